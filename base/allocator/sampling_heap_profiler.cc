@@ -0,0 +1,371 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/sampling_heap_profiler.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/debug/stack_trace.h"
+#include "base/debug/trace_event.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/rand_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+namespace allocator {
+
+namespace {
+
+// The most frames kept per sample.
+const size_t kMaxFrames = 32;
+
+// A thread's countdown is set to this while the thread is inside the profiler,
+// so that the profiler's own allocations and frees are ignored.
+const uintptr_t kInsideProfiler = ~static_cast<uintptr_t>(0);
+
+// The longest gap between two samples on a thread.
+const double kMaxSamplingGap = 0xffffffffu;
+
+// Frees look the address up in a table of 2^kFilterBits counters before taking
+// the lock.
+const int kFilterBits = 16;
+const size_t kFilterSize = 1 << kFilterBits;
+
+// Non-zero while the profiler runs.
+subtle::Atomic32 g_running = 0;
+
+subtle::AtomicWord g_sampling_interval =
+    SamplingHeapProfiler::kDefaultSamplingInterval;
+
+// The number of bytes the thread may allocate before its next sample, plus one,
+// so that zero means that the thread hasn't drawn a countdown yet.
+ThreadLocalStorage::StaticSlot g_countdown = TLS_INITIALIZER;
+
+// The number of sampled live allocations whose addresses map to each counter.
+// Most frees find a zero and return without taking the lock.
+subtle::Atomic32 g_sampled_addresses[kFilterSize];
+
+LazyInstance<SamplingHeapProfiler>::Leaky g_profiler =
+    LAZY_INSTANCE_INITIALIZER;
+
+size_t FilterIndex(const void* address) {
+  // Allocations are at least 8-byte aligned; multiplicative hashing spreads
+  // the rest of the bits over the table.
+  uint32 bits = static_cast<uint32>(reinterpret_cast<uintptr_t>(address) >> 3);
+  return (bits * 2654435761u) >> (32 - kFilterBits);
+}
+
+// Draws the countdown to the next sample, plus one.
+uintptr_t DrawCountdown() {
+  double interval = static_cast<double>(
+      subtle::NoBarrier_Load(&g_sampling_interval));
+  // -log(1 - u) is exponentially distributed with a mean of 1 if u is uniform
+  // in [0, 1).
+  double gap = -log(1.0 - RandDouble()) * interval;
+  return static_cast<uintptr_t>(std::min(gap, kMaxSamplingGap)) + 1;
+}
+
+// Marks the current thread as inside the profiler for its lifetime.
+class ScopedInsideProfiler {
+ public:
+  ScopedInsideProfiler() : countdown_(g_countdown.Get()) {
+    g_countdown.Set(reinterpret_cast<void*>(kInsideProfiler));
+  }
+  ~ScopedInsideProfiler() { g_countdown.Set(countdown_); }
+
+ private:
+  void* countdown_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedInsideProfiler);
+};
+
+// Holds a snapshot until the tracing system needs to serialize it.
+class SampledHeapDumpHolder : public debug::ConvertableToTraceFormat {
+ public:
+  SampledHeapDumpHolder() {}
+
+  std::vector<SamplingHeapProfiler::Entry>* entries() { return &entries_; }
+
+  // base::debug::ConvertableToTraceFormat overrides:
+  virtual void AppendAsTraceFormat(std::string* out) const OVERRIDE {
+    SamplingHeapProfiler::AppendSnapshotAsTraceFormat(entries_, out);
+  }
+
+ private:
+  virtual ~SampledHeapDumpHolder() {}
+
+  std::vector<SamplingHeapProfiler::Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampledHeapDumpHolder);
+};
+
+}  // namespace
+
+struct SamplingHeapProfiler::Sample {
+  size_t size;
+  size_t estimated_size;
+  size_t frame_count;
+  const void* frames[kMaxFrames];
+};
+
+SamplingHeapProfiler::Entry::Entry()
+    : count(0),
+      sampled_bytes(0),
+      estimated_bytes(0) {
+}
+
+SamplingHeapProfiler::Entry::~Entry() {
+}
+
+SamplingHeapProfiler::SamplingHeapProfiler() {
+}
+
+SamplingHeapProfiler::~SamplingHeapProfiler() {
+}
+
+// static
+SamplingHeapProfiler* SamplingHeapProfiler::GetInstance() {
+  return g_profiler.Pointer();
+}
+
+void SamplingHeapProfiler::SetSamplingInterval(size_t sampling_interval) {
+  DCHECK_GT(sampling_interval, 0u);
+  subtle::NoBarrier_Store(&g_sampling_interval, sampling_interval);
+  if (g_countdown.initialized())
+    g_countdown.Set(NULL);
+}
+
+void SamplingHeapProfiler::Start() {
+  AutoLock lock(lock_);
+  if (!g_countdown.initialized())
+    CHECK(g_countdown.Initialize(NULL));
+  g_countdown.Set(NULL);
+  // Publishes the slot to the hooks on other threads.
+  subtle::Release_Store(&g_running, 1);
+}
+
+void SamplingHeapProfiler::Stop() {
+  AutoLock lock(lock_);
+  subtle::Release_Store(&g_running, 0);
+  for (size_t i = 0; i < kFilterSize; ++i)
+    subtle::NoBarrier_Store(&g_sampled_addresses[i], 0);
+  samples_.clear();
+}
+
+// static
+void SamplingHeapProfiler::RecordAlloc(const void* address, size_t size) {
+  if (!address || !subtle::Acquire_Load(&g_running))
+    return;
+  uintptr_t countdown = reinterpret_cast<uintptr_t>(g_countdown.Get());
+  if (countdown == kInsideProfiler)
+    return;
+  if (countdown == 0) {
+    g_countdown.Set(reinterpret_cast<void*>(kInsideProfiler));
+    countdown = DrawCountdown();
+  }
+  if (size + 1 < countdown) {
+    g_countdown.Set(reinterpret_cast<void*>(countdown - size));
+    return;
+  }
+  g_countdown.Set(reinterpret_cast<void*>(kInsideProfiler));
+  g_profiler.Pointer()->AddSample(address, size);
+  g_countdown.Set(reinterpret_cast<void*>(DrawCountdown()));
+}
+
+// static
+void SamplingHeapProfiler::RecordFree(const void* address) {
+  if (!address || !subtle::Acquire_Load(&g_running))
+    return;
+  if (!subtle::NoBarrier_Load(&g_sampled_addresses[FilterIndex(address)]))
+    return;
+  if (reinterpret_cast<uintptr_t>(g_countdown.Get()) == kInsideProfiler)
+    return;
+  ScopedInsideProfiler inside_profiler;
+  g_profiler.Pointer()->RemoveSample(address);
+}
+
+void SamplingHeapProfiler::GetSnapshot(std::vector<Entry>* entries) {
+  entries->clear();
+  if (!g_countdown.initialized())
+    return;
+  ScopedInsideProfiler inside_profiler;
+
+  std::map<std::vector<const void*>, Entry> entries_by_stack;
+  {
+    AutoLock lock(lock_);
+    for (SampleMap::const_iterator it = samples_.begin(); it != samples_.end();
+         ++it) {
+      const Sample& sample = it->second;
+      std::vector<const void*> frames(sample.frames,
+                                      sample.frames + sample.frame_count);
+      Entry& entry = entries_by_stack[frames];
+      entry.count++;
+      entry.sampled_bytes += sample.size;
+      entry.estimated_bytes += sample.estimated_size;
+    }
+  }
+
+  entries->reserve(entries_by_stack.size());
+  for (std::map<std::vector<const void*>, Entry>::iterator it =
+           entries_by_stack.begin();
+       it != entries_by_stack.end(); ++it) {
+    entries->push_back(it->second);
+    entries->back().frames = it->first;
+  }
+}
+
+// static
+void SamplingHeapProfiler::AppendSnapshotAsTraceFormat(
+    const std::vector<Entry>& entries,
+    std::string* out) {
+  size_t total_estimated_bytes = 0;
+  out->append("{\"allocations\":[");
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    total_estimated_bytes += entry.estimated_bytes;
+    if (i)
+      out->append(",");
+    StringAppendF(out,
+                  "{\"count\":%" PRIuS ",\"sampled_bytes\":%" PRIuS
+                  ",\"estimated_bytes\":%" PRIuS ",\"frames\":[",
+                  entry.count, entry.sampled_bytes, entry.estimated_bytes);
+    for (size_t j = 0; j < entry.frames.size(); ++j) {
+      StringAppendF(out, "%s\"0x%" PRIx64 "\"", j ? "," : "",
+                    static_cast<uint64>(
+                        reinterpret_cast<uintptr_t>(entry.frames[j])));
+    }
+    out->append("]}");
+  }
+  StringAppendF(out, "],\"total_estimated_bytes\":%" PRIuS "}",
+                total_estimated_bytes);
+}
+
+void SamplingHeapProfiler::AddSample(const void* address, size_t size) {
+  Sample sample;
+  sample.size = size;
+  // An allocation of |size| bytes is sampled with probability
+  // 1 - exp(-size / interval), so it stands for 1 / that many bytes' worth of
+  // allocations of its size.
+  double interval = static_cast<double>(
+      subtle::NoBarrier_Load(&g_sampling_interval));
+  double probability = 1.0 - exp(-static_cast<double>(size) / interval);
+  sample.estimated_size = probability > 0 ?
+      static_cast<size_t>(size / probability) : size;
+
+  debug::StackTrace stack_trace;
+  size_t frame_count;
+  const void* const* frames = stack_trace.Addresses(&frame_count);
+  sample.frame_count = std::min(frame_count, kMaxFrames);
+  std::copy(frames, frames + sample.frame_count, sample.frames);
+
+  AutoLock lock(lock_);
+  // Stop() may have run since RecordAlloc() checked.
+  if (!subtle::NoBarrier_Load(&g_running))
+    return;
+  std::pair<SampleMap::iterator, bool> result =
+      samples_.insert(std::make_pair(address, sample));
+  if (result.second) {
+    subtle::NoBarrier_AtomicIncrement(
+        &g_sampled_addresses[FilterIndex(address)], 1);
+  } else {
+    // The free of the previous allocation at |address| happened while the
+    // hooks weren't installed.
+    result.first->second = sample;
+  }
+}
+
+void SamplingHeapProfiler::RemoveSample(const void* address) {
+  AutoLock lock(lock_);
+  SampleMap::iterator it = samples_.find(address);
+  if (it == samples_.end())
+    return;
+  samples_.erase(it);
+  subtle::NoBarrier_AtomicIncrement(
+      &g_sampled_addresses[FilterIndex(address)], -1);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+SamplingHeapProfilerController::SamplingHeapProfilerController(
+    scoped_refptr<MessageLoopProxy> message_loop_proxy,
+    HooksFunction add_hooks_function,
+    HooksFunction remove_hooks_function)
+    : message_loop_proxy_(message_loop_proxy),
+      add_hooks_function_(add_hooks_function),
+      remove_hooks_function_(remove_hooks_function),
+      weak_factory_(this) {
+  // Force the category to show up in the trace viewer.
+  TRACE_EVENT0(TRACE_DISABLED_BY_DEFAULT("memory.sampled"), "init");
+  debug::TraceLog::GetInstance()->AddEnabledStateObserver(this);
+}
+
+SamplingHeapProfilerController::~SamplingHeapProfilerController() {
+  if (dump_timer_.IsRunning())
+    StopProfiling();
+  debug::TraceLog::GetInstance()->RemoveEnabledStateObserver(this);
+}
+
+void SamplingHeapProfilerController::OnTraceLogEnabled() {
+  bool enabled;
+  TRACE_EVENT_CATEGORY_GROUP_ENABLED(
+      TRACE_DISABLED_BY_DEFAULT("memory.sampled"), &enabled);
+  if (!enabled)
+    return;
+  message_loop_proxy_->PostTask(
+      FROM_HERE,
+      Bind(&SamplingHeapProfilerController::StartProfiling,
+           weak_factory_.GetWeakPtr()));
+}
+
+void SamplingHeapProfilerController::OnTraceLogDisabled() {
+  // The category is always disabled by now, so whether it was enabled can't be
+  // told. StopProfiling() does nothing if it wasn't.
+  message_loop_proxy_->PostTask(
+      FROM_HERE,
+      Bind(&SamplingHeapProfilerController::StopProfiling,
+           weak_factory_.GetWeakPtr()));
+}
+
+void SamplingHeapProfilerController::StartProfiling() {
+  if (dump_timer_.IsRunning())
+    return;
+  SamplingHeapProfiler::GetInstance()->Start();
+  add_hooks_function_(&SamplingHeapProfiler::RecordAlloc,
+                      &SamplingHeapProfiler::RecordFree);
+  const int kDumpIntervalSeconds = 5;
+  dump_timer_.Start(FROM_HERE,
+                    TimeDelta::FromSeconds(kDumpIntervalSeconds),
+                    Bind(&SamplingHeapProfilerController::DumpMemoryProfile,
+                         weak_factory_.GetWeakPtr()));
+}
+
+void SamplingHeapProfilerController::DumpMemoryProfile() {
+  scoped_refptr<SampledHeapDumpHolder> dump(new SampledHeapDumpHolder);
+  SamplingHeapProfiler::GetInstance()->GetSnapshot(dump->entries());
+  const int kSnapshotId = 1;
+  TRACE_EVENT_OBJECT_SNAPSHOT_WITH_ID(
+      TRACE_DISABLED_BY_DEFAULT("memory.sampled"),
+      "memory::SampledHeap",
+      kSnapshotId,
+      scoped_refptr<debug::ConvertableToTraceFormat>(dump));
+}
+
+void SamplingHeapProfilerController::StopProfiling() {
+  if (!dump_timer_.IsRunning())
+    return;
+  dump_timer_.Stop();
+  remove_hooks_function_(&SamplingHeapProfiler::RecordAlloc,
+                         &SamplingHeapProfiler::RecordFree);
+  SamplingHeapProfiler::GetInstance()->Stop();
+}
+
+}  // namespace allocator
+}  // namespace base
@@ -0,0 +1,154 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SamplingHeapProfiler records the call stacks of a random sample of the heap
+// allocations a process makes, cheaply enough to leave running in production.
+// Every allocated byte has the same chance of being sampled: the bytes between
+// two samples on a thread follow an exponential distribution with a given mean,
+// so an allocation of |size| bytes is sampled with probability
+// 1 - exp(-size / mean). Allocations that aren't sampled cost a thread-local
+// counter decrement, and frees a lookup in a small table of counters.
+//
+// The profiler doesn't hook any allocator itself. The embedder forwards
+// allocations and frees to RecordAlloc() and RecordFree() while it runs, e.g.
+// with tcmalloc's MallocHook_AddNewHook() and MallocHook_AddDeleteHook().
+// SamplingHeapProfilerController does so while the "memory.sampled" trace
+// category is enabled, and periodically adds the live samples to the trace.
+
+#ifndef BASE_ALLOCATOR_SAMPLING_HEAP_PROFILER_H_
+#define BASE_ALLOCATOR_SAMPLING_HEAP_PROFILER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/debug/trace_event_impl.h"
+#include "base/lazy_instance.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/timer/timer.h"
+
+namespace base {
+
+class MessageLoopProxy;
+
+namespace allocator {
+
+class BASE_EXPORT SamplingHeapProfiler {
+ public:
+  // Signatures of the functions the embedder's allocator hooks call.
+  typedef void (*AllocHook)(const void* address, size_t size);
+  typedef void (*FreeHook)(const void* address);
+
+  // The live sampled allocations made from one call stack.
+  struct BASE_EXPORT Entry {
+    Entry();
+    ~Entry();
+
+    // The return addresses of the stack, innermost first. Includes the
+    // profiler's and the allocator's own frames.
+    std::vector<const void*> frames;
+
+    // The number of sampled allocations and the bytes they hold.
+    size_t count;
+    size_t sampled_bytes;
+
+    // An estimate of the bytes held by all allocations from the stack, sampled
+    // or not.
+    size_t estimated_bytes;
+  };
+
+  // The default mean number of bytes between two samples.
+  static const size_t kDefaultSamplingInterval = 128 * 1024;
+
+  static SamplingHeapProfiler* GetInstance();
+
+  // Sets the mean number of bytes between two samples. Takes effect on each
+  // thread after its next sample, and right away on the calling thread.
+  void SetSamplingInterval(size_t sampling_interval);
+
+  // Starts and stops sampling. Stopping forgets all samples.
+  void Start();
+  void Stop();
+
+  // Called by the allocator hooks for each allocation and free. Cheap and safe
+  // to call on any thread, whether or not the profiler is running.
+  static void RecordAlloc(const void* address, size_t size);
+  static void RecordFree(const void* address);
+
+  // Replaces the contents of |entries| with the live samples grouped by stack.
+  void GetSnapshot(std::vector<Entry>* entries);
+
+  // Appends |entries| as a JSON object to |out|, with the addresses of the
+  // frames in hex.
+  static void AppendSnapshotAsTraceFormat(const std::vector<Entry>& entries,
+                                          std::string* out);
+
+ private:
+  friend struct DefaultLazyInstanceTraits<SamplingHeapProfiler>;
+  struct Sample;
+  typedef std::map<const void*, Sample> SampleMap;
+
+  SamplingHeapProfiler();
+  ~SamplingHeapProfiler();
+
+  void AddSample(const void* address, size_t size);
+  void RemoveSample(const void* address);
+
+  // Guards |samples_| and the starting and stopping of sampling.
+  Lock lock_;
+  SampleMap samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingHeapProfiler);
+};
+
+// Runs the SamplingHeapProfiler while the "memory.sampled" trace category is
+// enabled, and adds its samples to the trace every few seconds as
+// "memory::SampledHeap" snapshots.
+class BASE_EXPORT SamplingHeapProfilerController
+    : public debug::TraceLog::EnabledStateObserver {
+ public:
+  // Adds or removes |alloc_hook| and |free_hook| to or from the process'
+  // allocator.
+  typedef void (*HooksFunction)(SamplingHeapProfiler::AllocHook alloc_hook,
+                                SamplingHeapProfiler::FreeHook free_hook);
+
+  // |message_loop_proxy| must be a proxy to the primary thread for the client
+  // process, e.g. the UI thread in a browser. Passing the hook functions in
+  // avoids a dependency from base on the allocator.
+  SamplingHeapProfilerController(
+      scoped_refptr<MessageLoopProxy> message_loop_proxy,
+      HooksFunction add_hooks_function,
+      HooksFunction remove_hooks_function);
+  virtual ~SamplingHeapProfilerController();
+
+  // base::debug::TraceLog::EnabledStateObserver overrides:
+  virtual void OnTraceLogEnabled() OVERRIDE;
+  virtual void OnTraceLogDisabled() OVERRIDE;
+
+  void StartProfiling();
+  void DumpMemoryProfile();
+  void StopProfiling();
+
+  bool IsTimerRunningForTest() const { return dump_timer_.IsRunning(); }
+
+ private:
+  scoped_refptr<MessageLoopProxy> message_loop_proxy_;
+  HooksFunction add_hooks_function_;
+  HooksFunction remove_hooks_function_;
+
+  RepeatingTimer<SamplingHeapProfilerController> dump_timer_;
+
+  WeakPtrFactory<SamplingHeapProfilerController> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingHeapProfilerController);
+};
+
+}  // namespace allocator
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_SAMPLING_HEAP_PROFILER_H_
@@ -0,0 +1,148 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/sampling_heap_profiler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace allocator {
+
+namespace {
+
+// The tests record made-up allocations, so the hooks never see a real one.
+const void* FakeAddress(size_t i) {
+  return reinterpret_cast<const void*>(0x10000 + i * 16);
+}
+
+class SamplingHeapProfilerTest : public testing::Test {
+ protected:
+  SamplingHeapProfilerTest()
+      : profiler_(SamplingHeapProfiler::GetInstance()) {
+  }
+
+  virtual ~SamplingHeapProfilerTest() {
+    profiler_->Stop();
+    profiler_->SetSamplingInterval(
+        SamplingHeapProfiler::kDefaultSamplingInterval);
+  }
+
+  SamplingHeapProfiler* profiler_;
+};
+
+int g_hooks_added = 0;
+
+void AddHooks(SamplingHeapProfiler::AllocHook alloc_hook,
+              SamplingHeapProfiler::FreeHook free_hook) {
+  EXPECT_EQ(&SamplingHeapProfiler::RecordAlloc, alloc_hook);
+  EXPECT_EQ(&SamplingHeapProfiler::RecordFree, free_hook);
+  ++g_hooks_added;
+}
+
+void RemoveHooks(SamplingHeapProfiler::AllocHook alloc_hook,
+                 SamplingHeapProfiler::FreeHook free_hook) {
+  --g_hooks_added;
+}
+
+}  // namespace
+
+TEST_F(SamplingHeapProfilerTest, NotRunning) {
+  SamplingHeapProfiler::RecordAlloc(FakeAddress(0), 1024 * 1024);
+  std::vector<SamplingHeapProfiler::Entry> entries;
+  profiler_->GetSnapshot(&entries);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST_F(SamplingHeapProfilerTest, GroupsSamplesByStack) {
+  // With a mean of one byte between samples, every allocation this big is all
+  // but certain to be sampled.
+  profiler_->SetSamplingInterval(1);
+  profiler_->Start();
+  for (size_t i = 0; i < 100; ++i)
+    SamplingHeapProfiler::RecordAlloc(FakeAddress(i), 1000);
+  SamplingHeapProfiler::RecordAlloc(FakeAddress(100), 500);
+
+  std::vector<SamplingHeapProfiler::Entry> entries;
+  profiler_->GetSnapshot(&entries);
+  ASSERT_EQ(2u, entries.size());
+  size_t loop = entries[0].count == 100 ? 0 : 1;
+  EXPECT_EQ(100u, entries[loop].count);
+  EXPECT_EQ(100000u, entries[loop].sampled_bytes);
+  EXPECT_EQ(100000u, entries[loop].estimated_bytes);
+  EXPECT_FALSE(entries[loop].frames.empty());
+  EXPECT_EQ(1u, entries[1 - loop].count);
+  EXPECT_EQ(500u, entries[1 - loop].sampled_bytes);
+
+  // Freed allocations are dropped, and unknown addresses are ignored.
+  for (size_t i = 0; i < 50; ++i)
+    SamplingHeapProfiler::RecordFree(FakeAddress(i));
+  SamplingHeapProfiler::RecordFree(FakeAddress(1000));
+  profiler_->GetSnapshot(&entries);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(50u, entries[loop].count);
+  EXPECT_EQ(50000u, entries[loop].sampled_bytes);
+
+  profiler_->Stop();
+  profiler_->GetSnapshot(&entries);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST_F(SamplingHeapProfilerTest, EstimatesUnsampledBytes) {
+  const size_t kNumAllocations = 100000;
+  const size_t kSize = 64;
+  profiler_->SetSamplingInterval(1024);
+  profiler_->Start();
+  for (size_t i = 0; i < kNumAllocations; ++i)
+    SamplingHeapProfiler::RecordAlloc(FakeAddress(i), kSize);
+
+  std::vector<SamplingHeapProfiler::Entry> entries;
+  profiler_->GetSnapshot(&entries);
+  ASSERT_EQ(1u, entries.size());
+  // About one allocation in 16.5 is sampled; the estimate is within a few
+  // standard deviations of the truth.
+  EXPECT_GT(entries[0].count, kNumAllocations / 20);
+  EXPECT_LT(entries[0].count, kNumAllocations / 14);
+  EXPECT_GT(entries[0].estimated_bytes, kNumAllocations * kSize * 9 / 10);
+  EXPECT_LT(entries[0].estimated_bytes, kNumAllocations * kSize * 11 / 10);
+}
+
+TEST_F(SamplingHeapProfilerTest, TraceFormat) {
+  std::vector<SamplingHeapProfiler::Entry> entries(1);
+  entries[0].frames.push_back(reinterpret_cast<const void*>(0x1234));
+  entries[0].frames.push_back(reinterpret_cast<const void*>(0xabcd));
+  entries[0].count = 2;
+  entries[0].sampled_bytes = 100;
+  entries[0].estimated_bytes = 4000;
+  std::string json;
+  SamplingHeapProfiler::AppendSnapshotAsTraceFormat(entries, &json);
+  EXPECT_EQ("{\"allocations\":[{\"count\":2,\"sampled_bytes\":100,"
+            "\"estimated_bytes\":4000,\"frames\":[\"0x1234\",\"0xabcd\"]}],"
+            "\"total_estimated_bytes\":4000}",
+            json);
+}
+
+TEST_F(SamplingHeapProfilerTest, Controller) {
+  MessageLoop message_loop;
+  scoped_ptr<SamplingHeapProfilerController> controller(
+      new SamplingHeapProfilerController(message_loop.message_loop_proxy(),
+                                         &AddHooks, &RemoveHooks));
+  EXPECT_FALSE(controller->IsTimerRunningForTest());
+
+  controller->StartProfiling();
+  EXPECT_TRUE(controller->IsTimerRunningForTest());
+  EXPECT_EQ(1, g_hooks_added);
+  controller->DumpMemoryProfile();
+
+  controller->StopProfiling();
+  EXPECT_FALSE(controller->IsTimerRunningForTest());
+  EXPECT_EQ(0, g_hooks_added);
+}
+
+}  // namespace allocator
+}  // namespace base
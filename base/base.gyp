@@ -439,6 +439,7 @@
       'type': '<(gtest_target_type)',
       'sources': [
         # Tests.
+        'allocator/sampling_heap_profiler_unittest.cc',
         'android/activity_status_unittest.cc',
         'android/jni_android_unittest.cc',
         'android/jni_array_unittest.cc',
@@ -462,6 +463,7 @@
         'callback_unittest.nc',
         'cancelable_callback_unittest.cc',
         'command_line_unittest.cc',
+        'containers/flat_hash_map_unittest.cc',
         'containers/hash_tables_unittest.cc',
         'containers/linked_list_unittest.cc',
         'containers/mru_cache_unittest.cc',
@@ -506,6 +508,7 @@
         'ios/device_util_unittest.mm',
         'json/json_parser_unittest.cc',
         'json/json_reader_unittest.cc',
+        'json/json_value_builder_unittest.cc',
         'json/json_value_converter_unittest.cc',
         'json/json_value_serializer_unittest.cc',
         'json/json_writer_unittest.cc',
@@ -521,6 +524,7 @@
         'mac/scoped_sending_event_unittest.mm',
         'md5_unittest.cc',
         'memory/aligned_memory_unittest.cc',
+        'memory/discardable_lru_cache_unittest.cc',
         'memory/discardable_memory_allocator_android_unittest.cc',
         'memory/discardable_memory_unittest.cc',
         'memory/discardable_memory_provider_unittest.cc',
@@ -532,8 +536,10 @@
         'memory/scoped_vector_unittest.cc',
         'memory/shared_memory_unittest.cc',
         'memory/singleton_unittest.cc',
+        'memory/task_arena_unittest.cc',
         'memory/weak_ptr_unittest.cc',
         'memory/weak_ptr_unittest.nc',
+        'message_loop/lock_free_task_queue_unittest.cc',
         'message_loop/message_loop_proxy_impl_unittest.cc',
         'message_loop/message_loop_proxy_unittest.cc',
         'message_loop/message_loop_unittest.cc',
@@ -548,6 +554,7 @@
         'metrics/histogram_delta_serialization_unittest.cc',
         'metrics/histogram_snapshot_manager_unittest.cc',
         'metrics/histogram_unittest.cc',
+        'metrics/shared_histogram_allocator_unittest.cc',
         'metrics/sparse_histogram_unittest.cc',
         'metrics/stats_table_unittest.cc',
         'metrics/statistics_recorder_unittest.cc',
@@ -833,6 +840,26 @@
         'i18n/streaming_utf8_validator_perftest.cc',
       ],
     },
+    {
+      'target_name': 'base_perftests',
+      'type': '<(gtest_target_type)',
+      'dependencies': [
+        'test_support_base',
+        'test_support_perf',
+        '../testing/gtest.gyp:gtest',
+        'base',
+        'base_prefs',
+      ],
+      'sources': [
+        'containers/flat_hash_map_perftest.cc',
+        'memory/task_arena_perftest.cc',
+        'metrics/histogram_perftest.cc',
+        'prefs/json_pref_store_perftest.cc',
+        'strings/utf_string_conversions_perftest.cc',
+        'threading/sequenced_worker_pool_perftest.cc',
+        'values_perftest.cc',
+      ],
+    },
     {
       'target_name': 'test_support_base',
       'type': 'static_library',
@@ -0,0 +1,66 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_MAP_H_
+#define BASE_CONTAINERS_FLAT_HASH_MAP_H_
+
+#include <functional>
+#include <utility>
+
+#include "base/containers/flat_hash_table.h"
+
+namespace base {
+
+namespace internal {
+
+template <typename Key, typename Value>
+struct FlatHashMapKeyOf {
+  const Key& operator()(const std::pair<const Key, Value>& value) const {
+    return value.first;
+  }
+};
+
+template <typename Key, typename Value>
+struct FlatHashMapMakeValue {
+  std::pair<const Key, Value> operator()(const Key& key) const {
+    return std::pair<const Key, Value>(key, Value());
+  }
+};
+
+}  // namespace internal
+
+// A hash map that stores its elements in one array and finds them by open
+// addressing, for maps that are looked up on hot paths. It has the interface
+// of base::hash_map, minus the bucket interface. Lookups touch fewer cache
+// lines, which makes them about twice as fast once the map is too big for the
+// L1 cache; for maps of a few dozen elements base::hash_map is as fast (see
+// flat_hash_map_perftest.cc). See flat_hash_table.h for how it works.
+//
+// Unlike base::hash_map, inserting an element may move all the others, which
+// invalidates iterators and pointers to them. Erasing doesn't. Elements have
+// to be copyable. For large values, store pointers to them.
+template <typename Key,
+          typename Value,
+          typename Hash = FlatHashDefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class FlatHashMap
+    : public internal::FlatHashTable<Key,
+                                     std::pair<const Key, Value>,
+                                     std::pair<const Key, Value>,
+                                     internal::FlatHashMapKeyOf<Key, Value>,
+                                     Hash,
+                                     KeyEqual> {
+ public:
+  typedef Value mapped_type;
+
+  Value& operator[](const Key& key) {
+    return this->FindOrInsert(key,
+                              internal::FlatHashMapMakeValue<Key, Value>())
+        .second;
+  }
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_MAP_H_
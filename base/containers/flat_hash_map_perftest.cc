@@ -0,0 +1,88 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares FlatHashMap with base::hash_map for maps of ids like the layer id
+// maps in cc.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <string>
+#include <vector>
+
+#include "base/containers/hash_tables.h"
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/perf_log.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kLookups = 10000000;
+
+// Returns |count| distinct random keys.
+std::vector<int> MakeKeys(size_t count) {
+  hash_set<int> keys;
+  while (keys.size() < count)
+    keys.insert(RandInt(0, kint32max));
+  return std::vector<int>(keys.begin(), keys.end());
+}
+
+template <typename Map>
+void RunTest(const std::string& name, size_t size) {
+  std::vector<int> keys = MakeKeys(size * 2);
+  std::string test_name = name + "_" + IntToString(size);
+
+  Map map;
+  {
+    PerfTimeLogger logger((test_name + "_Insert").c_str());
+    for (size_t i = 0; i < size; ++i)
+      map[keys[i]] = static_cast<int>(i);
+    logger.Done();
+  }
+
+  // Half the lookups are for keys that aren't there.
+  size_t rounds = kLookups / keys.size() + 1;
+  size_t found = 0;
+  {
+    PerfTimeLogger logger((test_name + "_Find").c_str());
+    for (size_t round = 0; round < rounds; ++round) {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        if (map.find(keys[i]) != map.end())
+          ++found;
+      }
+    }
+    logger.Done();
+  }
+  EXPECT_EQ(rounds * size, found);
+
+  {
+    PerfTimeLogger logger((test_name + "_Erase").c_str());
+    for (size_t i = 0; i < size; ++i)
+      map.erase(keys[i]);
+    logger.Done();
+  }
+  EXPECT_TRUE(map.empty());
+}
+
+}  // namespace
+
+TEST(FlatHashMapPerfTest, SmallMap) {
+  RunTest<hash_map<int, int> >("HashMap", 100);
+  RunTest<FlatHashMap<int, int> >("FlatHashMap", 100);
+}
+
+TEST(FlatHashMapPerfTest, MediumMap) {
+  RunTest<hash_map<int, int> >("HashMap", 10000);
+  RunTest<FlatHashMap<int, int> >("FlatHashMap", 10000);
+}
+
+TEST(FlatHashMapPerfTest, LargeMap) {
+  RunTest<hash_map<int, int> >("HashMap", 1000000);
+  RunTest<FlatHashMap<int, int> >("FlatHashMap", 1000000);
+}
+
+}  // namespace base
@@ -0,0 +1,142 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <set>
+#include <string>
+
+#include "base/containers/flat_hash_set.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Sends all keys to the same probe sequence.
+struct ConstantHash {
+  size_t operator()(int key) const { return 42; }
+};
+
+}  // namespace
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.find(1) == map.end());
+  EXPECT_TRUE(map.begin() == map.end());
+
+  EXPECT_TRUE(map.insert(std::make_pair(1, std::string("one"))).second);
+  std::pair<FlatHashMap<int, std::string>::iterator, bool> result =
+      map.insert(std::make_pair(1, std::string("uno")));
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ("one", result.first->second);
+  map[2] = "two";
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ("one", map.find(1)->second);
+  EXPECT_EQ("two", map[2]);
+  EXPECT_EQ("", map[3]);
+  EXPECT_EQ(3u, map.size());
+
+  EXPECT_EQ(1u, map.erase(1));
+  EXPECT_EQ(0u, map.erase(1));
+  EXPECT_EQ(0u, map.count(1));
+  map.erase(map.find(2));
+  EXPECT_EQ(1u, map.size());
+  EXPECT_EQ(1u, map.count(3));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.find(3) == map.end());
+}
+
+TEST(FlatHashMapTest, ManyElements) {
+  const int kCount = 10000;
+  FlatHashMap<int, int> map;
+  for (int i = 0; i < kCount; ++i)
+    map[i * 7] = i;
+  EXPECT_EQ(static_cast<size_t>(kCount), map.size());
+  EXPECT_LE(map.size(), map.capacity() - map.capacity() / 8);
+
+  // Erasing leaves deleted slots that lookups have to probe past.
+  for (int i = 0; i < kCount; i += 2)
+    EXPECT_EQ(1u, map.erase(i * 7));
+  for (int i = 0; i < kCount; ++i) {
+    FlatHashMap<int, int>::const_iterator it = map.find(i * 7);
+    if (i % 2) {
+      ASSERT_TRUE(it != map.end());
+      EXPECT_EQ(i, it->second);
+    } else {
+      EXPECT_TRUE(it == map.end());
+    }
+  }
+
+  // Refilling reuses the deleted slots rather than growing for ever.
+  size_t capacity = map.capacity();
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < kCount; i += 2)
+      map[i * 7] = i;
+    for (int i = 0; i < kCount; i += 2)
+      map.erase(i * 7);
+  }
+  EXPECT_EQ(capacity, map.capacity());
+
+  std::set<int> seen;
+  for (FlatHashMap<int, int>::iterator it = map.begin(); it != map.end();
+       ++it) {
+    EXPECT_EQ(it->first, it->second * 7);
+    EXPECT_TRUE(seen.insert(it->first).second);
+  }
+  EXPECT_EQ(map.size(), seen.size());
+}
+
+TEST(FlatHashMapTest, CollidingHashes) {
+  FlatHashMap<int, int, ConstantHash> map;
+  for (int i = 0; i < 100; ++i)
+    map[i] = i;
+  for (int i = 0; i < 100; i += 3)
+    map.erase(i);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i % 3 ? 1u : 0u, map.count(i)) << i;
+}
+
+TEST(FlatHashMapTest, CopyAndSwap) {
+  FlatHashMap<std::string, int> map;
+  map["a"] = 1;
+  map["b"] = 2;
+  FlatHashMap<std::string, int> copy(map);
+  map["a"] = 3;
+  EXPECT_EQ(1, copy["a"]);
+  EXPECT_EQ(2u, copy.size());
+
+  FlatHashMap<std::string, int> other;
+  other["c"] = 4;
+  other.swap(copy);
+  EXPECT_EQ(1u, copy.size());
+  EXPECT_EQ(4, copy["c"]);
+  EXPECT_EQ(2, other["b"]);
+
+  other = map;
+  EXPECT_EQ(3, other["a"]);
+}
+
+TEST(FlatHashSetTest, InsertFindErase) {
+  FlatHashSet<int> set;
+  for (int i = 0; i < 100; ++i)
+    EXPECT_TRUE(set.insert(i).second);
+  EXPECT_FALSE(set.insert(5).second);
+  EXPECT_EQ(100u, set.size());
+  EXPECT_EQ(1u, set.erase(5));
+  EXPECT_TRUE(set.find(5) == set.end());
+  EXPECT_EQ(6, *set.find(6));
+
+  int sum = 0;
+  for (FlatHashSet<int>::const_iterator it = set.begin(); it != set.end();
+       ++it) {
+    sum += *it;
+  }
+  EXPECT_EQ(4950 - 5, sum);
+}
+
+}  // namespace base
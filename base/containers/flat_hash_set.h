@@ -0,0 +1,40 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_SET_H_
+#define BASE_CONTAINERS_FLAT_HASH_SET_H_
+
+#include <functional>
+
+#include "base/containers/flat_hash_table.h"
+
+namespace base {
+
+namespace internal {
+
+template <typename Key>
+struct FlatHashSetKeyOf {
+  const Key& operator()(const Key& key) const { return key; }
+};
+
+}  // namespace internal
+
+// The set version of FlatHashMap, with the interface of base::hash_set. The
+// same caveats apply: inserting invalidates iterators and pointers to the
+// elements.
+template <typename Key,
+          typename Hash = FlatHashDefaultHash<Key>,
+          typename KeyEqual = std::equal_to<Key> >
+class FlatHashSet
+    : public internal::FlatHashTable<Key,
+                                     Key,
+                                     const Key,
+                                     internal::FlatHashSetKeyOf<Key>,
+                                     Hash,
+                                     KeyEqual> {
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_SET_H_
@@ -0,0 +1,536 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// The open addressing hash table behind FlatHashMap and FlatHashSet. Don't use
+// it directly.
+//
+// Elements are stored in one array of slots, next to an array of control
+// bytes with one byte per slot. A control byte says whether its slot is empty,
+// deleted or full, and for full slots holds 7 bits of the element's hash. A
+// lookup hashes the key once, then scans the control bytes of a group of 16
+// slots at a time for the 7 bits, which SSE2 does in a few instructions, and
+// only compares keys for the slots whose bits match. Most lookups touch one
+// cache line of control bytes and one slot, where a node based hash_map
+// follows a pointer to a bucket and another to each node.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_TABLE_H_
+#define BASE_CONTAINERS_FLAT_HASH_TABLE_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/logging.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BASE_FLAT_HASH_TABLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
+namespace base {
+
+// The hash function FlatHashMap and FlatHashSet use by default. It is the one
+// base::hash_map uses.
+template <typename Key>
+struct FlatHashDefaultHash {
+  size_t operator()(const Key& key) const {
+#if defined(COMPILER_MSVC)
+    return stdext::hash_value(key);
+#else
+    return BASE_HASH_NAMESPACE::hash<Key>()(key);
+#endif
+  }
+};
+
+namespace internal {
+
+// Control byte values. Full slots hold 7 bits of the hash, 0 to 127.
+enum FlatHashControl {
+  kFlatHashEmpty = -128,
+  kFlatHashDeleted = -2
+};
+
+// The slots a group of control bytes covers.
+const size_t kFlatHashGroupWidth = 16;
+
+// Finds the slots of a group whose control bytes have a given value. The
+// results are bit masks with bit i set for the group's slot i.
+class FlatHashGroup {
+ public:
+  explicit FlatHashGroup(const int8* control) {
+#if defined(BASE_FLAT_HASH_TABLE_SSE2)
+    control_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+#else
+    memcpy(control_, control, kFlatHashGroupWidth);
+#endif
+  }
+
+  // Slots that are full and hold |hash_bits|.
+  uint32 Match(int8 hash_bits) const {
+#if defined(BASE_FLAT_HASH_TABLE_SSE2)
+    return _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8(hash_bits), control_));
+#else
+    return MatchIf(hash_bits, false);
+#endif
+  }
+
+  // Slots that are empty.
+  uint32 MatchEmpty() const {
+    return Match(static_cast<int8>(kFlatHashEmpty));
+  }
+
+  // Slots that are empty or deleted, that is, that an element can go to.
+  uint32 MatchFree() const {
+#if defined(BASE_FLAT_HASH_TABLE_SSE2)
+    // Free slots are the ones with negative control bytes.
+    return _mm_movemask_epi8(control_);
+#else
+    return MatchIf(0, true);
+#endif
+  }
+
+  // Returns the index of the lowest bit set in |mask|, which isn't 0.
+  static int LowestBit(uint32 mask) {
+    DCHECK(mask);
+#if defined(COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
+ private:
+#if defined(BASE_FLAT_HASH_TABLE_SSE2)
+  __m128i control_;
+#else
+  uint32 MatchIf(int8 value, bool negative) const {
+    uint32 mask = 0;
+    for (size_t i = 0; i < kFlatHashGroupWidth; ++i) {
+      if (negative ? control_[i] < 0 : control_[i] == value)
+        mask |= 1u << i;
+    }
+    return mask;
+  }
+
+  int8 control_[kFlatHashGroupWidth];
+#endif
+};
+
+// |Value| is what the table stores, |IteratorValue| what its iterators point
+// to: Value for maps and const Value for sets, whose elements are keys.
+// |KeyOf| is a functor that returns the key of a Value.
+template <typename Key,
+          typename Value,
+          typename IteratorValue,
+          typename KeyOf,
+          typename Hash,
+          typename KeyEqual>
+class FlatHashTable {
+ private:
+  template <typename IterValue>
+  class Iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef ptrdiff_t difference_type;
+    typedef IterValue* pointer;
+    typedef IterValue& reference;
+
+    Iterator() : control_(NULL), slot_(NULL), control_end_(NULL) {}
+
+    // Converts an iterator to a const_iterator.
+    template <typename OtherValue>
+    Iterator(const Iterator<OtherValue>& other)
+        : control_(other.control_),
+          slot_(other.slot_),
+          control_end_(other.control_end_) {
+    }
+
+    reference operator*() const { return *slot_; }
+    pointer operator->() const { return slot_; }
+
+    Iterator& operator++() {
+      ++control_;
+      ++slot_;
+      SkipFreeSlots();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator result(*this);
+      ++*this;
+      return result;
+    }
+
+    template <typename OtherValue>
+    bool operator==(const Iterator<OtherValue>& other) const {
+      return slot_ == other.slot_;
+    }
+
+    template <typename OtherValue>
+    bool operator!=(const Iterator<OtherValue>& other) const {
+      return slot_ != other.slot_;
+    }
+
+   private:
+    friend class FlatHashTable;
+    template <typename OtherValue> friend class Iterator;
+
+    Iterator(const int8* control, IterValue* slot, const int8* control_end)
+        : control_(control), slot_(slot), control_end_(control_end) {
+    }
+
+    void SkipFreeSlots() {
+      while (control_ != control_end_ && *control_ < 0) {
+        ++control_;
+        ++slot_;
+      }
+    }
+
+    const int8* control_;
+    IterValue* slot_;
+    const int8* control_end_;
+  };
+
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef size_t size_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef Iterator<IteratorValue> iterator;
+  typedef Iterator<const Value> const_iterator;
+
+  FlatHashTable()
+      : control_(NULL),
+        slots_(NULL),
+        capacity_(0),
+        size_(0),
+        growth_left_(0) {
+  }
+
+  FlatHashTable(const FlatHashTable& other)
+      : control_(NULL),
+        slots_(NULL),
+        capacity_(0),
+        size_(0),
+        growth_left_(0),
+        hash_(other.hash_),
+        key_equal_(other.key_equal_) {
+    reserve(other.size());
+    for (const_iterator it = other.begin(); it != other.end(); ++it)
+      insert(*it);
+  }
+
+  ~FlatHashTable() {
+    DestroyAll();
+    free(control_);
+  }
+
+  FlatHashTable& operator=(const FlatHashTable& other) {
+    FlatHashTable copy(other);
+    swap(copy);
+    return *this;
+  }
+
+  iterator begin() { return MakeIterator(0, true); }
+  const_iterator begin() const {
+    return const_cast<FlatHashTable*>(this)->begin();
+  }
+  iterator end() { return MakeIterator(capacity_, false); }
+  const_iterator end() const {
+    return const_cast<FlatHashTable*>(this)->end();
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  // The number of slots. The table grows when 7/8 of them are taken.
+  size_type capacity() const { return capacity_; }
+
+  void clear() {
+    DestroyAll();
+    if (capacity_)
+      ResetControl();
+  }
+
+  // Makes room for |count| elements without growing again.
+  void reserve(size_type count) {
+    size_type capacity = kFlatHashGroupWidth;
+    while (MaxLoad(capacity) < count)
+      capacity *= 2;
+    if (capacity > capacity_)
+      Resize(capacity);
+  }
+
+  iterator find(const Key& key) {
+    size_t index;
+    if (!Find(key, Hash2(key), &index))
+      return end();
+    return MakeIterator(index, false);
+  }
+
+  const_iterator find(const Key& key) const {
+    return const_cast<FlatHashTable*>(this)->find(key);
+  }
+
+  size_type count(const Key& key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  // Inserts |value| unless an element with its key is there. Returns the
+  // element with the key and whether |value| was inserted. Inserting may move
+  // all the elements, which invalidates iterators and pointers to them.
+  std::pair<iterator, bool> insert(const Value& value) {
+    const Key& key = KeyOf()(value);
+    size_t hash = Hash2(key);
+    size_t index;
+    if (Find(key, hash, &index))
+      return std::make_pair(MakeIterator(index, false), false);
+    index = PrepareInsert(hash);
+    new (&slots_[index]) Value(value);
+    return std::make_pair(MakeIterator(index, false), true);
+  }
+
+  // Erasing doesn't move other elements.
+  void erase(const_iterator pos) {
+    DCHECK(pos != end());
+    EraseAt(pos.slot_ - slots_);
+  }
+
+  size_type erase(const Key& key) {
+    size_t index;
+    if (!Find(key, Hash2(key), &index))
+      return 0;
+    EraseAt(index);
+    return 1;
+  }
+
+  void swap(FlatHashTable& other) {
+    std::swap(control_, other.control_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hash_, other.hash_);
+    std::swap(key_equal_, other.key_equal_);
+  }
+
+ protected:
+  // Returns the element with |key|, inserting |Value| made by |make_value|
+  // from the key if there is none.
+  template <typename MakeValue>
+  Value& FindOrInsert(const Key& key, MakeValue make_value) {
+    size_t hash = Hash2(key);
+    size_t index;
+    if (!Find(key, hash, &index)) {
+      index = PrepareInsert(hash);
+      new (&slots_[index]) Value(make_value(key));
+    }
+    return slots_[index];
+  }
+
+ private:
+  // The number of elements |capacity| slots can hold.
+  static size_type MaxLoad(size_type capacity) {
+    return capacity - capacity / 8;
+  }
+
+  // Returns the hash of |key|, mixed so that all of its bits depend on all of
+  // the bits of the key: hash functions like the identity for integers
+  // would make a table of keys with the same low bits probe the same slots.
+  size_t Hash2(const Key& key) const {
+    uint64 hash =
+        static_cast<uint64>(hash_(key)) * GG_UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<size_t>(hash ^ (hash >> 32));
+  }
+
+  // The 7 bits of the hash that go in the control bytes.
+  static int8 HashBits(size_t hash) { return static_cast<int8>(hash & 0x7f); }
+
+  // The slot where the probe sequence for |hash| starts.
+  size_t ProbeStart(size_t hash) const {
+    return (hash >> 7) & (capacity_ - 1);
+  }
+
+  bool Find(const Key& key, size_t hash, size_t* index) const {
+    if (!capacity_)
+      return false;
+    int8 hash_bits = HashBits(hash);
+    size_t mask = capacity_ - 1;
+    size_t position = ProbeStart(hash);
+    // Visits groups at triangular number steps, which covers the whole table
+    // when the number of slots is a power of 2.
+    for (size_t step = kFlatHashGroupWidth; ; step += kFlatHashGroupWidth) {
+      FlatHashGroup group(control_ + position);
+      for (uint32 match = group.Match(hash_bits); match; match &= match - 1) {
+        size_t candidate =
+            (position + FlatHashGroup::LowestBit(match)) & mask;
+        if (key_equal_(KeyOf()(slots_[candidate]), key)) {
+          *index = candidate;
+          return true;
+        }
+      }
+      // Probing stops at an empty slot: an element with the key would have
+      // been put there.
+      if (group.MatchEmpty())
+        return false;
+      position = (position + step) & mask;
+      DCHECK_LE(step, capacity_ + kFlatHashGroupWidth);
+    }
+  }
+
+  // Returns the slot to put a new element with |hash| in, growing the table
+  // if needed, and marks it full.
+  size_t PrepareInsert(size_t hash) {
+    if (!growth_left_) {
+      if (!capacity_)
+        Resize(kFlatHashGroupWidth);
+      else if (size_ < MaxLoad(capacity_) / 2)
+        Resize(capacity_);  // Deleted slots take the room: clear them.
+      else
+        Resize(capacity_ * 2);
+    }
+    size_t mask = capacity_ - 1;
+    size_t position = ProbeStart(hash);
+    for (size_t step = kFlatHashGroupWidth; ; step += kFlatHashGroupWidth) {
+      uint32 free = FlatHashGroup(control_ + position).MatchFree();
+      if (free) {
+        size_t index = (position + FlatHashGroup::LowestBit(free)) & mask;
+        if (control_[index] == kFlatHashEmpty)
+          --growth_left_;
+        SetControl(index, HashBits(hash));
+        ++size_;
+        return index;
+      }
+      position = (position + step) & mask;
+    }
+  }
+
+  void EraseAt(size_t index) {
+    slots_[index].~Value();
+    --size_;
+    // The slot can be made empty only if no probe sequence went past it,
+    // which is the case if the group it is in had an empty slot all along.
+    // Otherwise it is marked deleted, so that lookups continue past it.
+    size_t mask = capacity_ - 1;
+    size_t before = (index - kFlatHashGroupWidth) & mask;
+    uint32 empty_after = FlatHashGroup(control_ + index).MatchEmpty();
+    uint32 empty_before = FlatHashGroup(control_ + before).MatchEmpty();
+    if (empty_after && empty_before &&
+        LeadingZeros16(empty_before) + TrailingZeros16(empty_after) <
+            kFlatHashGroupWidth) {
+      SetControl(index, static_cast<int8>(kFlatHashEmpty));
+      ++growth_left_;
+    } else {
+      SetControl(index, static_cast<int8>(kFlatHashDeleted));
+    }
+  }
+
+  static size_t TrailingZeros16(uint32 mask) {
+    return mask ? FlatHashGroup::LowestBit(mask) : kFlatHashGroupWidth;
+  }
+
+  static size_t LeadingZeros16(uint32 mask) {
+    size_t zeros = 0;
+    for (uint32 bit = 1u << (kFlatHashGroupWidth - 1); bit && !(mask & bit);
+         bit >>= 1) {
+      ++zeros;
+    }
+    return zeros;
+  }
+
+  // Sets the control byte of slot |index|, and its copy past the end that
+  // lets groups be read across the end of the table.
+  void SetControl(size_t index, int8 value) {
+    control_[index] = value;
+    if (index < kFlatHashGroupWidth)
+      control_[capacity_ + index] = value;
+  }
+
+  void ResetControl() {
+    memset(control_, kFlatHashEmpty, capacity_ + kFlatHashGroupWidth);
+    growth_left_ = MaxLoad(capacity_);
+  }
+
+  // Moves the elements to a table of |capacity| slots.
+  void Resize(size_type capacity) {
+    DCHECK_GE(capacity, kFlatHashGroupWidth);
+    DCHECK_EQ(0u, capacity & (capacity - 1));
+    int8* old_control = control_;
+    Value* old_slots = slots_;
+    size_type old_capacity = capacity_;
+
+    // The control bytes and the slots share one allocation.
+    size_t control_size =
+        (capacity + kFlatHashGroupWidth + sizeof(Value) - 1) / sizeof(Value) *
+        sizeof(Value);
+    void* memory = malloc(control_size + capacity * sizeof(Value));
+    CHECK(memory);
+    control_ = static_cast<int8*>(memory);
+    slots_ = reinterpret_cast<Value*>(static_cast<char*>(memory) +
+                                      control_size);
+    capacity_ = capacity;
+    size_ = 0;
+    ResetControl();
+
+    for (size_type i = 0; i < old_capacity; ++i) {
+      if (old_control[i] < 0)
+        continue;
+      size_t index = PrepareInsert(Hash2(KeyOf()(old_slots[i])));
+      new (&slots_[index]) Value(old_slots[i]);
+      old_slots[i].~Value();
+    }
+    free(old_control);
+  }
+
+  void DestroyAll() {
+    for (size_type i = 0; i < capacity_; ++i) {
+      if (control_[i] >= 0)
+        slots_[i].~Value();
+    }
+    size_ = 0;
+  }
+
+  iterator MakeIterator(size_t index, bool skip_free_slots) {
+    iterator it(control_ + index, slots_ + index, control_ + capacity_);
+    if (skip_free_slots)
+      it.SkipFreeSlots();
+    return it;
+  }
+
+  int8* control_;
+  Value* slots_;
+  size_type capacity_;
+  size_type size_;
+
+  // The number of empty slots that can be filled before the table grows.
+  size_type growth_left_;
+
+  Hash hash_;
+  KeyEqual key_equal_;
+};
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_TABLE_H_
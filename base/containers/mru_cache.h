@@ -21,6 +21,7 @@
 #include <utility>
 
 #include "base/basictypes.h"
+#include "base/containers/flat_hash_map.h"
 #include "base/containers/hash_tables.h"
 #include "base/logging.h"
 
@@ -305,6 +306,38 @@ class HashingMRUCache : public MRUCacheBase<KeyType,
   DISALLOW_COPY_AND_ASSIGN(HashingMRUCache);
 };
 
+// FlatHashingMRUCache --------------------------------------------------------
+
+template <class KeyType, class ValueType>
+struct MRUCacheFlatHashMap {
+  typedef base::FlatHashMap<KeyType, ValueType> Type;
+};
+
+// This class is similar to HashingMRUCache, except that its index is a
+// base::FlatHashMap, which makes Get() and Peek() faster for small keys.
+template <class KeyType, class PayloadType>
+class FlatHashingMRUCache
+    : public MRUCacheBase<KeyType,
+                          PayloadType,
+                          MRUCacheNullDeletor<PayloadType>,
+                          MRUCacheFlatHashMap> {
+ private:
+  typedef MRUCacheBase<KeyType, PayloadType,
+                       MRUCacheNullDeletor<PayloadType>,
+                       MRUCacheFlatHashMap> ParentType;
+
+ public:
+  // See MRUCacheBase, noting the possibility of using NO_AUTO_EVICT.
+  explicit FlatHashingMRUCache(typename ParentType::size_type max_size)
+      : ParentType(max_size) {
+  }
+  virtual ~FlatHashingMRUCache() {
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(FlatHashingMRUCache);
+};
+
 }  // namespace base
 
 #endif  // BASE_CONTAINERS_MRU_CACHE_H_
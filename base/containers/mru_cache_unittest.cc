@@ -269,3 +269,23 @@ TEST(MRUCacheTest, HashingMRUCache) {
   EXPECT_EQ(two.value, cache.Get("Second")->second.value);
   EXPECT_TRUE(cache.Get("First") == cache.end());
 }
+
+TEST(MRUCacheTest, FlatHashingMRUCache) {
+  typedef base::FlatHashingMRUCache<int, CachedItem> Cache;
+  Cache cache(3);
+  for (int i = 0; i < 5; ++i)
+    cache.Put(i, CachedItem(i * 10));
+
+  // The two oldest items were evicted.
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_TRUE(cache.Peek(0) == cache.end());
+  EXPECT_TRUE(cache.Peek(1) == cache.end());
+  EXPECT_EQ(20, cache.Get(2)->second.value);
+
+  // 2 is the most recent now, so 3 goes next.
+  cache.Put(5, CachedItem(50));
+  EXPECT_TRUE(cache.Peek(3) == cache.end());
+  EXPECT_EQ(20, cache.Peek(2)->second.value);
+  EXPECT_EQ(40, cache.Peek(4)->second.value);
+  EXPECT_EQ(50, cache.Peek(5)->second.value);
+}
@@ -725,6 +725,26 @@
     INTERNAL_TRACE_EVENT_ADD_WITH_ID(TRACE_EVENT_PHASE_DELETE_OBJECT, \
         category_group, name, TRACE_ID_DONT_MANGLE(id), TRACE_EVENT_FLAG_NONE)
 
+// Records an instant event called "name" and takes a snapshot of the trace
+// buffer without stopping tracing; see TraceLog::TakeSnapshot(). Use it with
+// RECORD_CONTINUOUSLY to keep the trace leading up to a rare problem, e.g. a
+// frame that missed its deadline. If the category is not enabled, then this
+// does nothing.
+// - category and name strings must have application lifetime (statics or
+//   literals). They may not include " chars.
+#define TRACE_EVENT_SNAPSHOT_TRIGGER(category_group, name) \
+    do { \
+      INTERNAL_TRACE_EVENT_GET_CATEGORY_INFO(category_group); \
+      if (INTERNAL_TRACE_EVENT_CATEGORY_GROUP_ENABLED_FOR_RECORDING_MODE()) { \
+        trace_event_internal::AddTraceEvent( \
+            TRACE_EVENT_PHASE_INSTANT, \
+            INTERNAL_TRACE_EVENT_UID(category_group_enabled), name, \
+            trace_event_internal::kNoEventId, \
+            TRACE_EVENT_FLAG_NONE | TRACE_EVENT_SCOPE_PROCESS); \
+        TRACE_EVENT_API_TAKE_SNAPSHOT(); \
+      } \
+    } while (0)
+
 #define INTERNAL_TRACE_EVENT_CATEGORY_GROUP_ENABLED_FOR_RECORDING_MODE() \
     UNLIKELY(*INTERNAL_TRACE_EVENT_UID(category_group_enabled) & \
         (base::debug::TraceLog::ENABLED_FOR_RECORDING | \
@@ -817,6 +837,11 @@
 #define TRACE_EVENT_API_UPDATE_TRACE_EVENT_DURATION \
     base::debug::TraceLog::GetInstance()->UpdateTraceEventDuration
 
+// Take a snapshot of the trace buffer without stopping tracing.
+// bool TRACE_EVENT_API_TAKE_SNAPSHOT()
+#define TRACE_EVENT_API_TAKE_SNAPSHOT \
+    base::debug::TraceLog::GetInstance()->TakeSnapshot
+
 // Defines atomic operations used internally by the tracing system.
 #define TRACE_EVENT_API_ATOMIC_WORD base::subtle::AtomicWord
 #define TRACE_EVENT_API_ATOMIC_LOAD(var) base::subtle::NoBarrier_Load(&(var))
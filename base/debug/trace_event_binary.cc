@@ -0,0 +1,564 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/trace_event_binary.h"
+
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "base/debug/trace_event.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+const char kMagic[] = "TRBN";
+const size_t kMagicLength = 4;
+const unsigned char kVersion = 1;
+
+enum RecordType {
+  CHUNK_RECORD = 1,
+  EVENT_END_RECORD = 2,
+};
+
+// String tags. Tags from FIRST_INTERNED_STRING_ID on refer to the interned
+// string with id |tag - FIRST_INTERNED_STRING_ID|.
+enum StringTag {
+  INLINE_STRING = 0,
+  NEW_INTERNED_STRING = 1,
+  FIRST_INTERNED_STRING_ID = 2,
+};
+
+void AppendVarint(uint64 value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Zigzag-encodes |value| so that small negative numbers stay short.
+void AppendSignedVarint(int64 value, std::string* out) {
+  AppendVarint((static_cast<uint64>(value) << 1) ^
+                   static_cast<uint64>(value >> 63),
+               out);
+}
+
+void AppendByte(unsigned char value, std::string* out) {
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendStringData(const char* str, std::string* out) {
+  size_t length = strlen(str);
+  AppendVarint(length, out);
+  out->append(str, length);
+}
+
+void AppendInlineString(const char* str, std::string* out) {
+  AppendVarint(INLINE_STRING, out);
+  AppendStringData(str, out);
+}
+
+// Chunk sequence numbers are unique within a trace, so they and the index in
+// the chunk identify an event.
+uint64 MakeEventKey(uint64 chunk_seq, uint64 event_index) {
+  return (chunk_seq << 32) | event_index;
+}
+
+// A TraceEvent read back from a binary trace.
+struct DecodedEvent {
+  DecodedEvent()
+      : phase(0),
+        flags(0),
+        thread_id(0),
+        timestamp(0),
+        thread_timestamp(0),
+        duration(-1),
+        thread_duration(-1),
+        id(0),
+        num_args(0) {
+    memset(arg_types, 0, sizeof(arg_types));
+    memset(arg_values, 0, sizeof(arg_values));
+  }
+
+  char phase;
+  unsigned char flags;
+  int thread_id;
+  int64 timestamp;
+  int64 thread_timestamp;
+  int64 duration;
+  int64 thread_duration;
+  uint64 id;
+  std::string category;
+  std::string name;
+  int num_args;
+  std::string arg_names[kTraceMaxNumArgs];
+  unsigned char arg_types[kTraceMaxNumArgs];
+  TraceEvent::TraceValue arg_values[kTraceMaxNumArgs];
+  // Holds string and convertable argument values.
+  std::string arg_strings[kTraceMaxNumArgs];
+};
+
+class BinaryTraceReader {
+ public:
+  explicit BinaryTraceReader(const std::string& binary)
+      : data_(binary.data()),
+        end_(binary.data() + binary.size()),
+        last_timestamp_(0) {}
+
+  bool AtEnd() const { return data_ == end_; }
+
+  bool ReadHeader(int* process_id) {
+    if (static_cast<size_t>(end_ - data_) < kMagicLength ||
+        memcmp(data_, kMagic, kMagicLength) != 0) {
+      return false;
+    }
+    data_ += kMagicLength;
+    unsigned char version;
+    int64 pid;
+    if (!ReadByte(&version) || version != kVersion || !ReadSignedVarint(&pid))
+      return false;
+    *process_id = static_cast<int>(pid);
+    return true;
+  }
+
+  bool ReadByte(unsigned char* value) {
+    if (data_ == end_)
+      return false;
+    *value = static_cast<unsigned char>(*data_++);
+    return true;
+  }
+
+  bool ReadVarint(uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      unsigned char byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64* value) {
+    uint64 zigzag;
+    if (!ReadVarint(&zigzag))
+      return false;
+    *value = static_cast<int64>(zigzag >> 1) ^ -static_cast<int64>(zigzag & 1);
+    return true;
+  }
+
+  bool ReadStringData(std::string* str) {
+    uint64 length;
+    if (!ReadVarint(&length) || length > static_cast<uint64>(end_ - data_))
+      return false;
+    str->assign(data_, static_cast<size_t>(length));
+    data_ += length;
+    return true;
+  }
+
+  bool ReadString(std::string* str) {
+    uint64 tag;
+    if (!ReadVarint(&tag))
+      return false;
+    if (tag == INLINE_STRING)
+      return ReadStringData(str);
+    if (tag == NEW_INTERNED_STRING) {
+      if (!ReadStringData(str))
+        return false;
+      interned_strings_.push_back(*str);
+      return true;
+    }
+    uint64 id = tag - FIRST_INTERNED_STRING_ID;
+    if (id >= interned_strings_.size())
+      return false;
+    *str = interned_strings_[static_cast<size_t>(id)];
+    return true;
+  }
+
+  bool ReadEvent(DecodedEvent* event) {
+    unsigned char phase;
+    int64 thread_id;
+    int64 timestamp_delta;
+    if (!ReadByte(&phase) || !ReadByte(&event->flags) ||
+        !ReadSignedVarint(&thread_id) || !ReadSignedVarint(&timestamp_delta) ||
+        !ReadSignedVarint(&event->thread_timestamp)) {
+      return false;
+    }
+    event->phase = static_cast<char>(phase);
+    event->thread_id = static_cast<int>(thread_id);
+    last_timestamp_ += timestamp_delta;
+    event->timestamp = last_timestamp_;
+
+    if (event->phase == TRACE_EVENT_PHASE_COMPLETE &&
+        (!ReadSignedVarint(&event->duration) ||
+         !ReadSignedVarint(&event->thread_duration))) {
+      return false;
+    }
+    if ((event->flags & TRACE_EVENT_FLAG_HAS_ID) && !ReadVarint(&event->id))
+      return false;
+
+    unsigned char num_args;
+    if (!ReadString(&event->category) || !ReadString(&event->name) ||
+        !ReadByte(&num_args) || num_args > kTraceMaxNumArgs) {
+      return false;
+    }
+    event->num_args = num_args;
+    for (int i = 0; i < event->num_args; ++i) {
+      if (!ReadString(&event->arg_names[i]) ||
+          !ReadByte(&event->arg_types[i]) ||
+          !ReadArgValue(event->arg_types[i], &event->arg_values[i],
+                        &event->arg_strings[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  bool ReadArgValue(unsigned char type,
+                    TraceEvent::TraceValue* value,
+                    std::string* str) {
+    switch (type) {
+      case TRACE_VALUE_TYPE_BOOL: {
+        unsigned char as_bool;
+        if (!ReadByte(&as_bool))
+          return false;
+        value->as_bool = as_bool != 0;
+        return true;
+      }
+      case TRACE_VALUE_TYPE_UINT: {
+        uint64 as_uint;
+        if (!ReadVarint(&as_uint))
+          return false;
+        value->as_uint = as_uint;
+        return true;
+      }
+      case TRACE_VALUE_TYPE_INT: {
+        int64 as_int;
+        if (!ReadSignedVarint(&as_int))
+          return false;
+        value->as_int = as_int;
+        return true;
+      }
+      case TRACE_VALUE_TYPE_DOUBLE:
+        if (static_cast<size_t>(end_ - data_) < sizeof(value->as_double))
+          return false;
+        memcpy(&value->as_double, data_, sizeof(value->as_double));
+        data_ += sizeof(value->as_double);
+        return true;
+      case TRACE_VALUE_TYPE_POINTER: {
+        uint64 as_pointer;
+        if (!ReadVarint(&as_pointer))
+          return false;
+        value->as_pointer =
+            reinterpret_cast<const void*>(static_cast<uintptr_t>(as_pointer));
+        return true;
+      }
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING:
+      case TRACE_VALUE_TYPE_CONVERTABLE:
+        return ReadString(str);
+    }
+    return false;
+  }
+
+  const char* data_;
+  const char* const end_;
+  int64 last_timestamp_;
+  std::vector<std::string> interned_strings_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryTraceReader);
+};
+
+// Matches TraceEvent::AppendAsJSON().
+void AppendDecodedEventAsJSON(const DecodedEvent& event,
+                              int process_id,
+                              std::string* out) {
+  StringAppendF(out,
+      "{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ","
+      "\"ph\":\"%c\",\"name\":\"%s\",\"args\":{",
+      event.category.c_str(),
+      process_id,
+      event.thread_id,
+      event.timestamp,
+      event.phase,
+      event.name.c_str());
+
+  for (int i = 0; i < event.num_args; ++i) {
+    if (i > 0)
+      *out += ",";
+    *out += "\"";
+    *out += event.arg_names[i];
+    *out += "\":";
+
+    unsigned char type = event.arg_types[i];
+    if (type == TRACE_VALUE_TYPE_CONVERTABLE) {
+      *out += event.arg_strings[i];
+    } else {
+      TraceEvent::TraceValue value = event.arg_values[i];
+      if (type == TRACE_VALUE_TYPE_STRING ||
+          type == TRACE_VALUE_TYPE_COPY_STRING) {
+        value.as_string = event.arg_strings[i].c_str();
+      }
+      TraceEvent::AppendValueAsJSON(type, value, out);
+    }
+  }
+  *out += "}";
+
+  if (event.phase == TRACE_EVENT_PHASE_COMPLETE) {
+    if (event.duration != -1)
+      StringAppendF(out, ",\"dur\":%" PRId64, event.duration);
+    if (event.thread_timestamp && event.thread_duration != -1)
+      StringAppendF(out, ",\"tdur\":%" PRId64, event.thread_duration);
+  }
+
+  if (event.thread_timestamp)
+    StringAppendF(out, ",\"tts\":%" PRId64, event.thread_timestamp);
+
+  if (event.flags & TRACE_EVENT_FLAG_HAS_ID)
+    StringAppendF(out, ",\"id\":\"0x%" PRIx64 "\"", event.id);
+
+  if (event.phase == TRACE_EVENT_PHASE_INSTANT) {
+    char scope = '?';
+    switch (event.flags & TRACE_EVENT_FLAG_SCOPE_MASK) {
+      case TRACE_EVENT_SCOPE_GLOBAL:
+        scope = TRACE_EVENT_SCOPE_NAME_GLOBAL;
+        break;
+
+      case TRACE_EVENT_SCOPE_PROCESS:
+        scope = TRACE_EVENT_SCOPE_NAME_PROCESS;
+        break;
+
+      case TRACE_EVENT_SCOPE_THREAD:
+        scope = TRACE_EVENT_SCOPE_NAME_THREAD;
+        break;
+    }
+    StringAppendF(out, ",\"s\":\"%c\"", scope);
+  }
+
+  *out += "}";
+}
+
+}  // namespace
+
+TraceEventBinaryWriter::TraceEventBinaryWriter(int process_id)
+    : process_id_(process_id),
+      header_written_(false),
+      last_timestamp_(0) {
+}
+
+TraceEventBinaryWriter::~TraceEventBinaryWriter() {
+}
+
+void TraceEventBinaryWriter::AppendChunk(const TraceBufferChunk& chunk,
+                                         std::string* out) {
+  AppendHeaderIfNeeded(out);
+  AppendByte(CHUNK_RECORD, out);
+  AppendVarint(chunk.seq(), out);
+  AppendVarint(chunk.size(), out);
+  for (size_t i = 0; i < chunk.size(); ++i)
+    AppendEvent(*chunk.GetEventAt(i), out);
+}
+
+void TraceEventBinaryWriter::AppendEventEnd(TraceEventHandle handle,
+                                            const TimeTicks& now,
+                                            const TimeTicks& thread_now,
+                                            std::string* out) {
+  AppendHeaderIfNeeded(out);
+  AppendByte(EVENT_END_RECORD, out);
+  AppendVarint(handle.chunk_seq, out);
+  AppendVarint(handle.event_index, out);
+  AppendSignedVarint(now.ToInternalValue(), out);
+  AppendSignedVarint(thread_now.ToInternalValue(), out);
+}
+
+void TraceEventBinaryWriter::AppendHeaderIfNeeded(std::string* out) {
+  if (header_written_)
+    return;
+  header_written_ = true;
+  out->append(kMagic, kMagicLength);
+  AppendByte(kVersion, out);
+  AppendSignedVarint(process_id_, out);
+}
+
+void TraceEventBinaryWriter::AppendEvent(const TraceEvent& trace_event,
+                                         std::string* out) {
+  bool copy = (trace_event.flags() & TRACE_EVENT_FLAG_COPY) != 0;
+
+  AppendByte(static_cast<unsigned char>(trace_event.phase()), out);
+  AppendByte(trace_event.flags(), out);
+  AppendSignedVarint(trace_event.thread_id(), out);
+  int64 timestamp = trace_event.timestamp().ToInternalValue();
+  AppendSignedVarint(timestamp - last_timestamp_, out);
+  last_timestamp_ = timestamp;
+  AppendSignedVarint(trace_event.thread_timestamp().ToInternalValue(), out);
+
+  if (trace_event.phase() == TRACE_EVENT_PHASE_COMPLETE) {
+    AppendSignedVarint(trace_event.duration().ToInternalValue(), out);
+    AppendSignedVarint(trace_event.thread_duration().ToInternalValue(), out);
+  }
+  if (trace_event.flags() & TRACE_EVENT_FLAG_HAS_ID)
+    AppendVarint(trace_event.id(), out);
+
+  AppendInternedString(
+      TraceLog::GetCategoryGroupName(trace_event.category_group_enabled()),
+      out);
+  if (copy)
+    AppendInlineString(trace_event.name(), out);
+  else
+    AppendInternedString(trace_event.name(), out);
+
+  int num_args = 0;
+  while (num_args < kTraceMaxNumArgs && trace_event.arg_names_[num_args])
+    ++num_args;
+  AppendByte(static_cast<unsigned char>(num_args), out);
+
+  for (int i = 0; i < num_args; ++i) {
+    if (copy)
+      AppendInlineString(trace_event.arg_names_[i], out);
+    else
+      AppendInternedString(trace_event.arg_names_[i], out);
+
+    unsigned char type = trace_event.arg_types_[i];
+    const TraceEvent::TraceValue& value = trace_event.arg_values_[i];
+    AppendByte(type, out);
+    switch (type) {
+      case TRACE_VALUE_TYPE_BOOL:
+        AppendByte(value.as_bool ? 1 : 0, out);
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        AppendVarint(value.as_uint, out);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        AppendSignedVarint(value.as_int, out);
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        out->append(reinterpret_cast<const char*>(&value.as_double),
+                    sizeof(value.as_double));
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        AppendVarint(reinterpret_cast<uintptr_t>(value.as_pointer), out);
+        break;
+      case TRACE_VALUE_TYPE_STRING:
+        if (value.as_string)
+          AppendInternedString(value.as_string, out);
+        else
+          AppendInlineString("NULL", out);
+        break;
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        AppendInlineString(value.as_string ? value.as_string : "NULL", out);
+        break;
+      case TRACE_VALUE_TYPE_CONVERTABLE: {
+        std::string json;
+        trace_event.convertable_values_[i]->AppendAsTraceFormat(&json);
+        AppendVarint(INLINE_STRING, out);
+        AppendVarint(json.size(), out);
+        out->append(json);
+        break;
+      }
+      default:
+        NOTREACHED() << "Don't know how to write this value";
+        break;
+    }
+  }
+}
+
+void TraceEventBinaryWriter::AppendInternedString(const char* str,
+                                                  std::string* out) {
+  hash_map<const char*, uint32>::const_iterator it =
+      interned_strings_.find(str);
+  if (it != interned_strings_.end()) {
+    AppendVarint(FIRST_INTERNED_STRING_ID + it->second, out);
+    return;
+  }
+  uint32 id = static_cast<uint32>(interned_strings_.size());
+  interned_strings_[str] = id;
+  AppendVarint(NEW_INTERNED_STRING, out);
+  AppendStringData(str, out);
+}
+
+bool ConvertBinaryTraceToJSON(const std::string& binary, std::string* json) {
+  BinaryTraceReader reader(binary);
+  if (binary.empty())
+    return true;
+  int process_id;
+  if (!reader.ReadHeader(&process_id))
+    return false;
+
+  // Events are held until the end so that end records, which come after the
+  // events they finish, can fill in durations.
+  std::vector<DecodedEvent> events;
+  std::map<uint64, size_t> unfinished_events;
+  bool success = true;
+  while (success && !reader.AtEnd()) {
+    unsigned char record_type;
+    if (!reader.ReadByte(&record_type)) {
+      success = false;
+      break;
+    }
+
+    if (record_type == CHUNK_RECORD) {
+      uint64 chunk_seq;
+      uint64 num_events;
+      if (!reader.ReadVarint(&chunk_seq) || !reader.ReadVarint(&num_events)) {
+        success = false;
+        break;
+      }
+      for (uint64 i = 0; i < num_events; ++i) {
+        events.push_back(DecodedEvent());
+        if (!reader.ReadEvent(&events.back())) {
+          events.pop_back();
+          success = false;
+          break;
+        }
+        if (events.back().phase == TRACE_EVENT_PHASE_COMPLETE &&
+            events.back().duration == -1) {
+          unfinished_events[MakeEventKey(chunk_seq, i)] = events.size() - 1;
+        }
+      }
+    } else if (record_type == EVENT_END_RECORD) {
+      uint64 chunk_seq;
+      uint64 event_index;
+      int64 now;
+      int64 thread_now;
+      if (!reader.ReadVarint(&chunk_seq) || !reader.ReadVarint(&event_index) ||
+          !reader.ReadSignedVarint(&now) ||
+          !reader.ReadSignedVarint(&thread_now)) {
+        success = false;
+        break;
+      }
+      // Ignore ends of events that weren't written, e.g. ones that began
+      // before tracing was restarted.
+      std::map<uint64, size_t>::iterator it =
+          unfinished_events.find(MakeEventKey(chunk_seq, event_index));
+      if (it != unfinished_events.end()) {
+        DecodedEvent& event = events[it->second];
+        event.duration = now - event.timestamp;
+        event.thread_duration = thread_now - event.thread_timestamp;
+        unfinished_events.erase(it);
+      }
+    } else {
+      success = false;
+    }
+  }
+
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (i > 0)
+      json->append(",");
+    AppendDecodedEventAsJSON(events[i], process_id, json);
+  }
+  return success;
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,79 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A compact binary encoding of trace events, for writing long traces out while
+// they are recorded instead of holding them as TraceEvents until Flush().
+//
+// A binary trace is a header followed by records. Each chunk record holds the
+// sequence number of a TraceBufferChunk and then its events in order.
+// Timestamps are varint deltas from the previous event. Category and event
+// names, argument names and static string values are interned by pointer: the
+// first time a string is seen its characters are written and it is given the
+// next id, after which only the id is written. Strings that were copied into
+// the event (TRACE_EVENT_FLAG_COPY, TRACE_STR_COPY) are always written out.
+// End records give the end time of a COMPLETE event that was written out
+// before it ended.
+//
+// The encoding uses the byte order of the machine that wrote it, so traces
+// should be converted on the same kind of machine.
+
+#ifndef BASE_DEBUG_TRACE_EVENT_BINARY_H_
+#define BASE_DEBUG_TRACE_EVENT_BINARY_H_
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/debug/trace_event_impl.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace debug {
+
+class BASE_EXPORT TraceEventBinaryWriter {
+ public:
+  // |process_id| is written to the header, to be output with every event.
+  explicit TraceEventBinaryWriter(int process_id);
+  ~TraceEventBinaryWriter();
+
+  // Appends the events in |chunk| to |out|. The header is written before the
+  // first chunk.
+  void AppendChunk(const TraceBufferChunk& chunk, std::string* out);
+
+  // Appends a record that the COMPLETE event at |handle| ended at |now| and
+  // |thread_now|, for events whose chunk has already been written.
+  void AppendEventEnd(TraceEventHandle handle,
+                      const TimeTicks& now,
+                      const TimeTicks& thread_now,
+                      std::string* out);
+
+ private:
+  void AppendHeaderIfNeeded(std::string* out);
+  void AppendEvent(const TraceEvent& trace_event, std::string* out);
+
+  // Appends |str|, which lives as long as the process, as an interned string.
+  void AppendInternedString(const char* str, std::string* out);
+
+  int process_id_;
+  bool header_written_;
+  int64 last_timestamp_;
+
+  // Ids of the strings written so far, by address.
+  hash_map<const char*, uint32> interned_strings_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceEventBinaryWriter);
+};
+
+// Converts |binary|, written by TraceEventBinaryWriter, to the comma-separated
+// JSON events that TraceLog::Flush() outputs, and appends them to |json|.
+// Returns false if |binary| is malformed; |json| then holds the events that
+// could be read before the error.
+BASE_EXPORT bool ConvertBinaryTraceToJSON(const std::string& binary,
+                                          std::string* json);
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_TRACE_EVENT_BINARY_H_
@@ -11,6 +11,7 @@
 #include "base/command_line.h"
 #include "base/debug/leak_annotations.h"
 #include "base/debug/trace_event.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/debug/trace_event_synthetic_delay.h"
 #include "base/float_util.h"
 #include "base/format_macros.h"
@@ -34,6 +35,10 @@
 #include "base/threading/thread_id_name_manager.h"
 #include "base/time/time.h"
 
+#if !defined(OS_NACL)
+#include "base/file_util.h"
+#endif
+
 #if defined(OS_WIN)
 #include "base/debug/trace_event_win.h"
 #endif
@@ -63,11 +68,20 @@ const int kOverheadReportThresholdInMicroseconds = 50;
 const size_t kTraceBufferChunkSize = TraceBufferChunk::kTraceBufferChunkSize;
 const size_t kTraceEventVectorBufferChunks = 256000 / kTraceBufferChunkSize;
 const size_t kTraceEventRingBufferChunks = kTraceEventVectorBufferChunks / 4;
+// Bounds for SetContinuousTraceBufferSize(). There must be many more chunks
+// than threads, and chunk indices have to fit in a TraceEventHandle.
+const size_t kMinTraceEventRingBufferChunks = 64;
+const size_t kMaxTraceEventRingBufferChunks = (1u << 16) - 1;
 const size_t kTraceEventBatchChunks = 1000 / kTraceBufferChunkSize;
 // Can store results for 30 seconds with 1 ms sampling interval.
 const size_t kMonitorTraceEventBufferChunks = 30000 / kTraceBufferChunkSize;
 // ECHO_TO_CONSOLE needs a small buffer to hold the unfinished COMPLETE events.
 const size_t kEchoToConsoleTraceEventBufferChunks = 256;
+// When streaming, chunks stay in memory for a while after they are filled so
+// that most COMPLETE events have ended by the time they are written.
+const size_t kStreamingTraceEventBufferChunks = 256;
+// Bytes of encoded events to collect before writing them to the file.
+const size_t kStreamingWriteSize = 64 * 1024;
 
 const int kThreadFlushTimeoutMs = 3000;
 
@@ -141,10 +155,12 @@ class TraceBufferRingBuffer : public TraceBuffer {
 
     TraceBufferChunk* chunk = chunks_[*index];
     chunks_[*index] = NULL;  // Put NULL in the slot of a in-flight chunk.
-    if (chunk)
+    if (chunk) {
+      WillReuseChunk(*index, *chunk);
       chunk->Reset(current_chunk_seq_++);
-    else
+    } else {
       chunk = new TraceBufferChunk(current_chunk_seq_++);
+    }
 
     return scoped_ptr<TraceBufferChunk>(chunk);
   }
@@ -212,6 +228,11 @@ class TraceBufferRingBuffer : public TraceBuffer {
     return cloned_buffer.PassAs<TraceBuffer>();
   }
 
+ protected:
+  // Called before the events in |chunk|, the oldest returned chunk, are
+  // overwritten.
+  virtual void WillReuseChunk(size_t index, const TraceBufferChunk& chunk) {}
+
  private:
   class ClonedTraceBuffer : public TraceBuffer {
    public:
@@ -284,6 +305,80 @@ class TraceBufferRingBuffer : public TraceBuffer {
   DISALLOW_COPY_AND_ASSIGN(TraceBufferRingBuffer);
 };
 
+#if !defined(OS_NACL)  // NaCl can't write files.
+// Writes each chunk to a file in the binary trace format before its slot in
+// the ring buffer is reused, so that the trace can be any length while only
+// the most recent chunks are kept in memory.
+class TraceBufferStreaming : public TraceBufferRingBuffer {
+ public:
+  TraceBufferStreaming(const FilePath& path, int process_id)
+      : TraceBufferRingBuffer(kStreamingTraceEventBufferChunks),
+        path_(path),
+        writer_(process_id),
+        write_failed_(false) {
+  }
+
+  // Stop recording if the file can't be written, rather than drop events.
+  virtual bool IsFull() const OVERRIDE {
+    return write_failed_;
+  }
+
+  virtual void UpdateRemovedEventDuration(TraceEventHandle handle,
+                                          const TimeTicks& now,
+                                          const TimeTicks& thread_now)
+      OVERRIDE {
+    writer_.AppendEventEnd(handle, now, thread_now, &pending_output_);
+  }
+
+  // Writes out the chunks that are still in memory instead of returning
+  // them, because everything else has gone to the file.
+  virtual const TraceBufferChunk* NextChunk() OVERRIDE {
+    while (const TraceBufferChunk* chunk =
+               TraceBufferRingBuffer::NextChunk()) {
+      writer_.AppendChunk(*chunk, &pending_output_);
+      if (pending_output_.size() >= kStreamingWriteSize)
+        Write();
+    }
+    Write();
+    if (file_)
+      fflush(file_.get());
+    return NULL;
+  }
+
+ protected:
+  virtual void WillReuseChunk(size_t index,
+                              const TraceBufferChunk& chunk) OVERRIDE {
+    writer_.AppendChunk(chunk, &pending_output_);
+    if (pending_output_.size() >= kStreamingWriteSize)
+      Write();
+  }
+
+ private:
+  void Write() {
+    if (write_failed_)
+      return;
+    // Opened on first use, so that the buffers created when tracing is reset
+    // don't truncate the file.
+    if (!file_)
+      file_.reset(OpenFile(path_, "wb"));
+    write_failed_ = !file_ ||
+        fwrite(pending_output_.data(), 1, pending_output_.size(),
+               file_.get()) != pending_output_.size();
+    if (write_failed_)
+      DLOG(ERROR) << "Failed to write trace events to " << path_.value();
+    pending_output_.clear();
+  }
+
+  FilePath path_;
+  file_util::ScopedFILE file_;
+  TraceEventBinaryWriter writer_;
+  std::string pending_output_;
+  bool write_failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBufferStreaming);
+};
+#endif  // !defined(OS_NACL)
+
 class TraceBufferVector : public TraceBuffer {
  public:
   TraceBufferVector()
@@ -990,12 +1085,13 @@ class TraceLog::ThreadLocalEventBuffer
 
   int generation() const { return generation_; }
 
+  // Returns the chunk being filled, if any, to the main buffer.
+  void FlushWhileLocked();
+
  private:
   // MessageLoop::DestructionObserver
   virtual void WillDestroyCurrentMessageLoop() OVERRIDE;
 
-  void FlushWhileLocked();
-
   void CheckThisIsCurrentBuffer() const {
     DCHECK(trace_log_->thread_local_event_buffer_.Get() == this);
   }
@@ -1118,6 +1214,8 @@ void TraceLog::ThreadLocalEventBuffer::FlushWhileLocked() {
   // find the generation mismatch and delete this buffer soon.
 }
 
+const int TraceLog::kMinTimeBetweenSnapshotsMs = 10000;
+
 // static
 TraceLog* TraceLog::GetInstance() {
   return Singleton<TraceLog, LeakySingletonTraits<TraceLog> >::get();
@@ -1137,6 +1235,7 @@ TraceLog::TraceLog()
       category_filter_(CategoryFilter::kDefaultCategoryFilterString),
       event_callback_category_filter_(
           CategoryFilter::kDefaultCategoryFilterString),
+      continuous_buffer_chunks_(kTraceEventRingBufferChunks),
       thread_shared_chunk_index_(0),
       generation_(0) {
   // Trace is enabled or disabled on one thread while other threads are
@@ -1384,6 +1483,14 @@ void TraceLog::SetEnabled(const CategoryFilter& category_filter,
   }
 }
 
+void TraceLog::SetStreamingFile(const FilePath& path) {
+  AutoLock lock(lock_);
+  DCHECK(!IsEnabled());
+  DCHECK(!flush_message_loop_proxy_.get());
+  streaming_file_path_ = path;
+  UseNextTraceBuffer();
+}
+
 CategoryFilter TraceLog::GetCurrentCategoryFilter() {
   AutoLock lock(lock_);
   return category_filter_;
@@ -1479,8 +1586,12 @@ bool TraceLog::BufferIsFull() const {
 
 TraceBuffer* TraceLog::CreateTraceBuffer() {
   Options options = trace_options();
+#if !defined(OS_NACL)
+  if (!streaming_file_path_.empty())
+    return new TraceBufferStreaming(streaming_file_path_, process_id_);
+#endif
   if (options & RECORD_CONTINUOUSLY)
-    return new TraceBufferRingBuffer(kTraceEventRingBufferChunks);
+    return new TraceBufferRingBuffer(continuous_buffer_chunks_);
   else if ((options & ENABLE_SAMPLING) && mode_ == MONITORING_MODE)
     return new TraceBufferRingBuffer(kMonitorTraceEventBufferChunks);
   else if (options & ECHO_TO_CONSOLE)
@@ -1708,6 +1819,71 @@ void TraceLog::FlushButLeaveBufferIntact(
                                   flush_output_callback);
 }
 
+void TraceLog::SetSnapshotCallback(
+    const scoped_refptr<MessageLoopProxy>& message_loop_proxy,
+    const OutputCallback& callback) {
+  AutoLock lock(lock_);
+  DCHECK(callback.is_null() || message_loop_proxy.get());
+  snapshot_message_loop_proxy_ = message_loop_proxy;
+  snapshot_callback_ = callback;
+}
+
+bool TraceLog::TakeSnapshot() {
+  scoped_ptr<TraceBuffer> snapshot;
+  scoped_refptr<MessageLoopProxy> message_loop_proxy;
+  OutputCallback callback;
+  {
+    AutoLock lock(lock_);
+    if (mode_ != RECORDING_MODE || !(trace_options() & RECORD_CONTINUOUSLY) ||
+        snapshot_callback_.is_null()) {
+      return false;
+    }
+    // Snapshots are expensive, and a trigger that fires in a loop shouldn't
+    // bog the process down.
+    TimeTicks now = TimeTicks::Now();
+    if (!last_snapshot_time_.is_null() &&
+        now - last_snapshot_time_ <
+            TimeDelta::FromMilliseconds(kMinTimeBetweenSnapshotsMs)) {
+      return false;
+    }
+    last_snapshot_time_ = now;
+
+    // The caller's recent events may still be in its thread-local buffer.
+    if (thread_local_event_buffer_.Get())
+      thread_local_event_buffer_.Get()->FlushWhileLocked();
+    AddMetadataEventsWhileLocked();
+    if (thread_shared_chunk_) {
+      logged_events_->ReturnChunk(thread_shared_chunk_index_,
+                                  thread_shared_chunk_.Pass());
+    }
+    snapshot = logged_events_->CloneForIteration().Pass();
+    message_loop_proxy = snapshot_message_loop_proxy_;
+    callback = snapshot_callback_;
+  }
+
+  // Convert on the callback's thread; the caller may be in a hurry.
+  message_loop_proxy->PostTask(
+      FROM_HERE,
+      Bind(&TraceLog::ConvertTraceEventsToTraceFormat, Unretained(this),
+           Passed(&snapshot), callback));
+  return true;
+}
+
+void TraceLog::SetContinuousTraceBufferSize(size_t max_bytes) {
+  AutoLock lock(lock_);
+  DCHECK(!IsEnabled());
+  DCHECK(!flush_message_loop_proxy_.get());
+  if (!max_bytes) {
+    continuous_buffer_chunks_ = kTraceEventRingBufferChunks;
+  } else {
+    continuous_buffer_chunks_ = std::min(
+        std::max(max_bytes / sizeof(TraceBufferChunk),
+                 kMinTraceEventRingBufferChunks),
+        kMaxTraceEventRingBufferChunks);
+  }
+  UseNextTraceBuffer();
+}
+
 void TraceLog::UseNextTraceBuffer() {
   logged_events_.reset(CreateTraceBuffer());
   subtle::NoBarrier_AtomicIncrement(&generation_, 1);
@@ -1989,6 +2165,9 @@ void TraceLog::UpdateTraceEventDuration(
 #if defined(OS_ANDROID)
       trace_event->SendToATrace();
 #endif
+    } else if (handle.chunk_seq) {
+      lock.EnsureAcquired();
+      logged_events_->UpdateRemovedEventDuration(handle, now, thread_now);
     }
 
     if (trace_options() & ECHO_TO_CONSOLE) {
@@ -13,6 +13,7 @@
 #include "base/atomicops.h"
 #include "base/callback.h"
 #include "base/containers/hash_tables.h"
+#include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_vector.h"
@@ -176,6 +177,8 @@ class BASE_EXPORT TraceEvent {
   unsigned char flags_;
   unsigned char arg_types_[kTraceMaxNumArgs];
 
+  friend class TraceEventBinaryWriter;
+
   DISALLOW_COPY_AND_ASSIGN(TraceEvent);
 };
 
@@ -228,6 +231,13 @@ class BASE_EXPORT TraceBuffer {
   virtual size_t Capacity() const = 0;
   virtual TraceEvent* GetEventByHandle(TraceEventHandle handle) = 0;
 
+  // Called when the COMPLETE event at |handle| ends after GetEventByHandle()
+  // has stopped finding it. Buffers that have written the event out record
+  // its end here; the others drop it.
+  virtual void UpdateRemovedEventDuration(TraceEventHandle handle,
+                                          const TimeTicks& now,
+                                          const TimeTicks& thread_now) {}
+
   // For iteration. Each TraceBuffer can only be iterated once.
   virtual const TraceBufferChunk* NextChunk() = 0;
 
@@ -423,6 +433,14 @@ class BASE_EXPORT TraceLog {
   // Disables normal tracing for all categories.
   void SetDisabled();
 
+  // Makes the traces recorded from now on be written to |path| in the binary
+  // format of trace_event_binary.h while they are collected, instead of being
+  // held in memory until Flush(). Flush() then finishes the file and passes
+  // no events to its callback; use ConvertBinaryTraceToJSON() to read it. An
+  // empty |path| goes back to buffering in memory. Events that haven't been
+  // flushed are discarded. Must not be called while tracing is enabled.
+  void SetStreamingFile(const FilePath& path);
+
   bool IsEnabled() { return mode_ != DISABLED; }
 
   // The number of times we have begun recording traces. If tracing is off,
@@ -497,6 +515,31 @@ class BASE_EXPORT TraceLog {
   void Flush(const OutputCallback& cb);
   void FlushButLeaveBufferIntact(const OutputCallback& flush_output_callback);
 
+  // Sets where TakeSnapshot() sends snapshots: |callback| is run on
+  // |message_loop_proxy| with the snapshot's events, in the same way as by
+  // Flush(). A null |callback| turns snapshots off.
+  void SetSnapshotCallback(
+      const scoped_refptr<MessageLoopProxy>& message_loop_proxy,
+      const OutputCallback& callback);
+
+  // Copies the events in the trace buffer and passes them to the snapshot
+  // callback, without stopping tracing. Meant for recording continuously and
+  // keeping the events that led up to something going wrong, e.g. through
+  // TRACE_EVENT_SNAPSHOT_TRIGGER. Events still in the thread-local buffers of
+  // threads other than the caller's aren't included. Returns false, doing
+  // nothing, if tracing isn't recording continuously, there is no snapshot
+  // callback, or the last snapshot was taken less than
+  // kMinTimeBetweenSnapshotsMs ago.
+  bool TakeSnapshot();
+
+  // Limits the trace buffer used when recording continuously to about
+  // |max_bytes|, not counting copied strings and convertable arguments. 0
+  // restores the default. Events that haven't been flushed are discarded.
+  // Must not be called while tracing is enabled.
+  void SetContinuousTraceBufferSize(size_t max_bytes);
+
+  static const int kMinTimeBetweenSnapshotsMs;
+
   // Called by TRACE_EVENT* macros, don't call this directly.
   // The name parameter is a category group for example:
   // TRACE_EVENT0("renderer,webkit", "WebViewImpl::HandleInputEvent")
@@ -604,6 +647,8 @@ class BASE_EXPORT TraceLog {
                            TraceBufferRingBufferHalfIteration);
   FRIEND_TEST_ALL_PREFIXES(TraceEventTestFixture,
                            TraceBufferRingBufferFullIteration);
+  FRIEND_TEST_ALL_PREFIXES(TraceEventTestFixture,
+                           ContinuousTraceBufferSize);
 
   // This allows constructor and destructor to be private and usable only
   // by the Singleton class.
@@ -705,6 +750,17 @@ class BASE_EXPORT TraceLog {
 
   subtle::AtomicWord /* Options */ trace_options_;
 
+  // Where events are streamed to, if set by SetStreamingFile().
+  FilePath streaming_file_path_;
+
+  // The number of chunks in the buffer when recording continuously.
+  size_t continuous_buffer_chunks_;
+
+  // Set by SetSnapshotCallback().
+  scoped_refptr<MessageLoopProxy> snapshot_message_loop_proxy_;
+  OutputCallback snapshot_callback_;
+  TimeTicks last_snapshot_time_;
+
   // Sampling thread handles.
   scoped_ptr<TraceSamplingThread> sampling_thread_;
   PlatformThreadHandle sampling_thread_handle_;
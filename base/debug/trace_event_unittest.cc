@@ -10,7 +10,10 @@
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
+#include "base/debug/trace_event_binary.h"
 #include "base/debug/trace_event_synthetic_delay.h"
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/memory/ref_counted_memory.h"
@@ -2461,6 +2464,120 @@ TEST_F(TraceEventTestFixture, TraceBufferRingBufferFullIteration) {
   TraceLog::GetInstance()->SetDisabled();
 }
 
+TEST_F(TraceEventTestFixture, ContinuousTraceBufferSize) {
+  TraceLog* trace_log = TraceLog::GetInstance();
+  trace_log->SetContinuousTraceBufferSize(100 * sizeof(TraceBufferChunk));
+  trace_log->SetEnabled(CategoryFilter("*"),
+                        base::debug::TraceLog::RECORDING_MODE,
+                        TraceLog::RECORD_CONTINUOUSLY);
+  EXPECT_EQ(100 * TraceBufferChunk::kTraceBufferChunkSize,
+            trace_log->trace_buffer()->Capacity());
+  trace_log->SetDisabled();
+
+  trace_log->SetContinuousTraceBufferSize(0);
+  trace_log->SetEnabled(CategoryFilter("*"),
+                        base::debug::TraceLog::RECORDING_MODE,
+                        TraceLog::RECORD_CONTINUOUSLY);
+  EXPECT_LT(100 * TraceBufferChunk::kTraceBufferChunkSize,
+            trace_log->trace_buffer()->Capacity());
+  trace_log->SetDisabled();
+}
+
+TEST_F(TraceEventTestFixture, SnapshotTrigger) {
+  Thread snapshot_thread("snapshot");
+  ASSERT_TRUE(snapshot_thread.Start());
+  WaitableEvent snapshot_complete_event(false, false);
+  TraceLog* trace_log = TraceLog::GetInstance();
+  trace_log->SetSnapshotCallback(
+      snapshot_thread.message_loop_proxy(),
+      Bind(&TraceEventTestFixture::OnTraceDataCollected, Unretained(this),
+           Unretained(&snapshot_complete_event)));
+
+  // Snapshots are only taken while recording continuously.
+  BeginTrace();
+  EXPECT_FALSE(trace_log->TakeSnapshot());
+  trace_log->SetDisabled();
+
+  trace_log->SetEnabled(CategoryFilter("*"),
+                        base::debug::TraceLog::RECORDING_MODE,
+                        TraceLog::RECORD_CONTINUOUSLY);
+  TRACE_EVENT_INSTANT0("all", "before trigger", TRACE_EVENT_SCOPE_THREAD);
+  TRACE_EVENT_SNAPSHOT_TRIGGER("all", "trigger");
+  snapshot_complete_event.Wait();
+
+  EXPECT_TRUE(trace_log->IsEnabled());
+  EXPECT_TRUE(FindTraceEntry(trace_parsed_, "before trigger"));
+  EXPECT_TRUE(FindNamePhase("trigger", "I"));
+
+  // Another trigger right away doesn't take a snapshot.
+  EXPECT_FALSE(trace_log->TakeSnapshot());
+  trace_log->SetDisabled();
+  trace_log->SetSnapshotCallback(NULL, TraceLog::OutputCallback());
+}
+
+TEST_F(TraceEventTestFixture, StreamingToFile) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("trace");
+  TraceLog::GetInstance()->SetStreamingFile(path);
+
+  // Enough events that the chunk holding "outer" is written out before the
+  // event ends.
+  const int kNumEvents = 50000;
+  BeginTrace();
+  {
+    TRACE_EVENT0("all", "outer");
+    for (int i = 0; i < kNumEvents; ++i) {
+      TRACE_EVENT_INSTANT2("all", "instant", TRACE_EVENT_SCOPE_THREAD,
+                           "int", i, "string", "value");
+    }
+    std::string copied_name("copied name");
+    TRACE_EVENT_COPY_INSTANT1("all", copied_name.c_str(),
+                              TRACE_EVENT_SCOPE_THREAD, "double", 0.5);
+  }
+  EndTraceAndFlush();
+
+  // The events went to the file, not to Flush().
+  EXPECT_EQ(0u, trace_parsed_.GetSize());
+
+  std::string binary;
+  ASSERT_TRUE(ReadFileToString(path, &binary));
+  std::string json("[");
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(binary, &json));
+  json += "]";
+  scoped_ptr<Value> root(JSONReader::Read(json));
+  ListValue* events = NULL;
+  ASSERT_TRUE(root.get());
+  ASSERT_TRUE(root->GetAsList(&events));
+
+  std::vector<const DictionaryValue*> instants =
+      FindTraceEntries(*events, "instant");
+  ASSERT_EQ(static_cast<size_t>(kNumEvents), instants.size());
+  int value;
+  std::string str_value;
+  EXPECT_TRUE(instants.back()->GetInteger("args.int", &value));
+  EXPECT_EQ(kNumEvents - 1, value);
+  EXPECT_TRUE(instants.back()->GetString("args.string", &str_value));
+  EXPECT_EQ("value", str_value);
+
+  const DictionaryValue* outer = FindTraceEntry(*events, "outer");
+  ASSERT_TRUE(outer);
+  EXPECT_TRUE(outer->HasKey("dur"));
+
+  const DictionaryValue* copied = FindTraceEntry(*events, "copied name");
+  ASSERT_TRUE(copied);
+  double double_value;
+  EXPECT_TRUE(copied->GetDouble("args.double", &double_value));
+  EXPECT_EQ(0.5, double_value);
+}
+
+TEST_F(TraceEventTestFixture, ConvertMalformedBinaryTrace) {
+  std::string json;
+  EXPECT_TRUE(ConvertBinaryTraceToJSON(std::string(), &json));
+  EXPECT_TRUE(json.empty());
+  EXPECT_FALSE(ConvertBinaryTraceToJSON("not a trace", &json));
+}
+
 // Test the category filter.
 TEST_F(TraceEventTestFixture, CategoryFilter) {
   // Using the default filter.
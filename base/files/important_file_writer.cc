@@ -12,6 +12,11 @@
 
 #include <stdio.h>
 
+#if defined(OS_POSIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <string>
 
 #include "base/bind.h"
@@ -20,7 +25,10 @@
 #include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/metrics/histogram.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/task_runner.h"
 #include "base/threading/thread.h"
@@ -49,59 +57,219 @@ void LogFailure(const FilePath& path, TempFileFailure failure_code,
                  << " : " << message;
 }
 
-}  // namespace
+// A temporary file holding the new contents of |path|.
+struct TempFile {
+  FilePath path;
+  FilePath tmp_path;
+  File file;
+  size_t size;
+};
 
-// static
-bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
-                                              const std::string& data) {
+// Writes |data| to a new temporary file next to |path|. Returns NULL on
+// failure.
+scoped_ptr<TempFile> WriteTempFile(const FilePath& path,
+                                   const std::string& data) {
   // Write the data to a temp file then rename to avoid data loss if we crash
   // while writing the file. Ensure that the temp file is on the same volume
   // as target file, so it can be moved in one step, and that the temp file
   // is securely created.
-  FilePath tmp_file_path;
-  if (!base::CreateTemporaryFileInDir(path.DirName(), &tmp_file_path)) {
+  scoped_ptr<TempFile> temp_file(new TempFile);
+  temp_file->path = path;
+  temp_file->size = data.length();
+  if (!base::CreateTemporaryFileInDir(path.DirName(), &temp_file->tmp_path)) {
     LogFailure(path, FAILED_CREATING, "could not create temporary file");
-    return false;
+    return scoped_ptr<TempFile>();
   }
 
-  File tmp_file(tmp_file_path, File::FLAG_OPEN | File::FLAG_WRITE);
-  if (!tmp_file.IsValid()) {
+  temp_file->file.Initialize(temp_file->tmp_path,
+                             File::FLAG_OPEN | File::FLAG_WRITE);
+  if (!temp_file->file.IsValid()) {
     LogFailure(path, FAILED_OPENING, "could not open temporary file");
-    return false;
+    return scoped_ptr<TempFile>();
   }
 
   // If this happens in the wild something really bad is going on.
   CHECK_LE(data.length(), static_cast<size_t>(kint32max));
-  int bytes_written = tmp_file.Write(0, data.data(),
-                                     static_cast<int>(data.length()));
-  tmp_file.Flush();  // Ignore return value.
-  tmp_file.Close();
-
+  int bytes_written = temp_file->file.Write(0, data.data(),
+                                            static_cast<int>(data.length()));
   if (bytes_written < static_cast<int>(data.length())) {
+    temp_file->file.Close();
     LogFailure(path, FAILED_WRITING, "error writing, bytes_written=" +
                IntToString(bytes_written));
-    base::DeleteFile(tmp_file_path, false);
-    return false;
+    base::DeleteFile(temp_file->tmp_path, false);
+    return scoped_ptr<TempFile>();
   }
 
-  if (!base::ReplaceFile(tmp_file_path, path, NULL)) {
-    LogFailure(path, FAILED_RENAMING, "could not rename temporary file");
-    base::DeleteFile(tmp_file_path, false);
+  return temp_file.Pass();
+}
+
+// Starts writing the data of |temp_file| to disk without waiting for it, so
+// that the disk can work on all the files of a batch at once.
+void StartSync(TempFile* temp_file) {
+#if defined(OS_LINUX)
+  // Errors are ignored: SyncData() waits for the data anyway.
+  sync_file_range(temp_file->file.GetPlatformFile(), 0, 0,
+                  SYNC_FILE_RANGE_WRITE);
+#endif
+}
+
+// Waits until the data of |temp_file| is on disk. Only the data and the size
+// have to be: the file is renamed next, and its other metadata, like its
+// modification time, doesn't need a disk write of its own.
+bool SyncData(TempFile* temp_file) {
+#if defined(OS_MACOSX)
+  // fsync() only pushes the data to the drive, which may keep it in a volatile
+  // cache; F_FULLFSYNC flushes the cache too. Not all file systems support it.
+  if (HANDLE_EINTR(fcntl(temp_file->file.GetPlatformFile(), F_FULLFSYNC)) == 0)
+    return true;
+  return temp_file->file.Flush();
+#elif defined(OS_LINUX) || defined(OS_ANDROID)
+  return !HANDLE_EINTR(fdatasync(temp_file->file.GetPlatformFile()));
+#else
+  return temp_file->file.Flush();
+#endif
+}
+
+// Flushes |temp_file| to disk and renames it to its target.
+bool CommitTempFile(TempFile* temp_file) {
+  SyncData(temp_file);  // Ignore return value.
+  temp_file->file.Close();
+
+  if (!base::ReplaceFile(temp_file->tmp_path, temp_file->path, NULL)) {
+    LogFailure(temp_file->path, FAILED_RENAMING,
+               "could not rename temporary file");
+    base::DeleteFile(temp_file->tmp_path, false);
     return false;
   }
 
   return true;
 }
 
+// Writes the files in |writes| atomically, flushing them to disk together.
+// Returns the number of files written and adds their size to
+// |bytes_written|.
+int WriteFilesAtomically(const std::map<FilePath, std::string>& writes,
+                         int64* bytes_written) {
+  ScopedVector<TempFile> temp_files;
+  for (std::map<FilePath, std::string>::const_iterator it = writes.begin();
+       it != writes.end(); ++it) {
+    scoped_ptr<TempFile> temp_file = WriteTempFile(it->first, it->second);
+    if (temp_file)
+      temp_files.push_back(temp_file.release());
+  }
+
+  for (size_t i = 0; i < temp_files.size(); ++i)
+    StartSync(temp_files[i]);
+
+  int files_written = 0;
+  for (size_t i = 0; i < temp_files.size(); ++i) {
+    if (CommitTempFile(temp_files[i])) {
+      ++files_written;
+      *bytes_written += temp_files[i]->size;
+    }
+  }
+  return files_written;
+}
+
+}  // namespace
+
+ImportantFileWriteQueue::Stats::Stats()
+    : writes_requested(0),
+      writes_coalesced(0),
+      batches(0),
+      files_written(0),
+      bytes_requested(0),
+      bytes_written(0) {
+}
+
+ImportantFileWriteQueue::ImportantFileWriteQueue(
+    SequencedTaskRunner* task_runner)
+    : task_runner_(task_runner),
+      batch_posted_(false) {
+  DCHECK(task_runner_.get());
+}
+
+ImportantFileWriteQueue::~ImportantFileWriteQueue() {
+  DCHECK(pending_writes_.empty());
+}
+
+void ImportantFileWriteQueue::Write(const FilePath& path,
+                                    const std::string& data) {
+  {
+    AutoLock lock(lock_);
+    ++stats_.writes_requested;
+    stats_.bytes_requested += data.length();
+    std::pair<WriteMap::iterator, bool> inserted =
+        pending_writes_.insert(std::make_pair(path, std::string()));
+    if (!inserted.second)
+      ++stats_.writes_coalesced;
+    inserted.first->second = data;
+    if (batch_posted_)
+      return;
+    batch_posted_ = true;
+  }
+
+  if (!task_runner_->PostTask(
+          FROM_HERE,
+          MakeCriticalClosure(
+              Bind(&ImportantFileWriteQueue::WriteBatch, this)))) {
+    // Posting the task to background message loop is not expected
+    // to fail, but if it does, avoid losing data and just hit the disk
+    // on the current thread.
+    NOTREACHED();
+
+    WriteBatch();
+  }
+}
+
+ImportantFileWriteQueue::Stats ImportantFileWriteQueue::GetStats() const {
+  AutoLock lock(lock_);
+  return stats_;
+}
+
+void ImportantFileWriteQueue::WriteBatch() {
+  WriteMap writes;
+  {
+    AutoLock lock(lock_);
+    writes.swap(pending_writes_);
+    batch_posted_ = false;
+  }
+
+  int64 bytes_written = 0;
+  int files_written = WriteFilesAtomically(writes, &bytes_written);
+
+  AutoLock lock(lock_);
+  ++stats_.batches;
+  stats_.files_written += files_written;
+  stats_.bytes_written += bytes_written;
+}
+
+// static
+bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
+                                              const std::string& data) {
+  scoped_ptr<TempFile> temp_file = WriteTempFile(path, data);
+  return temp_file && CommitTempFile(temp_file.get());
+}
+
 ImportantFileWriter::ImportantFileWriter(
     const FilePath& path, base::SequencedTaskRunner* task_runner)
         : path_(path),
-          task_runner_(task_runner),
+          queue_(new ImportantFileWriteQueue(task_runner)),
           serializer_(NULL),
           commit_interval_(TimeDelta::FromMilliseconds(
               kDefaultCommitIntervalMs)) {
   DCHECK(CalledOnValidThread());
-  DCHECK(task_runner_.get());
+}
+
+ImportantFileWriter::ImportantFileWriter(
+    const FilePath& path, ImportantFileWriteQueue* queue)
+        : path_(path),
+          queue_(queue),
+          serializer_(NULL),
+          commit_interval_(TimeDelta::FromMilliseconds(
+              kDefaultCommitIntervalMs)) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(queue_.get());
 }
 
 ImportantFileWriter::~ImportantFileWriter() {
@@ -126,18 +294,7 @@ void ImportantFileWriter::WriteNow(const std::string& data) {
   if (HasPendingWrite())
     timer_.Stop();
 
-  if (!task_runner_->PostTask(
-          FROM_HERE,
-          MakeCriticalClosure(
-              Bind(IgnoreResult(&ImportantFileWriter::WriteFileAtomically),
-                   path_, data)))) {
-    // Posting the task to background message loop is not expected
-    // to fail, but if it does, avoid losing data and just hit the disk
-    // on the current thread.
-    NOTREACHED();
-
-    WriteFileAtomically(path_, data);
-  }
+  queue_->Write(path_, data);
 }
 
 void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
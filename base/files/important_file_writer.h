@@ -5,12 +5,14 @@
 #ifndef BASE_FILES_IMPORTANT_FILE_WRITER_H_
 #define BASE_FILES_IMPORTANT_FILE_WRITER_H_
 
+#include <map>
 #include <string>
 
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
@@ -20,6 +22,75 @@ namespace base {
 class SequencedTaskRunner;
 class Thread;
 
+// Does the writes of one or more ImportantFileWriters on a SequencedTaskRunner.
+// Writes that are queued when a batch starts are done together: all the
+// temporary files are written first and then flushed to disk one after the
+// other, so the disk sees one burst of flushes instead of one per file. A
+// write to a file that already has a queued write replaces it, so a file that
+// changes often is written once per batch however many times it was saved.
+//
+// Writers of files that are saved around the same time, like prefs and
+// bookmarks, can share a queue to get this; a writer made without one gets
+// a queue of its own.
+class BASE_EXPORT ImportantFileWriteQueue
+    : public RefCountedThreadSafe<ImportantFileWriteQueue> {
+ public:
+  struct BASE_EXPORT Stats {
+    Stats();
+
+    // Writes asked for, and how many of them were replaced by a later write
+    // to the same file before they started.
+    int64 writes_requested;
+    int64 writes_coalesced;
+
+    // Batches run and files written to disk.
+    int64 batches;
+    int64 files_written;
+
+    // Bytes asked to be written and bytes written to disk. Their ratio is the
+    // queue's write amplification: data saved again before it reached the
+    // disk isn't written, so coalescing keeps it below 1.
+    int64 bytes_requested;
+    int64 bytes_written;
+  };
+
+  // |task_runner| is where the files are written.
+  explicit ImportantFileWriteQueue(SequencedTaskRunner* task_runner);
+
+  // Saves |data| to |path| atomically on the queue's task runner. Does not
+  // block. May be called on any thread.
+  void Write(const FilePath& path, const std::string& data);
+
+  Stats GetStats() const;
+
+  SequencedTaskRunner* task_runner() const { return task_runner_.get(); }
+
+ private:
+  friend class RefCountedThreadSafe<ImportantFileWriteQueue>;
+
+  typedef std::map<FilePath, std::string> WriteMap;
+
+  ~ImportantFileWriteQueue();
+
+  // Writes all the queued files. Runs on |task_runner_|.
+  void WriteBatch();
+
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+
+  // Protects the members below.
+  mutable Lock lock_;
+
+  // The data to write to each file in the next batch.
+  WriteMap pending_writes_;
+
+  // Whether a WriteBatch task is posted and hasn't started yet.
+  bool batch_posted_;
+
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImportantFileWriteQueue);
+};
+
 // Helper to ensure that a file won't be corrupted by the write (for example on
 // application crash). Consider a naive way to save an important file F:
 //
@@ -64,6 +135,10 @@ class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
   ImportantFileWriter(const FilePath& path,
                       base::SequencedTaskRunner* task_runner);
 
+  // Same as above, but the writes go through |queue|, which may be shared
+  // with other writers.
+  ImportantFileWriter(const FilePath& path, ImportantFileWriteQueue* queue);
+
   // You have to ensure that there are no pending writes at the moment
   // of destruction.
   ~ImportantFileWriter();
@@ -101,8 +176,8 @@ class BASE_EXPORT ImportantFileWriter : public NonThreadSafe {
   // Path being written to.
   const FilePath path_;
 
-  // TaskRunner for the thread on which file I/O can be done.
-  const scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  // Queue that does the file I/O.
+  const scoped_refptr<ImportantFileWriteQueue> queue_;
 
   // Timer used to schedule commit after ScheduleWrite.
   OneShotTimer<ImportantFileWriter> timer_;
@@ -54,8 +54,6 @@ class ImportantFileWriterTest : public testing::Test {
  protected:
   FilePath file_;
   MessageLoop loop_;
-
- private:
   ScopedTempDir temp_dir_;
 };
 
@@ -119,4 +117,34 @@ TEST_F(ImportantFileWriterTest, BatchingWrites) {
   EXPECT_EQ("baz", GetFileContent(writer.path()));
 }
 
+TEST_F(ImportantFileWriterTest, SharedQueue) {
+  scoped_refptr<ImportantFileWriteQueue> queue(
+      new ImportantFileWriteQueue(MessageLoopProxy::current().get()));
+  ImportantFileWriter writer(file_, queue.get());
+  ImportantFileWriter other_writer(temp_dir_.path().AppendASCII("other"),
+                                   queue.get());
+  writer.WriteNow("foo");
+  other_writer.WriteNow("other");
+  writer.WriteNow("bar");
+  RunLoop().RunUntilIdle();
+  ASSERT_TRUE(PathExists(writer.path()));
+  EXPECT_EQ("bar", GetFileContent(writer.path()));
+  ASSERT_TRUE(PathExists(other_writer.path()));
+  EXPECT_EQ("other", GetFileContent(other_writer.path()));
+
+  // The writes were done in one batch, and "foo" never reached the disk.
+  ImportantFileWriteQueue::Stats stats = queue->GetStats();
+  EXPECT_EQ(3, stats.writes_requested);
+  EXPECT_EQ(1, stats.writes_coalesced);
+  EXPECT_EQ(1, stats.batches);
+  EXPECT_EQ(2, stats.files_written);
+  EXPECT_EQ(11, stats.bytes_requested);
+  EXPECT_EQ(8, stats.bytes_written);
+
+  writer.WriteNow("baz");
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ("baz", GetFileContent(writer.path()));
+  EXPECT_EQ(2, queue->GetStats().batches);
+}
+
 }  // namespace base
@@ -10,6 +10,7 @@
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/files/file_path.h"
+#include "base/json/json_reader.h"
 #include "base/values.h"
 
 class BASE_EXPORT JSONFileValueSerializer : public base::ValueSerializer {
@@ -48,6 +49,13 @@ class BASE_EXPORT JSONFileValueSerializer : public base::ValueSerializer {
   virtual base::Value* Deserialize(int* error_code,
                                    std::string* error_message) OVERRIDE;
 
+  // Like Deserialize(), but reports the contents of the file to |delegate|
+  // instead of building a Value. Returns false on error, with |error_code| and
+  // |error_message| filled in as for Deserialize().
+  bool DeserializeWithDelegate(base::JSONReader::Delegate* delegate,
+                               int* error_code,
+                               std::string* error_message);
+
   // This enum is designed to safely overlap with JSONReader::JsonParseError.
   enum JsonFileError {
     JSON_NO_ERROR = 0,
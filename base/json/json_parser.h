@@ -66,6 +66,12 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // result as a Value owned by the caller.
   Value* Parse(const StringPiece& input);
 
+  // Parses the input string according to the set options and reports its
+  // contents to |delegate|. Returns false on error, including when |delegate|
+  // stops parsing.
+  bool ParseWithDelegate(const StringPiece& input,
+                         JSONReader::Delegate* delegate);
+
   // Returns the error code.
   JSONReader::JsonParseError error_code() const;
 
@@ -143,6 +149,14 @@ class BASE_EXPORT_PRIVATE JSONParser {
     std::string* string_;
   };
 
+  // Winds the parser to the start of the |length| bytes at |start|, skipping
+  // any Byte-Order-Mark, and clears the error information.
+  void StartParsing(const char* start, size_t length);
+
+  // Called once the root value has been consumed. Returns true if nothing but
+  // whitespace and comments follow it, and reports an error otherwise.
+  bool ConsumeEndOfInput();
+
   // Quick check that the stream has capacity to consume |length| more bytes.
   bool CanConsume(int length);
 
@@ -172,6 +186,15 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // caller owns.
   Value* ParseToken(Token token);
 
+  // Like ParseNextToken() and ParseToken(), but the value is reported to
+  // |delegate| instead of being returned. Returns false on error.
+  bool DispatchNextToken(JSONReader::Delegate* delegate);
+  bool DispatchToken(Token token, JSONReader::Delegate* delegate);
+
+  // Like ConsumeDictionary() and ConsumeList(), but reporting to |delegate|.
+  bool DispatchDictionary(JSONReader::Delegate* delegate);
+  bool DispatchList(JSONReader::Delegate* delegate);
+
   // Assuming that the parser is currently wound to '{', this parses a JSON
   // object into a DictionaryValue.
   Value* ConsumeDictionary();
@@ -202,6 +225,9 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // Assuming that the parser is wound to the start of a valid JSON number,
   // this parses and converts it to either an int or double value.
   Value* ConsumeNumber();
+  // Helper for ConsumeNumber() that consumes the number and places its text in
+  // |out|. Returns false on failure with error information set.
+  bool ConsumeNumberRaw(StringPiece* out);
   // Helper that reads characters that are ints. Returns true if a number was
   // read and false on error.
   bool ReadInt(bool allow_leading_zeros);
@@ -209,6 +235,9 @@ class BASE_EXPORT_PRIVATE JSONParser {
   // Consumes the literal values of |true|, |false|, and |null|, assuming the
   // parser is wound to the first character of any of those.
   Value* ConsumeLiteral();
+  // Helper for ConsumeLiteral() that consumes the literal without creating a
+  // value. Returns false on failure with error information set.
+  bool ConsumeLiteralRaw();
 
   // Compares two string buffers of a given length.
   static bool StringsAreEqual(const char* left, const char* right, size_t len);
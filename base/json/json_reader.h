@@ -3,7 +3,8 @@
 // found in the LICENSE file.
 //
 // A JSON parser.  Converts strings of JSON into a Value object (see
-// base/values.h).
+// base/values.h), or reports their contents to a JSONReader::Delegate as they
+// are read, for callers that don't need the whole document as Values.
 // http://www.ietf.org/rfc/rfc4627.txt?number=4627
 //
 // Known limitations/deviations from the RFC:
@@ -73,6 +74,7 @@ class BASE_EXPORT JSONReader {
     JSON_UNEXPECTED_DATA_AFTER_ROOT,
     JSON_UNSUPPORTED_ENCODING,
     JSON_UNQUOTED_DICTIONARY_KEY,
+    JSON_STOPPED_BY_DELEGATE,
     JSON_PARSE_ERROR_COUNT
   };
 
@@ -85,6 +87,29 @@ class BASE_EXPORT JSONReader {
   static const char* kUnexpectedDataAfterRoot;
   static const char* kUnsupportedEncoding;
   static const char* kUnquotedDictionaryKey;
+  static const char* kStoppedByDelegate;
+
+  // Receives the contents of a document from ReadWithDelegate(), in order.
+  // Dictionaries and lists are reported by a start call, their members, and
+  // an end call; each member of a dictionary is preceded by OnKey(). The
+  // StringPieces are only valid for the duration of the call. Returning false
+  // from any method stops parsing with JSON_STOPPED_BY_DELEGATE.
+  class BASE_EXPORT Delegate {
+   public:
+    virtual bool OnStartDictionary() = 0;
+    virtual bool OnKey(const StringPiece& key) = 0;
+    virtual bool OnEndDictionary() = 0;
+    virtual bool OnStartList() = 0;
+    virtual bool OnEndList() = 0;
+    virtual bool OnString(const StringPiece& value) = 0;
+    virtual bool OnInteger(int value) = 0;
+    virtual bool OnDouble(double value) = 0;
+    virtual bool OnBoolean(bool value) = 0;
+    virtual bool OnNull() = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
 
   // Constructs a reader with the default options, JSON_PARSE_RFC.
   JSONReader();
@@ -112,6 +137,17 @@ class BASE_EXPORT JSONReader {
                                    int* error_code_out,
                                    std::string* error_msg_out);
 
+  // Reads and parses |json| like ReadAndReturnError(), but reports its
+  // contents to |delegate| instead of building a Value. Returns false if
+  // |json| is not properly formed or |delegate| stopped parsing, in which case
+  // |delegate| may have seen part of the document. |error_code_out| and
+  // |error_msg_out| are optional and populated as in ReadAndReturnError().
+  static bool ReadWithDelegate(const StringPiece& json,
+                               int options,  // JSONParserOptions
+                               Delegate* delegate,
+                               int* error_code_out,
+                               std::string* error_msg_out);
+
   // Converts a JSON parse error code into a human readable message.
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
@@ -9,6 +9,7 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
@@ -17,6 +18,54 @@
 
 namespace base {
 
+namespace {
+
+// Records what it is told as a space-separated list of events. Returns false
+// once it has seen |stop_after| events.
+class RecordingDelegate : public JSONReader::Delegate {
+ public:
+  explicit RecordingDelegate(int stop_after)
+      : events_left_(stop_after) {
+  }
+  virtual ~RecordingDelegate() {}
+
+  const std::string& events() const { return events_; }
+
+  virtual bool OnStartDictionary() OVERRIDE { return Record("{"); }
+  virtual bool OnKey(const StringPiece& key) OVERRIDE {
+    return Record(key.as_string() + ":");
+  }
+  virtual bool OnEndDictionary() OVERRIDE { return Record("}"); }
+  virtual bool OnStartList() OVERRIDE { return Record("["); }
+  virtual bool OnEndList() OVERRIDE { return Record("]"); }
+  virtual bool OnString(const StringPiece& value) OVERRIDE {
+    return Record("'" + value.as_string() + "'");
+  }
+  virtual bool OnInteger(int value) OVERRIDE {
+    return Record(IntToString(value));
+  }
+  virtual bool OnDouble(double value) OVERRIDE {
+    return Record(DoubleToString(value) + "d");
+  }
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    return Record(value ? "true" : "false");
+  }
+  virtual bool OnNull() OVERRIDE { return Record("null"); }
+
+ private:
+  bool Record(const std::string& event) {
+    if (!events_.empty())
+      events_ += " ";
+    events_ += event;
+    return --events_left_ > 0;
+  }
+
+  std::string events_;
+  int events_left_;
+};
+
+}  // namespace
+
 TEST(JSONReaderTest, Reading) {
   // some whitespace checking
   scoped_ptr<Value> root;
@@ -653,4 +702,48 @@ TEST(JSONReaderTest, IllegalTrailingNull) {
   EXPECT_EQ(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, reader.error_code());
 }
 
+TEST(JSONReaderTest, ReadWithDelegate) {
+  RecordingDelegate delegate(100);
+  EXPECT_TRUE(JSONReader::ReadWithDelegate(
+      "{\"a\": [1, 2.5, \"x\\ny\", true, null], \"b\": {}, "
+      "\"c\\u0041\": [], /* comment */ \"d\": false,}",
+      JSON_ALLOW_TRAILING_COMMAS, &delegate, NULL, NULL));
+  EXPECT_EQ("{ a: [ 1 2.5d 'x\ny' true null ] b: { } cA: [ ] d: false }",
+            delegate.events());
+
+  RecordingDelegate scalar_delegate(100);
+  EXPECT_TRUE(JSONReader::ReadWithDelegate("\"abc\"", JSON_PARSE_RFC,
+                                           &scalar_delegate, NULL, NULL));
+  EXPECT_EQ("'abc'", scalar_delegate.events());
+}
+
+TEST(JSONReaderTest, ReadWithDelegateErrors) {
+  int error_code = JSONReader::JSON_NO_ERROR;
+  std::string error_message;
+
+  RecordingDelegate delegate(100);
+  EXPECT_FALSE(JSONReader::ReadWithDelegate("[1, 2,]", JSON_PARSE_RFC,
+                                            &delegate, &error_code,
+                                            &error_message));
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, error_code);
+  EXPECT_NE("", error_message);
+  EXPECT_EQ("[ 1 2", delegate.events());
+
+  RecordingDelegate trailing_delegate(100);
+  EXPECT_FALSE(JSONReader::ReadWithDelegate("[] 1", JSON_PARSE_RFC,
+                                            &trailing_delegate, &error_code,
+                                            NULL));
+  EXPECT_EQ(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, error_code);
+
+  // The delegate can stop parsing.
+  RecordingDelegate stopping_delegate(3);
+  EXPECT_FALSE(JSONReader::ReadWithDelegate("{\"a\": 1, \"b\": 2}",
+                                            JSON_PARSE_RFC, &stopping_delegate,
+                                            &error_code, &error_message));
+  EXPECT_EQ(JSONReader::JSON_STOPPED_BY_DELEGATE, error_code);
+  EXPECT_EQ("Line: 1, column: 7, Parsing stopped by the delegate.",
+            error_message);
+  EXPECT_EQ("{ a: 1", stopping_delegate.events());
+}
+
 }  // namespace base
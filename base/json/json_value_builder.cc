@@ -0,0 +1,109 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_value_builder.h"
+
+#include "base/logging.h"
+#include "base/values.h"
+
+namespace base {
+
+JSONValueBuilder::JSONValueBuilder() {
+}
+
+JSONValueBuilder::~JSONValueBuilder() {
+}
+
+bool JSONValueBuilder::IsComplete() const {
+  return root_ && open_containers_.empty();
+}
+
+scoped_ptr<Value> JSONValueBuilder::PassValue() {
+  if (!IsComplete())
+    return scoped_ptr<Value>();
+  return root_.Pass();
+}
+
+bool JSONValueBuilder::OnStartDictionary() {
+  return OpenContainer(new DictionaryValue);
+}
+
+bool JSONValueBuilder::OnKey(const StringPiece& key) {
+  if (open_containers_.empty() ||
+      !open_containers_.back()->IsType(Value::TYPE_DICTIONARY)) {
+    return false;
+  }
+  key.CopyToString(&key_);
+  return true;
+}
+
+bool JSONValueBuilder::OnEndDictionary() {
+  return CloseContainer(Value::TYPE_DICTIONARY);
+}
+
+bool JSONValueBuilder::OnStartList() {
+  return OpenContainer(new ListValue);
+}
+
+bool JSONValueBuilder::OnEndList() {
+  return CloseContainer(Value::TYPE_LIST);
+}
+
+bool JSONValueBuilder::OnString(const StringPiece& value) {
+  return AddValue(new StringValue(value.as_string()));
+}
+
+bool JSONValueBuilder::OnInteger(int value) {
+  return AddValue(new FundamentalValue(value));
+}
+
+bool JSONValueBuilder::OnDouble(double value) {
+  return AddValue(new FundamentalValue(value));
+}
+
+bool JSONValueBuilder::OnBoolean(bool value) {
+  return AddValue(new FundamentalValue(value));
+}
+
+bool JSONValueBuilder::OnNull() {
+  return AddValue(Value::CreateNullValue());
+}
+
+bool JSONValueBuilder::AddValue(Value* value) {
+  if (open_containers_.empty()) {
+    if (root_) {
+      delete value;
+      return false;
+    }
+    root_.reset(value);
+    return true;
+  }
+
+  Value* parent = open_containers_.back();
+  if (parent->IsType(Value::TYPE_DICTIONARY)) {
+    static_cast<DictionaryValue*>(parent)->SetWithoutPathExpansion(key_,
+                                                                   value);
+  } else {
+    static_cast<ListValue*>(parent)->Append(value);
+  }
+  return true;
+}
+
+bool JSONValueBuilder::OpenContainer(Value* container) {
+  if (!AddValue(container))
+    return false;
+  open_containers_.push_back(container);
+  return true;
+}
+
+bool JSONValueBuilder::CloseContainer(int type) {
+  if (open_containers_.empty() ||
+      open_containers_.back()->GetType() != type) {
+    return false;
+  }
+  open_containers_.pop_back();
+  return true;
+}
+
+}  // namespace base
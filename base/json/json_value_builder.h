@@ -0,0 +1,75 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_JSON_VALUE_BUILDER_H_
+#define BASE_JSON_JSON_VALUE_BUILDER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+class Value;
+
+// A JSONReader::Delegate that builds a Value from what it is told, so that a
+// delegate can build Values for just the parts of a document it needs by
+// forwarding their calls to one of these. Unlike the Values returned by
+// JSONReader::Read(), the result doesn't refer to the input.
+class BASE_EXPORT JSONValueBuilder : public JSONReader::Delegate {
+ public:
+  JSONValueBuilder();
+  virtual ~JSONValueBuilder();
+
+  // Returns true once a whole value has been built.
+  bool IsComplete() const;
+
+  // Returns the value built, or NULL if it isn't complete.
+  scoped_ptr<Value> PassValue();
+
+  // JSONReader::Delegate:
+  virtual bool OnStartDictionary() OVERRIDE;
+  virtual bool OnKey(const StringPiece& key) OVERRIDE;
+  virtual bool OnEndDictionary() OVERRIDE;
+  virtual bool OnStartList() OVERRIDE;
+  virtual bool OnEndList() OVERRIDE;
+  virtual bool OnString(const StringPiece& value) OVERRIDE;
+  virtual bool OnInteger(int value) OVERRIDE;
+  virtual bool OnDouble(double value) OVERRIDE;
+  virtual bool OnBoolean(bool value) OVERRIDE;
+  virtual bool OnNull() OVERRIDE;
+
+ private:
+  // Adds |value| to the innermost open dictionary or list, or makes it the
+  // root. Takes ownership of |value|. Returns false if the root is already
+  // complete.
+  bool AddValue(Value* value);
+
+  // Adds |container| like AddValue() and opens it.
+  bool OpenContainer(Value* container);
+
+  // Closes the innermost open container, which must be of |type|.
+  bool CloseContainer(int type);
+
+  scoped_ptr<Value> root_;
+
+  // The dictionaries and lists that are still being built, innermost last.
+  // Owned by |root_|.
+  std::vector<Value*> open_containers_;
+
+  // The key of the next member of the innermost open dictionary.
+  std::string key_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONValueBuilder);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_VALUE_BUILDER_H_
@@ -0,0 +1,61 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_value_builder.h"
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(JSONValueBuilderTest, BuildsSameValueAsRead) {
+  const char kJSON[] =
+      "{\"a\": [1, 2.5, \"x\\u0041\", true, null, {}], "
+      "\"b\": {\"c\": {\"d\": []}, \"e\": \"f\"}}";
+
+  JSONValueBuilder builder;
+  EXPECT_FALSE(builder.IsComplete());
+  EXPECT_TRUE(JSONReader::ReadWithDelegate(kJSON, JSON_PARSE_RFC, &builder,
+                                           NULL, NULL));
+  EXPECT_TRUE(builder.IsComplete());
+  scoped_ptr<Value> built(builder.PassValue());
+  ASSERT_TRUE(built);
+
+  scoped_ptr<Value> read(JSONReader::Read(kJSON));
+  ASSERT_TRUE(read);
+  EXPECT_TRUE(built->Equals(read.get()));
+}
+
+TEST(JSONValueBuilderTest, Scalar) {
+  JSONValueBuilder builder;
+  EXPECT_TRUE(builder.OnString("abc"));
+  EXPECT_TRUE(builder.IsComplete());
+  // There can only be one root.
+  EXPECT_FALSE(builder.OnInteger(1));
+
+  scoped_ptr<Value> value(builder.PassValue());
+  std::string string_value;
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(value->GetAsString(&string_value));
+  EXPECT_EQ("abc", string_value);
+}
+
+TEST(JSONValueBuilderTest, Incomplete) {
+  JSONValueBuilder builder;
+  EXPECT_TRUE(builder.OnStartList());
+  EXPECT_TRUE(builder.OnStartDictionary());
+  // Keys only go in dictionaries, and containers must be closed in order.
+  EXPECT_FALSE(builder.OnEndList());
+  EXPECT_TRUE(builder.OnEndDictionary());
+  EXPECT_FALSE(builder.OnKey("a"));
+  EXPECT_FALSE(builder.IsComplete());
+  EXPECT_FALSE(builder.PassValue());
+
+  EXPECT_TRUE(builder.OnEndList());
+  EXPECT_TRUE(builder.IsComplete());
+}
+
+}  // namespace base
@@ -9,6 +9,9 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_value_builder.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
@@ -46,6 +49,11 @@
 //   JSONValueConverter<Message> converter;
 //   converter.Convert(json, &message);
 //
+// If you have the JSON text rather than a Value, call ConvertJSON() instead.
+// It only builds Values for the members that have registered fields, one at a
+// time, rather than for the whole document.
+//   converter.ConvertJSON(json_text, &message);
+//
 // Convert() returns false when it fails.  Here "fail" means that the value is
 // structurally different from expected, such like a string value appears
 // for an int field.  Do not report failures for missing fields.
@@ -364,6 +372,152 @@ class RepeatedCustomValueConverter
   DISALLOW_COPY_AND_ASSIGN(RepeatedCustomValueConverter);
 };
 
+// Reads the members of the root dictionary of a JSON document for
+// JSONValueConverter::ConvertJSON(). Each member whose key starts the path of
+// a field is built into a Value and converted as soon as it has been read;
+// other members are skipped without building anything.
+template <typename StructType>
+class MemberConverterDelegate : public JSONReader::Delegate {
+ public:
+  MemberConverterDelegate(
+      const ScopedVector<FieldConverterBase<StructType> >* fields,
+      StructType* output)
+      : fields_(fields),
+        output_(output),
+        depth_(0) {
+  }
+
+  virtual bool OnStartDictionary() OVERRIDE {
+    if (depth_++ == 0)
+      return true;
+    return !member_builder_ || member_builder_->OnStartDictionary();
+  }
+
+  virtual bool OnKey(const StringPiece& key) OVERRIDE {
+    if (depth_ == 1) {
+      StartMember(key);
+      return true;
+    }
+    return !member_builder_ || member_builder_->OnKey(key);
+  }
+
+  virtual bool OnEndDictionary() OVERRIDE {
+    --depth_;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnEndDictionary() && MaybeConvertMember();
+  }
+
+  virtual bool OnStartList() OVERRIDE {
+    // The root must be a dictionary.
+    if (depth_++ == 0)
+      return false;
+    return !member_builder_ || member_builder_->OnStartList();
+  }
+
+  virtual bool OnEndList() OVERRIDE {
+    --depth_;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnEndList() && MaybeConvertMember();
+  }
+
+  virtual bool OnString(const StringPiece& value) OVERRIDE {
+    if (depth_ == 0)
+      return false;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnString(value) && MaybeConvertMember();
+  }
+
+  virtual bool OnInteger(int value) OVERRIDE {
+    if (depth_ == 0)
+      return false;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnInteger(value) && MaybeConvertMember();
+  }
+
+  virtual bool OnDouble(double value) OVERRIDE {
+    if (depth_ == 0)
+      return false;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnDouble(value) && MaybeConvertMember();
+  }
+
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    if (depth_ == 0)
+      return false;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnBoolean(value) && MaybeConvertMember();
+  }
+
+  virtual bool OnNull() OVERRIDE {
+    if (depth_ == 0)
+      return false;
+    if (!member_builder_)
+      return true;
+    return member_builder_->OnNull() && MaybeConvertMember();
+  }
+
+ private:
+  // Returns the first component of |field_path|.
+  static StringPiece GetMemberKey(const std::string& field_path) {
+    return StringPiece(field_path).substr(0, field_path.find('.'));
+  }
+
+  // Starts building the member named |key| if any field needs it.
+  void StartMember(const StringPiece& key) {
+    member_builder_.reset();
+    for (size_t i = 0; i < fields_->size(); ++i) {
+      if (GetMemberKey((*fields_)[i]->field_path()) == key) {
+        key.CopyToString(&member_key_);
+        member_builder_.reset(new JSONValueBuilder);
+        return;
+      }
+    }
+  }
+
+  // Once the member being built is complete, converts the fields within it.
+  // Returns false if a field fails to convert.
+  bool MaybeConvertMember() {
+    if (!member_builder_->IsComplete())
+      return true;
+
+    DictionaryValue member;
+    member.SetWithoutPathExpansion(member_key_,
+                                   member_builder_->PassValue().release());
+    member_builder_.reset();
+    for (size_t i = 0; i < fields_->size(); ++i) {
+      const FieldConverterBase<StructType>* field_converter = (*fields_)[i];
+      if (GetMemberKey(field_converter->field_path()) != member_key_)
+        continue;
+      const base::Value* field = NULL;
+      if (member.Get(field_converter->field_path(), &field) &&
+          !field_converter->ConvertField(*field, output_)) {
+        DVLOG(1) << "failure at field " << field_converter->field_path();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const ScopedVector<FieldConverterBase<StructType> >* fields_;
+  StructType* output_;
+
+  // How many dictionaries and lists the parser is within.
+  int depth_;
+
+  // The key of the member being built, and its builder. NULL while skipping
+  // a member.
+  std::string member_key_;
+  scoped_ptr<JSONValueBuilder> member_builder_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemberConverterDelegate);
+};
+
 
 }  // namespace internal
 
@@ -516,6 +670,14 @@ class JSONValueConverter {
     return true;
   }
 
+  // Like Convert(), but for the JSON text |json|. Also returns false if |json|
+  // is not properly formed.
+  bool ConvertJSON(const StringPiece& json, StructType* output) const {
+    internal::MemberConverterDelegate<StructType> delegate(&fields_, output);
+    return JSONReader::ReadWithDelegate(json, JSON_PARSE_RFC, &delegate, NULL,
+                                        NULL);
+  }
+
  private:
   ScopedVector<internal::FieldConverterBase<StructType> > fields_;
 
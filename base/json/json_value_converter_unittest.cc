@@ -253,4 +253,47 @@ TEST(JSONValueConverterTest, RepeatedValueErrorInTheMiddle) {
   // No check the values as mentioned above.
 }
 
+TEST(JSONValueConverterTest, ConvertJSON) {
+  const char normal_data[] =
+      "{\n"
+      "  \"unknown\": {\"foo\": [1, {\"bar\": 2}]},\n"
+      "  \"foo\": 1.0,\n"
+      "  \"child\": {\n"
+      "    \"foo\": 1,\n"
+      "    \"bar\": \"bar\",\n"
+      "    \"baz\": true\n"
+      "  },\n"
+      "  \"also_unknown\": 3,\n"
+      "  \"children\": [{\n"
+      "    \"foo\": 2,\n"
+      "    \"ints\": [1, 2]\n"
+      "  }]\n"
+      "}\n";
+
+  NestedMessage message;
+  base::JSONValueConverter<NestedMessage> converter;
+  EXPECT_TRUE(converter.ConvertJSON(normal_data, &message));
+
+  EXPECT_EQ(1.0, message.foo);
+  EXPECT_EQ(1, message.child.foo);
+  EXPECT_EQ("bar", message.child.bar);
+  EXPECT_TRUE(message.child.baz);
+  ASSERT_EQ(1U, message.children.size());
+  EXPECT_EQ(2, message.children[0]->foo);
+  ASSERT_EQ(2U, message.children[0]->ints.size());
+  EXPECT_EQ(2, *message.children[0]->ints[1]);
+}
+
+TEST(JSONValueConverterTest, ConvertJSONFailures) {
+  base::JSONValueConverter<SimpleMessage> converter;
+  SimpleMessage message;
+  // "bar" is an integer here.
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": 1, \"bar\": 2}", &message));
+  // Malformed JSON.
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": 1,", &message));
+  // The root is not a dictionary.
+  EXPECT_FALSE(converter.ConvertJSON("[{\"foo\": 1}]", &message));
+  EXPECT_FALSE(converter.ConvertJSON("1", &message));
+}
+
 }  // namespace base
@@ -0,0 +1,213 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_DISCARDABLE_LRU_CACHE_H_
+#define BASE_MEMORY_DISCARDABLE_LRU_CACHE_H_
+
+#include <string.h>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/logging.h"
+#include "base/memory/discardable_memory.h"
+#include "base/memory/scoped_ptr.h"
+
+namespace base {
+
+// DiscardableLRUCache keeps buffers that can be recomputed, such as decoded
+// images, in DiscardableMemory. An entry is only locked while it is in use, so
+// the system can take the memory back under pressure instead of the process
+// being killed. When an entry whose memory was purged is locked again, the
+// cache calls its rebuild callback to recompute the contents; without one, or
+// if rebuilding fails, the entry is dropped and the lookup misses.
+//
+// The cache also bounds the bytes it holds, evicting the least recently used
+// unlocked entries first.
+//
+//   DiscardableLRUCache<int> cache(kMaxBytes, base::Bind(&DecodeImage));
+//   cache.Put(id, pixels, size);
+//   ...
+//   DiscardableLRUCache<int>::ScopedLock lock(&cache, id);
+//   if (lock.memory())
+//     Draw(lock.memory(), lock.size());
+//
+// Like DiscardableMemory, a cache is not thread-safe.
+template <class Key>
+class DiscardableLRUCache {
+ public:
+  // Fills the |size| bytes at |memory| with the contents of the entry for
+  // |key|. Returns false if it can't.
+  typedef Callback<bool(const Key& key, void* memory, size_t size)>
+      RebuildCallback;
+
+  // Locks an entry for the lifetime of the object. memory() is NULL if the
+  // cache has no entry for the key.
+  class ScopedLock {
+   public:
+    ScopedLock(DiscardableLRUCache* cache, const Key& key)
+        : cache_(cache),
+          key_(key),
+          size_(0),
+          memory_(cache->Lock(key, &size_)) {
+    }
+    ~ScopedLock() {
+      if (memory_)
+        cache_->Unlock(key_);
+    }
+
+    void* memory() const { return memory_; }
+    size_t size() const { return size_; }
+
+   private:
+    DiscardableLRUCache* cache_;
+    Key key_;
+    size_t size_;
+    void* memory_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedLock);
+  };
+
+  // Once the entries take more than |max_bytes|, the least recently used
+  // unlocked ones are evicted. |rebuild_callback| may be null.
+  DiscardableLRUCache(size_t max_bytes,
+                      const RebuildCallback& rebuild_callback)
+      : entries_(EntryMap::NO_AUTO_EVICT),
+        max_bytes_(max_bytes),
+        bytes_(0),
+        rebuild_callback_(rebuild_callback) {
+  }
+
+  ~DiscardableLRUCache() {
+    for (typename EntryMap::iterator it = entries_.begin();
+         it != entries_.end(); ++it) {
+      DCHECK(!it->second->locked) << "An entry is still locked";
+    }
+  }
+
+  // Sets the entry for |key| to a copy of the |size| bytes at |data|. The
+  // entry must not be locked. Returns false if no discardable memory could be
+  // allocated, in which case the cache has no entry for |key|.
+  bool Put(const Key& key, const void* data, size_t size) {
+    Erase(key);
+    scoped_ptr<DiscardableMemory> memory =
+        DiscardableMemory::CreateLockedMemory(size);
+    if (!memory)
+      return false;
+    memcpy(memory->Memory(), data, size);
+    memory->Unlock();
+
+    Entry* entry = new Entry;
+    entry->memory = memory.Pass();
+    entry->size = size;
+    entries_.Put(key, entry);
+    bytes_ += size;
+    EvictIfNeeded();
+    return true;
+  }
+
+  // Locks the entry for |key|, makes it the most recently used, and returns
+  // its memory and size. Returns NULL if there is no entry, or if its memory
+  // was purged and couldn't be rebuilt. Each successful call must be followed
+  // by Unlock(); locks don't nest.
+  void* Lock(const Key& key, size_t* size) {
+    typename EntryMap::iterator it = entries_.Get(key);
+    if (it == entries_.end())
+      return NULL;
+    Entry* entry = it->second;
+    DCHECK(!entry->locked);
+
+    switch (entry->memory->Lock()) {
+      case DISCARDABLE_MEMORY_LOCK_STATUS_SUCCESS:
+        break;
+      case DISCARDABLE_MEMORY_LOCK_STATUS_PURGED:
+        if (!Rebuild(key, entry)) {
+          entry->memory->Unlock();
+          EraseEntry(it);
+          return NULL;
+        }
+        break;
+      case DISCARDABLE_MEMORY_LOCK_STATUS_FAILED:
+        entry->memory = DiscardableMemory::CreateLockedMemory(entry->size);
+        if (!entry->memory || !Rebuild(key, entry)) {
+          if (entry->memory)
+            entry->memory->Unlock();
+          EraseEntry(it);
+          return NULL;
+        }
+        break;
+    }
+
+    entry->locked = true;
+    *size = entry->size;
+    return entry->memory->Memory();
+  }
+
+  void Unlock(const Key& key) {
+    typename EntryMap::iterator it = entries_.Peek(key);
+    DCHECK(it != entries_.end());
+    Entry* entry = it->second;
+    DCHECK(entry->locked);
+    entry->memory->Unlock();
+    entry->locked = false;
+    EvictIfNeeded();
+  }
+
+  // Drops the entry for |key|, if any. The entry must not be locked.
+  void Erase(const Key& key) {
+    typename EntryMap::iterator it = entries_.Peek(key);
+    if (it != entries_.end())
+      EraseEntry(it);
+  }
+
+  size_t size() const { return entries_.size(); }
+
+  // The size of all entries, whether or not their memory has been purged.
+  size_t bytes() const { return bytes_; }
+
+ private:
+  struct Entry {
+    Entry() : size(0), locked(false) {}
+
+    scoped_ptr<DiscardableMemory> memory;
+    size_t size;
+    bool locked;
+  };
+  typedef OwningMRUCache<Key, Entry*> EntryMap;
+
+  // Refills the locked memory of |entry| after it was purged.
+  bool Rebuild(const Key& key, Entry* entry) {
+    return !rebuild_callback_.is_null() &&
+        rebuild_callback_.Run(key, entry->memory->Memory(), entry->size);
+  }
+
+  void EraseEntry(typename EntryMap::iterator it) {
+    DCHECK(!it->second->locked);
+    bytes_ -= it->second->size;
+    entries_.Erase(it);
+  }
+
+  void EvictIfNeeded() {
+    typename EntryMap::reverse_iterator it = entries_.rbegin();
+    while (bytes_ > max_bytes_ && it != entries_.rend()) {
+      if (it->second->locked) {
+        ++it;
+        continue;
+      }
+      bytes_ -= it->second->size;
+      it = entries_.Erase(it);
+    }
+  }
+
+  EntryMap entries_;
+  size_t max_bytes_;
+  size_t bytes_;
+  RebuildCallback rebuild_callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(DiscardableLRUCache);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_DISCARDABLE_LRU_CACHE_H_
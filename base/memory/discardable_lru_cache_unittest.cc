@@ -0,0 +1,121 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/discardable_lru_cache.h"
+
+#include <string.h>
+
+#include "base/bind.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+typedef DiscardableLRUCache<int> Cache;
+
+const size_t kSize = 4096;
+
+// Entry |key| is |kSize| bytes of |key|.
+void FillEntry(int key, void* memory) {
+  memset(memory, key, kSize);
+}
+
+bool PutEntry(Cache* cache, int key) {
+  char data[kSize];
+  FillEntry(key, data);
+  return cache->Put(key, data, kSize);
+}
+
+bool HasContents(int key, const void* memory) {
+  char expected[kSize];
+  FillEntry(key, expected);
+  return memcmp(expected, memory, kSize) == 0;
+}
+
+bool Rebuild(int* rebuilds, const int& key, void* memory, size_t size) {
+  EXPECT_EQ(kSize, size);
+  ++*rebuilds;
+  FillEntry(key, memory);
+  return true;
+}
+
+}  // namespace
+
+TEST(DiscardableLRUCacheTest, PutAndLock) {
+  Cache cache(10 * kSize, Cache::RebuildCallback());
+  ASSERT_TRUE(PutEntry(&cache, 1));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(kSize, cache.bytes());
+
+  size_t size = 0;
+  void* memory = cache.Lock(1, &size);
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(kSize, size);
+  EXPECT_TRUE(HasContents(1, memory));
+  cache.Unlock(1);
+
+  EXPECT_FALSE(cache.Lock(2, &size));
+
+  cache.Erase(1);
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.bytes());
+}
+
+TEST(DiscardableLRUCacheTest, EvictsLeastRecentlyUsed) {
+  Cache cache(3 * kSize, Cache::RebuildCallback());
+  ASSERT_TRUE(PutEntry(&cache, 1));
+  ASSERT_TRUE(PutEntry(&cache, 2));
+  ASSERT_TRUE(PutEntry(&cache, 3));
+  // Using 1 makes 2 the least recently used.
+  { Cache::ScopedLock lock(&cache, 1); }
+  ASSERT_TRUE(PutEntry(&cache, 4));
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(3 * kSize, cache.bytes());
+  EXPECT_FALSE(Cache::ScopedLock(&cache, 2).memory());
+  EXPECT_TRUE(Cache::ScopedLock(&cache, 1).memory());
+}
+
+TEST(DiscardableLRUCacheTest, KeepsLockedEntries) {
+  Cache cache(2 * kSize, Cache::RebuildCallback());
+  ASSERT_TRUE(PutEntry(&cache, 1));
+  Cache::ScopedLock lock(&cache, 1);
+  ASSERT_TRUE(lock.memory());
+  ASSERT_TRUE(PutEntry(&cache, 2));
+  ASSERT_TRUE(PutEntry(&cache, 3));
+  // 1 is the least recently used, but it's locked.
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_FALSE(Cache::ScopedLock(&cache, 2).memory());
+  EXPECT_TRUE(HasContents(1, lock.memory()));
+}
+
+TEST(DiscardableLRUCacheTest, RebuildsPurgedEntries) {
+  if (!DiscardableMemory::PurgeForTestingSupported())
+    return;
+
+  int rebuilds = 0;
+  Cache cache(10 * kSize, Bind(&Rebuild, &rebuilds));
+  ASSERT_TRUE(PutEntry(&cache, 1));
+  DiscardableMemory::PurgeForTesting();
+
+  Cache::ScopedLock lock(&cache, 1);
+  ASSERT_TRUE(lock.memory());
+  EXPECT_EQ(1, rebuilds);
+  EXPECT_TRUE(HasContents(1, lock.memory()));
+}
+
+TEST(DiscardableLRUCacheTest, DropsPurgedEntriesWithoutRebuildCallback) {
+  if (!DiscardableMemory::PurgeForTestingSupported())
+    return;
+
+  Cache cache(10 * kSize, Cache::RebuildCallback());
+  ASSERT_TRUE(PutEntry(&cache, 1));
+  DiscardableMemory::PurgeForTesting();
+
+  EXPECT_FALSE(Cache::ScopedLock(&cache, 1).memory());
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.bytes());
+}
+
+}  // namespace base
@@ -0,0 +1,96 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/task_arena.h"
+
+#include <stdlib.h>
+
+#include "base/message_loop/message_loop.h"
+
+namespace base {
+
+struct TaskArena::Block {
+  Block* next;
+};
+
+namespace {
+
+// The blocks' memory starts this far past their header, to keep it aligned.
+const size_t kBlockHeaderSize = 16;
+
+}  // namespace
+
+TaskArena::TaskArena()
+    : next_(NULL),
+      end_(NULL),
+      first_block_(NULL),
+      extra_blocks_(NULL),
+      task_depth_(0),
+      generation_(0),
+      heap_allocation_count_(0) {
+  COMPILE_ASSERT(sizeof(Block) <= kBlockHeaderSize, block_header_too_big);
+}
+
+TaskArena::~TaskArena() {
+  DCHECK(!in_task());
+  Reset();
+  free(first_block_);
+}
+
+// static
+TaskArena* TaskArena::Current() {
+  MessageLoop* loop = MessageLoop::current();
+  if (!loop || !loop->task_arena()->in_task())
+    return NULL;
+  return loop->task_arena();
+}
+
+void* TaskArena::AllocateSlow(size_t size) {
+  if (!first_block_) {
+    first_block_ = NewBlock(kBlockSize);
+    next_ = BlockMemory(first_block_);
+    end_ = next_ + kBlockSize;
+    return Allocate(size);
+  }
+
+  // Large allocations get a block of their own, so that the rest of the
+  // current block isn't wasted.
+  size_t block_size = size > kBlockSize / 4 ? size : kBlockSize;
+  Block* block = NewBlock(block_size);
+  block->next = extra_blocks_;
+  extra_blocks_ = block;
+  char* memory = BlockMemory(block);
+  if (block_size == kBlockSize) {
+    next_ = memory + size;
+    end_ = memory + kBlockSize;
+  }
+  return memory;
+}
+
+TaskArena::Block* TaskArena::NewBlock(size_t size) {
+  ++heap_allocation_count_;
+  void* block = malloc(kBlockHeaderSize + size);
+  CHECK(block);
+  return static_cast<Block*>(block);
+}
+
+// static
+char* TaskArena::BlockMemory(Block* block) {
+  return reinterpret_cast<char*>(block) + kBlockHeaderSize;
+}
+
+void TaskArena::Reset() {
+  while (extra_blocks_) {
+    Block* next = extra_blocks_->next;
+    free(extra_blocks_);
+    extra_blocks_ = next;
+  }
+  if (first_block_) {
+    next_ = BlockMemory(first_block_);
+    end_ = next_ + kBlockSize;
+  }
+  ++generation_;
+}
+
+}  // namespace base
@@ -0,0 +1,162 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_TASK_ARENA_H_
+#define BASE_MEMORY_TASK_ARENA_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/logging.h"
+
+namespace base {
+
+// TaskArena is a bump pointer allocator for objects that die before the
+// MessageLoop task that made them ends. Each MessageLoop has one; it hands out
+// memory while a task runs and takes it all back when the outermost task
+// returns, so short-lived allocations on hot paths don't go to the heap.
+//
+// Memory from the arena is never freed individually and destructors aren't
+// run for it, so it suits buffers and trivially destructible objects. Most
+// code should use it through TaskArenaAllocator below.
+class BASE_EXPORT TaskArena {
+ public:
+  TaskArena();
+  ~TaskArena();
+
+  // Returns the arena of the task running on the current thread, or NULL if
+  // the thread isn't running a MessageLoop task.
+  static TaskArena* Current();
+
+  // Returns |size| bytes aligned for any type. The memory stays valid until
+  // the outermost task ends.
+  void* Allocate(size_t size) {
+    DCHECK(in_task());
+    size = (size + kAlignment - 1) & ~(kAlignment - 1);
+    if (size > static_cast<size_t>(end_ - next_))
+      return AllocateSlow(size);
+    void* result = next_;
+    next_ += size;
+    return result;
+  }
+
+  // Called by MessageLoop around each task it runs. Tasks nest when a task
+  // spins a nested loop; the arena is reset when the outermost one ends.
+  void WillRunTask() { ++task_depth_; }
+  void DidRunTask() {
+    DCHECK_GT(task_depth_, 0);
+    if (--task_depth_ == 0)
+      Reset();
+  }
+
+  bool in_task() const { return task_depth_ > 0; }
+
+  // Changes every time the arena is reset, so that users can check that their
+  // memory is still valid.
+  uint32 generation() const { return generation_; }
+
+  // The number of heap allocations the arena has made for its blocks.
+  size_t heap_allocation_count() const { return heap_allocation_count_; }
+
+ private:
+  struct Block;
+
+  enum {
+    kAlignment = 16,
+    // The size of the block the arena keeps between tasks.
+    kBlockSize = 16 * 1024
+  };
+
+  // Finds room for |size| bytes in a new block.
+  void* AllocateSlow(size_t size);
+
+  // Returns a block with room for |size| bytes from the heap.
+  Block* NewBlock(size_t size);
+  static char* BlockMemory(Block* block);
+
+  // Frees all blocks but the first and makes it empty.
+  void Reset();
+
+  // The free part of the current block.
+  char* next_;
+  char* end_;
+
+  // The first block is kept between tasks, the others are freed.
+  Block* first_block_;
+  Block* extra_blocks_;
+
+  int task_depth_;
+  uint32 generation_;
+  size_t heap_allocation_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskArena);
+};
+
+// An STL allocator that takes memory from the arena of the current task, or
+// from the heap when there is no task. A container using it must not outlive
+// the task it was made in:
+//
+//   TaskArenaVector<Layer*>::Type sorted_children;
+//
+// Frees are ignored unless the memory came from the heap.
+template <typename T>
+class TaskArenaAllocator : public std::allocator<T> {
+ public:
+  typedef typename std::allocator<T>::pointer pointer;
+  typedef typename std::allocator<T>::size_type size_type;
+
+  template <typename U>
+  struct rebind {
+    typedef TaskArenaAllocator<U> other;
+  };
+
+  TaskArenaAllocator()
+      : arena_(TaskArena::Current()),
+        generation_(arena_ ? arena_->generation() : 0) {
+  }
+
+  TaskArenaAllocator(const TaskArenaAllocator<T>& other)
+      : std::allocator<T>(),
+        arena_(other.arena()),
+        generation_(other.generation()) {
+  }
+
+  template <typename U>
+  TaskArenaAllocator(const TaskArenaAllocator<U>& other)
+      : arena_(other.arena()),
+        generation_(other.generation()) {
+  }
+
+  pointer allocate(size_type n, const void* hint = 0) {
+    if (!arena_)
+      return std::allocator<T>::allocate(n, hint);
+    DCHECK_EQ(generation_, arena_->generation())
+        << "The container outlived its task";
+    return static_cast<pointer>(arena_->Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(pointer p, size_type n) {
+    if (!arena_)
+      std::allocator<T>::deallocate(p, n);
+  }
+
+  TaskArena* arena() const { return arena_; }
+  uint32 generation() const { return generation_; }
+
+ private:
+  TaskArena* arena_;
+  uint32 generation_;
+};
+
+// A vector of T that lives in the current task's arena.
+template <typename T>
+struct TaskArenaVector {
+  typedef std::vector<T, TaskArenaAllocator<T> > Type;
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_TASK_ARENA_H_
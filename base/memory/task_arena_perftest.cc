@@ -0,0 +1,94 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the time and the heap allocations it takes to run tasks that build
+// short-lived vectors, as draw property computation does for each layer,
+// with the vectors on the heap and in the task's arena.
+
+#include "base/memory/task_arena.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/test/perf_log.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kNumTasks = 10000;
+const int kVectorsPerTask = 20;
+const int kElementsPerVector = 100;
+
+int g_heap_allocations = 0;
+
+// std::allocator that counts its allocations.
+template <typename T>
+class CountingAllocator : public std::allocator<T> {
+ public:
+  typedef typename std::allocator<T>::pointer pointer;
+  typedef typename std::allocator<T>::size_type size_type;
+
+  template <typename U>
+  struct rebind {
+    typedef CountingAllocator<U> other;
+  };
+
+  CountingAllocator() {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other) {}
+
+  pointer allocate(size_type n, const void* hint = 0) {
+    ++g_heap_allocations;
+    return std::allocator<T>::allocate(n, hint);
+  }
+};
+
+template <typename Vector>
+void BuildVectors() {
+  for (int i = 0; i < kVectorsPerTask; ++i) {
+    Vector values;
+    for (int j = 0; j < kElementsPerVector; ++j)
+      values.push_back(&values);
+  }
+}
+
+// Runs kNumTasks tasks that each call |task|, and logs how long they took and
+// how many heap allocations they made.
+void RunTasks(const char* name, void (*task)()) {
+  MessageLoop message_loop;
+  for (int i = 0; i < kNumTasks; ++i)
+    message_loop.PostTask(FROM_HERE, Bind(task));
+  g_heap_allocations = 0;
+  size_t arena_heap_allocations =
+      message_loop.task_arena()->heap_allocation_count();
+
+  PerfTimeLogger logger(name);
+  RunLoop().RunUntilIdle();
+  logger.Done();
+
+  arena_heap_allocations =
+      message_loop.task_arena()->heap_allocation_count() -
+      arena_heap_allocations;
+  LogPerfResult(
+      (std::string(name) + "_HeapAllocationsPerTask").c_str(),
+      static_cast<double>(g_heap_allocations + arena_heap_allocations) /
+          kNumTasks,
+      "allocations");
+}
+
+}  // namespace
+
+TEST(TaskArenaPerfTest, ShortLivedVectors) {
+  RunTasks("TaskArena_Heap",
+           &BuildVectors<std::vector<void*, CountingAllocator<void*> > >);
+  RunTasks("TaskArena_Arena", &BuildVectors<TaskArenaVector<void*>::Type>);
+}
+
+}  // namespace base
@@ -0,0 +1,119 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/task_arena.h"
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+void CheckSmallAllocations(size_t* heap_allocations) {
+  TaskArena* arena = TaskArena::Current();
+  ASSERT_TRUE(arena);
+  char* first = static_cast<char*>(arena->Allocate(1));
+  char* second = static_cast<char*>(arena->Allocate(24));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(first) % 16);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second) % 16);
+  EXPECT_EQ(first + 16, second);
+  for (int i = 0; i < 100; ++i)
+    arena->Allocate(64);
+  *heap_allocations = arena->heap_allocation_count();
+}
+
+void CheckLargeAllocation() {
+  TaskArena* arena = TaskArena::Current();
+  ASSERT_TRUE(arena);
+  char* small = static_cast<char*>(arena->Allocate(16));
+  size_t heap_allocations = arena->heap_allocation_count();
+  arena->Allocate(1024 * 1024);
+  EXPECT_EQ(heap_allocations + 1, arena->heap_allocation_count());
+  // The current block is still used for small allocations.
+  EXPECT_EQ(small + 16, arena->Allocate(16));
+}
+
+void FillVector(int* sum) {
+  TaskArenaVector<int>::Type values;
+  EXPECT_EQ(TaskArena::Current(), values.get_allocator().arena());
+  for (int i = 0; i < 1000; ++i)
+    values.push_back(i);
+  *sum = 0;
+  for (size_t i = 0; i < values.size(); ++i)
+    *sum += values[i];
+}
+
+void RecordGeneration(uint32* generation) {
+  *generation = TaskArena::Current()->generation();
+}
+
+void RunNestedTask(uint32* outer_generation, uint32* inner_generation) {
+  *outer_generation = TaskArena::Current()->generation();
+  MessageLoop::ScopedNestableTaskAllower allow(MessageLoop::current());
+  RunLoop run_loop;
+  MessageLoop::current()->PostTask(
+      FROM_HERE, Bind(&RecordGeneration, inner_generation));
+  MessageLoop::current()->PostTask(FROM_HERE, run_loop.QuitClosure());
+  run_loop.Run();
+  // The inner task didn't reset the arena.
+  EXPECT_EQ(*outer_generation, TaskArena::Current()->generation());
+}
+
+}  // namespace
+
+TEST(TaskArenaTest, OnlyInTasks) {
+  EXPECT_FALSE(TaskArena::Current());
+  MessageLoop message_loop;
+  EXPECT_FALSE(TaskArena::Current());
+  EXPECT_FALSE(message_loop.task_arena()->in_task());
+}
+
+TEST(TaskArenaTest, KeepsFirstBlock) {
+  MessageLoop message_loop;
+  size_t first_task_heap_allocations = 0;
+  size_t second_task_heap_allocations = 0;
+  message_loop.PostTask(
+      FROM_HERE, Bind(&CheckSmallAllocations, &first_task_heap_allocations));
+  message_loop.PostTask(
+      FROM_HERE, Bind(&CheckSmallAllocations, &second_task_heap_allocations));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(1u, first_task_heap_allocations);
+  EXPECT_EQ(1u, second_task_heap_allocations);
+}
+
+TEST(TaskArenaTest, LargeAllocation) {
+  MessageLoop message_loop;
+  message_loop.PostTask(FROM_HERE, Bind(&CheckLargeAllocation));
+  RunLoop().RunUntilIdle();
+}
+
+TEST(TaskArenaTest, ResetsAfterOutermostTask) {
+  MessageLoop message_loop;
+  uint32 outer_generation = 0;
+  uint32 inner_generation = 1;
+  message_loop.PostTask(
+      FROM_HERE,
+      Bind(&RunNestedTask, &outer_generation, &inner_generation));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(outer_generation, inner_generation);
+  EXPECT_NE(outer_generation, message_loop.task_arena()->generation());
+}
+
+TEST(TaskArenaTest, Allocator) {
+  // Outside a task the allocator uses the heap.
+  int sum = 0;
+  FillVector(&sum);
+  EXPECT_EQ(499500, sum);
+
+  MessageLoop message_loop;
+  sum = 0;
+  message_loop.PostTask(FROM_HERE, Bind(&FillVector, &sum));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(499500, sum);
+}
+
+}  // namespace base
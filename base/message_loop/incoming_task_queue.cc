@@ -8,12 +8,16 @@
 #include "base/location.h"
 #include "base/message_loop/message_loop.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
 
 namespace base {
 namespace internal {
 
 IncomingTaskQueue::IncomingTaskQueue(MessageLoop* message_loop)
-    : message_loop_(message_loop),
+    : immediate_work_scheduled_(0),
+      immediate_posts_in_progress_(0),
+      message_loop_destroyed_(0),
+      message_loop_(message_loop),
       next_sequence_num_(0) {
 }
 
@@ -22,6 +26,11 @@ bool IncomingTaskQueue::AddToIncomingQueue(
     const Closure& task,
     TimeDelta delay,
     bool nestable) {
+  if (delay == TimeDelta()) {
+    PendingTask pending_task(from_here, task, TimeTicks(), nestable);
+    return PostImmediatePendingTask(&pending_task);
+  }
+
   AutoLock locked(incoming_queue_lock_);
   PendingTask pending_task(
       from_here, task, CalculateDelayedRuntime(delay), nestable);
@@ -38,17 +47,30 @@ bool IncomingTaskQueue::IsHighResolutionTimerEnabledForTesting() {
 
 bool IncomingTaskQueue::IsIdleForTesting() {
   AutoLock lock(incoming_queue_lock_);
-  return incoming_queue_.empty();
+  return incoming_queue_.empty() && immediate_queue_.IsEmpty();
 }
 
 void IncomingTaskQueue::ReloadWorkQueue(TaskQueue* work_queue) {
   // Make sure no tasks are lost.
   DCHECK(work_queue->empty());
 
-  // Acquire all we can from the inter-thread queue with one lock acquisition.
+  // Let the next immediate task posted wake up the pump. This has to happen
+  // before emptying |immediate_queue_|: a task pushed too late to be seen below
+  // will then find the flag clear.
+  subtle::NoBarrier_Store(&immediate_work_scheduled_, 0);
+  subtle::MemoryBarrier();
+  immediate_queue_.PopAll(work_queue);
+
+  // Acquire all we can from the delayed queue with one lock acquisition.
   AutoLock lock(incoming_queue_lock_);
-  if (!incoming_queue_.empty())
+  if (work_queue->empty()) {
     incoming_queue_.Swap(work_queue);  // Constant time
+  } else {
+    while (!incoming_queue_.empty()) {
+      work_queue->push(incoming_queue_.front());
+      incoming_queue_.pop();
+    }
+  }
 
   DCHECK(incoming_queue_.empty());
 }
@@ -64,6 +86,13 @@ void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
   }
 #endif
 
+  // Turn away new immediate posts, and wait for the ones already past that
+  // check to finish with |message_loop_|.
+  subtle::NoBarrier_Store(&message_loop_destroyed_, 1);
+  subtle::MemoryBarrier();
+  while (subtle::Acquire_Load(&immediate_posts_in_progress_))
+    PlatformThread::YieldCurrentThread();
+
   AutoLock lock(incoming_queue_lock_);
   message_loop_ = NULL;
 }
@@ -125,14 +154,7 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
     return false;
   }
 
-  // Initialize the sequence number. The sequence number is used for delayed
-  // tasks (to faciliate FIFO sorting when two tasks have the same
-  // delayed_run_time value) and for identifying the task in about:tracing.
-  pending_task->sequence_num = next_sequence_num_++;
-
-  TRACE_EVENT_FLOW_BEGIN0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
-      "MessageLoop::PostTask",
-      TRACE_ID_MANGLE(message_loop_->GetTaskTraceID(*pending_task)));
+  WillQueuePendingTask(pending_task);
 
   bool was_empty = incoming_queue_.empty();
   incoming_queue_.push(*pending_task);
@@ -144,5 +166,43 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
   return true;
 }
 
+bool IncomingTaskQueue::PostImmediatePendingTask(PendingTask* pending_task) {
+  // See PostPendingTask() about not short-circuiting this thread's tasks.
+
+  subtle::Barrier_AtomicIncrement(&immediate_posts_in_progress_, 1);
+  if (subtle::Acquire_Load(&message_loop_destroyed_)) {
+    subtle::Barrier_AtomicIncrement(&immediate_posts_in_progress_, -1);
+    pending_task->task.Reset();
+    return false;
+  }
+
+  WillQueuePendingTask(pending_task);
+  immediate_queue_.Push(*pending_task);
+  pending_task->task.Reset();
+
+  // Wake up the pump, unless this isn't the first task since the last
+  // ReloadWorkQueue(). The task has to be in the queue before the flag is
+  // checked, see ReloadWorkQueue().
+  subtle::MemoryBarrier();
+  bool was_empty =
+      !subtle::NoBarrier_AtomicExchange(&immediate_work_scheduled_, 1);
+  message_loop_->ScheduleWork(was_empty);
+
+  subtle::Barrier_AtomicIncrement(&immediate_posts_in_progress_, -1);
+  return true;
+}
+
+void IncomingTaskQueue::WillQueuePendingTask(PendingTask* pending_task) {
+  // Initialize the sequence number. The sequence number is used for delayed
+  // tasks (to faciliate FIFO sorting when two tasks have the same
+  // delayed_run_time value) and for identifying the task in about:tracing.
+  pending_task->sequence_num =
+      subtle::NoBarrier_AtomicIncrement(&next_sequence_num_, 1) - 1;
+
+  TRACE_EVENT_FLOW_BEGIN0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
+      "MessageLoop::PostTask",
+      TRACE_ID_MANGLE(message_loop_->GetTaskTraceID(*pending_task)));
+}
+
 }  // namespace internal
 }  // namespace base
@@ -5,8 +5,10 @@
 #ifndef BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 #define BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/memory/ref_counted.h"
+#include "base/message_loop/lock_free_task_queue.h"
 #include "base/pending_task.h"
 #include "base/synchronization/lock.h"
 #include "base/time/time.h"
@@ -21,6 +23,11 @@ namespace internal {
 // Implements a queue of tasks posted to the message loop running on the current
 // thread. This class takes care of synchronizing posting tasks from different
 // threads and together with MessageLoop ensures clean shutdown.
+//
+// Immediate tasks, by far the most common kind, go through a lock-free queue
+// so that threads posting to a busy loop don't contend on a lock with each
+// other or with the loop. Delayed tasks are rare enough to keep using
+// |incoming_queue_| under |incoming_queue_lock_|.
 class BASE_EXPORT IncomingTaskQueue
     : public RefCountedThreadSafe<IncomingTaskQueue> {
  public:
@@ -65,24 +72,46 @@ class BASE_EXPORT IncomingTaskQueue
   // does not retain |pending_task->task| beyond this function call.
   bool PostPendingTask(PendingTask* pending_task);
 
+  // Like PostPendingTask(), but for a task with no delay, which is added to
+  // |immediate_queue_| without taking |incoming_queue_lock_|.
+  bool PostImmediatePendingTask(PendingTask* pending_task);
+
+  // Assigns |pending_task| its sequence number and starts its trace flow.
+  void WillQueuePendingTask(PendingTask* pending_task);
+
 #if defined(OS_WIN)
   TimeTicks high_resolution_timer_expiration_;
 #endif
 
-  // The lock that protects access to |incoming_queue_|, |message_loop_| and
-  // |next_sequence_num_|.
+  // The lock that protects access to |incoming_queue_| and, for delayed tasks,
+  // |message_loop_|.
   base::Lock incoming_queue_lock_;
 
-  // An incoming queue of tasks that are acquired under a mutex for processing
-  // on this instance's thread. These tasks have not yet been been pushed to
-  // |message_loop_|.
+  // An incoming queue of delayed tasks that are acquired under a mutex for
+  // processing on this instance's thread. These tasks have not yet been been
+  // pushed to |message_loop_|.
   TaskQueue incoming_queue_;
 
+  // The incoming queue of immediate tasks, which needs no lock.
+  LockFreeTaskQueue immediate_queue_;
+
+  // Non-zero once |message_loop_| has been told about tasks in
+  // |immediate_queue_|. ReloadWorkQueue() clears it before emptying the queue,
+  // so the first task posted after that wakes up the pump, like a post to an
+  // empty |incoming_queue_| does.
+  subtle::Atomic32 immediate_work_scheduled_;
+
+  // The number of threads in PostImmediatePendingTask() past the check of
+  // |message_loop_destroyed_|. WillDestroyCurrentMessageLoop() waits for them
+  // to finish with |message_loop_| before clearing it.
+  subtle::Atomic32 immediate_posts_in_progress_;
+  subtle::Atomic32 message_loop_destroyed_;
+
   // Points to the message loop that owns |this|.
   MessageLoop* message_loop_;
 
-  // The next sequence number to use for delayed tasks.
-  int next_sequence_num_;
+  // The next sequence number to use for tasks.
+  subtle::Atomic32 next_sequence_num_;
 
   DISALLOW_COPY_AND_ASSIGN(IncomingTaskQueue);
 };
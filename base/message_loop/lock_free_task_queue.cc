@@ -0,0 +1,82 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/lock_free_task_queue.h"
+
+#include "base/logging.h"
+
+namespace base {
+namespace internal {
+
+LockFreeTaskQueue::LockFreeTaskQueue()
+    : head_(reinterpret_cast<subtle::AtomicWord>(&stub_)),
+      tail_(&stub_) {
+}
+
+LockFreeTaskQueue::~LockFreeTaskQueue() {
+  // Delete the tasks with the queue still in a consistent state, in case
+  // deleting one of them looks at the queue.
+  TaskQueue tasks;
+  PopAll(&tasks);
+  DCHECK(IsEmpty());
+}
+
+void LockFreeTaskQueue::Push(const PendingTask& pending_task) {
+  PushLink(new Node(pending_task));
+}
+
+size_t LockFreeTaskQueue::PopAll(TaskQueue* work_queue) {
+  size_t count = 0;
+  while (PopOne(work_queue))
+    ++count;
+  return count;
+}
+
+bool LockFreeTaskQueue::IsEmpty() const {
+  return tail_ == &stub_ && !subtle::Acquire_Load(&stub_.next);
+}
+
+void LockFreeTaskQueue::PushLink(Link* link) {
+  subtle::NoBarrier_Store(&link->next, 0);
+  Link* previous = reinterpret_cast<Link*>(subtle::NoBarrier_AtomicExchange(
+      &head_, reinterpret_cast<subtle::AtomicWord>(link)));
+  // Until this store, the consumer can't get from |previous| to |link| or any
+  // link pushed after it. The release makes |link|'s task visible along with
+  // it.
+  subtle::Release_Store(&previous->next,
+                        reinterpret_cast<subtle::AtomicWord>(link));
+}
+
+bool LockFreeTaskQueue::PopOne(TaskQueue* work_queue) {
+  Link* tail = tail_;
+  Link* next = reinterpret_cast<Link*>(subtle::Acquire_Load(&tail->next));
+  if (tail == &stub_) {
+    if (!next)
+      return false;
+    tail_ = next;
+    tail = next;
+    next = reinterpret_cast<Link*>(subtle::Acquire_Load(&tail->next));
+  }
+
+  if (!next) {
+    // |tail| is the last visible node. Unless a producer is between swapping
+    // |head_| and linking, it is also the newest one: push the stub behind it
+    // so it can be removed without leaving the list empty.
+    if (tail != reinterpret_cast<Link*>(subtle::Acquire_Load(&head_)))
+      return false;
+    PushLink(&stub_);
+    next = reinterpret_cast<Link*>(subtle::Acquire_Load(&tail->next));
+    if (!next)
+      return false;
+  }
+
+  tail_ = next;
+  Node* node = static_cast<Node*>(tail);
+  work_queue->push(node->task);
+  delete node;
+  return true;
+}
+
+}  // namespace internal
+}  // namespace base
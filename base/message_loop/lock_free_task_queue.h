@@ -0,0 +1,81 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
+#define BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
+
+#include "base/atomicops.h"
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/pending_task.h"
+
+namespace base {
+namespace internal {
+
+// A multi-producer, single-consumer FIFO of PendingTasks that doesn't take a
+// lock. Any thread may call Push(); only one thread at a time, the consumer,
+// may call the other methods.
+//
+// This is an intrusive linked list where producers atomically swap themselves
+// in as the newest node and then link the previous newest node to theirs,
+// after D. Vyukov's non-blocking MPSC queue. Tasks pushed by one thread come
+// out in the order they were pushed. A task becomes visible to the consumer
+// once its Push() has linked it in; until then the queue may briefly look
+// shorter than it is, so producers need to let the consumer know about new
+// tasks after Push() returns, not before.
+class BASE_EXPORT LockFreeTaskQueue {
+ public:
+  LockFreeTaskQueue();
+
+  // Deletes any tasks still in the queue.
+  ~LockFreeTaskQueue();
+
+  // Appends a copy of |pending_task|. May be called on any thread.
+  void Push(const PendingTask& pending_task);
+
+  // Moves every task that is visible to the consumer to the back of
+  // |work_queue|, oldest first. Returns the number of tasks moved.
+  size_t PopAll(TaskQueue* work_queue);
+
+  // Returns true if there are no tasks visible to the consumer.
+  bool IsEmpty() const;
+
+ private:
+  struct Link {
+    Link() : next(0) {}
+
+    // The next newer Link, or 0.
+    subtle::AtomicWord next;
+  };
+
+  struct Node : public Link {
+    explicit Node(const PendingTask& pending_task) : task(pending_task) {}
+
+    PendingTask task;
+  };
+
+  // Makes |link| the newest link in the list.
+  void PushLink(Link* link);
+
+  // Removes the oldest node and moves its task to |work_queue|. Returns false
+  // if no node is visible.
+  bool PopOne(TaskQueue* work_queue);
+
+  // The newest link. Written by producers.
+  subtle::AtomicWord head_;
+
+  // The oldest link. Only touched by the consumer.
+  Link* tail_;
+
+  // Stays in the list when it is otherwise empty, so producers never have to
+  // update |tail_|.
+  Link stub_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeTaskQueue);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
@@ -0,0 +1,140 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/lock_free_task_queue.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/location.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+class RefCountedObject : public RefCountedThreadSafe<RefCountedObject> {
+ private:
+  friend class RefCountedThreadSafe<RefCountedObject>;
+  ~RefCountedObject() {}
+};
+
+void TakeRef(RefCountedObject* object) {}
+
+// Tasks are told apart by their |sequence_num|, which the queue doesn't use.
+PendingTask MakeTask(int id) {
+  PendingTask task(FROM_HERE, Bind(&DoNothing));
+  task.sequence_num = id;
+  return task;
+}
+
+// Pushes |count| tasks numbered |first_id| onwards.
+class Producer : public DelegateSimpleThread::Delegate {
+ public:
+  Producer(LockFreeTaskQueue* queue, int first_id, int count)
+      : queue_(queue), first_id_(first_id), count_(count) {}
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < count_; ++i)
+      queue_->Push(MakeTask(first_id_ + i));
+  }
+
+ private:
+  LockFreeTaskQueue* const queue_;
+  const int first_id_;
+  const int count_;
+};
+
+}  // namespace
+
+TEST(LockFreeTaskQueueTest, Empty) {
+  LockFreeTaskQueue queue;
+  EXPECT_TRUE(queue.IsEmpty());
+  TaskQueue work_queue;
+  EXPECT_EQ(0u, queue.PopAll(&work_queue));
+  EXPECT_TRUE(work_queue.empty());
+}
+
+TEST(LockFreeTaskQueueTest, FIFO) {
+  LockFreeTaskQueue queue;
+  TaskQueue work_queue;
+  queue.Push(MakeTask(0));
+  queue.Push(MakeTask(1));
+  EXPECT_FALSE(queue.IsEmpty());
+  EXPECT_EQ(2u, queue.PopAll(&work_queue));
+  EXPECT_TRUE(queue.IsEmpty());
+
+  // Tasks pushed after PopAll() go behind the ones already popped.
+  queue.Push(MakeTask(2));
+  EXPECT_EQ(1u, queue.PopAll(&work_queue));
+  queue.Push(MakeTask(3));
+  queue.Push(MakeTask(4));
+  EXPECT_EQ(2u, queue.PopAll(&work_queue));
+  EXPECT_TRUE(queue.IsEmpty());
+
+  ASSERT_EQ(5u, work_queue.size());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i, work_queue.front().sequence_num);
+    work_queue.pop();
+  }
+}
+
+// Tasks left in the queue are deleted with it.
+TEST(LockFreeTaskQueueTest, DeletesTasks) {
+  scoped_refptr<RefCountedObject> object(new RefCountedObject);
+  {
+    LockFreeTaskQueue queue;
+    queue.Push(PendingTask(FROM_HERE, Bind(&DoNothing)));
+    queue.Push(PendingTask(FROM_HERE, Bind(&TakeRef, object)));
+    EXPECT_FALSE(object->HasOneRef());
+  }
+  EXPECT_TRUE(object->HasOneRef());
+}
+
+// Tasks from several threads all come out, each thread's in the order it
+// pushed them.
+TEST(LockFreeTaskQueueTest, MultipleProducers) {
+  const int kNumThreads = 4;
+  const int kTasksPerThread = 10000;
+
+  LockFreeTaskQueue queue;
+  ScopedVector<Producer> producers;
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    producers.push_back(
+        new Producer(&queue, i * kTasksPerThread, kTasksPerThread));
+    threads.push_back(new DelegateSimpleThread(producers.back(), "Producer"));
+  }
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Start();
+
+  std::vector<int> next_id(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i)
+    next_id[i] = i * kTasksPerThread;
+  int tasks_popped = 0;
+  TaskQueue work_queue;
+  while (tasks_popped < kNumThreads * kTasksPerThread) {
+    queue.PopAll(&work_queue);
+    while (!work_queue.empty()) {
+      int id = work_queue.front().sequence_num;
+      work_queue.pop();
+      int thread = id / kTasksPerThread;
+      ASSERT_EQ(next_id[thread], id);
+      ++next_id[thread];
+      ++tasks_popped;
+    }
+  }
+
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+}  // namespace internal
+}  // namespace base
@@ -115,6 +115,8 @@ MessageLoop::DestructionObserver::~DestructionObserver() {
 
 MessageLoop::MessageLoop(Type type)
     : type_(type),
+      timer_slack_(TIMER_SLACK_NONE),
+      delayed_work_wakeups_(0),
       nestable_tasks_allowed_(true),
 #if defined(OS_WIN)
       os_modal_loop_(false),
@@ -129,6 +131,8 @@ MessageLoop::MessageLoop(Type type)
 MessageLoop::MessageLoop(scoped_ptr<MessagePump> pump)
     : pump_(pump.Pass()),
       type_(TYPE_CUSTOM),
+      timer_slack_(TIMER_SLACK_NONE),
+      delayed_work_wakeups_(0),
       nestable_tasks_allowed_(true),
 #if defined(OS_WIN)
       os_modal_loop_(false),
@@ -343,6 +347,17 @@ bool MessageLoop::IsNested() {
   return run_loop_->run_depth_ > 1;
 }
 
+void MessageLoop::SetTimerSlack(TimerSlack timer_slack) {
+  DCHECK_EQ(this, current());
+  timer_slack_ = timer_slack;
+  pump_->SetTimerSlack(timer_slack);
+  // The pump may be waiting for a time rounded for the old setting.
+  if (!delayed_work_queue_.empty()) {
+    pump_->ScheduleDelayedWork(
+        CoalesceDelayedRunTime(delayed_work_queue_.top().delayed_run_time));
+  }
+}
+
 void MessageLoop::AddTaskObserver(TaskObserver* task_observer) {
   DCHECK_EQ(this, current());
   task_observers_.AddObserver(task_observer);
@@ -442,11 +457,13 @@ void MessageLoop::RunTask(const PendingTask& pending_task) {
 
   HistogramEvent(kTaskRunEvent);
 
+  task_arena_.WillRunTask();
   FOR_EACH_OBSERVER(TaskObserver, task_observers_,
                     WillProcessTask(pending_task));
   pending_task.task.Run();
   FOR_EACH_OBSERVER(TaskObserver, task_observers_,
                     DidProcessTask(pending_task));
+  task_arena_.DidRunTask();
 
   tracked_objects::ThreadData::TallyRunOnNamedThreadIfTracking(pending_task,
       start_time, tracked_objects::ThreadData::NowForEndOfRun());
@@ -473,6 +490,35 @@ void MessageLoop::AddToDelayedWorkQueue(const PendingTask& pending_task) {
   delayed_work_queue_.push(pending_task);
 }
 
+TimeTicks MessageLoop::CoalesceDelayedRunTime(
+    TimeTicks delayed_run_time) const {
+  if (timer_slack_ == TIMER_SLACK_NONE)
+    return delayed_run_time;
+
+  // Round up to the next multiple of the slack. Every thread that does this
+  // rounds the same way, so their wakeups line up too.
+  const int64 slack =
+      TimeDelta::FromMilliseconds(kTimerSlackMaximumMs).ToInternalValue();
+  int64 run_time = delayed_run_time.ToInternalValue();
+  return TimeTicks::FromInternalValue((run_time + slack - 1) / slack * slack);
+}
+
+void MessageLoop::RecordDelayedWorkWakeup() {
+  ++delayed_work_wakeups_;
+  if (delayed_work_wakeups_start_.is_null()) {
+    delayed_work_wakeups_start_ = recent_time_;
+    return;
+  }
+  TimeDelta elapsed = recent_time_ - delayed_work_wakeups_start_;
+  if (elapsed < TimeDelta::FromSeconds(1))
+    return;
+  TRACE_COUNTER_ID1("base", "MessageLoop::DelayedWorkWakeupsPerSecond", this,
+                    static_cast<int>(delayed_work_wakeups_ /
+                                     elapsed.InSecondsF()));
+  delayed_work_wakeups_ = 0;
+  delayed_work_wakeups_start_ = recent_time_;
+}
+
 bool MessageLoop::DeletePendingTasks() {
   bool did_work = !work_queue_.empty();
   while (!work_queue_.empty()) {
@@ -567,8 +613,10 @@ bool MessageLoop::DoWork() {
       if (!pending_task.delayed_run_time.is_null()) {
         AddToDelayedWorkQueue(pending_task);
         // If we changed the topmost task, then it is time to reschedule.
-        if (delayed_work_queue_.top().task.Equals(pending_task.task))
-          pump_->ScheduleDelayedWork(pending_task.delayed_run_time);
+        if (delayed_work_queue_.top().task.Equals(pending_task.task)) {
+          pump_->ScheduleDelayedWork(
+              CoalesceDelayedRunTime(pending_task.delayed_run_time));
+        }
       } else {
         if (DeferOrRunPendingTask(pending_task))
           return true;
@@ -597,16 +645,19 @@ bool MessageLoop::DoDelayedWork(TimeTicks* next_delayed_work_time) {
   if (next_run_time > recent_time_) {
     recent_time_ = TimeTicks::Now();  // Get a better view of Now();
     if (next_run_time > recent_time_) {
-      *next_delayed_work_time = next_run_time;
+      *next_delayed_work_time = CoalesceDelayedRunTime(next_run_time);
       return false;
     }
+    RecordDelayedWorkWakeup();
   }
 
   PendingTask pending_task = delayed_work_queue_.top();
   delayed_work_queue_.pop();
 
-  if (!delayed_work_queue_.empty())
-    *next_delayed_work_time = delayed_work_queue_.top().delayed_run_time;
+  if (!delayed_work_queue_.empty()) {
+    *next_delayed_work_time =
+        CoalesceDelayedRunTime(delayed_work_queue_.top().delayed_run_time);
+  }
 
   return DeferOrRunPendingTask(pending_task);
 }
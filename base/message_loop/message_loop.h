@@ -14,10 +14,12 @@
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/task_arena.h"
 #include "base/message_loop/incoming_task_queue.h"
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/message_loop/message_loop_proxy_impl.h"
 #include "base/message_loop/message_pump.h"
+#include "base/message_loop/timer_slack.h"
 #include "base/observer_list.h"
 #include "base/pending_task.h"
 #include "base/sequenced_task_runner_helpers.h"
@@ -317,6 +319,10 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
     return message_loop_proxy_;
   }
 
+  // Gets the arena for the tasks of this loop. Most callers want
+  // TaskArena::Current() instead.
+  TaskArena* task_arena() { return &task_arena_; }
+
   // Enables or disables the recursive task processing. This happens in the case
   // of recursive message loops. Some unwanted message loop may occurs when
   // using common controls or printer functions. By default, recursive task
@@ -359,6 +365,14 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
   // Returns true if we are currently running a nested message loop.
   bool IsNested();
 
+  // Sets how precisely delayed tasks are run. With TIMER_SLACK_MAXIMUM, the
+  // loop only wakes up for delayed work at multiples of kTimerSlackMaximumMs
+  // on the TimeTicks clock, and runs all the tasks that have come due by then,
+  // so timers with nearby deadlines share one wakeup instead of each waking
+  // the thread. Meant for threads with nothing the user is waiting on, such
+  // as those of background processes. Must be called on this loop's thread.
+  void SetTimerSlack(TimerSlack timer_slack);
+
   // A TaskObserver is an object that receives task notifications from the
   // MessageLoop.
   //
@@ -451,6 +465,13 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
   // Adds the pending task to delayed_work_queue_.
   void AddToDelayedWorkQueue(const PendingTask& pending_task);
 
+  // Returns when to wake up for a delayed task due at |delayed_run_time|,
+  // given |timer_slack_|.
+  TimeTicks CoalesceDelayedRunTime(TimeTicks delayed_run_time) const;
+
+  // Counts a wakeup for delayed work, see |delayed_work_wakeups_|.
+  void RecordDelayedWorkWakeup();
+
   // Delete tasks that haven't run yet without running them.  Used in the
   // destructor to make sure all the task's destructors get called.  Returns
   // true if some work was done.
@@ -497,6 +518,13 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
   // A recent snapshot of Time::Now(), used to check delayed_work_queue_.
   TimeTicks recent_time_;
 
+  TimerSlack timer_slack_;
+
+  // The number of times the thread woke up for delayed work since
+  // |delayed_work_wakeups_start_|, reported to tracing about once a second.
+  int delayed_work_wakeups_;
+  TimeTicks delayed_work_wakeups_start_;
+
   // A queue of non-nestable tasks that we had to defer because when it came
   // time to execute them we were in a nested message loop.  They will execute
   // once we're out of nested message loops.
@@ -522,6 +550,8 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
 
   ObserverList<TaskObserver> task_observers_;
 
+  TaskArena task_arena_;
+
   scoped_refptr<internal::IncomingTaskQueue> incoming_task_queue_;
 
   // The message loop proxy associated with this message loop.
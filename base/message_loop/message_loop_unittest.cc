@@ -958,6 +958,55 @@ TEST(MessageLoopTest, IsType) {
   EXPECT_FALSE(loop.IsType(MessageLoop::TYPE_DEFAULT));
 }
 
+namespace {
+
+void RecordRunTime(TimeTicks* run_time) {
+  *run_time = TimeTicks::Now();
+}
+
+void RecordRunTimeAndQuit(TimeTicks* run_time) {
+  RecordRunTime(run_time);
+  MessageLoop::current()->QuitWhenIdle();
+}
+
+// Rounds |time| up to a multiple of the maximum timer slack.
+TimeTicks RoundUpToTimerSlack(TimeTicks time) {
+  const int64 slack =
+      TimeDelta::FromMilliseconds(kTimerSlackMaximumMs).ToInternalValue();
+  return TimeTicks::FromInternalValue(
+      (time.ToInternalValue() + slack - 1) / slack * slack);
+}
+
+}  // namespace
+
+TEST(MessageLoopTest, TimerSlack) {
+  MessageLoop loop;
+  loop.SetTimerSlack(TIMER_SLACK_MAXIMUM);
+
+  // Delayed tasks run no earlier than the slack boundary after their run time.
+  const TimeDelta kDelay1 = TimeDelta::FromMilliseconds(1);
+  const TimeDelta kDelay2 = TimeDelta::FromMilliseconds(2);
+  TimeTicks run_time1;
+  TimeTicks run_time2;
+  TimeTicks time_before_post = TimeTicks::Now();
+  loop.PostDelayedTask(FROM_HERE, Bind(&RecordRunTime, &run_time1), kDelay1);
+  loop.PostDelayedTask(
+      FROM_HERE, Bind(&RecordRunTimeAndQuit, &run_time2), kDelay2);
+  loop.Run();
+  EXPECT_GE(run_time1, RoundUpToTimerSlack(time_before_post + kDelay1));
+  EXPECT_GE(run_time2, RoundUpToTimerSlack(time_before_post + kDelay2));
+  EXPECT_LE(run_time1, run_time2);
+
+  // Switching the slack off again still runs tasks in time.
+  loop.SetTimerSlack(TIMER_SLACK_NONE);
+  TimeTicks run_time3;
+  time_before_post = TimeTicks::Now();
+  loop.PostDelayedTask(
+      FROM_HERE, Bind(&RecordRunTimeAndQuit, &run_time3), kDelay1);
+  loop.Run();
+  EXPECT_GE(run_time3, time_before_post + kDelay1);
+}
+
 #if defined(OS_WIN)
 void EmptyFunction() {}
 
@@ -8,6 +8,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/prctl.h>
+#endif
+
 #include "base/auto_reset.h"
 #include "base/compiler_specific.h"
 #include "base/logging.h"
@@ -302,6 +306,18 @@ void MessagePumpLibevent::ScheduleDelayedWork(
   delayed_work_time_ = delayed_work_time;
 }
 
+void MessagePumpLibevent::SetTimerSlack(TimerSlack timer_slack) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // The kernel may then fire the epoll_wait() timeout late by as much, and
+  // fold it into another wakeup. Zero restores the default slack.
+  unsigned long slack_ns = timer_slack == TIMER_SLACK_MAXIMUM ?
+      kTimerSlackMaximumMs * Time::kMicrosecondsPerMillisecond *
+          Time::kNanosecondsPerMicrosecond : 0;
+  if (prctl(PR_SET_TIMERSLACK, slack_ns, 0, 0, 0))
+    DPLOG(ERROR) << "prctl(PR_SET_TIMERSLACK)";
+#endif
+}
+
 void MessagePumpLibevent::WillProcessIOEvent() {
   FOR_EACH_OBSERVER(IOObserver, io_observers_, WillProcessIOEvent());
 }
@@ -126,6 +126,7 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   virtual void Quit() OVERRIDE;
   virtual void ScheduleWork() OVERRIDE;
   virtual void ScheduleDelayedWork(const TimeTicks& delayed_work_time) OVERRIDE;
+  virtual void SetTimerSlack(TimerSlack timer_slack) OVERRIDE;
 
  private:
   friend class MessagePumpLibeventTest;
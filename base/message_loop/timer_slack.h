@@ -0,0 +1,26 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_LOOP_TIMER_SLACK_H_
+#define BASE_MESSAGE_LOOP_TIMER_SLACK_H_
+
+namespace base {
+
+// How precisely a MessageLoop runs its delayed tasks. See
+// MessageLoop::SetTimerSlack().
+enum TimerSlack {
+  // Wake up for each delayed task as close to its run time as possible.
+  TIMER_SLACK_NONE,
+
+  // Delay tasks by up to kTimerSlackMaximumMs so that ones with nearby run
+  // times share a wakeup.
+  TIMER_SLACK_MAXIMUM
+};
+
+// The most a delayed task is held back under TIMER_SLACK_MAXIMUM.
+const int kTimerSlackMaximumMs = 50;
+
+}  // namespace base
+
+#endif  // BASE_MESSAGE_LOOP_TIMER_SLACK_H_
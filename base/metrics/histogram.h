@@ -475,6 +475,11 @@ class BASE_EXPORT Histogram : public HistogramBase {
 
   virtual ~Histogram();
 
+  // Moves the samples to the global SharedHistogramAllocator, if there is one
+  // with room, so that the process that made its segment can read them. Must
+  // be called before the histogram is registered.
+  void MoveSamplesToSharedMemory();
+
   // HistogramBase implementation:
   virtual bool SerializeInfoImpl(Pickle* pickle) const OVERRIDE;
 
@@ -681,6 +686,9 @@ class BASE_EXPORT CustomHistogram : public Histogram {
       PickleIterator* iter);
   static HistogramBase* DeserializeInfoImpl(PickleIterator* iter);
 
+  // To validate the ranges of histograms in shared memory.
+  friend class SharedHistogramAllocator;
+
   static bool ValidateCustomRanges(const std::vector<Sample>& custom_ranges);
   static BucketRanges* CreateBucketRangesFromCustomRanges(
       const std::vector<Sample>& custom_ranges);
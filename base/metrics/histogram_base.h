@@ -73,6 +73,11 @@ class BASE_EXPORT HistogramBase {
     // the source histogram!).
     kIPCSerializationSourceFlag = 0x10,
 
+    // Indicates that the samples are kept in a SharedHistogramAllocator's
+    // segment, where the process that made it reads them directly. They are
+    // not sent over IPC.
+    kSharedMemoryFlag = 0x20,
+
     // Only for Histogram and its sub classes: fancy bucket-naming support.
     kHexRangePrintingFlag = 0x8000,
   };
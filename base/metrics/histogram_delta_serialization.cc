@@ -4,30 +4,94 @@
 
 #include "base/metrics/histogram_delta_serialization.h"
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/md5.h"
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/histogram_snapshot_manager.h"
+#include "base/metrics/statistics_recorder.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/pickle.h"
+#include "base/synchronization/lock.h"
 #include "base/values.h"
 
 namespace base {
 
 namespace {
 
-// Create or find existing histogram and add the samples from pickle.
-// Silently returns when seeing any data problem in the pickle.
-void DeserializeHistogramAndAddSamples(PickleIterator* iter) {
-  HistogramBase* histogram = DeserializeHistogramInfo(iter);
+// Names of the histograms described to this process so far, by name hash, so
+// that later deltas sent by hash alone can be found in the StatisticsRecorder.
+struct ReceivedHistogramNames {
+  Lock lock;
+  std::map<uint64, std::string> names;
+};
+
+LazyInstance<ReceivedHistogramNames>::Leaky g_received_histogram_names =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Same hash as metrics::HashMetricName(): the first 8 bytes of the MD5 of
+// |name|, big-endian.
+uint64 HashHistogramName(const std::string& name) {
+  MD5Digest digest;
+  MD5Sum(name.data(), name.size(), &digest);
+  uint64 hash = 0;
+  for (size_t i = 0; i < sizeof(hash); ++i)
+    hash = (hash << 8) | digest.a[i];
+  return hash;
+}
+
+// Looks up a histogram previously described to this process.
+HistogramBase* FindReceivedHistogram(uint64 name_hash) {
+  std::string name;
+  {
+    ReceivedHistogramNames& received = g_received_histogram_names.Get();
+    AutoLock auto_lock(received.lock);
+    std::map<uint64, std::string>::const_iterator it =
+        received.names.find(name_hash);
+    if (it == received.names.end())
+      return NULL;
+    name = it->second;
+  }
+  return StatisticsRecorder::FindHistogram(name);
+}
+
+// Create or find existing histogram and add the samples from one delta of a
+// batch.  Silently skips the delta when seeing any data problem in it.
+// Returns false if the batch itself is malformed and can't be read further.
+bool DeserializeHistogramAndAddSamples(PickleIterator* batch_iter) {
+  uint64 name_hash;
+  bool has_info;
+  const char* data;
+  int data_length;
+  if (!batch_iter->ReadUInt64(&name_hash) ||
+      !batch_iter->ReadBool(&has_info) ||
+      !batch_iter->ReadData(&data, &data_length)) {
+    return false;
+  }
+
+  Pickle pickle(data, data_length);
+  PickleIterator iter(pickle);
+  HistogramBase* histogram = NULL;
+  if (has_info) {
+    histogram = DeserializeHistogramInfo(&iter);
+    if (histogram) {
+      ReceivedHistogramNames& received = g_received_histogram_names.Get();
+      AutoLock auto_lock(received.lock);
+      received.names[name_hash] = histogram->histogram_name();
+    }
+  } else {
+    histogram = FindReceivedHistogram(name_hash);
+  }
   if (!histogram)
-    return;
+    return true;
 
   if (histogram->flags() & HistogramBase::kIPCSerializationSourceFlag) {
     DVLOG(1) << "Single process mode, histogram observed and not copied: "
              << histogram->histogram_name();
-    return;
+    return true;
   }
-  histogram->AddSamplesFromPickle(iter);
+  histogram->AddSamplesFromPickle(&iter);
+  return true;
 }
 
 }  // namespace
@@ -35,7 +99,8 @@ void DeserializeHistogramAndAddSamples(PickleIterator* iter) {
 HistogramDeltaSerialization::HistogramDeltaSerialization(
     const std::string& caller_name)
     : histogram_snapshot_manager_(this),
-      serialized_deltas_(NULL) {
+      batch_(NULL),
+      batch_count_(0) {
   inconsistencies_histogram_ =
       LinearHistogram::FactoryGet(
           "Histogram.Inconsistencies" + caller_name, 1,
@@ -61,13 +126,27 @@ HistogramDeltaSerialization::~HistogramDeltaSerialization() {
 
 void HistogramDeltaSerialization::PrepareAndSerializeDeltas(
     std::vector<std::string>* serialized_deltas) {
-  serialized_deltas_ = serialized_deltas;
+  Pickle batch;
+  if (serialized_deltas) {
+    batch_ = &batch;
+    batch_count_ = 0;
+  }
   // Note: Before serializing, we set the kIPCSerializationSourceFlag for all
   // the histograms, so that the receiving process can distinguish them from the
   // local histograms.
   histogram_snapshot_manager_.PrepareDeltas(
       Histogram::kIPCSerializationSourceFlag, Histogram::kNoFlags);
-  serialized_deltas_ = NULL;
+  batch_ = NULL;
+
+  if (batch_count_ > 0) {
+    serialized_deltas->push_back(
+        std::string(static_cast<const char*>(batch.data()), batch.size()));
+  }
+  batch_count_ = 0;
+}
+
+void HistogramDeltaSerialization::ResetSentHistogramInfo() {
+  sent_histograms_.clear();
 }
 
 // static
@@ -75,9 +154,10 @@ void HistogramDeltaSerialization::DeserializeAndAddSamples(
     const std::vector<std::string>& serialized_deltas) {
   for (std::vector<std::string>::const_iterator it = serialized_deltas.begin();
        it != serialized_deltas.end(); ++it) {
-    Pickle pickle(it->data(), checked_cast<int>(it->size()));
-    PickleIterator iter(pickle);
-    DeserializeHistogramAndAddSamples(&iter);
+    Pickle batch(it->data(), checked_cast<int>(it->size()));
+    PickleIterator iter(batch);
+    while (DeserializeHistogramAndAddSamples(&iter)) {
+    }
   }
 }
 
@@ -86,11 +166,33 @@ void HistogramDeltaSerialization::RecordDelta(
     const HistogramSamples& snapshot) {
   DCHECK_NE(0, snapshot.TotalCount());
 
+  // The receiving process reads these from shared memory itself.
+  if (histogram.flags() & HistogramBase::kSharedMemoryFlag)
+    return;
+
+  if (!batch_)
+    return;
+
+  // Describe the histogram in full only the first time it is sent.
+  std::map<const HistogramBase*, uint64>::const_iterator it =
+      sent_histograms_.find(&histogram);
+  bool has_info = it == sent_histograms_.end();
+  uint64 name_hash;
   Pickle pickle;
-  histogram.SerializeInfo(&pickle);
+  if (has_info) {
+    name_hash = HashHistogramName(histogram.histogram_name());
+    sent_histograms_[&histogram] = name_hash;
+    histogram.SerializeInfo(&pickle);
+  } else {
+    name_hash = it->second;
+  }
   snapshot.Serialize(&pickle);
-  serialized_deltas_->push_back(
-      std::string(static_cast<const char*>(pickle.data()), pickle.size()));
+
+  batch_->WriteUInt64(name_hash);
+  batch_->WriteBool(has_info);
+  batch_->WriteData(static_cast<const char*>(pickle.data()),
+                    checked_cast<int>(pickle.size()));
+  ++batch_count_;
 }
 
 void HistogramDeltaSerialization::InconsistencyDetected(
@@ -5,6 +5,7 @@
 #ifndef BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
 #define BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -14,11 +15,20 @@
 #include "base/metrics/histogram_flattener.h"
 #include "base/metrics/histogram_snapshot_manager.h"
 
+class Pickle;
+
 namespace base {
 
 class HistogramBase;
 
 // Serializes and restores histograms deltas.
+//
+// All deltas from one call to PrepareAndSerializeDeltas() go out as a single
+// batch.  A histogram is described in full (name, type, ranges) only the first
+// time this serializer sends it; after that it is identified by a 64-bit hash
+// of its name, which the receiving side resolves from the earlier full
+// description.  Each serializer therefore expects to talk to a single receiver
+// over an ordered channel; see ResetSentHistogramInfo().
 class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
  public:
   // |caller_name| is string used in histograms for counting inconsistencies.
@@ -31,6 +41,11 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
   // will compute the deltas relative to this one.
   void PrepareAndSerializeDeltas(std::vector<std::string>* serialized_deltas);
 
+  // Makes the next batch describe every histogram in full again.  Call this
+  // when the deltas start going to a different receiver, e.g. when a new
+  // process connects.
+  void ResetSentHistogramInfo();
+
   // Deserialize deltas and add samples to corresponding histograms, creating
   // them if necessary. Silently ignores errors in |serialized_deltas|.
   static void DeserializeAndAddSamples(
@@ -49,8 +64,13 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
   // Calculates deltas in histogram counters.
   HistogramSnapshotManager histogram_snapshot_manager_;
 
-  // Output buffer for serialized deltas.
-  std::vector<std::string>* serialized_deltas_;
+  // Batch being built by PrepareAndSerializeDeltas(), and the number of deltas
+  // in it.
+  Pickle* batch_;
+  int batch_count_;
+
+  // Name hashes of the histograms already described to the receiver.
+  std::map<const HistogramBase*, uint64> sent_histograms_;
 
   // Histograms to count inconsistencies in snapshots.
   HistogramBase* inconsistencies_histogram_;
@@ -51,4 +51,52 @@ TEST(HistogramDeltaSerializationTest, DeserializeHistogramAndAddSamples) {
   EXPECT_EQ(2, snapshot2->GetCount(1000));
 }
 
+TEST(HistogramDeltaSerializationTest, LaterDeltasSentByNameHash) {
+  StatisticsRecorder statistic_recorder;
+  HistogramDeltaSerialization serializer("HistogramDeltaSerializationTest");
+
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TestHistogramByHash", 1, 1000, 10, HistogramBase::kNoFlags);
+  HistogramBase* other_histogram = Histogram::FactoryGet(
+      "OtherTestHistogramByHash", 1, 1000, 10, HistogramBase::kNoFlags);
+
+  histogram->Add(10);
+  other_histogram->Add(10);
+  std::vector<std::string> first_deltas;
+  serializer.PrepareAndSerializeDeltas(&first_deltas);
+  // Both deltas travel in one batch.
+  ASSERT_EQ(1u, first_deltas.size());
+
+  histogram->Add(100);
+  other_histogram->Add(100);
+  std::vector<std::string> second_deltas;
+  serializer.PrepareAndSerializeDeltas(&second_deltas);
+  ASSERT_EQ(1u, second_deltas.size());
+  // The histograms were already described, so the second batch is smaller.
+  EXPECT_LT(second_deltas[0].size(), first_deltas[0].size());
+
+  // Emulate multi-process usage.
+  histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  other_histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  HistogramDeltaSerialization::DeserializeAndAddSamples(first_deltas);
+  HistogramDeltaSerialization::DeserializeAndAddSamples(second_deltas);
+
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(2, snapshot->GetCount(10));
+  EXPECT_EQ(2, snapshot->GetCount(100));
+  scoped_ptr<HistogramSamples> other_snapshot(
+      other_histogram->SnapshotSamples());
+  EXPECT_EQ(2, other_snapshot->GetCount(10));
+  EXPECT_EQ(2, other_snapshot->GetCount(100));
+
+  // After a reset the next batch describes the histograms again.
+  histogram->Add(100);
+  other_histogram->Add(100);
+  std::vector<std::string> third_deltas;
+  serializer.ResetSentHistogramInfo();
+  serializer.PrepareAndSerializeDeltas(&third_deltas);
+  ASSERT_EQ(1u, third_deltas.size());
+  EXPECT_GT(third_deltas[0].size(), second_deltas[0].size());
+}
+
 }  // namespace base
@@ -0,0 +1,90 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the cost of recording samples into histograms that several
+// threads are recording into at once, as hot paths in net, cc and IPC do.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_vector.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/sparse_histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kNumSamples = 1000000;
+const int kThreadCounts[] = { 1, 2, 4, 8 };
+
+void RecordCounts(int i) {
+  UMA_HISTOGRAM_COUNTS("PerfTest.Counts", i % 1000);
+}
+
+void RecordEnumeration(int i) {
+  UMA_HISTOGRAM_ENUMERATION("PerfTest.Enumeration", i % 50, 50);
+}
+
+void RecordSparse(int i) {
+  UMA_HISTOGRAM_SPARSE_SLOWLY("PerfTest.Sparse", i % 50);
+}
+
+class Recorder : public DelegateSimpleThread::Delegate {
+ public:
+  explicit Recorder(void (*record)(int)) : record_(record) {}
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < kNumSamples; ++i)
+      record_(i);
+  }
+
+ private:
+  void (*record_)(int);
+
+  DISALLOW_COPY_AND_ASSIGN(Recorder);
+};
+
+// Times each of the thread counts above recording kNumSamples samples each
+// with |record|.
+void TimeRecording(const char* name, void (*record)(int)) {
+  // Sparse histograms are looked up by name on every sample.
+  StatisticsRecorder::Initialize();
+  for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+    Recorder recorder(record);
+    std::string test_name =
+        StringPrintf("Histogram_%s_%dThreads", name, kThreadCounts[i]);
+    PerfTimeLogger logger(test_name.c_str());
+    ScopedVector<DelegateSimpleThread> threads;
+    for (int j = 0; j < kThreadCounts[i]; ++j) {
+      threads.push_back(new DelegateSimpleThread(&recorder, "Recorder"));
+      threads.back()->Start();
+    }
+    for (int j = 0; j < kThreadCounts[i]; ++j)
+      threads[j]->Join();
+    logger.Done();
+  }
+}
+
+}  // namespace
+
+TEST(HistogramPerfTest, ContendedCounts) {
+  TimeRecording("Counts", &RecordCounts);
+}
+
+TEST(HistogramPerfTest, ContendedEnumeration) {
+  TimeRecording("Enumeration", &RecordEnumeration);
+}
+
+TEST(HistogramPerfTest, ContendedSparse) {
+  TimeRecording("Sparse", &RecordSparse);
+}
+
+}  // namespace base
@@ -5,12 +5,19 @@
 #include "base/metrics/histogram_samples.h"
 
 #include "base/compiler_specific.h"
+#include "base/lazy_instance.h"
 #include "base/pickle.h"
+#include "base/synchronization/lock.h"
 
 namespace base {
 
 namespace {
 
+#if !defined(ARCH_CPU_64_BITS)
+// Guards Metadata::sum, which can't be updated atomically.
+LazyInstance<Lock>::Leaky g_sum_lock = LAZY_INSTANCE_INITIALIZER;
+#endif
+
 class SampleCountPickleIterator : public SampleCountIterator {
  public:
   explicit SampleCountPickleIterator(PickleIterator* iter);
@@ -58,18 +65,28 @@ void SampleCountPickleIterator::Get(HistogramBase::Sample* min,
 
 }  // namespace
 
-HistogramSamples::HistogramSamples() : sum_(0), redundant_count_(0) {}
+HistogramSamples::HistogramSamples() : meta_(&local_meta_) {
+  local_meta_.sum = 0;
+  local_meta_.redundant_count = 0;
+}
+
+HistogramSamples::HistogramSamples(Metadata* meta) : meta_(meta) {
+  local_meta_.sum = 0;
+  local_meta_.redundant_count = 0;
+}
 
 HistogramSamples::~HistogramSamples() {}
 
 void HistogramSamples::Add(const HistogramSamples& other) {
-  sum_ += other.sum();
-  HistogramBase::Count old_redundant_count =
-      subtle::NoBarrier_Load(&redundant_count_);
-  subtle::NoBarrier_Store(&redundant_count_,
-      old_redundant_count + other.redundant_count());
+  // Read the totals before the counts, and add them after, so that a
+  // concurrent snapshot doesn't see more samples in the totals than in the
+  // counts. See Accumulate() in the subclasses.
+  int64 sum = other.sum();
+  HistogramBase::Count redundant_count = other.redundant_count();
   bool success = AddSubtractImpl(other.Iterator().get(), ADD);
   DCHECK(success);
+  IncreaseSum(sum);
+  IncreaseRedundantCount(redundant_count);
 }
 
 bool HistogramSamples::AddFromPickle(PickleIterator* iter) {
@@ -78,29 +95,25 @@ bool HistogramSamples::AddFromPickle(PickleIterator* iter) {
 
   if (!iter->ReadInt64(&sum) || !iter->ReadInt(&redundant_count))
     return false;
-  sum_ += sum;
-  HistogramBase::Count old_redundant_count =
-      subtle::NoBarrier_Load(&redundant_count_);
-  subtle::NoBarrier_Store(&redundant_count_,
-                          old_redundant_count + redundant_count);
 
   SampleCountPickleIterator pickle_iter(iter);
-  return AddSubtractImpl(&pickle_iter, ADD);
+  bool success = AddSubtractImpl(&pickle_iter, ADD);
+  IncreaseSum(sum);
+  IncreaseRedundantCount(redundant_count);
+  return success;
 }
 
 void HistogramSamples::Subtract(const HistogramSamples& other) {
-  sum_ -= other.sum();
-  HistogramBase::Count old_redundant_count =
-      subtle::NoBarrier_Load(&redundant_count_);
-  subtle::NoBarrier_Store(&redundant_count_,
-                          old_redundant_count - other.redundant_count());
+  int64 sum = other.sum();
+  HistogramBase::Count redundant_count = other.redundant_count();
+  IncreaseSum(-sum);
+  IncreaseRedundantCount(-redundant_count);
   bool success = AddSubtractImpl(other.Iterator().get(), SUBTRACT);
   DCHECK(success);
 }
 
 bool HistogramSamples::Serialize(Pickle* pickle) const {
-  if (!pickle->WriteInt64(sum_) ||
-      !pickle->WriteInt(subtle::NoBarrier_Load(&redundant_count_)))
+  if (!pickle->WriteInt64(sum()) || !pickle->WriteInt(redundant_count()))
     return false;
 
   HistogramBase::Sample min;
@@ -118,13 +131,30 @@ bool HistogramSamples::Serialize(Pickle* pickle) const {
   return true;
 }
 
+int64 HistogramSamples::sum() const {
+#if defined(ARCH_CPU_64_BITS)
+  return subtle::NoBarrier_Load(&meta_->sum);
+#else
+  AutoLock lock(g_sum_lock.Get());
+  return meta_->sum;
+#endif
+}
+
+HistogramBase::Count HistogramSamples::redundant_count() const {
+  return subtle::Acquire_Load(&meta_->redundant_count);
+}
+
 void HistogramSamples::IncreaseSum(int64 diff) {
-  sum_ += diff;
+#if defined(ARCH_CPU_64_BITS)
+  subtle::NoBarrier_AtomicIncrement(&meta_->sum, diff);
+#else
+  AutoLock lock(g_sum_lock.Get());
+  meta_->sum += diff;
+#endif
 }
 
 void HistogramSamples::IncreaseRedundantCount(HistogramBase::Count diff) {
-  subtle::NoBarrier_Store(&redundant_count_,
-      subtle::NoBarrier_Load(&redundant_count_) + diff);
+  subtle::Barrier_AtomicIncrement(&meta_->redundant_count, diff);
 }
 
 SampleCountIterator::~SampleCountIterator() {}
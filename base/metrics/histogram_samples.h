@@ -19,7 +19,31 @@ class SampleCountIterator;
 // HistogramSamples is a container storing all samples of a histogram.
 class BASE_EXPORT HistogramSamples {
  public:
+  // The totals kept alongside the counts. They are a separate struct so that
+  // they can live with the counts in memory shared with other processes; see
+  // SharedHistogramAllocator.
+  struct Metadata {
+#if defined(ARCH_CPU_64_BITS)
+    subtle::Atomic64 sum;
+#else
+    // There is no 64-bit atomic increment here, so it is guarded by a lock
+    // shared by all histograms instead.
+    int64 sum;
+#endif
+
+    // |redundant_count| helps identify memory corruption. It redundantly
+    // stores the total number of samples accumulated in the histogram. We can
+    // compare this count to the sum of the counts (TotalCount() function), and
+    // detect problems. Note, depending on the implementation of different
+    // histogram types, there might be races during histogram accumulation and
+    // snapshotting that we choose to accept. In this case, the tallies might
+    // mismatch even when no memory corruption has happened.
+    HistogramBase::AtomicCount redundant_count;
+  };
+
   HistogramSamples();
+  // Keeps the totals in |meta|, which must be zeroed and outlive this object.
+  explicit HistogramSamples(Metadata* meta);
   virtual ~HistogramSamples();
 
   virtual void Accumulate(HistogramBase::Sample value,
@@ -38,30 +62,30 @@ class BASE_EXPORT HistogramSamples {
   virtual bool Serialize(Pickle* pickle) const;
 
   // Accessor fuctions.
-  int64 sum() const { return sum_; }
-  HistogramBase::Count redundant_count() const {
-    return subtle::NoBarrier_Load(&redundant_count_);
-  }
+  int64 sum() const;
+  HistogramBase::Count redundant_count() const;
 
  protected:
   // Based on |op| type, add or subtract sample counts data from the iterator.
   enum Operator { ADD, SUBTRACT };
   virtual bool AddSubtractImpl(SampleCountIterator* iter, Operator op) = 0;
 
+  // Samples are recorded without locks. Subclasses update their counts
+  // first, then call these, the second of which is a barrier. Readers call
+  // redundant_count() before reading the counts, so that a snapshot may
+  // include samples that are missing from its redundant count but never the
+  // reverse, and then only those being recorded at that moment.
   void IncreaseSum(int64 diff);
   void IncreaseRedundantCount(HistogramBase::Count diff);
 
  private:
-  int64 sum_;
-
-  // |redundant_count_| helps identify memory corruption. It redundantly stores
-  // the total number of samples accumulated in the histogram. We can compare
-  // this count to the sum of the counts (TotalCount() function), and detect
-  // problems. Note, depending on the implementation of different histogram
-  // types, there might be races during histogram accumulation and snapshotting
-  // that we choose to accept. In this case, the tallies might mismatch even
-  // when no memory corruption has happened.
-  HistogramBase::AtomicCount redundant_count_;
+  // Used unless the totals are kept elsewhere.
+  Metadata local_meta_;
+
+  // Points to |local_meta_| or to the Metadata given to the constructor.
+  Metadata* meta_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramSamples);
 };
 
 class BASE_EXPORT SampleCountIterator {
@@ -14,7 +14,9 @@
 #include "base/metrics/histogram.h"
 #include "base/metrics/sample_vector.h"
 #include "base/metrics/statistics_recorder.h"
+#include "base/memory/scoped_vector.h"
 #include "base/pickle.h"
+#include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -46,6 +48,30 @@ class HistogramTest : public testing::Test {
   StatisticsRecorder* statistics_recorder_;
 };
 
+namespace {
+
+// Adds samples to a histogram from its own thread.
+class HistogramAdder : public DelegateSimpleThread::Delegate {
+ public:
+  HistogramAdder(HistogramBase* histogram, int num_samples)
+      : histogram_(histogram),
+        num_samples_(num_samples) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_samples_; ++i)
+      histogram_->Add(i % 100);
+  }
+
+ private:
+  HistogramBase* const histogram_;
+  const int num_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramAdder);
+};
+
+}  // namespace
+
 // Check for basic syntax and use.
 TEST_F(HistogramTest, BasicTest) {
   // Try basic construction
@@ -443,6 +469,31 @@ TEST_F(HistogramTest, CustomHistogramSerializeInfo) {
   EXPECT_FALSE(iter.SkipBytes(1));
 }
 
+// Samples added concurrently aren't lost.
+TEST_F(HistogramTest, ConcurrentAddTest) {
+  const int kNumThreads = 4;
+  const int kNumSamples = 10000;
+  HistogramBase* histogram =
+      LinearHistogram::FactoryGet("Concurrent", 1, 100, 101,
+                                  HistogramBase::kNoFlags);
+
+  HistogramAdder adder(histogram, kNumSamples);
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(new DelegateSimpleThread(&adder, "HistogramAdder"));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Join();
+
+  scoped_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(kNumThreads * kNumSamples, samples->TotalCount());
+  EXPECT_EQ(kNumThreads * kNumSamples, samples->redundant_count());
+  EXPECT_EQ(kNumThreads * kNumSamples / 100, samples->GetCount(0));
+  EXPECT_EQ(kNumThreads * (kNumSamples / 100) * (99 * 100 / 2),
+            samples->sum());
+}
+
 #if GTEST_HAS_DEATH_TEST
 // For Histogram, LinearHistogram and CustomHistogram, the minimum for a
 // declared range is 1, while the maximum is (HistogramBase::kSampleType_MAX -
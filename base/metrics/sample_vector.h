@@ -23,6 +23,11 @@ class BucketRanges;
 class BASE_EXPORT_PRIVATE SampleVector : public HistogramSamples {
  public:
   explicit SampleVector(const BucketRanges* bucket_ranges);
+  // Keeps the counts in |counts|, which has a slot per bucket, and the totals
+  // in |meta|. Both must be zeroed and outlive this object.
+  SampleVector(const BucketRanges* bucket_ranges,
+               Metadata* meta,
+               HistogramBase::AtomicCount* counts);
   virtual ~SampleVector();
 
   // HistogramSamples implementation:
@@ -46,7 +51,12 @@ class BASE_EXPORT_PRIVATE SampleVector : public HistogramSamples {
  private:
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, CorruptSampleCounts);
 
-  std::vector<HistogramBase::AtomicCount> counts_;
+  // Used unless the counts are kept elsewhere.
+  std::vector<HistogramBase::AtomicCount> local_counts_;
+
+  // Points into |local_counts_| or at the counts given to the constructor.
+  HistogramBase::AtomicCount* counts_;
+  size_t counts_size_;
 
   // Shares the same BucketRanges with Histogram object.
   const BucketRanges* const bucket_ranges_;
@@ -58,6 +68,9 @@ class BASE_EXPORT_PRIVATE SampleVectorIterator : public SampleCountIterator {
  public:
   SampleVectorIterator(const std::vector<HistogramBase::AtomicCount>* counts,
                        const BucketRanges* bucket_ranges);
+  SampleVectorIterator(const HistogramBase::AtomicCount* counts,
+                       size_t counts_size,
+                       const BucketRanges* bucket_ranges);
   virtual ~SampleVectorIterator();
 
   // SampleCountIterator implementation:
@@ -73,7 +86,8 @@ class BASE_EXPORT_PRIVATE SampleVectorIterator : public SampleCountIterator {
  private:
   void SkipEmptyBuckets();
 
-  const std::vector<HistogramBase::AtomicCount>* counts_;
+  const HistogramBase::AtomicCount* counts_;
+  size_t counts_size_;
   const BucketRanges* bucket_ranges_;
 
   size_t index_;
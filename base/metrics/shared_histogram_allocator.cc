@@ -0,0 +1,367 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_allocator.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/sample_vector.h"
+
+namespace base {
+
+namespace {
+
+typedef HistogramBase::AtomicCount AtomicCount;
+typedef HistogramBase::Sample Sample;
+
+// Identifies a segment made by Create().
+const uint32 kSegmentCookie = 0x48495354;  // "HIST"
+
+// Records are aligned for HistogramSamples::Metadata::sum.
+const uint32 kRecordAlignment = 8;
+
+// Histograms with more buckets than this are kept out of the segment, which
+// also bounds what ImportHistograms() will accept.
+const uint32 kMaxBucketCount = 16384;
+const uint32 kMaxNameLength = 1024;
+
+struct SegmentHeader {
+  uint32 cookie;
+
+  // The number of bytes allocated, including this header.
+  subtle::Atomic32 used;
+};
+
+// A record for a histogram, followed by its bucket counts, then, for custom
+// histograms, its bucket_count + 1 ranges, then its name.
+struct RecordHeader {
+  // Set, with release semantics, once the rest of the record is written.
+  subtle::Atomic32 ready;
+
+  // The size of the whole record, including padding.
+  uint32 size;
+
+  HistogramSamples::Metadata meta;
+
+  int32 histogram_type;
+  int32 flags;
+  int32 declared_min;
+  int32 declared_max;
+  uint32 bucket_count;
+  uint32 ranges_checksum;
+  uint32 ranges_count;
+  uint32 name_length;
+};
+
+COMPILE_ASSERT(sizeof(SegmentHeader) % kRecordAlignment == 0,
+               segment_header_must_keep_records_aligned);
+COMPILE_ASSERT(sizeof(RecordHeader) % kRecordAlignment == 0,
+               record_header_must_keep_counts_aligned);
+
+// Returns the size of a record with the given contents. The arguments must
+// have been checked against the limits above, so this can't overflow.
+uint32 GetRecordSize(uint32 bucket_count,
+                     uint32 ranges_count,
+                     uint32 name_length) {
+  uint32 size = sizeof(RecordHeader) + bucket_count * sizeof(AtomicCount) +
+      ranges_count * sizeof(Sample) + name_length;
+  return (size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+// These take the counts from the caller rather than from |record|, which
+// another process may be changing.
+AtomicCount* GetCounts(RecordHeader* record) {
+  return reinterpret_cast<AtomicCount*>(record + 1);
+}
+
+Sample* GetRanges(RecordHeader* record, uint32 bucket_count) {
+  return reinterpret_cast<Sample*>(GetCounts(record) + bucket_count);
+}
+
+char* GetName(RecordHeader* record,
+              uint32 bucket_count,
+              uint32 ranges_count) {
+  return reinterpret_cast<char*>(GetRanges(record, bucket_count) +
+                                 ranges_count);
+}
+
+subtle::AtomicWord g_allocator = 0;
+
+}  // namespace
+
+// A histogram found in the segment.
+struct SharedHistogramAllocator::ImportedHistogram {
+  // The histogram in this process that the samples are added to.
+  Histogram* histogram;
+
+  // The samples in the segment.
+  scoped_ptr<SampleVector> shared_samples;
+
+  // The samples that have been added to |histogram| so far.
+  scoped_ptr<SampleVector> imported_samples;
+};
+
+SharedHistogramAllocator::~SharedHistogramAllocator() {
+}
+
+// static
+scoped_ptr<SharedHistogramAllocator> SharedHistogramAllocator::Create(
+    size_t size) {
+  if (size < sizeof(SegmentHeader) || size > kint32max)
+    return scoped_ptr<SharedHistogramAllocator>();
+
+  scoped_ptr<SharedMemory> shared_memory(new SharedMemory);
+  if (!shared_memory->CreateAndMapAnonymous(size))
+    return scoped_ptr<SharedHistogramAllocator>();
+
+  // New segments are zeroed.
+  SegmentHeader* header = static_cast<SegmentHeader*>(shared_memory->memory());
+  header->cookie = kSegmentCookie;
+  subtle::Release_Store(&header->used, sizeof(SegmentHeader));
+  return scoped_ptr<SharedHistogramAllocator>(
+      new SharedHistogramAllocator(shared_memory.Pass()));
+}
+
+// static
+scoped_ptr<SharedHistogramAllocator> SharedHistogramAllocator::Open(
+    SharedMemoryHandle handle,
+    size_t size) {
+  scoped_ptr<SharedMemory> shared_memory(new SharedMemory(handle, false));
+  if (size < sizeof(SegmentHeader) || size > kint32max ||
+      !shared_memory->Map(size)) {
+    return scoped_ptr<SharedHistogramAllocator>();
+  }
+
+  const SegmentHeader* header =
+      static_cast<const SegmentHeader*>(shared_memory->memory());
+  if (header->cookie != kSegmentCookie)
+    return scoped_ptr<SharedHistogramAllocator>();
+  return scoped_ptr<SharedHistogramAllocator>(
+      new SharedHistogramAllocator(shared_memory.Pass()));
+}
+
+// static
+void SharedHistogramAllocator::SetGlobal(SharedHistogramAllocator* allocator) {
+  DCHECK(!GetGlobal());
+  subtle::Release_Store(&g_allocator,
+                        reinterpret_cast<subtle::AtomicWord>(allocator));
+}
+
+// static
+SharedHistogramAllocator* SharedHistogramAllocator::GetGlobal() {
+  return reinterpret_cast<SharedHistogramAllocator*>(
+      subtle::Acquire_Load(&g_allocator));
+}
+
+// static
+scoped_ptr<SharedHistogramAllocator>
+SharedHistogramAllocator::ReleaseGlobalForTesting() {
+  SharedHistogramAllocator* allocator = GetGlobal();
+  subtle::Release_Store(&g_allocator, 0);
+  return scoped_ptr<SharedHistogramAllocator>(allocator);
+}
+
+scoped_ptr<SampleVector> SharedHistogramAllocator::AllocateSamples(
+    const Histogram& histogram) {
+  const BucketRanges* ranges = histogram.bucket_ranges();
+  const std::string& name = histogram.histogram_name();
+  HistogramType type = histogram.GetHistogramType();
+  if (type == SPARSE_HISTOGRAM || ranges->bucket_count() > kMaxBucketCount ||
+      name.size() > kMaxNameLength) {
+    return scoped_ptr<SampleVector>();
+  }
+
+  uint32 bucket_count = static_cast<uint32>(ranges->bucket_count());
+  uint32 ranges_count = type == CUSTOM_HISTOGRAM ? bucket_count + 1 : 0;
+  uint32 name_length = static_cast<uint32>(name.size());
+  uint32 size = GetRecordSize(bucket_count, ranges_count, name_length);
+  uint32 offset = Allocate(size);
+  if (!offset)
+    return scoped_ptr<SampleVector>();
+
+  char* base = static_cast<char*>(shared_memory_->memory());
+  RecordHeader* record = reinterpret_cast<RecordHeader*>(base + offset);
+  record->size = size;
+  record->histogram_type = type;
+  record->flags = histogram.flags();
+  record->declared_min = histogram.declared_min();
+  record->declared_max = histogram.declared_max();
+  record->bucket_count = bucket_count;
+  record->ranges_checksum = ranges->checksum();
+  record->ranges_count = ranges_count;
+  record->name_length = name_length;
+  for (uint32 i = 0; i < ranges_count; ++i)
+    GetRanges(record, bucket_count)[i] = ranges->range(i);
+  memcpy(GetName(record, bucket_count, ranges_count), name.data(),
+         name_length);
+  subtle::Release_Store(&record->ready, 1);
+
+  return scoped_ptr<SampleVector>(
+      new SampleVector(ranges, &record->meta, GetCounts(record)));
+}
+
+void SharedHistogramAllocator::ImportHistograms() {
+  FindNewRecords();
+
+  for (size_t i = 0; i < imported_histograms_.size(); ++i) {
+    ImportedHistogram* imported = imported_histograms_[i];
+    SampleVector delta(imported->histogram->bucket_ranges());
+    delta.Add(*imported->shared_samples);
+    delta.Subtract(*imported->imported_samples);
+    if (delta.redundant_count() == 0 && delta.TotalCount() == 0)
+      continue;
+
+    imported->histogram->AddSamples(delta);
+    imported->imported_samples->Add(delta);
+  }
+}
+
+SharedHistogramAllocator::SharedHistogramAllocator(
+    scoped_ptr<SharedMemory> shared_memory)
+    : shared_memory_(shared_memory.Pass()),
+      size_(static_cast<uint32>(shared_memory_->mapped_size())),
+      next_record_(sizeof(SegmentHeader)),
+      corrupt_(false) {
+}
+
+uint32 SharedHistogramAllocator::Allocate(uint32 size) {
+  DCHECK_EQ(0u, size % kRecordAlignment);
+  SegmentHeader* header =
+      static_cast<SegmentHeader*>(shared_memory_->memory());
+
+  // Another process may be allocating from the same segment, so a lock in
+  // this one wouldn't help.
+  subtle::Atomic32 used = subtle::NoBarrier_Load(&header->used);
+  while (true) {
+    if (used < static_cast<subtle::Atomic32>(sizeof(SegmentHeader)) ||
+        static_cast<uint32>(used) > size_ ||
+        size_ - static_cast<uint32>(used) < size) {
+      return 0;
+    }
+    subtle::Atomic32 previous =
+        subtle::NoBarrier_CompareAndSwap(&header->used, used, used + size);
+    if (previous == used)
+      return static_cast<uint32>(used);
+    used = previous;
+  }
+}
+
+void SharedHistogramAllocator::FindNewRecords() {
+  SegmentHeader* header =
+      static_cast<SegmentHeader*>(shared_memory_->memory());
+  uint32 used = static_cast<uint32>(subtle::Acquire_Load(&header->used));
+  if (used > size_)
+    used = size_;
+
+  char* base = static_cast<char*>(shared_memory_->memory());
+  while (!corrupt_ && used - next_record_ >= sizeof(RecordHeader) &&
+         next_record_ < used) {
+    RecordHeader* record = reinterpret_cast<RecordHeader*>(base + next_record_);
+
+    // A record that isn't ready yet may be finished by the next call. One
+    // left unfinished by a crash hides those after it, but those can only
+    // have been allocated at the moment of the crash.
+    if (!subtle::Acquire_Load(&record->ready))
+      return;
+
+    uint32 size = record->size;
+    if (size < sizeof(RecordHeader) || size % kRecordAlignment != 0 ||
+        size > used - next_record_) {
+      corrupt_ = true;
+      return;
+    }
+
+    ImportedHistogram* imported = CreateImportedHistogram(next_record_);
+    if (!imported) {
+      corrupt_ = true;
+      return;
+    }
+    imported_histograms_.push_back(imported);
+    next_record_ += size;
+  }
+}
+
+SharedHistogramAllocator::ImportedHistogram*
+SharedHistogramAllocator::CreateImportedHistogram(uint32 offset) {
+  RecordHeader* record = reinterpret_cast<RecordHeader*>(
+      static_cast<char*>(shared_memory_->memory()) + offset);
+
+  // Copy the fields, since the other process could still change them.
+  uint32 size = record->size;
+  int32 histogram_type = record->histogram_type;
+  int32 flags = record->flags & ~(HistogramBase::kSharedMemoryFlag |
+                                  HistogramBase::kIPCSerializationSourceFlag);
+  Sample declared_min = record->declared_min;
+  Sample declared_max = record->declared_max;
+  uint32 bucket_count = record->bucket_count;
+  uint32 ranges_checksum = record->ranges_checksum;
+  uint32 ranges_count = record->ranges_count;
+  uint32 name_length = record->name_length;
+
+  if (bucket_count < 1 || bucket_count > kMaxBucketCount ||
+      name_length > kMaxNameLength ||
+      (ranges_count != 0 && ranges_count != bucket_count + 1) ||
+      size != GetRecordSize(bucket_count, ranges_count, name_length)) {
+    return NULL;
+  }
+  std::string name(GetName(record, bucket_count, ranges_count), name_length);
+
+  // Find or create the histogram in this process, as
+  // DeserializeHistogramInfo() does.
+  HistogramBase* histogram_base = NULL;
+  switch (histogram_type) {
+    case HISTOGRAM:
+      histogram_base = Histogram::FactoryGet(name, declared_min, declared_max,
+                                        bucket_count, flags);
+      break;
+    case LINEAR_HISTOGRAM:
+      histogram_base = LinearHistogram::FactoryGet(name, declared_min, declared_max,
+                                              bucket_count, flags);
+      break;
+    case BOOLEAN_HISTOGRAM:
+      histogram_base = BooleanHistogram::FactoryGet(name, flags);
+      break;
+    case CUSTOM_HISTOGRAM: {
+      if (ranges_count < 3)
+        return NULL;
+      // The first and last ranges are implied.
+      const Sample* ranges = GetRanges(record, bucket_count);
+      std::vector<Sample> custom_ranges(ranges + 1,
+                                        ranges + ranges_count - 1);
+      if (!CustomHistogram::ValidateCustomRanges(custom_ranges))
+        return NULL;
+      histogram_base = CustomHistogram::FactoryGet(name, custom_ranges, flags);
+      break;
+    }
+    default:
+      return NULL;
+  }
+
+  // The local histogram may differ from the one in the segment, whether
+  // because the segment is corrupt or because the two processes disagree.
+  if (!histogram_base || histogram_base->GetHistogramType() != histogram_type)
+    return NULL;
+  Histogram* histogram = static_cast<Histogram*>(histogram_base);
+  const BucketRanges* local_ranges = histogram->bucket_ranges();
+  if (local_ranges->bucket_count() != bucket_count ||
+      local_ranges->checksum() != ranges_checksum) {
+    return NULL;
+  }
+
+  ImportedHistogram* imported = new ImportedHistogram;
+  imported->histogram = histogram;
+  imported->shared_samples.reset(
+      new SampleVector(local_ranges, &record->meta, GetCounts(record)));
+  imported->imported_samples.reset(new SampleVector(local_ranges));
+  return imported;
+}
+
+}  // namespace base
@@ -0,0 +1,113 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SharedHistogramAllocator places the samples of a process' histograms in a
+// shared memory segment, so that the process that created the segment can read
+// them directly instead of having them sent over IPC. Because the creator holds
+// its own mapping, it can still collect the histograms of a child that crashed.
+//
+// The creator makes a segment per child and passes its handle along:
+//
+//   scoped_ptr<SharedHistogramAllocator> allocator =
+//       SharedHistogramAllocator::Create(kSegmentSize);
+//   allocator->shared_memory()->ShareToProcess(child, &handle);
+//
+// The child opens it and makes it the home of all its histograms before it
+// creates any:
+//
+//   SharedHistogramAllocator::SetGlobal(
+//       SharedHistogramAllocator::Open(handle, kSegmentSize).release());
+//
+// From then on the creator calls ImportHistograms() on its allocator to fold
+// whatever the child has recorded into its own histograms of the same names.
+// Histograms whose samples are in a segment have kSharedMemoryFlag set, and
+// HistogramDeltaSerialization leaves them out. Once the segment is full, new
+// histograms keep their samples in the process' heap as before.
+
+#ifndef BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
+#define BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/memory/shared_memory.h"
+
+namespace base {
+
+class Histogram;
+class SampleVector;
+
+class BASE_EXPORT SharedHistogramAllocator {
+ public:
+  ~SharedHistogramAllocator();
+
+  // Creates and maps a new segment of |size| bytes. Returns NULL on failure.
+  static scoped_ptr<SharedHistogramAllocator> Create(size_t size);
+
+  // Maps the segment of |size| bytes that |handle| refers to, which another
+  // process made with Create(). Returns NULL if it can't be mapped or doesn't
+  // look like such a segment.
+  static scoped_ptr<SharedHistogramAllocator> Open(SharedMemoryHandle handle,
+                                                   size_t size);
+
+  // Makes |allocator| the home of the samples of histograms created from now
+  // on. Takes ownership; like the histograms, it is never destroyed. Must be
+  // called before other threads start creating histograms.
+  static void SetGlobal(SharedHistogramAllocator* allocator);
+
+  // Returns the allocator given to SetGlobal(), or NULL.
+  static SharedHistogramAllocator* GetGlobal();
+
+  // Stops placing the samples of new histograms in the global allocator and
+  // returns it. The histograms using it must not be used after it's destroyed.
+  static scoped_ptr<SharedHistogramAllocator> ReleaseGlobalForTesting();
+
+  // Returns storage in the segment for the samples of |histogram|, or NULL if
+  // the segment is full or |histogram| has a type that isn't supported.
+  scoped_ptr<SampleVector> AllocateSamples(const Histogram& histogram);
+
+  // Adds the samples recorded in the segment since the last call to the
+  // histograms of the same names in this process, creating them if needed.
+  // The contents of the segment aren't trusted.
+  void ImportHistograms();
+
+  SharedMemory* shared_memory() { return shared_memory_.get(); }
+
+ private:
+  struct ImportedHistogram;
+
+  explicit SharedHistogramAllocator(scoped_ptr<SharedMemory> shared_memory);
+
+  // Reserves |size| bytes in the segment and returns their offset, or 0 if
+  // there isn't room.
+  uint32 Allocate(uint32 size);
+
+  // Finds the records completed since the last call and adds them to
+  // |imported_histograms_|.
+  void FindNewRecords();
+
+  // Returns the local histogram for the record at |offset|, which has been
+  // checked to lie within the segment, or NULL if the record is invalid.
+  ImportedHistogram* CreateImportedHistogram(uint32 offset);
+
+  scoped_ptr<SharedMemory> shared_memory_;
+
+  // The size of the mapping. The segment's own idea of its size isn't trusted.
+  uint32 size_;
+
+  // The offset of the first record that FindNewRecords() hasn't looked at.
+  uint32 next_record_;
+
+  // Set once a record fails validation; nothing after it is imported.
+  bool corrupt_;
+
+  ScopedVector<ImportedHistogram> imported_histograms_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedHistogramAllocator);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
@@ -0,0 +1,187 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_allocator.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_delta_serialization.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/process/process_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const size_t kSegmentSize = 64 * 1024;
+
+}  // namespace
+
+// The tests play both processes: a "child" whose histograms live in the
+// segment, and the "browser" that made the segment and imports them. The
+// browser gets a fresh StatisticsRecorder so that it doesn't find the child's
+// histograms.
+class SharedHistogramAllocatorTest : public testing::Test {
+ protected:
+  SharedHistogramAllocatorTest()
+      : statistics_recorder_(new StatisticsRecorder) {
+  }
+
+  virtual ~SharedHistogramAllocatorTest() {
+    child_allocator_.reset();
+    delete statistics_recorder_;
+  }
+
+  // Makes the segment and starts placing histograms in it.
+  void StartChild(size_t segment_size) {
+    allocator_ = SharedHistogramAllocator::Create(segment_size);
+    ASSERT_TRUE(allocator_);
+    SharedMemoryHandle handle;
+    ASSERT_TRUE(allocator_->shared_memory()->ShareToProcess(
+        GetCurrentProcessHandle(), &handle));
+    scoped_ptr<SharedHistogramAllocator> child_allocator =
+        SharedHistogramAllocator::Open(handle, segment_size);
+    ASSERT_TRUE(child_allocator);
+    SharedHistogramAllocator::SetGlobal(child_allocator.release());
+  }
+
+  // Stops placing histograms in the segment and switches to the browser.
+  void StartBrowser() {
+    child_allocator_ = SharedHistogramAllocator::ReleaseGlobalForTesting();
+    delete statistics_recorder_;
+    statistics_recorder_ = new StatisticsRecorder;
+  }
+
+  StatisticsRecorder* statistics_recorder_;
+
+  // The browser's view of the segment.
+  scoped_ptr<SharedHistogramAllocator> allocator_;
+
+  // Kept until the child's histograms are no longer used.
+  scoped_ptr<SharedHistogramAllocator> child_allocator_;
+};
+
+TEST_F(SharedHistogramAllocatorTest, ImportHistograms) {
+  StartChild(kSegmentSize);
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "Shared.Histogram", 1, 1000, 10,
+      HistogramBase::kUmaTargetedHistogramFlag);
+  HistogramBase* linear_histogram =
+      LinearHistogram::FactoryGet("Shared.Linear", 1, 100, 10, 0);
+  HistogramBase* boolean_histogram =
+      BooleanHistogram::FactoryGet("Shared.Boolean", 0);
+  std::vector<HistogramBase::Sample> custom_ranges;
+  custom_ranges.push_back(10);
+  custom_ranges.push_back(20);
+  custom_ranges.push_back(30);
+  HistogramBase* custom_histogram =
+      CustomHistogram::FactoryGet("Shared.Custom", custom_ranges, 0);
+  EXPECT_TRUE(histogram->flags() & HistogramBase::kSharedMemoryFlag);
+  EXPECT_TRUE(linear_histogram->flags() & HistogramBase::kSharedMemoryFlag);
+  EXPECT_TRUE(boolean_histogram->flags() & HistogramBase::kSharedMemoryFlag);
+  EXPECT_TRUE(custom_histogram->flags() & HistogramBase::kSharedMemoryFlag);
+
+  histogram->Add(5);
+  histogram->Add(500);
+  linear_histogram->Add(50);
+  boolean_histogram->AddBoolean(true);
+  custom_histogram->Add(15);
+
+  // The samples aren't sent over IPC.
+  std::vector<std::string> deltas;
+  HistogramDeltaSerialization serializer("SharedHistogramAllocatorTest");
+  serializer.PrepareAndSerializeDeltas(&deltas);
+  EXPECT_TRUE(deltas.empty());
+
+  StartBrowser();
+  allocator_->ImportHistograms();
+
+  HistogramBase* imported = StatisticsRecorder::FindHistogram(
+      "Shared.Histogram");
+  ASSERT_TRUE(imported);
+  EXPECT_NE(histogram, imported);
+  EXPECT_EQ(HistogramBase::kUmaTargetedHistogramFlag, imported->flags());
+  scoped_ptr<HistogramSamples> samples = imported->SnapshotSamples();
+  EXPECT_EQ(1, samples->GetCount(5));
+  EXPECT_EQ(1, samples->GetCount(500));
+  EXPECT_EQ(505, samples->sum());
+
+  imported = StatisticsRecorder::FindHistogram("Shared.Linear");
+  ASSERT_TRUE(imported);
+  EXPECT_EQ(1, imported->SnapshotSamples()->GetCount(50));
+  imported = StatisticsRecorder::FindHistogram("Shared.Boolean");
+  ASSERT_TRUE(imported);
+  EXPECT_EQ(1, imported->SnapshotSamples()->GetCount(1));
+  imported = StatisticsRecorder::FindHistogram("Shared.Custom");
+  ASSERT_TRUE(imported);
+  EXPECT_EQ(CUSTOM_HISTOGRAM, imported->GetHistogramType());
+  EXPECT_EQ(1, imported->SnapshotSamples()->GetCount(15));
+
+  // Only what was added since the last import is imported.
+  histogram->Add(5);
+  allocator_->ImportHistograms();
+  allocator_->ImportHistograms();
+  imported = StatisticsRecorder::FindHistogram("Shared.Histogram");
+  samples = imported->SnapshotSamples();
+  EXPECT_EQ(2, samples->GetCount(5));
+  EXPECT_EQ(1, samples->GetCount(500));
+
+  // The samples can still be read once the child is gone.
+  histogram->Add(500);
+  child_allocator_.reset();
+  allocator_->ImportHistograms();
+  EXPECT_EQ(2, imported->SnapshotSamples()->GetCount(500));
+}
+
+TEST_F(SharedHistogramAllocatorTest, FullSegment) {
+  // Only room for one small histogram.
+  StartChild(128);
+  HistogramBase* first = Histogram::FactoryGet("Shared.First", 1, 1000, 10, 0);
+  HistogramBase* second =
+      Histogram::FactoryGet("Shared.Second", 1, 1000, 10, 0);
+  EXPECT_TRUE(first->flags() & HistogramBase::kSharedMemoryFlag);
+  EXPECT_FALSE(second->flags() & HistogramBase::kSharedMemoryFlag);
+
+  // The second one still works, from the heap.
+  second->Add(2);
+  EXPECT_EQ(1, second->SnapshotSamples()->GetCount(2));
+
+  StartBrowser();
+  allocator_->ImportHistograms();
+  EXPECT_TRUE(StatisticsRecorder::FindHistogram("Shared.First"));
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("Shared.Second"));
+}
+
+TEST_F(SharedHistogramAllocatorTest, CorruptSegment) {
+  StartChild(kSegmentSize);
+  HistogramBase* histogram =
+      Histogram::FactoryGet("Shared.Histogram", 1, 1000, 10, 0);
+  histogram->Add(5);
+
+  StartBrowser();
+
+  // Scribble over the record after its ready flag, as a compromised child
+  // could.
+  char* memory = static_cast<char*>(allocator_->shared_memory()->memory());
+  memset(memory + 12, 0xff, 64);
+  allocator_->ImportHistograms();
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("Shared.Histogram"));
+}
+
+TEST_F(SharedHistogramAllocatorTest, OpenRejectsOtherSegments) {
+  SharedMemory shared_memory;
+  ASSERT_TRUE(shared_memory.CreateAndMapAnonymous(kSegmentSize));
+  SharedMemoryHandle handle;
+  ASSERT_TRUE(shared_memory.ShareToProcess(GetCurrentProcessHandle(),
+                                           &handle));
+  EXPECT_FALSE(SharedHistogramAllocator::Open(handle, kSegmentSize));
+}
+
+}  // namespace base
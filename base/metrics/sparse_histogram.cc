@@ -4,11 +4,14 @@
 
 #include "base/metrics/sparse_histogram.h"
 
+#include "base/atomicops.h"
+#include "base/lazy_instance.h"
 #include "base/metrics/sample_map.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread_local.h"
 
 using std::map;
 using std::string;
@@ -18,6 +21,28 @@ namespace base {
 typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
+namespace {
+
+// Each thread is given a number the first time it records into a sparse
+// histogram, which picks its shard in all of them. The number is stored
+// plus one, so that zero means none has been given yet.
+LazyInstance<ThreadLocalPointer<void> >::Leaky g_thread_number =
+    LAZY_INSTANCE_INITIALIZER;
+subtle::Atomic32 g_last_thread_number = 0;
+
+uint32 GetThreadNumber() {
+  ThreadLocalPointer<void>& thread_number = g_thread_number.Get();
+  uintptr_t number = reinterpret_cast<uintptr_t>(thread_number.Get());
+  if (!number) {
+    number = static_cast<uint32>(
+        subtle::NoBarrier_AtomicIncrement(&g_last_thread_number, 1));
+    thread_number.Set(reinterpret_cast<void*>(number));
+  }
+  return static_cast<uint32>(number - 1);
+}
+
+}  // namespace
+
 // static
 HistogramBase* SparseHistogram::FactoryGet(const string& name, int32 flags) {
   HistogramBase* histogram = StatisticsRecorder::FindHistogram(name);
@@ -48,26 +73,31 @@ bool SparseHistogram::HasConstructionArguments(
 }
 
 void SparseHistogram::Add(Sample value) {
-  base::AutoLock auto_lock(lock_);
-  samples_.Accumulate(value, 1);
+  Shard* shard = GetShard();
+  base::AutoLock auto_lock(shard->lock);
+  shard->samples.Accumulate(value, 1);
 }
 
 scoped_ptr<HistogramSamples> SparseHistogram::SnapshotSamples() const {
   scoped_ptr<SampleMap> snapshot(new SampleMap());
 
-  base::AutoLock auto_lock(lock_);
-  snapshot->Add(samples_);
+  for (size_t i = 0; i < kNumShards; ++i) {
+    base::AutoLock auto_lock(shards_[i].lock);
+    snapshot->Add(shards_[i].samples);
+  }
   return snapshot.PassAs<HistogramSamples>();
 }
 
 void SparseHistogram::AddSamples(const HistogramSamples& samples) {
-  base::AutoLock auto_lock(lock_);
-  samples_.Add(samples);
+  Shard* shard = GetShard();
+  base::AutoLock auto_lock(shard->lock);
+  shard->samples.Add(samples);
 }
 
 bool SparseHistogram::AddSamplesFromPickle(PickleIterator* iter) {
-  base::AutoLock auto_lock(lock_);
-  return samples_.AddFromPickle(iter);
+  Shard* shard = GetShard();
+  base::AutoLock auto_lock(shard->lock);
+  return shard->samples.AddFromPickle(iter);
 }
 
 void SparseHistogram::WriteHTMLGraph(string* output) const {
@@ -87,6 +117,10 @@ bool SparseHistogram::SerializeInfoImpl(Pickle* pickle) const {
 SparseHistogram::SparseHistogram(const string& name)
     : HistogramBase(name) {}
 
+SparseHistogram::Shard* SparseHistogram::GetShard() const {
+  return &shards_[GetThreadNumber() % kNumShards];
+}
+
 HistogramBase* SparseHistogram::DeserializeInfoImpl(PickleIterator* iter) {
   string histogram_name;
   int flags;
@@ -104,10 +104,22 @@ class BASE_EXPORT_PRIVATE SparseHistogram : public HistogramBase {
   // For constuctor calling.
   friend class SparseHistogramTest;
 
-  // Protects access to |samples_|.
-  mutable base::Lock lock_;
+  // Samples are recorded into one of several shards, chosen by thread, so
+  // that threads recording into the same histogram don't usually contend for
+  // a lock. Snapshots merge the shards.
+  enum { kNumShards = 8 };
 
-  SampleMap samples_;
+  struct Shard {
+    // Protects access to |samples|.
+    base::Lock lock;
+
+    SampleMap samples;
+  };
+
+  // Returns the shard for the current thread.
+  Shard* GetShard() const;
+
+  mutable Shard shards_[kNumShards];
 
   DISALLOW_COPY_AND_ASSIGN(SparseHistogram);
 };
@@ -10,8 +10,10 @@
 #include "base/metrics/sample_map.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/metrics/statistics_recorder.h"
+#include "base/memory/scoped_vector.h"
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
+#include "base/threading/simple_thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -141,4 +143,49 @@ TEST_F(SparseHistogramTest, Serialize) {
   EXPECT_FALSE(iter.SkipBytes(1));
 }
 
+namespace {
+
+class SparseHistogramAdder : public DelegateSimpleThread::Delegate {
+ public:
+  SparseHistogramAdder(SparseHistogram* histogram, int num_samples)
+      : histogram_(histogram),
+        num_samples_(num_samples) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_samples_; ++i)
+      histogram_->Add(i % 10);
+  }
+
+ private:
+  SparseHistogram* const histogram_;
+  const int num_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(SparseHistogramAdder);
+};
+
+}  // namespace
+
+// Samples recorded on different threads all show up in snapshots.
+TEST_F(SparseHistogramTest, ConcurrentAdd) {
+  const int kNumThreads = 16;
+  const int kNumSamples = 1000;
+  scoped_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
+
+  SparseHistogramAdder adder(histogram.get(), kNumSamples);
+  ScopedVector<DelegateSimpleThread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(new DelegateSimpleThread(&adder, "SparseAdder"));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Join();
+  histogram->Add(5);
+
+  scoped_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(kNumThreads * kNumSamples + 1, snapshot->TotalCount());
+  EXPECT_EQ(kNumThreads * kNumSamples / 10, snapshot->GetCount(0));
+  EXPECT_EQ(kNumThreads * kNumSamples / 10 + 1, snapshot->GetCount(5));
+}
+
 }  // namespace base
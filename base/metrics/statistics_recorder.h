@@ -88,11 +88,14 @@ class BASE_EXPORT StatisticsRecorder {
   friend class HistogramBaseTest;
   friend class HistogramSnapshotManagerTest;
   friend class HistogramTest;
+  friend class SharedHistogramAllocatorTest;
   friend class SparseHistogramTest;
   friend class StatisticsDeltaReaderTest;
   friend class StatisticsRecorderTest;
   FRIEND_TEST_ALL_PREFIXES(HistogramDeltaSerializationTest,
                            DeserializeHistogramAndAddSamples);
+  FRIEND_TEST_ALL_PREFIXES(HistogramDeltaSerializationTest,
+                           LaterDeltasSentByNameHash);
 
   // The constructor just initializes static members. Usually client code should
   // use Initialize to do this. But in test code, you can friend this class and
@@ -6,7 +6,8 @@
 
 #include <stdlib.h>
 
-#include <algorithm>  // for max()
+#include <algorithm>  // for max() and min()
+#include <limits>
 
 //------------------------------------------------------------------------------
 
@@ -165,8 +166,9 @@ Pickle::Pickle()
     : header_(NULL),
       header_size_(sizeof(Header)),
       capacity_after_header_(0),
-      write_offset_(0) {
-  Resize(kPayloadUnit);
+      write_offset_(0),
+      heap_allocated_(false) {
+  UseInlineStorage();
   header_->payload_size = 0;
 }
 
@@ -174,10 +176,29 @@ Pickle::Pickle(int header_size)
     : header_(NULL),
       header_size_(AlignInt(header_size, sizeof(uint32))),
       capacity_after_header_(0),
-      write_offset_(0) {
+      write_offset_(0),
+      heap_allocated_(false) {
   DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
   DCHECK_LE(header_size, kPayloadUnit);
-  Resize(kPayloadUnit);
+  UseInlineStorage();
+  header_->payload_size = 0;
+}
+
+Pickle::Pickle(int header_size, char* buffer, size_t buffer_size)
+    : header_(NULL),
+      header_size_(AlignInt(header_size, sizeof(uint32))),
+      capacity_after_header_(0),
+      write_offset_(0),
+      heap_allocated_(false) {
+  DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
+  DCHECK_LE(header_size, kPayloadUnit);
+  DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(buffer) % sizeof(uint32));
+  if (buffer_size >= header_size_) {
+    header_ = reinterpret_cast<Header*>(buffer);
+    capacity_after_header_ = buffer_size - header_size_;
+  } else {
+    UseInlineStorage();
+  }
   header_->payload_size = 0;
 }
 
@@ -185,7 +206,8 @@ Pickle::Pickle(const char* data, int data_len)
     : header_(reinterpret_cast<Header*>(const_cast<char*>(data))),
       header_size_(0),
       capacity_after_header_(kCapacityReadOnly),
-      write_offset_(0) {
+      write_offset_(0),
+      heap_allocated_(false) {
   if (data_len >= static_cast<int>(sizeof(Header)))
     header_size_ = data_len - header_->payload_size;
 
@@ -204,15 +226,17 @@ Pickle::Pickle(const Pickle& other)
     : header_(NULL),
       header_size_(other.header_size_),
       capacity_after_header_(0),
-      write_offset_(other.write_offset_) {
-  size_t payload_size = header_size_ + other.header_->payload_size;
-  Resize(payload_size);
-  memcpy(header_, other.header_, payload_size);
+      write_offset_(0),
+      heap_allocated_(false) {
+  UseInlineStorage();
+  if (other.header_->payload_size > capacity_after_header_)
+    Resize(other.header_->payload_size);
+  memcpy(header_, other.header_, header_size_ + other.header_->payload_size);
+  write_offset_ = other.write_offset_;
 }
 
 Pickle::~Pickle() {
-  if (capacity_after_header_ != kCapacityReadOnly)
-    free(header_);
+  FreeHeapStorage();
 }
 
 Pickle& Pickle::operator=(const Pickle& other) {
@@ -220,16 +244,15 @@ Pickle& Pickle::operator=(const Pickle& other) {
     NOTREACHED();
     return *this;
   }
-  if (capacity_after_header_ == kCapacityReadOnly) {
-    header_ = NULL;
-    capacity_after_header_ = 0;
-  }
-  if (header_size_ != other.header_size_) {
-    free(header_);
-    header_ = NULL;
+  if (capacity_after_header_ == kCapacityReadOnly || !header_ ||
+      header_size_ != other.header_size_) {
+    FreeHeapStorage();
     header_size_ = other.header_size_;
+    UseInlineStorage();
   }
-  Resize(other.header_->payload_size);
+  write_offset_ = 0;
+  if (other.header_->payload_size > capacity_after_header_)
+    Resize(other.header_->payload_size);
   memcpy(header_, other.header_,
          other.header_size_ + other.header_->payload_size);
   write_offset_ = other.write_offset_;
@@ -284,12 +307,38 @@ void Pickle::Resize(size_t new_capacity) {
   new_capacity = AlignInt(new_capacity, kPayloadUnit);
 
   CHECK_NE(capacity_after_header_, kCapacityReadOnly);
-  void* p = realloc(header_, header_size_ + new_capacity);
-  CHECK(p);
-  header_ = reinterpret_cast<Header*>(p);
+  if (heap_allocated_) {
+    void* p = realloc(header_, header_size_ + new_capacity);
+    CHECK(p);
+    header_ = reinterpret_cast<Header*>(p);
+  } else {
+    // Move out of the inline storage or the caller's buffer.
+    void* p = malloc(header_size_ + new_capacity);
+    CHECK(p);
+    memcpy(p, header_,
+           header_size_ + std::min(write_offset_, new_capacity));
+    header_ = reinterpret_cast<Header*>(p);
+    heap_allocated_ = true;
+  }
   capacity_after_header_ = new_capacity;
 }
 
+void Pickle::UseInlineStorage() {
+  // The inline storage must fit the largest header and a payload unit.
+  COMPILE_ASSERT(kInlineStorageSize >= 2 * kPayloadUnit,
+                 inline_storage_too_small);
+  DCHECK(!heap_allocated_);
+  header_ = inline_storage_.data_as<Header>();
+  capacity_after_header_ = kPayloadUnit;
+}
+
+void Pickle::FreeHeapStorage() {
+  if (heap_allocated_)
+    free(header_);
+  header_ = NULL;
+  heap_allocated_ = false;
+}
+
 // static
 const char* Pickle::FindNext(size_t header_size,
                              const char* start,
@@ -307,6 +356,25 @@ const char* Pickle::FindNext(size_t header_size,
   return start + header_size + hdr->payload_size;
 }
 
+// static
+bool Pickle::PeekNext(size_t header_size,
+                      const char* start,
+                      const char* end,
+                      size_t* pickle_size) {
+  DCHECK_EQ(header_size, AlignInt(header_size, sizeof(uint32)));
+  DCHECK_LE(header_size, static_cast<size_t>(kPayloadUnit));
+
+  size_t length = static_cast<size_t>(end - start);
+  if (length < sizeof(Header) || length < header_size)
+    return false;
+
+  const Header* hdr = reinterpret_cast<const Header*>(start);
+  if (hdr->payload_size > std::numeric_limits<size_t>::max() - header_size)
+    return false;
+  *pickle_size = header_size + hdr->payload_size;
+  return true;
+}
+
 template <size_t length> void Pickle::WriteBytesStatic(const void* data) {
   WriteBytesCommon(data, length);
 }
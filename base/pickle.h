@@ -12,6 +12,7 @@
 #include "base/compiler_specific.h"
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
+#include "base/memory/aligned_memory.h"
 #include "base/strings/string16.h"
 
 class Pickle;
@@ -110,6 +111,13 @@ class BASE_EXPORT Pickle {
   // will be rounded up to ensure that the header size is 32bit-aligned.
   explicit Pickle(int header_size);
 
+  // Initializes a Pickle with the specified header size that writes into
+  // |buffer|, which must be 32bit-aligned and outlive the Pickle. Once the
+  // data outgrows |buffer| it is moved to the heap, so use data() rather than
+  // |buffer| to get at it. This avoids allocating for pickles whose size is
+  // known to be small.
+  Pickle(int header_size, char* buffer, size_t buffer_size);
+
   // Initializes a Pickle from a const block of data.  The data is not copied;
   // instead the data is merely referenced by this Pickle.  Only const methods
   // should be used on the Pickle when initialized this way.  The header
@@ -314,12 +322,31 @@ class BASE_EXPORT Pickle {
                               const char* range_start,
                               const char* range_end);
 
+  // Find the size of the pickled data that starts at range_start, from its
+  // header alone. Returns false if the header is not all in the given data
+  // range, or if the size doesn't fit in a size_t.
+  static bool PeekNext(size_t header_size,
+                       const char* range_start,
+                       const char* range_end,
+                       size_t* pickle_size);
+
   // The allocation granularity of the payload.
   static const int kPayloadUnit;
 
  private:
   friend class PickleIterator;
 
+  // Pickles start out in |inline_storage_|, which has room for the largest
+  // header and kPayloadUnit bytes of payload, and only go to the heap when
+  // they grow beyond that.
+  enum { kInlineStorageSize = 128 };
+
+  // Makes |inline_storage_| hold the pickle, discarding its contents.
+  void UseInlineStorage();
+
+  // Frees the heap allocation holding the pickle, if any.
+  void FreeHeapStorage();
+
   Header* header_;
   size_t header_size_;  // Supports extra data between header and payload.
   // Allocation size of payload (or -1 if allocation is const). Note: this
@@ -329,6 +356,12 @@ class BASE_EXPORT Pickle {
   // the header.
   size_t write_offset_;
 
+  // Whether |header_| was allocated by Resize(), rather than being
+  // |inline_storage_|, a caller's buffer or const data.
+  bool heap_allocated_;
+
+  base::AlignedMemory<kInlineStorageSize, sizeof(uint64)> inline_storage_;
+
   // Just like WriteBytes, but with a compile-time size, for performance.
   template<size_t length> void WriteBytesStatic(const void* data);
 
@@ -343,6 +376,7 @@ class BASE_EXPORT Pickle {
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNext);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNextWithIncompleteHeader);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNextOverflow);
+  FRIEND_TEST_ALL_PREFIXES(PickleTest, PeekNext);
 };
 
 #endif  // BASE_PICKLE_H__
@@ -216,6 +216,27 @@ TEST(PickleTest, FindNextOverflow) {
 #pragma warning(pop)
 #endif
 
+TEST(PickleTest, PeekNext) {
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteInt(1));
+  EXPECT_TRUE(pickle.WriteString("Domo"));
+
+  const char* start = reinterpret_cast<const char*>(pickle.data());
+  const char* end = start + pickle.size();
+
+  // Only the header is needed to know the size.
+  size_t pickle_size = 0;
+  EXPECT_TRUE(Pickle::PeekNext(pickle.header_size_, start,
+                               start + pickle.header_size_, &pickle_size));
+  EXPECT_EQ(pickle.size(), pickle_size);
+  pickle_size = 0;
+  EXPECT_TRUE(Pickle::PeekNext(pickle.header_size_, start, end, &pickle_size));
+  EXPECT_EQ(pickle.size(), pickle_size);
+  EXPECT_FALSE(Pickle::PeekNext(pickle.header_size_, start,
+                                start + pickle.header_size_ - 1,
+                                &pickle_size));
+}
+
 TEST(PickleTest, GetReadPointerAndAdvance) {
   Pickle pickle;
 
@@ -267,6 +288,52 @@ TEST(PickleTest, Resize) {
   EXPECT_EQ(cur_payload, pickle.payload_size());
 }
 
+// Small pickles are held within the Pickle object.
+TEST(PickleTest, InlineStorage) {
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteInt(1));
+  EXPECT_TRUE(pickle.WriteString("small"));
+  const char* object_start = reinterpret_cast<const char*>(&pickle);
+  const char* data = static_cast<const char*>(pickle.data());
+  EXPECT_GE(data, object_start);
+  EXPECT_LT(data, object_start + sizeof(pickle));
+
+  Pickle copy(pickle);
+  EXPECT_NE(pickle.data(), copy.data());
+  PickleIterator iter(copy);
+  int outint;
+  std::string outstring;
+  EXPECT_TRUE(copy.ReadInt(&iter, &outint));
+  EXPECT_EQ(1, outint);
+  EXPECT_TRUE(copy.ReadString(&iter, &outstring));
+  EXPECT_EQ("small", outstring);
+}
+
+// A pickle writes into the buffer it is given until it outgrows it.
+TEST(PickleTest, ExternalBuffer) {
+  uint32 buffer[16];
+  Pickle pickle(sizeof(Pickle::Header), reinterpret_cast<char*>(buffer),
+                sizeof(buffer));
+  EXPECT_EQ(static_cast<const void*>(buffer), pickle.data());
+  for (int i = 0; i < 8; ++i)
+    EXPECT_TRUE(pickle.WriteInt(i));
+  EXPECT_EQ(static_cast<const void*>(buffer), pickle.data());
+
+  std::string long_string(1000, 'x');
+  EXPECT_TRUE(pickle.WriteString(long_string));
+  EXPECT_NE(static_cast<const void*>(buffer), pickle.data());
+
+  PickleIterator iter(pickle);
+  for (int i = 0; i < 8; ++i) {
+    int outint;
+    EXPECT_TRUE(pickle.ReadInt(&iter, &outint));
+    EXPECT_EQ(i, outint);
+  }
+  std::string outstring;
+  EXPECT_TRUE(pickle.ReadString(&iter, &outstring));
+  EXPECT_EQ(long_string, outstring);
+}
+
 namespace {
 
 struct CustomHeader : Pickle::Header {
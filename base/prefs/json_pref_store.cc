@@ -5,16 +5,21 @@
 #include "base/prefs/json_pref_store.h"
 
 #include <algorithm>
+#include <map>
 
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/file_util.h"
 #include "base/json/json_file_value_serializer.h"
-#include "base/json/json_string_value_serializer.h"
+#include "base/json/json_value_builder.h"
+#include "base/json/json_writer.h"
+#include "base/json/string_escape.h"
 #include "base/memory/ref_counted.h"
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/prefs/pref_filter.h"
 #include "base/sequenced_task_runner.h"
+#include "base/stl_util.h"
+#include "base/strings/string_util.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "base/values.h"
 
@@ -23,6 +28,41 @@ namespace {
 // Some extensions we'll tack on to copies of the Preferences files.
 const base::FilePath::CharType* kBadExtension = FILE_PATH_LITERAL("bad");
 
+// The line ending and indentation JSONWriter uses when pretty printing.
+#if defined(OS_WIN)
+const char kLineEnding[] = "\r\n";
+#else
+const char kLineEnding[] = "\n";
+#endif
+const size_t kIndentWidth = 3;
+
+// Appends |value| to |output| pretty printed the way JSONWriter prints it
+// as a value |depth| dictionaries deep.  JSONWriter indents every line but
+// the empty one inside an empty dictionary by |kIndentWidth| per level, so
+// this shifts those lines of a top-level serialization over.
+bool WriteIndentedValue(const base::Value& value,
+                        size_t depth,
+                        std::string* output) {
+  std::string json;
+  bool result = base::JSONWriter::WriteWithOptions(
+      &value, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  const size_t line_ending_length = arraysize(kLineEnding) - 1;
+  DCHECK(EndsWith(json, kLineEnding, true));
+  json.resize(json.size() - line_ending_length);
+
+  size_t start = 0;
+  size_t end;
+  while ((end = json.find(kLineEnding, start)) != std::string::npos) {
+    end += line_ending_length;
+    output->append(json, start, end - start);
+    if (json.compare(end, line_ending_length, kLineEnding) != 0)
+      output->append(depth * kIndentWidth, ' ');
+    start = end;
+  }
+  output->append(json, start, std::string::npos);
+  return result;
+}
+
 // Differentiates file loading between origin thread and passed
 // (aka file) thread.
 class FileThreadDeserializer
@@ -68,7 +108,13 @@ class FileThreadDeserializer
     int error_code;
     std::string error_msg;
     JSONFileValueSerializer serializer(path);
-    base::Value* value = serializer.Deserialize(&error_code, &error_msg);
+    // Build the prefs straight from the parser's events, so that they don't
+    // keep a copy of the file's contents alive the way the Values returned by
+    // Deserialize() do.
+    base::JSONValueBuilder builder;
+    base::Value* value = NULL;
+    if (serializer.DeserializeWithDelegate(&builder, &error_code, &error_msg))
+      value = builder.PassValue().release();
     HandleErrors(value, path, error_code, error_msg, error);
     *no_dir = !base::PathExists(path.DirName());
     return value;
@@ -141,6 +187,127 @@ void FileThreadDeserializer::HandleErrors(
 
 }  // namespace
 
+// A dictionary entry is either cached whole or, once a pref inside it
+// changed, split into an entry per child so that later writes serialize
+// only the children that changed.  Every cached byte is held by a single
+// entry, so the cache costs about as much memory as the written file.
+class JsonPrefStore::SerializedEntry {
+ public:
+  SerializedEntry() {}
+  ~SerializedEntry() { STLDeleteValues(&children_); }
+
+  // Drops the cached JSON of the pref at |path|, relative to this entry's
+  // dictionary, and splits the entries containing it.
+  void Invalidate(const std::string& path);
+
+  // Appends |dict|, the value of this entry, pretty printed |depth|
+  // dictionaries deep to |output|, reusing and updating the cache of its
+  // children.  Returns false if a value could not be serialized.
+  bool SerializeDictionary(const base::DictionaryValue& dict,
+                           size_t depth,
+                           std::string* output);
+
+ private:
+  typedef std::map<std::string, SerializedEntry*> ChildMap;
+
+  // Appends the line for |key| and its |value| to |output|, from the cache
+  // when there is one.
+  bool Serialize(const std::string& key,
+                 const base::Value& value,
+                 size_t depth,
+                 std::string* output);
+
+  // The whole serialized entry, key included, or empty if it isn't cached.
+  std::string json_;
+
+  // Cached children of a split dictionary entry.
+  ChildMap children_;
+
+  DISALLOW_COPY_AND_ASSIGN(SerializedEntry);
+};
+
+void JsonPrefStore::SerializedEntry::Invalidate(const std::string& path) {
+  SerializedEntry* entry = this;
+  std::string::size_type start = 0;
+  for (;;) {
+    std::string::size_type end = path.find('.', start);
+    SerializedEntry*& child =
+        entry->children_[path.substr(start, end - start)];
+    if (!child)
+      child = new SerializedEntry;
+    child->json_.clear();
+    if (end == std::string::npos) {
+      STLDeleteValues(&child->children_);
+      return;
+    }
+    entry = child;
+    start = end + 1;
+  }
+}
+
+bool JsonPrefStore::SerializedEntry::SerializeDictionary(
+    const base::DictionaryValue& dict,
+    size_t depth,
+    std::string* output) {
+  bool result = true;
+  output->push_back('{');
+  output->append(kLineEnding);
+
+  // Rebuilt in the order of |dict|, leaving out the entries of removed prefs.
+  ChildMap children;
+  for (base::DictionaryValue::Iterator it(dict); !it.IsAtEnd(); it.Advance()) {
+    SerializedEntry* child = NULL;
+    ChildMap::iterator cached = children_.find(it.key());
+    if (cached != children_.end()) {
+      child = cached->second;
+      children_.erase(cached);
+    } else {
+      child = new SerializedEntry;
+    }
+    if (!children.empty()) {
+      output->push_back(',');
+      output->append(kLineEnding);
+    }
+    children.insert(children.end(), std::make_pair(it.key(), child));
+    if (!child->Serialize(it.key(), it.value(), depth + 1, output))
+      result = false;
+  }
+  STLDeleteValues(&children_);
+  children_.swap(children);
+
+  output->append(kLineEnding);
+  output->append(depth * kIndentWidth, ' ');
+  output->push_back('}');
+  return result;
+}
+
+bool JsonPrefStore::SerializedEntry::Serialize(const std::string& key,
+                                               const base::Value& value,
+                                               size_t depth,
+                                               std::string* output) {
+  if (!json_.empty()) {
+    output->append(json_);
+    return true;
+  }
+
+  std::string line(depth * kIndentWidth, ' ');
+  base::EscapeJSONString(key, true, &line);
+  line.append(": ");
+
+  const base::DictionaryValue* dict = NULL;
+  if (!children_.empty() && value.GetAsDictionary(&dict)) {
+    output->append(line);
+    return SerializeDictionary(*dict, depth, output);
+  }
+
+  STLDeleteValues(&children_);
+  bool result = WriteIndentedValue(value, depth, &line);
+  output->append(line);
+  if (result)
+    json_.swap(line);
+  return result;
+}
+
 scoped_refptr<base::SequencedTaskRunner> JsonPrefStore::GetTaskRunnerForFile(
     const base::FilePath& filename,
     base::SequencedWorkerPool* worker_pool) {
@@ -157,6 +324,7 @@ JsonPrefStore::JsonPrefStore(const base::FilePath& filename,
     : path_(filename),
       sequenced_task_runner_(sequenced_task_runner),
       prefs_(new base::DictionaryValue()),
+      serialized_prefs_(new SerializedEntry),
       read_only_(false),
       writer_(filename, sequenced_task_runner),
       pref_filter_(pref_filter.Pass()),
@@ -192,6 +360,8 @@ bool JsonPrefStore::IsInitializationComplete() const {
 
 bool JsonPrefStore::GetMutableValue(const std::string& key,
                                     base::Value** result) {
+  // The caller may change the value without reporting it.
+  InvalidateSerializedValue(key);
   return prefs_->Get(key, result);
 }
 
@@ -214,6 +384,7 @@ void JsonPrefStore::SetValueSilently(const std::string& key,
   prefs_->Get(key, &old_value);
   if (!old_value || !value->Equals(old_value)) {
     prefs_->Set(key, new_value.release());
+    InvalidateSerializedValue(key);
     if (!read_only_)
       writer_.ScheduleWrite(this);
   }
@@ -267,6 +438,8 @@ void JsonPrefStore::CommitPendingWrite() {
 }
 
 void JsonPrefStore::ReportValueChanged(const std::string& key) {
+  InvalidateSerializedValue(key);
+
   if (pref_filter_)
     pref_filter_->FilterUpdate(key);
 
@@ -316,6 +489,7 @@ void JsonPrefStore::OnFileRead(base::Value* value_owned,
 
   if (pref_filter_)
     pref_filter_->FilterOnLoad(prefs_.get());
+  serialized_prefs_.reset(new SerializedEntry);
 
   if (error_delegate_.get() && error != PREF_READ_ERROR_NONE)
     error_delegate_->OnError(error);
@@ -333,7 +507,13 @@ bool JsonPrefStore::SerializeData(std::string* output) {
   if (pref_filter_)
     pref_filter_->FilterSerializeData(prefs_.get());
 
-  JSONStringValueSerializer serializer(output);
-  serializer.set_pretty_print(true);
-  return serializer.Serialize(*prefs_);
+  // Produces the same output as pretty printing |prefs_| with JSONWriter.
+  output->clear();
+  bool result = serialized_prefs_->SerializeDictionary(*prefs_, 0, output);
+  output->append(kLineEnding);
+  return result;
+}
+
+void JsonPrefStore::InvalidateSerializedValue(const std::string& key) {
+  serialized_prefs_->Invalidate(key);
 }
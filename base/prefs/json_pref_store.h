@@ -75,16 +75,29 @@ class BASE_PREFS_EXPORT JsonPrefStore
   void OnFileRead(base::Value* value_owned, PrefReadError error, bool no_dir);
 
  private:
+  // Cached JSON of the parts of |prefs_| that did not change since the last
+  // write, defined in the .cc file.
+  class SerializedEntry;
+
   virtual ~JsonPrefStore();
 
   // ImportantFileWriter::DataSerializer overrides:
   virtual bool SerializeData(std::string* output) OVERRIDE;
 
+  // Drops the cached JSON of |key| and of the dictionaries containing it, so
+  // that the next write serializes them again.  Must be called whenever the
+  // value at |key| may have changed.
+  void InvalidateSerializedValue(const std::string& key);
+
   base::FilePath path_;
   const scoped_refptr<base::SequencedTaskRunner> sequenced_task_runner_;
 
   scoped_ptr<base::DictionaryValue> prefs_;
 
+  // Lets SerializeData() reuse the JSON of unchanged prefs, so that a write
+  // only costs time proportional to what changed since the previous one.
+  scoped_ptr<SerializedEntry> serialized_prefs_;
+
   bool read_only_;
 
   // Helper for safely writing pref data.
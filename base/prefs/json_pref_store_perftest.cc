@@ -0,0 +1,126 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long JsonPrefStore takes to serialize a large Preferences file
+// when a single pref changed between writes, compared to serializing all of
+// it with JSONWriter.
+
+#include "base/prefs/json_pref_store.h"
+
+#include <string>
+
+#include "base/files/important_file_writer.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/prefs/pref_filter.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kNumExtensions = 1000;
+const int kNumIterations = 100;
+
+// Returns the settings of extension |i|, shaped like the entries of the
+// "extensions.settings" pref.
+DictionaryValue* BuildExtensionSettings(int i) {
+  DictionaryValue* extension = new DictionaryValue;
+  extension->SetBoolean("active_bit", false);
+  extension->SetInteger("creation_flags", 1);
+  extension->SetBoolean("from_webstore", true);
+  extension->SetString("install_time", StringPrintf("1300%09d", i));
+  extension->SetInteger("location", 1);
+  extension->SetString("path", StringPrintf("%032d/1.0_0", i));
+  extension->SetInteger("state", 1);
+  ListValue* permissions = new ListValue;
+  permissions->AppendString("tabs");
+  permissions->AppendString("storage");
+  permissions->AppendString(StringPrintf("http://www.example%d.com/*", i));
+  extension->Set("granted_permissions.api", permissions);
+  DictionaryValue* manifest = new DictionaryValue;
+  manifest->SetString("name", StringPrintf("Extension %d", i));
+  manifest->SetString("description", std::string(200, 'd'));
+  manifest->SetString("version", "1.0");
+  extension->Set("manifest", manifest);
+  return extension;
+}
+
+}  // namespace
+
+class JsonPrefStorePerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    pref_store_ = new JsonPrefStore(
+        temp_dir_.path().AppendASCII("Preferences"),
+        message_loop_.message_loop_proxy(),
+        scoped_ptr<PrefFilter>());
+    ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NO_FILE,
+              pref_store_->ReadPrefs());
+    for (int i = 0; i < kNumExtensions; ++i) {
+      std::string key = StringPrintf("extensions.settings.%032d", i);
+      prefs_.Set(key, BuildExtensionSettings(i));
+      pref_store_->SetValue(key, BuildExtensionSettings(i));
+    }
+    prefs_.SetString("homepage", "http://www.example.com/");
+    pref_store_->SetValue("homepage",
+                          new StringValue("http://www.example.com/"));
+    pref_store_->CommitPendingWrite();
+    RunLoop().RunUntilIdle();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    pref_store_ = NULL;
+    RunLoop().RunUntilIdle();
+  }
+
+  // Changes the state of extension |i| in both |prefs_| and |pref_store_|.
+  void ChangeExtensionState(int i) {
+    std::string key =
+        StringPrintf("extensions.settings.%032d.state", i % kNumExtensions);
+    prefs_.SetInteger(key, i);
+    pref_store_->SetValue(key, new FundamentalValue(i));
+  }
+
+  ScopedTempDir temp_dir_;
+  MessageLoop message_loop_;
+  DictionaryValue prefs_;
+  scoped_refptr<JsonPrefStore> pref_store_;
+};
+
+TEST_F(JsonPrefStorePerfTest, SerializeAll) {
+  std::string json;
+  PerfTimeLogger logger("JsonPrefStore_SerializeAll");
+  for (int i = 0; i < kNumIterations; ++i) {
+    ChangeExtensionState(i);
+    ASSERT_TRUE(JSONWriter::WriteWithOptions(
+        &prefs_, JSONWriter::OPTIONS_PRETTY_PRINT, &json));
+  }
+  logger.Done();
+}
+
+TEST_F(JsonPrefStorePerfTest, SerializeChanged) {
+  ImportantFileWriter::DataSerializer* serializer = pref_store_.get();
+  std::string json;
+  PerfTimeLogger logger("JsonPrefStore_SerializeChanged");
+  for (int i = 0; i < kNumIterations; ++i) {
+    ChangeExtensionState(i);
+    ASSERT_TRUE(serializer->SerializeData(&json));
+  }
+  logger.Done();
+
+  std::string expected_json;
+  ASSERT_TRUE(JSONWriter::WriteWithOptions(
+      &prefs_, JSONWriter::OPTIONS_PRETTY_PRINT, &expected_json));
+  EXPECT_EQ(expected_json, json);
+}
+
+}  // namespace base
@@ -6,6 +6,7 @@
 
 #include "base/file_util.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/json/json_writer.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
@@ -278,6 +279,87 @@ TEST_F(JsonPrefStoreTest, RemoveClearsEmptyParent) {
   EXPECT_FALSE(has_dict);
 }
 
+// Writes |pref_store| to |pref_file| and checks that the file holds the same
+// JSON as pretty printing |expected| in one go.
+void ExpectWrittenAs(JsonPrefStore* pref_store,
+                     const FilePath& pref_file,
+                     const DictionaryValue& expected) {
+  pref_store->CommitPendingWrite();
+  RunLoop().RunUntilIdle();
+
+  std::string expected_json;
+  ASSERT_TRUE(JSONWriter::WriteWithOptions(
+      &expected, JSONWriter::OPTIONS_PRETTY_PRINT, &expected_json));
+  std::string written_json;
+  ASSERT_TRUE(ReadFileToString(pref_file, &written_json));
+  EXPECT_EQ(expected_json, written_json);
+}
+
+// Tests that writes which reuse the JSON of unchanged prefs produce the same
+// file as serializing all prefs.
+TEST_F(JsonPrefStoreTest, IncrementalWrites) {
+  FilePath pref_file = temp_dir_.path().AppendASCII("incremental.json");
+
+  scoped_refptr<JsonPrefStore> pref_store = new JsonPrefStore(
+      pref_file,
+      message_loop_.message_loop_proxy(),
+      scoped_ptr<PrefFilter>());
+  ASSERT_EQ(PersistentPrefStore::PREF_READ_ERROR_NO_FILE,
+            pref_store->ReadPrefs());
+  DictionaryValue expected;
+
+  ListValue* list = new ListValue;
+  list->AppendString("first");
+  DictionaryValue* list_dict = new DictionaryValue;
+  list_dict->SetInteger("nested", 1);
+  list->Append(list_dict);
+  expected.Set("a.e", list->DeepCopy());
+  pref_store->SetValue("a.e", list);
+  expected.SetInteger("a.b.c", 1);
+  pref_store->SetValue("a.b.c", new FundamentalValue(1));
+  expected.SetString("a.b.d", "text");
+  pref_store->SetValue("a.b.d", new StringValue("text"));
+  expected.Set("f", new DictionaryValue);
+  pref_store->SetValue("f", new DictionaryValue);
+  expected.SetBoolean("g", true);
+  pref_store->SetValue("g", new FundamentalValue(true));
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+
+  // Change a pref nested inside cached dictionaries.
+  expected.SetInteger("a.b.c", 2);
+  pref_store->SetValue("a.b.c", new FundamentalValue(2));
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+
+  // Change a value in place and report it.
+  Value* value = NULL;
+  ASSERT_TRUE(pref_store->GetMutableValue("a.e", &value));
+  ASSERT_TRUE(value->GetAsList(&list));
+  list->AppendString("second");
+  expected.Set("a.e", list->DeepCopy());
+  pref_store->ReportValueChanged("a.e");
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+
+  // Remove prefs.
+  expected.RemovePath("a.b.d", NULL);
+  pref_store->RemoveValue("a.b.d");
+  expected.RemovePath("g", NULL);
+  pref_store->RemoveValue("g");
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+
+  // Replace a dictionary with a plain value and back.
+  expected.SetString("a.b", "flat");
+  pref_store->SetValue("a.b", new StringValue("flat"));
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+  expected.SetInteger("a.b.x", 3);
+  pref_store->SetValue("a.b.x", new FundamentalValue(3));
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+
+  // Changing the nested dictionary to an empty one.
+  expected.Set("a.b", new DictionaryValue);
+  pref_store->SetValue("a.b", new DictionaryValue);
+  ExpectWrittenAs(pref_store.get(), pref_file, expected);
+}
+
 // Tests asynchronous reading of the file when there is no file.
 TEST_F(JsonPrefStoreTest, AsyncNonExistingFile) {
   base::FilePath bogus_input_file = data_dir_.AppendASCII("read.txt");
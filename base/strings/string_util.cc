@@ -378,11 +378,11 @@ bool IsStringASCII(const std::wstring& str) {
 #endif
 
 bool IsStringASCII(const string16& str) {
-  return DoIsStringASCII(str);
+  return base::CountLeadingASCII(str.data(), str.length()) == str.length();
 }
 
 bool IsStringASCII(const base::StringPiece& str) {
-  return DoIsStringASCII(str);
+  return base::CountLeadingASCII(str.data(), str.length()) == str.length();
 }
 
 bool IsStringUTF8(const std::string& str) {
@@ -391,6 +391,12 @@ bool IsStringUTF8(const std::string& str) {
   int32 char_index = 0;
 
   while (char_index < src_len) {
+    // ASCII characters are all valid, so skip runs of them in bulk.
+    if (static_cast<unsigned char>(src[char_index]) < 0x80) {
+      char_index += static_cast<int32>(
+          base::CountLeadingASCII(src + char_index, src_len - char_index));
+      continue;
+    }
     int32 code_point;
     CBU8_NEXT(src, char_index, src_len, code_point);
     if (!base::IsValidCharacter(code_point))
@@ -4,10 +4,140 @@
 
 #include "base/strings/utf_string_conversion_utils.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "base/third_party/icu/icu_utf.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BASE_UTF_STRING_CONVERSION_UTILS_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace base {
 
+namespace {
+
+#if !defined(BASE_UTF_STRING_CONVERSION_UTILS_SSE2)
+// Without SSE2 the ASCII checks go a machine word at a time. This also covers
+// ARM, where NEON is optional, and a word-wide test does as well as NEON for
+// finding the end of an ASCII run.
+typedef uintptr_t MachineWord;
+
+const MachineWord kNonASCIIBytes =
+    static_cast<MachineWord>(0x8080808080808080ULL);
+const MachineWord kNonASCIIChar16s =
+    static_cast<MachineWord>(0xFF80FF80FF80FF80ULL);
+
+template <typename CHAR>
+MachineWord LoadWord(const CHAR* src) {
+  MachineWord word;
+  memcpy(&word, src, sizeof(word));
+  return word;
+}
+#endif
+
+}  // namespace
+
+// ASCII runs ------------------------------------------------------------------
+
+size_t CountLeadingASCII(const char* src, size_t src_len) {
+  size_t i = 0;
+#if defined(BASE_UTF_STRING_CONVERSION_UTILS_SSE2)
+  for (; i + 16 <= src_len; i += 16) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // The top bit of each byte is set for non-ASCII bytes.
+    if (_mm_movemask_epi8(chunk))
+      break;
+  }
+#else
+  for (; i + sizeof(MachineWord) <= src_len; i += sizeof(MachineWord)) {
+    if (LoadWord(src + i) & kNonASCIIBytes)
+      break;
+  }
+#endif
+  while (i < src_len && static_cast<unsigned char>(src[i]) < 0x80)
+    ++i;
+  return i;
+}
+
+size_t CountLeadingASCII(const char16* src, size_t src_len) {
+  size_t i = 0;
+#if defined(BASE_UTF_STRING_CONVERSION_UTILS_SSE2)
+  const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<short>(0xFF80));
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= src_len; i += 8) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(chunk, non_ascii_bits), zero);
+    if (_mm_movemask_epi8(ascii) != 0xFFFF)
+      break;
+  }
+#else
+  const size_t kCharsPerWord = sizeof(MachineWord) / sizeof(char16);
+  for (; i + kCharsPerWord <= src_len; i += kCharsPerWord) {
+    if (LoadWord(src + i) & kNonASCIIChar16s)
+      break;
+  }
+#endif
+  while (i < src_len && src[i] < 0x80)
+    ++i;
+  return i;
+}
+
+void AppendASCII(const char* src, size_t src_len, string16* output) {
+  // Widens into a buffer and appends that, because resizing |output| first
+  // would fill it a character at a time with c16memset().
+  const size_t kBufferSize = 256;
+  char16 buffer[kBufferSize];
+  while (src_len) {
+    size_t count = std::min(src_len, kBufferSize);
+    size_t i = 0;
+#if defined(BASE_UTF_STRING_CONVERSION_UTILS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+      __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i),
+                       _mm_unpacklo_epi8(chunk, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i + 8),
+                       _mm_unpackhi_epi8(chunk, zero));
+    }
+#endif
+    for (; i < count; ++i)
+      buffer[i] = static_cast<unsigned char>(src[i]);
+    output->append(buffer, count);
+    src += count;
+    src_len -= count;
+  }
+}
+
+void AppendASCII(const char16* src, size_t src_len, std::string* output) {
+  size_t offset = output->size();
+  output->resize(offset + src_len);
+  if (!src_len)
+    return;
+  char* dest = &(*output)[offset];
+  size_t i = 0;
+#if defined(BASE_UTF_STRING_CONVERSION_UTILS_SSE2)
+  for (; i + 16 <= src_len; i += 16) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+    // The characters are ASCII, so packing doesn't saturate any of them.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_packus_epi16(low, high));
+  }
+#endif
+  for (; i < src_len; ++i)
+    dest[i] = static_cast<char>(src[i]);
+}
+
 // ReadUnicodeCharacter --------------------------------------------------------
 
 bool ReadUnicodeCharacter(const char* src,
@@ -56,6 +56,21 @@ BASE_EXPORT bool ReadUnicodeCharacter(const wchar_t* src,
                                       uint32* code_point);
 #endif  // defined(WCHAR_T_IS_UTF32)
 
+// ASCII runs ------------------------------------------------------------------
+
+// Returns the number of ASCII characters at the start of |src|. Checks 16
+// bytes at a time where it can, so that converters can copy runs of ASCII
+// characters as they are and only decode the rest one code point at a time.
+BASE_EXPORT size_t CountLeadingASCII(const char* src, size_t src_len);
+BASE_EXPORT size_t CountLeadingASCII(const char16* src, size_t src_len);
+
+// Appends the |src_len| ASCII characters at |src| to |output|, widening or
+// narrowing each to the character type of |output|.
+BASE_EXPORT void AppendASCII(const char* src, size_t src_len, string16* output);
+BASE_EXPORT void AppendASCII(const char16* src,
+                             size_t src_len,
+                             std::string* output);
+
 // WriteUnicodeCharacter -------------------------------------------------------
 
 // Appends a UTF-8 character to the given 8-bit string.  Returns the number of
@@ -12,6 +12,39 @@ namespace base {
 
 namespace {
 
+// ASCII runs ------------------------------------------------------------------
+
+template<typename CHAR>
+bool IsASCII(CHAR c) {
+  return static_cast<typename ToUnsigned<CHAR>::Unsigned>(c) < 0x80;
+}
+
+// Appends the run of ASCII characters at the start of |src| to |output| and
+// returns its length. UTF-8 <-> UTF-16 conversions find and copy the run a
+// block at a time, the rest a character at a time.
+template<typename SRC_CHAR, typename DEST_STRING>
+size_t AppendASCIIRun(const SRC_CHAR* src,
+                      size_t src_len,
+                      DEST_STRING* output) {
+  typedef typename DEST_STRING::value_type DEST_CHAR;
+  size_t run = 0;
+  for (; run < src_len && IsASCII(src[run]); ++run)
+    output->push_back(static_cast<DEST_CHAR>(src[run]));
+  return run;
+}
+
+size_t AppendASCIIRun(const char* src, size_t src_len, string16* output) {
+  size_t run = CountLeadingASCII(src, src_len);
+  AppendASCII(src, run, output);
+  return run;
+}
+
+size_t AppendASCIIRun(const char16* src, size_t src_len, std::string* output) {
+  size_t run = CountLeadingASCII(src, src_len);
+  AppendASCII(src, run, output);
+  return run;
+}
+
 // Generalized Unicode converter -----------------------------------------------
 
 // Converts the given source Unicode character type to the given destination
@@ -26,6 +59,12 @@ bool ConvertUnicode(const SRC_CHAR* src,
   bool success = true;
   int32 src_len32 = static_cast<int32>(src_len);
   for (int32 i = 0; i < src_len32; i++) {
+    if (IsASCII(src[i])) {
+      int32 run = static_cast<int32>(AppendASCIIRun(src + i, src_len32 - i,
+                                                    output));
+      i += run - 1;
+      continue;
+    }
     uint32 code_point;
     if (ReadUnicodeCharacter(src, src_len32, &i, &code_point)) {
       WriteUnicodeCharacter(code_point, output);
@@ -0,0 +1,97 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Times UTF-8 <-> UTF-16 conversion and UTF-8 validation of mostly ASCII,
+// CJK and mixed text.
+
+#include "base/strings/utf_string_conversions.h"
+
+#include <string>
+
+#include "base/strings/string_util.h"
+#include "base/test/perf_log.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// The corpora are about this many bytes of UTF-8.
+const size_t kCorpusSize = 64 * 1024;
+const int kIterations = 2000;
+
+// English text with the odd accented letter, as on most web pages.
+const char kLatin[] =
+    "The quick brown fox jumps over the lazy dog while the caf\xC3\xA9 "
+    "down the street serves cr\xC3\xA8me br\xC3\xBBl\xC3\xA9""e to anyone "
+    "who asks nicely and pays in advance. ";
+
+// Japanese text, three bytes per character.
+const char kCJK[] =
+    "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87\xE7\xAB"
+    "\xA0\xE3\x81\xAF\xE6\xBC\xA2\xE5\xAD\x97\xE3\x81\xA8\xE4\xBB\xAE\xE5"
+    "\x90\x8D\xE3\x82\x92\xE6\xB7\xB7\xE3\x81\x9C\xE3\x81\xA6\xE6\x9B\xB8"
+    "\xE3\x81\x8D\xE3\x81\xBE\xE3\x81\x99\xE3\x80\x82";
+
+// Markup around CJK text, like a Chinese web page.
+const char kMixed[] =
+    "<div class=\"article-body\"><p>\xE4\xBB\x8A\xE5\xA4\xA9\xE7\x9A\x84"
+    "\xE5\xA4\xA9\xE6\xB0\x94\xE5\xBE\x88\xE5\xA5\xBD</p>"
+    "<a href=\"http://www.example.com/news/index.html\">\xE6\x96\xB0\xE9"
+    "\x97\xBB</a></div>\n";
+
+std::string MakeCorpus(const char* text) {
+  std::string corpus;
+  while (corpus.size() < kCorpusSize)
+    corpus += text;
+  return corpus;
+}
+
+void RunTest(const std::string& name, const char* text) {
+  const std::string utf8 = MakeCorpus(text);
+  string16 utf16;
+  ASSERT_TRUE(UTF8ToUTF16(utf8.data(), utf8.size(), &utf16));
+
+  {
+    PerfTimeLogger logger(("UTF8ToUTF16_" + name).c_str());
+    for (int i = 0; i < kIterations; ++i)
+      UTF8ToUTF16(utf8.data(), utf8.size(), &utf16);
+    logger.Done();
+  }
+
+  std::string round_trip;
+  {
+    PerfTimeLogger logger(("UTF16ToUTF8_" + name).c_str());
+    for (int i = 0; i < kIterations; ++i)
+      UTF16ToUTF8(utf16.data(), utf16.size(), &round_trip);
+    logger.Done();
+  }
+  EXPECT_EQ(utf8, round_trip);
+
+  int valid = 0;
+  {
+    PerfTimeLogger logger(("IsStringUTF8_" + name).c_str());
+    for (int i = 0; i < kIterations; ++i)
+      valid += IsStringUTF8(utf8);
+    logger.Done();
+  }
+  EXPECT_EQ(kIterations, valid);
+}
+
+}  // namespace
+
+TEST(UTFStringConversionsPerfTest, Latin) {
+  RunTest("Latin", kLatin);
+}
+
+TEST(UTFStringConversionsPerfTest, CJK) {
+  RunTest("CJK", kCJK);
+}
+
+TEST(UTFStringConversionsPerfTest, Mixed) {
+  RunTest("Mixed", kMixed);
+}
+
+}  // namespace base
@@ -208,4 +208,33 @@ TEST(UTFStringConversionsTest, ConvertMultiString) {
   EXPECT_EQ(expected, converted);
 }
 
+// ASCII runs are copied a block at a time. Put non-ASCII characters, valid and
+// not, at every offset in and around a block.
+TEST(UTFStringConversionsTest, ConvertASCIIRuns) {
+  const std::string ascii(40, 'a');
+  for (size_t i = 0; i <= ascii.size(); ++i) {
+    std::string utf8 = ascii;
+    utf8.insert(i, "\xC3\xA9");
+    string16 utf16 = ASCIIToUTF16(ascii);
+    utf16.insert(i, 1, 0xE9);
+    EXPECT_EQ(utf16, UTF8ToUTF16(utf8));
+    EXPECT_EQ(utf8, UTF16ToUTF8(utf16));
+    EXPECT_TRUE(IsStringUTF8(utf8));
+    EXPECT_FALSE(IsStringASCII(utf8));
+    EXPECT_FALSE(IsStringASCII(utf16));
+
+    std::string invalid_utf8 = ascii;
+    invalid_utf8.insert(i, 1, '\xFF');
+    string16 replaced = ASCIIToUTF16(ascii);
+    replaced.insert(i, 1, 0xFFFD);
+    string16 converted;
+    EXPECT_FALSE(UTF8ToUTF16(invalid_utf8.data(), invalid_utf8.size(),
+                             &converted));
+    EXPECT_EQ(replaced, converted);
+    EXPECT_FALSE(IsStringUTF8(invalid_utf8));
+  }
+  EXPECT_TRUE(IsStringASCII(ascii));
+  EXPECT_TRUE(IsStringASCII(ASCIIToUTF16(ascii)));
+}
+
 }  // base
@@ -304,6 +304,8 @@ class SequencedWorkerPool::Inner {
   void ThreadLoop(Worker* this_worker);
 
  private:
+  typedef std::set<SequencedTask, SequencedTaskLessThan> PendingTaskSet;
+
   enum GetWorkStatus {
     GET_WORK_FOUND,
     GET_WORK_NOT_FOUND,
@@ -362,6 +364,15 @@ class SequencedWorkerPool::Inner {
   // sequence token.
   bool IsSequenceTokenRunnable(int sequence_token_id) const;
 
+  // Called from within the lock, these maintain |runnable_tasks_| and
+  // |sequence_tasks_|. LockedAddPendingTask() queues a newly posted task.
+  // LockedRemoveRunnableTask() removes a task from the front of its sequence;
+  // the rest of the sequence stays blocked until LockedMakeSequenceRunnable()
+  // is called, once the removed task has run or been deleted.
+  void LockedAddPendingTask(const SequencedTask& task);
+  void LockedRemoveRunnableTask(PendingTaskSet::iterator task);
+  void LockedMakeSequenceRunnable(int sequence_token_id);
+
   // Checks if all threads are busy and the addition of one more could run an
   // additional task waiting in the queue. This must be called from within
   // the lock.
@@ -435,19 +446,28 @@ class SequencedWorkerPool::Inner {
   // or SKIP_ON_SHUTDOWN flag set.
   size_t blocking_shutdown_thread_count_;
 
-  // A set of all pending tasks in time-to-run order. These are tasks that are
-  // either waiting for a thread to run on, waiting for their time to run,
-  // or blocked on a previous task in their sequence. We have to iterate over
-  // the tasks by time-to-run order, so we use the set instead of the
-  // traditional priority_queue.
-  typedef std::set<SequencedTask, SequencedTaskLessThan> PendingTaskSet;
-  PendingTaskSet pending_tasks_;
+  // The pending tasks that a free thread could pick up, in time-to-run order:
+  // every unsequenced task, and the first task of each sequence that isn't
+  // currently running. These are waiting either for a thread to run on or for
+  // their time to run. We have to iterate over the tasks by time-to-run order,
+  // so we use the set instead of the traditional priority_queue.
+  PendingTaskSet runnable_tasks_;
+
+  // All pending tasks of each sequence in time-to-run order, keyed by sequence
+  // token ID. The first task of a sequence is also in |runnable_tasks_| unless
+  // the sequence is running; the others are blocked on it. Keeping blocked
+  // tasks out of |runnable_tasks_| means GetWork() never has to skip over
+  // them, however many tasks a busy sequence has queued.
+  typedef std::map<int, PendingTaskSet> SequenceTaskMap;
+  SequenceTaskMap sequence_tasks_;
+
+  // The total number of pending tasks, runnable or blocked.
+  size_t pending_task_count_;
 
   // The next sequence number for a new sequenced task.
   int64 next_sequence_task_number_;
 
-  // Number of tasks in the pending_tasks_ list that are marked as blocking
-  // shutdown.
+  // Number of pending tasks that are marked as blocking shutdown.
   size_t blocking_shutdown_pending_task_count_;
 
   // Lists all sequence tokens currently executing.
@@ -521,6 +541,7 @@ SequencedWorkerPool::Inner::Inner(
       thread_being_created_(false),
       waiting_thread_count_(0),
       blocking_shutdown_thread_count_(0),
+      pending_task_count_(0),
       next_sequence_task_number_(0),
       blocking_shutdown_pending_task_count_(0),
       trace_id_(0),
@@ -603,7 +624,7 @@ bool SequencedWorkerPool::Inner::PostTask(
     if (optional_token_name)
       sequenced.sequence_token_id = LockedGetNamedTokenID(*optional_token_name);
 
-    pending_tasks_.insert(sequenced);
+    LockedAddPendingTask(sequenced);
     if (shutdown_behavior == BLOCK_SHUTDOWN)
       blocking_shutdown_pending_task_count_++;
 
@@ -642,7 +663,7 @@ void SequencedWorkerPool::Inner::CleanupForTesting() {
   CHECK_EQ(CLEANUP_DONE, cleanup_state_);
   if (shutdown_called_)
     return;
-  if (pending_tasks_.empty() && waiting_thread_count_ == threads_.size())
+  if (pending_task_count_ == 0 && waiting_thread_count_ == threads_.size())
     return;
   cleanup_state_ = CLEANUP_REQUESTED;
   cleanup_idlers_ = 0;
@@ -900,44 +921,23 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
 
 #if !defined(OS_NACL)
   UMA_HISTOGRAM_COUNTS_100("SequencedWorkerPool.TaskCount",
-                           static_cast<int>(pending_tasks_.size()));
+                           static_cast<int>(pending_task_count_));
 #endif
 
-  // Find the next task with a sequence token that's not currently in use.
-  // If the token is in use, that means another thread is running something
-  // in that sequence, and we can't run it without going out-of-order.
-  //
-  // This algorithm is simple and fair, but inefficient in some cases. For
-  // example, say somebody schedules 1000 slow tasks with the same sequence
-  // number. We'll have to go through all those tasks each time we feel like
-  // there might be work to schedule. If this proves to be a problem, we
-  // should make this more efficient.
-  //
-  // One possible enhancement would be to keep a map from sequence ID to a
-  // list of pending but currently blocked SequencedTasks for that ID.
-  // When a worker finishes a task of one sequence token, it can pick up the
-  // next one from that token right away.
-  //
-  // This may lead to starvation if there are sufficient numbers of sequences
-  // in use. To alleviate this, we could add an incrementing priority counter
-  // to each SequencedTask. Then maintain a priority_queue of all runnable
-  // tasks, sorted by priority counter. When a sequenced task is completed
-  // we would pop the head element off of that tasks pending list and add it
-  // to the priority queue. Then we would run the first item in the priority
-  // queue.
+  // Run the first task in |runnable_tasks_|. Tasks whose sequence token is in
+  // use, meaning another thread is running something in that sequence, are
+  // kept out of that set until the running task finishes, so everything in it
+  // can run without going out-of-order. This picks the same task as scanning
+  // all pending tasks in time-to-run order for the first one with a sequence
+  // token not in use would, without having to skip over blocked tasks.
 
   GetWorkStatus status = GET_WORK_NOT_FOUND;
-  int unrunnable_tasks = 0;
-  PendingTaskSet::iterator i = pending_tasks_.begin();
   // We assume that the loop below doesn't take too long and so we can just do
   // a single call to TimeTicks::Now().
   const TimeTicks current_time = TimeTicks::Now();
-  while (i != pending_tasks_.end()) {
-    if (!IsSequenceTokenRunnable(i->sequence_token_id)) {
-      unrunnable_tasks++;
-      ++i;
-      continue;
-    }
+  while (!runnable_tasks_.empty()) {
+    PendingTaskSet::iterator i = runnable_tasks_.begin();
+    DCHECK(IsSequenceTokenRunnable(i->sequence_token_id));
 
     if (shutdown_called_ && i->shutdown_behavior != BLOCK_SHUTDOWN) {
       // We're shutting down and the task we just found isn't blocking
@@ -956,7 +956,9 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
       // vector they passed to us once the lock is exited to make this
       // happen.
       delete_these_outside_lock->push_back(i->task);
-      pending_tasks_.erase(i++);
+      int sequence_token_id = i->sequence_token_id;
+      LockedRemoveRunnableTask(i);
+      LockedMakeSequenceRunnable(sequence_token_id);
       continue;
     }
 
@@ -967,14 +969,17 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
       if (cleanup_state_ == CLEANUP_RUNNING) {
         // Deferred tasks are deleted when cleaning up, see Inner::ThreadLoop.
         delete_these_outside_lock->push_back(i->task);
-        pending_tasks_.erase(i);
+        int sequence_token_id = i->sequence_token_id;
+        LockedRemoveRunnableTask(i);
+        LockedMakeSequenceRunnable(sequence_token_id);
       }
       break;
     }
 
-    // Found a runnable task.
+    // Found a runnable task. The rest of its sequence stays blocked until
+    // DidRunWorkerTask().
     *task = *i;
-    pending_tasks_.erase(i);
+    LockedRemoveRunnableTask(i);
     if (task->shutdown_behavior == BLOCK_SHUTDOWN) {
       blocking_shutdown_pending_task_count_--;
     }
@@ -983,13 +988,6 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
     break;
   }
 
-  // Track the number of tasks we had to skip over to see if we should be
-  // making this more efficient. If this number ever becomes large or is
-  // frequently "some", we should consider the optimization above.
-#if !defined(OS_NACL)
-  UMA_HISTOGRAM_COUNTS_100("SequencedWorkerPool.UnrunnableTaskCount",
-                           unrunnable_tasks);
-#endif
   return status;
 }
 
@@ -1032,8 +1030,10 @@ void SequencedWorkerPool::Inner::DidRunWorkerTask(const SequencedTask& task) {
     blocking_shutdown_thread_count_--;
   }
 
-  if (task.sequence_token_id)
+  if (task.sequence_token_id) {
     current_sequences_.erase(task.sequence_token_id);
+    LockedMakeSequenceRunnable(task.sequence_token_id);
+  }
 }
 
 bool SequencedWorkerPool::Inner::IsSequenceTokenRunnable(
@@ -1044,6 +1044,58 @@ bool SequencedWorkerPool::Inner::IsSequenceTokenRunnable(
           current_sequences_.end();
 }
 
+void SequencedWorkerPool::Inner::LockedAddPendingTask(
+    const SequencedTask& task) {
+  lock_.AssertAcquired();
+  pending_task_count_++;
+  if (!task.sequence_token_id) {
+    runnable_tasks_.insert(task);
+    return;
+  }
+
+  PendingTaskSet& sequence = sequence_tasks_[task.sequence_token_id];
+  if (IsSequenceTokenRunnable(task.sequence_token_id)) {
+    // The new task may come before the sequence's current first task, e.g. if
+    // that one is delayed.
+    if (sequence.empty()) {
+      runnable_tasks_.insert(task);
+    } else if (SequencedTaskLessThan()(task, *sequence.begin())) {
+      runnable_tasks_.erase(*sequence.begin());
+      runnable_tasks_.insert(task);
+    }
+  }
+  sequence.insert(task);
+}
+
+void SequencedWorkerPool::Inner::LockedRemoveRunnableTask(
+    PendingTaskSet::iterator task) {
+  lock_.AssertAcquired();
+  DCHECK_GT(pending_task_count_, 0u);
+  pending_task_count_--;
+  if (task->sequence_token_id) {
+    SequenceTaskMap::iterator sequence =
+        sequence_tasks_.find(task->sequence_token_id);
+    DCHECK(sequence != sequence_tasks_.end());
+    DCHECK_EQ(task->sequence_task_number,
+              sequence->second.begin()->sequence_task_number);
+    sequence->second.erase(sequence->second.begin());
+    if (sequence->second.empty())
+      sequence_tasks_.erase(sequence);
+  }
+  runnable_tasks_.erase(task);
+}
+
+void SequencedWorkerPool::Inner::LockedMakeSequenceRunnable(
+    int sequence_token_id) {
+  lock_.AssertAcquired();
+  if (!sequence_token_id)
+    return;
+  SequenceTaskMap::const_iterator sequence =
+      sequence_tasks_.find(sequence_token_id);
+  if (sequence != sequence_tasks_.end())
+    runnable_tasks_.insert(*sequence->second.begin());
+}
+
 int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
   lock_.AssertAcquired();
   // How thread creation works:
@@ -1081,13 +1133,10 @@ int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
       threads_.size() < max_threads_ &&
       waiting_thread_count_ == 0) {
     // We could use an additional thread if there's work to be done.
-    for (PendingTaskSet::const_iterator i = pending_tasks_.begin();
-         i != pending_tasks_.end(); ++i) {
-      if (IsSequenceTokenRunnable(i->sequence_token_id)) {
-        // Found a runnable task, mark the thread as being started.
-        thread_being_created_ = true;
-        return static_cast<int>(threads_.size() + 1);
-      }
+    if (!runnable_tasks_.empty()) {
+      // Found a runnable task, mark the thread as being started.
+      thread_being_created_ = true;
+      return static_cast<int>(threads_.size() + 1);
     }
   }
   return 0;
@@ -0,0 +1,79 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how fast SequencedWorkerPool gets through large numbers of short
+// tasks, which is dominated by the cost of GetWork() finding the next one.
+
+#include "base/threading/sequenced_worker_pool.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/memory/ref_counted.h"
+#include "base/message_loop/message_loop.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const size_t kNumWorkerThreads = 8;
+const int kNumTasks = 20000;
+const int kNumSequences = 100;
+
+class SequencedWorkerPoolPerfTest : public testing::Test {
+ protected:
+  SequencedWorkerPoolPerfTest()
+      : pool_(new SequencedWorkerPool(kNumWorkerThreads, "PerfTest")) {}
+
+  virtual ~SequencedWorkerPoolPerfTest() {
+    pool_->Shutdown();
+  }
+
+  MessageLoop message_loop_;
+  scoped_refptr<SequencedWorkerPool> pool_;
+};
+
+}  // namespace
+
+TEST_F(SequencedWorkerPoolPerfTest, Unsequenced) {
+  PerfTimeLogger timer("SequencedWorkerPool_Unsequenced");
+  for (int i = 0; i < kNumTasks; ++i)
+    pool_->PostWorkerTask(FROM_HERE, Bind(&DoNothing));
+  pool_->FlushForTesting();
+  timer.Done();
+}
+
+TEST_F(SequencedWorkerPoolPerfTest, ManySequences) {
+  std::vector<SequencedWorkerPool::SequenceToken> tokens;
+  for (int i = 0; i < kNumSequences; ++i)
+    tokens.push_back(pool_->GetSequenceToken());
+
+  PerfTimeLogger timer("SequencedWorkerPool_ManySequences");
+  for (int i = 0; i < kNumTasks; ++i) {
+    pool_->PostSequencedWorkerTask(tokens[i % kNumSequences], FROM_HERE,
+                                   Bind(&DoNothing));
+  }
+  pool_->FlushForTesting();
+  timer.Done();
+}
+
+// A long queue of tasks in one sequence, e.g. the simple cache index, while
+// other work is posted to the pool. Each GetWork() used to walk past all the
+// blocked tasks of the busy sequence.
+TEST_F(SequencedWorkerPoolPerfTest, LongSequence) {
+  SequencedWorkerPool::SequenceToken token = pool_->GetSequenceToken();
+
+  PerfTimeLogger timer("SequencedWorkerPool_LongSequence");
+  for (int i = 0; i < kNumTasks; ++i) {
+    pool_->PostSequencedWorkerTask(token, FROM_HERE, Bind(&DoNothing));
+    pool_->PostWorkerTask(FROM_HERE, Bind(&DoNothing));
+  }
+  pool_->FlushForTesting();
+  timer.Done();
+}
+
+}  // namespace base
@@ -20,6 +20,12 @@ namespace base {
 
 namespace {
 
+// Orders the entries of a flat dictionary by key, for std::lower_bound().
+bool EntryKeyLess(const std::pair<std::string, Value*>& entry,
+                  const std::string& key) {
+  return entry.first < key;
+}
+
 // Make a deep copy of |node|, but don't include empty lists or dictionaries
 // in the copy. It's possible for this function to return NULL and it
 // expects |node| to always be non-NULL.
@@ -381,19 +387,26 @@ bool DictionaryValue::GetAsDictionary(const DictionaryValue** out_value) const {
 
 bool DictionaryValue::HasKey(const std::string& key) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator current_entry = dictionary_.find(key);
-  DCHECK((current_entry == dictionary_.end()) || current_entry->second);
-  return current_entry != dictionary_.end();
+  Value** current_entry = const_cast<DictionaryValue*>(this)->FindValue(key);
+  DCHECK(!current_entry || *current_entry);
+  return current_entry != NULL;
 }
 
 void DictionaryValue::Clear() {
-  ValueMap::iterator dict_iterator = dictionary_.begin();
-  while (dict_iterator != dictionary_.end()) {
-    delete dict_iterator->second;
-    ++dict_iterator;
+  if (large_dictionary_) {
+    ValueMap::iterator dict_iterator = large_dictionary_->begin();
+    while (dict_iterator != large_dictionary_->end()) {
+      delete dict_iterator->second;
+      ++dict_iterator;
+    }
+    large_dictionary_.reset();
   }
 
-  dictionary_.clear();
+  for (FlatValueMap::iterator it = flat_dictionary_.begin();
+       it != flat_dictionary_.end(); ++it) {
+    delete it->second;
+  }
+  FlatValueMap().swap(flat_dictionary_);
 }
 
 void DictionaryValue::Set(const std::string& path, Value* in_value) {
@@ -446,13 +459,34 @@ void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
                                               Value* in_value) {
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
-  std::pair<ValueMap::iterator, bool> ins_res =
-      dictionary_.insert(std::make_pair(key, in_value));
-  if (!ins_res.second) {
-    DCHECK_NE(ins_res.first->second, in_value);  // This would be bogus
-    delete ins_res.first->second;
-    ins_res.first->second = in_value;
+  Value** existing = FindValue(key);
+  if (existing) {
+    DCHECK_NE(*existing, in_value);  // This would be bogus
+    delete *existing;
+    *existing = in_value;
+    return;
+  }
+
+  if (!large_dictionary_ && flat_dictionary_.size() == kMaxFlatSize) {
+    large_dictionary_.reset(
+        new ValueMap(flat_dictionary_.begin(), flat_dictionary_.end()));
+    FlatValueMap().swap(flat_dictionary_);
   }
+  if (large_dictionary_) {
+    large_dictionary_->insert(std::make_pair(key, in_value));
+    return;
+  }
+
+  // Shift the later entries up by swapping, which doesn't copy their keys.
+  size_t index = std::lower_bound(flat_dictionary_.begin(),
+                                  flat_dictionary_.end(), key, &EntryKeyLess) -
+      flat_dictionary_.begin();
+  flat_dictionary_.push_back(std::make_pair(std::string(), in_value));
+  for (size_t i = flat_dictionary_.size() - 1; i > index; --i) {
+    flat_dictionary_[i].first.swap(flat_dictionary_[i - 1].first);
+    std::swap(flat_dictionary_[i].second, flat_dictionary_[i - 1].second);
+  }
+  flat_dictionary_[index].first = key;
 }
 
 void DictionaryValue::SetBooleanWithoutPathExpansion(
@@ -628,13 +662,12 @@ bool DictionaryValue::GetList(const std::string& path, ListValue** out_value) {
 bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
                                               const Value** out_value) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  Value** entry = const_cast<DictionaryValue*>(this)->FindValue(key);
+  if (!entry)
     return false;
 
-  const Value* entry = entry_iterator->second;
   if (out_value)
-    *out_value = entry;
+    *out_value = *entry;
   return true;
 }
 
@@ -757,16 +790,36 @@ bool DictionaryValue::Remove(const std::string& path,
 bool DictionaryValue::RemoveWithoutPathExpansion(const std::string& key,
                                                  scoped_ptr<Value>* out_value) {
   DCHECK(IsStringUTF8(key));
-  ValueMap::iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
-    return false;
+  Value* entry = NULL;
+  if (large_dictionary_) {
+    ValueMap::iterator entry_iterator = large_dictionary_->find(key);
+    if (entry_iterator == large_dictionary_->end())
+      return false;
+    entry = entry_iterator->second;
+    large_dictionary_->erase(entry_iterator);
+  } else {
+    FlatValueMap::iterator entry_iterator =
+        std::lower_bound(flat_dictionary_.begin(), flat_dictionary_.end(),
+                         key, &EntryKeyLess);
+    if (entry_iterator == flat_dictionary_.end() ||
+        entry_iterator->first != key) {
+      return false;
+    }
+    entry = entry_iterator->second;
+    // Shift the later entries down by swapping, as in
+    // SetWithoutPathExpansion().
+    for (size_t i = entry_iterator - flat_dictionary_.begin();
+         i + 1 < flat_dictionary_.size(); ++i) {
+      flat_dictionary_[i].first.swap(flat_dictionary_[i + 1].first);
+      flat_dictionary_[i].second = flat_dictionary_[i + 1].second;
+    }
+    flat_dictionary_.pop_back();
+  }
 
-  Value* entry = entry_iterator->second;
   if (out_value)
     out_value->reset(entry);
   else
     delete entry;
-  dictionary_.erase(entry_iterator);
   return true;
 }
 
@@ -813,23 +866,45 @@ void DictionaryValue::MergeDictionary(const DictionaryValue* dictionary) {
 }
 
 void DictionaryValue::Swap(DictionaryValue* other) {
-  dictionary_.swap(other->dictionary_);
+  flat_dictionary_.swap(other->flat_dictionary_);
+  large_dictionary_.swap(other->large_dictionary_);
+}
+
+Value** DictionaryValue::FindValue(const std::string& key) {
+  if (large_dictionary_) {
+    ValueMap::iterator entry_iterator = large_dictionary_->find(key);
+    if (entry_iterator == large_dictionary_->end())
+      return NULL;
+    return &entry_iterator->second;
+  }
+
+  FlatValueMap::iterator entry_iterator =
+      std::lower_bound(flat_dictionary_.begin(), flat_dictionary_.end(), key,
+                       &EntryKeyLess);
+  if (entry_iterator == flat_dictionary_.end() ||
+      entry_iterator->first != key) {
+    return NULL;
+  }
+  return &entry_iterator->second;
 }
 
 DictionaryValue::Iterator::Iterator(const DictionaryValue& target)
     : target_(target),
-      it_(target.dictionary_.begin()) {}
+      flat_it_(target.flat_dictionary_.begin()) {
+  if (target.large_dictionary_)
+    map_it_ = target.large_dictionary_->begin();
+}
 
 DictionaryValue::Iterator::~Iterator() {}
 
 DictionaryValue* DictionaryValue::DeepCopy() const {
   DictionaryValue* result = new DictionaryValue;
 
-  for (ValueMap::const_iterator current_entry(dictionary_.begin());
-       current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
-  }
+  // Entries come out in order, so each one is added at the end.
+  if (!large_dictionary_)
+    result->flat_dictionary_.reserve(flat_dictionary_.size());
+  for (Iterator it(*this); !it.IsAtEnd(); it.Advance())
+    result->SetWithoutPathExpansion(it.key(), it.value().DeepCopy());
 
   return result;
 }
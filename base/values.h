@@ -207,6 +207,9 @@ class BASE_EXPORT BinaryValue: public Value {
 // parsing for recursive access; see the comment at the top of the file. Keys
 // are |std::string|s and should be UTF-8 encoded.
 class BASE_EXPORT DictionaryValue : public Value {
+ private:
+  typedef std::vector<std::pair<std::string, Value*> > FlatValueMap;
+
  public:
   DictionaryValue();
   virtual ~DictionaryValue();
@@ -220,10 +223,13 @@ class BASE_EXPORT DictionaryValue : public Value {
   bool HasKey(const std::string& key) const;
 
   // Returns the number of Values in this dictionary.
-  size_t size() const { return dictionary_.size(); }
+  size_t size() const {
+    return large_dictionary_ ? large_dictionary_->size() :
+                               flat_dictionary_.size();
+  }
 
   // Returns whether the dictionary is empty.
-  bool empty() const { return dictionary_.empty(); }
+  bool empty() const { return size() == 0; }
 
   // Clears any current contents of this dictionary.
   void Clear();
@@ -351,15 +357,29 @@ class BASE_EXPORT DictionaryValue : public Value {
     explicit Iterator(const DictionaryValue& target);
     ~Iterator();
 
-    bool IsAtEnd() const { return it_ == target_.dictionary_.end(); }
-    void Advance() { ++it_; }
-
-    const std::string& key() const { return it_->first; }
-    const Value& value() const { return *it_->second; }
+    bool IsAtEnd() const {
+      return target_.large_dictionary_ ?
+          map_it_ == target_.large_dictionary_->end() :
+          flat_it_ == target_.flat_dictionary_.end();
+    }
+    void Advance() {
+      if (target_.large_dictionary_)
+        ++map_it_;
+      else
+        ++flat_it_;
+    }
+
+    const std::string& key() const {
+      return target_.large_dictionary_ ? map_it_->first : flat_it_->first;
+    }
+    const Value& value() const {
+      return target_.large_dictionary_ ? *map_it_->second : *flat_it_->second;
+    }
 
    private:
     const DictionaryValue& target_;
-    ValueMap::const_iterator it_;
+    FlatValueMap::const_iterator flat_it_;
+    ValueMap::const_iterator map_it_;
   };
 
   // Overridden from Value:
@@ -367,7 +387,17 @@ class BASE_EXPORT DictionaryValue : public Value {
   virtual bool Equals(const Value* other) const OVERRIDE;
 
  private:
-  ValueMap dictionary_;
+  // Most dictionaries are small, so they keep their entries in a vector sorted
+  // by key: one allocation for all of them instead of a map node each. A
+  // dictionary that grows beyond kMaxFlatSize entries moves them to
+  // |large_dictionary_| so that adding entries stays O(log n).
+  enum { kMaxFlatSize = 32 };
+
+  // Returns where the value for |key| is stored, or NULL if there is none.
+  Value** FindValue(const std::string& key);
+
+  FlatValueMap flat_dictionary_;
+  scoped_ptr<ValueMap> large_dictionary_;
 
   DISALLOW_COPY_AND_ASSIGN(DictionaryValue);
 };
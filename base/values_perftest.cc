@@ -0,0 +1,125 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the time and memory it takes to hold a Preferences file as Values.
+// Preferences are mostly small dictionaries: one per content setting pattern,
+// per extension, per site engagement entry and so on.
+
+#include "base/values.h"
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_log.h"
+#include "base/test/perf_time_logger.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if defined(OS_LINUX)
+#include <malloc.h>
+#endif
+
+namespace base {
+
+namespace {
+
+const int kNumPatterns = 500;
+const int kNumExtensions = 50;
+const int kNumIterations = 20;
+
+// Returns the number of bytes currently allocated, or 0 if that can't be
+// measured on this platform.
+size_t GetAllocatedBytes() {
+#if defined(OS_LINUX)
+  struct mallinfo info = mallinfo();
+  return info.hblkhd + info.uordblks;
+#else
+  return 0;
+#endif
+}
+
+// Builds a dictionary shaped like a typical Preferences file.
+scoped_ptr<DictionaryValue> BuildPreferences() {
+  scoped_ptr<DictionaryValue> prefs(new DictionaryValue);
+
+  DictionaryValue* patterns = new DictionaryValue;
+  for (int i = 0; i < kNumPatterns; ++i) {
+    DictionaryValue* settings = new DictionaryValue;
+    settings->SetInteger("cookies", i % 3);
+    settings->SetInteger("images", 1);
+    settings->SetInteger("popups", 2);
+    settings->SetString("last_used", StringPrintf("1300%09d", i));
+    patterns->SetWithoutPathExpansion(
+        StringPrintf("http://www.example%d.com:80,*", i), settings);
+  }
+  prefs->Set("profile.content_settings.pattern_pairs", patterns);
+
+  DictionaryValue* extensions = new DictionaryValue;
+  for (int i = 0; i < kNumExtensions; ++i) {
+    DictionaryValue* extension = new DictionaryValue;
+    extension->SetBoolean("active_bit", false);
+    extension->SetInteger("creation_flags", 1);
+    extension->SetBoolean("from_bookmark", false);
+    extension->SetBoolean("from_webstore", true);
+    extension->SetString("install_time", StringPrintf("1300%09d", i));
+    extension->SetInteger("location", 1);
+    extension->SetString("path", StringPrintf("%032d/1.0_0", i));
+    extension->SetInteger("state", 1);
+    extension->SetBoolean("was_installed_by_default", false);
+    ListValue* permissions = new ListValue;
+    permissions->AppendString("tabs");
+    permissions->AppendString("storage");
+    extension->Set("granted_permissions.api", permissions);
+    extensions->SetWithoutPathExpansion(StringPrintf("%032d", i), extension);
+  }
+  prefs->Set("extensions.settings", extensions);
+
+  prefs->SetBoolean("browser.show_home_button", true);
+  prefs->SetString("homepage", "http://www.example.com/");
+  prefs->SetInteger("session.restore_on_startup", 1);
+  return prefs.Pass();
+}
+
+}  // namespace
+
+TEST(ValuesPerfTest, ParsePreferences) {
+  std::string json;
+  {
+    scoped_ptr<DictionaryValue> prefs(BuildPreferences());
+    ASSERT_TRUE(JSONWriter::Write(prefs.get(), &json));
+  }
+
+  size_t bytes_before = GetAllocatedBytes();
+  scoped_ptr<Value> parsed(JSONReader::Read(json));
+  ASSERT_TRUE(parsed);
+  size_t bytes_after = GetAllocatedBytes();
+  if (bytes_after > bytes_before) {
+    LogPerfResult("Values_ParsePreferences_Memory",
+                  static_cast<double>(bytes_after - bytes_before), "bytes");
+  }
+  parsed.reset();
+
+  PerfTimeLogger logger("Values_ParsePreferences");
+  for (int i = 0; i < kNumIterations; ++i) {
+    parsed.reset(JSONReader::Read(json));
+    ASSERT_TRUE(parsed);
+  }
+  logger.Done();
+}
+
+TEST(ValuesPerfTest, CopyPreferences) {
+  scoped_ptr<DictionaryValue> prefs(BuildPreferences());
+
+  PerfTimeLogger logger("Values_CopyPreferences");
+  for (int i = 0; i < kNumIterations; ++i) {
+    scoped_ptr<DictionaryValue> copy(prefs->DeepCopy());
+    ASSERT_TRUE(copy->Equals(prefs.get()));
+  }
+  logger.Done();
+}
+
+}  // namespace base
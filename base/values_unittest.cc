@@ -6,6 +6,7 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string16.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -809,4 +810,95 @@ TEST(ValuesTest, DictionaryIterator) {
   EXPECT_TRUE(seen2);
 }
 
+// Dictionaries change how they store their entries as they grow and shrink;
+// none of that should be visible.
+TEST(ValuesTest, LargeDictionary) {
+  const int kSize = 100;
+  DictionaryValue dict;
+  for (int i = kSize - 1; i >= 0; --i) {
+    dict.SetIntegerWithoutPathExpansion(StringPrintf("key%03d", i), i);
+    EXPECT_EQ(static_cast<size_t>(kSize - i), dict.size());
+  }
+
+  int expected = 0;
+  for (DictionaryValue::Iterator it(dict); !it.IsAtEnd(); it.Advance()) {
+    EXPECT_EQ(StringPrintf("key%03d", expected), it.key());
+    int value = -1;
+    EXPECT_TRUE(it.value().GetAsInteger(&value));
+    EXPECT_EQ(expected, value);
+    ++expected;
+  }
+  EXPECT_EQ(kSize, expected);
+
+  scoped_ptr<DictionaryValue> copy(dict.DeepCopy());
+  EXPECT_TRUE(copy->Equals(&dict));
+
+  // Replacing a value doesn't add an entry.
+  dict.SetIntegerWithoutPathExpansion("key050", -50);
+  EXPECT_EQ(static_cast<size_t>(kSize), dict.size());
+  EXPECT_FALSE(copy->Equals(&dict));
+
+  for (int i = 0; i < kSize; i += 2)
+    EXPECT_TRUE(dict.RemoveWithoutPathExpansion(StringPrintf("key%03d", i),
+                                                NULL));
+  EXPECT_EQ(static_cast<size_t>(kSize / 2), dict.size());
+  for (int i = 0; i < kSize; ++i) {
+    int value = -1;
+    EXPECT_EQ(i % 2 == 1,
+              dict.GetIntegerWithoutPathExpansion(StringPrintf("key%03d", i),
+                                                  &value));
+    if (i % 2 == 1)
+      EXPECT_EQ(i, value);
+  }
+
+  dict.Clear();
+  EXPECT_TRUE(dict.empty());
+  dict.SetIntegerWithoutPathExpansion("key", 1);
+  EXPECT_TRUE(dict.HasKey("key"));
+}
+
+TEST(ValuesTest, SmallDictionary) {
+  DictionaryValue dict;
+  dict.SetStringWithoutPathExpansion("c", "3");
+  dict.SetStringWithoutPathExpansion("a", "1");
+  dict.SetStringWithoutPathExpansion("b", "2");
+  dict.SetStringWithoutPathExpansion("a", "one");
+
+  const char* const kExpected[][2] = {
+    { "a", "one" }, { "b", "2" }, { "c", "3" },
+  };
+  size_t i = 0;
+  for (DictionaryValue::Iterator it(dict); !it.IsAtEnd(); it.Advance(), ++i) {
+    ASSERT_LT(i, arraysize(kExpected));
+    EXPECT_EQ(kExpected[i][0], it.key());
+    std::string value;
+    EXPECT_TRUE(it.value().GetAsString(&value));
+    EXPECT_EQ(kExpected[i][1], value);
+  }
+  EXPECT_EQ(arraysize(kExpected), i);
+
+  scoped_ptr<Value> removed;
+  EXPECT_TRUE(dict.RemoveWithoutPathExpansion("b", &removed));
+  ASSERT_TRUE(removed);
+  EXPECT_FALSE(dict.RemoveWithoutPathExpansion("b", NULL));
+  EXPECT_FALSE(dict.HasKey("b"));
+  EXPECT_TRUE(dict.HasKey("a"));
+  EXPECT_TRUE(dict.HasKey("c"));
+  EXPECT_EQ(2U, dict.size());
+}
+
+TEST(ValuesTest, SwapDictionaries) {
+  DictionaryValue small_dict;
+  small_dict.SetInteger("small", 1);
+  DictionaryValue large_dict;
+  for (int i = 0; i < 100; ++i)
+    large_dict.SetInteger(StringPrintf("large%d", i), i);
+
+  small_dict.Swap(&large_dict);
+  EXPECT_EQ(100U, small_dict.size());
+  EXPECT_TRUE(small_dict.HasKey("large99"));
+  EXPECT_EQ(1U, large_dict.size());
+  EXPECT_TRUE(large_dict.HasKey("small"));
+}
+
 }  // namespace base
@@ -17,7 +17,8 @@ AnimationEvent::AnimationEvent(AnimationEvent::Type type,
       target_property(target_property),
       monotonic_time(monotonic_time),
       is_impl_only(false),
-      opacity(0.f) {
+      opacity(0.f),
+      background_color(SK_ColorTRANSPARENT) {
 }
 
 }  // namespace cc
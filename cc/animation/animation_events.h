@@ -10,6 +10,7 @@
 #include "cc/animation/animation.h"
 #include "cc/base/cc_export.h"
 #include "cc/output/filter_operations.h"
+#include "third_party/skia/include/core/SkColor.h"
 #include "ui/gfx/transform.h"
 
 namespace cc {
@@ -32,6 +33,7 @@ struct CC_EXPORT AnimationEvent {
   float opacity;
   gfx::Transform transform;
   FilterOperations filters;
+  SkColor background_color;
 };
 
 typedef std::vector<AnimationEvent> AnimationEventsVector;
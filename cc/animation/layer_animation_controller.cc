@@ -185,7 +185,18 @@ void LayerAnimationController::AccumulatePropertyUpdates(
         break;
       }
 
-      case Animation::BackgroundColor: { break; }
+      case Animation::BackgroundColor: {
+        AnimationEvent event(AnimationEvent::PropertyUpdate,
+                             id_,
+                             animation->group(),
+                             Animation::BackgroundColor,
+                             monotonic_time);
+        event.background_color =
+            animation->curve()->ToColorAnimationCurve()->GetValue(trimmed);
+        event.is_impl_only = true;
+        events->push_back(event);
+        break;
+      }
 
       case Animation::ScrollOffset: {
         // Impl-side changes to scroll offset are already sent back to the
@@ -357,6 +368,12 @@ void LayerAnimationController::NotifyAnimationPropertyUpdate(
     case Animation::Transform:
       NotifyObserversTransformAnimated(event.transform);
       break;
+    case Animation::Filter:
+      NotifyObserversFilterAnimated(event.filters);
+      break;
+    case Animation::BackgroundColor:
+      NotifyObserversBackgroundColorAnimated(event.background_color);
+      break;
     default:
       NOTREACHED();
   }
@@ -737,7 +754,11 @@ void LayerAnimationController::TickAnimations(double monotonic_time) {
         }
 
         case Animation::BackgroundColor: {
-          // Not yet implemented.
+          const ColorAnimationCurve* color_animation_curve =
+              active_animations_[i]->curve()->ToColorAnimationCurve();
+          const SkColor background_color =
+              color_animation_curve->GetValue(trimmed);
+          NotifyObserversBackgroundColorAnimated(background_color);
           break;
         }
 
@@ -804,6 +825,13 @@ void LayerAnimationController::NotifyObserversScrollOffsetAnimated(
                     OnScrollOffsetAnimated(scroll_offset));
 }
 
+void LayerAnimationController::NotifyObserversBackgroundColorAnimated(
+    SkColor background_color) {
+  FOR_EACH_OBSERVER(LayerAnimationValueObserver,
+                    value_observers_,
+                    OnBackgroundColorAnimated(background_color));
+}
+
 void LayerAnimationController::NotifyObserversAnimationWaitingForDeletion() {
   FOR_EACH_OBSERVER(LayerAnimationValueObserver,
                     value_observers_,
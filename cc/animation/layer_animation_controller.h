@@ -157,6 +157,7 @@ class CC_EXPORT LayerAnimationController
   void NotifyObserversTransformAnimated(const gfx::Transform& transform);
   void NotifyObserversFilterAnimated(const FilterOperations& filter);
   void NotifyObserversScrollOffsetAnimated(const gfx::Vector2dF& scroll_offset);
+  void NotifyObserversBackgroundColorAnimated(SkColor background_color);
 
   void NotifyObserversAnimationWaitingForDeletion();
 
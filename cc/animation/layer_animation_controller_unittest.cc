@@ -560,6 +560,58 @@ TEST(LayerAnimationControllerTest, FilterTransitionOnImplOnly) {
   EXPECT_TRUE(end_filter_event->is_impl_only);
 }
 
+TEST(LayerAnimationControllerTest, BackgroundColorTransitionOnImplOnly) {
+  scoped_ptr<AnimationEventsVector> events(
+      make_scoped_ptr(new AnimationEventsVector));
+  FakeLayerAnimationValueObserver dummy_impl;
+  scoped_refptr<LayerAnimationController> controller_impl(
+      LayerAnimationController::Create(0));
+  controller_impl->AddValueObserver(&dummy_impl);
+
+  scoped_ptr<KeyframedColorAnimationCurve> curve(
+      KeyframedColorAnimationCurve::Create());
+  curve->AddKeyframe(
+      ColorKeyframe::Create(0, SK_ColorRED, scoped_ptr<TimingFunction>()));
+  curve->AddKeyframe(
+      ColorKeyframe::Create(1, SK_ColorBLUE, scoped_ptr<TimingFunction>()));
+
+  scoped_ptr<Animation> animation(Animation::Create(
+      curve.PassAs<AnimationCurve>(), 1, 0, Animation::BackgroundColor));
+  animation->set_is_impl_only(true);
+  controller_impl->AddAnimation(animation.Pass());
+
+  // Run animation.
+  controller_impl->Animate(kInitialTickTime);
+  controller_impl->UpdateState(true, events.get());
+  EXPECT_TRUE(controller_impl->HasActiveAnimation());
+  EXPECT_EQ(SK_ColorRED, dummy_impl.background_color());
+  EXPECT_EQ(2u, events->size());
+  const AnimationEvent* start_color_event =
+      GetMostRecentPropertyUpdateEvent(events.get());
+  EXPECT_TRUE(start_color_event);
+  EXPECT_EQ(SK_ColorRED, start_color_event->background_color);
+  EXPECT_TRUE(start_color_event->is_impl_only);
+
+  controller_impl->Animate(kInitialTickTime + 1.0);
+  controller_impl->UpdateState(true, events.get());
+  EXPECT_EQ(SK_ColorBLUE, dummy_impl.background_color());
+  EXPECT_FALSE(controller_impl->HasActiveAnimation());
+  EXPECT_EQ(4u, events->size());
+  const AnimationEvent* end_color_event =
+      GetMostRecentPropertyUpdateEvent(events.get());
+  EXPECT_TRUE(end_color_event);
+  EXPECT_EQ(SK_ColorBLUE, end_color_event->background_color);
+  EXPECT_TRUE(end_color_event->is_impl_only);
+
+  // The main thread picks up the value from the property update.
+  FakeLayerAnimationValueObserver dummy;
+  scoped_refptr<LayerAnimationController> controller(
+      LayerAnimationController::Create(0));
+  controller->AddValueObserver(&dummy);
+  controller->NotifyAnimationPropertyUpdate(*end_color_event);
+  EXPECT_EQ(SK_ColorBLUE, dummy.background_color());
+}
+
 TEST(LayerAnimationControllerTest, ScrollOffsetTransition) {
   FakeLayerAnimationValueObserver dummy_impl;
   FakeLayerAnimationValueProvider dummy_provider_impl;
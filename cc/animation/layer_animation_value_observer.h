@@ -6,6 +6,7 @@
 #define CC_ANIMATION_LAYER_ANIMATION_VALUE_OBSERVER_H_
 
 #include "cc/base/cc_export.h"
+#include "third_party/skia/include/core/SkColor.h"
 
 namespace cc {
 
@@ -17,6 +18,7 @@ class CC_EXPORT LayerAnimationValueObserver {
   virtual void OnOpacityAnimated(float opacity) = 0;
   virtual void OnTransformAnimated(const gfx::Transform& transform) = 0;
   virtual void OnScrollOffsetAnimated(const gfx::Vector2dF& scroll_offset) = 0;
+  virtual void OnBackgroundColorAnimated(SkColor background_color) = 0;
   virtual void OnAnimationWaitingForDeletion() = 0;
   virtual bool IsActive() const = 0;
 };
@@ -151,6 +151,15 @@ const char kDisable4444Textures[] = "disable-4444-textures";
 const char kDisableCompositorTouchHitTesting[] =
     "disable-compositor-touch-hit-testing";
 
+// When the main thread falls a frame behind, skip BeginMainFrames to let it
+// catch up, or draw without waiting for commits that would miss the deadline.
+const char kEnableMainThreadLatencyRecovery[] =
+    "enable-main-thread-latency-recovery";
+
+// Milliseconds per frame that may be spent rasterizing missing tiles at low
+// resolution while drawing, instead of checkerboarding them.
+const char kRasterOnDemandBudgetMs[] = "raster-on-demand-budget-ms";
+
 bool IsLCDTextEnabled() {
   const CommandLine* command_line = CommandLine::ForCurrentProcess();
   if (command_line->HasSwitch(switches::kDisableLCDText))
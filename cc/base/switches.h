@@ -41,6 +41,8 @@ CC_EXPORT extern const char kEnableMapImage[];
 CC_EXPORT extern const char kDisableMapImage[];
 CC_EXPORT extern const char kDisable4444Textures[];
 CC_EXPORT extern const char kDisableCompositorTouchHitTesting[];
+CC_EXPORT extern const char kEnableMainThreadLatencyRecovery[];
+CC_EXPORT extern const char kRasterOnDemandBudgetMs[];
 
 // Switches for both the renderer and ui compositors.
 CC_EXPORT extern const char kUIDisablePartialSwap[];
@@ -0,0 +1,39 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/debug/frame_timing_benchmark.h"
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/values.h"
+#include "cc/debug/frame_timing_benchmark_impl.h"
+
+namespace cc {
+
+FrameTimingBenchmark::FrameTimingBenchmark(
+    scoped_ptr<base::Value> value,
+    const MicroBenchmark::DoneCallback& callback)
+    : MicroBenchmark(callback),
+      settings_(value.Pass()),
+      weak_ptr_factory_(this) {}
+
+FrameTimingBenchmark::~FrameTimingBenchmark() {
+  weak_ptr_factory_.InvalidateWeakPtrs();
+}
+
+scoped_ptr<MicroBenchmarkImpl> FrameTimingBenchmark::CreateBenchmarkImpl(
+    scoped_refptr<base::MessageLoopProxy> origin_loop) {
+  return scoped_ptr<MicroBenchmarkImpl>(new FrameTimingBenchmarkImpl(
+      origin_loop,
+      settings_.get(),
+      base::Bind(&FrameTimingBenchmark::RecordImplResults,
+                 weak_ptr_factory_.GetWeakPtr())));
+}
+
+void FrameTimingBenchmark::RecordImplResults(
+    scoped_ptr<base::Value> results) {
+  NotifyDone(results.Pass());
+}
+
+}  // namespace cc
@@ -0,0 +1,36 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_DEBUG_FRAME_TIMING_BENCHMARK_H_
+#define CC_DEBUG_FRAME_TIMING_BENCHMARK_H_
+
+#include "base/memory/weak_ptr.h"
+#include "cc/debug/micro_benchmark.h"
+
+namespace cc {
+
+// Times the impl-side phases of the frames drawn after the next commit; see
+// FrameTimingBenchmarkImpl. The main thread only forwards the results.
+class CC_EXPORT FrameTimingBenchmark : public MicroBenchmark {
+ public:
+  FrameTimingBenchmark(scoped_ptr<base::Value> value,
+                       const MicroBenchmark::DoneCallback& callback);
+  virtual ~FrameTimingBenchmark();
+
+ protected:
+  virtual scoped_ptr<MicroBenchmarkImpl> CreateBenchmarkImpl(
+      scoped_refptr<base::MessageLoopProxy> origin_loop) OVERRIDE;
+
+ private:
+  void RecordImplResults(scoped_ptr<base::Value> results);
+
+  scoped_ptr<base::Value> settings_;
+  base::WeakPtrFactory<FrameTimingBenchmark> weak_ptr_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameTimingBenchmark);
+};
+
+}  // namespace cc
+
+#endif  // CC_DEBUG_FRAME_TIMING_BENCHMARK_H_
@@ -0,0 +1,113 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/debug/frame_timing_benchmark_impl.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/basictypes.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/values.h"
+
+namespace cc {
+
+namespace {
+
+const int kDefaultFrameCount = 100;
+
+const char* const kFramePhaseNames[] = {
+  "update_draw_properties_ms",
+  "calculate_render_passes_ms",
+  "prepare_to_draw_ms",
+  "manage_tiles_ms",
+  "draw_frame_ms",
+};
+COMPILE_ASSERT(arraysize(kFramePhaseNames) ==
+                   MicroBenchmarkImpl::NUM_FRAME_PHASES,
+               frame_phase_names_match_phases);
+
+// The nearest-rank |percentile| of the sorted |samples|.
+double Percentile(const std::vector<double>& samples, double percentile) {
+  DCHECK(!samples.empty());
+  int rank = static_cast<int>(std::ceil(percentile / 100.0 * samples.size()));
+  rank = std::max(1, std::min(rank, static_cast<int>(samples.size())));
+  return samples[rank - 1];
+}
+
+scoped_ptr<base::Value> SamplesAsValue(
+    const std::vector<double>& unsorted_samples) {
+  std::vector<double> samples(unsorted_samples);
+  std::sort(samples.begin(), samples.end());
+  scoped_ptr<base::DictionaryValue> value(new base::DictionaryValue);
+  value->SetInteger("count", static_cast<int>(samples.size()));
+  value->SetDouble("p50", Percentile(samples, 50.0));
+  value->SetDouble("p90", Percentile(samples, 90.0));
+  value->SetDouble("p99", Percentile(samples, 99.0));
+  value->SetDouble("max", samples.back());
+  return value.PassAs<base::Value>();
+}
+
+}  // namespace
+
+FrameTimingBenchmarkImpl::FrameTimingBenchmarkImpl(
+    scoped_refptr<base::MessageLoopProxy> origin_loop,
+    base::Value* settings,
+    const MicroBenchmarkImpl::DoneCallback& callback)
+    : MicroBenchmarkImpl(callback, origin_loop),
+      frame_count_(kDefaultFrameCount),
+      frames_drawn_(0),
+      last_draw_frame_ms_(0.0) {
+  base::DictionaryValue* settings_dictionary = NULL;
+  if (settings)
+    settings->GetAsDictionary(&settings_dictionary);
+  if (!settings_dictionary)
+    return;
+
+  if (settings_dictionary->HasKey("frame_count"))
+    settings_dictionary->GetInteger("frame_count", &frame_count_);
+  frame_count_ = std::max(frame_count_, 1);
+}
+
+FrameTimingBenchmarkImpl::~FrameTimingBenchmarkImpl() {}
+
+void FrameTimingBenchmarkImpl::DidRunFramePhase(FramePhase phase,
+                                                base::TimeDelta duration) {
+  DCHECK_LT(phase, NUM_FRAME_PHASES);
+  double duration_ms = duration.InMillisecondsF();
+  phase_samples_ms_[phase].push_back(duration_ms);
+  if (phase == DRAW_FRAME_PHASE)
+    last_draw_frame_ms_ = duration_ms;
+}
+
+void FrameTimingBenchmarkImpl::DidDrawFrame(size_t render_pass_count) {
+  if (render_pass_count) {
+    draw_frame_per_render_pass_samples_ms_.push_back(last_draw_frame_ms_ /
+                                                     render_pass_count);
+  }
+  last_draw_frame_ms_ = 0.0;
+
+  if (++frames_drawn_ < frame_count_)
+    return;
+  NotifyDone(ResultsAsValue());
+}
+
+scoped_ptr<base::Value> FrameTimingBenchmarkImpl::ResultsAsValue() const {
+  scoped_ptr<base::DictionaryValue> results(new base::DictionaryValue);
+  results->SetInteger("frame_count", frames_drawn_);
+  for (int phase = 0; phase < NUM_FRAME_PHASES; ++phase) {
+    if (phase_samples_ms_[phase].empty())
+      continue;
+    results->Set(kFramePhaseNames[phase],
+                 SamplesAsValue(phase_samples_ms_[phase]).release());
+  }
+  if (!draw_frame_per_render_pass_samples_ms_.empty()) {
+    results->Set(
+        "draw_frame_per_render_pass_ms",
+        SamplesAsValue(draw_frame_per_render_pass_samples_ms_).release());
+  }
+  return results.PassAs<base::Value>();
+}
+
+}  // namespace cc
@@ -0,0 +1,48 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_DEBUG_FRAME_TIMING_BENCHMARK_IMPL_H_
+#define CC_DEBUG_FRAME_TIMING_BENCHMARK_IMPL_H_
+
+#include <vector>
+
+#include "base/time/time.h"
+#include "cc/debug/micro_benchmark_impl.h"
+
+namespace cc {
+
+// Collects the durations of the impl-side frame phases over the next
+// "frame_count" drawn frames, then reports the 50th, 90th and 99th
+// percentile and the maximum of each phase, in milliseconds. The renderer's
+// draw time is also reported divided by the number of render passes drawn.
+class CC_EXPORT FrameTimingBenchmarkImpl : public MicroBenchmarkImpl {
+ public:
+  FrameTimingBenchmarkImpl(scoped_refptr<base::MessageLoopProxy> origin_loop,
+                           base::Value* settings,
+                           const MicroBenchmarkImpl::DoneCallback& callback);
+  virtual ~FrameTimingBenchmarkImpl();
+
+  // Implements MicroBenchmarkImpl interface.
+  virtual void DidRunFramePhase(FramePhase phase,
+                                base::TimeDelta duration) OVERRIDE;
+  virtual void DidDrawFrame(size_t render_pass_count) OVERRIDE;
+
+ private:
+  typedef std::vector<double> Samples;
+
+  scoped_ptr<base::Value> ResultsAsValue() const;
+
+  int frame_count_;
+  int frames_drawn_;
+  Samples phase_samples_ms_[NUM_FRAME_PHASES];
+  Samples draw_frame_per_render_pass_samples_ms_;
+  // The duration of the DRAW_FRAME_PHASE of the frame being drawn.
+  double last_draw_frame_ms_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameTimingBenchmarkImpl);
+};
+
+}  // namespace cc
+
+#endif  // CC_DEBUG_FRAME_TIMING_BENCHMARK_IMPL_H_
@@ -50,6 +50,28 @@ void MicroBenchmarkControllerImpl::DidCompleteCommit() {
   CleanUpFinishedBenchmarks();
 }
 
+void MicroBenchmarkControllerImpl::DidRunFramePhase(
+    MicroBenchmarkImpl::FramePhase phase,
+    base::TimeDelta duration) {
+  for (ScopedPtrVector<MicroBenchmarkImpl>::iterator it = benchmarks_.begin();
+       it != benchmarks_.end();
+       ++it) {
+    DCHECK(!(*it)->IsDone());
+    (*it)->DidRunFramePhase(phase, duration);
+  }
+}
+
+void MicroBenchmarkControllerImpl::DidDrawFrame(size_t render_pass_count) {
+  for (ScopedPtrVector<MicroBenchmarkImpl>::iterator it = benchmarks_.begin();
+       it != benchmarks_.end();
+       ++it) {
+    DCHECK(!(*it)->IsDone());
+    (*it)->DidDrawFrame(render_pass_count);
+  }
+
+  CleanUpFinishedBenchmarks();
+}
+
 void MicroBenchmarkControllerImpl::CleanUpFinishedBenchmarks() {
   benchmarks_.erase(
       benchmarks_.partition(std::not1(IsDonePredicate())),
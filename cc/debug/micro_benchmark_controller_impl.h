@@ -20,6 +20,12 @@ class CC_EXPORT MicroBenchmarkControllerImpl {
   ~MicroBenchmarkControllerImpl();
 
   void DidCompleteCommit();
+  void DidRunFramePhase(MicroBenchmarkImpl::FramePhase phase,
+                        base::TimeDelta duration);
+  void DidDrawFrame(size_t render_pass_count);
+
+  // Frame phases are only worth timing while there are benchmarks to tell.
+  bool HasBenchmarks() const { return !benchmarks_.empty(); }
 
   void ScheduleRun(scoped_ptr<MicroBenchmarkImpl> benchmark);
 
@@ -4,8 +4,12 @@
 
 #include "base/callback.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/values.h"
+#include "cc/debug/frame_timing_benchmark.h"
 #include "cc/debug/micro_benchmark.h"
 #include "cc/debug/micro_benchmark_controller.h"
+#include "cc/debug/micro_benchmark_controller_impl.h"
 #include "cc/layers/layer.h"
 #include "cc/resources/resource_update_queue.h"
 #include "cc/test/fake_layer_tree_host.h"
@@ -46,6 +50,11 @@ void IncrementCallCount(int* count, scoped_ptr<base::Value> value) {
   ++(*count);
 }
 
+void SaveResults(scoped_ptr<base::Value>* results,
+                 scoped_ptr<base::Value> value) {
+  *results = value.Pass();
+}
+
 TEST_F(MicroBenchmarkControllerTest, ScheduleFail) {
   bool result = layer_tree_host_->ScheduleMicroBenchmark(
       "non_existant_benchmark", scoped_ptr<base::Value>(), base::Bind(&Noop));
@@ -137,5 +146,49 @@ TEST_F(MicroBenchmarkControllerTest, BenchmarkImplRan) {
   EXPECT_EQ(1, run_count);
 }
 
+TEST_F(MicroBenchmarkControllerTest, FrameTimingBenchmarkImpl) {
+  scoped_ptr<base::Value> results;
+  scoped_ptr<base::DictionaryValue> settings(new base::DictionaryValue);
+  settings->SetInteger("frame_count", 2);
+  FrameTimingBenchmark benchmark(
+      settings.PassAs<base::Value>(),
+      base::Bind(&SaveResults, base::Unretained(&results)));
+
+  MicroBenchmarkControllerImpl controller(layer_tree_host_impl_.get());
+  EXPECT_FALSE(controller.HasBenchmarks());
+  controller.ScheduleRun(
+      benchmark.GetBenchmarkImpl(base::MessageLoopProxy::current()));
+  EXPECT_TRUE(controller.HasBenchmarks());
+
+  controller.DidRunFramePhase(MicroBenchmarkImpl::DRAW_FRAME_PHASE,
+                              base::TimeDelta::FromMilliseconds(4));
+  controller.DidDrawFrame(2);
+  EXPECT_TRUE(controller.HasBenchmarks());
+  controller.DidRunFramePhase(MicroBenchmarkImpl::DRAW_FRAME_PHASE,
+                              base::TimeDelta::FromMilliseconds(8));
+  controller.DidDrawFrame(2);
+  EXPECT_FALSE(controller.HasBenchmarks());
+
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_TRUE(benchmark.IsDone());
+  ASSERT_TRUE(results);
+
+  base::DictionaryValue* results_dictionary = NULL;
+  ASSERT_TRUE(results->GetAsDictionary(&results_dictionary));
+  int frame_count = 0;
+  EXPECT_TRUE(results_dictionary->GetInteger("frame_count", &frame_count));
+  EXPECT_EQ(2, frame_count);
+  double value = 0.0;
+  EXPECT_TRUE(results_dictionary->GetDouble("draw_frame_ms.p50", &value));
+  EXPECT_EQ(4.0, value);
+  EXPECT_TRUE(results_dictionary->GetDouble("draw_frame_ms.max", &value));
+  EXPECT_EQ(8.0, value);
+  EXPECT_TRUE(results_dictionary->GetDouble(
+      "draw_frame_per_render_pass_ms.max", &value));
+  EXPECT_EQ(4.0, value);
+  // Phases that didn't run are left out.
+  EXPECT_FALSE(results_dictionary->HasKey("manage_tiles_ms"));
+}
+
 }  // namespace
 }  // namespace cc
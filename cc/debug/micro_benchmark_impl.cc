@@ -34,6 +34,11 @@ bool MicroBenchmarkImpl::IsDone() const {
 
 void MicroBenchmarkImpl::DidCompleteCommit(LayerTreeHostImpl* host) {}
 
+void MicroBenchmarkImpl::DidRunFramePhase(FramePhase phase,
+                                          base::TimeDelta duration) {}
+
+void MicroBenchmarkImpl::DidDrawFrame(size_t render_pass_count) {}
+
 void MicroBenchmarkImpl::NotifyDone(scoped_ptr<base::Value> result) {
   origin_loop_->PostTask(
     FROM_HERE,
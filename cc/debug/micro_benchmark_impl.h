@@ -7,6 +7,7 @@
 
 #include "base/callback.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
 #include "cc/base/cc_export.h"
 
 namespace base {
@@ -23,6 +24,16 @@ class CC_EXPORT MicroBenchmarkImpl {
  public:
   typedef base::Callback<void(scoped_ptr<base::Value>)> DoneCallback;
 
+  // The parts of an impl frame that benchmarks are told the durations of.
+  enum FramePhase {
+    UPDATE_DRAW_PROPERTIES_PHASE,
+    CALCULATE_RENDER_PASSES_PHASE,
+    PREPARE_TO_DRAW_PHASE,
+    MANAGE_TILES_PHASE,
+    DRAW_FRAME_PHASE,
+    NUM_FRAME_PHASES
+  };
+
   explicit MicroBenchmarkImpl(
       const DoneCallback& callback,
       scoped_refptr<base::MessageLoopProxy> origin_loop);
@@ -30,6 +41,9 @@ class CC_EXPORT MicroBenchmarkImpl {
 
   bool IsDone() const;
   virtual void DidCompleteCommit(LayerTreeHostImpl* host);
+  virtual void DidRunFramePhase(FramePhase phase, base::TimeDelta duration);
+  // Called once the renderer has drawn |render_pass_count| render passes.
+  virtual void DidDrawFrame(size_t render_pass_count);
 
   virtual void RunOnLayer(LayerImpl* layer);
   virtual void RunOnLayer(PictureLayerImpl* layer);
@@ -33,7 +33,13 @@ void MainThreadRenderingStats::Add(const MainThreadRenderingStats& other) {
 
 ImplThreadRenderingStats::ImplThreadRenderingStats()
     : frame_count(0),
-      rasterized_pixel_count(0) {}
+      rasterized_pixel_count(0),
+      draw_call_count(0),
+      drawn_quad_count(0),
+      checkerboarded_frame_count(0),
+      checkerboarded_tile_count(0),
+      raster_on_demand_pixel_count(0),
+      impl_animated_frame_count(0) {}
 
 scoped_refptr<base::debug::ConvertableToTraceFormat>
 ImplThreadRenderingStats::AsTraceableData() const {
@@ -41,6 +47,18 @@ ImplThreadRenderingStats::AsTraceableData() const {
   record_data->SetInteger("frame_count", frame_count);
   record_data->SetDouble("rasterize_time", rasterize_time.InSecondsF());
   record_data->SetInteger("rasterized_pixel_count", rasterized_pixel_count);
+  record_data->SetInteger("draw_call_count", draw_call_count);
+  record_data->SetInteger("drawn_quad_count", drawn_quad_count);
+  record_data->SetInteger("checkerboarded_frame_count",
+                          checkerboarded_frame_count);
+  record_data->SetInteger("checkerboarded_tile_count",
+                          checkerboarded_tile_count);
+  record_data->SetDouble("raster_on_demand_time",
+                         raster_on_demand_time.InSecondsF());
+  record_data->SetInteger("raster_on_demand_pixel_count",
+                          raster_on_demand_pixel_count);
+  record_data->SetInteger("impl_animated_frame_count",
+                          impl_animated_frame_count);
   return TracedValue::FromValue(record_data.release());
 }
 
@@ -49,6 +67,13 @@ void ImplThreadRenderingStats::Add(const ImplThreadRenderingStats& other) {
   rasterize_time += other.rasterize_time;
   analysis_time += other.analysis_time;
   rasterized_pixel_count += other.rasterized_pixel_count;
+  draw_call_count += other.draw_call_count;
+  drawn_quad_count += other.drawn_quad_count;
+  checkerboarded_frame_count += other.checkerboarded_frame_count;
+  checkerboarded_tile_count += other.checkerboarded_tile_count;
+  raster_on_demand_time += other.raster_on_demand_time;
+  raster_on_demand_pixel_count += other.raster_on_demand_pixel_count;
+  impl_animated_frame_count += other.impl_animated_frame_count;
 }
 
 void RenderingStats::Add(const RenderingStats& other) {
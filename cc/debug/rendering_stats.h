@@ -35,6 +35,15 @@ struct CC_EXPORT ImplThreadRenderingStats {
   base::TimeDelta rasterize_time;
   base::TimeDelta analysis_time;
   int64 rasterized_pixel_count;
+  int64 draw_call_count;
+  int64 drawn_quad_count;
+  int64 checkerboarded_frame_count;
+  int64 checkerboarded_tile_count;
+  base::TimeDelta raster_on_demand_time;
+  int64 raster_on_demand_pixel_count;
+  // Frames in which animations were ticked on the impl thread. Each of these
+  // would have needed a main thread commit if the animations ran there.
+  int64 impl_animated_frame_count;
 
   ImplThreadRenderingStats();
   scoped_refptr<base::debug::ConvertableToTraceFormat> AsTraceableData() const;
@@ -108,4 +108,40 @@ void RenderingStatsInstrumentation::AddAnalysis(base::TimeDelta duration,
   impl_stats_.analysis_time += duration;
 }
 
+void RenderingStatsInstrumentation::AddDraw(int64 draw_calls, int64 quads) {
+  if (!record_rendering_stats_)
+    return;
+
+  base::AutoLock scoped_lock(lock_);
+  impl_stats_.draw_call_count += draw_calls;
+  impl_stats_.drawn_quad_count += quads;
+}
+
+void RenderingStatsInstrumentation::AddCheckerboard(int64 missing_tiles) {
+  if (!record_rendering_stats_ || !missing_tiles)
+    return;
+
+  base::AutoLock scoped_lock(lock_);
+  impl_stats_.checkerboarded_frame_count++;
+  impl_stats_.checkerboarded_tile_count += missing_tiles;
+}
+
+void RenderingStatsInstrumentation::AddRasterOnDemand(base::TimeDelta duration,
+                                                      int64 pixels) {
+  if (!record_rendering_stats_ || !pixels)
+    return;
+
+  base::AutoLock scoped_lock(lock_);
+  impl_stats_.raster_on_demand_time += duration;
+  impl_stats_.raster_on_demand_pixel_count += pixels;
+}
+
+void RenderingStatsInstrumentation::AddImplAnimatedFrame() {
+  if (!record_rendering_stats_)
+    return;
+
+  base::AutoLock scoped_lock(lock_);
+  impl_stats_.impl_animated_frame_count++;
+}
+
 }  // namespace cc
@@ -53,6 +53,11 @@ class CC_EXPORT RenderingStatsInstrumentation {
   void AddRecord(base::TimeDelta duration, int64 pixels);
   void AddRaster(base::TimeDelta duration, int64 pixels);
   void AddAnalysis(base::TimeDelta duration, int64 pixels);
+  void AddDraw(int64 draw_calls, int64 quads);
+  // Counts a drawn frame that had |missing_tiles| tiles checkerboarded.
+  void AddCheckerboard(int64 missing_tiles);
+  void AddRasterOnDemand(base::TimeDelta duration, int64 pixels);
+  void AddImplAnimatedFrame();
 
  protected:
   RenderingStatsInstrumentation();
@@ -403,6 +403,11 @@ void Layer::SetBackgroundColor(SkColor background_color) {
   SetNeedsCommit();
 }
 
+bool Layer::BackgroundColorIsAnimating() const {
+  return layer_animation_controller_->IsAnimatingProperty(
+      Animation::BackgroundColor);
+}
+
 SkColor Layer::SafeOpaqueBackgroundColor() const {
   SkColor color = background_color();
   if (SkColorGetA(color) == 255 && !contents_opaque()) {
@@ -909,7 +914,11 @@ void Layer::PushPropertiesTo(LayerImpl* layer) {
 
   layer->SetAnchorPoint(anchor_point_);
   layer->SetAnchorPointZ(anchor_point_z_);
-  layer->SetBackgroundColor(background_color_);
+  if (!layer->BackgroundColorIsAnimatingOnImplOnly() &&
+      !BackgroundColorIsAnimating())
+    layer->SetBackgroundColor(background_color_);
+  DCHECK(!(BackgroundColorIsAnimating() &&
+           layer->BackgroundColorIsAnimatingOnImplOnly()));
   layer->SetBounds(use_paint_properties ? paint_properties_.bounds
                                         : bounds_);
   layer->SetContentBounds(content_bounds());
@@ -1114,6 +1123,10 @@ void Layer::OnScrollOffsetAnimated(const gfx::Vector2dF& scroll_offset) {
   // compositor-driven scrolling.
 }
 
+void Layer::OnBackgroundColorAnimated(SkColor background_color) {
+  background_color_ = background_color;
+}
+
 void Layer::OnAnimationWaitingForDeletion() {
   // Animations are only deleted during PushProperties.
   SetNeedsPushProperties();
@@ -110,6 +110,7 @@ class CC_EXPORT Layer : public base::RefCounted<Layer>,
 
   virtual void SetBackgroundColor(SkColor background_color);
   SkColor background_color() const { return background_color_; }
+  bool BackgroundColorIsAnimating() const;
   // If contents_opaque(), return an opaque color else return a
   // non-opaque color.  Tries to return background_color(), if possible.
   SkColor SafeOpaqueBackgroundColor() const;
@@ -544,6 +545,7 @@ class CC_EXPORT Layer : public base::RefCounted<Layer>,
   virtual void OnTransformAnimated(const gfx::Transform& transform) OVERRIDE;
   virtual void OnScrollOffsetAnimated(
       const gfx::Vector2dF& scroll_offset) OVERRIDE;
+  virtual void OnBackgroundColorAnimated(SkColor background_color) OVERRIDE;
   virtual void OnAnimationWaitingForDeletion() OVERRIDE;
   virtual bool IsActive() const OVERRIDE;
 
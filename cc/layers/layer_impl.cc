@@ -752,6 +752,10 @@ void LayerImpl::OnScrollOffsetAnimated(const gfx::Vector2dF& scroll_offset) {
   layer_tree_impl_->DidAnimateScrollOffset();
 }
 
+void LayerImpl::OnBackgroundColorAnimated(SkColor background_color) {
+  SetBackgroundColor(background_color);
+}
+
 void LayerImpl::OnAnimationWaitingForDeletion() {}
 
 bool LayerImpl::IsActive() const {
@@ -859,6 +863,18 @@ void LayerImpl::SetBackgroundColor(SkColor background_color) {
   NoteLayerPropertyChanged();
 }
 
+bool LayerImpl::BackgroundColorIsAnimating() const {
+  return layer_animation_controller_->IsAnimatingProperty(
+      Animation::BackgroundColor);
+}
+
+bool LayerImpl::BackgroundColorIsAnimatingOnImplOnly() const {
+  Animation* background_color_animation =
+      layer_animation_controller_->GetAnimation(Animation::BackgroundColor);
+  return background_color_animation &&
+         background_color_animation->is_impl_only();
+}
+
 SkColor LayerImpl::SafeOpaqueBackgroundColor() const {
   SkColor color = background_color();
   if (SkColorGetA(color) == 255 && !contents_opaque()) {
@@ -26,6 +26,7 @@
 #include "cc/quads/render_pass.h"
 #include "cc/quads/shared_quad_state.h"
 #include "cc/resources/resource_provider.h"
+#include "cc/trees/occlusion_tracker.h"
 #include "skia/ext/refptr.h"
 #include "third_party/skia/include/core/SkColor.h"
 #include "third_party/skia/include/core/SkImageFilter.h"
@@ -87,6 +88,7 @@ class CC_EXPORT LayerImpl : public LayerAnimationValueObserver,
   virtual void OnTransformAnimated(const gfx::Transform& transform) OVERRIDE;
   virtual void OnScrollOffsetAnimated(
       const gfx::Vector2dF& scroll_offset) OVERRIDE;
+  virtual void OnBackgroundColorAnimated(SkColor background_color) OVERRIDE;
   virtual void OnAnimationWaitingForDeletion() OVERRIDE;
   virtual bool IsActive() const OVERRIDE;
 
@@ -179,7 +181,9 @@ class CC_EXPORT LayerImpl : public LayerAnimationValueObserver,
   virtual RenderPass::Id FirstContributingRenderPassId() const;
   virtual RenderPass::Id NextContributingRenderPassId(RenderPass::Id id) const;
 
-  virtual void UpdateTilePriorities() {}
+  // |occlusion_tracker| has entered this layer, and may be null.
+  virtual void UpdateTilePriorities(
+      const OcclusionTrackerImpl* occlusion_tracker) {}
 
   virtual ScrollbarLayerImplBase* ToScrollbarLayer();
 
@@ -201,6 +205,8 @@ class CC_EXPORT LayerImpl : public LayerAnimationValueObserver,
 
   void SetBackgroundColor(SkColor background_color);
   SkColor background_color() const { return background_color_; }
+  bool BackgroundColorIsAnimating() const;
+  bool BackgroundColorIsAnimatingOnImplOnly() const;
   // If contents_opaque(), return an opaque color else return a
   // non-opaque color.  Tries to return background_color(), if possible.
   SkColor SafeOpaqueBackgroundColor() const;
@@ -54,9 +54,14 @@ PictureLayerImpl::PictureLayerImpl(LayerTreeImpl* tree_impl, int id)
       is_using_lcd_text_(tree_impl->settings().can_use_lcd_text),
       needs_post_commit_initialization_(true),
       should_update_tile_priorities_(false),
-      should_use_gpu_rasterization_(tree_impl->settings().gpu_rasterization) {}
+      should_use_gpu_rasterization_(tree_impl->settings().gpu_rasterization),
+      occlusion_tracker_(NULL) {
+  layer_tree_impl()->RegisterPictureLayerImpl(this);
+}
 
-PictureLayerImpl::~PictureLayerImpl() {}
+PictureLayerImpl::~PictureLayerImpl() {
+  layer_tree_impl()->UnregisterPictureLayerImpl(this);
+}
 
 const char* PictureLayerImpl::LayerTypeAsString() const {
   return "cc::PictureLayerImpl";
@@ -214,6 +219,15 @@ void PictureLayerImpl::AppendQuads(QuadSink* quad_sink,
        ++iter) {
     gfx::Rect geometry_rect = iter.geometry_rect();
     if (!*iter || !iter->IsReadyToDraw()) {
+      // A missing tile that has a recording can be drawn blurry from it.
+      if (*iter && AppendRasterOnDemandQuad(quad_sink,
+                                            shared_quad_state,
+                                            geometry_rect,
+                                            append_quads_data)) {
+        append_quads_data->had_incomplete_tile = true;
+        continue;
+      }
+
       if (DrawCheckerboardForMissingTiles()) {
         // TODO(enne): Figure out how to show debug "invalidated checker" color
         scoped_ptr<CheckerboardDrawQuad> quad = CheckerboardDrawQuad::Create();
@@ -251,7 +265,7 @@ void PictureLayerImpl::AppendQuads(QuadSink* quad_sink,
                      opaque_rect,
                      tile_version.get_resource_id(),
                      texture_rect,
-                     iter.texture_size(),
+                     tile_version.get_resource_size(),
                      tile_version.contents_swizzled());
         draw_quad = quad.PassAs<DrawQuad>();
         break;
@@ -303,7 +317,43 @@ void PictureLayerImpl::AppendQuads(QuadSink* quad_sink,
   CleanUpTilingsOnActiveLayer(seen_tilings);
 }
 
-void PictureLayerImpl::UpdateTilePriorities() {
+bool PictureLayerImpl::AppendRasterOnDemandQuad(
+    QuadSink* quad_sink,
+    SharedQuadState* shared_quad_state,
+    const gfx::Rect& geometry_rect,
+    AppendQuadsData* append_quads_data) {
+  float scale_factor =
+      layer_tree_impl()->settings().low_res_contents_scale_factor;
+  gfx::Rect raster_rect = gfx::ScaleToEnclosingRect(geometry_rect,
+                                                    scale_factor);
+  int64 raster_pixels =
+      static_cast<int64>(raster_rect.width()) * raster_rect.height();
+  if (!raster_pixels ||
+      raster_pixels > layer_tree_impl()->raster_on_demand_pixel_budget())
+    return false;
+
+  gfx::RectF texture_rect = gfx::ScaleRect(geometry_rect, scale_factor) -
+                            raster_rect.OffsetFromOrigin();
+  ResourceFormat format =
+      layer_tree_impl()->resource_provider()->memory_efficient_texture_format();
+  scoped_ptr<PictureDrawQuad> quad = PictureDrawQuad::Create();
+  quad->SetNew(shared_quad_state,
+               geometry_rect,
+               gfx::Rect(),
+               texture_rect,
+               raster_rect.size(),
+               format,
+               raster_rect,
+               contents_scale_x() * scale_factor,
+               pile_);
+  // Only quads that aren't occluded get rasterized.
+  if (quad_sink->Append(quad.PassAs<DrawQuad>(), append_quads_data))
+    layer_tree_impl()->ConsumeRasterOnDemandBudget(raster_pixels);
+  return true;
+}
+
+void PictureLayerImpl::UpdateTilePriorities(
+    const OcclusionTrackerImpl* occlusion_tracker) {
   DCHECK(!needs_post_commit_initialization_);
   CHECK(should_update_tile_priorities_);
 
@@ -350,10 +400,28 @@ void PictureLayerImpl::UpdateTilePriorities() {
   WhichTree tree =
       layer_tree_impl()->IsActiveTree() ? ACTIVE_TREE : PENDING_TREE;
 
+  predicted_scroll_delta_in_layer_space_ = gfx::Vector2dF();
+  gfx::Vector2dF predicted_scroll_delta =
+      layer_tree_impl()->PredictedScrollDeltaInScreenSpace(this);
+  if (!predicted_scroll_delta.IsZero()) {
+    gfx::Vector2dF layer_to_screen_scale =
+        MathUtil::ComputeTransform2dScaleComponents(screen_space_transform(),
+                                                    0.f);
+    layer_to_screen_scale.Scale(contents_scale_x(), contents_scale_y());
+    if (layer_to_screen_scale.x() && layer_to_screen_scale.y()) {
+      predicted_scroll_delta_in_layer_space_ =
+          gfx::ScaleVector2d(predicted_scroll_delta,
+                             1.f / layer_to_screen_scale.x(),
+                             1.f / layer_to_screen_scale.y());
+    }
+  }
+
+  occlusion_tracker_ = occlusion_tracker;
   tilings_->UpdateTilePriorities(tree,
                                  visible_rect_in_content_space,
                                  contents_scale_x(),
                                  current_frame_time_in_seconds);
+  occlusion_tracker_ = NULL;
 
   if (layer_tree_impl()->IsPendingTree())
     MarkVisibleResourcesAsRequired();
@@ -469,6 +537,8 @@ scoped_refptr<Tile> PictureLayerImpl::CreateTile(PictureLayerTiling* tiling,
     flags |= Tile::USE_LCD_TEXT;
   if (should_use_gpu_rasterization())
     flags |= Tile::USE_GPU_RASTERIZATION;
+  if (is_mask_)
+    flags |= Tile::REQUIRES_EXACT_SIZE_RESOURCE;
   return layer_tree_impl()->tile_manager()->CreateTile(
       pile_.get(),
       content_rect.size(),
@@ -515,6 +585,22 @@ int PictureLayerImpl::GetSkewportExtrapolationLimitInContentPixels() const {
       .skewport_extrapolation_limit_in_content_pixels;
 }
 
+gfx::Vector2dF PictureLayerImpl::GetPredictedScrollDeltaInLayerSpace() const {
+  return predicted_scroll_delta_in_layer_space_;
+}
+
+bool PictureLayerImpl::IsContentRectOccluded(const gfx::Rect& content_rect,
+                                             float contents_scale) const {
+  if (!occlusion_tracker_)
+    return false;
+  gfx::Rect layer_content_rect =
+      gfx::ScaleToEnclosingRect(content_rect,
+                                contents_scale_x() / contents_scale,
+                                contents_scale_y() / contents_scale);
+  return occlusion_tracker_->Occluded(
+      render_target(), layer_content_rect, draw_transform(), false);
+}
+
 gfx::Size PictureLayerImpl::CalculateTileSize(
     const gfx::Size& content_bounds) const {
   if (is_mask_) {
@@ -623,6 +709,14 @@ void PictureLayerImpl::SyncFromActiveLayer(const PictureLayerImpl* other) {
   SanityCheckTilingState();
 }
 
+void PictureLayerImpl::GetTilings(
+    std::vector<PictureLayerTiling*>* tilings) const {
+  if (!tilings_)
+    return;
+  for (size_t i = 0; i < tilings_->num_tilings(); ++i)
+    tilings->push_back(tilings_->tiling_at(i));
+}
+
 void PictureLayerImpl::SyncTiling(
     const PictureLayerTiling* tiling) {
   if (!CanHaveTilingWithScale(tiling->contents_scale()))
@@ -635,7 +729,7 @@ void PictureLayerImpl::SyncTiling(
   // we can create tiles for this tiling immediately.
   if (!layer_tree_impl()->needs_update_draw_properties() &&
       should_update_tile_priorities_)
-    UpdateTilePriorities();
+    UpdateTilePriorities(NULL);
 }
 
 void PictureLayerImpl::SetIsMask(bool is_mask) {
@@ -794,6 +888,10 @@ bool PictureLayerImpl::MarkVisibleTilesAsRequired(
     if (!missing_region.Intersects(iter.geometry_rect()))
       continue;
 
+    // An occluded tile won't be seen after activation either.
+    if (tile->is_occluded(PENDING_TREE))
+      continue;
+
     // If the twin tile doesn't exist (i.e. missing recording or so far away
     // that it is outside the visible tile rect) or this tile is shared between
     // with the twin, then this tile isn't required to prevent flashing.
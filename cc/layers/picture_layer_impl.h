@@ -39,7 +39,8 @@ class CC_EXPORT PictureLayerImpl
   virtual void PushPropertiesTo(LayerImpl* layer) OVERRIDE;
   virtual void AppendQuads(QuadSink* quad_sink,
                            AppendQuadsData* append_quads_data) OVERRIDE;
-  virtual void UpdateTilePriorities() OVERRIDE;
+  virtual void UpdateTilePriorities(
+      const OcclusionTrackerImpl* occlusion_tracker) OVERRIDE;
   virtual void DidBecomeActive() OVERRIDE;
   virtual void DidBeginTracing() OVERRIDE;
   virtual void ReleaseResources() OVERRIDE;
@@ -65,6 +66,12 @@ class CC_EXPORT PictureLayerImpl
   virtual size_t GetMaxTilesForInterestArea() const OVERRIDE;
   virtual float GetSkewportTargetTimeInSeconds() const OVERRIDE;
   virtual int GetSkewportExtrapolationLimitInContentPixels() const OVERRIDE;
+  virtual gfx::Vector2dF GetPredictedScrollDeltaInLayerSpace() const OVERRIDE;
+  virtual bool IsContentRectOccluded(const gfx::Rect& content_rect,
+                                     float contents_scale) const OVERRIDE;
+
+  // Appends the layer's tilings to |tilings|.
+  void GetTilings(std::vector<PictureLayerTiling*>* tilings) const;
 
   // PushPropertiesTo active tree => pending tree.
   void SyncTiling(const PictureLayerTiling* tiling);
@@ -109,6 +116,12 @@ class CC_EXPORT PictureLayerImpl
       float contents_scale,
       const gfx::Rect& rect,
       const Region& missing_region) const;
+  // Appends a quad that rasterizes the missing |geometry_rect| at low
+  // resolution while drawing, if the frame's budget for that allows it.
+  bool AppendRasterOnDemandQuad(QuadSink* quad_sink,
+                                SharedQuadState* shared_quad_state,
+                                const gfx::Rect& geometry_rect,
+                                AppendQuadsData* append_quads_data);
 
   void DoPostCommitInitializationIfNeeded() {
     if (needs_post_commit_initialization_)
@@ -150,6 +163,10 @@ class CC_EXPORT PictureLayerImpl
   // after a CalculateContentsScale/ManageTilings.
   bool should_update_tile_priorities_;
   bool should_use_gpu_rasterization_;
+  // Set by UpdateTilePriorities() for the tilings to read.
+  gfx::Vector2dF predicted_scroll_delta_in_layer_space_;
+  // Only set while UpdateTilePriorities() runs, and may be null.
+  const OcclusionTrackerImpl* occlusion_tracker_;
 
   friend class PictureLayer;
   DISALLOW_COPY_AND_ASSIGN(PictureLayerImpl);
@@ -8,6 +8,7 @@
 
 #include "cc/layers/append_quads_data.h"
 #include "cc/layers/picture_layer.h"
+#include "cc/quads/picture_draw_quad.h"
 #include "cc/test/fake_content_layer_client.h"
 #include "cc/test/fake_impl_proxy.h"
 #include "cc/test/fake_layer_tree_host_impl.h"
@@ -311,7 +312,7 @@ TEST_F(PictureLayerImplTest, SuppressUpdateTilePriorities) {
                                         &dummy_content_bounds);
 
   EXPECT_TRUE(host_impl_.manage_tiles_needed());
-  active_layer_->UpdateTilePriorities();
+  active_layer_->UpdateTilePriorities(NULL);
   host_impl_.ManageTiles();
   EXPECT_FALSE(host_impl_.manage_tiles_needed());
 
@@ -324,7 +325,7 @@ TEST_F(PictureLayerImplTest, SuppressUpdateTilePriorities) {
                                         gfx::Rect(layer_bounds),
                                         gfx::Rect(layer_bounds),
                                         valid_for_tile_management);
-  active_layer_->UpdateTilePriorities();
+  active_layer_->UpdateTilePriorities(NULL);
   EXPECT_FALSE(host_impl_.manage_tiles_needed());
 
   time_ticks += base::TimeDelta::FromMilliseconds(200);
@@ -335,7 +336,7 @@ TEST_F(PictureLayerImplTest, SuppressUpdateTilePriorities) {
                                         gfx::Rect(layer_bounds),
                                         gfx::Rect(layer_bounds),
                                         valid_for_tile_management);
-  active_layer_->UpdateTilePriorities();
+  active_layer_->UpdateTilePriorities(NULL);
   EXPECT_TRUE(host_impl_.manage_tiles_needed());
 }
 
@@ -1173,6 +1174,70 @@ TEST_F(PictureLayerImplTest, DisallowTileDrawQuads) {
   EXPECT_EQ(DrawQuad::PICTURE_CONTENT, quad_culler.quad_list()[0]->material);
 }
 
+TEST_F(PictureLayerImplTest, RasterOnDemandMissingTilesWithinBudget) {
+  gfx::Size tile_size(400, 400);
+  gfx::Size layer_bounds(1300, 1900);
+
+  scoped_refptr<FakePicturePileImpl> pending_pile =
+      FakePicturePileImpl::CreateFilledPile(tile_size, layer_bounds);
+  scoped_refptr<FakePicturePileImpl> active_pile =
+      FakePicturePileImpl::CreateFilledPile(tile_size, layer_bounds);
+
+  SetupTrees(pending_pile, active_pile);
+
+  active_layer_->SetContentBounds(layer_bounds);
+  active_layer_->draw_properties().visible_content_rect =
+      gfx::Rect(layer_bounds);
+  AddDefaultTilingsWithInvalidation(Region());
+
+  // Without a budget, none of the missing tiles are rasterized on demand.
+  {
+    MockQuadCuller quad_culler;
+    AppendQuadsData data;
+    host_impl_.SetRasterOnDemandPixelBudgetForTesting(0);
+    active_layer_->WillDraw(DRAW_MODE_HARDWARE, NULL);
+    active_layer_->AppendQuads(&quad_culler, &data);
+    active_layer_->DidDraw(NULL);
+
+    EXPECT_LT(0, data.num_missing_tiles);
+    for (size_t i = 0; i < quad_culler.quad_list().size(); ++i) {
+      EXPECT_NE(DrawQuad::PICTURE_CONTENT,
+                quad_culler.quad_list()[i]->material);
+    }
+  }
+
+  // With a budget, missing tiles are drawn from the pile at low resolution
+  // until the budget runs out.
+  {
+    MockQuadCuller quad_culler;
+    AppendQuadsData data;
+    int64 budget = 100 * 100;
+    host_impl_.SetRasterOnDemandPixelBudgetForTesting(budget);
+    active_layer_->WillDraw(DRAW_MODE_HARDWARE, NULL);
+    active_layer_->AppendQuads(&quad_culler, &data);
+    active_layer_->DidDraw(NULL);
+
+    int64 rastered_pixels = 0;
+    size_t num_raster_on_demand_quads = 0;
+    for (size_t i = 0; i < quad_culler.quad_list().size(); ++i) {
+      const DrawQuad* quad = quad_culler.quad_list()[i];
+      if (quad->material != DrawQuad::PICTURE_CONTENT)
+        continue;
+      const PictureDrawQuad* picture_quad = PictureDrawQuad::MaterialCast(quad);
+      EXPECT_FLOAT_EQ(
+          host_impl_.settings().low_res_contents_scale_factor,
+          picture_quad->contents_scale);
+      rastered_pixels += picture_quad->content_rect.size().GetArea();
+      ++num_raster_on_demand_quads;
+    }
+    EXPECT_LT(0u, num_raster_on_demand_quads);
+    EXPECT_GE(budget, rastered_pixels);
+    EXPECT_EQ(budget - rastered_pixels,
+              host_impl_.raster_on_demand_pixel_budget());
+    EXPECT_TRUE(data.had_incomplete_tile);
+  }
+}
+
 TEST_F(PictureLayerImplTest, MarkRequiredNullTiles) {
   gfx::Size tile_size(100, 100);
   gfx::Size layer_bounds(1000, 1000);
@@ -132,6 +132,7 @@ void RenderSurfaceImpl::AppendRenderPasses(RenderPassSink* pass_sink) {
                content_rect_,
                damage_tracker_->current_damage_rect(),
                screen_space_transform_);
+  pass->damage_rects = damage_tracker_->current_damage_rects().rects();
   pass_sink->AppendRenderPass(pass.Pass());
 }
 
@@ -14,6 +14,7 @@
 #include "cc/base/math_util.h"
 #include "cc/output/copy_output_request.h"
 #include "cc/quads/draw_quad.h"
+#include "cc/quads/render_pass_draw_quad.h"
 #include "cc/resources/raster_worker_pool.h"
 #include "ui/gfx/rect_conversions.h"
 #include "ui/gfx/transform.h"
@@ -180,8 +181,10 @@ void DirectRenderer::DecideRenderPassAllocationsForFrame(
 
   // Delete RenderPass textures from the previous frame that will not be used
   // again.
-  for (size_t i = 0; i < passes_to_delete.size(); ++i)
+  for (size_t i = 0; i < passes_to_delete.size(); ++i) {
     render_pass_textures_.erase(passes_to_delete[i]);
+    cached_render_pass_contents_.erase(passes_to_delete[i]);
+  }
 
   for (size_t i = 0; i < render_passes_in_draw_order.size(); ++i) {
     if (!render_pass_textures_.contains(render_passes_in_draw_order[i]->id)) {
@@ -207,6 +210,11 @@ void DirectRenderer::DrawFrame(RenderPassList* render_passes_in_draw_order,
   const RenderPass* root_render_pass = render_passes_in_draw_order->back();
   DCHECK(root_render_pass);
 
+  draw_call_count_ = 0;
+  drawn_quad_count_ = 0;
+  on_demand_raster_time_ = base::TimeDelta();
+  on_demand_raster_pixel_count_ = 0;
+
   DrawingFrame frame;
   frame.root_render_pass = root_render_pass;
   frame.root_damage_rect =
@@ -220,6 +228,20 @@ void DirectRenderer::DrawFrame(RenderPassList* render_passes_in_draw_order,
   frame.disable_picture_quad_image_filtering =
       disable_picture_quad_image_filtering;
 
+  // Damage that covers the whole frame, as from SetFullRootLayerDamage(), may
+  // stand for changes the damage of the render passes doesn't include, like
+  // new tiles or a frame drawn by another renderer. Without partial swaps the
+  // HUD may be drawn into any pass without damaging it.
+  if (!allow_partial_swap ||
+      root_render_pass->damage_rect.Contains(root_render_pass->output_rect)) {
+    cached_render_pass_contents_.clear();
+  }
+  for (base::hash_map<RenderPass::Id, CachedRenderPassContents>::iterator it =
+           cached_render_pass_contents_.begin();
+       it != cached_render_pass_contents_.end();
+       ++it)
+    it->second.drawn_in_full_this_frame = false;
+
   EnsureBackbuffer();
 
   // Only reshape when we know we are going to draw. Otherwise, the reshape
@@ -337,34 +359,93 @@ void DirectRenderer::DrawRenderPass(DrawingFrame* frame,
   if (!UseRenderPass(frame, render_pass))
     return;
 
+  // Passes from delegated frames (with a non-zero index) are damaged relative
+  // to the child compositor's last frame rather than ours, so they can't be
+  // kept across frames, and neither can the passes they contribute to.
+  bool contributing_passes_drawn_in_full = false;
+  bool can_cache_contents =
+      allow_partial_swap && render_pass != frame->root_render_pass &&
+      !render_pass->id.index &&
+      ContributingRenderPassesAreCached(render_pass,
+                                        &contributing_passes_drawn_in_full);
   bool using_scissor_as_optimization =
       Capabilities().using_partial_swap && allow_partial_swap;
-  gfx::RectF render_pass_scissor;
+
+  // The pass was drawn from the contents its contributing passes had then, so
+  // it is only up to date if theirs changed only by their damage, which is
+  // part of its own.
+  if (can_cache_contents && !contributing_passes_drawn_in_full &&
+      RenderPassContentsAreCached(render_pass)) {
+    // The texture still holds the rest of the pass, so only its own damage
+    // is redrawn, a rect at a time.
+    TRACE_EVENT0("cc", "DirectRenderer::DrawRenderPass cached");
+    std::vector<gfx::RectF> damage_rects =
+        DamageRectsForRenderPass(render_pass);
+    for (size_t i = 0; i < damage_rects.size(); ++i)
+      DrawRenderPassQuads(frame, true, damage_rects[i]);
+    return;
+  }
+
+  if (can_cache_contents) {
+    // Draw all of the pass, even outside the root damage, so that the next
+    // frames only need to draw its damage.
+    DrawRenderPassQuads(frame, false, gfx::RectF());
+    CacheRenderPassContents(render_pass);
+    return;
+  }
+
+  cached_render_pass_contents_.erase(render_pass->id);
+  if (!using_scissor_as_optimization) {
+    DrawRenderPassQuads(frame, false, gfx::RectF());
+    return;
+  }
+
+  gfx::RectF render_pass_scissor = ComputeScissorRectForRenderPass(frame);
+  if (render_pass != frame->root_render_pass ||
+      render_pass_scissor == render_pass->output_rect) {
+    DrawRenderPassQuads(frame, true, render_pass_scissor);
+    return;
+  }
+
+  // Far apart damage on the root pass is drawn a rect at a time, rather than
+  // as one rect covering everything in between.
+  std::vector<gfx::RectF> damage_rects = DamageRectsForRenderPass(render_pass);
+  for (size_t i = 0; i < damage_rects.size(); ++i) {
+    damage_rects[i].Intersect(render_pass_scissor);
+    if (!damage_rects[i].IsEmpty())
+      DrawRenderPassQuads(frame, true, damage_rects[i]);
+  }
+}
+
+void DirectRenderer::DrawRenderPassQuads(
+    DrawingFrame* frame,
+    bool using_render_pass_scissor,
+    const gfx::RectF& render_pass_scissor) {
+  const RenderPass* render_pass = frame->current_render_pass;
   bool draw_rect_covers_full_surface = true;
-  if (frame->current_render_pass == frame->root_render_pass &&
+  if (render_pass == frame->root_render_pass &&
       !frame->device_viewport_rect.Contains(
            gfx::Rect(output_surface_->SurfaceSize())))
     draw_rect_covers_full_surface = false;
 
-  if (using_scissor_as_optimization) {
-    render_pass_scissor = ComputeScissorRectForRenderPass(frame);
+  if (using_render_pass_scissor) {
     SetScissorTestRectInDrawSpace(frame, render_pass_scissor);
-    if (!render_pass_scissor.Contains(frame->current_render_pass->output_rect))
+    if (!render_pass_scissor.Contains(render_pass->output_rect))
       draw_rect_covers_full_surface = false;
   }
 
-  if (frame->current_render_pass != frame->root_render_pass ||
+  if (render_pass != frame->root_render_pass ||
       settings_->should_clear_root_render_pass) {
     if (NeedDeviceClip(frame)) {
       SetScissorTestRect(DeviceClipRectInWindowSpace(frame));
       draw_rect_covers_full_surface = false;
-    } else if (!using_scissor_as_optimization) {
+    } else if (!using_render_pass_scissor) {
       EnsureScissorTestDisabled();
     }
 
     bool has_external_stencil_test =
         output_surface_->HasExternalStencilTest() &&
-        frame->current_render_pass == frame->root_render_pass;
+        render_pass == frame->root_render_pass;
 
     DiscardPixels(has_external_stencil_test, draw_rect_covers_full_surface);
     ClearFramebuffer(frame, has_external_stencil_test);
@@ -377,19 +458,61 @@ void DirectRenderer::DrawRenderPass(DrawingFrame* frame,
     const DrawQuad& quad = *(*it);
     bool should_skip_quad = false;
 
-    if (using_scissor_as_optimization) {
+    if (using_render_pass_scissor) {
       SetScissorStateForQuadWithRenderPassScissor(
           frame, quad, render_pass_scissor, &should_skip_quad);
     } else {
       SetScissorStateForQuad(frame, quad);
     }
 
-    if (!should_skip_quad)
+    if (!should_skip_quad) {
       DoDrawQuad(frame, *it);
+      ++drawn_quad_count_;
+    }
   }
   FinishDrawingQuadList();
 }
 
+bool DirectRenderer::RenderPassContentsAreCached(
+    const RenderPass* render_pass) {
+  base::hash_map<RenderPass::Id, CachedRenderPassContents>::const_iterator
+      it = cached_render_pass_contents_.find(render_pass->id);
+  if (it == cached_render_pass_contents_.end())
+    return false;
+
+  ScopedResource* texture = render_pass_textures_.get(render_pass->id);
+  return it->second.texture_id == texture->id() &&
+         it->second.output_rect == render_pass->output_rect;
+}
+
+bool DirectRenderer::ContributingRenderPassesAreCached(
+    const RenderPass* render_pass,
+    bool* drawn_in_full_this_frame) {
+  *drawn_in_full_this_frame = false;
+  const QuadList& quad_list = render_pass->quad_list;
+  for (size_t i = 0; i < quad_list.size(); ++i) {
+    if (quad_list[i]->material != DrawQuad::RENDER_PASS)
+      continue;
+    RenderPass::Id contributing_pass_id =
+        RenderPassDrawQuad::MaterialCast(quad_list[i])->render_pass_id;
+    base::hash_map<RenderPass::Id, CachedRenderPassContents>::const_iterator
+        it = cached_render_pass_contents_.find(contributing_pass_id);
+    if (it == cached_render_pass_contents_.end())
+      return false;
+    if (it->second.drawn_in_full_this_frame)
+      *drawn_in_full_this_frame = true;
+  }
+  return true;
+}
+
+void DirectRenderer::CacheRenderPassContents(const RenderPass* render_pass) {
+  CachedRenderPassContents& contents =
+      cached_render_pass_contents_[render_pass->id];
+  contents.texture_id = render_pass_textures_.get(render_pass->id)->id();
+  contents.output_rect = render_pass->output_rect;
+  contents.drawn_in_full_this_frame = true;
+}
+
 bool DirectRenderer::UseRenderPass(DrawingFrame* frame,
                                    const RenderPass* render_pass) {
   frame->current_render_pass = render_pass;
@@ -419,7 +542,9 @@ bool DirectRenderer::UseRenderPass(DrawingFrame* frame,
 }
 
 void DirectRenderer::RunOnDemandRasterTask(
-    internal::Task* on_demand_raster_task) {
+    internal::Task* on_demand_raster_task,
+    const gfx::Rect& raster_rect) {
+  base::TimeTicks start_time = base::TimeTicks::HighResNow();
   internal::TaskGraphRunner* task_graph_runner =
       RasterWorkerPool::GetTaskGraphRunner();
   DCHECK(task_graph_runner);
@@ -445,6 +570,10 @@ void DirectRenderer::RunOnDemandRasterTask(
                                            &completed_tasks);
   DCHECK_EQ(1u, completed_tasks.size());
   DCHECK_EQ(completed_tasks[0], on_demand_raster_task);
+
+  on_demand_raster_time_ += base::TimeTicks::HighResNow() - start_time;
+  on_demand_raster_pixel_count_ +=
+      static_cast<int64>(raster_rect.width()) * raster_rect.height();
 }
 
 bool DirectRenderer::HasAllocatedResourcesForTesting(RenderPass::Id id)
@@ -458,4 +587,26 @@ gfx::Size DirectRenderer::RenderPassTextureSize(const RenderPass* render_pass) {
   return render_pass->output_rect.size();
 }
 
+// static
+std::vector<gfx::RectF> DirectRenderer::DamageRectsForRenderPass(
+    const RenderPass* render_pass) {
+  gfx::RectF bounds;
+  for (size_t i = 0; i < render_pass->damage_rects.size(); ++i)
+    bounds.Union(render_pass->damage_rects[i]);
+
+  std::vector<gfx::RectF> damage_rects;
+  if (!render_pass->damage_rects.empty() && bounds == render_pass->damage_rect)
+    damage_rects = render_pass->damage_rects;
+  else
+    damage_rects.push_back(render_pass->damage_rect);
+
+  std::vector<gfx::RectF> clipped_damage_rects;
+  for (size_t i = 0; i < damage_rects.size(); ++i) {
+    damage_rects[i].Intersect(render_pass->output_rect);
+    if (!damage_rects[i].IsEmpty())
+      clipped_damage_rects.push_back(damage_rects[i]);
+  }
+  return clipped_damage_rects;
+}
+
 }  // namespace cc
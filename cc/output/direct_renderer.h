@@ -5,8 +5,11 @@
 #ifndef CC_OUTPUT_DIRECT_RENDERER_H_
 #define CC_OUTPUT_DIRECT_RENDERER_H_
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/callback.h"
+#include "base/containers/hash_tables.h"
 #include "base/containers/scoped_ptr_hash_map.h"
 #include "cc/base/cc_export.h"
 #include "cc/output/renderer.h"
@@ -91,13 +94,22 @@ class CC_EXPORT DirectRenderer : public Renderer {
                                      const gfx::RectF& draw_space_rect);
 
   static gfx::Size RenderPassTextureSize(const RenderPass* render_pass);
+  // The damage of |render_pass| within its output rect, as the rects of
+  // RenderPass::damage_rects when they are usable.
+  static std::vector<gfx::RectF> DamageRectsForRenderPass(
+      const RenderPass* render_pass);
 
   void DrawRenderPass(DrawingFrame* frame,
                       const RenderPass* render_pass,
                       bool allow_partial_swap);
+  void DrawRenderPassQuads(DrawingFrame* frame,
+                           bool using_render_pass_scissor,
+                           const gfx::RectF& render_pass_scissor);
   bool UseRenderPass(DrawingFrame* frame, const RenderPass* render_pass);
 
-  void RunOnDemandRasterTask(internal::Task* on_demand_raster_task);
+  // Runs the task that rasterizes |raster_rect| and waits for it.
+  void RunOnDemandRasterTask(internal::Task* on_demand_raster_task,
+                             const gfx::Rect& raster_rect);
 
   virtual void BindFramebufferToOutputSurface(DrawingFrame* frame) = 0;
   virtual bool BindFramebufferToTexture(DrawingFrame* frame,
@@ -124,6 +136,21 @@ class CC_EXPORT DirectRenderer : public Renderer {
       scoped_ptr<CopyOutputRequest> request) = 0;
 
   base::ScopedPtrHashMap<RenderPass::Id, ScopedResource> render_pass_textures_;
+
+  // The non-root render passes whose textures hold all of their contents as
+  // of the last frame they were drawn in, so that only their damage needs to
+  // be redrawn. An entry is only valid while the pass' texture and output rect
+  // stay the same.
+  struct CachedRenderPassContents {
+    CachedRenderPassContents()
+        : texture_id(0), drawn_in_full_this_frame(false) {}
+
+    ResourceProvider::ResourceId texture_id;
+    gfx::Rect output_rect;
+    bool drawn_in_full_this_frame;
+  };
+  base::hash_map<RenderPass::Id, CachedRenderPassContents>
+      cached_render_pass_contents_;
   OutputSurface* output_surface_;
   ResourceProvider* resource_provider_;
 
@@ -137,6 +164,13 @@ class CC_EXPORT DirectRenderer : public Renderer {
   gfx::Size current_surface_size_;
 
  private:
+  bool RenderPassContentsAreCached(const RenderPass* render_pass);
+  // Whether the passes drawn into |render_pass| are all kept across frames,
+  // and whether any of them were drawn in full this frame.
+  bool ContributingRenderPassesAreCached(const RenderPass* render_pass,
+                                         bool* drawn_in_full_this_frame);
+  void CacheRenderPassContents(const RenderPass* render_pass);
+
   gfx::Vector2d enlarge_pass_texture_amount_;
 
   internal::NamespaceToken on_demand_task_namespace_;
@@ -343,6 +343,8 @@ void GLRenderer::BeginDrawingFrame(DrawingFrame* frame) {
 
   TRACE_EVENT0("cc", "GLRenderer::BeginDrawingFrame");
 
+  context_support_->BeginFrameSubmission();
+
   // TODO(enne): Do we need to reinitialize all of this state per frame?
   ReinitializeGLState();
 }
@@ -357,6 +359,9 @@ void GLRenderer::DoDrawQuad(DrawingFrame* frame, const DrawQuad* quad) {
   if (quad->material != DrawQuad::TEXTURE_CONTENT) {
     FlushTextureQuadCache();
   }
+  if (quad->material != DrawQuad::SOLID_COLOR) {
+    FlushSolidColorQuadCache();
+  }
 
   switch (quad->material) {
     case DrawQuad::INVALID:
@@ -480,6 +485,7 @@ void GLRenderer::DrawDebugBorderQuad(const DrawingFrame* frame,
   // The indices for the line are stored in the same array as the triangle
   // indices.
   GLC(gl_, gl_->DrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_SHORT, 0));
+  ++draw_call_count_;
 }
 
 static SkBitmap ApplyImageFilter(GLRenderer* renderer,
@@ -1351,11 +1357,17 @@ void GLRenderer::DrawSolidColorQuad(const DrawingFrame* frame,
       settings_->allow_antialiasing && !quad->force_anti_aliasing_off &&
       SetupQuadForAntialiasing(device_transform, quad, &local_quad, edge);
 
+  // Without antialiasing, quads only differ by transform and color, so they
+  // are drawn in batches.
+  if (!use_aa) {
+    EnqueueSolidColorQuad(frame, quad);
+    return;
+  }
+
+  FlushSolidColorQuadCache();
+
   SolidColorProgramUniforms uniforms;
-  if (use_aa)
-    SolidColorUniformLocation(GetSolidColorProgramAA(), &uniforms);
-  else
-    SolidColorUniformLocation(GetSolidColorProgram(), &uniforms);
+  SolidColorUniformLocation(GetSolidColorProgramAA(), &uniforms);
   SetUseProgram(uniforms.program);
 
   GLC(gl_,
@@ -1364,18 +1376,15 @@ void GLRenderer::DrawSolidColorQuad(const DrawingFrame* frame,
                      (SkColorGetG(color) * (1.0f / 255.0f)) * alpha,
                      (SkColorGetB(color) * (1.0f / 255.0f)) * alpha,
                      alpha));
-  if (use_aa) {
-    float viewport[4] = {static_cast<float>(viewport_.x()),
-                         static_cast<float>(viewport_.y()),
-                         static_cast<float>(viewport_.width()),
-                         static_cast<float>(viewport_.height()), };
-    GLC(gl_, gl_->Uniform4fv(uniforms.viewport_location, 1, viewport));
-    GLC(gl_, gl_->Uniform3fv(uniforms.edge_location, 8, edge));
-  }
+  float viewport[4] = {static_cast<float>(viewport_.x()),
+                       static_cast<float>(viewport_.y()),
+                       static_cast<float>(viewport_.width()),
+                       static_cast<float>(viewport_.height()), };
+  GLC(gl_, gl_->Uniform4fv(uniforms.viewport_location, 1, viewport));
+  GLC(gl_, gl_->Uniform3fv(uniforms.edge_location, 8, edge));
 
-  // Enable blending when the quad properties require it or if we decided
-  // to use antialiasing.
-  SetBlendEnabled(quad->ShouldDrawWithBlending() || use_aa);
+  // Antialiasing always needs blending.
+  SetBlendEnabled(true);
 
   // Normalize to tile_rect.
   local_quad.Scale(1.0f / tile_rect.width(), 1.0f / tile_rect.height());
@@ -1758,7 +1767,7 @@ void GLRenderer::DrawPictureQuad(const DrawingFrame* frame,
                                  &on_demand_tile_raster_bitmap_,
                                  quad->content_rect,
                                  quad->contents_scale));
-  RunOnDemandRasterTask(on_demand_raster_task.get());
+  RunOnDemandRasterTask(on_demand_raster_task.get(), quad->content_rect);
 
   uint8_t* bitmap_pixels = NULL;
   SkBitmap on_demand_tile_raster_bitmap_dest;
@@ -1871,6 +1880,7 @@ void GLRenderer::FlushTextureQuadCache() {
                         6 * draw_cache_.matrix_data.size(),
                         GL_UNSIGNED_SHORT,
                         0));
+  ++draw_call_count_;
 
   // Clear the cache.
   draw_cache_.program_id = 0;
@@ -1944,6 +1954,76 @@ void GLRenderer::EnqueueTextureQuad(const DrawingFrame* frame,
   draw_cache_.matrix_data.push_back(m);
 }
 
+void GLRenderer::FlushSolidColorQuadCache() {
+  if (solid_color_draw_cache_.program_id == 0)
+    return;
+
+  SetBlendEnabled(solid_color_draw_cache_.needs_blending);
+  SetUseProgram(solid_color_draw_cache_.program_id);
+
+  GLC(gl_,
+      gl_->UniformMatrix4fv(
+          solid_color_draw_cache_.matrix_location,
+          static_cast<int>(solid_color_draw_cache_.matrix_data.size()),
+          false,
+          reinterpret_cast<float*>(
+              &solid_color_draw_cache_.matrix_data.front())));
+  GLC(gl_,
+      gl_->Uniform4fv(
+          solid_color_draw_cache_.color_location,
+          static_cast<int>(solid_color_draw_cache_.color_data.size()),
+          reinterpret_cast<float*>(
+              &solid_color_draw_cache_.color_data.front())));
+
+  GLC(gl_,
+      gl_->DrawElements(GL_TRIANGLES,
+                        6 * solid_color_draw_cache_.matrix_data.size(),
+                        GL_UNSIGNED_SHORT,
+                        0));
+  ++draw_call_count_;
+
+  solid_color_draw_cache_.program_id = 0;
+  solid_color_draw_cache_.matrix_data.resize(0);
+  solid_color_draw_cache_.color_data.resize(0);
+}
+
+void GLRenderer::EnqueueSolidColorQuad(const DrawingFrame* frame,
+                                       const SolidColorDrawQuad* quad) {
+  const SolidColorProgram* program = GetSolidColorProgram();
+  bool needs_blending = quad->ShouldDrawWithBlending();
+
+  if (solid_color_draw_cache_.program_id != program->program() ||
+      solid_color_draw_cache_.needs_blending != needs_blending ||
+      solid_color_draw_cache_.matrix_data.size() >= 8) {
+    FlushSolidColorQuadCache();
+    solid_color_draw_cache_.program_id = program->program();
+    solid_color_draw_cache_.needs_blending = needs_blending;
+    solid_color_draw_cache_.matrix_location =
+        program->vertex_shader().matrix_location();
+    solid_color_draw_cache_.color_location =
+        program->vertex_shader().color_location();
+  }
+
+  Float4 color = PremultipliedColor(quad->color);
+  for (size_t i = 0; i < arraysize(color.data); ++i)
+    color.data[i] *= quad->opacity();
+  solid_color_draw_cache_.color_data.push_back(color);
+
+  gfx::Transform quad_rect_matrix;
+  QuadRectTransform(
+      &quad_rect_matrix, quad->quadTransform(), quad->visible_rect);
+  quad_rect_matrix = frame->projection_matrix * quad_rect_matrix;
+
+  Float16 m;
+  quad_rect_matrix.matrix().asColMajorf(m.data);
+  solid_color_draw_cache_.matrix_data.push_back(m);
+}
+
+void GLRenderer::FlushDrawCaches() {
+  FlushTextureQuadCache();
+  FlushSolidColorQuadCache();
+}
+
 void GLRenderer::DrawIOSurfaceQuad(const DrawingFrame* frame,
                                    const IOSurfaceDrawQuad* quad) {
   SetBlendEnabled(quad->ShouldDrawWithBlending());
@@ -1996,9 +2076,11 @@ void GLRenderer::FinishDrawingFrame(DrawingFrame* frame) {
 
   GLC(gl_, gl_->Disable(GL_BLEND));
   blend_shadow_ = false;
+
+  context_support_->EndFrameSubmission();
 }
 
-void GLRenderer::FinishDrawingQuadList() { FlushTextureQuadCache(); }
+void GLRenderer::FinishDrawingQuadList() { FlushDrawCaches(); }
 
 bool GLRenderer::FlippedFramebuffer() const { return true; }
 
@@ -2006,7 +2088,7 @@ void GLRenderer::EnsureScissorTestEnabled() {
   if (is_scissor_enabled_)
     return;
 
-  FlushTextureQuadCache();
+  FlushDrawCaches();
   GLC(gl_, gl_->Enable(GL_SCISSOR_TEST));
   is_scissor_enabled_ = true;
 }
@@ -2015,7 +2097,7 @@ void GLRenderer::EnsureScissorTestDisabled() {
   if (!is_scissor_enabled_)
     return;
 
-  FlushTextureQuadCache();
+  FlushDrawCaches();
   GLC(gl_, gl_->Disable(GL_SCISSOR_TEST));
   is_scissor_enabled_ = false;
 }
@@ -2094,6 +2176,7 @@ void GLRenderer::DrawQuadGeometry(const DrawingFrame* frame,
   GLC(gl_, gl_->UniformMatrix4fv(matrix_location, 1, false, &gl_matrix[0]));
 
   GLC(gl_, gl_->DrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0));
+  ++draw_call_count_;
 }
 
 void GLRenderer::CopyTextureToFramebuffer(const DrawingFrame* frame,
@@ -2580,7 +2663,7 @@ void GLRenderer::SetScissorTestRect(const gfx::Rect& scissor_rect) {
     return;
 
   scissor_rect_ = scissor_rect;
-  FlushTextureQuadCache();
+  FlushDrawCaches();
   GLC(gl_,
       gl_->Scissor(scissor_rect.x(),
                    scissor_rect.y(),
@@ -11,4 +11,9 @@ TexturedQuadDrawCache::TexturedQuadDrawCache()
 
 TexturedQuadDrawCache::~TexturedQuadDrawCache() {}
 
+SolidColorQuadDrawCache::SolidColorQuadDrawCache()
+    : program_id(0) {}
+
+SolidColorQuadDrawCache::~SolidColorQuadDrawCache() {}
+
 }  // namespace cc
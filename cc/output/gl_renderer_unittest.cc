@@ -952,6 +952,60 @@ TEST_F(GLRendererTest, ShouldClearRootRenderPass) {
   Mock::VerifyAndClearExpectations(&mock_context);
 }
 
+class DrawElementsMockContext : public TestWebGraphicsContext3D {
+ public:
+  MOCK_METHOD4(drawElements,
+               void(GLenum mode, GLsizei count, GLenum type, GLintptr offset));
+};
+
+TEST_F(GLRendererTest, BatchesSolidColorQuads) {
+  scoped_ptr<DrawElementsMockContext> mock_context_owned(
+      new DrawElementsMockContext);
+  DrawElementsMockContext* mock_context = mock_context_owned.get();
+
+  FakeOutputSurfaceClient output_surface_client;
+  scoped_ptr<OutputSurface> output_surface(FakeOutputSurface::Create3d(
+      mock_context_owned.PassAs<TestWebGraphicsContext3D>()));
+  CHECK(output_surface->BindToClient(&output_surface_client));
+
+  scoped_ptr<ResourceProvider> resource_provider(
+      ResourceProvider::Create(output_surface.get(), NULL, 0, false, 1));
+
+  LayerTreeSettings settings;
+  FakeRendererClient renderer_client;
+  FakeRendererGL renderer(&renderer_client,
+                          &settings,
+                          output_surface.get(),
+                          resource_provider.get());
+
+  gfx::Rect viewport_rect(100, 100);
+
+  RenderPass::Id root_pass_id(1, 0);
+  TestRenderPass* root_pass = AddRenderPass(&render_passes_in_draw_order_,
+                                            root_pass_id,
+                                            viewport_rect,
+                                            gfx::Transform());
+  AddQuad(root_pass, gfx::Rect(0, 0, 10, 10), SK_ColorRED);
+  AddQuad(root_pass, gfx::Rect(20, 20, 10, 10), SK_ColorGREEN);
+  AddQuad(root_pass, gfx::Rect(40, 40, 10, 10), SK_ColorBLUE);
+
+  // The three quads are drawn together.
+  EXPECT_CALL(*mock_context, drawElements(GL_TRIANGLES, 18, _, _)).Times(1);
+
+  renderer.DecideRenderPassAllocationsForFrame(render_passes_in_draw_order_);
+  renderer.DrawFrame(&render_passes_in_draw_order_,
+                     NULL,
+                     1.f,
+                     viewport_rect,
+                     viewport_rect,
+                     true,
+                     false);
+
+  EXPECT_EQ(1u, renderer.draw_call_count());
+  EXPECT_EQ(3u, renderer.drawn_quad_count());
+  Mock::VerifyAndClearExpectations(&mock_context);
+}
+
 class ScissorTestOnClearCheckingContext : public TestWebGraphicsContext3D {
  public:
   ScissorTestOnClearCheckingContext() : scissor_enabled_(false) {}
@@ -6,6 +6,7 @@
 #define CC_OUTPUT_RENDERER_H_
 
 #include "base/basictypes.h"
+#include "base/time/time.h"
 #include "cc/base/cc_export.h"
 #include "cc/quads/render_pass.h"
 #include "cc/trees/layer_tree_host.h"
@@ -87,12 +88,32 @@ class CC_EXPORT Renderer {
                                       size_t bytes_visible_and_nearby,
                                       size_t bytes_allocated) = 0;
 
+  // The number of draw calls issued and quads drawn by the last DrawFrame().
+  size_t draw_call_count() const { return draw_call_count_; }
+  size_t drawn_quad_count() const { return drawn_quad_count_; }
+  // The time spent rasterizing picture quads while drawing, and the number of
+  // pixels rasterized, in the last DrawFrame().
+  base::TimeDelta on_demand_raster_time() const {
+    return on_demand_raster_time_;
+  }
+  int64 on_demand_raster_pixel_count() const {
+    return on_demand_raster_pixel_count_;
+  }
+
  protected:
   explicit Renderer(RendererClient* client, const LayerTreeSettings* settings)
-      : client_(client), settings_(settings) {}
+      : client_(client),
+        settings_(settings),
+        draw_call_count_(0),
+        drawn_quad_count_(0),
+        on_demand_raster_pixel_count_(0) {}
 
   RendererClient* client_;
   const LayerTreeSettings* settings_;
+  size_t draw_call_count_;
+  size_t drawn_quad_count_;
+  base::TimeDelta on_demand_raster_time_;
+  int64 on_demand_raster_pixel_count_;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(Renderer);
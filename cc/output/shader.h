@@ -137,6 +137,27 @@ class VertexShaderPosTexTransform {
   DISALLOW_COPY_AND_ASSIGN(VertexShaderPosTexTransform);
 };
 
+// Draws up to 8 solid color quads at once, each with its own transform and
+// color.
+class VertexShaderPosColor {
+ public:
+  VertexShaderPosColor();
+
+  void Init(gpu::gles2::GLES2Interface* context,
+            unsigned program,
+            int* base_uniform_index);
+  std::string GetShaderString() const;
+
+  int matrix_location() const { return matrix_location_; }
+  int color_location() const { return color_location_; }
+
+ private:
+  int matrix_location_;
+  int color_location_;
+
+  DISALLOW_COPY_AND_ASSIGN(VertexShaderPosColor);
+};
+
 class VertexShaderQuad {
  public:
   VertexShaderQuad();
@@ -688,6 +709,16 @@ class FragmentShaderColor {
   DISALLOW_COPY_AND_ASSIGN(FragmentShaderColor);
 };
 
+class FragmentShaderVaryingColor {
+ public:
+  std::string GetShaderString(
+      TexCoordPrecision precision, SamplerType sampler) const;
+
+  void Init(gpu::gles2::GLES2Interface* context,
+            unsigned program,
+            int* base_uniform_index) {}
+};
+
 class FragmentShaderColorAA {
  public:
   FragmentShaderColorAA();
@@ -264,6 +264,8 @@ bool SoftwareRenderer::IsSoftwareResource(
 
 void SoftwareRenderer::DoDrawQuad(DrawingFrame* frame, const DrawQuad* quad) {
   TRACE_EVENT0("cc", "SoftwareRenderer::DoDrawQuad");
+  // Every quad is drawn with its own canvas calls.
+  ++draw_call_count_;
   gfx::Transform quad_rect_matrix;
   QuadRectTransform(&quad_rect_matrix, quad->quadTransform(), quad->rect);
   gfx::Transform contents_device_transform =
@@ -389,7 +391,7 @@ void SoftwareRenderer::DrawPictureQuad(const DrawingFrame* frame,
                                  current_canvas_,
                                  quad->content_rect,
                                  quad->contents_scale));
-  RunOnDemandRasterTask(on_demand_raster_task.get());
+  RunOnDemandRasterTask(on_demand_raster_task.get(), quad->content_rect);
 
   current_canvas_->setDrawFilter(NULL);
 }
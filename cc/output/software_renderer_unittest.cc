@@ -436,5 +436,134 @@ TEST_F(SoftwareRendererTest, RenderPassVisibleRect) {
                             interior_visible_rect.bottom() - 1));
 }
 
+TEST_F(SoftwareRendererTest, CachedRenderPassDrawsOnlyItsDamage) {
+  float device_scale_factor = 1.f;
+  gfx::Rect viewport_rect(0, 0, 100, 100);
+  InitializeRenderer(make_scoped_ptr(new SoftwareOutputDevice));
+
+  RenderPassList list;
+
+  SkBitmap output;
+  output.setConfig(SkBitmap::kARGB_8888_Config,
+                   viewport_rect.width(),
+                   viewport_rect.height());
+  output.allocPixels();
+
+  // Draw a green child pass in a first frame, which keeps its contents.
+  RenderPass::Id child_pass_id(2, 0);
+  TestRenderPass* child_pass =
+      AddRenderPass(&list, child_pass_id, viewport_rect, gfx::Transform());
+  AddQuad(child_pass, viewport_rect, SK_ColorGREEN);
+
+  RenderPass::Id root_pass_id(1, 0);
+  TestRenderPass* root_pass =
+      AddRenderPass(&list, root_pass_id, viewport_rect, gfx::Transform());
+  AddRenderPassQuad(root_pass, child_pass);
+
+  renderer()->DecideRenderPassAllocationsForFrame(list);
+  renderer()->DrawFrame(&list,
+                        NULL,
+                        device_scale_factor,
+                        viewport_rect,
+                        viewport_rect,
+                        true,
+                        false);
+  renderer()->GetFramebufferPixels(output.getPixels(), viewport_rect);
+  EXPECT_EQ(SK_ColorGREEN, output.getColor(50, 50));
+
+  list.clear();
+
+  // Make the child pass magenta, but damage it in two corners only. The root
+  // pass is damaged over both, so any part of the child pass that was redrawn
+  // would show.
+  gfx::Rect top_left_rect(0, 0, 10, 10);
+  gfx::Rect bottom_right_rect(80, 80, 10, 10);
+  gfx::Rect damage_rect = gfx::UnionRects(top_left_rect, bottom_right_rect);
+
+  child_pass =
+      AddRenderPass(&list, child_pass_id, viewport_rect, gfx::Transform());
+  AddQuad(child_pass, viewport_rect, SK_ColorMAGENTA);
+  child_pass->damage_rect = damage_rect;
+  child_pass->damage_rects.push_back(top_left_rect);
+  child_pass->damage_rects.push_back(bottom_right_rect);
+
+  root_pass =
+      AddRenderPass(&list, root_pass_id, viewport_rect, gfx::Transform());
+  AddRenderPassQuad(root_pass, child_pass);
+  root_pass->damage_rect = damage_rect;
+
+  renderer()->DecideRenderPassAllocationsForFrame(list);
+  renderer()->DrawFrame(&list,
+                        NULL,
+                        device_scale_factor,
+                        viewport_rect,
+                        viewport_rect,
+                        true,
+                        false);
+  renderer()->GetFramebufferPixels(output.getPixels(), viewport_rect);
+
+  EXPECT_EQ(SK_ColorMAGENTA, output.getColor(0, 0));
+  EXPECT_EQ(SK_ColorMAGENTA, output.getColor(89, 89));
+  EXPECT_EQ(SK_ColorGREEN, output.getColor(50, 50));
+  EXPECT_EQ(SK_ColorGREEN, output.getColor(99, 99));
+}
+
+TEST_F(SoftwareRendererTest, RootRenderPassDrawsEachDamageRect) {
+  float device_scale_factor = 1.f;
+  gfx::Rect viewport_rect(0, 0, 100, 100);
+  settings_.should_clear_root_render_pass = false;
+  InitializeRenderer(make_scoped_ptr(new SoftwareOutputDevice));
+
+  RenderPassList list;
+
+  SkBitmap output;
+  output.setConfig(SkBitmap::kARGB_8888_Config,
+                   viewport_rect.width(),
+                   viewport_rect.height());
+  output.allocPixels();
+
+  RenderPass::Id root_pass_id(1, 0);
+  TestRenderPass* root_pass =
+      AddRenderPass(&list, root_pass_id, viewport_rect, gfx::Transform());
+  AddQuad(root_pass, viewport_rect, SK_ColorGREEN);
+
+  renderer()->DecideRenderPassAllocationsForFrame(list);
+  renderer()->DrawFrame(&list,
+                        NULL,
+                        device_scale_factor,
+                        viewport_rect,
+                        viewport_rect,
+                        true,
+                        false);
+
+  list.clear();
+
+  // Damage two corners only; what lies between them is not redrawn.
+  gfx::Rect top_left_rect(0, 0, 10, 10);
+  gfx::Rect bottom_right_rect(80, 80, 10, 10);
+
+  root_pass =
+      AddRenderPass(&list, root_pass_id, viewport_rect, gfx::Transform());
+  AddQuad(root_pass, viewport_rect, SK_ColorMAGENTA);
+  root_pass->damage_rect = gfx::UnionRects(top_left_rect, bottom_right_rect);
+  root_pass->damage_rects.push_back(top_left_rect);
+  root_pass->damage_rects.push_back(bottom_right_rect);
+
+  renderer()->DecideRenderPassAllocationsForFrame(list);
+  renderer()->DrawFrame(&list,
+                        NULL,
+                        device_scale_factor,
+                        viewport_rect,
+                        viewport_rect,
+                        true,
+                        false);
+  renderer()->GetFramebufferPixels(output.getPixels(), viewport_rect);
+
+  EXPECT_EQ(SK_ColorMAGENTA, output.getColor(0, 0));
+  EXPECT_EQ(SK_ColorMAGENTA, output.getColor(89, 89));
+  EXPECT_EQ(SK_ColorGREEN, output.getColor(50, 50));
+  EXPECT_EQ(SK_ColorGREEN, output.getColor(10, 10));
+}
+
 }  // namespace
 }  // namespace cc
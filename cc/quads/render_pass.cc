@@ -62,6 +62,7 @@ scoped_ptr<RenderPass> RenderPass::Copy(Id new_id) const {
                     damage_rect,
                     transform_to_root_target,
                     has_transparent_background);
+  copy_pass->damage_rects = damage_rects;
   return copy_pass.Pass();
 }
 
@@ -81,6 +82,7 @@ void RenderPass::CopyAll(const ScopedPtrVector<RenderPass>& in,
                       source->damage_rect,
                       source->transform_to_root_target,
                       source->has_transparent_background);
+    copy_pass->damage_rects = source->damage_rects;
     for (size_t i = 0; i < source->shared_quad_state_list.size(); ++i) {
       copy_pass->shared_quad_state_list.push_back(
           source->shared_quad_state_list[i]->Copy());
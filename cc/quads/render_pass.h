@@ -6,6 +6,7 @@
 #define CC_QUADS_RENDER_PASS_H_
 
 #include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/callback.h"
@@ -94,6 +95,10 @@ class CC_EXPORT RenderPass {
   // These are in the space of the render pass' physical pixels.
   gfx::Rect output_rect;
   gfx::RectF damage_rect;
+  // If non-empty, a finer cover of |damage_rect| by a few rects, whose union
+  // is |damage_rect|. It is not serialized, so renderers must fall back to
+  // |damage_rect| when it is empty or no longer matches |damage_rect|.
+  std::vector<gfx::RectF> damage_rects;
 
   // Transforms from the origin of the |output_rect| to the origin of the root
   // render pass' |output_rect|.
@@ -0,0 +1,161 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/image_decode_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "cc/resources/raster_worker_pool.h"
+
+namespace cc {
+
+namespace {
+
+size_t DecodedBytes(SkPixelRef* pixel_ref) {
+  const SkImageInfo& info = pixel_ref->info();
+  return static_cast<size_t>(info.fWidth) * info.fHeight *
+         SkColorTypeBytesPerPixel(info.fColorType);
+}
+
+// Orders images from the first to evict to the last.
+struct EvictionOrder {
+  EvictionOrder(ManagedTileBin bin, unsigned last_use, uint32_t id)
+      : bin(bin), last_use(last_use), id(id) {}
+
+  bool operator<(const EvictionOrder& other) const {
+    if (bin != other.bin)
+      return bin > other.bin;
+    return last_use < other.last_use;
+  }
+
+  ManagedTileBin bin;
+  unsigned last_use;
+  uint32_t id;
+};
+
+}  // namespace
+
+ImageDecodeCache::Image::Image()
+    : is_decoded(false), ref_count(0), bin(NEVER_BIN), last_use(0) {}
+
+ImageDecodeCache::Image::~Image() {}
+
+ImageDecodeCache::ImageDecodeCache(
+    RenderingStatsInstrumentation* rendering_stats_instrumentation)
+    : rendering_stats_instrumentation_(rendering_stats_instrumentation),
+      memory_usage_bytes_(0),
+      use_count_(0) {}
+
+ImageDecodeCache::~ImageDecodeCache() {
+  for (ImageMap::iterator it = images_.begin(); it != images_.end(); ++it) {
+    DCHECK_EQ(0, it->second.ref_count);
+    DCHECK(!it->second.decode_task);
+    UnlockImage(&it->second);
+  }
+  DCHECK_EQ(0u, memory_usage_bytes_);
+}
+
+scoped_refptr<internal::WorkerPoolTask> ImageDecodeCache::RefImage(
+    SkPixelRef* pixel_ref,
+    int layer_id,
+    ManagedTileBin bin) {
+  uint32_t id = pixel_ref->getGenerationID();
+  Image& image = images_[id];
+
+  image.bin = image.ref_count ? std::min(image.bin, bin) : bin;
+  image.last_use = ++use_count_;
+  ++image.ref_count;
+
+  if (image.is_decoded)
+    return NULL;
+
+  if (!image.decode_task) {
+    image.pixel_ref = skia::SharePtr(pixel_ref);
+    image.decode_task = RasterWorkerPool::CreateImageDecodeTask(
+        pixel_ref,
+        layer_id,
+        rendering_stats_instrumentation_,
+        base::Bind(&ImageDecodeCache::OnDecodeTaskCompleted,
+                   base::Unretained(this),
+                   id));
+  }
+  return image.decode_task;
+}
+
+void ImageDecodeCache::UnrefImage(uint32_t id) {
+  ImageMap::iterator it = images_.find(id);
+  DCHECK(it != images_.end());
+  DCHECK_GT(it->second.ref_count, 0);
+  --it->second.ref_count;
+  EraseImageIfUnused(it);
+}
+
+void ImageDecodeCache::ReduceMemoryUsage(size_t max_memory_usage_bytes) {
+  if (memory_usage_bytes_ <= max_memory_usage_bytes)
+    return;
+
+  TRACE_EVENT0("cc", "ImageDecodeCache::ReduceMemoryUsage");
+
+  std::vector<EvictionOrder> candidates;
+  for (ImageMap::const_iterator it = images_.begin(); it != images_.end();
+       ++it) {
+    const Image& image = it->second;
+    if (image.is_decoded && !image.ref_count)
+      candidates.push_back(EvictionOrder(image.bin, image.last_use, it->first));
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  for (std::vector<EvictionOrder>::const_iterator it = candidates.begin();
+       it != candidates.end() && memory_usage_bytes_ > max_memory_usage_bytes;
+       ++it) {
+    ImageMap::iterator image_it = images_.find(it->id);
+    UnlockImage(&image_it->second);
+    EraseImageIfUnused(image_it);
+  }
+}
+
+void ImageDecodeCache::OnDecodeTaskCompleted(uint32_t id, bool was_canceled) {
+  ImageMap::iterator it = images_.find(id);
+  DCHECK(it != images_.end());
+  Image& image = it->second;
+  DCHECK(image.decode_task);
+  DCHECK(!image.is_decoded);
+  image.decode_task = NULL;
+
+  if (!was_canceled) {
+    // The pixels were just decoded, so this only keeps them from being
+    // discarded.
+    image.pixel_ref->lockPixels();
+    image.is_decoded = true;
+    memory_usage_bytes_ += DecodedBytes(image.pixel_ref.get());
+  }
+
+  EraseImageIfUnused(it);
+}
+
+void ImageDecodeCache::UnlockImage(Image* image) {
+  if (!image->is_decoded)
+    return;
+
+  size_t bytes = DecodedBytes(image->pixel_ref.get());
+  DCHECK_GE(memory_usage_bytes_, bytes);
+  memory_usage_bytes_ -= bytes;
+  image->pixel_ref->unlockPixels();
+  image->is_decoded = false;
+}
+
+void ImageDecodeCache::EraseImageIfUnused(ImageMap::iterator it) {
+  const Image& image = it->second;
+  // Pending decode tasks still report back, and decoded pixels stay until
+  // ReduceMemoryUsage() drops them.
+  if (image.ref_count || image.decode_task || image.is_decoded)
+    return;
+
+  images_.erase(it);
+}
+
+}  // namespace cc
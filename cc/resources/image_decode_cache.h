@@ -0,0 +1,86 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_RESOURCES_IMAGE_DECODE_CACHE_H_
+#define CC_RESOURCES_IMAGE_DECODE_CACHE_H_
+
+#include "base/containers/hash_tables.h"
+#include "base/memory/ref_counted.h"
+#include "cc/base/cc_export.h"
+#include "cc/resources/managed_tile_state.h"
+#include "skia/ext/refptr.h"
+#include "third_party/skia/include/core/SkPixelRef.h"
+
+namespace cc {
+class RenderingStatsInstrumentation;
+
+namespace internal {
+class WorkerPoolTask;
+}
+
+// Keeps the decoded pixels of the images that tiles draw, so that an image is
+// decoded once for all the layers that draw it and for every scale they draw
+// it at. Images are pinned while raster tasks that draw them are pending.
+// Unpinned images stay decoded until the cache is asked to give their memory
+// back, and then the ones drawn by the least important tiles go first.
+class CC_EXPORT ImageDecodeCache {
+ public:
+  explicit ImageDecodeCache(
+      RenderingStatsInstrumentation* rendering_stats_instrumentation);
+  ~ImageDecodeCache();
+
+  // Pins |pixel_ref| for a raster task of a tile in |bin|. Returns the task
+  // that decodes it, which the raster task must depend on, or NULL if it is
+  // already decoded. Every call must be balanced by a call to UnrefImage().
+  scoped_refptr<internal::WorkerPoolTask> RefImage(SkPixelRef* pixel_ref,
+                                                   int layer_id,
+                                                   ManagedTileBin bin);
+
+  // Unpins the image with generation id |id| once the raster task that
+  // pinned it has completed or was canceled.
+  void UnrefImage(uint32_t id);
+
+  // Drops the decoded pixels of unpinned images until the cache uses at most
+  // |max_memory_usage_bytes|, or only pinned images are left.
+  void ReduceMemoryUsage(size_t max_memory_usage_bytes);
+
+  // The memory used by decoded images.
+  size_t memory_usage_bytes() const { return memory_usage_bytes_; }
+  size_t image_count() const { return images_.size(); }
+
+ private:
+  struct Image {
+    Image();
+    ~Image();
+
+    skia::RefPtr<SkPixelRef> pixel_ref;
+    // The task that decodes the image until it has completed.
+    scoped_refptr<internal::WorkerPoolTask> decode_task;
+    // The pixels are locked while this is true.
+    bool is_decoded;
+    int ref_count;
+    // The most important bin of the tiles that pinned the image since it was
+    // last unpinned.
+    ManagedTileBin bin;
+    // When the image was last pinned, for choosing between images in the same
+    // bin.
+    unsigned last_use;
+  };
+  typedef base::hash_map<uint32_t, Image> ImageMap;
+
+  void OnDecodeTaskCompleted(uint32_t id, bool was_canceled);
+  void UnlockImage(Image* image);
+  void EraseImageIfUnused(ImageMap::iterator it);
+
+  RenderingStatsInstrumentation* rendering_stats_instrumentation_;
+  ImageMap images_;
+  size_t memory_usage_bytes_;
+  unsigned use_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageDecodeCache);
+};
+
+}  // namespace cc
+
+#endif  // CC_RESOURCES_IMAGE_DECODE_CACHE_H_
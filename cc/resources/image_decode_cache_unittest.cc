@@ -0,0 +1,126 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/image_decode_cache.h"
+
+#include "cc/resources/raster_worker_pool.h"
+#include "cc/test/skia_common.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace cc {
+namespace {
+
+const size_t kImageBytes = 100 * 100 * 4;
+
+void RunDecodeTask(internal::WorkerPoolTask* task) {
+  task->WillRun();
+  task->RunOnWorkerThread(0u);
+  task->DidRun();
+  task->RunReplyOnOriginThread();
+}
+
+void CancelDecodeTask(internal::WorkerPoolTask* task) {
+  task->RunReplyOnOriginThread();
+}
+
+class ImageDecodeCacheTest : public testing::Test {
+ public:
+  ImageDecodeCacheTest() : cache_(NULL) {
+    CreateBitmap(gfx::Size(100, 100), "a", &a_);
+    CreateBitmap(gfx::Size(100, 100), "b", &b_);
+  }
+
+  SkPixelRef* a() { return a_.pixelRef(); }
+  SkPixelRef* b() { return b_.pixelRef(); }
+
+ protected:
+  ImageDecodeCache cache_;
+  SkBitmap a_;
+  SkBitmap b_;
+};
+
+TEST_F(ImageDecodeCacheTest, DecodeOnceForAllLayers) {
+  scoped_refptr<internal::WorkerPoolTask> task =
+      cache_.RefImage(a(), 1, NOW_BIN);
+  ASSERT_TRUE(task);
+  EXPECT_EQ(task.get(), cache_.RefImage(a(), 2, SOON_BIN).get());
+
+  RunDecodeTask(task.get());
+  EXPECT_EQ(kImageBytes, cache_.memory_usage_bytes());
+  EXPECT_FALSE(cache_.RefImage(a(), 3, NOW_BIN));
+
+  cache_.UnrefImage(a()->getGenerationID());
+  cache_.UnrefImage(a()->getGenerationID());
+  cache_.UnrefImage(a()->getGenerationID());
+
+  // Unpinned images stay decoded until their memory is needed.
+  EXPECT_FALSE(cache_.RefImage(a(), 1, NOW_BIN));
+  cache_.UnrefImage(a()->getGenerationID());
+  EXPECT_EQ(kImageBytes, cache_.memory_usage_bytes());
+
+  cache_.ReduceMemoryUsage(0u);
+  EXPECT_EQ(0u, cache_.memory_usage_bytes());
+  EXPECT_EQ(0u, cache_.image_count());
+}
+
+TEST_F(ImageDecodeCacheTest, CanceledDecodeIsRetried) {
+  scoped_refptr<internal::WorkerPoolTask> task =
+      cache_.RefImage(a(), 1, NOW_BIN);
+  ASSERT_TRUE(task);
+  cache_.UnrefImage(a()->getGenerationID());
+  CancelDecodeTask(task.get());
+  EXPECT_EQ(0u, cache_.memory_usage_bytes());
+  EXPECT_EQ(0u, cache_.image_count());
+
+  scoped_refptr<internal::WorkerPoolTask> new_task =
+      cache_.RefImage(a(), 1, NOW_BIN);
+  ASSERT_TRUE(new_task);
+  EXPECT_NE(task.get(), new_task.get());
+
+  RunDecodeTask(new_task.get());
+  cache_.UnrefImage(a()->getGenerationID());
+  cache_.ReduceMemoryUsage(0u);
+}
+
+TEST_F(ImageDecodeCacheTest, PinnedImagesAreNotEvicted) {
+  scoped_refptr<internal::WorkerPoolTask> task =
+      cache_.RefImage(a(), 1, NOW_BIN);
+  RunDecodeTask(task.get());
+
+  cache_.ReduceMemoryUsage(0u);
+  EXPECT_EQ(kImageBytes, cache_.memory_usage_bytes());
+
+  cache_.UnrefImage(a()->getGenerationID());
+  cache_.ReduceMemoryUsage(0u);
+  EXPECT_EQ(0u, cache_.memory_usage_bytes());
+}
+
+TEST_F(ImageDecodeCacheTest, EvictLeastImportantFirst) {
+  scoped_refptr<internal::WorkerPoolTask> a_task =
+      cache_.RefImage(a(), 1, NOW_BIN);
+  scoped_refptr<internal::WorkerPoolTask> b_task =
+      cache_.RefImage(b(), 1, EVENTUALLY_BIN);
+  RunDecodeTask(a_task.get());
+  RunDecodeTask(b_task.get());
+  cache_.UnrefImage(b()->getGenerationID());
+  cache_.UnrefImage(a()->getGenerationID());
+  EXPECT_EQ(2 * kImageBytes, cache_.memory_usage_bytes());
+
+  // |b| was used more recently but only by a tile that isn't needed soon.
+  cache_.ReduceMemoryUsage(kImageBytes);
+  EXPECT_EQ(kImageBytes, cache_.memory_usage_bytes());
+  EXPECT_FALSE(cache_.RefImage(a(), 1, NOW_BIN));
+  scoped_refptr<internal::WorkerPoolTask> new_b_task =
+      cache_.RefImage(b(), 1, NOW_BIN);
+  EXPECT_TRUE(new_b_task);
+
+  CancelDecodeTask(new_b_task.get());
+  cache_.UnrefImage(a()->getGenerationID());
+  cache_.UnrefImage(b()->getGenerationID());
+  cache_.ReduceMemoryUsage(0u);
+}
+
+}  // namespace
+}  // namespace cc
@@ -9,6 +9,11 @@
 
 namespace cc {
 
+// Rasterizes tiles straight into the GPU memory buffers backing
+// CHROMIUM_map_image images, which are then sampled without an upload copy.
+// The ResourcePool only hands a resource out again once its read lock fence
+// has passed, so a tile is never rasterized into a buffer that is still being
+// read by the GPU.
 class CC_EXPORT ImageRasterWorkerPool : public RasterWorkerPool {
  public:
   virtual ~ImageRasterWorkerPool();
@@ -54,6 +54,14 @@ class CC_EXPORT ManagedTileState {
       return resource_->id();
     }
 
+    // May be larger than the tile, whose contents are then at the origin.
+    gfx::Size get_resource_size() const {
+      DCHECK(mode_ == RESOURCE_MODE);
+      DCHECK(resource_);
+
+      return resource_->size();
+    }
+
     SkColor get_solid_color() const {
       DCHECK(mode_ == SOLID_COLOR_MODE);
 
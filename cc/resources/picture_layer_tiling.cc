@@ -14,6 +14,7 @@
 #include "ui/gfx/rect_conversions.h"
 #include "ui/gfx/safe_integer_conversions.h"
 #include "ui/gfx/size_conversions.h"
+#include "ui/gfx/vector2d_conversions.h"
 
 namespace cc {
 
@@ -334,6 +335,152 @@ gfx::Size PictureLayerTiling::CoverageIterator::texture_size() const {
   return tiling_->tiling_data_.max_texture_size();
 }
 
+namespace {
+
+class HigherPriorityTile {
+ public:
+  explicit HigherPriorityTile(WhichTree tree) : tree_(tree) {}
+
+  bool operator()(const Tile* a, const Tile* b) const {
+    return a->priority(tree_).IsHigherPriorityThan(b->priority(tree_));
+  }
+
+ private:
+  WhichTree tree_;
+};
+
+class LowerPriorityTile {
+ public:
+  explicit LowerPriorityTile(WhichTree tree) : tree_(tree) {}
+
+  bool operator()(const Tile* a, const Tile* b) const {
+    return b->priority(tree_).IsHigherPriorityThan(a->priority(tree_));
+  }
+
+ private:
+  WhichTree tree_;
+};
+
+}  // namespace
+
+PictureLayerTiling::TilingRasterTileIterator::TilingRasterTileIterator()
+    : tiling_(NULL),
+      tree_(ACTIVE_TREE),
+      stage_(DONE_STAGE),
+      stage_index_(0),
+      current_tile_(NULL) {}
+
+PictureLayerTiling::TilingRasterTileIterator::TilingRasterTileIterator(
+    PictureLayerTiling* tiling,
+    WhichTree tree)
+    : tiling_(tiling),
+      tree_(tree),
+      stage_(VISIBLE_STAGE),
+      stage_index_(0),
+      current_tile_(NULL) {
+  if (!tiling_->has_ever_been_updated()) {
+    stage_ = DONE_STAGE;
+    return;
+  }
+  // Collect the visible tiles; AdvanceStage() starts from the next stage.
+  for (TilingData::Iterator iter(
+           &tiling_->tiling_data_,
+           tiling_->current_visible_rect_in_content_space_);
+       iter;
+       ++iter) {
+    TileMap::iterator find = tiling_->tiles_.find(iter.index());
+    if (find != tiling_->tiles_.end() && !find->second->is_occluded(tree_))
+      stage_tiles_.push_back(find->second.get());
+  }
+  if (stage_tiles_.empty())
+    AdvanceStage();
+  if (stage_index_ < stage_tiles_.size())
+    current_tile_ = stage_tiles_[stage_index_];
+}
+
+PictureLayerTiling::TilingRasterTileIterator::~TilingRasterTileIterator() {}
+
+PictureLayerTiling::TilingRasterTileIterator&
+PictureLayerTiling::TilingRasterTileIterator::operator++() {
+  DCHECK(current_tile_);
+  ++stage_index_;
+  if (stage_index_ >= stage_tiles_.size())
+    AdvanceStage();
+  current_tile_ =
+      stage_index_ < stage_tiles_.size() ? stage_tiles_[stage_index_] : NULL;
+  return *this;
+}
+
+void PictureLayerTiling::TilingRasterTileIterator::AdvanceStage() {
+  stage_tiles_.clear();
+  stage_index_ = 0;
+  while (stage_tiles_.empty() && stage_ != DONE_STAGE) {
+    stage_ = static_cast<Stage>(stage_ + 1);
+
+    gfx::Rect rect;
+    gfx::Rect ignore_rect;
+    if (stage_ == SKEWPORT_STAGE) {
+      rect = tiling_->current_skewport_;
+      ignore_rect = tiling_->current_visible_rect_in_content_space_;
+    } else if (stage_ == EVENTUALLY_STAGE) {
+      rect = tiling_->current_eventually_rect_;
+      ignore_rect = tiling_->current_skewport_;
+    } else {
+      break;
+    }
+
+    for (TilingData::DifferenceIterator iter(
+             &tiling_->tiling_data_, rect, ignore_rect);
+         iter;
+         ++iter) {
+      TileMap::iterator find = tiling_->tiles_.find(iter.index());
+      if (find != tiling_->tiles_.end())
+        stage_tiles_.push_back(find->second.get());
+    }
+    // The occluded visible tiles were left out of the visible stage, and come
+    // last.
+    if (stage_ == EVENTUALLY_STAGE) {
+      for (TilingData::Iterator iter(
+               &tiling_->tiling_data_,
+               tiling_->current_visible_rect_in_content_space_);
+           iter;
+           ++iter) {
+        TileMap::iterator find = tiling_->tiles_.find(iter.index());
+        if (find != tiling_->tiles_.end() && find->second->is_occluded(tree_))
+          stage_tiles_.push_back(find->second.get());
+      }
+    }
+    std::sort(stage_tiles_.begin(), stage_tiles_.end(),
+              HigherPriorityTile(tree_));
+  }
+}
+
+PictureLayerTiling::TilingEvictionTileIterator::TilingEvictionTileIterator()
+    : tree_(ACTIVE_TREE), index_(0) {}
+
+PictureLayerTiling::TilingEvictionTileIterator::TilingEvictionTileIterator(
+    PictureLayerTiling* tiling,
+    WhichTree tree)
+    : tree_(tree), index_(0) {
+  for (TileMap::iterator it = tiling->tiles_.begin();
+       it != tiling->tiles_.end();
+       ++it) {
+    if (it->second->HasResources())
+      tiles_.push_back(it->second.get());
+  }
+  std::sort(tiles_.begin(), tiles_.end(), LowerPriorityTile(tree_));
+}
+
+PictureLayerTiling::TilingEvictionTileIterator::~TilingEvictionTileIterator() {
+}
+
+PictureLayerTiling::TilingEvictionTileIterator&
+PictureLayerTiling::TilingEvictionTileIterator::operator++() {
+  DCHECK_LT(index_, tiles_.size());
+  ++index_;
+  return *this;
+}
+
 void PictureLayerTiling::Reset() {
   live_tiles_rect_ = gfx::Rect();
   tiles_.clear();
@@ -387,6 +534,25 @@ gfx::Rect PictureLayerTiling::ComputeSkewport(
   return skewport;
 }
 
+gfx::Rect PictureLayerTiling::ComputePredictedSkewport(
+    const gfx::Rect& visible_rect_in_content_space) const {
+  gfx::Vector2d predicted_scroll_delta = gfx::ToRoundedVector2d(
+      gfx::ScaleVector2d(client_->GetPredictedScrollDeltaInLayerSpace(),
+                         contents_scale_));
+  if (predicted_scroll_delta.IsZero())
+    return visible_rect_in_content_space;
+
+  int skewport_limit = client_->GetSkewportExtrapolationLimitInContentPixels();
+  gfx::Rect max_skewport = visible_rect_in_content_space;
+  max_skewport.Inset(
+      -skewport_limit, -skewport_limit, -skewport_limit, -skewport_limit);
+
+  gfx::Rect skewport = visible_rect_in_content_space + predicted_scroll_delta;
+  skewport.Union(visible_rect_in_content_space);
+  skewport.Intersect(max_skewport);
+  return skewport;
+}
+
 void PictureLayerTiling::UpdateTilePriorities(
     WhichTree tree,
     const gfx::Rect& visible_layer_rect,
@@ -404,6 +570,9 @@ void PictureLayerTiling::UpdateTilePriorities(
   if (ContentRect().IsEmpty()) {
     last_impl_frame_time_in_seconds_ = current_frame_time_in_seconds;
     last_visible_rect_in_content_space_ = visible_rect_in_content_space;
+    current_visible_rect_in_content_space_ = gfx::Rect();
+    current_skewport_ = gfx::Rect();
+    current_eventually_rect_ = gfx::Rect();
     return;
   }
 
@@ -415,6 +584,7 @@ void PictureLayerTiling::UpdateTilePriorities(
 
   gfx::Rect skewport = ComputeSkewport(current_frame_time_in_seconds,
                                        visible_rect_in_content_space);
+  skewport.Union(ComputePredictedSkewport(visible_rect_in_content_space));
   DCHECK(skewport.Contains(visible_rect_in_content_space));
 
   gfx::Rect eventually_rect =
@@ -429,9 +599,16 @@ void PictureLayerTiling::UpdateTilePriorities(
 
   last_impl_frame_time_in_seconds_ = current_frame_time_in_seconds;
   last_visible_rect_in_content_space_ = visible_rect_in_content_space;
+  current_visible_rect_in_content_space_ = visible_rect_in_content_space;
+  current_skewport_ = skewport;
+  current_eventually_rect_ = eventually_rect;
 
-  // Assign now priority to all visible tiles.
+  // Assign now priority to all visible tiles, except for those hidden under
+  // opaque layers, which are not worth rasterizing before anything else.
   TilePriority now_priority(resolution_, TilePriority::NOW, 0);
+  TilePriority occluded_priority(resolution_,
+                                 TilePriority::EVENTUALLY,
+                                 std::numeric_limits<float>::infinity());
   for (TilingData::Iterator iter(&tiling_data_, visible_rect_in_content_space);
        iter;
        ++iter) {
@@ -440,7 +617,12 @@ void PictureLayerTiling::UpdateTilePriorities(
       continue;
     Tile* tile = find->second.get();
 
-    tile->SetPriority(tree, now_priority);
+    gfx::Rect visible_tile_rect = gfx::IntersectRects(
+        tile->content_rect(), visible_rect_in_content_space);
+    bool is_occluded =
+        client_->IsContentRectOccluded(visible_tile_rect, contents_scale_);
+    tile->set_is_occluded(tree, is_occluded);
+    tile->SetPriority(tree, is_occluded ? occluded_priority : now_priority);
   }
 
   // Assign soon priority to all tiles in the skewport that are not visible.
@@ -463,6 +645,7 @@ void PictureLayerTiling::UpdateTilePriorities(
         content_to_screen_scale;
 
     TilePriority priority(resolution_, TilePriority::SOON, distance_to_visible);
+    tile->set_is_occluded(tree, false);
     tile->SetPriority(tree, priority);
   }
 
@@ -485,6 +668,7 @@ void PictureLayerTiling::UpdateTilePriorities(
         content_to_screen_scale;
     TilePriority priority(
         resolution_, TilePriority::EVENTUALLY, distance_to_visible);
+    tile->set_is_occluded(tree, false);
     tile->SetPriority(tree, priority);
   }
 }
@@ -532,6 +716,7 @@ void PictureLayerTiling::DidBecomeRecycled() {
   // due to a pending invalidation).
   for (TileMap::const_iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
     it->second->SetPriority(ACTIVE_TREE, TilePriority());
+    it->second->set_is_occluded(ACTIVE_TREE, false);
   }
 }
 
@@ -539,6 +724,9 @@ void PictureLayerTiling::DidBecomeActive() {
   for (TileMap::const_iterator it = tiles_.begin(); it != tiles_.end(); ++it) {
     it->second->SetPriority(ACTIVE_TREE, it->second->priority(PENDING_TREE));
     it->second->SetPriority(PENDING_TREE, TilePriority());
+    it->second->set_is_occluded(ACTIVE_TREE,
+                                it->second->is_occluded(PENDING_TREE));
+    it->second->set_is_occluded(PENDING_TREE, false);
 
     // Tile holds a ref onto a picture pile. If the tile never gets invalidated
     // and recreated, then that picture pile ref could exist indefinitely.  To
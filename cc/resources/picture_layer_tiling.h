@@ -17,6 +17,7 @@
 #include "cc/resources/tile.h"
 #include "cc/resources/tile_priority.h"
 #include "ui/gfx/rect.h"
+#include "ui/gfx/vector2d_f.h"
 
 namespace cc {
 
@@ -38,6 +39,13 @@ class CC_EXPORT PictureLayerTilingClient {
   virtual size_t GetMaxTilesForInterestArea() const = 0;
   virtual float GetSkewportTargetTimeInSeconds() const = 0;
   virtual int GetSkewportExtrapolationLimitInContentPixels() const = 0;
+  // The distance, in layer space, that the layer's contents are predicted to
+  // be scrolled by within the skewport target time.
+  virtual gfx::Vector2dF GetPredictedScrollDeltaInLayerSpace() const = 0;
+  // Whether |content_rect|, in the space of a tiling with |contents_scale|,
+  // is hidden by opaque content drawn on top of the layer.
+  virtual bool IsContentRectOccluded(const gfx::Rect& content_rect,
+                                     float contents_scale) const = 0;
 
  protected:
   virtual ~PictureLayerTilingClient() {}
@@ -132,6 +140,66 @@ class CC_EXPORT PictureLayerTiling {
     friend class PictureLayerTiling;
   };
 
+  // Iterates over the tiles of the tiling in the order they should be
+  // rasterized for |tree|, as of the last UpdateTilePriorities(): the visible
+  // tiles, then the tiles in the skewport and then the rest of the live tiles,
+  // each closest to the viewport first. The tiles of a stage are only looked
+  // at when the iterator gets to it.
+  class CC_EXPORT TilingRasterTileIterator {
+   public:
+    TilingRasterTileIterator();
+    TilingRasterTileIterator(PictureLayerTiling* tiling, WhichTree tree);
+    ~TilingRasterTileIterator();
+
+    Tile* operator->() const { return current_tile_; }
+    Tile* operator*() const { return current_tile_; }
+
+    TilingRasterTileIterator& operator++();
+    operator bool() const { return !!current_tile_; }
+
+    WhichTree tree() const { return tree_; }
+
+   private:
+    enum Stage {
+      VISIBLE_STAGE,
+      SKEWPORT_STAGE,
+      EVENTUALLY_STAGE,
+      DONE_STAGE
+    };
+
+    // Moves to the next stage with tiles and collects them.
+    void AdvanceStage();
+
+    PictureLayerTiling* tiling_;
+    WhichTree tree_;
+    Stage stage_;
+    std::vector<Tile*> stage_tiles_;
+    size_t stage_index_;
+    Tile* current_tile_;
+  };
+
+  // Iterates over the tiles of the tiling that have resources, lowest priority
+  // for |tree| first.
+  class CC_EXPORT TilingEvictionTileIterator {
+   public:
+    TilingEvictionTileIterator();
+    TilingEvictionTileIterator(PictureLayerTiling* tiling, WhichTree tree);
+    ~TilingEvictionTileIterator();
+
+    Tile* operator->() const { return tiles_[index_]; }
+    Tile* operator*() const { return tiles_[index_]; }
+
+    TilingEvictionTileIterator& operator++();
+    operator bool() const { return index_ < tiles_.size(); }
+
+    WhichTree tree() const { return tree_; }
+
+   private:
+    WhichTree tree_;
+    std::vector<Tile*> tiles_;
+    size_t index_;
+  };
+
   Region OpaqueRegionInContentRect(const gfx::Rect& content_rect) const;
 
   void Reset();
@@ -200,6 +268,13 @@ class CC_EXPORT PictureLayerTiling {
                             const gfx::Rect& visible_rect_in_content_space)
       const;
 
+  // Computes the rect that the visible rect sweeps over as the client's
+  // predicted scroll moves it, limited like the skewport. Unlike the skewport
+  // this doesn't need the visible rect to have moved already, so tiles in
+  // the direction of a fling are prioritized from its first frame.
+  gfx::Rect ComputePredictedSkewport(
+      const gfx::Rect& visible_rect_in_content_space) const;
+
   // Given properties.
   float contents_scale_;
   gfx::Size layer_bounds_;
@@ -215,7 +290,15 @@ class CC_EXPORT PictureLayerTiling {
   double last_impl_frame_time_in_seconds_;
   gfx::RectF last_visible_rect_in_content_space_;
 
+  // The rects the last UpdateTilePriorities() assigned priorities by, which
+  // the raster iterator goes through in turn.
+  gfx::Rect current_visible_rect_in_content_space_;
+  gfx::Rect current_skewport_;
+  gfx::Rect current_eventually_rect_;
+
   friend class CoverageIterator;
+  friend class TilingRasterTileIterator;
+  friend class TilingEvictionTileIterator;
 
  private:
   DISALLOW_ASSIGN(PictureLayerTiling);
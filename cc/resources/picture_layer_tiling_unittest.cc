@@ -5,6 +5,7 @@
 #include "cc/resources/picture_layer_tiling.h"
 
 #include <limits>
+#include <set>
 
 #include "cc/base/math_util.h"
 #include "cc/resources/picture_layer_tiling_set.h"
@@ -45,6 +46,7 @@ class TestablePictureLayerTiling : public PictureLayerTiling {
   }
 
   using PictureLayerTiling::ComputeSkewport;
+  using PictureLayerTiling::ComputePredictedSkewport;
 
  protected:
   TestablePictureLayerTiling(float contents_scale,
@@ -393,6 +395,55 @@ TEST(PictureLayerTilingTest, ComputeSkewport) {
   EXPECT_EQ(160, expanded_skewport.height());
 }
 
+TEST(PictureLayerTilingTest, ComputePredictedSkewport) {
+  FakePictureLayerTilingClient client;
+  client.set_skewport_extrapolation_limit_in_content_pixels(75);
+  scoped_ptr<TestablePictureLayerTiling> tiling;
+
+  gfx::Rect viewport(0, 0, 100, 100);
+  gfx::Size layer_bounds(200, 200);
+
+  client.SetTileSize(gfx::Size(100, 100));
+  tiling = TestablePictureLayerTiling::Create(0.5f, layer_bounds, &client);
+
+  // Without a predicted scroll the skewport is the viewport.
+  EXPECT_EQ(viewport.ToString(),
+            tiling->ComputePredictedSkewport(viewport).ToString());
+
+  // The predicted scroll is in layer space.
+  client.set_predicted_scroll_delta(gfx::Vector2dF(0.f, 60.f));
+  EXPECT_EQ(gfx::Rect(0, 0, 100, 130).ToString(),
+            tiling->ComputePredictedSkewport(viewport).ToString());
+
+  // The skewport is limited by the extrapolation limit.
+  client.set_predicted_scroll_delta(gfx::Vector2dF(-400.f, 0.f));
+  EXPECT_EQ(gfx::Rect(-75, 0, 175, 100).ToString(),
+            tiling->ComputePredictedSkewport(viewport).ToString());
+}
+
+TEST(PictureLayerTilingTest, PredictedScrollPrioritizesTilesFromFirstFrame) {
+  FakePictureLayerTilingClient client;
+  scoped_ptr<TestablePictureLayerTiling> tiling;
+
+  gfx::Rect viewport(0, 0, 100, 100);
+  gfx::Size layer_bounds(400, 400);
+
+  client.SetTileSize(gfx::Size(100, 100));
+  client.set_predicted_scroll_delta(gfx::Vector2dF(0.f, 150.f));
+  tiling = TestablePictureLayerTiling::Create(1.0f, layer_bounds, &client);
+
+  // There is no earlier frame to extrapolate from, but tiles in the direction
+  // of the predicted scroll are still soon.
+  tiling->UpdateTilePriorities(ACTIVE_TREE, viewport, 1.f, 1.0);
+
+  ASSERT_TRUE(tiling->TileAt(0, 2));
+  ASSERT_TRUE(tiling->TileAt(2, 0));
+  EXPECT_EQ(TilePriority::SOON,
+            tiling->TileAt(0, 2)->priority(ACTIVE_TREE).priority_bin);
+  EXPECT_EQ(TilePriority::EVENTUALLY,
+            tiling->TileAt(2, 0)->priority(ACTIVE_TREE).priority_bin);
+}
+
 TEST(PictureLayerTilingTest, ViewportDistanceWithScale) {
   FakePictureLayerTilingClient client;
   scoped_ptr<TestablePictureLayerTiling> tiling;
@@ -1464,5 +1515,93 @@ TEST(UpdateTilePrioritiesTest, RotationMotion) {
   EXPECT_EQ(TilePriority::NOW, priority.priority_bin);
 }
 
+TEST(PictureLayerTilingTest, TilingRasterTileIterator) {
+  FakePictureLayerTilingClient client;
+  client.SetTileSize(gfx::Size(100, 100));
+  scoped_ptr<TestablePictureLayerTiling> tiling =
+      TestablePictureLayerTiling::Create(1.0f, gfx::Size(1000, 1000), &client);
+
+  // Without priorities there is nothing to iterate over.
+  EXPECT_FALSE(PictureLayerTiling::TilingRasterTileIterator(tiling.get(),
+                                                            ACTIVE_TREE));
+
+  // Scroll down so that there is a skewport below the viewport.
+  tiling->UpdateTilePriorities(
+      ACTIVE_TREE, gfx::Rect(0, 0, 200, 200), 1.f, 1.0);
+  tiling->UpdateTilePriorities(
+      ACTIVE_TREE, gfx::Rect(0, 100, 200, 200), 1.f, 2.0);
+
+  std::vector<Tile*> all_tiles = tiling->AllTilesForTesting();
+  std::set<Tile*> unique_tiles;
+  bool have_tiles[TilePriority::EVENTUALLY + 1] = {};
+  Tile* last_tile = NULL;
+  for (PictureLayerTiling::TilingRasterTileIterator it(tiling.get(),
+                                                       ACTIVE_TREE);
+       it;
+       ++it) {
+    Tile* tile = *it;
+    TilePriority priority = tile->priority(ACTIVE_TREE);
+    have_tiles[priority.priority_bin] = true;
+    if (last_tile) {
+      EXPECT_FALSE(
+          priority.IsHigherPriorityThan(last_tile->priority(ACTIVE_TREE)));
+    }
+    EXPECT_TRUE(unique_tiles.insert(tile).second);
+    last_tile = tile;
+  }
+
+  EXPECT_EQ(all_tiles.size(), unique_tiles.size());
+  EXPECT_TRUE(have_tiles[TilePriority::NOW]);
+  EXPECT_TRUE(have_tiles[TilePriority::SOON]);
+  EXPECT_TRUE(have_tiles[TilePriority::EVENTUALLY]);
+}
+
+TEST(PictureLayerTilingTest, OccludedVisibleTilesAreRasteredLast) {
+  FakePictureLayerTilingClient client;
+  client.SetTileSize(gfx::Size(100, 100));
+  // Hides the left column of visible tiles.
+  client.set_occluded_layer_rect(gfx::Rect(0, 0, 110, 200));
+  scoped_ptr<TestablePictureLayerTiling> tiling =
+      TestablePictureLayerTiling::Create(1.0f, gfx::Size(1000, 1000), &client);
+
+  tiling->UpdateTilePriorities(
+      ACTIVE_TREE, gfx::Rect(0, 0, 200, 200), 1.f, 1.0);
+
+  Tile* occluded_tile = tiling->TileAt(0, 0);
+  Tile* visible_tile = tiling->TileAt(1, 0);
+  ASSERT_TRUE(occluded_tile);
+  ASSERT_TRUE(visible_tile);
+  EXPECT_TRUE(occluded_tile->is_occluded(ACTIVE_TREE));
+  EXPECT_EQ(TilePriority::EVENTUALLY,
+            occluded_tile->priority(ACTIVE_TREE).priority_bin);
+  EXPECT_FALSE(visible_tile->is_occluded(ACTIVE_TREE));
+  EXPECT_EQ(TilePriority::NOW,
+            visible_tile->priority(ACTIVE_TREE).priority_bin);
+
+  std::vector<Tile*> all_tiles = tiling->AllTilesForTesting();
+  size_t tile_count = 0;
+  Tile* last_tile = NULL;
+  for (PictureLayerTiling::TilingRasterTileIterator it(tiling.get(),
+                                                       ACTIVE_TREE);
+       it;
+       ++it) {
+    if (tile_count == 0)
+      EXPECT_FALSE(it->is_occluded(ACTIVE_TREE));
+    last_tile = *it;
+    ++tile_count;
+  }
+  EXPECT_EQ(all_tiles.size(), tile_count);
+  ASSERT_TRUE(last_tile);
+  EXPECT_TRUE(last_tile->is_occluded(ACTIVE_TREE));
+
+  // Once nothing covers them, the tiles are visible again.
+  client.set_occluded_layer_rect(gfx::Rect());
+  tiling->UpdateTilePriorities(
+      ACTIVE_TREE, gfx::Rect(0, 0, 200, 200), 1.f, 2.0);
+  EXPECT_FALSE(occluded_tile->is_occluded(ACTIVE_TREE));
+  EXPECT_EQ(TilePriority::NOW,
+            occluded_tile->priority(ACTIVE_TREE).priority_bin);
+}
+
 }  // namespace
 }  // namespace cc
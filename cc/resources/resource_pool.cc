@@ -9,6 +9,8 @@
 
 namespace cc {
 
+const float ResourcePool::kMaxWastedAreaRatio = 0.25f;
+
 ResourcePool::ResourcePool(ResourceProvider* resource_provider,
                            GLenum target,
                            ResourceFormat format)
@@ -36,17 +38,38 @@ ResourcePool::~ResourcePool() {
 }
 
 scoped_ptr<ScopedResource> ResourcePool::AcquireResource(
-    const gfx::Size& size) {
-  for (ResourceList::iterator it = unused_resources_.begin();
+    const gfx::Size& size,
+    bool exact_size) {
+  int64 area = static_cast<int64>(size.width()) * size.height();
+  UnusedResourceList::iterator best = unused_resources_.end();
+  int64 best_area = 0;
+  for (UnusedResourceList::iterator it = unused_resources_.begin();
        it != unused_resources_.end();
        ++it) {
-    ScopedResource* resource = *it;
+    ScopedResource* resource = it->resource;
     DCHECK(resource_provider_->CanLockForWrite(resource->id()));
 
-    if (resource->size() != size)
+    if (resource->size() == size) {
+      best = it;
+      break;
+    }
+    if (exact_size || resource->size().width() < size.width() ||
+        resource->size().height() < size.height())
       continue;
 
-    unused_resources_.erase(it);
+    int64 resource_area = static_cast<int64>(resource->size().width()) *
+                          resource->size().height();
+    if (area < resource_area * (1.f - kMaxWastedAreaRatio))
+      continue;
+    if (best == unused_resources_.end() || resource_area < best_area) {
+      best = it;
+      best_area = resource_area;
+    }
+  }
+
+  if (best != unused_resources_.end()) {
+    ScopedResource* resource = best->resource;
+    unused_resources_.erase(best);
     unused_memory_usage_bytes_ -= resource->bytes();
     return make_scoped_ptr(resource);
   }
@@ -92,12 +115,21 @@ void ResourcePool::ReduceResourceUsage() {
     // can't be locked for write might also not be truly free-able.
     // We can free the resource here but it doesn't mean that the
     // memory is necessarily returned to the OS.
-    ScopedResource* resource = unused_resources_.front();
+    ScopedResource* resource = unused_resources_.front().resource;
     unused_resources_.pop_front();
-    memory_usage_bytes_ -= resource->bytes();
-    unused_memory_usage_bytes_ -= resource->bytes();
-    --resource_count_;
-    delete resource;
+    DeleteUnusedResource(resource);
+  }
+}
+
+void ResourcePool::ReleaseIdleResources(base::TimeTicks now,
+                                        base::TimeDelta max_idle_time) {
+  while (!unused_resources_.empty()) {
+    if (now - unused_resources_.front().last_usage < max_idle_time)
+      break;
+
+    ScopedResource* resource = unused_resources_.front().resource;
+    unused_resources_.pop_front();
+    DeleteUnusedResource(resource);
   }
 }
 
@@ -128,7 +160,15 @@ void ResourcePool::CheckBusyResources() {
 
 void ResourcePool::DidFinishUsingResource(ScopedResource* resource) {
   unused_memory_usage_bytes_ += resource->bytes();
-  unused_resources_.push_back(resource);
+  unused_resources_.push_back(
+      UnusedResource(resource, base::TimeTicks::Now()));
+}
+
+void ResourcePool::DeleteUnusedResource(ScopedResource* resource) {
+  memory_usage_bytes_ -= resource->bytes();
+  unused_memory_usage_bytes_ -= resource->bytes();
+  --resource_count_;
+  delete resource;
 }
 
 }  // namespace cc
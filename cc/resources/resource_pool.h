@@ -8,6 +8,7 @@
 #include <list>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
 #include "cc/base/cc_export.h"
 #include "cc/output/renderer.h"
 #include "cc/resources/resource.h"
@@ -26,7 +27,13 @@ class CC_EXPORT ResourcePool {
 
   virtual ~ResourcePool();
 
-  scoped_ptr<ScopedResource> AcquireResource(const gfx::Size& size);
+  // Returns an unused resource of exactly |size| if there is one. Otherwise,
+  // unless |exact_size| is set, returns the smallest unused resource that
+  // covers |size| without wasting more than kMaxWastedAreaRatio of its area,
+  // and only allocates a new resource if there is none. Callers must only
+  // use the |size| part at the origin of a larger resource.
+  scoped_ptr<ScopedResource> AcquireResource(const gfx::Size& size,
+                                             bool exact_size);
   void ReleaseResource(scoped_ptr<ScopedResource>);
 
   void SetResourceUsageLimits(size_t max_memory_usage_bytes,
@@ -34,6 +41,9 @@ class CC_EXPORT ResourcePool {
                               size_t max_resource_count);
 
   void ReduceResourceUsage();
+  // Frees the unused resources that haven't been reused for at least
+  // |max_idle_time| as of |now|, even when usage is within the limits.
+  void ReleaseIdleResources(base::TimeTicks now, base::TimeDelta max_idle_time);
   void CheckBusyResources();
 
   size_t total_memory_usage_bytes() const { return memory_usage_bytes_; }
@@ -43,6 +53,11 @@ class CC_EXPORT ResourcePool {
   size_t acquired_resource_count() const {
     return resource_count_ - unused_resources_.size();
   }
+  size_t unused_resource_count() const { return unused_resources_.size(); }
+
+  // A larger resource is only handed out for a smaller size when no more than
+  // this part of its area goes unused.
+  static const float kMaxWastedAreaRatio;
 
  protected:
   ResourcePool(ResourceProvider* resource_provider,
@@ -52,7 +67,16 @@ class CC_EXPORT ResourcePool {
   bool ResourceUsageTooHigh();
 
  private:
+  struct UnusedResource {
+    UnusedResource(ScopedResource* resource, base::TimeTicks last_usage)
+        : resource(resource), last_usage(last_usage) {}
+
+    ScopedResource* resource;
+    base::TimeTicks last_usage;
+  };
+
   void DidFinishUsingResource(ScopedResource* resource);
+  void DeleteUnusedResource(ScopedResource* resource);
 
   ResourceProvider* resource_provider_;
   const GLenum target_;
@@ -64,8 +88,10 @@ class CC_EXPORT ResourcePool {
   size_t unused_memory_usage_bytes_;
   size_t resource_count_;
 
+  // Least recently used first.
+  typedef std::list<UnusedResource> UnusedResourceList;
+  UnusedResourceList unused_resources_;
   typedef std::list<ScopedResource*> ResourceList;
-  ResourceList unused_resources_;
   ResourceList busy_resources_;
 
   DISALLOW_COPY_AND_ASSIGN(ResourcePool);
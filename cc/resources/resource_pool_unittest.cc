@@ -0,0 +1,118 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/resources/resource_pool.h"
+
+#include <limits>
+
+#include "cc/resources/resource_provider.h"
+#include "cc/resources/scoped_resource.h"
+#include "cc/test/fake_output_surface.h"
+#include "cc/test/fake_output_surface_client.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/khronos/GLES2/gl2.h"
+
+namespace cc {
+namespace {
+
+class ResourcePoolTest : public testing::Test {
+ public:
+  virtual void SetUp() OVERRIDE {
+    output_surface_ = FakeOutputSurface::Create3d();
+    CHECK(output_surface_->BindToClient(&output_surface_client_));
+    resource_provider_ =
+        ResourceProvider::Create(output_surface_.get(), NULL, 0, false, 1);
+    resource_pool_ = ResourcePool::Create(
+        resource_provider_.get(), GL_TEXTURE_2D, RGBA_8888);
+    resource_pool_->SetResourceUsageLimits(
+        std::numeric_limits<size_t>::max(),
+        std::numeric_limits<size_t>::max(),
+        std::numeric_limits<size_t>::max());
+  }
+
+  virtual void TearDown() OVERRIDE {
+    resource_pool_.reset();
+    resource_provider_.reset();
+    output_surface_.reset();
+  }
+
+ protected:
+  // Returns |resource| to the pool and makes it available for reuse.
+  void Recycle(scoped_ptr<ScopedResource> resource) {
+    resource_pool_->ReleaseResource(resource.Pass());
+    resource_pool_->CheckBusyResources();
+  }
+
+  FakeOutputSurfaceClient output_surface_client_;
+  scoped_ptr<OutputSurface> output_surface_;
+  scoped_ptr<ResourceProvider> resource_provider_;
+  scoped_ptr<ResourcePool> resource_pool_;
+};
+
+TEST_F(ResourcePoolTest, ReusesLargerResourceWithinWasteLimit) {
+  scoped_ptr<ScopedResource> resource =
+      resource_pool_->AcquireResource(gfx::Size(64, 64), false);
+  ResourceProvider::ResourceId id = resource->id();
+  Recycle(resource.Pass());
+
+  // Little enough of the resource goes unused.
+  resource = resource_pool_->AcquireResource(gfx::Size(64, 56), false);
+  EXPECT_EQ(id, resource->id());
+  EXPECT_EQ(gfx::Size(64, 64), resource->size());
+  Recycle(resource.Pass());
+
+  // Too much of the resource would go unused.
+  resource = resource_pool_->AcquireResource(gfx::Size(32, 32), false);
+  EXPECT_NE(id, resource->id());
+  EXPECT_EQ(gfx::Size(32, 32), resource->size());
+  Recycle(resource.Pass());
+
+  // Only an exact size is allowed.
+  resource = resource_pool_->AcquireResource(gfx::Size(64, 56), true);
+  EXPECT_NE(id, resource->id());
+  EXPECT_EQ(gfx::Size(64, 56), resource->size());
+  Recycle(resource.Pass());
+
+  EXPECT_EQ(3u, resource_pool_->unused_resource_count());
+}
+
+TEST_F(ResourcePoolTest, PrefersExactThenSmallestResource) {
+  scoped_ptr<ScopedResource> large =
+      resource_pool_->AcquireResource(gfx::Size(64, 64), false);
+  scoped_ptr<ScopedResource> medium =
+      resource_pool_->AcquireResource(gfx::Size(64, 60), false);
+  scoped_ptr<ScopedResource> exact =
+      resource_pool_->AcquireResource(gfx::Size(64, 56), false);
+  ResourceProvider::ResourceId medium_id = medium->id();
+  ResourceProvider::ResourceId exact_id = exact->id();
+  Recycle(large.Pass());
+  Recycle(medium.Pass());
+  Recycle(exact.Pass());
+
+  scoped_ptr<ScopedResource> resource =
+      resource_pool_->AcquireResource(gfx::Size(64, 56), false);
+  EXPECT_EQ(exact_id, resource->id());
+  Recycle(resource.Pass());
+
+  resource = resource_pool_->AcquireResource(gfx::Size(60, 56), false);
+  EXPECT_EQ(medium_id, resource->id());
+  Recycle(resource.Pass());
+}
+
+TEST_F(ResourcePoolTest, ReleasesIdleResources) {
+  Recycle(resource_pool_->AcquireResource(gfx::Size(64, 64), false));
+  EXPECT_EQ(1u, resource_pool_->unused_resource_count());
+
+  base::TimeDelta max_idle_time = base::TimeDelta::FromSeconds(1);
+  base::TimeTicks now = base::TimeTicks::Now();
+  resource_pool_->ReleaseIdleResources(now, max_idle_time);
+  EXPECT_EQ(1u, resource_pool_->unused_resource_count());
+
+  resource_pool_->ReleaseIdleResources(now + 2 * max_idle_time, max_idle_time);
+  EXPECT_EQ(0u, resource_pool_->unused_resource_count());
+  EXPECT_EQ(0u, resource_pool_->total_memory_usage_bytes());
+}
+
+}  // namespace
+}  // namespace cc
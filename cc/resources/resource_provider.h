@@ -293,6 +293,7 @@ class CC_EXPORT ResourceProvider {
     ~ScopedWriteLockSoftware();
 
     SkCanvas* sk_canvas() { return sk_canvas_.get(); }
+    SkBitmap* sk_bitmap() { return &sk_bitmap_; }
     bool valid() const { return !!sk_bitmap_.getPixels(); }
 
    private:
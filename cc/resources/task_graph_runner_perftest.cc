@@ -211,6 +211,52 @@ class TaskGraphRunnerPerfTest : public testing::Test {
                            true);
   }
 
+  // Same as above, but with the tasks run by |num_workers| worker threads
+  // instead of the test thread.
+  void RunExecuteTasksOnWorkersTest(const std::string& test_name,
+                                    size_t num_workers,
+                                    int num_top_level_tasks,
+                                    int num_tasks,
+                                    int num_leaf_tasks) {
+    internal::TaskGraphRunner task_graph_runner(num_workers, "PerfTest");
+    internal::NamespaceToken namespace_token =
+        task_graph_runner.GetNamespaceToken();
+
+    PerfTaskImpl::Vector top_level_tasks;
+    PerfTaskImpl::Vector tasks;
+    PerfTaskImpl::Vector leaf_tasks;
+    CreateTasks(num_top_level_tasks, &top_level_tasks);
+    CreateTasks(num_tasks, &tasks);
+    CreateTasks(num_leaf_tasks, &leaf_tasks);
+
+    // Avoid unnecessary heap allocations by reusing the same graph and
+    // completed tasks vector.
+    internal::TaskGraph graph;
+    internal::Task::Vector completed_tasks;
+
+    timer_.Reset();
+    do {
+      graph.Reset();
+      BuildTaskGraph(top_level_tasks, tasks, leaf_tasks, &graph);
+      task_graph_runner.SetTaskGraph(namespace_token, &graph);
+      task_graph_runner.WaitForTasksToFinishRunning(namespace_token);
+      task_graph_runner.CollectCompletedTasks(namespace_token,
+                                              &completed_tasks);
+      completed_tasks.clear();
+      ResetTasks(&top_level_tasks);
+      ResetTasks(&tasks);
+      ResetTasks(&leaf_tasks);
+      timer_.NextLap();
+    } while (!timer_.HasTimeLimitExpired());
+
+    perf_test::PrintResult("execute_tasks_on_workers",
+                           TestModifierString(),
+                           test_name,
+                           timer_.LapsPerSecond(),
+                           "runs/s",
+                           true);
+  }
+
  private:
   static std::string TestModifierString() {
     return std::string("_task_graph_runner");
@@ -320,5 +366,14 @@ TEST_F(TaskGraphRunnerPerfTest, ScheduleAndExecuteTasks) {
   RunScheduleAndExecuteTasksTest("2_32_1", 2, 32, 1);
 }
 
+TEST_F(TaskGraphRunnerPerfTest, ExecuteTasksOnWorkers) {
+  RunExecuteTasksOnWorkersTest("4_0_256_0", 4, 0, 256, 0);
+  RunExecuteTasksOnWorkersTest("8_0_256_0", 8, 0, 256, 0);
+  RunExecuteTasksOnWorkersTest("16_0_256_0", 16, 0, 256, 0);
+  RunExecuteTasksOnWorkersTest("4_2_256_1", 4, 2, 256, 1);
+  RunExecuteTasksOnWorkersTest("8_2_256_1", 8, 2, 256, 1);
+  RunExecuteTasksOnWorkersTest("16_2_256_1", 16, 2, 256, 1);
+}
+
 }  // namespace
 }  // namespace cc
@@ -33,6 +33,8 @@ Tile::Tile(TileManager* tile_manager,
     flags_(flags),
     id_(s_next_id_++) {
   set_picture_pile(picture_pile);
+  for (int i = 0; i < NUM_TREES; ++i)
+    is_occluded_[i] = false;
 }
 
 Tile::~Tile() {
@@ -68,6 +70,8 @@ scoped_ptr<base::Value> Tile::AsValue() const {
   res->SetInteger("layer_id", layer_id_);
   res->Set("active_priority", priority_[ACTIVE_TREE].AsValue().release());
   res->Set("pending_priority", priority_[PENDING_TREE].AsValue().release());
+  res->SetBoolean("is_occluded_on_active", is_occluded_[ACTIVE_TREE]);
+  res->SetBoolean("is_occluded_on_pending", is_occluded_[PENDING_TREE]);
   res->Set("managed_state", managed_state_.AsValue().release());
   res->SetBoolean("can_use_lcd_text", can_use_lcd_text());
   res->SetBoolean("use_gpu_rasterization", use_gpu_rasterization());
@@ -23,7 +23,10 @@ class CC_EXPORT Tile : public RefCountedManaged<Tile> {
  public:
   enum TileRasterFlags {
     USE_LCD_TEXT = 1 << 0,
-    USE_GPU_RASTERIZATION = 1 << 1
+    USE_GPU_RASTERIZATION = 1 << 1,
+    // The tile's resource is used as a whole, as for masks, so it can't be a
+    // larger pooled resource of which only a part is rastered.
+    REQUIRES_EXACT_SIZE_RESOURCE = 1 << 2
   };
 
   typedef uint64 Id;
@@ -57,6 +60,14 @@ class CC_EXPORT Tile : public RefCountedManaged<Tile> {
     return priority_[PENDING_TREE].required_for_activation;
   }
 
+  // Whether the visible part of the tile is hidden by opaque layers above it
+  // on |tree|, as of the last UpdateTilePriorities().
+  void set_is_occluded(WhichTree tree, bool is_occluded) {
+    is_occluded_[tree] = is_occluded;
+  }
+
+  bool is_occluded(WhichTree tree) const { return is_occluded_[tree]; }
+
   void set_can_use_lcd_text(bool can_use_lcd_text) {
     if (can_use_lcd_text)
       flags_ |= USE_LCD_TEXT;
@@ -79,6 +90,10 @@ class CC_EXPORT Tile : public RefCountedManaged<Tile> {
     return !!(flags_ & USE_GPU_RASTERIZATION);
   }
 
+  bool requires_exact_size_resource() const {
+    return !!(flags_ & REQUIRES_EXACT_SIZE_RESOURCE);
+  }
+
   scoped_ptr<base::Value> AsValue() const;
 
   inline bool IsReadyToDraw() const {
@@ -89,6 +104,14 @@ class CC_EXPORT Tile : public RefCountedManaged<Tile> {
     return false;
   }
 
+  inline bool HasResources() const {
+    for (int mode = 0; mode < NUM_RASTER_MODES; ++mode) {
+      if (managed_state_.tile_versions[mode].resource_)
+        return true;
+    }
+    return false;
+  }
+
   const ManagedTileState::TileVersion& GetTileVersionForDrawing() const {
     for (int mode = 0; mode < NUM_RASTER_MODES; ++mode) {
       if (managed_state_.tile_versions[mode].IsReadyToDraw())
@@ -155,6 +178,7 @@ class CC_EXPORT Tile : public RefCountedManaged<Tile> {
   gfx::Rect opaque_rect_;
 
   TilePriority priority_[NUM_TREES];
+  bool is_occluded_[NUM_TREES];
   ManagedTileState managed_state_;
   int layer_id_;
   int source_frame_number_;
@@ -23,6 +23,11 @@
 namespace cc {
 namespace {
 
+// Unused resources that haven't been reused for this long are released even
+// when memory usage is within limits, as they are unlikely to fit the tiles
+// that need resources anymore.
+const int kMaxResourceIdleTimeMs = 1000;
+
 // Memory limit policy works by mapping some bin states to the NEVER bin.
 const ManagedTileBin kBinPolicyMap[NUM_TILE_MEMORY_LIMIT_POLICIES][NUM_BINS] = {
     // [ALLOW_NOTHING]
@@ -130,6 +135,79 @@ inline ManagedTileBin BinFromTilePriority(const TilePriority& prio) {
   return EVENTUALLY_BIN;
 }
 
+// Returns true if |a|, from a tiling on |a_tree|, should be rasterized before
+// |b|, from a tiling on |b_tree|. Like the bins, this puts all of the tiles of
+// the tree that takes priority first.
+bool RasterBefore(TreePriority tree_priority,
+                  const Tile* a,
+                  WhichTree a_tree,
+                  const Tile* b,
+                  WhichTree b_tree) {
+  if (a_tree != b_tree) {
+    if (tree_priority == SMOOTHNESS_TAKES_PRIORITY)
+      return a_tree == ACTIVE_TREE;
+    if (tree_priority == NEW_CONTENT_TAKES_PRIORITY)
+      return a_tree == PENDING_TREE;
+  }
+
+  const TilePriority& a_priority = a->priority(a_tree);
+  const TilePriority& b_priority = b->priority(b_tree);
+  if (a_priority.priority_bin != b_priority.priority_bin)
+    return a_priority.priority_bin < b_priority.priority_bin;
+  if (a_priority.required_for_activation != b_priority.required_for_activation)
+    return a_priority.required_for_activation;
+  if (a_priority.resolution != b_priority.resolution)
+    return a_priority.resolution < b_priority.resolution;
+  return a_priority.distance_to_visible < b_priority.distance_to_visible;
+}
+
+// Orders indices into a vector of tiling iterators by their current tiles,
+// for a heap with the tile to rasterize first on top.
+template <typename TilingIterator>
+class RasterOrderComparator {
+ public:
+  RasterOrderComparator(TreePriority tree_priority,
+                        const std::vector<TilingIterator>* iterators)
+      : tree_priority_(tree_priority), iterators_(iterators) {}
+
+  bool operator()(size_t a, size_t b) const {
+    const TilingIterator& a_iterator = (*iterators_)[a];
+    const TilingIterator& b_iterator = (*iterators_)[b];
+    return RasterBefore(tree_priority_,
+                        *b_iterator,
+                        b_iterator.tree(),
+                        *a_iterator,
+                        a_iterator.tree());
+  }
+
+ private:
+  TreePriority tree_priority_;
+  const std::vector<TilingIterator>* iterators_;
+};
+
+// Same as above, with the tile to evict first on top.
+template <typename TilingIterator>
+class EvictionOrderComparator {
+ public:
+  EvictionOrderComparator(TreePriority tree_priority,
+                          const std::vector<TilingIterator>* iterators)
+      : tree_priority_(tree_priority), iterators_(iterators) {}
+
+  bool operator()(size_t a, size_t b) const {
+    const TilingIterator& a_iterator = (*iterators_)[a];
+    const TilingIterator& b_iterator = (*iterators_)[b];
+    return RasterBefore(tree_priority_,
+                        *a_iterator,
+                        a_iterator.tree(),
+                        *b_iterator,
+                        b_iterator.tree());
+  }
+
+ private:
+  TreePriority tree_priority_;
+  const std::vector<TilingIterator>* iterators_;
+};
+
 }  // namespace
 
 RasterTaskCompletionStats::RasterTaskCompletionStats()
@@ -197,6 +275,7 @@ TileManager::TileManager(
       rendering_stats_instrumentation_(rendering_stats_instrumentation),
       did_initialize_visible_tile_(false),
       did_check_for_completed_tasks_since_last_schedule_tasks_(true),
+      image_decode_cache_(rendering_stats_instrumentation),
       use_rasterize_on_demand_(use_rasterize_on_demand) {
   RasterWorkerPool* raster_worker_pools[NUM_RASTER_WORKER_POOL_TYPES] = {
       raster_worker_pool_.get(),        // RASTER_WORKER_POOL_TYPE_DEFAULT
@@ -250,14 +329,6 @@ void TileManager::CleanUpReleasedTiles() {
     DCHECK(tiles_.find(tile->id()) != tiles_.end());
     tiles_.erase(tile->id());
 
-    LayerCountMap::iterator layer_it =
-        used_layer_counts_.find(tile->layer_id());
-    DCHECK_GT(layer_it->second, 0);
-    if (--layer_it->second == 0) {
-      used_layer_counts_.erase(layer_it);
-      image_decode_tasks_.erase(tile->layer_id());
-    }
-
     delete tile;
   }
 
@@ -601,6 +672,14 @@ void TileManager::AssignGpuMemoryToTiles(
   // invalidate when releasing some resource from the pool.
   resource_pool_->CheckBusyResources();
 
+  // Decoded images share the budget with tiles. Keep only the images that fit
+  // next to the tiles we already have, and count what is left, mostly images
+  // that pending raster tasks need, against the memory for new tiles.
+  image_decode_cache_.ReduceMemoryUsage(static_cast<size_t>(std::max(
+      static_cast<int64>(0),
+      static_cast<int64>(global_state_.soft_memory_limit_in_bytes) -
+          static_cast<int64>(resource_pool_->acquired_memory_usage_bytes()))));
+
   // Now give memory out to the tiles until we're out, and build
   // the needs-to-be-rasterized queue.
   all_tiles_that_need_to_be_rasterized_have_memory_ = true;
@@ -610,11 +689,13 @@ void TileManager::AssignGpuMemoryToTiles(
   int64 soft_bytes_available =
       static_cast<int64>(bytes_releasable_) +
       static_cast<int64>(global_state_.soft_memory_limit_in_bytes) -
-      static_cast<int64>(resource_pool_->acquired_memory_usage_bytes());
+      static_cast<int64>(resource_pool_->acquired_memory_usage_bytes()) -
+      static_cast<int64>(image_decode_cache_.memory_usage_bytes());
   int64 hard_bytes_available =
       static_cast<int64>(bytes_releasable_) +
       static_cast<int64>(global_state_.hard_memory_limit_in_bytes) -
-      static_cast<int64>(resource_pool_->acquired_memory_usage_bytes());
+      static_cast<int64>(resource_pool_->acquired_memory_usage_bytes()) -
+      static_cast<int64>(image_decode_cache_.memory_usage_bytes());
   int resources_available = resources_releasable_ +
                             global_state_.num_resources_limit -
                             resource_pool_->acquired_resource_count();
@@ -833,6 +914,9 @@ void TileManager::ScheduleTasks(
 
   // We must reduce the amount of unused resoruces before calling
   // ScheduleTasks to prevent usage from rising above limits.
+  resource_pool_->ReleaseIdleResources(
+      base::TimeTicks::Now(),
+      base::TimeDelta::FromMilliseconds(kMaxResourceIdleTimeMs));
   resource_pool_->ReduceResourceUsage();
 
   // Schedule running of |raster_tasks_|. This replaces any previously
@@ -843,49 +927,31 @@ void TileManager::ScheduleTasks(
   did_check_for_completed_tasks_since_last_schedule_tasks_ = false;
 }
 
-scoped_refptr<internal::WorkerPoolTask> TileManager::CreateImageDecodeTask(
-    Tile* tile,
-    SkPixelRef* pixel_ref) {
-  return RasterWorkerPool::CreateImageDecodeTask(
-      pixel_ref,
-      tile->layer_id(),
-      rendering_stats_instrumentation_,
-      base::Bind(&TileManager::OnImageDecodeTaskCompleted,
-                 base::Unretained(this),
-                 tile->layer_id(),
-                 base::Unretained(pixel_ref)));
-}
-
 scoped_refptr<internal::RasterWorkerPoolTask> TileManager::CreateRasterTask(
     Tile* tile) {
   ManagedTileState& mts = tile->managed_state();
 
-  scoped_ptr<ScopedResource> resource =
-      resource_pool_->AcquireResource(tile->tile_size_.size());
+  scoped_ptr<ScopedResource> resource = resource_pool_->AcquireResource(
+      tile->tile_size_.size(), tile->requires_exact_size_resource());
   const ScopedResource* const_resource = resource.get();
 
-  // Create and queue all image decode tasks that this tile depends on.
+  // Pin all images that this tile draws until the raster task completes, and
+  // queue the decode tasks of those that aren't decoded yet.
   internal::WorkerPoolTask::Vector decode_tasks;
-  PixelRefTaskMap& existing_pixel_refs = image_decode_tasks_[tile->layer_id()];
+  std::vector<uint32_t> pixel_ref_ids;
   for (PicturePileImpl::PixelRefIterator iter(
            tile->content_rect(), tile->contents_scale(), tile->picture_pile());
        iter;
        ++iter) {
     SkPixelRef* pixel_ref = *iter;
-    uint32_t id = pixel_ref->getGenerationID();
-
-    // Append existing image decode task if available.
-    PixelRefTaskMap::iterator decode_task_it = existing_pixel_refs.find(id);
-    if (decode_task_it != existing_pixel_refs.end()) {
-      decode_tasks.push_back(decode_task_it->second);
-      continue;
-    }
+    pixel_ref_ids.push_back(pixel_ref->getGenerationID());
 
-    // Create and append new image decode task for this pixel ref.
     scoped_refptr<internal::WorkerPoolTask> decode_task =
-        CreateImageDecodeTask(tile, pixel_ref);
-    decode_tasks.push_back(decode_task);
-    existing_pixel_refs[id] = decode_task;
+        image_decode_cache_.RefImage(pixel_ref, tile->layer_id(), mts.bin);
+    if (decode_task &&
+        std::find(decode_tasks.begin(), decode_tasks.end(), decode_task) ==
+            decode_tasks.end())
+      decode_tasks.push_back(decode_task);
   }
 
   return RasterWorkerPool::CreateRasterTask(
@@ -903,38 +969,24 @@ scoped_refptr<internal::RasterWorkerPoolTask> TileManager::CreateRasterTask(
                  base::Unretained(this),
                  tile->id(),
                  base::Passed(&resource),
-                 mts.raster_mode),
+                 mts.raster_mode,
+                 pixel_ref_ids),
       &decode_tasks,
       context_provider_);
 }
 
-void TileManager::OnImageDecodeTaskCompleted(int layer_id,
-                                             SkPixelRef* pixel_ref,
-                                             bool was_canceled) {
-  // If the task was canceled, we need to clean it up
-  // from |image_decode_tasks_|.
-  if (!was_canceled)
-    return;
-
-  LayerPixelRefTaskMap::iterator layer_it = image_decode_tasks_.find(layer_id);
-
-  if (layer_it == image_decode_tasks_.end())
-    return;
-
-  PixelRefTaskMap& pixel_ref_tasks = layer_it->second;
-  PixelRefTaskMap::iterator task_it =
-      pixel_ref_tasks.find(pixel_ref->getGenerationID());
-
-  if (task_it != pixel_ref_tasks.end())
-    pixel_ref_tasks.erase(task_it);
-}
-
 void TileManager::OnRasterTaskCompleted(
     Tile::Id tile_id,
     scoped_ptr<ScopedResource> resource,
     RasterMode raster_mode,
+    const std::vector<uint32_t>& pixel_ref_ids,
     const PicturePileImpl::Analysis& analysis,
     bool was_canceled) {
+  for (std::vector<uint32_t>::const_iterator id_it = pixel_ref_ids.begin();
+       id_it != pixel_ref_ids.end();
+       ++id_it)
+    image_decode_cache_.UnrefImage(*id_it);
+
   TileMap::iterator it = tiles_.find(tile_id);
   if (it == tiles_.end()) {
     ++update_visible_tiles_stats_.canceled_count;
@@ -993,9 +1045,139 @@ scoped_refptr<Tile> TileManager::CreateTile(PicturePileImpl* picture_pile,
   DCHECK(tiles_.find(tile->id()) == tiles_.end());
 
   tiles_[tile->id()] = tile;
-  used_layer_counts_[tile->layer_id()]++;
   prioritized_tiles_dirty_ = true;
   return tile;
 }
 
+TileManager::RasterTileIterator::RasterTileIterator(TileManager* tile_manager,
+                                                   TreePriority tree_priority)
+    : tree_priority_(tree_priority), current_tile_(NULL) {
+  for (int tree = 0; tree < NUM_TREES; ++tree) {
+    std::vector<PictureLayerTiling*> tilings;
+    tile_manager->client_->GetPictureLayerTilings(static_cast<WhichTree>(tree),
+                                                  &tilings);
+    for (size_t i = 0; i < tilings.size(); ++i) {
+      PictureLayerTiling::TilingRasterTileIterator it(
+          tilings[i], static_cast<WhichTree>(tree));
+      if (it)
+        iterators_.push_back(it);
+    }
+  }
+
+  for (size_t i = 0; i < iterators_.size(); ++i)
+    heap_.push_back(i);
+  std::make_heap(heap_.begin(),
+                 heap_.end(),
+                 RasterOrderComparator<
+                     PictureLayerTiling::TilingRasterTileIterator>(
+                     tree_priority_, &iterators_));
+  AdvanceToNextTile();
+}
+
+TileManager::RasterTileIterator::~RasterTileIterator() {}
+
+TileManager::RasterTileIterator& TileManager::RasterTileIterator::operator++() {
+  DCHECK(current_tile_);
+  AdvanceToNextTile();
+  return *this;
+}
+
+void TileManager::RasterTileIterator::AdvanceToNextTile() {
+  RasterOrderComparator<PictureLayerTiling::TilingRasterTileIterator>
+      comparator(tree_priority_, &iterators_);
+  current_tile_ = NULL;
+  while (!heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end(), comparator);
+    PictureLayerTiling::TilingRasterTileIterator& it = iterators_[heap_.back()];
+    Tile* tile = *it;
+    WhichTree tree = it.tree();
+    ++it;
+    if (it)
+      std::push_heap(heap_.begin(), heap_.end(), comparator);
+    else
+      heap_.pop_back();
+
+    // Like the bins, never rasterize new non-ideal tiles, since high-res
+    // tiles cover the same content.
+    if (tile->priority(tree).resolution == NON_IDEAL_RESOLUTION)
+      continue;
+    if (tile->IsReadyToDraw())
+      continue;
+    if (!returned_tiles_.insert(tile).second)
+      continue;
+
+    current_tile_ = tile;
+    return;
+  }
+}
+
+TileManager::EvictionTileIterator::EvictionTileIterator(
+    TileManager* tile_manager,
+    TreePriority tree_priority)
+    : tree_priority_(tree_priority), current_tile_(NULL) {
+  for (int tree = 0; tree < NUM_TREES; ++tree) {
+    std::vector<PictureLayerTiling*> tilings;
+    tile_manager->client_->GetPictureLayerTilings(static_cast<WhichTree>(tree),
+                                                  &tilings);
+    for (size_t i = 0; i < tilings.size(); ++i) {
+      PictureLayerTiling::TilingEvictionTileIterator it(
+          tilings[i], static_cast<WhichTree>(tree));
+      if (!it)
+        continue;
+      iterators_.push_back(it);
+      for (; it; ++it)
+        tree_tiles_[tree].insert(*it);
+    }
+  }
+
+  for (size_t i = 0; i < iterators_.size(); ++i)
+    heap_.push_back(i);
+  std::make_heap(heap_.begin(),
+                 heap_.end(),
+                 EvictionOrderComparator<
+                     PictureLayerTiling::TilingEvictionTileIterator>(
+                     tree_priority_, &iterators_));
+  AdvanceToNextTile();
+}
+
+TileManager::EvictionTileIterator::~EvictionTileIterator() {}
+
+TileManager::EvictionTileIterator&
+TileManager::EvictionTileIterator::operator++() {
+  DCHECK(current_tile_);
+  AdvanceToNextTile();
+  return *this;
+}
+
+void TileManager::EvictionTileIterator::AdvanceToNextTile() {
+  EvictionOrderComparator<PictureLayerTiling::TilingEvictionTileIterator>
+      comparator(tree_priority_, &iterators_);
+  current_tile_ = NULL;
+  while (!heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end(), comparator);
+    PictureLayerTiling::TilingEvictionTileIterator& it =
+        iterators_[heap_.back()];
+    Tile* tile = *it;
+    WhichTree tree = it.tree();
+    ++it;
+    if (it)
+      std::push_heap(heap_.begin(), heap_.end(), comparator);
+    else
+      heap_.pop_back();
+
+    // Return a tile on both trees from the tree where it has the higher
+    // priority, or from the active tree if that is the same.
+    WhichTree other_tree = tree == ACTIVE_TREE ? PENDING_TREE : ACTIVE_TREE;
+    if (tree_tiles_[other_tree].count(tile) &&
+        !RasterBefore(tree_priority_, tile, tree, tile, other_tree) &&
+        (tree == PENDING_TREE ||
+         RasterBefore(tree_priority_, tile, other_tree, tile, tree))) {
+      continue;
+    }
+
+    current_tile_ = tile;
+    return;
+  }
+}
+
 }  // namespace cc
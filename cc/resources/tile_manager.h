@@ -14,20 +14,38 @@
 #include "base/values.h"
 #include "cc/base/ref_counted_managed.h"
 #include "cc/debug/rendering_stats_instrumentation.h"
+#include "cc/resources/image_decode_cache.h"
 #include "cc/resources/managed_tile_state.h"
 #include "cc/resources/memory_history.h"
+#include "cc/resources/picture_layer_tiling.h"
 #include "cc/resources/picture_pile_impl.h"
 #include "cc/resources/prioritized_tile_set.h"
 #include "cc/resources/raster_worker_pool.h"
 #include "cc/resources/resource_pool.h"
 #include "cc/resources/tile.h"
 
+#if defined(COMPILER_GCC)
+namespace BASE_HASH_NAMESPACE {
+template <> struct hash<cc::Tile*> {
+  size_t operator()(cc::Tile* ptr) const {
+    return hash<size_t>()(reinterpret_cast<size_t>(ptr));
+  }
+};
+}  // namespace BASE_HASH_NAMESPACE
+#endif  // COMPILER
+
 namespace cc {
 class RasterWorkerPoolDelegate;
 class ResourceProvider;
 
 class CC_EXPORT TileManagerClient {
  public:
+  // Appends the tilings of the picture layers on |tree| to |tilings|, for the
+  // raster and eviction tile iterators to take tiles from.
+  virtual void GetPictureLayerTilings(
+      WhichTree tree,
+      std::vector<PictureLayerTiling*>* tilings) const = 0;
+
   virtual void NotifyReadyToActivate() = 0;
 
  protected:
@@ -50,6 +68,68 @@ scoped_ptr<base::Value> RasterTaskCompletionStatsAsValue(
 class CC_EXPORT TileManager : public RasterWorkerPoolClient,
                               public RefCountedManager<Tile> {
  public:
+  // Iterates over the tiles of the client's tilings that need to be
+  // rasterized, highest priority for |tree_priority| first. Instead of binning
+  // and sorting every tile, it merges the priority ordered iterators of the
+  // tilings as it goes, so it only looks at about as many tiles as it is
+  // advanced over. Tilings must not change while the iterator is in use.
+  class CC_EXPORT RasterTileIterator {
+   public:
+    RasterTileIterator(TileManager* tile_manager, TreePriority tree_priority);
+    ~RasterTileIterator();
+
+    Tile* operator->() const { return current_tile_; }
+    Tile* operator*() const { return current_tile_; }
+
+    RasterTileIterator& operator++();
+    operator bool() const { return !!current_tile_; }
+
+   private:
+    void AdvanceToNextTile();
+
+    TreePriority tree_priority_;
+    std::vector<PictureLayerTiling::TilingRasterTileIterator> iterators_;
+    // Indices into |iterators_|, as a heap with the highest priority next
+    // tile on top.
+    std::vector<size_t> heap_;
+    // A tile shared by an active and a pending tiling comes up twice.
+    base::hash_set<Tile*> returned_tiles_;
+    Tile* current_tile_;
+
+    DISALLOW_COPY_AND_ASSIGN(RasterTileIterator);
+  };
+
+  // Iterates over the tiles of the client's tilings that have resources,
+  // lowest priority for |tree_priority| first, to find the tiles to take
+  // memory from.
+  class CC_EXPORT EvictionTileIterator {
+   public:
+    EvictionTileIterator(TileManager* tile_manager,
+                         TreePriority tree_priority);
+    ~EvictionTileIterator();
+
+    Tile* operator->() const { return current_tile_; }
+    Tile* operator*() const { return current_tile_; }
+
+    EvictionTileIterator& operator++();
+    operator bool() const { return !!current_tile_; }
+
+   private:
+    void AdvanceToNextTile();
+
+    TreePriority tree_priority_;
+    std::vector<PictureLayerTiling::TilingEvictionTileIterator> iterators_;
+    // Indices into |iterators_|, as a heap with the lowest priority next tile
+    // on top.
+    std::vector<size_t> heap_;
+    // The tiles of the tilings on each tree. A tile on both trees is returned
+    // where its priority is higher, so that it is evicted last.
+    base::hash_set<Tile*> tree_tiles_[NUM_TREES];
+    Tile* current_tile_;
+
+    DISALLOW_COPY_AND_ASSIGN(EvictionTileIterator);
+  };
+
   static scoped_ptr<TileManager> Create(
       TileManagerClient* client,
       ResourceProvider* resource_provider,
@@ -95,7 +175,8 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
       ManagedTileState::TileVersion& tile_version =
           mts.tile_versions[HIGH_QUALITY_NO_LCD_RASTER_MODE];
 
-      tile_version.resource_ = resource_pool_->AcquireResource(gfx::Size(1, 1));
+      tile_version.resource_ =
+          resource_pool_->AcquireResource(gfx::Size(1, 1), true);
 
       bytes_releasable_ += BytesConsumedIfAllocated(tiles[i]);
       ++resources_releasable_;
@@ -128,6 +209,8 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
 
   // Methods called by Tile
   friend class Tile;
+  friend class RasterTileIterator;
+  friend class EvictionTileIterator;
   void DidChangeTilePriority(Tile* tile);
 
   void CleanUpReleasedTiles();
@@ -158,12 +241,10 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
     NUM_RASTER_WORKER_POOL_TYPES
   };
 
-  void OnImageDecodeTaskCompleted(int layer_id,
-                                  SkPixelRef* pixel_ref,
-                                  bool was_canceled);
   void OnRasterTaskCompleted(Tile::Id tile,
                              scoped_ptr<ScopedResource> resource,
                              RasterMode raster_mode,
+                             const std::vector<uint32_t>& pixel_ref_ids,
                              const PicturePileImpl::Analysis& analysis,
                              bool was_canceled);
 
@@ -176,9 +257,6 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
   void FreeResourceForTile(Tile* tile, RasterMode mode);
   void FreeResourcesForTile(Tile* tile);
   void FreeUnusedResourcesForTile(Tile* tile);
-  scoped_refptr<internal::WorkerPoolTask> CreateImageDecodeTask(
-      Tile* tile,
-      SkPixelRef* pixel_ref);
   scoped_refptr<internal::RasterWorkerPoolTask> CreateRasterTask(Tile* tile);
   scoped_ptr<base::Value> GetMemoryRequirementsAsValue() const;
   void UpdatePrioritizedTileSetIfNeeded();
@@ -215,13 +293,7 @@ class CC_EXPORT TileManager : public RasterWorkerPoolClient,
   bool did_initialize_visible_tile_;
   bool did_check_for_completed_tasks_since_last_schedule_tasks_;
 
-  typedef base::hash_map<uint32_t, scoped_refptr<internal::WorkerPoolTask> >
-      PixelRefTaskMap;
-  typedef base::hash_map<int, PixelRefTaskMap> LayerPixelRefTaskMap;
-  LayerPixelRefTaskMap image_decode_tasks_;
-
-  typedef base::hash_map<int, int> LayerCountMap;
-  LayerCountMap used_layer_counts_;
+  ImageDecodeCache image_decode_cache_;
 
   RasterTaskCompletionStats update_visible_tiles_stats_;
 
@@ -2,10 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <set>
+
 #include "cc/resources/tile.h"
 #include "cc/resources/tile_priority.h"
 #include "cc/test/fake_output_surface.h"
 #include "cc/test/fake_output_surface_client.h"
+#include "cc/test/fake_picture_layer_tiling_client.h"
 #include "cc/test/fake_picture_pile_impl.h"
 #include "cc/test/fake_tile_manager.h"
 #include "cc/test/test_tile_priorities.h"
@@ -72,8 +75,18 @@ class TileManagerTest : public testing::TestWithParam<bool>,
   }
 
   // TileManagerClient implementation.
+  virtual void GetPictureLayerTilings(
+      WhichTree tree,
+      std::vector<PictureLayerTiling*>* tilings) const OVERRIDE {
+    tilings->insert(tilings->end(), tilings_[tree].begin(),
+                    tilings_[tree].end());
+  }
   virtual void NotifyReadyToActivate() OVERRIDE { ready_to_activate_ = true; }
 
+  void AddTiling(WhichTree tree, PictureLayerTiling* tiling) {
+    tilings_[tree].push_back(tiling);
+  }
+
   TileVector CreateTilesWithSize(int count,
                                  TilePriority active_priority,
                                  TilePriority pending_priority,
@@ -103,6 +116,7 @@ class TileManagerTest : public testing::TestWithParam<bool>,
   }
 
   FakeTileManager* tile_manager() { return tile_manager_.get(); }
+  ResourceProvider* resource_provider() { return resource_provider_.get(); }
 
   int AssignedMemoryCount(const TileVector& tiles) {
     int has_memory_count = 0;
@@ -144,6 +158,7 @@ class TileManagerTest : public testing::TestWithParam<bool>,
   TileMemoryLimitPolicy memory_limit_policy_;
   int max_tiles_;
   bool ready_to_activate_;
+  std::vector<PictureLayerTiling*> tilings_[NUM_TREES];
 };
 
 TEST_P(TileManagerTest, EnoughMemoryAllowAnything) {
@@ -620,6 +635,150 @@ TEST_P(TileManagerTest, PreventRasterizeOnDemand) {
     EXPECT_FALSE((*it)->IsReadyToDraw());
 }
 
+// An active and a pending tiling of a tall layer, scrolled apart so that they
+// share some of their tiles.
+class TwinTilings {
+ public:
+  explicit TwinTilings(ResourceProvider* resource_provider)
+      : active_client_(resource_provider), pending_client_(resource_provider) {
+    gfx::Size layer_bounds(1000, 10000);
+    active_client_.SetTileSize(gfx::Size(100, 100));
+    active_client_.set_max_tiles_for_interest_area(100);
+    active_tiling_ =
+        PictureLayerTiling::Create(1.0f, layer_bounds, &active_client_);
+    active_tiling_->set_resolution(HIGH_RESOLUTION);
+    active_tiling_->UpdateTilePriorities(
+        ACTIVE_TREE, gfx::Rect(0, 0, 1000, 500), 1.f, 1.0);
+
+    pending_client_.SetTileSize(gfx::Size(100, 100));
+    pending_client_.set_max_tiles_for_interest_area(100);
+    pending_client_.set_twin_tiling(active_tiling_.get());
+    pending_tiling_ =
+        PictureLayerTiling::Create(1.0f, layer_bounds, &pending_client_);
+    pending_tiling_->set_resolution(HIGH_RESOLUTION);
+    pending_tiling_->UpdateTilePriorities(
+        PENDING_TREE, gfx::Rect(0, 1000, 1000, 500), 1.f, 1.0);
+
+    std::vector<Tile*> tiles = active_tiling_->AllTilesForTesting();
+    active_tiles_.insert(tiles.begin(), tiles.end());
+    tiles = pending_tiling_->AllTilesForTesting();
+    pending_tiles_.insert(tiles.begin(), tiles.end());
+  }
+
+  // Gives every tile a resource from the tile manager that created it.
+  void InitializeTilesWithResources(ResourceProvider* resource_provider) {
+    std::vector<Tile*> pending_only_tiles;
+    for (std::set<Tile*>::iterator it = pending_tiles_.begin();
+         it != pending_tiles_.end();
+         ++it) {
+      if (!active_tiles_.count(*it))
+        pending_only_tiles.push_back(*it);
+    }
+    active_client_.tile_manager()->InitializeTilesWithResourcesForTesting(
+        active_tiling_->AllTilesForTesting(), resource_provider);
+    pending_client_.tile_manager()->InitializeTilesWithResourcesForTesting(
+        pending_only_tiles, resource_provider);
+  }
+
+  PictureLayerTiling* active_tiling() { return active_tiling_.get(); }
+  PictureLayerTiling* pending_tiling() { return pending_tiling_.get(); }
+  const std::set<Tile*>& active_tiles() const { return active_tiles_; }
+  const std::set<Tile*>& pending_tiles() const { return pending_tiles_; }
+
+ private:
+  FakePictureLayerTilingClient active_client_;
+  FakePictureLayerTilingClient pending_client_;
+  scoped_ptr<PictureLayerTiling> active_tiling_;
+  scoped_ptr<PictureLayerTiling> pending_tiling_;
+  std::set<Tile*> active_tiles_;
+  std::set<Tile*> pending_tiles_;
+};
+
+TEST_P(TileManagerTest, RasterTileIterator) {
+  Initialize(10, ALLOW_ANYTHING, SMOOTHNESS_TAKES_PRIORITY);
+  TwinTilings twin_tilings(resource_provider());
+  AddTiling(ACTIVE_TREE, twin_tilings.active_tiling());
+  AddTiling(PENDING_TREE, twin_tilings.pending_tiling());
+
+  const std::set<Tile*>& active_tiles = twin_tilings.active_tiles();
+  const std::set<Tile*>& pending_tiles = twin_tilings.pending_tiles();
+  std::set<Tile*> all_tiles(active_tiles);
+  all_tiles.insert(pending_tiles.begin(), pending_tiles.end());
+  // The tilings share some tiles, but not all.
+  EXPECT_LT(all_tiles.size(), active_tiles.size() + pending_tiles.size());
+  EXPECT_GT(all_tiles.size(), active_tiles.size());
+
+  // With smoothness taking priority, all of the active tiles come first.
+  std::set<Tile*> raster_tiles;
+  Tile* last_tile = NULL;
+  for (TileManager::RasterTileIterator it(tile_manager(),
+                                          SMOOTHNESS_TAKES_PRIORITY);
+       it;
+       ++it) {
+    Tile* tile = *it;
+    EXPECT_TRUE(raster_tiles.insert(tile).second);
+    if (last_tile && active_tiles.count(tile)) {
+      EXPECT_TRUE(active_tiles.count(last_tile));
+      EXPECT_FALSE(tile->priority(ACTIVE_TREE).IsHigherPriorityThan(
+          last_tile->priority(ACTIVE_TREE)));
+    }
+    last_tile = tile;
+  }
+  EXPECT_EQ(all_tiles, raster_tiles);
+
+  raster_tiles.clear();
+  for (TileManager::RasterTileIterator it(tile_manager(),
+                                          SAME_PRIORITY_FOR_BOTH_TREES);
+       it;
+       ++it) {
+    EXPECT_TRUE(raster_tiles.insert(*it).second);
+  }
+  EXPECT_EQ(all_tiles, raster_tiles);
+
+  // Tiles that are ready to draw don't need to be rasterized.
+  twin_tilings.InitializeTilesWithResources(resource_provider());
+  EXPECT_FALSE(TileManager::RasterTileIterator(tile_manager(),
+                                               SMOOTHNESS_TAKES_PRIORITY));
+}
+
+TEST_P(TileManagerTest, EvictionTileIterator) {
+  Initialize(10, ALLOW_ANYTHING, SMOOTHNESS_TAKES_PRIORITY);
+  TwinTilings twin_tilings(resource_provider());
+  AddTiling(ACTIVE_TREE, twin_tilings.active_tiling());
+  AddTiling(PENDING_TREE, twin_tilings.pending_tiling());
+
+  // Only tiles with resources can be evicted.
+  EXPECT_FALSE(TileManager::EvictionTileIterator(tile_manager(),
+                                                 SMOOTHNESS_TAKES_PRIORITY));
+
+  twin_tilings.InitializeTilesWithResources(resource_provider());
+  const std::set<Tile*>& active_tiles = twin_tilings.active_tiles();
+  std::set<Tile*> all_tiles(active_tiles);
+  all_tiles.insert(twin_tilings.pending_tiles().begin(),
+                   twin_tilings.pending_tiles().end());
+
+  // With smoothness taking priority, the pending tiles go first and the
+  // visible active tiles last.
+  std::set<Tile*> evicted_tiles;
+  Tile* last_tile = NULL;
+  for (TileManager::EvictionTileIterator it(tile_manager(),
+                                            SMOOTHNESS_TAKES_PRIORITY);
+       it;
+       ++it) {
+    Tile* tile = *it;
+    EXPECT_TRUE(evicted_tiles.insert(tile).second);
+    if (last_tile && active_tiles.count(last_tile)) {
+      EXPECT_TRUE(active_tiles.count(tile));
+      EXPECT_FALSE(last_tile->priority(ACTIVE_TREE).IsHigherPriorityThan(
+          tile->priority(ACTIVE_TREE)));
+    }
+    last_tile = tile;
+  }
+  EXPECT_EQ(all_tiles, evicted_tiles);
+  ASSERT_TRUE(last_tile);
+  EXPECT_EQ(TilePriority::NOW, last_tile->priority(ACTIVE_TREE).priority_bin);
+}
+
 // If true, the max tile limit should be applied as bytes; if false,
 // as num_resources_limit.
 INSTANTIATE_TEST_CASE_P(TileManagerTests,
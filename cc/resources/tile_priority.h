@@ -96,6 +96,13 @@ struct CC_EXPORT TilePriority {
     return !(*this == other);
   }
 
+  // Compares the bins and then the distances to the viewport.
+  bool IsHigherPriorityThan(const TilePriority& other) const {
+    if (priority_bin != other.priority_bin)
+      return priority_bin < other.priority_bin;
+    return distance_to_visible < other.distance_to_visible;
+  }
+
   TileResolution resolution;
   bool required_for_activation;
   PriorityBin priority_bin;
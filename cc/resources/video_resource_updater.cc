@@ -149,10 +149,8 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
   size_t output_plane_count =
       (input_frame_format == media::VideoFrame::YV12A) ? 4 : 3;
 
-  // TODO(skaslev): If we're in software compositing mode, we do the YUV -> RGB
-  // conversion here. That involves an extra copy of each frame to a bitmap.
-  // Obviously, this is suboptimal and should be addressed once ubercompositor
-  // starts shaping up.
+  // If we're in software compositing mode, we do the YUV -> RGB conversion
+  // here, straight into the shared resource.
   if (software_compositor) {
     output_resource_format = kRGBResourceFormat;
     output_plane_count = 1;
@@ -162,6 +160,8 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
   gfx::Size coded_frame_size = video_frame->coded_size();
 
   std::vector<PlaneResource> plane_resources;
+  // Whether each resource in |plane_resources| already holds its plane.
+  std::vector<bool> plane_holds_content;
   bool allocation_success = true;
 
   for (size_t i = 0; i < output_plane_count; ++i) {
@@ -179,21 +179,33 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
 
     ResourceProvider::ResourceId resource_id = 0;
     gpu::Mailbox mailbox;
+    bool holds_plane = false;
 
-    // Try recycle a previously-allocated resource.
-    for (size_t i = 0; i < recycled_resources_.size(); ++i) {
+    // Try recycle a previously-allocated resource, preferring one that
+    // already holds this plane of |video_frame|.
+    size_t recycled_index = recycled_resources_.size();
+    for (size_t j = 0; j < recycled_resources_.size(); ++j) {
       bool resource_matches =
-          recycled_resources_[i].resource_format == output_resource_format &&
-          recycled_resources_[i].resource_size == output_plane_resource_size;
+          recycled_resources_[j].resource_format == output_resource_format &&
+          recycled_resources_[j].resource_size == output_plane_resource_size;
       bool not_in_use =
           !software_compositor || !resource_provider_->InUseByConsumer(
-                                       recycled_resources_[i].resource_id);
-      if (resource_matches && not_in_use) {
-        resource_id = recycled_resources_[i].resource_id;
-        mailbox = recycled_resources_[i].mailbox;
-        recycled_resources_.erase(recycled_resources_.begin() + i);
+                                       recycled_resources_[j].resource_id);
+      if (!resource_matches || !not_in_use)
+        continue;
+      if (PlaneResourceHoldsFramePlane(
+              recycled_resources_[j], video_frame, i)) {
+        recycled_index = j;
+        holds_plane = true;
         break;
       }
+      if (recycled_index == recycled_resources_.size())
+        recycled_index = j;
+    }
+    if (recycled_index < recycled_resources_.size()) {
+      resource_id = recycled_resources_[recycled_index].resource_id;
+      mailbox = recycled_resources_[recycled_index].mailbox;
+      recycled_resources_.erase(recycled_resources_.begin() + recycled_index);
     }
 
     if (resource_id == 0) {
@@ -234,6 +246,7 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
                                             output_plane_resource_size,
                                             output_resource_format,
                                             mailbox));
+    plane_holds_content.push_back(holds_plane);
   }
 
   if (!allocation_success) {
@@ -242,6 +255,12 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
     return VideoFrameExternalResources();
   }
 
+  // From here on, the resources hold the planes of |video_frame|.
+  for (size_t i = 0; i < plane_resources.size(); ++i) {
+    plane_resources[i].video_frame = video_frame;
+    plane_resources[i].plane_index = i;
+  }
+
   VideoFrameExternalResources external_resources;
 
   if (software_compositor) {
@@ -249,28 +268,20 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
     DCHECK_EQ(plane_resources[0].resource_format, kRGBResourceFormat);
     DCHECK(plane_resources[0].mailbox.IsZero());
 
-    if (!video_renderer_)
-      video_renderer_.reset(new media::SkCanvasVideoRenderer);
-
-    {
+    // Convert straight into the resource, rather than painting it through an
+    // intermediate bitmap.
+    if (!plane_holds_content[0]) {
       ResourceProvider::ScopedWriteLockSoftware lock(
           resource_provider_, plane_resources[0].resource_id);
-      video_renderer_->Paint(video_frame.get(),
-                             lock.sk_canvas(),
-                             video_frame->visible_rect(),
-                             0xff);
+      media::SkCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+          video_frame, lock.sk_bitmap()->getPixels(),
+          lock.sk_bitmap()->rowBytes());
     }
 
-    RecycleResourceData recycle_data = {
-      plane_resources[0].resource_id,
-      plane_resources[0].resource_size,
-      plane_resources[0].resource_format,
-      gpu::Mailbox()
-    };
     external_resources.software_resources.push_back(
         plane_resources[0].resource_id);
     external_resources.software_release_callback =
-        base::Bind(&RecycleResource, AsWeakPtr(), recycle_data);
+        base::Bind(&RecycleResource, AsWeakPtr(), plane_resources[0]);
     external_resources.type = VideoFrameExternalResources::SOFTWARE_RESOURCE;
 
     return external_resources;
@@ -280,30 +291,25 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForSoftwarePlanes(
     // Update each plane's resource id with its content.
     DCHECK_EQ(plane_resources[i].resource_format, kYUVResourceFormat);
 
-    const uint8_t* input_plane_pixels = video_frame->data(i);
-
-    gfx::Rect image_rect(0,
-                         0,
-                         video_frame->stride(i),
-                         plane_resources[i].resource_size.height());
-    gfx::Rect source_rect(plane_resources[i].resource_size);
-    resource_provider_->SetPixels(plane_resources[i].resource_id,
-                                  input_plane_pixels,
-                                  image_rect,
-                                  source_rect,
-                                  gfx::Vector2d());
-
-    RecycleResourceData recycle_data = {
-      plane_resources[i].resource_id,
-      plane_resources[i].resource_size,
-      plane_resources[i].resource_format,
-      plane_resources[i].mailbox
-    };
+    if (!plane_holds_content[i]) {
+      const uint8_t* input_plane_pixels = video_frame->data(i);
+
+      gfx::Rect image_rect(0,
+                           0,
+                           video_frame->stride(i),
+                           plane_resources[i].resource_size.height());
+      gfx::Rect source_rect(plane_resources[i].resource_size);
+      resource_provider_->SetPixels(plane_resources[i].resource_id,
+                                    input_plane_pixels,
+                                    image_rect,
+                                    source_rect,
+                                    gfx::Vector2d());
+    }
 
     external_resources.mailboxes.push_back(
         TextureMailbox(plane_resources[i].mailbox, GL_TEXTURE_2D, 0));
     external_resources.release_callbacks.push_back(
-        base::Bind(&RecycleResource, AsWeakPtr(), recycle_data));
+        base::Bind(&RecycleResource, AsWeakPtr(), plane_resources[i]));
   }
 
   external_resources.type = VideoFrameExternalResources::YUV_RESOURCE;
@@ -354,10 +360,19 @@ VideoFrameExternalResources VideoResourceUpdater::CreateForHardwarePlanes(
   return external_resources;
 }
 
+// static
+bool VideoResourceUpdater::PlaneResourceHoldsFramePlane(
+    const PlaneResource& plane_resource,
+    const scoped_refptr<media::VideoFrame>& video_frame,
+    size_t plane_index) {
+  return plane_resource.video_frame.get() == video_frame.get() &&
+         plane_resource.plane_index == plane_index;
+}
+
 // static
 void VideoResourceUpdater::RecycleResource(
     base::WeakPtr<VideoResourceUpdater> updater,
-    RecycleResourceData data,
+    PlaneResource data,
     uint32 sync_point,
     bool lost_resource) {
   if (!updater.get()) {
@@ -384,11 +399,7 @@ void VideoResourceUpdater::RecycleResource(
     updater->recycled_resources_.pop_back();
   }
 
-  PlaneResource recycled_resource(data.resource_id,
-                                  data.resource_size,
-                                  data.resource_format,
-                                  data.mailbox);
-  updater->recycled_resources_.push_back(recycled_resource);
+  updater->recycled_resources_.push_back(data);
 }
 
 }  // namespace cc
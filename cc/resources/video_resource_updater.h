@@ -18,7 +18,6 @@
 #include "ui/gfx/size.h"
 
 namespace media {
-class SkCanvasVideoRenderer;
 class VideoFrame;
 }
 
@@ -78,6 +77,12 @@ class CC_EXPORT VideoResourceUpdater
     gfx::Size resource_size;
     ResourceFormat resource_format;
     gpu::Mailbox mailbox;
+    // These identify the plane of the VideoFrame whose content the resource
+    // holds, so that it doesn't need to be uploaded again when the same frame
+    // is drawn more than once.  Holding a reference keeps the frame from
+    // being destroyed and another one allocated in its place.
+    scoped_refptr<media::VideoFrame> video_frame;
+    size_t plane_index;
 
     PlaneResource(unsigned resource_id,
                   const gfx::Size& resource_size,
@@ -86,9 +91,15 @@ class CC_EXPORT VideoResourceUpdater
         : resource_id(resource_id),
           resource_size(resource_size),
           resource_format(resource_format),
-          mailbox(mailbox) {}
+          mailbox(mailbox),
+          plane_index(0) {}
   };
 
+  static bool PlaneResourceHoldsFramePlane(
+      const PlaneResource& plane_resource,
+      const scoped_refptr<media::VideoFrame>& video_frame,
+      size_t plane_index);
+
   void DeleteResource(unsigned resource_id);
   bool VerifyFrame(const scoped_refptr<media::VideoFrame>& video_frame);
   VideoFrameExternalResources CreateForHardwarePlanes(
@@ -96,20 +107,13 @@ class CC_EXPORT VideoResourceUpdater
   VideoFrameExternalResources CreateForSoftwarePlanes(
       const scoped_refptr<media::VideoFrame>& video_frame);
 
-  struct RecycleResourceData {
-    unsigned resource_id;
-    gfx::Size resource_size;
-    ResourceFormat resource_format;
-    gpu::Mailbox mailbox;
-  };
   static void RecycleResource(base::WeakPtr<VideoResourceUpdater> updater,
-                              RecycleResourceData data,
+                              PlaneResource data,
                               uint32 sync_point,
                               bool lost_resource);
 
   ContextProvider* context_provider_;
   ResourceProvider* resource_provider_;
-  scoped_ptr<media::SkCanvasVideoRenderer> video_renderer_;
 
   std::vector<unsigned> all_resources_;
   std::vector<PlaneResource> recycled_resources_;
@@ -15,11 +15,33 @@
 namespace cc {
 namespace {
 
+class UploadCountingContext : public TestWebGraphicsContext3D {
+ public:
+  UploadCountingContext() : upload_count_(0) {}
+
+  virtual void texSubImage2D(GLenum target,
+                             GLint level,
+                             GLint xoffset,
+                             GLint yoffset,
+                             GLsizei width,
+                             GLsizei height,
+                             GLenum format,
+                             GLenum type,
+                             const void* pixels) OVERRIDE {
+    ++upload_count_;
+  }
+
+  int UploadCount() { return upload_count_; }
+  void ResetUploadCount() { upload_count_ = 0; }
+
+ private:
+  int upload_count_;
+};
+
 class VideoResourceUpdaterTest : public testing::Test {
  protected:
   VideoResourceUpdaterTest() {
-    scoped_ptr<TestWebGraphicsContext3D> context3d =
-        TestWebGraphicsContext3D::Create();
+    scoped_ptr<UploadCountingContext> context3d(new UploadCountingContext());
     context3d_ = context3d.get();
 
     output_surface3d_ =
@@ -29,7 +51,8 @@ class VideoResourceUpdaterTest : public testing::Test {
         ResourceProvider::Create(output_surface3d_.get(), NULL, 0, false, 1);
   }
 
-  scoped_refptr<media::VideoFrame> CreateTestYUVVideoFrame() {
+  scoped_refptr<media::VideoFrame> CreateTestYUVVideoFrame(
+      base::TimeDelta timestamp) {
     const int kDimension = 10;
     gfx::Size size(kDimension, kDimension);
     static uint8 y_data[kDimension * kDimension] = { 0 };
@@ -47,11 +70,16 @@ class VideoResourceUpdaterTest : public testing::Test {
         y_data,                   // y_data
         u_data,                   // u_data
         v_data,                   // v_data
-        base::TimeDelta(),        // timestamp,
+        timestamp,                // timestamp,
         base::Closure());         // no_longer_needed_cb
   }
 
-  TestWebGraphicsContext3D* context3d_;
+  static void ReleaseResources(const VideoFrameExternalResources& resources) {
+    for (size_t i = 0; i < resources.release_callbacks.size(); ++i)
+      resources.release_callbacks[i].Run(0, false);
+  }
+
+  UploadCountingContext* context3d_;
   FakeOutputSurfaceClient client_;
   scoped_ptr<FakeOutputSurface> output_surface3d_;
   scoped_ptr<ResourceProvider> resource_provider3d_;
@@ -60,11 +88,51 @@ class VideoResourceUpdaterTest : public testing::Test {
 TEST_F(VideoResourceUpdaterTest, SoftwareFrame) {
   VideoResourceUpdater updater(output_surface3d_->context_provider().get(),
                                resource_provider3d_.get());
-  scoped_refptr<media::VideoFrame> video_frame = CreateTestYUVVideoFrame();
+  scoped_refptr<media::VideoFrame> video_frame =
+      CreateTestYUVVideoFrame(base::TimeDelta());
+
+  VideoFrameExternalResources resources =
+      updater.CreateExternalResourcesFromVideoFrame(video_frame);
+  EXPECT_EQ(VideoFrameExternalResources::YUV_RESOURCE, resources.type);
+}
+
+TEST_F(VideoResourceUpdaterTest, ReuploadOnlyChangedFrames) {
+  VideoResourceUpdater updater(output_surface3d_->context_provider().get(),
+                               resource_provider3d_.get());
+  scoped_refptr<media::VideoFrame> video_frame =
+      CreateTestYUVVideoFrame(base::TimeDelta());
 
   VideoFrameExternalResources resources =
       updater.CreateExternalResourcesFromVideoFrame(video_frame);
   EXPECT_EQ(VideoFrameExternalResources::YUV_RESOURCE, resources.type);
+  EXPECT_EQ(3, context3d_->UploadCount());
+  ReleaseResources(resources);
+
+  // Drawing the same frame again reuses the recycled planes as they are.
+  context3d_->ResetUploadCount();
+  resources = updater.CreateExternalResourcesFromVideoFrame(video_frame);
+  EXPECT_EQ(VideoFrameExternalResources::YUV_RESOURCE, resources.type);
+  EXPECT_EQ(0, context3d_->UploadCount());
+  ReleaseResources(resources);
+
+  // A new frame has to be uploaded.
+  context3d_->ResetUploadCount();
+  scoped_refptr<media::VideoFrame> next_video_frame =
+      CreateTestYUVVideoFrame(base::TimeDelta::FromMilliseconds(33));
+  resources = updater.CreateExternalResourcesFromVideoFrame(next_video_frame);
+  EXPECT_EQ(VideoFrameExternalResources::YUV_RESOURCE, resources.type);
+  EXPECT_EQ(3, context3d_->UploadCount());
+  ReleaseResources(resources);
+
+  // So does a new frame with the same timestamp, even when it takes the place
+  // of the last one.
+  context3d_->ResetUploadCount();
+  next_video_frame =
+      CreateTestYUVVideoFrame(base::TimeDelta::FromMilliseconds(33));
+  resources = updater.CreateExternalResourcesFromVideoFrame(next_video_frame);
+  EXPECT_EQ(VideoFrameExternalResources::YUV_RESOURCE, resources.type);
+  EXPECT_EQ(3, context3d_->UploadCount());
+  ReleaseResources(resources);
 }
 
 }  // namespace
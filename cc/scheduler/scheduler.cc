@@ -218,9 +218,19 @@ void Scheduler::BeginImplFrame(const BeginFrameArgs& args) {
   devtools_instrumentation::DidBeginFrame(layer_tree_host_id_);
 
   if (settings_.switch_to_low_latency_if_possible) {
+    // When the main thread is a frame behind, skip a BeginMainFrame if it
+    // could catch up within this frame. Otherwise it will miss the deadline
+    // anyway, so draw the impl thread's changes without waiting for it.
+    bool main_thread_is_in_high_latency_mode =
+        state_machine_.MainThreadIsInHighLatencyMode();
+    bool can_commit_and_activate_before_deadline =
+        CanCommitAndActivateBeforeDeadline();
     state_machine_.SetSkipBeginMainFrameToReduceLatency(
-        state_machine_.MainThreadIsInHighLatencyMode() &&
-            CanCommitAndActivateBeforeDeadline());
+        main_thread_is_in_high_latency_mode &&
+        can_commit_and_activate_before_deadline);
+    state_machine_.SetSkipWaitingForMainFrameToReduceLatency(
+        main_thread_is_in_high_latency_mode &&
+        !can_commit_and_activate_before_deadline);
   }
 
   ProcessScheduledActions();
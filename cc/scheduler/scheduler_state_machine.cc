@@ -43,7 +43,8 @@ SchedulerStateMachine::SchedulerStateMachine(const SchedulerSettings& settings)
       draw_if_possible_failed_(false),
       did_create_and_initialize_first_output_surface_(false),
       smoothness_takes_priority_(false),
-      skip_begin_main_frame_to_reduce_latency_(false) {}
+      skip_begin_main_frame_to_reduce_latency_(false),
+      skip_waiting_for_main_frame_to_reduce_latency_(false) {}
 
 const char* SchedulerStateMachine::OutputSurfaceStateToString(
     OutputSurfaceState state) {
@@ -266,6 +267,8 @@ scoped_ptr<base::Value> SchedulerStateMachine::AsValue() const  {
                           MainThreadIsInHighLatencyMode());
   minor_state->SetBoolean("skip_begin_main_frame_to_reduce_latency",
                           skip_begin_main_frame_to_reduce_latency_);
+  minor_state->SetBoolean("skip_waiting_for_main_frame_to_reduce_latency",
+                          skip_waiting_for_main_frame_to_reduce_latency_);
   state->Set("minor_state", minor_state.release());
 
   return state.PassAs<base::Value>();
@@ -783,6 +786,11 @@ void SchedulerStateMachine::SetSkipBeginMainFrameToReduceLatency(bool skip) {
   skip_begin_main_frame_to_reduce_latency_ = skip;
 }
 
+void SchedulerStateMachine::SetSkipWaitingForMainFrameToReduceLatency(
+    bool skip) {
+  skip_waiting_for_main_frame_to_reduce_latency_ = skip;
+}
+
 bool SchedulerStateMachine::BeginImplFrameNeeded() const {
   // Proactive BeginImplFrames are bad for the synchronous compositor because we
   // have to draw when we get the BeginImplFrame and could end up drawing many
@@ -948,6 +956,11 @@ bool SchedulerStateMachine::ShouldTriggerBeginImplFrameDeadlineEarly() const {
   if (smoothness_takes_priority_)
     return true;
 
+  // The main thread's commit or pending tree won't be ready to draw before
+  // the deadline, so waiting for it would only delay the impl-thread draw.
+  if (skip_waiting_for_main_frame_to_reduce_latency_)
+    return true;
+
   return false;
 }
 
@@ -216,6 +216,10 @@ class CC_EXPORT SchedulerStateMachine {
 
   void SetSkipBeginMainFrameToReduceLatency(bool skip);
 
+  // Set when the main thread is not expected to commit and activate before
+  // the deadline, so that impl-thread draws don't wait for it.
+  void SetSkipWaitingForMainFrameToReduceLatency(bool skip);
+
   // Indicates whether drawing would, at this time, make sense.
   // CanDraw can be used to suppress flashes or checkerboarding
   // when such behavior would be undesirable.
@@ -305,6 +309,7 @@ class CC_EXPORT SchedulerStateMachine {
   bool did_create_and_initialize_first_output_surface_;
   bool smoothness_takes_priority_;
   bool skip_begin_main_frame_to_reduce_latency_;
+  bool skip_waiting_for_main_frame_to_reduce_latency_;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(SchedulerStateMachine);
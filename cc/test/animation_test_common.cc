@@ -192,6 +192,7 @@ float FakeFloatTransition::GetValue(double time) const {
 
 FakeLayerAnimationValueObserver::FakeLayerAnimationValueObserver()
     : opacity_(0.0f),
+      background_color_(SK_ColorTRANSPARENT),
       animation_waiting_for_deletion_(false) {}
 
 FakeLayerAnimationValueObserver::~FakeLayerAnimationValueObserver() {}
@@ -215,6 +216,11 @@ void FakeLayerAnimationValueObserver::OnScrollOffsetAnimated(
   scroll_offset_ = scroll_offset;
 }
 
+void FakeLayerAnimationValueObserver::OnBackgroundColorAnimated(
+    SkColor background_color) {
+  background_color_ = background_color;
+}
+
 void FakeLayerAnimationValueObserver::OnAnimationWaitingForDeletion() {
   animation_waiting_for_deletion_ = true;
 }
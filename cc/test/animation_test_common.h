@@ -77,6 +77,7 @@ class FakeLayerAnimationValueObserver : public LayerAnimationValueObserver {
   virtual void OnTransformAnimated(const gfx::Transform& transform) OVERRIDE;
   virtual void OnScrollOffsetAnimated(
       const gfx::Vector2dF& scroll_offset) OVERRIDE;
+  virtual void OnBackgroundColorAnimated(SkColor background_color) OVERRIDE;
   virtual void OnAnimationWaitingForDeletion() OVERRIDE;
   virtual bool IsActive() const OVERRIDE;
 
@@ -84,6 +85,7 @@ class FakeLayerAnimationValueObserver : public LayerAnimationValueObserver {
   float opacity() const  { return opacity_; }
   const gfx::Transform& transform() const { return transform_; }
   gfx::Vector2dF scroll_offset() { return scroll_offset_; }
+  SkColor background_color() const { return background_color_; }
 
   bool animation_waiting_for_deletion() {
     return animation_waiting_for_deletion_;
@@ -94,6 +96,7 @@ class FakeLayerAnimationValueObserver : public LayerAnimationValueObserver {
   float opacity_;
   gfx::Transform transform_;
   gfx::Vector2dF scroll_offset_;
+  SkColor background_color_;
   bool animation_waiting_for_deletion_;
 };
 
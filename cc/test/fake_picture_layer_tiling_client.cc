@@ -40,7 +40,8 @@ FakePictureLayerTilingClient::FakePictureLayerTilingClient(
       twin_tiling_(NULL),
       allow_create_tile_(true),
       max_tiles_for_interest_area_(10000),
-      skewport_target_time_in_seconds_(1.0f) {}
+      skewport_target_time_in_seconds_(1.0f),
+      skewport_extrapolation_limit_in_content_pixels_(2000) {}
 
 FakePictureLayerTilingClient::~FakePictureLayerTilingClient() {
 }
@@ -76,6 +77,19 @@ int FakePictureLayerTilingClient::GetSkewportExtrapolationLimitInContentPixels()
   return skewport_extrapolation_limit_in_content_pixels_;
 }
 
+gfx::Vector2dF
+FakePictureLayerTilingClient::GetPredictedScrollDeltaInLayerSpace() const {
+  return predicted_scroll_delta_;
+}
+
+bool FakePictureLayerTilingClient::IsContentRectOccluded(
+    const gfx::Rect& content_rect,
+    float contents_scale) const {
+  gfx::Rect layer_rect =
+      gfx::ScaleToEnclosingRect(content_rect, 1.f / contents_scale);
+  return occluded_layer_rect_.Contains(layer_rect);
+}
+
 const Region* FakePictureLayerTilingClient::GetInvalidation() {
   return &invalidation_;
 }
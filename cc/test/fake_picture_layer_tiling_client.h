@@ -29,6 +29,9 @@ class FakePictureLayerTilingClient : public PictureLayerTilingClient {
   virtual size_t GetMaxTilesForInterestArea() const OVERRIDE;
   virtual float GetSkewportTargetTimeInSeconds() const OVERRIDE;
   virtual int GetSkewportExtrapolationLimitInContentPixels() const OVERRIDE;
+  virtual gfx::Vector2dF GetPredictedScrollDeltaInLayerSpace() const OVERRIDE;
+  virtual bool IsContentRectOccluded(const gfx::Rect& content_rect,
+                                     float contents_scale) const OVERRIDE;
 
   void SetTileSize(const gfx::Size& tile_size);
   gfx::Size TileSize() const { return tile_size_; }
@@ -52,6 +55,13 @@ class FakePictureLayerTilingClient : public PictureLayerTilingClient {
   void set_skewport_extrapolation_limit_in_content_pixels(int limit) {
     skewport_extrapolation_limit_in_content_pixels_ = limit;
   }
+  void set_predicted_scroll_delta(const gfx::Vector2dF& delta) {
+    predicted_scroll_delta_ = delta;
+  }
+  // Sets the rect, in layer space, that is treated as occluded.
+  void set_occluded_layer_rect(const gfx::Rect& rect) {
+    occluded_layer_rect_ = rect;
+  }
 
   TileManager* tile_manager() const {
     return tile_manager_.get();
@@ -69,6 +79,8 @@ class FakePictureLayerTilingClient : public PictureLayerTilingClient {
   size_t max_tiles_for_interest_area_;
   float skewport_target_time_in_seconds_;
   int skewport_extrapolation_limit_in_content_pixels_;
+  gfx::Vector2dF predicted_scroll_delta_;
+  gfx::Rect occluded_layer_rect_;
 };
 
 }  // namespace cc
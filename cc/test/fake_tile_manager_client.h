@@ -5,6 +5,8 @@
 #ifndef CC_TEST_FAKE_TILE_MANAGER_CLIENT_H_
 #define CC_TEST_FAKE_TILE_MANAGER_CLIENT_H_
 
+#include <vector>
+
 #include "cc/resources/tile_manager.h"
 
 namespace cc {
@@ -14,7 +16,20 @@ class FakeTileManagerClient : public TileManagerClient {
   virtual ~FakeTileManagerClient() {}
 
   // TileManagerClient implementation.
+  virtual void GetPictureLayerTilings(
+      WhichTree tree,
+      std::vector<PictureLayerTiling*>* tilings) const OVERRIDE {
+    tilings->insert(tilings->end(), tilings_[tree].begin(),
+                    tilings_[tree].end());
+  }
   virtual void NotifyReadyToActivate() OVERRIDE {}
+
+  void AddTiling(WhichTree tree, PictureLayerTiling* tiling) {
+    tilings_[tree].push_back(tiling);
+  }
+
+ private:
+  std::vector<PictureLayerTiling*> tilings_[NUM_TREES];
 };
 
 }  // namespace cc
@@ -76,6 +76,10 @@ void TestContextSupport::SetSwapBuffersCompleteCallback(
   swap_buffers_complete_callback_ = callback;
 }
 
+void TestContextSupport::BeginFrameSubmission() {}
+
+void TestContextSupport::EndFrameSubmission() {}
+
 void TestContextSupport::OnSwapBuffersComplete() {
   if (!swap_buffers_complete_callback_.is_null())
     swap_buffers_complete_callback_.Run();
@@ -29,6 +29,8 @@ class TestContextSupport : public gpu::ContextSupport {
   virtual void PartialSwapBuffers(const gfx::Rect& sub_buffer) OVERRIDE;
   virtual void SetSwapBuffersCompleteCallback(
       const base::Closure& callback) OVERRIDE;
+  virtual void BeginFrameSubmission() OVERRIDE;
+  virtual void EndFrameSubmission() OVERRIDE;
 
   void CallAllSyncPointCallbacks();
 
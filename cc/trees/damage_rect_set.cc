@@ -0,0 +1,78 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/trees/damage_rect_set.h"
+
+#include <limits>
+
+namespace cc {
+
+namespace {
+
+float Area(const gfx::RectF& rect) {
+  return rect.width() * rect.height();
+}
+
+}  // namespace
+
+DamageRectSet::DamageRectSet() {}
+
+DamageRectSet::~DamageRectSet() {}
+
+void DamageRectSet::Union(const gfx::RectF& rect) {
+  if (rect.IsEmpty())
+    return;
+
+  bounds_.Union(rect);
+
+  // Merge with the rects it overlaps until it overlaps none, since a merged
+  // rect can overlap rects that the new one didn't.
+  gfx::RectF merged = rect;
+  for (size_t i = 0; i < rects_.size();) {
+    if (!rects_[i].Intersects(merged) && !merged.Contains(rects_[i])) {
+      ++i;
+      continue;
+    }
+    merged.Union(rects_[i]);
+    rects_.erase(rects_.begin() + i);
+    i = 0;
+  }
+  rects_.push_back(merged);
+
+  if (rects_.size() <= kMaxRects)
+    return;
+
+  size_t best_i = 0;
+  size_t best_j = 1;
+  float best_added_area = std::numeric_limits<float>::max();
+  for (size_t i = 0; i < rects_.size(); ++i) {
+    for (size_t j = i + 1; j < rects_.size(); ++j) {
+      gfx::RectF pair = rects_[i];
+      pair.Union(rects_[j]);
+      float added_area = Area(pair) - Area(rects_[i]) - Area(rects_[j]);
+      if (added_area < best_added_area) {
+        best_added_area = added_area;
+        best_i = i;
+        best_j = j;
+      }
+    }
+  }
+  merged = rects_[best_i];
+  merged.Union(rects_[best_j]);
+  rects_.erase(rects_.begin() + best_j);
+  rects_.erase(rects_.begin() + best_i);
+  Union(merged);
+}
+
+void DamageRectSet::Union(const DamageRectSet& other) {
+  for (size_t i = 0; i < other.rects_.size(); ++i)
+    Union(other.rects_[i]);
+}
+
+void DamageRectSet::Clear() {
+  rects_.clear();
+  bounds_ = gfx::RectF();
+}
+
+}  // namespace cc
@@ -0,0 +1,43 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_TREES_DAMAGE_RECT_SET_H_
+#define CC_TREES_DAMAGE_RECT_SET_H_
+
+#include <vector>
+
+#include "cc/base/cc_export.h"
+#include "ui/gfx/rect_f.h"
+
+namespace cc {
+
+// The damage of a surface as a few disjoint rects rather than their union, so
+// that unrelated damage in far apart places, like a video and a spinner,
+// doesn't become one rect that covers everything in between. Overlapping
+// rects are merged, and when there are more than kMaxRects the two whose
+// union adds the least area are merged.
+class CC_EXPORT DamageRectSet {
+ public:
+  enum { kMaxRects = 4 };
+
+  DamageRectSet();
+  ~DamageRectSet();
+
+  void Union(const gfx::RectF& rect);
+  void Union(const DamageRectSet& other);
+  void Clear();
+
+  bool IsEmpty() const { return rects_.empty(); }
+  // The union of the rects.
+  const gfx::RectF& bounds() const { return bounds_; }
+  const std::vector<gfx::RectF>& rects() const { return rects_; }
+
+ private:
+  std::vector<gfx::RectF> rects_;
+  gfx::RectF bounds_;
+};
+
+}  // namespace cc
+
+#endif  // CC_TREES_DAMAGE_RECT_SET_H_
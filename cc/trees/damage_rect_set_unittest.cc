@@ -0,0 +1,65 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/trees/damage_rect_set.h"
+
+#include "cc/test/geometry_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cc {
+namespace {
+
+TEST(DamageRectSetTest, KeepsDisjointRectsApart) {
+  DamageRectSet damage;
+  EXPECT_TRUE(damage.IsEmpty());
+
+  damage.Union(gfx::RectF());
+  EXPECT_TRUE(damage.IsEmpty());
+
+  damage.Union(gfx::RectF(0.f, 0.f, 10.f, 10.f));
+  damage.Union(gfx::RectF(100.f, 100.f, 10.f, 10.f));
+  ASSERT_EQ(2u, damage.rects().size());
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(0.f, 0.f, 10.f, 10.f), damage.rects()[0]);
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(100.f, 100.f, 10.f, 10.f),
+                       damage.rects()[1]);
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(0.f, 0.f, 110.f, 110.f), damage.bounds());
+
+  damage.Clear();
+  EXPECT_TRUE(damage.IsEmpty());
+  EXPECT_TRUE(damage.bounds().IsEmpty());
+}
+
+TEST(DamageRectSetTest, MergesOverlappingRects) {
+  DamageRectSet damage;
+  damage.Union(gfx::RectF(0.f, 0.f, 10.f, 10.f));
+  damage.Union(gfx::RectF(20.f, 0.f, 10.f, 10.f));
+
+  // Overlapping both rects merges all three.
+  damage.Union(gfx::RectF(5.f, 5.f, 20.f, 10.f));
+  ASSERT_EQ(1u, damage.rects().size());
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(0.f, 0.f, 30.f, 15.f), damage.rects()[0]);
+}
+
+TEST(DamageRectSetTest, MergesClosestRectsWhenFull) {
+  DamageRectSet damage;
+  for (int i = 0; i < DamageRectSet::kMaxRects; ++i)
+    damage.Union(gfx::RectF(i * 100.f, 0.f, 10.f, 10.f));
+  EXPECT_EQ(static_cast<size_t>(DamageRectSet::kMaxRects),
+            damage.rects().size());
+
+  // The new rect is closest to the first one, so that is what it merges with.
+  damage.Union(gfx::RectF(0.f, 20.f, 10.f, 10.f));
+  ASSERT_EQ(static_cast<size_t>(DamageRectSet::kMaxRects),
+            damage.rects().size());
+  bool found_merged_rect = false;
+  for (size_t i = 0; i < damage.rects().size(); ++i) {
+    if (damage.rects()[i] == gfx::RectF(0.f, 0.f, 10.f, 30.f))
+      found_merged_rect = true;
+  }
+  EXPECT_TRUE(found_merged_rect);
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(0.f, 0.f, 310.f, 30.f), damage.bounds());
+}
+
+}  // namespace
+}  // namespace cc
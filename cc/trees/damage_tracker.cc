@@ -33,16 +33,16 @@ static inline void ExpandRectWithFilters(
 }
 
 static inline void ExpandDamageRectInsideRectWithFilters(
-    gfx::RectF* damage_rect,
+    DamageRectSet* damage_rects,
     const gfx::RectF& pre_filter_rect,
     const FilterOperations& filters) {
-  gfx::RectF expanded_damage_rect = *damage_rect;
+  gfx::RectF expanded_damage_rect = damage_rects->bounds();
   ExpandRectWithFilters(&expanded_damage_rect, filters);
   gfx::RectF filter_rect = pre_filter_rect;
   ExpandRectWithFilters(&filter_rect, filters);
 
   expanded_damage_rect.Intersect(filter_rect);
-  damage_rect->Union(expanded_damage_rect);
+  damage_rects->Union(expanded_damage_rect);
 }
 
 void DamageTracker::UpdateDamageTrackingState(
@@ -81,7 +81,10 @@ void DamageTracker::UpdateDamageTrackingState(
   //       for each leftover layer:
   //           add the old layer/surface bounds to the target surface damage.
   //
-  //   4. combine all partial damage rects to get the full damage rect.
+  //   4. combine all partial damage rects to get the full damage rect. The
+  //      partial rects are kept apart where they don't overlap, as a
+  //      DamageRectSet, so that far apart damage can be redrawn without
+  //      everything in between.
   //
   // Additional important points:
   //
@@ -124,35 +127,39 @@ void DamageTracker::UpdateDamageTrackingState(
   // These functions cannot be bypassed with early-exits, even if we know what
   // the damage will be for this frame, because we need to update the damage
   // tracker state to correctly track the next frame.
-  gfx::RectF damage_from_active_layers =
+  DamageRectSet damage_from_active_layers =
       TrackDamageFromActiveLayers(layer_list, target_surface_layer_id);
   gfx::RectF damage_from_surface_mask =
       TrackDamageFromSurfaceMask(target_surface_mask_layer);
   gfx::RectF damage_from_leftover_rects = TrackDamageFromLeftoverRects();
 
-  gfx::RectF damage_rect_for_this_update;
+  DamageRectSet damage_rects_for_this_update;
 
   if (target_surface_property_changed_only_from_descendant) {
-    damage_rect_for_this_update = target_surface_content_rect;
+    damage_rects_for_this_update.Union(target_surface_content_rect);
   } else {
     // TODO(shawnsingh): can we clamp this damage to the surface's content rect?
     // (affects performance, but not correctness)
-    damage_rect_for_this_update = damage_from_active_layers;
-    damage_rect_for_this_update.Union(damage_from_surface_mask);
-    damage_rect_for_this_update.Union(damage_from_leftover_rects);
+    damage_rects_for_this_update = damage_from_active_layers;
+    damage_rects_for_this_update.Union(damage_from_surface_mask);
+    damage_rects_for_this_update.Union(damage_from_leftover_rects);
 
     if (filters.HasReferenceFilter()) {
       // TODO(senorblanco):  Once SkImageFilter reports its outsets, use
       // those here to limit damage.
-      damage_rect_for_this_update = target_surface_content_rect;
+      damage_rects_for_this_update.Clear();
+      damage_rects_for_this_update.Union(target_surface_content_rect);
     } else if (filters.HasFilterThatMovesPixels()) {
-      ExpandRectWithFilters(&damage_rect_for_this_update, filters);
+      gfx::RectF expanded_damage_rect = damage_rects_for_this_update.bounds();
+      ExpandRectWithFilters(&expanded_damage_rect, filters);
+      damage_rects_for_this_update.Clear();
+      damage_rects_for_this_update.Union(expanded_damage_rect);
     }
   }
 
   // Damage accumulates until we are notified that we actually did draw on that
   // frame.
-  current_damage_rect_.Union(damage_rect_for_this_update);
+  current_damage_rects_.Union(damage_rects_for_this_update);
 }
 
 DamageTracker::RectMapData& DamageTracker::RectDataForLayer(
@@ -172,10 +179,10 @@ DamageTracker::RectMapData& DamageTracker::RectDataForLayer(
   return *it;
 }
 
-gfx::RectF DamageTracker::TrackDamageFromActiveLayers(
+DamageRectSet DamageTracker::TrackDamageFromActiveLayers(
     const LayerImplList& layer_list,
     int target_surface_layer_id) {
-  gfx::RectF damage_rect = gfx::RectF();
+  DamageRectSet damage_rects;
 
   for (size_t layer_index = 0; layer_index < layer_list.size(); ++layer_index) {
     // Visit layers in back-to-front order.
@@ -189,12 +196,12 @@ gfx::RectF DamageTracker::TrackDamageFromActiveLayers(
 
     if (LayerTreeHostCommon::RenderSurfaceContributesToTarget<LayerImpl>(
             layer, target_surface_layer_id))
-      ExtendDamageForRenderSurface(layer, &damage_rect);
+      ExtendDamageForRenderSurface(layer, &damage_rects);
     else
-      ExtendDamageForLayer(layer, &damage_rect);
+      ExtendDamageForLayer(layer, &damage_rects);
   }
 
-  return damage_rect;
+  return damage_rects;
 }
 
 gfx::RectF DamageTracker::TrackDamageFromSurfaceMask(
@@ -261,7 +268,7 @@ gfx::RectF DamageTracker::TrackDamageFromLeftoverRects() {
 }
 
 void DamageTracker::ExtendDamageForLayer(LayerImpl* layer,
-                                         gfx::RectF* target_damage_rect) {
+                                         DamageRectSet* target_damage_rects) {
   // There are two ways that a layer can damage a region of the target surface:
   //   1. Property change (e.g. opacity, position, transforms):
   //        - the entire region of the layer itself damages the surface.
@@ -292,11 +299,11 @@ void DamageTracker::ExtendDamageForLayer(LayerImpl* layer,
   if (layer_is_new || layer->LayerPropertyChanged()) {
     // If a layer is new or has changed, then its entire layer rect affects the
     // target surface.
-    target_damage_rect->Union(rect_in_target_space);
+    target_damage_rects->Union(rect_in_target_space);
 
     // The layer's old region is now exposed on the target surface, too.
     // Note old_rect_in_target_space is already in target space.
-    target_damage_rect->Union(old_rect_in_target_space);
+    target_damage_rects->Union(old_rect_in_target_space);
   } else if (!layer->update_rect().IsEmpty()) {
     // If the layer properties haven't changed, then the the target surface is
     // only affected by the layer's update area, which could be empty.
@@ -304,12 +311,12 @@ void DamageTracker::ExtendDamageForLayer(LayerImpl* layer,
         layer->LayerRectToContentRect(layer->update_rect());
     gfx::RectF update_rect_in_target_space =
         MathUtil::MapClippedRect(layer->draw_transform(), update_content_rect);
-    target_damage_rect->Union(update_rect_in_target_space);
+    target_damage_rects->Union(update_rect_in_target_space);
   }
 }
 
 void DamageTracker::ExtendDamageForRenderSurface(
-    LayerImpl* layer, gfx::RectF* target_damage_rect) {
+    LayerImpl* layer, DamageRectSet* target_damage_rects) {
   // There are two ways a "descendant surface" can damage regions of the "target
   // surface":
   //   1. Property change:
@@ -336,32 +343,33 @@ void DamageTracker::ExtendDamageForRenderSurface(
       render_surface->DrawableContentRect();
   data.Update(surface_rect_in_target_space, mailboxId_);
 
-  gfx::RectF damage_rect_in_local_space;
+  DamageRectSet damage_rects_in_local_space;
   if (surface_is_new || render_surface->SurfacePropertyChanged()) {
     // The entire surface contributes damage.
-    damage_rect_in_local_space = render_surface->content_rect();
+    damage_rects_in_local_space.Union(render_surface->content_rect());
 
     // The surface's old region is now exposed on the target surface, too.
-    target_damage_rect->Union(old_surface_rect);
+    target_damage_rects->Union(old_surface_rect);
   } else {
     // Only the surface's damage_rect will damage the target surface.
-    damage_rect_in_local_space =
-        render_surface->damage_tracker()->current_damage_rect();
+    damage_rects_in_local_space =
+        render_surface->damage_tracker()->current_damage_rects();
   }
 
   // If there was damage, transform it to target space, and possibly contribute
   // its reflection if needed.
-  if (!damage_rect_in_local_space.IsEmpty()) {
+  const std::vector<gfx::RectF>& local_rects =
+      damage_rects_in_local_space.rects();
+  for (size_t i = 0; i < local_rects.size(); ++i) {
     const gfx::Transform& draw_transform = render_surface->draw_transform();
-    gfx::RectF damage_rect_in_target_space =
-        MathUtil::MapClippedRect(draw_transform, damage_rect_in_local_space);
-    target_damage_rect->Union(damage_rect_in_target_space);
+    target_damage_rects->Union(
+        MathUtil::MapClippedRect(draw_transform, local_rects[i]));
 
     if (layer->replica_layer()) {
       const gfx::Transform& replica_draw_transform =
           render_surface->replica_draw_transform();
-      target_damage_rect->Union(MathUtil::MapClippedRect(
-          replica_draw_transform, damage_rect_in_local_space));
+      target_damage_rects->Union(
+          MathUtil::MapClippedRect(replica_draw_transform, local_rects[i]));
     }
   }
 
@@ -386,7 +394,7 @@ void DamageTracker::ExtendDamageForRenderSurface(
     if (replica_is_new ||
         replica_mask_layer->LayerPropertyChanged() ||
         !replica_mask_layer->update_rect().IsEmpty())
-      target_damage_rect->Union(replica_mask_layer_rect);
+      target_damage_rects->Union(replica_mask_layer_rect);
   }
 
   // If the layer has a background filter, this may cause pixels in our surface
@@ -396,7 +404,7 @@ void DamageTracker::ExtendDamageForRenderSurface(
   // one in them. This means we need to redraw any pixels in the surface being
   // used for the blur in this layer this frame.
   if (layer->background_filters().HasFilterThatMovesPixels()) {
-    ExpandDamageRectInsideRectWithFilters(target_damage_rect,
+    ExpandDamageRectInsideRectWithFilters(target_damage_rects,
                                           surface_rect_in_target_space,
                                           layer->background_filters());
   }
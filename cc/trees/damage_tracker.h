@@ -9,6 +9,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "cc/base/cc_export.h"
 #include "cc/layers/layer_lists.h"
+#include "cc/trees/damage_rect_set.h"
 #include "ui/gfx/rect_f.h"
 
 class SkImageFilter;
@@ -31,9 +32,9 @@ class CC_EXPORT DamageTracker {
   static scoped_ptr<DamageTracker> Create();
   ~DamageTracker();
 
-  void DidDrawDamagedArea() { current_damage_rect_ = gfx::RectF(); }
+  void DidDrawDamagedArea() { current_damage_rects_.Clear(); }
   void AddDamageNextUpdate(const gfx::RectF& dmg) {
-    current_damage_rect_.Union(dmg);
+    current_damage_rects_.Union(dmg);
   }
   void UpdateDamageTrackingState(
       const LayerImplList& layer_list,
@@ -43,12 +44,17 @@ class CC_EXPORT DamageTracker {
       LayerImpl* target_surface_mask_layer,
       const FilterOperations& filters);
 
-  gfx::RectF current_damage_rect() { return current_damage_rect_; }
+  gfx::RectF current_damage_rect() { return current_damage_rects_.bounds(); }
+  // A finer cover of current_damage_rect(), in up to DamageRectSet::kMaxRects
+  // rects.
+  const DamageRectSet& current_damage_rects() const {
+    return current_damage_rects_;
+  }
 
  private:
   DamageTracker();
 
-  gfx::RectF TrackDamageFromActiveLayers(
+  DamageRectSet TrackDamageFromActiveLayers(
       const LayerImplList& layer_list,
       int target_surface_layer_id);
   gfx::RectF TrackDamageFromSurfaceMask(LayerImpl* target_surface_mask_layer);
@@ -57,9 +63,10 @@ class CC_EXPORT DamageTracker {
   void PrepareRectHistoryForUpdate();
 
   // These helper functions are used only in TrackDamageFromActiveLayers().
-  void ExtendDamageForLayer(LayerImpl* layer, gfx::RectF* target_damage_rect);
+  void ExtendDamageForLayer(LayerImpl* layer,
+                            DamageRectSet* target_damage_rects);
   void ExtendDamageForRenderSurface(LayerImpl* layer,
-                                    gfx::RectF* target_damage_rect);
+                                    DamageRectSet* target_damage_rects);
 
   struct RectMapData {
     RectMapData() : layer_id_(0), mailboxId_(0) {}
@@ -84,7 +91,7 @@ class CC_EXPORT DamageTracker {
   SortedRectMap rect_history_;
 
   unsigned int mailboxId_;
-  gfx::RectF current_damage_rect_;
+  DamageRectSet current_damage_rects_;
 
   DISALLOW_COPY_AND_ASSIGN(DamageTracker);
 };
@@ -719,6 +719,16 @@ TEST_F(DamageTrackerTest, VerifyDamageForMultipleLayers) {
           root->render_surface()->damage_tracker()->current_damage_rect();
   EXPECT_FLOAT_RECT_EQ(
       gfx::RectF(100.f, 100.f, 303.f, 284.f), root_damage_rect);
+
+  // The two damaged regions are kept apart, rather than covering everything
+  // between them.
+  const std::vector<gfx::RectF>& root_damage_rects =
+      root->render_surface()->damage_tracker()->current_damage_rects().rects();
+  ASSERT_EQ(2u, root_damage_rects.size());
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(100.f, 100.f, 1.f, 2.f),
+                       root_damage_rects[0]);
+  EXPECT_FLOAT_RECT_EQ(gfx::RectF(400.f, 380.f, 3.f, 4.f),
+                       root_damage_rects[1]);
 }
 
 TEST_F(DamageTrackerTest, VerifyDamageForNestedSurfaces) {
@@ -757,6 +767,11 @@ TEST_F(DamageTrackerTest, VerifyDamageForNestedSurfaces) {
           root->render_surface()->damage_tracker()->current_damage_rect();
   EXPECT_FLOAT_RECT_EQ(gfx::RectF(200.f, 200.f, 6.f, 8.f), child_damage_rect);
   EXPECT_FLOAT_RECT_EQ(gfx::RectF(11.f, 11.f, 295.f, 297.f), root_damage_rect);
+  EXPECT_EQ(2u, root->render_surface()
+                    ->damage_tracker()
+                    ->current_damage_rects()
+                    .rects()
+                    .size());
 }
 
 TEST_F(DamageTrackerTest, VerifyDamageForSurfaceChangeFromDescendantLayer) {
@@ -7,6 +7,7 @@
 #include <algorithm>
 
 #include "base/debug/trace_event.h"
+#include "base/memory/task_arena.h"
 #include "cc/base/math_util.h"
 #include "cc/layers/heads_up_display_layer_impl.h"
 #include "cc/layers/layer.h"
@@ -1177,9 +1178,10 @@ static LayerType* GetChildContainingLayer(const LayerType& parent,
 }
 
 template <typename LayerType>
-static void AddScrollParentChain(std::vector<LayerType*>* out,
-                                 const LayerType& parent,
-                                 LayerType* layer) {
+static void AddScrollParentChain(
+    typename base::TaskArenaVector<LayerType*>::Type* out,
+    const LayerType& parent,
+    LayerType* layer) {
   // At a high level, this function walks up the chain of scroll parents
   // recursively, and once we reach the end of the chain, we add the child
   // of |parent| containing each scroll ancestor as we unwind. The result is
@@ -1219,8 +1221,9 @@ static void AddScrollParentChain(std::vector<LayerType*>* out,
 }
 
 template <typename LayerType>
-static bool SortChildrenForRecursion(std::vector<LayerType*>* out,
-                                     const LayerType& parent) {
+static bool SortChildrenForRecursion(
+    typename base::TaskArenaVector<LayerType*>::Type* out,
+    const LayerType& parent) {
   out->reserve(parent.children().size());
   bool order_changed = false;
   for (size_t i = 0; i < parent.children().size(); ++i) {
@@ -1894,7 +1897,9 @@ static void CalculateDrawPropertiesInternal(
     data_for_children.subtree_is_visible_from_ancestor = layer_is_drawn;
   }
 
-  std::vector<LayerType*> sorted_children;
+  // Filled for each layer with a scroll child and dropped once its subtree is
+  // done, so it lives in the task's arena.
+  typename base::TaskArenaVector<LayerType*>::Type sorted_children;
   bool child_order_changed = false;
   if (layer_draw_properties.has_child_with_a_scroll_parent)
     child_order_changed = SortChildrenForRecursion(&sorted_children, *layer);
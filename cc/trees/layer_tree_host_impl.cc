@@ -13,6 +13,7 @@
 #include "base/metrics/histogram.h"
 #include "base/stl_util.h"
 #include "base/strings/stringprintf.h"
+#include "cc/animation/scroll_offset_animation_curve.h"
 #include "cc/animation/scrollbar_animation_controller.h"
 #include "cc/animation/timing_function.h"
 #include "cc/base/latency_info_swap_promise_monitor.h"
@@ -33,6 +34,7 @@
 #include "cc/layers/layer_impl.h"
 #include "cc/layers/layer_iterator.h"
 #include "cc/layers/painted_scrollbar_layer_impl.h"
+#include "cc/layers/picture_layer_impl.h"
 #include "cc/layers/render_surface_impl.h"
 #include "cc/layers/scrollbar_layer_impl_base.h"
 #include "cc/output/compositor_frame_metadata.h"
@@ -77,27 +79,43 @@ void DidVisibilityChange(cc::LayerTreeHostImpl* id, bool visible) {
   TRACE_EVENT_ASYNC_END0("webkit", "LayerTreeHostImpl::SetVisible", id);
 }
 
+// We want to make sure the default transfer buffer size is equal to the
+// amount of data that can be uploaded by the compositor to avoid stalling
+// the pipeline.
+// For reference Chromebook Pixel can upload 1MB in about 0.5ms.
+const size_t kMaxBytesUploadedPerMs = 1024 * 1024 * 2;
+// Assuming a two frame deep pipeline between CPU and GPU and we are
+// drawing 60 frames per second which would require us to draw one
+// frame in 16 milliseconds.
+const size_t kMaxTransferBufferUsageBytes = 16 * 2 * kMaxBytesUploadedPerMs;
+
+// Until on demand raster has been measured, assume that a 256x256 tile takes
+// 4ms to rasterize. The estimate is never allowed below a sixteenth of that,
+// so that a few unmeasurably fast frames don't lift the budget entirely.
+const double kDefaultRasterOnDemandMsPerPixel = 4.0 / (256 * 256);
+const double kMinRasterOnDemandMsPerPixel =
+    kDefaultRasterOnDemandMsPerPixel / 16;
+
 size_t GetMaxTransferBufferUsageBytes(cc::ContextProvider* context_provider) {
   // Software compositing should not use this value in production. Just use a
   // default value when testing uploads with the software compositor.
   if (!context_provider)
     return std::numeric_limits<size_t>::max();
 
-  // We want to make sure the default transfer buffer size is equal to the
-  // amount of data that can be uploaded by the compositor to avoid stalling
-  // the pipeline.
-  // For reference Chromebook Pixel can upload 1MB in about 0.5ms.
-  const size_t kMaxBytesUploadedPerMs = 1024 * 1024 * 2;
-  // Assuming a two frame deep pipeline between CPU and GPU and we are
-  // drawing 60 frames per second which would require us to draw one
-  // frame in 16 milliseconds.
-  const size_t kMaxTransferBufferUsageBytes = 16 * 2 * kMaxBytesUploadedPerMs;
   return std::min(
       context_provider->ContextCapabilities().max_transfer_buffer_usage_bytes,
       kMaxTransferBufferUsageBytes);
 }
 
-size_t GetMaxRasterTasksUsageBytes(cc::ContextProvider* context_provider) {
+size_t GetMaxRasterTasksUsageBytes(cc::ContextProvider* context_provider,
+                                   bool using_map_image) {
+  // Tiles are rasterized straight into the image buffers that are sampled
+  // when using map image, so there are no transfer buffers to stay within.
+  // Raster is still limited, to preserve caching behavior, but not by the
+  // context's transfer buffer limit.
+  if (using_map_image && context_provider)
+    return kMaxTransferBufferUsageBytes;
+
   // Transfer-buffer/raster-tasks limits are different but related. We make
   // equal here, as this is ideal when using transfer buffers. When not using
   // transfer buffers we should still limit raster to something similar, to
@@ -105,6 +123,33 @@ size_t GetMaxRasterTasksUsageBytes(cc::ContextProvider* context_provider) {
   return GetMaxTransferBufferUsageBytes(context_provider);
 }
 
+// Tells the impl-side micro benchmarks how long its scope took, if there are
+// any benchmarks to tell.
+class ScopedFramePhaseTimer {
+ public:
+  ScopedFramePhaseTimer(cc::MicroBenchmarkControllerImpl* controller,
+                        cc::MicroBenchmarkImpl::FramePhase phase)
+      : controller_(controller->HasBenchmarks() ? controller : NULL),
+        phase_(phase) {
+    if (controller_)
+      start_time_ = base::TimeTicks::HighResNow();
+  }
+
+  ~ScopedFramePhaseTimer() {
+    if (controller_) {
+      controller_->DidRunFramePhase(
+          phase_, base::TimeTicks::HighResNow() - start_time_);
+    }
+  }
+
+ private:
+  cc::MicroBenchmarkControllerImpl* controller_;
+  cc::MicroBenchmarkImpl::FramePhase phase_;
+  base::TimeTicks start_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedFramePhaseTimer);
+};
+
 unsigned GetMapImageTextureTarget(cc::ContextProvider* context_provider) {
   if (!context_provider)
     return GL_TEXTURE_2D;
@@ -198,7 +243,9 @@ class LayerTreeHostImplTimeSourceAdapter : public TimeSourceClient {
 };
 
 LayerTreeHostImpl::FrameData::FrameData()
-    : contains_incomplete_tile(false), has_no_damage(false) {}
+    : contains_incomplete_tile(false),
+      missing_tile_count(0),
+      has_no_damage(false) {}
 
 LayerTreeHostImpl::FrameData::~FrameData() {}
 
@@ -256,6 +303,8 @@ LayerTreeHostImpl::LayerTreeHostImpl(
       rendering_stats_instrumentation_(rendering_stats_instrumentation),
       micro_benchmark_controller_(this),
       need_to_update_visible_tiles_before_draw_(false),
+      raster_on_demand_pixel_budget_(0),
+      raster_on_demand_ms_per_pixel_(kDefaultRasterOnDemandMsPerPixel),
 #ifndef NDEBUG
       did_lose_called_(false),
 #endif
@@ -404,6 +453,7 @@ void LayerTreeHostImpl::Animate(base::TimeTicks monotonic_time,
   AnimateLayers(monotonic_time, wall_clock_time);
   AnimateScrollbars(monotonic_time);
   AnimateTopControls(monotonic_time);
+  UpdatePredictedScrollDeltas(monotonic_time);
 }
 
 void LayerTreeHostImpl::ManageTiles() {
@@ -415,7 +465,11 @@ void LayerTreeHostImpl::ManageTiles() {
     return;
 
   tile_priorities_dirty_ = false;
-  tile_manager_->ManageTiles(global_tile_state_);
+  {
+    ScopedFramePhaseTimer timer(&micro_benchmark_controller_,
+                                MicroBenchmarkImpl::MANAGE_TILES_PHASE);
+    tile_manager_->ManageTiles(global_tile_state_);
+  }
 
   size_t memory_required_bytes;
   size_t memory_nice_to_have_bytes;
@@ -526,6 +580,7 @@ void LayerTreeHostImpl::TrackDamageForAllSurfaces(
 scoped_ptr<base::Value> LayerTreeHostImpl::FrameData::AsValue() const {
   scoped_ptr<base::DictionaryValue> value(new base::DictionaryValue());
   value->SetBoolean("contains_incomplete_tile", contains_incomplete_tile);
+  value->SetInteger("missing_tile_count", missing_tile_count);
   value->SetBoolean("has_no_damage", has_no_damage);
 
   // Quad data can be quite large, so only dump render passes if we select
@@ -854,6 +909,7 @@ DrawSwapReadbackResult::DrawResult LayerTreeHostImpl::CalculateRenderPasses(
     }
 
     if (append_quads_data.num_missing_tiles) {
+      frame->missing_tile_count += append_quads_data.num_missing_tiles;
       bool layer_has_animating_transform =
           it->screen_space_transform_is_animating() ||
           it->draw_transform_is_animating();
@@ -1083,6 +1139,8 @@ DrawSwapReadbackResult::DrawResult LayerTreeHostImpl::PrepareToDraw(
                "LayerTreeHostImpl::PrepareToDraw",
                "SourceFrameNumber",
                active_tree_->source_frame_number());
+  ScopedFramePhaseTimer prepare_to_draw_timer(
+      &micro_benchmark_controller_, MicroBenchmarkImpl::PREPARE_TO_DRAW_PHASE);
 
   if (need_to_update_visible_tiles_before_draw_ &&
       tile_manager_ && tile_manager_->UpdateVisibleTiles()) {
@@ -1090,15 +1148,28 @@ DrawSwapReadbackResult::DrawResult LayerTreeHostImpl::PrepareToDraw(
   }
   need_to_update_visible_tiles_before_draw_ = true;
 
-  active_tree_->UpdateDrawProperties();
+  {
+    ScopedFramePhaseTimer timer(
+        &micro_benchmark_controller_,
+        MicroBenchmarkImpl::UPDATE_DRAW_PROPERTIES_PHASE);
+    active_tree_->UpdateDrawProperties();
+  }
 
   frame->render_surface_layer_list = &active_tree_->RenderSurfaceLayerList();
   frame->render_passes.clear();
   frame->render_passes_by_id.clear();
   frame->will_draw_layers.clear();
   frame->contains_incomplete_tile = false;
+  frame->missing_tile_count = 0;
   frame->has_no_damage = false;
 
+  raster_on_demand_pixel_budget_ = 0;
+  if (settings_.raster_on_demand_budget_ms > 0.0 && renderer_ &&
+      renderer_->Capabilities().allow_rasterize_on_demand) {
+    raster_on_demand_pixel_budget_ = static_cast<int64>(
+        settings_.raster_on_demand_budget_ms / raster_on_demand_ms_per_pixel_);
+  }
+
   gfx::Rect device_viewport_damage_rect(damage_rect);
   if (active_tree_->root_layer()) {
     device_viewport_damage_rect.Union(viewport_damage_rect_);
@@ -1108,7 +1179,13 @@ DrawSwapReadbackResult::DrawResult LayerTreeHostImpl::PrepareToDraw(
         AddDamageNextUpdate(device_viewport_damage_rect);
   }
 
-  DrawSwapReadbackResult::DrawResult draw_result = CalculateRenderPasses(frame);
+  DrawSwapReadbackResult::DrawResult draw_result;
+  {
+    ScopedFramePhaseTimer timer(
+        &micro_benchmark_controller_,
+        MicroBenchmarkImpl::CALCULATE_RENDER_PASSES_PHASE);
+    draw_result = CalculateRenderPasses(frame);
+  }
   if (draw_result != DrawSwapReadbackResult::DRAW_SUCCESS) {
     DCHECK(!output_surface_->capabilities()
                .draw_and_swap_full_viewport_every_frame);
@@ -1200,6 +1277,18 @@ void LayerTreeHostImpl::DidInitializeVisibleTile() {
     client_->DidInitializeVisibleTileOnImplThread();
 }
 
+void LayerTreeHostImpl::GetPictureLayerTilings(
+    WhichTree tree,
+    std::vector<PictureLayerTiling*>* tilings) const {
+  LayerTreeImpl* layer_tree =
+      tree == ACTIVE_TREE ? active_tree_.get() : pending_tree_.get();
+  if (!layer_tree)
+    return;
+  const std::vector<PictureLayerImpl*>& layers = layer_tree->picture_layers();
+  for (size_t i = 0; i < layers.size(); ++i)
+    layers[i]->GetTilings(tilings);
+}
+
 void LayerTreeHostImpl::NotifyReadyToActivate() {
   client_->NotifyReadyToActivate();
 }
@@ -1392,6 +1481,8 @@ void LayerTreeHostImpl::DrawLayers(FrameData* frame,
         GetDrawMode(output_surface_.get()), resource_provider_.get());
   }
 
+  rendering_stats_instrumentation_->AddCheckerboard(frame->missing_tile_count);
+
   if (output_surface_->ForcedDrawToSoftwareDevice()) {
     bool allow_partial_swap = false;
     bool disable_picture_quad_image_filtering =
@@ -1406,19 +1497,47 @@ void LayerTreeHostImpl::DrawLayers(FrameData* frame,
                                       DeviceClip(),
                                       allow_partial_swap,
                                       disable_picture_quad_image_filtering);
+
+    // The damage drawn here is cleared below, so the render pass contents
+    // that |renderer_| kept from its last frame can't be updated from the
+    // damage of the next one.
+    SetFullRootLayerDamage();
   } else {
     // We don't track damage on the HUD layer (it interacts with damage tracking
     // visualizations), so disable partial swaps to make the HUD layer display
     // properly.
     bool allow_partial_swap = !debug_state_.ShowHudRects();
 
-    renderer_->DrawFrame(&frame->render_passes,
-                         offscreen_context_provider_.get(),
-                         device_scale_factor_,
-                         DeviceViewport(),
-                         DeviceClip(),
-                         allow_partial_swap,
-                         false);
+    size_t render_pass_count = frame->render_passes.size();
+    {
+      ScopedFramePhaseTimer timer(&micro_benchmark_controller_,
+                                  MicroBenchmarkImpl::DRAW_FRAME_PHASE);
+      renderer_->DrawFrame(&frame->render_passes,
+                           offscreen_context_provider_.get(),
+                           device_scale_factor_,
+                           DeviceViewport(),
+                           DeviceClip(),
+                           allow_partial_swap,
+                           false);
+    }
+    rendering_stats_instrumentation_->AddDraw(renderer_->draw_call_count(),
+                                              renderer_->drawn_quad_count());
+    int64 on_demand_raster_pixels = renderer_->on_demand_raster_pixel_count();
+    if (on_demand_raster_pixels) {
+      base::TimeDelta on_demand_raster_time =
+          renderer_->on_demand_raster_time();
+      rendering_stats_instrumentation_->AddRasterOnDemand(
+          on_demand_raster_time, on_demand_raster_pixels);
+      // Average with the earlier estimate so that one unusually slow or fast
+      // frame doesn't swing the next frame's budget.
+      double ms_per_pixel =
+          on_demand_raster_time.InMillisecondsF() / on_demand_raster_pixels;
+      raster_on_demand_ms_per_pixel_ =
+          std::max(kMinRasterOnDemandMsPerPixel,
+                   (raster_on_demand_ms_per_pixel_ + ms_per_pixel) / 2);
+    }
+    if (micro_benchmark_controller_.HasBenchmarks())
+      micro_benchmark_controller_.DidDrawFrame(render_pass_count);
   }
   // The render passes should be consumed by the renderer.
   DCHECK(frame->render_passes.empty());
@@ -1755,7 +1874,8 @@ void LayerTreeHostImpl::CreateAndSetTileManager(
                           using_map_image,
                           allow_rasterize_on_demand,
                           GetMaxTransferBufferUsageBytes(context_provider),
-                          GetMaxRasterTasksUsageBytes(context_provider),
+                          GetMaxRasterTasksUsageBytes(context_provider,
+                                                      using_map_image),
                           GetMapImageTextureTarget(context_provider));
 
   UpdateTileManagerMemoryPolicy(ActualManagedMemoryPolicy());
@@ -2663,9 +2783,53 @@ void LayerTreeHostImpl::AnimateLayers(base::TimeTicks monotonic_time,
        ++iter)
     (*iter).second->Animate(monotonic_seconds);
 
+  rendering_stats_instrumentation_->AddImplAnimatedFrame();
   SetNeedsRedraw();
 }
 
+void LayerTreeHostImpl::UpdatePredictedScrollDeltas(
+    base::TimeTicks monotonic_time) {
+  predicted_scroll_deltas_.clear();
+  double target_time = settings_.skewport_target_time_in_seconds;
+
+  // The fling velocity is in viewport pixels per second.
+  LayerImpl* scrolling_layer = active_tree_->CurrentlyScrollingLayer();
+  if (scrolling_layer && !current_fling_velocity_.IsZero()) {
+    predicted_scroll_deltas_[scrolling_layer->id()] = gfx::ScaleVector2d(
+        current_fling_velocity_, device_scale_factor_ * target_time);
+  }
+
+  if (!settings_.accelerated_animation_enabled)
+    return;
+
+  double monotonic_seconds = (monotonic_time - base::TimeTicks()).InSecondsF();
+  const AnimationRegistrar::AnimationControllerMap& controllers =
+      animation_registrar_->active_animation_controllers();
+  for (AnimationRegistrar::AnimationControllerMap::const_iterator iter =
+           controllers.begin();
+       iter != controllers.end();
+       ++iter) {
+    Animation* animation =
+        iter->second->GetAnimation(Animation::ScrollOffset);
+    if (!animation || animation->run_state() != Animation::Running)
+      continue;
+    LayerImpl* layer = active_tree_->LayerById(iter->first);
+    if (!layer)
+      continue;
+
+    const ScrollOffsetAnimationCurve* curve =
+        animation->curve()->ToScrollOffsetAnimationCurve();
+    double predicted_time =
+        animation->TrimTimeToCurrentIteration(monotonic_seconds + target_time);
+    gfx::Vector2dF delta =
+        curve->GetValue(predicted_time) - layer->TotalScrollOffset();
+    gfx::Vector2dF screen_scale = MathUtil::ComputeTransform2dScaleComponents(
+        layer->screen_space_transform(), 1.f);
+    predicted_scroll_deltas_[layer->id()] +=
+        gfx::ScaleVector2d(delta, screen_scale.x(), screen_scale.y());
+  }
+}
+
 void LayerTreeHostImpl::UpdateAnimationState(bool start_ready_animations) {
   if (!settings_.accelerated_animation_enabled ||
       animation_registrar_->active_animation_controllers().empty() ||
@@ -2981,6 +3145,11 @@ void LayerTreeHostImpl::MarkUIResourceNotEvicted(UIResourceId uid) {
     client_->OnCanDrawStateChanged(CanDraw());
 }
 
+void LayerTreeHostImpl::ConsumeRasterOnDemandBudget(int64 pixels) {
+  DCHECK_LE(pixels, raster_on_demand_pixel_budget_);
+  raster_on_demand_pixel_budget_ -= pixels;
+}
+
 void LayerTreeHostImpl::ScheduleMicroBenchmark(
     scoped_ptr<MicroBenchmarkImpl> benchmark) {
   micro_benchmark_controller_.ScheduleRun(benchmark.Pass());
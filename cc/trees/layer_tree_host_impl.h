@@ -158,6 +158,9 @@ class CC_EXPORT LayerTreeHostImpl
     const LayerImplList* render_surface_layer_list;
     LayerImplList will_draw_layers;
     bool contains_incomplete_tile;
+    // The number of tiles drawn as checkerboard or background color because
+    // they weren't ready.
+    int64 missing_tile_count;
     bool has_no_damage;
 
     // RenderPassSink implementation.
@@ -218,6 +221,9 @@ class CC_EXPORT LayerTreeHostImpl
   virtual void SetFullRootLayerDamage() OVERRIDE;
 
   // TileManagerClient implementation.
+  virtual void GetPictureLayerTilings(
+      WhichTree tree,
+      std::vector<PictureLayerTiling*>* tilings) const OVERRIDE;
   virtual void NotifyReadyToActivate() OVERRIDE;
 
   // OutputSurfaceClient implementation.
@@ -381,8 +387,27 @@ class CC_EXPORT LayerTreeHostImpl
     return current_fling_velocity_;
   }
 
+  // The screen space scroll deltas, keyed by layer id, that flinging and
+  // scroll offset animations are predicted to scroll layers by within the
+  // skewport target time. Updated by Animate().
+  typedef base::hash_map<int, gfx::Vector2dF> ScrollDeltaMap;
+  const ScrollDeltaMap& predicted_scroll_deltas() const {
+    return predicted_scroll_deltas_;
+  }
+
   bool pinch_gesture_active() const { return pinch_gesture_active_; }
 
+  // The pixels of missing tiles that may still be rasterized at low
+  // resolution while drawing the frame being prepared, instead of being
+  // checkerboarded. Layers consume the budget as they append such quads.
+  int64 raster_on_demand_pixel_budget() const {
+    return raster_on_demand_pixel_budget_;
+  }
+  void ConsumeRasterOnDemandBudget(int64 pixels);
+  void SetRasterOnDemandPixelBudgetForTesting(int64 pixels) {
+    raster_on_demand_pixel_budget_ = pixels;
+  }
+
   void SetTreePriority(TreePriority priority);
 
   void ResetCurrentFrameTimeForNextFrame();
@@ -447,6 +472,8 @@ class CC_EXPORT LayerTreeHostImpl
   // Virtual for testing.
   virtual base::TimeDelta LowFrequencyAnimationInterval() const;
 
+  void UpdatePredictedScrollDeltas(base::TimeTicks monotonic_time);
+
   const AnimationRegistrar::AnimationControllerMap&
       active_animation_controllers() const {
     return animation_registrar_->active_animation_controllers();
@@ -569,6 +596,7 @@ class CC_EXPORT LayerTreeHostImpl
 
   gfx::Vector2dF accumulated_root_overscroll_;
   gfx::Vector2dF current_fling_velocity_;
+  ScrollDeltaMap predicted_scroll_deltas_;
 
   bool pinch_gesture_active_;
   bool pinch_gesture_end_should_clear_scrolling_layer_;
@@ -646,6 +674,11 @@ class CC_EXPORT LayerTreeHostImpl
   MicroBenchmarkControllerImpl micro_benchmark_controller_;
 
   bool need_to_update_visible_tiles_before_draw_;
+
+  int64 raster_on_demand_pixel_budget_;
+  // Estimated from the on demand raster of earlier frames, to turn
+  // settings_.raster_on_demand_budget_ms into a pixel budget.
+  double raster_on_demand_ms_per_pixel_;
 #ifndef NDEBUG
   bool did_lose_called_;
 #endif
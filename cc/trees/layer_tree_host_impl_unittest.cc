@@ -2893,6 +2893,44 @@ TEST_F(LayerTreeHostImplTest, OverscrollRoot) {
 }
 
 
+TEST_F(LayerTreeHostImplTest, PredictedScrollDeltaFromFling) {
+  LayerImpl* scroll_layer =
+      SetupScrollAndContentsLayers(gfx::Size(100, 100));
+  host_impl_->SetViewportSize(gfx::Size(50, 50));
+  DrawFrame();
+
+  base::TimeTicks now = gfx::FrameTime::Now();
+  host_impl_->Animate(now, base::Time());
+  EXPECT_TRUE(host_impl_->predicted_scroll_deltas().empty());
+
+  EXPECT_EQ(InputHandler::ScrollStarted,
+            host_impl_->ScrollBegin(gfx::Point(), InputHandler::Gesture));
+  EXPECT_EQ(InputHandler::ScrollStarted, host_impl_->FlingScrollBegin());
+  host_impl_->ScrollBy(gfx::Point(), gfx::Vector2d(0, 10));
+  host_impl_->NotifyCurrentFlingVelocity(gfx::Vector2dF(0, 100));
+  host_impl_->Animate(now, base::Time());
+
+  // The fling is predicted to go on for the skewport target time.
+  float target_time = host_impl_->settings().skewport_target_time_in_seconds;
+  ASSERT_EQ(1u, host_impl_->predicted_scroll_deltas().size());
+  EXPECT_VECTOR_EQ(
+      gfx::Vector2dF(0, 100 * target_time),
+      host_impl_->predicted_scroll_deltas().find(scroll_layer->id())->second);
+
+  // The prediction applies to the contents of the scrolled layer.
+  EXPECT_VECTOR_EQ(gfx::Vector2dF(0, 100 * target_time),
+                   host_impl_->active_tree()->PredictedScrollDeltaInScreenSpace(
+                       scroll_layer->children()[0]));
+  EXPECT_VECTOR_EQ(
+      gfx::Vector2dF(),
+      host_impl_->active_tree()->PredictedScrollDeltaInScreenSpace(
+          scroll_layer));
+
+  host_impl_->ScrollEnd();
+  host_impl_->Animate(now, base::Time());
+  EXPECT_TRUE(host_impl_->predicted_scroll_deltas().empty());
+}
+
 TEST_F(LayerTreeHostImplTest, OverscrollChildWithoutBubbling) {
   // Scroll child layers beyond their maximum scroll range and make sure root
   // overscroll does not accumulate.
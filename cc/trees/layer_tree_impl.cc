@@ -4,6 +4,8 @@
 
 #include "cc/trees/layer_tree_impl.h"
 
+#include <algorithm>
+
 #include "base/debug/trace_event.h"
 #include "cc/animation/keyframed_animation_curve.h"
 #include "cc/animation/scrollbar_animation_controller.h"
@@ -17,6 +19,7 @@
 #include "cc/resources/ui_resource_request.h"
 #include "cc/trees/layer_tree_host_common.h"
 #include "cc/trees/layer_tree_host_impl.h"
+#include "cc/trees/occlusion_tracker.h"
 #include "ui/gfx/size_conversions.h"
 #include "ui/gfx/vector2d_conversions.h"
 
@@ -481,22 +484,32 @@ void LayerTreeImpl::UpdateDrawProperties() {
                  source_frame_number_);
     // LayerIterator is used here instead of CallFunctionForSubtree to only
     // UpdateTilePriorities on layers that will be visible (and thus have valid
-    // draw properties) and not because any ordering is required.
+    // draw properties), and to track occlusion front to back like the draw
+    // does, so that tiles hidden under opaque layers don't get rasterized
+    // ahead of visible ones.
+    OcclusionTrackerImpl occlusion_tracker(
+        root_layer()->render_surface()->content_rect(), false);
+    occlusion_tracker.set_minimum_tracking_size(
+        settings().minimum_occlusion_tracking_size);
     typedef LayerIterator<LayerImpl> LayerIteratorType;
     LayerIteratorType end = LayerIteratorType::End(&render_surface_layer_list_);
     for (LayerIteratorType it =
              LayerIteratorType::Begin(&render_surface_layer_list_);
          it != end;
          ++it) {
-      if (!it.represents_itself())
-        continue;
-      LayerImpl* layer = *it;
+      occlusion_tracker.EnterLayer(it);
 
-      layer->UpdateTilePriorities();
-      if (layer->mask_layer())
-        layer->mask_layer()->UpdateTilePriorities();
-      if (layer->replica_layer() && layer->replica_layer()->mask_layer())
-        layer->replica_layer()->mask_layer()->UpdateTilePriorities();
+      LayerImpl* layer = *it;
+      if (it.represents_itself()) {
+        layer->UpdateTilePriorities(&occlusion_tracker);
+        // Masks are not occluded by the layers the tracker has seen.
+        if (layer->mask_layer())
+          layer->mask_layer()->UpdateTilePriorities(NULL);
+        if (layer->replica_layer() && layer->replica_layer()->mask_layer())
+          layer->replica_layer()->mask_layer()->UpdateTilePriorities(NULL);
+      }
+
+      occlusion_tracker.LeaveLayer(it);
     }
   }
 
@@ -534,6 +547,19 @@ void LayerTreeImpl::UnregisterLayer(LayerImpl* layer) {
   layer_id_map_.erase(layer->id());
 }
 
+void LayerTreeImpl::RegisterPictureLayerImpl(PictureLayerImpl* layer) {
+  DCHECK(std::find(picture_layers_.begin(), picture_layers_.end(), layer) ==
+         picture_layers_.end());
+  picture_layers_.push_back(layer);
+}
+
+void LayerTreeImpl::UnregisterPictureLayerImpl(PictureLayerImpl* layer) {
+  std::vector<PictureLayerImpl*>::iterator it =
+      std::find(picture_layers_.begin(), picture_layers_.end(), layer);
+  DCHECK(it != picture_layers_.end());
+  picture_layers_.erase(it);
+}
+
 void LayerTreeImpl::PushPersistedState(LayerTreeImpl* pending_tree) {
   pending_tree->SetCurrentlyScrollingLayer(
       LayerTreeHostCommon::FindLayerInSubtree(pending_tree->root_layer(),
@@ -684,6 +710,33 @@ base::TimeTicks LayerTreeImpl::CurrentFrameTimeTicks() const {
   return layer_tree_host_impl_->CurrentFrameTimeTicks();
 }
 
+gfx::Vector2dF LayerTreeImpl::PredictedScrollDeltaInScreenSpace(
+    const LayerImpl* layer) const {
+  const LayerTreeHostImpl::ScrollDeltaMap& scroll_deltas =
+      layer_tree_host_impl_->predicted_scroll_deltas();
+  gfx::Vector2dF delta;
+  if (scroll_deltas.empty())
+    return delta;
+
+  // Scrolling a layer moves its descendants, not the layer itself.
+  for (const LayerImpl* ancestor = layer->parent(); ancestor;
+       ancestor = ancestor->parent()) {
+    LayerTreeHostImpl::ScrollDeltaMap::const_iterator it =
+        scroll_deltas.find(ancestor->id());
+    if (it != scroll_deltas.end())
+      delta += it->second;
+  }
+  return delta;
+}
+
+int64 LayerTreeImpl::raster_on_demand_pixel_budget() const {
+  return layer_tree_host_impl_->raster_on_demand_pixel_budget();
+}
+
+void LayerTreeImpl::ConsumeRasterOnDemandBudget(int64 pixels) {
+  layer_tree_host_impl_->ConsumeRasterOnDemandBudget(pixels);
+}
+
 base::Time LayerTreeImpl::CurrentFrameTime() const {
   return layer_tree_host_impl_->CurrentFrameTime();
 }
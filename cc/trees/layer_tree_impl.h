@@ -42,6 +42,7 @@ class LayerTreeSettings;
 class MemoryHistory;
 class OutputSurface;
 class PaintTimeCounter;
+class PictureLayerImpl;
 class Proxy;
 class ResourceProvider;
 class TileManager;
@@ -82,6 +83,13 @@ class CC_EXPORT LayerTreeImpl {
   base::TimeTicks CurrentFrameTimeTicks() const;
   base::Time CurrentFrameTime() const;
   base::TimeTicks CurrentPhysicalTimeTicks() const;
+  // The screen space distance that flings and scroll offset animations of its
+  // ancestors are predicted to scroll |layer|'s contents by within the
+  // skewport target time.
+  gfx::Vector2dF PredictedScrollDeltaInScreenSpace(
+      const LayerImpl* layer) const;
+  int64 raster_on_demand_pixel_budget() const;
+  void ConsumeRasterOnDemandBudget(int64 pixels);
   void SetNeedsCommit();
   gfx::Size DrawViewportSize() const;
   void StartScrollbarAnimation();
@@ -195,6 +203,13 @@ class CC_EXPORT LayerTreeImpl {
   void RegisterLayer(LayerImpl* layer);
   void UnregisterLayer(LayerImpl* layer);
 
+  // These should be called by PictureLayerImpl's ctor/dtor.
+  void RegisterPictureLayerImpl(PictureLayerImpl* layer);
+  void UnregisterPictureLayerImpl(PictureLayerImpl* layer);
+  const std::vector<PictureLayerImpl*>& picture_layers() const {
+    return picture_layers_;
+  }
+
   AnimationRegistrar* animationRegistrar() const;
 
   void PushPersistedState(LayerTreeImpl* pending_tree);
@@ -274,6 +289,8 @@ class CC_EXPORT LayerTreeImpl {
   typedef base::hash_map<int, LayerImpl*> LayerIdMap;
   LayerIdMap layer_id_map_;
 
+  std::vector<PictureLayerImpl*> picture_layers_;
+
   std::vector<LayerImpl*> layers_with_copy_output_request_;
 
   // Persisted state for non-impl-side-painting.
@@ -16,6 +16,7 @@ LayerTreeSettings::LayerTreeSettings()
     : impl_side_painting(false),
       allow_antialiasing(true),
       throttle_frame_production(true),
+      switch_to_low_latency_if_possible(false),
       begin_impl_frame_scheduling_enabled(false),
       using_synchronous_renderer_compositor(false),
       per_tile_painting_enabled(false),
@@ -37,6 +38,7 @@ LayerTreeSettings::LayerTreeSettings()
       layer_transforms_should_scale_layer_contents(false),
       minimum_contents_scale(0.0625f),
       low_res_contents_scale_factor(0.25f),
+      raster_on_demand_budget_ms(0.0),
       top_controls_height(0.f),
       top_controls_show_threshold(0.5f),
       top_controls_hide_threshold(0.5f),
@@ -21,6 +21,7 @@ class CC_EXPORT LayerTreeSettings {
   bool impl_side_painting;
   bool allow_antialiasing;
   bool throttle_frame_production;
+  bool switch_to_low_latency_if_possible;
   bool begin_impl_frame_scheduling_enabled;
   bool using_synchronous_renderer_compositor;
   bool per_tile_painting_enabled;
@@ -48,6 +49,9 @@ class CC_EXPORT LayerTreeSettings {
   bool layer_transforms_should_scale_layer_contents;
   float minimum_contents_scale;
   float low_res_contents_scale_factor;
+  // Time per frame the renderer may spend rasterizing missing tiles at low
+  // resolution, instead of checkerboarding them. Zero disables it.
+  double raster_on_demand_budget_ms;
   float top_controls_height;
   float top_controls_show_threshold;
   float top_controls_hide_threshold;
@@ -1479,6 +1479,8 @@ void ThreadProxy::InitializeImplOnImplThread(CompletionEvent* completion) {
       settings.using_synchronous_renderer_compositor;
   scheduler_settings.throttle_frame_production =
       settings.throttle_frame_production;
+  scheduler_settings.switch_to_low_latency_if_possible =
+      settings.switch_to_low_latency_if_possible;
   impl().scheduler =
       Scheduler::Create(this, scheduler_settings, impl().layer_tree_host_id);
   impl().scheduler->SetVisible(impl().layer_tree_host_impl->visible());
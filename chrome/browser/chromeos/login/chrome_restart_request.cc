@@ -171,11 +171,13 @@ std::string DeriveCommandLine(const GURL& start_url,
       cc::switches::kEnableGpuBenchmarking,
       cc::switches::kEnableGPURasterization,
       cc::switches::kEnableImplSidePainting,
+      cc::switches::kEnableMainThreadLatencyRecovery,
       cc::switches::kEnableMapImage,
       cc::switches::kEnablePinchVirtualViewport,
       cc::switches::kEnableTopControlsPositionCalculation,
       cc::switches::kMaxTilesForInterestArea,
       cc::switches::kMaxUnusedResourceMemoryUsagePercentage,
+      cc::switches::kRasterOnDemandBudgetMs,
       cc::switches::kShowCompositedLayerBorders,
       cc::switches::kShowFPSCounter,
       cc::switches::kShowLayerAnimationBounds,
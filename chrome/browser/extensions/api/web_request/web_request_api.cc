@@ -2015,7 +2015,7 @@ bool ExtensionWebRequestEventRouter::ProcessDeclarativeRules(
     }
   }
 
-  base::TimeDelta elapsed_time = start - base::Time::Now();
+  base::TimeDelta elapsed_time = base::Time::Now() - start;
   UMA_HISTOGRAM_TIMES("Extensions.DeclarativeWebRequestNetworkDelay",
                       elapsed_time);
 
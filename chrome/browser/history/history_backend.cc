@@ -278,6 +278,7 @@ SegmentID HistoryBackend::GetLastSegmentID(VisitID from_visit) {
 
 SegmentID HistoryBackend::UpdateSegments(
     const GURL& url,
+    URLID url_id,
     VisitID from_visit,
     VisitID visit_id,
     content::PageTransition transition_type,
@@ -311,7 +312,6 @@ SegmentID HistoryBackend::UpdateSegments(
       (transition_type & content::PAGE_TRANSITION_FORWARD_BACK) == 0) {
     // If so, create or get the segment.
     std::string segment_name = db_->ComputeSegmentName(url);
-    URLID url_id = db_->GetRowForURL(url, NULL);
     if (!url_id)
       return 0;
 
@@ -441,8 +441,8 @@ void HistoryBackend::AddPage(const HistoryAddPageArgs& request) {
     // result in changing most visited, so we don't update segments (most
     // visited db).
     if (!is_keyword_generated) {
-      UpdateSegments(request.url, from_visit_id, last_ids.second, t,
-                     request.time);
+      UpdateSegments(request.url, last_ids.first, from_visit_id,
+                     last_ids.second, t, request.time);
 
       // Update the referrer's duration.
       UpdateVisitDuration(from_visit_id, request.time);
@@ -514,7 +514,7 @@ void HistoryBackend::AddPage(const HistoryAddPageArgs& request) {
                               t, request.visit_source);
       if (t & content::PAGE_TRANSITION_CHAIN_START) {
         // Update the segment for this visit.
-        UpdateSegments(redirects[redirect_index],
+        UpdateSegments(redirects[redirect_index], last_ids.first,
                        from_visit_id, last_ids.second, t, request.time);
 
         // Update the visit_details for this visit.
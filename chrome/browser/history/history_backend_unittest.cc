@@ -17,6 +17,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
 #include "base/run_loop.h"
+#include "base/stl_util.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
@@ -29,6 +30,7 @@
 #include "chrome/browser/history/history_service_factory.h"
 #include "chrome/browser/history/in_memory_database.h"
 #include "chrome/browser/history/in_memory_history_backend.h"
+#include "chrome/browser/history/page_usage_data.h"
 #include "chrome/browser/history/visit_filter.h"
 #include "chrome/common/chrome_constants.h"
 #include "chrome/common/chrome_paths.h"
@@ -893,6 +895,51 @@ TEST_F(HistoryBackendTest, StripUsernamePasswordTest) {
   ASSERT_EQ(1U, visits.size());
 }
 
+// Segment visit counts are buffered between commits.  Buffered counts must
+// be visible to segment queries and add up to what one write per visit
+// would give.
+TEST_F(HistoryBackendTest, SegmentVisitCountsCoalesced) {
+  ASSERT_TRUE(backend_.get());
+
+  const GURL url1("http://www.google.com/");
+  const GURL url2("http://www.example.com/");
+  const Time visit_time = Time::Now() - base::TimeDelta::FromHours(1);
+  for (int i = 0; i < 3; ++i) {
+    HistoryAddPageArgs request1(url1, visit_time, NULL, 0, GURL(),
+                                history::RedirectList(),
+                                content::PAGE_TRANSITION_TYPED,
+                                history::SOURCE_BROWSED, false);
+    backend_->AddPage(request1);
+
+    HistoryAddPageArgs request2(url2, visit_time, NULL, 0, GURL(),
+                                history::RedirectList(),
+                                content::PAGE_TRANSITION_TYPED,
+                                history::SOURCE_BROWSED, false);
+    backend_->AddPage(request2);
+    backend_->Commit();
+  }
+
+  // One more visit to each, left in the buffer.
+  HistoryAddPageArgs request1(url1, visit_time, NULL, 0, GURL(),
+                              history::RedirectList(),
+                              content::PAGE_TRANSITION_TYPED,
+                              history::SOURCE_BROWSED, false);
+  backend_->AddPage(request1);
+  HistoryAddPageArgs request2(url2, visit_time, NULL, 0, GURL(),
+                              history::RedirectList(),
+                              content::PAGE_TRANSITION_TYPED,
+                              history::SOURCE_BROWSED, false);
+  backend_->AddPage(request2);
+
+  std::vector<PageUsageData*> results;
+  backend_->db_->QuerySegmentUsage(visit_time - base::TimeDelta::FromDays(1),
+                                   10, &results);
+  ASSERT_EQ(2u, results.size());
+  EXPECT_GT(results[0]->GetScore(), 0.0);
+  EXPECT_DOUBLE_EQ(results[0]->GetScore(), results[1]->GetScore());
+  STLDeleteElements(&results);
+}
+
 TEST_F(HistoryBackendTest, AddPageVisitSource) {
   ASSERT_TRUE(backend_.get());
 
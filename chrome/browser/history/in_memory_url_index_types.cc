@@ -12,12 +12,66 @@
 
 #include "base/i18n/break_iterator.h"
 #include "base/i18n/case_conversion.h"
+#include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "net/base/escape.h"
 #include "net/base/net_util.h"
 
 namespace history {
 
+namespace {
+
+// Appends |value| to |output| as a varint: seven bits to a byte, least
+// significant first, with the high bit set on all but the last byte.
+template <typename Container>
+void AppendVarint(uint64 value, Container* output) {
+  typedef typename Container::value_type Byte;
+  while (value >= 0x80) {
+    output->push_back(static_cast<Byte>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<Byte>(value));
+}
+
+// Reads the varint at |*offset| in the |size| bytes at |data| into |value|
+// and advances |*offset| past it. Returns false if the data ends first or the
+// varint does not fit in 64 bits.
+bool ReadVarint(const uint8* data, size_t size, size_t* offset,
+                uint64* value) {
+  uint64 result = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*offset >= size)
+      return false;
+    uint8 byte = data[(*offset)++];
+    result |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Decodes the output of PostingList::Encode() in |input| into |ids|. Returns
+// false unless |input| holds a strictly increasing sequence of IDs.
+bool DecodeIDs(const std::string& input, std::vector<uint64>* ids) {
+  ids->clear();
+  const uint8* data = reinterpret_cast<const uint8*>(input.data());
+  uint64 value = 0;
+  for (size_t offset = 0; offset < input.size(); ) {
+    uint64 delta = 0;
+    if (!ReadVarint(data, input.size(), &offset, &delta))
+      return false;
+    if ((!ids->empty() && delta == 0) || value + delta < value)
+      return false;
+    value += delta;
+    ids->push_back(value);
+  }
+  return true;
+}
+
+}  // namespace
+
 // Matches within URL and Title Strings ----------------------------------------
 
 // The maximum length of URL or title returned by the Cleanup functions.
@@ -169,6 +223,371 @@ Char16Set Char16SetFromString16(const base::string16& term) {
   return characters;
 }
 
+// PostingList -----------------------------------------------------------------
+
+PostingList::const_iterator::const_iterator()
+    : list_(NULL),
+      block_(0),
+      remaining_(0),
+      offset_(0),
+      value_(0) {
+}
+
+PostingList::const_iterator::const_iterator(const PostingList* list,
+                                            size_t block)
+    : list_(list),
+      block_(block),
+      remaining_(0),
+      offset_(0),
+      value_(0) {
+  LoadBlock();
+}
+
+PostingList::const_iterator& PostingList::const_iterator::operator++() {
+  if (remaining_ == 0) {
+    ++block_;
+    LoadBlock();
+    return *this;
+  }
+  uint64 delta = 0;
+  bool valid = ReadVarint(&list_->data_[0], list_->data_.size(), &offset_,
+                          &delta);
+  DCHECK(valid);
+  value_ += delta;
+  --remaining_;
+  return *this;
+}
+
+bool PostingList::const_iterator::operator==(
+    const const_iterator& other) const {
+  return list_ == other.list_ && block_ == other.block_ &&
+      remaining_ == other.remaining_;
+}
+
+void PostingList::const_iterator::LoadBlock() {
+  if (block_ >= list_->blocks_.size()) {
+    remaining_ = 0;
+    return;
+  }
+  const Block& block = list_->blocks_[block_];
+  value_ = block.first;
+  remaining_ = block.count - 1;
+  offset_ = block.offset;
+}
+
+PostingList::PostingList() : size_(0), last_(0) {}
+
+PostingList::~PostingList() {}
+
+PostingList::const_iterator PostingList::begin() const {
+  return const_iterator(this, 0);
+}
+
+PostingList::const_iterator PostingList::end() const {
+  return const_iterator(this, blocks_.size());
+}
+
+size_t PostingList::count(uint64 id) const {
+  if (empty() || id > last_ || id < blocks_[0].first)
+    return 0;
+  const Block& block = blocks_[FindBlock(id)];
+  uint64 value = block.first;
+  size_t offset = block.offset;
+  for (uint32 i = 1; value < id && i < block.count; ++i) {
+    uint64 delta = 0;
+    ReadVarint(&data_[0], data_.size(), &offset, &delta);
+    value += delta;
+  }
+  return value == id ? 1 : 0;
+}
+
+bool PostingList::insert(uint64 id) {
+  if (empty() || id > last_) {
+    if (!empty() && blocks_.back().count < kBlockSize) {
+      AppendVarint(id - last_, &data_);
+      ++blocks_.back().count;
+    } else {
+      Block block = { id, static_cast<uint32>(data_.size()), 1 };
+      blocks_.push_back(block);
+    }
+    last_ = id;
+    ++size_;
+    return true;
+  }
+
+  size_t index = FindBlock(id);
+  std::vector<uint64> ids;
+  DecodeBlock(index, &ids);
+  std::vector<uint64>::iterator pos =
+      std::lower_bound(ids.begin(), ids.end(), id);
+  if (pos != ids.end() && *pos == id)
+    return false;
+  ids.insert(pos, id);
+  ReplaceBlock(index, ids);
+  ++size_;
+  return true;
+}
+
+bool PostingList::erase(uint64 id) {
+  if (!count(id))
+    return false;
+  size_t index = FindBlock(id);
+  std::vector<uint64> ids;
+  DecodeBlock(index, &ids);
+  ids.erase(std::lower_bound(ids.begin(), ids.end(), id));
+  ReplaceBlock(index, ids);
+  --size_;
+  if (id == last_ && !blocks_.empty()) {
+    DecodeBlock(blocks_.size() - 1, &ids);
+    last_ = ids.back();
+  }
+  return true;
+}
+
+void PostingList::clear() {
+  blocks_.clear();
+  data_.clear();
+  size_ = 0;
+  last_ = 0;
+}
+
+void PostingList::swap(PostingList& other) {
+  blocks_.swap(other.blocks_);
+  data_.swap(other.data_);
+  std::swap(size_, other.size_);
+  std::swap(last_, other.last_);
+}
+
+void PostingList::Encode(std::string* output) const {
+  output->clear();
+  uint64 previous = 0;
+  for (const_iterator iter = begin(); iter != end(); ++iter) {
+    AppendVarint(*iter - previous, output);
+    previous = *iter;
+  }
+}
+
+bool PostingList::Decode(const std::string& input) {
+  clear();
+  std::vector<uint64> ids;
+  if (!DecodeIDs(input, &ids))
+    return false;
+  data_.reserve(input.size());
+  for (std::vector<uint64>::const_iterator iter = ids.begin();
+       iter != ids.end(); ++iter)
+    insert(*iter);
+  return true;
+}
+
+size_t PostingList::FindBlock(uint64 id) const {
+  // Find the first block that starts after |id|; the one before holds it.
+  size_t low = 0;
+  size_t high = blocks_.size();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (blocks_[middle].first <= id)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low == 0 ? 0 : low - 1;
+}
+
+size_t PostingList::BlockEnd(size_t index) const {
+  return index + 1 < blocks_.size() ? blocks_[index + 1].offset : data_.size();
+}
+
+void PostingList::DecodeBlock(size_t index, std::vector<uint64>* ids) const {
+  const Block& block = blocks_[index];
+  ids->clear();
+  ids->reserve(block.count);
+  uint64 value = block.first;
+  ids->push_back(value);
+  size_t offset = block.offset;
+  for (uint32 i = 1; i < block.count; ++i) {
+    uint64 delta = 0;
+    ReadVarint(&data_[0], data_.size(), &offset, &delta);
+    value += delta;
+    ids->push_back(value);
+  }
+}
+
+void PostingList::ReplaceBlock(size_t index, const std::vector<uint64>& ids) {
+  size_t begin = blocks_[index].offset;
+  size_t end = BlockEnd(index);
+
+  // Re-encode the IDs, splitting them into blocks of kBlockSize if there are
+  // too many for one.
+  std::vector<Block> new_blocks;
+  std::vector<uint8> bytes;
+  size_t chunk = ids.size() >= 2 * kBlockSize ? kBlockSize : ids.size();
+  for (size_t i = 0; i < ids.size(); i += chunk) {
+    Block block = { ids[i], static_cast<uint32>(begin + bytes.size()),
+                    static_cast<uint32>(std::min(chunk, ids.size() - i)) };
+    for (size_t j = i + 1; j < i + block.count; ++j)
+      AppendVarint(ids[j] - ids[j - 1], &bytes);
+    new_blocks.push_back(block);
+  }
+
+  data_.erase(data_.begin() + begin, data_.begin() + end);
+  data_.insert(data_.begin() + begin, bytes.begin(), bytes.end());
+  for (size_t i = index + 1; i < blocks_.size(); ++i)
+    blocks_[i].offset = blocks_[i].offset + bytes.size() - (end - begin);
+  blocks_.erase(blocks_.begin() + index);
+  blocks_.insert(blocks_.begin() + index, new_blocks.begin(),
+                 new_blocks.end());
+}
+
+// WordIDBitmap ----------------------------------------------------------------
+
+WordIDBitmap::const_iterator::const_iterator()
+    : bitmap_(NULL),
+      position_(0) {
+}
+
+WordIDBitmap::const_iterator::const_iterator(const WordIDBitmap* bitmap,
+                                             size_t position)
+    : bitmap_(bitmap),
+      position_(position) {
+  SkipClearBits();
+}
+
+WordID WordIDBitmap::const_iterator::operator*() const {
+  return bitmap_->is_dense() ? position_ : bitmap_->ids_[position_];
+}
+
+WordIDBitmap::const_iterator& WordIDBitmap::const_iterator::operator++() {
+  ++position_;
+  SkipClearBits();
+  return *this;
+}
+
+void WordIDBitmap::const_iterator::SkipClearBits() {
+  if (!bitmap_ || !bitmap_->is_dense())
+    return;
+  const std::vector<uint32>& bits = bitmap_->bits_;
+  while (position_ < bits.size() * 32) {
+    uint32 word = bits[position_ / 32] >> (position_ % 32);
+    if (word) {
+      for (; !(word & 1); word >>= 1)
+        ++position_;
+      return;
+    }
+    position_ = (position_ / 32 + 1) * 32;
+  }
+}
+
+WordIDBitmap::WordIDBitmap() : size_(0) {}
+
+WordIDBitmap::~WordIDBitmap() {}
+
+WordIDBitmap::const_iterator WordIDBitmap::begin() const {
+  return const_iterator(this, 0);
+}
+
+WordIDBitmap::const_iterator WordIDBitmap::end() const {
+  return const_iterator(this, is_dense() ? bits_.size() * 32 : ids_.size());
+}
+
+size_t WordIDBitmap::count(WordID word_id) const {
+  if (is_dense()) {
+    size_t index = word_id / 32;
+    return index < bits_.size() && ((bits_[index] >> (word_id % 32)) & 1);
+  }
+  return std::binary_search(ids_.begin(), ids_.end(),
+                            static_cast<uint32>(word_id)) ? 1 : 0;
+}
+
+bool WordIDBitmap::insert(WordID word_id) {
+  DCHECK_LE(word_id, kuint32max);
+  if (is_dense()) {
+    size_t index = word_id / 32;
+    if (index >= bits_.size())
+      bits_.resize(index + 1, 0);
+    uint32 mask = 1u << (word_id % 32);
+    if (bits_[index] & mask)
+      return false;
+    bits_[index] |= mask;
+  } else {
+    uint32 id = static_cast<uint32>(word_id);
+    std::vector<uint32>::iterator pos =
+        std::lower_bound(ids_.begin(), ids_.end(), id);
+    if (pos != ids_.end() && *pos == id)
+      return false;
+    ids_.insert(pos, id);
+  }
+  ++size_;
+  MaybeSwitchForm();
+  return true;
+}
+
+bool WordIDBitmap::erase(WordID word_id) {
+  if (!count(word_id))
+    return false;
+  if (is_dense()) {
+    bits_[word_id / 32] &= ~(1u << (word_id % 32));
+  } else {
+    ids_.erase(std::lower_bound(ids_.begin(), ids_.end(),
+                                static_cast<uint32>(word_id)));
+  }
+  --size_;
+  MaybeSwitchForm();
+  return true;
+}
+
+void WordIDBitmap::clear() {
+  ids_.clear();
+  bits_.clear();
+  size_ = 0;
+}
+
+void WordIDBitmap::Encode(std::string* output) const {
+  output->clear();
+  WordID previous = 0;
+  for (const_iterator iter = begin(); iter != end(); ++iter) {
+    AppendVarint(*iter - previous, output);
+    previous = *iter;
+  }
+}
+
+bool WordIDBitmap::Decode(const std::string& input) {
+  clear();
+  std::vector<uint64> ids;
+  if (!DecodeIDs(input, &ids) || (!ids.empty() && ids.back() > kuint32max))
+    return false;
+  ids_.assign(ids.begin(), ids.end());
+  size_ = ids_.size();
+  MaybeSwitchForm();
+  return true;
+}
+
+void WordIDBitmap::MaybeSwitchForm() {
+  // The sparse form costs 32 bits per WordID in the set, the dense form one
+  // bit per WordID up to the largest in the set.
+  if (!is_dense()) {
+    if (ids_.empty() || size_ <= ids_.back() / 32 + 1)
+      return;
+    std::vector<uint32> bits(ids_.back() / 32 + 1, 0);
+    for (std::vector<uint32>::const_iterator iter = ids_.begin();
+         iter != ids_.end(); ++iter)
+      bits[*iter / 32] |= 1u << (*iter % 32);
+    bits_.swap(bits);
+    std::vector<uint32>().swap(ids_);
+    return;
+  }
+
+  while (!bits_.empty() && !bits_.back())
+    bits_.pop_back();
+  if (size_ * 2 >= bits_.size())
+    return;
+  std::vector<uint32> ids;
+  ids.reserve(size_);
+  for (const_iterator iter = begin(); iter != end(); ++iter)
+    ids.push_back(static_cast<uint32>(*iter));
+  ids_.swap(ids);
+  std::vector<uint32>().swap(bits_);
+}
+
 // HistoryInfoMapValue ---------------------------------------------------------
 
 HistoryInfoMapValue::HistoryInfoMapValue() {}
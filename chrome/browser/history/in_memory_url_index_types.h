@@ -5,10 +5,14 @@
 #ifndef CHROME_BROWSER_HISTORY_IN_MEMORY_URL_INDEX_TYPES_H_
 #define CHROME_BROWSER_HISTORY_IN_MEMORY_URL_INDEX_TYPES_H_
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
+#include "base/basictypes.h"
 #include "base/strings/string16.h"
 #include "chrome/browser/autocomplete/history_provider_util.h"
 #include "chrome/browser/history/history_types.h"
@@ -141,16 +145,222 @@ typedef size_t WordID;
 // A map allowing a WordID to be determined given a word.
 typedef std::map<base::string16, WordID> WordMap;
 
-// A map from character to the word_ids of words containing that character.
 typedef std::set<WordID> WordIDSet;  // An index into the WordList.
-typedef std::map<base::char16, WordIDSet> CharWordIDMap;
+typedef std::vector<WordID> WordIDVector;
 
-// A map from word (by word_id) to history items containing that word.
 typedef history::URLID HistoryID;
-typedef std::set<HistoryID> HistoryIDSet;
 typedef std::vector<HistoryID> HistoryIDVector;
-typedef std::map<WordID, HistoryIDSet> WordIDHistoryMap;
-typedef std::map<HistoryID, WordIDSet> HistoryIDWordMap;
+
+// A sorted set of IDs, stored as varint-encoded deltas. The IDs are split
+// into blocks of roughly kBlockSize, each headed by its first ID, so that a
+// lookup or update decodes a single block, and appending an ID larger than
+// all others (the common case, as new history items get the largest IDs)
+// writes only its delta. The interface follows std::set so that the list can
+// be used in its place.
+class PostingList {
+ public:
+  typedef uint64 value_type;
+
+  // Visits the IDs in ascending order.
+  class const_iterator
+      : public std::iterator<std::forward_iterator_tag, uint64> {
+   public:
+    const_iterator();
+
+    uint64 operator*() const { return value_; }
+    const_iterator& operator++();
+    bool operator==(const const_iterator& other) const;
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class PostingList;
+    const_iterator(const PostingList* list, size_t block);
+
+    // Positions the iterator at the first ID of |block_|.
+    void LoadBlock();
+
+    const PostingList* list_;
+    size_t block_;
+    size_t remaining_;  // The number of IDs in |block_| after |value_|.
+    size_t offset_;  // The offset in |list_->data_| of the next delta.
+    uint64 value_;
+  };
+
+  PostingList();
+  ~PostingList();
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns 1 if |id| is in the list, otherwise 0.
+  size_t count(uint64 id) const;
+
+  // Adds |id| and returns true unless it is already in the list.
+  bool insert(uint64 id);
+
+  // Removes |id| and returns true if it was in the list.
+  bool erase(uint64 id);
+
+  void clear();
+  void swap(PostingList& other);
+
+  // Serializes the list as the varint-encoded deltas between successive IDs,
+  // the first from zero, replacing the contents of |output|.
+  void Encode(std::string* output) const;
+
+  // Replaces the contents of the list with those serialized by Encode() in
+  // |input|. Returns false, leaving the list empty, if |input| is malformed.
+  bool Decode(const std::string& input);
+
+ private:
+  struct Block {
+    uint64 first;  // The smallest ID in the block.
+    uint32 offset;  // The offset in |data_| of the deltas of the other IDs.
+    uint32 count;  // The number of IDs in the block, including |first|.
+  };
+
+  // Blocks are split once they reach twice this many IDs.
+  static const size_t kBlockSize = 64;
+
+  // Returns the index of the block that holds, or would hold, |id|.
+  size_t FindBlock(uint64 id) const;
+
+  // Returns the offset in |data_| just past the deltas of block |index|.
+  size_t BlockEnd(size_t index) const;
+
+  // Decodes the IDs of block |index| into |ids|.
+  void DecodeBlock(size_t index, std::vector<uint64>* ids) const;
+
+  // Replaces block |index| with as many blocks as are needed to hold |ids|,
+  // which may be empty.
+  void ReplaceBlock(size_t index, const std::vector<uint64>& ids);
+
+  std::vector<Block> blocks_;
+  std::vector<uint8> data_;
+  size_t size_;
+  uint64 last_;  // The largest ID, valid only if |size_| is non-zero.
+};
+
+// The set of WordIDs of the words containing one character. A character that
+// occurs in a good share of the words, as most ASCII letters do, is kept as a
+// flat bitmap over the WordIDs so that membership tests are a single bit test.
+// A rare one, as most CJK characters are, is kept as a sorted array so that it
+// does not cost a bit for every word in the index. The interface follows
+// std::set so that the bitmap can be used in its place.
+class WordIDBitmap {
+ public:
+  typedef WordID value_type;
+
+  // Visits the WordIDs in ascending order.
+  class const_iterator
+      : public std::iterator<std::forward_iterator_tag, WordID> {
+   public:
+    const_iterator();
+
+    WordID operator*() const;
+    const_iterator& operator++();
+    bool operator==(const const_iterator& other) const {
+      return bitmap_ == other.bitmap_ && position_ == other.position_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class WordIDBitmap;
+    const_iterator(const WordIDBitmap* bitmap, size_t position);
+
+    // Advances |position_| to the next set bit at or after it.
+    void SkipClearBits();
+
+    const WordIDBitmap* bitmap_;
+    // An index into |bitmap_->ids_|, or a WordID if |bitmap_| is dense.
+    size_t position_;
+  };
+
+  WordIDBitmap();
+  ~WordIDBitmap();
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool is_dense() const { return !bits_.empty(); }
+
+  // Returns 1 if |word_id| is in the set, otherwise 0.
+  size_t count(WordID word_id) const;
+
+  // Adds |word_id| and returns true unless it is already in the set.
+  bool insert(WordID word_id);
+
+  // Removes |word_id| and returns true if it was in the set.
+  bool erase(WordID word_id);
+
+  void clear();
+
+  // Serializes the set in the same format as PostingList::Encode().
+  void Encode(std::string* output) const;
+
+  // Replaces the contents of the set with those serialized by Encode() in
+  // |input|. Returns false, leaving the set empty, if |input| is malformed.
+  bool Decode(const std::string& input);
+
+ private:
+  // Switches between the sparse and dense forms when the other would be
+  // smaller, with some slack so that a set near the boundary does not switch
+  // back and forth.
+  void MaybeSwitchForm();
+
+  // Sorted WordIDs, used when the set is sparse.
+  std::vector<uint32> ids_;
+  // One bit per WordID, used when the set is dense.
+  std::vector<uint32> bits_;
+  size_t size_;
+};
+
+// A map from character to the word_ids of words containing that character.
+typedef std::map<base::char16, WordIDBitmap> CharWordIDMap;
+
+// A map from word (by word_id, which indexes the vector) to history items
+// containing that word.
+typedef std::vector<PostingList> WordIDHistoryMap;
+typedef std::map<HistoryID, PostingList> HistoryIDWordMap;
+
+// Intersects the sorted, duplicate-free vectors |a| and |b| into |result|.
+// Each element of the shorter vector is looked up in the longer one by
+// galloping, i.e. an exponential search forward from the previous match
+// followed by a binary search, so the cost grows with the size of the shorter
+// vector and only logarithmically with that of the longer one.
+template <typename T>
+void IntersectSorted(const std::vector<T>& a,
+                     const std::vector<T>& b,
+                     std::vector<T>* result) {
+  const std::vector<T>& shorter(a.size() <= b.size() ? a : b);
+  const std::vector<T>& longer(a.size() <= b.size() ? b : a);
+  result->clear();
+  typename std::vector<T>::const_iterator low = longer.begin();
+  for (typename std::vector<T>::const_iterator iter = shorter.begin();
+       iter != shorter.end() && low != longer.end(); ++iter) {
+    typename std::vector<T>::const_iterator high = low;
+    size_t step = 1;
+    while (high != longer.end() && *high < *iter) {
+      low = high;
+      high += std::min(step, static_cast<size_t>(longer.end() - high));
+      step *= 2;
+    }
+    low = std::lower_bound(low, high, *iter);
+    if (low != longer.end() && *low == *iter) {
+      result->push_back(*iter);
+      ++low;
+    }
+  }
+}
 
 
 // Information used in scoring a particular URL.
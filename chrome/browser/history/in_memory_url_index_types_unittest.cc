@@ -3,6 +3,9 @@
 // found in the LICENSE file.
 
 #include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "base/strings/string16.h"
 #include "base/strings/utf_string_conversions.h"
@@ -147,4 +150,105 @@ TEST_F(InMemoryURLIndexTypesTest, OffsetsAndTermMatches) {
     EXPECT_EQ(expected_offsets_b[i], matches_b[i].offset);
 }
 
+TEST_F(InMemoryURLIndexTypesTest, PostingList) {
+  // Insert more IDs than fit in one block, out of order, and compare against
+  // a std::set.
+  PostingList list;
+  std::set<uint64> expected;
+  for (uint64 i = 0; i < 1000; ++i) {
+    uint64 id = (i * 7919) % 1000 * 3;
+    EXPECT_TRUE(list.insert(id));
+    expected.insert(id);
+  }
+  EXPECT_FALSE(list.insert(3));
+  EXPECT_EQ(expected.size(), list.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), list.begin()));
+  EXPECT_EQ(1U, list.count(2997));
+  EXPECT_EQ(0U, list.count(2998));
+  EXPECT_EQ(0U, list.count(3000));
+
+  for (uint64 id = 0; id < 3000; id += 6) {
+    EXPECT_TRUE(list.erase(id));
+    expected.erase(id);
+  }
+  EXPECT_FALSE(list.erase(6));
+  EXPECT_EQ(expected.size(), list.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), list.begin()));
+
+  // Round trip through the cache encoding.
+  std::string encoded;
+  list.Encode(&encoded);
+  PostingList decoded;
+  ASSERT_TRUE(decoded.Decode(encoded));
+  EXPECT_EQ(expected.size(), decoded.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), decoded.begin()));
+
+  // IDs must be strictly increasing.
+  EXPECT_FALSE(decoded.Decode(std::string("\x01\x00", 2)));
+  EXPECT_TRUE(decoded.empty());
+  // A truncated varint.
+  EXPECT_FALSE(decoded.Decode(std::string("\x80")));
+}
+
+TEST_F(InMemoryURLIndexTypesTest, WordIDBitmap) {
+  WordIDBitmap bitmap;
+  EXPECT_TRUE(bitmap.insert(100000));
+  EXPECT_TRUE(bitmap.insert(5));
+  EXPECT_FALSE(bitmap.insert(5));
+  // Two far apart WordIDs are cheaper to keep as an array.
+  EXPECT_FALSE(bitmap.is_dense());
+  EXPECT_EQ(1U, bitmap.count(5));
+  EXPECT_EQ(0U, bitmap.count(6));
+
+  // Once most WordIDs are in the set it switches to a bitmap.
+  std::set<WordID> expected;
+  expected.insert(5);
+  expected.insert(100000);
+  for (WordID word_id = 0; word_id < 100000; word_id += 2) {
+    bitmap.insert(word_id);
+    expected.insert(word_id);
+  }
+  EXPECT_TRUE(bitmap.is_dense());
+  EXPECT_EQ(expected.size(), bitmap.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), bitmap.begin()));
+  EXPECT_EQ(1U, bitmap.count(100000));
+  EXPECT_EQ(0U, bitmap.count(99999));
+
+  std::string encoded;
+  bitmap.Encode(&encoded);
+  WordIDBitmap decoded;
+  ASSERT_TRUE(decoded.Decode(encoded));
+  EXPECT_TRUE(decoded.is_dense());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), decoded.begin()));
+
+  // And back to an array as it empties.
+  for (WordID word_id = 0; word_id < 99990; word_id += 2)
+    EXPECT_TRUE(bitmap.erase(word_id));
+  EXPECT_FALSE(bitmap.is_dense());
+  EXPECT_EQ(7U, bitmap.size());
+  EXPECT_EQ(5U, *bitmap.begin());
+}
+
+TEST_F(InMemoryURLIndexTypesTest, IntersectSorted) {
+  std::vector<HistoryID> common;
+  for (HistoryID id = 0; id < 10000; ++id)
+    common.push_back(id);
+  std::vector<HistoryID> rare;
+  rare.push_back(-1);
+  rare.push_back(7);
+  rare.push_back(4096);
+  rare.push_back(9999);
+  rare.push_back(10000);
+  std::vector<HistoryID> result;
+  IntersectSorted(common, rare, &result);
+  ASSERT_EQ(3U, result.size());
+  EXPECT_EQ(7, result[0]);
+  EXPECT_EQ(4096, result[1]);
+  EXPECT_EQ(9999, result[2]);
+  IntersectSorted(rare, common, &result);
+  EXPECT_EQ(3U, result.size());
+  IntersectSorted(rare, std::vector<HistoryID>(), &result);
+  EXPECT_TRUE(result.empty());
+}
+
 }  // namespace history
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <vector>
 
 #include "base/auto_reset.h"
 #include "base/file_util.h"
@@ -13,6 +14,7 @@
 #include "base/path_service.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "chrome/browser/autocomplete/autocomplete_provider.h"
 #include "chrome/browser/bookmarks/bookmark_test_helpers.h"
@@ -33,6 +35,7 @@
 #include "content/public/test/test_browser_thread.h"
 #include "sql/transaction.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
 
 using base::ASCIIToUTF16;
 using content::BrowserThread;
@@ -337,6 +340,19 @@ void ExpectMapOfContainersIdentical(const T& expected, const T& actual) {
   }
 }
 
+// Helper function which compares two vectors of containers for equivalence,
+// including the contents of the containers.
+template<typename T>
+void ExpectVectorOfContainersIdentical(const std::vector<T>& expected,
+                                       const std::vector<T>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i].size(), actual[i].size());
+    EXPECT_TRUE(std::equal(expected[i].begin(), expected[i].end(),
+                           actual[i].begin()));
+  }
+}
+
 void InMemoryURLIndexTest::ExpectPrivateDataEqual(
     const URLIndexPrivateData& expected,
     const URLIndexPrivateData& actual) {
@@ -356,8 +372,8 @@ void InMemoryURLIndexTest::ExpectPrivateDataEqual(
 
   ExpectMapOfContainersIdentical(expected.char_word_map_,
                                  actual.char_word_map_);
-  ExpectMapOfContainersIdentical(expected.word_id_history_map_,
-                                 actual.word_id_history_map_);
+  ExpectVectorOfContainersIdentical(expected.word_id_history_map_,
+                                    actual.word_id_history_map_);
   ExpectMapOfContainersIdentical(expected.history_id_word_map_,
                                  actual.history_id_word_map_);
 
@@ -668,6 +684,54 @@ TEST_F(InMemoryURLIndexTest, HugeResultSet) {
             private_data.post_scoring_item_count_);
 }
 
+TEST_F(InMemoryURLIndexTest, ScoringCutoff) {
+  // Create many qualifying history items, each with a single link visit a
+  // day older than the last, and three with ten typed visits today.
+  const base::Time now = base::Time::Now();
+  URLIndexPrivateData& private_data(*GetPrivateData());
+  for (URLID row_id = 5000; row_id < 5400; ++row_id) {
+    URLRow new_row(GURL(base::StringPrintf("http://www.bulk%d.com/",
+                                           static_cast<int>(row_id))),
+                   row_id);
+    new_row.set_last_visit(now);
+    EXPECT_TRUE(UpdateURL(new_row));
+    VisitVector visits;
+    if (row_id < 5003) {
+      for (int i = 0; i < 10; ++i) {
+        visits.push_back(VisitRow(row_id, now, 0,
+                                  content::PAGE_TRANSITION_TYPED, 0));
+      }
+    } else {
+      visits.push_back(VisitRow(
+          row_id,
+          now - base::TimeDelta::FromDays(static_cast<int>(row_id - 5000)), 0,
+          content::PAGE_TRANSITION_LINK, 0));
+    }
+    private_data.UpdateRecentVisits(row_id, visits);
+  }
+
+  const int kIterations = 50;
+  ScoredHistoryMatches matches;
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    matches = url_index_->HistoryItemsForTerms(ASCIIToUTF16("bulk"),
+                                               base::string16::npos);
+  }
+  perf_test::PrintResult(
+      "hqp_scoring", "", "bulk",
+      (base::TimeTicks::Now() - start).InMillisecondsF() / kIterations, "ms",
+      true);
+
+  // Only the typed items need to be scored: no other item's visits can earn
+  // it a score as high as theirs.
+  ASSERT_EQ(AutocompleteProvider::kMaxMatches, matches.size());
+  for (size_t i = 0; i < matches.size(); ++i)
+    EXPECT_LT(matches[i].url_info.id(), 5003);
+  EXPECT_EQ(400U, private_data.pre_filter_item_count_);
+  EXPECT_EQ(AutocompleteProvider::kMaxMatches,
+            private_data.scored_item_count_);
+}
+
 TEST_F(InMemoryURLIndexTest, TitleSearch) {
   // Signal if someone has changed the test DB.
   EXPECT_EQ(29U, GetPrivateData()->history_info_map_.size());
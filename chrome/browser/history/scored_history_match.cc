@@ -208,6 +208,28 @@ ScoredHistoryMatch::ScoredHistoryMatch(const URLRow& row,
 
 ScoredHistoryMatch::~ScoredHistoryMatch() {}
 
+// static
+int ScoredHistoryMatch::GetMaxRawScore(const VisitInfoVector& visits,
+                                       const base::Time now) {
+  Init();
+  if (also_do_hup_like_scoring_)
+    return kint32max;
+  if (raw_term_score_to_topicality_score_ == NULL) {
+    raw_term_score_to_topicality_score_ = new float[kMaxRawTermScore];
+    FillInTermScoreToTopicalityScoreArray();
+  }
+  // The topicality score is an average of per-term scores, none of which
+  // exceeds that of the largest bucket, and the frecency score is largest
+  // when every visit is given a bookmarked item's value.
+  const float max_topicality_score =
+      raw_term_score_to_topicality_score_[kMaxRawTermScore - 1];
+  const float max_frecency_score = GetFrecency(now, true, visits);
+  // Add one to allow for rounding in the average of the term scores.
+  const float max_score =
+      GetFinalRelevancyScore(max_topicality_score, max_frecency_score) + 1;
+  return (max_score <= kint32max) ? static_cast<int>(max_score) : kint32max;
+}
+
 // Comparison function for sorting ScoredMatches by their scores with
 // intelligent tie-breaking.
 bool ScoredHistoryMatch::MatchScoreGreater(const ScoredHistoryMatch& m1,
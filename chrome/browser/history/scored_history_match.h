@@ -64,6 +64,15 @@ class ScoredHistoryMatch : public history::HistoryMatch {
   const TermMatches& title_matches() const { return title_matches_; }
   bool can_inline() const { return can_inline_; }
 
+  // Returns an upper bound on the raw score of a match for a history item
+  // with the recent visits in |visits|, whatever the terms and whether or not
+  // the item is bookmarked. This is much cheaper than scoring the item, so it
+  // can be used to skip items that cannot outscore matches already found.
+  // Returns kint32max if HUP-like scoring, which can raise a score above what
+  // the visits alone allow, is enabled.
+  static int GetMaxRawScore(const VisitInfoVector& visits,
+                            const base::Time now);
+
   // Returns |term_matches| after removing all matches that are not at a
   // word break that are in the range [|start_pos|, |end_pos|).
   // start_pos == string::npos is treated as start_pos = length of string.
@@ -1141,6 +1141,10 @@ sql::InitStatus ThumbnailDatabase::OpenDatabase(sql::Connection* db,
   db->set_page_size(2048);
   db->set_cache_size(32);
 
+  // Favicons are mostly read.  With its small cache, reads are served from a
+  // memory mapping of the file instead of read() calls.
+  db->set_mmap_size(16 * 1024 * 1024);
+
   // Run the database in exclusive mode. Nobody else should be accessing the
   // database while we're running, and this will give somewhat improved perf.
   db->set_exclusive_locking();
@@ -4,15 +4,21 @@
 
 #include "chrome/browser/history/top_sites.h"
 
+#include "base/memory/ref_counted_memory.h"
 #include "base/strings/string_util.h"
 #include "chrome/browser/history/top_sites_impl.h"
 #include "grit/chromium_strings.h"
 #include "grit/generated_resources.h"
 #include "grit/locale_settings.h"
 #include "grit/theme_resources.h"
+#include "ui/gfx/image/image_util.h"
 
 namespace history {
 
+// Use 100 quality (highest quality) because we're very sensitive to
+// artifacts for these small sized, highly detailed images.
+static const int kTopSitesImageQuality = 100;
+
 const TopSites::PrepopulatedPage kPrepopulatedPages[] = {
 #if defined(OS_ANDROID)
     { IDS_MOBILE_WELCOME_URL, IDS_NEW_TAB_CHROME_WELCOME_PAGE_TITLE,
@@ -37,4 +43,21 @@ TopSites* TopSites::Create(Profile* profile, const base::FilePath& db_name) {
   return top_sites_impl;
 }
 
+// static
+bool TopSites::EncodeBitmap(const gfx::Image& bitmap,
+                            scoped_refptr<base::RefCountedBytes>* bytes) {
+  if (bitmap.IsEmpty())
+    return false;
+  *bytes = new base::RefCountedBytes();
+  std::vector<unsigned char> data;
+  if (!gfx::JPEG1xEncodedDataFromImage(bitmap, kTopSitesImageQuality, &data))
+    return false;
+
+  // As we're going to cache this data, make sure the vector is only as big as
+  // it needs to be, as JPEGCodec::Encode() over-allocates data.capacity().
+  // (In a C++0x future, we can just call shrink_to_fit() in Encode())
+  (*bytes)->data() = data;
+  return true;
+}
+
 }  // namespace history
@@ -44,6 +44,13 @@ class TopSites
   // Initializes TopSites.
   static TopSites* Create(Profile* profile, const base::FilePath& db_name);
 
+  // Encodes the bitmap to bytes for storage to the db. Returns true if the
+  // bitmap was successfully encoded. Encoding is slow, so callers on the UI
+  // thread should do it on a worker thread and pass the result to
+  // SetPageThumbnailToJPEGBytes. May be called on any thread.
+  static bool EncodeBitmap(const gfx::Image& bitmap,
+                           scoped_refptr<base::RefCountedBytes>* bytes);
+
   // Sets the given thumbnail for the given URL. Returns true if the thumbnail
   // was updated. False means either the URL wasn't known to us, or we felt
   // that our current thumbnail was superior to the given one. Should be called
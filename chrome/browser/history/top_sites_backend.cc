@@ -14,8 +14,28 @@
 
 using content::BrowserThread;
 
+namespace {
+
+// How long thumbnails wait to be written, so that several can share a
+// transaction.
+const int kPendingThumbnailsFlushDelayMs = 2000;
+
+}  // namespace
+
 namespace history {
 
+TopSitesBackend::PendingThumbnail::PendingThumbnail(
+    const MostVisitedURL& url,
+    int url_rank,
+    const Images& thumbnail)
+    : url(url),
+      url_rank(url_rank),
+      thumbnail(thumbnail) {
+}
+
+TopSitesBackend::PendingThumbnail::~PendingThumbnail() {
+}
+
 TopSitesBackend::TopSitesBackend()
     : db_(new TopSitesDatabase()) {
 }
@@ -28,6 +48,7 @@ void TopSitesBackend::Init(const base::FilePath& path) {
 }
 
 void TopSitesBackend::Shutdown() {
+  FlushPendingThumbnails();
   BrowserThread::PostTask(
       BrowserThread::DB, FROM_HERE,
       base::Bind(&TopSitesBackend::ShutdownDBOnDBThread, this));
@@ -36,6 +57,7 @@ void TopSitesBackend::Shutdown() {
 void TopSitesBackend::GetMostVisitedThumbnails(
     const GetMostVisitedThumbnailsCallback& callback,
     base::CancelableTaskTracker* tracker) {
+  FlushPendingThumbnails();
   scoped_refptr<MostVisitedThumbnails> thumbnails = new MostVisitedThumbnails();
 
   tracker->PostTaskAndReply(
@@ -48,6 +70,7 @@ void TopSitesBackend::GetMostVisitedThumbnails(
 }
 
 void TopSitesBackend::UpdateTopSites(const TopSitesDelta& delta) {
+  FlushPendingThumbnails();
   BrowserThread::PostTask(
       BrowserThread::DB, FROM_HERE,
       base::Bind(&TopSitesBackend::UpdateTopSitesOnDBThread, this, delta));
@@ -56,13 +79,18 @@ void TopSitesBackend::UpdateTopSites(const TopSitesDelta& delta) {
 void TopSitesBackend::SetPageThumbnail(const MostVisitedURL& url,
                                        int url_rank,
                                        const Images& thumbnail) {
-  BrowserThread::PostTask(
-      BrowserThread::DB, FROM_HERE,
-      base::Bind(&TopSitesBackend::SetPageThumbnailOnDBThread, this, url,
-                 url_rank, thumbnail));
+  if (pending_thumbnails_.empty()) {
+    BrowserThread::PostDelayedTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&TopSitesBackend::FlushPendingThumbnails, this),
+        base::TimeDelta::FromMilliseconds(kPendingThumbnailsFlushDelayMs));
+  }
+  pending_thumbnails_.push_back(PendingThumbnail(url, url_rank, thumbnail));
 }
 
 void TopSitesBackend::ResetDatabase() {
+  // The thumbnails would be deleted along with the rest of the db.
+  pending_thumbnails_.clear();
   BrowserThread::PostTask(
       BrowserThread::DB, FROM_HERE,
       base::Bind(&TopSitesBackend::ResetDatabaseOnDBThread, this, db_path_));
@@ -70,6 +98,7 @@ void TopSitesBackend::ResetDatabase() {
 
 void TopSitesBackend::DoEmptyRequest(const base::Closure& reply,
                                      base::CancelableTaskTracker* tracker) {
+  FlushPendingThumbnails();
   tracker->PostTaskAndReply(
       BrowserThread::GetMessageLoopProxyForThread(BrowserThread::DB).get(),
       FROM_HERE,
@@ -82,6 +111,18 @@ TopSitesBackend::~TopSitesBackend() {
                  // nulling out db).
 }
 
+void TopSitesBackend::FlushPendingThumbnails() {
+  if (pending_thumbnails_.empty())
+    return;
+
+  PendingThumbnails thumbnails;
+  thumbnails.swap(pending_thumbnails_);
+  BrowserThread::PostTask(
+      BrowserThread::DB, FROM_HERE,
+      base::Bind(&TopSitesBackend::SetPageThumbnailsOnDBThread, this,
+                 thumbnails));
+}
+
 void TopSitesBackend::InitDBOnDBThread(const base::FilePath& path) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::DB));
   if (!db_->Init(path)) {
@@ -119,13 +160,17 @@ void TopSitesBackend::UpdateTopSitesOnDBThread(const TopSitesDelta& delta) {
     db_->UpdatePageRank(delta.moved[i].url, delta.moved[i].rank);
 }
 
-void TopSitesBackend::SetPageThumbnailOnDBThread(const MostVisitedURL& url,
-                                                 int url_rank,
-                                                 const Images& thumbnail) {
+void TopSitesBackend::SetPageThumbnailsOnDBThread(
+    const PendingThumbnails& thumbnails) {
   if (!db_)
     return;
 
-  db_->SetPageThumbnail(url, url_rank, thumbnail);
+  db_->BeginTransaction();
+  for (size_t i = 0; i < thumbnails.size(); ++i) {
+    db_->SetPageThumbnail(thumbnails[i].url, thumbnails[i].url_rank,
+                          thumbnails[i].thumbnail);
+  }
+  db_->CommitTransaction();
 }
 
 void TopSitesBackend::ResetDatabaseOnDBThread(const base::FilePath& file_path) {
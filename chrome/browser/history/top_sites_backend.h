@@ -5,6 +5,8 @@
 #ifndef CHROME_BROWSER_HISTORY_TOP_SITES_BACKEND_H_
 #define CHROME_BROWSER_HISTORY_TOP_SITES_BACKEND_H_
 
+#include <vector>
+
 #include "base/callback.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
@@ -45,7 +47,8 @@ class TopSitesBackend : public base::RefCountedThreadSafe<TopSitesBackend> {
   // Updates top sites database from the specified delta.
   void UpdateTopSites(const TopSitesDelta& delta);
 
-  // Sets the thumbnail.
+  // Sets the thumbnail. Thumbnails are written to the db in batches, shortly
+  // after they are set, or before any other request reaches the db.
   void SetPageThumbnail(const MostVisitedURL& url,
                         int url_rank,
                         const Images& thumbnail);
@@ -62,8 +65,25 @@ class TopSitesBackend : public base::RefCountedThreadSafe<TopSitesBackend> {
  private:
   friend class base::RefCountedThreadSafe<TopSitesBackend>;
 
+  // A thumbnail which has been set but not yet written to the db.
+  struct PendingThumbnail {
+    PendingThumbnail(const MostVisitedURL& url,
+                     int url_rank,
+                     const Images& thumbnail);
+    ~PendingThumbnail();
+
+    MostVisitedURL url;
+    int url_rank;
+    Images thumbnail;
+  };
+  typedef std::vector<PendingThumbnail> PendingThumbnails;
+
   virtual ~TopSitesBackend();
 
+  // Posts the pending thumbnails to the db thread. Must be called before any
+  // other request is posted, so that the db sees requests in order.
+  void FlushPendingThumbnails();
+
   // Invokes Init on the db_.
   void InitDBOnDBThread(const base::FilePath& path);
 
@@ -77,10 +97,8 @@ class TopSitesBackend : public base::RefCountedThreadSafe<TopSitesBackend> {
   // Updates top sites.
   void UpdateTopSitesOnDBThread(const TopSitesDelta& delta);
 
-  // Sets the thumbnail.
-  void SetPageThumbnailOnDBThread(const MostVisitedURL& url,
-                                  int url_rank,
-                                  const Images& thumbnail);
+  // Sets the thumbnails, in a single transaction.
+  void SetPageThumbnailsOnDBThread(const PendingThumbnails& thumbnails);
 
   // Resets the database.
   void ResetDatabaseOnDBThread(const base::FilePath& file_path);
@@ -89,6 +107,10 @@ class TopSitesBackend : public base::RefCountedThreadSafe<TopSitesBackend> {
 
   scoped_ptr<TopSitesDatabase> db_;
 
+  // Thumbnails waiting for FlushPendingThumbnails. Only accessed on the UI
+  // thread.
+  PendingThumbnails pending_thumbnails_;
+
   DISALLOW_COPY_AND_ASSIGN(TopSitesBackend);
 };
 
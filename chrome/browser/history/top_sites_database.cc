@@ -558,6 +558,14 @@ void TopSitesDatabase::AddPageThumbnail(const MostVisitedURL& url,
     UpdatePageRankNoTransaction(url, new_rank);
 }
 
+void TopSitesDatabase::BeginTransaction() {
+  db_->BeginTransaction();
+}
+
+void TopSitesDatabase::CommitTransaction() {
+  db_->CommitTransaction();
+}
+
 void TopSitesDatabase::UpdatePageRank(const MostVisitedURL& url,
                                       int new_rank) {
   DCHECK((url.last_forced_time.ToInternalValue() == 0) ==
@@ -723,6 +731,7 @@ sql::Connection* TopSitesDatabase::CreateDB(const base::FilePath& db_name) {
                                     db.get(), db_name));
   db->set_page_size(4096);
   db->set_cache_size(32);
+  db->set_mmap_size(16 * 1024 * 1024);
 
   if (!db->Open(db_name))
     return NULL;
@@ -51,6 +51,12 @@ class TopSitesDatabase {
   // Use SetPageThumbnail if it's not.
   void UpdatePageRank(const MostVisitedURL& url, int new_rank);
 
+  // Groups the changes made between the two calls into a single transaction,
+  // so that they are committed to disk once. The transactions of the methods
+  // above nest inside it.
+  void BeginTransaction();
+  void CommitTransaction();
+
   // Get a thumbnail for a given page. Returns true iff we have the thumbnail.
   bool GetPageThumbnail(const GURL& url, Images* thumbnail);
 
@@ -43,7 +43,6 @@
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/layout.h"
 #include "ui/base/resource/resource_bundle.h"
-#include "ui/gfx/image/image_util.h"
 
 using base::DictionaryValue;
 using content::BrowserThread;
@@ -94,9 +93,6 @@ static const int64 kUpdateIntervalSecs = 15;
 static const int64 kMinUpdateIntervalMinutes = 1;
 static const int64 kMaxUpdateIntervalMinutes = 60;
 
-// Use 100 quality (highest quality) because we're very sensitive to
-// artifacts for these small sized, highly detailed images.
-static const int kTopSitesImageQuality = 100;
 
 TopSitesImpl::TopSitesImpl(Profile* profile)
     : backend_(NULL),
@@ -535,23 +531,6 @@ bool TopSitesImpl::SetPageThumbnailEncoded(
   return true;
 }
 
-// static
-bool TopSitesImpl::EncodeBitmap(const gfx::Image& bitmap,
-                                scoped_refptr<base::RefCountedBytes>* bytes) {
-  if (bitmap.IsEmpty())
-    return false;
-  *bytes = new base::RefCountedBytes();
-  std::vector<unsigned char> data;
-  if (!gfx::JPEG1xEncodedDataFromImage(bitmap, kTopSitesImageQuality, &data))
-    return false;
-
-  // As we're going to cache this data, make sure the vector is only as big as
-  // it needs to be, as JPEGCodec::Encode() over-allocates data.capacity().
-  // (In a C++0x future, we can just call shrink_to_fit() in Encode())
-  (*bytes)->data() = data;
-  return true;
-}
-
 void TopSitesImpl::RemoveTemporaryThumbnailByURL(const GURL& url) {
   for (TempImages::iterator i = temp_images_.begin(); i != temp_images_.end();
        ++i) {
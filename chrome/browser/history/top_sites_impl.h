@@ -131,11 +131,6 @@ class TopSitesImpl : public TopSites {
                                const base::RefCountedMemory* thumbnail,
                                const ThumbnailScore& score);
 
-  // Encodes the bitmap to bytes for storage to the db. Returns true if the
-  // bitmap was successfully encoded.
-  static bool EncodeBitmap(const gfx::Image& bitmap,
-                           scoped_refptr<base::RefCountedBytes>* bytes);
-
   // Removes the cached thumbnail for url. Does nothing if |url| if not cached
   // in |temp_images_|.
   void RemoveTemporaryThumbnailByURL(const GURL& url);
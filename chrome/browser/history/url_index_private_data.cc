@@ -9,6 +9,7 @@
 #include <iterator>
 #include <limits>
 #include <numeric>
+#include <queue>
 #include <string>
 #include <vector>
 
@@ -48,16 +49,13 @@ static const size_t kMaxVisitsToStoreInCache = 10u;
 namespace history {
 
 typedef imui::InMemoryURLIndexCacheItem_WordListItem WordListItem;
-typedef imui::InMemoryURLIndexCacheItem_WordMapItem_WordMapEntry WordMapEntry;
-typedef imui::InMemoryURLIndexCacheItem_WordMapItem WordMapItem;
-typedef imui::InMemoryURLIndexCacheItem_CharWordMapItem CharWordMapItem;
-typedef imui::InMemoryURLIndexCacheItem_CharWordMapItem_CharWordMapEntry
-    CharWordMapEntry;
-typedef imui::InMemoryURLIndexCacheItem_WordIDHistoryMapItem
-    WordIDHistoryMapItem;
+typedef imui::InMemoryURLIndexCacheItem_CharWordPostingsItem
+    CharWordPostingsItem;
 typedef imui::
-    InMemoryURLIndexCacheItem_WordIDHistoryMapItem_WordIDHistoryMapEntry
-    WordIDHistoryMapEntry;
+    InMemoryURLIndexCacheItem_CharWordPostingsItem_CharWordPostingsEntry
+    CharWordPostingsEntry;
+typedef imui::InMemoryURLIndexCacheItem_WordHistoryPostingsItem
+    WordHistoryPostingsItem;
 typedef imui::InMemoryURLIndexCacheItem_HistoryInfoMapItem HistoryInfoMapItem;
 typedef imui::InMemoryURLIndexCacheItem_HistoryInfoMapItem_HistoryInfoMapEntry
     HistoryInfoMapEntry;
@@ -147,7 +145,8 @@ URLIndexPrivateData::URLIndexPrivateData()
       saved_cache_version_(kCurrentCacheFileVersion),
       pre_filter_item_count_(0),
       post_filter_item_count_(0),
-      post_scoring_item_count_(0) {
+      post_scoring_item_count_(0),
+      scored_item_count_(0) {
 }
 
 ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
@@ -166,6 +165,7 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   pre_filter_item_count_ = 0;
   post_filter_item_count_ = 0;
   post_scoring_item_count_ = 0;
+  scored_item_count_ = 0;
   // The search string we receive may contain escaped characters. For reducing
   // the index we need individual, lower-cased words, ignoring escapings. For
   // the final filtering we need whitespace separated substrings possibly
@@ -192,22 +192,19 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   // approach.
   ResetSearchTermCache();
 
-  HistoryIDSet history_id_set = HistoryIDSetFromWords(lower_words);
+  HistoryIDVector history_ids = HistoryIDsFromWords(lower_words);
 
   // Trim the candidate pool if it is large. Note that we do not filter out
   // items that do not contain the search terms as proper substrings -- doing
   // so is the performance-costly operation we are trying to avoid in order
   // to maintain omnibox responsiveness.
   const size_t kItemsToScoreLimit = 500;
-  pre_filter_item_count_ = history_id_set.size();
+  pre_filter_item_count_ = history_ids.size();
   // If we trim the results set we do not want to cache the results for next
   // time as the user's ultimately desired result could easily be eliminated
   // in this early rough filter.
   bool was_trimmed = (pre_filter_item_count_ > kItemsToScoreLimit);
   if (was_trimmed) {
-    HistoryIDVector history_ids;
-    std::copy(history_id_set.begin(), history_id_set.end(),
-              std::back_inserter(history_ids));
     // Trim down the set by sorting by typed-count, visit-count, and last
     // visit.
     HistoryItemFactorGreater
@@ -216,10 +213,9 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
                       history_ids.begin() + kItemsToScoreLimit,
                       history_ids.end(),
                       item_factor_functor);
-    history_id_set.clear();
-    std::copy(history_ids.begin(), history_ids.begin() + kItemsToScoreLimit,
-              std::inserter(history_id_set, history_id_set.end()));
-    post_filter_item_count_ = history_id_set.size();
+    history_ids.resize(kItemsToScoreLimit);
+    std::sort(history_ids.begin(), history_ids.end());
+    post_filter_item_count_ = history_ids.size();
   }
 
   // Pass over all of the candidates filtering out any without a proper
@@ -245,9 +241,44 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
     // but this is such a rare edge case that it's not worth the time.
     return scored_items;
   }
-  scored_items = std::for_each(history_id_set.begin(), history_id_set.end(),
-      AddHistoryMatch(*this, languages, bookmark_service, lower_raw_string,
-                      lower_raw_terms, base::Time::Now())).ScoredMatches();
+  // Only the best kMaxMatches matches are returned, so score the candidates
+  // in descending order of the best score their visits allow, and stop once
+  // that bound falls below the scores of the kMaxMatches best matches found
+  // so far. Ties in score are broken by other properties, so a candidate
+  // whose bound equals the lowest of those scores must still be scored.
+  const base::Time now = base::Time::Now();
+  std::vector<std::pair<int, HistoryID> > candidates;
+  candidates.reserve(history_ids.size());
+  for (HistoryIDVector::const_iterator iter = history_ids.begin();
+       iter != history_ids.end(); ++iter) {
+    HistoryInfoMap::const_iterator hist_pos = history_info_map_.find(*iter);
+    if (hist_pos == history_info_map_.end())
+      continue;
+    candidates.push_back(std::make_pair(
+        ScoredHistoryMatch::GetMaxRawScore(hist_pos->second.visits, now),
+        *iter));
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            std::greater<std::pair<int, HistoryID> >());
+  AddHistoryMatch add_history_match(*this, languages, bookmark_service,
+                                    lower_raw_string, lower_raw_terms, now);
+  // The lowest of the best scores so far is on top.
+  std::priority_queue<int, std::vector<int>, std::greater<int> > best_scores;
+  for (std::vector<std::pair<int, HistoryID> >::const_iterator iter =
+       candidates.begin(); iter != candidates.end(); ++iter) {
+    if (best_scores.size() == AutocompleteProvider::kMaxMatches &&
+        iter->first < best_scores.top())
+      break;
+    const size_t match_count = add_history_match.ScoredMatches().size();
+    add_history_match(iter->second);
+    ++scored_item_count_;
+    if (add_history_match.ScoredMatches().size() == match_count)
+      continue;  // The candidate did not qualify.
+    best_scores.push(add_history_match.ScoredMatches().back().raw_score());
+    if (best_scores.size() > AutocompleteProvider::kMaxMatches)
+      best_scores.pop();
+  }
+  scored_items = add_history_match.ScoredMatches();
 
   // Select and sort only the top kMaxMatches results.
   if (scored_items.size() > AutocompleteProvider::kMaxMatches) {
@@ -492,6 +523,7 @@ scoped_refptr<URLIndexPrivateData> URLIndexPrivateData::Duplicate() const {
   //    pre_filter_item_count_
   //    post_filter_item_count_
   //    post_scoring_item_count_
+  //    scored_item_count_
 };
 
 bool URLIndexPrivateData::Empty() const {
@@ -512,14 +544,14 @@ void URLIndexPrivateData::Clear() {
 
 URLIndexPrivateData::~URLIndexPrivateData() {}
 
-HistoryIDSet URLIndexPrivateData::HistoryIDSetFromWords(
+HistoryIDVector URLIndexPrivateData::HistoryIDsFromWords(
     const String16Vector& unsorted_words) {
   // Break the terms down into individual terms (words), get the candidate
   // set for each term, and intersect each to get a final candidate list.
   // Note that a single 'term' from the user's perspective might be
   // a string like "http://www.somewebsite.com" which, from our perspective,
   // is four words: 'http', 'www', 'somewebsite', and 'com'.
-  HistoryIDSet history_id_set;
+  HistoryIDVector history_ids;
   String16Vector words(unsorted_words);
   // Sort the words into the longest first as such are likely to narrow down
   // the results quicker. Also, single character words are the most expensive
@@ -528,36 +560,33 @@ HistoryIDSet URLIndexPrivateData::HistoryIDSetFromWords(
   for (String16Vector::iterator iter = words.begin(); iter != words.end();
        ++iter) {
     base::string16 uni_word = *iter;
-    HistoryIDSet term_history_set = HistoryIDsForTerm(uni_word);
-    if (term_history_set.empty()) {
-      history_id_set.clear();
+    HistoryIDVector term_history_ids = HistoryIDsForTerm(uni_word);
+    if (term_history_ids.empty()) {
+      history_ids.clear();
       break;
     }
     if (iter == words.begin()) {
-      history_id_set.swap(term_history_set);
+      history_ids.swap(term_history_ids);
     } else {
-      HistoryIDSet new_history_id_set;
-      std::set_intersection(history_id_set.begin(), history_id_set.end(),
-                            term_history_set.begin(), term_history_set.end(),
-                            std::inserter(new_history_id_set,
-                                          new_history_id_set.begin()));
-      history_id_set.swap(new_history_id_set);
+      HistoryIDVector new_history_ids;
+      IntersectSorted(history_ids, term_history_ids, &new_history_ids);
+      history_ids.swap(new_history_ids);
     }
   }
-  return history_id_set;
+  return history_ids;
 }
 
-HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
+HistoryIDVector URLIndexPrivateData::HistoryIDsForTerm(
     const base::string16& term) {
   if (term.empty())
-    return HistoryIDSet();
+    return HistoryIDVector();
 
   // TODO(mrossetti): Consider optimizing for very common terms such as
   // 'http[s]', 'www', 'com', etc. Or collect the top 100 more frequently
   // occuring words in the user's searches.
 
   size_t term_length = term.length();
-  WordIDSet word_id_set;
+  WordIDVector word_ids;
   if (term_length > 1) {
     // See if this term or a prefix thereof is present in the cache.
     SearchTermCacheMap::iterator best_prefix(search_term_cache_.end());
@@ -579,17 +608,17 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
       size_t prefix_length = best_prefix->first.length();
       if (prefix_length == term_length) {
         best_prefix->second.used_ = true;
-        return best_prefix->second.history_id_set_;
+        return best_prefix->second.history_ids_;
       }
 
       // Otherwise we have a handy starting point.
       // If there are no history results for this prefix then we can bail early
       // as there will be no history results for the full term.
-      if (best_prefix->second.history_id_set_.empty()) {
+      if (best_prefix->second.history_ids_.empty()) {
         search_term_cache_[term] = SearchTermCacheItem();
-        return HistoryIDSet();
+        return HistoryIDVector();
       }
-      word_id_set = best_prefix->second.word_id_set_;
+      word_ids = best_prefix->second.word_ids_;
       prefix_chars = Char16SetFromString16(best_prefix->first);
       leftovers = term.substr(prefix_length);
     }
@@ -601,95 +630,92 @@ HistoryIDSet URLIndexPrivateData::HistoryIDsForTerm(
 
     // Reduce the word set with any leftover, unprocessed characters.
     if (!unique_chars.empty()) {
-      WordIDSet leftover_set(WordIDSetForTermChars(unique_chars));
+      WordIDVector leftover_ids(WordIDsForTermChars(unique_chars));
       // We might come up empty on the leftovers.
-      if (leftover_set.empty()) {
+      if (leftover_ids.empty()) {
         search_term_cache_[term] = SearchTermCacheItem();
-        return HistoryIDSet();
+        return HistoryIDVector();
       }
       // Or there may not have been a prefix from which to start.
       if (prefix_chars.empty()) {
-        word_id_set.swap(leftover_set);
+        word_ids.swap(leftover_ids);
       } else {
-        WordIDSet new_word_id_set;
-        std::set_intersection(word_id_set.begin(), word_id_set.end(),
-                              leftover_set.begin(), leftover_set.end(),
-                              std::inserter(new_word_id_set,
-                                            new_word_id_set.begin()));
-        word_id_set.swap(new_word_id_set);
+        WordIDVector new_word_ids;
+        IntersectSorted(word_ids, leftover_ids, &new_word_ids);
+        word_ids.swap(new_word_ids);
       }
     }
 
     // We must filter the word list because the resulting word set surely
     // contains words which do not have the search term as a proper subset.
-    for (WordIDSet::iterator word_set_iter = word_id_set.begin();
-         word_set_iter != word_id_set.end(); ) {
-      if (word_list_[*word_set_iter].find(term) == base::string16::npos)
-        word_id_set.erase(word_set_iter++);
-      else
-        ++word_set_iter;
+    WordIDVector::iterator kept = word_ids.begin();
+    for (WordIDVector::const_iterator word_iter = word_ids.begin();
+         word_iter != word_ids.end(); ++word_iter) {
+      if (word_list_[*word_iter].find(term) != base::string16::npos)
+        *kept++ = *word_iter;
     }
+    word_ids.erase(kept, word_ids.end());
   } else {
-    word_id_set = WordIDSetForTermChars(Char16SetFromString16(term));
+    word_ids = WordIDsForTermChars(Char16SetFromString16(term));
   }
 
   // If any words resulted then we can compose a set of history IDs by unioning
-  // the sets from each word.
-  HistoryIDSet history_id_set;
-  if (!word_id_set.empty()) {
-    for (WordIDSet::iterator word_id_iter = word_id_set.begin();
-         word_id_iter != word_id_set.end(); ++word_id_iter) {
-      WordID word_id = *word_id_iter;
-      WordIDHistoryMap::iterator word_iter = word_id_history_map_.find(word_id);
-      if (word_iter != word_id_history_map_.end()) {
-        HistoryIDSet& word_history_id_set(word_iter->second);
-        history_id_set.insert(word_history_id_set.begin(),
-                              word_history_id_set.end());
-      }
-    }
+  // the posting lists of each word.
+  HistoryIDVector history_ids;
+  for (WordIDVector::const_iterator word_id_iter = word_ids.begin();
+       word_id_iter != word_ids.end(); ++word_id_iter) {
+    DCHECK_LT(*word_id_iter, word_id_history_map_.size());
+    const PostingList& word_history_ids(word_id_history_map_[*word_id_iter]);
+    history_ids.insert(history_ids.end(), word_history_ids.begin(),
+                       word_history_ids.end());
+  }
+  if (word_ids.size() > 1) {
+    std::sort(history_ids.begin(), history_ids.end());
+    history_ids.erase(std::unique(history_ids.begin(), history_ids.end()),
+                      history_ids.end());
   }
 
   // Record a new cache entry for this word if the term is longer than
   // a single character.
   if (term_length > 1)
-    search_term_cache_[term] = SearchTermCacheItem(word_id_set, history_id_set);
+    search_term_cache_[term] = SearchTermCacheItem(word_ids, history_ids);
 
-  return history_id_set;
+  return history_ids;
 }
 
-WordIDSet URLIndexPrivateData::WordIDSetForTermChars(
+WordIDVector URLIndexPrivateData::WordIDsForTermChars(
     const Char16Set& term_chars) {
-  WordIDSet word_id_set;
+  // Walk the words of the rarest character and keep those that every other
+  // character's bitmap contains as well.
+  std::vector<const WordIDBitmap*> char_word_ids;
+  const WordIDBitmap* rarest = NULL;
   for (Char16Set::const_iterator c_iter = term_chars.begin();
        c_iter != term_chars.end(); ++c_iter) {
-    CharWordIDMap::iterator char_iter = char_word_map_.find(*c_iter);
-    if (char_iter == char_word_map_.end()) {
-      // A character was not found so there are no matching results: bail.
-      word_id_set.clear();
-      break;
-    }
-    WordIDSet& char_word_id_set(char_iter->second);
-    // It is possible for there to no longer be any words associated with
-    // a particular character. Give up in that case.
-    if (char_word_id_set.empty()) {
-      word_id_set.clear();
-      break;
-    }
+    CharWordIDMap::const_iterator char_iter = char_word_map_.find(*c_iter);
+    // A character was not found, or it is no longer associated with any
+    // words, so there are no matching results: bail.
+    if (char_iter == char_word_map_.end() || char_iter->second.empty())
+      return WordIDVector();
+    const WordIDBitmap* word_id_bitmap = &char_iter->second;
+    if (!rarest || word_id_bitmap->size() < rarest->size())
+      rarest = word_id_bitmap;
+    char_word_ids.push_back(word_id_bitmap);
+  }
 
-    if (c_iter == term_chars.begin()) {
-      // First character results becomes base set of results.
-      word_id_set = char_word_id_set;
-    } else {
-      // Subsequent character results get intersected in.
-      WordIDSet new_word_id_set;
-      std::set_intersection(word_id_set.begin(), word_id_set.end(),
-                            char_word_id_set.begin(), char_word_id_set.end(),
-                            std::inserter(new_word_id_set,
-                                          new_word_id_set.begin()));
-      word_id_set.swap(new_word_id_set);
-    }
+  WordIDVector word_ids;
+  if (!rarest)
+    return word_ids;
+  for (WordIDBitmap::const_iterator word_iter = rarest->begin();
+       word_iter != rarest->end(); ++word_iter) {
+    std::vector<const WordIDBitmap*>::const_iterator bitmap_iter =
+        char_word_ids.begin();
+    while (bitmap_iter != char_word_ids.end() &&
+           (*bitmap_iter == rarest || (*bitmap_iter)->count(*word_iter)))
+      ++bitmap_iter;
+    if (bitmap_iter == char_word_ids.end())
+      word_ids.push_back(*word_iter);
   }
-  return word_id_set;
+  return word_ids;
 }
 
 bool URLIndexPrivateData::IndexRow(
@@ -786,6 +812,7 @@ void URLIndexPrivateData::AddWordHistory(const base::string16& term,
   WordID word_id = word_list_.size();
   if (available_words_.empty()) {
     word_list_.push_back(term);
+    word_id_history_map_.resize(word_list_.size());
   } else {
     word_id = *(available_words_.begin());
     word_list_[word_id] = term;
@@ -793,51 +820,28 @@ void URLIndexPrivateData::AddWordHistory(const base::string16& term,
   }
   word_map_[term] = word_id;
 
-  HistoryIDSet history_id_set;
-  history_id_set.insert(history_id);
-  word_id_history_map_[word_id] = history_id_set;
+  DCHECK(word_id_history_map_[word_id].empty());
+  word_id_history_map_[word_id].insert(history_id);
   AddToHistoryIDWordMap(history_id, word_id);
 
   // For each character in the newly added word (i.e. a word that is not
   // already in the word index), add the word to the character index.
   Char16Set characters = Char16SetFromString16(term);
   for (Char16Set::iterator uni_char_iter = characters.begin();
-       uni_char_iter != characters.end(); ++uni_char_iter) {
-    base::char16 uni_char = *uni_char_iter;
-    CharWordIDMap::iterator char_iter = char_word_map_.find(uni_char);
-    if (char_iter != char_word_map_.end()) {
-      // Update existing entry in the char/word index.
-      WordIDSet& word_id_set(char_iter->second);
-      word_id_set.insert(word_id);
-    } else {
-      // Create a new entry in the char/word index.
-      WordIDSet word_id_set;
-      word_id_set.insert(word_id);
-      char_word_map_[uni_char] = word_id_set;
-    }
-  }
+       uni_char_iter != characters.end(); ++uni_char_iter)
+    char_word_map_[*uni_char_iter].insert(word_id);
 }
 
 void URLIndexPrivateData::UpdateWordHistory(WordID word_id,
                                             HistoryID history_id) {
-  WordIDHistoryMap::iterator history_pos = word_id_history_map_.find(word_id);
-  DCHECK(history_pos != word_id_history_map_.end());
-  HistoryIDSet& history_id_set(history_pos->second);
-  history_id_set.insert(history_id);
+  DCHECK_LT(word_id, word_id_history_map_.size());
+  word_id_history_map_[word_id].insert(history_id);
   AddToHistoryIDWordMap(history_id, word_id);
 }
 
 void URLIndexPrivateData::AddToHistoryIDWordMap(HistoryID history_id,
                                                 WordID word_id) {
-  HistoryIDWordMap::iterator iter = history_id_word_map_.find(history_id);
-  if (iter != history_id_word_map_.end()) {
-    WordIDSet& word_id_set(iter->second);
-    word_id_set.insert(word_id);
-  } else {
-    WordIDSet word_id_set;
-    word_id_set.insert(word_id);
-    history_id_word_map_[history_id] = word_id_set;
-  }
+  history_id_word_map_[history_id].insert(word_id);
 }
 
 void URLIndexPrivateData::RemoveRowFromIndex(const URLRow& row) {
@@ -851,15 +855,20 @@ void URLIndexPrivateData::RemoveRowWordsFromIndex(const URLRow& row) {
   // Remove the entries in history_id_word_map_ and word_id_history_map_ for
   // this row.
   HistoryID history_id = static_cast<HistoryID>(row.id());
-  WordIDSet word_id_set = history_id_word_map_[history_id];
-  history_id_word_map_.erase(history_id);
+  PostingList word_ids;
+  HistoryIDWordMap::iterator row_words = history_id_word_map_.find(history_id);
+  if (row_words != history_id_word_map_.end()) {
+    word_ids.swap(row_words->second);
+    history_id_word_map_.erase(row_words);
+  }
 
   // Reconcile any changes to word usage.
-  for (WordIDSet::iterator word_id_iter = word_id_set.begin();
-       word_id_iter != word_id_set.end(); ++word_id_iter) {
+  for (PostingList::const_iterator word_id_iter = word_ids.begin();
+       word_id_iter != word_ids.end(); ++word_id_iter) {
     WordID word_id = *word_id_iter;
-    word_id_history_map_[word_id].erase(history_id);
-    if (!word_id_history_map_[word_id].empty())
+    PostingList& word_history_ids(word_id_history_map_[word_id]);
+    word_history_ids.erase(history_id);
+    if (!word_history_ids.empty())
       continue;  // The word is still in use.
 
     // The word is no longer in use. Reconcile any changes to character usage.
@@ -867,14 +876,15 @@ void URLIndexPrivateData::RemoveRowWordsFromIndex(const URLRow& row) {
     Char16Set characters = Char16SetFromString16(word);
     for (Char16Set::iterator uni_char_iter = characters.begin();
          uni_char_iter != characters.end(); ++uni_char_iter) {
-      base::char16 uni_char = *uni_char_iter;
-      char_word_map_[uni_char].erase(word_id);
-      if (char_word_map_[uni_char].empty())
-        char_word_map_.erase(uni_char);  // No longer in use.
+      CharWordIDMap::iterator char_iter = char_word_map_.find(*uni_char_iter);
+      if (char_iter == char_word_map_.end())
+        continue;
+      char_iter->second.erase(word_id);
+      if (char_iter->second.empty())
+        char_word_map_.erase(char_iter);  // No longer in use.
     }
 
     // Complete the removal of references to the word.
-    word_id_history_map_.erase(word_id);
     word_map_.erase(word);
     word_list_[word_id] = base::string16();
     available_words_.insert(word_id);
@@ -917,7 +927,6 @@ void URLIndexPrivateData::SavePrivateData(
   // definition use a placeholder. This will go away with the switch to SQLite.
   cache->set_history_item_count(0);
   SaveWordList(cache);
-  SaveWordMap(cache);
   SaveCharWordMap(cache);
   SaveWordIDHistoryMap(cache);
   SaveHistoryInfoMap(cache);
@@ -934,34 +943,17 @@ void URLIndexPrivateData::SaveWordList(InMemoryURLIndexCacheItem* cache) const {
     list_item->add_word(base::UTF16ToUTF8(*iter));
 }
 
-void URLIndexPrivateData::SaveWordMap(InMemoryURLIndexCacheItem* cache) const {
-  if (word_map_.empty())
-    return;
-  WordMapItem* map_item = cache->mutable_word_map();
-  map_item->set_item_count(word_map_.size());
-  for (WordMap::const_iterator iter = word_map_.begin();
-       iter != word_map_.end(); ++iter) {
-    WordMapEntry* map_entry = map_item->add_word_map_entry();
-    map_entry->set_word(base::UTF16ToUTF8(iter->first));
-    map_entry->set_word_id(iter->second);
-  }
-}
-
 void URLIndexPrivateData::SaveCharWordMap(
     InMemoryURLIndexCacheItem* cache) const {
   if (char_word_map_.empty())
     return;
-  CharWordMapItem* map_item = cache->mutable_char_word_map();
-  map_item->set_item_count(char_word_map_.size());
+  CharWordPostingsItem* map_item = cache->mutable_char_word_postings();
   for (CharWordIDMap::const_iterator iter = char_word_map_.begin();
        iter != char_word_map_.end(); ++iter) {
-    CharWordMapEntry* map_entry = map_item->add_char_word_map_entry();
+    CharWordPostingsEntry* map_entry =
+        map_item->add_char_word_postings_entry();
     map_entry->set_char_16(iter->first);
-    const WordIDSet& word_id_set(iter->second);
-    map_entry->set_item_count(word_id_set.size());
-    for (WordIDSet::const_iterator set_iter = word_id_set.begin();
-         set_iter != word_id_set.end(); ++set_iter)
-      map_entry->add_word_id(*set_iter);
+    iter->second.Encode(map_entry->mutable_word_ids());
   }
 }
 
@@ -969,19 +961,10 @@ void URLIndexPrivateData::SaveWordIDHistoryMap(
     InMemoryURLIndexCacheItem* cache) const {
   if (word_id_history_map_.empty())
     return;
-  WordIDHistoryMapItem* map_item = cache->mutable_word_id_history_map();
-  map_item->set_item_count(word_id_history_map_.size());
+  WordHistoryPostingsItem* map_item = cache->mutable_word_history_postings();
   for (WordIDHistoryMap::const_iterator iter = word_id_history_map_.begin();
-       iter != word_id_history_map_.end(); ++iter) {
-    WordIDHistoryMapEntry* map_entry =
-        map_item->add_word_id_history_map_entry();
-    map_entry->set_word_id(iter->first);
-    const HistoryIDSet& history_id_set(iter->second);
-    map_entry->set_item_count(history_id_set.size());
-    for (HistoryIDSet::const_iterator set_iter = history_id_set.begin();
-         set_iter != history_id_set.end(); ++set_iter)
-      map_entry->add_history_id(*set_iter);
-  }
+       iter != word_id_history_map_.end(); ++iter)
+    iter->Encode(map_item->add_history_ids());
 }
 
 void URLIndexPrivateData::SaveHistoryInfoMap(
@@ -1065,7 +1048,7 @@ bool URLIndexPrivateData::RestorePrivateData(
     }
     restored_cache_version_ = cache.version();
   }
-  return RestoreWordList(cache) && RestoreWordMap(cache) &&
+  return RestoreWordList(cache) &&
       RestoreCharWordMap(cache) && RestoreWordIDHistoryMap(cache) &&
       RestoreHistoryInfoMap(cache) && RestoreWordStartsMap(cache, languages);
 }
@@ -1080,82 +1063,56 @@ bool URLIndexPrivateData::RestoreWordList(
   if (actual_item_count == 0 || actual_item_count != expected_item_count)
     return false;
   const RepeatedPtrField<std::string>& words(list_item.word());
+  word_list_.reserve(actual_item_count);
   for (RepeatedPtrField<std::string>::const_iterator iter = words.begin();
-       iter != words.end(); ++iter)
+       iter != words.end(); ++iter) {
+    WordID word_id = word_list_.size();
     word_list_.push_back(base::UTF8ToUTF16(*iter));
-  return true;
-}
-
-bool URLIndexPrivateData::RestoreWordMap(
-    const InMemoryURLIndexCacheItem& cache) {
-  if (!cache.has_word_map())
-    return false;
-  const WordMapItem& list_item(cache.word_map());
-  uint32 expected_item_count = list_item.item_count();
-  uint32 actual_item_count = list_item.word_map_entry_size();
-  if (actual_item_count == 0 || actual_item_count != expected_item_count)
-    return false;
-  const RepeatedPtrField<WordMapEntry>& entries(list_item.word_map_entry());
-  for (RepeatedPtrField<WordMapEntry>::const_iterator iter = entries.begin();
-       iter != entries.end(); ++iter)
-    word_map_[base::UTF8ToUTF16(iter->word())] = iter->word_id();
+    // Unused slots are saved as empty words.
+    if (word_list_.back().empty())
+      available_words_.insert(word_id);
+    else
+      word_map_[word_list_.back()] = word_id;
+  }
   return true;
 }
 
 bool URLIndexPrivateData::RestoreCharWordMap(
     const InMemoryURLIndexCacheItem& cache) {
-  if (!cache.has_char_word_map())
+  if (!cache.has_char_word_postings())
     return false;
-  const CharWordMapItem& list_item(cache.char_word_map());
-  uint32 expected_item_count = list_item.item_count();
-  uint32 actual_item_count = list_item.char_word_map_entry_size();
-  if (actual_item_count == 0 || actual_item_count != expected_item_count)
+  const CharWordPostingsItem& list_item(cache.char_word_postings());
+  if (list_item.char_word_postings_entry_size() == 0)
     return false;
-  const RepeatedPtrField<CharWordMapEntry>&
-      entries(list_item.char_word_map_entry());
-  for (RepeatedPtrField<CharWordMapEntry>::const_iterator iter =
+  const RepeatedPtrField<CharWordPostingsEntry>&
+      entries(list_item.char_word_postings_entry());
+  for (RepeatedPtrField<CharWordPostingsEntry>::const_iterator iter =
        entries.begin(); iter != entries.end(); ++iter) {
-    expected_item_count = iter->item_count();
-    actual_item_count = iter->word_id_size();
-    if (actual_item_count == 0 || actual_item_count != expected_item_count)
-      return false;
     base::char16 uni_char = static_cast<base::char16>(iter->char_16());
-    WordIDSet word_id_set;
-    const RepeatedField<int32>& word_ids(iter->word_id());
-    for (RepeatedField<int32>::const_iterator jiter = word_ids.begin();
-         jiter != word_ids.end(); ++jiter)
-      word_id_set.insert(*jiter);
-    char_word_map_[uni_char] = word_id_set;
+    WordIDBitmap& word_ids(char_word_map_[uni_char]);
+    if (!word_ids.Decode(iter->word_ids()) || word_ids.empty())
+      return false;
   }
   return true;
 }
 
 bool URLIndexPrivateData::RestoreWordIDHistoryMap(
     const InMemoryURLIndexCacheItem& cache) {
-  if (!cache.has_word_id_history_map())
+  if (!cache.has_word_history_postings())
     return false;
-  const WordIDHistoryMapItem& list_item(cache.word_id_history_map());
-  uint32 expected_item_count = list_item.item_count();
-  uint32 actual_item_count = list_item.word_id_history_map_entry_size();
-  if (actual_item_count == 0 || actual_item_count != expected_item_count)
+  const WordHistoryPostingsItem& list_item(cache.word_history_postings());
+  // There is a list for each word, including the unused ones.
+  if (static_cast<size_t>(list_item.history_ids_size()) != word_list_.size())
     return false;
-  const RepeatedPtrField<WordIDHistoryMapEntry>&
-      entries(list_item.word_id_history_map_entry());
-  for (RepeatedPtrField<WordIDHistoryMapEntry>::const_iterator iter =
-       entries.begin(); iter != entries.end(); ++iter) {
-    expected_item_count = iter->item_count();
-    actual_item_count = iter->history_id_size();
-    if (actual_item_count == 0 || actual_item_count != expected_item_count)
+  word_id_history_map_.resize(word_list_.size());
+  for (WordID word_id = 0; word_id < word_list_.size(); ++word_id) {
+    PostingList& history_ids(word_id_history_map_[word_id]);
+    if (!history_ids.Decode(list_item.history_ids(word_id)) ||
+        history_ids.empty() != word_list_[word_id].empty())
       return false;
-    WordID word_id = iter->word_id();
-    HistoryIDSet history_id_set;
-    const RepeatedField<int64>& history_ids(iter->history_id());
-    for (RepeatedField<int64>::const_iterator jiter = history_ids.begin();
-         jiter != history_ids.end(); ++jiter) {
-      history_id_set.insert(*jiter);
-      AddToHistoryIDWordMap(*jiter, word_id);
-    }
-    word_id_history_map_[word_id] = history_id_set;
+    for (PostingList::const_iterator iter = history_ids.begin();
+         iter != history_ids.end(); ++iter)
+      AddToHistoryIDWordMap(*iter, word_id);
   }
   return true;
 }
@@ -1257,10 +1214,10 @@ bool URLIndexPrivateData::URLSchemeIsWhitelisted(
 // SearchTermCacheItem ---------------------------------------------------------
 
 URLIndexPrivateData::SearchTermCacheItem::SearchTermCacheItem(
-    const WordIDSet& word_id_set,
-    const HistoryIDSet& history_id_set)
-    : word_id_set_(word_id_set),
-      history_id_set_(history_id_set),
+    const WordIDVector& word_ids,
+    const HistoryIDVector& history_ids)
+    : word_ids_(word_ids),
+      history_ids_(history_ids),
       used_(true) {}
 
 URLIndexPrivateData::SearchTermCacheItem::SearchTermCacheItem()
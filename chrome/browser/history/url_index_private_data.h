@@ -34,7 +34,7 @@ class InMemoryURLIndex;
 class RefCountedBool;
 
 // Current version of the cache file.
-static const int kCurrentCacheFileVersion = 4;
+static const int kCurrentCacheFileVersion = 5;
 
 // A structure private to InMemoryURLIndex describing its internal data and
 // providing for restoring, rebuilding and updating that internal data. As
@@ -155,6 +155,7 @@ class URLIndexPrivateData
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, ReadVisitsFromHistory);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, RebuildFromHistoryIfCacheOld);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, Scoring);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, ScoringCutoff);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, TitleSearch);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, TypedCharacterCaching);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, WhitelistedURLs);
@@ -171,22 +172,22 @@ class URLIndexPrivateData
   // no longer needed.
   //
   // Items stored in the search term cache. If a search term exactly matches one
-  // in the cache then we can quickly supply the proper |history_id_set_| (and
+  // in the cache then we can quickly supply the proper |history_ids_| (and
   // marking the cache item as being |used_|. If we find a prefix for a search
   // term in the cache (which is very likely to occur as the user types each
   // term into the omnibox) then we can short-circuit the index search for those
-  // characters in the prefix by returning the |word_id_set|. In that case we do
-  // not mark the item as being |used_|.
+  // characters in the prefix by returning the |word_ids_|. In that case we do
+  // not mark the item as being |used_|. Both are sorted.
   struct SearchTermCacheItem {
-    SearchTermCacheItem(const WordIDSet& word_id_set,
-                        const HistoryIDSet& history_id_set);
+    SearchTermCacheItem(const WordIDVector& word_ids,
+                        const HistoryIDVector& history_ids);
     // Creates a cache item for a term which has no results.
     SearchTermCacheItem();
 
     ~SearchTermCacheItem();
 
-    WordIDSet word_id_set_;
-    HistoryIDSet history_id_set_;
+    WordIDVector word_ids_;
+    HistoryIDVector history_ids_;
     bool used_;  // True if this item has been used for the current term search.
   };
   typedef std::map<base::string16, SearchTermCacheItem> SearchTermCacheMap;
@@ -205,7 +206,9 @@ class URLIndexPrivateData
 
     void operator()(const HistoryID history_id);
 
-    ScoredHistoryMatches ScoredMatches() const { return scored_matches_; }
+    const ScoredHistoryMatches& ScoredMatches() const {
+      return scored_matches_;
+    }
 
    private:
     const URLIndexPrivateData& private_data_;
@@ -233,16 +236,17 @@ class URLIndexPrivateData
 
   // URL History indexing support functions.
 
-  // Composes a set of history item IDs by intersecting the set for each word
-  // in |unsorted_words|.
-  HistoryIDSet HistoryIDSetFromWords(const String16Vector& unsorted_words);
+  // Composes a sorted vector of history item IDs by intersecting the IDs for
+  // each word in |unsorted_words|.
+  HistoryIDVector HistoryIDsFromWords(const String16Vector& unsorted_words);
 
-  // Helper function to HistoryIDSetFromWords which composes a set of history
-  // ids for the given term given in |term|.
-  HistoryIDSet HistoryIDsForTerm(const base::string16& term);
+  // Helper function to HistoryIDsFromWords which composes a sorted vector of
+  // history ids for the given term given in |term|.
+  HistoryIDVector HistoryIDsForTerm(const base::string16& term);
 
-  // Given a set of Char16s, finds words containing those characters.
-  WordIDSet WordIDSetForTermChars(const Char16Set& term_chars);
+  // Given a set of Char16s, finds words containing those characters and
+  // returns their sorted WordIDs.
+  WordIDVector WordIDsForTermChars(const Char16Set& term_chars);
 
   // Indexes one URL history item as described by |row|. Returns true if the
   // row was actually indexed. |languages| gives a list of language encodings by
@@ -300,7 +304,6 @@ class URLIndexPrivateData
   // Encode a data structure into the protobuf |cache|.
   void SavePrivateData(imui::InMemoryURLIndexCacheItem* cache) const;
   void SaveWordList(imui::InMemoryURLIndexCacheItem* cache) const;
-  void SaveWordMap(imui::InMemoryURLIndexCacheItem* cache) const;
   void SaveCharWordMap(imui::InMemoryURLIndexCacheItem* cache) const;
   void SaveWordIDHistoryMap(imui::InMemoryURLIndexCacheItem* cache) const;
   void SaveHistoryInfoMap(imui::InMemoryURLIndexCacheItem* cache) const;
@@ -312,7 +315,6 @@ class URLIndexPrivateData
   bool RestorePrivateData(const imui::InMemoryURLIndexCacheItem& cache,
                           const std::string& languages);
   bool RestoreWordList(const imui::InMemoryURLIndexCacheItem& cache);
-  bool RestoreWordMap(const imui::InMemoryURLIndexCacheItem& cache);
   bool RestoreCharWordMap(const imui::InMemoryURLIndexCacheItem& cache);
   bool RestoreWordIDHistoryMap(const imui::InMemoryURLIndexCacheItem& cache);
   bool RestoreHistoryInfoMap(const imui::InMemoryURLIndexCacheItem& cache);
@@ -355,7 +357,7 @@ class URLIndexPrivateData
   WordIDSet available_words_;
 
   // A one-to-one mapping from the a word string to its slot number (i.e.
-  // WordID) in the |word_list_|.
+  // WordID) in the |word_list_|. Not cached; it is rebuilt from |word_list_|.
   WordMap word_map_;
 
   // A one-to-many mapping from a single character to all WordIDs of words
@@ -364,6 +366,8 @@ class URLIndexPrivateData
 
   // A one-to-many mapping from a WordID to all HistoryIDs (the row_id as
   // used in the history database) of history items in which the word occurs.
+  // Indexed by WordID, so it has an entry, possibly empty, for every slot in
+  // |word_list_|.
   WordIDHistoryMap word_id_history_map_;
 
   // A one-to-many mapping from a HistoryID to all WordIDs of words that occur
@@ -387,10 +391,12 @@ class URLIndexPrivateData
   int saved_cache_version_;
 
   // Used for unit testing only. Records the number of candidate history items
-  // at three stages in the index searching process.
+  // at three stages in the index searching process, and how many of them were
+  // actually scored.
   size_t pre_filter_item_count_;    // After word index is queried.
   size_t post_filter_item_count_;   // After trimming large result set.
   size_t post_scoring_item_count_;  // After performing final filter/scoring.
+  size_t scored_item_count_;
 };
 
 }  // namespace history
@@ -87,6 +87,8 @@ bool VisitSegmentDatabase::InitSegmentTables() {
 }
 
 bool VisitSegmentDatabase::DropSegmentTables() {
+  DiscardSegmentVisitCounts();
+
   // Dropping the tables will implicitly delete the indices.
   return GetDB().Execute("DROP TABLE segments") &&
          GetDB().Execute("DROP TABLE segment_usage");
@@ -170,11 +172,33 @@ bool VisitSegmentDatabase::IncreaseSegmentVisitCount(SegmentID segment_id,
                                                      base::Time ts,
                                                      int amount) {
   base::Time t = ts.LocalMidnight();
+  pending_visit_counts_[std::make_pair(segment_id, t.ToInternalValue())] +=
+      amount;
+  return true;
+}
+
+bool VisitSegmentDatabase::CommitSegmentVisitCounts() {
+  bool result = true;
+  for (PendingVisitCounts::const_iterator i = pending_visit_counts_.begin();
+       i != pending_visit_counts_.end(); ++i) {
+    if (!AddSegmentVisitCount(i->first.first, i->first.second, i->second))
+      result = false;
+  }
+  pending_visit_counts_.clear();
+  return result;
+}
+
+void VisitSegmentDatabase::DiscardSegmentVisitCounts() {
+  pending_visit_counts_.clear();
+}
 
+bool VisitSegmentDatabase::AddSegmentVisitCount(SegmentID segment_id,
+                                                int64 time_slot,
+                                                int64 amount) {
   sql::Statement select(GetDB().GetCachedStatement(SQL_FROM_HERE,
       "SELECT id, visit_count FROM segment_usage "
       "WHERE time_slot = ? AND segment_id = ?"));
-  select.BindInt64(0, t.ToInternalValue());
+  select.BindInt64(0, time_slot);
   select.BindInt64(1, segment_id);
 
   if (!select.is_valid())
@@ -183,7 +207,7 @@ bool VisitSegmentDatabase::IncreaseSegmentVisitCount(SegmentID segment_id,
   if (select.Step()) {
     sql::Statement update(GetDB().GetCachedStatement(SQL_FROM_HERE,
         "UPDATE segment_usage SET visit_count = ? WHERE id = ?"));
-    update.BindInt64(0, select.ColumnInt64(1) + static_cast<int64>(amount));
+    update.BindInt64(0, select.ColumnInt64(1) + amount);
     update.BindInt64(1, select.ColumnInt64(0));
 
     return update.Run();
@@ -192,8 +216,8 @@ bool VisitSegmentDatabase::IncreaseSegmentVisitCount(SegmentID segment_id,
         "INSERT INTO segment_usage "
         "(segment_id, time_slot, visit_count) VALUES (?, ?, ?)"));
     insert.BindInt64(0, segment_id);
-    insert.BindInt64(1, t.ToInternalValue());
-    insert.BindInt64(2, static_cast<int64>(amount));
+    insert.BindInt64(1, time_slot);
+    insert.BindInt64(2, amount);
 
     return insert.Run();
   }
@@ -207,6 +231,7 @@ void VisitSegmentDatabase::QuerySegmentUsage(
   // The first gathers scores for all segments.
   // The second gathers segment data (url, title, etc.) for the highest-ranked
   // segments.
+  CommitSegmentVisitCounts();
 
   // Gather all the segment scores.
   sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
@@ -286,6 +311,8 @@ void VisitSegmentDatabase::QuerySegmentUsage(
 }
 
 bool VisitSegmentDatabase::DeleteSegmentData(base::Time older_than) {
+  CommitSegmentVisitCounts();
+
   sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
       "DELETE FROM segment_usage WHERE time_slot < ?"));
   statement.BindInt64(0, older_than.LocalMidnight().ToInternalValue());
@@ -294,6 +321,8 @@ bool VisitSegmentDatabase::DeleteSegmentData(base::Time older_than) {
 }
 
 bool VisitSegmentDatabase::DeleteSegmentForURL(URLID url_id) {
+  CommitSegmentVisitCounts();
+
   sql::Statement delete_usage(GetDB().GetCachedStatement(SQL_FROM_HERE,
       "DELETE FROM segment_usage WHERE segment_id IN "
       "(SELECT id FROM segments WHERE url_id = ?)"));
@@ -5,6 +5,9 @@
 #ifndef CHROME_BROWSER_HISTORY_VISITSEGMENT_DATABASE_H_
 #define CHROME_BROWSER_HISTORY_VISITSEGMENT_DATABASE_H_
 
+#include <map>
+#include <utility>
+
 #include "base/basictypes.h"
 #include "chrome/browser/history/history_types.h"
 
@@ -47,9 +50,19 @@ class VisitSegmentDatabase {
 
   // Increase the segment visit count by the provided amount. Return true on
   // success.
+  //
+  // The increase is buffered, and increases of the same segment and day are
+  // added together, so that a burst of visits costs one read-modify-write
+  // of segment_usage instead of one per visit.  The buffer is written by
+  // CommitSegmentVisitCounts(), and before any function of this class which
+  // reads or deletes segment usage.
   bool IncreaseSegmentVisitCount(SegmentID segment_id, base::Time ts,
                                  int amount);
 
+  // Writes the visit counts buffered by IncreaseSegmentVisitCount().  Returns
+  // true on success.
+  bool CommitSegmentVisitCounts();
+
   // Compute the segment usage since |from_time| using the provided aggregator.
   // A PageUsageData is added in |result| for the highest-scored segments up to
   // |max_result_count|.
@@ -83,7 +96,21 @@ class VisitSegmentDatabase {
   // presentation table is removed entirely.
   bool MigratePresentationIndex();
 
+  // Drops the visit counts buffered by IncreaseSegmentVisitCount(), for when
+  // the transaction they belong to is rolled back.
+  void DiscardSegmentVisitCounts();
+
  private:
+  // Adds |amount| to the visit count of |segment_id| in |time_slot|.
+  bool AddSegmentVisitCount(SegmentID segment_id,
+                            int64 time_slot,
+                            int64 amount);
+
+  // Visit counts not yet written to segment_usage, keyed by segment and time
+  // slot.
+  typedef std::map<std::pair<SegmentID, int64>, int64> PendingVisitCounts;
+  PendingVisitCounts pending_visit_counts_;
+
   DISALLOW_COPY_AND_ASSIGN(VisitSegmentDatabase);
 };
 
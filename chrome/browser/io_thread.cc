@@ -15,6 +15,7 @@
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/metrics/field_trial.h"
+#include "base/path_service.h"
 #include "base/prefs/pref_registry_simple.h"
 #include "base/prefs/pref_service.h"
 #include "base/stl_util.h"
@@ -40,6 +41,8 @@
 #include "chrome/browser/net/proxy_service_factory.h"
 #include "chrome/browser/net/sdch_dictionary_fetcher.h"
 #include "chrome/browser/net/spdyproxy/http_auth_handler_spdyproxy.h"
+#include "chrome/common/chrome_constants.h"
+#include "chrome/common/chrome_paths.h"
 #include "chrome/common/chrome_switches.h"
 #include "chrome/common/chrome_version_info.h"
 #include "chrome/common/pref_names.h"
@@ -70,6 +73,7 @@
 #include "net/proxy/proxy_config_service.h"
 #include "net/proxy/proxy_script_fetcher_impl.h"
 #include "net/proxy/proxy_service.h"
+#include "net/quic/crypto/quic_server_info_store.h"
 #include "net/quic/quic_protocol.h"
 #include "net/socket/tcp_client_socket.h"
 #include "net/spdy/spdy_session.h"
@@ -1104,6 +1108,15 @@ void IOThread::ConfigureQuic(const CommandLine& command_line) {
         ShouldEnableQuicHttps(command_line, quic_trial_group));
     globals_->enable_quic_port_selection.set(
         ShouldEnableQuicPortSelection(command_line));
+    // Start loading the server configs now, so they're ready by the time the
+    // first QUIC connection is made.
+    base::FilePath user_data_dir;
+    if (PathService::Get(chrome::DIR_USER_DATA, &user_data_dir)) {
+      globals_->quic_server_info_store.reset(new net::QuicServerInfoStore(
+          user_data_dir.Append(chrome::kQuicServerInfoFilename),
+          BrowserThread::GetMessageLoopProxyForThread(
+              BrowserThread::FILE).get()));
+    }
   }
 
   size_t max_packet_length = GetQuicMaxPacketLength(command_line,
@@ -53,6 +53,7 @@ class NetworkTimeNotifier;
 class ServerBoundCertService;
 class ProxyConfigService;
 class ProxyService;
+class QuicServerInfoStore;
 class SdchManager;
 class SSLConfigService;
 class TransportSecurityState;
@@ -122,6 +123,10 @@ class IOThread : public content::BrowserThreadDelegate {
     scoped_refptr<net::SSLConfigService> ssl_config_service;
     scoped_ptr<net::HttpAuthHandlerFactory> http_auth_handler_factory;
     scoped_ptr<net::HttpServerProperties> http_server_properties;
+    // The QUIC server crypto configs, persisted across restarts and shared by
+    // the regular (non-incognito) profiles so that more QUIC connections can
+    // use 0-RTT handshakes.  Must outlive every HttpNetworkSession using it.
+    scoped_ptr<net::QuicServerInfoStore> quic_server_info_store;
     scoped_ptr<net::ProxyService> proxy_script_fetcher_proxy_service;
     scoped_ptr<net::HttpTransactionFactory>
         proxy_script_fetcher_http_transaction_factory;
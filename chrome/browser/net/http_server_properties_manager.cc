@@ -4,6 +4,8 @@
 
 #include "chrome/browser/net/http_server_properties_manager.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/metrics/histogram.h"
 #include "base/prefs/pref_service.h"
@@ -225,7 +227,9 @@ HttpServerPropertiesManager::spdy_settings_map() const {
 void HttpServerPropertiesManager::SetServerNetworkStats(
     const net::HostPortPair& host_port_pair,
     NetworkStats stats) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   http_server_properties_impl_->SetServerNetworkStats(host_port_pair, stats);
+  ScheduleUpdatePrefsOnIO();
 }
 
 const HttpServerPropertiesManager::NetworkStats*
@@ -321,6 +325,8 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnUI() {
       new net::PipelineCapabilityMap);
   scoped_ptr<net::AlternateProtocolMap> alternate_protocol_map(
       new net::AlternateProtocolMap);
+  scoped_ptr<ServerNetworkStatsMap> server_network_stats_map(
+      new ServerNetworkStatsMap);
 
   for (base::DictionaryValue::Iterator it(*servers_dict); !it.IsAtEnd();
        it.Advance()) {
@@ -385,6 +391,28 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnUI() {
           static_cast<net::HttpPipelinedHostCapability>(pipeline_capability);
     }
 
+    // Get the measured network stats.
+    DCHECK(!ContainsKey(*server_network_stats_map, server));
+    const base::DictionaryValue* network_stats_dict = NULL;
+    if (server_pref_dict->GetDictionaryWithoutPathExpansion(
+        "network_stats", &network_stats_dict)) {
+      int srtt = 0;
+      int bandwidth = 0;
+      if (!network_stats_dict->GetIntegerWithoutPathExpansion("srtt", &srtt) ||
+          srtt < 0 ||
+          !network_stats_dict->GetIntegerWithoutPathExpansion(
+              "bandwidth", &bandwidth) ||
+          bandwidth < 0) {
+        DVLOG(1) << "Malformed network_stats for server: " << server_str;
+        detected_corrupted_prefs = true;
+      } else {
+        NetworkStats network_stats;
+        network_stats.rtt = base::TimeDelta::FromMicroseconds(srtt);
+        network_stats.bandwidth_estimate = bandwidth;
+        (*server_network_stats_map)[server] = network_stats;
+      }
+    }
+
     // Get alternate_protocol server.
     DCHECK(!ContainsKey(*alternate_protocol_map, server));
     const base::DictionaryValue* port_alternate_protocol_dict = NULL;
@@ -434,6 +462,7 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnUI() {
                  base::Owned(spdy_settings_map.release()),
                  base::Owned(alternate_protocol_map.release()),
                  base::Owned(pipeline_capability_map.release()),
+                 base::Owned(server_network_stats_map.release()),
                  detected_corrupted_prefs));
 }
 
@@ -442,6 +471,7 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnIO(
     net::SpdySettingsMap* spdy_settings_map,
     net::AlternateProtocolMap* alternate_protocol_map,
     net::PipelineCapabilityMap* pipeline_capability_map,
+    ServerNetworkStatsMap* server_network_stats_map,
     bool detected_corrupted_prefs) {
   // Preferences have the master data because admins might have pushed new
   // preferences. Update the cached data with new data from preferences.
@@ -467,6 +497,11 @@ void HttpServerPropertiesManager::UpdateCacheFromPrefsOnIO(
   http_server_properties_impl_->InitializePipelineCapabilities(
       pipeline_capability_map);
 
+  UMA_HISTOGRAM_COUNTS("Net.CountOfServerNetworkStats",
+                       server_network_stats_map->size());
+  http_server_properties_impl_->InitializeServerNetworkStats(
+      server_network_stats_map);
+
   // Update the prefs with what we have read (delete all corrupted prefs).
   if (detected_corrupted_prefs)
     ScheduleUpdatePrefsOnIO();
@@ -518,6 +553,10 @@ void HttpServerPropertiesManager::UpdatePrefsFromCacheOnIO(
   *pipeline_capability_map =
       http_server_properties_impl_->GetPipelineCapabilityMap();
 
+  ServerNetworkStatsMap* server_network_stats_map = new ServerNetworkStatsMap;
+  *server_network_stats_map =
+      http_server_properties_impl_->server_network_stats_map();
+
   // Update the preferences on the UI thread.
   BrowserThread::PostTask(
       BrowserThread::UI,
@@ -528,18 +567,20 @@ void HttpServerPropertiesManager::UpdatePrefsFromCacheOnIO(
                  base::Owned(spdy_settings_map),
                  base::Owned(alternate_protocol_map),
                  base::Owned(pipeline_capability_map),
+                 base::Owned(server_network_stats_map),
                  completion));
 }
 
 // A local or temporary data structure to hold |supports_spdy|, SpdySettings,
-// PortAlternateProtocolPair, and |pipeline_capability| preferences for a
-// server. This is used only in UpdatePrefsOnUI.
+// PortAlternateProtocolPair, |pipeline_capability| and NetworkStats
+// preferences for a server. This is used only in UpdatePrefsOnUI.
 struct ServerPref {
   ServerPref()
       : supports_spdy(false),
         settings_map(NULL),
         alternate_protocol(NULL),
-        pipeline_capability(net::PIPELINE_UNKNOWN) {
+        pipeline_capability(net::PIPELINE_UNKNOWN),
+        network_stats(NULL) {
   }
   ServerPref(bool supports_spdy,
              const net::SettingsMap* settings_map,
@@ -547,12 +588,14 @@ struct ServerPref {
       : supports_spdy(supports_spdy),
         settings_map(settings_map),
         alternate_protocol(alternate_protocol),
-        pipeline_capability(net::PIPELINE_UNKNOWN) {
+        pipeline_capability(net::PIPELINE_UNKNOWN),
+        network_stats(NULL) {
   }
   bool supports_spdy;
   const net::SettingsMap* settings_map;
   const net::PortAlternateProtocolPair* alternate_protocol;
   net::HttpPipelinedHostCapability pipeline_capability;
+  const net::HttpServerProperties::NetworkStats* network_stats;
 };
 
 void HttpServerPropertiesManager::UpdatePrefsOnUI(
@@ -560,6 +603,7 @@ void HttpServerPropertiesManager::UpdatePrefsOnUI(
     net::SpdySettingsMap* spdy_settings_map,
     net::AlternateProtocolMap* alternate_protocol_map,
     net::PipelineCapabilityMap* pipeline_capability_map,
+    ServerNetworkStatsMap* server_network_stats_map,
     const base::Closure& completion) {
 
   typedef std::map<net::HostPortPair, ServerPref> ServerPrefMap;
@@ -636,6 +680,22 @@ void HttpServerPropertiesManager::UpdatePrefsOnUI(
     }
   }
 
+  // Add servers with measured network stats to server_pref_map.
+  for (ServerNetworkStatsMap::const_iterator map_it =
+           server_network_stats_map->begin();
+       map_it != server_network_stats_map->end(); ++map_it) {
+    const net::HostPortPair& server = map_it->first;
+
+    ServerPrefMap::iterator it = server_pref_map.find(server);
+    if (it == server_pref_map.end()) {
+      ServerPref server_pref;
+      server_pref.network_stats = &map_it->second;
+      server_pref_map[server] = server_pref;
+    } else {
+      it->second.network_stats = &map_it->second;
+    }
+  }
+
   // Persist the prefs::kHttpServerProperties.
   base::DictionaryValue http_server_properties_dict;
   base::DictionaryValue* servers_dict = new base::DictionaryValue;
@@ -684,6 +744,21 @@ void HttpServerPropertiesManager::UpdatePrefsOnUI(
                                    server_pref.pipeline_capability);
     }
 
+    // Save network stats.
+    if (server_pref.network_stats) {
+      base::DictionaryValue* network_stats_dict = new base::DictionaryValue;
+      network_stats_dict->SetInteger(
+          "srtt",
+          static_cast<int>(std::min<int64>(
+              server_pref.network_stats->rtt.InMicroseconds(), kint32max)));
+      network_stats_dict->SetInteger(
+          "bandwidth",
+          static_cast<int>(std::min<uint64>(
+              server_pref.network_stats->bandwidth_estimate, kint32max)));
+      server_pref_dict->SetWithoutPathExpansion("network_stats",
+                                                network_stats_dict);
+    }
+
     servers_dict->SetWithoutPathExpansion(server.ToString(), server_pref_dict);
   }
 
@@ -183,6 +183,7 @@ class HttpServerPropertiesManager
       net::SpdySettingsMap* spdy_settings_map,
       net::AlternateProtocolMap* alternate_protocol_map,
       net::PipelineCapabilityMap* pipeline_capability_map,
+      ServerNetworkStatsMap* server_network_stats_map,
       bool detected_corrupted_prefs);
 
   // These are used to delay updating the preferences when cached data in
@@ -210,6 +211,7 @@ class HttpServerPropertiesManager
       net::SpdySettingsMap* spdy_settings_map,
       net::AlternateProtocolMap* alternate_protocol_map,
       net::PipelineCapabilityMap* pipeline_capability_map,
+      ServerNetworkStatsMap* server_network_stats_map,
       const base::Closure& completion);
 
  private:
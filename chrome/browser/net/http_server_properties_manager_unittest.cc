@@ -61,17 +61,19 @@ class TestingHttpServerPropertiesManager : public HttpServerPropertiesManager {
 
   MOCK_METHOD0(UpdateCacheFromPrefsOnUI, void());
   MOCK_METHOD1(UpdatePrefsFromCacheOnIO, void(const base::Closure&));
-  MOCK_METHOD5(UpdateCacheFromPrefsOnIO,
+  MOCK_METHOD6(UpdateCacheFromPrefsOnIO,
                void(std::vector<std::string>* spdy_servers,
                     net::SpdySettingsMap* spdy_settings_map,
                     net::AlternateProtocolMap* alternate_protocol_map,
                     net::PipelineCapabilityMap* pipeline_capability_map,
+                    ServerNetworkStatsMap* server_network_stats_map,
                     bool detected_corrupted_prefs));
-  MOCK_METHOD4(UpdatePrefsOnUI,
+  MOCK_METHOD5(UpdatePrefsOnUI,
                void(base::ListValue* spdy_server_list,
                     net::SpdySettingsMap* spdy_settings_map,
                     net::AlternateProtocolMap* alternate_protocol_map,
-                    net::PipelineCapabilityMap* pipeline_capability_map));
+                    net::PipelineCapabilityMap* pipeline_capability_map,
+                    ServerNetworkStatsMap* server_network_stats_map));
 
  private:
   DISALLOW_COPY_AND_ASSIGN(TestingHttpServerPropertiesManager);
@@ -401,6 +403,60 @@ TEST_F(HttpServerPropertiesManagerTest, PipelineCapability) {
   Mock::VerifyAndClearExpectations(http_server_props_manager_.get());
 }
 
+TEST_F(HttpServerPropertiesManagerTest, ServerNetworkStats) {
+  ExpectPrefsUpdate();
+
+  net::HostPortPair quic_server("mail.google.com", 443);
+  EXPECT_TRUE(
+      http_server_props_manager_->GetServerNetworkStats(quic_server) == NULL);
+
+  // Post an update task to the IO thread. SetServerNetworkStats calls
+  // ScheduleUpdatePrefsOnIO.
+  net::HttpServerProperties::NetworkStats stats;
+  stats.rtt = base::TimeDelta::FromMilliseconds(42);
+  stats.bandwidth_estimate = 100000;
+  http_server_props_manager_->SetServerNetworkStats(quic_server, stats);
+
+  // Run the task.
+  loop_.RunUntilIdle();
+  Mock::VerifyAndClearExpectations(http_server_props_manager_.get());
+
+  // Verify that the stats were persisted.
+  const base::DictionaryValue* servers_dict = NULL;
+  ASSERT_TRUE(pref_service_.GetDictionary(prefs::kHttpServerProperties)->
+      GetDictionaryWithoutPathExpansion("servers", &servers_dict));
+  const base::DictionaryValue* server_pref_dict = NULL;
+  ASSERT_TRUE(servers_dict->GetDictionaryWithoutPathExpansion(
+      "mail.google.com:443", &server_pref_dict));
+  const base::DictionaryValue* network_stats_dict = NULL;
+  ASSERT_TRUE(server_pref_dict->GetDictionaryWithoutPathExpansion(
+      "network_stats", &network_stats_dict));
+  int srtt = 0;
+  EXPECT_TRUE(network_stats_dict->GetInteger("srtt", &srtt));
+  EXPECT_EQ(42000, srtt);
+
+  // Reload the cache from a fresh copy of the prefs; the stats must survive.
+  ExpectPrefsUpdate();
+  ExpectCacheUpdate();
+  http_server_props_manager_->SetServerNetworkStats(
+      net::HostPortPair("www.google.com", 443), stats);
+  base::DictionaryValue* http_server_properties_dict =
+      pref_service_.GetDictionary(prefs::kHttpServerProperties)->DeepCopy();
+  pref_service_.SetManagedPref(prefs::kHttpServerProperties,
+                               http_server_properties_dict);
+  loop_.RunUntilIdle();
+  Mock::VerifyAndClearExpectations(http_server_props_manager_.get());
+
+  const net::HttpServerProperties::NetworkStats* stats_ret =
+      http_server_props_manager_->GetServerNetworkStats(quic_server);
+  ASSERT_TRUE(stats_ret != NULL);
+  EXPECT_EQ(42, stats_ret->rtt.InMilliseconds());
+  EXPECT_EQ(100000U, stats_ret->bandwidth_estimate);
+  // Stats measured before the reload are kept.
+  EXPECT_TRUE(http_server_props_manager_->GetServerNetworkStats(
+      net::HostPortPair("www.google.com", 443)) != NULL);
+}
+
 TEST_F(HttpServerPropertiesManagerTest, Clear) {
   ExpectPrefsUpdate();
 
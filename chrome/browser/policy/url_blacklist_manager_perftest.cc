@@ -0,0 +1,102 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/policy/core/browser/url_blacklist_manager.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/values.h"
+#include "chrome/common/net/url_fixer_upper.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace policy {
+
+namespace {
+
+const int kNumURLs = 2000;
+const int kIterations = 20;
+
+// Helper to get the disambiguated SegmentURL() function.
+URLBlacklist::SegmentURLCallback GetSegmentURLCallback() {
+  return URLFixerUpper::SegmentURL;
+}
+
+// Filters like the ones found in enterprise URLBlacklist policies: whole
+// domains, single hosts, paths within a domain and scheme or port
+// restrictions.
+void CreateFilters(int count, int offset, base::ListValue* filters) {
+  for (int i = offset; i < offset + count; ++i) {
+    switch (i % 4) {
+      case 0:
+        filters->AppendString(base::StringPrintf("host%d.com", i));
+        break;
+      case 1:
+        filters->AppendString(base::StringPrintf(".www.host%d.com", i));
+        break;
+      case 2:
+        filters->AppendString(base::StringPrintf("host%d.com/path%d", i, i));
+        break;
+      case 3:
+        filters->AppendString(base::StringPrintf("https://host%d.com:443", i));
+        break;
+    }
+  }
+}
+
+std::vector<GURL> CreateURLs() {
+  std::vector<GURL> urls;
+  for (int i = 0; i < kNumURLs; ++i) {
+    urls.push_back(GURL(base::StringPrintf(
+        "http://a.b.www.host%d.com/path%d/%d.html?q=%d",
+        i % 1013, i % 89, i, i)));
+  }
+  return urls;
+}
+
+void RunBlacklist(int num_filters) {
+  base::ListValue block;
+  base::ListValue allow;
+  CreateFilters(num_filters, 0, &block);
+  CreateFilters(num_filters / 10, num_filters / 2, &allow);
+  std::vector<GURL> urls(CreateURLs());
+
+  URLBlacklist blacklist(GetSegmentURLCallback());
+  base::PerfTimeLogger build_timer(base::StringPrintf(
+      "URLBlacklist build %d filters", num_filters).c_str());
+  blacklist.Block(&block);
+  blacklist.Allow(&allow);
+  build_timer.Done();
+
+  base::PerfTimeLogger timer(base::StringPrintf(
+      "URLBlacklist lookup %d filters", num_filters).c_str());
+  size_t num_blocked = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < urls.size(); ++j) {
+      if (blacklist.IsURLBlocked(urls[j]))
+        ++num_blocked;
+    }
+  }
+  timer.Done();
+  EXPECT_GT(num_blocked, 0u);
+}
+
+}  // namespace
+
+TEST(URLBlacklistPerfTest, Filters10) {
+  RunBlacklist(10);
+}
+
+TEST(URLBlacklistPerfTest, Filters100) {
+  RunBlacklist(100);
+}
+
+TEST(URLBlacklistPerfTest, Filters1000) {
+  RunBlacklist(1000);
+}
+
+}  // namespace policy
@@ -30,6 +30,11 @@ struct Config {
   // Is rate limiting enabled?
   bool rate_limit_enabled;
 
+  // Is admission control enabled? When it is, a prerender whose host is
+  // expected to need more memory than is available is preconnected to
+  // instead, and prerenders are skipped shortly after memory pressure.
+  bool admission_control_enabled;
+
   // The maximum time that a prerender can wait for launch in the
   // PrerenderLinkManager.
   base::TimeDelta max_wait_to_launch;
@@ -223,7 +223,8 @@ PrerenderContents::PrerenderContents(
       creator_child_id_(-1),
       main_frame_id_(0),
       cookie_status_(0),
-      network_bytes_(0) {
+      network_bytes_(0),
+      peak_private_bytes_(0) {
   DCHECK(prerender_manager != NULL);
 }
 
@@ -401,6 +402,8 @@ PrerenderContents::~PrerenderContents() {
   bool used = final_status() == FINAL_STATUS_USED ||
               final_status() == FINAL_STATUS_WOULD_HAVE_BEEN_USED;
   prerender_manager_->RecordNetworkBytes(used, network_bytes_);
+  prerender_manager_->RecordPrivateMemory(prerender_url_, used,
+                                          peak_private_bytes_);
 
   // Broadcast the removal of aliases.
   for (content::RenderProcessHost::iterator host_iterator =
@@ -717,10 +720,11 @@ void PrerenderContents::DestroyWhenUsingTooManyResources() {
     return;
 
   size_t private_bytes, shared_bytes;
-  if (metrics->GetMemoryBytes(&private_bytes, &shared_bytes) &&
-      private_bytes > prerender_manager_->config().max_bytes) {
+  if (!metrics->GetMemoryBytes(&private_bytes, &shared_bytes))
+    return;
+  peak_private_bytes_ = std::max(peak_private_bytes_, private_bytes);
+  if (private_bytes > prerender_manager_->config().max_bytes)
     Destroy(FINAL_STATUS_MEMORY_LIMIT_EXCEEDED);
-  }
 }
 
 WebContents* PrerenderContents::ReleasePrerenderContents() {
@@ -468,6 +468,10 @@ class PrerenderContents : public content::NotificationObserver,
   // transferred over the network for resources.  Updated with AddNetworkBytes.
   int64 network_bytes_;
 
+  // The largest private memory use of the prerender's process seen by
+  // DestroyWhenUsingTooManyResources.
+  size_t peak_private_bytes_;
+
   DISALLOW_COPY_AND_ASSIGN(PrerenderContents);
 };
 
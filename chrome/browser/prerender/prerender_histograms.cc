@@ -440,6 +440,15 @@ void PrerenderHistograms::RecordNetworkBytes(bool used,
                               kBucketCount);
 }
 
+void PrerenderHistograms::RecordPrivateMemory(bool used,
+                                              size_t private_bytes) {
+  const int private_kb = static_cast<int>(private_bytes / 1024);
+  if (used)
+    UMA_HISTOGRAM_MEMORY_KB("Prerender.PrivateMemory.Used", private_kb);
+  else
+    UMA_HISTOGRAM_MEMORY_KB("Prerender.PrivateMemory.Wasted", private_kb);
+}
+
 uint8 PrerenderHistograms::GetCurrentExperimentId() const {
   if (!WithinWindow())
     return kNoExperiment;
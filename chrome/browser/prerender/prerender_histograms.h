@@ -116,6 +116,10 @@ class PrerenderHistograms {
                           int64 prerender_bytes,
                           int64 profile_bytes);
 
+  // Record the peak private memory of the prerender, whether it was used or
+  // not.
+  void RecordPrivateMemory(bool used, size_t private_bytes);
+
  private:
   base::TimeTicks GetCurrentTimeTicks() const;
 
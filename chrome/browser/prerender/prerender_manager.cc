@@ -17,6 +17,7 @@
 #include "base/prefs/pref_service.h"
 #include "base/stl_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/sys_info.h"
 #include "base/time/time.h"
 #include "base/timer/elapsed_timer.h"
 #include "base/values.h"
@@ -25,6 +26,7 @@
 #include "chrome/browser/common/cancelable_request.h"
 #include "chrome/browser/history/history_service_factory.h"
 #include "chrome/browser/net/chrome_cookie_notification_details.h"
+#include "chrome/browser/net/predictor.h"
 #include "chrome/browser/predictors/predictor_database.h"
 #include "chrome/browser/predictors/predictor_database_factory.h"
 #include "chrome/browser/prerender/prerender_condition.h"
@@ -244,7 +246,10 @@ PrerenderManager::PrerenderManager(Profile* profile,
       prerender_history_(new PrerenderHistory(kHistoryLength)),
       histograms_(new PrerenderHistograms()),
       profile_network_bytes_(0),
-      last_recorded_profile_network_bytes_(0) {
+      last_recorded_profile_network_bytes_(0),
+      private_memory_estimates_(kMaxPrivateMemoryEstimates),
+      memory_pressure_level_(
+          base::MemoryPressureListener::MEMORY_PRESSURE_MODERATE) {
   // There are some assumptions that the PrerenderManager is on the UI thread.
   // Any other checks simply make sure that the PrerenderManager is accessed on
   // the same thread that it was created on.
@@ -289,6 +294,9 @@ PrerenderManager::PrerenderManager(Profile* profile,
       content::NotificationService::AllBrowserContextsAndSources());
 
   MediaCaptureDevicesDispatcher::GetInstance()->AddObserver(this);
+
+  memory_pressure_listener_.reset(new base::MemoryPressureListener(
+      base::Bind(&PrerenderManager::OnMemoryPressure, base::Unretained(this))));
 }
 
 PrerenderManager::~PrerenderManager() {
@@ -1271,6 +1279,20 @@ PrerenderHandle* PrerenderManager::AddPrerender(
     return NULL;
   }
 
+  // Check that the prerender is affordable before paying for it, rather than
+  // waiting for it to exceed the memory limit.
+  switch (GetAdmissionDecision(url)) {
+    case ADMISSION_PRERENDER:
+      break;
+    case ADMISSION_PRECONNECT:
+      PreconnectInsteadOfPrerender(url);
+      RecordFinalStatus(origin, experiment, FINAL_STATUS_PRECONNECTED_INSTEAD);
+      return NULL;
+    case ADMISSION_SKIP:
+      RecordFinalStatus(origin, experiment, FINAL_STATUS_MEMORY_PRESSURE);
+      return NULL;
+  }
+
   PrerenderContents* prerender_contents = CreatePrerenderContents(
       url, referrer, origin, experiment);
   DCHECK(prerender_contents);
@@ -1323,6 +1345,53 @@ PrerenderHandle* PrerenderManager::AddPrerender(
   return prerender_handle;
 }
 
+PrerenderManager::AdmissionDecision PrerenderManager::GetAdmissionDecision(
+    const GURL& url) const {
+  if (!config_.admission_control_enabled)
+    return ADMISSION_PRERENDER;
+
+  // Shortly after memory pressure a new prerender would likely be discarded
+  // soon, or push out something the user is looking at.
+  if (!last_memory_pressure_time_.is_null() &&
+      GetCurrentTimeTicks() - last_memory_pressure_time_ <
+          base::TimeDelta::FromMilliseconds(kMemoryPressureWindowMs)) {
+    return memory_pressure_level_ ==
+        base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL ?
+            ADMISSION_SKIP : ADMISSION_PRECONNECT;
+  }
+
+  base::MRUCache<std::string, size_t>::const_iterator it =
+      private_memory_estimates_.Peek(url.host());
+  if (it == private_memory_estimates_.end())
+    return ADMISSION_PRERENDER;
+
+  // A prerender expected to exceed the limit would only be killed once it
+  // has already paid most of its cost.
+  const size_t estimate = it->second;
+  if (estimate > config_.max_bytes)
+    return ADMISSION_PRECONNECT;
+
+  // Leave at least as much memory again for everything else.
+  const int64 available = GetAvailablePhysicalMemory();
+  if (available > 0 && static_cast<int64>(estimate) * 2 > available)
+    return ADMISSION_PRECONNECT;
+
+  return ADMISSION_PRERENDER;
+}
+
+void PrerenderManager::PreconnectInsteadOfPrerender(const GURL& url) {
+  chrome_browser_net::Predictor* predictor = profile_->GetNetworkPredictor();
+  if (predictor)
+    predictor->PreconnectUrlAndSubresources(url, GURL());
+}
+
+void PrerenderManager::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  DCHECK(CalledOnValidThread());
+  memory_pressure_level_ = memory_pressure_level;
+  last_memory_pressure_time_ = GetCurrentTimeTicks();
+}
+
 void PrerenderManager::StartSchedulingPeriodicCleanups() {
   DCHECK(CalledOnValidThread());
   if (repeating_timer_.IsRunning())
@@ -1416,6 +1485,10 @@ base::TimeTicks PrerenderManager::GetCurrentTimeTicks() const {
   return base::TimeTicks::Now();
 }
 
+int64 PrerenderManager::GetAvailablePhysicalMemory() const {
+  return base::SysInfo::AmountOfAvailablePhysicalMemory();
+}
+
 PrerenderContents* PrerenderManager::CreatePrerenderContents(
     const GURL& url,
     const content::Referrer& referrer,
@@ -1785,6 +1858,25 @@ void PrerenderManager::RecordNetworkBytes(bool used, int64 prerender_bytes) {
   histograms_->RecordNetworkBytes(used, prerender_bytes, recent_profile_bytes);
 }
 
+void PrerenderManager::RecordPrivateMemory(const GURL& url,
+                                           bool used,
+                                           size_t private_bytes) {
+  DCHECK(CalledOnValidThread());
+  // The process of a prerender which never started has nothing to report.
+  if (!private_bytes)
+    return;
+  histograms_->RecordPrivateMemory(used, private_bytes);
+
+  // Blend with the previous estimate so one unusual page does not decide
+  // the fate of every later prerender from its host.
+  const std::string host = url.host();
+  base::MRUCache<std::string, size_t>::iterator it =
+      private_memory_estimates_.Get(host);
+  if (it != private_memory_estimates_.end())
+    private_bytes = (it->second + private_bytes) / 2;
+  private_memory_estimates_.Put(host, private_bytes);
+}
+
 void PrerenderManager::AddProfileNetworkBytesIfEnabled(int64 bytes) {
   DCHECK_GE(bytes, 0);
   if (IsEnabled() && ActuallyPrerendering())
@@ -11,7 +11,9 @@
 #include <utility>
 #include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
@@ -323,6 +325,10 @@ class PrerenderManager : public base::SupportsWeakPtr<PrerenderManager>,
   virtual base::Time GetCurrentTime() const;
   virtual base::TimeTicks GetCurrentTimeTicks() const;
 
+  // Returns the amount of physical memory available to a new prerender.
+  // Virtual so that tests can control admission.
+  virtual int64 GetAvailablePhysicalMemory() const;
+
   scoped_refptr<predictors::LoggedInPredictorTable>
   logged_in_predictor_table() {
     return logged_in_predictor_table_;
@@ -350,6 +356,11 @@ class PrerenderManager : public base::SupportsWeakPtr<PrerenderManager>,
   // recorded.
   void RecordNetworkBytes(bool used, int64 prerender_bytes);
 
+  // Notification that a prerender of |url| has completed, having used at most
+  // |private_bytes| of private memory. Records the memory, and updates the
+  // estimate of what a prerender from the host of |url| will cost.
+  void RecordPrivateMemory(const GURL& url, bool used, size_t private_bytes);
+
   // Add to the running tally of bytes transferred over the network for this
   // profile if prerendering is currently enabled.
   void AddProfileNetworkBytesIfEnabled(int64 bytes);
@@ -516,8 +527,33 @@ class PrerenderManager : public base::SupportsWeakPtr<PrerenderManager>,
   // Time window for which we record old navigations, in milliseconds.
   static const int kNavigationRecordWindowMs = 5000;
 
+  // Time after a memory pressure notification during which new prerenders
+  // are not admitted, in milliseconds.
+  static const int kMemoryPressureWindowMs = 30000;
+
+  // Number of hosts whose prerender memory use is remembered.
+  static const int kMaxPrivateMemoryEstimates = 100;
+
+  // What to do with a prerender request.
+  enum AdmissionDecision {
+    ADMISSION_PRERENDER,
+    ADMISSION_PRECONNECT,
+    ADMISSION_SKIP
+  };
+
   void OnCancelPrerenderHandle(PrerenderData* prerender_data);
 
+  // Decides whether a prerender of |url| is affordable right now, given the
+  // memory earlier prerenders from its host used and the memory pressure the
+  // system has reported.
+  AdmissionDecision GetAdmissionDecision(const GURL& url) const;
+
+  // Warms up the connections for |url| in place of a prerender.
+  void PreconnectInsteadOfPrerender(const GURL& url);
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
   // Adds a prerender for |url| from |referrer| initiated from the process
   // |child_id|. The |origin| specifies how the prerender was added. If |size|
   // is empty, then PrerenderContents::StartPrerendering will instead use a
@@ -709,6 +745,16 @@ class PrerenderManager : public base::SupportsWeakPtr<PrerenderManager>,
   // The value of profile_network_bytes_ that was last recorded.
   int64 last_recorded_profile_network_bytes_;
 
+  // Estimated private memory of a prerender, keyed by host, from the peak use
+  // of completed prerenders.
+  base::MRUCache<std::string, size_t> private_memory_estimates_;
+
+  scoped_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  // The most recent memory pressure notification, and when it arrived.
+  base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level_;
+  base::TimeTicks last_memory_pressure_time_;
+
   DISALLOW_COPY_AND_ASSIGN(PrerenderManager);
 };
 
@@ -93,12 +93,15 @@ class UnitTestPrerenderManager : public PrerenderManager {
  public:
   using PrerenderManager::kMinTimeBetweenPrerendersMs;
   using PrerenderManager::kNavigationRecordWindowMs;
+  using PrerenderManager::kMemoryPressureWindowMs;
+  using PrerenderManager::OnMemoryPressure;
 
   explicit UnitTestPrerenderManager(Profile* profile,
                                     PrerenderTracker* prerender_tracker)
       : PrerenderManager(profile, prerender_tracker),
         time_(Time::Now()),
         time_ticks_(TimeTicks::Now()),
+        available_physical_memory_(GG_INT64_C(4) * 1024 * 1024 * 1024),
         prerender_tracker_(prerender_tracker) {
     set_rate_limit_enabled(false);
   }
@@ -194,6 +197,10 @@ class UnitTestPrerenderManager : public PrerenderManager {
     mutable_config().rate_limit_enabled = enabled;
   }
 
+  void set_available_physical_memory(int64 bytes) {
+    available_physical_memory_ = bytes;
+  }
+
   PrerenderContents* next_prerender_contents() {
     return next_prerender_contents_.get();
   }
@@ -207,6 +214,10 @@ class UnitTestPrerenderManager : public PrerenderManager {
     return time_ticks_;
   }
 
+  virtual int64 GetAvailablePhysicalMemory() const OVERRIDE {
+    return available_physical_memory_;
+  }
+
   virtual PrerenderContents* GetPrerenderContentsForRoute(
       int child_id, int route_id) const OVERRIDE {
     // Overridden for the PrerenderLinkManager's pending prerender logic.
@@ -256,6 +267,7 @@ class UnitTestPrerenderManager : public PrerenderManager {
 
   Time time_;
   TimeTicks time_ticks_;
+  int64 available_physical_memory_;
   scoped_ptr<PrerenderContents> next_prerender_contents_;
   // PrerenderContents with an |expected_final_status| of FINAL_STATUS_USED,
   // tracked so they will be automatically deleted.
@@ -438,6 +450,59 @@ TEST_F(PrerenderTest, DuplicateTest) {
   ASSERT_EQ(prerender_contents, prerender_manager()->FindAndUseEntry(url));
 }
 
+// Ensure that no prerender starts shortly after critical memory pressure.
+TEST_F(PrerenderTest, MemoryPressureTest) {
+  GURL url("http://www.google.com/");
+  prerender_manager()->OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL);
+  EXPECT_FALSE(AddSimplePrerender(url));
+
+  prerender_manager()->AdvanceTimeTicks(TimeDelta::FromMilliseconds(
+      UnitTestPrerenderManager::kMemoryPressureWindowMs + 1));
+  DummyPrerenderContents* prerender_contents =
+      prerender_manager()->CreateNextPrerenderContents(
+          url,
+          FINAL_STATUS_USED);
+  EXPECT_TRUE(AddSimplePrerender(url));
+  EXPECT_TRUE(prerender_contents->prerendering_has_started());
+  ASSERT_EQ(prerender_contents, prerender_manager()->FindAndUseEntry(url));
+}
+
+// Ensure that hosts whose prerenders used more memory than the limit, or than
+// the system can spare, are not prerendered again.
+TEST_F(PrerenderTest, MemoryEstimateTest) {
+  GURL url("http://www.google.com/");
+  const size_t max_bytes = prerender_manager()->config().max_bytes;
+
+  prerender_manager()->RecordPrivateMemory(url, false, max_bytes * 3);
+  EXPECT_FALSE(AddSimplePrerender(url));
+
+  // The estimate blends in new measurements.
+  prerender_manager()->RecordPrivateMemory(url, true, max_bytes / 4);
+  prerender_manager()->RecordPrivateMemory(url, true, max_bytes / 4);
+  prerender_manager()->set_available_physical_memory(max_bytes / 2);
+  EXPECT_FALSE(AddSimplePrerender(url));
+
+  prerender_manager()->set_available_physical_memory(max_bytes * 4);
+  DummyPrerenderContents* prerender_contents =
+      prerender_manager()->CreateNextPrerenderContents(
+          url,
+          FINAL_STATUS_USED);
+  EXPECT_TRUE(AddSimplePrerender(url));
+  EXPECT_TRUE(prerender_contents->prerendering_has_started());
+  ASSERT_EQ(prerender_contents, prerender_manager()->FindAndUseEntry(url));
+
+  // Other hosts are not affected.
+  GURL other_url("http://www.example.com/");
+  prerender_manager()->set_available_physical_memory(0);
+  prerender_contents = prerender_manager()->CreateNextPrerenderContents(
+      other_url,
+      FINAL_STATUS_USED);
+  EXPECT_TRUE(AddSimplePrerender(other_url));
+  ASSERT_EQ(prerender_contents,
+            prerender_manager()->FindAndUseEntry(other_url));
+}
+
 // Ensure that we expire a prerendered page after the max. permitted time.
 TEST_F(PrerenderTest, ExpireTest) {
   GURL url("http://www.google.com/");
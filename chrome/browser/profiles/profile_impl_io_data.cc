@@ -445,6 +445,10 @@ void ProfileImplIOData::InitializeInternal(
               .get());
   net::HttpNetworkSession::Params network_session_params;
   PopulateNetworkSessionParams(profile_params, &network_session_params);
+  // Only regular profiles get the on-disk QUIC server info store; incognito
+  // server configs and source address tokens must not be persisted.
+  network_session_params.quic_server_info_factory =
+      io_thread_globals->quic_server_info_store.get();
   net::HttpCache* main_cache = new net::HttpCache(
       network_session_params, main_backend);
   main_cache->InitializeInfiniteCache(lazy_params_->infinite_cache_path);
@@ -45,16 +45,24 @@
 //     n * 8 byte |&index_[0]..&index_[n]|
 //     m * 2 byte |&deltas_[0]..&deltas_[m]|
 //        16 byte digest
+//
+// |LoadFile()| maps the file and looks prefixes up in place rather than
+// copying the index and deltas to the heap.  The mapped pages are clean
+// and backed by the file, so they can be shared and discarded under
+// memory pressure.  A mapped file cannot be replaced on all platforms,
+// so a loaded set must be deleted before its file is rewritten.
 
 #ifndef CHROME_BROWSER_SAFE_BROWSING_PREFIX_SET_H_
 #define CHROME_BROWSER_SAFE_BROWSING_PREFIX_SET_H_
 
 #include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "chrome/browser/safe_browsing/safe_browsing_util.h"
 
 namespace base {
 class FilePath;
+class MemoryMappedFile;
 }
 
 namespace safe_browsing {
@@ -90,6 +98,16 @@ class PrefixSet {
   // |deltas| using |swap()|.
   PrefixSet(IndexVector* index, std::vector<uint16>* deltas);
 
+  // Helper for |LoadFile()|.  Looks prefixes up in the |index_size|
+  // pairs at |index| and the |deltas_size| deltas at |deltas|, both of
+  // which live in |file|.
+  PrefixSet(scoped_ptr<base::MemoryMappedFile> file,
+            const IndexPair* index, size_t index_size,
+            const uint16* deltas, size_t deltas_size);
+
+  // Points the lookup data at |index_| and |deltas_|.
+  void UseVectors();
+
   // Top-level index of prefix to offset in |deltas_|.  Each pair
   // indicates a base prefix and where the deltas from that prefix
   // begin in |deltas_|.  The deltas for a pair end at the next pair's
@@ -101,6 +119,17 @@ class PrefixSet {
   // |index_|, or the end of |deltas_| for the last |index_| pair.
   std::vector<uint16> deltas_;
 
+  // The file the set was loaded from.  When set, |index_| and |deltas_|
+  // are empty and the lookup data points into the mapping.
+  scoped_ptr<base::MemoryMappedFile> file_;
+
+  // The data |Exists()| and friends use, which is either the contents of
+  // |index_| and |deltas_| or part of |file_|.
+  const IndexPair* index_data_;
+  size_t index_size_;
+  const uint16* deltas_data_;
+  size_t deltas_size_;
+
   DISALLOW_COPY_AND_ASSIGN(PrefixSet);
 };
 
@@ -367,6 +367,30 @@ TEST_F(PrefixSetTest, ReadWrite) {
   }
 }
 
+// Test that a set which was read from disk can be written back out.
+TEST_F(PrefixSetTest, ReadWriteLoaded) {
+  base::FilePath filename;
+  ASSERT_TRUE(GetPrefixSetFile(&filename));
+  scoped_ptr<safe_browsing::PrefixSet>
+      loaded_set(safe_browsing::PrefixSet::LoadFile(filename));
+  ASSERT_TRUE(loaded_set.get());
+
+  const base::FilePath copy_filename =
+      temp_dir_.path().AppendASCII("PrefixSetCopy");
+  ASSERT_TRUE(loaded_set->WriteFile(copy_filename));
+  loaded_set.reset();
+
+  scoped_ptr<safe_browsing::PrefixSet>
+      prefix_set(safe_browsing::PrefixSet::LoadFile(copy_filename));
+  ASSERT_TRUE(prefix_set.get());
+  CheckPrefixes(*prefix_set, shared_prefixes_);
+
+  std::string contents, copy_contents;
+  ASSERT_TRUE(base::ReadFileToString(filename, &contents));
+  ASSERT_TRUE(base::ReadFileToString(copy_filename, &copy_contents));
+  EXPECT_EQ(contents, copy_contents);
+}
+
 // Check that |CleanChecksum()| makes an acceptable checksum.
 TEST_F(PrefixSetTest, CorruptionHelpers) {
   base::FilePath filename;
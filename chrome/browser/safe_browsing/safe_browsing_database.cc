@@ -655,6 +655,13 @@ void SafeBrowsingDatabaseNew::Init(const base::FilePath& filename_base) {
 bool SafeBrowsingDatabaseNew::ResetDatabase() {
   DCHECK_EQ(creation_loop_, base::MessageLoop::current());
 
+  // The prefix sets may be mapped from files which are about to be deleted.
+  {
+    base::AutoLock locked(lookup_lock_);
+    browse_prefix_set_.reset();
+    side_effect_free_whitelist_prefix_set_.reset();
+  }
+
   // Delete files on disk.
   // TODO(shess): Hard to see where one might want to delete without a
   // reset.  Perhaps inline |Delete()|?
@@ -1462,6 +1469,10 @@ void SafeBrowsingDatabaseNew::UpdateBrowseStore() {
     browse_prefix_set_.swap(prefix_set);
   }
 
+  // The old set may be mapped from the file which is about to be
+  // rewritten.
+  prefix_set.reset();
+
   DVLOG(1) << "SafeBrowsingDatabaseImpl built prefix set in "
            << (base::TimeTicks::Now() - before).InMilliseconds()
            << " ms total.  prefix count: " << add_prefixes.size();
@@ -1533,6 +1544,10 @@ void SafeBrowsingDatabaseNew::UpdateSideEffectFreeWhitelistStore() {
     side_effect_free_whitelist_prefix_set_.swap(prefix_set);
   }
 
+  // The old set may be mapped from the file which is about to be
+  // rewritten.
+  prefix_set.reset();
+
   const base::TimeTicks before = base::TimeTicks::Now();
   const bool write_ok = side_effect_free_whitelist_prefix_set_->WriteFile(
       side_effect_free_whitelist_prefix_set_filename_);
@@ -491,6 +491,10 @@ class SessionService : public BaseSessionService,
   // current/last session.
   bool move_on_new_browser_;
 
+  // Number of commands written by the last reset, i.e. the size of the
+  // session file right after it was recreated.
+  size_t commands_in_last_reset_;
+
   // Used for reporting frequency of session altering operations.
   base::TimeTicks last_updated_tab_closed_time_;
   base::TimeTicks last_updated_nav_list_pruned_time_;
@@ -31,6 +31,12 @@ class ThumbnailService : public RefcountedBrowserContextKeyedService {
   virtual bool SetPageThumbnail(const ThumbnailingContext& context,
                                 const gfx::Image& thumbnail) = 0;
 
+  // As SetPageThumbnail, for a thumbnail which has already been encoded as
+  // JPEG. Lets callers encode the thumbnail away from the UI thread.
+  virtual bool SetPageThumbnailToJPEGBytes(
+      const ThumbnailingContext& context,
+      const base::RefCountedMemory* jpeg_data) = 0;
+
   // Returns the ThumbnailingAlgorithm used for processing thumbnails.
   // It is always a new instance, the caller owns it. It will encapsulate the
   // process of creating a thumbnail from tab contents. The lifetime of these
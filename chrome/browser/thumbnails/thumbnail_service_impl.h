@@ -25,6 +25,9 @@ class ThumbnailServiceImpl : public ThumbnailService {
   // Implementation of ThumbnailService.
   virtual bool SetPageThumbnail(const ThumbnailingContext& context,
                                 const gfx::Image& thumbnail) OVERRIDE;
+  virtual bool SetPageThumbnailToJPEGBytes(
+      const ThumbnailingContext& context,
+      const base::RefCountedMemory* jpeg_data) OVERRIDE;
   virtual ThumbnailingAlgorithm* GetThumbnailingAlgorithm() const OVERRIDE;
   virtual bool GetPageThumbnail(
       const GURL& url,
@@ -4,12 +4,16 @@
 
 #include "chrome/browser/thumbnails/thumbnail_tab_helper.h"
 
+#include "base/memory/ref_counted_memory.h"
+#include "base/task_runner_util.h"
 #include "chrome/browser/browser_process.h"
+#include "chrome/browser/history/top_sites.h"
 #include "chrome/browser/profiles/profile.h"
 #include "chrome/browser/thumbnails/thumbnail_service.h"
 #include "chrome/browser/thumbnails/thumbnail_service_factory.h"
 #include "chrome/browser/thumbnails/thumbnailing_algorithm.h"
 #include "chrome/browser/thumbnails/thumbnailing_context.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/notification_details.h"
 #include "content/public/browser/notification_source.h"
 #include "content/public/browser/notification_types.h"
@@ -52,13 +56,37 @@ using thumbnails::ThumbnailingAlgorithm;
 
 namespace {
 
-// Feed the constructed thumbnail to the thumbnail service.
+// Encodes the thumbnail on a worker thread. JPEG encoding takes long enough
+// to cause jank if done on the UI thread.
+scoped_refptr<base::RefCountedBytes> EncodeThumbnail(
+    const SkBitmap& thumbnail) {
+  scoped_refptr<base::RefCountedBytes> jpeg_data;
+  if (!history::TopSites::EncodeBitmap(
+          gfx::Image::CreateFrom1xBitmap(thumbnail), &jpeg_data)) {
+    return NULL;
+  }
+  return jpeg_data;
+}
+
+// Feed the encoded thumbnail to the thumbnail service.
+void SetEncodedThumbnail(scoped_refptr<const ThumbnailingContext> context,
+                         scoped_refptr<base::RefCountedBytes> jpeg_data) {
+  DCHECK(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+  if (!jpeg_data.get())
+    return;
+  context->service->SetPageThumbnailToJPEGBytes(*context, jpeg_data.get());
+  VLOG(1) << "Thumbnail taken for " << context->url << ": "
+          << context->score.ToString();
+}
+
+// Encode the constructed thumbnail and feed it to the thumbnail service.
 void UpdateThumbnail(const ThumbnailingContext& context,
                      const SkBitmap& thumbnail) {
-  gfx::Image image = gfx::Image::CreateFrom1xBitmap(thumbnail);
-  context.service->SetPageThumbnail(context, image);
-  VLOG(1) << "Thumbnail taken for " << context.url << ": "
-          << context.score.ToString();
+  base::PostTaskAndReplyWithResult(
+      content::BrowserThread::GetBlockingPool(),
+      FROM_HERE,
+      base::Bind(&EncodeThumbnail, thumbnail),
+      base::Bind(&SetEncodedThumbnail, make_scoped_refptr(&context)));
 }
 
 void ProcessCapturedBitmap(scoped_refptr<ThumbnailingContext> context,
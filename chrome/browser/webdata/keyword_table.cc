@@ -247,7 +247,7 @@ bool KeywordTable::AddKeyword(const TemplateURLData& data) {
   std::string query("INSERT INTO keywords (" + GetKeywordColumns() + ") "
                     "VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,"
                     "        ?)");
-  sql::Statement s(db_->GetUniqueStatement(query.c_str()));
+  sql::Statement s(db_->GetCachedStatement(SQL_FROM_HERE, query.c_str()));
   BindURLToStatement(data, &s, 0, 1);
 
   return s.Run();
@@ -255,8 +255,8 @@ bool KeywordTable::AddKeyword(const TemplateURLData& data) {
 
 bool KeywordTable::RemoveKeyword(TemplateURLID id) {
   DCHECK(id);
-  sql::Statement s(
-      db_->GetUniqueStatement("DELETE FROM keywords WHERE id = ?"));
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE, "DELETE FROM keywords WHERE id = ?"));
   s.BindInt64(0, id);
 
   return s.Run();
@@ -284,7 +284,8 @@ bool KeywordTable::GetKeywords(Keywords* keywords) {
 
 bool KeywordTable::UpdateKeyword(const TemplateURLData& data) {
   DCHECK(data.id);
-  sql::Statement s(db_->GetUniqueStatement("UPDATE keywords SET short_name=?, "
+  sql::Statement s(db_->GetCachedStatement(SQL_FROM_HERE,
+      "UPDATE keywords SET short_name=?, "
       "keyword=?, favicon_url=?, url=?, safe_for_autoreplace=?, "
       "originating_url=?, date_created=?, usage_count=?, input_encodings=?, "
       "show_in_default_list=?, suggest_url=?, prepopulate_id=?, "
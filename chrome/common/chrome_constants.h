@@ -72,6 +72,7 @@ extern const base::FilePath::CharType kMediaCacheDirname[];
 extern const base::FilePath::CharType kNewTabThumbnailsFilename[];
 extern const base::FilePath::CharType kOBCertFilename[];
 extern const base::FilePath::CharType kPreferencesFilename[];
+extern const base::FilePath::CharType kQuicServerInfoFilename[];
 extern const base::FilePath::CharType kReadmeFilename[];
 extern const base::FilePath::CharType kResetPromptMementoFilename[];
 extern const base::FilePath::CharType kSafeBrowsingBaseFilename[];
@@ -56,6 +56,9 @@ void ServiceIPCServer::OnChannelError() {
   // client requests, we will recreate the channel.
   bool client_was_connected = client_connected_;
   client_connected_ = false;
+  // The next client hasn't seen any histogram descriptions yet.
+  if (histogram_delta_serializer_)
+    histogram_delta_serializer_->ResetSentHistogramInfo();
   // TODO(sanjeevr): Instead of invoking the service process for such handlers,
   // define a Client interface that the ServiceProcess can implement.
   if (client_was_connected) {
@@ -668,7 +668,8 @@ bool AutofillTable::GetIDAndCountOfFormElement(
   DCHECK(pair_id);
   DCHECK(count);
 
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "SELECT pair_id, count FROM autofill "
       "WHERE name = ? AND value = ?"));
   s.BindString16(0, element.name);
@@ -702,7 +703,8 @@ bool AutofillTable::GetCountOfFormElement(int64 pair_id, int* count) {
 }
 
 bool AutofillTable::SetCountOfFormElement(int64 pair_id, int count) {
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "UPDATE autofill SET count = ? WHERE pair_id = ?"));
   s.BindInt(0, count);
   s.BindInt64(1, pair_id);
@@ -713,7 +715,8 @@ bool AutofillTable::SetCountOfFormElement(int64 pair_id, int count) {
 bool AutofillTable::InsertFormElement(const FormFieldData& element,
                                       int64* pair_id) {
   DCHECK(pair_id);
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "INSERT INTO autofill (name, value, value_lower) VALUES (?,?,?)"));
   s.BindString16(0, element.name);
   s.BindString16(1, element.value);
@@ -728,7 +731,8 @@ bool AutofillTable::InsertFormElement(const FormFieldData& element,
 
 bool AutofillTable::InsertPairIDAndDate(int64 pair_id,
                                         const Time& date_created) {
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "INSERT INTO autofill_dates "
       "(pair_id, date_created) VALUES (?, ?)"));
   s.BindInt64(0, pair_id);
@@ -740,7 +744,8 @@ bool AutofillTable::InsertPairIDAndDate(int64 pair_id,
 bool AutofillTable::DeleteLastAccess(int64 pair_id) {
   // Inner SELECT selects the newest |date_created| for a given |pair_id|.
   // DELETE deletes only that entry.
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "DELETE FROM autofill_dates WHERE pair_id = ? and date_created IN "
       "(SELECT date_created FROM autofill_dates WHERE pair_id = ? "
       "ORDER BY date_created DESC LIMIT 1)"));
@@ -47,6 +47,14 @@ scoped_ptr<URLBlacklist> BuildBlacklist(
   return blacklist.Pass();
 }
 
+// Prepends a '.' to |host| unless it already starts with one, the same way
+// URLMatcher canonicalizes hosts for its host conditions.
+std::string CanonicalizeHost(const std::string& host) {
+  if (!host.empty() && host[0] == '.')
+    return host;
+  return "." + host;
+}
+
 }  // namespace
 
 struct URLBlacklist::FilterComponents {
@@ -62,13 +70,12 @@ struct URLBlacklist::FilterComponents {
 };
 
 URLBlacklist::URLBlacklist(SegmentURLCallback segment_url)
-    : segment_url_(segment_url), id_(0), url_matcher_(new URLMatcher) {}
+    : segment_url_(segment_url) {}
 
 URLBlacklist::~URLBlacklist() {}
 
 void URLBlacklist::AddFilters(bool allow,
                               const base::ListValue* list) {
-  URLMatcherConditionSet::Vector all_conditions;
   size_t size = std::min(kMaxFiltersPerPolicy, list->GetSize());
   for (size_t i = 0; i < size; ++i) {
     std::string pattern;
@@ -83,13 +90,14 @@ void URLBlacklist::AddFilters(bool allow,
       continue;
     }
 
-    all_conditions.push_back(
-        CreateConditionSet(url_matcher_.get(), ++id_, components.scheme,
-                           components.host, components.match_subdomains,
-                           components.port, components.path));
-    filters_[id_] = components;
+    if (components.match_subdomains) {
+      host_suffix_filters_[components.host].push_back(filters_.size());
+    } else {
+      host_equals_filters_[CanonicalizeHost(components.host)].push_back(
+          filters_.size());
+    }
+    filters_.push_back(components);
   }
-  url_matcher_->AddConditionSets(all_conditions);
 }
 
 void URLBlacklist::Block(const base::ListValue* filters) {
@@ -101,18 +109,21 @@ void URLBlacklist::Allow(const base::ListValue* filters) {
 }
 
 bool URLBlacklist::IsURLBlocked(const GURL& url) const {
-  std::set<URLMatcherConditionSet::ID> matching_ids =
-      url_matcher_->MatchURL(url);
-
   const FilterComponents* max = NULL;
-  for (std::set<URLMatcherConditionSet::ID>::iterator id = matching_ids.begin();
-       id != matching_ids.end(); ++id) {
-    std::map<int, FilterComponents>::const_iterator it = filters_.find(*id);
-    DCHECK(it != filters_.end());
-    const FilterComponents& filter = it->second;
-    if (!max || FilterTakesPrecedence(filter, *max))
-      max = &filter;
+  const std::string host = CanonicalizeHost(url.host());
+  const std::string scheme = url.scheme();
+  const int port = url.EffectiveIntPort();
+  const std::string path = url.path();
+  MatchFilters(host_equals_filters_, host, scheme, port, path, &max);
+
+  // Suffix filters always start at a component boundary, so only the suffixes
+  // of |host| that start with a '.' can match, plus the empty suffix.
+  for (size_t pos = host.find('.'); pos != std::string::npos;
+       pos = host.find('.', pos + 1)) {
+    MatchFilters(host_suffix_filters_, host.substr(pos), scheme, port, path,
+                 &max);
   }
+  MatchFilters(host_suffix_filters_, std::string(), scheme, port, path, &max);
 
   // Default to allow.
   if (!max)
@@ -240,6 +251,30 @@ scoped_refptr<URLMatcherConditionSet> URLBlacklist::CreateConditionSet(
                                     scheme_filter.Pass(), port_filter.Pass());
 }
 
+void URLBlacklist::MatchFilters(const HostMap& map,
+                                const std::string& host,
+                                const std::string& scheme,
+                                int port,
+                                const std::string& path,
+                                const FilterComponents** max) const {
+  HostMap::const_iterator it = map.find(host);
+  if (it == map.end())
+    return;
+
+  for (std::vector<size_t>::const_iterator index = it->second.begin();
+       index != it->second.end(); ++index) {
+    const FilterComponents& filter = filters_[*index];
+    if (!filter.scheme.empty() && filter.scheme != scheme)
+      continue;
+    if (filter.port != 0 && filter.port != port)
+      continue;
+    if (path.compare(0, filter.path.size(), filter.path) != 0)
+      continue;
+    if (!*max || FilterTakesPrecedence(filter, **max))
+      *max = &filter;
+  }
+}
+
 // static
 bool URLBlacklist::FilterTakesPrecedence(const FilterComponents& lhs,
                                          const FilterComponents& rhs) {
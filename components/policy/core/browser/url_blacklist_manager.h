@@ -5,8 +5,8 @@
 #ifndef COMPONENTS_POLICY_CORE_BROWSER_URL_BLACKLIST_MANAGER_H_
 #define COMPONENTS_POLICY_CORE_BROWSER_URL_BLACKLIST_MANAGER_H_
 
-#include <map>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
@@ -38,7 +38,9 @@ class PrefRegistrySyncable;
 namespace policy {
 
 // Contains a set of filters to block and allow certain URLs, and matches GURLs
-// against this set. The filters are currently kept in memory.
+// against this set. The filters are currently kept in memory, indexed by the
+// host they apply to so that a lookup only examines the filters for the
+// suffixes of the URL's host.
 class POLICY_EXPORT URLBlacklist {
  public:
   // This is meant to be bound to URLFixerUpper::SegmentURL. See that function
@@ -100,14 +102,33 @@ class POLICY_EXPORT URLBlacklist {
  private:
   struct FilterComponents;
 
+  // Maps a canonicalized host to the indices in |filters_| of the filters for
+  // that host.
+  typedef base::hash_map<std::string, std::vector<size_t> > HostMap;
+
   // Returns true if |lhs| takes precedence over |rhs|.
   static bool FilterTakesPrecedence(const FilterComponents& lhs,
                                     const FilterComponents& rhs);
 
+  // Updates |*max| with the filters listed under |host| in |map| that match
+  // the given |scheme|, |port| and |path|, keeping the one that takes
+  // precedence.
+  void MatchFilters(const HostMap& map,
+                    const std::string& host,
+                    const std::string& scheme,
+                    int port,
+                    const std::string& path,
+                    const FilterComponents** max) const;
+
   SegmentURLCallback segment_url_;
-  url_matcher::URLMatcherConditionSet::ID id_;
-  std::map<url_matcher::URLMatcherConditionSet::ID, FilterComponents> filters_;
-  scoped_ptr<url_matcher::URLMatcher> url_matcher_;
+  std::vector<FilterComponents> filters_;
+
+  // Filters that match subdomains, keyed by their host suffix. The suffix
+  // starts with a '.', or is empty for filters that match every host.
+  HostMap host_suffix_filters_;
+
+  // Filters that only match one host, keyed by that host with a leading '.'.
+  HostMap host_equals_filters_;
 
   DISALLOW_COPY_AND_ASSIGN(URLBlacklist);
 };
@@ -10,10 +10,17 @@
 #include "components/url_matcher/substring_set_matcher.h"
 #include "third_party/re2/re2/filtered_re2.h"
 #include "third_party/re2/re2/re2.h"
+#include "third_party/re2/re2/set.h"
 
 namespace url_matcher {
 
-RegexSetMatcher::RegexSetMatcher() {}
+// RE2::Set runs on the DFA only and cannot fall back to the NFA if its state
+// cache overflows. Larger collections use the prefilter instead, whose
+// per-regex automata stay small.
+const size_t RegexSetMatcher::kDefaultMaxRegexSetSize = 100;
+
+RegexSetMatcher::RegexSetMatcher()
+    : max_regex_set_size_(kDefaultMaxRegexSetSize) {}
 
 RegexSetMatcher::~RegexSetMatcher() {
   DeleteSubstringPatterns();
@@ -40,6 +47,15 @@ bool RegexSetMatcher::Match(const std::string& text,
   size_t old_number_of_matches = matches->size();
   if (regexes_.empty())
     return false;
+
+  if (regex_set_.get()) {
+    std::vector<RE2ID> re2_ids;
+    regex_set_->Match(text, &re2_ids);
+    for (size_t i = 0; i < re2_ids.size(); ++i)
+      matches->insert(re2_id_map_[re2_ids[i]]);
+    return old_number_of_matches != matches->size();
+  }
+
   if (!filtered_re2_.get()) {
     LOG(ERROR) << "RegexSetMatcher was not initialized";
     return false;
@@ -73,10 +89,16 @@ std::vector<RegexSetMatcher::RE2ID> RegexSetMatcher::FindSubstringMatches(
 
 void RegexSetMatcher::RebuildMatcher() {
   re2_id_map_.clear();
+  regex_set_.reset();
   filtered_re2_.reset(new re2::FilteredRE2());
+  substring_matcher_.reset();
+  DeleteSubstringPatterns();
   if (regexes_.empty())
     return;
 
+  if (regexes_.size() <= max_regex_set_size_ && BuildRegexSet())
+    return;
+
   for (RegexMap::iterator it = regexes_.begin(); it != regexes_.end(); ++it) {
     RE2ID re2_id;
     RE2::ErrorCode error = filtered_re2_->Add(
@@ -96,7 +118,6 @@ void RegexSetMatcher::RebuildMatcher() {
   filtered_re2_->Compile(&strings_to_match);
 
   substring_matcher_.reset(new SubstringSetMatcher);
-  DeleteSubstringPatterns();
   // Build SubstringSetMatcher from |strings_to_match|.
   // SubstringSetMatcher doesn't own its strings.
   for (size_t i = 0; i < strings_to_match.size(); ++i) {
@@ -106,6 +127,31 @@ void RegexSetMatcher::RebuildMatcher() {
   substring_matcher_->RegisterPatterns(substring_patterns_);
 }
 
+bool RegexSetMatcher::BuildRegexSet() {
+  scoped_ptr<RE2::Set> regex_set(
+      new RE2::Set(RE2::DefaultOptions, RE2::UNANCHORED));
+  for (RegexMap::iterator it = regexes_.begin(); it != regexes_.end(); ++it) {
+    RE2ID re2_id = regex_set->Add(it->second->pattern(), NULL);
+    if (re2_id >= 0) {
+      DCHECK_EQ(static_cast<RE2ID>(re2_id_map_.size()), re2_id);
+      re2_id_map_.push_back(it->first);
+    } else {
+      // Unparseable regexes should have been rejected already in
+      // URLMatcherFactory::CreateURLMatchesCondition.
+      LOG(ERROR) << "Could not parse regex (id=" << it->first << ", "
+                 << it->second->pattern() << ")";
+    }
+  }
+
+  // RE2::Set cannot compile an empty set.
+  if (re2_id_map_.empty() || !regex_set->Compile()) {
+    re2_id_map_.clear();
+    return false;
+  }
+  regex_set_ = regex_set.Pass();
+  return true;
+}
+
 void RegexSetMatcher::DeleteSubstringPatterns() {
   STLDeleteElements(&substring_patterns_);
 }
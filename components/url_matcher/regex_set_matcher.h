@@ -14,6 +14,7 @@
 #include "components/url_matcher/string_pattern.h"
 #include "components/url_matcher/substring_set_matcher.h"
 #include "components/url_matcher/url_matcher_export.h"
+#include "third_party/re2/re2/re2.h"
 
 namespace re2 {
 class FilteredRE2;
@@ -21,15 +22,28 @@ class FilteredRE2;
 
 namespace url_matcher {
 
-// Efficiently matches URLs against a collection of regular expressions,
-// using FilteredRE2 to reduce the number of regexes that must be matched
-// by pre-filtering with substring matching. See:
+// Efficiently matches URLs against a collection of regular expressions.
+// Small collections are compiled into a single RE2::Set, which matches all
+// regexes in one pass over the text. Larger collections, whose combined
+// automaton could exhaust the DFA's memory budget, use FilteredRE2 to reduce
+// the number of regexes that must be matched by pre-filtering with substring
+// matching. See:
 // http://swtch.com/~rsc/regexp/regexp3.html#analysis
 class URL_MATCHER_EXPORT RegexSetMatcher {
  public:
+  // Default for the largest number of regexes compiled into an RE2::Set.
+  static const size_t kDefaultMaxRegexSetSize;
+
   RegexSetMatcher();
   virtual ~RegexSetMatcher();
 
+  // Sets the largest number of regexes that are compiled into an RE2::Set;
+  // 0 always uses the FilteredRE2 prefilter. Takes effect on the next
+  // AddPatterns() or ClearPatterns().
+  void set_max_regex_set_size_for_testing(size_t size) {
+    max_regex_set_size_ = size;
+  }
+
   // Adds the regex patterns in |regex_list| to the matcher. Also rebuilds
   // the FilteredRE2 matcher; thus, for efficiency, prefer adding multiple
   // patterns at once.
@@ -61,6 +75,10 @@ class URL_MATCHER_EXPORT RegexSetMatcher {
   // apparently not supported by FilteredRE2.
   void RebuildMatcher();
 
+  // Tries to compile all regexes into |regex_set_|. Returns false, leaving
+  // |regex_set_| empty, if RE2 cannot compile the set.
+  bool BuildRegexSet();
+
   // Clean up StringPatterns in |substring_patterns_|.
   void DeleteSubstringPatterns();
 
@@ -70,6 +88,11 @@ class URL_MATCHER_EXPORT RegexSetMatcher {
   // to regex StringPattern::IDs.
   RE2IDMap re2_id_map_;
 
+  // Matches all regexes at once, if set. Otherwise |filtered_re2_| and
+  // |substring_matcher_| are used.
+  scoped_ptr<RE2::Set> regex_set_;
+  size_t max_regex_set_size_;
+
   scoped_ptr<re2::FilteredRE2> filtered_re2_;
   scoped_ptr<SubstringSetMatcher> substring_matcher_;
 
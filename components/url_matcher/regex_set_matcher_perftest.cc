@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/url_matcher/regex_set_matcher.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_vector.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace url_matcher {
+
+namespace {
+
+const int kNumURLs = 2000;
+const int kIterations = 20;
+
+// Regexes like the ones declarative webRequest rules are made of.
+void CreateRegexes(int count, ScopedVector<StringPattern>* patterns) {
+  for (int i = 0; i < count; ++i) {
+    std::string regex;
+    switch (i % 4) {
+      case 0:
+        regex = base::StringPrintf("^https?://([a-z]+\\.)*host%d\\.com/", i);
+        break;
+      case 1:
+        regex = base::StringPrintf("/path%d/[0-9]+\\.(js|css)$", i);
+        break;
+      case 2:
+        regex = base::StringPrintf("[?&]param%d=[^&]*ad", i);
+        break;
+      case 3:
+        regex = base::StringPrintf("tracker%d.*\\.gif", i);
+        break;
+    }
+    patterns->push_back(new StringPattern(regex, i));
+  }
+}
+
+std::vector<std::string> CreateURLs() {
+  std::vector<std::string> urls;
+  for (int i = 0; i < kNumURLs; ++i) {
+    urls.push_back(base::StringPrintf(
+        "http://www.host%d.com/path%d/%d.js?param%d=xyz&q=%d",
+        i % 97, i % 89, i, i % 83, i));
+  }
+  return urls;
+}
+
+void RunMatcher(int num_regexes, size_t max_regex_set_size) {
+  ScopedVector<StringPattern> patterns;
+  CreateRegexes(num_regexes, &patterns);
+  std::vector<const StringPattern*> regexes(patterns.begin(), patterns.end());
+  std::vector<std::string> urls(CreateURLs());
+
+  RegexSetMatcher matcher;
+  matcher.set_max_regex_set_size_for_testing(max_regex_set_size);
+  matcher.AddPatterns(regexes);
+
+  base::PerfTimeLogger timer(base::StringPrintf(
+      "RegexSetMatcher %d regexes, %s", num_regexes,
+      max_regex_set_size ? "RE2::Set" : "FilteredRE2").c_str());
+  size_t num_matches = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < urls.size(); ++j) {
+      std::set<StringPattern::ID> matches;
+      matcher.Match(urls[j], &matches);
+      num_matches += matches.size();
+    }
+  }
+  timer.Done();
+  EXPECT_GT(num_matches, 0u);
+}
+
+}  // namespace
+
+TEST(RegexSetMatcherPerfTest, Prefilter10) {
+  RunMatcher(10, 0);
+}
+
+TEST(RegexSetMatcherPerfTest, RegexSet10) {
+  RunMatcher(10, 10);
+}
+
+TEST(RegexSetMatcherPerfTest, Prefilter100) {
+  RunMatcher(100, 0);
+}
+
+TEST(RegexSetMatcherPerfTest, RegexSet100) {
+  RunMatcher(100, 100);
+}
+
+}  // namespace url_matcher
@@ -59,4 +59,46 @@ TEST(RegexSetMatcherTest, CaseSensitivity) {
   EXPECT_TRUE(ContainsKey(result2, 57));
 }
 
+// Checks that the RE2::Set and the FilteredRE2 prefilter find the same
+// matches.
+TEST(RegexSetMatcherTest, RegexSetAndPrefilterAgree) {
+  const char* const kRegexes[] = {
+    "ab.*c", "f*f", "c(ar|ra)b|brac", "^https://", "\\.com/$", "[0-9]{3}",
+    "(?i)MAIL", "x", "",
+  };
+  const char* const kTexts[] = {
+    "http://abracadabra.com/", "https://ffff.fi/cf", "http://123.net/",
+    "http://gmail.com/", "http://nothing.org", "",
+  };
+  std::vector<StringPattern*> patterns;
+  std::vector<const StringPattern*> regexes;
+  for (size_t i = 0; i < arraysize(kRegexes); ++i) {
+    patterns.push_back(new StringPattern(kRegexes[i], i));
+    regexes.push_back(patterns.back());
+  }
+
+  RegexSetMatcher set_matcher;
+  set_matcher.AddPatterns(regexes);
+  RegexSetMatcher prefilter_matcher;
+  prefilter_matcher.set_max_regex_set_size_for_testing(0);
+  prefilter_matcher.AddPatterns(regexes);
+
+  for (size_t i = 0; i < arraysize(kTexts); ++i) {
+    std::set<StringPattern::ID> set_matches;
+    std::set<StringPattern::ID> prefilter_matches;
+    EXPECT_EQ(prefilter_matcher.Match(kTexts[i], &prefilter_matches),
+              set_matcher.Match(kTexts[i], &set_matches)) << kTexts[i];
+    EXPECT_EQ(prefilter_matches, set_matches) << kTexts[i];
+    // The empty regex matches everything.
+    EXPECT_TRUE(ContainsKey(set_matches,
+                            static_cast<int>(arraysize(kRegexes) - 1)));
+  }
+
+  set_matcher.ClearPatterns();
+  EXPECT_TRUE(set_matcher.IsEmpty());
+  std::set<StringPattern::ID> matches;
+  EXPECT_FALSE(set_matcher.Match(kTexts[0], &matches));
+  STLDeleteElements(&patterns);
+}
+
 }  // namespace url_matcher
@@ -111,20 +111,19 @@ bool SubstringSetMatcher::Match(const std::string& text,
   const size_t old_number_of_matches = matches->size();
 
   // Handle patterns matching the empty string.
-  matches->insert(tree_[0].matches().begin(), tree_[0].matches().end());
+  AddMatchesOfNode(0, matches);
 
   uint32 current_node = 0;
   for (std::string::const_iterator i = text.begin(); i != text.end(); ++i) {
-    uint32 edge_from_current = tree_[current_node].GetEdge(*i);
+    uint32 edge_from_current = GetCompiledEdge(current_node, *i);
     while (edge_from_current == AhoCorasickNode::kNoSuchEdge &&
            current_node != 0) {
-      current_node = tree_[current_node].failure();
-      edge_from_current = tree_[current_node].GetEdge(*i);
+      current_node = compiled_nodes_[current_node].failure;
+      edge_from_current = GetCompiledEdge(current_node, *i);
     }
     if (edge_from_current != AhoCorasickNode::kNoSuchEdge) {
       current_node = edge_from_current;
-      matches->insert(tree_[current_node].matches().begin(),
-                      tree_[current_node].matches().end());
+      AddMatchesOfNode(current_node, matches);
     } else {
       DCHECK_EQ(0u, current_node);
     }
@@ -135,7 +134,7 @@ bool SubstringSetMatcher::Match(const std::string& text,
 
 bool SubstringSetMatcher::IsEmpty() const {
   // An empty tree consists of only the root node.
-  return patterns_.empty() && tree_.size() == 1u;
+  return patterns_.empty() && compiled_nodes_.size() == 1u;
 }
 
 void SubstringSetMatcher::RebuildAhoCorasickTree(
@@ -155,6 +154,7 @@ void SubstringSetMatcher::RebuildAhoCorasickTree(
   }
 
   CreateFailureEdges();
+  CompileAhoCorasickTree();
 }
 
 void SubstringSetMatcher::InsertPatternIntoAhoCorasickTree(
@@ -224,11 +224,103 @@ void SubstringSetMatcher::CreateFailureEdges() {
               ? edge_from_failure
               : 0;
       tree_[leads_to].set_failure(follow_in_case_of_failure);
-      tree_[leads_to].AddMatches(tree_[follow_in_case_of_failure].matches());
     }
   }
 }
 
+void SubstringSetMatcher::CompileAhoCorasickTree() {
+  typedef AhoCorasickNode::Edges Edges;
+
+  const uint32 num_nodes = tree_.size();
+  compiled_nodes_.resize(num_nodes);
+  edge_labels_.clear();
+  edge_labels_.reserve(num_nodes - 1);  // Every node but the root has a parent.
+  edge_targets_.clear();
+  edge_targets_.reserve(num_nodes - 1);
+  match_ids_.clear();
+
+  for (uint32 i = 0; i < num_nodes; ++i) {
+    const AhoCorasickNode& node = tree_[i];
+    CompiledNode& compiled = compiled_nodes_[i];
+
+    compiled.first_edge = edge_labels_.size();
+    compiled.num_edges = node.edges().size();
+    for (Edges::const_iterator e = node.edges().begin();
+         e != node.edges().end(); ++e) {
+      edge_labels_.push_back(e->first);
+      edge_targets_.push_back(e->second);
+    }
+
+    compiled.first_match = match_ids_.size();
+    compiled.num_matches = node.matches().size();
+    match_ids_.insert(match_ids_.end(),
+                      node.matches().begin(), node.matches().end());
+
+    compiled.failure = node.failure();
+    compiled.output = AhoCorasickNode::kNoSuchEdge;
+  }
+
+  std::fill(root_edges_, root_edges_ + arraysize(root_edges_),
+            AhoCorasickNode::kNoSuchEdge);
+  const Edges& root_edges = tree_[0].edges();
+  for (Edges::const_iterator e = root_edges.begin(); e != root_edges.end();
+       ++e) {
+    root_edges_[static_cast<unsigned char>(e->first)] = e->second;
+  }
+
+  // Output links point towards the root, so compute them in breadth-first
+  // order. Matches of the root are reported separately by Match().
+  std::queue<uint32> queue;
+  for (Edges::const_iterator e = root_edges.begin(); e != root_edges.end();
+       ++e) {
+    queue.push(e->second);
+  }
+  while (!queue.empty()) {
+    const uint32 current = queue.front();
+    queue.pop();
+    CompiledNode& compiled = compiled_nodes_[current];
+    const uint32 failure = compiled.failure;
+    if (failure != 0) {
+      compiled.output = compiled_nodes_[failure].num_matches > 0
+                            ? failure
+                            : compiled_nodes_[failure].output;
+    }
+    const Edges& edges = tree_[current].edges();
+    for (Edges::const_iterator e = edges.begin(); e != edges.end(); ++e)
+      queue.push(e->second);
+  }
+
+  // The map and set based nodes are much larger than the compiled ones and
+  // are not needed until the next rebuild.
+  std::vector<AhoCorasickNode>().swap(tree_);
+}
+
+uint32 SubstringSetMatcher::GetCompiledEdge(uint32 node, char c) const {
+  if (node == 0)
+    return root_edges_[static_cast<unsigned char>(c)];
+
+  const CompiledNode& compiled = compiled_nodes_[node];
+  std::vector<char>::const_iterator begin =
+      edge_labels_.begin() + compiled.first_edge;
+  std::vector<char>::const_iterator end = begin + compiled.num_edges;
+  std::vector<char>::const_iterator i = std::lower_bound(begin, end, c);
+  if (i == end || *i != c)
+    return AhoCorasickNode::kNoSuchEdge;
+  return edge_targets_[i - edge_labels_.begin()];
+}
+
+void SubstringSetMatcher::AddMatchesOfNode(
+    uint32 node,
+    std::set<StringPattern::ID>* matches) const {
+  while (node != AhoCorasickNode::kNoSuchEdge) {
+    const CompiledNode& compiled = compiled_nodes_[node];
+    std::vector<StringPattern::ID>::const_iterator begin =
+        match_ids_.begin() + compiled.first_match;
+    matches->insert(begin, begin + compiled.num_matches);
+    node = compiled.output;
+  }
+}
+
 const uint32 SubstringSetMatcher::AhoCorasickNode::kNoSuchEdge = ~0;
 
 SubstringSetMatcher::AhoCorasickNode::AhoCorasickNode()
@@ -264,9 +356,4 @@ void SubstringSetMatcher::AhoCorasickNode::AddMatch(StringPattern::ID id) {
   matches_.insert(id);
 }
 
-void SubstringSetMatcher::AhoCorasickNode::AddMatches(
-    const SubstringSetMatcher::AhoCorasickNode::Matches& matches) {
-  matches_.insert(matches.begin(), matches.end());
-}
-
 }  // namespace url_matcher
@@ -79,6 +79,10 @@ class URL_MATCHER_EXPORT SubstringSetMatcher {
   // If your brain thinks "Forget it, let's go shopping.", don't worry.
   // Take a nap and read an introductory text on the Aho Corasick algorithm.
   // It will make sense. Eventually.
+  //
+  // AhoCorasickNode is only used while building the tree. Once the failure
+  // edges are known, the tree is compiled into the flat arrays below and the
+  // nodes are released.
   class AhoCorasickNode {
    public:
     // Key: label of the edge, value: node index in |tree_| of parent class.
@@ -100,7 +104,6 @@ class URL_MATCHER_EXPORT SubstringSetMatcher {
     void set_failure(uint32 failure) { failure_ = failure; }
 
     void AddMatch(StringPattern::ID id);
-    void AddMatches(const Matches& matches);
     const Matches& matches() const { return matches_; }
 
    private:
@@ -110,10 +113,28 @@ class URL_MATCHER_EXPORT SubstringSetMatcher {
     // Node index that failure edge leads to.
     uint32 failure_;
 
-    // Identifiers of matches.
+    // Identifiers of patterns that end at this node. Matches of nodes on
+    // the failure path are not copied here; see CompiledNode::output.
     Matches matches_;
   };
 
+  // A node of the compiled automaton. Its index is the index of the
+  // AhoCorasickNode it was compiled from. The edges of a node are the range
+  // [first_edge, first_edge + num_edges) of |edge_labels_| and
+  // |edge_targets_|, sorted by label; its matches are the range
+  // [first_match, first_match + num_matches) of |match_ids_|.
+  struct CompiledNode {
+    uint32 first_edge;
+    uint32 num_edges;
+    uint32 first_match;
+    uint32 num_matches;
+    uint32 failure;
+    // The nearest node other than the root on the failure path of this node
+    // that has matches, or kNoSuchEdge. Reporting the matches of a node
+    // means reporting the matches along this chain.
+    uint32 output;
+  };
+
   typedef std::map<StringPattern::ID, const StringPattern*> SubstringPatternMap;
   typedef std::vector<const StringPattern*> SubstringPatternVector;
 
@@ -126,13 +147,34 @@ class URL_MATCHER_EXPORT SubstringSetMatcher {
   void InsertPatternIntoAhoCorasickTree(const StringPattern* pattern);
   void CreateFailureEdges();
 
+  // Flattens |tree_| into |compiled_nodes_| and friends and clears |tree_|.
+  void CompileAhoCorasickTree();
+
+  // Returns the node reached from compiled node |node| by an edge labeled
+  // |c|, or kNoSuchEdge.
+  uint32 GetCompiledEdge(uint32 node, char c) const;
+
+  // Adds the matches of compiled node |node| and its output chain.
+  void AddMatchesOfNode(uint32 node,
+                        std::set<StringPattern::ID>* matches) const;
+
   // Set of all registered StringPatterns. Used to regenerate the
   // Aho-Corasick tree in case patterns are registered or unregistered.
   SubstringPatternMap patterns_;
 
-  // The nodes of a Aho-Corasick tree.
+  // The nodes of a Aho-Corasick tree. Only populated during a rebuild.
   std::vector<AhoCorasickNode> tree_;
 
+  // The compiled Aho-Corasick tree that Match() runs on.
+  std::vector<CompiledNode> compiled_nodes_;
+  std::vector<char> edge_labels_;
+  std::vector<uint32> edge_targets_;
+  std::vector<StringPattern::ID> match_ids_;
+
+  // Edges of the root indexed by label. Match() falls back to the root after
+  // every mismatch, so its edges are looked up far more often than others.
+  uint32 root_edges_[256];
+
   DISALLOW_COPY_AND_ASSIGN(SubstringSetMatcher);
 };
 
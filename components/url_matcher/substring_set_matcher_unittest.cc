@@ -4,10 +4,12 @@
 
 #include "components/url_matcher/substring_set_matcher.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "base/memory/scoped_vector.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace url_matcher {
@@ -167,4 +169,48 @@ TEST(SubstringSetMatcherTest, TestEmptyMatcher) {
   EXPECT_TRUE(matches.empty());
 }
 
+// Checks many overlapping patterns, including non-ASCII characters, against
+// std::string::find.
+TEST(SubstringSetMatcherTest, ManyPatterns) {
+  const char kAlphabet[] = { 'a', 'b', 'c', '\x80', '\xff' };
+  uint32 seed = 1;
+  std::vector<std::string> strings;
+  for (int i = 0; i < 200; ++i) {
+    std::string s;
+    seed = seed * 1103515245 + 12345;
+    const size_t length = 1 + (seed >> 16) % 6;
+    while (s.length() < length) {
+      seed = seed * 1103515245 + 12345;
+      s.push_back(kAlphabet[(seed >> 16) % arraysize(kAlphabet)]);
+    }
+    if (std::find(strings.begin(), strings.end(), s) == strings.end())
+      strings.push_back(s);
+  }
+
+  ScopedVector<StringPattern> owned_patterns;
+  std::vector<const StringPattern*> patterns;
+  for (size_t i = 0; i < strings.size(); ++i) {
+    owned_patterns.push_back(new StringPattern(strings[i], i));
+    patterns.push_back(owned_patterns.back());
+  }
+  SubstringSetMatcher matcher;
+  matcher.RegisterPatterns(patterns);
+
+  for (int i = 0; i < 50; ++i) {
+    std::string text;
+    for (int j = 0; j < 40; ++j) {
+      seed = seed * 1103515245 + 12345;
+      text.push_back(kAlphabet[(seed >> 16) % arraysize(kAlphabet)]);
+    }
+    std::set<int> expected;
+    for (size_t j = 0; j < strings.size(); ++j) {
+      if (text.find(strings[j]) != std::string::npos)
+        expected.insert(j);
+    }
+    std::set<int> matches;
+    EXPECT_EQ(!expected.empty(), matcher.Match(text, &matches));
+    EXPECT_EQ(expected, matches);
+  }
+}
+
 }  // namespace url_matcher
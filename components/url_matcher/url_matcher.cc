@@ -9,6 +9,7 @@
 
 #include "base/logging.h"
 #include "url/gurl.h"
+#include "url/gurl_view.h"
 #include "url/url_canon.h"
 
 namespace url_matcher {
@@ -384,8 +385,12 @@ std::string URLMatcherConditionFactory::CanonicalizeURLForFullSearches(
       replacements.ClearPort();
     }
   }
-  return kBeginningOfURL + url.ReplaceComponents(replacements).spec() +
-      kEndOfURL;
+  url_canon::RawCanonOutput<1024> buffer;
+  GURLView canonical_url(url, replacements, &buffer);
+  std::string result = kBeginningOfURL;
+  canonical_url.spec().AppendToString(&result);
+  result.append(kEndOfURL);
+  return result;
 }
 
 static std::string CanonicalizeURLForRegexSearchesHelper(
@@ -405,7 +410,8 @@ static std::string CanonicalizeURLForRegexSearchesHelper(
       replacements.ClearPort();
     }
   }
-  return url.ReplaceComponents(replacements).spec();
+  url_canon::RawCanonOutput<1024> buffer;
+  return GURLView(url, replacements, &buffer).spec().as_string();
 }
 
 std::string URLMatcherConditionFactory::CanonicalizeURLForRegexSearches(
@@ -19,6 +19,7 @@
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/message_loop/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "base/path_service.h"
 #include "base/rand_util.h"
 #include "base/strings/string_util.h"
@@ -53,6 +54,11 @@ const unsigned VisitedLinkMaster::kDefaultTableSize = 16381;
 
 const size_t VisitedLinkMaster::kBigDeleteThreshold = 64;
 
+// The table grows when it is half full and stops accepting URLs at 80%, so
+// copying more than 10 / 3 slots per added URL finishes a resize in time.
+const int32 VisitedLinkMaster::kResizeSlotsPerAdd = 64;
+const int32 VisitedLinkMaster::kResizeSlotsPerTask = 32 * 1024;
+
 namespace {
 
 // Fills the given salt structure with some quasi-random values
@@ -182,7 +188,8 @@ VisitedLinkMaster::VisitedLinkMaster(content::BrowserContext* browser_context,
     : browser_context_(browser_context),
       delegate_(delegate),
       listener_(new VisitedLinkEventListener(this, browser_context)),
-      persist_to_disk_(persist_to_disk) {
+      persist_to_disk_(persist_to_disk),
+      weak_ptr_factory_(this) {
   InitMembers();
 }
 
@@ -194,7 +201,8 @@ VisitedLinkMaster::VisitedLinkMaster(Listener* listener,
                                      int32 default_table_size)
     : browser_context_(NULL),
       delegate_(delegate),
-      persist_to_disk_(persist_to_disk) {
+      persist_to_disk_(persist_to_disk),
+      weak_ptr_factory_(this) {
   listener_.reset(listener);
   DCHECK(listener_.get());
   InitMembers();
@@ -222,6 +230,11 @@ void VisitedLinkMaster::InitMembers() {
   shared_memory_ = NULL;
   shared_memory_serial_ = 0;
   used_items_ = 0;
+  resize_shared_memory_ = NULL;
+  resize_hash_table_ = NULL;
+  resize_table_length_ = 0;
+  resize_used_items_ = 0;
+  resize_next_slot_ = 0;
   table_size_override_ = 0;
   suppress_rebuild_ = false;
   sequence_token_ = BrowserThread::GetBlockingPool()->GetSequenceToken();
@@ -314,6 +327,9 @@ void VisitedLinkMaster::AddURLs(const std::vector<GURL>& url) {
 }
 
 void VisitedLinkMaster::DeleteAllURLs() {
+  // The new table would be empty too.
+  CancelIncrementalResize();
+
   // Any pending modifications are invalid.
   added_since_rebuild_.clear();
   deleted_since_rebuild_.clear();
@@ -398,6 +414,12 @@ VisitedLinkMaster::Hash VisitedLinkMaster::AddFingerprint(
       // End of probe sequence found, insert here.
       hash_table_[cur_hash] = fingerprint;
       used_items_++;
+      // Keep a table being grown in sync, the slot may have been copied.
+      if (resize_hash_table_ &&
+          AddFingerprintToTable(fingerprint, resize_hash_table_,
+                                resize_table_length_)) {
+        resize_used_items_++;
+      }
       // If allowed, notify listener that a new visited link was added.
       if (send_notifications)
         listener_->Add(fingerprint);
@@ -416,6 +438,27 @@ VisitedLinkMaster::Hash VisitedLinkMaster::AddFingerprint(
   }
 }
 
+// static
+bool VisitedLinkMaster::AddFingerprintToTable(Fingerprint fingerprint,
+                                              Fingerprint* table,
+                                              int32 table_length) {
+  Hash cur_hash = HashFingerprint(fingerprint, table_length);
+  Hash first_hash = cur_hash;
+  while (true) {
+    if (table[cur_hash] == fingerprint)
+      return false;
+    if (table[cur_hash] == null_fingerprint_) {
+      table[cur_hash] = fingerprint;
+      return true;
+    }
+    cur_hash = cur_hash >= table_length - 1 ? 0 : cur_hash + 1;
+    if (cur_hash == first_hash) {
+      NOTREACHED();  // The table is full.
+      return false;
+    }
+  }
+}
+
 void VisitedLinkMaster::DeleteFingerprintsFromCurrentTable(
     const std::set<Fingerprint>& fingerprints) {
   bool bulk_write = (fingerprints.size() > kBigDeleteThreshold);
@@ -443,6 +486,10 @@ bool VisitedLinkMaster::DeleteFingerprint(Fingerprint fingerprint,
   if (!IsVisited(fingerprint))
     return false;  // Not in the database to delete.
 
+  // Deleting moves other fingerprints around, possibly into slots that have
+  // already been copied, so don't do it halfway through a resize.
+  CompleteIncrementalResize();
+
   // First update the header used count.
   used_items_--;
   if (update_file && persist_to_disk_)
@@ -719,6 +766,7 @@ bool VisitedLinkMaster::BeginReplaceURLTable(int32 num_entries) {
 }
 
 void VisitedLinkMaster::FreeURLTable() {
+  CancelIncrementalResize();
   if (shared_memory_) {
     delete shared_memory_;
     shared_memory_ = NULL;
@@ -733,6 +781,11 @@ void VisitedLinkMaster::FreeURLTable() {
 bool VisitedLinkMaster::ResizeTableIfNecessary() {
   DCHECK(table_length_ > 0) << "Must have a table";
 
+  if (resize_hash_table_) {
+    ContinueIncrementalResize(kResizeSlotsPerAdd);
+    return false;
+  }
+
   // Load limits for good performance/space. We are pretty conservative about
   // keeping the table not very full. This is because we use linear probing
   // which increases the likelihood of clumps of entries which will reduce
@@ -750,12 +803,18 @@ bool VisitedLinkMaster::ResizeTableIfNecessary() {
   int new_size = NewTableSizeForCount(used_items_);
   DCHECK(new_size > used_items_);
   DCHECK(load <= min_table_load || new_size > table_length_);
+  if (new_size > table_length_) {
+    StartIncrementalResize(new_size);
+    return false;
+  }
   ResizeTable(new_size);
   return true;
 }
 
 void VisitedLinkMaster::ResizeTable(int32 new_size) {
   DCHECK(shared_memory_ && shared_memory_->memory() && hash_table_);
+  DCHECK(!resize_hash_table_);
+  base::TimeTicks start_time = base::TimeTicks::Now();
   shared_memory_serial_++;
 
 #ifndef NDEBUG
@@ -791,6 +850,110 @@ void VisitedLinkMaster::ResizeTable(int32 new_size) {
   // The new table needs to be written to disk.
   if (persist_to_disk_)
     WriteFullTable();
+
+  UMA_HISTOGRAM_TIMES("History.VisitedLinks.ResizeTime",
+                      base::TimeTicks::Now() - start_time);
+}
+
+void VisitedLinkMaster::StartIncrementalResize(int32 new_size) {
+  DCHECK(!resize_hash_table_);
+  base::TimeTicks start_time = base::TimeTicks::Now();
+
+  // CreateURLTable() sets up the members for the current table, so save
+  // them and move the new table aside.
+  base::SharedMemory* old_shared_memory = shared_memory_;
+  Fingerprint* old_hash_table = hash_table_;
+  int32 old_table_length = table_length_;
+  int32 old_used_items = used_items_;
+  bool created = CreateURLTable(new_size, true);
+  if (created) {
+    resize_shared_memory_ = shared_memory_;
+    resize_hash_table_ = hash_table_;
+    resize_table_length_ = table_length_;
+    resize_used_items_ = 0;
+    resize_next_slot_ = 0;
+  }
+  shared_memory_ = old_shared_memory;
+  hash_table_ = old_hash_table;
+  table_length_ = old_table_length;
+  used_items_ = old_used_items;
+  if (!created)
+    return;
+
+  resize_time_ = base::TimeTicks::Now() - start_time;
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&VisitedLinkMaster::OnIncrementalResizeTask,
+                 weak_ptr_factory_.GetWeakPtr()));
+}
+
+void VisitedLinkMaster::ContinueIncrementalResize(int32 slot_count) {
+  DCHECK(resize_hash_table_);
+  base::TimeTicks start_time = base::TimeTicks::Now();
+
+  int32 end_slot = std::min(table_length_, resize_next_slot_ + slot_count);
+  for (; resize_next_slot_ < end_slot; resize_next_slot_++) {
+    Fingerprint cur = hash_table_[resize_next_slot_];
+    if (cur &&
+        AddFingerprintToTable(cur, resize_hash_table_, resize_table_length_)) {
+      resize_used_items_++;
+    }
+  }
+  if (resize_next_slot_ < table_length_) {
+    resize_time_ += base::TimeTicks::Now() - start_time;
+    return;
+  }
+
+  // Everything has been copied, switch to the new table.
+  DCHECK_EQ(used_items_, resize_used_items_);
+  delete shared_memory_;
+  shared_memory_ = resize_shared_memory_;
+  hash_table_ = resize_hash_table_;
+  table_length_ = resize_table_length_;
+  used_items_ = resize_used_items_;
+  shared_memory_serial_++;
+  resize_shared_memory_ = NULL;
+  resize_hash_table_ = NULL;
+  resize_table_length_ = 0;
+  resize_used_items_ = 0;
+  resize_next_slot_ = 0;
+
+#ifndef NDEBUG
+  DebugValidate();
+#endif
+
+  listener_->NewTable(shared_memory_);
+  if (persist_to_disk_)
+    WriteFullTable();
+
+  resize_time_ += base::TimeTicks::Now() - start_time;
+  UMA_HISTOGRAM_TIMES("History.VisitedLinks.ResizeTime", resize_time_);
+}
+
+void VisitedLinkMaster::CompleteIncrementalResize() {
+  if (resize_hash_table_)
+    ContinueIncrementalResize(table_length_);
+}
+
+void VisitedLinkMaster::OnIncrementalResizeTask() {
+  if (!resize_hash_table_)
+    return;
+  ContinueIncrementalResize(kResizeSlotsPerTask);
+  if (resize_hash_table_) {
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&VisitedLinkMaster::OnIncrementalResizeTask,
+                   weak_ptr_factory_.GetWeakPtr()));
+  }
+}
+
+void VisitedLinkMaster::CancelIncrementalResize() {
+  delete resize_shared_memory_;
+  resize_shared_memory_ = NULL;
+  resize_hash_table_ = NULL;
+  resize_table_length_ = 0;
+  resize_used_items_ = 0;
+  resize_next_slot_ = 0;
 }
 
 uint32 VisitedLinkMaster::NewTableSizeForCount(int32 item_count) const {
@@ -830,6 +993,7 @@ bool VisitedLinkMaster::RebuildTableFromDelegate() {
   DCHECK(!table_builder_.get());
 
   // TODO(brettw) make sure we have reasonable salt!
+  rebuild_start_time_ = base::TimeTicks::Now();
   table_builder_ = new TableBuilder(this, salt_);
   delegate_->RebuildTable(table_builder_);
   return true;
@@ -840,6 +1004,12 @@ void VisitedLinkMaster::OnTableRebuildComplete(
     bool success,
     const std::vector<Fingerprint>& fingerprints) {
   if (success) {
+    UMA_HISTOGRAM_LONG_TIMES("History.VisitedLinks.RebuildTime",
+                             base::TimeTicks::Now() - rebuild_start_time_);
+
+    // The table is about to be replaced anyway.
+    CancelIncrementalResize();
+
     // Replace the old table with a new blank one.
     shared_memory_serial_++;
 
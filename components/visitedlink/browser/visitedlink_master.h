@@ -16,7 +16,9 @@
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/shared_memory.h"
+#include "base/memory/weak_ptr.h"
 #include "base/threading/sequenced_worker_pool.h"
+#include "base/time/time.h"
 #include "components/visitedlink/common/visitedlink_common.h"
 
 #if defined(UNIT_TEST) || defined(PERF_TEST) || !defined(NDEBUG)
@@ -159,6 +161,7 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, Delete);
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BigDelete);
   FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, BigImport);
+  FRIEND_TEST_ALL_PREFIXES(VisitedLinkTest, IncrementalResizing);
 
   // Object to rebuild the table on the history thread (see the .cc file).
   class TableBuilder;
@@ -187,6 +190,11 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // we will write the whole table to disk at once instead of individual items.
   static const size_t kBigDeleteThreshold;
 
+  // While the table grows, this many slots of the current table are copied
+  // to the new one on each added URL, and in each posted task.
+  static const int32 kResizeSlotsPerAdd;
+  static const int32 kResizeSlotsPerTask;
+
   // Backend for the constructors initializing the members.
   void InitMembers();
 
@@ -250,6 +258,12 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // duplicate and this item was skippped.
   Hash AddFingerprint(Fingerprint fingerprint, bool send_notifications);
 
+  // Adds |fingerprint| to |table| of |table_length| entries, using the same
+  // probe sequence as AddFingerprint. Returns false if it was already there.
+  static bool AddFingerprintToTable(Fingerprint fingerprint,
+                                    Fingerprint* table,
+                                    int32 table_length);
+
   // Deletes all fingerprints from the given vector from the current hash table
   // and syncs it to disk if there are changes. This does not update the
   // deleted_since_rebuild_ list, the caller must update this itself if there
@@ -292,13 +306,40 @@ class VisitedLinkMaster : public VisitedLinkCommon {
 
   // For growing the table. ResizeTableIfNecessary will check to see if the
   // table should be resized and calls ResizeTable if needed. Returns true if
-  // we decided to resize the table.
+  // the table was replaced, in which case the new table was written to disk.
+  // Growing the table starts an incremental resize instead, which returns
+  // false; so does moving an incremental resize along.
   bool ResizeTableIfNecessary();
 
   // Resizes the table (growing or shrinking) as necessary to accomodate the
   // current count.
   void ResizeTable(int32 new_size);
 
+  // Incremental resizing
+  // --------------------
+  // Rehashing a large table at once blocks the UI thread, so the table grows
+  // incrementally. A new table is allocated next to the current one and
+  // filled a few slots at a time. Renderers keep reading the current table,
+  // which stays complete since URLs are added to both, until the new one
+  // replaces it and is sent to them. Anything else that changes the table
+  // finishes the resize first.
+
+  // Allocates a table of |new_size| entries and starts copying to it.
+  void StartIncrementalResize(int32 new_size);
+
+  // Copies up to |slot_count| slots of the current table to the new one,
+  // and switches to the new table when everything has been copied.
+  void ContinueIncrementalResize(int32 slot_count);
+
+  // Finishes an incremental resize, if any, right away.
+  void CompleteIncrementalResize();
+
+  // Posted to copy the table while the UI thread is otherwise idle.
+  void OnIncrementalResizeTask();
+
+  // Frees the new table of an incremental resize, if any.
+  void CancelIncrementalResize();
+
   // Returns the desired table size for |item_count| URLs.
   uint32 NewTableSizeForCount(int32 item_count) const;
 
@@ -400,6 +441,22 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // Number of non-empty items in the table, used to compute fullness.
   int32 used_items_;
 
+  // The table being filled by an incremental resize, or NULL. Its shared
+  // memory has the same layout as |shared_memory_|.
+  base::SharedMemory* resize_shared_memory_;
+  Fingerprint* resize_hash_table_;
+  int32 resize_table_length_;
+  int32 resize_used_items_;
+
+  // Index of the next slot of |hash_table_| to copy to |resize_hash_table_|.
+  int32 resize_next_slot_;
+
+  // UI thread time spent on the current incremental resize so far.
+  base::TimeDelta resize_time_;
+
+  // When the current rebuild from the delegate started.
+  base::TimeTicks rebuild_start_time_;
+
   // Testing values -----------------------------------------------------------
   //
   // The following fields exist for testing purposes. They are not used in
@@ -423,6 +480,8 @@ class VisitedLinkMaster : public VisitedLinkCommon {
   // will be false in production.
   bool suppress_rebuild_;
 
+  base::WeakPtrFactory<VisitedLinkMaster> weak_ptr_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(VisitedLinkMaster);
 };
 
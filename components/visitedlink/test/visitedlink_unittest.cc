@@ -400,6 +400,51 @@ TEST_F(VisitedLinkTest, Resizing) {
   Reload();
 }
 
+// Tests that a large table grows incrementally: readers keep using the old
+// table, which stays complete, until the new one has been filled.
+TEST_F(VisitedLinkTest, IncrementalResizing) {
+  const int32 initial_size = VisitedLinkMaster::kDefaultTableSize;
+  ASSERT_TRUE(InitVisited(initial_size, true));
+
+  VisitedLinkSlave slave;
+  base::SharedMemoryHandle new_handle = base::SharedMemory::NULLHandle();
+  master_->shared_memory()->ShareToProcess(
+      base::GetCurrentProcessHandle(), &new_handle);
+  slave.OnUpdateVisitedLinks(new_handle);
+  g_slaves.push_back(&slave);
+
+  // Just past half full, the table starts growing. A few more URLs move the
+  // resize along, but not far enough to finish it.
+  const int url_count = initial_size / 2 + 10;
+  for (int i = 0; i < url_count; i++)
+    master_->AddURL(TestURL(i));
+
+  int32 table_size;
+  VisitedLinkCommon::Fingerprint* table;
+  master_->GetUsageStatistics(&table_size, &table);
+  EXPECT_EQ(initial_size, table_size);
+  for (int i = 0; i < url_count; i++) {
+    ASSERT_TRUE(master_->IsVisited(TestURL(i))) << i;
+    ASSERT_TRUE(slave.IsVisited(TestURL(i))) << i;
+  }
+
+  // The rest of the copying is done by posted tasks.
+  base::RunLoop().RunUntilIdle();
+
+  master_->GetUsageStatistics(&table_size, &table);
+  EXPECT_GT(table_size, initial_size);
+  EXPECT_EQ(url_count, master_->GetUsedCount());
+  int32 child_table_size;
+  VisitedLinkCommon::Fingerprint* child_table;
+  slave.GetUsageStatistics(&child_table_size, &child_table);
+  ASSERT_EQ(table_size, child_table_size);
+  for (int i = 0; i < url_count; i++)
+    ASSERT_TRUE(slave.IsVisited(TestURL(i))) << i;
+
+  master_->DebugValidate();
+  g_slaves.clear();
+}
+
 // Tests that if the database doesn't exist, it will be rebuilt from history.
 TEST_F(VisitedLinkTest, Rebuild) {
   // Add half of our URLs to history. This needs to be done before we
@@ -16,7 +16,10 @@
 
 WebDataRequest::WebDataRequest(WebDataServiceConsumer* consumer,
                                WebDataRequestManager* manager)
-    : manager_(manager), cancelled_(false), consumer_(consumer) {
+    : manager_(manager),
+      creation_time_(base::TimeTicks::Now()),
+      cancelled_(false),
+      consumer_(consumer) {
   handle_ = manager_->GetNextRequestHandle();
   message_loop_ = base::MessageLoop::current();
   manager_->RegisterRequest(this);
@@ -43,6 +46,10 @@ base::MessageLoop* WebDataRequest::GetMessageLoop() const {
   return message_loop_;
 }
 
+base::TimeTicks WebDataRequest::GetCreationTime() const {
+  return creation_time_;
+}
+
 bool WebDataRequest::IsCancelled() const {
   base::AutoLock l(cancel_lock_);
   return cancelled_;
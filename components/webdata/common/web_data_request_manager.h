@@ -13,6 +13,7 @@
 
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
+#include "base/time/time.h"
 #include "components/webdata/common/web_database_service.h"
 #include "components/webdata/common/web_data_results.h"
 #include "components/webdata/common/web_data_service_base.h"
@@ -48,6 +49,9 @@ class WebDataRequest {
   // Retrieves the original message loop the of the request.
   base::MessageLoop* GetMessageLoop() const;
 
+  // Returns when the request was made, to measure how long it was queued.
+  base::TimeTicks GetCreationTime() const;
+
   // Returns |true| if the request was cancelled via the |Cancel()| method.
   bool IsCancelled() const;
 
@@ -76,6 +80,9 @@ class WebDataRequest {
   // Identifier for this request.
   WebDataServiceBase::Handle handle_;
 
+  // When the request was made.
+  base::TimeTicks creation_time_;
+
   // A lock to protect against simultaneous cancellations of the request.
   // Cancellation affects both the |cancelled_| flag and |consumer_|.
   mutable base::Lock cancel_lock_;
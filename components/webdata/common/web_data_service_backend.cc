@@ -6,6 +6,9 @@
 
 #include "base/bind.h"
 #include "base/location.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/metrics/histogram.h"
+#include "base/time/time.h"
 #include "components/webdata/common/web_data_request_manager.h"
 #include "components/webdata/common/web_database.h"
 #include "components/webdata/common/web_database_table.h"
@@ -13,6 +16,14 @@
 using base::Bind;
 using base::FilePath;
 
+namespace {
+
+// How long a commit is deferred after a write, so that writes arriving within
+// this window share one transaction.
+const int kCommitDelayMs = 500;
+
+}  // namespace
+
 WebDataServiceBackend::WebDataServiceBackend(
     const FilePath& path,
     Delegate* delegate,
@@ -22,7 +33,10 @@ WebDataServiceBackend::WebDataServiceBackend(
       request_manager_(new WebDataRequestManager()),
       init_status_(sql::INIT_FAILURE),
       init_complete_(false),
-      delegate_(delegate) {
+      delegate_(delegate),
+      db_thread_(db_thread),
+      pending_writes_(0),
+      weak_ptr_factory_(this) {
 }
 
 void WebDataServiceBackend::AddTable(scoped_ptr<WebDatabaseTable> table) {
@@ -64,6 +78,7 @@ sql::InitStatus WebDataServiceBackend::LoadDatabaseIfNecessary() {
 void WebDataServiceBackend::ShutdownDatabase(bool should_reinit) {
   if (db_ && init_status_ == sql::INIT_OK)
     db_->CommitTransaction();
+  pending_writes_ = 0;
   db_.reset(NULL);
   init_complete_ = !should_reinit; // Setting init_complete_ to true will ensure
   // that the init sequence is not re-run.
@@ -77,6 +92,8 @@ void WebDataServiceBackend::DBWriteTaskWrapper(
   if (request->IsCancelled())
     return;
 
+  UMA_HISTOGRAM_TIMES("WebDatabase.TaskQueueTime",
+                      base::TimeTicks::Now() - request->GetCreationTime());
   ExecuteWriteTask(task);
   request_manager_->RequestCompleted(request.Pass());
 }
@@ -85,9 +102,12 @@ void WebDataServiceBackend::ExecuteWriteTask(
     const WebDatabaseService::WriteTask& task) {
   LoadDatabaseIfNecessary();
   if (db_ && init_status_ == sql::INIT_OK) {
+    base::TimeTicks start_time = base::TimeTicks::Now();
     WebDatabase::State state = task.Run(db_.get());
+    UMA_HISTOGRAM_TIMES("WebDatabase.WriteTaskTime",
+                        base::TimeTicks::Now() - start_time);
     if (state == WebDatabase::COMMIT_NEEDED)
-      Commit();
+      ScheduleCommit();
   }
 }
 
@@ -97,6 +117,8 @@ void WebDataServiceBackend::DBReadTaskWrapper(
   if (request->IsCancelled())
     return;
 
+  UMA_HISTOGRAM_TIMES("WebDatabase.TaskQueueTime",
+                      base::TimeTicks::Now() - request->GetCreationTime());
   request->SetResult(ExecuteReadTask(task).Pass());
   request_manager_->RequestCompleted(request.Pass());
 }
@@ -105,7 +127,11 @@ scoped_ptr<WDTypedResult> WebDataServiceBackend::ExecuteReadTask(
     const WebDatabaseService::ReadTask& task) {
   LoadDatabaseIfNecessary();
   if (db_ && init_status_ == sql::INIT_OK) {
-    return task.Run(db_.get());
+    base::TimeTicks start_time = base::TimeTicks::Now();
+    scoped_ptr<WDTypedResult> result = task.Run(db_.get());
+    UMA_HISTOGRAM_TIMES("WebDatabase.ReadTaskTime",
+                        base::TimeTicks::Now() - start_time);
+    return result.Pass();
   }
   return scoped_ptr<WDTypedResult>();
 }
@@ -116,9 +142,30 @@ WebDataServiceBackend::~WebDataServiceBackend() {
 
 void WebDataServiceBackend::Commit() {
   if (db_ && init_status_ == sql::INIT_OK) {
+    base::TimeTicks start_time = base::TimeTicks::Now();
     db_->CommitTransaction();
+    UMA_HISTOGRAM_TIMES("WebDatabase.CommitTime",
+                        base::TimeTicks::Now() - start_time);
     db_->BeginTransaction();
   } else {
     NOTREACHED() << "Commit scheduled after Shutdown()";
   }
 }
+
+void WebDataServiceBackend::ScheduleCommit() {
+  if (pending_writes_++ > 0)
+    return;
+  db_thread_->PostDelayedTask(
+      FROM_HERE,
+      Bind(&WebDataServiceBackend::CommitPendingWrites,
+           weak_ptr_factory_.GetWeakPtr()),
+      base::TimeDelta::FromMilliseconds(kCommitDelayMs));
+}
+
+void WebDataServiceBackend::CommitPendingWrites() {
+  if (pending_writes_ == 0)
+    return;
+  UMA_HISTOGRAM_COUNTS_100("WebDatabase.WritesPerCommit", pending_writes_);
+  pending_writes_ = 0;
+  Commit();
+}
@@ -13,6 +13,7 @@
 #include "base/memory/ref_counted_delete_on_message_loop.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
+#include "base/memory/weak_ptr.h"
 #include "components/webdata/common/web_database_service.h"
 #include "components/webdata/common/webdata_export.h"
 
@@ -28,6 +29,10 @@ class Location;
 // WebDataServiceBackend handles all database tasks posted by
 // WebDatabaseService. It is refcounted to allow asynchronous destruction on the
 // DB thread.
+//
+// Write tasks that need a commit don't commit right away. The commit is
+// deferred for a short window, so that a burst of writes (a form submission,
+// a keyword sync merge) shares a single SQLite transaction.
 
 // TODO(caitkp): Rename this class to WebDatabaseBackend.
 
@@ -95,6 +100,13 @@ class WEBDATA_EXPORT WebDataServiceBackend
   // Commit the current transaction.
   void Commit();
 
+  // Schedules a commit of the current transaction at the end of the batching
+  // window, unless one is already scheduled.
+  void ScheduleCommit();
+
+  // Commits the current transaction if any writes are waiting for it.
+  void CommitPendingWrites();
+
   // Path to database file.
   base::FilePath db_path_;
 
@@ -124,6 +136,17 @@ class WEBDATA_EXPORT WebDataServiceBackend
   // Delegate. See the class definition above for more information.
   scoped_ptr<Delegate> delegate_;
 
+  // The DB thread, where deferred commits are posted.
+  scoped_refptr<base::MessageLoopProxy> db_thread_;
+
+  // Number of write tasks that have run since the last commit and asked for
+  // one.
+  int pending_writes_;
+
+  // Used to post deferred commits; invalidated on destruction so that a
+  // pending commit doesn't keep the backend alive.
+  base::WeakPtrFactory<WebDataServiceBackend> weak_ptr_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(WebDataServiceBackend);
 };
 
@@ -4,6 +4,7 @@
 
 #include "content/browser/browser_main_loop.h"
 
+#include "base/allocator/sampling_heap_profiler.h"
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
@@ -111,6 +112,7 @@
 
 #if defined(TCMALLOC_TRACE_MEMORY_SUPPORTED)
 #include "third_party/tcmalloc/chromium/src/gperftools/heap-profiler.h"
+#include "third_party/tcmalloc/chromium/src/gperftools/malloc_hook_c.h"
 #endif
 
 #if defined(USE_X11)
@@ -129,6 +131,22 @@
 namespace content {
 namespace {
 
+#if defined(TCMALLOC_TRACE_MEMORY_SUPPORTED)
+void AddSamplingHeapProfilerHooks(
+    base::allocator::SamplingHeapProfiler::AllocHook alloc_hook,
+    base::allocator::SamplingHeapProfiler::FreeHook free_hook) {
+  MallocHook_AddNewHook(alloc_hook);
+  MallocHook_AddDeleteHook(free_hook);
+}
+
+void RemoveSamplingHeapProfilerHooks(
+    base::allocator::SamplingHeapProfiler::AllocHook alloc_hook,
+    base::allocator::SamplingHeapProfiler::FreeHook free_hook) {
+  MallocHook_RemoveNewHook(alloc_hook);
+  MallocHook_RemoveDeleteHook(free_hook);
+}
+#endif
+
 #if defined(OS_POSIX) && !defined(OS_MACOSX) && !defined(OS_ANDROID)
 void SetupSandbox(const CommandLine& parsed_command_line) {
   TRACE_EVENT0("startup", "SetupSandbox");
@@ -528,6 +546,11 @@ void BrowserMainLoop::MainMessageLoopStart() {
       ::HeapProfilerWithPseudoStackStart,
       ::HeapProfilerStop,
       ::GetHeapProfile));
+  sampling_heap_profiler_controller_.reset(
+      new base::allocator::SamplingHeapProfilerController(
+          base::MessageLoop::current()->message_loop_proxy(),
+          &AddSamplingHeapProfilerHooks,
+          &RemoveSamplingHeapProfilerHooks));
 #endif
 }
 
@@ -751,6 +774,7 @@ void BrowserMainLoop::ShutdownThreadsAndCleanUp() {
   }
 
   trace_memory_controller_.reset();
+  sampling_heap_profiler_controller_.reset();
   system_stats_monitor_.reset();
 
 #if !defined(OS_IOS)
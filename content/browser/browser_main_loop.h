@@ -19,6 +19,9 @@ class HighResolutionTimerManager;
 class MessageLoop;
 class PowerMonitor;
 class SystemMonitor;
+namespace allocator {
+class SamplingHeapProfilerController;
+}  // namespace allocator
 namespace debug {
 class TraceMemoryController;
 class TraceEventSystemStatsMonitor;
@@ -177,6 +180,8 @@ class CONTENT_EXPORT BrowserMainLoop {
   scoped_ptr<base::Thread> indexed_db_thread_;
   scoped_ptr<MemoryObserver> memory_observer_;
   scoped_ptr<base::debug::TraceMemoryController> trace_memory_controller_;
+  scoped_ptr<base::allocator::SamplingHeapProfilerController>
+      sampling_heap_profiler_controller_;
   scoped_ptr<base::debug::TraceEventSystemStatsMonitor> system_stats_monitor_;
 
   bool is_tracing_startup_;
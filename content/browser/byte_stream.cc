@@ -12,6 +12,7 @@
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/sequenced_task_runner.h"
+#include "base/synchronization/lock.h"
 
 namespace content {
 namespace {
@@ -21,6 +22,33 @@ ContentVector;
 
 class ByteStreamReaderImpl;
 
+// Data handed from the writer to the reader that the reader hasn't picked up
+// yet.  The writer only posts a TransferData task when none is pending; while
+// one is, further writes are appended here and ride along with it.  This
+// keeps the task count down to one per reader wakeup when the reader falls
+// behind, instead of one per third of the buffer.
+struct PendingTransfer : public base::RefCountedThreadSafe<PendingTransfer> {
+ public:
+  PendingTransfer()
+      : contents_size(0), complete(false), status(0), task_posted(false) {}
+
+  // Guards everything below.
+  base::Lock lock;
+  ContentVector contents;
+  size_t contents_size;
+  bool complete;
+  int status;
+  // True while a TransferData task is queued on the reader's task runner.
+  bool task_posted;
+
+ protected:
+  friend class base::RefCountedThreadSafe<PendingTransfer>;
+  virtual ~PendingTransfer() { }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PendingTransfer);
+};
+
 // A poor man's weak pointer; a RefCountedThreadSafe boolean that can be
 // cleared in an object destructor and accessed to check for object
 // existence.  We can't use weak pointers because they're tightly tied to
@@ -53,7 +81,8 @@ class ByteStreamWriterImpl : public ByteStreamWriter {
   // Must be called before any operations are performed.
   void SetPeer(ByteStreamReaderImpl* peer,
                scoped_refptr<base::SequencedTaskRunner> peer_task_runner,
-               scoped_refptr<LifetimeFlag> peer_lifetime_flag);
+               scoped_refptr<LifetimeFlag> peer_lifetime_flag,
+               scoped_refptr<PendingTransfer> pending_transfer);
 
   // Overridden from ByteStreamWriter.
   virtual bool Write(scoped_refptr<net::IOBuffer> buffer,
@@ -101,6 +130,9 @@ class ByteStreamWriterImpl : public ByteStreamWriter {
   // Only valid to access on peer_task_runner_ if
   // |*peer_lifetime_flag_ == true|
   ByteStreamReaderImpl* peer_;
+
+  // Shared with the reader; see PendingTransfer.
+  scoped_refptr<PendingTransfer> pending_transfer_;
 };
 
 class ByteStreamReaderImpl : public ByteStreamReader {
@@ -123,25 +155,18 @@ class ByteStreamReaderImpl : public ByteStreamReader {
 
   // PostTask target from |ByteStreamWriterImpl::Write| and
   // |ByteStreamWriterImpl::Close|.
-  // Receive data from our peer.
+  // Receive data from our peer, as accumulated in |pending_transfer|.
   // static because it may be called after the object it is targeting
   // has been destroyed.  It may not access |*target|
   // if |*object_lifetime_flag| is false.
   static void TransferData(
       scoped_refptr<LifetimeFlag> object_lifetime_flag,
       ByteStreamReaderImpl* target,
-      scoped_ptr<ContentVector> transfer_buffer,
-      size_t transfer_buffer_bytes,
-      bool source_complete,
-      int status);
+      scoped_refptr<PendingTransfer> pending_transfer);
 
  private:
   // Called from TransferData once object existence has been validated.
-  void TransferDataInternal(
-      scoped_ptr<ContentVector> transfer_buffer,
-      size_t transfer_buffer_bytes,
-      bool source_complete,
-      int status);
+  void TransferDataInternal(PendingTransfer* pending_transfer);
 
   void MaybeUpdateInput();
 
@@ -200,10 +225,12 @@ ByteStreamWriterImpl::~ByteStreamWriterImpl() {
 void ByteStreamWriterImpl::SetPeer(
     ByteStreamReaderImpl* peer,
     scoped_refptr<base::SequencedTaskRunner> peer_task_runner,
-    scoped_refptr<LifetimeFlag> peer_lifetime_flag) {
+    scoped_refptr<LifetimeFlag> peer_lifetime_flag,
+    scoped_refptr<PendingTransfer> pending_transfer) {
   peer_ = peer;
   peer_task_runner_ = peer_task_runner;
   peer_lifetime_flag_ = peer_lifetime_flag;
+  pending_transfer_ = pending_transfer;
 }
 
 bool ByteStreamWriterImpl::Write(
@@ -287,24 +314,38 @@ void ByteStreamWriterImpl::PostToPeer(bool complete, int status) {
   // Valid contexts in which to call.
   DCHECK(complete || 0 != input_contents_size_);
 
-  scoped_ptr<ContentVector> transfer_buffer;
-  size_t buffer_size = 0;
-  if (0 != input_contents_size_) {
-    transfer_buffer.reset(new ContentVector);
-    transfer_buffer->swap(input_contents_);
-    buffer_size = input_contents_size_;
-    output_size_used_ += input_contents_size_;
-    input_contents_size_ = 0;
+  bool post_task = false;
+  {
+    base::AutoLock auto_lock(pending_transfer_->lock);
+    ContentVector& contents = pending_transfer_->contents;
+    if (contents.empty()) {
+      contents.swap(input_contents_);
+    } else {
+      contents.insert(contents.end(),
+                      input_contents_.begin(), input_contents_.end());
+      input_contents_.clear();
+    }
+    pending_transfer_->contents_size += input_contents_size_;
+    if (complete) {
+      pending_transfer_->complete = true;
+      pending_transfer_->status = status;
+    }
+    if (!pending_transfer_->task_posted) {
+      pending_transfer_->task_posted = true;
+      post_task = true;
+    }
+  }
+  output_size_used_ += input_contents_size_;
+  input_contents_size_ = 0;
+
+  if (post_task) {
+    peer_task_runner_->PostTask(
+        FROM_HERE, base::Bind(
+            &ByteStreamReaderImpl::TransferData,
+            peer_lifetime_flag_,
+            peer_,
+            pending_transfer_));
   }
-  peer_task_runner_->PostTask(
-      FROM_HERE, base::Bind(
-          &ByteStreamReaderImpl::TransferData,
-          peer_lifetime_flag_,
-          peer_,
-          base::Passed(&transfer_buffer),
-          buffer_size,
-          complete,
-          status));
 }
 
 ByteStreamReaderImpl::ByteStreamReaderImpl(
@@ -372,32 +413,41 @@ void ByteStreamReaderImpl::RegisterCallback(
 void ByteStreamReaderImpl::TransferData(
     scoped_refptr<LifetimeFlag> object_lifetime_flag,
     ByteStreamReaderImpl* target,
-    scoped_ptr<ContentVector> transfer_buffer,
-    size_t buffer_size,
-    bool source_complete,
-    int status) {
+    scoped_refptr<PendingTransfer> pending_transfer) {
   // If our target is no longer alive, do nothing.
   if (!object_lifetime_flag->is_alive) return;
 
-  target->TransferDataInternal(
-      transfer_buffer.Pass(), buffer_size, source_complete, status);
+  target->TransferDataInternal(pending_transfer.get());
 }
 
 void ByteStreamReaderImpl::TransferDataInternal(
-    scoped_ptr<ContentVector> transfer_buffer,
-    size_t buffer_size,
-    bool source_complete,
-    int status) {
+    PendingTransfer* pending_transfer) {
   DCHECK(my_task_runner_->RunsTasksOnCurrentThread());
 
   bool was_empty = available_contents_.empty();
 
-  if (transfer_buffer) {
-    available_contents_.insert(available_contents_.end(),
-                               transfer_buffer->begin(),
-                               transfer_buffer->end());
+  // Take everything the writer has handed over so far; the next write will
+  // post a new task.
+  bool source_complete;
+  int status;
+  {
+    base::AutoLock auto_lock(pending_transfer->lock);
+    if (available_contents_.empty()) {
+      available_contents_.swap(pending_transfer->contents);
+    } else {
+      available_contents_.insert(available_contents_.end(),
+                                 pending_transfer->contents.begin(),
+                                 pending_transfer->contents.end());
+      pending_transfer->contents.clear();
+    }
+    pending_transfer->contents_size = 0;
+    source_complete = pending_transfer->complete;
+    status = pending_transfer->status;
+    pending_transfer->task_posted = false;
   }
 
+  // The writer never writes after Close(), so once |source_complete| has been
+  // seen no further tasks arrive.
   if (source_complete) {
     received_status_ = true;
     status_ = status;
@@ -453,7 +503,9 @@ void CreateByteStream(
   ByteStreamReaderImpl* out = new ByteStreamReaderImpl(
       output_task_runner, output_flag, buffer_size);
 
-  in->SetPeer(out, output_task_runner, output_flag);
+  scoped_refptr<PendingTransfer> pending_transfer(new PendingTransfer());
+
+  in->SetPeer(out, output_task_runner, output_flag, pending_transfer);
   out->SetPeer(in, input_task_runner, input_flag);
   input->reset(in);
   output->reset(out);
@@ -0,0 +1,159 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/byte_stream.h"
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/perf_time_logger.h"
+#include "base/threading/thread.h"
+#include "net/base/io_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+const size_t kStreamBufferSize = 100 * 1024;
+const size_t kTotalBytes = 512 * 1024 * 1024;
+
+// Pumps |kTotalBytes| through a ByteStream from a writer on one thread to a
+// reader on another, the way a download moves data from the IO thread to the
+// FILE thread.  Only touches the writer on the writer thread and the reader
+// on the reader thread.
+class ByteStreamPump {
+ public:
+  ByteStreamPump(scoped_ptr<ByteStreamWriter> writer,
+                 scoped_ptr<ByteStreamReader> reader,
+                 size_t write_size)
+      : writer_(writer.Pass()),
+        reader_(reader.Pass()),
+        write_size_(write_size),
+        bytes_written_(0),
+        bytes_read_(0),
+        done_(false, false) {
+  }
+
+  void StartWriter() {
+    writer_->RegisterCallback(
+        base::Bind(&ByteStreamPump::Write, base::Unretained(this)));
+    Write();
+  }
+
+  void StartReader() {
+    reader_->RegisterCallback(
+        base::Bind(&ByteStreamPump::Read, base::Unretained(this)));
+  }
+
+  void StopWriter() { writer_.reset(); }
+  void StopReader() { reader_.reset(); }
+
+  void Wait() { done_.Wait(); }
+
+  size_t bytes_read() const { return bytes_read_; }
+
+ private:
+  // Writes until the stream pushes back; the writer callback resumes.
+  void Write() {
+    while (bytes_written_ < kTotalBytes) {
+      scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(write_size_));
+      bytes_written_ += write_size_;
+      if (!writer_->Write(buffer, write_size_))
+        return;
+    }
+    writer_->Close(0);
+  }
+
+  void Read() {
+    scoped_refptr<net::IOBuffer> buffer;
+    size_t length = 0;
+    for (;;) {
+      switch (reader_->Read(&buffer, &length)) {
+        case ByteStreamReader::STREAM_HAS_DATA:
+          bytes_read_ += length;
+          break;
+        case ByteStreamReader::STREAM_EMPTY:
+          return;
+        case ByteStreamReader::STREAM_COMPLETE:
+          done_.Signal();
+          return;
+      }
+    }
+  }
+
+  scoped_ptr<ByteStreamWriter> writer_;
+  scoped_ptr<ByteStreamReader> reader_;
+  const size_t write_size_;
+  size_t bytes_written_;
+  size_t bytes_read_;
+  base::WaitableEvent done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ByteStreamPump);
+};
+
+}  // namespace
+
+class ByteStreamPerfTest : public testing::Test {
+ public:
+  ByteStreamPerfTest()
+      : writer_thread_("ByteStream writer"),
+        reader_thread_("ByteStream reader") {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(writer_thread_.Start());
+    ASSERT_TRUE(reader_thread_.Start());
+  }
+
+  void RunPump(size_t write_size) {
+    scoped_ptr<ByteStreamWriter> writer;
+    scoped_ptr<ByteStreamReader> reader;
+    CreateByteStream(writer_thread_.message_loop_proxy(),
+                     reader_thread_.message_loop_proxy(),
+                     kStreamBufferSize, &writer, &reader);
+    ByteStreamPump pump(writer.Pass(), reader.Pass(), write_size);
+
+    base::PerfTimeLogger timer(
+        base::StringPrintf("ByteStream %d byte writes",
+                           static_cast<int>(write_size)).c_str());
+    reader_thread_.message_loop_proxy()->PostTask(
+        FROM_HERE,
+        base::Bind(&ByteStreamPump::StartReader, base::Unretained(&pump)));
+    writer_thread_.message_loop_proxy()->PostTask(
+        FROM_HERE,
+        base::Bind(&ByteStreamPump::StartWriter, base::Unretained(&pump)));
+    pump.Wait();
+    timer.Done();
+
+    EXPECT_EQ(kTotalBytes, pump.bytes_read());
+
+    // Tear down on the owning threads; Stop() flushes the posted tasks.
+    writer_thread_.message_loop_proxy()->PostTask(
+        FROM_HERE,
+        base::Bind(&ByteStreamPump::StopWriter, base::Unretained(&pump)));
+    reader_thread_.message_loop_proxy()->PostTask(
+        FROM_HERE,
+        base::Bind(&ByteStreamPump::StopReader, base::Unretained(&pump)));
+    writer_thread_.Stop();
+    reader_thread_.Stop();
+  }
+
+ private:
+  base::Thread writer_thread_;
+  base::Thread reader_thread_;
+};
+
+// Small writes, as from a network socket read.
+TEST_F(ByteStreamPerfTest, SmallWrites) {
+  RunPump(4 * 1024);
+}
+
+// Writes the size of the download resource handler's read buffer.
+TEST_F(ByteStreamPerfTest, LargeWrites) {
+  RunPump(32 * 1024);
+}
+
+}  // namespace content
@@ -363,6 +363,43 @@ TEST_F(ByteStreamTest, ByteStream_SinkCallback) {
             byte_stream_output->Read(&output_io_buffer, &output_length));
 }
 
+// Confirm that transfers posted while the reader hasn't yet picked up an
+// earlier one ride along with it instead of posting a task of their own.
+TEST_F(ByteStreamTest, ByteStream_CoalescedTransfers) {
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner(
+      new base::TestSimpleTaskRunner());
+
+  scoped_ptr<ByteStreamWriter> byte_stream_input;
+  scoped_ptr<ByteStreamReader> byte_stream_output;
+  CreateByteStream(
+      message_loop_.message_loop_proxy(), task_runner,
+      10000, &byte_stream_input, &byte_stream_output);
+
+  int num_callbacks = 0;
+  byte_stream_output->RegisterCallback(
+      base::Bind(CountCallbacks, &num_callbacks));
+
+  // Each write is above the posting threshold.
+  EXPECT_TRUE(Write(byte_stream_input.get(), 4000));
+  EXPECT_TRUE(Write(byte_stream_input.get(), 4000));
+  byte_stream_input->Close(0);
+  EXPECT_EQ(1U, task_runner->GetPendingTasks().size());
+
+  task_runner->RunUntilIdle();
+  EXPECT_EQ(1, num_callbacks);
+
+  scoped_refptr<net::IOBuffer> output_io_buffer;
+  size_t output_length;
+  EXPECT_EQ(ByteStreamReader::STREAM_HAS_DATA,
+            byte_stream_output->Read(&output_io_buffer, &output_length));
+  EXPECT_TRUE(ValidateIOBuffer(output_io_buffer, output_length));
+  EXPECT_EQ(ByteStreamReader::STREAM_HAS_DATA,
+            byte_stream_output->Read(&output_io_buffer, &output_length));
+  EXPECT_TRUE(ValidateIOBuffer(output_io_buffer, output_length));
+  EXPECT_EQ(ByteStreamReader::STREAM_COMPLETE,
+            byte_stream_output->Read(&output_io_buffer, &output_length));
+}
+
 // Confirm that callbacks on the source side are triggered when they should
 // be.
 TEST_F(ByteStreamTest, ByteStream_SourceCallback) {
@@ -139,7 +139,7 @@ bool DOMStorageArea::SetItem(const base::string16& key,
   bool success = map_->SetItem(key, value, old_value);
   if (success && backing_) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
-    commit_batch->changed_values[key] = base::NullableString16(value, false);
+    commit_batch->dirty_keys.insert(key);
   }
   return success;
 }
@@ -154,7 +154,7 @@ bool DOMStorageArea::RemoveItem(const base::string16& key,
   bool success = map_->RemoveItem(key, old_value);
   if (success && backing_) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
-    commit_batch->changed_values[key] = base::NullableString16();
+    commit_batch->dirty_keys.insert(key);
   }
   return success;
 }
@@ -172,7 +172,7 @@ bool DOMStorageArea::Clear() {
   if (backing_) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
     commit_batch->clear_all_first = true;
-    commit_batch->changed_values.clear();
+    commit_batch->dirty_keys.clear();
   }
 
   return true;
@@ -194,7 +194,7 @@ void DOMStorageArea::FastClear() {
   if (backing_) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
     commit_batch->clear_all_first = true;
-    commit_batch->changed_values.clear();
+    commit_batch->dirty_keys.clear();
   }
 }
 
@@ -269,6 +269,8 @@ void DOMStorageArea::PurgeMemory() {
 void DOMStorageArea::Shutdown() {
   DCHECK(!is_shutdown_);
   is_shutdown_ = true;
+  if (commit_batch_)
+    PopulateCommitBatchValues();
   map_ = NULL;
   if (!backing_)
     return;
@@ -335,6 +337,20 @@ DOMStorageArea::CommitBatch* DOMStorageArea::CreateCommitBatchIfNeeded() {
   return commit_batch_.get();
 }
 
+void DOMStorageArea::PopulateCommitBatchValues() {
+  // This method executes on the primary sequence, which owns |map_|.
+  DCHECK(commit_batch_);
+  DCHECK(map_.get());
+  DOMStorageValuesMap& changed_values = commit_batch_->changed_values;
+  for (std::set<base::string16>::const_iterator it =
+           commit_batch_->dirty_keys.begin();
+       it != commit_batch_->dirty_keys.end(); ++it) {
+    // A null value tells the backing store to delete the key.
+    changed_values[*it] = map_->GetItem(*it);
+  }
+  commit_batch_->dirty_keys.clear();
+}
+
 void DOMStorageArea::OnCommitTimer() {
   if (is_shutdown_)
     return;
@@ -349,6 +365,7 @@ void DOMStorageArea::OnCommitTimer() {
   // This method executes on the primary sequence, we schedule
   // a task for immediate execution on the commit sequence.
   DCHECK(task_runner_->IsRunningOnPrimarySequence());
+  PopulateCommitBatchValues();
   bool success = task_runner_->PostShutdownBlockingTask(
       FROM_HERE,
       DOMStorageTaskRunner::COMMIT_SEQUENCE,
@@ -5,6 +5,8 @@
 #ifndef CONTENT_BROWSER_DOM_STORAGE_DOM_STORAGE_AREA_H_
 #define CONTENT_BROWSER_DOM_STORAGE_DOM_STORAGE_AREA_H_
 
+#include <set>
+
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
@@ -95,8 +97,12 @@ class CONTENT_EXPORT DOMStorageArea
   FRIEND_TEST_ALL_PREFIXES(DOMStorageContextImplTest, PersistentIds);
   friend class base::RefCountedThreadSafe<DOMStorageArea>;
 
+  // Changes are recorded as a set of dirty keys; their values are only
+  // copied out of |map_| when the batch is handed to the commit sequence,
+  // so a key written many times between commits is copied once.
   struct CommitBatch {
     bool clear_all_first;
+    std::set<base::string16> dirty_keys;
     DOMStorageValuesMap changed_values;
     CommitBatch();
     ~CommitBatch();
@@ -113,6 +119,7 @@ class CONTENT_EXPORT DOMStorageArea
   // disk on the commit sequence, and to call back on the primary
   // task sequence when complete.
   CommitBatch* CreateCommitBatchIfNeeded();
+  void PopulateCommitBatchValues();
   void OnCommitTimer();
   void CommitChanges(const CommitBatch* commit_batch);
   void OnCommitComplete();
@@ -228,11 +228,11 @@ TEST_F(DOMStorageAreaTest, CommitTasks) {
   EXPECT_TRUE(area->HasUncommittedChanges());
   EXPECT_TRUE(area->commit_batch_.get());
   EXPECT_FALSE(area->commit_batch_->clear_all_first);
-  EXPECT_EQ(1u, area->commit_batch_->changed_values.size());
+  EXPECT_EQ(1u, area->commit_batch_->dirty_keys.size());
   EXPECT_TRUE(area->SetItem(kKey2, kValue2, &old_value));
   EXPECT_TRUE(area->commit_batch_.get());
   EXPECT_FALSE(area->commit_batch_->clear_all_first);
-  EXPECT_EQ(2u, area->commit_batch_->changed_values.size());
+  EXPECT_EQ(2u, area->commit_batch_->dirty_keys.size());
   base::MessageLoop::current()->RunUntilIdle();
   EXPECT_FALSE(area->HasUncommittedChanges());
   EXPECT_FALSE(area->commit_batch_.get());
@@ -248,7 +248,7 @@ TEST_F(DOMStorageAreaTest, CommitTasks) {
   EXPECT_TRUE(area->Clear());
   EXPECT_TRUE(area->commit_batch_.get());
   EXPECT_TRUE(area->commit_batch_->clear_all_first);
-  EXPECT_TRUE(area->commit_batch_->changed_values.empty());
+  EXPECT_TRUE(area->commit_batch_->dirty_keys.empty());
   base::MessageLoop::current()->RunUntilIdle();
   EXPECT_FALSE(area->commit_batch_.get());
   EXPECT_EQ(0, area->commit_batches_in_flight_);
@@ -279,6 +279,21 @@ TEST_F(DOMStorageAreaTest, CommitTasks) {
   EXPECT_EQ(2u, values.size());
   EXPECT_EQ(kValue, values[kKey].string());
   EXPECT_EQ(kValue2, values[kKey2].string());
+
+  // See that repeated writes to a key are recorded once, and that the
+  // value committed is the latest one, including a removal.
+  base::string16 removed_value;
+  EXPECT_TRUE(area->SetItem(kKey, kValue2, &old_value));
+  EXPECT_TRUE(area->SetItem(kKey, kValue, &old_value));
+  EXPECT_TRUE(area->RemoveItem(kKey2, &removed_value));
+  EXPECT_EQ(2u, area->commit_batch_->dirty_keys.size());
+  EXPECT_TRUE(area->commit_batch_->changed_values.empty());
+  base::MessageLoop::current()->RunUntilIdle();
+  EXPECT_FALSE(area->HasUncommittedChanges());
+  values.clear();
+  area->backing_->ReadAllValues(&values);
+  EXPECT_EQ(1u, values.size());
+  EXPECT_EQ(kValue, values[kKey].string());
 }
 
 TEST_F(DOMStorageAreaTest, CommitChangesAtShutdown) {
@@ -25,6 +25,7 @@ namespace content {
 
 const int kUpdatePeriodMs = 500;
 const int kMaxTimeBlockingFileThreadMs = 1000;
+const size_t kMaxWriteBufferSize = 128 * 1024;
 
 int DownloadFile::number_active_objects_ = 0;
 
@@ -226,16 +227,19 @@ void DownloadFileImpl::StreamActive() {
       case ByteStreamReader::STREAM_HAS_DATA:
         {
           ++num_buffers;
-          base::TimeTicks write_start(base::TimeTicks::Now());
-          reason = AppendDataToFile(
+          reason = BufferDataForFile(
               incoming_data.get()->data(), incoming_data_size);
-          disk_writes_time_ += (base::TimeTicks::Now() - write_start);
           bytes_seen_ += incoming_data_size;
           total_incoming_data_size += incoming_data_size;
         }
         break;
       case ByteStreamReader::STREAM_COMPLETE:
         {
+          // A failed write of the last buffered data is reported like any
+          // other write error.
+          reason = FlushWriteBuffer();
+          if (reason != DOWNLOAD_INTERRUPT_REASON_NONE)
+            break;
           reason = static_cast<DownloadInterruptReason>(
               stream_reader_->GetStatus());
           SendUpdate();
@@ -257,6 +261,12 @@ void DownloadFileImpl::StreamActive() {
            reason == DOWNLOAD_INTERRUPT_REASON_NONE &&
            now - start <= delta);
 
+  // Don't leave data behind when yielding or waiting for more.
+  if (reason == DOWNLOAD_INTERRUPT_REASON_NONE)
+    reason = FlushWriteBuffer();
+  else
+    write_buffer_.clear();
+
   // If we're stopping to yield the thread, post a task so we come back.
   if (state == ByteStreamReader::STREAM_HAS_DATA &&
       now - start > delta) {
@@ -305,6 +315,39 @@ void DownloadFileImpl::StreamActive() {
   }
 }
 
+DownloadInterruptReason DownloadFileImpl::BufferDataForFile(
+    const char* data, size_t data_len) {
+  if (write_buffer_.size() + data_len > kMaxWriteBufferSize) {
+    DownloadInterruptReason reason = FlushWriteBuffer();
+    if (reason != DOWNLOAD_INTERRUPT_REASON_NONE)
+      return reason;
+  }
+
+  if (data_len >= kMaxWriteBufferSize) {
+    base::TimeTicks write_start(base::TimeTicks::Now());
+    DownloadInterruptReason reason = AppendDataToFile(data, data_len);
+    disk_writes_time_ += (base::TimeTicks::Now() - write_start);
+    return reason;
+  }
+
+  if (write_buffer_.capacity() < kMaxWriteBufferSize)
+    write_buffer_.reserve(kMaxWriteBufferSize);
+  write_buffer_.append(data, data_len);
+  return DOWNLOAD_INTERRUPT_REASON_NONE;
+}
+
+DownloadInterruptReason DownloadFileImpl::FlushWriteBuffer() {
+  if (write_buffer_.empty())
+    return DOWNLOAD_INTERRUPT_REASON_NONE;
+
+  base::TimeTicks write_start(base::TimeTicks::Now());
+  DownloadInterruptReason reason =
+      AppendDataToFile(write_buffer_.data(), write_buffer_.size());
+  disk_writes_time_ += (base::TimeTicks::Now() - write_start);
+  write_buffer_.clear();
+  return reason;
+}
+
 void DownloadFileImpl::SendUpdate() {
   BrowserThread::PostTask(
       BrowserThread::UI, FROM_HERE,
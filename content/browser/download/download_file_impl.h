@@ -78,6 +78,13 @@ class CONTENT_EXPORT DownloadFileImpl : virtual public DownloadFile {
   // handled.
   void StreamActive();
 
+  // Queues |data| for writing, flushing |write_buffer_| first if |data|
+  // would overflow it.  Buffers too large to coalesce are written directly.
+  DownloadInterruptReason BufferDataForFile(const char* data, size_t data_len);
+
+  // Writes out and empties |write_buffer_|.
+  DownloadInterruptReason FlushWriteBuffer();
+
   // The base file instance.
   BaseFile file_;
 
@@ -90,6 +97,12 @@ class CONTENT_EXPORT DownloadFileImpl : virtual public DownloadFile {
   // with DownloadFile and get rid of BaseFile.
   scoped_ptr<ByteStreamReader> stream_reader_;
 
+  // Small buffers read from |stream_reader_| are gathered here so that they
+  // reach the disk (and the hash) in fewer, larger writes.  Always empty
+  // between calls to StreamActive(), so file_ is up to date whenever anyone
+  // else looks at it.
+  std::string write_buffer_;
+
   // Used to trigger progress updates.
   scoped_ptr<base::RepeatingTimer<DownloadFileImpl> > update_timer_;
 
@@ -131,13 +131,12 @@ void IndexedDBCursor::CursorPrefetchIterationOperation(
       case indexed_db::CURSOR_KEY_ONLY:
         found_values.push_back(std::string());
         break;
-      case indexed_db::CURSOR_KEY_AND_VALUE: {
-        std::string value;
-        value.swap(*cursor_->value());
-        size_estimate += value.size();
-        found_values.push_back(value);
+      case indexed_db::CURSOR_KEY_AND_VALUE:
+        // Swap the value in to avoid copying it.
+        found_values.push_back(std::string());
+        found_values.back().swap(*cursor_->value());
+        size_estimate += found_values.back().size();
         break;
-      }
       default:
         NOTREACHED();
     }
@@ -154,7 +153,7 @@ void IndexedDBCursor::CursorPrefetchIterationOperation(
   }
 
   callbacks->OnSuccessWithPrefetch(
-      found_keys, found_primary_keys, found_values);
+      found_keys, found_primary_keys, &found_values);
 }
 
 void IndexedDBCursor::PrefetchReset(int used_prefetches,
@@ -37,14 +37,16 @@ void LevelDBTransaction::Set(const StringPiece& key,
                              std::string* value,
                              bool deleted) {
   DCHECK(!finished_);
-  DataType::iterator it = data_.find(key);
+  // A single lookup serves both the overwrite and the insert case; bulk loads
+  // mostly append keys in order, so the hint makes the insert cheap.
+  DataType::iterator it = data_.lower_bound(key);
 
-  if (it == data_.end()) {
+  if (it == data_.end() || data_comparator_(key, it->first)) {
     Record* record = new Record();
     record->key.assign(key.begin(), key.end() - key.begin());
     record->value.swap(*value);
     record->deleted = deleted;
-    data_[record->key] = record;
+    data_.insert(it, DataType::value_type(record->key, record));
     NotifyIterators();
     return;
   }
@@ -67,8 +69,7 @@ leveldb::Status LevelDBTransaction::Get(const StringPiece& key,
                                         bool* found) {
   *found = false;
   DCHECK(!finished_);
-  std::string string_key(key.begin(), key.end() - key.begin());
-  DataType::const_iterator it = data_.find(string_key);
+  DataType::const_iterator it = data_.find(key);
 
   if (it != data_.end()) {
     if (it->second->deleted)
@@ -242,6 +242,75 @@ TEST(LevelDBDatabaseTest, TransactionCommitTest) {
   EXPECT_EQ(value3, got_value);
 }
 
+TEST(LevelDBDatabaseTest, TransactionWritesVisibleBeforeCommit) {
+  base::ScopedTempDir temp_directory;
+  ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
+
+  const std::string key1("key1");
+  const std::string key2("key2");
+  const std::string key3("key3");
+  const std::string value1("value1");
+  const std::string value2("value2");
+  const std::string value3("value3");
+
+  std::string put_value;
+  std::string got_value;
+  SimpleComparator comparator;
+  bool found;
+
+  scoped_ptr<LevelDBDatabase> leveldb;
+  LevelDBDatabase::Open(temp_directory.path(), &comparator, &leveldb);
+  EXPECT_TRUE(leveldb);
+
+  scoped_refptr<LevelDBTransaction> transaction =
+      new LevelDBTransaction(leveldb.get());
+
+  // Insert out of order so that both ends of the buffered data are hit.
+  put_value = value2;
+  transaction->Put(key2, &put_value);
+  put_value = value1;
+  transaction->Put(key1, &put_value);
+
+  scoped_ptr<LevelDBIterator> it = transaction->CreateIterator();
+  it->Seek(key1);
+  EXPECT_TRUE(it->IsValid());
+  EXPECT_EQ(comparator.Compare(it->Key(), key1), 0);
+
+  // A key added while the iterator is live must still be visited.
+  put_value = value3;
+  transaction->Put(key3, &put_value);
+  transaction->Remove(key2);
+
+  it->Next();
+  EXPECT_TRUE(it->IsValid());
+  EXPECT_EQ(comparator.Compare(it->Key(), key3), 0);
+  EXPECT_EQ(comparator.Compare(it->Value(), value3), 0);
+  it->Next();
+  EXPECT_FALSE(it->IsValid());
+  it.reset();
+
+  leveldb::Status status = transaction->Get(key2, &got_value, &found);
+  EXPECT_TRUE(status.ok());
+  EXPECT_FALSE(found);
+
+  status = transaction->Get(key1, &got_value, &found);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(found);
+  EXPECT_EQ(value1, got_value);
+
+  status = transaction->Commit();
+  EXPECT_TRUE(status.ok());
+
+  status = leveldb->Get(key2, &got_value, &found);
+  EXPECT_TRUE(status.ok());
+  EXPECT_FALSE(found);
+
+  status = leveldb->Get(key3, &got_value, &found);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(found);
+  EXPECT_EQ(value3, got_value);
+}
+
 TEST(LevelDB, Locking) {
   base::ScopedTempDir temp_directory;
   ASSERT_TRUE(temp_directory.CreateUniqueTempDir());
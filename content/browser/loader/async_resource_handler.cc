@@ -40,6 +40,10 @@ static int kBufferSize = 1024 * 512;
 static int kMinAllocationSize = 1024 * 4;
 static int kMaxAllocationSize = 1024 * 32;
 
+// While the renderer keeps up, allocations grow up to this fraction of the
+// buffer, so that fast loads need fewer ResourceMsg_DataReceived messages.
+static const int kMaxAdaptiveAllocationDivisor = 4;
+
 void GetNumericArg(const std::string& name, int* result) {
   const std::string& value =
       CommandLine::ForCurrentProcess()->GetSwitchValueASCII(name);
@@ -88,7 +92,9 @@ AsyncResourceHandler::AsyncResourceHandler(
       has_checked_for_sufficient_resources_(false),
       sent_received_response_msg_(false),
       sent_first_data_msg_(false),
-      reported_transfer_size_(0) {
+      reported_transfer_size_(0),
+      data_messages_sent_(0),
+      data_bytes_sent_(0) {
   InitializeResourceBufferConstants();
 }
 
@@ -263,6 +269,7 @@ bool AsyncResourceHandler::OnReadCompleted(int request_id, int bytes_read,
     return false;
 
   buffer_->ShrinkLastAllocation(bytes_read);
+  AdaptAllocationSize(bytes_read);
 
   UMA_HISTOGRAM_CUSTOM_COUNTS(
       "Net.AsyncResourceHandler_SharedIOBuffer_Used",
@@ -290,6 +297,8 @@ bool AsyncResourceHandler::OnReadCompleted(int request_id, int bytes_read,
   filter->Send(new ResourceMsg_DataReceived(
       request_id, data_offset, bytes_read, encoded_data_length));
   ++pending_data_count_;
+  ++data_messages_sent_;
+  data_bytes_sent_ += bytes_read;
   UMA_HISTOGRAM_CUSTOM_COUNTS(
       "Net.AsyncResourceHandler_PendingDataCount",
       pending_data_count_, 0, 100, 100);
@@ -298,6 +307,9 @@ bool AsyncResourceHandler::OnReadCompleted(int request_id, int bytes_read,
     UMA_HISTOGRAM_CUSTOM_COUNTS(
         "Net.AsyncResourceHandler_PendingDataCount_WhenFull",
         pending_data_count_, 0, 100, 100);
+    // The renderer is the bottleneck; go back to small allocations so that
+    // each ACK frees up room for the next read sooner.
+    buffer_->SetMaxAllocationSize(kMaxAllocationSize);
     *defer = did_defer_ = true;
     OnDefer();
   }
@@ -368,6 +380,13 @@ void AsyncResourceHandler::OnResponseCompleted(
   request_complete_data.completion_time = TimeTicks::Now();
   request_complete_data.encoded_data_length =
       request()->GetTotalReceivedBytes();
+
+  if (data_messages_sent_) {
+    UMA_HISTOGRAM_CUSTOM_COUNTS(
+        "Net.AsyncResourceHandler_BytesPerDataReceived",
+        static_cast<int>(data_bytes_sent_ / data_messages_sent_),
+        1, kBufferSize, 50);
+  }
   info->filter()->Send(
       new ResourceMsg_RequestComplete(request_id, request_complete_data));
 }
@@ -390,6 +409,20 @@ bool AsyncResourceHandler::EnsureResourceBufferIsInitialized() {
                              kMaxAllocationSize);
 }
 
+void AsyncResourceHandler::AdaptAllocationSize(int bytes_read) {
+  // Grow only when the read filled its allocation, so the network has more
+  // data ready, and every earlier message has been ACKed, so the renderer is
+  // keeping up.
+  if (bytes_read < allocation_size_ || pending_data_count_)
+    return;
+  int max_size = std::max(kMaxAllocationSize,
+                          kBufferSize / kMaxAdaptiveAllocationDivisor);
+  max_size -= max_size % kMinAllocationSize;
+  int current_size = buffer_->max_allocation_size();
+  if (current_size < max_size)
+    buffer_->SetMaxAllocationSize(std::min(current_size * 2, max_size));
+}
+
 void AsyncResourceHandler::ResumeIfDeferred() {
   if (did_defer_) {
     did_defer_ = false;
@@ -74,6 +74,7 @@ class AsyncResourceHandler : public ResourceHandler,
   void OnDataReceivedACK(int request_id);
 
   bool EnsureResourceBufferIsInitialized();
+  void AdaptAllocationSize(int bytes_read);
   void ResumeIfDeferred();
   void OnDefer();
 
@@ -94,6 +95,10 @@ class AsyncResourceHandler : public ResourceHandler,
 
   int64_t reported_transfer_size_;
 
+  // Totals over the ResourceMsg_DataReceived messages sent for this request.
+  int data_messages_sent_;
+  int64 data_bytes_sent_;
+
   DISALLOW_COPY_AND_ASSIGN(AsyncResourceHandler);
 };
 
@@ -178,4 +178,12 @@ void ResourceBuffer::RecycleLeastRecentlyAllocated() {
   }
 }
 
+void ResourceBuffer::SetMaxAllocationSize(int max_allocation_size) {
+  DCHECK(IsInitialized());
+  DCHECK_EQ(0, max_allocation_size % min_alloc_size_);
+  DCHECK_GE(max_allocation_size, min_alloc_size_);
+  DCHECK_LE(max_allocation_size, buf_size_);
+  max_alloc_size_ = max_allocation_size;
+}
+
 }  // namespace content
@@ -99,6 +99,12 @@ class CONTENT_EXPORT ResourceBuffer
   // above the class for more details about this method.
   void RecycleLeastRecentlyAllocated();
 
+  // Changes the preferred size of allocations returned by Allocate.  Only
+  // later allocations are affected.  |max_allocation_size| must be a multiple
+  // of min_allocation_size and no larger than the buffer.
+  void SetMaxAllocationSize(int max_allocation_size);
+  int max_allocation_size() const { return max_alloc_size_; }
+
  private:
   friend class base::RefCountedThreadSafe<ResourceBuffer>;
   ~ResourceBuffer();
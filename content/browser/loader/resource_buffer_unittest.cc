@@ -134,4 +134,32 @@ TEST(ResourceBufferTest, Full) {
   EXPECT_FALSE(buf->CanAllocate());
 }
 
+TEST(ResourceBufferTest, SetMaxAllocationSize) {
+  scoped_refptr<ResourceBuffer> buf = new ResourceBuffer();
+  EXPECT_TRUE(buf->Initialize(100, 5, 10));
+
+  int size;
+  buf->Allocate(&size);
+  EXPECT_EQ(10, size);
+
+  // Only later allocations see the new size.
+  buf->SetMaxAllocationSize(40);
+  EXPECT_EQ(40, buf->max_allocation_size());
+  buf->Allocate(&size);
+  EXPECT_EQ(40, size);
+  EXPECT_EQ(10, buf->GetLastAllocationOffset());
+
+  buf->SetMaxAllocationSize(5);
+  buf->Allocate(&size);
+  EXPECT_EQ(5, size);
+  EXPECT_EQ(50, buf->GetLastAllocationOffset());
+
+  // Recycling still frees the allocations in order, whatever their size.
+  buf->RecycleLeastRecentlyAllocated();
+  buf->RecycleLeastRecentlyAllocated();
+  buf->RecycleLeastRecentlyAllocated();
+  buf->Allocate(&size);
+  EXPECT_EQ(0, buf->GetLastAllocationOffset());
+}
+
 }  // namespace content
@@ -13,6 +13,7 @@
 #include "ipc/ipc_message_macros.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
 #include "net/base/request_priority.h"
 #include "net/http/http_server_properties.h"
 #include "net/url_request/url_request.h"
@@ -23,6 +24,44 @@ namespace content {
 static const size_t kMaxNumDelayableRequestsPerClient = 10;
 static const size_t kMaxNumDelayableRequestsPerHost = 6;
 
+// Bounds on the per-client limit chosen by DelayableRequestLimiter. The lower
+// bound matches the per-host limit, so a single-host page is never slowed
+// down by the adaptation.
+static const size_t kMinAdaptiveDelayableRequestsPerClient = 6;
+static const size_t kMaxAdaptiveDelayableRequestsPerClient = 16;
+
+// Weight of a new sample in the moving averages, as 1 / N.
+static const int kLoadTimingSampleWeight = 4;
+
+DelayableRequestLimiter::DelayableRequestLimiter()
+    : limit_(kMaxNumDelayableRequestsPerClient),
+      has_samples_(false) {
+}
+
+void DelayableRequestLimiter::AddSample(base::TimeDelta time_to_first_byte,
+                                        base::TimeDelta transfer_time) {
+  if (!has_samples_) {
+    has_samples_ = true;
+    average_time_to_first_byte_ = time_to_first_byte;
+    average_transfer_time_ = transfer_time;
+  } else {
+    average_time_to_first_byte_ +=
+        (time_to_first_byte - average_time_to_first_byte_) /
+        kLoadTimingSampleWeight;
+    average_transfer_time_ +=
+        (transfer_time - average_transfer_time_) / kLoadTimingSampleWeight;
+  }
+
+  // Move one step at a time so that a single outlier can't swing the limit.
+  if (average_time_to_first_byte_ > average_transfer_time_) {
+    if (limit_ < kMaxAdaptiveDelayableRequestsPerClient)
+      ++limit_;
+  } else if (average_transfer_time_ > 2 * average_time_to_first_byte_) {
+    if (limit_ > kMinAdaptiveDelayableRequestsPerClient)
+      --limit_;
+  }
+}
+
 // A thin wrapper around net::PriorityQueue that deals with
 // ScheduledResourceRequests instead of PriorityQueue::Pointers.
 class ResourceScheduler::RequestQueue {
@@ -142,6 +181,12 @@ class ResourceScheduler::ScheduledResourceRequest
   net::URLRequest* url_request() { return request_; }
   const net::URLRequest* url_request() const { return request_; }
 
+  // Set once the response headers of a network load over HTTP/1.x arrive.
+  // The scheduler reads these when the request goes away, at which point
+  // the URLRequest may already be gone.
+  base::TimeDelta time_to_first_byte() const { return time_to_first_byte_; }
+  base::TimeTicks response_start() const { return response_start_; }
+
  private:
   // ResourceMessageDelegate interface:
   virtual bool OnMessageReceived(const IPC::Message& message,
@@ -159,6 +204,24 @@ class ResourceScheduler::ScheduledResourceRequest
     deferred_ = *defer = !ready_;
   }
 
+  virtual void WillProcessResponse(bool* defer) OVERRIDE {
+    // Cached responses and SPDY streams don't compete for connections, so
+    // they say nothing about how many requests the client should run.
+    if (!request_->url().SchemeIsHTTPOrHTTPS() ||
+        request_->was_fetched_via_spdy()) {
+      return;
+    }
+    net::LoadTimingInfo load_timing_info;
+    request_->GetLoadTimingInfo(&load_timing_info);
+    if (load_timing_info.send_start.is_null() ||
+        load_timing_info.receive_headers_end.is_null()) {
+      return;
+    }
+    time_to_first_byte_ =
+        load_timing_info.receive_headers_end - load_timing_info.send_start;
+    response_start_ = base::TimeTicks::Now();
+  }
+
   virtual const char* GetNameForLogging() const OVERRIDE {
     return "ResourceScheduler";
   }
@@ -172,6 +235,8 @@ class ResourceScheduler::ScheduledResourceRequest
   bool ready_;
   bool deferred_;
   ResourceScheduler* scheduler_;
+  base::TimeDelta time_to_first_byte_;
+  base::TimeTicks response_start_;
 
   DISALLOW_COPY_AND_ASSIGN(ScheduledResourceRequest);
 };
@@ -183,6 +248,7 @@ struct ResourceScheduler::Client {
 
   bool has_body;
   bool using_spdy_proxy;
+  DelayableRequestLimiter delayable_request_limiter;
   RequestQueue pending_requests;
   RequestSet in_flight_requests;
 };
@@ -245,6 +311,12 @@ void ResourceScheduler::RemoveRequest(ScheduledResourceRequest* request) {
     size_t erased = client->in_flight_requests.erase(request);
     DCHECK(erased);
 
+    if (!request->response_start().is_null()) {
+      client->delayable_request_limiter.AddSample(
+          request->time_to_first_byte(),
+          base::TimeTicks::Now() - request->response_start());
+    }
+
     // Removing this request may have freed up another to load.
     LoadAnyStartablePendingRequests(client);
   }
@@ -454,7 +526,8 @@ void ResourceScheduler::GetNumDelayableRequestsInFlight(
 //   * If no high priority requests are in flight, start loading low priority
 //     requests.
 //   * Once the renderer has a <body>, start loading delayable requests.
-//   * Never exceed 10 delayable requests in flight per client.
+//   * Never exceed the client's delayable request limit. It starts at 10 and
+//     is adjusted between 6 and 16 by DelayableRequestLimiter.
 //   * Never exceed 6 delayable requests for a given host.
 //   * Prior to <body>, allow one delayable request to load at a time.
 ResourceScheduler::ShouldStartReqResult ResourceScheduler::ShouldStartRequest(
@@ -496,7 +569,8 @@ ResourceScheduler::ShouldStartReqResult ResourceScheduler::ShouldStartRequest(
                                   &num_delayable_requests_in_flight,
                                   &num_requests_in_flight_for_host);
 
-  if (num_delayable_requests_in_flight >= kMaxNumDelayableRequestsPerClient) {
+  if (num_delayable_requests_in_flight >=
+      client->delayable_request_limiter.limit()) {
     return DO_NOT_START_REQUEST_AND_STOP_SEARCHING;
   }
 
@@ -12,6 +12,7 @@
 #include "base/compiler_specific.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time/time.h"
 #include "content/common/content_export.h"
 #include "net/base/priority_queue.h"
 #include "net/base/request_priority.h"
@@ -24,6 +25,31 @@ class URLRequest;
 namespace content {
 class ResourceThrottle;
 
+// Chooses how many delayable requests a client may have in flight, based on
+// how its completed loads split their time between waiting for the response
+// headers and reading the body.
+//
+// Loads that mostly wait on the round trip leave the link idle, so more of
+// them can run side by side. Loads that mostly transfer bytes are already
+// sharing the available bandwidth, and adding more only delays each of them,
+// including the ones that matter for first paint.
+class CONTENT_EXPORT DelayableRequestLimiter {
+ public:
+  DelayableRequestLimiter();
+
+  // Feeds the timing of a completed load into the estimate.
+  void AddSample(base::TimeDelta time_to_first_byte,
+                 base::TimeDelta transfer_time);
+
+  size_t limit() const { return limit_; }
+
+ private:
+  size_t limit_;
+  bool has_samples_;
+  base::TimeDelta average_time_to_first_byte_;
+  base::TimeDelta average_transfer_time_;
+};
+
 // There is one ResourceScheduler. All renderer-initiated HTTP requests are
 // expected to pass through it.
 //
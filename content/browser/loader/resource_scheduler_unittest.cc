@@ -478,6 +478,57 @@ TEST_F(ResourceSchedulerTest, SpdyProxySchedulesImmediately) {
   EXPECT_TRUE(after->started());
 }
 
+TEST(DelayableRequestLimiterTest, StartsAtDefaultLimit) {
+  DelayableRequestLimiter limiter;
+  EXPECT_EQ(10u, limiter.limit());
+}
+
+TEST(DelayableRequestLimiterTest, LatencyBoundLoadsRaiseLimit) {
+  DelayableRequestLimiter limiter;
+  for (int i = 0; i < 3; ++i) {
+    limiter.AddSample(base::TimeDelta::FromMilliseconds(300),
+                      base::TimeDelta::FromMilliseconds(20));
+  }
+  EXPECT_EQ(13u, limiter.limit());
+
+  // The limit is capped no matter how long the round trips get.
+  for (int i = 0; i < 20; ++i) {
+    limiter.AddSample(base::TimeDelta::FromMilliseconds(300),
+                      base::TimeDelta::FromMilliseconds(20));
+  }
+  EXPECT_EQ(16u, limiter.limit());
+}
+
+TEST(DelayableRequestLimiterTest, BandwidthBoundLoadsLowerLimit) {
+  DelayableRequestLimiter limiter;
+  for (int i = 0; i < 20; ++i) {
+    limiter.AddSample(base::TimeDelta::FromMilliseconds(20),
+                      base::TimeDelta::FromMilliseconds(500));
+  }
+  // Never below the per-host limit.
+  EXPECT_EQ(6u, limiter.limit());
+}
+
+TEST(DelayableRequestLimiterTest, BalancedLoadsKeepLimit) {
+  DelayableRequestLimiter limiter;
+  for (int i = 0; i < 20; ++i) {
+    limiter.AddSample(base::TimeDelta::FromMilliseconds(100),
+                      base::TimeDelta::FromMilliseconds(150));
+  }
+  EXPECT_EQ(10u, limiter.limit());
+}
+
+TEST(DelayableRequestLimiterTest, SingleOutlierMovesLimitOneStep) {
+  DelayableRequestLimiter limiter;
+  for (int i = 0; i < 10; ++i) {
+    limiter.AddSample(base::TimeDelta::FromMilliseconds(100),
+                      base::TimeDelta::FromMilliseconds(150));
+  }
+  limiter.AddSample(base::TimeDelta::FromSeconds(2),
+                    base::TimeDelta::FromMilliseconds(150));
+  EXPECT_EQ(11u, limiter.limit());
+}
+
 }  // unnamed namespace
 
 }  // namespace content
@@ -54,6 +54,7 @@ class FileElementReader : public net::UploadFileElementReader {
                                      element.expected_modification_time()),
         resource_request_body_(resource_request_body) {
     DCHECK_EQ(ResourceRequestBody::Element::TYPE_FILE, element.type());
+    set_read_ahead_size(kDefaultReadAheadSize);
   }
 
   virtual ~FileElementReader() {}
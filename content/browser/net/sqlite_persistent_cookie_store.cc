@@ -218,6 +218,12 @@ class SQLitePersistentCookieStore::Backend
   sql::MetaTable meta_table_;
 
   typedef std::list<PendingOperation*> PendingOperationsList;
+
+  // Drops operations from |ops| that a later operation on the same cookie
+  // makes redundant: an access time update followed by another update or a
+  // delete, and an add that is deleted again before it is committed.
+  static void CoalesceOperations(PendingOperationsList* ops);
+
   PendingOperationsList pending_;
   PendingOperationsList::size_type num_pending_;
   // True if the persistent store should skip delete on exit rules.
@@ -572,6 +578,10 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
 
   db_.reset(new sql::Connection);
   db_->set_histogram_tag("Cookie");
+  // Commits only append to the write-ahead log, which is checkpointed back
+  // into the database once it has grown, instead of syncing the database
+  // and a rollback journal for every batch.
+  db_->set_wal_mode();
 
   // Unretained to avoid a ref loop with |db_|.
   db_->set_error_callback(
@@ -890,7 +900,8 @@ bool SQLitePersistentCookieStore::Backend::EnsureDatabaseVersion() {
 
     meta_table_.Reset();
     db_.reset(new sql::Connection);
-    if (!base::DeleteFile(path_, false) ||
+    db_->set_wal_mode();
+    if (!sql::Connection::Delete(path_) ||
         !db_->Open(path_) ||
         !meta_table_.Init(
             db_.get(), kCurrentVersionNumber, kCompatibleVersionNumber)) {
@@ -966,6 +977,13 @@ void SQLitePersistentCookieStore::Backend::Commit() {
   if (!db_.get() || ops.empty())
     return;
 
+  PendingOperationsList::size_type num_queued = ops.size();
+  CoalesceOperations(&ops);
+  UMA_HISTOGRAM_COUNTS_10000("Cookie.CommitOperationsQueued", num_queued);
+  UMA_HISTOGRAM_COUNTS_10000("Cookie.CommitOperationsWritten", ops.size());
+  if (ops.empty())
+    return;
+
   sql::Statement add_smt(db_->GetCachedStatement(SQL_FROM_HERE,
       "INSERT INTO cookies (creation_utc, host_key, name, value, "
       "encrypted_value, path, expires_utc, secure, httponly, last_access_utc, "
@@ -1053,6 +1071,67 @@ void SQLitePersistentCookieStore::Backend::Commit() {
                             succeeded ? 0 : 1, 2);
 }
 
+// static
+void SQLitePersistentCookieStore::Backend::CoalesceOperations(
+    PendingOperationsList* ops) {
+  // The add and access time update still pending for each cookie, keyed by
+  // creation time, which is unique per cookie and is what the statements
+  // match on.
+  typedef std::map<int64, std::pair<PendingOperationsList::iterator,
+                                    PendingOperationsList::iterator> >
+      CookieOperationsMap;
+  CookieOperationsMap pending;
+
+  PendingOperationsList::iterator it = ops->begin();
+  while (it != ops->end()) {
+    int64 key = (*it)->cc().CreationDate().ToInternalValue();
+    CookieOperationsMap::iterator found = pending.find(key);
+    if (found == pending.end()) {
+      found = pending.insert(std::make_pair(
+          key, std::make_pair(ops->end(), ops->end()))).first;
+    }
+    PendingOperationsList::iterator& add = found->second.first;
+    PendingOperationsList::iterator& update = found->second.second;
+
+    PendingOperationsList::iterator current = it++;
+    switch ((*current)->op()) {
+      case PendingOperation::COOKIE_ADD:
+        add = current;
+        update = ops->end();
+        break;
+
+      case PendingOperation::COOKIE_UPDATEACCESS:
+        // Only the most recent access time needs to be written.
+        if (update != ops->end()) {
+          delete *update;
+          ops->erase(update);
+        }
+        update = current;
+        break;
+
+      case PendingOperation::COOKIE_DELETE:
+        if (update != ops->end()) {
+          delete *update;
+          ops->erase(update);
+        }
+        if (add != ops->end()) {
+          // The cookie never reaches the database.  Dropping both operations
+          // leaves |cookies_per_origin_| unchanged, as running them would.
+          delete *add;
+          ops->erase(add);
+          delete *current;
+          ops->erase(current);
+        }
+        pending.erase(found);
+        break;
+
+      default:
+        NOTREACHED();
+        break;
+    }
+  }
+}
+
 void SQLitePersistentCookieStore::Backend::Flush(
     const base::Closure& callback) {
   DCHECK(!background_task_runner_->RunsTasksOnCurrentThread());
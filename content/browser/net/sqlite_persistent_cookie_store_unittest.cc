@@ -336,11 +336,15 @@ TEST_F(SQLitePersistentCookieStoreTest, TestLoadCookiesForKey) {
 TEST_F(SQLitePersistentCookieStoreTest, TestFlush) {
   InitializeStore(false, false);
   // File timestamps don't work well on all platforms, so we'll determine
-  // whether the DB file has been modified by checking its size.
+  // whether the DB file has been modified by checking its size.  Commits go
+  // to the write-ahead log until it is checkpointed, so count it as well.
   base::FilePath path = temp_dir_.path().Append(kCookieFilename);
-  base::File::Info info;
-  ASSERT_TRUE(base::GetFileInfo(path, &info));
-  int64 base_size = info.size;
+  base::FilePath wal_path(path.value() + FILE_PATH_LITERAL("-wal"));
+  int64 base_size = 0;
+  ASSERT_TRUE(base::GetFileSize(path, &base_size));
+  int64 wal_size = 0;
+  if (base::GetFileSize(wal_path, &wal_size))
+    base_size += wal_size;
 
   // Write some large cookies, so the DB will have to expand by several KB.
   for (char c = 'a'; c < 'z'; ++c) {
@@ -353,9 +357,63 @@ TEST_F(SQLitePersistentCookieStoreTest, TestFlush) {
 
   Flush();
 
-  // We forced a write, so now the file will be bigger.
-  ASSERT_TRUE(base::GetFileInfo(path, &info));
-  ASSERT_GT(info.size, base_size);
+  // We forced a write, so now the files will be bigger.
+  int64 size = 0;
+  ASSERT_TRUE(base::GetFileSize(path, &size));
+  wal_size = 0;
+  if (base::GetFileSize(wal_path, &wal_size))
+    size += wal_size;
+  ASSERT_GT(size, base_size);
+}
+
+// Test that operations batched into one commit are coalesced without
+// changing what ends up in the database.
+TEST_F(SQLitePersistentCookieStoreTest, TestCoalescedOperations) {
+  InitializeStore(false, false);
+  base::Time t = base::Time::Now();
+  base::Time later = t + base::TimeDelta::FromSeconds(10);
+  AddCookie("A", "B", "foo.bar", "/", t);
+  AddCookie("C", "D", "foo.bar", "/", t + base::TimeDelta::FromMicroseconds(1));
+  store_->UpdateCookieAccessTime(
+      net::CanonicalCookie(GURL(), "A", "B", "foo.bar", "/", t, t,
+                           t + base::TimeDelta::FromSeconds(5), false, false,
+                           net::COOKIE_PRIORITY_DEFAULT));
+  store_->UpdateCookieAccessTime(
+      net::CanonicalCookie(GURL(), "A", "B", "foo.bar", "/", t, t, later,
+                           false, false, net::COOKIE_PRIORITY_DEFAULT));
+  // "C" is added and deleted again before the batch is committed.
+  store_->DeleteCookie(
+      net::CanonicalCookie(GURL(), "C", "D", "foo.bar", "/",
+                           t + base::TimeDelta::FromMicroseconds(1), t, t,
+                           false, false, net::COOKIE_PRIORITY_DEFAULT));
+  DestroyStore();
+
+  CanonicalCookieVector cookies;
+  CreateAndLoad(false, false, &cookies);
+  ASSERT_EQ(1U, cookies.size());
+  EXPECT_EQ("A", cookies[0]->Name());
+  EXPECT_EQ(later, cookies[0]->LastAccessDate());
+
+  // Deleting the remaining cookie after an update leaves nothing behind.
+  store_->UpdateCookieAccessTime(*cookies[0]);
+  store_->DeleteCookie(*cookies[0]);
+  DestroyStore();
+  STLDeleteElements(&cookies);
+  CreateAndLoad(false, false, &cookies);
+  EXPECT_EQ(0U, cookies.size());
+}
+
+// Test that the database is kept in write-ahead log mode.
+TEST_F(SQLitePersistentCookieStoreTest, UsesWriteAheadLog) {
+  InitializeStore(false, false);
+  AddCookie("A", "B", "foo.bar", "/", base::Time::Now());
+  DestroyStore();
+
+  sql::Connection db;
+  ASSERT_TRUE(db.Open(temp_dir_.path().Append(kCookieFilename)));
+  sql::Statement smt(db.GetUniqueStatement("PRAGMA journal_mode"));
+  ASSERT_TRUE(smt.Step());
+  EXPECT_EQ("wal", smt.ColumnString(0));
 }
 
 // Test loading old session cookies from the disk.
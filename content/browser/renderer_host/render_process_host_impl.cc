@@ -23,6 +23,7 @@
 #include "base/debug/trace_event.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram.h"
 #include "base/path_service.h"
@@ -229,6 +230,42 @@ base::LazyInstance<IDMap<RenderProcessHost> >::Leaky
 base::LazyInstance<scoped_refptr<BrowserPluginGeolocationPermissionContext> >
     g_browser_plugin_geolocation_context = LAZY_INSTANCE_INITIALIZER;
 
+// A renderer process launched ahead of need with
+// --enable-spare-renderer-process.  It has no views until
+// RenderProcessHostImpl::TakeSpareRenderProcessHost() hands it out.
+RenderProcessHostImpl* g_spare_render_process_host = NULL;
+
+// Drops the spare when the system runs low on memory.  Only exists while
+// there is a spare.
+base::MemoryPressureListener* g_spare_memory_pressure_listener = NULL;
+
+void OnMemoryPressureWithSpare(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  RenderProcessHostImpl::DiscardSpareRenderProcessHost();
+}
+
+// Forgets the spare and returns it.
+RenderProcessHostImpl* ReleaseSpareRenderProcessHost() {
+  RenderProcessHostImpl* spare = g_spare_render_process_host;
+  g_spare_render_process_host = NULL;
+  delete g_spare_memory_pressure_listener;
+  g_spare_memory_pressure_listener = NULL;
+  return spare;
+}
+
+// Returns true if any host other than the spare belongs to |browser_context|.
+bool HasNonSpareHostForBrowserContext(BrowserContext* browser_context) {
+  for (IDMap<RenderProcessHost>::iterator iter(g_all_hosts.Pointer());
+       !iter.IsAtEnd(); iter.Advance()) {
+    RenderProcessHost* host = iter.GetCurrentValue();
+    if (host != g_spare_render_process_host &&
+        host->GetBrowserContext() == browser_context) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Map of site to process, to ensure we only have one RenderProcessHost per
 // site in process-per-site mode.  Each map is specific to a BrowserContext.
 class SiteProcessMap : public base::SupportsUserData::Data {
@@ -451,6 +488,7 @@ RenderProcessHostImpl::~RenderProcessHostImpl() {
   DCHECK(is_self_deleted_)
       << "RenderProcessHostImpl is destroyed by something other than itself";
 #endif
+  DCHECK_NE(this, g_spare_render_process_host);
 
   // Make sure to clean up the in-process renderer before the channel, otherwise
   // it may still run and have its IPCs fail, causing asserts.
@@ -1102,11 +1140,13 @@ void RenderProcessHostImpl::PropagateBrowserCommandLineToRenderer(
     cc::switches::kEnableGPURasterization,
     cc::switches::kEnableImplSidePainting,
     cc::switches::kEnableLCDText,
+    cc::switches::kEnableMainThreadLatencyRecovery,
     cc::switches::kEnableMapImage,
     cc::switches::kEnablePinchVirtualViewport,
     cc::switches::kEnableTopControlsPositionCalculation,
     cc::switches::kMaxTilesForInterestArea,
     cc::switches::kMaxUnusedResourceMemoryUsagePercentage,
+    cc::switches::kRasterOnDemandBudgetMs,
     cc::switches::kShowCompositedLayerBorders,
     cc::switches::kShowFPSCounter,
     cc::switches::kShowLayerAnimationBounds,
@@ -1478,6 +1518,18 @@ void RenderProcessHostImpl::Cleanup() {
     // Remove ourself from the list of renderer processes so that we can't be
     // reused in between now and when the Delete task runs.
     UnregisterHost(GetID());
+
+    // Don't let the spare keep a BrowserContext alive once everything else
+    // using it is gone; embedders wait for all of a context's hosts to go
+    // away before destroying it.
+    if (this == g_spare_render_process_host) {
+      ReleaseSpareRenderProcessHost();
+    } else if (g_spare_render_process_host &&
+               g_spare_render_process_host->GetBrowserContext() ==
+                   GetBrowserContext() &&
+               !HasNonSpareHostForBrowserContext(GetBrowserContext())) {
+      DiscardSpareRenderProcessHost();
+    }
   }
 }
 
@@ -1635,6 +1687,10 @@ bool RenderProcessHostImpl::IsSuitableHost(
   if (host->GetBrowserContext() != browser_context)
     return false;
 
+  // The spare is only handed out through TakeSpareRenderProcessHost().
+  if (host == g_spare_render_process_host)
+    return false;
+
   // Do not allow sharing of guest hosts. This is to prevent bugs where guest
   // and non-guest storage gets mixed. In the future, we might consider enabling
   // the sharing of guests, in this case this check should be removed and
@@ -1719,7 +1775,10 @@ bool RenderProcessHost::ShouldTryToUseExistingProcessHost(
   //       a renderer process for a browser context that has no existing
   //       renderers. This is OK in moderation, since the
   //       GetMaxRendererProcessCount() is conservative.
-  if (g_all_hosts.Get().size() >= GetMaxRendererProcessCount())
+  size_t host_count = g_all_hosts.Get().size();
+  if (g_spare_render_process_host)
+    --host_count;
+  if (host_count >= GetMaxRendererProcessCount())
     return true;
 
   return GetContentClient()->browser()->
@@ -1878,10 +1937,95 @@ void RenderProcessHostImpl::ProcessDied(bool already_dead) {
   if (delayed_cleanup_needed_)
     Cleanup();
 
+  // A spare that died is of no use to anyone.
+  if (this == g_spare_render_process_host)
+    DiscardSpareRenderProcessHost();
+
   // This object is not deleted at this point and might be reused later.
   // TODO(darin): clean this up
 }
 
+// static
+RenderProcessHost* RenderProcessHostImpl::TakeSpareRenderProcessHost(
+    BrowserContext* browser_context,
+    StoragePartition* storage_partition,
+    bool supports_browser_plugin,
+    bool is_guest) {
+  if (!CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableSpareRendererProcess)) {
+    return NULL;
+  }
+
+  RenderProcessHostImpl* spare = g_spare_render_process_host;
+  bool usable = spare &&
+      !is_guest &&
+      spare->GetBrowserContext() == browser_context &&
+      spare->InSameStoragePartition(storage_partition) &&
+      spare->supports_browser_plugin_ == supports_browser_plugin &&
+      spare->HasConnection();
+  UMA_HISTOGRAM_BOOLEAN("BrowserRenderProcessHost.SpareProcessUsed", usable);
+  if (!usable)
+    return NULL;
+
+  // The taken spare launched as a spare, so get its replacement going here.
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&RenderProcessHostImpl::StartSpareRenderProcessHost,
+                 spare->GetID()));
+  return ReleaseSpareRenderProcessHost();
+}
+
+// static
+void RenderProcessHostImpl::StartSpareRenderProcessHost(
+    int render_process_id) {
+  RenderProcessHostImpl* host = static_cast<RenderProcessHostImpl*>(
+      RenderProcessHost::FromID(render_process_id));
+  if (!host || host->deleting_soon_ || host->is_guest_)
+    return;
+
+  // Replace a spare that can't stand in for |host|; the most recent launch is
+  // the best guess at what the next one will need.
+  if (g_spare_render_process_host) {
+    if (g_spare_render_process_host->GetBrowserContext() ==
+            host->GetBrowserContext() &&
+        g_spare_render_process_host->InSameStoragePartition(
+            host->GetStoragePartition()) &&
+        g_spare_render_process_host->supports_browser_plugin_ ==
+            host->supports_browser_plugin_) {
+      return;
+    }
+    DiscardSpareRenderProcessHost();
+  }
+
+  // The spare is not worth pushing other renderers into sharing processes.
+  if (run_renderer_in_process() ||
+      g_all_hosts.Get().size() + 1 > GetMaxRendererProcessCount()) {
+    return;
+  }
+
+  RenderProcessHostImpl* spare = new RenderProcessHostImpl(
+      host->GetBrowserContext(),
+      host->storage_partition_impl_,
+      host->supports_browser_plugin_,
+      false);
+  if (!spare->Init()) {
+    spare->Cleanup();
+    return;
+  }
+  g_spare_render_process_host = spare;
+  g_spare_memory_pressure_listener = new base::MemoryPressureListener(
+      base::Bind(&OnMemoryPressureWithSpare));
+}
+
+// static
+void RenderProcessHostImpl::DiscardSpareRenderProcessHost() {
+  RenderProcessHostImpl* spare = ReleaseSpareRenderProcessHost();
+
+  // The spare has no views, so this shuts it down.
+  if (spare && !spare->deleting_soon_)
+    spare->Cleanup();
+}
+
 int RenderProcessHostImpl::GetActiveViewCount() {
   int num_active_views = 0;
   scoped_ptr<RenderWidgetHostIterator> widgets(
@@ -2006,6 +2150,17 @@ void RenderProcessHostImpl::OnProcessLaunched() {
     queued_messages_.pop();
   }
 
+  // Now that this process is up, get the next one ready.  Posted so that the
+  // launch doesn't delay anything queued behind this notification.
+  if (this != g_spare_render_process_host &&
+      CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableSpareRendererProcess)) {
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&RenderProcessHostImpl::StartSpareRenderProcessHost,
+                   GetID()));
+  }
+
 #if defined(ENABLE_WEBRTC)
   if (WebRTCInternals::GetInstance()->aec_dump_enabled())
     EnableAecDump(WebRTCInternals::GetInstance()->aec_dump_file_path());
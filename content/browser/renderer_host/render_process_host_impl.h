@@ -203,6 +203,21 @@ class CONTENT_EXPORT RenderProcessHostImpl
       RenderProcessHost* process,
       const GURL& url);
 
+  // Returns the spare renderer process, which has already been launched, if
+  // it can host a new view in |browser_context| and |storage_partition|.  The
+  // caller takes the place of the spare's owner and a new spare is launched
+  // later.  Returns NULL if there's no suitable spare; a new
+  // RenderProcessHost should be created instead.  The spare is only kept
+  // with --enable-spare-renderer-process.
+  static RenderProcessHost* TakeSpareRenderProcessHost(
+      BrowserContext* browser_context,
+      StoragePartition* storage_partition,
+      bool supports_browser_plugin,
+      bool is_guest);
+
+  // Shuts down the spare renderer process, if any.
+  static void DiscardSpareRenderProcessHost();
+
   static base::MessageLoop* GetInProcessRendererThreadForTesting();
 
   // This forces a renderer that is running "in process" to shut down.
@@ -273,6 +288,10 @@ class CONTENT_EXPORT RenderProcessHostImpl
   // Callers can reduce the RenderProcess' priority.
   void SetBackgrounded(bool backgrounded);
 
+  // Launches a spare renderer process like the one of the host with
+  // |render_process_id|, if there isn't one already and there's room for it.
+  static void StartSpareRenderProcessHost(int render_process_id);
+
   // Handle termination of our process.
   void ProcessDied(bool already_dead);
 
@@ -120,6 +120,46 @@ int GetInputRouterViewFlagsFromCompositorFrameMetadata(
   return view_flags;
 }
 
+// How many of the latest input events have their type remembered, for the
+// latency breakdown recorded when their rendering reaches the screen.
+const size_t kMaxLatencyInputTypes = 100;
+
+// Returns the name the latency breakdown of input events of |type| is
+// recorded under.
+const char* GetLatencyInputKind(WebInputEvent::Type type,
+                                bool is_scroll_update) {
+  // In Aura, scroll updates carry the latency of the touch they come from.
+  if (is_scroll_update)
+    return "ScrollUpdate";
+  if (type == WebInputEvent::MouseWheel)
+    return "MouseWheel";
+  if (WebInputEvent::isMouseEventType(type))
+    return "Mouse";
+  if (WebInputEvent::isKeyboardEventType(type))
+    return "Key";
+  if (WebInputEvent::isTouchEventType(type))
+    return "Touch";
+  if (WebInputEvent::isGestureEventType(type))
+    return "Gesture";
+  return "Other";
+}
+
+// Records |delta| for the |stage| of the latency of |input_kind| events, both
+// to UMA, where benchmarks read it with getBrowserHistogram(), and as a trace
+// counter.
+void RecordInputLatencyStage(const char* input_kind,
+                             const char* stage,
+                             base::TimeDelta delta) {
+  if (delta < base::TimeDelta())
+    return;
+  std::string name =
+      std::string("Event.Latency.") + input_kind + "." + stage;
+  base::HistogramBase* histogram = base::Histogram::FactoryGet(
+      name, 1, 1000000, 100, base::HistogramBase::kUmaTargetedHistogramFlag);
+  histogram->Add(delta.InMicroseconds());
+  TRACE_COPY_COUNTER1("benchmark", name.c_str(), delta.InMicroseconds());
+}
+
 // Implements the RenderWidgetHostIterator interface. It keeps a list of
 // RenderWidgetHosts, and makes sure it returns a live RenderWidgetHost at each
 // iteration (or NULL if there isn't any left).
@@ -1133,6 +1173,11 @@ ui::LatencyInfo RenderWidgetHostImpl::CreateRWHLatencyInfoIfNotExist(
                           GetLatencyComponentId(),
                           ++last_input_number_);
     info.TraceEventType(WebInputEventTraits::GetName(type));
+
+    // Most input never causes a swap, so only remember the latest events.
+    latency_input_types_[last_input_number_] = type;
+    if (latency_input_types_.size() > kMaxLatencyInputTypes)
+      latency_input_types_.erase(latency_input_types_.begin());
   }
   return info;
 }
@@ -2385,6 +2430,69 @@ void RenderWidgetHostImpl::ComputeTouchLatency(
   }
 }
 
+void RenderWidgetHostImpl::ComputeInputLatencyBreakdown(
+    const ui::LatencyInfo& latency_info,
+    const ui::LatencyInfo::LatencyComponent& rwh_component,
+    const ui::LatencyInfo::LatencyComponent& swap_component) {
+  std::map<int64, WebInputEvent::Type>::iterator type_it =
+      latency_input_types_.find(rwh_component.sequence_number);
+  if (type_it == latency_input_types_.end())
+    return;
+  WebInputEvent::Type type = type_it->second;
+  latency_input_types_.erase(type_it);
+
+  const char* input_kind = GetLatencyInputKind(
+      type,
+      latency_info.FindLatency(
+          ui::INPUT_EVENT_LATENCY_SCROLL_UPDATE_RWH_COMPONENT,
+          GetLatencyComponentId(),
+          NULL));
+  base::TimeTicks start_time = rwh_component.event_time;
+
+  // OS: from the platform timestamp to the browser creating its ui::Event.
+  // Browser: from there to RenderWidgetHost sending the event to the renderer.
+  ui::LatencyInfo::LatencyComponent original_component;
+  ui::LatencyInfo::LatencyComponent ui_component;
+  bool has_original = latency_info.FindLatency(
+      ui::INPUT_EVENT_LATENCY_ORIGINAL_COMPONENT, 0, &original_component);
+  bool has_ui = latency_info.FindLatency(
+      ui::INPUT_EVENT_LATENCY_UI_COMPONENT, 0, &ui_component);
+  if (has_original && has_ui) {
+    RecordInputLatencyStage(input_kind, "OS",
+                            ui_component.event_time -
+                                original_component.event_time);
+  }
+  if (has_ui) {
+    RecordInputLatencyStage(input_kind, "Browser",
+                            rwh_component.event_time - ui_component.event_time);
+    start_time = ui_component.event_time;
+  } else if (has_original) {
+    RecordInputLatencyStage(input_kind, "Browser",
+                            rwh_component.event_time -
+                                original_component.event_time);
+  }
+  if (has_original)
+    start_time = original_component.event_time;
+
+  // Renderer: from the renderer receiving the event to it scheduling the
+  // rendering the event caused. GPU: from there to the frame swap.
+  ui::LatencyInfo::LatencyComponent scheduled_component;
+  if (latency_info.FindLatency(
+          ui::INPUT_EVENT_LATENCY_RENDERING_SCHEDULED_COMPONENT,
+          0,
+          &scheduled_component)) {
+    RecordInputLatencyStage(input_kind, "Renderer",
+                            scheduled_component.event_time -
+                                rwh_component.event_time);
+    RecordInputLatencyStage(input_kind, "GpuSwap",
+                            swap_component.event_time -
+                                scheduled_component.event_time);
+  }
+
+  RecordInputLatencyStage(input_kind, "Total",
+                          swap_component.event_time - start_time);
+}
+
 void RenderWidgetHostImpl::FrameSwapped(const ui::LatencyInfo& latency_info) {
   ui::LatencyInfo::LatencyComponent window_snapshot_component;
   if (latency_info.FindLatency(ui::WINDOW_SNAPSHOT_FRAME_NUMBER_COMPONENT,
@@ -2405,6 +2513,8 @@ void RenderWidgetHostImpl::FrameSwapped(const ui::LatencyInfo& latency_info) {
     return;
   }
 
+  ComputeInputLatencyBreakdown(latency_info, rwh_component, swap_component);
+
   ui::LatencyInfo::LatencyComponent original_component;
   if (latency_info.FindLatency(
           ui::INPUT_EVENT_LATENCY_SCROLL_UPDATE_ORIGINAL_COMPONENT,
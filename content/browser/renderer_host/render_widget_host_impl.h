@@ -532,6 +532,12 @@ class CONTENT_EXPORT RenderWidgetHostImpl : virtual public RenderWidgetHost,
   bool should_auto_resize() { return should_auto_resize_; }
 
   void ComputeTouchLatency(const ui::LatencyInfo& latency_info);
+  // Records how long each stage of the pipeline took for an input event whose
+  // rendering reached the screen at |swap_component|.
+  void ComputeInputLatencyBreakdown(
+      const ui::LatencyInfo& latency_info,
+      const ui::LatencyInfo::LatencyComponent& rwh_component,
+      const ui::LatencyInfo::LatencyComponent& swap_component);
   void FrameSwapped(const ui::LatencyInfo& latency_info);
   void DidReceiveRendererFrame();
 
@@ -933,6 +939,11 @@ class CONTENT_EXPORT RenderWidgetHostImpl : virtual public RenderWidgetHost,
 
   int64 last_input_number_;
 
+  // The types of the input events given an
+  // INPUT_EVENT_LATENCY_BEGIN_RWH_COMPONENT, by its sequence number, until
+  // their rendering reaches the screen.
+  std::map<int64, blink::WebInputEvent::Type> latency_input_types_;
+
   DISALLOW_COPY_AND_ASSIGN(RenderWidgetHostImpl);
 };
 
@@ -4,6 +4,7 @@
 
 #include "content/browser/service_worker/service_worker_version.h"
 
+#include "base/metrics/histogram.h"
 #include "base/stl_util.h"
 #include "content/browser/service_worker/embedded_worker_instance.h"
 #include "content/browser/service_worker/embedded_worker_registry.h"
@@ -135,6 +136,7 @@ void ServiceWorkerVersion::StartWorker(const StatusCallback& callback) {
       RunSoon(base::Bind(callback, status));
       return;
     }
+    start_time_ = base::TimeTicks::Now();
   }
   start_callbacks_.push_back(callback);
 }
@@ -227,6 +229,12 @@ void ServiceWorkerVersion::RemoveProcessToWorker(int process_id) {
 
 void ServiceWorkerVersion::OnStarted() {
   DCHECK_EQ(RUNNING, status());
+  if (!start_time_.is_null()) {
+    UMA_HISTOGRAM_TIMES("ServiceWorker.StartWorker.Time",
+                        base::TimeTicks::Now() - start_time_);
+    start_time_ = base::TimeTicks();
+  }
+
   // Fire all start callbacks.
   RunCallbacks(start_callbacks_, SERVICE_WORKER_OK);
   start_callbacks_.clear();
@@ -234,6 +242,9 @@ void ServiceWorkerVersion::OnStarted() {
 
 void ServiceWorkerVersion::OnStopped() {
   DCHECK_EQ(STOPPED, status());
+  // A start that was pending has failed; don't count it as a start time.
+  start_time_ = base::TimeTicks();
+
   // Fire all stop callbacks.
   RunCallbacks(stop_callbacks_, SERVICE_WORKER_OK);
   stop_callbacks_.clear();
@@ -13,6 +13,7 @@
 #include "base/id_map.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
 #include "content/browser/service_worker/embedded_worker_instance.h"
 #include "content/common/content_export.h"
 #include "content/common/service_worker/service_worker_status_code.h"
@@ -159,6 +160,9 @@ class CONTENT_EXPORT ServiceWorkerVersion
   std::vector<StatusCallback> start_callbacks_;
   std::vector<StatusCallback> stop_callbacks_;
 
+  // When the pending start was requested, for measuring start latency.
+  base::TimeTicks start_time_;
+
   IDMap<MessageCallback, IDMapOwnPointer> message_callbacks_;
 
   base::WeakPtrFactory<ServiceWorkerVersion> weak_factory_;
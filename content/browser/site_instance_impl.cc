@@ -106,10 +106,19 @@ RenderProcessHost* SiteInstanceImpl::GetProcess() {
                 BrowserContext::GetStoragePartition(browser_context, this));
         bool supports_browser_plugin = GetContentClient()->browser()->
             SupportsBrowserPlugin(browser_context, site_);
-        process_ = new RenderProcessHostImpl(browser_context,
-                                             partition,
-                                             supports_browser_plugin,
-                                             site_.SchemeIs(kGuestScheme));
+        bool is_guest = site_.SchemeIs(kGuestScheme);
+        // Process-per-site processes may be set up specially at launch for
+        // their site, which a spare launched ahead of time can't be.
+        if (!use_process_per_site) {
+          process_ = RenderProcessHostImpl::TakeSpareRenderProcessHost(
+              browser_context, partition, supports_browser_plugin, is_guest);
+        }
+        if (!process_) {
+          process_ = new RenderProcessHostImpl(browser_context,
+                                               partition,
+                                               supports_browser_plugin,
+                                               is_guest);
+        }
       }
     }
     CHECK(process_);
@@ -6,6 +6,7 @@
 
 #include "base/bind.h"
 #include "base/location.h"
+#include "base/debug/trace_event.h"
 #include "base/message_loop/message_loop.h"
 
 namespace content {
@@ -13,7 +14,9 @@ namespace content {
 StartupTaskRunner::StartupTaskRunner(
     base::Callback<void(int)> const startup_complete_callback,
     scoped_refptr<base::SingleThreadTaskRunner> proxy)
-    : startup_complete_callback_(startup_complete_callback), proxy_(proxy) {}
+    : startup_complete_callback_(startup_complete_callback),
+      proxy_(proxy),
+      tasks_run_(0) {}
 
 StartupTaskRunner::~StartupTaskRunner() {}
 
@@ -39,13 +42,16 @@ void StartupTaskRunner::StartRunningTasksAsync() {
 
 void StartupTaskRunner::RunAllTasksNow() {
   int result = 0;
+  bool ran_tasks = !task_list_.empty();
   for (std::list<StartupTask>::iterator it = task_list_.begin();
        it != task_list_.end();
        it++) {
-    result = it->Run();
+    result = RunTask(*it);
     if (result > 0) break;
   }
   task_list_.clear();
+  if (ran_tasks)
+    EndStartupTrace(result);
   if (!startup_complete_callback_.is_null()) {
     startup_complete_callback_.Run(result);
     // Clear the callback to prevent it being called a second time
@@ -60,13 +66,14 @@ void StartupTaskRunner::WrappedTask() {
     // so there is nothing to do
     return;
   }
-  int result = task_list_.front().Run();
+  int result = RunTask(task_list_.front());
   task_list_.pop_front();
   if (result > 0) {
     // Stop now and throw away the remaining tasks
     task_list_.clear();
   }
   if (task_list_.empty()) {
+    EndStartupTrace(result);
     if (!startup_complete_callback_.is_null()) {
       startup_complete_callback_.Run(result);
       // Clear the callback to prevent it being called a second time
@@ -79,4 +86,17 @@ void StartupTaskRunner::WrappedTask() {
   }
 }
 
+int StartupTaskRunner::RunTask(const StartupTask& task) {
+  if (tasks_run_ == 0)
+    TRACE_EVENT_ASYNC_BEGIN0("startup", "StartupTaskRunner", this);
+  TRACE_EVENT1("startup", "StartupTaskRunner::RunTask", "index", tasks_run_);
+  ++tasks_run_;
+  return task.Run();
+}
+
+void StartupTaskRunner::EndStartupTrace(int result) {
+  TRACE_EVENT_ASYNC_END2("startup", "StartupTaskRunner", this,
+                         "tasks_run", tasks_run_, "result", result);
+}
+
 }  // namespace content
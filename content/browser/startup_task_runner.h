@@ -30,6 +30,10 @@ typedef base::Callback<int(void)> StartupTask;
 // Note that this differs from a SingleThreadedTaskRunner in that there may be
 // no opportunity to handle UI events between the tasks of a
 // SingleThreadedTaskRunner.
+//
+// Each task is recorded as a "startup" trace event, and the whole run as an
+// async "StartupTaskRunner" event, so the gaps between tasks (time spent on UI
+// events when running asynchronously) show up on the startup critical path.
 
 class CONTENT_EXPORT StartupTaskRunner {
 
@@ -55,9 +59,13 @@ class CONTENT_EXPORT StartupTaskRunner {
 
   std::list<StartupTask> task_list_;
   void WrappedTask();
+  int RunTask(const StartupTask& task);
+  void EndStartupTrace(int result);
 
   base::Callback<void(int)> startup_complete_callback_;
   scoped_refptr<base::SingleThreadTaskRunner> proxy_;
+  // Number of tasks run so far, used to label the trace events.
+  int tasks_run_;
 
   DISALLOW_COPY_AND_ASSIGN(StartupTaskRunner);
 };
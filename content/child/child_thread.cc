@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/allocator/allocator_extension.h"
+#include "base/allocator/sampling_heap_profiler.h"
 #include "base/base_switches.h"
 #include "base/basictypes.h"
 #include "base/command_line.h"
@@ -50,6 +51,7 @@
 
 #if defined(TCMALLOC_TRACE_MEMORY_SUPPORTED)
 #include "third_party/tcmalloc/chromium/src/gperftools/heap-profiler.h"
+#include "third_party/tcmalloc/chromium/src/gperftools/malloc_hook_c.h"
 #endif
 
 using tracked_objects::ThreadData;
@@ -57,6 +59,22 @@ using tracked_objects::ThreadData;
 namespace content {
 namespace {
 
+#if defined(TCMALLOC_TRACE_MEMORY_SUPPORTED)
+void AddSamplingHeapProfilerHooks(
+    base::allocator::SamplingHeapProfiler::AllocHook alloc_hook,
+    base::allocator::SamplingHeapProfiler::FreeHook free_hook) {
+  MallocHook_AddNewHook(alloc_hook);
+  MallocHook_AddDeleteHook(free_hook);
+}
+
+void RemoveSamplingHeapProfilerHooks(
+    base::allocator::SamplingHeapProfiler::AllocHook alloc_hook,
+    base::allocator::SamplingHeapProfiler::FreeHook free_hook) {
+  MallocHook_RemoveNewHook(alloc_hook);
+  MallocHook_RemoveDeleteHook(free_hook);
+}
+#endif
+
 // How long to wait for a connection to the browser process before giving up.
 const int kConnectionTimeoutS = 15;
 
@@ -297,6 +315,11 @@ void ChildThread::Init() {
       ::HeapProfilerWithPseudoStackStart,
       ::HeapProfilerStop,
       ::GetHeapProfile));
+  sampling_heap_profiler_controller_.reset(
+      new base::allocator::SamplingHeapProfilerController(
+          message_loop_->message_loop_proxy(),
+          &AddSamplingHeapProfilerHooks,
+          &RemoveSamplingHeapProfilerHooks));
 #endif
 }
 
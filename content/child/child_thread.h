@@ -21,6 +21,10 @@
 namespace base {
 class MessageLoop;
 
+namespace allocator {
+class SamplingHeapProfilerController;
+}  // namespace allocator
+
 namespace debug {
 class TraceMemoryController;
 }  // namespace debug
@@ -225,6 +229,11 @@ class CONTENT_EXPORT ChildThread : public IPC::Listener, public IPC::Sender {
   // starts profiling the tcmalloc heap.
   scoped_ptr<base::debug::TraceMemoryController> trace_memory_controller_;
 
+  // Samples heap allocations while the "memory.sampled" trace category is
+  // enabled.
+  scoped_ptr<base::allocator::SamplingHeapProfilerController>
+      sampling_heap_profiler_controller_;
+
   scoped_ptr<base::PowerMonitor> power_monitor_;
 
   bool in_browser_process_;
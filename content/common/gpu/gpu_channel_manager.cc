@@ -11,6 +11,7 @@
 #include "content/common/gpu/gpu_memory_manager.h"
 #include "content/common/gpu/gpu_messages.h"
 #include "content/common/gpu/sync_point_manager.h"
+#include "gpu/command_buffer/service/disk_program_cache.h"
 #include "gpu/command_buffer/service/feature_info.h"
 #include "gpu/command_buffer/service/gpu_switches.h"
 #include "gpu/command_buffer/service/mailbox_manager.h"
@@ -62,7 +63,14 @@ gpu::gles2::ProgramCache* GpuChannelManager::program_cache() {
        gfx::g_driver_gl.ext.b_GL_OES_get_program_binary) &&
       !CommandLine::ForCurrentProcess()->HasSwitch(
           switches::kDisableGpuProgramCache)) {
-    program_cache_.reset(new gpu::gles2::MemoryProgramCache());
+    const CommandLine* command_line = CommandLine::ForCurrentProcess();
+    base::FilePath cache_dir =
+        command_line->GetSwitchValuePath(switches::kGpuProgramCacheDir);
+    if (!cache_dir.empty() &&
+        !command_line->HasSwitch(switches::kDisableGpuShaderDiskCache))
+      program_cache_.reset(new gpu::gles2::DiskProgramCache(cache_dir));
+    else
+      program_cache_.reset(new gpu::gles2::MemoryProgramCache());
   }
   return program_cache_.get();
 }
@@ -100,6 +100,11 @@ const int64 kHandleMoreWorkPeriodBusyMs = 1;
 // Prevents idle work from being starved.
 const int64 kMaxTimeSinceIdleMs = 10;
 
+// Offscreen contexts, such as WebGL and canvas, process their commands in
+// slices of this length so that an onscreen context, such as the browser
+// compositor, never waits on them for long. Onscreen contexts aren't limited.
+const int64 kOffscreenTimeSliceMs = 2;
+
 }  // namespace
 
 GpuCommandBufferStub::GpuCommandBufferStub(
@@ -413,6 +418,10 @@ void GpuCommandBufferStub::OnInitialize(
                                          decoder_.get()));
   if (preemption_flag_.get())
     scheduler_->SetPreemptByFlag(preemption_flag_);
+  if (handle_.is_null()) {
+    scheduler_->SetTimeSlice(
+        base::TimeDelta::FromMilliseconds(kOffscreenTimeSliceMs));
+  }
 
   decoder_->set_engine(scheduler_.get());
 
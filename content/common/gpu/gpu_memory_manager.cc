@@ -19,6 +19,7 @@
 #include "content/common/gpu/gpu_messages.h"
 #include "gpu/command_buffer/common/gpu_memory_allocation.h"
 #include "gpu/command_buffer/service/gpu_switches.h"
+#include "gpu/command_buffer/service/program_cache.h"
 
 using gpu::ManagedMemoryStats;
 using gpu::MemoryAllocation;
@@ -30,6 +31,10 @@ const int kDelayedScheduleManageTimeoutMs = 67;
 
 const uint64 kBytesAllocatedUnmanagedStep = 16 * 1024 * 1024;
 
+// Allocations that would take the total usage past this multiple of the
+// available GPU memory are refused.
+const uint64 kHardLimitAvailableGpuMemoryFactor = 2;
+
 void TrackValueChanged(uint64 old_size, uint64 new_size, uint64* total_size) {
   DCHECK(new_size > old_size || *total_size >= (old_size - new_size));
   *total_size += (new_size - old_size);
@@ -65,6 +70,7 @@ GpuMemoryManager::GpuMemoryManager(
       bytes_allocated_unmanaged_high_(0),
       bytes_allocated_unmanaged_low_(0),
       bytes_unmanaged_limit_step_(kBytesAllocatedUnmanagedStep),
+      memory_pressure_(false),
       disable_schedule_manage_(false)
 {
   CommandLine* command_line = CommandLine::ForCurrentProcess();
@@ -136,6 +142,10 @@ uint64 GpuMemoryManager::GetMaximumTotalGpuMemory() const {
 #endif
 }
 
+uint64 GpuMemoryManager::GetHardLimitGpuMemory() const {
+  return kHardLimitAvailableGpuMemoryFactor * bytes_available_gpu_memory_;
+}
+
 uint64 GpuMemoryManager::GetMaximumClientAllocation() const {
 #if defined(OS_ANDROID) || defined(OS_CHROMEOS)
   return bytes_available_gpu_memory_;
@@ -269,6 +279,8 @@ void GpuMemoryManager::TrackMemoryAllocatedChange(
     ScheduleManage(kScheduleManageNow);
   if (bytes_allocated_unmanaged_current_ < bytes_allocated_unmanaged_low_)
     ScheduleManage(kScheduleManageLater);
+  if (memory_pressure_ && GetCurrentUsage() <= bytes_available_gpu_memory_)
+    ScheduleManage(kScheduleManageLater);
 
   if (GetCurrentUsage() > bytes_allocated_historical_max_) {
       bytes_allocated_historical_max_ = GetCurrentUsage();
@@ -278,9 +290,29 @@ void GpuMemoryManager::TrackMemoryAllocatedChange(
   }
 }
 
-bool GpuMemoryManager::EnsureGPUMemoryAvailable(uint64 /* size_needed */) {
-  // TODO: Check if there is enough space. Lose contexts until there is.
-  return true;
+bool GpuMemoryManager::EnsureGPUMemoryAvailable(uint64 size_needed) {
+  // Refuse allocations past the hard limit, so that a single context can't
+  // exhaust the memory of the GPU process, and have the other clients free
+  // what they can.
+  if (GetCurrentUsage() + size_needed <= GetHardLimitGpuMemory())
+    return true;
+  if (!memory_pressure_)
+    OnMemoryPressure();
+  return false;
+}
+
+void GpuMemoryManager::OnMemoryPressure() {
+  TRACE_EVENT0("gpu", "GpuMemoryManager::OnMemoryPressure");
+  memory_pressure_ = true;
+
+  // Cached program binaries are not referenced by any context, and are
+  // recreated when the programs are linked again.
+  if (channel_manager_ && channel_manager_->program_cache())
+    channel_manager_->program_cache()->Clear();
+
+  // Limit the visible clients to their required memory, and take the
+  // frontbuffers of the nonvisible ones.
+  ScheduleManage(kScheduleManageNow);
 }
 
 GpuMemoryManagerClientState* GpuMemoryManager::CreateClientState(
@@ -398,6 +430,11 @@ void GpuMemoryManager::Manage() {
   // Update the limit on unmanaged memory.
   UpdateUnmanagedMemoryLimits();
 
+  // Give the clients their memory back once the usage is within the
+  // available memory again.
+  if (memory_pressure_ && GetCurrentUsage() <= bytes_available_gpu_memory_)
+    memory_pressure_ = false;
+
   // Determine which clients are "hibernated" (which determines the
   // distribution of frontbuffers and memory among clients that don't have
   // surfaces).
@@ -671,7 +708,9 @@ void GpuMemoryManager::AssignSurfacesAllocations() {
 
     allocation.bytes_limit_when_visible =
         client_state->bytes_allocation_when_visible_;
-    allocation.priority_cutoff_when_visible = priority_cutoff_;
+    allocation.priority_cutoff_when_visible =
+        memory_pressure_ ? MemoryAllocation::CUTOFF_ALLOW_REQUIRED_ONLY
+                         : priority_cutoff_;
 
     client_state->client_->SetMemoryAllocation(allocation);
     client_state->client_->SuggestHaveFrontBuffer(!client_state->hibernated_);
@@ -706,6 +745,8 @@ void GpuMemoryManager::SetClientsHibernatedState() const {
   }
   // All clients with surfaces that are visible are non-hibernated.
   uint64 non_hibernated_clients = 0;
+  uint64 non_hibernated_clients_limit =
+      memory_pressure_ ? 0 : max_surfaces_with_frontbuffer_soft_limit_;
   for (ClientStateList::const_iterator it = clients_visible_mru_.begin();
        it != clients_visible_mru_.end();
        ++it) {
@@ -720,7 +761,7 @@ void GpuMemoryManager::SetClientsHibernatedState() const {
        it != clients_nonvisible_mru_.end();
        ++it) {
     GpuMemoryManagerClientState* client_state = *it;
-    if (non_hibernated_clients < max_surfaces_with_frontbuffer_soft_limit_) {
+    if (non_hibernated_clients < non_hibernated_clients_limit) {
       client_state->hibernated_ = false;
       client_state->tracking_group_->hibernated_ = false;
       non_hibernated_clients++;
@@ -101,6 +101,8 @@ class CONTENT_EXPORT GpuMemoryManager :
                            UnmanagedTracking);
   FRIEND_TEST_ALL_PREFIXES(GpuMemoryManagerTest,
                            DefaultAllocation);
+  FRIEND_TEST_ALL_PREFIXES(GpuMemoryManagerTest,
+                           MemoryPressure);
 
   typedef std::map<gpu::gles2::MemoryTracker*, GpuMemoryTrackingGroup*>
       TrackingGroupMap;
@@ -145,6 +147,9 @@ class CONTENT_EXPORT GpuMemoryManager :
   // Maximum cap on total GPU memory, no matter how much the GPU reports.
   uint64 GetMaximumTotalGpuMemory() const;
 
+  // Allocations are refused past this total usage.
+  uint64 GetHardLimitGpuMemory() const;
+
   // The maximum and minimum amount of memory that a client may be assigned.
   uint64 GetMaximumClientAllocation() const;
   uint64 GetMinimumClientAllocation() const {
@@ -176,6 +181,11 @@ class CONTENT_EXPORT GpuMemoryManager :
   void OnDestroyTrackingGroup(GpuMemoryTrackingGroup* tracking_group);
   bool EnsureGPUMemoryAvailable(uint64 size_needed);
 
+  // Called when an allocation was refused for going past the hard limit.
+  // Drops the caches of the GPU process, and has all clients drop their
+  // nice-to-have memory until the usage is back within the available memory.
+  void OnMemoryPressure();
+
   // GpuMemoryManagerClientState interface
   void SetClientStateVisible(
       GpuMemoryManagerClientState* client_state, bool visible);
@@ -251,6 +261,10 @@ class CONTENT_EXPORT GpuMemoryManager :
   // Update bytes_allocated_unmanaged_low/high_ in intervals of step_.
   uint64 bytes_unmanaged_limit_step_;
 
+  // Set when an allocation went past the hard limit, until the usage is back
+  // within the available memory.
+  bool memory_pressure_;
+
   // Used to disable automatic changes to Manage() in testing.
   bool disable_schedule_manage_;
 
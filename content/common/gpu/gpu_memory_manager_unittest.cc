@@ -609,4 +609,55 @@ TEST_F(GpuMemoryManagerTest, DefaultAllocation) {
             memmgr_.GetDefaultClientAllocation());
 }
 
+// Test that allocations past the hard limit are refused, and that the clients
+// drop down to their required memory until the usage is back within the
+// available memory.
+TEST_F(GpuMemoryManagerTest, MemoryPressure) {
+  // Set memory manager constants for this test
+  memmgr_.TestingSetAvailableGpuMemory(64);
+  memmgr_.TestingSetMinimumClientAllocation(8);
+
+  FakeClient stub1(&memmgr_, GenerateUniqueSurfaceId(), true),
+             stub2(&memmgr_, GenerateUniqueSurfaceId(), false);
+
+  Manage();
+  EXPECT_EQ(memmgr_.priority_cutoff_,
+            stub1.allocation_.priority_cutoff_when_visible);
+  EXPECT_TRUE(stub2.suggest_have_frontbuffer_);
+
+  // Allocations within the hard limit are allowed, even past the available
+  // memory.
+  EXPECT_TRUE(memmgr_.EnsureGPUMemoryAvailable(96));
+  memmgr_.TrackMemoryAllocatedChange(
+      stub1.tracking_group_.get(),
+      0,
+      96,
+      gpu::gles2::MemoryTracker::kUnmanaged);
+  EXPECT_FALSE(memmgr_.EnsureGPUMemoryAvailable(64));
+  Manage();
+  EXPECT_EQ(MemoryAllocation::CUTOFF_ALLOW_REQUIRED_ONLY,
+            stub1.allocation_.priority_cutoff_when_visible);
+  EXPECT_FALSE(stub2.suggest_have_frontbuffer_);
+
+  // Freeing memory until the usage is within the available memory ends the
+  // memory pressure.
+  memmgr_.TrackMemoryAllocatedChange(
+      stub1.tracking_group_.get(),
+      96,
+      80,
+      gpu::gles2::MemoryTracker::kUnmanaged);
+  Manage();
+  EXPECT_EQ(MemoryAllocation::CUTOFF_ALLOW_REQUIRED_ONLY,
+            stub1.allocation_.priority_cutoff_when_visible);
+  memmgr_.TrackMemoryAllocatedChange(
+      stub1.tracking_group_.get(),
+      80,
+      0,
+      gpu::gles2::MemoryTracker::kUnmanaged);
+  Manage();
+  EXPECT_EQ(memmgr_.priority_cutoff_,
+            stub1.allocation_.priority_cutoff_when_visible);
+  EXPECT_TRUE(stub2.suggest_have_frontbuffer_);
+}
+
 }  // namespace content
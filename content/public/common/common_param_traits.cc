@@ -150,19 +150,12 @@ void ParamTraits<content::PageState>::Log(
 }
 
 void ParamTraits<gfx::Point>::Write(Message* m, const gfx::Point& p) {
-  m->WriteInt(p.x());
-  m->WriteInt(p.y());
+  BytewiseParamTraits<gfx::Point, 2 * sizeof(int)>::Write(m, p);
 }
 
 bool ParamTraits<gfx::Point>::Read(const Message* m, PickleIterator* iter,
                                    gfx::Point* r) {
-  int x, y;
-  if (!m->ReadInt(iter, &x) ||
-      !m->ReadInt(iter, &y))
-    return false;
-  r->set_x(x);
-  r->set_y(y);
-  return true;
+  return BytewiseParamTraits<gfx::Point, 2 * sizeof(int)>::Read(m, iter, r);
 }
 
 void ParamTraits<gfx::Point>::Log(const gfx::Point& p, std::string* l) {
@@ -170,20 +163,13 @@ void ParamTraits<gfx::Point>::Log(const gfx::Point& p, std::string* l) {
 }
 
 void ParamTraits<gfx::PointF>::Write(Message* m, const gfx::PointF& v) {
-  ParamTraits<float>::Write(m, v.x());
-  ParamTraits<float>::Write(m, v.y());
+  BytewiseParamTraits<gfx::PointF, 2 * sizeof(float)>::Write(m, v);
 }
 
 bool ParamTraits<gfx::PointF>::Read(const Message* m,
                                       PickleIterator* iter,
                                       gfx::PointF* r) {
-  float x, y;
-  if (!ParamTraits<float>::Read(m, iter, &x) ||
-      !ParamTraits<float>::Read(m, iter, &y))
-    return false;
-  r->set_x(x);
-  r->set_y(y);
-  return true;
+  return BytewiseParamTraits<gfx::PointF, 2 * sizeof(float)>::Read(m, iter, r);
 }
 
 void ParamTraits<gfx::PointF>::Log(const gfx::PointF& v, std::string* l) {
@@ -237,20 +223,13 @@ void ParamTraits<gfx::SizeF>::Log(const gfx::SizeF& p, std::string* l) {
 }
 
 void ParamTraits<gfx::Vector2d>::Write(Message* m, const gfx::Vector2d& p) {
-  int values[2] = { p.x(), p.y() };
-  m->WriteBytes(&values, sizeof(int) * 2);
+  BytewiseParamTraits<gfx::Vector2d, 2 * sizeof(int)>::Write(m, p);
 }
 
 bool ParamTraits<gfx::Vector2d>::Read(const Message* m,
                                       PickleIterator* iter,
                                       gfx::Vector2d* r) {
-  const char* char_values;
-  if (!m->ReadBytes(iter, &char_values, sizeof(int) * 2))
-    return false;
-  const int* values = reinterpret_cast<const int*>(char_values);
-  r->set_x(values[0]);
-  r->set_y(values[1]);
-  return true;
+  return BytewiseParamTraits<gfx::Vector2d, 2 * sizeof(int)>::Read(m, iter, r);
 }
 
 void ParamTraits<gfx::Vector2d>::Log(const gfx::Vector2d& v, std::string* l) {
@@ -258,20 +237,14 @@ void ParamTraits<gfx::Vector2d>::Log(const gfx::Vector2d& v, std::string* l) {
 }
 
 void ParamTraits<gfx::Vector2dF>::Write(Message* m, const gfx::Vector2dF& p) {
-  float values[2] = { p.x(), p.y() };
-  m->WriteBytes(&values, sizeof(float) * 2);
+  BytewiseParamTraits<gfx::Vector2dF, 2 * sizeof(float)>::Write(m, p);
 }
 
 bool ParamTraits<gfx::Vector2dF>::Read(const Message* m,
                                       PickleIterator* iter,
                                       gfx::Vector2dF* r) {
-  const char* char_values;
-  if (!m->ReadBytes(iter, &char_values, sizeof(float) * 2))
-    return false;
-  const float* values = reinterpret_cast<const float*>(char_values);
-  r->set_x(values[0]);
-  r->set_y(values[1]);
-  return true;
+  return BytewiseParamTraits<gfx::Vector2dF, 2 * sizeof(float)>::Read(
+      m, iter, r);
 }
 
 void ParamTraits<gfx::Vector2dF>::Log(const gfx::Vector2dF& v, std::string* l) {
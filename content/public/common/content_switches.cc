@@ -539,6 +539,10 @@ const char kEnableSmoothScrolling[]         = "enable-smooth-scrolling";
 // Allow the compositor to use its software implementation if GL fails.
 const char kEnableSoftwareCompositing[]     = "enable-software-compositing";
 
+// Keeps a spare renderer process launched ahead of need, so that a navigation
+// that needs a new process doesn't wait for one to start.
+const char kEnableSpareRendererProcess[]    = "enable-spare-renderer-process";
+
 // Enable spatial navigation
 const char kEnableSpatialNavigation[]       = "enable-spatial-navigation";
 
@@ -88,6 +88,8 @@ scoped_ptr<RenderWidgetCompositor> RenderWidgetCompositor::Create(
 
   settings.throttle_frame_production =
       !cmd->HasSwitch(switches::kDisableGpuVsync);
+  settings.switch_to_low_latency_if_possible =
+      cmd->HasSwitch(cc::switches::kEnableMainThreadLatencyRecovery);
   settings.begin_impl_frame_scheduling_enabled =
       cmd->HasSwitch(switches::kEnableBeginFrameScheduling);
   settings.using_synchronous_renderer_compositor =
@@ -232,6 +234,15 @@ scoped_ptr<RenderWidgetCompositor> RenderWidgetCompositor::Create(
     }
   }
 
+  if (cmd->HasSwitch(cc::switches::kRasterOnDemandBudgetMs)) {
+    int raster_on_demand_budget_ms;
+    if (GetSwitchValueAsInt(*cmd,
+                            cc::switches::kRasterOnDemandBudgetMs,
+                            0, 1000,
+                            &raster_on_demand_budget_ms))
+      settings.raster_on_demand_budget_ms = raster_on_demand_budget_ms;
+  }
+
   settings.strict_layer_property_change_checking =
       cmd->HasSwitch(cc::switches::kStrictLayerPropertyChangeChecking);
 
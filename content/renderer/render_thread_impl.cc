@@ -1399,6 +1399,9 @@ void RenderThreadImpl::WidgetHidden() {
   hidden_widget_count_++;
 
   if (widget_count_ && hidden_widget_count_ == widget_count_) {
+    // Nothing on screen depends on this thread's timers being precise, so let
+    // them share wakeups.
+    base::MessageLoop::current()->SetTimerSlack(base::TIMER_SLACK_MAXIMUM);
 #if !defined(SYSTEM_NATIVELY_SIGNALS_MEMORY_PRESSURE)
     // TODO(vollick): Remove this this heavy-handed approach once we're polling
     // the real system memory pressure.
@@ -1413,6 +1416,7 @@ void RenderThreadImpl::WidgetHidden() {
 void RenderThreadImpl::WidgetRestored() {
   DCHECK_GT(hidden_widget_count_, 0);
   hidden_widget_count_--;
+  base::MessageLoop::current()->SetTimerSlack(base::TIMER_SLACK_NONE);
 
   if (!GetContentClient()->renderer()->RunIdleHandlerWhenWidgetsHidden()) {
     return;
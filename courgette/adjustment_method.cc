@@ -680,8 +680,25 @@ AdjustmentMethod* AdjustmentMethod::MakeTrieAdjustmentMethod() {
   return new GraphAdjuster();
 }
 
-Status Adjust(const AssemblyProgram& model, AssemblyProgram* program) {
-  AdjustmentMethod* method = AdjustmentMethod::MakeProductionAdjustmentMethod();
+AdjustmentMethod* AdjustmentMethod::MakeAdjustmentMethod(
+    AdjustmentMethodId id) {
+  switch (id) {
+    case ADJUSTMENT_METHOD_NULL:
+      return MakeNullAdjustmentMethod();
+    case ADJUSTMENT_METHOD_TRIE:
+      return MakeTrieAdjustmentMethod();
+    case ADJUSTMENT_METHOD_SHINGLE:
+      return MakeShingleAdjustmentMethod();
+    case ADJUSTMENT_METHOD_FLAT:
+      return MakeFlatAdjustmentMethod();
+  }
+  NOTREACHED();
+  return NULL;
+}
+
+static Status AdjustWith(AdjustmentMethod* method,
+                         const AssemblyProgram& model,
+                         AssemblyProgram* program) {
   bool ok = method->Adjust(model, program);
   method->Destroy();
   if (ok)
@@ -690,4 +707,18 @@ Status Adjust(const AssemblyProgram& model, AssemblyProgram* program) {
     return C_ADJUSTMENT_FAILED;
 }
 
+Status Adjust(const AssemblyProgram& model, AssemblyProgram* program) {
+  return AdjustWith(AdjustmentMethod::MakeProductionAdjustmentMethod(),
+                    model, program);
+}
+
+Status Adjust(const AssemblyProgram& model, AssemblyProgram* program,
+              AdjustmentMethodId method) {
+  AdjustmentMethod* adjustment_method =
+      AdjustmentMethod::MakeAdjustmentMethod(method);
+  if (!adjustment_method)
+    return C_ADJUSTMENT_FAILED;
+  return AdjustWith(adjustment_method, model, program);
+}
+
 }  // namespace courgette
@@ -6,6 +6,7 @@
 #define COURGETTE_ADJUSTMENT_METHOD_H_
 
 #include "base/basictypes.h"
+#include "courgette/courgette.h"
 
 namespace courgette {
 
@@ -29,6 +30,12 @@ class AdjustmentMethod {
   // Returns the new shingle tiling adjustment method.
   static AdjustmentMethod* MakeShingleAdjustmentMethod();
 
+  // Returns the shingle matching adjustment method that uses flat arrays.
+  static AdjustmentMethod* MakeFlatAdjustmentMethod();
+
+  // Returns the adjustment method identified by |id|.
+  static AdjustmentMethod* MakeAdjustmentMethod(AdjustmentMethodId id);
+
   // AdjustmentMethod interface:
 
   // Adjusts |program| to increase similarity to |model|.  |program| can be
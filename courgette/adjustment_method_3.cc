@@ -0,0 +1,388 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/adjustment_method.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "base/time/time.h"
+#include "courgette/assembly_program.h"
+
+/*
+
+Flat shingle matching.
+
+This solves the same problem as the shingle weighting method in
+adjustment_method_2.cc: the labels referenced by the 'program' are to be given
+the indexes of labels referenced by the 'model' so that the two sequences of
+indexes share long runs.  It trades a little of that method's precision for
+speed, using only sorted flat arrays instead of maps and sets of shingles.
+
+Each label reference sequence is rewritten as a trace of dense symbol numbers.
+A shingle is the run of |width| references starting at some position.  The
+shingle is summarized by a hash of its 'shape': a symbol that is already
+matched contributes the model symbol it stands for, and any other symbol
+contributes the distance back to its previous occurrence in the shingle, or
+zero.  Two shingles with the same shape can be made identical by matching their
+unmatched symbols position by position.
+
+One round hashes every shingle of the model and of the program and sorts the
+hashes.  A shape that occurs exactly once in each is good evidence that the two
+shingles line up, and each of its unmatched symbol pairs gets a vote.  Program
+symbols whose best candidate has enough votes, and clearly more than the
+runner-up, are matched, strongest first.
+
+Matching symbols gives more shingles distinct shapes, so rounds are repeated
+until they stop finding matches.  The first rounds use wide shingles, since
+shapes made only of unmatched symbols are rarely unique; later rounds narrow
+the shingles to reach the symbols between the matched ones.  Anything left
+unmatched is handled by AssemblyProgram::AssignRemainingIndexes.
+
+*/
+
+namespace courgette {
+namespace adjustment_method_3 {
+
+static const uint32 kNone = static_cast<uint32>(-1);
+
+// Shingle widths, widest first.  Each width is used for rounds until a round
+// makes no matches.
+static const size_t kWidths[] = { 16, 8, 4, 2 };
+static const size_t kMaxWidth = 16;
+
+// The most rounds made at one width.
+static const int kMaxRoundsPerWidth = 8;
+
+// A program symbol is matched to its best candidate only with at least this
+// many votes, and at least |kMinVoteRatio| times the votes of the runner-up.
+static const uint32 kMinVotes = 2;
+static const uint32 kMinVoteRatio = 2;
+
+typedef std::vector<Label*> LabelTrace;
+
+// The references to one kind of label in the order they appear in a program,
+// with the labels numbered densely.
+class SymbolTrace {
+ public:
+  explicit SymbolTrace(const LabelTrace& references)
+      : symbols_(references) {
+    std::sort(symbols_.begin(), symbols_.end());
+    symbols_.erase(std::unique(symbols_.begin(), symbols_.end()),
+                   symbols_.end());
+
+    trace_.reserve(references.size());
+    for (size_t i = 0;  i < references.size();  ++i) {
+      trace_.push_back(static_cast<uint32>(
+          std::lower_bound(symbols_.begin(), symbols_.end(), references[i]) -
+          symbols_.begin()));
+    }
+
+    std::vector<uint32> last(symbols_.size(), kNone);
+    previous_.resize(trace_.size());
+    for (size_t i = 0;  i < trace_.size();  ++i) {
+      previous_[i] = last[trace_[i]];
+      last[trace_[i]] = static_cast<uint32>(i);
+    }
+
+    names_.resize(symbols_.size(), kNone);
+  }
+
+  size_t length() const { return trace_.size(); }
+  size_t symbol_count() const { return symbols_.size(); }
+  Label* label(uint32 symbol) const { return symbols_[symbol]; }
+  uint32 symbol_at(size_t position) const { return trace_[position]; }
+
+  // The model symbol that |symbol| stands for, or kNone while it is unmatched.
+  uint32 name(uint32 symbol) const { return names_[symbol]; }
+  void set_name(uint32 symbol, uint32 name) { names_[symbol] = name; }
+
+  // Returns the shape of the |offset|th reference of the shingle at |start|.
+  uint64 Shape(size_t start, size_t offset) const {
+    size_t position = start + offset;
+    uint32 name = names_[trace_[position]];
+    if (name != kNone)
+      return kMaxWidth + name;
+    uint32 previous = previous_[position];
+    if (previous == kNone || previous < start)
+      return 0;
+    return position - previous;
+  }
+
+  // Returns a hash of the shape of the shingle of |width| references at
+  // |start|, and sets |*all_named| if every symbol in it is matched.
+  uint64 HashShingle(size_t start, size_t width, bool* all_named) const {
+    uint64 hash = 14695981039346656037ULL;
+    *all_named = true;
+    for (size_t offset = 0;  offset < width;  ++offset) {
+      if (names_[trace_[start + offset]] == kNone)
+        *all_named = false;
+      hash = (hash ^ Shape(start, offset)) * 1099511628211ULL;
+      hash ^= hash >> 29;
+    }
+    return hash;
+  }
+
+ private:
+  LabelTrace symbols_;             // Distinct labels, sorted by address.
+  std::vector<uint32> trace_;      // The symbol of each reference.
+  std::vector<uint32> previous_;   // Previous reference to the same symbol.
+  std::vector<uint32> names_;
+
+  DISALLOW_COPY_AND_ASSIGN(SymbolTrace);
+};
+
+// A shingle hash and the position of the shingle.
+typedef std::pair<uint64, uint32> ShingleHash;
+typedef std::vector<ShingleHash> ShingleHashes;
+
+// A vote for matching a program symbol with a model symbol.
+typedef std::pair<uint32, uint32> Vote;
+typedef std::vector<Vote> Votes;
+
+// A candidate match: the number of votes, and the program and model symbols.
+struct Candidate {
+  Candidate(uint32 votes, uint32 program_symbol, uint32 model_symbol)
+      : votes(votes),
+        program_symbol(program_symbol),
+        model_symbol(model_symbol) {
+  }
+
+  // Orders by decreasing votes, then by symbols so that sorting is
+  // deterministic.
+  bool operator<(const Candidate& other) const {
+    if (votes != other.votes)
+      return votes > other.votes;
+    if (program_symbol != other.program_symbol)
+      return program_symbol < other.program_symbol;
+    return model_symbol < other.model_symbol;
+  }
+
+  uint32 votes;
+  uint32 program_symbol;
+  uint32 model_symbol;
+};
+
+class AssignmentProblem {
+ public:
+  AssignmentProblem(SymbolTrace* model, SymbolTrace* program)
+      : model_(model), program_(program) {
+  }
+
+  void Solve() {
+    for (size_t i = 0;  i < arraysize(kWidths);  ++i) {
+      for (int round = 0;  round < kMaxRoundsPerWidth;  ++round) {
+        size_t matched = Round(kWidths[i]);
+        VLOG(2) << "width " << kWidths[i] << " round " << round
+                << " matched " << matched;
+        if (matched == 0)
+          break;
+      }
+    }
+  }
+
+ private:
+  // Makes one round of matches with shingles of |width| references.  Returns
+  // the number of program symbols matched.
+  size_t Round(size_t width) {
+    ShingleHashes model_hashes;
+    ShingleHashes program_hashes;
+    HashShingles(*model_, width, &model_hashes);
+    HashShingles(*program_, width, &program_hashes);
+
+    Votes votes;
+    ShingleHashes::const_iterator m = model_hashes.begin();
+    ShingleHashes::const_iterator p = program_hashes.begin();
+    while (m != model_hashes.end() && p != program_hashes.end()) {
+      if (m->first < p->first) {
+        m = SkipGroup(m, model_hashes.end());
+      } else if (p->first < m->first) {
+        p = SkipGroup(p, program_hashes.end());
+      } else {
+        ShingleHashes::const_iterator m_end = SkipGroup(m, model_hashes.end());
+        ShingleHashes::const_iterator p_end =
+            SkipGroup(p, program_hashes.end());
+        if (m_end - m == 1 && p_end - p == 1)
+          AddVotes(m->second, p->second, width, &votes);
+        m = m_end;
+        p = p_end;
+      }
+    }
+
+    return Assign(&votes);
+  }
+
+  static void HashShingles(const SymbolTrace& trace, size_t width,
+                           ShingleHashes* hashes) {
+    if (trace.length() < width)
+      return;
+    hashes->reserve(trace.length() - width + 1);
+    for (size_t start = 0;  start + width <= trace.length();  ++start) {
+      bool all_named;
+      uint64 hash = trace.HashShingle(start, width, &all_named);
+      // Matched shingles have nothing left to vote for.
+      if (!all_named)
+        hashes->push_back(ShingleHash(hash, static_cast<uint32>(start)));
+    }
+    std::sort(hashes->begin(), hashes->end());
+  }
+
+  static ShingleHashes::const_iterator SkipGroup(
+      ShingleHashes::const_iterator group,
+      ShingleHashes::const_iterator end) {
+    ShingleHashes::const_iterator next = group;
+    while (next != end && next->first == group->first)
+      ++next;
+    return next;
+  }
+
+  // Votes for matching the unmatched symbols of the program shingle at
+  // |program_start| with those of the model shingle at |model_start|, if the
+  // shingles really have the same shape.
+  void AddVotes(size_t model_start, size_t program_start, size_t width,
+                Votes* votes) {
+    for (size_t offset = 0;  offset < width;  ++offset) {
+      if (model_->Shape(model_start, offset) !=
+          program_->Shape(program_start, offset)) {
+        return;  // Hash collision.
+      }
+    }
+    for (size_t offset = 0;  offset < width;  ++offset) {
+      uint32 program_symbol = program_->symbol_at(program_start + offset);
+      if (program_->name(program_symbol) != kNone)
+        continue;
+      votes->push_back(
+          std::make_pair(program_symbol,
+                         model_->symbol_at(model_start + offset)));
+    }
+  }
+
+  // Matches the program symbols with a clear winner among |votes|, strongest
+  // first.  Returns the number matched.
+  size_t Assign(Votes* votes) {
+    std::sort(votes->begin(), votes->end());
+
+    std::vector<Candidate> candidates;
+    Votes::const_iterator vote = votes->begin();
+    while (vote != votes->end()) {
+      uint32 program_symbol = vote->first;
+      uint32 best_symbol = kNone;
+      uint32 best_votes = 0;
+      uint32 second_votes = 0;
+      while (vote != votes->end() && vote->first == program_symbol) {
+        uint32 model_symbol = vote->second;
+        uint32 count = 0;
+        for (;  vote != votes->end() && *vote == std::make_pair(
+                    program_symbol, model_symbol);  ++vote) {
+          ++count;
+        }
+        if (count > best_votes) {
+          second_votes = best_votes;
+          best_votes = count;
+          best_symbol = model_symbol;
+        } else if (count > second_votes) {
+          second_votes = count;
+        }
+      }
+      // Model symbols taken in this round are checked below.
+      if (best_votes >= kMinVotes &&
+          best_votes >= kMinVoteRatio * second_votes &&
+          model_->name(best_symbol) == kNone) {
+        candidates.push_back(
+            Candidate(best_votes, program_symbol, best_symbol));
+      }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    size_t matched = 0;
+    for (size_t i = 0;  i < candidates.size();  ++i) {
+      const Candidate& candidate = candidates[i];
+      if (model_->name(candidate.model_symbol) != kNone)
+        continue;
+      model_->set_name(candidate.model_symbol, candidate.model_symbol);
+      program_->set_name(candidate.program_symbol, candidate.model_symbol);
+      ++matched;
+    }
+    return matched;
+  }
+
+  SymbolTrace* model_;
+  SymbolTrace* program_;
+
+  DISALLOW_COPY_AND_ASSIGN(AssignmentProblem);
+};
+
+class FlatAdjuster : public AdjustmentMethod {
+ public:
+  FlatAdjuster() {}
+  ~FlatAdjuster() {}
+
+  bool Adjust(const AssemblyProgram& model, AssemblyProgram* program) {
+    VLOG(1) << "FlatAdjuster::Adjust";
+    program->UnassignIndexes();
+
+    LabelTrace model_abs32;
+    LabelTrace model_rel32;
+    LabelTrace program_abs32;
+    LabelTrace program_rel32;
+    CollectTraces(model, &model_abs32, &model_rel32);
+    CollectTraces(*program, &program_abs32, &program_rel32);
+
+    Solve(model_abs32, program_abs32);
+    Solve(model_rel32, program_rel32);
+
+    program->AssignRemainingIndexes();
+    return true;
+  }
+
+ private:
+  static void CollectTraces(const AssemblyProgram& program,
+                            LabelTrace* abs32, LabelTrace* rel32) {
+    const InstructionVector& instructions = program.instructions();
+    for (size_t i = 0;  i < instructions.size();  ++i) {
+      Instruction* instruction = instructions[i];
+      if (Label* label = program.InstructionAbs32Label(instruction))
+        abs32->push_back(label);
+      if (Label* label = program.InstructionRel32Label(instruction))
+        rel32->push_back(label);
+    }
+  }
+
+  // Gives the labels in |program_references| the indexes of the labels in
+  // |model_references| they are matched with.
+  static void Solve(const LabelTrace& model_references,
+                    const LabelTrace& program_references) {
+    base::Time start_time = base::Time::Now();
+    SymbolTrace model(model_references);
+    SymbolTrace program(program_references);
+    AssignmentProblem problem(&model, &program);
+    problem.Solve();
+
+    size_t matched = 0;
+    for (uint32 symbol = 0;  symbol < program.symbol_count();  ++symbol) {
+      uint32 name = program.name(symbol);
+      if (name == kNone)
+        continue;
+      DCHECK_NE(Label::kNoIndex, model.label(name)->index_);
+      program.label(symbol)->index_ = model.label(name)->index_;
+      ++matched;
+    }
+    VLOG(1) << " FlatAdjuster::Solve matched " << matched << " of "
+            << program.symbol_count() << " labels in "
+            << (base::Time::Now() - start_time).InSecondsF() << "s";
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(FlatAdjuster);
+};
+
+}  // namespace adjustment_method_3
+
+AdjustmentMethod* AdjustmentMethod::MakeFlatAdjustmentMethod() {
+  return new adjustment_method_3::FlatAdjuster();
+}
+
+}  // namespace courgette
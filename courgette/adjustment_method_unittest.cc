@@ -15,6 +15,7 @@
 class AdjustmentMethodTest : public testing::Test {
  public:
   void Test1() const;
+  void Test1(courgette::AdjustmentMethodId method) const;
 
  private:
   void SetUp() {
@@ -101,7 +102,30 @@ void AdjustmentMethodTest::Test1() const {
   EXPECT_TRUE(s5 == s6);  // Adjustment did change B into A
 }
 
+void AdjustmentMethodTest::Test1(courgette::AdjustmentMethodId method) const {
+  courgette::AssemblyProgram* prog1 = MakeProgramA();
+  std::string s1 = Serialize(prog1);
+
+  courgette::AssemblyProgram* prog5 = MakeProgramA();
+  courgette::AssemblyProgram* prog6 = MakeProgramB();
+  courgette::Status can_adjust = Adjust(*prog5, prog6, method);
+  EXPECT_EQ(courgette::C_OK, can_adjust);
+  std::string s5 = Serialize(prog5);
+  std::string s6 = Serialize(prog6);
+
+  EXPECT_TRUE(s1 == s5);  // Adjustment did not change A (prog5)
+  EXPECT_TRUE(s5 == s6);  // Adjustment did change B into A
+}
+
 
 TEST_F(AdjustmentMethodTest, All) {
   Test1();
 }
+
+TEST_F(AdjustmentMethodTest, Shingle) {
+  Test1(courgette::ADJUSTMENT_METHOD_SHINGLE);
+}
+
+TEST_F(AdjustmentMethodTest, Flat) {
+  Test1(courgette::ADJUSTMENT_METHOD_FLAT);
+}
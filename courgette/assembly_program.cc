@@ -158,6 +158,10 @@ AssemblyProgram::~AssemblyProgram() {
   DeleteContainedLabels(abs32_labels_);
 }
 
+CheckBool AssemblyProgram::ReserveInstructions(size_t count) {
+  return instructions_.reserve(count);
+}
+
 CheckBool AssemblyProgram::EmitPeRelocsInstruction() {
   return Emit(new(std::nothrow) PeRelocsInstruction());
 }
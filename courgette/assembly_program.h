@@ -69,6 +69,10 @@ class AssemblyProgram {
 
   void set_image_base(uint64 image_base) { image_base_ = image_base; }
 
+  // Allocates room for |count| instructions up front, so a program of about
+  // that size does not repeatedly outgrow and copy its instruction list.
+  CheckBool ReserveInstructions(size_t count) WARN_UNUSED_RESULT;
+
   // Instructions will be assembled in the order they are emitted.
 
   // Generates an entire base relocation table.
@@ -4,14 +4,21 @@
 
 #include "courgette/third_party/bsdiff.h"
 
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/platform_file.h"
 #include "courgette/base_test_unittest.h"
 #include "courgette/courgette.h"
+#include "courgette/crc.h"
 #include "courgette/streams.h"
 
 class BSDiffMemoryTest : public BaseTest {
  public:
   void GenerateAndTestPatch(const std::string& a, const std::string& b) const;
 
+  // Checks that both suffix sorts lead to the same patch from |a| to |b|.
+  void TestSuffixSortsMatch(const std::string& a, const std::string& b) const;
+
   std::string GenerateSyntheticInput(size_t length, int seed) const;
 };
 
@@ -36,6 +43,52 @@ void BSDiffMemoryTest::GenerateAndTestPatch(const std::string& old_text,
   EXPECT_EQ(courgette::OK, status);
   EXPECT_EQ(new_text.length(), new2.Length());
   EXPECT_EQ(0, memcmp(new_text.c_str(), new2.Buffer(), new_text.length()));
+
+  // The same patch applied straight to a file.
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath new_path = temp_dir.path().AppendASCII("new");
+  base::PlatformFile new_file = base::CreatePlatformFile(
+      new_path, base::PLATFORM_FILE_CREATE | base::PLATFORM_FILE_WRITE,
+      NULL, NULL);
+  ASSERT_NE(base::kInvalidPlatformFileValue, new_file);
+
+  courgette::SourceStream old3;
+  courgette::SourceStream patch3;
+  old3.Init(old_text.c_str(), old_text.length());
+  patch3.Init(patch1);
+  uint32 new_crc = 0;
+  status = ApplyBinaryPatchToFile(&old3, &patch3, new_file, &new_crc);
+  EXPECT_TRUE(base::ClosePlatformFile(new_file));
+  EXPECT_EQ(courgette::OK, status);
+
+  std::string new3;
+  EXPECT_TRUE(base::ReadFileToString(new_path, &new3));
+  EXPECT_EQ(new_text, new3);
+  EXPECT_EQ(courgette::CalculateCrc(
+                reinterpret_cast<const uint8*>(new_text.c_str()),
+                new_text.length()),
+            new_crc);
+}
+
+void BSDiffMemoryTest::TestSuffixSortsMatch(
+    const std::string& old_text, const std::string& new_text) const {
+  courgette::SinkStream patches[2];
+  const courgette::SuffixSortAlgorithm algorithms[2] = {
+    courgette::SUFFIX_SORT_QSUFSORT, courgette::SUFFIX_SORT_SAIS
+  };
+  for (int i = 0; i < 2; ++i) {
+    courgette::SourceStream old_stream;
+    courgette::SourceStream new_stream;
+    old_stream.Init(old_text.c_str(), old_text.length());
+    new_stream.Init(new_text.c_str(), new_text.length());
+    EXPECT_EQ(courgette::OK,
+              CreateBinaryPatch(&old_stream, &new_stream, &patches[i],
+                                algorithms[i]));
+  }
+  ASSERT_EQ(patches[0].Length(), patches[1].Length());
+  EXPECT_EQ(0, memcmp(patches[0].Buffer(), patches[1].Buffer(),
+                      patches[0].Length()));
 }
 
 std::string BSDiffMemoryTest::GenerateSyntheticInput(size_t length, int seed)
@@ -123,3 +176,10 @@ TEST_F(BSDiffMemoryTest, TestDifferentElfs) {
   std::string file2 = FileContents("elf-32-2");
   GenerateAndTestPatch(file1, file2);
 }
+
+TEST_F(BSDiffMemoryTest, TestSuffixSortsMatch) {
+  TestSuffixSortsMatch(std::string(), "xxx");
+  TestSuffixSortsMatch(GenerateSyntheticInput(1 << 18, 0),
+                       GenerateSyntheticInput(1 << 18, 1));
+  TestSuffixSortsMatch(FileContents("setup1.exe"), FileContents("setup2.exe"));
+}
@@ -8,6 +8,7 @@
     'courgette_lib_sources': [
       'adjustment_method.cc',
       'adjustment_method_2.cc',
+      'adjustment_method_3.cc',
       'adjustment_method.h',
       'assembly_program.cc',
       'assembly_program.h',
@@ -45,6 +46,8 @@
       'simple_delta.h',
       'streams.cc',
       'streams.h',
+      'suffix_array.cc',
+      'suffix_array.h',
       'types_elf.h',
       'types_win_pe.h',
       'patch_generator_x86_32.h',
@@ -98,6 +101,7 @@
         'bsdiff_memory_unittest.cc',
         'base_test_unittest.cc',
         'base_test_unittest.h',
+        'crc_unittest.cc',
         'difference_estimator_unittest.cc',
         'disassembler_elf_32_x86_unittest.cc',
         'disassembler_win32_x86_unittest.cc',
@@ -106,6 +110,7 @@
         'encode_decode_unittest.cc',
         'ensemble_unittest.cc',
         'streams_unittest.cc',
+        'suffix_array_unittest.cc',
         'typedrva_unittest.cc',
         'versioning_unittest.cc',
         'third_party/paged_array_unittest.cc'
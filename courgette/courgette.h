@@ -61,6 +61,14 @@ enum ExecutableType {
   EXE_WIN_32_X64 = 4,
 };
 
+// The ways Adjust can make one AssemblyProgram look more like another.
+enum AdjustmentMethodId {
+  ADJUSTMENT_METHOD_NULL,     // Makes no adjustments.
+  ADJUSTMENT_METHOD_TRIE,     // The original method.
+  ADJUSTMENT_METHOD_SHINGLE,  // Shingle weighting, used in production.
+  ADJUSTMENT_METHOD_FLAT,     // Shingle matching over flat arrays.
+};
+
 class SinkStream;
 class SinkStreamSet;
 class SourceStream;
@@ -84,12 +92,31 @@ Status ApplyEnsemblePatch(const base::FilePath::CharType* old_file_name,
                           const base::FilePath::CharType* patch_file_name,
                           const base::FilePath::CharType* new_file_name);
 
+// As above, but assembles the ensemble one element at a time and writes it to
+// |new_file_name| as it is produced.  Data that outlives an element is kept in
+// temporary files rather than on the heap, so peak memory is bounded by the
+// largest element instead of the size of the output.  |new_file_name| is
+// deleted if the patch fails.
+Status ApplyEnsemblePatchStreaming(
+    const base::FilePath::CharType* old_file_name,
+    const base::FilePath::CharType* patch_file_name,
+    const base::FilePath::CharType* new_file_name);
+
 // Generates a patch that will transform the bytes in |old| into the bytes in
 // |target|.
 // Returns C_OK unless something when wrong (unexpected).
 Status GenerateEnsemblePatch(SourceStream* old, SourceStream* target,
                              SinkStream* patch);
 
+// As above, but transforms at most |max_threads| elements at a time, and only
+// starts another element while the estimated memory of the elements in
+// progress stays within |memory_budget| bytes.  The version above uses all
+// processors and half of the physical memory.  The patch is the same for any
+// limits.
+Status GenerateEnsemblePatch(SourceStream* old, SourceStream* target,
+                             SinkStream* patch,
+                             int max_threads, size_t memory_budget);
+
 // Detects the type of an executable file, and it's length. The length
 // may be slightly smaller than some executables (like ELF), but will include
 // all bytes the courgette algorithm has special benefit for.
@@ -142,5 +169,10 @@ void DeleteEncodedProgram(EncodedProgram* encoded);
 //
 Status Adjust(const AssemblyProgram& model, AssemblyProgram *program);
 
+// Adjusts |program| to look more like |model| with the adjustment method
+// |method|.
+Status Adjust(const AssemblyProgram& model, AssemblyProgram* program,
+              AdjustmentMethodId method);
+
 }  // namespace courgette
 #endif  // COURGETTE_COURGETTE_H_
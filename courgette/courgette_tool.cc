@@ -10,10 +10,15 @@
 #include "base/command_line.h"
 #include "base/file_util.h"
 #include "base/files/file_path.h"
+#include "base/format_macros.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process/process_handle.h"
+#include "base/process/process_metrics.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
 #include "courgette/third_party/bsdiff.h"
@@ -28,6 +33,9 @@ void PrintHelp() {
     "  courgette -disadj <executable_file> <reference> <binary_assembly_file>\n"
     "  courgette -gen <v1> <v2> <patch>\n"
     "  courgette -apply <v1> <patch> <v2>\n"
+    "  courgette -applystream <v1> <patch> <v2>\n"
+    "  courgette -sufsortbench <v1>\n"
+    "  courgette -adjbench <v1> <v2>\n"
     "\n");
 }
 
@@ -329,12 +337,17 @@ void GenerateEnsemblePatch(const base::FilePath& old_file,
 
 void ApplyEnsemblePatch(const base::FilePath& old_file,
                         const base::FilePath& patch_file,
-                        const base::FilePath& new_file) {
+                        const base::FilePath& new_file,
+                        bool streaming) {
   // We do things a little differently here in order to call the same Courgette
   // entry point as the installer.  That entry point point takes file names and
   // returns an status code but does not output any diagnostics.
 
   courgette::Status status =
+      streaming ?
+      courgette::ApplyEnsemblePatchStreaming(old_file.value().c_str(),
+                                             patch_file.value().c_str(),
+                                             new_file.value().c_str()) :
       courgette::ApplyEnsemblePatch(old_file.value().c_str(),
                                     patch_file.value().c_str(),
                                     new_file.value().c_str());
@@ -381,7 +394,7 @@ void ApplyEnsemblePatch(const base::FilePath& old_file,
   if (status == courgette::C_WRITE_ERROR)
     Problem("Can't write output");
 
-  Problem("-apply failed.");
+  Problem(streaming ? "-applystream failed." : "-apply failed.");
 }
 
 void GenerateBSDiffPatch(const base::FilePath& old_file,
@@ -424,6 +437,132 @@ void ApplyBSDiffPatch(const base::FilePath& old_file,
   WriteSinkToFile(&new_stream, new_file);
 }
 
+// Generates a bsdiff patch from |old_file| to an empty file with each suffix
+// sort, which times little more than building the suffix array, and reports
+// the time taken and the peak working set of the process.  qsufsort runs last
+// since it needs more memory, so its peak is not hidden by the SA-IS run.
+void BenchmarkSuffixSort(const base::FilePath& old_file) {
+  std::string old_buffer = ReadOrFail(old_file, "'old' input");
+
+#if !defined(OS_MACOSX) || defined(OS_IOS)
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+#else
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle(), NULL));
+#endif
+
+  static const struct {
+    courgette::SuffixSortAlgorithm algorithm;
+    const char* name;
+  } kSuffixSorts[] = {
+    { courgette::SUFFIX_SORT_SAIS, "SA-IS" },
+    { courgette::SUFFIX_SORT_QSUFSORT, "qsufsort" },
+  };
+  for (size_t i = 0; i < ARRAYSIZE_UNSAFE(kSuffixSorts); ++i) {
+    courgette::SourceStream old_stream;
+    courgette::SourceStream new_stream;
+    old_stream.Init(old_buffer);
+    new_stream.Init(std::string());
+
+    courgette::SinkStream patch_stream;
+    base::TimeTicks start = base::TimeTicks::Now();
+    courgette::BSDiffStatus status = courgette::CreateBinaryPatch(
+        &old_stream, &new_stream, &patch_stream, kSuffixSorts[i].algorithm);
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    if (status != courgette::OK)
+      Problem("-sufsortbench failed.");
+
+    fprintf(stderr, "%s: %.2f s, peak working set %.1f MB\n",
+            kSuffixSorts[i].name,
+            elapsed.InSecondsF(),
+            metrics->GetPeakWorkingSetSize() / (1024.0 * 1024.0));
+  }
+}
+
+// Parses |buffer| as an executable, or exits.
+courgette::AssemblyProgram* ParseOrFail(const std::string& buffer,
+                                        const char* kind) {
+  courgette::AssemblyProgram* program = NULL;
+  const courgette::Status parse_status =
+      courgette::ParseDetectedExecutable(buffer.c_str(), buffer.length(),
+                                         &program);
+  if (parse_status != courgette::C_OK)
+    Problem("Can't parse %s input.", kind);
+  return program;
+}
+
+// Encodes and serializes |program| into |sinks|, and deletes |program|.
+void EncodeOrFail(courgette::AssemblyProgram* program,
+                  courgette::SinkStreamSet* sinks) {
+  courgette::EncodedProgram* encoded = NULL;
+  const courgette::Status encode_status = Encode(program, &encoded);
+  courgette::DeleteAssemblyProgram(program);
+  if (encode_status != courgette::C_OK)
+    Problem("Can't encode program.");
+
+  const courgette::Status write_status =
+      courgette::WriteEncodedProgram(encoded, sinks);
+  courgette::DeleteEncodedProgram(encoded);
+  if (write_status != courgette::C_OK)
+    Problem("Can't serialize encoded program.");
+}
+
+// Adjusts the disassembly of |new_file| to the disassembly of |old_file| with
+// each adjustment method, and reports the time taken and the total size of
+// the bsdiff patches between the streams of the two EncodedPrograms, as -gen1a
+// would write them.
+void BenchmarkAdjustment(const base::FilePath& old_file,
+                         const base::FilePath& new_file) {
+  std::string old_buffer = ReadOrFail(old_file, "'old' input");
+  std::string new_buffer = ReadOrFail(new_file, "'new' input");
+
+  static const struct {
+    courgette::AdjustmentMethodId method;
+    const char* name;
+  } kAdjustmentMethods[] = {
+    { courgette::ADJUSTMENT_METHOD_NULL, "null" },
+    { courgette::ADJUSTMENT_METHOD_TRIE, "trie" },
+    { courgette::ADJUSTMENT_METHOD_SHINGLE, "shingle" },
+    { courgette::ADJUSTMENT_METHOD_FLAT, "flat" },
+  };
+  for (size_t i = 0; i < ARRAYSIZE_UNSAFE(kAdjustmentMethods); ++i) {
+    courgette::AssemblyProgram* model = ParseOrFail(old_buffer, "'old'");
+    courgette::AssemblyProgram* program = ParseOrFail(new_buffer, "'new'");
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    const courgette::Status adjust_status =
+        courgette::Adjust(*model, program, kAdjustmentMethods[i].method);
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    if (adjust_status != courgette::C_OK)
+      Problem("Can't adjust program.");
+
+    courgette::SinkStreamSet model_sinks;
+    courgette::SinkStreamSet program_sinks;
+    EncodeOrFail(model, &model_sinks);
+    EncodeOrFail(program, &program_sinks);
+
+    size_t patch_size = 0;
+    for (size_t j = 0; j < courgette::kMaxStreams; ++j) {
+      courgette::SourceStream old_source;
+      courgette::SourceStream new_source;
+      old_source.Init(*model_sinks.stream(j));
+      new_source.Init(*program_sinks.stream(j));
+      courgette::SinkStream patch_stream;
+      courgette::BSDiffStatus status = courgette::CreateBinaryPatch(
+          &old_source, &new_source, &patch_stream);
+      if (status != courgette::OK)
+        Problem("-adjbench failed.");
+      patch_size += patch_stream.Length();
+    }
+
+    fprintf(stderr, "%s: %.2f s, patch %" PRIuS " bytes\n",
+            kAdjustmentMethods[i].name, elapsed.InSecondsF(), patch_size);
+  }
+}
+
 int main(int argc, const char* argv[]) {
   base::AtExitManager at_exit_manager;
   CommandLine::Init(argc, argv);
@@ -441,10 +580,13 @@ int main(int argc, const char* argv[]) {
   bool cmd_disadj = command_line.HasSwitch("disadj");
   bool cmd_make_patch = command_line.HasSwitch("gen");
   bool cmd_apply_patch = command_line.HasSwitch("apply");
+  bool cmd_apply_patch_streaming = command_line.HasSwitch("applystream");
   bool cmd_make_bsdiff_patch = command_line.HasSwitch("genbsdiff");
   bool cmd_apply_bsdiff_patch = command_line.HasSwitch("applybsdiff");
   bool cmd_spread_1_adjusted = command_line.HasSwitch("gen1a");
   bool cmd_spread_1_unadjusted = command_line.HasSwitch("gen1u");
+  bool cmd_suffix_sort_benchmark = command_line.HasSwitch("sufsortbench");
+  bool cmd_adjustment_benchmark = command_line.HasSwitch("adjbench");
 
   std::vector<base::FilePath> values;
   const CommandLine::StringVector& args = command_line.GetArgs();
@@ -461,13 +603,14 @@ int main(int argc, const char* argv[]) {
       repeat_count = 1;
 
   if (cmd_sup + cmd_dis + cmd_asm + cmd_disadj + cmd_make_patch +
-      cmd_apply_patch + cmd_make_bsdiff_patch + cmd_apply_bsdiff_patch +
-      cmd_spread_1_adjusted + cmd_spread_1_unadjusted
+      cmd_apply_patch + cmd_apply_patch_streaming + cmd_make_bsdiff_patch +
+      cmd_apply_bsdiff_patch + cmd_spread_1_adjusted + cmd_spread_1_unadjusted +
+      cmd_suffix_sort_benchmark + cmd_adjustment_benchmark
       != 1)
     UsageProblem(
         "Must have exactly one of:\n"
-        "  -supported -asm, -dis, -disadj, -gen or -apply, -genbsdiff"
-        " or -applybsdiff.");
+        "  -supported -asm, -dis, -disadj, -gen or -apply, -applystream,"
+        " -genbsdiff, -applybsdiff, -sufsortbench or -adjbench.");
 
   while (repeat_count-- > 0) {
     if (cmd_sup) {
@@ -493,7 +636,11 @@ int main(int argc, const char* argv[]) {
     } else if (cmd_apply_patch) {
       if (values.size() != 3)
         UsageProblem("-apply <old_file> <patch_file> <new_file>");
-      ApplyEnsemblePatch(values[0], values[1], values[2]);
+      ApplyEnsemblePatch(values[0], values[1], values[2], false);
+    } else if (cmd_apply_patch_streaming) {
+      if (values.size() != 3)
+        UsageProblem("-applystream <old_file> <patch_file> <new_file>");
+      ApplyEnsemblePatch(values[0], values[1], values[2], true);
     } else if (cmd_make_bsdiff_patch) {
       if (values.size() != 3)
         UsageProblem("-genbsdiff <old_file> <new_file> <patch_file>");
@@ -507,6 +654,14 @@ int main(int argc, const char* argv[]) {
         UsageProblem("-gen1[au] <old_file> <new_file> <patch_files_root>");
       DisassembleAdjustDiff(values[0], values[1], values[2],
                             cmd_spread_1_adjusted);
+    } else if (cmd_suffix_sort_benchmark) {
+      if (values.size() != 1)
+        UsageProblem("-sufsortbench <old_file>");
+      BenchmarkSuffixSort(values[0]);
+    } else if (cmd_adjustment_benchmark) {
+      if (values.size() != 2)
+        UsageProblem("-adjbench <old_file> <new_file>");
+      BenchmarkAdjustment(values[0], values[1]);
     } else {
       UsageProblem("No operation specified");
     }
@@ -13,9 +13,27 @@ extern "C" {
 #endif
 
 #include "base/basictypes.h"
+#include "base/lazy_instance.h"
 
 namespace courgette {
 
+#ifndef COURGETTE_USE_CRC_LIB
+namespace {
+
+// Builds the LZMA SDK's slice-by-8 tables, 8KB of them, once per process
+// rather than on every call.
+class CrcTable {
+ public:
+  CrcTable() {
+    CrcGenerateTable();
+  }
+};
+
+base::LazyInstance<CrcTable>::Leaky g_crc_table = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+#endif
+
 uint32 CalculateCrc(const uint8* buffer, size_t size) {
   uint32 crc;
 
@@ -24,11 +42,22 @@ uint32 CalculateCrc(const uint8* buffer, size_t size) {
   crc = crc32(0, buffer, size);
 #else
   // Calculate Crc by calling CRC method in LZMA SDK
-  CrcGenerateTable();
+  g_crc_table.Get();
   crc = CrcCalc(buffer, size);
 #endif
 
   return ~crc;
 }
 
+uint32 UpdateCrc(uint32 crc, const uint8* buffer, size_t size) {
+#ifdef COURGETTE_USE_CRC_LIB
+  return ~crc32(~crc, buffer, size);
+#else
+  // CalculateCrc returns the value CrcUpdate works on, before the final
+  // inversion that CrcCalc applies.
+  g_crc_table.Get();
+  return CrcUpdate(crc, buffer, size);
+#endif
+}
+
 }  // namespace
@@ -13,5 +13,10 @@ namespace courgette {
 //
 uint32 CalculateCrc(const uint8* buffer, size_t size);
 
+// Extends |crc|, the Crc of some bytes as returned by CalculateCrc, to also
+// cover the |size| bytes at |buffer|.  CalculateCrc(NULL, 0) is the Crc of no
+// bytes.
+uint32 UpdateCrc(uint32 crc, const uint8* buffer, size_t size);
+
 }  // namespace courgette
 #endif  // COURGETTE_CRC_H_
@@ -0,0 +1,45 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/crc.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const char kCheckInput[] = "123456789";
+
+const uint8* AsBytes(const char* data) {
+  return reinterpret_cast<const uint8*>(data);
+}
+
+}  // namespace
+
+TEST(CrcTest, CalculateCrc) {
+  // Courgette's Crc is the bitwise complement of the usual CRC-32, which is
+  // 0xCBF43926 for |kCheckInput|.
+  EXPECT_EQ(0x340BC6D9U,
+            courgette::CalculateCrc(AsBytes(kCheckInput),
+                                    strlen(kCheckInput)));
+  EXPECT_EQ(0xFFFFFFFFU, courgette::CalculateCrc(NULL, 0));
+}
+
+TEST(CrcTest, UpdateCrc) {
+  const size_t size = strlen(kCheckInput);
+  const uint32 expected = courgette::CalculateCrc(AsBytes(kCheckInput), size);
+
+  for (size_t split = 0; split <= size; ++split) {
+    uint32 crc = courgette::CalculateCrc(AsBytes(kCheckInput), split);
+    crc = courgette::UpdateCrc(crc, AsBytes(kCheckInput) + split,
+                               size - split);
+    EXPECT_EQ(expected, crc) << "split at " << split;
+  }
+
+  uint32 crc = courgette::CalculateCrc(NULL, 0);
+  for (size_t i = 0; i < size; ++i)
+    crc = courgette::UpdateCrc(crc, AsBytes(kCheckInput) + i, 1);
+  EXPECT_EQ(expected, crc);
+}
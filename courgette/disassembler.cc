@@ -84,7 +84,12 @@ Status ParseDetectedExecutable(const void* buffer, size_t length,
 
   AssemblyProgram* program = new AssemblyProgram(disassembler->kind());
 
-  if (!disassembler->Disassemble(program)) {
+  // Every instruction covers at least one byte, bar a few without bytes, so
+  // the length bounds the count closely.  Reserving avoids the copy of the
+  // list when it doubles, which would otherwise set the peak memory of the
+  // parse.
+  if (!program->ReserveInstructions(disassembler->length()) ||
+      !disassembler->Disassemble(program)) {
     delete program;
     delete disassembler;
     return C_DISASSEMBLY_FAILED;
@@ -201,6 +201,9 @@ class TransformationPatchGenerator {
 
   virtual ~TransformationPatchGenerator();
 
+  Element* old_element() const { return old_element_; }
+  Element* new_element() const { return new_element_; }
+
   // Returns the TransformationMethodId that identies this transformation.
   virtual ExecutableType Kind() = 0;
 
@@ -6,10 +6,15 @@
 
 #include "courgette/ensemble.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/file_util.h"
 #include "base/files/memory_mapped_file.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/platform_file.h"
 #include "courgette/crc.h"
 #include "courgette/region.h"
 #include "courgette/streams.h"
@@ -18,6 +23,90 @@
 
 namespace courgette {
 
+namespace {
+
+// A temporary file that holds data which outlives one element of a streaming
+// patch application.  The data is appended to the file and then mapped back
+// in for reading, so it occupies the page cache rather than the heap.  The file
+// is deleted when the SpillFile is closed.
+class SpillFile {
+ public:
+  SpillFile() : file_(base::kInvalidPlatformFileValue) {}
+  ~SpillFile() { Close(); }
+
+  // Creates the file, empty and open for writing.
+  bool Create() {
+    DCHECK(path_.empty());
+    if (!base::CreateTemporaryFile(&path_))
+      return false;
+    file_ = base::CreatePlatformFile(
+        path_, base::PLATFORM_FILE_CREATE_ALWAYS | base::PLATFORM_FILE_WRITE,
+        NULL, NULL);
+    return file_ != base::kInvalidPlatformFileValue;
+  }
+
+  // Returns the file that is open for writing.
+  base::PlatformFile file() const { return file_; }
+
+  // Appends |length| bytes at |data| to the file.
+  bool Write(const void* data, size_t length) {
+    const char* bytes = static_cast<const char*>(data);
+    while (length > 0) {
+      int chunk = static_cast<int>(std::min<size_t>(length, kMaxWriteSize));
+      if (base::WritePlatformFileAtCurrentPos(file_, bytes, chunk) != chunk)
+        return false;
+      bytes += chunk;
+      length -= chunk;
+    }
+    return true;
+  }
+
+  // Finishes writing and sets |region| to the contents of the file, which stay
+  // mapped until the file is closed.
+  bool Map(Region* region) {
+    base::ClosePlatformFile(file_);
+    file_ = base::kInvalidPlatformFileValue;
+
+    int64 size = 0;
+    if (!base::GetFileSize(path_, &size))
+      return false;
+    if (size == 0) {
+      // An empty file can not be mapped.
+      region->assign(Region());
+      return true;
+    }
+    mapping_.reset(new base::MemoryMappedFile());
+    if (!mapping_->Initialize(path_))
+      return false;
+    region->assign(Region(mapping_->data(), mapping_->length()));
+    return true;
+  }
+
+  // Unmaps and deletes the file.
+  void Close() {
+    if (file_ != base::kInvalidPlatformFileValue) {
+      base::ClosePlatformFile(file_);
+      file_ = base::kInvalidPlatformFileValue;
+    }
+    mapping_.reset();
+    if (!path_.empty()) {
+      base::DeleteFile(path_, false);
+      path_.clear();
+    }
+  }
+
+ private:
+  static const size_t kMaxWriteSize = 1 << 30;
+
+  base::FilePath path_;
+  base::PlatformFile file_;
+  scoped_ptr<base::MemoryMappedFile> mapping_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpillFile);
+};
+
+}  // namespace
+
 // EnsemblePatchApplication is all the logic and data required to apply the
 // multi-stage patch.
 class EnsemblePatchApplication {
@@ -53,6 +142,24 @@ class EnsemblePatchApplication {
                              SourceStream* correction,
                              SinkStream* corrected_ensemble);
 
+  // Streaming versions of the last four steps.  The intermediate data is
+  // kept in temporary files as soon as each element has been processed, so
+  // the heap only has to hold one element at a time.
+
+  Status TransformUpToFile(SourceStreamSet* parameters,
+                           SourceStream* transformed_elements);
+
+  Status SubpatchTransformedElementsToFile(SourceStream* elements,
+                                           SourceStream* correction,
+                                           SourceStreamSet* corrected_elements);
+
+  Status TransformDownToFile(SourceStreamSet* transformed_elements,
+                             SourceStream* basic_elements);
+
+  Status SubpatchFinalOutputToFile(SourceStream* original,
+                                   SourceStream* correction,
+                                   base::PlatformFile corrected_ensemble);
+
  private:
   Status SubpatchStreamSets(SinkStreamSet* predicted_items,
                             SourceStream* correction,
@@ -70,6 +177,10 @@ class EnsemblePatchApplication {
   SinkStream corrected_parameters_storage_;
   SinkStream corrected_elements_storage_;
 
+  SpillFile transformed_elements_file_;
+  SpillFile corrected_elements_file_;
+  SpillFile basic_elements_file_;
+
   DISALLOW_COPY_AND_ASSIGN(EnsemblePatchApplication);
 };
 
@@ -279,6 +390,160 @@ Status EnsemblePatchApplication::SubpatchFinalOutput(
   return C_OK;
 }
 
+Status EnsemblePatchApplication::TransformUpToFile(
+    SourceStreamSet* parameters,
+    SourceStream* transformed_elements) {
+  // Each element adds a piece to every stream of the combined set that
+  // TransformUp builds.  The pieces are spilled element by element and then
+  // rearranged into the layout of SinkStreamSet::CopyTo.
+  SpillFile pieces_file;
+  if (!pieces_file.Create())
+    return C_STREAM_ERROR;
+  std::vector<size_t> piece_lengths;
+  size_t stream_lengths[kMaxStreams] = {};
+
+  for (size_t i = 0;  i < patchers_.size();  ++i) {
+    SourceStreamSet single_parameters;
+    if (!parameters->ReadSet(&single_parameters))
+      return C_STREAM_ERROR;
+    SinkStreamSet single_transformed_element;
+    Status status = patchers_[i]->Transform(&single_parameters,
+                                            &single_transformed_element);
+    if (status != C_OK)
+      return status;
+    if (!single_parameters.Empty())
+      return C_STREAM_NOT_CONSUMED;
+
+    SinkStreamSet pieces;
+    if (!pieces.WriteSet(&single_transformed_element))
+      return C_STREAM_ERROR;
+    for (size_t j = 0;  j < kMaxStreams;  ++j) {
+      SinkStream* piece = pieces.stream(j);
+      if (!pieces_file.Write(piece->Buffer(), piece->Length()))
+        return C_STREAM_ERROR;
+      piece_lengths.push_back(piece->Length());
+      stream_lengths[j] += piece->Length();
+      piece->Retire();
+    }
+  }
+
+  if (!parameters->Empty())
+    return C_STREAM_NOT_CONSUMED;
+
+  Region pieces_region;
+  if (!pieces_file.Map(&pieces_region))
+    return C_STREAM_ERROR;
+
+  if (!transformed_elements_file_.Create())
+    return C_STREAM_ERROR;
+  SinkStream header;
+  if (!SinkStreamSet::WriteHeader(kMaxStreams, stream_lengths, &header) ||
+      !transformed_elements_file_.Write(header.Buffer(), header.Length()))
+    return C_STREAM_ERROR;
+  for (size_t j = 0;  j < kMaxStreams;  ++j) {
+    size_t offset = 0;
+    for (size_t k = 0;  k < piece_lengths.size();  ++k) {
+      if (k % kMaxStreams == j &&
+          !transformed_elements_file_.Write(pieces_region.start() + offset,
+                                            piece_lengths[k]))
+        return C_STREAM_ERROR;
+      offset += piece_lengths[k];
+    }
+  }
+
+  Region transformed_elements_region;
+  if (!transformed_elements_file_.Map(&transformed_elements_region))
+    return C_STREAM_ERROR;
+  transformed_elements->Init(transformed_elements_region);
+
+  return C_OK;
+}
+
+Status EnsemblePatchApplication::SubpatchTransformedElementsToFile(
+    SourceStream* predicted_elements,
+    SourceStream* correction,
+    SourceStreamSet* corrected_elements) {
+  if (!corrected_elements_file_.Create())
+    return C_STREAM_ERROR;
+  uint32 corrected_elements_crc;
+  Status status = ApplySimpleDeltaToFile(predicted_elements,
+                                         correction,
+                                         corrected_elements_file_.file(),
+                                         &corrected_elements_crc);
+  if (status != C_OK)
+    return status;
+  // The prediction has been used up, so can delete the file it is in.
+  transformed_elements_file_.Close();
+
+  Region corrected_region;
+  if (!corrected_elements_file_.Map(&corrected_region))
+    return C_STREAM_ERROR;
+  if (!corrected_elements->Init(corrected_region.start(),
+                                corrected_region.length()))
+    return C_STREAM_ERROR;
+
+  return C_OK;
+}
+
+Status EnsemblePatchApplication::TransformDownToFile(
+    SourceStreamSet* transformed_elements,
+    SourceStream* basic_elements) {
+  // Construct the same blob as TransformDown, but in a file, reforming one
+  // element at a time.
+  if (!basic_elements_file_.Create())
+    return C_STREAM_ERROR;
+
+  // The original input:
+  if (!basic_elements_file_.Write(base_region_.start(), base_region_.length()))
+    return C_STREAM_ERROR;
+
+  for (size_t i = 0;  i < patchers_.size();  ++i) {
+    SourceStreamSet single_corrected_element;
+    if (!transformed_elements->ReadSet(&single_corrected_element))
+      return C_STREAM_ERROR;
+    SinkStream reformed_element;
+    Status status = patchers_[i]->Reform(&single_corrected_element,
+                                         &reformed_element);
+    if (status != C_OK)
+      return status;
+    if (!single_corrected_element.Empty())
+      return C_STREAM_NOT_CONSUMED;
+    if (!basic_elements_file_.Write(reformed_element.Buffer(),
+                                    reformed_element.Length()))
+      return C_STREAM_ERROR;
+  }
+
+  if (!transformed_elements->Empty())
+    return C_STREAM_NOT_CONSUMED;
+  // We have totally consumed transformed_elements, so can delete the file to
+  // which it referred.
+  corrected_elements_file_.Close();
+
+  Region basic_elements_region;
+  if (!basic_elements_file_.Map(&basic_elements_region))
+    return C_STREAM_ERROR;
+  basic_elements->Init(basic_elements_region);
+
+  return C_OK;
+}
+
+Status EnsemblePatchApplication::SubpatchFinalOutputToFile(
+    SourceStream* original,
+    SourceStream* correction,
+    base::PlatformFile corrected_ensemble) {
+  uint32 corrected_ensemble_crc;
+  Status delta_status = ApplySimpleDeltaToFile(original, correction,
+                                               corrected_ensemble,
+                                               &corrected_ensemble_crc);
+  if (delta_status != C_OK)
+    return delta_status;
+
+  if (corrected_ensemble_crc != target_checksum_)
+    return C_BAD_ENSEMBLE_CRC;
+
+  return C_OK;
+}
+
 Status EnsemblePatchApplication::SubpatchStreamSets(
     SinkStreamSet* predicted_items,
     SourceStream* correction,
@@ -304,49 +569,65 @@ Status EnsemblePatchApplication::SubpatchStreamSets(
   return C_OK;
 }
 
-Status ApplyEnsemblePatch(SourceStream* base,
-                          SourceStream* patch,
-                          SinkStream* output) {
+// Applies the steps that are the same whether the patched ensemble is
+// collected in memory or streamed to a file: validates |base| against the
+// header of |patch|, and works out the parameters for transforming the
+// elements of |base|.  On return |patch_streams| holds the rest of the patch.
+static Status ReadTransformParameters(EnsemblePatchApplication* patch_process,
+                                      SourceStream* base,
+                                      SourceStream* patch,
+                                      SourceStreamSet* patch_streams,
+                                      SourceStreamSet* corrected_parameters) {
   Status status;
-  EnsemblePatchApplication patch_process;
 
-  status = patch_process.ReadHeader(patch);
+  status = patch_process->ReadHeader(patch);
   if (status != C_OK)
     return status;
 
-  status = patch_process.InitBase(Region(base->Buffer(), base->Remaining()));
+  status = patch_process->InitBase(Region(base->Buffer(), base->Remaining()));
   if (status != C_OK)
     return status;
 
-  status = patch_process.ValidateBase();
+  status = patch_process->ValidateBase();
   if (status != C_OK)
     return status;
 
   // The rest of the patch stream is a StreamSet.
-  SourceStreamSet patch_streams;
-  patch_streams.Init(patch);
+  patch_streams->Init(patch);
 
-  SourceStream* transformation_descriptions     = patch_streams.stream(0);
-  SourceStream* parameter_correction            = patch_streams.stream(1);
-  SourceStream* transformed_elements_correction = patch_streams.stream(2);
-  SourceStream* ensemble_correction             = patch_streams.stream(3);
+  SourceStream* transformation_descriptions     = patch_streams->stream(0);
+  SourceStream* parameter_correction            = patch_streams->stream(1);
 
-  status = patch_process.ReadInitialParameters(transformation_descriptions);
+  status = patch_process->ReadInitialParameters(transformation_descriptions);
   if (status != C_OK)
     return status;
 
   SinkStreamSet predicted_parameters;
-  status = patch_process.PredictTransformParameters(&predicted_parameters);
+  status = patch_process->PredictTransformParameters(&predicted_parameters);
   if (status != C_OK)
     return status;
 
+  return patch_process->SubpatchTransformParameters(&predicted_parameters,
+                                                    parameter_correction,
+                                                    corrected_parameters);
+}
+
+Status ApplyEnsemblePatch(SourceStream* base,
+                          SourceStream* patch,
+                          SinkStream* output) {
+  Status status;
+  EnsemblePatchApplication patch_process;
+
+  SourceStreamSet patch_streams;
   SourceStreamSet corrected_parameters;
-  status = patch_process.SubpatchTransformParameters(&predicted_parameters,
-                                                     parameter_correction,
-                                                     &corrected_parameters);
+  status = ReadTransformParameters(&patch_process, base, patch, &patch_streams,
+                                   &corrected_parameters);
   if (status != C_OK)
     return status;
 
+  SourceStream* transformed_elements_correction = patch_streams.stream(2);
+  SourceStream* ensemble_correction             = patch_streams.stream(3);
+
   SinkStreamSet transformed_elements;
   status = patch_process.TransformUp(&corrected_parameters,
                                      &transformed_elements);
@@ -378,6 +659,48 @@ Status ApplyEnsemblePatch(SourceStream* base,
   return C_OK;
 }
 
+// Streaming counterpart of ApplyEnsemblePatch above that writes the patched
+// ensemble to |output|.
+static Status ApplyEnsemblePatchToFile(SourceStream* base,
+                                       SourceStream* patch,
+                                       base::PlatformFile output) {
+  Status status;
+  EnsemblePatchApplication patch_process;
+
+  SourceStreamSet patch_streams;
+  SourceStreamSet corrected_parameters;
+  status = ReadTransformParameters(&patch_process, base, patch, &patch_streams,
+                                   &corrected_parameters);
+  if (status != C_OK)
+    return status;
+
+  SourceStream* transformed_elements_correction = patch_streams.stream(2);
+  SourceStream* ensemble_correction             = patch_streams.stream(3);
+
+  SourceStream transformed_elements;
+  status = patch_process.TransformUpToFile(&corrected_parameters,
+                                           &transformed_elements);
+  if (status != C_OK)
+    return status;
+
+  SourceStreamSet corrected_transformed_elements;
+  status = patch_process.SubpatchTransformedElementsToFile(
+      &transformed_elements,
+      transformed_elements_correction,
+      &corrected_transformed_elements);
+  if (status != C_OK)
+    return status;
+
+  SourceStream final_patch_prediction;
+  status = patch_process.TransformDownToFile(&corrected_transformed_elements,
+                                             &final_patch_prediction);
+  if (status != C_OK)
+    return status;
+
+  return patch_process.SubpatchFinalOutputToFile(&final_patch_prediction,
+                                                 ensemble_correction, output);
+}
+
 Status ApplyEnsemblePatch(const base::FilePath::CharType* old_file_name,
                           const base::FilePath::CharType* patch_file_name,
                           const base::FilePath::CharType* new_file_name) {
@@ -428,4 +751,51 @@ Status ApplyEnsemblePatch(const base::FilePath::CharType* old_file_name,
   return C_OK;
 }
 
+Status ApplyEnsemblePatchStreaming(
+    const base::FilePath::CharType* old_file_name,
+    const base::FilePath::CharType* patch_file_name,
+    const base::FilePath::CharType* new_file_name) {
+  base::FilePath patch_file_path(patch_file_name);
+  base::MemoryMappedFile patch_file;
+  if (!patch_file.Initialize(patch_file_path))
+    return C_READ_OPEN_ERROR;
+
+  // 'Dry-run' the first step of the patch process to validate format of header.
+  SourceStream patch_header_stream;
+  patch_header_stream.Init(patch_file.data(), patch_file.length());
+  EnsemblePatchApplication patch_process;
+  Status status = patch_process.ReadHeader(&patch_header_stream);
+  if (status != C_OK)
+    return status;
+
+  // Map the old_file.  Unlike a heap copy, its pages can be dropped and read
+  // back in under memory pressure.
+  base::FilePath old_file_path(old_file_name);
+  base::MemoryMappedFile old_file;
+  if (!old_file.Initialize(old_file_path))
+    return C_READ_ERROR;
+
+  base::FilePath new_file_path(new_file_name);
+  base::PlatformFile new_file = base::CreatePlatformFile(
+      new_file_path,
+      base::PLATFORM_FILE_CREATE_ALWAYS | base::PLATFORM_FILE_WRITE,
+      NULL, NULL);
+  if (new_file == base::kInvalidPlatformFileValue)
+    return C_WRITE_OPEN_ERROR;
+
+  SourceStream old_source_stream;
+  SourceStream patch_source_stream;
+  old_source_stream.Init(old_file.data(), old_file.length());
+  patch_source_stream.Init(patch_file.data(), patch_file.length());
+  status = ApplyEnsemblePatchToFile(&old_source_stream, &patch_source_stream,
+                                    new_file);
+
+  if (!base::ClosePlatformFile(new_file) && status == C_OK)
+    status = C_WRITE_ERROR;
+  // Don't leave a partly written or corrupt file behind.
+  if (status != C_OK)
+    base::DeleteFile(new_file_path, false);
+  return status;
+}
+
 }  // namespace
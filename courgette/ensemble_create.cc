@@ -14,11 +14,17 @@
 
 #include "courgette/ensemble.h"
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 
 #include "courgette/crc.h"
@@ -238,11 +244,222 @@ void FreeGenerators(std::vector<TransformationPatchGenerator*>* generators) {
   generators->clear();
 }
 
+// Rough peak memory needed to transform an element, per byte of the old and
+// new elements.  Both are disassembled into AssemblyPrograms, which take
+// several times the size of the code.
+static const size_t kTransformMemoryPerByte = 16;
+
+// Runs TransformationPatchGenerator::Transform for each generator, on a pool of
+// threads when there is more than one element.  The elements are started in
+// order, and an element is started only while the estimated memory of the
+// elements started but not yet released fits in the budget, except that one
+// element can always run.  Each element keeps its own output until the caller
+// has written it, so the caller can write the outputs in order and the patch
+// does not depend on how the work was scheduled.
+class ElementTransformer : public base::DelegateSimpleThread::Delegate {
+ public:
+  ElementTransformer(
+      const std::vector<TransformationPatchGenerator*>& generators,
+      int max_threads,
+      size_t memory_budget);
+  virtual ~ElementTransformer();
+
+  // The input and outputs of the |index|th element.
+  SourceStreamSet* parameters(size_t index) {
+    return &jobs_[index]->parameters;
+  }
+  SinkStreamSet* predicted_transformed_element(size_t index) {
+    return &jobs_[index]->predicted_transformed_element;
+  }
+  SinkStreamSet* corrected_transformed_element(size_t index) {
+    return &jobs_[index]->corrected_transformed_element;
+  }
+
+  // Starts transforming.  The parameters of all elements must have been read.
+  void Start();
+
+  // Waits for the |index|th element to be transformed and returns the status.
+  // The elements must be waited for in order.
+  Status WaitForElement(size_t index);
+
+  // Returns the memory of the |index|th element to the budget once its output
+  // has been written.
+  void ReleaseElement(size_t index);
+
+  // DelegateSimpleThread::Delegate implementation.  Each thread of the pool
+  // transforms elements until none are left.
+  virtual void Run() OVERRIDE;
+
+ private:
+  struct Job {
+    explicit Job(TransformationPatchGenerator* generator);
+
+    TransformationPatchGenerator* generator;
+    size_t memory_estimate;
+    SourceStreamSet parameters;
+    SinkStreamSet predicted_transformed_element;
+    SinkStreamSet corrected_transformed_element;
+    Status status;
+    bool done;
+  };
+
+  static Status Transform(Job* job);
+
+  bool FitsInBudget(const Job* job) const;
+
+  ScopedVector<Job> jobs_;
+  const size_t memory_budget_;
+  int num_threads_;
+
+  // NULL until Start(), and when the elements are transformed on the calling
+  // thread.
+  scoped_ptr<base::DelegateSimpleThreadPool> pool_;
+
+  base::Lock lock_;
+  // Signalled when an element is done or released, or on cancellation.
+  base::ConditionVariable condition_;
+  // The fields below are guarded by |lock_|.
+  size_t next_job_;
+  size_t memory_in_use_;
+  bool cancelled_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElementTransformer);
+};
+
+ElementTransformer::Job::Job(TransformationPatchGenerator* generator)
+    : generator(generator),
+      memory_estimate(0),
+      status(C_OK),
+      done(false) {
+}
+
+ElementTransformer::ElementTransformer(
+    const std::vector<TransformationPatchGenerator*>& generators,
+    int max_threads,
+    size_t memory_budget)
+    : memory_budget_(memory_budget),
+      num_threads_(1),
+      condition_(&lock_),
+      next_job_(0),
+      memory_in_use_(0),
+      cancelled_(false) {
+  for (size_t i = 0;  i < generators.size();  ++i) {
+    Job* job = new Job(generators[i]);
+    job->memory_estimate = kTransformMemoryPerByte *
+        (generators[i]->old_element()->region().length() +
+         generators[i]->new_element()->region().length());
+    jobs_.push_back(job);
+  }
+
+  if (max_threads > 1) {
+    num_threads_ = static_cast<int>(
+        std::min(static_cast<size_t>(max_threads), jobs_.size()));
+  }
+}
+
+ElementTransformer::~ElementTransformer() {
+  {
+    base::AutoLock auto_lock(lock_);
+    cancelled_ = true;
+  }
+  condition_.Broadcast();
+  if (pool_)
+    pool_->JoinAll();
+}
+
+void ElementTransformer::Start() {
+  if (num_threads_ <= 1)
+    return;
+  pool_.reset(
+      new base::DelegateSimpleThreadPool("CourgetteTransform", num_threads_));
+  pool_->AddWork(this, num_threads_);
+  pool_->Start();
+}
+
+Status ElementTransformer::WaitForElement(size_t index) {
+  Job* job = jobs_[index];
+  if (!pool_) {
+    job->status = Transform(job);
+    job->done = true;
+    return job->status;
+  }
+
+  base::AutoLock auto_lock(lock_);
+  while (!job->done)
+    condition_.Wait();
+  return job->status;
+}
+
+void ElementTransformer::ReleaseElement(size_t index) {
+  if (!pool_)
+    return;
+
+  {
+    base::AutoLock auto_lock(lock_);
+    DCHECK(jobs_[index]->done);
+    memory_in_use_ -= jobs_[index]->memory_estimate;
+  }
+  condition_.Broadcast();
+}
+
+void ElementTransformer::Run() {
+  base::AutoLock auto_lock(lock_);
+  while (true) {
+    while (!cancelled_ && next_job_ < jobs_.size() &&
+           !FitsInBudget(jobs_[next_job_])) {
+      condition_.Wait();
+    }
+    if (cancelled_ || next_job_ == jobs_.size())
+      return;
+
+    Job* job = jobs_[next_job_++];
+    memory_in_use_ += job->memory_estimate;
+    Status status;
+    {
+      base::AutoUnlock auto_unlock(lock_);
+      status = Transform(job);
+    }
+    job->status = status;
+    job->done = true;
+    condition_.Broadcast();
+  }
+}
+
+// static
+Status ElementTransformer::Transform(Job* job) {
+  base::Time start_time = base::Time::Now();
+  Status status = job->generator->Transform(
+      &job->parameters,
+      &job->predicted_transformed_element,
+      &job->corrected_transformed_element);
+  VLOG(1) << "done Transform " << job->generator->new_element()->Name()
+          << " " << (base::Time::Now() - start_time).InSecondsF() << "s";
+  return status;
+}
+
+bool ElementTransformer::FitsInBudget(const Job* job) const {
+  return memory_in_use_ == 0 ||
+         memory_in_use_ + job->memory_estimate <= memory_budget_;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Status GenerateEnsemblePatch(SourceStream* base,
                              SourceStream* update,
                              SinkStream* final_patch) {
+  return GenerateEnsemblePatch(
+      base, update, final_patch,
+      base::SysInfo::NumberOfProcessors(),
+      static_cast<size_t>(std::min<int64>(
+          base::SysInfo::AmountOfPhysicalMemory() / 2,
+          std::numeric_limits<size_t>::max())));
+}
+
+Status GenerateEnsemblePatch(SourceStream* base,
+                             SourceStream* update,
+                             SinkStream* final_patch,
+                             int max_threads,
+                             size_t memory_budget) {
   VLOG(1) << "start GenerateEnsemblePatch";
   base::Time start_time = base::Time::Now();
 
@@ -335,26 +552,26 @@ Status GenerateEnsemblePatch(SourceStream* base,
   SinkStreamSet predicted_transformed_elements;
   SinkStreamSet corrected_transformed_elements;
 
+  ElementTransformer transformer(generators, max_threads, memory_budget);
   for (size_t i = 0;  i < number_of_transformations;  ++i) {
-    SourceStreamSet single_parameters;
-    if (!corrected_parameters_source_set.ReadSet(&single_parameters))
+    if (!corrected_parameters_source_set.ReadSet(
+            transformer.parameters(i)))
       return C_STREAM_ERROR;
-    SinkStreamSet single_predicted_transformed_element;
-    SinkStreamSet single_corrected_transformed_element;
-    Status status = generators[i]->Transform(
-        &single_parameters,
-        &single_predicted_transformed_element,
-        &single_corrected_transformed_element);
+  }
+  transformer.Start();
+  for (size_t i = 0;  i < number_of_transformations;  ++i) {
+    Status status = transformer.WaitForElement(i);
     if (status != C_OK)
       return status;
-    if (!single_parameters.Empty())
+    if (!transformer.parameters(i)->Empty())
       return C_STREAM_NOT_CONSUMED;
     if (!predicted_transformed_elements.WriteSet(
-            &single_predicted_transformed_element))
+            transformer.predicted_transformed_element(i)))
       return C_STREAM_ERROR;
     if (!corrected_transformed_elements.WriteSet(
-            &single_corrected_transformed_element))
+            transformer.corrected_transformed_element(i)))
       return C_STREAM_ERROR;
+    transformer.ReleaseElement(i);
   }
 
   if (!corrected_parameters_source_set.Empty())
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "courgette/base_test_unittest.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
@@ -11,11 +13,45 @@ class EnsembleTest : public BaseTest {
 
   void TestEnsemble(std::string src_bytes, std::string tgt_bytes) const;
 
+  // Checks that the patch does not depend on how many elements are transformed
+  // at once.
+  void TestThreadedEnsemble(std::string src_bytes,
+                            std::string tgt_bytes) const;
+
   void PeEnsemble() const;
+  void PeThreadedEnsemble() const;
   void Pe64Ensemble() const;
   void Elf32Ensemble() const;
 };
 
+// Applies |patch_bytes| to |src_bytes| with ApplyEnsemblePatchStreaming, which
+// works on files, and returns the result.
+static std::string ApplyPatchStreaming(const std::string& src_bytes,
+                                       const std::string& patch_bytes) {
+  base::ScopedTempDir temp_dir;
+  EXPECT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath old_path = temp_dir.path().AppendASCII("old");
+  base::FilePath patch_path = temp_dir.path().AppendASCII("patch");
+  base::FilePath new_path = temp_dir.path().AppendASCII("new");
+
+  EXPECT_EQ(static_cast<int>(src_bytes.size()),
+            file_util::WriteFile(old_path, src_bytes.data(),
+                                 static_cast<int>(src_bytes.size())));
+  EXPECT_EQ(static_cast<int>(patch_bytes.size()),
+            file_util::WriteFile(patch_path, patch_bytes.data(),
+                                 static_cast<int>(patch_bytes.size())));
+
+  courgette::Status status =
+      courgette::ApplyEnsemblePatchStreaming(old_path.value().c_str(),
+                                             patch_path.value().c_str(),
+                                             new_path.value().c_str());
+  EXPECT_EQ(courgette::C_OK, status);
+
+  std::string result;
+  EXPECT_TRUE(base::ReadFileToString(new_path, &result));
+  return result;
+}
+
 void EnsembleTest::TestEnsemble(std::string src_bytes,
                                 std::string tgt_bytes) const {
 
@@ -44,6 +80,49 @@ void EnsembleTest::TestEnsemble(std::string src_bytes,
   EXPECT_FALSE(memcmp(target.Buffer(),
                       patch_result.Buffer(),
                       target.OriginalLength()));
+
+  std::string patch_bytes(reinterpret_cast<const char*>(patch_sink.Buffer()),
+                          patch_sink.Length());
+  EXPECT_EQ(tgt_bytes, ApplyPatchStreaming(src_bytes, patch_bytes));
+}
+
+// Returns the patch from |src_bytes| to |tgt_bytes| generated with the given
+// limits.
+static std::string GeneratePatch(const std::string& src_bytes,
+                                 const std::string& tgt_bytes,
+                                 int max_threads,
+                                 size_t memory_budget) {
+  courgette::SourceStream source;
+  courgette::SourceStream target;
+
+  source.Init(src_bytes);
+  target.Init(tgt_bytes);
+
+  courgette::SinkStream patch_sink;
+
+  courgette::Status status = courgette::GenerateEnsemblePatch(
+      &source, &target, &patch_sink, max_threads, memory_budget);
+  EXPECT_EQ(courgette::C_OK, status);
+
+  return std::string(reinterpret_cast<const char*>(patch_sink.Buffer()),
+                     patch_sink.Length());
+}
+
+void EnsembleTest::TestThreadedEnsemble(std::string src_bytes,
+                                        std::string tgt_bytes) const {
+  std::string serial_patch = GeneratePatch(src_bytes, tgt_bytes, 1, 0);
+  EXPECT_FALSE(serial_patch.empty());
+
+  // No memory limit.
+  EXPECT_EQ(serial_patch,
+            GeneratePatch(src_bytes, tgt_bytes, 4, static_cast<size_t>(-1)));
+
+  // A budget too small for two elements, so they run one at a time.
+  EXPECT_EQ(serial_patch, GeneratePatch(src_bytes, tgt_bytes, 4, 1));
+
+  // More threads than elements.
+  EXPECT_EQ(serial_patch,
+            GeneratePatch(src_bytes, tgt_bytes, 64, static_cast<size_t>(-1)));
 }
 
 void EnsembleTest::Elf32Ensemble() const {
@@ -82,6 +161,24 @@ void EnsembleTest::PeEnsemble() const {
   TestEnsemble(src_bytes, tgt_bytes);
 }
 
+void EnsembleTest::PeThreadedEnsemble() const {
+  std::list<std::string> src_ensemble;
+  std::list<std::string> tgt_ensemble;
+
+  src_ensemble.push_back("en-US.dll");
+  src_ensemble.push_back("setup1.exe");
+  src_ensemble.push_back("elf-32-1");
+
+  tgt_ensemble.push_back("en-US.dll");
+  tgt_ensemble.push_back("setup2.exe");
+  tgt_ensemble.push_back("elf-32-2");
+
+  std::string src_bytes = FilesContents(src_ensemble);
+  std::string tgt_bytes = FilesContents(tgt_ensemble);
+
+  TestThreadedEnsemble(src_bytes, tgt_bytes);
+}
+
 void EnsembleTest::Pe64Ensemble() const {
   std::list<std::string> src_ensemble;
   std::list<std::string> tgt_ensemble;
@@ -103,6 +200,11 @@ void EnsembleTest::Pe64Ensemble() const {
   TestEnsemble(src_bytes, tgt_bytes);
 }
 
+TEST_F(EnsembleTest, NoElements) {
+  // Not executables, so the patch is a single bsdiff of the whole ensemble.
+  TestEnsemble("aaabbbcccdddeeefff", "aaagggcccdddeeefffhhh");
+}
+
 // Ensemble tests still take too long on Windows so disabling for now
 // TODO(dgarrett) http://code.google.com/p/chromium/issues/detail?id=101614
 
@@ -110,6 +212,10 @@ TEST_F(EnsembleTest, DISABLED_PE) {
   PeEnsemble();
 }
 
+TEST_F(EnsembleTest, DISABLED_PEThreaded) {
+  PeThreadedEnsemble();
+}
+
 TEST_F(EnsembleTest, DISABLED_PE64) {
   Pe64Ensemble();
 }
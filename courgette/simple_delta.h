@@ -7,6 +7,7 @@
 #ifndef COURGETTE_SIMPLE_DELTA_H_
 #define COURGETTE_SIMPLE_DELTA_H_
 
+#include "base/platform_file.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
 
@@ -15,6 +16,12 @@ namespace courgette {
 Status ApplySimpleDelta(SourceStream* old, SourceStream* delta,
                         SinkStream* target);
 
+// As ApplySimpleDelta, but appends the target to |target_file| as it is
+// produced and sets |*target_crc| to its CRC.
+Status ApplySimpleDeltaToFile(SourceStream* old, SourceStream* delta,
+                              base::PlatformFile target_file,
+                              uint32* target_crc);
+
 Status GenerateSimpleDelta(SourceStream* old, SourceStream* target,
                            SinkStream* delta);
 
@@ -329,17 +329,26 @@ void SinkStreamSet::Init(size_t stream_index_limit) {
 
 // The header for a stream set for N streams is serialized as
 //   <version><N><length1><length2>...<lengthN>
-CheckBool SinkStreamSet::CopyHeaderTo(SinkStream* header) {
+// static
+CheckBool SinkStreamSet::WriteHeader(size_t count, const size_t* lengths,
+                                     SinkStream* header) {
   bool ret = header->WriteVarint32(kStreamsSerializationFormatVersion);
   if (ret) {
-    ret = header->WriteSizeVarint32(count_);
-    for (size_t i = 0; ret && i < count_; ++i) {
-      ret = header->WriteSizeVarint32(stream(i)->Length());
+    ret = header->WriteSizeVarint32(count);
+    for (size_t i = 0; ret && i < count; ++i) {
+      ret = header->WriteSizeVarint32(lengths[i]);
     }
   }
   return ret;
 }
 
+CheckBool SinkStreamSet::CopyHeaderTo(SinkStream* header) {
+  size_t lengths[kMaxStreams];
+  for (size_t i = 0; i < count_; ++i)
+    lengths[i] = stream(i)->Length();
+  return WriteHeader(count_, lengths, header);
+}
+
 // Writes |this| to |combined_stream|.  See SourceStreamSet::Init for the layout
 // of the stream metadata and contents.
 CheckBool SinkStreamSet::CopyTo(SinkStream *combined_stream) {
@@ -223,6 +223,13 @@ class SinkStreamSet {
   // Partner to SourceStreamSet::ReadSet.
   CheckBool WriteSet(SinkStreamSet* set) WARN_UNUSED_RESULT;
 
+  // Writes the header that CopyTo puts before |count| streams with the given
+  // |lengths| to |header|.  The header followed by the stream contents in order
+  // is the layout of CopyTo, so a set can be serialized from pieces that are
+  // never all in memory at once.
+  static CheckBool WriteHeader(size_t count, const size_t* lengths,
+                               SinkStream* header) WARN_UNUSED_RESULT;
+
  private:
   CheckBool CopyHeaderTo(SinkStream* stream) WARN_UNUSED_RESULT;
 
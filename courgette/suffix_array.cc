@@ -0,0 +1,200 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/suffix_array.h"
+
+#include <vector>
+
+#include "base/logging.h"
+
+namespace courgette {
+
+namespace {
+
+// The string sorted at the top level: |text| followed by a sentinel that is
+// smaller than every byte.  Bytes are shifted up by one to make room for it.
+class ByteString {
+ public:
+  ByteString(const uint8* text, int size) : text_(text), size_(size) {}
+
+  int operator[](int i) const { return i < size_ ? text_[i] + 1 : 0; }
+
+ private:
+  const uint8* text_;
+  int size_;
+};
+
+// A window into a PagedArray<int> that starts at |offset|.  The reduced string
+// and the suffix array of each recursive step live in the suffix array of the
+// step above, so no further arrays of that size are allocated.
+class IntArrayWindow {
+ public:
+  IntArrayWindow(PagedArray<int>* array, size_t offset)
+      : array_(array), offset_(offset) {}
+
+  int& operator[](int i) const { return (*array_)[offset_ + i]; }
+
+  IntArrayWindow Subwindow(int offset) const {
+    return IntArrayWindow(array_, offset_ + offset);
+  }
+
+ private:
+  PagedArray<int>* array_;
+  size_t offset_;
+};
+
+// |stype|[i] is true if the suffix at |i| is S-type, i.e. smaller than the
+// suffix at |i| + 1, and false if it is L-type.
+typedef std::vector<bool> SuffixTypes;
+
+// Returns true if |i| is the position of a leftmost S-type suffix.
+bool IsLMS(const SuffixTypes& stype, int i) {
+  return i > 0 && stype[i] && !stype[i - 1];
+}
+
+// Sets |bucket|[c] to the start, or the end if |end| is true, of the bucket of
+// suffixes that begin with character |c|.
+template <typename String>
+void GetBuckets(const String& s, int n, int k, bool end,
+                PagedArray<int>* bucket) {
+  for (int c = 0; c <= k; ++c)
+    (*bucket)[c] = 0;
+  for (int i = 0; i < n; ++i)
+    ++(*bucket)[s[i]];
+  int sum = 0;
+  for (int c = 0; c <= k; ++c) {
+    sum += (*bucket)[c];
+    (*bucket)[c] = end ? sum : sum - (*bucket)[c];
+  }
+}
+
+// Places the L-type suffixes, scanning |sa| from the left.
+template <typename String>
+void InduceL(const String& s, const SuffixTypes& stype, IntArrayWindow sa,
+             int n, int k, PagedArray<int>* bucket) {
+  GetBuckets(s, n, k, false, bucket);
+  for (int i = 0; i < n; ++i) {
+    int j = sa[i] - 1;
+    if (j >= 0 && !stype[j])
+      sa[(*bucket)[s[j]]++] = j;
+  }
+}
+
+// Places the S-type suffixes, scanning |sa| from the right.
+template <typename String>
+void InduceS(const String& s, const SuffixTypes& stype, IntArrayWindow sa,
+             int n, int k, PagedArray<int>* bucket) {
+  GetBuckets(s, n, k, true, bucket);
+  for (int i = n - 1; i >= 0; --i) {
+    int j = sa[i] - 1;
+    if (j >= 0 && stype[j])
+      sa[--(*bucket)[s[j]]] = j;
+  }
+}
+
+// Sorts the suffixes of |s|, which has |n| characters in [0, |k|] and ends with
+// a unique 0 sentinel, into |sa|.
+template <typename String>
+bool SAIS(const String& s, IntArrayWindow sa, int n, int k) {
+  if (n == 1) {
+    sa[0] = 0;
+    return true;
+  }
+
+  SuffixTypes stype(n);
+  stype[n - 1] = true;
+  for (int i = n - 2; i >= 0; --i)
+    stype[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && stype[i + 1]);
+
+  // Sort the LMS substrings by inducing from their unsorted positions.
+  PagedArray<int> bucket;
+  if (!bucket.Allocate(k + 1))
+    return false;
+  GetBuckets(s, n, k, true, &bucket);
+  for (int i = 0; i < n; ++i)
+    sa[i] = -1;
+  for (int i = 1; i < n; ++i) {
+    if (IsLMS(stype, i))
+      sa[--bucket[s[i]]] = i;
+  }
+  InduceL(s, stype, sa, n, k, &bucket);
+  InduceS(s, stype, sa, n, k, &bucket);
+  bucket.clear();
+
+  // Move the sorted LMS substrings to the front of |sa| and name them.  Names
+  // are stored at |n1| + position / 2, which is free since no two LMS
+  // positions are adjacent.
+  int n1 = 0;
+  for (int i = 0; i < n; ++i) {
+    if (IsLMS(stype, sa[i]))
+      sa[n1++] = sa[i];
+  }
+  for (int i = n1; i < n; ++i)
+    sa[i] = -1;
+  int name = 0;
+  int prev = -1;
+  for (int i = 0; i < n1; ++i) {
+    int pos = sa[i];
+    bool diff = false;
+    for (int d = 0; d < n; ++d) {
+      if (prev == -1 || s[pos + d] != s[prev + d] ||
+          stype[pos + d] != stype[prev + d]) {
+        diff = true;
+        break;
+      }
+      if (d > 0 && (IsLMS(stype, pos + d) || IsLMS(stype, prev + d)))
+        break;
+    }
+    if (diff) {
+      ++name;
+      prev = pos;
+    }
+    sa[n1 + pos / 2] = name - 1;
+  }
+  for (int i = n - 1, j = n - 1; i >= n1; --i) {
+    if (sa[i] >= 0)
+      sa[j--] = sa[i];
+  }
+
+  // Sort the reduced string of names, recursing unless the names are unique.
+  IntArrayWindow s1 = sa.Subwindow(n - n1);
+  IntArrayWindow sa1 = sa;
+  if (name < n1) {
+    if (!SAIS(s1, sa1, n1, name - 1))
+      return false;
+  } else {
+    for (int i = 0; i < n1; ++i)
+      sa1[s1[i]] = i;
+  }
+
+  // Induce the order of all suffixes from the sorted LMS suffixes.
+  if (!bucket.Allocate(k + 1))
+    return false;
+  GetBuckets(s, n, k, true, &bucket);
+  for (int i = 1, j = 0; i < n; ++i) {
+    if (IsLMS(stype, i))
+      s1[j++] = i;
+  }
+  for (int i = 0; i < n1; ++i)
+    sa1[i] = s1[sa1[i]];
+  for (int i = n1; i < n; ++i)
+    sa[i] = -1;
+  for (int i = n1 - 1; i >= 0; --i) {
+    int j = sa[i];
+    sa[i] = -1;
+    sa[--bucket[s[j]]] = j;
+  }
+  InduceL(s, stype, sa, n, k, &bucket);
+  InduceS(s, stype, sa, n, k, &bucket);
+  return true;
+}
+
+}  // namespace
+
+bool SuffixSortSAIS(const uint8* text, int size, PagedArray<int>* sa) {
+  DCHECK_GE(size, 0);
+  return SAIS(ByteString(text, size), IntArrayWindow(sa, 0), size + 1, 256);
+}
+
+}  // namespace courgette
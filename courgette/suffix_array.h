@@ -0,0 +1,29 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COURGETTE_SUFFIX_ARRAY_H_
+#define COURGETTE_SUFFIX_ARRAY_H_
+
+#include "base/basictypes.h"
+#include "courgette/third_party/paged_array.h"
+
+namespace courgette {
+
+// Builds the suffix array of |text| in linear time with the SA-IS algorithm
+// from Nong, Zhang and Chan, "Two Efficient Algorithms for Linear Time Suffix
+// Array Construction".
+//
+// |sa| must have room for |size| + 1 elements.  On return |sa|[0] is |size|,
+// the position of the empty suffix, and |sa|[1..size] are the positions of the
+// other suffixes in lexicographic order.  This is the layout produced by
+// bsdiff's qsufsort().
+//
+// Besides |sa| the algorithm needs one bit per byte of |text|, and the bucket
+// counts of the recursive step, which are at most |size| / 2 ints.  Returns
+// false if that memory can not be allocated.
+bool SuffixSortSAIS(const uint8* text, int size, PagedArray<int>* sa);
+
+}  // namespace courgette
+
+#endif  // COURGETTE_SUFFIX_ARRAY_H_
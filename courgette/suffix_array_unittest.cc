@@ -0,0 +1,90 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/suffix_array.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Orders suffixes of |text_| by comparing them directly.
+class SuffixLess {
+ public:
+  explicit SuffixLess(const std::string& text) : text_(text) {}
+
+  bool operator()(int a, int b) const {
+    return text_.compare(a, std::string::npos,
+                         text_, b, std::string::npos) < 0;
+  }
+
+ private:
+  const std::string& text_;
+};
+
+// Checks SuffixSortSAIS() against sorting the suffixes of |text| directly.
+void TestSuffixArray(const std::string& text) {
+  const int size = static_cast<int>(text.size());
+  courgette::PagedArray<int> sa;
+  ASSERT_TRUE(sa.Allocate(size + 1));
+  ASSERT_TRUE(courgette::SuffixSortSAIS(
+      reinterpret_cast<const uint8*>(text.data()), size, &sa));
+
+  std::vector<int> expected(size);
+  for (int i = 0; i < size; ++i)
+    expected[i] = i;
+  std::sort(expected.begin(), expected.end(), SuffixLess(text));
+
+  EXPECT_EQ(size, sa[0]);
+  for (int i = 0; i < size; ++i)
+    ASSERT_EQ(expected[i], sa[i + 1]) << "at " << i;
+}
+
+std::string GenerateRandomText(size_t length, int alphabet_size, uint32 seed) {
+  std::string result;
+  while (result.length() < length) {
+    seed = seed * 1103515245 + 12345;
+    result.push_back(static_cast<char>(255 - (seed >> 16) % alphabet_size));
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(SuffixArrayTest, Empty) {
+  TestSuffixArray(std::string());
+}
+
+TEST(SuffixArrayTest, SingleCharacter) {
+  TestSuffixArray("x");
+  TestSuffixArray(std::string(1, '\0'));
+  TestSuffixArray(std::string(1, '\xff'));
+}
+
+TEST(SuffixArrayTest, Words) {
+  TestSuffixArray("banana");
+  TestSuffixArray("mississippi");
+  TestSuffixArray("abracadabra");
+  TestSuffixArray("I do not like them, Sam-I-am.");
+}
+
+TEST(SuffixArrayTest, Repeats) {
+  TestSuffixArray(std::string(1000, 'a'));
+  TestSuffixArray(std::string(1000, '\0'));
+  std::string periodic;
+  for (int i = 0; i < 1000; ++i)
+    periodic += "abaab"[i % 5];
+  TestSuffixArray(periodic);
+}
+
+TEST(SuffixArrayTest, Random) {
+  for (int alphabet_size = 1; alphabet_size <= 256; alphabet_size *= 2) {
+    for (size_t length = 0; length < 100; ++length)
+      TestSuffixArray(GenerateRandomText(length, alphabet_size, length));
+    TestSuffixArray(GenerateRandomText(5000, alphabet_size, 0));
+  }
+}
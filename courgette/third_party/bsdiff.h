@@ -39,6 +39,7 @@
 
 #include "base/basictypes.h"
 #include "base/file_util.h"
+#include "base/platform_file.h"
 
 namespace courgette {
 
@@ -54,12 +55,28 @@ enum BSDiffStatus {
 class SourceStream;
 class SinkStream;
 
+// Ways to build the suffix array of the old file.  Both give the same array,
+// and so the same patch.
+enum SuffixSortAlgorithm {
+  // Larsson and Sadakane's qsufsort, as in the original bsdiff.  Uses two ints
+  // of memory per byte of the old file.
+  SUFFIX_SORT_QSUFSORT = 0,
+  // Linear time SA-IS.  Uses a little over one int per byte.
+  SUFFIX_SORT_SAIS = 1
+};
+
 // Creates a binary patch.
 //
 BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
                                SourceStream* new_stream,
                                SinkStream* patch_stream);
 
+// As above, but with a choice of suffix sort.
+BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
+                               SourceStream* new_stream,
+                               SinkStream* patch_stream,
+                               SuffixSortAlgorithm suffix_sort);
+
 // Applies the given patch file to a given source file. This method validates
 // the CRC of the original file stored in the patch file, before applying the
 // patch to it.
@@ -73,6 +90,14 @@ BSDiffStatus ApplyBinaryPatch(const base::FilePath& old_stream,
                               const base::FilePath& patch_stream,
                               const base::FilePath& new_stream);
 
+// As above, but appends the new data to |new_file| as it is produced instead
+// of collecting it in memory.  Sets |*new_crc| to the CRC of the new data, as
+// CalculateCrc would compute it.
+BSDiffStatus ApplyBinaryPatchToFile(SourceStream* old_stream,
+                                    SourceStream* patch_stream,
+                                    base::PlatformFile new_file,
+                                    uint32* new_crc);
+
 // The following declarations are common to the patch-creation and
 // patch-application code.
 
@@ -36,12 +36,74 @@
 
 #include "courgette/third_party/bsdiff.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/files/memory_mapped_file.h"
 #include "courgette/crc.h"
 #include "courgette/streams.h"
 
 namespace courgette {
 
+namespace {
+
+// Buffers the new data of a patch and appends it to a file, keeping a running
+// CRC of what has been written.  Has the part of the SinkStream interface that
+// MBS_ApplyPatch uses.
+class FileOutput {
+ public:
+  explicit FileOutput(base::PlatformFile file)
+      : file_(file),
+        crc_(CalculateCrc(NULL, 0)),
+        buffer_(kBufferSize),
+        used_(0) {
+  }
+
+  bool Reserve(size_t length) { return true; }
+
+  bool Write(const void* data, size_t byte_count) {
+    const uint8* bytes = static_cast<const uint8*>(data);
+    while (byte_count > 0) {
+      if (used_ == kBufferSize && !Flush())
+        return false;
+      size_t count = std::min(byte_count, kBufferSize - used_);
+      memcpy(&buffer_[used_], bytes, count);
+      used_ += count;
+      bytes += count;
+      byte_count -= count;
+    }
+    return true;
+  }
+
+  // Writes out the buffered data.
+  bool Flush() {
+    if (used_ == 0)
+      return true;
+    crc_ = UpdateCrc(crc_, &buffer_[0], used_);
+    int written = base::WritePlatformFileAtCurrentPos(
+        file_, reinterpret_cast<const char*>(&buffer_[0]),
+        static_cast<int>(used_));
+    if (written != static_cast<int>(used_))
+      return false;
+    used_ = 0;
+    return true;
+  }
+
+  uint32 crc() const { return crc_; }
+
+ private:
+  static const size_t kBufferSize = 64 * 1024;
+
+  base::PlatformFile file_;
+  uint32 crc_;
+  std::vector<uint8> buffer_;
+  size_t used_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileOutput);
+};
+
+}  // namespace
+
 BSDiffStatus MBS_ReadHeader(SourceStream* stream, MBSPatchHeader* header) {
   if (!stream->Read(header->tag, sizeof(header->tag))) return READ_ERROR;
   if (!stream->ReadVarint32(&header->slen)) return READ_ERROR;
@@ -57,10 +119,12 @@ BSDiffStatus MBS_ReadHeader(SourceStream* stream, MBSPatchHeader* header) {
   return OK;
 }
 
+// |Output| is SinkStream or FileOutput.
+template <class Output>
 BSDiffStatus MBS_ApplyPatch(const MBSPatchHeader *header,
                             SourceStream* patch_stream,
                             const uint8* old_start, size_t old_size,
-                            SinkStream* new_stream) {
+                            Output* new_stream) {
   const uint8* old_end = old_start + old_size;
 
   SourceStreamSet patch_streams;
@@ -140,6 +204,11 @@ BSDiffStatus MBS_ApplyPatch(const MBSPatchHeader *header,
     old_position += seek_adjustment;
   }
 
+  // The extra bytes were read through |extra_position|, so consume them from
+  // the stream before checking that everything was used.
+  if (!extra_bytes->Skip(extra_position - extra_start))
+    return UNEXPECTED_ERROR;
+
   if (!control_stream_copy_counts->Empty() ||
       !control_stream_extra_counts->Empty() ||
       !control_stream_seeks->Empty() ||
@@ -166,8 +235,35 @@ BSDiffStatus ApplyBinaryPatch(SourceStream* old_stream,
   if (CalculateCrc(old_start, old_size) != header.scrc32)
     return CRC_ERROR;
 
-  MBS_ApplyPatch(&header, patch_stream, old_start, old_size, new_stream);
+  return MBS_ApplyPatch(&header, patch_stream, old_start, old_size,
+                        new_stream);
+}
+
+BSDiffStatus ApplyBinaryPatchToFile(SourceStream* old_stream,
+                                    SourceStream* patch_stream,
+                                    base::PlatformFile new_file,
+                                    uint32* new_crc) {
+  MBSPatchHeader header;
+  BSDiffStatus ret = MBS_ReadHeader(patch_stream, &header);
+  if (ret != OK) return ret;
+
+  const uint8* old_start = old_stream->Buffer();
+  size_t old_size = old_stream->Remaining();
+
+  if (old_size != header.slen) return UNEXPECTED_ERROR;
+
+  if (CalculateCrc(old_start, old_size) != header.scrc32)
+    return CRC_ERROR;
+
+  FileOutput new_output(new_file);
+  ret = MBS_ApplyPatch(&header, patch_stream, old_start, old_size,
+                       &new_output);
+  // FileOutput only fails to write, which MBS_ApplyPatch reports as MEM_ERROR.
+  if (ret == MEM_ERROR) return WRITE_ERROR;
+  if (ret != OK) return ret;
+  if (!new_output.Flush()) return WRITE_ERROR;
 
+  *new_crc = new_output.crc();
   return OK;
 }
 
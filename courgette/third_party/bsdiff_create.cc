@@ -34,6 +34,7 @@
 
 #include "courgette/crc.h"
 #include "courgette/streams.h"
+#include "courgette/suffix_array.h"
 #include "courgette/third_party/paged_array.h"
 
 namespace courgette {
@@ -201,7 +202,15 @@ static CheckBool WriteHeader(SinkStream* stream, MBSPatchHeader* header) {
 
 BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
                                SourceStream* new_stream,
-                               SinkStream* patch_stream)
+                               SinkStream* patch_stream) {
+  return CreateBinaryPatch(old_stream, new_stream, patch_stream,
+                           SUFFIX_SORT_SAIS);
+}
+
+BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
+                               SourceStream* new_stream,
+                               SinkStream* patch_stream,
+                               SuffixSortAlgorithm suffix_sort)
 {
   base::Time start_bsdiff_time = base::Time::Now();
   VLOG(1) << "Start bsdiff";
@@ -221,7 +230,6 @@ BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
   uint32 pending_diff_zeros = 0;
 
   PagedArray<int> I;
-  PagedArray<int> V;
 
   if (!I.Allocate(oldsize + 1)) {
     LOG(ERROR) << "Could not allocate I[], " << ((oldsize + 1) * sizeof(int))
@@ -229,17 +237,25 @@ BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
     return MEM_ERROR;
   }
 
-  if (!V.Allocate(oldsize + 1)) {
-    LOG(ERROR) << "Could not allocate V[], " << ((oldsize + 1) * sizeof(int))
-               << " bytes";
-    return MEM_ERROR;
-  }
-
   base::Time q_start_time = base::Time::Now();
-  qsufsort(I, V, old, oldsize);
-  VLOG(1) << " done qsufsort "
-          << (base::Time::Now() - q_start_time).InSecondsF();
-  V.clear();
+  if (suffix_sort == SUFFIX_SORT_SAIS) {
+    if (!SuffixSortSAIS(old, oldsize, &I)) {
+      LOG(ERROR) << "Could not allocate SA-IS buckets";
+      return MEM_ERROR;
+    }
+    VLOG(1) << " done SA-IS "
+            << (base::Time::Now() - q_start_time).InSecondsF();
+  } else {
+    PagedArray<int> V;
+    if (!V.Allocate(oldsize + 1)) {
+      LOG(ERROR) << "Could not allocate V[], " << ((oldsize + 1) * sizeof(int))
+                 << " bytes";
+      return MEM_ERROR;
+    }
+    qsufsort(I, V, old, oldsize);
+    VLOG(1) << " done qsufsort "
+            << (base::Time::Now() - q_start_time).InSecondsF();
+  }
 
   const uint8* newbuf = new_stream->Buffer();
   const int newsize = static_cast<int>(new_stream->Remaining());
@@ -17,6 +17,11 @@
 #include "crypto/scoped_nss_types.h"
 #endif
 
+#if defined(USE_OPENSSL)
+// Forward declaration for openssl/*.h
+typedef struct aes_key_st AES_KEY;
+#endif
+
 namespace crypto {
 
 class SymmetricKey;
@@ -121,6 +126,9 @@ class CRYPTO_EXPORT Encryptor {
                 const base::StringPiece& input,
                 std::string* output);
   std::string iv_;
+  // The expanded key used in CTR mode, set up once in Init() rather than on
+  // every call.
+  scoped_ptr<AES_KEY> ctr_key_;
 #elif defined(USE_NSS) || defined(OS_WIN) || defined(OS_MACOSX)
   bool Crypt(PK11Context* context,
              const base::StringPiece& input,
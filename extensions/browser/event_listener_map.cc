@@ -199,10 +199,13 @@ std::set<const EventListener*> EventListenerMap::GetEventListeners(
       interested_listeners.insert(listener);
     }
   } else {
-    ListenerList& listeners = listeners_[event.event_name];
-    for (ListenerList::const_iterator it = listeners.begin();
-         it != listeners.end(); it++) {
-      interested_listeners.insert(it->get());
+    // Don't add an empty list for events nobody listens to.
+    ListenerMap::const_iterator listeners = listeners_.find(event.event_name);
+    if (listeners != listeners_.end()) {
+      for (ListenerList::const_iterator it = listeners->second.begin();
+           it != listeners->second.end(); it++) {
+        interested_listeners.insert(it->get());
+      }
     }
   }
 
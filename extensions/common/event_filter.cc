@@ -40,8 +40,8 @@ EventFilter::EventFilter()
 
 EventFilter::~EventFilter() {
   // Normally when an event matcher entry is removed from event_matchers_ it
-  // will remove its condition sets from url_matcher_, but as url_matcher_ is
-  // being destroyed anyway there is no need to do that step here.
+  // will remove its condition sets from its URL matcher, but as the URL
+  // matchers are being destroyed anyway there is no need to do that step here.
   for (EventMatcherMultiMap::iterator it = event_matchers_.begin();
        it != event_matchers_.end(); it++) {
     for (EventMatcherMap::iterator it2 = it->second.begin();
@@ -55,9 +55,14 @@ EventFilter::MatcherID
 EventFilter::AddEventMatcher(const std::string& event_name,
                              scoped_ptr<EventMatcher> matcher) {
   MatcherID id = next_id_++;
+  linked_ptr<URLMatcher>& url_matcher = url_matchers_[event_name];
+  if (!url_matcher.get())
+    url_matcher.reset(new URLMatcher);
   URLMatcherConditionSet::Vector condition_sets;
-  if (!CreateConditionSets(id, matcher.get(), &condition_sets))
+  if (!CreateConditionSets(id, matcher.get(), url_matcher.get(),
+                           &condition_sets)) {
     return -1;
+  }
 
   for (URLMatcherConditionSet::Vector::iterator it = condition_sets.begin();
        it != condition_sets.end(); it++) {
@@ -66,7 +71,8 @@ EventFilter::AddEventMatcher(const std::string& event_name,
   }
   id_to_event_name_[id] = event_name;
   event_matchers_[event_name][id] = linked_ptr<EventMatcherEntry>(
-      new EventMatcherEntry(matcher.Pass(), &url_matcher_, condition_sets));
+      new EventMatcherEntry(matcher.Pass(), url_matcher.get(),
+                            condition_sets));
   return id;
 }
 
@@ -84,18 +90,20 @@ const std::string& EventFilter::GetEventName(MatcherID id) {
 bool EventFilter::CreateConditionSets(
     MatcherID id,
     EventMatcher* matcher,
+    URLMatcher* url_matcher,
     URLMatcherConditionSet::Vector* condition_sets) {
   if (matcher->GetURLFilterCount() == 0) {
     // If there are no URL filters then we want to match all events, so create a
     // URLFilter from an empty dictionary.
     base::DictionaryValue empty_dict;
-    return AddDictionaryAsConditionSet(&empty_dict, condition_sets);
+    return AddDictionaryAsConditionSet(&empty_dict, url_matcher,
+                                       condition_sets);
   }
   for (int i = 0; i < matcher->GetURLFilterCount(); i++) {
     base::DictionaryValue* url_filter;
     if (!matcher->GetURLFilter(i, &url_filter))
       return false;
-    if (!AddDictionaryAsConditionSet(url_filter, condition_sets))
+    if (!AddDictionaryAsConditionSet(url_filter, url_matcher, condition_sets))
       return false;
   }
   return true;
@@ -103,17 +111,18 @@ bool EventFilter::CreateConditionSets(
 
 bool EventFilter::AddDictionaryAsConditionSet(
     base::DictionaryValue* url_filter,
+    URLMatcher* url_matcher,
     URLMatcherConditionSet::Vector* condition_sets) {
   std::string error;
   URLMatcherConditionSet::ID condition_set_id = next_condition_set_id_++;
   condition_sets->push_back(URLMatcherFactory::CreateFromURLFilterDictionary(
-      url_matcher_.condition_factory(),
+      url_matcher->condition_factory(),
       url_filter,
       condition_set_id,
       &error));
   if (!error.empty()) {
     LOG(ERROR) << "CreateFromURLFilterDictionary failed: " << error;
-    url_matcher_.ClearUnusedConditionSets();
+    url_matcher->ClearUnusedConditionSets();
     condition_sets->clear();
     return false;
   }
@@ -142,7 +151,7 @@ std::set<EventFilter::MatcherID> EventFilter::MatchEvent(
   EventMatcherMap& matcher_map = it->second;
   GURL url_to_match_against = event_info.has_url() ? event_info.url() : GURL();
   std::set<URLMatcherConditionSet::ID> matching_condition_set_ids =
-      url_matcher_.MatchURL(url_to_match_against);
+      url_matchers_[event_name]->MatchURL(url_to_match_against);
   for (std::set<URLMatcherConditionSet::ID>::iterator it =
        matching_condition_set_ids.begin();
        it != matching_condition_set_ids.end(); it++) {
@@ -155,7 +164,7 @@ std::set<EventFilter::MatcherID> EventFilter::MatchEvent(
     MatcherID id = matcher_id->second;
     EventMatcherMap::iterator matcher_entry = matcher_map.find(id);
     if (matcher_entry == matcher_map.end()) {
-      // Matcher must be for a different event.
+      // The matcher has been removed.
       continue;
     }
     const EventMatcher* event_matcher = matcher_entry->second->event_matcher();
@@ -174,6 +183,15 @@ std::set<EventFilter::MatcherID> EventFilter::MatchEvent(
   return matchers;
 }
 
+bool EventFilter::IsURLMatcherEmpty() const {
+  for (URLMatcherMap::const_iterator it = url_matchers_.begin();
+       it != url_matchers_.end(); ++it) {
+    if (!it->second->IsEmpty())
+      return false;
+  }
+  return true;
+}
+
 int EventFilter::GetMatcherCountForEvent(const std::string& name) {
   EventMatcherMultiMap::const_iterator it = event_matchers_.find(name);
   if (it == event_matchers_.end())
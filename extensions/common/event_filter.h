@@ -50,9 +50,7 @@ class EventFilter {
   int GetMatcherCountForEvent(const std::string& event_name);
 
   // For testing.
-  bool IsURLMatcherEmpty() const {
-    return url_matcher_.IsEmpty();
-  }
+  bool IsURLMatcherEmpty() const;
 
  private:
   class EventMatcherEntry {
@@ -92,18 +90,27 @@ class EventFilter {
   // Maps from event name to the map of matchers that are registered for it.
   typedef std::map<std::string, EventMatcherMap> EventMatcherMultiMap;
 
-  // Adds the list of URL filters in |matcher| to the URL matcher, having
+  // Maps from event name to the URL matcher holding the condition sets of the
+  // matchers registered for it.
+  typedef std::map<std::string, linked_ptr<url_matcher::URLMatcher> >
+      URLMatcherMap;
+
+  // Adds the list of URL filters in |matcher| to |url_matcher|, having
   // matches for those URLs map to |id|.
   bool CreateConditionSets(
       MatcherID id,
       EventMatcher* matcher,
+      url_matcher::URLMatcher* url_matcher,
       url_matcher::URLMatcherConditionSet::Vector* condition_sets);
 
   bool AddDictionaryAsConditionSet(
       base::DictionaryValue* url_filter,
+      url_matcher::URLMatcher* url_matcher,
       url_matcher::URLMatcherConditionSet::Vector* condition_sets);
 
-  url_matcher::URLMatcher url_matcher_;
+  // Each event has its own URL matcher, so matching an event only tests the
+  // URL against the filters of that event's listeners.
+  URLMatcherMap url_matchers_;
   EventMatcherMultiMap event_matchers_;
 
   // The next id to assign to an EventMatcher.
@@ -254,4 +254,22 @@ TEST_F(EventFilterUnittest,
   ASSERT_EQ(1u, matches.count(id));
 }
 
+TEST_F(EventFilterUnittest, RemovingMatchersOfOneEventKeepsOtherEvents) {
+  int id1 = event_filter_.AddEventMatcher("event1",
+                                          HostSuffixMatcher("google.com"));
+  int id2 = event_filter_.AddEventMatcher("event2",
+                                          HostSuffixMatcher("google.com"));
+  event_filter_.RemoveEventMatcher(id1);
+  ASSERT_TRUE(event_filter_.MatchEvent(
+      "event1", google_event_, MSG_ROUTING_NONE).empty());
+  std::set<int> matches = event_filter_.MatchEvent(
+      "event2", google_event_, MSG_ROUTING_NONE);
+  ASSERT_EQ(1u, matches.size());
+  ASSERT_EQ(1u, matches.count(id2));
+  ASSERT_FALSE(event_filter_.IsURLMatcherEmpty());
+
+  event_filter_.RemoveEventMatcher(id2);
+  ASSERT_TRUE(event_filter_.IsURLMatcherEmpty());
+}
+
 }  // namespace extensions
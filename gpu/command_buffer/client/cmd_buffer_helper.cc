@@ -22,12 +22,14 @@ CommandBufferHelper::CommandBufferHelper(CommandBuffer* command_buffer)
       token_(0),
       put_(0),
       last_put_sent_(0),
+      last_token_put_(-1),
 #if defined(CMD_HELPER_PERIODIC_FLUSH_CHECK)
       commands_issued_(0),
 #endif
       usable_(true),
       context_lost_(false),
       flush_automatically_(true),
+      frame_in_progress_(false),
       last_flush_time_(0) {
 }
 
@@ -117,6 +119,7 @@ bool CommandBufferHelper::AllocateRingBuffer() {
 
   total_entry_count_ = num_ring_buffer_entries;
   put_ = state.put_offset;
+  last_token_put_ = -1;
   CalcImmediateEntries(0);
   return true;
 }
@@ -150,8 +153,10 @@ bool CommandBufferHelper::FlushSync() {
   }
 
   // Wrap put_ before flush.
-  if (put_ == total_entry_count_)
+  if (put_ == total_entry_count_) {
     put_ = 0;
+    last_token_put_ = -1;
+  }
 
   last_flush_time_ = clock();
   last_put_sent_ = put_;
@@ -162,8 +167,10 @@ bool CommandBufferHelper::FlushSync() {
 
 void CommandBufferHelper::Flush() {
   // Wrap put_ before flush.
-  if (put_ == total_entry_count_)
+  if (put_ == total_entry_count_) {
     put_ = 0;
+    last_token_put_ = -1;
+  }
 
   if (usable() && last_put_sent_ != put_) {
     last_flush_time_ = clock();
@@ -176,11 +183,22 @@ void CommandBufferHelper::Flush() {
 #if defined(CMD_HELPER_PERIODIC_FLUSH_CHECK)
 void CommandBufferHelper::PeriodicFlushCheck() {
   clock_t current_time = clock();
-  if (current_time - last_flush_time_ > kPeriodicFlushDelay * CLOCKS_PER_SEC)
-    Flush();
+  if (current_time - last_flush_time_ <= kPeriodicFlushDelay * CLOCKS_PER_SEC)
+    return;
+  if (frame_in_progress_ && get_offset() != last_put_sent_)
+    return;
+  Flush();
 }
 #endif
 
+void CommandBufferHelper::BeginFrameSubmission() {
+  frame_in_progress_ = true;
+}
+
+void CommandBufferHelper::EndFrameSubmission() {
+  frame_in_progress_ = false;
+}
+
 // Calls Flush() and then waits until the buffer is empty. Break early if the
 // error is set.
 bool CommandBufferHelper::Finish() {
@@ -213,12 +231,15 @@ int32 CommandBufferHelper::InsertToken() {
     return token_;
   }
   DCHECK(HaveRingBuffer());
+  if (put_ == last_token_put_)
+    return token_;
   // Increment token as 31-bit integer. Negative values are used to signal an
   // error.
   token_ = (token_ + 1) & 0x7FFFFFFF;
   cmd::SetToken* cmd = GetCmdSpace<cmd::SetToken>();
   if (cmd) {
     cmd->Init(token_);
+    last_token_put_ = put_;
     if (token_ == 0) {
       TRACE_EVENT0("gpu", "CommandBufferHelper::InsertToken(wrapped)");
       // we wrapped
@@ -289,6 +310,7 @@ void CommandBufferHelper::WaitForAvailableEntries(int32 count) {
       num_entries -= num_to_skip;
     }
     put_ = 0;
+    last_token_put_ = -1;
   }
 
   // Try to get 'count' entries without flushing.
@@ -86,7 +86,8 @@ class GPU_EXPORT CommandBufferHelper {
   // Inserts a new token into the command buffer. This token either has a value
   // different from previously inserted tokens, or ensures that previously
   // inserted tokens with that value have already passed through the command
-  // stream.
+  // stream. If no commands were added since the last token, that token is
+  // returned instead of inserting a new one, so that several frees share it.
   // Returns:
   //   the value of the new token or -1 if the command buffer reader has
   //   shutdown.
@@ -99,6 +100,13 @@ class GPU_EXPORT CommandBufferHelper {
   //   the value of the token to wait for.
   void WaitForToken(int32 token);
 
+  // Mark the start and end of the commands of a frame. While a frame is in
+  // progress, periodic flushes are deferred until the service has caught up
+  // with the commands flushed before, as flushing earlier can't make it start
+  // on the new commands any sooner.
+  void BeginFrameSubmission();
+  void EndFrameSubmission();
+
   // Called prior to each command being issued. Waits for a certain amount of
   // space to be available. Returns address of space.
   CommandBufferEntry* GetSpace(int32 entries) {
@@ -299,6 +307,9 @@ class GPU_EXPORT CommandBufferHelper {
   int32 token_;
   int32 put_;
   int32 last_put_sent_;
+  // The put offset right after the last inserted token, or -1 if put has
+  // wrapped since.
+  int32 last_token_put_;
 
 #if defined(CMD_HELPER_PERIODIC_FLUSH_CHECK)
   int commands_issued_;
@@ -307,6 +318,7 @@ class GPU_EXPORT CommandBufferHelper {
   bool usable_;
   bool context_lost_;
   bool flush_automatically_;
+  bool frame_in_progress_;
 
   // Using C runtime instead of base because this file cannot depend on base.
   clock_t last_flush_time_;
@@ -569,6 +569,39 @@ TEST_F(CommandBufferHelperTest, TestToken) {
   EXPECT_EQ(error::kNoError, GetError());
 }
 
+// Checks that InsertToken only inserts a new token if commands were added
+// since the last one.
+TEST_F(CommandBufferHelperTest, TestTokenIsSharedWithoutNewCommands) {
+  CommandBufferEntry args[2];
+  args[0].value_uint32 = 3;
+  args[1].value_float = 4.f;
+
+  AddCommandWithExpect(error::kNoError, kUnusedCommandId + 3, 2, args);
+  int32 token1 = helper_->InsertToken();
+  CommandBufferOffset token1_put = get_helper_put();
+  int32 token2 = helper_->InsertToken();
+  EXPECT_EQ(token1, token2);
+  EXPECT_EQ(token1_put, get_helper_put());
+
+  AddCommandWithExpect(error::kNoError, kUnusedCommandId + 4, 2, args);
+  int32 token3 = helper_->InsertToken();
+  EXPECT_LT(token2, token3);
+
+  EXPECT_CALL(*api_mock_.get(), DoCommand(cmd::kSetToken, 1, _))
+      .Times(2)
+      .WillRepeatedly(DoAll(Invoke(api_mock_.get(), &AsyncAPIMock::SetToken),
+                            Return(error::kNoError)));
+  helper_->WaitForToken(token3);
+  EXPECT_EQ(token3, helper_->last_token_read());
+  helper_->Finish();
+
+  // Check that the commands did happen.
+  Mock::VerifyAndClearExpectations(api_mock_.get());
+
+  // Check the error status.
+  EXPECT_EQ(error::kNoError, GetError());
+}
+
 TEST_F(CommandBufferHelperTest, FreeRingBuffer) {
   EXPECT_TRUE(helper_->HaveRingBuffer());
 
@@ -33,6 +33,11 @@ class ContextSupport {
   virtual void SetSwapBuffersCompleteCallback(
       const base::Closure& callback) = 0;
 
+  // Mark the start and end of the commands that draw a frame, so that they
+  // can be flushed to the service in fewer, larger batches.
+  virtual void BeginFrameSubmission() = 0;
+  virtual void EndFrameSubmission() = 0;
+
  protected:
   ContextSupport() {}
   virtual ~ContextSupport() {}
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 
+#include "base/bits.h"
 #include "gpu/command_buffer/client/cmd_buffer_helper.h"
 
 namespace gpu {
@@ -36,9 +37,14 @@ const FencedAllocator::Offset FencedAllocator::kInvalidOffset;
 FencedAllocator::FencedAllocator(unsigned int size,
                                  CommandBufferHelper *helper)
     : helper_(helper),
-      bytes_in_use_(0) {
+      bytes_in_use_(0),
+      pending_block_count_(0),
+      last_token_read_at_scan_(kUnusedToken),
+      pending_blocks_added_since_scan_(false) {
+  std::fill(free_block_counts_, free_block_counts_ + kNumSizeClasses, 0u);
   Block block = { FREE, 0, RoundDown(size), kUnusedToken };
   blocks_.push_back(block);
+  AddFreeBlock(block.size);
 }
 
 FencedAllocator::~FencedAllocator() {
@@ -59,6 +65,30 @@ FencedAllocator::~FencedAllocator() {
 // optimizing what to wait for, just looks inside the block in order (first-fit
 // as well).
 FencedAllocator::Offset FencedAllocator::Alloc(unsigned int size) {
+  Offset offset = AllocWithoutWaiting(size);
+  if (offset != kInvalidOffset || size == 0 || !pending_block_count_)
+    return offset;
+
+  // Round up the allocation size to ensure alignment.
+  size = RoundUp(size);
+
+  // No free block is available. Look for blocks pending tokens, and wait for
+  // them to be re-usable.
+  for (unsigned int i = 0; i < blocks_.size(); ++i) {
+    if (blocks_[i].state != FREE_PENDING_TOKEN)
+      continue;
+    i = WaitForTokenAndFreeBlock(i);
+    if (blocks_[i].size >= size)
+      return AllocInBlock(i, size);
+  }
+  return kInvalidOffset;
+}
+
+// Same as the first half of Alloc, but the size classes of the FREE blocks
+// are checked before scanning them, since most of the blocks are typically
+// IN_USE or FREE_PENDING_TOKEN.
+FencedAllocator::Offset FencedAllocator::AllocWithoutWaiting(
+    unsigned int size) {
   // size of 0 is not allowed because it would be inconsistent to only sometimes
   // have it succeed. Example: Alloc(SizeOfBuffer), Alloc(0).
   if (size == 0)  {
@@ -68,23 +98,15 @@ FencedAllocator::Offset FencedAllocator::Alloc(unsigned int size) {
   // Round up the allocation size to ensure alignment.
   size = RoundUp(size);
 
-  // Try first to allocate in a free block.
+  if (!MayHaveFreeBlock(size))
+    return kInvalidOffset;
+
   for (unsigned int i = 0; i < blocks_.size(); ++i) {
     Block &block = blocks_[i];
     if (block.state == FREE && block.size >= size) {
       return AllocInBlock(i, size);
     }
   }
-
-  // No free block is available. Look for blocks pending tokens, and wait for
-  // them to be re-usable.
-  for (unsigned int i = 0; i < blocks_.size(); ++i) {
-    if (blocks_[i].state != FREE_PENDING_TOKEN)
-      continue;
-    i = WaitForTokenAndFreeBlock(i);
-    if (blocks_[i].size >= size)
-      return AllocInBlock(i, size);
-  }
   return kInvalidOffset;
 }
 
@@ -97,8 +119,11 @@ void FencedAllocator::Free(FencedAllocator::Offset offset) {
 
   if (block.state == IN_USE)
     bytes_in_use_ -= block.size;
+  else if (block.state == FREE_PENDING_TOKEN)
+    --pending_block_count_;
 
   block.state = FREE;
+  AddFreeBlock(block.size);
   CollapseFreeBlock(index);
 }
 
@@ -109,13 +134,18 @@ void FencedAllocator::FreePendingToken(
   Block &block = blocks_[index];
   if (block.state == IN_USE)
     bytes_in_use_ -= block.size;
+  if (block.state != FREE_PENDING_TOKEN)
+    ++pending_block_count_;
   block.state = FREE_PENDING_TOKEN;
   block.token = token;
+  pending_blocks_added_since_scan_ = true;
 }
 
 // Gets the max of the size of the blocks marked as free.
 unsigned int FencedAllocator::GetLargestFreeSize() {
   FreeUnused();
+  if (!MayHaveFreeBlock(1))
+    return 0;
   unsigned int max_size = 0;
   for (unsigned int i = 0; i < blocks_.size(); ++i) {
     Block &block = blocks_[i];
@@ -176,14 +206,20 @@ FencedAllocator::BlockIndex FencedAllocator::CollapseFreeBlock(
   if (index + 1 < blocks_.size()) {
     Block &next = blocks_[index + 1];
     if (next.state == FREE) {
+      RemoveFreeBlock(blocks_[index].size);
+      RemoveFreeBlock(next.size);
       blocks_[index].size += next.size;
+      AddFreeBlock(blocks_[index].size);
       blocks_.erase(blocks_.begin() + index + 1);
     }
   }
   if (index > 0) {
     Block &prev = blocks_[index - 1];
     if (prev.state == FREE) {
+      RemoveFreeBlock(prev.size);
+      RemoveFreeBlock(blocks_[index].size);
       prev.size += blocks_[index].size;
+      AddFreeBlock(prev.size);
       blocks_.erase(blocks_.begin() + index);
       --index;
     }
@@ -198,16 +234,29 @@ FencedAllocator::BlockIndex FencedAllocator::WaitForTokenAndFreeBlock(
   DCHECK_EQ(block.state, FREE_PENDING_TOKEN);
   helper_->WaitForToken(block.token);
   block.state = FREE;
+  --pending_block_count_;
+  AddFreeBlock(block.size);
   return CollapseFreeBlock(index);
 }
 
 // Frees any blocks pending a token for which the token has been read.
 void FencedAllocator::FreeUnused() {
+  if (!pending_block_count_)
+    return;
   int32 last_token_read = helper_->last_token_read();
-  for (unsigned int i = 0; i < blocks_.size();) {
+  // Nothing can have become free if neither the blocks pending a token nor the
+  // last token read changed since the last scan.
+  if (!pending_blocks_added_since_scan_ &&
+      last_token_read == last_token_read_at_scan_)
+    return;
+  pending_blocks_added_since_scan_ = false;
+  last_token_read_at_scan_ = last_token_read;
+  for (unsigned int i = 0; i < blocks_.size() && pending_block_count_;) {
     Block& block = blocks_[i];
     if (block.state == FREE_PENDING_TOKEN && block.token <= last_token_read) {
       block.state = FREE;
+      --pending_block_count_;
+      AddFreeBlock(block.size);
       i = CollapseFreeBlock(i);
     } else {
       ++i;
@@ -224,6 +273,7 @@ FencedAllocator::Offset FencedAllocator::AllocInBlock(BlockIndex index,
   DCHECK_EQ(block.state, FREE);
   Offset offset = block.offset;
   bytes_in_use_ += size;
+  RemoveFreeBlock(block.size);
   if (block.size == size) {
     block.state = IN_USE;
     return offset;
@@ -231,6 +281,7 @@ FencedAllocator::Offset FencedAllocator::AllocInBlock(BlockIndex index,
   Block newblock = { FREE, offset + size, block.size - size, kUnusedToken};
   block.state = IN_USE;
   block.size = size;
+  AddFreeBlock(newblock.size);
   // this is the last thing being done because it may invalidate block;
   blocks_.insert(blocks_.begin() + index + 1, newblock);
   return offset;
@@ -245,4 +296,30 @@ FencedAllocator::BlockIndex FencedAllocator::GetBlockByOffset(Offset offset) {
   return it-blocks_.begin();
 }
 
+// Blocks of size 0 only exist for buffers smaller than the alignment, and are
+// counted with the blocks of size 1.
+int FencedAllocator::GetSizeClass(unsigned int size) {
+  return std::max(base::bits::Log2Floor(size), 0);
+}
+
+void FencedAllocator::AddFreeBlock(unsigned int size) {
+  ++free_block_counts_[GetSizeClass(size)];
+}
+
+void FencedAllocator::RemoveFreeBlock(unsigned int size) {
+  int size_class = GetSizeClass(size);
+  DCHECK_GT(free_block_counts_[size_class], 0u);
+  --free_block_counts_[size_class];
+}
+
+// A block in a size class above |size|'s is certainly big enough, one in the
+// same size class may be.
+bool FencedAllocator::MayHaveFreeBlock(unsigned int size) const {
+  for (int i = GetSizeClass(size); i < kNumSizeClasses; ++i) {
+    if (free_block_counts_[i])
+      return true;
+  }
+  return false;
+}
+
 }  // namespace gpu
@@ -51,6 +51,17 @@ class GPU_EXPORT FencedAllocator {
   //   memory.
   Offset Alloc(unsigned int size);
 
+  // Allocates a block of memory only if a free block is directly available,
+  // never waiting for a token.
+  //
+  // Parameters:
+  //   size: the size of the memory block to allocate.
+  //
+  // Returns:
+  //   the offset of the allocated memory block, or kInvalidOffset if no free
+  //   block is big enough.
+  Offset AllocWithoutWaiting(unsigned int size);
+
   // Frees a block of memory.
   //
   // Parameters:
@@ -115,6 +126,19 @@ class GPU_EXPORT FencedAllocator {
 
   static const int32 kUnusedToken = 0;
 
+  // FREE blocks are counted by size class, the floor of the log2 of their
+  // size, so that Alloc can tell without scanning when no block fits.
+  enum { kNumSizeClasses = 32 };
+
+  static int GetSizeClass(unsigned int size);
+
+  // Book-keeping for blocks becoming FREE or leaving the FREE state.
+  void AddFreeBlock(unsigned int size);
+  void RemoveFreeBlock(unsigned int size);
+
+  // Returns false if no FREE block can be |size| bytes or larger.
+  bool MayHaveFreeBlock(unsigned int size) const;
+
   // Gets the index of a memory block, given its offset.
   BlockIndex GetBlockByOffset(Offset offset);
 
@@ -138,6 +162,14 @@ class GPU_EXPORT FencedAllocator {
   CommandBufferHelper *helper_;
   Container blocks_;
   size_t bytes_in_use_;
+  unsigned int free_block_counts_[kNumSizeClasses];
+
+  // Number of FREE_PENDING_TOKEN blocks. FreeUnused only scans the blocks when
+  // there are some, and when either the last token read has changed or a block
+  // was freed pending a token since the last scan.
+  unsigned int pending_block_count_;
+  int32 last_token_read_at_scan_;
+  bool pending_blocks_added_since_scan_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(FencedAllocator);
 };
@@ -167,6 +199,19 @@ class FencedAllocatorWrapper {
     return GetPointer(offset);
   }
 
+  // Allocates a block of memory only if a free block is directly available,
+  // never waiting for a token.
+  //
+  // Parameters:
+  //   size: the size of the memory block to allocate.
+  //
+  // Returns:
+  //   the pointer to the allocated memory block, or NULL if no free block is
+  //   big enough.
+  void *AllocWithoutWaiting(unsigned int size) {
+    return GetPointer(allocator_.AllocWithoutWaiting(size));
+  }
+
   // Allocates a block of memory. If the buffer is out of directly available
   // memory, this function may wait until memory that was freed "pending a
   // token" can be re-used.
@@ -4,10 +4,13 @@
 
 // This file contains the tests for the FencedAllocator class.
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/memory/aligned_memory.h"
 #include "base/message_loop/message_loop.h"
+#include "base/time/time.h"
 #include "gpu/command_buffer/client/cmd_buffer_helper.h"
 #include "gpu/command_buffer/client/fenced_allocator.h"
 #include "gpu/command_buffer/service/cmd_buffer_engine.h"
@@ -289,6 +292,66 @@ TEST_F(FencedAllocatorTest, FreeUnused) {
   EXPECT_FALSE(allocator_->InUse());
 }
 
+// Checks that AllocWithoutWaiting doesn't wait for blocks pending a token.
+TEST_F(FencedAllocatorTest, AllocWithoutWaiting) {
+  const unsigned int kSize = 16;
+  const unsigned int kAllocCount = kBufferSize / kSize;
+
+  FencedAllocator::Offset offsets[kAllocCount];
+  for (unsigned int i = 0; i < kAllocCount; ++i) {
+    offsets[i] = allocator_->AllocWithoutWaiting(kSize);
+    EXPECT_NE(FencedAllocator::kInvalidOffset, offsets[i]);
+  }
+  EXPECT_EQ(FencedAllocator::kInvalidOffset,
+            allocator_->AllocWithoutWaiting(kSize));
+
+  int32 token = helper_.get()->InsertToken();
+  allocator_->FreePendingToken(offsets[0], token);
+  EXPECT_EQ(FencedAllocator::kInvalidOffset,
+            allocator_->AllocWithoutWaiting(kSize));
+  EXPECT_GT(token, GetToken());
+
+  // Alloc waits for the token instead.
+  EXPECT_EQ(offsets[0], allocator_->Alloc(kSize));
+  EXPECT_LE(token, GetToken());
+  EXPECT_TRUE(allocator_->CheckConsistency());
+
+  // Once a block is free, the small size classes don't hide it.
+  allocator_->Free(offsets[1]);
+  EXPECT_EQ(FencedAllocator::kInvalidOffset,
+            allocator_->AllocWithoutWaiting(2 * kSize));
+  EXPECT_EQ(offsets[1], allocator_->AllocWithoutWaiting(kSize));
+
+  for (unsigned int i = 0; i < kAllocCount; ++i)
+    allocator_->Free(offsets[i]);
+  EXPECT_FALSE(allocator_->InUse());
+  EXPECT_EQ(kBufferSize, allocator_->GetLargestFreeSize());
+}
+
+// Measures the throughput of allocations that reuse blocks freed pending a
+// token, as done for every transfer buffer upload.
+TEST_F(FencedAllocatorTest, AllocThroughput) {
+  const unsigned int kSize = 16;
+  const int kIterations = 10000;
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kIterations; ++i) {
+    FencedAllocator::Offset offset = allocator_->Alloc(kSize);
+    ASSERT_NE(FencedAllocator::kInvalidOffset, offset);
+    allocator_->FreePendingToken(offset, helper_.get()->InsertToken());
+    allocator_->FreeUnused();
+  }
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+  VLOG(1) << "FencedAllocator: "
+          << kIterations / std::max(elapsed.InSecondsF(), 1e-6)
+          << " allocations per second";
+
+  EXPECT_TRUE(allocator_->CheckConsistency());
+  helper_->Finish();
+  allocator_->FreeUnused();
+  EXPECT_FALSE(allocator_->InUse());
+}
+
 // Tests GetLargestFreeSize
 TEST_F(FencedAllocatorTest, TestGetLargestFreeSize) {
   EXPECT_TRUE(allocator_->CheckConsistency());
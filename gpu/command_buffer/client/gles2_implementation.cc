@@ -2796,6 +2796,14 @@ void GLES2Implementation::SetSwapBuffersCompleteCallback(
   swap_buffers_complete_callback_ = swap_buffers_complete_callback;
 }
 
+void GLES2Implementation::BeginFrameSubmission() {
+  helper_->BeginFrameSubmission();
+}
+
+void GLES2Implementation::EndFrameSubmission() {
+  helper_->EndFrameSubmission();
+}
+
 void GLES2Implementation::OnSwapBuffersComplete() {
   if (!swap_buffers_complete_callback_.is_null())
     swap_buffers_complete_callback_.Run();
@@ -221,6 +221,8 @@ class GLES2_IMPL_EXPORT GLES2Implementation
   virtual void SetSwapBuffersCompleteCallback(
       const base::Closure& swap_buffers_complete_callback)
           OVERRIDE;
+  virtual void BeginFrameSubmission() OVERRIDE;
+  virtual void EndFrameSubmission() OVERRIDE;
 
   void GetProgramInfoCHROMIUMHelper(GLuint program, std::vector<int8>* result);
   GLint GetAttribLocationHelper(GLuint program, const char* name);
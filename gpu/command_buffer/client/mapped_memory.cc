@@ -43,14 +43,14 @@ void* MappedMemoryManager::Alloc(
   DCHECK(shm_offset);
   if (size <= allocated_memory_) {
     size_t total_bytes_in_use = 0;
-    // See if any of the chunks can satisfy this request.
+    // See if any of the chunks can satisfy this request. Chunks without a big
+    // enough free block reject the allocation without scanning their blocks.
     for (size_t ii = 0; ii < chunks_.size(); ++ii) {
       MemoryChunk* chunk = chunks_[ii];
       chunk->FreeUnused();
       total_bytes_in_use += chunk->bytes_in_use();
-      if (chunk->GetLargestFreeSizeWithoutWaiting() >= size) {
-        void* mem = chunk->Alloc(size);
-        DCHECK(mem);
+      void* mem = chunk->AllocWithoutWaiting(size);
+      if (mem) {
         *shm_id = chunk->shm_id();
         *shm_offset = chunk->GetOffset(mem);
         return mem;
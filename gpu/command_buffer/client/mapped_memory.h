@@ -55,6 +55,19 @@ class GPU_EXPORT MemoryChunk {
     return allocator_.Alloc(size);
   }
 
+  // Allocates a block of memory only if a free block is directly available,
+  // never waiting for a token.
+  //
+  // Parameters:
+  //   size: the size of the memory block to allocate.
+  //
+  // Returns:
+  //   the pointer to the allocated memory block, or NULL if no free block is
+  //   big enough.
+  void* AllocWithoutWaiting(unsigned int size) {
+    return allocator_.AllocWithoutWaiting(size);
+  }
+
   // Gets the offset to a memory block given the base memory and the address.
   // It translates NULL to FencedAllocator::kInvalidOffset.
   unsigned int GetOffset(void* pointer) {
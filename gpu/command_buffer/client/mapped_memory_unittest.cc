@@ -4,9 +4,13 @@
 
 #include "gpu/command_buffer/client/mapped_memory.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop/message_loop.h"
+#include "base/time/time.h"
 #include "gpu/command_buffer/client/cmd_buffer_helper.h"
 #include "gpu/command_buffer/service/command_buffer_service.h"
 #include "gpu/command_buffer/service/gpu_scheduler.h"
@@ -384,4 +388,42 @@ TEST_F(MappedMemoryManagerTest, MemoryLimitWithReuse) {
   EXPECT_EQ(1 * kChunkSize, manager_->allocated_memory());
 }
 
+// Measures the throughput of allocations when most chunks are full, which
+// must not require scanning the blocks of each full chunk.
+TEST_F(MappedMemoryManagerTest, AllocThroughputWithFullChunks) {
+  const unsigned int kSize = 16;
+  const size_t kNumFullChunks = 32;
+  const int kIterations = 10000;
+  manager_->set_chunk_size_multiple(kBufferSize);
+
+  std::vector<void*> full;
+  int32 id = -1;
+  unsigned int offset = 0xFFFFFFFFU;
+  for (size_t i = 0; i < kNumFullChunks * (kBufferSize / kSize); ++i) {
+    void* mem = manager_->Alloc(kSize, &id, &offset);
+    ASSERT_TRUE(mem);
+    full.push_back(mem);
+  }
+  EXPECT_EQ(kNumFullChunks, manager_->num_chunks());
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kIterations; ++i) {
+    void* mem = manager_->Alloc(kSize, &id, &offset);
+    ASSERT_TRUE(mem);
+    manager_->Free(mem);
+  }
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+  VLOG(1) << "MappedMemoryManager: "
+          << kIterations / std::max(elapsed.InSecondsF(), 1e-6)
+          << " allocations per second";
+
+  // The freed block is reused, so only one chunk was added.
+  EXPECT_EQ(kNumFullChunks + 1, manager_->num_chunks());
+
+  for (size_t i = 0; i < full.size(); ++i)
+    manager_->Free(full[i]);
+  manager_->FreeUnused();
+  EXPECT_EQ(0u, manager_->num_chunks());
+}
+
 }  // namespace gpu
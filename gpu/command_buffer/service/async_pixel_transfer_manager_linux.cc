@@ -17,16 +17,29 @@ namespace gpu {
 AsyncPixelTransferManager* AsyncPixelTransferManager::Create(
     gfx::GLContext* context) {
   TRACE_EVENT0("gpu", "AsyncPixelTransferManager::Create");
-  if (CommandLine::ForCurrentProcess()->HasSwitch(
-          switches::kEnableShareGroupAsyncTextureUpload)) {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(switches::kEnableShareGroupAsyncTextureUpload)) {
     DCHECK(context);
-    return static_cast<AsyncPixelTransferManager*> (
-        new AsyncPixelTransferManagerShareGroup(context));
+    if (AsyncPixelTransferManagerShareGroup::Initialize(context)) {
+      return static_cast<AsyncPixelTransferManager*> (
+          new AsyncPixelTransferManagerShareGroup(context));
+    }
   }
 
   switch (gfx::GetGLImplementation()) {
-    case gfx::kGLImplementationOSMesaGL:
     case gfx::kGLImplementationDesktopGL:
+      // GLX drivers share textures between threads well enough to upload
+      // them on a thread of their own, which keeps large uploads from
+      // stalling the main thread.
+      if (context &&
+          !command_line.HasSwitch(
+              switches::kDisableShareGroupAsyncTextureUpload) &&
+          AsyncPixelTransferManagerShareGroup::Initialize(context)) {
+        return static_cast<AsyncPixelTransferManager*> (
+            new AsyncPixelTransferManagerShareGroup(context));
+      }
+      return new AsyncPixelTransferManagerIdle;
+    case gfx::kGLImplementationOSMesaGL:
     case gfx::kGLImplementationEGLGLES2:
       return new AsyncPixelTransferManagerIdle;
     case gfx::kGLImplementationMockGL:
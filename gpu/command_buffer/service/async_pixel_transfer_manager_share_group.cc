@@ -32,6 +32,12 @@ namespace {
 
 const char kAsyncTransferThreadName[] = "AsyncTransferThread";
 
+// Pixels that may be queued on the upload thread at once. Beyond this, the
+// main thread waits for the oldest uploads before queuing new ones, so that
+// a page uploading faster than the thread keeps up can't queue an unbounded
+// amount of work, and memory, behind the textures it needs next.
+const uint32 kMaxPendingUploadBytes = 32 * 1024 * 1024;
+
 void PerformNotifyCompletion(
     AsyncMemoryParams mem_params,
     ScopedSafeSharedMemory* safe_shared_memory,
@@ -48,7 +54,8 @@ class TransferThread : public base::Thread {
  public:
   TransferThread()
       : base::Thread(kAsyncTransferThreadName),
-        initialized_(false) {
+        initialized_(false),
+        initialization_failed_(false) {
     Start();
 #if defined(OS_ANDROID) || defined(OS_LINUX)
     SetPriority(base::kThreadPriority_Background);
@@ -60,10 +67,12 @@ class TransferThread : public base::Thread {
     NOTREACHED();
   }
 
-  void InitializeOnMainThread(gfx::GLContext* parent_context) {
+  // Returns whether the thread has a context to upload with. A failure is
+  // not retried, as it would fail again for the next context.
+  bool InitializeOnMainThread(gfx::GLContext* parent_context) {
     TRACE_EVENT0("gpu", "TransferThread::InitializeOnMainThread");
-    if (initialized_)
-      return;
+    if (initialized_ || initialization_failed_)
+      return initialized_;
 
     base::WaitableEvent wait_for_init(true, false);
     message_loop_proxy()->PostTask(
@@ -73,6 +82,8 @@ class TransferThread : public base::Thread {
                  base::Unretained(parent_context),
                  &wait_for_init));
     wait_for_init.Wait();
+    initialization_failed_ = !initialized_;
+    return initialized_;
   }
 
   virtual void CleanUp() OVERRIDE {
@@ -86,6 +97,7 @@ class TransferThread : public base::Thread {
 
  private:
   bool initialized_;
+  bool initialization_failed_;
 
   scoped_refptr<gfx::GLSurface> surface_;
   scoped_refptr<gfx::GLContext> context_;
@@ -95,7 +107,7 @@ class TransferThread : public base::Thread {
                                    base::WaitableEvent* caller_wait) {
     TRACE_EVENT0("gpu", "InitializeOnTransferThread");
 
-    if (!parent_context) {
+    if (!parent_context || !parent_context->share_group()) {
       LOG(ERROR) << "No parent context provided.";
       caller_wait->Signal();
       return;
@@ -121,7 +133,12 @@ class TransferThread : public base::Thread {
       return;
     }
 
-    context_->MakeCurrent(surface_.get());
+    if (!context_->MakeCurrent(surface_.get())) {
+      LOG(ERROR) << "Unable to make the upload context current.";
+      context_ = NULL;
+      caller_wait->Signal();
+      return;
+    }
     initialized_ = true;
     caller_wait->Signal();
   }
@@ -172,8 +189,12 @@ class PendingTask : public base::RefCountedThreadSafe<PendingTask> {
       task_.Run();
       task_.Reset();
       glBindTexture(GL_TEXTURE_2D, 0);
-      // Flush for synchronization between threads.
-      glFlush();
+      // A flush only guarantees that the upload reaches the driver, not that
+      // other contexts see it: some desktop drivers, GLX ones in particular,
+      // only make it visible to the share group once it has completed. Wait
+      // for it here, so that the main thread never binds a partially
+      // uploaded texture and completion queries mean what they say.
+      glFinish();
       task_pending_.Signal();
     }
   }
@@ -240,6 +261,14 @@ class TransferStateInternal
     pending_upload_task_ = NULL;
   }
 
+  // Unlike WaitForTransferCompletion, doesn't run the upload on the calling
+  // thread, which may have another texture bound.
+  void WaitForUploadThread() {
+    TRACE_EVENT0("gpu", "WaitForUploadThread");
+    if (pending_upload_task_.get())
+      pending_upload_task_->WaitForTask();
+  }
+
   void CancelUpload() {
     TRACE_EVENT0("gpu", "CancelUpload");
     if (pending_upload_task_.get())
@@ -406,6 +435,7 @@ class AsyncPixelTransferDelegateShareGroup
   virtual ~AsyncPixelTransferDelegateShareGroup();
 
   void BindTransfer() { state_->BindTransfer(); }
+  void WaitForUploadThread() { state_->WaitForUploadThread(); }
 
   // Implement AsyncPixelTransferDelegate:
   virtual void AsyncTexImage2D(
@@ -419,6 +449,10 @@ class AsyncPixelTransferDelegateShareGroup
   virtual void WaitForTransferCompletion() OVERRIDE;
 
  private:
+  // Finishes the oldest uploads until there is room for |size| more bytes of
+  // pending uploads, and records this delegate's upload as pending.
+  void ThrottleUploads(uint32 size);
+
   // A raw pointer is safe because the SharedState is owned by the Manager,
   // which owns this Delegate.
   AsyncPixelTransferManagerShareGroup::SharedState* shared_state_;
@@ -474,6 +508,7 @@ void AsyncPixelTransferDelegateShareGroup::AsyncTexImage2D(
   DCHECK_EQ(static_cast<GLenum>(GL_TEXTURE_2D), tex_params.target);
   DCHECK_EQ(tex_params.level, 0);
 
+  ThrottleUploads(mem_params.shm_data_size);
   shared_state_->pending_allocations.push_back(AsWeakPtr());
   state_->ScheduleAsyncTexImage2D(tex_params,
                                   mem_params,
@@ -494,13 +529,35 @@ void AsyncPixelTransferDelegateShareGroup::AsyncTexSubImage2D(
   DCHECK_EQ(static_cast<GLenum>(GL_TEXTURE_2D), tex_params.target);
   DCHECK_EQ(tex_params.level, 0);
 
+  ThrottleUploads(mem_params.shm_data_size);
   state_->ScheduleAsyncTexSubImage2D(
       tex_params, mem_params, shared_state_->texture_upload_stats);
 }
 
+void AsyncPixelTransferDelegateShareGroup::ThrottleUploads(uint32 size) {
+  typedef AsyncPixelTransferManagerShareGroup::SharedState SharedState;
+  std::list<SharedState::PendingUpload>& pending_uploads =
+      shared_state_->pending_uploads;
+  while (!pending_uploads.empty() &&
+         shared_state_->pending_upload_bytes + size > kMaxPendingUploadBytes) {
+    SharedState::PendingUpload upload = pending_uploads.front();
+    pending_uploads.pop_front();
+    shared_state_->pending_upload_bytes -= upload.size;
+    if (upload.delegate.get() && upload.delegate->TransferIsInProgress()) {
+      TRACE_EVENT0("gpu", "AsyncPixelTransfer::ThrottleUploads");
+      upload.delegate->WaitForUploadThread();
+    }
+  }
+
+  SharedState::PendingUpload upload = { AsWeakPtr(), size };
+  pending_uploads.push_back(upload);
+  shared_state_->pending_upload_bytes += size;
+}
+
 AsyncPixelTransferManagerShareGroup::SharedState::SharedState()
     // TODO(reveman): Skip this if --enable-gpu-benchmarking is not present.
-    : texture_upload_stats(new AsyncPixelTransferUploadStats) {}
+    : texture_upload_stats(new AsyncPixelTransferUploadStats),
+      pending_upload_bytes(0) {}
 
 AsyncPixelTransferManagerShareGroup::SharedState::~SharedState() {}
 
@@ -511,7 +568,22 @@ AsyncPixelTransferManagerShareGroup::AsyncPixelTransferManagerShareGroup(
 
 AsyncPixelTransferManagerShareGroup::~AsyncPixelTransferManagerShareGroup() {}
 
+// static
+bool AsyncPixelTransferManagerShareGroup::Initialize(gfx::GLContext* context) {
+  return g_transfer_thread.Pointer()->InitializeOnMainThread(context);
+}
+
 void AsyncPixelTransferManagerShareGroup::BindCompletedAsyncTransfers() {
+  // Forget the uploads that are done. They finish in order.
+  while (!shared_state_.pending_uploads.empty()) {
+    const SharedState::PendingUpload& upload =
+        shared_state_.pending_uploads.front();
+    if (upload.delegate.get() && upload.delegate->TransferIsInProgress())
+      break;
+    shared_state_.pending_upload_bytes -= upload.size;
+    shared_state_.pending_uploads.pop_front();
+  }
+
   scoped_ptr<gfx::ScopedTextureBinder> texture_binder;
 
   while (!shared_state_.pending_allocations.empty()) {
@@ -22,6 +22,11 @@ class AsyncPixelTransferManagerShareGroup : public AsyncPixelTransferManager {
   explicit AsyncPixelTransferManagerShareGroup(gfx::GLContext* context);
   virtual ~AsyncPixelTransferManagerShareGroup();
 
+  // Starts the upload thread with a context in the share group of |context|.
+  // Returns false if the thread has no context to upload with, in which case
+  // this manager can't be used.
+  static bool Initialize(gfx::GLContext* context);
+
   // AsyncPixelTransferManager implementation:
   virtual void BindCompletedAsyncTransfers() OVERRIDE;
   virtual void AsyncNotifyCompletion(
@@ -41,6 +46,15 @@ class AsyncPixelTransferManagerShareGroup : public AsyncPixelTransferManager {
     typedef std::list<base::WeakPtr<AsyncPixelTransferDelegateShareGroup> >
         TransferQueue;
     TransferQueue pending_allocations;
+
+    // Uploads that may not have finished yet, oldest first, and the total
+    // size of their pixels.
+    struct PendingUpload {
+      base::WeakPtr<AsyncPixelTransferDelegateShareGroup> delegate;
+      uint32 size;
+    };
+    std::list<PendingUpload> pending_uploads;
+    uint32 pending_upload_bytes;
   };
 
  private:
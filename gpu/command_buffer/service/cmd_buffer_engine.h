@@ -38,6 +38,10 @@ class CommandBufferEngine {
   // Gets the "get" pointer.
   virtual int32 GetGetOffset() = 0;
 
+  // Returns whether the engine can process more commands. A command may
+  // unschedule the engine, in which case the commands after it must wait.
+  virtual bool IsScheduled() = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(CommandBufferEngine);
 };
@@ -80,6 +80,22 @@ error::Error CommandParser::ProcessCommand() {
   return result;
 }
 
+error::Error CommandParser::ProcessCommands(int num_commands) {
+  if (get_ == put_)
+    return error::kNoError;
+
+  // Commands don't wrap around the end of the buffer.
+  int num_entries = put_ < get_ ? entry_count_ - get_ : put_ - get_;
+  int entries_processed = 0;
+  error::Error result = handler_->DoCommands(
+      num_commands, buffer_ + get_, num_entries, &entries_processed);
+  if (error::IsError(result))
+    DVLOG(1) << "Error: " << result << " while processing commands";
+
+  get_ = (get_ + entries_processed) % entry_count_;
+  return result;
+}
+
 void CommandParser::ReportError(unsigned int command_id,
                                 error::Error result) {
   DVLOG(1) << "Error: " << result << " for Command "
@@ -97,4 +113,29 @@ error::Error CommandParser::ProcessAllCommands() {
   return error::kNoError;
 }
 
+error::Error AsyncAPIInterface::DoCommands(unsigned int num_commands,
+                                           const void* buffer,
+                                           int num_entries,
+                                           int* entries_processed) {
+  *entries_processed = 0;
+  if (num_commands == 0 || num_entries == 0)
+    return error::kNoError;
+
+  const CommandBufferEntry* cmd_data =
+      static_cast<const CommandBufferEntry*>(buffer);
+  CommandHeader header = cmd_data->value_header;
+  if (header.size == 0)
+    return error::kInvalidSize;
+  if (static_cast<int>(header.size) > num_entries)
+    return error::kOutOfBounds;
+
+  TRACE_EVENT0(TRACE_DISABLED_BY_DEFAULT("cb_command"),
+               GetCommandName(header.command));
+
+  error::Error result = DoCommand(header.command, header.size - 1, cmd_data);
+  if (result != error::kDeferCommandUntilLater)
+    *entries_processed = header.size;
+  return result;
+}
+
 }  // namespace gpu
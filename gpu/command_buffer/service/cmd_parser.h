@@ -19,6 +19,10 @@ class AsyncAPIInterface;
 // buffer, to implement some asynchronous RPC mechanism.
 class GPU_EXPORT CommandParser {
  public:
+  // The number of commands handed to the handler at once by the users of
+  // ProcessCommands. They check for preemption between slices.
+  static const int kParseCommandsSlice = 20;
+
   explicit CommandParser(AsyncAPIInterface* handler);
 
   // Sets the buffer to read commands from.
@@ -57,6 +61,11 @@ class GPU_EXPORT CommandParser {
   // if there are no commands in the buffer.
   error::Error ProcessCommand();
 
+  // Processes up to |num_commands| commands in one call to the handler,
+  // updating the get pointer. Stops early at the end of the buffer, or after
+  // a command that fails, is deferred or unschedules the handler's engine.
+  error::Error ProcessCommands(int num_commands);
+
   // Processes all commands until get == put.
   error::Error ProcessAllCommands();
 
@@ -91,6 +100,22 @@ class AsyncAPIInterface {
       unsigned int arg_count,
       const void* cmd_data) = 0;
 
+  // Executes up to |num_commands| commands.
+  // Parameters:
+  //    num_commands: the maximum number of commands to execute.
+  //    buffer: the first command buffer entry to process.
+  //    num_entries: the number of consecutive entries in |buffer|.
+  //    entries_processed: set to the number of entries processed.
+  // Returns:
+  //   the result of the last command executed. Processing stops after a
+  //   command that doesn't return error::kNoError. A deferred command is not
+  //   counted in |entries_processed|.
+  // The default implementation executes a single command through DoCommand.
+  virtual error::Error DoCommands(unsigned int num_commands,
+                                  const void* buffer,
+                                  int num_entries,
+                                  int* entries_processed);
+
   // Returns a name for a command. Useful for logging / debuging.
   virtual const char* GetCommandName(unsigned int command_id) const = 0;
 };
@@ -169,6 +169,45 @@ TEST_F(CommandParserTest, TestMultipleCommands) {
   Mock::VerifyAndClearExpectations(api_mock());
 }
 
+// Tests processing commands in batches through the handler's DoCommands.
+TEST_F(CommandParserTest, TestProcessCommands) {
+  scoped_ptr<CommandParser> parser(MakeParser(10));
+  CommandBufferOffset put = parser->put();
+  CommandHeader header;
+
+  header.size = 2;
+  header.command = 123;
+  buffer()[put++].value_header = header;
+  buffer()[put++].value_int32 = 5656;
+
+  CommandBufferOffset put_cmd2 = put;
+  header.size = 1;
+  header.command = 321;
+  buffer()[put++].value_header = header;
+
+  parser->set_put(put);
+
+  CommandBufferEntry param_array[1];
+  param_array[0].value_int32 = 5656;
+  AddDoCommandExpect(error::kNoError, 123, 1, param_array);
+  AddDoCommandExpect(error::kDeferCommandUntilLater, 321, 0, NULL);
+  AddDoCommandExpect(error::kNoError, 321, 0, NULL);
+
+  // The mock only executes one command per batch.
+  EXPECT_EQ(error::kNoError,
+            parser->ProcessCommands(CommandParser::kParseCommandsSlice));
+  EXPECT_EQ(put_cmd2, parser->get());
+
+  // A deferred command is executed again by the next batch.
+  EXPECT_EQ(error::kDeferCommandUntilLater,
+            parser->ProcessCommands(CommandParser::kParseCommandsSlice));
+  EXPECT_EQ(put_cmd2, parser->get());
+  EXPECT_EQ(error::kNoError,
+            parser->ProcessCommands(CommandParser::kParseCommandsSlice));
+  EXPECT_EQ(put, parser->get());
+  Mock::VerifyAndClearExpectations(api_mock());
+}
+
 // Tests that the parser will wrap correctly at the end of the buffer.
 TEST_F(CommandParserTest, TestWrap) {
   scoped_ptr<CommandParser> parser(MakeParser(5));
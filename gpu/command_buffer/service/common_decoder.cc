@@ -56,7 +56,11 @@ bool CommonDecoder::Bucket::GetAsString(std::string* str) {
   return true;
 }
 
-CommonDecoder::CommonDecoder() : engine_(NULL) {}
+CommonDecoder::CommonDecoder()
+    : engine_(NULL),
+      in_command_batch_(false),
+      has_cached_shm_buffer_(false),
+      cached_shm_id_(0) {}
 
 CommonDecoder::~CommonDecoder() {}
 
@@ -64,7 +68,7 @@ void* CommonDecoder::GetAddressAndCheckSize(unsigned int shm_id,
                                             unsigned int offset,
                                             unsigned int size) {
   CHECK(engine_);
-  Buffer buffer = engine_->GetSharedMemoryBuffer(shm_id);
+  Buffer buffer = GetSharedMemoryBuffer(shm_id);
   if (!buffer.ptr)
     return NULL;
   unsigned int end = offset + size;
@@ -75,7 +79,25 @@ void* CommonDecoder::GetAddressAndCheckSize(unsigned int shm_id,
 }
 
 Buffer CommonDecoder::GetSharedMemoryBuffer(unsigned int shm_id) {
-  return engine_->GetSharedMemoryBuffer(shm_id);
+  if (has_cached_shm_buffer_ && cached_shm_id_ == shm_id)
+    return cached_shm_buffer_;
+  Buffer buffer = engine_->GetSharedMemoryBuffer(shm_id);
+  if (in_command_batch_) {
+    has_cached_shm_buffer_ = true;
+    cached_shm_id_ = shm_id;
+    cached_shm_buffer_ = buffer;
+  }
+  return buffer;
+}
+
+void CommonDecoder::BeginCommandBatch() {
+  DCHECK(!in_command_batch_);
+  in_command_batch_ = true;
+}
+
+void CommonDecoder::EndCommandBatch() {
+  in_command_batch_ = false;
+  has_cached_shm_buffer_ = false;
 }
 
 const char* CommonDecoder::GetCommonCommandName(
@@ -151,6 +151,13 @@ class GPU_EXPORT CommonDecoder : NON_EXPORTED_BASE(public AsyncAPIInterface) {
   // Gets an name for a common command.
   const char* GetCommonCommandName(cmd::CommandId command_id) const;
 
+  // Between these calls, the shared memory buffer looked up last is reused
+  // when the next lookup is for the same ID, as consecutive commands usually
+  // refer to the same transfer buffer. Transfer buffers are only registered
+  // and destroyed between batches of commands.
+  void BeginCommandBatch();
+  void EndCommandBatch();
+
  private:
   // Generate a member function prototype for each command in an automated and
   // typesafe way.
@@ -165,6 +172,11 @@ class GPU_EXPORT CommonDecoder : NON_EXPORTED_BASE(public AsyncAPIInterface) {
 
   CommandBufferEngine* engine_;
 
+  bool in_command_batch_;
+  bool has_cached_shm_buffer_;
+  unsigned int cached_shm_id_;
+  Buffer cached_shm_buffer_;
+
   typedef std::map<uint32, linked_ptr<Bucket> > BucketMap;
   BucketMap buckets_;
 };
@@ -135,6 +135,11 @@ class MockCommandBufferEngine : public CommandBufferEngine {
     return get_offset_;
   }
 
+  // Overridden from CommandBufferEngine.
+  virtual bool IsScheduled() OVERRIDE {
+    return true;
+  }
+
  private:
   bool IsValidSharedMemoryId(int32 shm_id) {
     return shm_id == kValidShmId || shm_id == kStartValidShmId;
@@ -0,0 +1,263 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/disk_program_cache.h"
+
+#include "base/base64.h"
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/file_util.h"
+#include "base/metrics/histogram.h"
+#include "gpu/command_buffer/service/shader_manager.h"
+#include "ui/gl/gl_bindings.h"
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+const base::FilePath::CharType kCacheFileName[] =
+    FILE_PATH_LITERAL("GPUProgramCache");
+
+// Bump the version whenever the layout of the file changes.
+const uint32 kFileMagic = 0x47504331;  // 'GPC1'
+const uint32 kFileVersion = 1;
+
+// Programs are not written to the file anymore once it reaches this size.
+const int64 kDefaultMaxFileSizeBytes = 16 * 1024 * 1024;
+
+// The file is a header followed by the programs, each of which is its
+// program hash, its size and the serialized GpuProgramProto:
+//   uint32 magic, uint32 version, uint32 size, char driver[size]
+//   { char hash[kHashLength], uint32 size, char program[size] }*
+struct FileHeader {
+  uint32 magic;
+  uint32 version;
+  uint32 driver_size;
+};
+
+struct EntryHeader {
+  char hash[ProgramCache::kHashLength];
+  uint32 size;
+};
+
+const char* GetGLString(GLenum name) {
+  const char* value = reinterpret_cast<const char*>(glGetString(name));
+  return value ? value : "";
+}
+
+// Program binaries are only valid for the driver that produced them.
+std::string GetDriverIdentifier() {
+  std::string driver(GetGLString(GL_VENDOR));
+  driver += '\n';
+  driver += GetGLString(GL_RENDERER);
+  driver += '\n';
+  driver += GetGLString(GL_VERSION);
+  return driver;
+}
+
+}  // namespace
+
+DiskProgramCache::DiskProgramCache(const base::FilePath& cache_dir)
+    : file_path_(cache_dir.Append(kCacheFileName)),
+      max_file_size_bytes_(kDefaultMaxFileSizeBytes),
+      index_loaded_(false),
+      end_offset_(0) {
+}
+
+DiskProgramCache::DiskProgramCache(const base::FilePath& cache_dir,
+                                   size_t max_cache_size_bytes,
+                                   int64 max_file_size_bytes)
+    : MemoryProgramCache(max_cache_size_bytes),
+      file_path_(cache_dir.Append(kCacheFileName)),
+      max_file_size_bytes_(max_file_size_bytes),
+      index_loaded_(false),
+      end_offset_(0) {
+}
+
+DiskProgramCache::~DiskProgramCache() {}
+
+ProgramCache::ProgramLoadResult DiskProgramCache::LoadLinkedProgram(
+    GLuint program,
+    Shader* shader_a,
+    const ShaderTranslatorInterface* translator_a,
+    Shader* shader_b,
+    const ShaderTranslatorInterface* translator_b,
+    const LocationMap* bind_attrib_location_map,
+    const ShaderCacheCallback& shader_callback) {
+  EnsureIndexLoaded();
+
+  char a_sha[kHashLength];
+  char b_sha[kHashLength];
+  DCHECK(shader_a && shader_a->signature_source() &&
+         shader_b && shader_b->signature_source());
+  ComputeShaderHash(*shader_a->signature_source(), translator_a, a_sha);
+  ComputeShaderHash(*shader_b->signature_source(), translator_b, b_sha);
+  char sha[kHashLength];
+  ComputeProgramHash(a_sha, b_sha, bind_attrib_location_map, sha);
+  const std::string sha_string(sha, kHashLength);
+
+  // Bring the program into memory if only the file has it.
+  Index::const_iterator found = index_.find(sha_string);
+  if (found != index_.end() && !HasProgram(sha_string)) {
+    TRACE_EVENT0("gpu", "DiskProgramCache::LoadLinkedProgram::read");
+    std::string serialized(found->second.size, '\0');
+    if (file_.Read(found->second.offset + sizeof(EntryHeader),
+                   &serialized[0],
+                   found->second.size) == found->second.size) {
+      LoadProgram(serialized);
+    }
+  }
+
+  ProgramLoadResult result = MemoryProgramCache::LoadLinkedProgram(
+      program,
+      shader_a,
+      translator_a,
+      shader_b,
+      translator_b,
+      bind_attrib_location_map,
+      shader_callback);
+  if (found != index_.end()) {
+    UMA_HISTOGRAM_BOOLEAN("GPU.ProgramCache.DiskLoadSuccess",
+                          result == PROGRAM_LOAD_SUCCESS);
+    // Forget a stale binary so that the relinked program replaces it.
+    if (result != PROGRAM_LOAD_SUCCESS)
+      index_.erase(sha_string);
+  }
+  return result;
+}
+
+void DiskProgramCache::SaveLinkedProgram(
+    GLuint program,
+    const Shader* shader_a,
+    const ShaderTranslatorInterface* translator_a,
+    const Shader* shader_b,
+    const ShaderTranslatorInterface* translator_b,
+    const LocationMap* bind_attrib_location_map,
+    const ShaderCacheCallback& shader_callback) {
+  EnsureIndexLoaded();
+  MemoryProgramCache::SaveLinkedProgram(
+      program,
+      shader_a,
+      translator_a,
+      shader_b,
+      translator_b,
+      bind_attrib_location_map,
+      base::Bind(&DiskProgramCache::OnProgramCached,
+                 base::Unretained(this),
+                 shader_callback));
+}
+
+bool DiskProgramCache::IsProgramInBackend(const std::string& program_hash) {
+  EnsureIndexLoaded();
+  return index_.find(program_hash) != index_.end();
+}
+
+void DiskProgramCache::EnsureIndexLoaded() {
+  if (index_loaded_)
+    return;
+  index_loaded_ = true;
+  TRACE_EVENT0("gpu", "DiskProgramCache::EnsureIndexLoaded");
+
+  // The driver strings are all empty without a current context.
+  const std::string driver = GetDriverIdentifier();
+  if (driver.size() <= 2 || !base::CreateDirectory(file_path_.DirName()))
+    return;
+  file_.Initialize(file_path_,
+                   base::File::FLAG_OPEN_ALWAYS |
+                   base::File::FLAG_READ |
+                   base::File::FLAG_WRITE);
+  if (!file_.IsValid())
+    return;
+
+  FileHeader header;
+  std::string file_driver;
+  int64 length = file_.GetLength();
+  if (file_.Read(0, reinterpret_cast<char*>(&header), sizeof(header)) ==
+          static_cast<int>(sizeof(header)) &&
+      header.magic == kFileMagic &&
+      header.version == kFileVersion &&
+      header.driver_size == driver.size()) {
+    file_driver.resize(header.driver_size);
+    if (file_driver.empty() ||
+        file_.Read(sizeof(header), &file_driver[0], file_driver.size()) !=
+            static_cast<int>(file_driver.size()))
+      file_driver.clear();
+  }
+
+  if (file_driver.empty() || file_driver != driver) {
+    // Start a new file.
+    header.magic = kFileMagic;
+    header.version = kFileVersion;
+    header.driver_size = driver.size();
+    if (!file_.SetLength(0) ||
+        file_.Write(0, reinterpret_cast<const char*>(&header),
+                    sizeof(header)) != static_cast<int>(sizeof(header)) ||
+        file_.Write(sizeof(header), driver.data(), driver.size()) !=
+            static_cast<int>(driver.size())) {
+      file_.Close();
+      return;
+    }
+    end_offset_ = sizeof(header) + driver.size();
+    return;
+  }
+
+  // Only the entry headers are read here, the programs are read on demand. A
+  // truncated entry at the end, from a crash while appending, is dropped. A
+  // program appended again after its binary went stale replaces the older
+  // entry.
+  end_offset_ = sizeof(header) + driver.size();
+  EntryHeader entry_header;
+  while (end_offset_ + static_cast<int64>(sizeof(entry_header)) <= length &&
+         file_.Read(end_offset_, reinterpret_cast<char*>(&entry_header),
+                    sizeof(entry_header)) ==
+             static_cast<int>(sizeof(entry_header))) {
+    int64 entry_end = end_offset_ + sizeof(entry_header) + entry_header.size;
+    if (entry_end > length)
+      break;
+    Entry entry = { end_offset_, static_cast<int>(entry_header.size) };
+    index_[std::string(entry_header.hash, kHashLength)] = entry;
+    end_offset_ = entry_end;
+  }
+  if (length > end_offset_)
+    file_.SetLength(end_offset_);
+  UMA_HISTOGRAM_COUNTS("GPU.ProgramCache.DiskEntryCount", index_.size());
+}
+
+void DiskProgramCache::OnProgramCached(const ShaderCacheCallback& callback,
+                                       const std::string& key,
+                                       const std::string& program) {
+  if (!callback.is_null())
+    callback.Run(key, program);
+
+  std::string sha_string;
+  if (!file_.IsValid() ||
+      !base::Base64Decode(key, &sha_string) ||
+      sha_string.size() != kHashLength ||
+      index_.find(sha_string) != index_.end())
+    return;
+
+  EntryHeader entry_header;
+  memcpy(entry_header.hash, sha_string.data(), kHashLength);
+  entry_header.size = program.size();
+  int64 entry_end = end_offset_ + sizeof(entry_header) + program.size();
+  if (entry_end > max_file_size_bytes_)
+    return;
+
+  TRACE_EVENT0("gpu", "DiskProgramCache::OnProgramCached::write");
+  if (file_.Write(end_offset_, reinterpret_cast<const char*>(&entry_header),
+                  sizeof(entry_header)) !=
+          static_cast<int>(sizeof(entry_header)) ||
+      file_.Write(end_offset_ + sizeof(entry_header), program.data(),
+                  program.size()) != static_cast<int>(program.size())) {
+    file_.SetLength(end_offset_);
+    return;
+  }
+  Entry entry = { end_offset_, static_cast<int>(program.size()) };
+  index_[sha_string] = entry;
+  end_offset_ = entry_end;
+}
+
+}  // namespace gles2
+}  // namespace gpu
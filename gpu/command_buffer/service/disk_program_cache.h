@@ -0,0 +1,88 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_DISK_PROGRAM_CACHE_H_
+#define GPU_COMMAND_BUFFER_SERVICE_DISK_PROGRAM_CACHE_H_
+
+#include <string>
+
+#include "base/containers/hash_tables.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "gpu/command_buffer/service/memory_program_cache.h"
+
+namespace gpu {
+namespace gles2 {
+
+// Program cache that also keeps the linked program binaries in a file of its
+// own, so that they survive a restart of the GPU process without having to be
+// sent back by the browser. Programs are keyed by the same hash as in the
+// MemoryProgramCache, which covers the shader sources and translator options.
+// The file starts with a header identifying the driver, and a file written by
+// another driver is discarded. The index of the file is read the first time a
+// program is looked up, and each program binary is only read when first
+// needed.
+class GPU_EXPORT DiskProgramCache : public MemoryProgramCache {
+ public:
+  explicit DiskProgramCache(const base::FilePath& cache_dir);
+  DiskProgramCache(const base::FilePath& cache_dir,
+                   size_t max_cache_size_bytes,
+                   int64 max_file_size_bytes);
+  virtual ~DiskProgramCache();
+
+  virtual ProgramLoadResult LoadLinkedProgram(
+      GLuint program,
+      Shader* shader_a,
+      const ShaderTranslatorInterface* translator_a,
+      Shader* shader_b,
+      const ShaderTranslatorInterface* translator_b,
+      const LocationMap* bind_attrib_location_map,
+      const ShaderCacheCallback& shader_callback) OVERRIDE;
+  virtual void SaveLinkedProgram(
+      GLuint program,
+      const Shader* shader_a,
+      const ShaderTranslatorInterface* translator_a,
+      const Shader* shader_b,
+      const ShaderTranslatorInterface* translator_b,
+      const LocationMap* bind_attrib_location_map,
+      const ShaderCacheCallback& shader_callback) OVERRIDE;
+
+  // Used for testing.
+  size_t disk_entry_count() const { return index_.size(); }
+
+ private:
+  // Location of a serialized program in the file.
+  struct Entry {
+    int64 offset;
+    int size;
+  };
+
+  typedef base::hash_map<std::string, Entry> Index;
+
+  virtual bool IsProgramInBackend(const std::string& program_hash) OVERRIDE;
+
+  // Opens the file and reads its index, or starts a new file if it is missing
+  // or was written by another driver.
+  void EnsureIndexLoaded();
+
+  // Runs |callback| and appends |program| to the file if it isn't there yet.
+  void OnProgramCached(const ShaderCacheCallback& callback,
+                       const std::string& key,
+                       const std::string& program);
+
+  const base::FilePath file_path_;
+  const int64 max_file_size_bytes_;
+  bool index_loaded_;
+  base::File file_;
+  Index index_;
+  // Offset at which the next program is appended.
+  int64 end_offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(DiskProgramCache);
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_DISK_PROGRAM_CACHE_H_
@@ -0,0 +1,217 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/disk_program_cache.h"
+
+#include "base/files/scoped_temp_dir.h"
+#include "gpu/command_buffer/service/gl_utils.h"
+#include "gpu/command_buffer/service/shader_manager.h"
+#include "gpu/command_buffer/service/shader_translator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_mock.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+namespace gpu {
+namespace gles2 {
+
+namespace {
+
+const char kProgramBinary[] = "disk program binary";
+const GLsizei kProgramBinaryLength = sizeof(kProgramBinary);
+const GLenum kProgramBinaryFormat = 3;
+const size_t kCacheSizeBytes = 1024;
+const int64 kFileSizeBytes = 4096;
+
+void GetProgramBinary(GLuint program,
+                      GLsizei buffer_size,
+                      GLsizei* length,
+                      GLenum* format,
+                      GLvoid* binary) {
+  if (length)
+    *length = kProgramBinaryLength;
+  *format = kProgramBinaryFormat;
+  memcpy(binary, kProgramBinary, kProgramBinaryLength);
+}
+
+void ProgramBinary(GLuint program,
+                   GLenum format,
+                   const GLvoid* binary,
+                   GLsizei length) {
+  EXPECT_EQ(0, memcmp(kProgramBinary, binary, length));
+}
+
+}  // namespace
+
+class DiskProgramCacheTest : public testing::Test {
+ public:
+  static const GLuint kVertexShaderClientId = 90;
+  static const GLuint kVertexShaderServiceId = 100;
+  static const GLuint kFragmentShaderClientId = 91;
+  static const GLuint kFragmentShaderServiceId = 100;
+
+  DiskProgramCacheTest()
+      : vertex_shader_(NULL),
+        fragment_shader_(NULL) {}
+  virtual ~DiskProgramCacheTest() {
+    shader_manager_.Destroy(false);
+  }
+
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    gl_.reset(new ::testing::StrictMock<gfx::MockGLInterface>());
+    ::gfx::MockGLInterface::SetGLInterface(gl_.get());
+
+    vertex_shader_ = shader_manager_.CreateShader(kVertexShaderClientId,
+                                                  kVertexShaderServiceId,
+                                                  GL_VERTEX_SHADER);
+    fragment_shader_ = shader_manager_.CreateShader(
+        kFragmentShaderClientId,
+        kFragmentShaderServiceId,
+        GL_FRAGMENT_SHADER);
+    ASSERT_TRUE(vertex_shader_ != NULL);
+    ASSERT_TRUE(fragment_shader_ != NULL);
+
+    typedef ShaderTranslatorInterface::VariableInfo VariableInfo;
+    ShaderTranslator::VariableMap attrib_map;
+    ShaderTranslator::VariableMap uniform_map;
+    attrib_map["a"] = VariableInfo(1, 34, SH_PRECISION_LOWP, 0, "a");
+    uniform_map["b"] = VariableInfo(2, 3114, SH_PRECISION_HIGHP, 1, "b");
+    vertex_shader_->set_attrib_map(attrib_map);
+    fragment_shader_->set_uniform_map(uniform_map);
+
+    vertex_shader_->UpdateSource("bbbalsldkdkdkd");
+    fragment_shader_->UpdateSource("bbbal   sldkdkdkas 134 ad");
+    vertex_shader_->SetStatus(true, NULL, NULL);
+    fragment_shader_->SetStatus(true, NULL, NULL);
+  }
+
+  virtual void TearDown() {
+    ::gfx::MockGLInterface::SetGLInterface(NULL);
+    gl_.reset();
+  }
+
+  scoped_ptr<DiskProgramCache> CreateCache() {
+    return make_scoped_ptr(new DiskProgramCache(
+        temp_dir_.path(), kCacheSizeBytes, kFileSizeBytes));
+  }
+
+  void SetDriver(const char* renderer) {
+    EXPECT_CALL(*gl_.get(), GetString(GL_VENDOR))
+        .WillRepeatedly(Return(reinterpret_cast<const GLubyte*>("vendor")));
+    EXPECT_CALL(*gl_.get(), GetString(GL_RENDERER))
+        .WillRepeatedly(Return(reinterpret_cast<const GLubyte*>(renderer)));
+    EXPECT_CALL(*gl_.get(), GetString(GL_VERSION))
+        .WillRepeatedly(Return(reinterpret_cast<const GLubyte*>("version")));
+  }
+
+  void SaveProgram(DiskProgramCache* cache, GLuint program) {
+    EXPECT_CALL(*gl_.get(),
+                GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, _))
+        .WillOnce(SetArgPointee<2>(kProgramBinaryLength));
+    EXPECT_CALL(*gl_.get(),
+                GetProgramBinary(program, kProgramBinaryLength, _, _, _))
+        .WillOnce(Invoke(&GetProgramBinary));
+    cache->SaveLinkedProgram(program, vertex_shader_, NULL,
+                             fragment_shader_, NULL, NULL,
+                             ShaderCacheCallback());
+  }
+
+  ProgramCache::LinkedProgramStatus GetStatus(DiskProgramCache* cache) {
+    return cache->GetLinkedProgramStatus(*vertex_shader_->signature_source(),
+                                         NULL,
+                                         *fragment_shader_->signature_source(),
+                                         NULL,
+                                         NULL);
+  }
+
+  scoped_ptr< ::testing::StrictMock<gfx::MockGLInterface> > gl_;
+  base::ScopedTempDir temp_dir_;
+  ShaderManager shader_manager_;
+  Shader* vertex_shader_;
+  Shader* fragment_shader_;
+};
+
+TEST_F(DiskProgramCacheTest, ProgramSurvivesNewCache) {
+  const GLuint kProgramId = 10;
+  SetDriver("renderer");
+  scoped_ptr<DiskProgramCache> cache = CreateCache();
+  EXPECT_EQ(ProgramCache::LINK_UNKNOWN, GetStatus(cache.get()));
+  SaveProgram(cache.get(), kProgramId);
+  EXPECT_EQ(ProgramCache::LINK_SUCCEEDED, GetStatus(cache.get()));
+  EXPECT_EQ(1u, cache->disk_entry_count());
+
+  // A new cache only knows the program from the file.
+  cache = CreateCache();
+  EXPECT_EQ(ProgramCache::LINK_SUCCEEDED, GetStatus(cache.get()));
+  EXPECT_EQ(1u, cache->disk_entry_count());
+
+  ShaderTranslator::VariableMap attrib_map = vertex_shader_->attrib_map();
+  ShaderTranslator::VariableMap uniform_map = fragment_shader_->uniform_map();
+  vertex_shader_->set_attrib_map(ShaderTranslator::VariableMap());
+  fragment_shader_->set_uniform_map(ShaderTranslator::VariableMap());
+
+  EXPECT_CALL(*gl_.get(), ProgramBinary(kProgramId,
+                                        kProgramBinaryFormat,
+                                        _,
+                                        kProgramBinaryLength))
+      .WillOnce(Invoke(&ProgramBinary));
+  EXPECT_CALL(*gl_.get(), GetProgramiv(kProgramId, GL_LINK_STATUS, _))
+      .WillOnce(SetArgPointee<2>(GL_TRUE));
+  EXPECT_EQ(ProgramCache::PROGRAM_LOAD_SUCCESS,
+            cache->LoadLinkedProgram(kProgramId, vertex_shader_, NULL,
+                                     fragment_shader_, NULL, NULL,
+                                     ShaderCacheCallback()));
+  EXPECT_EQ(attrib_map.size(), vertex_shader_->attrib_map().size());
+  EXPECT_EQ(uniform_map.size(), fragment_shader_->uniform_map().size());
+
+  // Saving the program again doesn't add it to the file twice.
+  SaveProgram(cache.get(), kProgramId);
+  EXPECT_EQ(1u, cache->disk_entry_count());
+}
+
+TEST_F(DiskProgramCacheTest, DifferentDriverDiscardsFile) {
+  SetDriver("renderer");
+  scoped_ptr<DiskProgramCache> cache = CreateCache();
+  SaveProgram(cache.get(), 10);
+  EXPECT_EQ(1u, cache->disk_entry_count());
+
+  SetDriver("other renderer");
+  cache = CreateCache();
+  EXPECT_EQ(ProgramCache::LINK_UNKNOWN, GetStatus(cache.get()));
+  EXPECT_EQ(0u, cache->disk_entry_count());
+}
+
+TEST_F(DiskProgramCacheTest, StaleBinaryIsReplaced) {
+  const GLuint kProgramId = 10;
+  SetDriver("renderer");
+  scoped_ptr<DiskProgramCache> cache = CreateCache();
+  SaveProgram(cache.get(), kProgramId);
+
+  cache = CreateCache();
+  EXPECT_CALL(*gl_.get(), ProgramBinary(kProgramId, _, _, _))
+      .WillOnce(Invoke(&ProgramBinary));
+  EXPECT_CALL(*gl_.get(), GetProgramiv(kProgramId, GL_LINK_STATUS, _))
+      .WillOnce(SetArgPointee<2>(GL_FALSE));
+  EXPECT_EQ(ProgramCache::PROGRAM_LOAD_FAILURE,
+            cache->LoadLinkedProgram(kProgramId, vertex_shader_, NULL,
+                                     fragment_shader_, NULL, NULL,
+                                     ShaderCacheCallback()));
+  EXPECT_EQ(0u, cache->disk_entry_count());
+
+  // The relinked program is written to the file again.
+  SaveProgram(cache.get(), kProgramId);
+  EXPECT_EQ(1u, cache->disk_entry_count());
+  cache = CreateCache();
+  EXPECT_EQ(ProgramCache::LINK_SUCCEEDED, GetStatus(cache.get()));
+  EXPECT_EQ(1u, cache->disk_entry_count());
+}
+
+}  // namespace gles2
+}  // namespace gpu
@@ -226,26 +226,6 @@ bool ComputeDataSize(
   return true;
 }
 
-// A struct to hold info about each command.
-struct CommandInfo {
-  uint8 arg_flags;   // How to handle the arguments for this command
-  uint8 cmd_flags;   // How to handle this command
-  uint16 arg_count;  // How many arguments are expected for this command.
-};
-
-//     cmds::name::cmd_flags,
-// A table of CommandInfo for all the commands.
-const CommandInfo g_command_info[] = {
-  #define GLES2_CMD_OP(name) {                                             \
-    cmds::name::kArgFlags,                                                 \
-    cmds::name::cmd_flags,                                                 \
-    sizeof(cmds::name) / sizeof(CommandBufferEntry) - 1, },  /* NOLINT */
-
-  GLES2_COMMAND_LIST(GLES2_CMD_OP)
-
-  #undef GLES2_CMD_OP
-};
-
 // Return true if a character belongs to the ASCII subset as defined in
 // GLSL ES 1.0 spec section 3.1.
 static bool CharacterIsValidForGLES(unsigned char c) {
@@ -518,6 +498,12 @@ class GLES2DecoderImpl : public GLES2Decoder,
                           unsigned int arg_count,
                           const void* args) OVERRIDE;
 
+  // Overridden from AsyncAPIInterface.
+  virtual Error DoCommands(unsigned int num_commands,
+                           const void* buffer,
+                           int num_entries,
+                           int* entries_processed) OVERRIDE;
+
   // Overridden from AsyncAPIInterface.
   virtual const char* GetCommandName(unsigned int command_id) const OVERRIDE;
 
@@ -1170,6 +1156,13 @@ class GLES2DecoderImpl : public GLES2Decoder,
   // Wrapper for glCompileShader.
   void DoCompileShader(GLuint shader);
 
+  // Finishes a deferred compile of |shader|, if any, before its results are
+  // used.
+  void CompileShaderIfPending(Shader* shader);
+
+  ProgramManager::TranslatedShaderSourceType
+      GetTranslatedShaderSourceType() const;
+
   // Helper for DeleteSharedIdsCHROMIUM commands.
   void DoDeleteSharedIdsCHROMIUM(
       GLuint namespace_id, GLsizei n, const GLuint* ids);
@@ -1551,6 +1544,32 @@ class GLES2DecoderImpl : public GLES2Decoder,
 
   #undef GLES2_CMD_OP
 
+  typedef Error (*CommandHandler)(GLES2DecoderImpl* decoder,
+                                  uint32 immediate_data_size,
+                                  const void* cmd_data);
+
+  // Calls |Handler| with the command data cast to its command type. Using a
+  // table of these instead of a switch on the command ID lets each command
+  // be dispatched with a single indirect call.
+  template <typename T, Error (GLES2DecoderImpl::*Handler)(uint32, const T&)>
+  static Error CallHandler(GLES2DecoderImpl* decoder,
+                           uint32 immediate_data_size,
+                           const void* cmd_data) {
+    return (decoder->*Handler)(immediate_data_size,
+                               *static_cast<const T*>(cmd_data));
+  }
+
+  // A struct to hold info about each command.
+  struct CommandInfo {
+    CommandHandler handler;
+    uint8 arg_flags;   // How to handle the arguments for this command
+    uint8 cmd_flags;   // How to handle this command
+    uint16 arg_count;  // How many arguments are expected for this command.
+  };
+
+  // A table of CommandInfo for all the commands.
+  static const CommandInfo command_info[];
+
   // The GL context this decoder renders to on behalf of the client.
   scoped_refptr<gfx::GLSurface> surface_;
   scoped_refptr<gfx::GLContext> context_;
@@ -1675,6 +1694,10 @@ class GLES2DecoderImpl : public GLES2Decoder,
 
   bool compile_shader_always_succeeds_;
 
+  // Translate shaders on worker threads, and only finish compiling them when
+  // their results are needed.
+  bool defer_shader_compile_;
+
   // Log extra info.
   bool service_logging_;
 
@@ -2172,6 +2195,7 @@ GLES2DecoderImpl::GLES2DecoderImpl(ContextGroup* group)
       frag_depth_explicitly_enabled_(false),
       draw_buffers_explicitly_enabled_(false),
       compile_shader_always_succeeds_(false),
+      defer_shader_compile_(false),
       service_logging_(CommandLine::ForCurrentProcess()->HasSwitch(
           switches::kEnableGPUServiceLoggingGPU)),
       viewport_max_width_(0),
@@ -2234,6 +2258,8 @@ bool GLES2DecoderImpl::Initialize(
 
   compile_shader_always_succeeds_ = CommandLine::ForCurrentProcess()->HasSwitch(
       switches::kCompileShaderAlwaysSucceeds);
+  defer_shader_compile_ = CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kEnableDeferredShaderCompile);
 
 
   // Take ownership of the context and surface. The surface can be replaced with
@@ -3524,6 +3550,19 @@ const char* GLES2DecoderImpl::GetCommandName(unsigned int command_id) const {
 // Note: args is a pointer to the command buffer. As such, it could be changed
 // by a (malicious) client at any time, so if validation has to happen, it
 // should operate on a copy of them.
+const GLES2DecoderImpl::CommandInfo GLES2DecoderImpl::command_info[] = {
+  #define GLES2_CMD_OP(name) {                                             \
+    &GLES2DecoderImpl::CallHandler<cmds::name,                             \
+                                   &GLES2DecoderImpl::Handle ## name>,     \
+    cmds::name::kArgFlags,                                                 \
+    cmds::name::cmd_flags,                                                 \
+    sizeof(cmds::name) / sizeof(CommandBufferEntry) - 1, },  /* NOLINT */
+
+  GLES2_COMMAND_LIST(GLES2_CMD_OP)
+
+  #undef GLES2_CMD_OP
+};
+
 error::Error GLES2DecoderImpl::DoCommand(
     unsigned int command,
     unsigned int arg_count,
@@ -3536,8 +3575,8 @@ error::Error GLES2DecoderImpl::DoCommand(
                << GetCommandName(command);
   }
   unsigned int command_index = command - kStartPoint - 1;
-  if (command_index < arraysize(g_command_info)) {
-    const CommandInfo& info = g_command_info[command_index];
+  if (command_index < arraysize(command_info)) {
+    const CommandInfo& info = command_info[command_index];
     unsigned int info_arg_count = static_cast<unsigned int>(info.arg_count);
     if ((info.arg_flags == cmd::kFixed && arg_count == info_arg_count) ||
         (info.arg_flags == cmd::kAtLeastN && arg_count >= info_arg_count)) {
@@ -3551,17 +3590,7 @@ error::Error GLES2DecoderImpl::DoCommand(
 
       uint32 immediate_data_size =
           (arg_count - info_arg_count) * sizeof(CommandBufferEntry);  // NOLINT
-      switch (command) {
-        #define GLES2_CMD_OP(name)                                 \
-          case cmds::name::kCmdId:                                 \
-            result = Handle ## name(                               \
-                immediate_data_size,                               \
-                *static_cast<const gles2::cmds::name*>(cmd_data)); \
-            break;                                                 \
-
-        GLES2_COMMAND_LIST(GLES2_CMD_OP)
-        #undef GLES2_CMD_OP
-      }
+      result = info.handler(this, immediate_data_size, cmd_data);
 
       if (doing_gpu_trace)
         gpu_tracer_->End(kTraceDecoder);
@@ -3588,6 +3617,50 @@ error::Error GLES2DecoderImpl::DoCommand(
   return result;
 }
 
+error::Error GLES2DecoderImpl::DoCommands(unsigned int num_commands,
+                                          const void* buffer,
+                                          int num_entries,
+                                          int* entries_processed) {
+  const CommandBufferEntry* cmd_data =
+      static_cast<const CommandBufferEntry*>(buffer);
+  int process_pos = 0;
+  error::Error result = error::kNoError;
+
+  BeginCommandBatch();
+  for (unsigned int i = 0; i < num_commands && process_pos < num_entries;
+       ++i) {
+    CommandHeader header = cmd_data->value_header;
+    if (header.size == 0) {
+      DVLOG(1) << "Error: zero sized command in command buffer";
+      result = error::kInvalidSize;
+      break;
+    }
+    if (static_cast<int>(header.size) + process_pos > num_entries) {
+      DVLOG(1) << "Error: get offset out of bounds";
+      result = error::kOutOfBounds;
+      break;
+    }
+
+    TRACE_EVENT0(TRACE_DISABLED_BY_DEFAULT("cb_command"),
+                 GetCommandName(header.command));
+
+    // Not a virtual call, so that it can be inlined here.
+    result = GLES2DecoderImpl::DoCommand(
+        header.command, header.size - 1, cmd_data);
+    if (result == error::kDeferCommandUntilLater)
+      break;
+
+    process_pos += header.size;
+    cmd_data += header.size;
+    if (result != error::kNoError || !engine()->IsScheduled())
+      break;
+  }
+  EndCommandBatch();
+
+  *entries_processed = process_pos;
+  return result;
+}
+
 void GLES2DecoderImpl::RemoveBuffer(GLuint client_id) {
   buffer_manager()->RemoveBuffer(client_id);
 }
@@ -5430,6 +5503,8 @@ void GLES2DecoderImpl::DoLinkProgram(GLuint program_id) {
   }
 
   LogClientServiceForInfo(program, program_id, "glLinkProgram");
+  program_manager()->CompilePendingShaders(program,
+                                           GetTranslatedShaderSourceType());
   ShaderTranslator* vertex_translator = NULL;
   ShaderTranslator* fragment_translator = NULL;
   if (use_shader_translator_) {
@@ -6641,19 +6716,34 @@ void GLES2DecoderImpl::DoCompileShader(GLuint client_id) {
         vertex_translator_.get() : fragment_translator_.get();
   }
 
+  if (translator && defer_shader_compile_) {
+    program_manager()->DeferCompileShader(shader, translator);
+    return;
+  }
   program_manager()->DoCompileShader(
      shader,
      translator,
-     feature_info_->feature_flags().angle_translated_shader_source ?
-         ProgramManager::kANGLE : ProgramManager::kGL);
+     GetTranslatedShaderSourceType());
 };
 
+void GLES2DecoderImpl::CompileShaderIfPending(Shader* shader) {
+  program_manager()->CompilePendingShader(shader,
+                                          GetTranslatedShaderSourceType());
+}
+
+ProgramManager::TranslatedShaderSourceType
+GLES2DecoderImpl::GetTranslatedShaderSourceType() const {
+  return feature_info_->feature_flags().angle_translated_shader_source ?
+      ProgramManager::kANGLE : ProgramManager::kGL;
+}
+
 void GLES2DecoderImpl::DoGetShaderiv(
     GLuint shader_id, GLenum pname, GLint* params) {
   Shader* shader = GetShaderInfoNotProgram(shader_id, "glGetShaderiv");
   if (!shader) {
     return;
   }
+  CompileShaderIfPending(shader);
   switch (pname) {
     case GL_SHADER_SOURCE_LENGTH:
       *params = shader->source() ? shader->source()->size() + 1 : 0;
@@ -6700,6 +6790,7 @@ error::Error GLES2DecoderImpl::HandleGetTranslatedShaderSourceANGLE(
     bucket->SetSize(0);
     return error::kNoError;
   }
+  CompileShaderIfPending(shader);
 
   bucket->SetFromString(shader->translated_source() ?
       shader->translated_source()->c_str() : NULL);
@@ -6727,6 +6818,8 @@ error::Error GLES2DecoderImpl::HandleGetShaderInfoLog(
   uint32 bucket_id = static_cast<uint32>(c.bucket_id);
   Bucket* bucket = CreateBucket(bucket_id);
   Shader* shader = GetShaderInfoNotProgram(shader_id, "glGetShaderInfoLog");
+  if (shader)
+    CompileShaderIfPending(shader);
   if (!shader || !shader->log_info()) {
     bucket->SetFromString("");
     return error::kNoError;
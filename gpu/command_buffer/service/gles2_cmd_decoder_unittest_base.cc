@@ -1453,6 +1453,10 @@ int32 GLES2DecoderWithShaderTestBase::MockCommandBufferEngine::GetGetOffset() {
   return 0;
 }
 
+bool GLES2DecoderWithShaderTestBase::MockCommandBufferEngine::IsScheduled() {
+  return true;
+}
+
 void GLES2DecoderWithShaderTestBase::SetUp() {
   GLES2DecoderTestBase::SetUp();
   SetupDefaultProgram();
@@ -531,6 +531,9 @@ class GLES2DecoderTestBase : public testing::Test {
     // Overridden from CommandBufferEngine.
     virtual int32 GetGetOffset() OVERRIDE;
 
+    // Overridden from CommandBufferEngine.
+    virtual bool IsScheduled() OVERRIDE;
+
    private:
     scoped_ptr<int8[]> data_;
     gpu::Buffer valid_buffer_;
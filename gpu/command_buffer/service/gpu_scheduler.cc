@@ -78,18 +78,18 @@ void GpuScheduler::PutChanged() {
     DCHECK(IsScheduled());
     DCHECK(unschedule_fences_.empty());
 
-    error = parser_->ProcessCommand();
-
-    if (error == error::kDeferCommandUntilLater) {
-      DCHECK_GT(unscheduled_count_, 0);
-      break;
-    }
+    error = parser_->ProcessCommands(CommandParser::kParseCommandsSlice);
 
     // TODO(piman): various classes duplicate various pieces of state, leading
     // to needlessly complex update logic. It should be possible to simply
     // share the state across all of them.
     command_buffer_->SetGetOffset(static_cast<int32>(parser_->get()));
 
+    if (error == error::kDeferCommandUntilLater) {
+      DCHECK_GT(unscheduled_count_, 0);
+      break;
+    }
+
     if (error::IsError(error)) {
       LOG(ERROR) << "[" << decoder_ << "] "
                  << "GPU PARSE ERROR: " << error;
@@ -103,16 +103,26 @@ void GpuScheduler::PutChanged() {
 
     if (unscheduled_count_ > 0)
       break;
+
+    if (time_slice_ > base::TimeDelta() &&
+        base::TimeTicks::HighResNow() - begin_time >= time_slice_) {
+      TRACE_EVENT_INSTANT0("gpu", "GpuScheduler::TimeSliceExpired",
+                           TRACE_EVENT_SCOPE_THREAD);
+      break;
+    }
   }
 
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - begin_time;
+  processing_time_ += elapsed;
+  TRACE_COUNTER_ID1("gpu", "GpuScheduler::ProcessingTimeMs", this,
+                    processing_time_.InMilliseconds());
   if (decoder_) {
     if (!error::IsError(error) && decoder_->WasContextLost()) {
       command_buffer_->SetContextLostReason(decoder_->GetContextLostReason());
       command_buffer_->SetParseError(error::kLostContext);
     }
     decoder_->EndDecoding();
-    decoder_->AddProcessingCommandsTime(
-        base::TimeTicks::HighResNow() - begin_time);
+    decoder_->AddProcessingCommandsTime(elapsed);
   }
 }
 
@@ -15,6 +15,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/shared_memory.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "gpu/command_buffer/common/command_buffer.h"
 #include "gpu/command_buffer/service/cmd_buffer_engine.h"
 #include "gpu/command_buffer/service/cmd_parser.h"
@@ -64,6 +65,16 @@ class GPU_EXPORT GpuScheduler
     preemption_flag_ = flag;
   }
 
+  // Limits how long each call to PutChanged processes commands before
+  // returning with the rest left unprocessed, so that other contexts get to
+  // run in between. The limit is checked between slices of
+  // CommandParser::kParseCommandsSlice commands. A zero time slice,
+  // the default, processes all the commands.
+  void SetTimeSlice(base::TimeDelta time_slice) { time_slice_ = time_slice; }
+
+  // Total time spent processing the commands of this context.
+  base::TimeDelta processing_time() const { return processing_time_; }
+
   // Sets whether commands should be processed by this scheduler. Setting to
   // false unschedules. Setting to true reschedules. Whether or not the
   // scheduler is currently scheduled is "reference counted". Every call with
@@ -71,7 +82,7 @@ class GPU_EXPORT GpuScheduler
   void SetScheduled(bool is_scheduled);
 
   // Returns whether the scheduler is currently able to process more commands.
-  bool IsScheduled();
+  virtual bool IsScheduled() OVERRIDE;
 
   // Returns whether the scheduler needs to be polled again in the future.
   bool HasMoreWork();
@@ -160,6 +171,9 @@ class GPU_EXPORT GpuScheduler
   scoped_refptr<PreemptionFlag> preemption_flag_;
   bool was_preempted_;
 
+  base::TimeDelta time_slice_;
+  base::TimeDelta processing_time_;
+
   DISALLOW_COPY_AND_ASSIGN(GpuScheduler);
 };
 
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "base/message_loop/message_loop.h"
+#include "base/threading/platform_thread.h"
 #include "gpu/command_buffer/common/command_buffer_mock.h"
 #include "gpu/command_buffer/service/gles2_cmd_decoder.h"
 #include "gpu/command_buffer/service/gles2_cmd_decoder_mock.h"
@@ -18,6 +19,7 @@
 using testing::_;
 using testing::DoAll;
 using testing::Invoke;
+using testing::InvokeWithoutArgs;
 using testing::NiceMock;
 using testing::Return;
 using testing::SetArgumentPointee;
@@ -28,6 +30,10 @@ namespace gpu {
 const size_t kRingBufferSize = 1024;
 const size_t kRingBufferEntries = kRingBufferSize / sizeof(CommandBufferEntry);
 
+void SleepForTwoMilliseconds() {
+  base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(2));
+}
+
 class GpuSchedulerTest : public testing::Test {
  protected:
   static const int32 kTransferBufferId = 123;
@@ -157,6 +163,36 @@ TEST_F(GpuSchedulerTest, ProcessesTwoCommands) {
   scheduler_->PutChanged();
 }
 
+TEST_F(GpuSchedulerTest, StopsAfterTimeSlice) {
+  CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
+  header[0].command = 7;
+  header[0].size = 1;
+  header[1].command = 8;
+  header[1].size = 1;
+
+  CommandBuffer::State state;
+
+  state.put_offset = 2;
+  EXPECT_CALL(*command_buffer_, GetState())
+    .WillRepeatedly(Return(state));
+
+  // The first command takes longer than the time slice.
+  base::TimeDelta time_slice = base::TimeDelta::FromMilliseconds(1);
+  scheduler_->SetTimeSlice(time_slice);
+  EXPECT_CALL(*decoder_, DoCommand(7, 0, &buffer_[0]))
+    .WillOnce(DoAll(InvokeWithoutArgs(&SleepForTwoMilliseconds),
+                    Return(error::kNoError)));
+  EXPECT_CALL(*command_buffer_, SetGetOffset(1));
+  scheduler_->PutChanged();
+  EXPECT_GE(scheduler_->processing_time(), time_slice);
+
+  // The next call processes the rest.
+  EXPECT_CALL(*decoder_, DoCommand(8, 0, &buffer_[1]))
+    .WillOnce(Return(error::kNoError));
+  EXPECT_CALL(*command_buffer_, SetGetOffset(2));
+  scheduler_->PutChanged();
+}
+
 TEST_F(GpuSchedulerTest, SetsErrorCodeOnCommandBuffer) {
   CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
   header[0].command = 7;
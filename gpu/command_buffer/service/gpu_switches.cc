@@ -37,6 +37,11 @@ const char kEnableGPUServiceLoggingGPU[]    = "enable-gpu-service-logging";
 // Turn off gpu program caching
 const char kDisableGpuProgramCache[]        = "disable-gpu-program-cache";
 
+// Translate shaders on worker threads, and only finish compiling them when
+// their compile status or info log is queried, or a program using them is
+// linked.
+const char kEnableDeferredShaderCompile[]   = "enable-deferred-shader-compile";
+
 // Enforce GL minimums.
 const char kEnforceGLMinimums[]             = "enforce-gl-minimums";
 
@@ -57,6 +62,10 @@ const char kGpuDriverBugWorkarounds[] = "gpu-driver-bug-workarounds";
 // Sets the maximum size of the in-memory gpu program cache, in kb
 const char kGpuProgramCacheSizeKb[]         = "gpu-program-cache-size-kb";
 
+// Directory in which the GPU process keeps linked program binaries across
+// restarts.
+const char kGpuProgramCacheDir[]            = "gpu-program-cache-dir";
+
 // Disables the GPU shader on disk cache.
 const char kDisableGpuShaderDiskCache[]     = "disable-gpu-shader-disk-cache";
 
@@ -64,6 +73,11 @@ const char kDisableGpuShaderDiskCache[]     = "disable-gpu-shader-disk-cache";
 const char kEnableShareGroupAsyncTextureUpload[] =
     "enable-share-group-async-texture-upload";
 
+// Disables the async texture uploads via GL context sharing that are used by
+// default with desktop GL on Linux.
+const char kDisableShareGroupAsyncTextureUpload[] =
+    "disable-share-group-async-texture-upload";
+
 const char* kGpuSwitches[] = {
   kCompileShaderAlwaysSucceeds,
   kDisableGLErrorLimit,
@@ -74,14 +88,17 @@ const char* kGpuSwitches[] = {
   kEnableGPUDebugging,
   kEnableGPUServiceLoggingGPU,
   kDisableGpuProgramCache,
+  kEnableDeferredShaderCompile,
   kEnforceGLMinimums,
   kForceGLFinishWorkaround,
   kForceGpuMemAvailableMb,
   kForceSynchronousGLReadPixels,
   kGpuDriverBugWorkarounds,
   kGpuProgramCacheSizeKb,
+  kGpuProgramCacheDir,
   kDisableGpuShaderDiskCache,
   kEnableShareGroupAsyncTextureUpload,
+  kDisableShareGroupAsyncTextureUpload,
 };
 
 const int kNumGpuSwitches = arraysize(kGpuSwitches);
@@ -12,8 +12,19 @@
 namespace gpu {
 namespace gles2 {
 
-MailboxManager::MailboxManager()
-    : mailbox_to_textures_(std::ptr_fun(&MailboxManager::TargetNameLess)) {
+MailboxTargetName::MailboxTargetName(unsigned target, const Mailbox& mailbox)
+    : target(target),
+      mailbox(mailbox) {
+}
+
+size_t MailboxTargetName::Hash() const {
+  // Skip the first byte, which holds a checksum in debug builds.
+  uint64 prefix;
+  memcpy(&prefix, mailbox.name + 1, sizeof(prefix));
+  return base::HashPair(static_cast<uint32>(target), prefix);
+}
+
+MailboxManager::MailboxManager() {
 }
 
 MailboxManager::~MailboxManager() {
@@ -61,15 +72,5 @@ void MailboxManager::TextureDeleted(Texture* texture) {
   DCHECK_EQ(mailbox_to_textures_.size(), textures_to_mailboxes_.size());
 }
 
-MailboxManager::TargetName::TargetName(unsigned target, const Mailbox& mailbox)
-    : target(target),
-      mailbox(mailbox) {
-}
-
-bool MailboxManager::TargetNameLess(const MailboxManager::TargetName& lhs,
-                                    const MailboxManager::TargetName& rhs) {
-  return memcmp(&lhs, &rhs, sizeof(lhs)) < 0;
-}
-
 }  // namespace gles2
 }  // namespace gpu
@@ -5,9 +5,9 @@
 #ifndef GPU_COMMAND_BUFFER_SERVICE_MAILBOX_MANAGER_H_
 #define GPU_COMMAND_BUFFER_SERVICE_MAILBOX_MANAGER_H_
 
-#include <functional>
 #include <map>
 
+#include "base/containers/hash_tables.h"
 #include "base/memory/linked_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "gpu/command_buffer/common/constants.h"
@@ -22,6 +22,45 @@ namespace gles2 {
 class Texture;
 class TextureManager;
 
+// A mailbox name along with the texture target it was produced for.
+struct GPU_EXPORT MailboxTargetName {
+  MailboxTargetName(unsigned target, const Mailbox& mailbox);
+  bool operator<(const MailboxTargetName& other) const {
+    return memcmp(this, &other, sizeof other) < 0;
+  }
+  bool operator==(const MailboxTargetName& other) const {
+    return memcmp(this, &other, sizeof other) == 0;
+  }
+  // Mailbox names are random, so a few of their bytes make a good hash.
+  size_t Hash() const;
+
+  unsigned target;
+  Mailbox mailbox;
+};
+
+}  // namespace gles2
+}  // namespace gpu
+
+namespace BASE_HASH_NAMESPACE {
+#if defined(COMPILER_MSVC)
+inline size_t hash_value(const gpu::gles2::MailboxTargetName& key) {
+  return key.Hash();
+}
+#elif defined(COMPILER_GCC)
+template<>
+struct hash<gpu::gles2::MailboxTargetName> {
+  size_t operator()(const gpu::gles2::MailboxTargetName& key) const {
+    return key.Hash();
+  }
+};
+#else
+#error define a hash function for your compiler
+#endif  // COMPILER
+}  // namespace BASE_HASH_NAMESPACE
+
+namespace gpu {
+namespace gles2 {
+
 // Manages resources scoped beyond the context or context group level.
 class GPU_EXPORT MailboxManager : public base::RefCounted<MailboxManager> {
  public:
@@ -43,24 +82,16 @@ class GPU_EXPORT MailboxManager : public base::RefCounted<MailboxManager> {
 
   ~MailboxManager();
 
-  struct TargetName {
-    TargetName(unsigned target, const Mailbox& mailbox);
-    unsigned target;
-    Mailbox mailbox;
-  };
-
-  static bool TargetNameLess(const TargetName& lhs, const TargetName& rhs);
+  typedef MailboxTargetName TargetName;
 
   // This is a bidirectional map between mailbox and textures. We can have
   // multiple mailboxes per texture, but one texture per mailbox. We keep an
   // iterator in the MailboxToTextureMap to be able to manage changes to
-  // the TextureToMailboxMap efficiently.
+  // the TextureToMailboxMap efficiently. Every consume looks up the mailbox,
+  // so that side is hashed.
   typedef std::multimap<Texture*, TargetName> TextureToMailboxMap;
-  typedef std::map<TargetName,
-                   TextureToMailboxMap::iterator,
-                   std::pointer_to_binary_function<const TargetName&,
-                                                   const TargetName&,
-                                                   bool> > MailboxToTextureMap;
+  typedef base::hash_map<TargetName, TextureToMailboxMap::iterator>
+      MailboxToTextureMap;
 
   MailboxToTextureMap mailbox_to_textures_;
   TextureToMailboxMap textures_to_mailboxes_;
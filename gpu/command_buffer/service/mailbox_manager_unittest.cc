@@ -126,5 +126,26 @@ TEST_F(MailboxManagerTest, ProduceMultipleTextureMailbox) {
   EXPECT_EQ(NULL, manager_->ConsumeTexture(0, name2));
 }
 
+// Tests that mailboxes which only differ past the hashed bytes are distinct.
+TEST_F(MailboxManagerTest, SameNamePrefix) {
+  Texture* texture1 = CreateTexture();
+  Texture* texture2 = CreateTexture();
+  Mailbox name1 = Mailbox::Generate();
+  Mailbox name2 = name1;
+  name2.name[sizeof(name2.name) - 1] ^= 1;
+
+  manager_->ProduceTexture(0, name1, texture1);
+  manager_->ProduceTexture(0, name2, texture2);
+  EXPECT_EQ(texture1, manager_->ConsumeTexture(0, name1));
+  EXPECT_EQ(texture2, manager_->ConsumeTexture(0, name2));
+
+  DestroyTexture(texture1);
+  EXPECT_EQ(NULL, manager_->ConsumeTexture(0, name1));
+  EXPECT_EQ(texture2, manager_->ConsumeTexture(0, name2));
+
+  DestroyTexture(texture2);
+  EXPECT_EQ(NULL, manager_->ConsumeTexture(0, name2));
+}
+
 }  // namespace gles2
 }  // namespace gpu
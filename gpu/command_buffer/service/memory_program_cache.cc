@@ -330,6 +330,10 @@ void MemoryProgramCache::LoadProgram(const std::string& program) {
   }
 }
 
+bool MemoryProgramCache::HasProgram(const std::string& program_hash) const {
+  return store_.Peek(program_hash) != store_.end();
+}
+
 MemoryProgramCache::ProgramCacheValue::ProgramCacheValue(
     GLsizei length,
     GLenum format,
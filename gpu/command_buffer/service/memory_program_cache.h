@@ -45,6 +45,10 @@ class GPU_EXPORT MemoryProgramCache : public ProgramCache {
 
   virtual void LoadProgram(const std::string& program) OVERRIDE;
 
+ protected:
+  // Returns true if the program with |program_hash| is in memory.
+  bool HasProgram(const std::string& program_hash) const;
+
  private:
   virtual void ClearBackend() OVERRIDE;
 
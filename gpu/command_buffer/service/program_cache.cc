@@ -24,7 +24,7 @@ ProgramCache::LinkedProgramStatus ProgramCache::GetLinkedProgramStatus(
     const ShaderTranslatorInterface* translator_a,
     const std::string& untranslated_b,
     const ShaderTranslatorInterface* translator_b,
-    const std::map<std::string, GLint>* bind_attrib_location_map) const {
+    const std::map<std::string, GLint>* bind_attrib_location_map) {
   char a_sha[kHashLength];
   char b_sha[kHashLength];
   ComputeShaderHash(untranslated_a, translator_a, a_sha);
@@ -39,7 +39,8 @@ ProgramCache::LinkedProgramStatus ProgramCache::GetLinkedProgramStatus(
 
   LinkStatusMap::const_iterator found = link_status_.find(sha_string);
   if (found == link_status_.end()) {
-    return ProgramCache::LINK_UNKNOWN;
+    return IsProgramInBackend(sha_string) ? ProgramCache::LINK_SUCCEEDED
+                                          : ProgramCache::LINK_UNKNOWN;
   } else {
     return found->second;
   }
@@ -132,5 +133,9 @@ void ProgramCache::ComputeProgramHash(
                       total_size, reinterpret_cast<unsigned char*>(result));
 }
 
+bool ProgramCache::IsProgramInBackend(const std::string& program_hash) {
+  return false;
+}
+
 }  // namespace gles2
 }  // namespace gpu
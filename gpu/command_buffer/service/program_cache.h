@@ -45,7 +45,7 @@ class GPU_EXPORT ProgramCache {
       const ShaderTranslatorInterface* translator_a,
       const std::string& untranslated_shader_b,
       const ShaderTranslatorInterface* translator_b,
-      const LocationMap* bind_attrib_location_map) const;
+      const LocationMap* bind_attrib_location_map);
 
   // Loads the linked program from the cache.  If the program is not found or
   // there was an error, PROGRAM_LOAD_FAILURE should be returned.
@@ -107,6 +107,10 @@ class GPU_EXPORT ProgramCache {
   // called to clear the backend cache
   virtual void ClearBackend() = 0;
 
+  // called for programs not known to have linked, so that a backend keeping
+  // programs outside of memory can report them as linked
+  virtual bool IsProgramInBackend(const std::string& program_hash);
+
   LinkStatusMap link_status_;
 
   DISALLOW_COPY_AND_ASSIGN(ProgramCache);
@@ -23,6 +23,7 @@
 #include "gpu/command_buffer/service/program_cache.h"
 #include "gpu/command_buffer/service/shader_manager.h"
 #include "gpu/command_buffer/service/shader_translator.h"
+#include "gpu/command_buffer/service/shader_translator_cache.h"
 #include "third_party/re2/re2/re2.h"
 
 using base::TimeDelta;
@@ -464,16 +465,65 @@ void ProgramManager::DoCompileShader(
     Shader* shader,
     ShaderTranslator* translator,
     ProgramManager::TranslatedShaderSourceType translated_shader_source_type) {
+  // A compile deferred before is superseded by this one.
+  if (shader->has_pending_translation())
+    shader->TakePendingTranslation();
+
   // Translate GL ES 2.0 shader to Desktop GL shader and pass that to
   // glShaderSource and then glCompileShader.
+  scoped_refptr<ShaderTranslation> translation;
+  if (translator) {
+    const std::string* source = shader->source();
+    translation = new ShaderTranslation(translator,
+                                        source ? *source : std::string());
+    translation->Run();
+  }
+  CompileShader(shader, translation.get(), translated_shader_source_type);
+}
+
+void ProgramManager::DeferCompileShader(Shader* shader,
+                                        ShaderTranslator* translator) {
+  DCHECK(translator);
+  const std::string* source = shader->source();
+  scoped_refptr<ShaderTranslation> translation =
+      ShaderTranslatorCache::GetInstance()->GetTranslation(
+          translator, source ? *source : std::string());
+  shader->SetPendingTranslation(translator, translation.get());
+}
+
+void ProgramManager::CompilePendingShader(
+    Shader* shader,
+    ProgramManager::TranslatedShaderSourceType translated_shader_source_type) {
+  if (!shader->has_pending_translation())
+    return;
+  scoped_refptr<ShaderTranslation> translation =
+      shader->TakePendingTranslation();
+  CompileShader(shader, translation.get(), translated_shader_source_type);
+}
+
+void ProgramManager::CompilePendingShaders(
+    Program* program,
+    ProgramManager::TranslatedShaderSourceType translated_shader_source_type) {
+  for (int ii = 0; ii < Program::kMaxAttachedShaders; ++ii) {
+    Shader* shader = program->attached_shaders_[ii].get();
+    if (shader)
+      CompilePendingShader(shader, translated_shader_source_type);
+  }
+}
+
+void ProgramManager::CompileShader(
+    Shader* shader,
+    const ShaderTranslation* translation,
+    ProgramManager::TranslatedShaderSourceType translated_shader_source_type) {
   const std::string* source = shader->source();
   const char* shader_src = source ? source->c_str() : "";
-  if (translator) {
-    if (!translator->Translate(shader_src)) {
-      shader->SetStatus(false, translator->info_log(), NULL);
+  if (translation) {
+    if (!translation->success()) {
+      shader->SetStatus(false, translation->info_log(), NULL);
       return;
     }
-    shader_src = translator->translated_shader();
+    source = &translation->source();
+    shader_src = translation->translated_shader();
     if (translated_shader_source_type != kANGLE)
       shader->UpdateTranslatedSource(shader_src);
   }
@@ -497,7 +547,10 @@ void ProgramManager::DoCompileShader(
   GLint status = GL_FALSE;
   glGetShaderiv(shader->service_id(), GL_COMPILE_STATUS, &status);
   if (status) {
-    shader->SetStatus(true, "", translator);
+    if (translation)
+      shader->SetStatusFromTranslation(true, "", *translation);
+    else
+      shader->SetStatus(true, "", NULL);
   } else {
     // We cannot reach here if we are using the shader translator.
     // All invalid shaders must be rejected by the translator.
@@ -510,7 +563,7 @@ void ProgramManager::DoCompileShader(
     DCHECK(max_len == 0 || len < max_len);
     DCHECK(len == 0 || temp[len] == '\0');
     shader->SetStatus(false, std::string(temp.get(), len).c_str(), NULL);
-    LOG_IF(ERROR, translator)
+    LOG_IF(ERROR, translation)
         << "Shader translator allowed/produced an invalid shader "
         << "unless the driver is buggy:"
         << "\n--original-shader--\n" << (source ? *source : std::string())
@@ -24,6 +24,7 @@ class ProgramCache;
 class ProgramManager;
 class Shader;
 class ShaderManager;
+class ShaderTranslation;
 class ShaderTranslator;
 
 // This is used to track which attributes a particular program needs
@@ -390,6 +391,21 @@ class GPU_EXPORT ProgramManager {
       ShaderTranslator* translator,
       TranslatedShaderSourceType translated_shader_source_type);
 
+  // Starts translating the shader on a worker thread, deferring the rest of
+  // the compile until CompilePendingShader is called for it.
+  void DeferCompileShader(Shader* shader, ShaderTranslator* translator);
+
+  // Finishes a compile deferred by DeferCompileShader, if any, waiting for its
+  // translation.
+  void CompilePendingShader(
+      Shader* shader,
+      TranslatedShaderSourceType translated_shader_source_type);
+
+  // Same as CompilePendingShader for the shaders attached to |program|.
+  void CompilePendingShaders(
+      Program* program,
+      TranslatedShaderSourceType translated_shader_source_type);
+
   uint32 max_varying_vectors() const {
     return max_varying_vectors_;
   }
@@ -397,6 +413,13 @@ class GPU_EXPORT ProgramManager {
  private:
   friend class Program;
 
+  // Compiles the shader from the source |translation| translated to, or from
+  // its source as is if |translation| is NULL.
+  void CompileShader(
+      Shader* shader,
+      const ShaderTranslation* translation,
+      TranslatedShaderSourceType translated_shader_source_type);
+
   void StartTracking(Program* program);
   void StopTracking(Program* program);
 
@@ -128,6 +128,11 @@ class QueryManagerTest : public testing::Test {
       return 0;
     }
 
+    // Overridden from CommandBufferEngine.
+    virtual bool IsScheduled() OVERRIDE {
+      return true;
+    }
+
    private:
     scoped_ptr<int8[]> data_;
     gpu::Buffer valid_buffer_;
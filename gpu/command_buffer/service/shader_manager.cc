@@ -8,6 +8,7 @@
 
 #include "base/logging.h"
 #include "base/strings/string_util.h"
+#include "gpu/command_buffer/service/shader_translator_cache.h"
 
 namespace gpu {
 namespace gles2 {
@@ -20,6 +21,9 @@ Shader::Shader(GLuint service_id, GLenum shader_type)
 }
 
 Shader::~Shader() {
+  // The translation may still be using the translator.
+  if (pending_translation_.get())
+    pending_translation_->Wait();
 }
 
 void Shader::IncUseCount() {
@@ -58,6 +62,36 @@ void Shader::SetStatus(
   }
 }
 
+void Shader::SetStatusFromTranslation(
+    bool valid, const char* log, const ShaderTranslation& translation) {
+  SetStatus(valid, log, NULL);
+  if (valid) {
+    attrib_map_ = translation.attrib_map();
+    uniform_map_ = translation.uniform_map();
+    varying_map_ = translation.varying_map();
+    name_map_ = translation.name_map();
+    signature_source_.reset(new std::string(translation.source()));
+  }
+}
+
+void Shader::SetPendingTranslation(ShaderTranslator* translator,
+                                   ShaderTranslation* translation) {
+  // Let a previous translation finish before its translator may be released.
+  if (pending_translation_.get())
+    pending_translation_->Wait();
+  pending_translator_ = translator;
+  pending_translation_ = translation;
+}
+
+scoped_refptr<ShaderTranslation> Shader::TakePendingTranslation() {
+  DCHECK(pending_translation_.get());
+  pending_translation_->Wait();
+  scoped_refptr<ShaderTranslation> translation = pending_translation_;
+  pending_translation_ = NULL;
+  pending_translator_ = NULL;
+  return translation;
+}
+
 const Shader::VariableInfo*
     Shader::GetAttribInfo(
         const std::string& name) const {
@@ -18,6 +18,8 @@
 namespace gpu {
 namespace gles2 {
 
+class ShaderTranslation;
+
 // This is used to keep the source code for a shader. This is because in order
 // to emluate GLES2 the shaders will have to be re-written before passed to
 // the underlying OpenGL. But, when the user calls glGetShaderSource they
@@ -59,6 +61,24 @@ class GPU_EXPORT Shader : public base::RefCounted<Shader> {
       bool valid, const char* log,
       ShaderTranslatorInterface* translator);
 
+  // Same as SetStatus, for a compile of the source that |translation|
+  // translated.
+  void SetStatusFromTranslation(
+      bool valid, const char* log, const ShaderTranslation& translation);
+
+  // A compile whose translation may still be running on a worker thread.
+  // ProgramManager finishes it when its result is first needed. |translator|
+  // is kept alive until then.
+  void SetPendingTranslation(ShaderTranslator* translator,
+                             ShaderTranslation* translation);
+  bool has_pending_translation() const {
+    return pending_translation_.get() != NULL;
+  }
+
+  // Waits for the pending translation, and returns it so that the compile can
+  // be finished.
+  scoped_refptr<ShaderTranslation> TakePendingTranslation();
+
   const VariableInfo* GetAttribInfo(const std::string& name) const;
   const VariableInfo* GetUniformInfo(const std::string& name) const;
 
@@ -163,6 +183,9 @@ class GPU_EXPORT Shader : public base::RefCounted<Shader> {
 
   // The name hashing info when the shader was last compiled.
   NameMap name_map_;
+
+  scoped_refptr<ShaderTranslator> pending_translator_;
+  scoped_refptr<ShaderTranslation> pending_translation_;
 };
 
 // Tracks the Shaders.
@@ -12,6 +12,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
+#include "base/synchronization/lock.h"
 #include "gpu/gpu_export.h"
 #include "third_party/angle/include/GLSLANG/ShaderLang.h"
 
@@ -141,6 +142,11 @@ class GPU_EXPORT ShaderTranslator
   void AddDestructionObserver(DestructionObserver* observer);
   void RemoveDestructionObserver(DestructionObserver* observer);
 
+  // Translators are shared between contexts and translations may run on
+  // worker threads, so this must be held while translating and reading the
+  // results of the translation.
+  base::Lock& lock() { return lock_; }
+
  private:
   friend class base::RefCounted<ShaderTranslator>;
 
@@ -159,6 +165,7 @@ class GPU_EXPORT ShaderTranslator
   bool implementation_is_glsl_es_;
   ShCompileOptions driver_bug_workarounds_;
   ObserverList<DestructionObserver> destruction_observers_;
+  base::Lock lock_;
 
   DISALLOW_COPY_AND_ASSIGN(ShaderTranslator);
 };
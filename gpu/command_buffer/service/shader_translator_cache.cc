@@ -4,20 +4,86 @@
 
 #include "gpu/command_buffer/service/shader_translator_cache.h"
 
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/threading/worker_pool.h"
+
 namespace gpu {
 namespace gles2 {
 
+namespace {
+
+// Translations kept around so that contexts compiling the same shaders share
+// them.
+const size_t kMaxCachedTranslations = 128;
+
+}  // namespace
+
+ShaderTranslation::ShaderTranslation(ShaderTranslator* translator,
+                                     const std::string& source)
+    : translator_(translator),
+      source_(source),
+      done_(true, false),
+      success_(false) {
+}
+
+ShaderTranslation::~ShaderTranslation() {
+}
+
+void ShaderTranslation::Run() {
+  TRACE_EVENT0("gpu", "ShaderTranslation::Run");
+  {
+    base::AutoLock lock(translator_->lock());
+    success_ = translator_->Translate(source_.c_str());
+    const char* translated_shader = translator_->translated_shader();
+    if (translated_shader)
+      translated_shader_.reset(new std::string(translated_shader));
+    const char* info_log = translator_->info_log();
+    if (info_log)
+      info_log_.reset(new std::string(info_log));
+    if (success_) {
+      attrib_map_ = translator_->attrib_map();
+      uniform_map_ = translator_->uniform_map();
+      varying_map_ = translator_->varying_map();
+      name_map_ = translator_->name_map();
+    }
+  }
+  done_.Signal();
+}
+
+void ShaderTranslation::Start() {
+  if (!base::WorkerPool::PostTask(
+          FROM_HERE, base::Bind(&ShaderTranslation::Run, this), false))
+    Run();
+}
+
+void ShaderTranslation::Wait() {
+  if (done_.IsSignaled())
+    return;
+  TRACE_EVENT0("gpu", "ShaderTranslation::Wait");
+  done_.Wait();
+}
+
 ShaderTranslatorCache* ShaderTranslatorCache::GetInstance() {
   return Singleton<ShaderTranslatorCache>::get();
 }
 
-ShaderTranslatorCache::ShaderTranslatorCache() {
+ShaderTranslatorCache::ShaderTranslatorCache()
+    : translations_(kMaxCachedTranslations) {
 }
 
 ShaderTranslatorCache::~ShaderTranslatorCache() {
 }
 
 void ShaderTranslatorCache::OnDestruct(ShaderTranslator* translator) {
+  TranslationCache::iterator translation = translations_.begin();
+  while (translation != translations_.end()) {
+    if (translation->first.first == translator)
+      translation = translations_.Erase(translation);
+    else
+      ++translation;
+  }
+
   Cache::iterator it = cache_.begin();
   while (it != cache_.end()) {
     if (it->second == translator) {
@@ -57,5 +123,20 @@ scoped_refptr<ShaderTranslator> ShaderTranslatorCache::GetTranslator(
   }
 }
 
+scoped_refptr<ShaderTranslation> ShaderTranslatorCache::GetTranslation(
+    ShaderTranslator* translator,
+    const std::string& source) {
+  std::pair<ShaderTranslator*, std::string> key(translator, source);
+  TranslationCache::iterator it = translations_.Get(key);
+  if (it != translations_.end())
+    return it->second;
+
+  scoped_refptr<ShaderTranslation> translation(
+      new ShaderTranslation(translator, source));
+  translation->Start();
+  translations_.Put(key, translation);
+  return translation;
+}
+
 }  // namespace gles2
 }  // namespace gpu
@@ -8,18 +8,78 @@
 #include <string.h>
 
 #include <map>
+#include <string>
+#include <utility>
 
+#include "base/containers/mru_cache.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
+#include "base/synchronization/waitable_event.h"
 #include "gpu/command_buffer/service/shader_translator.h"
 #include "third_party/angle/include/GLSLANG/ShaderLang.h"
 
 namespace gpu {
 namespace gles2 {
 
+// The translation of one shader source by a ShaderTranslator. The results are
+// copied out of the translator, so that the translation can run on a worker
+// thread and its results outlive the translator's next translation.
+class GPU_EXPORT ShaderTranslation
+    : public base::RefCountedThreadSafe<ShaderTranslation> {
+ public:
+  typedef ShaderTranslatorInterface::VariableMap VariableMap;
+  typedef ShaderTranslatorInterface::NameMap NameMap;
+
+  // |translator| must outlive the translation.
+  ShaderTranslation(ShaderTranslator* translator, const std::string& source);
+
+  // Translates on the calling thread.
+  void Run();
+
+  // Translates on a worker thread.
+  void Start();
+
+  // Blocks until the translation has run. The accessors below may only be
+  // used after this returns.
+  void Wait();
+
+  const std::string& source() const { return source_; }
+  bool success() const { return success_; }
+  // These are NULL if the translator returned no translated shader or log.
+  const char* translated_shader() const {
+    return translated_shader_ ? translated_shader_->c_str() : NULL;
+  }
+  const char* info_log() const {
+    return info_log_ ? info_log_->c_str() : NULL;
+  }
+  const VariableMap& attrib_map() const { return attrib_map_; }
+  const VariableMap& uniform_map() const { return uniform_map_; }
+  const VariableMap& varying_map() const { return varying_map_; }
+  const NameMap& name_map() const { return name_map_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<ShaderTranslation>;
+
+  ~ShaderTranslation();
+
+  ShaderTranslator* translator_;
+  const std::string source_;
+  base::WaitableEvent done_;
+  bool success_;
+  scoped_ptr<std::string> translated_shader_;
+  scoped_ptr<std::string> info_log_;
+  VariableMap attrib_map_;
+  VariableMap uniform_map_;
+  VariableMap varying_map_;
+  NameMap name_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShaderTranslation);
+};
+
 // This singleton and the cache that it implements is NOT thread safe.
 // We're relying on the fact that the all GLES2DecoderImpl's are used
-// on one thread.
+// on one thread. Only the ShaderTranslations it starts run on worker threads.
 //
 // TODO(backer): Investigate using glReleaseShaderCompiler as an alternative to
 // to this cache.
@@ -38,6 +98,13 @@ class ShaderTranslatorCache : public ShaderTranslator::DestructionObserver {
           glsl_implementation_type,
       ShCompileOptions driver_bug_workarounds);
 
+  // Returns the translation of |source| by |translator|, started on a worker
+  // thread unless the same translator recently translated the same source,
+  // for any context. Whoever keeps a reference to |translator| must Wait()
+  // for the translation before releasing it.
+  scoped_refptr<ShaderTranslation> GetTranslation(ShaderTranslator* translator,
+                                                  const std::string& source);
+
  private:
   ShaderTranslatorCache();
   virtual ~ShaderTranslatorCache();
@@ -83,6 +150,10 @@ class ShaderTranslatorCache : public ShaderTranslator::DestructionObserver {
   typedef std::map<ShaderTranslatorInitParams, ShaderTranslator* > Cache;
   Cache cache_;
 
+  typedef base::MRUCache<std::pair<ShaderTranslator*, std::string>,
+                         scoped_refptr<ShaderTranslation> > TranslationCache;
+  TranslationCache translations_;
+
   DISALLOW_COPY_AND_ASSIGN(ShaderTranslatorCache);
 };
 
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "gpu/command_buffer/service/shader_translator.h"
+#include "gpu/command_buffer/service/shader_translator_cache.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace gpu {
@@ -259,6 +260,60 @@ TEST_F(ShaderTranslatorTest, OptionsString) {
   EXPECT_NE(options_3, options_4);
 }
 
+TEST_F(ShaderTranslatorTest, TranslationKeepsResults) {
+  const char* shader =
+      "attribute vec4 vPosition;\n"
+      "void main() {\n"
+      "  gl_Position = vPosition;\n"
+      "}";
+
+  scoped_refptr<ShaderTranslation> translation =
+      new ShaderTranslation(vertex_translator_.get(), shader);
+  translation->Run();
+  translation->Wait();
+  EXPECT_TRUE(translation->success());
+  EXPECT_EQ(shader, translation->source());
+  ASSERT_TRUE(translation->translated_shader() != NULL);
+  EXPECT_EQ(1u, translation->attrib_map().size());
+
+  // The results don't change when the translator translates another shader.
+  EXPECT_FALSE(vertex_translator_->Translate("foo-bar"));
+  EXPECT_TRUE(translation->success());
+  EXPECT_TRUE(translation->info_log() == NULL);
+  EXPECT_EQ(1u, translation->attrib_map().size());
+}
+
+TEST_F(ShaderTranslatorTest, CacheSharesTranslations) {
+  ShBuiltInResources resources;
+  ShInitBuiltInResources(&resources);
+  ShaderTranslatorCache* cache = ShaderTranslatorCache::GetInstance();
+  scoped_refptr<ShaderTranslator> translator = cache->GetTranslator(
+      SH_VERTEX_SHADER, SH_GLES2_SPEC, &resources,
+      ShaderTranslatorInterface::kGlsl,
+      static_cast<ShCompileOptions>(0));
+  ASSERT_TRUE(translator.get() != NULL);
+
+  const char* good_shader =
+      "void main() {\n"
+      "  gl_Position = vec4(1.0);\n"
+      "}";
+  scoped_refptr<ShaderTranslation> good_1 =
+      cache->GetTranslation(translator.get(), good_shader);
+  scoped_refptr<ShaderTranslation> good_2 =
+      cache->GetTranslation(translator.get(), good_shader);
+  scoped_refptr<ShaderTranslation> bad =
+      cache->GetTranslation(translator.get(), "foo-bar");
+  EXPECT_EQ(good_1.get(), good_2.get());
+  EXPECT_NE(good_1.get(), bad.get());
+
+  good_1->Wait();
+  bad->Wait();
+  EXPECT_TRUE(good_1->success());
+  EXPECT_TRUE(good_1->translated_shader() != NULL);
+  EXPECT_FALSE(bad->success());
+  EXPECT_TRUE(bad->info_log() != NULL);
+}
+
 }  // namespace gles2
 }  // namespace gpu
 
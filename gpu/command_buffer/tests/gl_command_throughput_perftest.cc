@@ -0,0 +1,105 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include "base/time/time.h"
+#include "gpu/command_buffer/tests/gl_manager.h"
+#include "gpu/command_buffer/tests/gl_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+#define SHADER(Src) #Src
+
+namespace gpu {
+
+namespace {
+
+// Enough commands for the run to take a measurable amount of time, without
+// slowing down the gl_tests run too much.
+const int kNumCommands = 100000;
+
+void PrintCommandsPerSecond(const std::string& trace,
+                            base::TimeDelta elapsed) {
+  perf_test::PrintResult("gl_command_throughput", "", trace,
+                         kNumCommands / elapsed.InSecondsF(),
+                         "commands/s", true);
+}
+
+}  // anonymous namespace.
+
+class GLCommandThroughputTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    GLManager::Options options;
+    options.size = gfx::Size(4, 4);
+    gl_.Initialize(options);
+  }
+
+  virtual void TearDown() {
+    gl_.Destroy();
+  }
+
+  GLManager gl_;
+};
+
+// Measures the decoding of small commands that only carry their arguments.
+TEST_F(GLCommandThroughputTest, Uniform) {
+  static const char* v_shader_str = SHADER(
+      uniform float u_scale;
+      attribute vec4 a_position;
+      void main()
+      {
+        gl_Position = a_position * u_scale;
+      }
+  );
+  static const char* f_shader_str = SHADER(
+      precision mediump float;
+      void main()
+      {
+        gl_FragColor = vec4(1.0, 0.0, 0.0, 1.0);
+      }
+  );
+
+  GLuint program = GLTestHelper::LoadProgram(v_shader_str, f_shader_str);
+  ASSERT_NE(0u, program);
+  glUseProgram(program);
+  GLint scale_loc = glGetUniformLocation(program, "u_scale");
+  ASSERT_NE(-1, scale_loc);
+  glFinish();
+
+  base::TimeTicks begin_time = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumCommands; ++i)
+    glUniform1f(scale_loc, static_cast<float>(i));
+  glFinish();
+  PrintCommandsPerSecond("uniform",
+                         base::TimeTicks::HighResNow() - begin_time);
+  EXPECT_TRUE(GLTestHelper::CheckGLError("no errors", __LINE__));
+
+  glDeleteProgram(program);
+}
+
+// Measures the decoding of commands whose data is in the transfer buffer.
+TEST_F(GLCommandThroughputTest, BufferSubData) {
+  static const GLfloat kData[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+  GLuint buffer = 0;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kData), NULL, GL_DYNAMIC_DRAW);
+  glFinish();
+
+  base::TimeTicks begin_time = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kNumCommands; ++i)
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(kData), kData);
+  glFinish();
+  PrintCommandsPerSecond("buffer_sub_data",
+                         base::TimeTicks::HighResNow() - begin_time);
+  EXPECT_TRUE(GLTestHelper::CheckGLError("no errors", __LINE__));
+
+  glDeleteBuffers(1, &buffer);
+}
+
+}  // namespace gpu
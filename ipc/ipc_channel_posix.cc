@@ -13,9 +13,7 @@
 #include <sys/un.h>
 #include <unistd.h>
 
-#if defined(OS_OPENBSD)
 #include <sys/uio.h>
-#endif
 
 #include <map>
 #include <string>
@@ -61,6 +59,11 @@ namespace IPC {
 //------------------------------------------------------------------------------
 namespace {
 
+// Bounds on the messages written together by a single system call. Messages
+// are only batched while they fit in what the peer reads at once.
+const size_t kMaxMessagesPerWrite = 64;
+const size_t kMaxBatchedWriteBytes = Channel::kReadBufferSize;
+
 // The PipeMap class works around this quirk related to unit tests:
 //
 // When running as a server, we install the client socket in a
@@ -382,6 +385,33 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
   while (!output_queue_.empty()) {
     Message* msg = output_queue_.front();
 
+    // Coalesce the small messages at the front of the queue that carry no
+    // descriptors, like bursts of input events or acks, into a single write.
+    size_t batch_count = 0;
+    size_t batch_bytes = 0;
+    for (std::deque<Message*>::const_iterator it = output_queue_.begin();
+         it != output_queue_.end() && batch_count < kMaxMessagesPerWrite;
+         ++it) {
+      const Message* batch_msg = *it;
+      if (!batch_msg->file_descriptor_set()->empty())
+        break;
+      size_t bytes = batch_msg->size();
+      if (it == output_queue_.begin())
+        bytes -= message_send_bytes_written_;
+      if (batch_bytes + bytes > kMaxBatchedWriteBytes)
+        break;
+      batch_bytes += bytes;
+      ++batch_count;
+    }
+    if (batch_count > 1) {
+      bool blocked = false;
+      if (!WriteOutgoingMessageBatch(batch_count, batch_bytes, &blocked))
+        return false;
+      if (blocked)
+        return true;
+      continue;
+    }
+
     size_t amt_to_write = msg->size() - message_send_bytes_written_;
     DCHECK_NE(0U, amt_to_write);
     const char* out_bytes = reinterpret_cast<const char*>(msg->data()) +
@@ -470,19 +500,7 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
       // caller will close the pipe. If they do not, the pipe will
       // still be closed next time OnFileCanReadWithoutBlocking is
       // called.
-#if defined(OS_MACOSX)
-      // On OSX writing to a pipe with no listener returns EPERM.
-      if (errno == EPERM) {
-        return false;
-      }
-#endif  // OS_MACOSX
-      if (errno == EPIPE) {
-        return false;
-      }
-      PLOG(ERROR) << "pipe error on "
-                  << fd_written
-                  << " Currently writing message of size: "
-                  << msg->size();
+      LogWriteError(fd_written, msg->size());
       return false;
     }
 
@@ -492,14 +510,7 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
         message_send_bytes_written_ += bytes_written;
       }
 
-      // Tell libevent to call us back once things are unblocked.
-      is_blocked_on_write_ = true;
-      base::MessageLoopForIO::current()->WatchFileDescriptor(
-          pipe_,
-          false,  // One shot
-          base::MessageLoopForIO::WATCH_WRITE,
-          &write_watcher_,
-          this);
+      WaitForWrite();
       return true;
     } else {
       message_send_bytes_written_ = 0;
@@ -508,12 +519,89 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
       DVLOG(2) << "sent message @" << msg << " on channel @" << this
                << " with type " << msg->type() << " on fd " << pipe_;
       delete output_queue_.front();
-      output_queue_.pop();
+      output_queue_.pop_front();
+    }
+  }
+  return true;
+}
+
+bool Channel::ChannelImpl::WriteOutgoingMessageBatch(size_t message_count,
+                                                     size_t batch_bytes,
+                                                     bool* blocked) {
+  struct iovec iov[kMaxMessagesPerWrite];
+  DCHECK_LE(message_count, arraysize(iov));
+  for (size_t i = 0; i < message_count; ++i) {
+    const Message* msg = output_queue_[i];
+    size_t offset = i ? 0 : message_send_bytes_written_;
+    iov[i].iov_base = const_cast<char*>(
+        reinterpret_cast<const char*>(msg->data()) + offset);
+    iov[i].iov_len = msg->size() - offset;
+  }
+
+#if defined(IPC_USES_READWRITE)
+  ssize_t bytes_written = HANDLE_EINTR(writev(pipe_, iov, message_count));
+#else
+  struct msghdr msgh = {0};
+  msgh.msg_iov = iov;
+  msgh.msg_iovlen = message_count;
+  ssize_t bytes_written = HANDLE_EINTR(sendmsg(pipe_, &msgh, MSG_DONTWAIT));
+#endif  // IPC_USES_READWRITE
+  if (bytes_written < 0 && !SocketWriteErrorIsRecoverable()) {
+    // See ProcessOutgoingMessages for why the pipe isn't closed here.
+    LogWriteError(pipe_, batch_bytes);
+    return false;
+  }
+
+  // Retire the messages that were written in full, and remember how much of
+  // the next one went out.
+  size_t bytes_left = bytes_written > 0 ? bytes_written : 0;
+  while (bytes_left) {
+    Message* msg = output_queue_.front();
+    size_t msg_bytes_left = msg->size() - message_send_bytes_written_;
+    if (bytes_left < msg_bytes_left) {
+      message_send_bytes_written_ += bytes_left;
+      break;
     }
+    bytes_left -= msg_bytes_left;
+    message_send_bytes_written_ = 0;
+    DVLOG(2) << "sent message @" << msg << " on channel @" << this
+             << " with type " << msg->type() << " on fd " << pipe_;
+    delete msg;
+    output_queue_.pop_front();
+  }
+
+  if (static_cast<size_t>(bytes_written) != batch_bytes) {
+    *blocked = true;
+    WaitForWrite();
   }
   return true;
 }
 
+void Channel::ChannelImpl::LogWriteError(int fd, size_t message_size) {
+#if defined(OS_MACOSX)
+  // On OSX writing to a pipe with no listener returns EPERM.
+  if (errno == EPERM)
+    return;
+#endif  // OS_MACOSX
+  if (errno == EPIPE)
+    return;
+  PLOG(ERROR) << "pipe error on "
+              << fd
+              << " Currently writing message of size: "
+              << message_size;
+}
+
+void Channel::ChannelImpl::WaitForWrite() {
+  // Tell libevent to call us back once things are unblocked.
+  is_blocked_on_write_ = true;
+  base::MessageLoopForIO::current()->WatchFileDescriptor(
+      pipe_,
+      false,  // One shot
+      base::MessageLoopForIO::WATCH_WRITE,
+      &write_watcher_,
+      this);
+}
+
 bool Channel::ChannelImpl::Send(Message* message) {
   DVLOG(2) << "sending message @" << message << " on channel @" << this
            << " with type " << message->type()
@@ -524,7 +612,7 @@ bool Channel::ChannelImpl::Send(Message* message) {
 #endif  // IPC_MESSAGE_LOG_ENABLED
 
   message->TraceMessageBegin();
-  output_queue_.push(message);
+  output_queue_.push_back(message);
   if (!is_blocked_on_write_ && !waiting_connect_) {
     return ProcessOutgoingMessages();
   }
@@ -594,7 +682,7 @@ void Channel::ChannelImpl::ResetToAcceptingConnectionState() {
 
   while (!output_queue_.empty()) {
     Message* m = output_queue_.front();
-    output_queue_.pop();
+    output_queue_.pop_front();
     delete m;
   }
 
@@ -764,7 +852,7 @@ void Channel::ChannelImpl::QueueHelloMessage() {
     DCHECK_EQ(msg->file_descriptor_set()->size(), 1U);
   }
 #endif  // IPC_USES_READWRITE
-  output_queue_.push(msg.release());
+  output_queue_.push_back(msg.release());
 }
 
 Channel::ChannelImpl::ReadState Channel::ChannelImpl::ReadData(
@@ -949,7 +1037,7 @@ void Channel::ChannelImpl::QueueCloseFDMessage(int fd, int hops) {
         NOTREACHED() << "Unable to pickle close fd.";
       }
       // Send(msg.release());
-      output_queue_.push(msg.release());
+      output_queue_.push_back(msg.release());
       break;
     }
 
@@ -9,7 +9,7 @@
 
 #include <sys/socket.h>  // for CMSG macros
 
-#include <queue>
+#include <deque>
 #include <set>
 #include <string>
 #include <vector>
@@ -77,6 +77,19 @@ class Channel::ChannelImpl : public internal::ChannelReader,
 
   bool ProcessOutgoingMessages();
 
+  // Writes the messages at the front of the output queue that carry no file
+  // descriptors with a single system call. Returns false on a pipe error.
+  // Sets |*blocked| if not all of the messages could be written.
+  bool WriteOutgoingMessageBatch(size_t message_count,
+                                 size_t batch_bytes,
+                                 bool* blocked);
+
+  // Logs a failed write to |fd| while sending a message of |message_size|.
+  void LogWriteError(int fd, size_t message_size);
+
+  // Has the message loop call us back once the pipe can be written to again.
+  void WaitForWrite();
+
   bool AcceptConnection();
   void ClosePipeOnError();
   int GetHelloMessageProcId();
@@ -157,7 +170,7 @@ class Channel::ChannelImpl : public internal::ChannelReader,
   std::string pipe_name_;
 
   // Messages to be sent are queued here.
-  std::queue<Message*> output_queue_;
+  std::deque<Message*> output_queue_;
 
   // We assume a worst case: kReadBufferSize bytes of messages, where each
   // message has no payload and a full complement of descriptors.
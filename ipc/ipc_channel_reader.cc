@@ -11,6 +11,14 @@
 namespace IPC {
 namespace internal {
 
+namespace {
+
+// The overflow buffer is shrunk back once it has grown past this capacity
+// and the partial message fits in it.
+const size_t kMaximumOverflowBufferCapacity = 16 * Channel::kReadBufferSize;
+
+}  // namespace
+
 ChannelReader::ChannelReader(Listener* listener) : listener_(listener) {
   memset(input_buf_, 0, sizeof(input_buf_));
 }
@@ -102,8 +110,29 @@ bool ChannelReader::DispatchInputData(const char* input_data,
     }
   }
 
-  // Save any partial data in the overflow buffer.
-  input_overflow_buf_.assign(p, end - p);
+  // Save any partial data in the overflow buffer. Once the header of the
+  // partial message is in, make room for all of it, so that the rest of a
+  // large message is appended without reallocating the buffer each time. The
+  // room is given back once large messages stop coming. |p| may point into
+  // the overflow buffer, so a new buffer is swapped in instead of resizing it.
+  size_t message_size = 0;
+  if (!Message::PeekNext(p, end, &message_size))
+    message_size = end - p;
+  if (message_size > Channel::kMaximumMessageSize) {
+    input_overflow_buf_.clear();
+    LOG(ERROR) << "IPC message is too big";
+    return false;
+  }
+  if (message_size > input_overflow_buf_.capacity() ||
+      (input_overflow_buf_.capacity() > kMaximumOverflowBufferCapacity &&
+       message_size <= kMaximumOverflowBufferCapacity)) {
+    std::string overflow_buf;
+    overflow_buf.reserve(message_size);
+    overflow_buf.assign(p, end - p);
+    input_overflow_buf_.swap(overflow_buf);
+  } else {
+    input_overflow_buf_.assign(p, end - p);
+  }
 
   if (input_overflow_buf_.empty() && !DidEmptyInputBuffers())
     return false;
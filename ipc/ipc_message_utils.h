@@ -5,6 +5,8 @@
 #ifndef IPC_IPC_MESSAGE_UTILS_H_
 #define IPC_IPC_MESSAGE_UTILS_H_
 
+#include <string.h>
+
 #include <algorithm>
 #include <map>
 #include <set>
@@ -106,6 +108,82 @@ static inline void LogParam(const P& p, std::string* l) {
   ParamTraits<Type>::Log(static_cast<const Type& >(p), l);
 }
 
+// Returns roughly how many bytes WriteParam() will add to a message for |p|,
+// so that the message can be sized up front with Reserve(). Only types whose
+// written size is cheap to work out are counted; the rest count as 0.
+template <class P>
+static inline size_t GetParamSizeHint(const P& p) {
+  return 0;
+}
+
+static inline size_t GetParamSizeHint(bool p) {
+  return sizeof(int);
+}
+
+static inline size_t GetParamSizeHint(int p) {
+  return sizeof(int);
+}
+
+static inline size_t GetParamSizeHint(unsigned int p) {
+  return sizeof(int);
+}
+
+static inline size_t GetParamSizeHint(int64 p) {
+  return sizeof(int64);
+}
+
+static inline size_t GetParamSizeHint(uint64 p) {
+  return sizeof(uint64);
+}
+
+static inline size_t GetParamSizeHint(float p) {
+  return sizeof(float);
+}
+
+// Doubles are written as a length followed by their bytes.
+static inline size_t GetParamSizeHint(double p) {
+  return sizeof(int) + sizeof(double);
+}
+
+// Strings are written as a length followed by their characters, padded to a
+// multiple of 4 bytes.
+static inline size_t GetParamSizeHint(const std::string& p) {
+  return sizeof(int) + ((p.size() + 3) & ~static_cast<size_t>(3));
+}
+
+static inline size_t GetParamSizeHint(const base::string16& p) {
+  return sizeof(int) +
+      ((p.size() * sizeof(base::char16) + 3) & ~static_cast<size_t>(3));
+}
+
+template <class A>
+static inline size_t GetParamSizeHint(const Tuple1<A>& p) {
+  return GetParamSizeHint(p.a);
+}
+
+template <class A, class B>
+static inline size_t GetParamSizeHint(const Tuple2<A, B>& p) {
+  return GetParamSizeHint(p.a) + GetParamSizeHint(p.b);
+}
+
+template <class A, class B, class C>
+static inline size_t GetParamSizeHint(const Tuple3<A, B, C>& p) {
+  return GetParamSizeHint(p.a) + GetParamSizeHint(p.b) +
+      GetParamSizeHint(p.c);
+}
+
+template <class A, class B, class C, class D>
+static inline size_t GetParamSizeHint(const Tuple4<A, B, C, D>& p) {
+  return GetParamSizeHint(p.a) + GetParamSizeHint(p.b) +
+      GetParamSizeHint(p.c) + GetParamSizeHint(p.d);
+}
+
+template <class A, class B, class C, class D, class E>
+static inline size_t GetParamSizeHint(const Tuple5<A, B, C, D, E>& p) {
+  return GetParamSizeHint(p.a) + GetParamSizeHint(p.b) +
+      GetParamSizeHint(p.c) + GetParamSizeHint(p.d) + GetParamSizeHint(p.e);
+}
+
 // Primitive ParamTraits -------------------------------------------------------
 
 template <>
@@ -233,6 +311,38 @@ struct IPC_EXPORT ParamTraits<double> {
   static void Log(const param_type& p, std::string* l);
 };
 
+// Bytewise ParamTraits -------------------------------------------------------
+
+// Base for the ParamTraits of a struct that is sent as its raw bytes, so that
+// it takes a single bounds-checked copy instead of a Write and Read per field.
+// Only use it for structs with no pointers and no invariants to check on the
+// receiving side. |kFieldBytes| is the sum of the sizes of the fields, so
+// that padding or a vtable, which would make the copy send uninitialized or
+// process-specific bytes, fails to compile. The specialization still
+// provides its own Log(). For example:
+//
+//   template <>
+//   struct ParamTraits<gfx::Point>
+//       : BytewiseParamTraits<gfx::Point, 2 * sizeof(int)> {
+//     static void Log(const param_type& p, std::string* l);
+//   };
+template <class P, size_t kFieldBytes>
+struct BytewiseParamTraits {
+  typedef P param_type;
+  static void Write(Message* m, const param_type& p) {
+    COMPILE_ASSERT(sizeof(param_type) == kFieldBytes,
+                   bytewise_param_type_has_padding);
+    m->WriteBytes(&p, static_cast<int>(sizeof(param_type)));
+  }
+  static bool Read(const Message* m, PickleIterator* iter, param_type* r) {
+    const char* data;
+    if (!m->ReadBytes(iter, &data, static_cast<int>(sizeof(param_type))))
+      return false;
+    memcpy(r, data, sizeof(param_type));
+    return true;
+  }
+};
+
 // STL ParamTraits -------------------------------------------------------------
 
 template <>
@@ -13,6 +13,7 @@ namespace IPC {
 
 template <class ParamType>
 void MessageSchema<ParamType>::Write(Message* msg, const RefParam& p) {
+  msg->Reserve(GetParamSizeHint(p));
   WriteParam(msg, p);
 }
 
@@ -29,6 +30,7 @@ template <class SendParamType, class ReplyParamType>
 void SyncMessageSchema<SendParamType, ReplyParamType>::Write(
     Message* msg,
     const RefSendParam& send) {
+  msg->Reserve(GetParamSizeHint(send));
   WriteParam(msg, send);
 }
 
@@ -70,5 +70,35 @@ TEST(IPCMessageUtilsTest, ParameterValidation) {
   ASSERT_FALSE(ParamTraits<base::FilePath>::Read(&message, &iter, &bad_path));
 }
 
+struct BytewiseStruct {
+  int32 a;
+  float b;
+  int32 c;
+};
+
+// Tests that a struct sent as its raw bytes is read back whole, and that a
+// truncated message is rejected.
+TEST(IPCMessageUtilsTest, BytewiseParamTraits) {
+  typedef BytewiseParamTraits<BytewiseStruct,
+                              2 * sizeof(int32) + sizeof(float)> Traits;
+  BytewiseStruct input = { -7, 1.5f, 1 << 30 };
+  IPC::Message message;
+  Traits::Write(&message, input);
+  EXPECT_EQ(sizeof(input), message.payload_size());
+
+  PickleIterator iter(message);
+  BytewiseStruct output = { 0, 0.0f, 0 };
+  ASSERT_TRUE(Traits::Read(&message, &iter, &output));
+  EXPECT_EQ(input.a, output.a);
+  EXPECT_EQ(input.b, output.b);
+  EXPECT_EQ(input.c, output.c);
+  EXPECT_FALSE(Traits::Read(&message, &iter, &output));
+
+  IPC::Message truncated;
+  truncated.WriteBytes(&input, sizeof(input) - sizeof(int32));
+  PickleIterator truncated_iter(truncated);
+  EXPECT_FALSE(Traits::Read(&truncated, &truncated_iter, &output));
+}
+
 }  // namespace
 }  // namespace IPC
@@ -12,6 +12,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/test/perf_time_logger.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
@@ -20,6 +21,8 @@
 #include "ipc/ipc_descriptors.h"
 #include "ipc/ipc_message_utils.h"
 #include "ipc/ipc_sender.h"
+#include "ipc/ipc_sync_channel.h"
+#include "ipc/ipc_sync_message.h"
 #include "ipc/ipc_test_base.h"
 
 namespace {
@@ -262,6 +265,252 @@ TEST_F(IPCChannelPerfTest, Performance) {
   DestroyChannel();
 }
 
+// Times the ping-pong of messages that span many pipe reads, like large
+// clipboard or view messages.
+TEST_F(IPCChannelPerfTest, LargeMessagePerformance) {
+  Init("PerformanceClient");
+
+  // Set up IPC channel and start client.
+  PerformanceChannelListener listener;
+  CreateChannel(&listener);
+  listener.Init(channel());
+  ASSERT_TRUE(ConnectChannel());
+  ASSERT_TRUE(StartClient());
+
+  const size_t kMsgSizes[] = { 1024 * 1024, 4 * 1024 * 1024,
+                               16 * 1024 * 1024 };
+  const int kMsgCount = 50;
+  for (size_t i = 0; i < arraysize(kMsgSizes); i++) {
+    listener.SetTestParams(kMsgCount, kMsgSizes[i]);
+
+    // This initial message will kick-start the ping-pong of messages.
+    IPC::Message* message =
+        new IPC::Message(0, 2, IPC::Message::PRIORITY_NORMAL);
+    message->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+    message->WriteInt(-1);
+    message->WriteString("hello");
+    sender()->Send(message);
+
+    // Run message loop.
+    base::MessageLoop::current()->Run();
+  }
+
+  // Send quit message.
+  IPC::Message* message = new IPC::Message(0, 2, IPC::Message::PRIORITY_NORMAL);
+  message->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+  message->WriteInt(-1);
+  message->WriteString("quit");
+  sender()->Send(message);
+
+  EXPECT_TRUE(WaitForClientShutdown());
+  DestroyChannel();
+}
+
+// This channel listener sends bursts of small messages, and sends the next
+// burst once the client has reflected all of the previous one. Once the pipe
+// fills up during a burst, the queued messages are written out in batches.
+class BurstChannelListener : public IPC::Listener {
+ public:
+  BurstChannelListener()
+      : channel_(NULL),
+        burst_count_(0),
+        burst_size_(0),
+        bursts_left_(0),
+        replies_left_(0),
+        next_reply_id_(0) {
+  }
+
+  virtual ~BurstChannelListener() {}
+
+  void Init(IPC::Channel* channel) {
+    DCHECK(!channel_);
+    channel_ = channel;
+  }
+
+  // Sends the first burst. Call this before running the message loop.
+  void Start(int burst_count, int burst_size, size_t msg_size) {
+    DCHECK_EQ(0, bursts_left_);
+    burst_count_ = burst_count;
+    burst_size_ = burst_size;
+    bursts_left_ = burst_count;
+    payload_ = std::string(msg_size, 'a');
+    std::string test_name = base::StringPrintf(
+        "IPC_Burst_Perf_%dx%dx_%u", burst_count_, burst_size_,
+        static_cast<unsigned>(msg_size));
+    perf_logger_.reset(new base::PerfTimeLogger(test_name.c_str()));
+    SendBurst();
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    CHECK(channel_);
+
+    PickleIterator iter(message);
+    int64 time_internal;
+    EXPECT_TRUE(iter.ReadInt64(&time_internal));
+    int msgid;
+    EXPECT_TRUE(iter.ReadInt(&msgid));
+
+    // The messages of a burst come back in order.
+    EXPECT_EQ(next_reply_id_, msgid);
+    next_reply_id_++;
+    CHECK(replies_left_ > 0);
+    if (--replies_left_)
+      return true;
+
+    if (--bursts_left_) {
+      SendBurst();
+    } else {
+      perf_logger_.reset();  // Stop the perf timer now.
+      base::MessageLoop::current()->QuitWhenIdle();
+    }
+    return true;
+  }
+
+ private:
+  void SendBurst() {
+    next_reply_id_ = 0;
+    replies_left_ = burst_size_;
+    for (int i = 0; i < burst_size_; i++) {
+      IPC::Message* msg =
+          new IPC::Message(0, 2, IPC::Message::PRIORITY_NORMAL);
+      msg->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+      msg->WriteInt(i);
+      msg->WriteString(payload_);
+      channel_->Send(msg);
+    }
+  }
+
+  IPC::Channel* channel_;
+  int burst_count_;
+  int burst_size_;
+  int bursts_left_;
+  int replies_left_;
+  int next_reply_id_;
+  std::string payload_;
+  scoped_ptr<base::PerfTimeLogger> perf_logger_;
+};
+
+TEST_F(IPCChannelPerfTest, BurstPerformance) {
+  Init("PerformanceClient");
+
+  // Set up IPC channel and start client.
+  BurstChannelListener listener;
+  CreateChannel(&listener);
+  listener.Init(channel());
+  ASSERT_TRUE(ConnectChannel());
+  ASSERT_TRUE(StartClient());
+
+  const size_t kMsgSizes[] = { 12, 144 };
+  const int kBurstCount = 100;
+  const int kBurstSize = 10000;
+  for (size_t i = 0; i < arraysize(kMsgSizes); i++) {
+    listener.Start(kBurstCount, kBurstSize, kMsgSizes[i]);
+
+    // Run message loop.
+    base::MessageLoop::current()->Run();
+  }
+
+  // Send quit message.
+  IPC::Message* message = new IPC::Message(0, 2, IPC::Message::PRIORITY_NORMAL);
+  message->WriteInt64(base::TimeTicks::Now().ToInternalValue());
+  message->WriteInt(-1);
+  message->WriteString("quit");
+  sender()->Send(message);
+
+  EXPECT_TRUE(WaitForClientShutdown());
+  DestroyChannel();
+}
+
+// The type of the sync messages sent by the SyncPerformanceClient. They have
+// no parameters, and neither do their replies.
+const uint32 kSyncMessageType = 3;
+
+// Accepts the empty replies to the sync messages.
+class EmptyReplyDeserializer : public IPC::MessageReplyDeserializer {
+ private:
+  virtual bool SerializeOutputParameters(const IPC::Message& msg,
+                                         PickleIterator iter) OVERRIDE {
+    return true;
+  }
+};
+
+// The SyncPerformanceClient only gets replies, which SyncChannel handles.
+class NullListener : public IPC::Listener {
+ public:
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    return false;
+  }
+};
+
+// This channel listener replies to each sync message right away. It quits
+// once the client closes the channel.
+class SyncReplyListener : public IPC::Listener {
+ public:
+  SyncReplyListener() : channel_(NULL) {}
+  virtual ~SyncReplyListener() {}
+
+  void Init(IPC::Channel* channel) {
+    DCHECK(!channel_);
+    channel_ = channel;
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    CHECK(channel_);
+    EXPECT_TRUE(message.is_sync());
+    channel_->Send(IPC::SyncMessage::GenerateReply(&message));
+    return true;
+  }
+
+  virtual void OnChannelError() OVERRIDE {
+    base::MessageLoop::current()->QuitWhenIdle();
+  }
+
+ private:
+  IPC::Channel* channel_;
+};
+
+// Times sync round trips, like the ones renderers make for cookies. The
+// client blocks in SyncChannel::Send until the reply is read on its IO
+// thread.
+TEST_F(IPCChannelPerfTest, SyncRoundTripPerformance) {
+  Init("SyncPerformanceClient");
+
+  // Set up IPC channel and start client.
+  SyncReplyListener listener;
+  CreateChannel(&listener);
+  listener.Init(channel());
+  ASSERT_TRUE(ConnectChannel());
+  ASSERT_TRUE(StartClient());
+
+  // Run message loop until the client is done.
+  base::MessageLoop::current()->Run();
+
+  EXPECT_TRUE(WaitForClientShutdown());
+  DestroyChannel();
+}
+
+// Times building messages like the ones above without sending them. Messages
+// with small payloads are built without touching the heap.
+TEST(IPCMessagePerfTest, Construction) {
+  const int kMsgCount = 1000000;
+  const size_t kPayloadSizes[] = { 12, 144, 1728 };
+  for (size_t i = 0; i < arraysize(kPayloadSizes); i++) {
+    std::string payload(kPayloadSizes[i], 'a');
+    std::string test_name =
+        base::StringPrintf("IPC_Message_Construction_%u",
+                           static_cast<unsigned>(kPayloadSizes[i]));
+    base::PerfTimeLogger logger(test_name.c_str());
+    for (int j = 0; j < kMsgCount; j++) {
+      IPC::Message message(0, 2, IPC::Message::PRIORITY_NORMAL);
+      message.WriteInt64(j);
+      message.WriteInt(j);
+      message.WriteString(payload);
+      ASSERT_GT(message.size(), payload.size());
+    }
+    logger.Done();
+  }
+}
+
 // This message loop bounces all messages back to the sender.
 MULTIPROCESS_IPC_TEST_CLIENT_MAIN(PerformanceClient) {
   base::MessageLoopForIO main_message_loop;
@@ -276,4 +525,35 @@ MULTIPROCESS_IPC_TEST_CLIENT_MAIN(PerformanceClient) {
   return 0;
 }
 
+// This client sends sync messages one after the other, and times them.
+MULTIPROCESS_IPC_TEST_CLIENT_MAIN(SyncPerformanceClient) {
+  const int kMsgCount = 100000;
+  base::MessageLoop main_message_loop;
+  base::Thread io_thread("SyncPerformanceClient IO thread");
+  CHECK(io_thread.StartWithOptions(
+      base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+  base::WaitableEvent shutdown_event(true, false);
+
+  NullListener listener;
+  IPC::SyncChannel channel(
+      IPCTestBase::GetChannelName("SyncPerformanceClient"),
+      IPC::Channel::MODE_CLIENT,
+      &listener,
+      io_thread.message_loop_proxy().get(),
+      true,
+      &shutdown_event);
+
+  std::string test_name =
+      base::StringPrintf("IPC_Sync_Perf_%dx_RoundTrip", kMsgCount);
+  base::PerfTimeLogger logger(test_name.c_str());
+  for (int i = 0; i < kMsgCount; i++) {
+    CHECK(channel.Send(new IPC::SyncMessage(MSG_ROUTING_CONTROL,
+                                            kSyncMessageType,
+                                            IPC::Message::PRIORITY_NORMAL,
+                                            new EmptyReplyDeserializer)));
+  }
+  logger.Done();
+  return 0;
+}
+
 }  // namespace
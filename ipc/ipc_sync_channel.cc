@@ -162,7 +162,8 @@ class SyncChannel::ReceivedSyncMsgQueue :
   void DispatchReplies() {
     for (size_t i = 0; i < received_replies_.size(); ++i) {
       Message* message = received_replies_[i].message;
-      if (received_replies_[i].context->TryToUnblockListener(message)) {
+      if (received_replies_[i].context->TryToUnblockListenerWithQueuedReply(
+              message)) {
         delete message;
         received_replies_.erase(received_replies_.begin() + i);
         return;
@@ -232,6 +233,7 @@ SyncChannel::SyncContext::SyncContext(
     WaitableEvent* shutdown_event)
     : ChannelProxy::Context(listener, ipc_task_runner),
       received_sync_msgs_(ReceivedSyncMsgQueue::AddContext()),
+      queued_reply_count_(0),
       shutdown_event_(shutdown_event),
       restrict_dispatch_group_(kRestrictDispatchGroup_None) {
 }
@@ -253,33 +255,47 @@ void SyncChannel::SyncContext::Push(SyncMessage* sync_msg) {
   // OnObjectSignalled, another Send can happen which would stop the watcher
   // from being called.  The event would get watched later, when the nested
   // Send completes, so the event will need to remain set.
+  base::AutoLock auto_lock(deserializers_lock_);
+  WaitableEvent* done_event = spare_done_event_.release();
+  if (!done_event)
+    done_event = new WaitableEvent(true, false);
   PendingSyncMsg pending(SyncMessage::GetMessageId(*sync_msg),
                          sync_msg->GetReplyDeserializer(),
-                         new WaitableEvent(true, false));
-  base::AutoLock auto_lock(deserializers_lock_);
+                         done_event);
   deserializers_.push_back(pending);
 }
 
 bool SyncChannel::SyncContext::Pop() {
   bool result;
+  bool has_queued_replies;
   {
     base::AutoLock auto_lock(deserializers_lock_);
     PendingSyncMsg msg = deserializers_.back();
     delete msg.deserializer;
-    delete msg.done_event;
+    if (spare_done_event_) {
+      delete msg.done_event;
+    } else {
+      msg.done_event->Reset();
+      spare_done_event_.reset(msg.done_event);
+    }
     msg.done_event = NULL;
     deserializers_.pop_back();
     result = msg.send_result;
+    has_queued_replies = queued_reply_count_ > 0;
   }
 
   // We got a reply to a synchronous Send() call that's blocking the listener
   // thread.  However, further down the call stack there could be another
   // blocking Send() call, whose reply we received after we made this last
   // Send() call.  So check if we have any queued replies available that
-  // can now unblock the listener thread.
-  ipc_task_runner()->PostTask(
-      FROM_HERE, base::Bind(&ReceivedSyncMsgQueue::DispatchReplies,
-                            received_sync_msgs_.get()));
+  // can now unblock the listener thread. Replies are counted before they are
+  // queued, so a reply that isn't counted yet will find the next Send() call
+  // on top by itself.
+  if (has_queued_replies) {
+    ipc_task_runner()->PostTask(
+        FROM_HERE, base::Bind(&ReceivedSyncMsgQueue::DispatchReplies,
+                              received_sync_msgs_.get()));
+  }
 
   return result;
 }
@@ -299,6 +315,21 @@ void SyncChannel::SyncContext::DispatchMessages() {
 
 bool SyncChannel::SyncContext::TryToUnblockListener(const Message* msg) {
   base::AutoLock auto_lock(deserializers_lock_);
+  return TryToUnblockListenerLocked(msg);
+}
+
+bool SyncChannel::SyncContext::TryToUnblockListenerWithQueuedReply(
+    const Message* msg) {
+  base::AutoLock auto_lock(deserializers_lock_);
+  if (!TryToUnblockListenerLocked(msg))
+    return false;
+  DCHECK_GT(queued_reply_count_, 0);
+  queued_reply_count_--;
+  return true;
+}
+
+bool SyncChannel::SyncContext::TryToUnblockListenerLocked(const Message* msg) {
+  deserializers_lock_.AssertAcquired();
   if (deserializers_.empty() ||
       !SyncMessage::IsMessageReplyTo(*msg, deserializers_.back().id)) {
     return false;
@@ -330,10 +361,15 @@ bool SyncChannel::SyncContext::OnMessageReceived(const Message& msg) {
   if (TryFilters(msg))
     return true;
 
-  if (TryToUnblockListener(&msg))
-    return true;
-
   if (msg.is_reply()) {
+    {
+      // The reply is counted under the same lock that Pop() takes, so that
+      // Pop() either sees it counted or its Send() is off the stack by now.
+      base::AutoLock auto_lock(deserializers_lock_);
+      if (TryToUnblockListenerLocked(&msg))
+        return true;
+      queued_reply_count_++;
+    }
     received_sync_msgs_->QueueReply(msg, this);
     return true;
   }
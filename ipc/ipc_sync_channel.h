@@ -10,6 +10,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/synchronization/lock.h"
 #include "base/synchronization/waitable_event_watcher.h"
 #include "ipc/ipc_channel_handle.h"
@@ -143,6 +144,10 @@ class IPC_EXPORT SyncChannel : public ChannelProxy {
     // returned. Otherwise the function returns false.
     bool TryToUnblockListener(const Message* msg);
 
+    // Same as TryToUnblockListener, for a reply that OnMessageReceived queued
+    // in the ReceivedSyncMsgQueue.
+    bool TryToUnblockListenerWithQueuedReply(const Message* msg);
+
     // Called on the IPC thread when a sync send that runs a nested message loop
     // times out.
     void OnSendTimeout(int message_id);
@@ -179,12 +184,25 @@ class IPC_EXPORT SyncChannel : public ChannelProxy {
     // Cancels all pending Send calls.
     void CancelPendingSends();
 
+    // TryToUnblockListener, with deserializers_lock_ held.
+    bool TryToUnblockListenerLocked(const Message* msg);
+
     void OnWaitableEventSignaled(base::WaitableEvent* event);
 
     typedef std::deque<PendingSyncMsg> PendingSyncMessageQueue;
     PendingSyncMessageQueue deserializers_;
     base::Lock deserializers_lock_;
 
+    // The number of replies that arrived while a nested Send was waiting, and
+    // were queued until the nested Send is popped. Pop only has the IPC
+    // thread look at the queued replies when there are some. Protected by
+    // deserializers_lock_.
+    int queued_reply_count_;
+
+    // The done event of the last completed Send, kept for the next one.
+    // Protected by deserializers_lock_.
+    scoped_ptr<base::WaitableEvent> spare_done_event_;
+
     scoped_refptr<ReceivedSyncMsgQueue> received_sync_msgs_;
 
     base::WaitableEvent* shutdown_event_;
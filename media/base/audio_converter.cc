@@ -11,9 +11,15 @@
 #include "media/base/audio_converter.h"
 
 #include <algorithm>
+#include <vector>
 
+#include "base/atomic_ref_count.h"
+#include "base/atomicops.h"
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/memory/scoped_vector.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
 #include "media/base/audio_bus.h"
 #include "media/base/audio_pull_fifo.h"
 #include "media/base/channel_mixer.h"
@@ -22,6 +28,131 @@
 
 namespace media {
 
+// Volume adjusts |src| and mixes it into |dest|.  The first input of each
+// conversion overwrites |dest| instead, so that it starts out clean.
+static void MixInput(const AudioBus* src, float volume, bool first_input,
+                     AudioBus* dest) {
+  // Optimize the most common single input, full volume case.
+  if (first_input) {
+    if (volume == 1.0f) {
+      src->CopyTo(dest);
+    } else if (volume > 0) {
+      for (int i = 0; i < src->channels(); ++i) {
+        vector_math::FMUL(
+            src->channel(i), volume, src->frames(), dest->channel(i));
+      }
+    } else {
+      // Zero |dest| otherwise, so we're mixing into a clean buffer.
+      dest->Zero();
+    }
+    return;
+  }
+
+  // Volume adjust and mix each mixer input into |dest| after rendering.
+  if (volume > 0) {
+    for (int i = 0; i < src->channels(); ++i) {
+      vector_math::FMAC(
+          src->channel(i), volume, src->frames(), dest->channel(i));
+    }
+  }
+}
+
+// Renders each input into its own AudioBus, with the inputs shared out between
+// a fixed set of worker threads and the thread calling ProvideInputs().
+class AudioConverter::ParallelInputProvider
+    : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit ParallelInputProvider(int num_threads)
+      : num_threads_(num_threads),
+        thread_pool_("AudioConverterInput", num_threads),
+        next_input_(0),
+        pending_runs_(0),
+        runs_done_(false, false) {
+    thread_pool_.Start();
+  }
+
+  virtual ~ParallelInputProvider() {
+    thread_pool_.JoinAll();
+  }
+
+  // Calls ProvideInput() on each of |inputs| with a |channels| by |frames|
+  // AudioBus and returns once all of them are done.
+  void ProvideInputs(const InputCallbackSet& inputs,
+                     int channels,
+                     int frames,
+                     base::TimeDelta buffer_delay) {
+    inputs_.assign(inputs.begin(), inputs.end());
+    if (!results_.empty() && results_[0]->audio_bus->frames() != frames)
+      results_.clear();
+    while (results_.size() < inputs_.size()) {
+      InputResult* result = new InputResult();
+      result->audio_bus = AudioBus::Create(channels, frames);
+      results_.push_back(result);
+    }
+    buffer_delay_ = buffer_delay;
+
+    // There's no point in waking more threads than there are inputs left over
+    // for them once this thread takes its share.
+    const int helper_runs =
+        std::min(num_threads_, static_cast<int>(inputs_.size()) - 1);
+    base::subtle::NoBarrier_Store(&next_input_, 0);
+    base::subtle::NoBarrier_Store(&pending_runs_, helper_runs + 1);
+    if (helper_runs > 0)
+      thread_pool_.AddWork(this, helper_runs);
+
+    Run();
+    runs_done_.Wait();
+  }
+
+  // Returns the audio and volume provided by the input at |index|.
+  const AudioBus* input_bus(size_t index) const {
+    return results_[index]->audio_bus.get();
+  }
+  float input_volume(size_t index) const { return results_[index]->volume; }
+
+  // base::DelegateSimpleThread::Delegate implementation.
+  virtual void Run() OVERRIDE {
+    const int input_count = static_cast<int>(inputs_.size());
+    for (;;) {
+      const int index =
+          base::subtle::NoBarrier_AtomicIncrement(&next_input_, 1) - 1;
+      if (index >= input_count)
+        break;
+      InputResult* result = results_[index];
+      result->volume = inputs_[index]->ProvideInput(result->audio_bus.get(),
+                                                    buffer_delay_);
+    }
+
+    if (!base::AtomicRefCountDec(&pending_runs_))
+      runs_done_.Signal();
+  }
+
+ private:
+  struct InputResult {
+    InputResult() : volume(0) {}
+    scoped_ptr<AudioBus> audio_bus;
+    float volume;
+  };
+
+  const int num_threads_;
+  base::DelegateSimpleThreadPool thread_pool_;
+
+  // State for the ProvideInputs() call in progress.
+  std::vector<InputCallback*> inputs_;
+  ScopedVector<InputResult> results_;
+  base::TimeDelta buffer_delay_;
+
+  // Index of the next input to be claimed by a Run().
+  base::subtle::Atomic32 next_input_;
+
+  // Number of Run()s, including the one on the calling thread, which have yet
+  // to finish; the last one to finish signals |runs_done_|.
+  base::AtomicRefCount pending_runs_;
+  base::WaitableEvent runs_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelInputProvider);
+};
+
 AudioConverter::AudioConverter(const AudioParameters& input_params,
                                const AudioParameters& output_params,
                                bool disable_fifo)
@@ -112,6 +243,12 @@ void AudioConverter::RemoveInput(InputCallback* input) {
     Reset();
 }
 
+void AudioConverter::EnableParallelInputs(int num_threads) {
+  DCHECK(!parallel_input_provider_);
+  DCHECK_GT(num_threads, 0);
+  parallel_input_provider_.reset(new ParallelInputProvider(num_threads));
+}
+
 void AudioConverter::Reset() {
   if (audio_fifo_)
     audio_fifo_->Clear();
@@ -194,38 +331,20 @@ void AudioConverter::SourceCallback(int fifo_frame_delay, AudioBus* dest) {
   }
 
   // Have each mixer render its data into an output buffer then mix the result.
-  for (InputCallbackSet::iterator it = transform_inputs_.begin();
-       it != transform_inputs_.end(); ++it) {
-    InputCallback* input = *it;
-
-    float volume = input->ProvideInput(
-        mixer_input_audio_bus_.get(), buffer_delay);
-
-    // Optimize the most common single input, full volume case.
-    if (it == transform_inputs_.begin()) {
-      if (volume == 1.0f) {
-        mixer_input_audio_bus_->CopyTo(temp_dest);
-      } else if (volume > 0) {
-        for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
-          vector_math::FMUL(
-              mixer_input_audio_bus_->channel(i), volume,
-              mixer_input_audio_bus_->frames(), temp_dest->channel(i));
-        }
-      } else {
-        // Zero |temp_dest| otherwise, so we're mixing into a clean buffer.
-        temp_dest->Zero();
-      }
-
-      continue;
+  if (parallel_input_provider_ && transform_inputs_.size() > 1) {
+    parallel_input_provider_->ProvideInputs(
+        transform_inputs_, input_channel_count_, dest->frames(), buffer_delay);
+    for (size_t i = 0; i < transform_inputs_.size(); ++i) {
+      MixInput(parallel_input_provider_->input_bus(i),
+               parallel_input_provider_->input_volume(i), i == 0, temp_dest);
     }
-
-    // Volume adjust and mix each mixer input into |temp_dest| after rendering.
-    if (volume > 0) {
-      for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
-        vector_math::FMAC(
-            mixer_input_audio_bus_->channel(i), volume,
-            mixer_input_audio_bus_->frames(), temp_dest->channel(i));
-      }
+  } else {
+    for (InputCallbackSet::iterator it = transform_inputs_.begin();
+         it != transform_inputs_.end(); ++it) {
+      float volume = (*it)->ProvideInput(
+          mixer_input_audio_bus_.get(), buffer_delay);
+      MixInput(mixer_input_audio_bus_.get(), volume,
+               it == transform_inputs_.begin(), temp_dest);
     }
   }
 
@@ -87,7 +87,17 @@ class MEDIA_EXPORT AudioConverter {
   // Flushes all buffered data.
   void Reset();
 
+  // Spreads the ProvideInput() calls made during each conversion over
+  // |num_threads| worker threads as well as the calling thread, which pays
+  // off when there are many inputs.  Once enabled, inputs must be safe to call
+  // from any thread; each is still called only from one thread at a time.
+  // The inputs are mixed in the same order as before, so the output does not
+  // change.  Must only be called once, and not during a conversion.
+  void EnableParallelInputs(int num_threads);
+
  private:
+  class ParallelInputProvider;
+
   // Provides input to the MultiChannelResampler.  Called by the resampler when
   // more data is necessary.
   void ProvideInput(int resampler_frame_delay, AudioBus* audio_bus);
@@ -115,6 +125,9 @@ class MEDIA_EXPORT AudioConverter {
   // Temporary AudioBus destination for mixing inputs.
   scoped_ptr<AudioBus> mixer_input_audio_bus_;
 
+  // Calls the inputs on several threads; only set by EnableParallelInputs().
+  scoped_ptr<ParallelInputProvider> parallel_input_provider_;
+
   // Since resampling is expensive, figure out if we should downmix channels
   // before resampling.
   bool downmix_early_;
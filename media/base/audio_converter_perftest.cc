@@ -2,6 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
+#include "base/memory/scoped_vector.h"
+#include "base/strings/stringprintf.h"
+#include "base/sys_info.h"
 #include "base/time/time.h"
 #include "media/base/audio_converter.h"
 #include "media/base/fake_audio_render_callback.h"
@@ -12,6 +17,10 @@ namespace media {
 
 static const int kBenchmarkIterations = 200000;
 
+// Number of inputs and iterations for the many input mixing benchmarks.
+static const int kMixInputs = 32;
+static const int kMixBenchmarkIterations = 2000;
+
 // InputCallback that zero's out the provided AudioBus.
 class NullInputProvider : public AudioConverter::InputCallback {
  public:
@@ -49,6 +58,33 @@ void RunConvertBenchmark(const AudioParameters& in_params,
       "audio_converter", "", trace_name, runs_per_second, "runs/s", true);
 }
 
+// Mixes |kMixInputs| sine wave inputs, calling them on |num_threads| worker
+// threads as well as the converting thread if |num_threads| is non-zero.
+void RunMixBenchmark(const AudioParameters& in_params,
+                     const AudioParameters& out_params,
+                     int num_threads,
+                     const std::string& trace_name) {
+  ScopedVector<FakeAudioRenderCallback> fake_inputs;
+  scoped_ptr<AudioBus> output_bus = AudioBus::Create(out_params);
+
+  AudioConverter converter(in_params, out_params, true);
+  if (num_threads > 0)
+    converter.EnableParallelInputs(num_threads);
+  for (int i = 0; i < kMixInputs; ++i) {
+    fake_inputs.push_back(new FakeAudioRenderCallback(0.001 * (i + 1)));
+    converter.AddInput(fake_inputs[i]);
+  }
+
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kMixBenchmarkIterations; ++i) {
+    converter.Convert(output_bus.get());
+  }
+  double runs_per_second = kMixBenchmarkIterations /
+                           (base::TimeTicks::HighResNow() - start).InSecondsF();
+  perf_test::PrintResult(
+      "audio_converter", "", trace_name, runs_per_second, "runs/s", true);
+}
+
 TEST(AudioConverterPerfTest, ConvertBenchmark) {
   // Create input and output parameters to convert between the two most common
   // sets of parameters (as indicated via UMA data).
@@ -76,4 +112,29 @@ TEST(AudioConverterPerfTest, ConvertBenchmarkFIFO) {
                       "convert_pass_through");
 }
 
+TEST(AudioConverterPerfTest, MixBenchmark) {
+  // Mix many inputs at the same rate the output device runs at, followed by
+  // the resampling case.
+  AudioParameters input_params(
+      AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 44100, 16, 440);
+  AudioParameters resampled_input_params(
+      AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 48000, 16, 480);
+  AudioParameters output_params(
+      AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 44100, 16, 440);
+
+  const int num_threads = std::min(3, base::SysInfo::NumberOfProcessors() - 1);
+  RunMixBenchmark(input_params, output_params, 0,
+                  base::StringPrintf("mix_%d_inputs", kMixInputs));
+  RunMixBenchmark(resampled_input_params, output_params, 0,
+                  base::StringPrintf("mix_%d_inputs_resample", kMixInputs));
+  if (num_threads <= 0)
+    return;
+  RunMixBenchmark(input_params, output_params, num_threads,
+                  base::StringPrintf("mix_%d_inputs_%d_threads",
+                                     kMixInputs, num_threads));
+  RunMixBenchmark(resampled_input_params, output_params, num_threads,
+                  base::StringPrintf("mix_%d_inputs_resample_%d_threads",
+                                     kMixInputs, num_threads));
+}
+
 } // namespace media
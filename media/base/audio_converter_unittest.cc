@@ -20,6 +20,7 @@ namespace media {
 // Parameters which control the many input case tests.
 static const int kConvertInputs = 8;
 static const int kConvertCycles = 3;
+static const int kConvertThreads = 3;
 
 // Parameters used for testing.
 static const int kBitsPerChannel = 32;
@@ -240,6 +241,11 @@ TEST_P(AudioConverterTest, ManyInputs) {
   RunTest(kConvertInputs);
 }
 
+TEST_P(AudioConverterTest, ManyInputsParallel) {
+  converter_->EnableParallelInputs(kConvertThreads);
+  RunTest(kConvertInputs);
+}
+
 INSTANTIATE_TEST_CASE_P(
     AudioConverterTest, AudioConverterTest, testing::Values(
         // No resampling. No channel mixing.
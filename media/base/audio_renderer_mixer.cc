@@ -4,14 +4,23 @@
 
 #include "media/base/audio_renderer_mixer.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/logging.h"
+#include "base/sys_info.h"
 
 namespace media {
 
 enum { kPauseDelaySeconds = 10 };
 
+// Number of inputs at which the inputs start being called on several threads,
+// and the most worker threads used for it.  Below this, the hand off between
+// threads costs more than it saves.
+static const size_t kMinInputsForParallelMixing = 8;
+static const int kMaxParallelMixingThreads = 3;
+
 AudioRendererMixer::AudioRendererMixer(
     const AudioParameters& input_params, const AudioParameters& output_params,
     const scoped_refptr<AudioRendererSink>& sink)
@@ -20,7 +29,13 @@ AudioRendererMixer::AudioRendererMixer(
       pause_delay_(base::TimeDelta::FromSeconds(kPauseDelaySeconds)),
       last_play_time_(base::TimeTicks::Now()),
       // Initialize |playing_| to true since Start() results in an auto-play.
-      playing_(true) {
+      playing_(true),
+      parallel_inputs_(false),
+      buffer_duration_(base::TimeDelta::FromMicroseconds(
+          output_params.frames_per_buffer() *
+          base::Time::kMicrosecondsPerSecond /
+          static_cast<double>(output_params.sample_rate()))),
+      glitch_count_(0) {
   audio_sink_->Initialize(output_params, this);
   audio_sink_->Start();
 }
@@ -32,6 +47,10 @@ AudioRendererMixer::~AudioRendererMixer() {
   // Ensures that all mixer inputs have stopped themselves prior to destruction
   // and have called RemoveMixerInput().
   DCHECK_EQ(mixer_inputs_.size(), 0U);
+
+  DVLOG_IF(1, glitch_count_ > 0) << glitch_count_ << " renders overran the "
+                                 << buffer_duration_.InMillisecondsF()
+                                 << " ms buffer duration.";
 }
 
 void AudioRendererMixer::AddMixerInput(AudioConverter::InputCallback* input,
@@ -47,6 +66,15 @@ void AudioRendererMixer::AddMixerInput(AudioConverter::InputCallback* input,
   DCHECK(mixer_inputs_.find(input) == mixer_inputs_.end());
   mixer_inputs_[input] = error_cb;
   audio_converter_.AddInput(input);
+
+  if (!parallel_inputs_ &&
+      mixer_inputs_.size() >= kMinInputsForParallelMixing) {
+    const int worker_threads = std::min<int>(
+        kMaxParallelMixingThreads, base::SysInfo::NumberOfProcessors() - 1);
+    if (worker_threads > 0)
+      audio_converter_.EnableParallelInputs(worker_threads);
+    parallel_inputs_ = true;
+  }
 }
 
 void AudioRendererMixer::RemoveMixerInput(
@@ -75,9 +103,18 @@ int AudioRendererMixer::Render(AudioBus* audio_bus,
 
   audio_converter_.ConvertWithDelay(
       base::TimeDelta::FromMilliseconds(audio_delay_milliseconds), audio_bus);
+
+  if (base::TimeTicks::Now() - now > buffer_duration_)
+    ++glitch_count_;
+
   return audio_bus->frames();
 }
 
+int AudioRendererMixer::glitch_count() {
+  base::AutoLock auto_lock(mixer_inputs_lock_);
+  return glitch_count_;
+}
+
 void AudioRendererMixer::OnRenderError() {
   base::AutoLock auto_lock(mixer_inputs_lock_);
 
@@ -34,6 +34,10 @@ class MEDIA_EXPORT AudioRendererMixer
     pause_delay_ = delay;
   }
 
+  // Returns the number of Render() calls which took longer than the duration
+  // of the audio they rendered, and so probably made the output glitch.
+  int glitch_count();
+
  private:
   // AudioRendererSink::RenderCallback implementation.
   virtual int Render(AudioBus* audio_bus,
@@ -59,6 +63,14 @@ class MEDIA_EXPORT AudioRendererMixer
   base::TimeTicks last_play_time_;
   bool playing_;
 
+  // Whether |audio_converter_| calls its inputs on several threads; turned on
+  // once there are enough inputs.
+  bool parallel_inputs_;
+
+  // Duration of one output buffer; Render() must finish within it.
+  const base::TimeDelta buffer_duration_;
+  int glitch_count_;
+
   DISALLOW_COPY_AND_ASSIGN(AudioRendererMixer);
 };
 
@@ -23,6 +23,10 @@ void DataSource::set_host(DataSourceHost* host) {
   host_ = host;
 }
 
+bool DataSource::GetCachedSeekIndex(std::string* index) { return false; }
+
+void DataSource::SetCachedSeekIndex(const std::string& index) {}
+
 DataSourceHost* DataSource::host() { return host_; }
 
 }  // namespace media
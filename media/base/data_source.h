@@ -5,6 +5,8 @@
 #ifndef MEDIA_BASE_DATA_SOURCE_H_
 #define MEDIA_BASE_DATA_SOURCE_H_
 
+#include <string>
+
 #include "base/callback.h"
 #include "base/time/time.h"
 #include "media/base/media_export.h"
@@ -62,6 +64,14 @@ class MEDIA_EXPORT DataSource {
   // Values of |bitrate| <= 0 are invalid and should be ignored.
   virtual void SetBitrate(int bitrate) = 0;
 
+  // Lets a demuxer keep a seek index for the media across sessions.
+  // GetCachedSeekIndex() returns true and fills in |index| with whatever was
+  // last passed to SetCachedSeekIndex() for the same media, possibly by an
+  // earlier DataSource.  DataSources backed by a persistent cache should
+  // override both; by default nothing is stored.
+  virtual bool GetCachedSeekIndex(std::string* index);
+  virtual void SetCachedSeekIndex(const std::string& index);
+
  protected:
   DataSourceHost* host();
 
@@ -61,6 +61,23 @@ MEDIA_EXPORT void ConvertYUVToRGB32_SSE(const uint8* yplane,
                                         int rgbstride,
                                         YUVType yuv_type);
 
+MEDIA_EXPORT void ConvertYUVToRGB32_SSE2(const uint8* yplane,
+                                         const uint8* uplane,
+                                         const uint8* vplane,
+                                         uint8* rgbframe,
+                                         int width,
+                                         int height,
+                                         int ystride,
+                                         int uvstride,
+                                         int rgbstride,
+                                         YUVType yuv_type);
+
+MEDIA_EXPORT void ConvertYUVToRGB32Row_SSE2(const uint8* yplane,
+                                            const uint8* uplane,
+                                            const uint8* vplane,
+                                            uint8* rgbframe,
+                                            ptrdiff_t width);
+
 MEDIA_EXPORT void ConvertYUVToRGB32_MMX(const uint8* yplane,
                                         const uint8* uplane,
                                         const uint8* vplane,
@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+#include "media/base/simd/convert_yuv_to_rgb.h"
+#include "media/base/simd/yuv_to_rgb_table.h"
+
+namespace media {
+
+// Converts the two pixels sharing the chroma at |u_buf[0]|, |v_buf[0]|.  The
+// arithmetic is that of ConvertYUVToRGB32Row_C(): the U, V and Y contributions
+// from |kCoefficientsRgbY| are summed with signed saturation, shifted down by
+// 6 and clamped to 0..255 by the final pack.  Each 64-bit half of the result
+// holds one pixel's four 16-bit channels.
+static inline __m128i ConvertYUVToRGB32Pair_SSE2(const uint8* y_buf,
+                                                  const uint8* u_buf,
+                                                  const uint8* v_buf) {
+  __m128i uv = _mm_adds_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+          kCoefficientsRgbY[256 + u_buf[0]])),
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+          kCoefficientsRgbY[512 + v_buf[0]])));
+  __m128i y = _mm_unpacklo_epi64(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+          kCoefficientsRgbY[y_buf[0]])),
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+          kCoefficientsRgbY[y_buf[1]])));
+  return _mm_srai_epi16(_mm_adds_epi16(y, _mm_unpacklo_epi64(uv, uv)), 6);
+}
+
+void ConvertYUVToRGB32Row_SSE2(const uint8* y_buf,
+                               const uint8* u_buf,
+                               const uint8* v_buf,
+                               uint8* rgb_buf,
+                               ptrdiff_t width) {
+  // Four pixels (16 bytes of output) per pass.
+  ptrdiff_t x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i rgb01 = ConvertYUVToRGB32Pair_SSE2(
+        y_buf + x, u_buf + (x >> 1), v_buf + (x >> 1));
+    __m128i rgb23 = ConvertYUVToRGB32Pair_SSE2(
+        y_buf + x + 2, u_buf + (x >> 1) + 1, v_buf + (x >> 1) + 1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb_buf + x * 4),
+                     _mm_packus_epi16(rgb01, rgb23));
+  }
+
+  // Handle the remaining one to three pixels.
+  for (; x < width; x += 2) {
+    uint8 y_pair[2] = { y_buf[x], 0 };
+    if (x + 1 < width)
+      y_pair[1] = y_buf[x + 1];
+    __m128i rgb = ConvertYUVToRGB32Pair_SSE2(
+        y_pair, u_buf + (x >> 1), v_buf + (x >> 1));
+    rgb = _mm_packus_epi16(rgb, rgb);
+    if (x + 1 < width) {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(rgb_buf + x * 4), rgb);
+    } else {
+      *reinterpret_cast<uint32*>(rgb_buf + x * 4) = static_cast<uint32>(
+          _mm_cvtsi128_si32(rgb));
+    }
+  }
+}
+
+void ConvertYUVToRGB32_SSE2(const uint8* yplane,
+                            const uint8* uplane,
+                            const uint8* vplane,
+                            uint8* rgbframe,
+                            int width,
+                            int height,
+                            int ystride,
+                            int uvstride,
+                            int rgbstride,
+                            YUVType yuv_type) {
+  unsigned int y_shift = yuv_type;
+  for (int y = 0; y < height; ++y) {
+    uint8* rgb_row = rgbframe + y * rgbstride;
+    const uint8* y_ptr = yplane + y * ystride;
+    const uint8* u_ptr = uplane + (y >> y_shift) * uvstride;
+    const uint8* v_ptr = vplane + (y >> y_shift) * uvstride;
+
+    ConvertYUVToRGB32Row_SSE2(y_ptr,
+                              u_ptr,
+                              v_ptr,
+                              rgb_row,
+                              width);
+  }
+}
+
+}  // namespace media
@@ -0,0 +1,130 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file must be compiled with AVX enabled (-mavx or /arch:AVX), and its
+// functions must only be called if base::CPU().has_avx() is true.
+
+#include "media/base/vector_math_testing.h"
+
+#include <algorithm>
+
+#include <immintrin.h>  // NOLINT
+
+namespace media {
+namespace vector_math {
+
+// Inputs and outputs are only guaranteed to be aligned to kRequiredAlignment
+// (16 bytes), so unaligned loads and stores are used throughout.  They are as
+// fast as aligned ones when the data happens to be 32 byte aligned.
+
+void FMUL_AVX(const float src[], float scale, int len, float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  const __m256 m_scale = _mm256_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] = src[i] * scale;
+}
+
+void FMAC_AVX(const float src[], float scale, int len, float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  const __m256 m_scale = _mm256_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i),
+                     _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i] * scale;
+}
+
+std::pair<float, float> EWMAAndMaxPower_AVX(
+    float initial_value, const float src[], int len, float smoothing_factor) {
+  // This is EWMAAndMaxPower_SSE() with 8 lanes instead of 4: z[n], ..., z[n-7]
+  // are computed in parallel in lanes 7, ..., 0, where
+  //
+  //   z[n] = a(S[n]^2) + (1-a)^8(z[n-8]) + (1-a)^16(z[n-16]) + ...
+  //
+  // and then combined to give y[n] = z[n] + (1-a)^1(z[n-1]) + ... +
+  // (1-a)^7(z[n-7]).
+
+  const int rem = len % 8;
+  const int last_index = len - rem;
+
+  const __m256 smoothing_factor_x8 = _mm256_set1_ps(smoothing_factor);
+  const float weight_prev = 1.0f - smoothing_factor;
+  const float weight_prev_squared = weight_prev * weight_prev;
+  const float weight_prev_4th = weight_prev_squared * weight_prev_squared;
+  const __m256 weight_prev_8th_x8 =
+      _mm256_set1_ps(weight_prev_4th * weight_prev_4th);
+
+  __m256 max_x8 = _mm256_setzero_ps();
+  __m256 ewma_x8 = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f,
+                                  0.0f, 0.0f, 0.0f, initial_value);
+  int i;
+  for (i = 0; i < last_index; i += 8) {
+    ewma_x8 = _mm256_mul_ps(ewma_x8, weight_prev_8th_x8);
+    const __m256 sample_x8 = _mm256_loadu_ps(src + i);
+    const __m256 sample_squared_x8 = _mm256_mul_ps(sample_x8, sample_x8);
+    max_x8 = _mm256_max_ps(max_x8, sample_squared_x8);
+    ewma_x8 = _mm256_add_ps(ewma_x8,
+                            _mm256_mul_ps(sample_squared_x8,
+                                          smoothing_factor_x8));
+  }
+
+  // Combine the lanes, oldest first.
+  float ewma_lanes[8];
+  float max_lanes[8];
+  _mm256_storeu_ps(ewma_lanes, ewma_x8);
+  _mm256_storeu_ps(max_lanes, max_x8);
+  std::pair<float, float> result(ewma_lanes[0], max_lanes[0]);
+  for (int lane = 1; lane < 8; ++lane) {
+    result.first = result.first * weight_prev + ewma_lanes[lane];
+    result.second = std::max(result.second, max_lanes[lane]);
+  }
+
+  // Handle remaining values at the end of |src|.
+  for (; i < len; ++i) {
+    result.first *= weight_prev;
+    const float sample = src[i];
+    const float sample_squared = sample * sample;
+    result.first += sample_squared * smoothing_factor;
+    result.second = std::max(result.second, sample_squared);
+  }
+
+  return result;
+}
+
+float DotProduct_AVX(const float a[], const float b[], int len) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  __m256 m_sums = _mm256_setzero_ps();
+  for (int i = 0; i < last_index; i += 8) {
+    m_sums = _mm256_add_ps(m_sums, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                                 _mm256_loadu_ps(b + i)));
+  }
+
+  // Sum components together.
+  __m128 m_sums_x4 = _mm_add_ps(_mm256_castps256_ps128(m_sums),
+                                _mm256_extractf128_ps(m_sums, 1));
+  m_sums_x4 = _mm_add_ps(_mm_movehl_ps(m_sums_x4, m_sums_x4), m_sums_x4);
+  m_sums_x4 = _mm_add_ss(m_sums_x4,
+                         _mm_shuffle_ps(m_sums_x4, m_sums_x4, 1));
+  float sum = _mm_cvtss_f32(m_sums_x4);
+
+  // Handle any remaining values that wouldn't fit in an AVX pass.
+  for (int i = last_index; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+}  // namespace vector_math
+}  // namespace media
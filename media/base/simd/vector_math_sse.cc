@@ -114,5 +114,25 @@ std::pair<float, float> EWMAAndMaxPower_SSE(
   return result;
 }
 
+float DotProduct_SSE(const float a[], const float b[], int len) {
+  const int rem = len % 4;
+  const int last_index = len - rem;
+  __m128 m_sums = _mm_setzero_ps();
+  // |b| may be unaligned, e.g. when sliding over a search region.
+  for (int i = 0; i < last_index; i += 4) {
+    m_sums = _mm_add_ps(m_sums,
+                        _mm_mul_ps(_mm_load_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+
+  // Sum components together.
+  m_sums = _mm_add_ps(_mm_movehl_ps(m_sums, m_sums), m_sums);
+  float sum = EXTRACT_FLOAT(m_sums, 0) + EXTRACT_FLOAT(m_sums, 1);
+
+  // Handle any remaining values that wouldn't fit in an SSE pass.
+  for (int i = last_index; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
 }  // namespace vector_math
 }  // namespace media
@@ -110,23 +110,28 @@ static double SincScaleFactor(double io_ratio) {
 // Force NaCl code to use C routines since (at present) nothing there uses these
 // methods and plumbing the -msse built library is non-trivial.
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+// X86 CPU detection required, since AVX is never assumed at compile time.
+// Functions will be set by InitializeCPUSpecificFeatures().  If SSE is known
+// to be available at compile time, Convolve_SSE() is used until then.
 #if defined(__SSE__)
-#define CONVOLVE_FUNC Convolve_SSE
-void SincResampler::InitializeCPUSpecificFeatures() {}
+#define CONVOLVE_FUNC (g_convolve_proc_ ? g_convolve_proc_ : Convolve_SSE)
 #else
-// X86 CPU detection required.  Functions will be set by
-// InitializeCPUSpecificFeatures().
 // TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
 #define CONVOLVE_FUNC g_convolve_proc_
+#endif
 
 typedef float (*ConvolveProc)(const float*, const float*, const float*, double);
 static ConvolveProc g_convolve_proc_ = NULL;
 
 void SincResampler::InitializeCPUSpecificFeatures() {
-  CHECK(!g_convolve_proc_);
-  g_convolve_proc_ = base::CPU().has_sse() ? Convolve_SSE : Convolve_C;
+  base::CPU cpu;
+  if (cpu.has_avx())
+    g_convolve_proc_ = Convolve_AVX;
+  else if (cpu.has_sse())
+    g_convolve_proc_ = Convolve_SSE;
+  else
+    g_convolve_proc_ = Convolve_C;
 }
-#endif
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define CONVOLVE_FUNC Convolve_NEON
 void SincResampler::InitializeCPUSpecificFeatures() {}
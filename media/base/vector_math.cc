@@ -22,45 +22,62 @@ namespace vector_math {
 // Force NaCl code to use C routines since (at present) nothing there uses these
 // methods and plumbing the -msse built library is non-trivial.
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
-#if defined(__SSE__)
-#define FMAC_FUNC FMAC_SSE
-#define FMUL_FUNC FMUL_SSE
-#define EWMAAndMaxPower_FUNC EWMAAndMaxPower_SSE
-void Initialize() {}
-#else
-// X86 CPU detection required.  Functions will be set by Initialize().
-// TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
+// X86 CPU detection required, since AVX is never assumed at compile time.
+// Functions will be set by Initialize().  If SSE is known to be available at
+// compile time, the SSE versions are used until then.
 #define FMAC_FUNC g_fmac_proc_
 #define FMUL_FUNC g_fmul_proc_
 #define EWMAAndMaxPower_FUNC g_ewma_power_proc_
+#define DotProduct_FUNC g_dot_product_proc_
 
 typedef void (*MathProc)(const float src[], float scale, int len, float dest[]);
-static MathProc g_fmac_proc_ = NULL;
-static MathProc g_fmul_proc_ = NULL;
 typedef std::pair<float, float> (*EWMAAndMaxPowerProc)(
     float initial_value, const float src[], int len, float smoothing_factor);
+typedef float (*DotProductProc)(const float a[], const float b[], int len);
+#if defined(__SSE__)
+static MathProc g_fmac_proc_ = FMAC_SSE;
+static MathProc g_fmul_proc_ = FMUL_SSE;
+static EWMAAndMaxPowerProc g_ewma_power_proc_ = EWMAAndMaxPower_SSE;
+static DotProductProc g_dot_product_proc_ = DotProduct_SSE;
+#else
+// TODO(dalecurtis): Once Chrome moves to an SSE baseline this can be removed.
+static MathProc g_fmac_proc_ = NULL;
+static MathProc g_fmul_proc_ = NULL;
 static EWMAAndMaxPowerProc g_ewma_power_proc_ = NULL;
+static DotProductProc g_dot_product_proc_ = NULL;
+#endif
 
 void Initialize() {
-  CHECK(!g_fmac_proc_);
-  CHECK(!g_fmul_proc_);
-  CHECK(!g_ewma_power_proc_);
-  const bool kUseSSE = base::CPU().has_sse();
-  g_fmac_proc_ = kUseSSE ? FMAC_SSE : FMAC_C;
-  g_fmul_proc_ = kUseSSE ? FMUL_SSE : FMUL_C;
-  g_ewma_power_proc_ = kUseSSE ? EWMAAndMaxPower_SSE : EWMAAndMaxPower_C;
+  base::CPU cpu;
+  if (cpu.has_avx()) {
+    g_fmac_proc_ = FMAC_AVX;
+    g_fmul_proc_ = FMUL_AVX;
+    g_ewma_power_proc_ = EWMAAndMaxPower_AVX;
+    g_dot_product_proc_ = DotProduct_AVX;
+  } else if (cpu.has_sse()) {
+    g_fmac_proc_ = FMAC_SSE;
+    g_fmul_proc_ = FMUL_SSE;
+    g_ewma_power_proc_ = EWMAAndMaxPower_SSE;
+    g_dot_product_proc_ = DotProduct_SSE;
+  } else {
+    g_fmac_proc_ = FMAC_C;
+    g_fmul_proc_ = FMUL_C;
+    g_ewma_power_proc_ = EWMAAndMaxPower_C;
+    g_dot_product_proc_ = DotProduct_C;
+  }
 }
-#endif
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define FMAC_FUNC FMAC_NEON
 #define FMUL_FUNC FMUL_NEON
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_NEON
+#define DotProduct_FUNC DotProduct_NEON
 void Initialize() {}
 #else
 // Unknown architecture.
 #define FMAC_FUNC FMAC_C
 #define FMUL_FUNC FMUL_C
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_C
+#define DotProduct_FUNC DotProduct_C
 void Initialize() {}
 #endif
 
@@ -109,6 +126,19 @@ std::pair<float, float> EWMAAndMaxPower_C(
   return result;
 }
 
+float DotProduct(const float a[], const float b[], int len) {
+  // Ensure |a| is 16-byte aligned.
+  DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(a) & (kRequiredAlignment - 1));
+  return DotProduct_FUNC(a, b, len);
+}
+
+float DotProduct_C(const float a[], const float b[], int len) {
+  float sum = 0.0f;
+  for (int i = 0; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 void FMAC_NEON(const float src[], float scale, int len, float dest[]) {
   const int rem = len % 4;
@@ -200,6 +230,23 @@ std::pair<float, float> EWMAAndMaxPower_NEON(
 
   return result;
 }
+
+float DotProduct_NEON(const float a[], const float b[], int len) {
+  const int rem = len % 4;
+  const int last_index = len - rem;
+  float32x4_t m_sums = vmovq_n_f32(0);
+  for (int i = 0; i < last_index; i += 4)
+    m_sums = vmlaq_f32(m_sums, vld1q_f32(a + i), vld1q_f32(b + i));
+
+  // Sum components together.
+  float32x2_t m_half = vadd_f32(vget_high_f32(m_sums), vget_low_f32(m_sums));
+  float sum = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+
+  // Handle any remaining values that wouldn't fit in an NEON pass.
+  for (int i = last_index; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
 #endif
 
 }  // namespace vector_math
@@ -15,9 +15,9 @@ namespace vector_math {
 // Required alignment for inputs and outputs to all vector math functions
 enum { kRequiredAlignment = 16 };
 
-// Selects runtime specific optimizations such as SSE.  Must be called prior to
-// calling FMAC() or FMUL().  Called during media library initialization; most
-// users should never have to call this.
+// Selects runtime specific optimizations such as SSE and AVX.  Must be called
+// prior to calling any of the functions below.  Called during media library
+// initialization; most users should never have to call this.
 MEDIA_EXPORT void Initialize();
 
 // Multiply each element of |src| (up to |len|) by |scale| and add to |dest|.
@@ -38,6 +38,10 @@ MEDIA_EXPORT void FMUL(const float src[], float scale, int len, float dest[]);
 MEDIA_EXPORT std::pair<float, float> EWMAAndMaxPower(
     float initial_value, const float src[], int len, float smoothing_factor);
 
+// Returns the sum of the products of the elements of |a| and |b| (up to
+// |len|).  |a| must be aligned by kRequiredAlignment; |b| need not be.
+MEDIA_EXPORT float DotProduct(const float a[], const float b[], int len);
+
 }  // namespace vector_math
 }  // namespace media
 
@@ -73,6 +73,26 @@ class VectorMathPerfTest : public testing::Test {
                            true);
   }
 
+  void RunBenchmark(float (*fn)(const float[], const float[], int),
+                    bool aligned,
+                    const std::string& test_name,
+                    const std::string& trace_name) {
+    TimeTicks start = TimeTicks::HighResNow();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      fn(input_vector_.get(),
+         output_vector_.get(),
+         kVectorSize - (aligned ? 0 : 1));
+    }
+    double total_time_milliseconds =
+        (TimeTicks::HighResNow() - start).InMillisecondsF();
+    perf_test::PrintResult(test_name,
+                           "",
+                           trace_name,
+                           kBenchmarkIterations / total_time_milliseconds,
+                           "runs/ms",
+                           true);
+  }
+
  protected:
   scoped_ptr<float, base::AlignedFreeDeleter> input_vector_;
   scoped_ptr<float, base::AlignedFreeDeleter> output_vector_;
@@ -107,6 +127,14 @@ TEST_F(VectorMathPerfTest, FMAC) {
   RunBenchmark(
       vector_math::FMAC_FUNC, true, "vector_math_fmac", "optimized_aligned");
 #endif
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx()) {
+    RunBenchmark(vector_math::FMAC_AVX, false, "vector_math_fmac",
+                 "optimized_avx_unaligned");
+    RunBenchmark(vector_math::FMAC_AVX, true, "vector_math_fmac",
+                 "optimized_avx_aligned");
+  }
+#endif
 }
 
 #undef FMAC_FUNC
@@ -138,6 +166,14 @@ TEST_F(VectorMathPerfTest, FMUL) {
   RunBenchmark(
       vector_math::FMUL_FUNC, true, "vector_math_fmul", "optimized_aligned");
 #endif
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx()) {
+    RunBenchmark(vector_math::FMUL_AVX, false, "vector_math_fmul",
+                 "optimized_avx_unaligned");
+    RunBenchmark(vector_math::FMUL_AVX, true, "vector_math_fmul",
+                 "optimized_avx_aligned");
+  }
+#endif
 }
 
 #undef FMUL_FUNC
@@ -174,8 +210,53 @@ TEST_F(VectorMathPerfTest, EWMAAndMaxPower) {
                "vector_math_ewma_and_max_power",
                "optimized_aligned");
 #endif
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx()) {
+    RunBenchmark(vector_math::EWMAAndMaxPower_AVX,
+                 kVectorSize - 1,
+                 "vector_math_ewma_and_max_power",
+                 "optimized_avx_unaligned");
+    RunBenchmark(vector_math::EWMAAndMaxPower_AVX,
+                 kVectorSize,
+                 "vector_math_ewma_and_max_power",
+                 "optimized_avx_aligned");
+  }
+#endif
 }
 
 #undef EWMAAndMaxPower_FUNC
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#define DotProduct_FUNC DotProduct_SSE
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+#define DotProduct_FUNC DotProduct_NEON
+#endif
+
+// Benchmark for each optimized vector_math::DotProduct() method.
+TEST_F(VectorMathPerfTest, DotProduct) {
+  // Benchmark DotProduct_C().
+  RunBenchmark(
+      vector_math::DotProduct_C, true, "vector_math_dot_product",
+      "unoptimized");
+#if defined(DotProduct_FUNC)
+#if defined(ARCH_CPU_X86_FAMILY)
+  ASSERT_TRUE(base::CPU().has_sse());
+#endif
+  RunBenchmark(vector_math::DotProduct_FUNC, false, "vector_math_dot_product",
+               "optimized_unaligned");
+  RunBenchmark(vector_math::DotProduct_FUNC, true, "vector_math_dot_product",
+               "optimized_aligned");
+#endif
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (base::CPU().has_avx()) {
+    RunBenchmark(vector_math::DotProduct_AVX, false, "vector_math_dot_product",
+                 "optimized_avx_unaligned");
+    RunBenchmark(vector_math::DotProduct_AVX, true, "vector_math_dot_product",
+                 "optimized_avx_aligned");
+  }
+#endif
+}
+
+#undef DotProduct_FUNC
+
 } // namespace media
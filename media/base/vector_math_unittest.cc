@@ -83,6 +83,14 @@ TEST_F(VectorMathTest, FMAC) {
         input_vector_.get(), kScale, kVectorSize, output_vector_.get());
     VerifyOutput(kResult);
   }
+
+  if (base::CPU().has_avx()) {
+    SCOPED_TRACE("FMAC_AVX");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMAC_AVX(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -125,6 +133,14 @@ TEST_F(VectorMathTest, FMUL) {
         input_vector_.get(), kScale, kVectorSize, output_vector_.get());
     VerifyOutput(kResult);
   }
+
+  if (base::CPU().has_avx()) {
+    SCOPED_TRACE("FMUL_AVX");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMUL_AVX(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -138,6 +154,43 @@ TEST_F(VectorMathTest, FMUL) {
 #endif
 }
 
+// Ensure each optimized vector_math::DotProduct() method returns the same
+// value.  The sizes cover a partial final pass of each implementation.
+TEST_F(VectorMathTest, DotProduct) {
+  static const float kResult = kInputFillValue * kOutputFillValue;
+  static const int kSizes[] = { 0, 1, 7, 8, 13, 64, kVectorSize - 1 };
+
+  FillTestVectors(kInputFillValue, kOutputFillValue);
+  for (size_t i = 0; i < arraysize(kSizes); ++i) {
+    const int len = kSizes[i];
+    SCOPED_TRACE(base::IntToString(len));
+    const float expected = kResult * len;
+
+    EXPECT_FLOAT_EQ(expected, vector_math::DotProduct(
+        input_vector_.get(), output_vector_.get(), len));
+    // Only the first input has to be aligned.
+    EXPECT_FLOAT_EQ(expected, vector_math::DotProduct(
+        input_vector_.get(), output_vector_.get() + 1, len));
+    EXPECT_FLOAT_EQ(expected, vector_math::DotProduct_C(
+        input_vector_.get(), output_vector_.get(), len));
+
+#if defined(ARCH_CPU_X86_FAMILY)
+    ASSERT_TRUE(base::CPU().has_sse());
+    EXPECT_FLOAT_EQ(expected, vector_math::DotProduct_SSE(
+        input_vector_.get(), output_vector_.get(), len));
+    if (base::CPU().has_avx()) {
+      EXPECT_FLOAT_EQ(expected, vector_math::DotProduct_AVX(
+          input_vector_.get(), output_vector_.get(), len));
+    }
+#endif
+
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+    EXPECT_FLOAT_EQ(expected, vector_math::DotProduct_NEON(
+        input_vector_.get(), output_vector_.get(), len));
+#endif
+  }
+}
+
 namespace {
 
 class EWMATestScenario {
@@ -226,6 +279,14 @@ class EWMATestScenario {
       EXPECT_NEAR(expected_final_avg_, result.first, 0.0000001f);
       EXPECT_NEAR(expected_max_, result.second, 0.0000001f);
     }
+
+    if (base::CPU().has_avx()) {
+      SCOPED_TRACE("EWMAAndMaxPower_AVX");
+      const std::pair<float, float>& result = vector_math::EWMAAndMaxPower_AVX(
+          initial_value_, data_.get(), data_len_, smoothing_factor_);
+      EXPECT_NEAR(expected_final_avg_, result.first, 0.0000001f);
+      EXPECT_NEAR(expected_max_, result.second, 0.0000001f);
+    }
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -17,10 +17,18 @@
 
 #include "media/base/yuv_convert.h"
 
+#include <algorithm>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/callback.h"
 #include "base/cpu.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
+#include "base/threading/worker_pool.h"
 #include "build/build_config.h"
 #include "media/base/simd/convert_rgb_to_yuv.h"
 #include "media/base/simd/convert_yuv_to_rgb.h"
@@ -161,6 +169,8 @@ void InitializeCPUSpecificYUVConversions() {
   if (cpu.has_sse2()) {
     g_filter_yuv_rows_proc_ = FilterYUVRows_SSE2;
     g_convert_rgb32_to_yuv_proc_ = ConvertRGB32ToYUV_SSE2;
+    g_convert_yuv_to_rgb32_row_proc_ = ConvertYUVToRGB32Row_SSE2;
+    g_convert_yuv_to_rgb32_proc_ = ConvertYUVToRGB32_SSE2;
 
 #if defined(ARCH_CPU_X86_64)
     g_scale_yuv_to_rgb32_row_proc_ = ScaleYUVToRGB32Row_SSE2_X64;
@@ -190,109 +200,150 @@ const int kFractionBits = 16;
 const int kFractionMax = 1 << kFractionBits;
 const int kFractionMask = ((1 << kFractionBits) - 1);
 
-// Scale a frame of YUV to 32 bit ARGB.
-void ScaleYUVToRGB32(const uint8* y_buf,
-                     const uint8* u_buf,
-                     const uint8* v_buf,
-                     uint8* rgb_buf,
-                     int source_width,
-                     int source_height,
-                     int width,
-                     int height,
-                     int y_pitch,
-                     int uv_pitch,
-                     int rgb_pitch,
-                     YUVType yuv_type,
-                     Rotate view_rotate,
-                     ScaleFilter filter) {
-  // Handle zero sized sources and destinations.
-  if ((yuv_type == YV12 && (source_width < 2 || source_height < 2)) ||
-      (yuv_type == YV16 && (source_width < 2 || source_height < 1)) ||
-      width == 0 || height == 0)
-    return;
-
-  // 4096 allows 3 buffers to fit in 12k.
-  // Helps performance on CPU with 16K L1 cache.
-  // Large enough for 3830x2160 and 30" displays which are 2560x1600.
-  const int kFilterBufferSize = 4096;
-  // Disable filtering if the screen is too big (to avoid buffer overflows).
-  // This should never happen to regular users: they don't have monitors
-  // wider than 4096 pixels.
-  // TODO(fbarchard): Allow rotated videos to filter.
-  if (source_width > kFilterBufferSize || view_rotate)
-    filter = FILTER_NONE;
+// Runs |convert_band| for |band| and then |done|.  Used to run the bands of a
+// frame on the worker pool.
+static void RunBand(const base::Callback<void(int)>& convert_band,
+                    int band,
+                    const base::Closure& done) {
+  convert_band.Run(band);
+  done.Run();
+}
 
-  unsigned int y_shift = yuv_type;
-  // Diagram showing origin and direction of source sampling.
-  // ->0   4<-
-  // 7       3
-  //
-  // 6       5
-  // ->1   2<-
-  // Rotations that start at right side of image.
-  if ((view_rotate == ROTATE_180) || (view_rotate == ROTATE_270) ||
-      (view_rotate == MIRROR_ROTATE_0) || (view_rotate == MIRROR_ROTATE_90)) {
-    y_buf += source_width - 1;
-    u_buf += source_width / 2 - 1;
-    v_buf += source_width / 2 - 1;
-    source_width = -source_width;
+// Runs |convert_band| for bands 1 to |num_bands| - 1 on the worker pool and for
+// band 0 on the calling thread, and returns once all of them are done.  The
+// calling thread must be allowed to wait.
+static void RunInBands(int num_bands,
+                       const base::Callback<void(int)>& convert_band) {
+  DCHECK_GE(num_bands, 1);
+  if (num_bands == 1) {
+    convert_band.Run(0);
+    return;
   }
-  // Rotations that start at bottom of image.
-  if ((view_rotate == ROTATE_90) || (view_rotate == ROTATE_180) ||
-      (view_rotate == MIRROR_ROTATE_90) || (view_rotate == MIRROR_ROTATE_180)) {
-    y_buf += (source_height - 1) * y_pitch;
-    u_buf += ((source_height >> y_shift) - 1) * uv_pitch;
-    v_buf += ((source_height >> y_shift) - 1) * uv_pitch;
-    source_height = -source_height;
+
+  base::WaitableEvent done(false, false);
+  base::Closure band_done = base::BarrierClosure(
+      num_bands - 1,
+      base::Bind(&base::WaitableEvent::Signal, base::Unretained(&done)));
+  for (int band = 1; band < num_bands; ++band) {
+    base::Closure task = base::Bind(&RunBand, convert_band, band, band_done);
+    if (!base::WorkerPool::PostTask(FROM_HERE, task, false))
+      task.Run();
   }
+  convert_band.Run(0);
+  done.Wait();
+}
 
-  int source_dx = source_width * kFractionMax / width;
+// Returns the first row of |band| when |height| rows are split into
+// |num_bands| bands.  Rows are split in pairs so that bands of YV12 frames
+// don't share chroma rows.
+static int GetBandStartRow(int height, int num_bands, int band) {
+  if (band == num_bands)
+    return height;
+  return static_cast<int>(static_cast<int64>(height) * band / num_bands) & ~1;
+}
 
-  if ((view_rotate == ROTATE_90) || (view_rotate == ROTATE_270)) {
-    int tmp = height;
-    height = width;
-    width = tmp;
-    tmp = source_height;
-    source_height = source_width;
-    source_width = tmp;
-    int source_dy = source_height * kFractionMax / height;
-    source_dx = ((source_dy >> kFractionBits) * y_pitch) << kFractionBits;
-    if (view_rotate == ROTATE_90) {
-      y_pitch = -1;
-      uv_pitch = -1;
-      source_height = -source_height;
-    } else {
-      y_pitch = 1;
-      uv_pitch = 1;
-    }
-  }
+// Limits |num_bands| so that every band has some rows to convert.
+static int ClampNumBands(int height, int num_bands) {
+  return std::max(1, std::min(num_bands, height / 2));
+}
+
+namespace {
+
+// Arguments of ConvertYUVToRGB32InBands(), shared by all the bands.
+struct ConvertYUVToRGB32Params {
+  const uint8* y_buf;
+  const uint8* u_buf;
+  const uint8* v_buf;
+  uint8* rgb_buf;
+  int width;
+  int height;
+  int y_pitch;
+  int uv_pitch;
+  int rgb_pitch;
+  YUVType yuv_type;
+};
+
+// State of ScaleYUVToRGB32InBands() once rotation has been applied, shared by
+// all the bands.
+struct ScaleYUVToRGB32Params {
+  const uint8* y_buf;
+  const uint8* u_buf;
+  const uint8* v_buf;
+  uint8* rgb_buf;
+  int source_width;
+  int source_height;
+  int width;
+  int height;
+  int y_pitch;
+  int uv_pitch;
+  int rgb_pitch;
+  unsigned int y_shift;
+  ScaleFilter filter;
+  int source_dx;
+  // Source y-coordinate of the first destination row, and the step between
+  // rows, in 16.16 fixed point.
+  int source_y_subpixel_start;
+  int source_y_subpixel_delta;
+};
+
+}  // namespace
+
+static void ConvertYUVToRGB32Band(const ConvertYUVToRGB32Params* params,
+                                  int num_bands,
+                                  int band) {
+  int start_row = GetBandStartRow(params->height, num_bands, band);
+  int end_row = GetBandStartRow(params->height, num_bands, band + 1);
+  unsigned int uv_start_row = start_row >> params->yuv_type;
+  g_convert_yuv_to_rgb32_proc_(
+      params->y_buf + start_row * params->y_pitch,
+      params->u_buf + uv_start_row * params->uv_pitch,
+      params->v_buf + uv_start_row * params->uv_pitch,
+      params->rgb_buf + start_row * params->rgb_pitch,
+      params->width,
+      end_row - start_row,
+      params->y_pitch,
+      params->uv_pitch,
+      params->rgb_pitch,
+      params->yuv_type);
+}
+
+// 4096 allows 3 buffers to fit in 12k.
+// Helps performance on CPU with 16K L1 cache.
+// Large enough for 3830x2160 and 30" displays which are 2560x1600.
+static const int kScaleFilterBufferSize = 4096;
+
+static void ScaleYUVToRGB32Band(const ScaleYUVToRGB32Params* params,
+                                int num_bands,
+                                int band) {
+  const uint8* y_buf = params->y_buf;
+  const uint8* u_buf = params->u_buf;
+  const uint8* v_buf = params->v_buf;
+  const int source_width = params->source_width;
+  const int source_height = params->source_height;
+  const int width = params->width;
+  const int y_pitch = params->y_pitch;
+  const int uv_pitch = params->uv_pitch;
+  const unsigned int y_shift = params->y_shift;
+  const ScaleFilter filter = params->filter;
+  const int source_dx = params->source_dx;
+  const int source_y_subpixel_delta = params->source_y_subpixel_delta;
 
   // Need padding because FilterRows() will write 1 to 16 extra pixels
   // after the end for SSE2 version.
-  uint8 yuvbuf[16 + kFilterBufferSize * 3 + 16];
+  uint8 yuvbuf[16 + kScaleFilterBufferSize * 3 + 16];
   uint8* ybuf =
       reinterpret_cast<uint8*>(reinterpret_cast<uintptr_t>(yuvbuf + 15) & ~15);
-  uint8* ubuf = ybuf + kFilterBufferSize;
-  uint8* vbuf = ubuf + kFilterBufferSize;
-
-  // TODO(fbarchard): Fixed point math is off by 1 on negatives.
+  uint8* ubuf = ybuf + kScaleFilterBufferSize;
+  uint8* vbuf = ubuf + kScaleFilterBufferSize;
 
-  // We take a y-coordinate in [0,1] space in the source image space, and
-  // transform to a y-coordinate in [0,1] space in the destination image space.
-  // Note that the coordinate endpoints lie on pixel boundaries, not on pixel
-  // centers: e.g. a two-pixel-high image will have pixel centers at 0.25 and
-  // 0.75.  The formula is as follows (in fixed-point arithmetic):
-  //   y_dst = dst_height * ((y_src + 0.5) / src_height)
-  //   dst_pixel = clamp([0, dst_height - 1], floor(y_dst - 0.5))
-  // Implement this here as an accumulator + delta, to avoid expensive math
-  // in the loop.
+  int start_row = GetBandStartRow(params->height, num_bands, band);
+  int end_row = GetBandStartRow(params->height, num_bands, band + 1);
   int source_y_subpixel_accum =
-      ((kFractionMax / 2) * source_height) / height - (kFractionMax / 2);
-  int source_y_subpixel_delta = ((1 << kFractionBits) * source_height) / height;
+      params->source_y_subpixel_start + start_row * source_y_subpixel_delta;
 
   // TODO(fbarchard): Split this into separate function for better efficiency.
-  for (int y = 0; y < height; ++y) {
-    uint8* dest_pixel = rgb_buf + y * rgb_pitch;
+  for (int y = start_row; y < end_row; ++y) {
+    uint8* dest_pixel = params->rgb_buf + y * params->rgb_pitch;
     int source_y_subpixel = source_y_subpixel_accum;
     source_y_subpixel_accum += source_y_subpixel_delta;
     if (source_y_subpixel < 0)
@@ -369,6 +420,147 @@ void ScaleYUVToRGB32(const uint8* y_buf,
   g_empty_register_state_proc_();
 }
 
+// Scale a frame of YUV to 32 bit ARGB.
+void ScaleYUVToRGB32(const uint8* y_buf,
+                     const uint8* u_buf,
+                     const uint8* v_buf,
+                     uint8* rgb_buf,
+                     int source_width,
+                     int source_height,
+                     int width,
+                     int height,
+                     int y_pitch,
+                     int uv_pitch,
+                     int rgb_pitch,
+                     YUVType yuv_type,
+                     Rotate view_rotate,
+                     ScaleFilter filter) {
+  ScaleYUVToRGB32InBands(y_buf,
+                         u_buf,
+                         v_buf,
+                         rgb_buf,
+                         source_width,
+                         source_height,
+                         width,
+                         height,
+                         y_pitch,
+                         uv_pitch,
+                         rgb_pitch,
+                         yuv_type,
+                         view_rotate,
+                         filter,
+                         1);
+}
+
+void ScaleYUVToRGB32InBands(const uint8* y_buf,
+                            const uint8* u_buf,
+                            const uint8* v_buf,
+                            uint8* rgb_buf,
+                            int source_width,
+                            int source_height,
+                            int width,
+                            int height,
+                            int y_pitch,
+                            int uv_pitch,
+                            int rgb_pitch,
+                            YUVType yuv_type,
+                            Rotate view_rotate,
+                            ScaleFilter filter,
+                            int num_bands) {
+  // Handle zero sized sources and destinations.
+  if ((yuv_type == YV12 && (source_width < 2 || source_height < 2)) ||
+      (yuv_type == YV16 && (source_width < 2 || source_height < 1)) ||
+      width == 0 || height == 0)
+    return;
+
+  // Disable filtering if the screen is too big (to avoid buffer overflows).
+  // This should never happen to regular users: they don't have monitors
+  // wider than 4096 pixels.
+  // TODO(fbarchard): Allow rotated videos to filter.
+  if (source_width > kScaleFilterBufferSize || view_rotate)
+    filter = FILTER_NONE;
+
+  unsigned int y_shift = yuv_type;
+  // Diagram showing origin and direction of source sampling.
+  // ->0   4<-
+  // 7       3
+  //
+  // 6       5
+  // ->1   2<-
+  // Rotations that start at right side of image.
+  if ((view_rotate == ROTATE_180) || (view_rotate == ROTATE_270) ||
+      (view_rotate == MIRROR_ROTATE_0) || (view_rotate == MIRROR_ROTATE_90)) {
+    y_buf += source_width - 1;
+    u_buf += source_width / 2 - 1;
+    v_buf += source_width / 2 - 1;
+    source_width = -source_width;
+  }
+  // Rotations that start at bottom of image.
+  if ((view_rotate == ROTATE_90) || (view_rotate == ROTATE_180) ||
+      (view_rotate == MIRROR_ROTATE_90) || (view_rotate == MIRROR_ROTATE_180)) {
+    y_buf += (source_height - 1) * y_pitch;
+    u_buf += ((source_height >> y_shift) - 1) * uv_pitch;
+    v_buf += ((source_height >> y_shift) - 1) * uv_pitch;
+    source_height = -source_height;
+  }
+
+  int source_dx = source_width * kFractionMax / width;
+
+  if ((view_rotate == ROTATE_90) || (view_rotate == ROTATE_270)) {
+    int tmp = height;
+    height = width;
+    width = tmp;
+    tmp = source_height;
+    source_height = source_width;
+    source_width = tmp;
+    int source_dy = source_height * kFractionMax / height;
+    source_dx = ((source_dy >> kFractionBits) * y_pitch) << kFractionBits;
+    if (view_rotate == ROTATE_90) {
+      y_pitch = -1;
+      uv_pitch = -1;
+      source_height = -source_height;
+    } else {
+      y_pitch = 1;
+      uv_pitch = 1;
+    }
+  }
+
+  // TODO(fbarchard): Fixed point math is off by 1 on negatives.
+
+  // We take a y-coordinate in [0,1] space in the source image space, and
+  // transform to a y-coordinate in [0,1] space in the destination image space.
+  // Note that the coordinate endpoints lie on pixel boundaries, not on pixel
+  // centers: e.g. a two-pixel-high image will have pixel centers at 0.25 and
+  // 0.75.  The formula is as follows (in fixed-point arithmetic):
+  //   y_dst = dst_height * ((y_src + 0.5) / src_height)
+  //   dst_pixel = clamp([0, dst_height - 1], floor(y_dst - 0.5))
+  // Implement this here as an accumulator + delta, to avoid expensive math
+  // in the loop.
+  ScaleYUVToRGB32Params params;
+  params.y_buf = y_buf;
+  params.u_buf = u_buf;
+  params.v_buf = v_buf;
+  params.rgb_buf = rgb_buf;
+  params.source_width = source_width;
+  params.source_height = source_height;
+  params.width = width;
+  params.height = height;
+  params.y_pitch = y_pitch;
+  params.uv_pitch = uv_pitch;
+  params.rgb_pitch = rgb_pitch;
+  params.y_shift = y_shift;
+  params.filter = filter;
+  params.source_dx = source_dx;
+  params.source_y_subpixel_start =
+      ((kFractionMax / 2) * source_height) / height - (kFractionMax / 2);
+  params.source_y_subpixel_delta =
+      ((1 << kFractionBits) * source_height) / height;
+
+  num_bands = ClampNumBands(height, num_bands);
+  RunInBands(num_bands,
+             base::Bind(&ScaleYUVToRGB32Band, &params, num_bands));
+}
+
 // Scale a frame of YV12 to 32 bit ARGB for a specific rectangle.
 void ScaleYUVToRGB32WithRect(const uint8* y_buf,
                              const uint8* u_buf,
@@ -630,6 +822,34 @@ void ConvertYUVToRGB32(const uint8* yplane,
                                yuv_type);
 }
 
+void ConvertYUVToRGB32InBands(const uint8* yplane,
+                              const uint8* uplane,
+                              const uint8* vplane,
+                              uint8* rgbframe,
+                              int width,
+                              int height,
+                              int ystride,
+                              int uvstride,
+                              int rgbstride,
+                              YUVType yuv_type,
+                              int num_bands) {
+  ConvertYUVToRGB32Params params;
+  params.y_buf = yplane;
+  params.u_buf = uplane;
+  params.v_buf = vplane;
+  params.rgb_buf = rgbframe;
+  params.width = width;
+  params.height = height;
+  params.y_pitch = ystride;
+  params.uv_pitch = uvstride;
+  params.rgb_pitch = rgbstride;
+  params.yuv_type = yuv_type;
+
+  num_bands = ClampNumBands(height, num_bands);
+  RunInBands(num_bands,
+             base::Bind(&ConvertYUVToRGB32Band, &params, num_bands));
+}
+
 void ConvertYUVAToARGB(const uint8* yplane,
                        const uint8* uplane,
                        const uint8* vplane,
@@ -64,6 +64,23 @@ MEDIA_EXPORT void ConvertYUVToRGB32(const uint8* yplane,
                                     int rgbstride,
                                     YUVType yuv_type);
 
+// Same as ConvertYUVToRGB32(), but the frame is split into up to |num_bands|
+// bands of rows which are converted in parallel: one on the calling thread
+// and the rest on the base::WorkerPool.  Returns once the whole frame has been
+// converted, so the calling thread must be allowed to wait.  Only worthwhile
+// for large frames; with |num_bands| == 1 this is ConvertYUVToRGB32().
+MEDIA_EXPORT void ConvertYUVToRGB32InBands(const uint8* yplane,
+                                           const uint8* uplane,
+                                           const uint8* vplane,
+                                           uint8* rgbframe,
+                                           int width,
+                                           int height,
+                                           int ystride,
+                                           int uvstride,
+                                           int rgbstride,
+                                           YUVType yuv_type,
+                                           int num_bands);
+
 // Convert a frame of YUVA to 32 bit ARGB.
 // Pass in YV12A
 MEDIA_EXPORT void ConvertYUVAToARGB(const uint8* yplane,
@@ -96,6 +113,24 @@ MEDIA_EXPORT void ScaleYUVToRGB32(const uint8* yplane,
                                   Rotate view_rotate,
                                   ScaleFilter filter);
 
+// Same as ScaleYUVToRGB32(), but the destination is split into bands of rows
+// which are scaled in parallel, as in ConvertYUVToRGB32InBands().
+MEDIA_EXPORT void ScaleYUVToRGB32InBands(const uint8* yplane,
+                                         const uint8* uplane,
+                                         const uint8* vplane,
+                                         uint8* rgbframe,
+                                         int source_width,
+                                         int source_height,
+                                         int width,
+                                         int height,
+                                         int ystride,
+                                         int uvstride,
+                                         int rgbstride,
+                                         YUVType yuv_type,
+                                         Rotate view_rotate,
+                                         ScaleFilter filter,
+                                         int num_bands);
+
 // Biliner Scale a frame of YV12 to 32 bits ARGB on a specified rectangle.
 // |yplane|, etc and |rgbframe| should point to the top-left pixels of the
 // source and destination buffers.
@@ -0,0 +1,157 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+
+#include "base/cpu.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/sys_info.h"
+#include "base/time/time.h"
+#include "media/base/simd/convert_yuv_to_rgb.h"
+#include "media/base/yuv_convert.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBpp = 4;
+
+// Number of frames converted by each benchmark.
+static const int kPerfTestIterations = 20;
+
+// Frame sizes, from 360p up to 4K.
+static const struct {
+  int width;
+  int height;
+} kFrameSizes[] = {
+  { 640, 360 },
+  { 1280, 720 },
+  { 1920, 1080 },
+  { 3840, 2160 },
+};
+
+class YUVConvertPerfTest : public testing::Test {
+ public:
+  YUVConvertPerfTest()
+      : num_bands_(std::min(4, base::SysInfo::NumberOfProcessors())) {}
+
+ protected:
+  // Allocates a YV12 frame of |width| by |height| filled with a pattern, and
+  // an RGB frame of the same size.
+  void AllocateFrames(int width, int height) {
+    width_ = width;
+    height_ = height;
+    yuv_bytes_.reset(new uint8[width * height * 3 / 2]);
+    for (int i = 0; i < width * height * 3 / 2; ++i)
+      yuv_bytes_[i] = static_cast<uint8>(i * 7);
+    rgb_bytes_.reset(new uint8[width * height * kBpp]);
+  }
+
+  const uint8* yplane() const { return yuv_bytes_.get(); }
+  const uint8* uplane() const { return yuv_bytes_.get() + width_ * height_; }
+  const uint8* vplane() const {
+    return yuv_bytes_.get() + width_ * height_ * 5 / 4;
+  }
+
+  void PrintResult(const std::string& test_name,
+                   const std::string& trace_name,
+                   base::TimeTicks start) {
+    double total_time_milliseconds =
+        (base::TimeTicks::HighResNow() - start).InMillisecondsF();
+    perf_test::PrintResult(test_name,
+                           base::StringPrintf("_%dx%d", width_, height_),
+                           trace_name,
+                           kPerfTestIterations / total_time_milliseconds,
+                           "frames/ms",
+                           true);
+  }
+
+  void RunConvertRowBenchmark(
+      void (*fn)(const uint8*, const uint8*, const uint8*, uint8*, ptrdiff_t),
+      const std::string& trace_name) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int i = 0; i < kPerfTestIterations; ++i) {
+      for (int row = 0; row < height_; ++row) {
+        fn(yplane() + row * width_,
+           uplane() + (row >> 1) * (width_ / 2),
+           vplane() + (row >> 1) * (width_ / 2),
+           rgb_bytes_.get() + row * width_ * kBpp,
+           width_);
+      }
+    }
+    EmptyRegisterState();
+    PrintResult("yuv_convert_row", trace_name, start);
+  }
+
+  void RunConvertBenchmark(int num_bands, const std::string& trace_name) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int i = 0; i < kPerfTestIterations; ++i) {
+      ConvertYUVToRGB32InBands(yplane(), uplane(), vplane(), rgb_bytes_.get(),
+                               width_, height_,
+                               width_, width_ / 2, width_ * kBpp,
+                               YV12, num_bands);
+    }
+    PrintResult("yuv_convert", trace_name, start);
+  }
+
+  // Scales the frame down to half its size.
+  void RunScaleBenchmark(int num_bands, const std::string& trace_name) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int i = 0; i < kPerfTestIterations; ++i) {
+      ScaleYUVToRGB32InBands(yplane(), uplane(), vplane(), rgb_bytes_.get(),
+                             width_, height_, width_ / 2, height_ / 2,
+                             width_, width_ / 2, width_ * kBpp,
+                             YV12, ROTATE_0, FILTER_BILINEAR, num_bands);
+    }
+    PrintResult("yuv_scale", trace_name, start);
+  }
+
+  const int num_bands_;
+
+ private:
+  int width_;
+  int height_;
+  scoped_ptr<uint8[]> yuv_bytes_;
+  scoped_ptr<uint8[]> rgb_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(YUVConvertPerfTest);
+};
+
+// Benchmark for each ConvertYUVToRGB32Row() method.
+TEST_F(YUVConvertPerfTest, ConvertYUVToRGB32Row) {
+  base::CPU cpu;
+  for (size_t i = 0; i < arraysize(kFrameSizes); ++i) {
+    AllocateFrames(kFrameSizes[i].width, kFrameSizes[i].height);
+    RunConvertRowBenchmark(ConvertYUVToRGB32Row_C, "c");
+#if defined(ARCH_CPU_X86_FAMILY)
+    if (cpu.has_mmx())
+      RunConvertRowBenchmark(ConvertYUVToRGB32Row_MMX, "mmx");
+    if (cpu.has_sse())
+      RunConvertRowBenchmark(ConvertYUVToRGB32Row_SSE, "sse");
+    if (cpu.has_sse2())
+      RunConvertRowBenchmark(ConvertYUVToRGB32Row_SSE2, "sse2");
+#endif
+  }
+}
+
+// Benchmark for ConvertYUVToRGB32() on one thread and in bands.
+TEST_F(YUVConvertPerfTest, ConvertYUVToRGB32) {
+  for (size_t i = 0; i < arraysize(kFrameSizes); ++i) {
+    AllocateFrames(kFrameSizes[i].width, kFrameSizes[i].height);
+    RunConvertBenchmark(1, "single_thread");
+    RunConvertBenchmark(num_bands_, base::StringPrintf("%d_bands", num_bands_));
+  }
+}
+
+// Benchmark for ScaleYUVToRGB32() on one thread and in bands.
+TEST_F(YUVConvertPerfTest, ScaleYUVToRGB32) {
+  for (size_t i = 0; i < arraysize(kFrameSizes); ++i) {
+    AllocateFrames(kFrameSizes[i].width, kFrameSizes[i].height);
+    RunScaleBenchmark(1, "single_thread");
+    RunScaleBenchmark(num_bands_, base::StringPrintf("%d_bands", num_bands_));
+  }
+}
+
+}  // namespace media
@@ -659,6 +659,114 @@ TEST(YUVConvertTest, ConvertYUVToRGB32Row_SSE) {
                       kWidth * kBpp));
 }
 
+TEST(YUVConvertTest, ConvertYUVToRGB32Row_SSE2) {
+  base::CPU cpu;
+  if (!cpu.has_sse2()) {
+    LOG(WARNING) << "System not supported. Test skipped.";
+    return;
+  }
+
+  scoped_ptr<uint8[]> yuv_bytes(new uint8[kYUV12Size]);
+  scoped_ptr<uint8[]> rgb_bytes_reference(new uint8[kRGBSize]);
+  scoped_ptr<uint8[]> rgb_bytes_converted(new uint8[kRGBSize]);
+  ReadYV12Data(&yuv_bytes);
+
+  // Cover each number of leftover pixels.
+  for (int width = 164; width < 168; ++width) {
+    SCOPED_TRACE(width);
+    ConvertYUVToRGB32Row_C(yuv_bytes.get(),
+                           yuv_bytes.get() + kSourceUOffset,
+                           yuv_bytes.get() + kSourceVOffset,
+                           rgb_bytes_reference.get(),
+                           width);
+    ConvertYUVToRGB32Row_SSE2(yuv_bytes.get(),
+                              yuv_bytes.get() + kSourceUOffset,
+                              yuv_bytes.get() + kSourceVOffset,
+                              rgb_bytes_converted.get(),
+                              width);
+    EXPECT_EQ(0, memcmp(rgb_bytes_reference.get(),
+                        rgb_bytes_converted.get(),
+                        width * kBpp));
+  }
+}
+
+TEST(YUVConvertTest, ConvertYUVToRGB32InBands) {
+  scoped_ptr<uint8[]> yuv_bytes;
+  scoped_ptr<uint8[]> rgb_bytes_reference(new uint8[kRGBSizeConverted]);
+  scoped_ptr<uint8[]> rgb_bytes_converted(new uint8[kRGBSizeConverted]);
+  ReadYV12Data(&yuv_bytes);
+
+  // Use an odd height so that the bands don't split evenly.
+  const int kHeight = kSourceHeight - 1;
+  media::ConvertYUVToRGB32(yuv_bytes.get(),
+                           yuv_bytes.get() + kSourceUOffset,
+                           yuv_bytes.get() + kSourceVOffset,
+                           rgb_bytes_reference.get(),
+                           kSourceWidth, kHeight,
+                           kSourceWidth,
+                           kSourceWidth / 2,
+                           kSourceWidth * kBpp,
+                           media::YV12);
+  for (int num_bands = 1; num_bands <= 5; ++num_bands) {
+    SCOPED_TRACE(num_bands);
+    memset(rgb_bytes_converted.get(), 0, kRGBSizeConverted);
+    media::ConvertYUVToRGB32InBands(yuv_bytes.get(),
+                                    yuv_bytes.get() + kSourceUOffset,
+                                    yuv_bytes.get() + kSourceVOffset,
+                                    rgb_bytes_converted.get(),
+                                    kSourceWidth, kHeight,
+                                    kSourceWidth,
+                                    kSourceWidth / 2,
+                                    kSourceWidth * kBpp,
+                                    media::YV12,
+                                    num_bands);
+    EXPECT_EQ(0, memcmp(rgb_bytes_reference.get(),
+                        rgb_bytes_converted.get(),
+                        kSourceWidth * kHeight * kBpp));
+  }
+}
+
+TEST(YUVConvertTest, ScaleYUVToRGB32InBands) {
+  scoped_ptr<uint8[]> yuv_bytes;
+  scoped_ptr<uint8[]> rgb_bytes_reference(new uint8[kRGBSizeScaled]);
+  scoped_ptr<uint8[]> rgb_bytes_converted(new uint8[kRGBSizeScaled]);
+  ReadYV12Data(&yuv_bytes);
+
+  const int kHeight = kScaledHeight - 1;
+  media::ScaleYUVToRGB32(yuv_bytes.get(),
+                         yuv_bytes.get() + kSourceUOffset,
+                         yuv_bytes.get() + kSourceVOffset,
+                         rgb_bytes_reference.get(),
+                         kSourceWidth, kSourceHeight,
+                         kScaledWidth, kHeight,
+                         kSourceWidth,
+                         kSourceWidth / 2,
+                         kScaledWidth * kBpp,
+                         media::YV12,
+                         media::ROTATE_0,
+                         media::FILTER_BILINEAR);
+  for (int num_bands = 2; num_bands <= 5; ++num_bands) {
+    SCOPED_TRACE(num_bands);
+    memset(rgb_bytes_converted.get(), 0, kRGBSizeScaled);
+    media::ScaleYUVToRGB32InBands(yuv_bytes.get(),
+                                  yuv_bytes.get() + kSourceUOffset,
+                                  yuv_bytes.get() + kSourceVOffset,
+                                  rgb_bytes_converted.get(),
+                                  kSourceWidth, kSourceHeight,
+                                  kScaledWidth, kHeight,
+                                  kSourceWidth,
+                                  kSourceWidth / 2,
+                                  kScaledWidth * kBpp,
+                                  media::YV12,
+                                  media::ROTATE_0,
+                                  media::FILTER_BILINEAR,
+                                  num_bands);
+    EXPECT_EQ(0, memcmp(rgb_bytes_reference.get(),
+                        rgb_bytes_converted.get(),
+                        kScaledWidth * kHeight * kBpp));
+  }
+}
+
 TEST(YUVConvertTest, ScaleYUVToRGB32Row_MMX) {
   base::CPU cpu;
   if (!cpu.has_mmx()) {
@@ -103,6 +103,11 @@ class PacketSender {
   // functions.
   virtual bool SendPacket(const transport::Packet& packet) = 0;
 
+  // Sends a burst of packets in order.  The default implementation calls
+  // SendPacket() for each of them; transports that can hand a whole burst to
+  // the network at once should override it.
+  virtual bool SendPackets(const transport::PacketList& packets);
+
   virtual ~PacketSender() {}
 };
 
@@ -135,11 +135,8 @@ void PacedSender::SendStoredPackets() {
 }
 
 bool PacedSender::TransmitPackets(const PacketList& packets) {
-  bool ret = true;
-  for (size_t i = 0; i < packets.size(); i++) {
-    ret &= transport_->SendPacket(packets[i]);
-  }
-  return ret;
+  // Hand the whole burst to the transport at once.
+  return transport_->SendPackets(packets);
 }
 
 void PacedSender::UpdateBurstSize(size_t packets_to_send) {
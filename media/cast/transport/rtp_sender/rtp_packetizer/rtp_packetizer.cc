@@ -105,12 +105,14 @@ void RtpPacketizer::Cast(bool is_key,
   size_t payload_length = (data.size() + num_packets) / num_packets;
   DCHECK_LE(payload_length, max_length) << "Invalid argument";
 
-  PacketList packets;
+  packets_.resize(num_packets);
 
   size_t remaining_size = data.size();
   std::string::const_iterator data_iter = data.begin();
   while (remaining_size > 0) {
-    Packet packet;
+    Packet& packet = packets_[packet_id_];
+    packet.clear();
+    packet.reserve(rtp_header_length + payload_length);
 
     if (remaining_size < payload_length) {
       payload_length = remaining_size;
@@ -140,12 +142,11 @@ void RtpPacketizer::Cast(bool is_key,
     // Update stats.
     ++send_packets_count_;
     send_octet_count_ += payload_length;
-    packets.push_back(packet);
   }
   DCHECK(packet_id_ == num_packets) << "Invalid state";
 
   // Send to network.
-  transport_->SendPackets(packets);
+  transport_->SendPackets(packets_);
 
   // Prepare for next frame.
   packet_id_ = 0;
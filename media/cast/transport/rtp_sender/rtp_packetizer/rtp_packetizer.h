@@ -89,6 +89,10 @@ class RtpPacketizer {
 
   int send_packets_count_;
   size_t send_octet_count_;
+
+  // Packets of the frame being sent.  Kept across frames so that the packet
+  // buffers are allocated once and reused.
+  PacketList packets_;
 };
 
 }  // namespace transport
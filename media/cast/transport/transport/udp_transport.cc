@@ -149,6 +149,44 @@ bool UdpTransport::SendPacket(const Packet& packet) {
   return ret >= net::OK;
 }
 
+bool UdpTransport::SendPackets(const PacketList& packets) {
+  DCHECK(io_thread_proxy_->RunsTasksOnCurrentThread());
+
+  send_queue_.insert(send_queue_.end(), packets.begin(), packets.end());
+  if (send_pending_)
+    return true;
+  return SendQueuedPackets();
+}
+
+bool UdpTransport::SendQueuedPackets() {
+  DCHECK(!send_pending_);
+
+  bool ret = true;
+  while (!send_queue_.empty()) {
+    const Packet& packet = send_queue_.front();
+    DCHECK(!packet.empty());
+    scoped_refptr<net::IOBuffer> buf = new net::WrappedIOBuffer(
+        reinterpret_cast<const char*>(&packet[0]));
+    int result = udp_socket_->SendTo(
+        buf,
+        static_cast<int>(packet.size()),
+        remote_addr_,
+        base::Bind(&UdpTransport::OnQueuedPacketSent,
+                   weak_factory_.GetWeakPtr(),
+                   buf));
+    if (result == net::ERR_IO_PENDING) {
+      send_pending_ = true;
+      break;
+    }
+    send_queue_.pop_front();
+    if (result < 0) {
+      LOG(ERROR) << "Failed to send packet: " << result << ".";
+      ret = false;
+    }
+  }
+  return ret;
+}
+
 void UdpTransport::OnSent(const scoped_refptr<net::IOBuffer>& buf, int result) {
   DCHECK(io_thread_proxy_->RunsTasksOnCurrentThread());
 
@@ -157,6 +195,15 @@ void UdpTransport::OnSent(const scoped_refptr<net::IOBuffer>& buf, int result) {
     LOG(ERROR) << "Failed to send packet: " << result << ".";
     status_callback_.Run(TRANSPORT_SOCKET_ERROR);
   }
+  if (!send_queue_.empty())
+    SendQueuedPackets();
+}
+
+void UdpTransport::OnQueuedPacketSent(const scoped_refptr<net::IOBuffer>& buf,
+                                      int result) {
+  DCHECK(!send_queue_.empty());
+  send_queue_.pop_front();
+  OnSent(buf, result);
 }
 
 }  // namespace transport
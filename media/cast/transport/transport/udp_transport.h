@@ -5,6 +5,8 @@
 #ifndef MEDIA_CAST_TRANSPORT_TRANSPORT_UDP_TRANSPORT_H_
 #define MEDIA_CAST_TRANSPORT_TRANSPORT_UDP_TRANSPORT_H_
 
+#include <deque>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
@@ -47,14 +49,28 @@ class UdpTransport : public PacketSender {
   // PacketSender implementations.
   virtual bool SendPacket(const Packet& packet) OVERRIDE;
 
+  // Unlike SendPacket(), packets are not dropped while a send is pending;
+  // they are queued and sent back to back as the socket accepts them.
+  virtual bool SendPackets(const PacketList& packets) OVERRIDE;
+
  private:
   void ReceiveOnePacket();
   void OnReceived(int result);
   void OnSent(const scoped_refptr<net::IOBuffer>& buf, int result);
 
+  // Sends packets from the front of |send_queue_| until the queue is empty or
+  // a send goes asynchronous.  Returns false if a send failed.
+  bool SendQueuedPackets();
+  void OnQueuedPacketSent(const scoped_refptr<net::IOBuffer>& buf,
+                          int result);
+
   scoped_refptr<base::SingleThreadTaskRunner> io_thread_proxy_;
   net::IPEndPoint local_addr_;
   net::IPEndPoint remote_addr_;
+  // Packets given to SendPackets() that have not been sent yet.  The packet
+  // at the front is handed to |udp_socket_| without a copy, so the queue is
+  // declared before the socket to outlive any write still in flight.
+  std::deque<Packet> send_queue_;
   scoped_ptr<net::UDPSocket> udp_socket_;
   bool send_pending_;
   scoped_refptr<net::IOBuffer> recv_buf_;
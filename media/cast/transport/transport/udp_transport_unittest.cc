@@ -89,6 +89,63 @@ TEST(UdpTransport, SendAndReceive) {
       std::equal(packet.begin(), packet.end(), receiver2.packet().begin()));
 }
 
+class CountingPacketReceiver {
+ public:
+  CountingPacketReceiver(size_t expected_packets, const base::Closure& done)
+      : expected_packets_(expected_packets), done_(done) {}
+
+  void ReceivedPacket(scoped_ptr<Packet> packet) {
+    packets_.push_back(*packet);
+    if (packets_.size() == expected_packets_)
+      done_.Run();
+  }
+
+  const PacketList& packets() const { return packets_; }
+  transport::PacketReceiverCallback packet_receiver() {
+    return base::Bind(&CountingPacketReceiver::ReceivedPacket,
+                      base::Unretained(this));
+  }
+
+ private:
+  const size_t expected_packets_;
+  base::Closure done_;
+  PacketList packets_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingPacketReceiver);
+};
+
+TEST(UdpTransport, SendPacketBurst) {
+  base::MessageLoopForIO message_loop;
+
+  net::IPAddressNumber local_addr_number;
+  net::IPAddressNumber empty_addr_number;
+  net::ParseIPLiteralToNumber("127.0.0.1", &local_addr_number);
+  net::ParseIPLiteralToNumber("0.0.0.0", &empty_addr_number);
+
+  UdpTransport send_transport(message_loop.message_loop_proxy(),
+                              net::IPEndPoint(local_addr_number, 2346),
+                              net::IPEndPoint(local_addr_number, 2347),
+                              base::Bind(&UpdateCastTransportStatus));
+  UdpTransport recv_transport(message_loop.message_loop_proxy(),
+                              net::IPEndPoint(local_addr_number, 2347),
+                              net::IPEndPoint(empty_addr_number, 0),
+                              base::Bind(&UpdateCastTransportStatus));
+
+  PacketList packets;
+  for (int i = 0; i < 10; ++i)
+    packets.push_back(Packet(100 + i, static_cast<uint8>(i)));
+
+  base::RunLoop run_loop;
+  CountingPacketReceiver receiver(packets.size(), run_loop.QuitClosure());
+  recv_transport.StartReceiving(receiver.packet_receiver());
+
+  EXPECT_TRUE(send_transport.SendPackets(packets));
+  run_loop.Run();
+  ASSERT_EQ(packets.size(), receiver.packets().size());
+  for (size_t i = 0; i < packets.size(); ++i)
+    EXPECT_TRUE(packets[i] == receiver.packets()[i]);
+}
+
 }  // namespace transport
 }  // namespace cast
 }  // namespace media
@@ -0,0 +1,83 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "media/audio/audio_parameters.h"
+#include "media/base/audio_buffer.h"
+#include "media/base/audio_bus.h"
+#include "media/base/buffers.h"
+#include "media/base/channel_layout.h"
+#include "media/base/test_helpers.h"
+#include "media/filters/audio_renderer_algorithm.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kSampleRate = 48000;
+static const int kFramesPerBuffer = 1024;
+
+// Seconds of output rendered by each benchmark.
+static const int kBenchmarkSeconds = 10;
+
+// Renders |kBenchmarkSeconds| of audio at |playback_rate| and reports how many
+// seconds of output were produced per second of CPU time.
+static void RunPlaybackRateBenchmark(ChannelLayout channel_layout,
+                                     float playback_rate,
+                                     const std::string& trace_name) {
+  const int channels = ChannelLayoutToChannelCount(channel_layout);
+  AudioParameters params(AudioParameters::AUDIO_PCM_LINEAR,
+                         channel_layout,
+                         kSampleRate,
+                         32,
+                         kFramesPerBuffer);
+  AudioRendererAlgorithm algorithm;
+  algorithm.Initialize(playback_rate, params);
+
+  // The content does not change the cost of the search, it only has to be
+  // non-zero so the algorithm does not treat it as silence.
+  scoped_refptr<AudioBuffer> buffer = MakePlanarAudioBuffer<float>(
+      kSampleFormatPlanarF32, channels, 0.0f, 1.0f / kFramesPerBuffer,
+      kFramesPerBuffer, kNoTimestamp(), kNoTimestamp());
+  scoped_ptr<AudioBus> bus = AudioBus::Create(channels, kFramesPerBuffer);
+
+  const int frames_to_render = kSampleRate * kBenchmarkSeconds;
+  int frames_rendered = 0;
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  while (frames_rendered < frames_to_render) {
+    while (!algorithm.IsQueueFull())
+      algorithm.EnqueueBuffer(buffer);
+    frames_rendered += algorithm.FillBuffer(bus.get(), kFramesPerBuffer);
+  }
+  double seconds_per_second = kBenchmarkSeconds /
+      (base::TimeTicks::HighResNow() - start).InSecondsF();
+
+  perf_test::PrintResult("audio_renderer_algorithm",
+                         base::StringPrintf("_%dch", channels),
+                         trace_name,
+                         seconds_per_second,
+                         "realtime",
+                         true);
+}
+
+static void RunPlaybackRateBenchmarks(ChannelLayout channel_layout) {
+  RunPlaybackRateBenchmark(channel_layout, 0.5f, "playback_rate_0.5x");
+  RunPlaybackRateBenchmark(channel_layout, 1.5f, "playback_rate_1.5x");
+  RunPlaybackRateBenchmark(channel_layout, 2.0f, "playback_rate_2x");
+}
+
+TEST(AudioRendererAlgorithmPerfTest, Stereo) {
+  RunPlaybackRateBenchmarks(CHANNEL_LAYOUT_STEREO);
+}
+
+TEST(AudioRendererAlgorithmPerfTest, FivePointOne) {
+  RunPlaybackRateBenchmarks(CHANNEL_LAYOUT_5_1);
+}
+
+TEST(AudioRendererAlgorithmPerfTest, SevenPointOne) {
+  RunPlaybackRateBenchmarks(CHANNEL_LAYOUT_7_1);
+}
+
+}  // namespace media
@@ -155,9 +155,9 @@ class SourceState {
   void MarkEndOfStream();
   void UnmarkEndOfStream();
   void Shutdown();
-  // Sets the memory limit on each stream. |memory_limit| is the
+  // Sets the memory limit on each stream of |type|. |memory_limit| is the
   // maximum number of bytes each stream is allowed to hold in its buffer.
-  void SetMemoryLimitsForTesting(int memory_limit);
+  void SetMemoryLimit(DemuxerStream::Type type, int memory_limit);
   bool IsSeekWaitingForData() const;
 
  private:
@@ -329,10 +329,10 @@ class ChunkDemuxerStream : public DemuxerStream {
   // if type() != TEXT.
   TextTrackConfig text_track_config();
 
-  // Sets the memory limit, in bytes, on the SourceBufferStream.
-  void set_memory_limit_for_testing(int memory_limit) {
-    stream_->set_memory_limit_for_testing(memory_limit);
-  }
+  // Sets the memory limit, in bytes, on the SourceBufferStream; it is
+  // applied once the stream has been created if that has not happened yet.
+  // Zero leaves the SourceBufferStream's default in place.
+  void SetMemoryLimit(int memory_limit);
 
  private:
   enum State {
@@ -351,6 +351,7 @@ class ChunkDemuxerStream : public DemuxerStream {
   Type type_;
 
   scoped_ptr<SourceBufferStream> stream_;
+  int memory_limit_;
 
   mutable base::Lock lock_;
   State state_;
@@ -589,16 +590,18 @@ void SourceState::Shutdown() {
   }
 }
 
-void SourceState::SetMemoryLimitsForTesting(int memory_limit) {
-  if (audio_)
-    audio_->set_memory_limit_for_testing(memory_limit);
+void SourceState::SetMemoryLimit(DemuxerStream::Type type, int memory_limit) {
+  if (type == DemuxerStream::AUDIO && audio_)
+    audio_->SetMemoryLimit(memory_limit);
 
-  if (video_)
-    video_->set_memory_limit_for_testing(memory_limit);
+  if (type == DemuxerStream::VIDEO && video_)
+    video_->SetMemoryLimit(memory_limit);
 
+  if (type != DemuxerStream::TEXT)
+    return;
   for (TextStreamMap::iterator itr = text_stream_map_.begin();
        itr != text_stream_map_.end(); ++itr) {
-    itr->second->set_memory_limit_for_testing(memory_limit);
+    itr->second->SetMemoryLimit(memory_limit);
   }
 }
 
@@ -935,6 +938,7 @@ void SourceState::FilterWithAppendWindow(
 
 ChunkDemuxerStream::ChunkDemuxerStream(Type type)
     : type_(type),
+      memory_limit_(0),
       state_(UNINITIALIZED) {
 }
 
@@ -1068,6 +1072,8 @@ bool ChunkDemuxerStream::UpdateAudioConfig(const AudioDecoderConfig& config,
   if (!stream_) {
     DCHECK_EQ(state_, UNINITIALIZED);
     stream_.reset(new SourceBufferStream(config, log_cb));
+    if (memory_limit_ > 0)
+      stream_->set_memory_limit(memory_limit_);
     return true;
   }
 
@@ -1083,6 +1089,8 @@ bool ChunkDemuxerStream::UpdateVideoConfig(const VideoDecoderConfig& config,
   if (!stream_) {
     DCHECK_EQ(state_, UNINITIALIZED);
     stream_.reset(new SourceBufferStream(config, log_cb));
+    if (memory_limit_ > 0)
+      stream_->set_memory_limit(memory_limit_);
     return true;
   }
 
@@ -1096,6 +1104,16 @@ void ChunkDemuxerStream::UpdateTextConfig(const TextTrackConfig& config,
   DCHECK(!stream_);
   DCHECK_EQ(state_, UNINITIALIZED);
   stream_.reset(new SourceBufferStream(config, log_cb));
+  if (memory_limit_ > 0)
+    stream_->set_memory_limit(memory_limit_);
+}
+
+void ChunkDemuxerStream::SetMemoryLimit(int memory_limit) {
+  DCHECK_GT(memory_limit, 0);
+  base::AutoLock auto_lock(lock_);
+  memory_limit_ = memory_limit;
+  if (stream_)
+    stream_->set_memory_limit(memory_limit_);
 }
 
 void ChunkDemuxerStream::MarkEndOfStream() {
@@ -1650,13 +1668,25 @@ void ChunkDemuxer::Shutdown() {
     base::ResetAndReturn(&seek_cb_).Run(PIPELINE_ERROR_ABORT);
 }
 
-void ChunkDemuxer::SetMemoryLimitsForTesting(int memory_limit) {
+void ChunkDemuxer::SetMemoryLimit(DemuxerStream::Type type,
+                                  int memory_limit) {
+  DCHECK(type == DemuxerStream::AUDIO || type == DemuxerStream::VIDEO ||
+         type == DemuxerStream::TEXT);
+  DCHECK_GT(memory_limit, 0);
+  base::AutoLock auto_lock(lock_);
+  memory_limits_[type] = memory_limit;
   for (SourceStateMap::iterator itr = source_state_map_.begin();
        itr != source_state_map_.end(); ++itr) {
-    itr->second->SetMemoryLimitsForTesting(memory_limit);
+    itr->second->SetMemoryLimit(type, memory_limit);
   }
 }
 
+void ChunkDemuxer::SetMemoryLimitsForTesting(int memory_limit) {
+  SetMemoryLimit(DemuxerStream::AUDIO, memory_limit);
+  SetMemoryLimit(DemuxerStream::VIDEO, memory_limit);
+  SetMemoryLimit(DemuxerStream::TEXT, memory_limit);
+}
+
 void ChunkDemuxer::ChangeState_Locked(State new_state) {
   lock_.AssertAcquired();
   DVLOG(1) << "ChunkDemuxer::ChangeState_Locked() : "
@@ -1739,21 +1769,22 @@ void ChunkDemuxer::OnSourceInitDone(bool success, TimeDelta duration) {
 
 ChunkDemuxerStream*
 ChunkDemuxer::CreateDemuxerStream(DemuxerStream::Type type) {
+  ChunkDemuxerStream* stream = NULL;
   switch (type) {
     case DemuxerStream::AUDIO:
       if (audio_)
         return NULL;
       audio_.reset(new ChunkDemuxerStream(DemuxerStream::AUDIO));
-      return audio_.get();
+      stream = audio_.get();
       break;
     case DemuxerStream::VIDEO:
       if (video_)
         return NULL;
       video_.reset(new ChunkDemuxerStream(DemuxerStream::VIDEO));
-      return video_.get();
+      stream = video_.get();
       break;
     case DemuxerStream::TEXT: {
-      return new ChunkDemuxerStream(DemuxerStream::TEXT);
+      stream = new ChunkDemuxerStream(DemuxerStream::TEXT);
       break;
     }
     case DemuxerStream::UNKNOWN:
@@ -1761,8 +1792,11 @@ ChunkDemuxer::CreateDemuxerStream(DemuxerStream::Type type) {
       NOTREACHED();
       return NULL;
   }
-  NOTREACHED();
-  return NULL;
+
+  MemoryLimitMap::const_iterator limit = memory_limits_.find(type);
+  if (limit != memory_limits_.end())
+    stream->SetMemoryLimit(limit->second);
+  return stream;
 }
 
 void ChunkDemuxer::OnNewTextTrack(ChunkDemuxerStream* text_stream,
@@ -148,6 +148,12 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
 
   void Shutdown();
 
+  // Sets the maximum number of bytes each stream of |type| is allowed to hold
+  // in its buffer, for existing streams as well as ones created later.  Once a
+  // stream goes over the limit, garbage collection removes whole GOPs from it
+  // on the next append.  |type| must be AUDIO, VIDEO or TEXT.
+  void SetMemoryLimit(DemuxerStream::Type type, int memory_limit);
+
   // Sets the memory limit on each stream. |memory_limit| is the
   // maximum number of bytes each stream is allowed to hold in its buffer.
   void SetMemoryLimitsForTesting(int memory_limit);
@@ -272,6 +278,10 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
   typedef std::map<std::string, SourceState*> SourceStateMap;
   SourceStateMap source_state_map_;
 
+  // Memory limits set by SetMemoryLimit(), applied to each new stream.
+  typedef std::map<DemuxerStream::Type, int> MemoryLimitMap;
+  MemoryLimitMap memory_limits_;
+
   // Used to ensure that (1) config data matches the type and codec provided in
   // AddId(), (2) only 1 audio and 1 video sources are added, and (3) ids may be
   // removed with RemoveID() but can not be re-added (yet).
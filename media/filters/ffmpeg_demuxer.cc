@@ -29,6 +29,7 @@
 #include "media/ffmpeg/ffmpeg_common.h"
 #include "media/filters/ffmpeg_glue.h"
 #include "media/filters/ffmpeg_h264_to_annex_b_bitstream_converter.h"
+#include "media/filters/ffmpeg_seek_index.h"
 #include "media/filters/webvtt_util.h"
 #include "media/formats/webm/webm_crypto_helpers.h"
 
@@ -378,6 +379,7 @@ FFmpegDemuxer::FFmpegDemuxer(
       audio_disabled_(false),
       text_enabled_(false),
       duration_known_(false),
+      seek_index_entry_count_(0),
       need_key_cb_(need_key_cb) {
   DCHECK(task_runner_.get());
   DCHECK(data_source_);
@@ -387,6 +389,8 @@ FFmpegDemuxer::~FFmpegDemuxer() {}
 
 void FFmpegDemuxer::Stop(const base::Closure& callback) {
   DCHECK(task_runner_->BelongsToCurrentThread());
+  if (!streams_.empty() && !pending_read_ && !pending_seek_)
+    SaveSeekIndex();
   url_protocol_->Abort();
   data_source_->Stop(BindToCurrentLoop(base::Bind(
       &FFmpegDemuxer::OnDataSourceStopped, weak_this_,
@@ -680,6 +684,10 @@ void FFmpegDemuxer::OnFindStreamInfoDone(const PipelineStatusCB& status_cb,
   if (bitrate_ > 0)
     data_source_->SetBitrate(bitrate_);
 
+  // Seeks into parts of the media which have not been read yet can go straight
+  // to the right offset if it was found while playing the media before.
+  LoadSeekIndex();
+
   // Audio logging
   if (audio_stream) {
     AVCodecContext* audio_codec = audio_stream->codec;
@@ -757,6 +765,9 @@ void FFmpegDemuxer::OnSeekFrameDone(const PipelineStatusCB& cb, int result) {
     VLOG(1) << "Not implemented";
   }
 
+  // The seek may have taught libavformat new keyframe offsets.
+  SaveSeekIndex();
+
   // Tell streams to flush buffers due to seeking.
   StreamVector::iterator iter;
   for (iter = streams_.begin(); iter != streams_.end(); ++iter) {
@@ -829,6 +840,9 @@ void FFmpegDemuxer::OnReadFrameDone(ScopedAVPacket packet, int result) {
         duration_known_ = true;
       }
     }
+    // Having read through, libavformat knows the offsets of all keyframes.
+    SaveSeekIndex();
+
     // If we have reached the end of stream, tell the downstream filters about
     // the event.
     StreamHasEnded();
@@ -886,6 +900,39 @@ void FFmpegDemuxer::OnReadFrameDone(ScopedAVPacket packet, int result) {
   ReadFrameIfNeeded();
 }
 
+void FFmpegDemuxer::LoadSeekIndex() {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  int64 file_size = 0;
+  std::string data;
+  if (data_source_->IsStreaming() || !data_source_->GetSize(&file_size) ||
+      !data_source_->GetCachedSeekIndex(&data)) {
+    return;
+  }
+
+  scoped_ptr<FFmpegSeekIndex> index = FFmpegSeekIndex::Deserialize(data);
+  if (!index || !index->ApplyTo(glue_->format_context(), file_size)) {
+    DVLOG(1) << "Ignoring a seek index which does not match the media.";
+    return;
+  }
+  seek_index_entry_count_ = index->entry_count();
+}
+
+void FFmpegDemuxer::SaveSeekIndex() {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  int64 file_size = 0;
+  if (!data_source_ || data_source_->IsStreaming() ||
+      !data_source_->GetSize(&file_size)) {
+    return;
+  }
+
+  scoped_ptr<FFmpegSeekIndex> index = FFmpegSeekIndex::CreateFromFormatContext(
+      glue_->format_context(), file_size);
+  if (index->entry_count() <= seek_index_entry_count_)
+    return;
+  seek_index_entry_count_ = index->entry_count();
+  data_source_->SetCachedSeekIndex(index->Serialize());
+}
+
 void FFmpegDemuxer::OnDataSourceStopped(const base::Closure& callback) {
   // This will block until all tasks complete. Note that after this returns it's
   // possible for reply tasks (e.g., OnReadFrameDone()) to be queued on this
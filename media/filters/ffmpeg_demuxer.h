@@ -202,6 +202,12 @@ class MEDIA_EXPORT FFmpegDemuxer : public Demuxer {
   // the text renderer to bind each text stream to the cue rendering engine.
   void AddTextStreams();
 
+  // Hands libavformat the seek index stored for the media through
+  // |data_source_|, and stores its current one if it has grown since.  No
+  // libavformat call may be in progress on |blocking_thread_| meanwhile.
+  void LoadSeekIndex();
+  void SaveSeekIndex();
+
   DemuxerHost* host_;
 
   scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
@@ -258,6 +264,9 @@ class MEDIA_EXPORT FFmpegDemuxer : public Demuxer {
   // stream -- at this moment we definitely know duration.
   bool duration_known_;
 
+  // Number of entries in the seek index last loaded or saved.
+  size_t seek_index_entry_count_;
+
   // FFmpegURLProtocol implementation and corresponding glue bits.
   scoped_ptr<BlockingUrlProtocol> url_protocol_;
   scoped_ptr<FFmpegGlue> glue_;
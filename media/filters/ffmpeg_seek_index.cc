@@ -0,0 +1,142 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/ffmpeg_seek_index.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "media/ffmpeg/ffmpeg_common.h"
+
+namespace media {
+
+// Bumped whenever the serialized format changes.
+static const int kSeekIndexVersion = 1;
+
+// Limits on what is stored and accepted.  Longer indices are thinned out
+// evenly, which still gets seeks close enough to their target.
+static const int kMaxStreams = 64;
+static const size_t kMaxEntriesPerStream = 2048;
+
+FFmpegSeekIndex::FFmpegSeekIndex(int64 file_size) : file_size_(file_size) {}
+
+FFmpegSeekIndex::~FFmpegSeekIndex() {}
+
+// static
+scoped_ptr<FFmpegSeekIndex> FFmpegSeekIndex::CreateFromFormatContext(
+    AVFormatContext* format_context, int64 file_size) {
+  scoped_ptr<FFmpegSeekIndex> index(new FFmpegSeekIndex(file_size));
+  const int stream_count =
+      std::min(static_cast<int>(format_context->nb_streams), kMaxStreams);
+  index->streams_.resize(stream_count);
+
+  for (int i = 0; i < stream_count; ++i) {
+    const AVStream* stream = format_context->streams[i];
+    EntryVector keyframes;
+    for (int j = 0; j < stream->nb_index_entries; ++j) {
+      const AVIndexEntry& index_entry = stream->index_entries[j];
+      if (!(index_entry.flags & AVINDEX_KEYFRAME) || index_entry.pos < 0)
+        continue;
+      Entry entry = { index_entry.pos, index_entry.timestamp };
+      keyframes.push_back(entry);
+    }
+
+    EntryVector& entries = index->streams_[i];
+    if (keyframes.size() <= kMaxEntriesPerStream) {
+      entries.swap(keyframes);
+      continue;
+    }
+    entries.reserve(kMaxEntriesPerStream);
+    for (size_t j = 0; j < kMaxEntriesPerStream; ++j)
+      entries.push_back(keyframes[j * keyframes.size() / kMaxEntriesPerStream]);
+  }
+
+  return index.Pass();
+}
+
+// static
+scoped_ptr<FFmpegSeekIndex> FFmpegSeekIndex::Deserialize(
+    const std::string& data) {
+  Pickle pickle(data.data(), data.size());
+  PickleIterator iter(pickle);
+
+  int version = 0;
+  int64 file_size = 0;
+  int stream_count = 0;
+  if (!pickle.ReadInt(&iter, &version) || version != kSeekIndexVersion ||
+      !pickle.ReadInt64(&iter, &file_size) ||
+      !pickle.ReadInt(&iter, &stream_count) ||
+      stream_count < 0 || stream_count > kMaxStreams) {
+    return scoped_ptr<FFmpegSeekIndex>();
+  }
+
+  scoped_ptr<FFmpegSeekIndex> index(new FFmpegSeekIndex(file_size));
+  index->streams_.resize(stream_count);
+  for (int i = 0; i < stream_count; ++i) {
+    int entry_count = 0;
+    if (!pickle.ReadInt(&iter, &entry_count) || entry_count < 0 ||
+        static_cast<size_t>(entry_count) > kMaxEntriesPerStream) {
+      return scoped_ptr<FFmpegSeekIndex>();
+    }
+
+    EntryVector& entries = index->streams_[i];
+    entries.resize(entry_count);
+    for (int j = 0; j < entry_count; ++j) {
+      if (!pickle.ReadInt64(&iter, &entries[j].pos) ||
+          !pickle.ReadInt64(&iter, &entries[j].timestamp) ||
+          entries[j].pos < 0 || entries[j].pos >= file_size ||
+          (j > 0 && entries[j].timestamp <= entries[j - 1].timestamp)) {
+        return scoped_ptr<FFmpegSeekIndex>();
+      }
+    }
+  }
+
+  return index.Pass();
+}
+
+std::string FFmpegSeekIndex::Serialize() const {
+  Pickle pickle;
+  pickle.WriteInt(kSeekIndexVersion);
+  pickle.WriteInt64(file_size_);
+  pickle.WriteInt(streams_.size());
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    pickle.WriteInt(streams_[i].size());
+    for (size_t j = 0; j < streams_[i].size(); ++j) {
+      pickle.WriteInt64(streams_[i][j].pos);
+      pickle.WriteInt64(streams_[i][j].timestamp);
+    }
+  }
+  return std::string(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+bool FFmpegSeekIndex::ApplyTo(AVFormatContext* format_context,
+                              int64 file_size) const {
+  if (file_size != file_size_ ||
+      streams_.size() != std::min(static_cast<size_t>(kMaxStreams),
+                                  static_cast<size_t>(
+                                      format_context->nb_streams))) {
+    return false;
+  }
+
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    AVStream* stream = format_context->streams[i];
+    for (size_t j = 0; j < streams_[i].size(); ++j) {
+      // av_add_index_entry() replaces any entry libavformat already has for
+      // the same timestamp, so entries it found itself are not duplicated.
+      av_add_index_entry(stream, streams_[i][j].pos, streams_[i][j].timestamp,
+                         0, 0, AVINDEX_KEYFRAME);
+    }
+  }
+  return true;
+}
+
+size_t FFmpegSeekIndex::entry_count() const {
+  size_t count = 0;
+  for (size_t i = 0; i < streams_.size(); ++i)
+    count += streams_[i].size();
+  return count;
+}
+
+}  // namespace media
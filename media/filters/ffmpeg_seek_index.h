@@ -0,0 +1,68 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_FILTERS_FFMPEG_SEEK_INDEX_H_
+#define MEDIA_FILTERS_FFMPEG_SEEK_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "media/base/media_export.h"
+
+struct AVFormatContext;
+
+namespace media {
+
+// The keyframe timestamps and byte offsets which libavformat has gathered for
+// each stream of a file, in a form which can be stored and handed back to
+// libavformat the next time the same file is opened.  For files without a
+// usable index of their own, libavformat can then seek straight to the right
+// offset instead of searching for it with a series of reads.
+class MEDIA_EXPORT FFmpegSeekIndex {
+ public:
+  // Takes a snapshot of the keyframe index entries of each stream in
+  // |format_context|, for a file of |file_size| bytes.  No libavformat call
+  // may be in progress on |format_context| meanwhile.
+  static scoped_ptr<FFmpegSeekIndex> CreateFromFormatContext(
+      AVFormatContext* format_context, int64 file_size);
+
+  // Parses an index written by Serialize().  Returns NULL if |data| is not a
+  // valid index.
+  static scoped_ptr<FFmpegSeekIndex> Deserialize(const std::string& data);
+
+  ~FFmpegSeekIndex();
+
+  std::string Serialize() const;
+
+  // Adds the entries to the streams of |format_context|, which must have been
+  // set up by avformat_find_stream_info().  Does nothing and returns false if
+  // the index was taken from a different file, as far as can be told from
+  // |file_size| and the number of streams.
+  bool ApplyTo(AVFormatContext* format_context, int64 file_size) const;
+
+  // Total number of entries across all streams.
+  size_t entry_count() const;
+
+ private:
+  struct Entry {
+    int64 pos;
+    int64 timestamp;
+  };
+  typedef std::vector<Entry> EntryVector;
+
+  explicit FFmpegSeekIndex(int64 file_size);
+
+  const int64 file_size_;
+
+  // Entries for each stream, ordered by timestamp.
+  std::vector<EntryVector> streams_;
+
+  DISALLOW_COPY_AND_ASSIGN(FFmpegSeekIndex);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_FILTERS_FFMPEG_SEEK_INDEX_H_
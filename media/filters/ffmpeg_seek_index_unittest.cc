@@ -0,0 +1,101 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/scoped_ptr.h"
+#include "media/base/test_data_util.h"
+#include "media/ffmpeg/ffmpeg_common.h"
+#include "media/filters/ffmpeg_glue.h"
+#include "media/filters/ffmpeg_seek_index.h"
+#include "media/filters/in_memory_url_protocol.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+class FFmpegSeekIndexTest : public ::testing::Test {
+ public:
+  FFmpegSeekIndexTest() {}
+
+  virtual ~FFmpegSeekIndexTest() {
+    // |glue_| should be destroyed before |protocol_|.
+    glue_.reset();
+    protocol_.reset();
+  }
+
+  // Opens |filename| and parses its stream info, leaving the rest unread.
+  void Open(const char* filename) {
+    glue_.reset();
+    protocol_.reset();
+    data_ = ReadTestDataFile(filename);
+    protocol_.reset(new InMemoryUrlProtocol(
+        data_->data(), data_->data_size(), false));
+    glue_.reset(new FFmpegGlue(protocol_.get()));
+    ASSERT_TRUE(glue_->OpenContext());
+    ASSERT_GE(avformat_find_stream_info(format_context(), NULL), 0);
+  }
+
+  // Reads every packet, so that libavformat indexes every keyframe.
+  void ReadToEnd() {
+    AVPacket packet;
+    while (av_read_frame(format_context(), &packet) >= 0)
+      av_free_packet(&packet);
+  }
+
+  AVFormatContext* format_context() { return glue_->format_context(); }
+  int64 file_size() const { return data_->data_size(); }
+
+ private:
+  scoped_refptr<DecoderBuffer> data_;
+  scoped_ptr<InMemoryUrlProtocol> protocol_;
+  scoped_ptr<FFmpegGlue> glue_;
+
+  DISALLOW_COPY_AND_ASSIGN(FFmpegSeekIndexTest);
+};
+
+TEST_F(FFmpegSeekIndexTest, SerializeRoundTrip) {
+  Open("bear-320x240.webm");
+  ReadToEnd();
+
+  scoped_ptr<FFmpegSeekIndex> index =
+      FFmpegSeekIndex::CreateFromFormatContext(format_context(), file_size());
+  EXPECT_GT(index->entry_count(), 0u);
+
+  std::string data = index->Serialize();
+  scoped_ptr<FFmpegSeekIndex> parsed_index = FFmpegSeekIndex::Deserialize(data);
+  ASSERT_TRUE(parsed_index);
+  EXPECT_EQ(index->entry_count(), parsed_index->entry_count());
+  EXPECT_EQ(data, parsed_index->Serialize());
+}
+
+TEST_F(FFmpegSeekIndexTest, DeserializeRejectsBadData) {
+  Open("bear-320x240.webm");
+  ReadToEnd();
+  std::string data = FFmpegSeekIndex::CreateFromFormatContext(
+      format_context(), file_size())->Serialize();
+
+  EXPECT_FALSE(FFmpegSeekIndex::Deserialize(std::string()));
+  EXPECT_FALSE(FFmpegSeekIndex::Deserialize("not a seek index"));
+  EXPECT_FALSE(FFmpegSeekIndex::Deserialize(data.substr(0, data.size() - 4)));
+}
+
+TEST_F(FFmpegSeekIndexTest, ApplyTo) {
+  Open("bear-320x240.webm");
+  ReadToEnd();
+  std::string data = FFmpegSeekIndex::CreateFromFormatContext(
+      format_context(), file_size())->Serialize();
+
+  // Reopen the file, as a later session would.
+  Open("bear-320x240.webm");
+  scoped_ptr<FFmpegSeekIndex> index = FFmpegSeekIndex::Deserialize(data);
+  ASSERT_TRUE(index);
+
+  // An index for a file of a different size is not applied.
+  EXPECT_FALSE(index->ApplyTo(format_context(), file_size() + 1));
+
+  EXPECT_TRUE(index->ApplyTo(format_context(), file_size()));
+  scoped_ptr<FFmpegSeekIndex> applied_index =
+      FFmpegSeekIndex::CreateFromFormatContext(format_context(), file_size());
+  EXPECT_GE(applied_index->entry_count(), index->entry_count());
+}
+
+}  // namespace media
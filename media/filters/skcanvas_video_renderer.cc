@@ -4,7 +4,10 @@
 
 #include "media/filters/skcanvas_video_renderer.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
+#include "base/sys_info.h"
 #include "media/base/video_frame.h"
 #include "media/base/yuv_convert.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -34,6 +37,19 @@ static bool IsEitherYV12OrYV12AOrYV16OrNative(
       format == media::VideoFrame::YV12A;
 }
 
+// Frames of at least this many pixels are converted in bands of rows on the
+// worker pool, using up to |kMaxConversionBands| threads.
+static const int kMinPixelsForConversionBands = 1280 * 720;
+static const int kMaxConversionBands = 4;
+
+// Returns how many bands to split the conversion of a |width| by |height|
+// frame into.
+static int GetNumConversionBands(int width, int height) {
+  if (width * height < kMinPixelsForConversionBands)
+    return 1;
+  return std::min(kMaxConversionBands, base::SysInfo::NumberOfProcessors());
+}
+
 // CanFastPaint is a helper method to determine the conditions for fast
 // painting. The conditions are:
 // 1. No skew in canvas matrix.
@@ -166,20 +182,23 @@ static void FastPaint(
   // TODO(hclam): do rotation and mirroring here.
   // TODO(fbarchard): switch filtering based on performance.
   bitmap.lockPixels();
-  media::ScaleYUVToRGB32(frame_clip_y,
-                         frame_clip_u,
-                         frame_clip_v,
-                         dest_rect_pointer,
-                         frame_clip_width,
-                         frame_clip_height,
-                         local_dest_irect.width(),
-                         local_dest_irect.height(),
-                         video_frame->stride(media::VideoFrame::kYPlane),
-                         video_frame->stride(media::VideoFrame::kUPlane),
-                         bitmap.rowBytes(),
-                         yuv_type,
-                         media::ROTATE_0,
-                         media::FILTER_BILINEAR);
+  media::ScaleYUVToRGB32InBands(
+      frame_clip_y,
+      frame_clip_u,
+      frame_clip_v,
+      dest_rect_pointer,
+      frame_clip_width,
+      frame_clip_height,
+      local_dest_irect.width(),
+      local_dest_irect.height(),
+      video_frame->stride(media::VideoFrame::kYPlane),
+      video_frame->stride(media::VideoFrame::kUPlane),
+      bitmap.rowBytes(),
+      yuv_type,
+      media::ROTATE_0,
+      media::FILTER_BILINEAR,
+      GetNumConversionBands(local_dest_irect.width(),
+                            local_dest_irect.height()));
   bitmap.unlockPixels();
 }
 
@@ -191,10 +210,6 @@ static void ConvertVideoFrameToBitmap(
     SkBitmap* bitmap) {
   DCHECK(IsEitherYV12OrYV12AOrYV16OrNative(video_frame->format()))
       << video_frame->format();
-  if (IsEitherYV12OrYV12AOrYV16(video_frame->format())) {
-    DCHECK_EQ(video_frame->stride(media::VideoFrame::kUPlane),
-              video_frame->stride(media::VideoFrame::kVPlane));
-  }
 
   // Check if |bitmap| needs to be (re)allocated.
   if (bitmap->isNull() ||
@@ -208,51 +223,70 @@ static void ConvertVideoFrameToBitmap(
   }
 
   bitmap->lockPixels();
-
-  size_t y_offset = 0;
-  size_t uv_offset = 0;
-  if (IsEitherYV12OrYV12AOrYV16(video_frame->format())) {
-    int y_shift = (video_frame->format() == media::VideoFrame::YV16) ? 0 : 1;
-    // Use the "left" and "top" of the destination rect to locate the offset
-    // in Y, U and V planes.
-    y_offset = (video_frame->stride(media::VideoFrame::kYPlane) *
-                video_frame->visible_rect().y()) +
-                video_frame->visible_rect().x();
-    // For format YV12, there is one U, V value per 2x2 block.
-    // For format YV16, there is one U, V value per 2x1 block.
-    uv_offset = (video_frame->stride(media::VideoFrame::kUPlane) *
-                (video_frame->visible_rect().y() >> y_shift)) +
-                (video_frame->visible_rect().x() >> 1);
+  if (video_frame->format() == media::VideoFrame::NATIVE_TEXTURE) {
+    video_frame->ReadPixelsFromNativeTexture(*bitmap);
+  } else {
+    SkCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+        video_frame, bitmap->getPixels(), bitmap->rowBytes());
   }
+  bitmap->notifyPixelsChanged();
+  bitmap->unlockPixels();
+}
+
+// static
+void SkCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+    const scoped_refptr<media::VideoFrame>& video_frame,
+    void* rgb_pixels,
+    size_t row_bytes) {
+  DCHECK(IsEitherYV12OrYV12AOrYV16(video_frame->format()))
+      << video_frame->format();
+  DCHECK_EQ(video_frame->stride(media::VideoFrame::kUPlane),
+            video_frame->stride(media::VideoFrame::kVPlane));
+
+  int y_shift = (video_frame->format() == media::VideoFrame::YV16) ? 0 : 1;
+  // Use the "left" and "top" of the destination rect to locate the offset
+  // in Y, U and V planes.
+  size_t y_offset = (video_frame->stride(media::VideoFrame::kYPlane) *
+                     video_frame->visible_rect().y()) +
+                     video_frame->visible_rect().x();
+  // For format YV12, there is one U, V value per 2x2 block.
+  // For format YV16, there is one U, V value per 2x1 block.
+  size_t uv_offset = (video_frame->stride(media::VideoFrame::kUPlane) *
+                     (video_frame->visible_rect().y() >> y_shift)) +
+                     (video_frame->visible_rect().x() >> 1);
 
   switch (video_frame->format()) {
     case media::VideoFrame::YV12:
     case media::VideoFrame::YV12J:
-      media::ConvertYUVToRGB32(
+      media::ConvertYUVToRGB32InBands(
           video_frame->data(media::VideoFrame::kYPlane) + y_offset,
           video_frame->data(media::VideoFrame::kUPlane) + uv_offset,
           video_frame->data(media::VideoFrame::kVPlane) + uv_offset,
-          static_cast<uint8*>(bitmap->getPixels()),
+          static_cast<uint8*>(rgb_pixels),
           video_frame->visible_rect().width(),
           video_frame->visible_rect().height(),
           video_frame->stride(media::VideoFrame::kYPlane),
           video_frame->stride(media::VideoFrame::kUPlane),
-          bitmap->rowBytes(),
-          media::YV12);
+          row_bytes,
+          media::YV12,
+          GetNumConversionBands(video_frame->visible_rect().width(),
+                                video_frame->visible_rect().height()));
       break;
 
     case media::VideoFrame::YV16:
-      media::ConvertYUVToRGB32(
+      media::ConvertYUVToRGB32InBands(
           video_frame->data(media::VideoFrame::kYPlane) + y_offset,
           video_frame->data(media::VideoFrame::kUPlane) + uv_offset,
           video_frame->data(media::VideoFrame::kVPlane) + uv_offset,
-          static_cast<uint8*>(bitmap->getPixels()),
+          static_cast<uint8*>(rgb_pixels),
           video_frame->visible_rect().width(),
           video_frame->visible_rect().height(),
           video_frame->stride(media::VideoFrame::kYPlane),
           video_frame->stride(media::VideoFrame::kUPlane),
-          bitmap->rowBytes(),
-          media::YV16);
+          row_bytes,
+          media::YV16,
+          GetNumConversionBands(video_frame->visible_rect().width(),
+                                video_frame->visible_rect().height()));
       break;
 
     case media::VideoFrame::YV12A:
@@ -261,27 +295,20 @@ static void ConvertVideoFrameToBitmap(
           video_frame->data(media::VideoFrame::kUPlane) + uv_offset,
           video_frame->data(media::VideoFrame::kVPlane) + uv_offset,
           video_frame->data(media::VideoFrame::kAPlane),
-          static_cast<uint8*>(bitmap->getPixels()),
+          static_cast<uint8*>(rgb_pixels),
           video_frame->visible_rect().width(),
           video_frame->visible_rect().height(),
           video_frame->stride(media::VideoFrame::kYPlane),
           video_frame->stride(media::VideoFrame::kUPlane),
           video_frame->stride(media::VideoFrame::kAPlane),
-          bitmap->rowBytes(),
+          row_bytes,
           media::YV12);
       break;
 
-    case media::VideoFrame::NATIVE_TEXTURE:
-      DCHECK_EQ(video_frame->format(), media::VideoFrame::NATIVE_TEXTURE);
-      video_frame->ReadPixelsFromNativeTexture(*bitmap);
-      break;
-
     default:
       NOTREACHED();
       break;
   }
-  bitmap->notifyPixelsChanged();
-  bitmap->unlockPixels();
 }
 
 SkCanvasVideoRenderer::SkCanvasVideoRenderer()
@@ -5,6 +5,7 @@
 #ifndef MEDIA_FILTERS_SKCANVAS_VIDEO_RENDERER_H_
 #define MEDIA_FILTERS_SKCANVAS_VIDEO_RENDERER_H_
 
+#include "base/memory/ref_counted.h"
 #include "base/time/time.h"
 #include "media/base/media_export.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -32,6 +33,15 @@ class MEDIA_EXPORT SkCanvasVideoRenderer {
              const gfx::RectF& dest_rect,
              uint8 alpha);
 
+  // Converts the visible rect of |video_frame|, which must be YV12, YV12J,
+  // YV12A or YV16, to ARGB at the top-left of |rgb_pixels|, whose rows are
+  // |row_bytes| apart.  Unlike Paint(), this writes straight into the
+  // destination without going through an intermediate bitmap.
+  static void ConvertVideoFrameToRGBPixels(
+      const scoped_refptr<media::VideoFrame>& video_frame,
+      void* rgb_pixels,
+      size_t row_bytes);
+
  private:
   // An RGB bitmap and corresponding timestamp of the previously converted
   // video frame data.
@@ -5,6 +5,7 @@
 #include "media/filters/source_buffer_stream.h"
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 
 #include "base/bind.h"
@@ -231,10 +232,16 @@ class SourceBufferRange {
                   BufferQueue* deleted_buffers);
 
   // Frees the buffers in |buffers_| from [|start_point|,|ending_point|) and
-  // updates the |size_in_bytes_| accordingly. Does not update |keyframe_map_|.
+  // updates the |size_in_bytes_| accordingly. Does not update |keyframe_map_|
+  // or |gop_sizes_|.
   void FreeBufferRange(const BufferQueue::iterator& starting_point,
                        const BufferQueue::iterator& ending_point);
 
+  // Drops the |gop_sizes_| of GOPs no longer in |keyframe_map_| after the
+  // buffers from the last remaining keyframe onward have been truncated, and
+  // recomputes the size of the last remaining GOP.
+  void TruncateGOPSizes();
+
   // Returns the distance in time estimating how far from the beginning or end
   // of this range a buffer can be to considered in the range.
   base::TimeDelta GetFudgeRoom() const;
@@ -256,6 +263,11 @@ class SourceBufferRange {
   //   keyframe_map_[k] - keyframe_map_index_base_
   int keyframe_map_index_base_;
 
+  // Size in bytes of the data in each GOP, in the same order as
+  // |keyframe_map_|.  Lets garbage collection size up GOPs without visiting
+  // each of their buffers.
+  std::deque<int> gop_sizes_;
+
   // Index into |buffers_| for the next buffer to be returned by
   // GetNextBuffer(), set to -1 before Seek().
   int next_buffer_index_;
@@ -1607,11 +1619,15 @@ void SourceBufferRange::AppendBuffersToEnd(const BufferQueue& new_buffers) {
     buffers_.push_back(*itr);
     size_in_bytes_ += (*itr)->data_size();
 
-    if ((*itr)->IsKeyframe()) {
-      keyframe_map_.insert(
-          std::make_pair((*itr)->GetDecodeTimestamp(),
-                         buffers_.size() - 1 + keyframe_map_index_base_));
+    if ((*itr)->IsKeyframe() &&
+        keyframe_map_.insert(
+            std::make_pair((*itr)->GetDecodeTimestamp(),
+                           buffers_.size() - 1 + keyframe_map_index_base_))
+            .second) {
+      gop_sizes_.push_back(0);
     }
+    DCHECK(!gop_sizes_.empty());
+    gop_sizes_.back() += (*itr)->data_size();
   }
 }
 
@@ -1672,6 +1688,8 @@ SourceBufferRange* SourceBufferRange::SplitRange(
   DCHECK_LT(keyframe_index, static_cast<int>(buffers_.size()));
   BufferQueue::iterator starting_point = buffers_.begin() + keyframe_index;
   BufferQueue removed_buffers(starting_point, buffers_.end());
+  gop_sizes_.resize(
+      std::distance(keyframe_map_.begin(), new_beginning_keyframe));
   keyframe_map_.erase(new_beginning_keyframe, keyframe_map_.end());
   FreeBufferRange(starting_point, buffers_.end());
 
@@ -1744,31 +1762,27 @@ int SourceBufferRange::DeleteGOPFromFront(BufferQueue* deleted_buffers) {
   DCHECK(!FirstGOPContainsNextBufferPosition());
   DCHECK(deleted_buffers);
 
-  int buffers_deleted = 0;
-  int total_bytes_deleted = 0;
-
   KeyframeMap::iterator front = keyframe_map_.begin();
   DCHECK(front != keyframe_map_.end());
 
   // Delete the keyframe at the start of |keyframe_map_|.
   keyframe_map_.erase(front);
+  const int total_bytes_deleted = gop_sizes_.front();
+  gop_sizes_.pop_front();
 
   // Now we need to delete all the buffers that depend on the keyframe we've
   // just deleted.
-  int end_index = keyframe_map_.size() > 0 ?
+  const int buffers_deleted = keyframe_map_.size() > 0 ?
       keyframe_map_.begin()->second - keyframe_map_index_base_ :
       buffers_.size();
 
   // Delete buffers from the beginning of the buffered range up until (but not
   // including) the next keyframe.
-  for (int i = 0; i < end_index; i++) {
-    int bytes_deleted = buffers_.front()->data_size();
-    size_in_bytes_ -= bytes_deleted;
-    total_bytes_deleted += bytes_deleted;
-    deleted_buffers->push_back(buffers_.front());
-    buffers_.pop_front();
-    ++buffers_deleted;
-  }
+  BufferQueue::iterator gop_end = buffers_.begin() + buffers_deleted;
+  deleted_buffers->insert(deleted_buffers->end(), buffers_.begin(), gop_end);
+  buffers_.erase(buffers_.begin(), gop_end);
+  size_in_bytes_ -= total_bytes_deleted;
+  DCHECK_GE(size_in_bytes_, 0);
 
   // Update |keyframe_map_index_base_| to account for the deleted buffers.
   keyframe_map_index_base_ += buffers_deleted;
@@ -1799,18 +1813,16 @@ int SourceBufferRange::DeleteGOPFromBack(BufferQueue* deleted_buffers) {
   // |buffers_| after that GOP is deleted.
   size_t goal_size = back->second - keyframe_map_index_base_;
   keyframe_map_.erase(back);
+  const int total_bytes_deleted = gop_sizes_.back();
+  gop_sizes_.pop_back();
 
-  int total_bytes_deleted = 0;
-  while (buffers_.size() != goal_size) {
-    int bytes_deleted = buffers_.back()->data_size();
-    size_in_bytes_ -= bytes_deleted;
-    total_bytes_deleted += bytes_deleted;
-    // We're removing buffers from the back, so push each removed buffer to the
-    // front of |deleted_buffers| so that |deleted_buffers| are in nondecreasing
-    // order.
-    deleted_buffers->push_front(buffers_.back());
-    buffers_.pop_back();
-  }
+  // Put the removed buffers at the front of |deleted_buffers| so that
+  // |deleted_buffers| stays in nondecreasing order.
+  BufferQueue::iterator gop_start = buffers_.begin() + goal_size;
+  deleted_buffers->insert(deleted_buffers->begin(), gop_start, buffers_.end());
+  buffers_.erase(gop_start, buffers_.end());
+  size_in_bytes_ -= total_bytes_deleted;
+  DCHECK_GE(size_in_bytes_, 0);
 
   return total_bytes_deleted;
 }
@@ -1824,8 +1836,7 @@ int SourceBufferRange::GetRemovalGOP(
   KeyframeMap::iterator gop_itr = GetFirstKeyframeAt(start_timestamp, false);
   if (gop_itr == keyframe_map_.end())
     return 0;
-  int keyframe_index = gop_itr->second - keyframe_map_index_base_;
-  BufferQueue::iterator buffer_itr = buffers_.begin() + keyframe_index;
+  size_t gop_index = std::distance(keyframe_map_.begin(), gop_itr);
   KeyframeMap::iterator gop_end = keyframe_map_.end();
   if (end_timestamp < GetBufferedEndTimestamp())
     gop_end = GetFirstKeyframeBefore(end_timestamp);
@@ -1839,13 +1850,7 @@ int SourceBufferRange::GetRemovalGOP(
   while (gop_itr != gop_end && bytes_to_free > 0) {
     ++gop_itr;
 
-    int gop_size = 0;
-    int next_gop_index = gop_itr == keyframe_map_.end() ?
-        buffers_.size() : gop_itr->second - keyframe_map_index_base_;
-    BufferQueue::iterator next_gop_start = buffers_.begin() + next_gop_index;
-    for (; buffer_itr != next_gop_start; ++buffer_itr)
-      gop_size += (*buffer_itr)->data_size();
-
+    int gop_size = gop_sizes_[gop_index++];
     bytes_removed += gop_size;
     bytes_to_free -= gop_size;
   }
@@ -1925,9 +1930,26 @@ bool SourceBufferRange::TruncateAt(
 
   // Remove everything from |starting_point| onward.
   FreeBufferRange(starting_point, buffers_.end());
+  TruncateGOPSizes();
   return buffers_.empty();
 }
 
+void SourceBufferRange::TruncateGOPSizes() {
+  gop_sizes_.resize(keyframe_map_.size());
+  if (keyframe_map_.empty())
+    return;
+
+  KeyframeMap::const_iterator last_gop = keyframe_map_.end();
+  --last_gop;
+  int last_gop_size = 0;
+  for (BufferQueue::const_iterator itr =
+           buffers_.begin() + (last_gop->second - keyframe_map_index_base_);
+       itr != buffers_.end(); ++itr) {
+    last_gop_size += (*itr)->data_size();
+  }
+  gop_sizes_.back() = last_gop_size;
+}
+
 bool SourceBufferRange::GetNextBuffer(
     scoped_refptr<StreamParserBuffer>* out_buffer) {
   if (!HasNextBuffer())
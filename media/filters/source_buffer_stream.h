@@ -136,7 +136,9 @@ class MEDIA_EXPORT SourceBufferStream {
   // yet.
   base::TimeDelta GetMaxInterbufferDistance() const;
 
-  void set_memory_limit_for_testing(int memory_limit) {
+  // Sets the maximum amount of data in bytes the stream keeps in memory.
+  // Garbage collection brings the stream back under it on the next Append().
+  void set_memory_limit(int memory_limit) {
     memory_limit_ = memory_limit;
   }
 
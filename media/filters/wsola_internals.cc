@@ -14,6 +14,7 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "media/base/audio_bus.h"
+#include "media/base/vector_math.h"
 
 namespace media {
 
@@ -48,10 +49,19 @@ void MultiChannelDotProduct(const AudioBus* a,
   DCHECK_LE(frame_offset_a + num_frames, a->frames());
   DCHECK_LE(frame_offset_b + num_frames, b->frames());
 
-  memset(dot_product, 0, sizeof(*dot_product) * a->channels());
   for (int k = 0; k < a->channels(); ++k) {
     const float* ch_a = a->channel(k) + frame_offset_a;
     const float* ch_b = b->channel(k) + frame_offset_b;
+
+    // vector_math::DotProduct() only needs its first input aligned, which
+    // holds for the target block since the search always starts it at zero.
+    if ((reinterpret_cast<uintptr_t>(ch_a) &
+         (vector_math::kRequiredAlignment - 1)) == 0) {
+      dot_product[k] = vector_math::DotProduct(ch_a, ch_b, num_frames);
+      continue;
+    }
+
+    dot_product[k] = 0;
     for (int n = 0; n < num_frames; ++n) {
       dot_product[k] += *ch_a++ * *ch_b++;
     }
@@ -142,6 +142,77 @@ void WatcherBackend::OnHandleError(const Handle& handle, MojoResult result) {
   RemoveAndNotify(handle, result);
 }
 
+// SameThreadWatcher -----------------------------------------------------------
+
+// SameThreadWatcher watches a single handle with the MessagePumpMojo of the
+// thread it's created on, which notifies it on that thread. This avoids the
+// thread hops through WatcherThreadManager.
+class SameThreadWatcher : public MessagePumpMojoHandler {
+ public:
+  SameThreadWatcher(MessagePumpMojo* message_pump,
+                    const Handle& handle,
+                    MojoWaitFlags wait_flags,
+                    base::TimeTicks deadline,
+                    const base::Callback<void(MojoResult)>& callback);
+  virtual ~SameThreadWatcher();
+
+ private:
+  // Notifies |callback_|, which may delete this.
+  void Notify(MojoResult result);
+
+  // MessagePumpMojoHandler overrides:
+  virtual void OnHandleReady(const Handle& handle) OVERRIDE;
+  virtual void OnHandleError(const Handle& handle, MojoResult result) OVERRIDE;
+
+  MessagePumpMojo* message_pump_;
+  const Handle handle_;
+  const base::Callback<void(MojoResult)> callback_;
+
+  // True until |message_pump_| has notified this.
+  bool registered_;
+
+  DISALLOW_COPY_AND_ASSIGN(SameThreadWatcher);
+};
+
+SameThreadWatcher::SameThreadWatcher(
+    MessagePumpMojo* message_pump,
+    const Handle& handle,
+    MojoWaitFlags wait_flags,
+    base::TimeTicks deadline,
+    const base::Callback<void(MojoResult)>& callback)
+    : message_pump_(message_pump),
+      handle_(handle),
+      callback_(callback),
+      registered_(true) {
+  message_pump_->AddHandler(this, handle_, wait_flags, deadline);
+}
+
+SameThreadWatcher::~SameThreadWatcher() {
+  // |message_pump_| may have been destroyed (with its thread's MessageLoop).
+  if (registered_ && MessagePumpMojo::current() == message_pump_)
+    message_pump_->RemoveHandler(handle_);
+}
+
+void SameThreadWatcher::Notify(MojoResult result) {
+  registered_ = false;
+  // Running the callback may delete this.
+  const base::Callback<void(MojoResult)> callback(callback_);
+  callback.Run(result);
+}
+
+void SameThreadWatcher::OnHandleReady(const Handle& handle) {
+  DCHECK_EQ(handle.value(), handle_.value());
+  message_pump_->RemoveHandler(handle_);
+  Notify(MOJO_RESULT_OK);
+}
+
+void SameThreadWatcher::OnHandleError(const Handle& handle,
+                                      MojoResult result) {
+  // |message_pump_| has already removed this.
+  DCHECK_EQ(handle.value(), handle_.value());
+  Notify(result);
+}
+
 // WatcherThreadManager --------------------------------------------------------
 
 // WatcherThreadManager manages the background thread that listens for handles
@@ -233,15 +304,21 @@ WatcherThreadManager::~WatcherThreadManager() {
 
 // Contains the information passed to Start().
 struct HandleWatcher::StartState {
-  explicit StartState(HandleWatcher* watcher) : weak_factory(watcher) {
+  explicit StartState(HandleWatcher* watcher)
+      : watcher_id(0),
+        weak_factory(watcher) {
   }
 
   ~StartState() {
   }
 
-  // ID assigned by WatcherThreadManager.
+  // ID assigned by WatcherThreadManager, if it's used.
   WatcherID watcher_id;
 
+  // Used instead of WatcherThreadManager if the thread Start() was invoked on
+  // has a MessagePumpMojo.
+  scoped_ptr<SameThreadWatcher> same_thread_watcher;
+
   // Callback to notify when done.
   base::Callback<void(MojoResult)> callback;
 
@@ -277,13 +354,25 @@ void HandleWatcher::Start(const Handle& handle,
 
   start_state_.reset(new StartState(this));
   start_state_->callback = callback;
+  const base::Callback<void(MojoResult)> on_handle_ready(
+      base::Bind(&HandleWatcher::OnHandleReady,
+                 start_state_->weak_factory.GetWeakPtr()));
+  MessagePumpMojo* message_pump = MessagePumpMojo::current();
+  if (message_pump) {
+    start_state_->same_thread_watcher.reset(
+        new SameThreadWatcher(message_pump,
+                              handle,
+                              wait_flags,
+                              MojoDeadlineToTimeTicks(deadline),
+                              on_handle_ready));
+    return;
+  }
   start_state_->watcher_id =
       WatcherThreadManager::GetInstance()->StartWatching(
           handle,
           wait_flags,
           MojoDeadlineToTimeTicks(deadline),
-          base::Bind(&HandleWatcher::OnHandleReady,
-                     start_state_->weak_factory.GetWeakPtr()));
+          on_handle_ready);
 }
 
 void HandleWatcher::Stop() {
@@ -291,7 +380,9 @@ void HandleWatcher::Stop() {
     return;
 
   scoped_ptr<StartState> old_state(start_state_.Pass());
-  WatcherThreadManager::GetInstance()->StopWatching(old_state->watcher_id);
+  // Destroying |old_state| stops its SameThreadWatcher, if it has one.
+  if (!old_state->same_thread_watcher.get())
+    WatcherThreadManager::GetInstance()->StopWatching(old_state->watcher_id);
 }
 
 void HandleWatcher::OnHandleReady(MojoResult result) {
@@ -10,6 +10,7 @@
 #include "base/bind.h"
 #include "base/run_loop.h"
 #include "base/test/simple_test_tick_clock.h"
+#include "mojo/common/message_pump_mojo.h"
 #include "mojo/public/system/core_cpp.h"
 #include "mojo/public/tests/test_utils.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -100,6 +101,9 @@ class HandleWatcherTest : public testing::Test {
   }
 
  protected:
+  explicit HandleWatcherTest(scoped_ptr<base::MessagePump> message_pump)
+      : message_loop_(message_pump.Pass()) {}
+
   void InstallTickClock() {
     HandleWatcher::tick_clock_ = &tick_clock_;
   }
@@ -304,6 +308,90 @@ TEST_F(HandleWatcherTest, DeleteInCallback) {
   EXPECT_TRUE(callback_helper.got_callback());
 }
 
+// Runs the test on a MessageLoop with a MessagePumpMojo, in which case
+// HandleWatcher watches handles on the test's thread.
+class HandleWatcherMessagePumpMojoTest : public HandleWatcherTest {
+ public:
+  HandleWatcherMessagePumpMojoTest()
+      : HandleWatcherTest(
+            scoped_ptr<base::MessagePump>(new MessagePumpMojo())) {}
+  virtual ~HandleWatcherMessagePumpMojoTest() {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HandleWatcherMessagePumpMojoTest);
+};
+
+TEST_F(HandleWatcherMessagePumpMojoTest, TwoHandles) {
+  MessagePipe test_pipe1;
+  MessagePipe test_pipe2;
+  CallbackHelper callback_helper1;
+  CallbackHelper callback_helper2;
+  ASSERT_TRUE(test_pipe1.handle0.is_valid());
+  ASSERT_TRUE(test_pipe2.handle0.is_valid());
+
+  HandleWatcher watcher1;
+  callback_helper1.Start(&watcher1, test_pipe1.handle0.get());
+  HandleWatcher watcher2;
+  callback_helper2.Start(&watcher2, test_pipe2.handle0.get());
+  RunUntilIdle();
+  EXPECT_FALSE(callback_helper1.got_callback());
+  EXPECT_FALSE(callback_helper2.got_callback());
+
+  // Write to 2 and make sure it's notified.
+  EXPECT_TRUE(mojo::test::WriteTextMessage(test_pipe2.handle1.get(),
+                                           std::string()));
+  callback_helper2.RunUntilGotCallback();
+  EXPECT_FALSE(callback_helper1.got_callback());
+  EXPECT_TRUE(callback_helper2.got_callback());
+  callback_helper2.clear_callback();
+
+  // Stop 1, then write to 1 and 2. Neither should be notified (2 was already
+  // notified).
+  watcher1.Stop();
+  EXPECT_TRUE(mojo::test::WriteTextMessage(test_pipe1.handle1.get(),
+                                           std::string()));
+  EXPECT_TRUE(mojo::test::WriteTextMessage(test_pipe2.handle1.get(),
+                                           std::string()));
+  RunUntilIdle();
+  EXPECT_FALSE(callback_helper1.got_callback());
+  EXPECT_FALSE(callback_helper2.got_callback());
+
+  // Listen on 1 again. It's still readable, so it's notified.
+  callback_helper1.Start(&watcher1, test_pipe1.handle0.get());
+  callback_helper1.RunUntilGotCallback();
+  EXPECT_TRUE(callback_helper1.got_callback());
+  EXPECT_FALSE(callback_helper2.got_callback());
+}
+
+TEST_F(HandleWatcherMessagePumpMojoTest, ClosedHandle) {
+  MessagePipe test_pipe;
+  CallbackHelper callback_helper;
+
+  // Closing the other end of the pipe makes the handle unreadable.
+  HandleWatcher watcher;
+  callback_helper.Start(&watcher, test_pipe.handle0.get());
+  RunUntilIdle();
+  EXPECT_FALSE(callback_helper.got_callback());
+  test_pipe.handle1.reset();
+  callback_helper.RunUntilGotCallback();
+  EXPECT_TRUE(callback_helper.got_callback());
+}
+
+TEST_F(HandleWatcherMessagePumpMojoTest, DeleteInCallback) {
+  MessagePipe test_pipe;
+  CallbackHelper callback_helper;
+
+  HandleWatcher* watcher = new HandleWatcher();
+  callback_helper.StartWithCallback(watcher, test_pipe.handle1.get(),
+                                    base::Bind(&DeleteWatcherAndForwardResult,
+                                               watcher,
+                                               callback_helper.GetCallback()));
+  EXPECT_TRUE(mojo::test::WriteTextMessage(test_pipe.handle0.get(),
+                                           std::string()));
+  callback_helper.RunUntilGotCallback();
+  EXPECT_TRUE(callback_helper.got_callback());
+}
+
 }  // namespace test
 }  // namespace common
 }  // namespace mojo
@@ -7,38 +7,54 @@
 #include <algorithm>
 #include <vector>
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/threading/thread_local.h"
 #include "base/time/time.h"
 #include "mojo/common/message_pump_mojo_handler.h"
 
 namespace mojo {
 namespace common {
 
-// State needed for one iteration of WaitMany. The first handle and flags
-// corresponds to that of the control pipe.
-struct MessagePumpMojo::WaitState {
-  std::vector<Handle> handles;
-  std::vector<MojoWaitFlags> wait_flags;
-};
+namespace {
+
+// Context of |MessagePumpMojo::read_handle_| in the wait set.
+const uint64_t kControlPipeContext = 0;
+
+// Maximum number of results collected by one call to MojoWaitOnWaitSet().
+const uint32_t kMaxResultsPerWait = 16;
+
+base::LazyInstance<base::ThreadLocalPointer<MessagePumpMojo> >::Leaky
+    lazy_tls_ptr = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
 
 struct MessagePumpMojo::RunState {
-  RunState() : should_quit(false) {
-    CreateMessagePipe(&read_handle, &write_handle);
-  }
+  RunState() : should_quit(false) {}
 
   base::TimeTicks delayed_work_time;
 
-  // Used to wake up WaitForWork().
-  ScopedMessagePipeHandle read_handle;
-  ScopedMessagePipeHandle write_handle;
-
   bool should_quit;
 };
 
-MessagePumpMojo::MessagePumpMojo() : run_state_(NULL), next_handler_id_(0) {
+MessagePumpMojo::MessagePumpMojo() : run_state_(NULL), next_handler_id_(1) {
+  // TODO: better deal with error handling.
+  CHECK_EQ(MOJO_RESULT_OK, CreateWaitSet(&wait_set_));
+  CHECK_EQ(MOJO_RESULT_OK, CreateMessagePipe(&read_handle_, &write_handle_));
+  CHECK_EQ(MOJO_RESULT_OK,
+           AddToWaitSet(wait_set_.get(), read_handle_.get(),
+                        MOJO_WAIT_FLAG_READABLE, kControlPipeContext));
+  lazy_tls_ptr.Pointer()->Set(this);
 }
 
 MessagePumpMojo::~MessagePumpMojo() {
+  if (current() == this)
+    lazy_tls_ptr.Pointer()->Set(NULL);
+}
+
+// static
+MessagePumpMojo* MessagePumpMojo::current() {
+  return lazy_tls_ptr.Pointer()->Get();
 }
 
 void MessagePumpMojo::AddHandler(MessagePumpMojoHandler* handler,
@@ -55,18 +71,29 @@ void MessagePumpMojo::AddHandler(MessagePumpMojoHandler* handler,
   handler_data.deadline = deadline;
   handler_data.id = next_handler_id_++;
   handlers_[handle] = handler_data;
+  id_to_handle_[handler_data.id] = handle;
+  if (!deadline.is_null())
+    deadlines_.insert(std::make_pair(deadline, handler_data.id));
+  AddToWaitSetForHandler(handler_data.id);
 }
 
 void MessagePumpMojo::RemoveHandler(const Handle& handle) {
-  handlers_.erase(handle);
+  HandleToHandler::iterator it = handlers_.find(handle);
+  if (it == handlers_.end())
+    return;
+
+  // This fails if |handle| has been closed, in which case it has already left
+  // the wait set.
+  RemoveFromWaitSet(wait_set_.get(), handle);
+  id_to_handle_.erase(it->second.id);
+  if (!it->second.deadline.is_null())
+    deadlines_.erase(std::make_pair(it->second.deadline, it->second.id));
+  handlers_.erase(it);
 }
 
 void MessagePumpMojo::Run(Delegate* delegate) {
   RunState* old_state = run_state_;
   RunState run_state;
-  // TODO: better deal with error handling.
-  CHECK(run_state.read_handle.is_valid());
-  CHECK(run_state.write_handle.is_valid());
   run_state_ = &run_state;
   bool more_work_is_plausible = true;
   for (;;) {
@@ -117,103 +144,133 @@ void MessagePumpMojo::ScheduleDelayedWork(
 }
 
 void MessagePumpMojo::DoInternalWork(bool block) {
+  // Handlers whose handles aren't valid are notified without waiting.
+  std::vector<uint64_t> invalid_handler_ids;
+  invalid_handler_ids.swap(invalid_handler_ids_);
+  for (size_t i = 0; i < invalid_handler_ids.size(); ++i) {
+    IdToHandle::const_iterator it = id_to_handle_.find(invalid_handler_ids[i]);
+    if (it != id_to_handle_.end())
+      RemoveAndNotifyError(it->second, MOJO_RESULT_INVALID_ARGUMENT);
+  }
+
   const MojoDeadline deadline = block ? GetDeadlineForWait() : 0;
-  const WaitState wait_state = GetWaitState();
-  const MojoResult result =
-      WaitMany(wait_state.handles, wait_state.wait_flags, deadline);
-  if (result == 0) {
-    // Control pipe was written to.
-    uint32_t num_bytes = 0;
-    ReadMessageRaw(run_state_->read_handle.get(), NULL, &num_bytes, NULL, NULL,
-                   MOJO_READ_MESSAGE_FLAG_MAY_DISCARD);
-  } else if (result > 0) {
-    const size_t index = static_cast<size_t>(result);
-    DCHECK(handlers_.find(wait_state.handles[index]) != handlers_.end());
-    handlers_[wait_state.handles[index]].handler->OnHandleReady(
-        wait_state.handles[index]);
-  } else {
-    switch (result) {
-      case MOJO_RESULT_INVALID_ARGUMENT:
-      case MOJO_RESULT_FAILED_PRECONDITION:
-        RemoveFirstInvalidHandle(wait_state);
-        break;
-      case MOJO_RESULT_DEADLINE_EXCEEDED:
-        break;
-      default:
-        NOTREACHED();
+  uint32_t num_results = kMaxResultsPerWait;
+  uint64_t contexts[kMaxResultsPerWait];
+  MojoResult results[kMaxResultsPerWait];
+  const MojoResult result = WaitOnWaitSet(wait_set_.get(), deadline,
+                                          &num_results, contexts, results);
+  if (result == MOJO_RESULT_OK) {
+    for (uint32_t i = 0; i < num_results; ++i) {
+      if (contexts[i] == kControlPipeContext) {
+        // TODO(sky): deal with control pipe going bad.
+        DCHECK_EQ(MOJO_RESULT_OK, results[i]);
+        DrainControlPipe();
+        continue;
+      }
+
+      // The handler may have been removed while notifying an earlier one.
+      IdToHandle::const_iterator it = id_to_handle_.find(contexts[i]);
+      if (it == id_to_handle_.end())
+        continue;
+      const Handle handle = it->second;
+      switch (results[i]) {
+        case MOJO_RESULT_OK:
+          handlers_[handle].handler->OnHandleReady(handle);
+          // Wait sets are edge-triggered, so (if the handler is still
+          // registered) the handle has to be added again. If it's still ready,
+          // it's reported again right away.
+          if (id_to_handle_.count(contexts[i])) {
+            RemoveFromWaitSet(wait_set_.get(), handle);
+            AddToWaitSetForHandler(contexts[i]);
+          }
+          break;
+        case MOJO_RESULT_FAILED_PRECONDITION:
+          RemoveAndNotifyError(handle, MOJO_RESULT_FAILED_PRECONDITION);
+          break;
+        case MOJO_RESULT_CANCELLED:
+          // The handle was closed, which is reported as it would be if it had
+          // been closed before being added.
+          RemoveAndNotifyError(handle, MOJO_RESULT_INVALID_ARGUMENT);
+          break;
+        default:
+          NOTREACHED();
+      }
     }
+  } else {
+    DCHECK_EQ(MOJO_RESULT_DEADLINE_EXCEEDED, result);
   }
 
-  // Notify and remove any handlers whose time has expired. Make a copy in case
-  // someone tries to add/remove new handlers from notification.
-  const HandleToHandler cloned_handlers(handlers_);
+  // Notify and remove any handlers whose time has expired. Collect them first,
+  // in case someone tries to add/remove handlers from notification.
   const base::TimeTicks now(base::TimeTicks::Now());
-  for (HandleToHandler::const_iterator i = cloned_handlers.begin();
-       i != cloned_handlers.end(); ++i) {
-    // Since we're iterating over a clone of the handlers, verify the handler is
-    // still valid before notifying.
-    if (!i->second.deadline.is_null() && i->second.deadline < now &&
-        handlers_.find(i->first) != handlers_.end() &&
-        handlers_[i->first].id == i->second.id) {
-      i->second.handler->OnHandleError(i->first, MOJO_RESULT_DEADLINE_EXCEEDED);
-    }
+  std::vector<uint64_t> expired_handler_ids;
+  for (DeadlineSet::const_iterator i = deadlines_.begin();
+       i != deadlines_.end() && i->first < now; ++i) {
+    expired_handler_ids.push_back(i->second);
+  }
+  for (size_t i = 0; i < expired_handler_ids.size(); ++i) {
+    IdToHandle::const_iterator it = id_to_handle_.find(expired_handler_ids[i]);
+    if (it != id_to_handle_.end())
+      RemoveAndNotifyError(it->second, MOJO_RESULT_DEADLINE_EXCEEDED);
   }
 }
 
-void MessagePumpMojo::RemoveFirstInvalidHandle(const WaitState& wait_state) {
-  // TODO(sky): deal with control pipe going bad.
-  for (size_t i = 1; i < wait_state.handles.size(); ++i) {
-    const MojoResult result =
-        Wait(wait_state.handles[i], wait_state.wait_flags[i], 0);
-    if (result == MOJO_RESULT_INVALID_ARGUMENT ||
-        result == MOJO_RESULT_FAILED_PRECONDITION) {
-      // Remove the handle first, this way if OnHandleError() tries to remove
-      // the handle our iterator isn't invalidated.
-      DCHECK(handlers_.find(wait_state.handles[i]) != handlers_.end());
-      MessagePumpMojoHandler* handler =
-          handlers_[wait_state.handles[i]].handler;
-      handlers_.erase(wait_state.handles[i]);
-      handler->OnHandleError(wait_state.handles[i], result);
-      return;
-    } else {
-      DCHECK_EQ(MOJO_RESULT_DEADLINE_EXCEEDED, result);
-    }
+void MessagePumpMojo::AddToWaitSetForHandler(uint64_t id) {
+  DCHECK(id_to_handle_.count(id));
+  const Handle handle = id_to_handle_[id];
+  const MojoResult result = AddToWaitSet(wait_set_.get(), handle,
+                                         handlers_[handle].wait_flags, id);
+  if (result != MOJO_RESULT_OK) {
+    DCHECK_EQ(MOJO_RESULT_INVALID_ARGUMENT, result);
+    invalid_handler_ids_.push_back(id);
   }
 }
 
-void MessagePumpMojo::SignalControlPipe() {
-  if (!run_state_)
-    return;
+void MessagePumpMojo::RemoveAndNotifyError(const Handle& handle,
+                                           MojoResult result) {
+  // Remove the handler first, this way it may add itself (or another handler
+  // for |handle|) again from OnHandleError().
+  // |handle| may refer to an entry of |id_to_handle_|, so copy it first.
+  const Handle handle_copy(handle);
+  DCHECK(handlers_.find(handle_copy) != handlers_.end());
+  MessagePumpMojoHandler* handler = handlers_[handle_copy].handler;
+  RemoveHandler(handle_copy);
+  handler->OnHandleError(handle_copy, result);
+}
 
+void MessagePumpMojo::SignalControlPipe() {
   // TODO(sky): deal with error?
-  WriteMessageRaw(run_state_->write_handle.get(), NULL, 0, NULL, 0,
+  WriteMessageRaw(write_handle_.get(), NULL, 0, NULL, 0,
                   MOJO_WRITE_MESSAGE_FLAG_NONE);
 }
 
-MessagePumpMojo::WaitState MessagePumpMojo::GetWaitState() const {
-  WaitState wait_state;
-  wait_state.handles.push_back(run_state_->read_handle.get());
-  wait_state.wait_flags.push_back(MOJO_WAIT_FLAG_READABLE);
-
-  for (HandleToHandler::const_iterator i = handlers_.begin();
-       i != handlers_.end(); ++i) {
-    wait_state.handles.push_back(i->first);
-    wait_state.wait_flags.push_back(i->second.wait_flags);
+void MessagePumpMojo::DrainControlPipe() {
+  // The control pipe is only reported when it becomes readable, so all the
+  // messages have to be read.
+  for (;;) {
+    uint32_t num_bytes = 0;
+    const MojoResult result =
+        ReadMessageRaw(read_handle_.get(), NULL, &num_bytes, NULL, NULL,
+                       MOJO_READ_MESSAGE_FLAG_MAY_DISCARD);
+    if (result != MOJO_RESULT_OK) {
+      DCHECK_EQ(MOJO_RESULT_SHOULD_WAIT, result);
+      break;
+    }
   }
-  return wait_state;
 }
 
 MojoDeadline MessagePumpMojo::GetDeadlineForWait() const {
+  if (!invalid_handler_ids_.empty())
+    return 0;
   base::TimeTicks min_time = run_state_->delayed_work_time;
-  for (HandleToHandler::const_iterator i = handlers_.begin();
-       i != handlers_.end(); ++i) {
-    if (min_time.is_null() && i->second.deadline < min_time)
-      min_time = i->second.deadline;
-  }
-  return min_time.is_null() ? MOJO_DEADLINE_INDEFINITE :
-      std::max(static_cast<MojoDeadline>(0),
-               static_cast<MojoDeadline>(
-                   (min_time - base::TimeTicks::Now()).InMicroseconds()));
+  if (!deadlines_.empty() &&
+      (min_time.is_null() || deadlines_.begin()->first < min_time))
+    min_time = deadlines_.begin()->first;
+  if (min_time.is_null())
+    return MOJO_DEADLINE_INDEFINITE;
+  return static_cast<MojoDeadline>(std::max(
+      static_cast<int64>(0),
+      (min_time - base::TimeTicks::Now()).InMicroseconds()));
 }
 
 }  // namespace common
@@ -6,6 +6,9 @@
 #define MOJO_COMMON_MESSAGE_PUMP_MOJO_H_
 
 #include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "base/message_loop/message_pump.h"
 #include "base/time/time.h"
@@ -17,14 +20,22 @@ namespace common {
 
 class MessagePumpMojoHandler;
 
-// Mojo implementation of MessagePump.
+// Mojo implementation of MessagePump. Handles are watched with a wait set (see
+// |MojoCreateWaitSet()|), so the cost of adding, removing and servicing a
+// handler doesn't depend on the number of handlers.
 class MOJO_COMMON_EXPORT MessagePumpMojo : public base::MessagePump {
  public:
   MessagePumpMojo();
   virtual ~MessagePumpMojo();
 
+  // Returns the MessagePumpMojo created on the current thread, or NULL if there
+  // isn't one.
+  static MessagePumpMojo* current();
+
   // Registers a MessagePumpMojoHandler for the specified handle. Only one
-  // handler can be registered for a specified handle.
+  // handler can be registered for a specified handle. The handler is removed
+  // before it's notified of an error (including the deadline passing), but
+  // stays registered after it's notified that the handle is ready.
   void AddHandler(MessagePumpMojoHandler* handler,
                   const Handle& handle,
                   MojoWaitFlags wait_flags,
@@ -41,7 +52,6 @@ class MOJO_COMMON_EXPORT MessagePumpMojo : public base::MessagePump {
 
  private:
   struct RunState;
-  struct WaitState;
 
   // Contains the data needed to track a request to AddHandler().
   struct Handler {
@@ -51,38 +61,59 @@ class MOJO_COMMON_EXPORT MessagePumpMojo : public base::MessagePump {
     MojoWaitFlags wait_flags;
     base::TimeTicks deadline;
     // See description of |MessagePumpMojo::next_handler_id_| for details.
-    int id;
+    uint64_t id;
   };
 
   typedef std::map<Handle, Handler> HandleToHandler;
+  typedef std::map<uint64_t, Handle> IdToHandle;
+  // The deadlines of the handlers that have one, with their ids.
+  typedef std::set<std::pair<base::TimeTicks, uint64_t> > DeadlineSet;
 
   // Services the set of handles ready. If |block| is true this waits for a
   // handle to become ready, otherwise this does not block.
   void DoInternalWork(bool block);
 
-  // Removes the first invalid handle. This is called if MojoWaitMany finds an
-  // invalid handle.
-  void RemoveFirstInvalidHandle(const WaitState& wait_state);
+  // Adds the handle of the handler with id |id| to |wait_set_|. If it can't be
+  // added (i.e., it isn't a valid handle), the handler is notified of the
+  // error by the next call to DoInternalWork().
+  void AddToWaitSetForHandler(uint64_t id);
+
+  // Removes the handler for |handle|, then notifies it of |result|.
+  void RemoveAndNotifyError(const Handle& handle, MojoResult result);
 
   void SignalControlPipe();
 
-  WaitState GetWaitState() const;
+  // Reads all the messages from |read_handle_|.
+  void DrainControlPipe();
 
-  // Returns the deadline for the call to MojoWaitMany().
+  // Returns the deadline for the call to MojoWaitOnWaitSet().
   MojoDeadline GetDeadlineForWait() const;
 
   // If non-NULL we're running (inside Run()). Member is reference to value on
   // stack.
   RunState* run_state_;
 
-  HandleToHandler handlers_;
+  // Contains |read_handle_| (with context 0) and the handle of each handler
+  // (with the handler's id as context).
+  ScopedWaitSetHandle wait_set_;
 
-  // An ever increasing value assigned to each Handler::id. Used to detect
-  // uniqueness while notifying. That is, while notifying expired timers we copy
-  // |handlers_| and only notify handlers whose id match. If the id does not
-  // match it means the handler was removed then added so that we shouldn't
-  // notify it.
-  int next_handler_id_;
+  // Used to wake up DoInternalWork().
+  ScopedMessagePipeHandle read_handle_;
+  ScopedMessagePipeHandle write_handle_;
+
+  HandleToHandler handlers_;
+  IdToHandle id_to_handle_;
+  DeadlineSet deadlines_;
+
+  // Ids of handlers whose handles couldn't be added to |wait_set_|.
+  std::vector<uint64_t> invalid_handler_ids_;
+
+  // An ever increasing value assigned to each Handler::id (starting at 1).
+  // Used to detect uniqueness while notifying. That is, a handler is only
+  // notified of a result from |wait_set_| or of an expired deadline if its id
+  // matches. If the id does not match it means the handler was removed (and
+  // perhaps added again), so that we shouldn't notify it.
+  uint64_t next_handler_id_;
 
   DISALLOW_COPY_AND_ASSIGN(MessagePumpMojo);
 };
@@ -103,6 +103,9 @@ class TypeConverter<String, std::string> {
  public:
   static String ConvertFrom(const std::string& input, Buffer* buf);
   static std::string ConvertTo(const String& input);
+  static size_t GetSerializedSize(const std::string& input) {
+    return String::Data::GetSerializedSize(input.size());
+  }
 };
 
 template <size_t N>
@@ -113,6 +116,9 @@ class TypeConverter<String, char[N]> {
     memcpy(&result[0], input, N - 1);
     return result.Finish();
   }
+  static size_t GetSerializedSize(const char input[N]) {
+    return String::Data::GetSerializedSize(N - 1);
+  }
 };
 
 // Appease MSVC.
@@ -122,12 +128,16 @@ class TypeConverter<String, const char[N]> {
   static String ConvertFrom(const char input[N], Buffer* buf) {
     return TypeConverter<String, char[N]>::ConvertFrom(input, buf);
   }
+  static size_t GetSerializedSize(const char input[N]) {
+    return TypeConverter<String, char[N]>::GetSerializedSize(input);
+  }
 };
 
 template <>
 class TypeConverter<String, const char*> {
  public:
   static String ConvertFrom(const char* input, Buffer* buf);
+  static size_t GetSerializedSize(const char* input);
   // NOTE: |ConvertTo| explicitly not implemented since String is not null
   // terminated (and may have embedded null bytes).
 };
@@ -150,6 +160,14 @@ class TypeConverter<Array<T>, std::vector<E> > {
     }
     return result;
   }
+  // Only for arrays of objects (the only ones convertible from vectors), so
+  // this includes the objects the elements point to.
+  static size_t GetSerializedSize(const std::vector<E>& input) {
+    size_t result = Array<T>::Data::GetSerializedSize(input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+      result += TypeConverter<T, E>::GetSerializedSize(input[i]);
+    return result;
+  }
 };
 
 }  // namespace mojo
@@ -35,4 +35,12 @@ String TypeConverter<String, const char*>::ConvertFrom(const char* input,
   return result.Finish();
 }
 
+// static
+size_t TypeConverter<String, const char*>::GetSerializedSize(
+    const char* input) {
+  if (!input)
+    return 0;
+  return String::Data::GetSerializedSize(strlen(input));
+}
+
 }  // namespace mojo
@@ -203,6 +203,13 @@ class Array_Data {
                                                         num_elements);
   }
 
+  // Returns the number of bytes that |New()| allocates from a Buffer for an
+  // array of |num_elements|, not counting any objects that the elements point
+  // to.
+  static size_t GetSerializedSize(size_t num_elements) {
+    return Align(sizeof(Array_Data<T>) + Traits::GetStorageSize(num_elements));
+  }
+
   size_t size() const { return header_.num_elements; }
 
   Ref at(size_t offset) {
@@ -83,5 +83,38 @@ TEST(ArrayTest, Handle) {
   EXPECT_FALSE(handles[0].is_valid());
 }
 
+// Tests that GetSerializedSize() predicts exactly what converting to a String
+// allocates, so that strings can be converted straight into a message buffer.
+// (FixedBuffer asserts that it has room for each allocation.)
+TEST(ArrayTest, GetSerializedSize) {
+  Environment env;
+
+  std::string str(100, 'x');
+  size_t size = TypeConverter<String, std::string>::GetSerializedSize(str);
+  EXPECT_EQ(internal::Align(8 + 100), size);
+
+  internal::FixedBuffer buf(size);
+  String string(str, &buf);
+  EXPECT_EQ(str, string.To<std::string>());
+
+  typedef TypeConverter<String, const char*> CStringConverter;
+  EXPECT_EQ(0u, CStringConverter::GetSerializedSize(NULL));
+  EXPECT_EQ(16u, CStringConverter::GetSerializedSize("hi"));
+
+  // For arrays of strings, this includes the strings.
+  std::vector<std::string> strs;
+  strs.push_back("hello");
+  strs.push_back(std::string());
+  strs.push_back(str);
+  size = TypeConverter<Array<String>, std::vector<std::string> >::
+      GetSerializedSize(strs);
+  EXPECT_EQ(internal::Align(8 + 3 * 8) + 16u + 8u + internal::Align(8 + 100),
+            size);
+
+  internal::FixedBuffer strs_buf(size);
+  Array<String> array(strs, &strs_buf);
+  EXPECT_EQ(strs, array.To<std::vector<std::string> >());
+}
+
 }  // namespace test
 }  // namespace mojo
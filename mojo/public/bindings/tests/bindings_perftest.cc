@@ -0,0 +1,146 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This tests the performance of serializing large arrays into messages.
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include "mojo/public/bindings/allocation_scope.h"
+#include "mojo/public/bindings/array.h"
+#include "mojo/public/bindings/lib/message_builder.h"
+#include "mojo/public/bindings/message.h"
+#include "mojo/public/environment/environment.h"
+#include "mojo/public/system/core_cpp.h"
+#include "mojo/public/system/macros.h"
+#include "mojo/public/tests/test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace mojo {
+namespace test {
+namespace {
+
+const uint32_t kEchoMessageName = 1;
+
+// Writes |message|'s data (it has no handles) to |handle|.
+void WriteMessage(const MessagePipeHandle& handle, Message* message) {
+  MojoResult result MOJO_ALLOW_UNUSED;
+  result = WriteMessageRaw(handle, message->data,
+                           message->data->header.num_bytes, NULL, 0,
+                           MOJO_WRITE_MESSAGE_FLAG_NONE);
+  assert(result == MOJO_RESULT_OK);
+}
+
+// Reads a message whose payload is a string from |handle|, and returns a view
+// of the string in |message|.
+String ReadMessage(const MessagePipeHandle& handle, Message* message) {
+  uint32_t num_bytes = 0;
+  MojoResult result MOJO_ALLOW_UNUSED;
+  result = ReadMessageRaw(handle, NULL, &num_bytes, NULL, NULL,
+                          MOJO_READ_MESSAGE_FLAG_NONE);
+  assert(result == MOJO_RESULT_RESOURCE_EXHAUSTED);
+  message->data = static_cast<MessageData*>(malloc(num_bytes));
+  result = ReadMessageRaw(handle, message->data, &num_bytes, NULL, NULL,
+                          MOJO_READ_MESSAGE_FLAG_NONE);
+  assert(result == MOJO_RESULT_OK);
+  return internal::Wrap(
+      reinterpret_cast<internal::String_Data*>(message->data->payload));
+}
+
+class BindingsPerftest : public testing::Test {
+ public:
+  BindingsPerftest() {}
+  virtual ~BindingsPerftest() {}
+
+  // Sends |str_| to the other end and echoes it back, the way bindings
+  // serialize through an |AllocationScope|: the string is built in scratch
+  // memory and cloned into the message, and the echo copies the received
+  // string out of its message before sending it back.
+  static void Echo_ThroughAllocationScope(void* closure) {
+    BindingsPerftest* self = static_cast<BindingsPerftest*>(closure);
+    self->SendThroughAllocationScope(self->pipe0_.get(), self->str_);
+
+    Message request;
+    std::string received = ReadMessage(self->pipe1_.get(), &request);
+    self->SendThroughAllocationScope(self->pipe1_.get(), received);
+
+    Message response;
+    ReadMessage(self->pipe0_.get(), &response);
+  }
+
+  // Same as the above, but each message is allocated at its final size and
+  // serialized into directly, and the echo reads the received string in place.
+  static void Echo_Direct(void* closure) {
+    BindingsPerftest* self = static_cast<BindingsPerftest*>(closure);
+    {
+      internal::MessageBuilder builder(
+          kEchoMessageName,
+          TypeConverter<String, std::string>::GetSerializedSize(self->str_));
+      String string(self->str_, builder.buffer());
+      Message message;
+      message.data = builder.Finish();
+      WriteMessage(self->pipe0_.get(), &message);
+    }
+
+    Message request;
+    String received = ReadMessage(self->pipe1_.get(), &request);
+    {
+      const internal::String_Data* data = internal::Unwrap(received);
+      internal::MessageBuilder builder(kEchoMessageName, data->ComputeSize());
+      data->Clone(builder.buffer());
+      Message message;
+      message.data = builder.Finish();
+      WriteMessage(self->pipe1_.get(), &message);
+    }
+
+    Message response;
+    ReadMessage(self->pipe0_.get(), &response);
+  }
+
+ protected:
+  virtual void SetUp() MOJO_OVERRIDE {
+    CreateMessagePipe(&pipe0_, &pipe1_);
+  }
+
+  void SendThroughAllocationScope(const MessagePipeHandle& handle,
+                                  const std::string& str) {
+    AllocationScope scope;
+    String string(str);
+    const internal::String_Data* data = internal::Unwrap(string);
+    internal::MessageBuilder builder(kEchoMessageName, data->ComputeSize());
+    data->Clone(builder.buffer());
+    Message message;
+    message.data = builder.Finish();
+    WriteMessage(handle, &message);
+  }
+
+  Environment env_;
+  ScopedMessagePipeHandle pipe0_;
+  ScopedMessagePipeHandle pipe1_;
+  std::string str_;
+
+ private:
+  MOJO_DISALLOW_COPY_AND_ASSIGN(BindingsPerftest);
+};
+
+TEST_F(BindingsPerftest, Echo) {
+  str_.assign(100, 'x');
+  IterateAndReportPerf("Echo_ThroughAllocationScope_100bytes",
+                       &BindingsPerftest::Echo_ThroughAllocationScope, this);
+  IterateAndReportPerf("Echo_Direct_100bytes",
+                       &BindingsPerftest::Echo_Direct, this);
+
+  str_.assign(100000, 'x');
+  IterateAndReportPerf("Echo_ThroughAllocationScope_100000bytes",
+                       &BindingsPerftest::Echo_ThroughAllocationScope, this);
+  IterateAndReportPerf("Echo_Direct_100000bytes",
+                       &BindingsPerftest::Echo_Direct, this);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace mojo
@@ -11,6 +11,10 @@ namespace mojo {
 template <typename T, typename U> class TypeConverter {
   // static T ConvertFrom(const U& input, Buffer* buf);
   // static U ConvertTo(const T& input);
+  //
+  // Optionally, to let |input| be serialized straight into a message buffer
+  // allocated at its final size:
+  // static size_t GetSerializedSize(const U& input);
 };
 
 }  // namespace mojo
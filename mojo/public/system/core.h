@@ -428,6 +428,85 @@ MOJO_SYSTEM_EXPORT MojoResult MojoWaitMany(const MojoHandle* handles,
                                            uint32_t num_handles,
                                            MojoDeadline deadline);
 
+// Wait sets:
+
+// Creates a wait set, which is used to wait on many handles at once, like
+// |MojoWaitMany()|. Unlike with |MojoWaitMany()|, handles are added to and
+// removed from a wait set one at a time, and a wait does not depend on the
+// number of handles in the set, so a wait set is suited to waiting on a large
+// set of handles that changes over time. On success, |*wait_set_handle| is set
+// to a handle for the wait set. A wait set may not be added to a wait set,
+// waited on using |MojoWait()|, etc., or sent over a message pipe.
+//
+// Returns:
+//   |MOJO_RESULT_OK| on success.
+//   |MOJO_RESULT_INVALID_ARGUMENT| if |wait_set_handle| does not appear to be a
+//       valid pointer.
+//   |MOJO_RESULT_RESOURCE_EXHAUSTED| if a process/system/quota/etc. limit has
+//       been reached.
+MOJO_SYSTEM_EXPORT MojoResult MojoCreateWaitSet(
+    MojoHandle* wait_set_handle);  // Out.
+
+// Adds |handle| to the wait set given by |wait_set_handle|, waiting for the
+// state indicated by |flags|. |context| is an arbitrary value, which
+// |MojoWaitOnWaitSet()| reports for |handle|.
+//
+// Readiness is edge-triggered: |handle| is reported when it is added if it
+// already satisfies |flags| (or never can), and then once for each subsequent
+// change of its state that satisfies |flags| (or makes them unsatisfiable),
+// with changes that happen before the previous report was collected coalesced.
+// Closing |handle| removes it from the wait set, after reporting it one last
+// time (with result |MOJO_RESULT_CANCELLED|).
+//
+// Returns:
+//   |MOJO_RESULT_OK| if |handle| was added.
+//   |MOJO_RESULT_INVALID_ARGUMENT| if |wait_set_handle| is not a valid handle
+//       to a wait set, or if |handle| is not a valid handle or is a handle to a
+//       wait set.
+//   |MOJO_RESULT_ALREADY_EXISTS| if |handle| is already in the wait set.
+MOJO_SYSTEM_EXPORT MojoResult MojoAddToWaitSet(MojoHandle wait_set_handle,
+                                               MojoHandle handle,
+                                               MojoWaitFlags flags,
+                                               uint64_t context);
+
+// Removes |handle| from the wait set given by |wait_set_handle|. |handle| won't
+// be reported by |MojoWaitOnWaitSet()| after this (even if it was ready
+// before).
+//
+// Returns:
+//   |MOJO_RESULT_OK| if |handle| was removed.
+//   |MOJO_RESULT_INVALID_ARGUMENT| if |wait_set_handle| is not a valid handle
+//       to a wait set, or if |handle| is not a valid handle.
+//   |MOJO_RESULT_NOT_FOUND| if |handle| is not in the wait set.
+MOJO_SYSTEM_EXPORT MojoResult MojoRemoveFromWaitSet(MojoHandle wait_set_handle,
+                                                    MojoHandle handle);
+
+// Waits on the wait set given by |wait_set_handle| until at least one of its
+// handles is ready (see |MojoAddToWaitSet()|), or until |deadline| has passed.
+// On input, |*num_results| must be the (nonzero) number of elements in
+// |contexts| and |results|. On success, |*num_results| is set to the number of
+// handles reported, and for each reported handle |contexts[i]| is set to the
+// context given when it was added and |results[i]| to:
+//   |MOJO_RESULT_OK| if the handle satisfies some flag given when it was added.
+//   |MOJO_RESULT_FAILED_PRECONDITION| if it is or becomes impossible that the
+//       handle will ever satisfy any of those flags.
+//   |MOJO_RESULT_CANCELLED| if the handle was closed.
+//
+// Returns:
+//   |MOJO_RESULT_OK| if at least one handle was reported.
+//   |MOJO_RESULT_INVALID_ARGUMENT| if |wait_set_handle| is not a valid handle
+//       to a wait set, or if |num_results|, |contexts| and/or |results| do not
+//       appear to be valid pointers.
+//   |MOJO_RESULT_DEADLINE_EXCEEDED| if the deadline has passed without any
+//       handle being ready.
+//   |MOJO_RESULT_CANCELLED| if the wait set was closed during the wait.
+MOJO_SYSTEM_EXPORT MojoResult MojoWaitOnWaitSet(
+    MojoHandle wait_set_handle,
+    MojoDeadline deadline,
+    uint32_t* num_results,  // In/out.
+    uint64_t* contexts,  // Out.
+    MojoResult* results);  // Out.
+
 // Message pipe:
 
 // Creates a message pipe, which is a bidirectional communication channel for
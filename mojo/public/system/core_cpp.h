@@ -172,6 +172,54 @@ inline bool operator<(const Handle& a, const Handle& b) {
   return a.value() < b.value();
 }
 
+// WaitSetHandle ---------------------------------------------------------------
+
+class WaitSetHandle : public Handle {
+ public:
+  WaitSetHandle() {}
+  explicit WaitSetHandle(MojoHandle value) : Handle(value) {}
+
+  // Copying and assignment allowed.
+};
+
+MOJO_COMPILE_ASSERT(sizeof(WaitSetHandle) == sizeof(Handle),
+                    bad_size_for_cpp_WaitSetHandle);
+
+typedef ScopedHandleBase<WaitSetHandle> ScopedWaitSetHandle;
+MOJO_COMPILE_ASSERT(sizeof(ScopedWaitSetHandle) == sizeof(WaitSetHandle),
+                    bad_size_for_cpp_ScopedWaitSetHandle);
+
+inline MojoResult CreateWaitSet(ScopedWaitSetHandle* wait_set) {
+  assert(wait_set);
+  WaitSetHandle handle;
+  MojoResult rv = MojoCreateWaitSet(handle.mutable_value());
+  // Reset even on failure (reduces the chances that a "stale"/incorrect handle
+  // will be used).
+  wait_set->reset(handle);
+  return rv;
+}
+
+inline MojoResult AddToWaitSet(WaitSetHandle wait_set,
+                               const Handle& handle,
+                               MojoWaitFlags flags,
+                               uint64_t context) {
+  return MojoAddToWaitSet(wait_set.value(), handle.value(), flags, context);
+}
+
+inline MojoResult RemoveFromWaitSet(WaitSetHandle wait_set,
+                                    const Handle& handle) {
+  return MojoRemoveFromWaitSet(wait_set.value(), handle.value());
+}
+
+inline MojoResult WaitOnWaitSet(WaitSetHandle wait_set,
+                                MojoDeadline deadline,
+                                uint32_t* num_results,
+                                uint64_t* contexts,
+                                MojoResult* results) {
+  return MojoWaitOnWaitSet(wait_set.value(), deadline, num_results, contexts,
+                           results);
+}
+
 // MessagePipeHandle -----------------------------------------------------------
 
 class MessagePipeHandle : public Handle {
@@ -36,6 +36,35 @@ MojoResult MojoWaitMany(const MojoHandle* handles,
   return g_core->WaitMany(handles, flags, num_handles, deadline);
 }
 
+MojoResult MojoCreateWaitSet(MojoHandle* wait_set_handle) {
+  assert(g_core);
+  return g_core->CreateWaitSet(wait_set_handle);
+}
+
+MojoResult MojoAddToWaitSet(MojoHandle wait_set_handle,
+                            MojoHandle handle,
+                            MojoWaitFlags flags,
+                            uint64_t context) {
+  assert(g_core);
+  return g_core->AddToWaitSet(wait_set_handle, handle, flags, context);
+}
+
+MojoResult MojoRemoveFromWaitSet(MojoHandle wait_set_handle,
+                                 MojoHandle handle) {
+  assert(g_core);
+  return g_core->RemoveFromWaitSet(wait_set_handle, handle);
+}
+
+MojoResult MojoWaitOnWaitSet(MojoHandle wait_set_handle,
+                             MojoDeadline deadline,
+                             uint32_t* num_results,
+                             uint64_t* contexts,
+                             MojoResult* results) {
+  assert(g_core);
+  return g_core->WaitOnWaitSet(wait_set_handle, deadline, num_results,
+                               contexts, results);
+}
+
 MojoResult MojoCreateMessagePipe(MojoHandle* message_pipe_handle0,
                                  MojoHandle* message_pipe_handle1) {
   assert(g_core);
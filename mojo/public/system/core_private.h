@@ -29,6 +29,18 @@ class MOJO_SYSTEM_EXPORT Core {
                               const MojoWaitFlags* flags,
                               uint32_t num_handles,
                               MojoDeadline deadline) = 0;
+  virtual MojoResult CreateWaitSet(MojoHandle* wait_set_handle) = 0;
+  virtual MojoResult AddToWaitSet(MojoHandle wait_set_handle,
+                                  MojoHandle handle,
+                                  MojoWaitFlags flags,
+                                  uint64_t context) = 0;
+  virtual MojoResult RemoveFromWaitSet(MojoHandle wait_set_handle,
+                                       MojoHandle handle) = 0;
+  virtual MojoResult WaitOnWaitSet(MojoHandle wait_set_handle,
+                                   MojoDeadline deadline,
+                                   uint32_t* num_results,
+                                   uint64_t* contexts,
+                                   MojoResult* results) = 0;
   virtual MojoResult CreateMessagePipe(MojoHandle* message_pipe_handle0,
                                        MojoHandle* message_pipe_handle1) = 0;
   virtual MojoResult WriteMessage(MojoHandle message_pipe_handle,
@@ -17,6 +17,7 @@
 #include "mojo/system/memory.h"
 #include "mojo/system/message_pipe.h"
 #include "mojo/system/message_pipe_dispatcher.h"
+#include "mojo/system/wait_set_dispatcher.h"
 #include "mojo/system/waiter.h"
 
 namespace mojo {
@@ -58,6 +59,7 @@ namespace system {
 //
 // The lock ordering is as follows:
 //   1. global handle table lock
+//   1.5. |WaitSetDispatcher| locks
 //   2. |Dispatcher| locks
 //   3. secondary object locks
 //   ...
@@ -67,7 +69,8 @@ namespace system {
 //    - While holding a |Dispatcher| lock, you may not unconditionally attempt
 //      to take another |Dispatcher| lock. (This has consequences on the
 //      concurrency semantics of |MojoWriteMessage()| when passing handles.)
-//      Doing so would lead to deadlock.
+//      Doing so would lead to deadlock. The exception is a wait set, which
+//      adds and removes waiters on the dispatchers in it under its own lock.
 //    - Locks at the "INF" level may not have any locks taken while they are
 //      held.
 
@@ -148,6 +151,70 @@ MojoResult CoreImpl::WaitMany(const MojoHandle* handles,
   return WaitManyInternal(handles, flags, num_handles, deadline);
 }
 
+MojoResult CoreImpl::CreateWaitSet(MojoHandle* wait_set_handle) {
+  if (!VerifyUserPointer<MojoHandle>(wait_set_handle, 1))
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  scoped_refptr<WaitSetDispatcher> dispatcher(new WaitSetDispatcher());
+  MojoHandle handle = AddDispatcher(dispatcher);
+  if (handle == MOJO_HANDLE_INVALID) {
+    dispatcher->Close();
+    return MOJO_RESULT_RESOURCE_EXHAUSTED;
+  }
+
+  *wait_set_handle = handle;
+  return MOJO_RESULT_OK;
+}
+
+MojoResult CoreImpl::AddToWaitSet(MojoHandle wait_set_handle,
+                                  MojoHandle handle,
+                                  MojoWaitFlags flags,
+                                  uint64_t context) {
+  scoped_refptr<WaitSetDispatcher> wait_set(
+      GetWaitSetDispatcher(wait_set_handle));
+  if (!wait_set.get())
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  scoped_refptr<Dispatcher> dispatcher(GetDispatcher(handle));
+  if (!dispatcher.get() || dispatcher->GetType() == Dispatcher::kTypeWaitSet)
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  return wait_set->Add(dispatcher, flags, context);
+}
+
+MojoResult CoreImpl::RemoveFromWaitSet(MojoHandle wait_set_handle,
+                                       MojoHandle handle) {
+  scoped_refptr<WaitSetDispatcher> wait_set(
+      GetWaitSetDispatcher(wait_set_handle));
+  if (!wait_set.get())
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  scoped_refptr<Dispatcher> dispatcher(GetDispatcher(handle));
+  if (!dispatcher.get())
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  return wait_set->Remove(dispatcher.get());
+}
+
+MojoResult CoreImpl::WaitOnWaitSet(MojoHandle wait_set_handle,
+                                   MojoDeadline deadline,
+                                   uint32_t* num_results,
+                                   uint64_t* contexts,
+                                   MojoResult* results) {
+  scoped_refptr<WaitSetDispatcher> wait_set(
+      GetWaitSetDispatcher(wait_set_handle));
+  if (!wait_set.get())
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  if (!VerifyUserPointer<uint32_t>(num_results, 1))
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  if (*num_results < 1)
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  if (!VerifyUserPointer<uint64_t>(contexts, *num_results))
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  if (!VerifyUserPointer<MojoResult>(results, *num_results))
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  return wait_set->Wait(deadline, num_results, contexts, results);
+}
+
 MojoResult CoreImpl::CreateMessagePipe(MojoHandle* message_pipe_handle0,
                                        MojoHandle* message_pipe_handle1) {
   if (!VerifyUserPointer<MojoHandle>(message_pipe_handle0, 1))
@@ -240,6 +307,11 @@ MojoResult CoreImpl::WriteMessage(MojoHandle message_pipe_handle,
         error_result = MOJO_RESULT_INVALID_ARGUMENT;
         break;
       }
+      // Wait sets can't be sent.
+      if (it->second.dispatcher->GetType() == Dispatcher::kTypeWaitSet) {
+        error_result = MOJO_RESULT_INVALID_ARGUMENT;
+        break;
+      }
 
       entries[i] = &it->second;
       if (entries[i]->busy) {
@@ -532,6 +604,14 @@ scoped_refptr<Dispatcher> CoreImpl::GetDispatcher(MojoHandle handle) {
   return it->second.dispatcher;
 }
 
+scoped_refptr<WaitSetDispatcher> CoreImpl::GetWaitSetDispatcher(
+    MojoHandle handle) {
+  scoped_refptr<Dispatcher> dispatcher(GetDispatcher(handle));
+  if (!dispatcher.get() || dispatcher->GetType() != Dispatcher::kTypeWaitSet)
+    return NULL;
+  return static_cast<WaitSetDispatcher*>(dispatcher.get());
+}
+
 MojoHandle CoreImpl::AddDispatcherNoLock(
     const scoped_refptr<Dispatcher>& dispatcher) {
   handle_table_lock_.AssertAcquired();
@@ -18,6 +18,7 @@ namespace system {
 
 class CoreImpl;
 class Dispatcher;
+class WaitSetDispatcher;
 
 // Test-only function (defined/used in embedder/test_embedder.cc). Declared here
 // so it can be friended.
@@ -44,6 +45,18 @@ class MOJO_SYSTEM_IMPL_EXPORT CoreImpl : public Core {
                               const MojoWaitFlags* flags,
                               uint32_t num_handles,
                               MojoDeadline deadline) OVERRIDE;
+  virtual MojoResult CreateWaitSet(MojoHandle* wait_set_handle) OVERRIDE;
+  virtual MojoResult AddToWaitSet(MojoHandle wait_set_handle,
+                                  MojoHandle handle,
+                                  MojoWaitFlags flags,
+                                  uint64_t context) OVERRIDE;
+  virtual MojoResult RemoveFromWaitSet(MojoHandle wait_set_handle,
+                                       MojoHandle handle) OVERRIDE;
+  virtual MojoResult WaitOnWaitSet(MojoHandle wait_set_handle,
+                                   MojoDeadline deadline,
+                                   uint32_t* num_results,
+                                   uint64_t* contexts,
+                                   MojoResult* results) OVERRIDE;
   virtual MojoResult CreateMessagePipe(
       MojoHandle* message_pipe_handle0,
       MojoHandle* message_pipe_handle1) OVERRIDE;
@@ -140,6 +153,10 @@ class MOJO_SYSTEM_IMPL_EXPORT CoreImpl : public Core {
   // invalid.
   scoped_refptr<Dispatcher> GetDispatcher(MojoHandle handle);
 
+  // Looks up the dispatcher for the given handle, which must be a wait set.
+  // Returns null if the handle is invalid or not a wait set.
+  scoped_refptr<WaitSetDispatcher> GetWaitSetDispatcher(MojoHandle handle);
+
   // Assigns a new handle for the given dispatcher; returns
   // |MOJO_HANDLE_INVALID| on failure (due to hitting resource limits) or if
   // |dispatcher| is null. Must be called under |handle_table_lock_|.
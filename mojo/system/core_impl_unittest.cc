@@ -672,6 +672,65 @@ TEST_F(CoreImplTest, DataPipe) {
   EXPECT_EQ(MOJO_RESULT_OK, core()->Close(ch));
 }
 
+TEST_F(CoreImplTest, WaitSet) {
+  MojoHandle ws;
+  MojoHandle h[2];
+  uint64_t contexts[2];
+  MojoResult results[2];
+  uint32_t num_results;
+
+  EXPECT_EQ(MOJO_RESULT_OK, core()->CreateWaitSet(&ws));
+  EXPECT_NE(ws, MOJO_HANDLE_INVALID);
+  EXPECT_EQ(MOJO_RESULT_OK, core()->CreateMessagePipe(&h[0], &h[1]));
+
+  // Bad arguments.
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            core()->AddToWaitSet(h[0], h[1], MOJO_WAIT_FLAG_READABLE, 0));
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            core()->AddToWaitSet(ws, ws, MOJO_WAIT_FLAG_READABLE, 0));
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            core()->AddToWaitSet(ws, MOJO_HANDLE_INVALID,
+                                 MOJO_WAIT_FLAG_READABLE, 0));
+  num_results = 0;
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            core()->WaitOnWaitSet(ws, 0, &num_results, contexts, results));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            core()->WaitOnWaitSet(ws, 0, &num_results, NULL, results));
+
+  // Wait for |h[0]| to become readable.
+  EXPECT_EQ(MOJO_RESULT_OK,
+            core()->AddToWaitSet(ws, h[0], MOJO_WAIT_FLAG_READABLE, 123));
+  EXPECT_EQ(MOJO_RESULT_ALREADY_EXISTS,
+            core()->AddToWaitSet(ws, h[0], MOJO_WAIT_FLAG_READABLE, 123));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            core()->WaitOnWaitSet(ws, 0, &num_results, contexts, results));
+  char buffer[1] = { 'a' };
+  EXPECT_EQ(MOJO_RESULT_OK,
+            core()->WriteMessage(h[1], buffer, 1, NULL, 0,
+                                 MOJO_WRITE_MESSAGE_FLAG_NONE));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            core()->WaitOnWaitSet(ws, 1000000000, &num_results, contexts,
+                                  results));
+  EXPECT_EQ(1u, num_results);
+  EXPECT_EQ(123u, contexts[0]);
+  EXPECT_EQ(MOJO_RESULT_OK, results[0]);
+
+  // Wait sets can't be sent.
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            core()->WriteMessage(h[1], buffer, 1, &ws, 1,
+                                 MOJO_WRITE_MESSAGE_FLAG_NONE));
+
+  EXPECT_EQ(MOJO_RESULT_OK, core()->RemoveFromWaitSet(ws, h[0]));
+  EXPECT_EQ(MOJO_RESULT_NOT_FOUND, core()->RemoveFromWaitSet(ws, h[0]));
+
+  EXPECT_EQ(MOJO_RESULT_OK, core()->Close(ws));
+  EXPECT_EQ(MOJO_RESULT_OK, core()->Close(h[0]));
+  EXPECT_EQ(MOJO_RESULT_OK, core()->Close(h[1]));
+}
+
 // Tests passing data pipe producer and consumer handles.
 TEST_F(CoreImplTest, MessagePipeBasicLocalHandlePassing2) {
   const char kHello[] = "hello";
@@ -361,6 +361,24 @@ DataPipe::~DataPipe() {
   DCHECK(!consumer_waiter_list_.get());
 }
 
+void DataPipe::OnRemoteStateChange(bool remote_closed) {
+  base::AutoLock locker(lock_);
+  if (remote_closed)
+    SetRemoteClosedNoLock();
+  AwakeProducerWaitersForStateChangeNoLock();
+  AwakeConsumerWaitersForStateChangeNoLock();
+}
+
+void DataPipe::SetRemoteClosedNoLock() {
+  lock_.AssertAcquired();
+  // Note: The local side doesn't have a waiter list anymore once it's closed,
+  // but then it's already marked as closed.
+  if (!has_local_producer_no_lock())
+    producer_open_ = false;
+  if (!has_local_consumer_no_lock())
+    consumer_open_ = false;
+}
+
 void DataPipe::AwakeProducerWaitersForStateChangeNoLock() {
   lock_.AssertAcquired();
   if (!has_local_producer_no_lock())
@@ -117,6 +117,17 @@ class MOJO_SYSTEM_IMPL_EXPORT DataPipe :
   virtual MojoWaitFlags ConsumerSatisfiedFlagsNoLock() = 0;
   virtual MojoWaitFlags ConsumerSatisfiableFlagsNoLock() = 0;
 
+  // For subclasses whose producer or consumer is remote, to be called (without
+  // the lock held) when the remote side may have changed the state of the data
+  // pipe, e.g., by writing, reading or closing. This awakes the local waiters
+  // as needed. |remote_closed| should be true if the remote side is closed.
+  void OnRemoteStateChange(bool remote_closed);
+
+  // Marks the remote producer or consumer (whichever there is) as closed. This
+  // must be done once the local side has closed, since a data pipe can only be
+  // destroyed once both sides are closed. Must be called under lock.
+  void SetRemoteClosedNoLock();
+
   // Thread-safe and fast (they don't take the lock):
   bool may_discard() const { return may_discard_; }
   size_t element_num_bytes() const { return element_num_bytes_; }
@@ -47,7 +47,8 @@ class MOJO_SYSTEM_IMPL_EXPORT Dispatcher :
     kTypeUnknown = 0,
     kTypeMessagePipe,
     kTypeDataPipeProducer,
-    kTypeDataPipeConsumer
+    kTypeDataPipeConsumer,
+    kTypeWaitSet
   };
   virtual Type GetType() const = 0;
 
@@ -5,6 +5,8 @@
 #ifndef MOJO_SYSTEM_RAW_CHANNEL_H_
 #define MOJO_SYSTEM_RAW_CHANNEL_H_
 
+#include <stddef.h>
+
 #include <vector>
 
 #include "base/macros.h"
@@ -75,6 +77,26 @@ class MOJO_SYSTEM_IMPL_EXPORT RawChannel {
                             Delegate* delegate,
                             base::MessageLoopForIO* message_loop_for_io);
 
+  // Like |Create()|, but the messages are written to and read from two ring
+  // buffers in shared memory, and |handle| only carries wakeups, which are
+  // only sent to a side that has run out of data to read or of space to write.
+  // This saves a system call per message between busy ends on the same
+  // machine. |shared_memory| is a handle to a zero-filled shared memory region
+  // of |GetSharedMemorySize()| bytes that both ends are created with, and
+  // |is_first_end| must be true for exactly one of them. Returns NULL if
+  // |shared_memory| can't be mapped.
+  // Note: Messages don't carry platform handles yet; once they do, those will
+  // have to go through |handle|.
+  static RawChannel* CreateWithSharedMemory(
+      embedder::ScopedPlatformHandle handle,
+      embedder::ScopedPlatformHandle shared_memory,
+      bool is_first_end,
+      Delegate* delegate,
+      base::MessageLoopForIO* message_loop_for_io);
+
+  // Returns the size of the shared memory for |CreateWithSharedMemory()|.
+  static size_t GetSharedMemorySize();
+
   // This must be called (on an I/O thread) before this object is used. Returns
   // true on success. On failure, |Shutdown()| should *not* be called.
   virtual bool Init() = 0;
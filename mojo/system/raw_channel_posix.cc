@@ -20,10 +20,12 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop/message_loop.h"
+#include "base/memory/shared_memory.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/synchronization/lock.h"
 #include "mojo/system/embedder/platform_handle.h"
 #include "mojo/system/message_in_transit.h"
+#include "mojo/system/shared_ring_buffer.h"
 
 namespace mojo {
 namespace system {
@@ -32,10 +34,23 @@ namespace {
 
 const size_t kReadSize = 4096;
 
+// Capacity of each of the ring buffers used with shared memory, one for each
+// direction.
+const size_t kSharedMemoryRingCapacity = 256 * 1024;
+
+// The byte sent through the socket to wake up the other end when using shared
+// memory. The other end then checks both for messages to read and for room to
+// write its pending messages.
+const char kWakeup = 'W';
+
 class RawChannelPosix : public RawChannel,
                         public base::MessageLoopForIO::Watcher {
  public:
+  // |shared_memory| is null, or mapped (see
+  // |RawChannel::CreateWithSharedMemory()|).
   RawChannelPosix(embedder::ScopedPlatformHandle handle,
+                  scoped_ptr<base::SharedMemory> shared_memory,
+                  bool is_first_end,
                   Delegate* delegate,
                   base::MessageLoopForIO* message_loop_for_io);
   virtual ~RawChannelPosix();
@@ -50,6 +65,20 @@ class RawChannelPosix : public RawChannel,
   virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE;
   virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE;
 
+  // Reads and dispatches the messages available from |fd_| or |read_ring_|.
+  // Must be called on the I/O thread.
+  void ReadMessages();
+
+  // Reads the wakeups available from |fd_| when using shared memory, and
+  // resumes writing to |write_ring_|. Returns false if the channel has failed
+  // or was shut down. Must be called on the I/O thread.
+  bool ReadWakeups();
+
+  // After reading from |read_ring_|, wakes up the writer if it's waiting for
+  // space, and either asks for a wakeup once there's more data or, if there
+  // already is, posts a task to read it. Must be called on the I/O thread.
+  void WaitForRingData();
+
   // Watches for |fd_| to become writable. Must be called on the I/O thread.
   void WaitToWrite();
 
@@ -63,6 +92,16 @@ class RawChannelPosix : public RawChannel,
   // called under |write_lock_|.
   bool WriteFrontMessageNoLock();
 
+  // Same as |WriteFrontMessageNoLock()| when using shared memory, except that
+  // it writes as many of the queued messages as fit in |write_ring_| and wakes
+  // up the reader if needed. If the ring gets full, it leaves the writer
+  // waiting for space, which the reader sends a wakeup for. Must be called
+  // under |write_lock_|.
+  bool WriteToRingNoLock();
+
+  // Writes a wakeup to |fd_|. Returns false on failure.
+  bool WriteWakeup();
+
   // Cancels all pending writes and destroys the contents of
   // |write_message_queue_|. Should only be called if |write_stopped_| is false;
   // sets |write_stopped_| to true. Must be called under |write_lock_|.
@@ -70,6 +109,13 @@ class RawChannelPosix : public RawChannel,
 
   embedder::ScopedPlatformHandle fd_;
 
+  // Only set when using shared memory, in which case the messages go through
+  // the ring buffers, and |fd_| only carries wakeups. |read_ring_| is only used
+  // on the I/O thread, and |write_ring_| under |write_lock_|.
+  scoped_ptr<base::SharedMemory> shared_memory_;
+  scoped_ptr<SharedRingBuffer> read_ring_;
+  scoped_ptr<SharedRingBuffer> write_ring_;
+
   // Only used on the I/O thread:
   scoped_ptr<base::MessageLoopForIO::FileDescriptorWatcher> read_watcher_;
   scoped_ptr<base::MessageLoopForIO::FileDescriptorWatcher> write_watcher_;
@@ -94,10 +140,13 @@ class RawChannelPosix : public RawChannel,
 };
 
 RawChannelPosix::RawChannelPosix(embedder::ScopedPlatformHandle handle,
+                                 scoped_ptr<base::SharedMemory> shared_memory,
+                                 bool is_first_end,
                                  Delegate* delegate,
                                  base::MessageLoopForIO* message_loop_for_io)
     : RawChannel(delegate, message_loop_for_io),
       fd_(handle.Pass()),
+      shared_memory_(shared_memory.Pass()),
       read_buffer_num_valid_bytes_(0),
       write_stopped_(false),
       write_message_offset_(0),
@@ -105,6 +154,26 @@ RawChannelPosix::RawChannelPosix(embedder::ScopedPlatformHandle handle,
   CHECK_EQ(RawChannel::message_loop_for_io()->type(),
            base::MessageLoop::TYPE_IO);
   DCHECK(fd_.is_valid());
+
+  if (shared_memory_.get()) {
+    // The first end writes to the first ring, and reads from the second one.
+    char* memory = static_cast<char*>(shared_memory_->memory());
+    DCHECK(memory);
+    size_t ring_memory_size =
+        SharedRingBuffer::GetRequiredMemorySize(kSharedMemoryRingCapacity);
+    scoped_ptr<SharedRingBuffer> first_ring(
+        new SharedRingBuffer(memory, kSharedMemoryRingCapacity));
+    scoped_ptr<SharedRingBuffer> second_ring(
+        new SharedRingBuffer(memory + ring_memory_size,
+                             kSharedMemoryRingCapacity));
+    if (is_first_end) {
+      write_ring_ = first_ring.Pass();
+      read_ring_ = second_ring.Pass();
+    } else {
+      write_ring_ = second_ring.Pass();
+      read_ring_ = first_ring.Pass();
+    }
+  }
 }
 
 RawChannelPosix::~RawChannelPosix() {
@@ -142,6 +211,11 @@ bool RawChannelPosix::Init() {
     return false;
   }
 
+  // The other end only sends a wakeup once we've said that we're waiting for
+  // one, and it may already have written messages.
+  if (read_ring_.get())
+    WaitForRingData();
+
   return true;
 }
 
@@ -176,7 +250,7 @@ bool RawChannelPosix::WriteMessage(MessageInTransit* message) {
 
   write_message_queue_.push_front(message);
   DCHECK_EQ(write_message_offset_, 0u);
-  bool result = WriteFrontMessageNoLock();
+  bool result = write_ring_.get() ? WriteToRingNoLock() : WriteFrontMessageNoLock();
   DCHECK(result || write_message_queue_.empty());
 
   if (!result) {
@@ -187,9 +261,10 @@ bool RawChannelPosix::WriteMessage(MessageInTransit* message) {
         base::Bind(&RawChannelPosix::CallOnFatalError,
                    weak_ptr_factory_.GetWeakPtr(),
                    Delegate::FATAL_ERROR_FAILED_WRITE));
-  } else if (!write_message_queue_.empty()) {
+  } else if (!write_message_queue_.empty() && !write_ring_.get()) {
     // Set up to wait for the FD to become writable. If we're not on the I/O
-    // thread, we have to post a task to do this.
+    // thread, we have to post a task to do this. (With shared memory, we're
+    // waiting for a wakeup instead.)
     if (base::MessageLoop::current() == message_loop_for_io()) {
       WaitToWrite();
     } else {
@@ -207,6 +282,18 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
   DCHECK_EQ(fd, fd_.get().fd);
   DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io());
 
+  if (read_ring_.get() && !ReadWakeups())
+    return;
+  ReadMessages();
+}
+
+void RawChannelPosix::ReadMessages() {
+  DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io());
+
+  // Reading may have failed since this was posted by |WaitForRingData()|.
+  if (!read_watcher_.get())
+    return;
+
   bool did_dispatch_message = false;
   // Tracks the offset of the first undispatched message in |read_buffer_|.
   // Currently, we copy data to ensure that this is zero at the beginning.
@@ -228,10 +315,17 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
       read_buffer_.resize(new_size, 0);
     }
 
-    ssize_t bytes_read = HANDLE_EINTR(
-        read(fd_.get().fd,
-             &read_buffer_[read_buffer_start + read_buffer_num_valid_bytes_],
-             kReadSize));
+    ssize_t bytes_read;
+    if (read_ring_.get()) {
+      bytes_read = static_cast<ssize_t>(read_ring_->Read(
+          &read_buffer_[read_buffer_start + read_buffer_num_valid_bytes_],
+          kReadSize));
+    } else {
+      bytes_read = HANDLE_EINTR(
+          read(fd_.get().fd,
+               &read_buffer_[read_buffer_start + read_buffer_num_valid_bytes_],
+               kReadSize));
+    }
     if (bytes_read < 0) {
       if (errno != EAGAIN && errno != EWOULDBLOCK) {
         PLOG(ERROR) << "read";
@@ -305,6 +399,68 @@ void RawChannelPosix::OnFileCanReadWithoutBlocking(int fd) {
     }
     read_buffer_start = 0;
   }
+
+  if (read_ring_.get())
+    WaitForRingData();
+}
+
+bool RawChannelPosix::ReadWakeups() {
+  DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io());
+
+  // All wakeups are the same, so only whether there was one matters.
+  char wakeups[64];
+  for (;;) {
+    ssize_t bytes_read = HANDLE_EINTR(
+        read(fd_.get().fd, wakeups, sizeof(wakeups)));
+    if (bytes_read < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        PLOG(ERROR) << "read";
+        read_watcher_.reset();
+        CallOnFatalError(Delegate::FATAL_ERROR_FAILED_READ);
+        return false;
+      }
+      break;
+    }
+    if (static_cast<size_t>(bytes_read) < sizeof(wakeups))
+      break;
+  }
+
+  // The other end may have made space for our pending messages.
+  bool did_fail = false;
+  {
+    base::AutoLock locker(write_lock_);
+    if (!write_stopped_ && !write_message_queue_.empty())
+      did_fail = !WriteToRingNoLock();
+  }
+  if (did_fail) {
+    CallOnFatalError(Delegate::FATAL_ERROR_FAILED_WRITE);
+    // |OnFatalError()| may have called |Shutdown()|.
+    if (!read_watcher_.get())
+      return false;
+  }
+  return true;
+}
+
+void RawChannelPosix::WaitForRingData() {
+  DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io());
+
+  if (read_ring_->ConsumeWriterWaiting() && !WriteWakeup()) {
+    // Writing will fail too (if there's anything left to write), which reports
+    // the error.
+    LOG(WARNING) << "Failed to wake up the writer";
+  }
+
+  if (read_ring_->SetReaderWaiting())
+    return;
+
+  // There's more to read, either because we stopped to let the message loop
+  // run or because the writer kept writing. There's no need for a wakeup while
+  // we keep reading.
+  base::AutoLock locker(write_lock_);
+  message_loop_for_io()->PostTask(
+      FROM_HERE,
+      base::Bind(&RawChannelPosix::ReadMessages,
+                 weak_ptr_factory_.GetWeakPtr()));
 }
 
 void RawChannelPosix::OnFileCanWriteWithoutBlocking(int fd) {
@@ -392,6 +548,57 @@ bool RawChannelPosix::WriteFrontMessageNoLock() {
   return true;
 }
 
+bool RawChannelPosix::WriteToRingNoLock() {
+  write_lock_.AssertAcquired();
+
+  DCHECK(!write_stopped_);
+  DCHECK(!write_message_queue_.empty());
+
+  bool did_write = false;
+  while (!write_message_queue_.empty()) {
+    MessageInTransit* message = write_message_queue_.front();
+    DCHECK_LT(write_message_offset_, message->main_buffer_size());
+    size_t bytes_to_write = message->main_buffer_size() - write_message_offset_;
+    size_t bytes_written = write_ring_->Write(
+        static_cast<const char*>(message->main_buffer()) +
+            write_message_offset_,
+        bytes_to_write);
+    if (bytes_written > 0)
+      did_write = true;
+
+    if (bytes_written == bytes_to_write) {
+      write_message_queue_.pop_front();
+      write_message_offset_ = 0;
+      message->Destroy();
+      continue;
+    }
+
+    // The ring is full. Wait for the reader to make space, unless it already
+    // has.
+    write_message_offset_ += bytes_written;
+    if (write_ring_->SetWriterWaiting())
+      break;
+  }
+
+  if (did_write && write_ring_->ConsumeReaderWaiting() && !WriteWakeup()) {
+    CancelPendingWritesNoLock();
+    return false;
+  }
+  return true;
+}
+
+bool RawChannelPosix::WriteWakeup() {
+  ssize_t bytes_written = HANDLE_EINTR(write(fd_.get().fd, &kWakeup, 1));
+  if (bytes_written < 0) {
+    // If the socket is full, the other end has wakeups to read anyway.
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return true;
+    PLOG(ERROR) << "write of wakeup";
+    return false;
+  }
+  return true;
+}
+
 void RawChannelPosix::CancelPendingWritesNoLock() {
   write_lock_.AssertAcquired();
   DCHECK(!write_stopped_);
@@ -414,7 +621,29 @@ void RawChannelPosix::CancelPendingWritesNoLock() {
 RawChannel* RawChannel::Create(embedder::ScopedPlatformHandle handle,
                                Delegate* delegate,
                                base::MessageLoopForIO* message_loop_for_io) {
-  return new RawChannelPosix(handle.Pass(), delegate, message_loop_for_io);
+  return new RawChannelPosix(handle.Pass(), scoped_ptr<base::SharedMemory>(),
+                             false, delegate, message_loop_for_io);
+}
+
+// Static factory method declared in raw_channel.h.
+// static
+RawChannel* RawChannel::CreateWithSharedMemory(
+    embedder::ScopedPlatformHandle handle,
+    embedder::ScopedPlatformHandle shared_memory,
+    bool is_first_end,
+    Delegate* delegate,
+    base::MessageLoopForIO* message_loop_for_io) {
+  scoped_ptr<base::SharedMemory> memory(new base::SharedMemory(
+      base::FileDescriptor(shared_memory.release().fd, true), false));
+  if (!memory->Map(GetSharedMemorySize()))
+    return NULL;
+  return new RawChannelPosix(handle.Pass(), memory.Pass(), is_first_end,
+                             delegate, message_loop_for_io);
+}
+
+// static
+size_t RawChannel::GetSharedMemorySize() {
+  return 2 * SharedRingBuffer::GetRequiredMemorySize(kSharedMemoryRingCapacity);
 }
 
 }  // namespace system
@@ -21,6 +21,7 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
+#include "base/memory/shared_memory.h"
 #include "base/message_loop/message_loop.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/rand_util.h"
@@ -440,6 +441,132 @@ TEST_F(RawChannelPosixTest, WriteMessageAndOnReadMessage) {
                                    base::Unretained(writer_rc.get())));
 }
 
+// RawChannelPosixTest.SharedMemory... ----------------------------------------
+
+// Sets |shared_memory_handles| to two handles to a new shared memory region for
+// |RawChannel::CreateWithSharedMemory()|.
+void CreateRawChannelSharedMemory(
+    embedder::ScopedPlatformHandle* shared_memory_handles) {
+  base::SharedMemory shared_memory;
+  CHECK(shared_memory.CreateAnonymous(RawChannel::GetSharedMemorySize()));
+  for (size_t i = 0; i < 2; i++) {
+    int fd = dup(shared_memory.handle().fd);
+    PCHECK(fd >= 0);
+    shared_memory_handles[i].reset(embedder::PlatformHandle(fd));
+  }
+}
+
+// Tests writing and reading through shared memory, including messages that
+// are larger than the ring buffers.
+TEST_F(RawChannelPosixTest, SharedMemoryWriteAndRead) {
+  embedder::ScopedPlatformHandle shared_memory_handles[2];
+  CreateRawChannelSharedMemory(shared_memory_handles);
+
+  WriteOnlyRawChannelDelegate writer_delegate;
+  scoped_ptr<RawChannel> writer_rc(
+      RawChannel::CreateWithSharedMemory(handles[0].Pass(),
+                                         shared_memory_handles[0].Pass(),
+                                         true,
+                                         &writer_delegate,
+                                         io_thread_message_loop()));
+  ASSERT_TRUE(writer_rc.get());
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&InitOnIOThread, writer_rc.get()));
+
+  ReadCheckerRawChannelDelegate reader_delegate;
+  scoped_ptr<RawChannel> reader_rc(
+      RawChannel::CreateWithSharedMemory(handles[1].Pass(),
+                                         shared_memory_handles[1].Pass(),
+                                         false,
+                                         &reader_delegate,
+                                         io_thread_message_loop()));
+  ASSERT_TRUE(reader_rc.get());
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&InitOnIOThread, reader_rc.get()));
+
+  // Write and read, for a variety of sizes.
+  for (uint32_t size = 1; size < 5 * 1000 * 1000; size += size / 2 + 1) {
+    reader_delegate.SetExpectedSizes(std::vector<uint32_t>(1, size));
+    EXPECT_TRUE(writer_rc->WriteMessage(MakeTestMessage(size)));
+    reader_delegate.Wait();
+  }
+
+  // Write/queue and read afterwards, for a variety of sizes.
+  std::vector<uint32_t> expected_sizes;
+  for (uint32_t size = 1; size < 5 * 1000 * 1000; size += size / 2 + 1)
+    expected_sizes.push_back(size);
+  reader_delegate.SetExpectedSizes(expected_sizes);
+  for (uint32_t size = 1; size < 5 * 1000 * 1000; size += size / 2 + 1)
+    EXPECT_TRUE(writer_rc->WriteMessage(MakeTestMessage(size)));
+  reader_delegate.Wait();
+
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&RawChannel::Shutdown,
+                                   base::Unretained(reader_rc.get())));
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&RawChannel::Shutdown,
+                                   base::Unretained(writer_rc.get())));
+}
+
+TEST_F(RawChannelPosixTest, SharedMemoryWriteMessageAndOnReadMessage) {
+  static const size_t kNumWriterThreads = 10;
+  static const size_t kNumWriteMessagesPerThread = 4000;
+
+  embedder::ScopedPlatformHandle shared_memory_handles[2];
+  CreateRawChannelSharedMemory(shared_memory_handles);
+
+  WriteOnlyRawChannelDelegate writer_delegate;
+  scoped_ptr<RawChannel> writer_rc(
+      RawChannel::CreateWithSharedMemory(handles[0].Pass(),
+                                         shared_memory_handles[0].Pass(),
+                                         true,
+                                         &writer_delegate,
+                                         io_thread_message_loop()));
+  ASSERT_TRUE(writer_rc.get());
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&InitOnIOThread, writer_rc.get()));
+
+  ReadCountdownRawChannelDelegate reader_delegate(
+      kNumWriterThreads * kNumWriteMessagesPerThread);
+  scoped_ptr<RawChannel> reader_rc(
+      RawChannel::CreateWithSharedMemory(handles[1].Pass(),
+                                         shared_memory_handles[1].Pass(),
+                                         false,
+                                         &reader_delegate,
+                                         io_thread_message_loop()));
+  ASSERT_TRUE(reader_rc.get());
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&InitOnIOThread, reader_rc.get()));
+
+  {
+    ScopedVector<RawChannelWriterThread> writer_threads;
+    for (size_t i = 0; i < kNumWriterThreads; i++) {
+      writer_threads.push_back(new RawChannelWriterThread(
+          writer_rc.get(), kNumWriteMessagesPerThread));
+    }
+    for (size_t i = 0; i < writer_threads.size(); i++)
+      writer_threads[i]->Start();
+  }  // Joins all the writer threads.
+
+  // Wait for reading to finish.
+  reader_delegate.Wait();
+
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&RawChannel::Shutdown,
+                                   base::Unretained(reader_rc.get())));
+  test::PostTaskAndWait(io_thread_task_runner(),
+                        FROM_HERE,
+                        base::Bind(&RawChannel::Shutdown,
+                                   base::Unretained(writer_rc.get())));
+}
+
 // RawChannelPosixTest.OnFatalError --------------------------------------------
 
 class FatalErrorRecordingRawChannelDelegate
@@ -23,5 +23,23 @@ RawChannel* RawChannel::Create(embedder::ScopedPlatformHandle handle,
   return NULL;
 }
 
+// Static factory method declared in raw_channel.h.
+// static
+RawChannel* RawChannel::CreateWithSharedMemory(
+    embedder::ScopedPlatformHandle handle,
+    embedder::ScopedPlatformHandle shared_memory,
+    bool is_first_end,
+    Delegate* delegate,
+    base::MessageLoopForIO* message_loop_for_io) {
+  NOTIMPLEMENTED();
+  return NULL;
+}
+
+// static
+size_t RawChannel::GetSharedMemorySize() {
+  NOTIMPLEMENTED();
+  return 0;
+}
+
 }  // namespace system
 }  // namespace mojo
@@ -0,0 +1,161 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MOJO_SYSTEM_SHARED_MEMORY_DATA_PIPE_H_
+#define MOJO_SYSTEM_SHARED_MEMORY_DATA_PIPE_H_
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "mojo/system/data_pipe.h"
+#include "mojo/system/embedder/scoped_platform_handle.h"
+#include "mojo/system/system_impl_export.h"
+
+namespace base {
+class SharedMemory;
+}
+
+namespace mojo {
+namespace system {
+
+// |SharedMemoryDataPipe| is a subclass that implements |DataPipe| for data
+// pipes whose producer and consumer are in different processes: Each process
+// has a |SharedMemoryDataPipe| for its side. The data goes through a circular
+// buffer in shared memory mapped by both processes, so two-phase writes and
+// reads in either process work directly on the same pages, and no data is
+// copied in between. Each side wakes up the other through a socket-like
+// platform handle when it changes what the other side may be waiting for: when
+// the buffer stops being empty, stops being full, or when it closes. The other
+// side watches the handle on its I/O thread. This class is thread-safe (with
+// protection provided by |DataPipe|'s |lock_|).
+//
+// The producer and the consumer each keep their own position in the buffer,
+// and only the number of bytes in it is shared. So "may discard" data pipes,
+// whose producer discards data ahead of the consumer, aren't supported.
+class MOJO_SYSTEM_IMPL_EXPORT SharedMemoryDataPipe
+    : public DataPipe,
+      public base::MessageLoopForIO::Watcher {
+ public:
+  // Returns the size of the shared memory for a data pipe with
+  // |validated_options|.
+  static size_t GetSharedMemorySize(
+      const MojoCreateDataPipeOptions& validated_options);
+
+  // Creates the side of a data pipe with the local producer if |is_producer|
+  // is true, and else the side with the local consumer. |validated_options|
+  // should be the output of |DataPipe::ValidateOptions()|, without the "may
+  // discard" flag, and the same for both sides. |handle| is the handle used for
+  // wakeups, whose other end belongs to the other side. |shared_memory| is a
+  // handle to a zero-filled shared memory region of |GetSharedMemorySize()|
+  // bytes, which the other side also maps. Does not take ownership of
+  // |message_loop_for_io|, which must outlive the data pipe. Returns null if
+  // the options aren't supported or |shared_memory| can't be mapped.
+  static scoped_refptr<SharedMemoryDataPipe> Create(
+      bool is_producer,
+      const MojoCreateDataPipeOptions& validated_options,
+      embedder::ScopedPlatformHandle handle,
+      embedder::ScopedPlatformHandle shared_memory,
+      base::MessageLoopForIO* message_loop_for_io);
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedMemoryDataPipe>;
+
+  // Layout of the start of the shared memory, followed by the buffer.
+  struct SharedState {
+    // Number of bytes in the buffer, changed by both sides.
+    volatile base::subtle::Atomic32 num_bytes;
+    // Each set by one side when it closes.
+    volatile base::subtle::Atomic32 producer_closed;
+    volatile base::subtle::Atomic32 consumer_closed;
+  };
+
+  SharedMemoryDataPipe(bool is_producer,
+                       const MojoCreateDataPipeOptions& validated_options,
+                       embedder::ScopedPlatformHandle handle,
+                       scoped_ptr<base::SharedMemory> shared_memory,
+                       base::MessageLoopForIO* message_loop_for_io);
+  virtual ~SharedMemoryDataPipe();
+
+  // |DataPipe| implementation:
+  virtual void ProducerCloseImplNoLock() OVERRIDE;
+  virtual MojoResult ProducerWriteDataImplNoLock(const void* elements,
+                                                 uint32_t* num_bytes,
+                                                 bool all_or_none) OVERRIDE;
+  virtual MojoResult ProducerBeginWriteDataImplNoLock(
+      void** buffer,
+      uint32_t* buffer_num_bytes,
+      bool all_or_none) OVERRIDE;
+  virtual MojoResult ProducerEndWriteDataImplNoLock(
+      uint32_t num_bytes_written) OVERRIDE;
+  virtual MojoWaitFlags ProducerSatisfiedFlagsNoLock() OVERRIDE;
+  virtual MojoWaitFlags ProducerSatisfiableFlagsNoLock() OVERRIDE;
+  virtual void ConsumerCloseImplNoLock() OVERRIDE;
+  virtual MojoResult ConsumerReadDataImplNoLock(void* elements,
+                                                uint32_t* num_bytes,
+                                                bool all_or_none) OVERRIDE;
+  virtual MojoResult ConsumerDiscardDataImplNoLock(uint32_t* num_bytes,
+                                                   bool all_or_none) OVERRIDE;
+  virtual MojoResult ConsumerQueryDataImplNoLock(uint32_t* num_bytes) OVERRIDE;
+  virtual MojoResult ConsumerBeginReadDataImplNoLock(const void** buffer,
+                                                     uint32_t* buffer_num_bytes,
+                                                     bool all_or_none) OVERRIDE;
+  virtual MojoResult ConsumerEndReadDataImplNoLock(
+      uint32_t num_bytes_read) OVERRIDE;
+  virtual MojoWaitFlags ConsumerSatisfiedFlagsNoLock() OVERRIDE;
+  virtual MojoWaitFlags ConsumerSatisfiableFlagsNoLock() OVERRIDE;
+
+  // |base::MessageLoopForIO::Watcher| implementation:
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE;
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE;
+
+  // Start and stop watching |handle_| for wakeups. Must be called on the I/O
+  // thread.
+  void StartWatching();
+  void StopWatching();
+
+  // Gets the number of bytes in the buffer. (This is clamped to the capacity,
+  // since the other process can't be trusted with it.)
+  size_t GetNumBytesNoLock() const;
+
+  // Marks |num_bytes| as written (by the producer) or consumed (by the
+  // consumer), waking up the other side if the buffer was empty or full,
+  // respectively.
+  void MarkDataAsWrittenNoLock(size_t num_bytes);
+  void MarkDataAsConsumedNoLock(size_t num_bytes);
+
+  // Get the maximum (single) write/read size right now (in number of bytes);
+  // result fits in a |uint32_t|.
+  size_t GetMaxNumBytesToWriteNoLock();
+  size_t GetMaxNumBytesToReadNoLock();
+
+  // Marks the local side as closed in the shared state, wakes up the other
+  // side and stops watching for wakeups.
+  void CloseNoLock(volatile base::subtle::Atomic32* closed);
+
+  // Writes a wakeup to |handle_|.
+  void WakeUpRemote();
+
+  const bool is_producer_;
+  const embedder::ScopedPlatformHandle handle_;
+  const scoped_ptr<base::SharedMemory> shared_memory_;
+  SharedState* const shared_state_;
+  char* const buffer_;
+  base::MessageLoopForIO* const message_loop_for_io_;
+
+  // Only used on the I/O thread.
+  scoped_ptr<base::MessageLoopForIO::FileDescriptorWatcher> watcher_;
+
+  // The members below are protected by |DataPipe|'s |lock_|:
+  // Index in |buffer_| at which the local side next writes or reads.
+  size_t index_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryDataPipe);
+};
+
+}  // namespace system
+}  // namespace mojo
+
+#endif  // MOJO_SYSTEM_SHARED_MEMORY_DATA_PIPE_H_
@@ -0,0 +1,437 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/system/shared_memory_data_pipe.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/shared_memory.h"
+#include "base/posix/eintr_wrapper.h"
+#include "mojo/system/constants.h"
+
+namespace mojo {
+namespace system {
+
+namespace {
+
+// The buffer starts on a separate cache line from the shared state (which also
+// satisfies |kDataPipeBufferAlignmentBytes|).
+const size_t kSharedStateSize = 64;
+
+const char kWakeup = 'W';
+
+}  // namespace
+
+// static
+size_t SharedMemoryDataPipe::GetSharedMemorySize(
+    const MojoCreateDataPipeOptions& validated_options) {
+  return kSharedStateSize + validated_options.capacity_num_bytes;
+}
+
+// static
+scoped_refptr<SharedMemoryDataPipe> SharedMemoryDataPipe::Create(
+    bool is_producer,
+    const MojoCreateDataPipeOptions& validated_options,
+    embedder::ScopedPlatformHandle handle,
+    embedder::ScopedPlatformHandle shared_memory,
+    base::MessageLoopForIO* message_loop_for_io) {
+  if ((validated_options.flags &
+          MOJO_CREATE_DATA_PIPE_OPTIONS_FLAG_MAY_DISCARD))
+    return scoped_refptr<SharedMemoryDataPipe>();
+
+  scoped_ptr<base::SharedMemory> memory(new base::SharedMemory(
+      base::FileDescriptor(shared_memory.release().fd, true), false));
+  if (!memory->Map(GetSharedMemorySize(validated_options)))
+    return scoped_refptr<SharedMemoryDataPipe>();
+
+  scoped_refptr<SharedMemoryDataPipe> data_pipe(
+      new SharedMemoryDataPipe(is_producer, validated_options, handle.Pass(),
+                               memory.Pass(), message_loop_for_io));
+  message_loop_for_io->PostTask(
+      FROM_HERE,
+      base::Bind(&SharedMemoryDataPipe::StartWatching, data_pipe));
+  return data_pipe;
+}
+
+SharedMemoryDataPipe::SharedMemoryDataPipe(
+    bool is_producer,
+    const MojoCreateDataPipeOptions& validated_options,
+    embedder::ScopedPlatformHandle handle,
+    scoped_ptr<base::SharedMemory> shared_memory,
+    base::MessageLoopForIO* message_loop_for_io)
+    : DataPipe(is_producer, !is_producer, validated_options),
+      is_producer_(is_producer),
+      handle_(handle.Pass()),
+      shared_memory_(shared_memory.Pass()),
+      shared_state_(static_cast<SharedState*>(shared_memory_->memory())),
+      buffer_(static_cast<char*>(shared_memory_->memory()) + kSharedStateSize),
+      message_loop_for_io_(message_loop_for_io),
+      index_(0) {
+  COMPILE_ASSERT(sizeof(SharedState) <= kSharedStateSize,
+                 shared_state_too_large);
+  COMPILE_ASSERT(kSharedStateSize % kDataPipeBufferAlignmentBytes == 0,
+                 buffer_misaligned);
+  DCHECK(handle_.is_valid());
+  DCHECK(!may_discard());
+}
+
+SharedMemoryDataPipe::~SharedMemoryDataPipe() {
+  DCHECK(!watcher_.get());
+}
+
+void SharedMemoryDataPipe::ProducerCloseImplNoLock() {
+  DCHECK(is_producer_);
+  CloseNoLock(&shared_state_->producer_closed);
+}
+
+MojoResult SharedMemoryDataPipe::ProducerWriteDataImplNoLock(
+    const void* elements,
+    uint32_t* num_bytes,
+    bool all_or_none) {
+  DCHECK_EQ(*num_bytes % element_num_bytes(), 0u);
+  DCHECK_GT(*num_bytes, 0u);
+  DCHECK(consumer_open_no_lock());
+
+  size_t num_bytes_available = capacity_num_bytes() - GetNumBytesNoLock();
+  if (all_or_none && *num_bytes > num_bytes_available) {
+    // Don't return "should wait" since you can't wait for a specified amount
+    // of data.
+    return MOJO_RESULT_OUT_OF_RANGE;
+  }
+
+  size_t num_bytes_to_write =
+      std::min(static_cast<size_t>(*num_bytes), num_bytes_available);
+  if (num_bytes_to_write == 0)
+    return MOJO_RESULT_SHOULD_WAIT;
+
+  // The amount we can write in our first |memcpy()|.
+  size_t num_bytes_to_write_first =
+      std::min(num_bytes_to_write, capacity_num_bytes() - index_);
+  memcpy(buffer_ + index_, elements, num_bytes_to_write_first);
+
+  if (num_bytes_to_write_first < num_bytes_to_write) {
+    // The "second write index" is zero.
+    memcpy(buffer_,
+           static_cast<const char*>(elements) + num_bytes_to_write_first,
+           num_bytes_to_write - num_bytes_to_write_first);
+  }
+
+  MarkDataAsWrittenNoLock(num_bytes_to_write);
+  *num_bytes = static_cast<uint32_t>(num_bytes_to_write);
+  return MOJO_RESULT_OK;
+}
+
+MojoResult SharedMemoryDataPipe::ProducerBeginWriteDataImplNoLock(
+    void** buffer,
+    uint32_t* buffer_num_bytes,
+    bool all_or_none) {
+  DCHECK(consumer_open_no_lock());
+
+  size_t max_num_bytes_to_write = GetMaxNumBytesToWriteNoLock();
+  if (all_or_none && *buffer_num_bytes > max_num_bytes_to_write) {
+    // Don't return "should wait" since you can't wait for a specified amount
+    // of data.
+    return MOJO_RESULT_OUT_OF_RANGE;
+  }
+
+  // Don't go into a two-phase write if there's no room.
+  if (max_num_bytes_to_write == 0)
+    return MOJO_RESULT_SHOULD_WAIT;
+
+  *buffer = buffer_ + index_;
+  *buffer_num_bytes = static_cast<uint32_t>(max_num_bytes_to_write);
+  set_producer_two_phase_max_num_bytes_written_no_lock(
+      static_cast<uint32_t>(max_num_bytes_to_write));
+  return MOJO_RESULT_OK;
+}
+
+MojoResult SharedMemoryDataPipe::ProducerEndWriteDataImplNoLock(
+    uint32_t num_bytes_written) {
+  DCHECK_LE(num_bytes_written,
+            producer_two_phase_max_num_bytes_written_no_lock());
+  if (num_bytes_written > 0)
+    MarkDataAsWrittenNoLock(num_bytes_written);
+  set_producer_two_phase_max_num_bytes_written_no_lock(0);
+  return MOJO_RESULT_OK;
+}
+
+MojoWaitFlags SharedMemoryDataPipe::ProducerSatisfiedFlagsNoLock() {
+  MojoWaitFlags rv = MOJO_WAIT_FLAG_NONE;
+  if (is_producer_ && consumer_open_no_lock() &&
+      GetNumBytesNoLock() < capacity_num_bytes() &&
+      !producer_in_two_phase_write_no_lock())
+    rv |= MOJO_WAIT_FLAG_WRITABLE;
+  return rv;
+}
+
+MojoWaitFlags SharedMemoryDataPipe::ProducerSatisfiableFlagsNoLock() {
+  MojoWaitFlags rv = MOJO_WAIT_FLAG_NONE;
+  if (is_producer_ && consumer_open_no_lock())
+    rv |= MOJO_WAIT_FLAG_WRITABLE;
+  return rv;
+}
+
+void SharedMemoryDataPipe::ConsumerCloseImplNoLock() {
+  DCHECK(!is_producer_);
+  CloseNoLock(&shared_state_->consumer_closed);
+}
+
+MojoResult SharedMemoryDataPipe::ConsumerReadDataImplNoLock(
+    void* elements,
+    uint32_t* num_bytes,
+    bool all_or_none) {
+  DCHECK_EQ(*num_bytes % element_num_bytes(), 0u);
+  DCHECK_GT(*num_bytes, 0u);
+
+  size_t current_num_bytes = GetNumBytesNoLock();
+  if (all_or_none && *num_bytes > current_num_bytes) {
+    // Don't return "should wait" since you can't wait for a specified amount of
+    // data.
+    return producer_open_no_lock() ? MOJO_RESULT_OUT_OF_RANGE :
+                                     MOJO_RESULT_FAILED_PRECONDITION;
+  }
+
+  size_t num_bytes_to_read =
+      std::min(static_cast<size_t>(*num_bytes), current_num_bytes);
+  if (num_bytes_to_read == 0) {
+    return producer_open_no_lock() ? MOJO_RESULT_SHOULD_WAIT :
+                                     MOJO_RESULT_FAILED_PRECONDITION;
+  }
+
+  // The amount we can read in our first |memcpy()|.
+  size_t num_bytes_to_read_first =
+      std::min(num_bytes_to_read, capacity_num_bytes() - index_);
+  memcpy(elements, buffer_ + index_, num_bytes_to_read_first);
+
+  if (num_bytes_to_read_first < num_bytes_to_read) {
+    // The "second read index" is zero.
+    memcpy(static_cast<char*>(elements) + num_bytes_to_read_first,
+           buffer_,
+           num_bytes_to_read - num_bytes_to_read_first);
+  }
+
+  MarkDataAsConsumedNoLock(num_bytes_to_read);
+  *num_bytes = static_cast<uint32_t>(num_bytes_to_read);
+  return MOJO_RESULT_OK;
+}
+
+MojoResult SharedMemoryDataPipe::ConsumerDiscardDataImplNoLock(
+    uint32_t* num_bytes,
+    bool all_or_none) {
+  DCHECK_EQ(*num_bytes % element_num_bytes(), 0u);
+  DCHECK_GT(*num_bytes, 0u);
+
+  size_t current_num_bytes = GetNumBytesNoLock();
+  if (all_or_none && *num_bytes > current_num_bytes) {
+    // Don't return "should wait" since you can't wait for a specified amount of
+    // data.
+    return producer_open_no_lock() ? MOJO_RESULT_OUT_OF_RANGE :
+                                     MOJO_RESULT_FAILED_PRECONDITION;
+  }
+
+  // Be consistent with other operations; error if no data available.
+  if (current_num_bytes == 0) {
+    return producer_open_no_lock() ? MOJO_RESULT_SHOULD_WAIT :
+                                     MOJO_RESULT_FAILED_PRECONDITION;
+  }
+
+  size_t num_bytes_to_discard =
+      std::min(static_cast<size_t>(*num_bytes), current_num_bytes);
+  MarkDataAsConsumedNoLock(num_bytes_to_discard);
+  *num_bytes = static_cast<uint32_t>(num_bytes_to_discard);
+  return MOJO_RESULT_OK;
+}
+
+MojoResult SharedMemoryDataPipe::ConsumerQueryDataImplNoLock(
+    uint32_t* num_bytes) {
+  // Note: This cast is safe, since the capacity fits into a |uint32_t|.
+  *num_bytes = static_cast<uint32_t>(GetNumBytesNoLock());
+  return MOJO_RESULT_OK;
+}
+
+MojoResult SharedMemoryDataPipe::ConsumerBeginReadDataImplNoLock(
+    const void** buffer,
+    uint32_t* buffer_num_bytes,
+    bool all_or_none) {
+  size_t max_num_bytes_to_read = GetMaxNumBytesToReadNoLock();
+  if (all_or_none && *buffer_num_bytes > max_num_bytes_to_read) {
+    // Don't return "should wait" since you can't wait for a specified amount of
+    // data.
+    return producer_open_no_lock() ? MOJO_RESULT_OUT_OF_RANGE :
+                                     MOJO_RESULT_FAILED_PRECONDITION;
+  }
+
+  // Don't go into a two-phase read if there's no data.
+  if (max_num_bytes_to_read == 0) {
+    return producer_open_no_lock() ? MOJO_RESULT_SHOULD_WAIT :
+                                     MOJO_RESULT_FAILED_PRECONDITION;
+  }
+
+  *buffer = buffer_ + index_;
+  *buffer_num_bytes = static_cast<uint32_t>(max_num_bytes_to_read);
+  set_consumer_two_phase_max_num_bytes_read_no_lock(
+      static_cast<uint32_t>(max_num_bytes_to_read));
+  return MOJO_RESULT_OK;
+}
+
+MojoResult SharedMemoryDataPipe::ConsumerEndReadDataImplNoLock(
+    uint32_t num_bytes_read) {
+  DCHECK_LE(num_bytes_read, consumer_two_phase_max_num_bytes_read_no_lock());
+  DCHECK_LE(index_ + num_bytes_read, capacity_num_bytes());
+  if (num_bytes_read > 0)
+    MarkDataAsConsumedNoLock(num_bytes_read);
+  set_consumer_two_phase_max_num_bytes_read_no_lock(0);
+  return MOJO_RESULT_OK;
+}
+
+MojoWaitFlags SharedMemoryDataPipe::ConsumerSatisfiedFlagsNoLock() {
+  MojoWaitFlags rv = MOJO_WAIT_FLAG_NONE;
+  if (!is_producer_ && GetNumBytesNoLock() > 0 &&
+      !consumer_in_two_phase_read_no_lock())
+    rv |= MOJO_WAIT_FLAG_READABLE;
+  return rv;
+}
+
+MojoWaitFlags SharedMemoryDataPipe::ConsumerSatisfiableFlagsNoLock() {
+  MojoWaitFlags rv = MOJO_WAIT_FLAG_NONE;
+  if (!is_producer_ && (GetNumBytesNoLock() > 0 || producer_open_no_lock()))
+    rv |= MOJO_WAIT_FLAG_READABLE;
+  return rv;
+}
+
+void SharedMemoryDataPipe::OnFileCanReadWithoutBlocking(int fd) {
+  DCHECK_EQ(fd, handle_.get().fd);
+  DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io_);
+
+  // All wakeups are the same, so only whether there was one matters. The
+  // other side closing (or dying) closes the handle.
+  bool remote_closed = false;
+  char wakeups[64];
+  for (;;) {
+    ssize_t bytes_read = HANDLE_EINTR(read(fd, wakeups, sizeof(wakeups)));
+    if (bytes_read < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        PLOG(ERROR) << "read";
+        remote_closed = true;
+      }
+      break;
+    }
+    if (bytes_read == 0) {
+      remote_closed = true;
+      break;
+    }
+    if (static_cast<size_t>(bytes_read) < sizeof(wakeups))
+      break;
+  }
+
+  volatile base::subtle::Atomic32* remote_closed_flag =
+      is_producer_ ? &shared_state_->consumer_closed :
+                     &shared_state_->producer_closed;
+  if (base::subtle::Acquire_Load(remote_closed_flag))
+    remote_closed = true;
+
+  // There won't be any further wakeups.
+  if (remote_closed)
+    StopWatching();
+
+  OnRemoteStateChange(remote_closed);
+}
+
+void SharedMemoryDataPipe::OnFileCanWriteWithoutBlocking(int fd) {
+  NOTREACHED();
+}
+
+void SharedMemoryDataPipe::StartWatching() {
+  DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io_);
+  DCHECK(!watcher_.get());
+
+  watcher_.reset(new base::MessageLoopForIO::FileDescriptorWatcher());
+  if (!message_loop_for_io_->WatchFileDescriptor(handle_.get().fd, true,
+          base::MessageLoopForIO::WATCH_READ, watcher_.get(), this)) {
+    LOG(ERROR) << "Failed to watch data pipe handle";
+    watcher_.reset();
+    OnRemoteStateChange(true);
+    return;
+  }
+
+  // Catch up on anything the other side did before we started watching.
+  OnFileCanReadWithoutBlocking(handle_.get().fd);
+}
+
+void SharedMemoryDataPipe::StopWatching() {
+  DCHECK_EQ(base::MessageLoop::current(), message_loop_for_io_);
+  watcher_.reset();  // This will stop watching (if necessary).
+}
+
+size_t SharedMemoryDataPipe::GetNumBytesNoLock() const {
+  base::subtle::Atomic32 num_bytes =
+      base::subtle::Acquire_Load(&shared_state_->num_bytes);
+  if (num_bytes < 0)
+    return 0;
+  return std::min(static_cast<size_t>(num_bytes), capacity_num_bytes());
+}
+
+void SharedMemoryDataPipe::MarkDataAsWrittenNoLock(size_t num_bytes) {
+  DCHECK(is_producer_);
+  DCHECK_GT(num_bytes, 0u);
+  index_ = (index_ + num_bytes) % capacity_num_bytes();
+  // This has a full barrier, so the data is visible to the consumer first.
+  base::subtle::Atomic32 new_num_bytes = base::subtle::Barrier_AtomicIncrement(
+      &shared_state_->num_bytes,
+      static_cast<base::subtle::Atomic32>(num_bytes));
+  // The consumer only waits for data when there's none.
+  if (new_num_bytes == static_cast<base::subtle::Atomic32>(num_bytes))
+    WakeUpRemote();
+}
+
+void SharedMemoryDataPipe::MarkDataAsConsumedNoLock(size_t num_bytes) {
+  DCHECK(!is_producer_);
+  DCHECK_GT(num_bytes, 0u);
+  index_ = (index_ + num_bytes) % capacity_num_bytes();
+  // This has a full barrier, so we're done with the data before the producer
+  // can overwrite it.
+  base::subtle::Atomic32 new_num_bytes = base::subtle::Barrier_AtomicIncrement(
+      &shared_state_->num_bytes,
+      -static_cast<base::subtle::Atomic32>(num_bytes));
+  // The producer only waits for room when the buffer is full.
+  if (static_cast<size_t>(new_num_bytes) + num_bytes == capacity_num_bytes())
+    WakeUpRemote();
+}
+
+size_t SharedMemoryDataPipe::GetMaxNumBytesToWriteNoLock() {
+  return std::min(capacity_num_bytes() - GetNumBytesNoLock(),
+                  capacity_num_bytes() - index_);
+}
+
+size_t SharedMemoryDataPipe::GetMaxNumBytesToReadNoLock() {
+  return std::min(GetNumBytesNoLock(), capacity_num_bytes() - index_);
+}
+
+void SharedMemoryDataPipe::CloseNoLock(
+    volatile base::subtle::Atomic32* closed) {
+  base::subtle::Release_Store(closed, 1);
+  WakeUpRemote();
+  SetRemoteClosedNoLock();
+  message_loop_for_io_->PostTask(
+      FROM_HERE,
+      base::Bind(&SharedMemoryDataPipe::StopWatching, this));
+}
+
+void SharedMemoryDataPipe::WakeUpRemote() {
+  ssize_t bytes_written = HANDLE_EINTR(write(handle_.get().fd, &kWakeup, 1));
+  // If the handle is full, the other side has wakeups to read anyway, and if
+  // it's closed, the other side is gone.
+  if (bytes_written < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+    DPLOG(WARNING) << "write of wakeup";
+}
+
+}  // namespace system
+}  // namespace mojo
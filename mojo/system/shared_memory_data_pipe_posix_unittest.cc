@@ -0,0 +1,281 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/system/shared_memory_data_pipe.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/shared_memory.h"
+#include "mojo/system/embedder/platform_channel_pair.h"
+#include "mojo/system/embedder/platform_handle.h"
+#include "mojo/system/embedder/scoped_platform_handle.h"
+#include "mojo/system/test_utils.h"
+#include "mojo/system/waiter.h"
+
+namespace mojo {
+namespace system {
+namespace {
+
+const uint32_t kSizeOfOptions =
+    static_cast<uint32_t>(sizeof(MojoCreateDataPipeOptions));
+
+// Waits for everything posted to the I/O thread so far, e.g., the data pipes
+// starting to watch for wakeups, to have run.
+void DoNothing() {
+}
+
+class SharedMemoryDataPipeTest : public test::TestWithIOThreadBase {
+ public:
+  SharedMemoryDataPipeTest() {}
+  virtual ~SharedMemoryDataPipeTest() {}
+
+ protected:
+  // Creates the producer and consumer sides of a data pipe, as if in two
+  // processes.
+  void CreateDataPipe(const MojoCreateDataPipeOptions& validated_options) {
+    base::SharedMemory shared_memory;
+    ASSERT_TRUE(shared_memory.CreateAnonymous(
+        SharedMemoryDataPipe::GetSharedMemorySize(validated_options)));
+    embedder::ScopedPlatformHandle shared_memory_handles[2];
+    for (size_t i = 0; i < 2; i++) {
+      int fd = dup(shared_memory.handle().fd);
+      ASSERT_GE(fd, 0);
+      shared_memory_handles[i].reset(embedder::PlatformHandle(fd));
+    }
+
+    embedder::PlatformChannelPair channel_pair;
+    producer_ = SharedMemoryDataPipe::Create(true,
+                                             validated_options,
+                                             channel_pair.PassServerHandle(),
+                                             shared_memory_handles[0].Pass(),
+                                             io_thread_message_loop());
+    consumer_ = SharedMemoryDataPipe::Create(false,
+                                             validated_options,
+                                             channel_pair.PassClientHandle(),
+                                             shared_memory_handles[1].Pass(),
+                                             io_thread_message_loop());
+    ASSERT_TRUE(producer_.get());
+    ASSERT_TRUE(consumer_.get());
+    FlushIOThread();
+  }
+
+  void FlushIOThread() {
+    test::PostTaskAndWait(io_thread_task_runner(),
+                          FROM_HERE,
+                          base::Bind(&DoNothing));
+  }
+
+  // Closes both sides (unless they're closed already), and waits for the data
+  // pipes to have stopped watching for wakeups.
+  void CloseDataPipe(bool producer_open, bool consumer_open) {
+    if (producer_open)
+      producer_->ProducerClose();
+    if (consumer_open)
+      consumer_->ConsumerClose();
+    FlushIOThread();
+  }
+
+  scoped_refptr<DataPipe> producer_;
+  scoped_refptr<DataPipe> consumer_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryDataPipeTest);
+};
+
+MojoCreateDataPipeOptions MakeOptions(uint32_t element_num_bytes,
+                                      uint32_t capacity_num_bytes) {
+  const MojoCreateDataPipeOptions options = {
+    kSizeOfOptions,  // |struct_size|.
+    MOJO_CREATE_DATA_PIPE_OPTIONS_FLAG_NONE,  // |flags|.
+    element_num_bytes,  // |element_num_bytes|.
+    capacity_num_bytes  // |capacity_num_bytes|.
+  };
+  MojoCreateDataPipeOptions validated_options = { 0 };
+  CHECK_EQ(DataPipe::ValidateOptions(&options, &validated_options),
+           MOJO_RESULT_OK);
+  return validated_options;
+}
+
+TEST_F(SharedMemoryDataPipeTest, MayDiscardIsUnsupported) {
+  const MojoCreateDataPipeOptions options = {
+    kSizeOfOptions,  // |struct_size|.
+    MOJO_CREATE_DATA_PIPE_OPTIONS_FLAG_MAY_DISCARD,  // |flags|.
+    1,  // |element_num_bytes|.
+    1000  // |capacity_num_bytes|.
+  };
+  MojoCreateDataPipeOptions validated_options = { 0 };
+  EXPECT_EQ(MOJO_RESULT_OK,
+            DataPipe::ValidateOptions(&options, &validated_options));
+  embedder::PlatformChannelPair channel_pair;
+  EXPECT_FALSE(SharedMemoryDataPipe::Create(true,
+                                            validated_options,
+                                            channel_pair.PassServerHandle(),
+                                            embedder::ScopedPlatformHandle(),
+                                            io_thread_message_loop()).get());
+}
+
+TEST_F(SharedMemoryDataPipeTest, SimpleReadWrite) {
+  CreateDataPipe(MakeOptions(sizeof(int32_t), 10 * sizeof(int32_t)));
+
+  int32_t elements[10] = { 0 };
+  uint32_t num_bytes = static_cast<uint32_t>(sizeof(elements));
+
+  // Try reading; nothing there yet.
+  EXPECT_EQ(MOJO_RESULT_SHOULD_WAIT,
+            consumer_->ConsumerReadData(elements, &num_bytes, false));
+
+  // Write three elements.
+  elements[0] = 123;
+  elements[1] = 456;
+  elements[2] = 789;
+  num_bytes = static_cast<uint32_t>(3u * sizeof(elements[0]));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerWriteData(elements, &num_bytes, false));
+  EXPECT_EQ(3u * sizeof(elements[0]), num_bytes);
+
+  // The consumer sees them right away.
+  num_bytes = 0;
+  EXPECT_EQ(MOJO_RESULT_OK, consumer_->ConsumerQueryData(&num_bytes));
+  EXPECT_EQ(3u * sizeof(elements[0]), num_bytes);
+
+  // Read one, discard one, and read the last one.
+  memset(elements, 0, sizeof(elements));
+  num_bytes = static_cast<uint32_t>(sizeof(elements[0]));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerReadData(elements, &num_bytes, false));
+  EXPECT_EQ(123, elements[0]);
+  EXPECT_EQ(MOJO_RESULT_OK, consumer_->ConsumerDiscardData(&num_bytes, false));
+  num_bytes = static_cast<uint32_t>(sizeof(elements));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerReadData(elements, &num_bytes, false));
+  EXPECT_EQ(sizeof(elements[0]), num_bytes);
+  EXPECT_EQ(789, elements[0]);
+
+  // Fill the buffer, wrapping around its end.
+  for (size_t i = 0; i < arraysize(elements); i++)
+    elements[i] = static_cast<int32_t>(i);
+  num_bytes = static_cast<uint32_t>(sizeof(elements));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerWriteData(elements, &num_bytes, false));
+  EXPECT_EQ(sizeof(elements), num_bytes);
+  EXPECT_EQ(MOJO_RESULT_SHOULD_WAIT,
+            producer_->ProducerWriteData(elements, &num_bytes, false));
+  num_bytes = static_cast<uint32_t>(sizeof(elements[0]));
+  EXPECT_EQ(MOJO_RESULT_OUT_OF_RANGE,
+            producer_->ProducerWriteData(elements, &num_bytes, true));
+
+  int32_t read_elements[10] = { 0 };
+  num_bytes = static_cast<uint32_t>(sizeof(read_elements));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerReadData(read_elements, &num_bytes, true));
+  EXPECT_EQ(0, memcmp(elements, read_elements, sizeof(elements)));
+
+  CloseDataPipe(true, true);
+}
+
+// Tests that two-phase writes and reads on the two sides work on the same
+// data.
+TEST_F(SharedMemoryDataPipeTest, TwoPhaseWriteRead) {
+  CreateDataPipe(MakeOptions(1, 100));
+
+  void* write_ptr = NULL;
+  uint32_t num_bytes = 0;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerBeginWriteData(&write_ptr, &num_bytes, false));
+  EXPECT_EQ(100u, num_bytes);
+  memcpy(write_ptr, "hello", 5);
+
+  // Nothing is readable until the write is done.
+  const void* read_ptr = NULL;
+  EXPECT_EQ(MOJO_RESULT_SHOULD_WAIT,
+            consumer_->ConsumerBeginReadData(&read_ptr, &num_bytes, false));
+  EXPECT_EQ(MOJO_RESULT_OK, producer_->ProducerEndWriteData(5));
+
+  num_bytes = 0;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerBeginReadData(&read_ptr, &num_bytes, false));
+  EXPECT_EQ(5u, num_bytes);
+  EXPECT_EQ(0, memcmp(read_ptr, "hello", 5));
+  EXPECT_EQ(MOJO_RESULT_OK, consumer_->ConsumerEndReadData(2));
+
+  // A two-phase write only goes up to the end of the buffer.
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerBeginWriteData(&write_ptr, &num_bytes, false));
+  EXPECT_EQ(95u, num_bytes);
+  EXPECT_EQ(MOJO_RESULT_OK, producer_->ProducerEndWriteData(95));
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerBeginWriteData(&write_ptr, &num_bytes, false));
+  EXPECT_EQ(2u, num_bytes);
+  EXPECT_EQ(MOJO_RESULT_OK, producer_->ProducerEndWriteData(0));
+
+  num_bytes = 0;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerBeginReadData(&read_ptr, &num_bytes, false));
+  EXPECT_EQ(98u, num_bytes);
+  EXPECT_EQ(0, memcmp(read_ptr, "llo", 3));
+  EXPECT_EQ(MOJO_RESULT_OK, consumer_->ConsumerEndReadData(98));
+
+  CloseDataPipe(true, true);
+}
+
+// Tests that waiters on one side are woken up by the other side.
+TEST_F(SharedMemoryDataPipeTest, BasicWaiting) {
+  CreateDataPipe(MakeOptions(1, 2));
+  Waiter waiter;
+
+  // Not readable yet.
+  waiter.Init();
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerAddWaiter(&waiter, MOJO_WAIT_FLAG_READABLE, 12));
+
+  char elements[2] = { 'a', 'b' };
+  uint32_t num_bytes = 2;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerWriteData(elements, &num_bytes, false));
+  EXPECT_EQ(12, waiter.Wait(1000000));
+  consumer_->ConsumerRemoveWaiter(&waiter);
+
+  // The buffer is full, so the producer isn't writable.
+  waiter.Init();
+  EXPECT_EQ(MOJO_RESULT_OK,
+            producer_->ProducerAddWaiter(&waiter, MOJO_WAIT_FLAG_WRITABLE, 34));
+
+  num_bytes = 1;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerReadData(elements, &num_bytes, false));
+  EXPECT_EQ(34, waiter.Wait(1000000));
+  producer_->ProducerRemoveWaiter(&waiter);
+
+  // Closing the producer makes the consumer unreadable once the data is gone.
+  producer_->ProducerClose();
+  num_bytes = 1;
+  EXPECT_EQ(MOJO_RESULT_OK,
+            consumer_->ConsumerReadData(elements, &num_bytes, false));
+  EXPECT_EQ('b', elements[0]);
+  waiter.Init();
+  MojoResult result =
+      consumer_->ConsumerAddWaiter(&waiter, MOJO_WAIT_FLAG_READABLE, 56);
+  if (result == MOJO_RESULT_OK) {
+    // The wakeup for the close hasn't been handled yet.
+    EXPECT_EQ(MOJO_RESULT_FAILED_PRECONDITION, waiter.Wait(1000000));
+    consumer_->ConsumerRemoveWaiter(&waiter);
+  } else {
+    EXPECT_EQ(MOJO_RESULT_FAILED_PRECONDITION, result);
+  }
+  EXPECT_EQ(MOJO_RESULT_FAILED_PRECONDITION,
+            consumer_->ConsumerReadData(elements, &num_bytes, false));
+
+  CloseDataPipe(false, true);
+}
+
+}  // namespace
+}  // namespace system
+}  // namespace mojo
@@ -0,0 +1,149 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/system/shared_ring_buffer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace mojo {
+namespace system {
+
+namespace {
+
+// The ring's bytes start on a separate cache line from the header.
+const size_t kHeaderSize = 64;
+
+}  // namespace
+
+SharedRingBuffer::SharedRingBuffer(void* memory, size_t capacity)
+    : header_(static_cast<Header*>(memory)),
+      buffer_(static_cast<char*>(memory) + kHeaderSize),
+      capacity_(capacity) {
+  COMPILE_ASSERT(sizeof(Header) <= kHeaderSize, header_too_large);
+  DCHECK(memory);
+  // The capacity must also be small enough for the offsets.
+  DCHECK(capacity_ > 0 && (capacity_ & (capacity_ - 1)) == 0);
+  DCHECK_LE(capacity_, static_cast<size_t>(1) << 31);
+}
+
+SharedRingBuffer::~SharedRingBuffer() {
+}
+
+// static
+size_t SharedRingBuffer::GetRequiredMemorySize(size_t capacity) {
+  return kHeaderSize + capacity;
+}
+
+size_t SharedRingBuffer::Write(const void* bytes, size_t num_bytes) {
+  num_bytes = std::min(num_bytes, capacity_ - GetNumBytesForWriter());
+  if (num_bytes == 0)
+    return 0;
+
+  uint32_t write_offset = static_cast<uint32_t>(
+      base::subtle::NoBarrier_Load(&header_->write_offset));
+  size_t start = write_offset & (capacity_ - 1);
+  size_t first_part_size = std::min(num_bytes, capacity_ - start);
+  memcpy(buffer_ + start, bytes, first_part_size);
+  memcpy(buffer_, static_cast<const char*>(bytes) + first_part_size,
+         num_bytes - first_part_size);
+
+  // Publishes the bytes to the reader.
+  base::subtle::Release_Store(
+      &header_->write_offset,
+      static_cast<base::subtle::Atomic32>(
+          write_offset + static_cast<uint32_t>(num_bytes)));
+  return num_bytes;
+}
+
+size_t SharedRingBuffer::Read(void* bytes, size_t num_bytes) {
+  num_bytes = std::min(num_bytes, GetNumBytesForReader());
+  if (num_bytes == 0)
+    return 0;
+
+  uint32_t read_offset = static_cast<uint32_t>(
+      base::subtle::NoBarrier_Load(&header_->read_offset));
+  size_t start = read_offset & (capacity_ - 1);
+  size_t first_part_size = std::min(num_bytes, capacity_ - start);
+  memcpy(bytes, buffer_ + start, first_part_size);
+  memcpy(static_cast<char*>(bytes) + first_part_size, buffer_,
+         num_bytes - first_part_size);
+
+  // Hands the space back to the writer.
+  base::subtle::Release_Store(
+      &header_->read_offset,
+      static_cast<base::subtle::Atomic32>(
+          read_offset + static_cast<uint32_t>(num_bytes)));
+  return num_bytes;
+}
+
+bool SharedRingBuffer::SetReaderWaiting() {
+  return SetWaiting(&header_->reader_waiting, true);
+}
+
+bool SharedRingBuffer::ConsumeReaderWaiting() {
+  return ConsumeWaiting(&header_->reader_waiting);
+}
+
+bool SharedRingBuffer::SetWriterWaiting() {
+  return SetWaiting(&header_->writer_waiting, false);
+}
+
+bool SharedRingBuffer::ConsumeWriterWaiting() {
+  return ConsumeWaiting(&header_->writer_waiting);
+}
+
+bool SharedRingBuffer::SetWaiting(volatile base::subtle::Atomic32* flag,
+                                  bool for_reader) {
+  base::subtle::NoBarrier_Store(flag, 1);
+  // The other side updates the offsets before it checks |*flag| (see
+  // |ConsumeWaiting()|), so either it sees |*flag| set or we see its update.
+  base::subtle::MemoryBarrier();
+  bool can_proceed = for_reader ? GetNumBytesForReader() > 0 :
+                                  GetNumBytesForWriter() < capacity_;
+  if (!can_proceed)
+    return true;
+
+  // If this fails, the other side has already consumed |*flag|, and the caller
+  // will get a wakeup it doesn't need.
+  base::subtle::NoBarrier_CompareAndSwap(flag, 1, 0);
+  return false;
+}
+
+// static
+bool SharedRingBuffer::ConsumeWaiting(volatile base::subtle::Atomic32* flag) {
+  // Orders the caller's update of the offsets before the load of |*flag|.
+  base::subtle::MemoryBarrier();
+  if (base::subtle::NoBarrier_Load(flag) == 0)
+    return false;
+  return base::subtle::NoBarrier_CompareAndSwap(flag, 1, 0) == 1;
+}
+
+size_t SharedRingBuffer::GetNumBytesForReader() const {
+  // The acquire load makes the written bytes visible to the reader.
+  uint32_t write_offset = static_cast<uint32_t>(
+      base::subtle::Acquire_Load(&header_->write_offset));
+  uint32_t read_offset = static_cast<uint32_t>(
+      base::subtle::NoBarrier_Load(&header_->read_offset));
+  size_t num_bytes = write_offset - read_offset;
+  // The other process may have scribbled over the offsets.
+  return std::min(num_bytes, capacity_);
+}
+
+size_t SharedRingBuffer::GetNumBytesForWriter() const {
+  // The acquire load makes sure that the reader is done with the space.
+  uint32_t read_offset = static_cast<uint32_t>(
+      base::subtle::Acquire_Load(&header_->read_offset));
+  uint32_t write_offset = static_cast<uint32_t>(
+      base::subtle::NoBarrier_Load(&header_->write_offset));
+  size_t num_bytes = write_offset - read_offset;
+  return std::min(num_bytes, capacity_);
+}
+
+}  // namespace system
+}  // namespace mojo
@@ -0,0 +1,100 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MOJO_SYSTEM_SHARED_RING_BUFFER_H_
+#define MOJO_SYSTEM_SHARED_RING_BUFFER_H_
+
+#include <stddef.h>
+
+#include "base/atomicops.h"
+#include "base/macros.h"
+#include "mojo/system/system_impl_export.h"
+
+namespace mojo {
+namespace system {
+
+// |SharedRingBuffer| is a view of a single-producer, single-consumer byte ring
+// in memory that may be shared between two processes. It does not own the
+// memory, which must start out zero-filled (as fresh shared memory is), and
+// which must be |GetRequiredMemorySize(capacity)| bytes and remain mapped while
+// this object is alive.
+//
+// Besides the bytes, the ring keeps a "waiting" flag for each side, which lets
+// the two sides tell each other when they need a wakeup (sent by other means):
+//  - A reader that found the ring empty calls |SetReaderWaiting()|; a writer
+//    that has added bytes calls |ConsumeReaderWaiting()| and sends a wakeup
+//    only if it returns true. So no wakeups are sent while the reader is still
+//    reading, and at most one is sent each time it goes idle.
+//  - Similarly, a writer that found the ring full calls |SetWriterWaiting()|
+//    and a reader that has removed bytes calls |ConsumeWriterWaiting()|.
+//
+// |Write()|, |SetWriterWaiting()| and |ConsumeReaderWaiting()| may only be
+// called by the writer, and the others by the reader (except for
+// |GetRequiredMemorySize()|). The writer and the reader may be on different
+// threads or in different processes.
+class MOJO_SYSTEM_IMPL_EXPORT SharedRingBuffer {
+ public:
+  // |capacity| must be a power of 2.
+  SharedRingBuffer(void* memory, size_t capacity);
+  ~SharedRingBuffer();
+
+  static size_t GetRequiredMemorySize(size_t capacity);
+
+  // Writes up to |num_bytes| from |bytes|, returning the number of bytes
+  // written (which is less than |num_bytes| if the ring is full).
+  size_t Write(const void* bytes, size_t num_bytes);
+
+  // Reads up to |num_bytes| into |bytes|, returning the number of bytes read
+  // (which is 0 if the ring is empty).
+  size_t Read(void* bytes, size_t num_bytes);
+
+  // Marks the reader as waiting for a wakeup, unless there are already bytes to
+  // read. Returns true if the reader is now waiting, and false if it should
+  // read again instead (in which case it may still get a wakeup).
+  bool SetReaderWaiting();
+  // Clears the reader's waiting flag, returning true if it was set, in which
+  // case the writer must wake up the reader.
+  bool ConsumeReaderWaiting();
+
+  // Same as the above, for a writer waiting for space in the ring.
+  bool SetWriterWaiting();
+  bool ConsumeWriterWaiting();
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  // Layout of the start of the shared memory, followed by the bytes of the
+  // ring. The offsets count all the bytes ever written and read (modulo 2^32),
+  // so the ring is empty when they are equal and full when they differ by
+  // |capacity_|.
+  struct Header {
+    volatile base::subtle::Atomic32 write_offset;
+    volatile base::subtle::Atomic32 read_offset;
+    volatile base::subtle::Atomic32 reader_waiting;
+    volatile base::subtle::Atomic32 writer_waiting;
+  };
+
+  // Common implementations of the |Set...Waiting()| and |Consume...Waiting()|
+  // methods. |SetWaiting()| sets |*flag| and returns true, unless the caller
+  // (the reader if |for_reader| is true, else the writer) can make progress
+  // after all, in which case it clears |*flag| again and returns false.
+  bool SetWaiting(volatile base::subtle::Atomic32* flag, bool for_reader);
+  static bool ConsumeWaiting(volatile base::subtle::Atomic32* flag);
+
+  // Returns the number of bytes in the ring, as seen by the reader or the
+  // writer respectively.
+  size_t GetNumBytesForReader() const;
+  size_t GetNumBytesForWriter() const;
+
+  Header* const header_;
+  char* const buffer_;
+  const size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedRingBuffer);
+};
+
+}  // namespace system
+}  // namespace mojo
+
+#endif  // MOJO_SYSTEM_SHARED_RING_BUFFER_H_
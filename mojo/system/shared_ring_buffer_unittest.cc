@@ -0,0 +1,89 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/system/shared_ring_buffer.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace mojo {
+namespace system {
+namespace {
+
+const size_t kCapacity = 16;
+
+TEST(SharedRingBufferTest, WriteAndRead) {
+  std::vector<char> memory(SharedRingBuffer::GetRequiredMemorySize(kCapacity),
+                           0);
+  SharedRingBuffer ring(&memory[0], kCapacity);
+
+  char buffer[2 * kCapacity];
+  EXPECT_EQ(0u, ring.Read(buffer, sizeof(buffer)));
+
+  // Only as much as fits is written.
+  const char kBytes[] = "0123456789abcdefghij";
+  EXPECT_EQ(10u, ring.Write(kBytes, 10));
+  EXPECT_EQ(6u, ring.Write(kBytes + 10, 10));
+  EXPECT_EQ(0u, ring.Write(kBytes, 1));
+
+  EXPECT_EQ(4u, ring.Read(buffer, 4));
+  EXPECT_EQ(0, memcmp(buffer, kBytes, 4));
+
+  // This write wraps around the end of the ring.
+  EXPECT_EQ(4u, ring.Write(kBytes + 16, 4));
+  EXPECT_EQ(16u, ring.Read(buffer, sizeof(buffer)));
+  EXPECT_EQ(0, memcmp(buffer, kBytes + 4, 16));
+  EXPECT_EQ(0u, ring.Read(buffer, sizeof(buffer)));
+}
+
+TEST(SharedRingBufferTest, ReaderWaiting) {
+  std::vector<char> memory(SharedRingBuffer::GetRequiredMemorySize(kCapacity),
+                           0);
+  SharedRingBuffer ring(&memory[0], kCapacity);
+
+  // No wakeup is needed while the reader isn't waiting.
+  EXPECT_EQ(1u, ring.Write("a", 1));
+  EXPECT_FALSE(ring.ConsumeReaderWaiting());
+
+  // The reader can't wait while there are bytes to read.
+  EXPECT_FALSE(ring.SetReaderWaiting());
+  EXPECT_FALSE(ring.ConsumeReaderWaiting());
+
+  char byte;
+  EXPECT_EQ(1u, ring.Read(&byte, 1));
+  EXPECT_TRUE(ring.SetReaderWaiting());
+
+  // Only the first of several writes needs to wake up the reader.
+  EXPECT_EQ(1u, ring.Write("b", 1));
+  EXPECT_TRUE(ring.ConsumeReaderWaiting());
+  EXPECT_EQ(1u, ring.Write("c", 1));
+  EXPECT_FALSE(ring.ConsumeReaderWaiting());
+}
+
+TEST(SharedRingBufferTest, WriterWaiting) {
+  std::vector<char> memory(SharedRingBuffer::GetRequiredMemorySize(kCapacity),
+                           0);
+  SharedRingBuffer ring(&memory[0], kCapacity);
+
+  // The writer can't wait while there's space.
+  EXPECT_FALSE(ring.SetWriterWaiting());
+  EXPECT_FALSE(ring.ConsumeWriterWaiting());
+
+  std::vector<char> bytes(kCapacity, 'x');
+  EXPECT_EQ(kCapacity, ring.Write(&bytes[0], bytes.size()));
+  EXPECT_TRUE(ring.SetWriterWaiting());
+
+  char byte;
+  EXPECT_EQ(1u, ring.Read(&byte, 1));
+  EXPECT_TRUE(ring.ConsumeWriterWaiting());
+  EXPECT_EQ(1u, ring.Read(&byte, 1));
+  EXPECT_FALSE(ring.ConsumeWriterWaiting());
+}
+
+}  // namespace
+}  // namespace system
+}  // namespace mojo
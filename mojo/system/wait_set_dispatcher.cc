@@ -0,0 +1,242 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/system/wait_set_dispatcher.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/time/time.h"
+#include "mojo/system/waiter.h"
+
+namespace mojo {
+namespace system {
+
+// WaitSetDispatcher::Entry ----------------------------------------------------
+
+class WaitSetDispatcher::Entry : public Waiter {
+ public:
+  Entry(WaitSetDispatcher* wait_set,
+        const scoped_refptr<Dispatcher>& dispatcher,
+        uint64_t context,
+        uint64_t id)
+      : wait_set_(wait_set),
+        dispatcher_(dispatcher),
+        context_(context),
+        id_(id),
+        is_ready_(false),
+        ready_result_(MOJO_RESULT_INTERNAL) {
+  }
+  virtual ~Entry() {}
+
+  // |Waiter| override:
+  virtual void Awake(MojoResult wait_result) OVERRIDE {
+    wait_set_->OnEntryAwoken(this, wait_result);
+  }
+
+  Dispatcher* dispatcher() const { return dispatcher_.get(); }
+  uint64_t context() const { return context_; }
+  uint64_t id() const { return id_; }
+
+  // These are protected by the wait set's |ready_lock_|.
+  bool is_ready() const { return is_ready_; }
+  MojoResult ready_result() const { return ready_result_; }
+  void set_ready(MojoResult result) {
+    is_ready_ = true;
+    ready_result_ = result;
+  }
+  void clear_ready() { is_ready_ = false; }
+
+ private:
+  WaitSetDispatcher* const wait_set_;
+  const scoped_refptr<Dispatcher> dispatcher_;
+  const uint64_t context_;
+  const uint64_t id_;
+
+  bool is_ready_;
+  MojoResult ready_result_;
+
+  DISALLOW_COPY_AND_ASSIGN(Entry);
+};
+
+// WaitSetDispatcher -----------------------------------------------------------
+
+WaitSetDispatcher::WaitSetDispatcher()
+    : next_entry_id_(0),
+      ready_cv_(&ready_lock_),
+      closed_(false) {
+}
+
+Dispatcher::Type WaitSetDispatcher::GetType() const {
+  return kTypeWaitSet;
+}
+
+MojoResult WaitSetDispatcher::Add(const scoped_refptr<Dispatcher>& dispatcher,
+                                  MojoWaitFlags flags,
+                                  uint64_t context) {
+  DCHECK(dispatcher.get());
+  DCHECK_NE(dispatcher->GetType(), kTypeWaitSet);
+
+  base::AutoLock locker(lock());
+  if (closed_)
+    return MOJO_RESULT_INVALID_ARGUMENT;
+  if (entries_.find(dispatcher.get()) != entries_.end())
+    return MOJO_RESULT_ALREADY_EXISTS;
+
+  Entry* entry = new Entry(this, dispatcher, context, next_entry_id_++);
+  MojoResult rv = dispatcher->AddWaiter(entry, flags, MOJO_RESULT_OK);
+  switch (rv) {
+    case MOJO_RESULT_OK:
+      break;
+    case MOJO_RESULT_ALREADY_EXISTS:
+      OnEntryAwoken(entry, MOJO_RESULT_OK);
+      break;
+    case MOJO_RESULT_FAILED_PRECONDITION:
+      OnEntryAwoken(entry, MOJO_RESULT_FAILED_PRECONDITION);
+      break;
+    default:
+      // The dispatcher was closed.
+      DCHECK_EQ(rv, MOJO_RESULT_INVALID_ARGUMENT);
+      delete entry;
+      return rv;
+  }
+  entries_[dispatcher.get()] = entry;
+  return MOJO_RESULT_OK;
+}
+
+MojoResult WaitSetDispatcher::Remove(Dispatcher* dispatcher) {
+  base::AutoLock locker(lock());
+  if (closed_)
+    return MOJO_RESULT_INVALID_ARGUMENT;
+
+  EntryMap::iterator it = entries_.find(dispatcher);
+  if (it == entries_.end())
+    return MOJO_RESULT_NOT_FOUND;
+  RemoveEntryNoLock(it);
+  return MOJO_RESULT_OK;
+}
+
+MojoResult WaitSetDispatcher::Wait(MojoDeadline deadline,
+                                   uint32_t* num_results,
+                                   uint64_t* contexts,
+                                   MojoResult* results) {
+  DCHECK_GT(*num_results, 0u);
+
+  // Entries for closed handles, identified by their dispatchers and IDs, to be
+  // removed below.
+  std::vector<std::pair<Dispatcher*, uint64_t> > cancelled_entries;
+  {
+    base::AutoLock locker(ready_lock_);
+
+    // As in |Waiter::Wait()|, treat any out-of-range deadline as "forever".
+    if (deadline > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+      while (ready_entries_.empty() && !closed_)
+        ready_cv_.Wait();
+    } else if (ready_entries_.empty() && !closed_ && deadline > 0) {
+      const base::TimeTicks end_time = base::TimeTicks::HighResNow() +
+          base::TimeDelta::FromMicroseconds(static_cast<int64_t>(deadline));
+      do {
+        base::TimeTicks now_time = base::TimeTicks::HighResNow();
+        if (now_time >= end_time)
+          break;
+        ready_cv_.TimedWait(end_time - now_time);
+      } while (ready_entries_.empty() && !closed_);
+    }
+
+    if (closed_)
+      return MOJO_RESULT_CANCELLED;
+    if (ready_entries_.empty())
+      return MOJO_RESULT_DEADLINE_EXCEEDED;
+
+    uint32_t i = 0;
+    for (; i < *num_results && !ready_entries_.empty(); i++) {
+      Entry* entry = ready_entries_.front();
+      ready_entries_.pop_front();
+      entry->clear_ready();
+      contexts[i] = entry->context();
+      results[i] = entry->ready_result();
+      if (results[i] == MOJO_RESULT_CANCELLED) {
+        cancelled_entries.push_back(
+            std::make_pair(entry->dispatcher(), entry->id()));
+      }
+    }
+    *num_results = i;
+  }
+
+  // Handles that were closed leave the set once they've been reported. This
+  // has to be done under |lock()|, which must not be taken under |ready_lock_|.
+  // The entries may have been removed in the meantime (and, in principle,
+  // their dispatchers added again), hence the IDs.
+  if (!cancelled_entries.empty()) {
+    base::AutoLock locker(lock());
+    for (size_t i = 0; i < cancelled_entries.size(); i++) {
+      EntryMap::iterator it = entries_.find(cancelled_entries[i].first);
+      if (it != entries_.end() &&
+          it->second->id() == cancelled_entries[i].second)
+        RemoveEntryNoLock(it);
+    }
+  }
+
+  return MOJO_RESULT_OK;
+}
+
+WaitSetDispatcher::~WaitSetDispatcher() {
+  // |Close()| must have been called.
+  DCHECK(entries_.empty());
+}
+
+void WaitSetDispatcher::OnEntryAwoken(Entry* entry, MojoResult result) {
+  base::AutoLock locker(ready_lock_);
+  // Once an entry is queued, it's reported only once, with its latest result.
+  if (!entry->is_ready())
+    ready_entries_.push_back(entry);
+  entry->set_ready(result);
+  ready_cv_.Signal();
+}
+
+void WaitSetDispatcher::RemoveEntryNoLock(EntryMap::iterator it) {
+  lock().AssertAcquired();
+
+  Entry* entry = it->second;
+  // After this, |entry| won't be awoken again. (This does nothing if the
+  // dispatcher has been closed, in which case it won't be awoken either.)
+  entry->dispatcher()->RemoveWaiter(entry);
+  {
+    base::AutoLock locker(ready_lock_);
+    if (entry->is_ready()) {
+      ready_entries_.erase(std::find(ready_entries_.begin(),
+                                     ready_entries_.end(),
+                                     entry));
+    }
+  }
+  entries_.erase(it);
+  delete entry;
+}
+
+void WaitSetDispatcher::CloseImplNoLock() {
+  lock().AssertAcquired();
+
+  {
+    base::AutoLock locker(ready_lock_);
+    closed_ = true;
+    // Wake up any threads in |Wait()|.
+    ready_cv_.Broadcast();
+  }
+
+  while (!entries_.empty())
+    RemoveEntryNoLock(entries_.begin());
+}
+
+scoped_refptr<Dispatcher>
+WaitSetDispatcher::CreateEquivalentDispatcherAndCloseImplNoLock() {
+  // |CoreImpl| doesn't allow wait sets to be sent.
+  NOTREACHED();
+  return scoped_refptr<Dispatcher>();
+}
+
+}  // namespace system
+}  // namespace mojo
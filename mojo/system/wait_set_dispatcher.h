@@ -0,0 +1,99 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MOJO_SYSTEM_WAIT_SET_DISPATCHER_H_
+#define MOJO_SYSTEM_WAIT_SET_DISPATCHER_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "mojo/public/system/core.h"
+#include "mojo/system/dispatcher.h"
+#include "mojo/system/system_impl_export.h"
+
+namespace mojo {
+namespace system {
+
+// This is the |Dispatcher| implementation for wait sets (created by the Mojo
+// primitive |MojoCreateWaitSet()|). Each handle in the set has its own |Waiter|
+// (an |Entry|), which stays added to the handle's dispatcher for as long as the
+// handle is in the set and, when awoken, appends itself to the queue of ready
+// entries. So adding and removing a handle costs the same regardless of the
+// size of the set, and a wait only looks at the ready entries. This class is
+// thread-safe.
+//
+// Lock order: Unlike other dispatchers, a wait set calls other dispatchers (to
+// add and remove its entries' waiters) under its |lock()|, so its lock comes
+// before the locks of all other dispatchers. (Wait sets can't be added to wait
+// sets, so this doesn't lead to cycles.) |ready_lock_| is only taken by
+// |Entry::Awake()| under other locks, so nothing may be called under it.
+class MOJO_SYSTEM_IMPL_EXPORT WaitSetDispatcher : public Dispatcher {
+ public:
+  WaitSetDispatcher();
+
+  virtual Type GetType() const OVERRIDE;
+
+  // These implement the Mojo primitives |MojoAddToWaitSet()|,
+  // |MojoRemoveFromWaitSet()| and |MojoWaitOnWaitSet()| (minus the validation
+  // of handles and pointers, which |CoreImpl| does). |dispatcher| is the
+  // dispatcher for the handle being added or removed.
+  MojoResult Add(const scoped_refptr<Dispatcher>& dispatcher,
+                 MojoWaitFlags flags,
+                 uint64_t context);
+  MojoResult Remove(Dispatcher* dispatcher);
+  MojoResult Wait(MojoDeadline deadline,
+                  uint32_t* num_results,
+                  uint64_t* contexts,
+                  MojoResult* results);
+
+ private:
+  class Entry;
+  // Entries are keyed by dispatcher (not handle), so that a closed handle's
+  // entry can't be confused with a new handle's.
+  typedef std::map<Dispatcher*, Entry*> EntryMap;
+
+  friend class base::RefCountedThreadSafe<WaitSetDispatcher>;
+  virtual ~WaitSetDispatcher();
+
+  // Called by |entry| when it's awoken with |result|.
+  void OnEntryAwoken(Entry* entry, MojoResult result);
+
+  // Removes the entry at |it| from its dispatcher, |ready_entries_| (if it's
+  // there) and |entries_|, and deletes it. Must be called under |lock()|.
+  void RemoveEntryNoLock(EntryMap::iterator it);
+
+  // |Dispatcher| implementation/overrides:
+  virtual void CloseImplNoLock() OVERRIDE;
+  virtual scoped_refptr<Dispatcher>
+      CreateEquivalentDispatcherAndCloseImplNoLock() OVERRIDE;
+
+  // Protected by |lock()|:
+  EntryMap entries_;
+  // Used to tell entries apart (see |Wait()|).
+  uint64_t next_entry_id_;
+
+  base::Lock ready_lock_;  // Protects the following members.
+  base::ConditionVariable ready_cv_;  // Associated to |ready_lock_|.
+  // Entries that have been awoken but not yet reported by |Wait()|, in the
+  // order they were awoken. (The entries' ready state is also protected by
+  // |ready_lock_|.)
+  std::deque<Entry*> ready_entries_;
+
+  // Set under both |lock()| and |ready_lock_|, so it may be read under either.
+  bool closed_;
+
+  DISALLOW_COPY_AND_ASSIGN(WaitSetDispatcher);
+};
+
+}  // namespace system
+}  // namespace mojo
+
+#endif  // MOJO_SYSTEM_WAIT_SET_DISPATCHER_H_
@@ -0,0 +1,260 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// NOTE: The threaded tests are inherently flaky (e.g., if run on a heavily-
+// loaded system). |kEpsilonMicros| may be increased to increase tolerance and
+// reduce observed flakiness.
+
+#include "mojo/system/wait_set_dispatcher.h"
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/platform_thread.h"  // For |Sleep()|.
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "mojo/system/message_pipe.h"
+#include "mojo/system/message_pipe_dispatcher.h"
+#include "mojo/system/test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace mojo {
+namespace system {
+namespace {
+
+const int64_t kMicrosPerMs = 1000;
+const int64_t kEpsilonMicros = 15 * kMicrosPerMs;  // 15 ms.
+
+void CreateMessagePipeDispatchers(scoped_refptr<MessagePipeDispatcher>* d0,
+                                  scoped_refptr<MessagePipeDispatcher>* d1) {
+  *d0 = new MessagePipeDispatcher();
+  *d1 = new MessagePipeDispatcher();
+  scoped_refptr<MessagePipe> mp(new MessagePipe());
+  (*d0)->Init(mp, 0);
+  (*d1)->Init(mp, 1);
+}
+
+void WriteOneByte(Dispatcher* dispatcher) {
+  char c = 'x';
+  EXPECT_EQ(MOJO_RESULT_OK,
+            dispatcher->WriteMessage(&c, 1, NULL,
+                                     MOJO_WRITE_MESSAGE_FLAG_NONE));
+}
+
+// Calls a function after a delay on another thread.
+class DelayedCallThread : public base::SimpleThread {
+ public:
+  typedef void (*Function)(Dispatcher*);
+
+  DelayedCallThread(int64_t delay_micros,
+                    Function function,
+                    Dispatcher* dispatcher)
+      : base::SimpleThread("delayed_call_thread"),
+        delay_micros_(delay_micros),
+        function_(function),
+        dispatcher_(dispatcher) {}
+  virtual ~DelayedCallThread() {
+    Join();
+  }
+
+ private:
+  virtual void Run() OVERRIDE {
+    base::PlatformThread::Sleep(
+        base::TimeDelta::FromMicroseconds(delay_micros_));
+    function_(dispatcher_.get());
+  }
+
+  const int64_t delay_micros_;
+  const Function function_;
+  const scoped_refptr<Dispatcher> dispatcher_;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayedCallThread);
+};
+
+void CloseDispatcher(Dispatcher* dispatcher) {
+  EXPECT_EQ(MOJO_RESULT_OK, dispatcher->Close());
+}
+
+TEST(WaitSetDispatcherTest, Basic) {
+  scoped_refptr<WaitSetDispatcher> ws(new WaitSetDispatcher());
+  scoped_refptr<MessagePipeDispatcher> d0, d1;
+  CreateMessagePipeDispatchers(&d0, &d1);
+  uint64_t contexts[2];
+  MojoResult results[2];
+  uint32_t num_results;
+
+  EXPECT_EQ(Dispatcher::kTypeWaitSet, ws->GetType());
+
+  // Nothing to report.
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            ws->Wait(0, &num_results, contexts, results));
+
+  // |d0| is already writable, so it's reported right away.
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d0, MOJO_WAIT_FLAG_WRITABLE, 123));
+  EXPECT_EQ(MOJO_RESULT_ALREADY_EXISTS,
+            ws->Add(d0, MOJO_WAIT_FLAG_READABLE, 456));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(1u, num_results);
+  EXPECT_EQ(123u, contexts[0]);
+  EXPECT_EQ(MOJO_RESULT_OK, results[0]);
+
+  // It's only reported once (until it's removed and added again).
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Remove(d0.get()));
+  EXPECT_EQ(MOJO_RESULT_NOT_FOUND, ws->Remove(d0.get()));
+
+  // Wait for |d0| to become readable.
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d0, MOJO_WAIT_FLAG_READABLE, 456));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            ws->Wait(0, &num_results, contexts, results));
+  WriteOneByte(d1.get());
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(1u, num_results);
+  EXPECT_EQ(456u, contexts[0]);
+  EXPECT_EQ(MOJO_RESULT_OK, results[0]);
+
+  // More messages don't change its state, so it isn't reported again.
+  WriteOneByte(d1.get());
+  WriteOneByte(d1.get());
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            ws->Wait(0, &num_results, contexts, results));
+
+  // Also watch |d1|, and re-add |d0| with different flags.
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d1, MOJO_WAIT_FLAG_READABLE, 789));
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Remove(d0.get()));
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d0, MOJO_WAIT_FLAG_WRITABLE, 123));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(1u, num_results);
+  EXPECT_EQ(123u, contexts[0]);
+
+  // Closing |d1| cancels its entry, which then leaves the set.
+  EXPECT_EQ(MOJO_RESULT_OK, d1->Close());
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(1u, num_results);
+  EXPECT_EQ(789u, contexts[0]);
+  EXPECT_EQ(MOJO_RESULT_CANCELLED, results[0]);
+  EXPECT_EQ(MOJO_RESULT_NOT_FOUND, ws->Remove(d1.get()));
+
+  // A closed dispatcher can't be added.
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            ws->Add(d1, MOJO_WAIT_FLAG_READABLE, 789));
+
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Close());
+  EXPECT_EQ(MOJO_RESULT_OK, d0->Close());
+}
+
+TEST(WaitSetDispatcherTest, MultipleResults) {
+  scoped_refptr<WaitSetDispatcher> ws(new WaitSetDispatcher());
+  scoped_refptr<MessagePipeDispatcher> d0, d1, d2, d3;
+  CreateMessagePipeDispatchers(&d0, &d1);
+  CreateMessagePipeDispatchers(&d2, &d3);
+  uint64_t contexts[2];
+  MojoResult results[2];
+  uint32_t num_results;
+
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d0, MOJO_WAIT_FLAG_READABLE, 0));
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d1, MOJO_WAIT_FLAG_READABLE, 1));
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d2, MOJO_WAIT_FLAG_READABLE, 2));
+
+  // Results are reported in the order they became ready, at most
+  // |*num_results| at a time.
+  WriteOneByte(d3.get());
+  WriteOneByte(d1.get());
+  WriteOneByte(d0.get());
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(2u, num_results);
+  EXPECT_EQ(2u, contexts[0]);
+  EXPECT_EQ(MOJO_RESULT_OK, results[0]);
+  EXPECT_EQ(0u, contexts[1]);
+  EXPECT_EQ(MOJO_RESULT_OK, results[1]);
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Wait(0, &num_results, contexts, results));
+  EXPECT_EQ(1u, num_results);
+  EXPECT_EQ(1u, contexts[0]);
+  EXPECT_EQ(MOJO_RESULT_OK, results[0]);
+
+  // Removing an entry that's ready drops its report.
+  EXPECT_EQ(MOJO_RESULT_OK, d3->Close());
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Remove(d2.get()));
+  num_results = 2;
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            ws->Wait(0, &num_results, contexts, results));
+
+  // Closing the wait set removes the remaining entries.
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Close());
+  EXPECT_EQ(MOJO_RESULT_OK, d0->Close());
+  EXPECT_EQ(MOJO_RESULT_OK, d1->Close());
+  EXPECT_EQ(MOJO_RESULT_OK, d2->Close());
+}
+
+TEST(WaitSetDispatcherTest, BasicThreaded) {
+  test::Stopwatch stopwatch;
+  scoped_refptr<WaitSetDispatcher> ws(new WaitSetDispatcher());
+  scoped_refptr<MessagePipeDispatcher> d0, d1;
+  CreateMessagePipeDispatchers(&d0, &d1);
+  uint64_t contexts[1];
+  MojoResult results[1];
+  uint32_t num_results;
+  int64_t elapsed_micros;
+
+  EXPECT_EQ(MOJO_RESULT_OK, ws->Add(d0, MOJO_WAIT_FLAG_READABLE, 1));
+
+  // Time out.
+  num_results = 1;
+  stopwatch.Start();
+  EXPECT_EQ(MOJO_RESULT_DEADLINE_EXCEEDED,
+            ws->Wait(2 * kEpsilonMicros, &num_results, contexts, results));
+  elapsed_micros = stopwatch.Elapsed();
+  EXPECT_GT(elapsed_micros, (2 - 1) * kEpsilonMicros);
+  EXPECT_LT(elapsed_micros, (2 + 1) * kEpsilonMicros);
+
+  // Awoken by another thread.
+  {
+    DelayedCallThread thread(2 * kEpsilonMicros, &WriteOneByte, d1.get());
+    thread.Start();
+    num_results = 1;
+    stopwatch.Start();
+    EXPECT_EQ(MOJO_RESULT_OK,
+              ws->Wait(MOJO_DEADLINE_INDEFINITE, &num_results, contexts,
+                       results));
+    elapsed_micros = stopwatch.Elapsed();
+    EXPECT_EQ(1u, num_results);
+    EXPECT_EQ(1u, contexts[0]);
+    EXPECT_EQ(MOJO_RESULT_OK, results[0]);
+    EXPECT_GT(elapsed_micros, (2 - 1) * kEpsilonMicros);
+    EXPECT_LT(elapsed_micros, (2 + 1) * kEpsilonMicros);
+  }
+
+  // The wait set is closed by another thread.
+  {
+    DelayedCallThread thread(2 * kEpsilonMicros, &CloseDispatcher, ws.get());
+    thread.Start();
+    num_results = 1;
+    stopwatch.Start();
+    EXPECT_EQ(MOJO_RESULT_CANCELLED,
+              ws->Wait(MOJO_DEADLINE_INDEFINITE, &num_results, contexts,
+                       results));
+    elapsed_micros = stopwatch.Elapsed();
+    EXPECT_GT(elapsed_micros, (2 - 1) * kEpsilonMicros);
+    EXPECT_LT(elapsed_micros, (2 + 1) * kEpsilonMicros);
+  }
+
+  EXPECT_EQ(MOJO_RESULT_INVALID_ARGUMENT,
+            ws->Add(d1, MOJO_WAIT_FLAG_READABLE, 2));
+  EXPECT_EQ(MOJO_RESULT_OK, d0->Close());
+  EXPECT_EQ(MOJO_RESULT_OK, d1->Close());
+}
+
+}  // namespace
+}  // namespace system
+}  // namespace mojo
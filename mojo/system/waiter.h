@@ -18,10 +18,13 @@ namespace system {
 // under other locks, in particular, |Dispatcher::lock_|s, so |Waiter| methods
 // must never call out to other objects (in particular, |Dispatcher|s). This
 // class is thread-safe.
+//
+// Subclasses may override |Awake()| to be notified some other way (see
+// |WaitSetDispatcher|), in which case they don't use |Init()| and |Wait()|.
 class MOJO_SYSTEM_IMPL_EXPORT Waiter {
  public:
   Waiter();
-  ~Waiter();
+  virtual ~Waiter();
 
   // A |Waiter| can be used multiple times; |Init()| should be called before
   // each time it's used.
@@ -41,7 +44,7 @@ class MOJO_SYSTEM_IMPL_EXPORT Waiter {
 
   // Wake the waiter up with the given result (or no-op if it's been woken up
   // already).
-  void Awake(MojoResult wait_result);
+  virtual void Awake(MojoResult wait_result);
 
  private:
   base::ConditionVariable cv_;  // Associated to |lock_|.
@@ -123,6 +123,11 @@ class ExpiringCache {
   // Note: The returned pointer remains owned by the ExpiringCache and is
   // invalidated by a call to a non-const method.
   const ValueType* Get(const KeyType& key, const ExpirationType& now) {
+    return GetMutable(key, now);
+  }
+
+  // Like Get(), but the returned value may be modified in place.
+  ValueType* GetMutable(const KeyType& key, const ExpirationType& now) {
     typename EntryMap::iterator it = entries_.find(key);
     if (it == entries_.end())
       return NULL;
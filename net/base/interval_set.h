@@ -0,0 +1,126 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// IntervalSet<T> is a set of values of an ordered type T, such as a stream
+// offset, stored as disjoint half-open intervals [min, max).  Adjacent and
+// overlapping intervals are coalesced as they are added, so that adding,
+// removing and looking up a range of values takes logarithmic time in the
+// number of intervals, however many values they cover.
+//
+// T must support subtraction, which is used to count the values added to or
+// removed from the set.
+
+#ifndef NET_BASE_INTERVAL_SET_H_
+#define NET_BASE_INTERVAL_SET_H_
+
+#include <algorithm>
+#include <map>
+
+template<class T>
+class IntervalSet {
+ private:
+  // Maps the min of each interval to its max.
+  typedef std::map<T, T> MapType;
+
+ public:
+  // Iterating over the set yields pair<min, max> intervals, in order.
+  typedef typename MapType::const_iterator const_iterator;
+
+  IntervalSet() {}
+
+  // Adds [min, max) to the set.  Returns the number of values which were not
+  // already in the set.
+  T Add(T min, T max) {
+    if (!(min < max))
+      return T();
+    T added = max - min;
+    // Merge all the intervals which overlap or touch [min, max).
+    typename MapType::iterator it = FindFirstTouching(min);
+    T merged_min = min;
+    T merged_max = max;
+    while (it != intervals_.end() && !(max < it->first)) {
+      T overlap_min = std::max(it->first, min);
+      T overlap_max = std::min(it->second, max);
+      if (overlap_min < overlap_max)
+        added = added - (overlap_max - overlap_min);
+      merged_min = std::min(merged_min, it->first);
+      merged_max = std::max(merged_max, it->second);
+      intervals_.erase(it++);
+    }
+    intervals_[merged_min] = merged_max;
+    return added;
+  }
+
+  // Removes [min, max) from the set.  Returns the number of values which were
+  // removed.
+  T Difference(T min, T max) {
+    if (!(min < max))
+      return T();
+    T removed = T();
+    typename MapType::iterator it = FindFirstTouching(min);
+    while (it != intervals_.end() && it->first < max) {
+      T interval_min = it->first;
+      T interval_max = it->second;
+      T overlap_min = std::max(interval_min, min);
+      T overlap_max = std::min(interval_max, max);
+      if (overlap_min < overlap_max)
+        removed = removed + (overlap_max - overlap_min);
+      intervals_.erase(it++);
+      if (interval_min < min)
+        intervals_[interval_min] = min;
+      if (max < interval_max) {
+        intervals_[max] = interval_max;
+        break;
+      }
+    }
+    return removed;
+  }
+
+  // Returns true if all of [min, max) is in the set.  |min| must be less than
+  // |max|.
+  bool Contains(T min, T max) const {
+    const_iterator it = Find(min);
+    return it != intervals_.end() && !(it->second < max);
+  }
+
+  // Returns true if |value| is in the set.
+  bool Contains(T value) const {
+    return Find(value) != intervals_.end();
+  }
+
+  // Returns the interval containing |value|, or end() if there is none.
+  const_iterator Find(T value) const {
+    const_iterator it = intervals_.upper_bound(value);
+    if (it == intervals_.begin())
+      return intervals_.end();
+    --it;
+    return value < it->second ? it : intervals_.end();
+  }
+
+  const_iterator begin() const { return intervals_.begin(); }
+  const_iterator end() const { return intervals_.end(); }
+
+  // Returns the number of disjoint intervals in the set.
+  size_t size() const { return intervals_.size(); }
+  bool empty() const { return intervals_.empty(); }
+
+  void clear() { intervals_.clear(); }
+
+ private:
+  // Returns the first interval which contains, touches or follows |value|.
+  typename MapType::iterator FindFirstTouching(T value) {
+    typename MapType::iterator it = intervals_.upper_bound(value);
+    if (it != intervals_.begin()) {
+      typename MapType::iterator previous = it;
+      --previous;
+      if (!(previous->second < value))
+        return previous;
+    }
+    return it;
+  }
+
+  MapType intervals_;
+};
+
+#endif  // NET_BASE_INTERVAL_SET_H_
@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/interval_set.h"
+
+#include "base/basictypes.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+typedef IntervalSet<uint64> Set;
+
+// Returns true if |set| holds exactly the intervals in |expected|, given as
+// consecutive min, max pairs.
+bool HasIntervals(const Set& set, const uint64* expected, size_t length) {
+  if (set.size() * 2 != length)
+    return false;
+  size_t i = 0;
+  for (Set::const_iterator it = set.begin(); it != set.end(); ++it) {
+    if (it->first != expected[i] || it->second != expected[i + 1])
+      return false;
+    i += 2;
+  }
+  return true;
+}
+
+TEST(IntervalSetTest, AddDisjoint) {
+  Set set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(10u, set.Add(10, 20));
+  EXPECT_EQ(5u, set.Add(0, 5));
+  EXPECT_EQ(0u, set.Add(30, 30));
+
+  const uint64 expected[] = { 0, 5, 10, 20 };
+  EXPECT_TRUE(HasIntervals(set, expected, arraysize(expected)));
+}
+
+TEST(IntervalSetTest, AddCoalesces) {
+  Set set;
+  set.Add(0, 5);
+  set.Add(10, 15);
+  set.Add(20, 25);
+
+  // Touching intervals are merged.
+  EXPECT_EQ(5u, set.Add(5, 10));
+  const uint64 expected[] = { 0, 15, 20, 25 };
+  EXPECT_TRUE(HasIntervals(set, expected, arraysize(expected)));
+
+  // Only the values which were missing are counted.
+  EXPECT_EQ(10u, set.Add(12, 30));
+  const uint64 expected2[] = { 0, 30 };
+  EXPECT_TRUE(HasIntervals(set, expected2, arraysize(expected2)));
+
+  EXPECT_EQ(0u, set.Add(3, 27));
+  EXPECT_EQ(1u, set.size());
+}
+
+TEST(IntervalSetTest, Difference) {
+  Set set;
+  set.Add(0, 10);
+  set.Add(20, 30);
+
+  EXPECT_EQ(4u, set.Difference(3, 7));
+  const uint64 expected[] = { 0, 3, 7, 10, 20, 30 };
+  EXPECT_TRUE(HasIntervals(set, expected, arraysize(expected)));
+
+  EXPECT_EQ(8u, set.Difference(5, 25));
+  const uint64 expected2[] = { 0, 3, 25, 30 };
+  EXPECT_TRUE(HasIntervals(set, expected2, arraysize(expected2)));
+
+  EXPECT_EQ(0u, set.Difference(10, 20));
+  EXPECT_EQ(8u, set.Difference(0, 100));
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(IntervalSetTest, Contains) {
+  Set set;
+  set.Add(10, 20);
+  set.Add(30, 40);
+
+  EXPECT_FALSE(set.Contains(9));
+  EXPECT_TRUE(set.Contains(10));
+  EXPECT_TRUE(set.Contains(19));
+  EXPECT_FALSE(set.Contains(20));
+
+  EXPECT_TRUE(set.Contains(10, 20));
+  EXPECT_TRUE(set.Contains(12, 15));
+  EXPECT_FALSE(set.Contains(5, 15));
+  EXPECT_FALSE(set.Contains(15, 35));
+
+  Set::const_iterator it = set.Find(35);
+  ASSERT_TRUE(it != set.end());
+  EXPECT_EQ(30u, it->first);
+  EXPECT_TRUE(set.Find(25) == set.end());
+}
+
+}  // namespace
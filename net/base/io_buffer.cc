@@ -4,10 +4,107 @@
 
 #include "net/base/io_buffer.h"
 
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/synchronization/lock.h"
 
 namespace net {
 
+namespace {
+
+// The block sizes of PooledIOBuffer, which cover QUIC packets, the SPDY read
+// buffer and typical TLS record reads and writes.
+const int kPoolBlockSizes[] = { 4 * 1024, 8 * 1024, 16 * 1024, 32 * 1024 };
+const int kNumPoolSizeClasses = arraysize(kPoolBlockSizes);
+
+// The number of bytes each size class may keep around once released. Blocks
+// released while their class is full are freed.
+const int kMaxPooledBytesPerSizeClass = 256 * 1024;
+
+// Returns the index of the smallest block size that fits |size|, or -1 if
+// |size| is larger than all of them.
+int GetSizeClass(int size) {
+  for (int i = 0; i < kNumPoolSizeClasses; ++i) {
+    if (size <= kPoolBlockSizes[i])
+      return i;
+  }
+  return -1;
+}
+
+// The free blocks of PooledIOBuffer. Buffers are often released on another
+// thread than the one that allocated them, so a single lock-protected pool is
+// used rather than per-thread ones.
+class IOBufferPool {
+ public:
+  IOBufferPool() {}
+
+  // Returns a block of size class |size_class|.
+  char* Allocate(int size_class) {
+    {
+      base::AutoLock lock(lock_);
+      std::vector<char*>& blocks = free_blocks_[size_class];
+      if (!blocks.empty()) {
+        char* block = blocks.back();
+        blocks.pop_back();
+        return block;
+      }
+    }
+    return new char[kPoolBlockSizes[size_class]];
+  }
+
+  // Returns true if |block| was taken back, and false if the caller should
+  // free it.
+  bool Release(int size_class, char* block) {
+    base::AutoLock lock(lock_);
+    std::vector<char*>& blocks = free_blocks_[size_class];
+    if (static_cast<int>(blocks.size() + 1) * kPoolBlockSizes[size_class] >
+        kMaxPooledBytesPerSizeClass) {
+      return false;
+    }
+    blocks.push_back(block);
+    return true;
+  }
+
+  void Clear() {
+    base::AutoLock lock(lock_);
+    for (int i = 0; i < kNumPoolSizeClasses; ++i) {
+      for (size_t j = 0; j < free_blocks_[i].size(); ++j)
+        delete[] free_blocks_[i][j];
+      free_blocks_[i].clear();
+    }
+  }
+
+  size_t GetSize() {
+    base::AutoLock lock(lock_);
+    size_t size = 0;
+    for (int i = 0; i < kNumPoolSizeClasses; ++i)
+      size += free_blocks_[i].size();
+    return size;
+  }
+
+ private:
+  base::Lock lock_;
+  std::vector<char*> free_blocks_[kNumPoolSizeClasses];
+
+  DISALLOW_COPY_AND_ASSIGN(IOBufferPool);
+};
+
+base::LazyInstance<IOBufferPool>::Leaky g_io_buffer_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Returns the memory for a PooledIOBuffer of |size| bytes.
+char* AllocatePooledBlock(int size, int size_class) {
+  CHECK_GE(size, 0);
+  if (size_class < 0)
+    return new char[size];
+  return g_io_buffer_pool.Get().Allocate(size_class);
+}
+
+}  // namespace
+
 IOBuffer::IOBuffer()
     : data_(NULL) {
 }
@@ -39,6 +136,28 @@ IOBufferWithSize::IOBufferWithSize(char* data, int size)
 IOBufferWithSize::~IOBufferWithSize() {
 }
 
+PooledIOBuffer::PooledIOBuffer(int size)
+    : IOBufferWithSize(AllocatePooledBlock(size, GetSizeClass(size)), size),
+      size_class_(GetSizeClass(size)) {
+}
+
+// static
+void PooledIOBuffer::ClearPoolForTesting() {
+  g_io_buffer_pool.Get().Clear();
+}
+
+// static
+size_t PooledIOBuffer::GetPoolSizeForTesting() {
+  return g_io_buffer_pool.Get().GetSize();
+}
+
+PooledIOBuffer::~PooledIOBuffer() {
+  // If the pool takes the block back, keep the base class destructor from
+  // deleting it.
+  if (size_class_ >= 0 && g_io_buffer_pool.Get().Release(size_class_, data_))
+    data_ = NULL;
+}
+
 StringIOBuffer::StringIOBuffer(const std::string& s)
     : IOBuffer(static_cast<char*>(NULL)),
       string_data_(s) {
@@ -109,6 +109,29 @@ class NET_EXPORT IOBufferWithSize : public IOBuffer {
   int size_;
 };
 
+// This version gets its memory from a process-wide pool of blocks of a few
+// common sizes, and returns it there when the last reference is released, so
+// that loops which allocate a fresh buffer for every read or write don't hit
+// the allocator each time. Like other IOBuffers, it may be released on any
+// thread. Sizes above the largest block size are allocated as usual.
+// The block may be larger than |size|, but only |size| bytes should be used.
+class NET_EXPORT PooledIOBuffer : public IOBufferWithSize {
+ public:
+  explicit PooledIOBuffer(int size);
+
+  // Frees the blocks that are waiting in the pool.
+  static void ClearPoolForTesting();
+
+  // Returns the number of blocks waiting in the pool.
+  static size_t GetPoolSizeForTesting();
+
+ private:
+  virtual ~PooledIOBuffer();
+
+  // The index of the size class of the block, or -1 if it isn't pooled.
+  const int size_class_;
+};
+
 // This is a read only IOBuffer.  The data is stored in a string and
 // the IOBuffer interface does not provide a proper way to modify it.
 class NET_EXPORT StringIOBuffer : public IOBuffer {
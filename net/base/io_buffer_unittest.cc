@@ -0,0 +1,72 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class PooledIOBufferTest : public testing::Test {
+ public:
+  virtual void SetUp() OVERRIDE {
+    PooledIOBuffer::ClearPoolForTesting();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    PooledIOBuffer::ClearPoolForTesting();
+  }
+};
+
+TEST_F(PooledIOBufferTest, ReusesReleasedBlocks) {
+  scoped_refptr<PooledIOBuffer> buffer(new PooledIOBuffer(1500));
+  EXPECT_EQ(1500, buffer->size());
+  memset(buffer->data(), 'a', buffer->size());
+  char* data = buffer->data();
+  buffer = NULL;
+  EXPECT_EQ(1u, PooledIOBuffer::GetPoolSizeForTesting());
+
+  // A buffer of another size in the same size class gets the same block.
+  buffer = new PooledIOBuffer(4096);
+  EXPECT_EQ(data, buffer->data());
+  EXPECT_EQ(0u, PooledIOBuffer::GetPoolSizeForTesting());
+
+  // A larger size class doesn't.
+  scoped_refptr<PooledIOBuffer> large_buffer(new PooledIOBuffer(4097));
+  EXPECT_NE(data, large_buffer->data());
+  large_buffer = NULL;
+  buffer = NULL;
+  EXPECT_EQ(2u, PooledIOBuffer::GetPoolSizeForTesting());
+}
+
+TEST_F(PooledIOBufferTest, UnpooledSizes) {
+  scoped_refptr<PooledIOBuffer> buffer(new PooledIOBuffer(64 * 1024));
+  EXPECT_EQ(64 * 1024, buffer->size());
+  memset(buffer->data(), 'a', buffer->size());
+  buffer = NULL;
+  EXPECT_EQ(0u, PooledIOBuffer::GetPoolSizeForTesting());
+
+  buffer = new PooledIOBuffer(0);
+  EXPECT_EQ(0, buffer->size());
+}
+
+TEST_F(PooledIOBufferTest, PoolIsBounded) {
+  std::vector<scoped_refptr<PooledIOBuffer> > buffers;
+  for (int i = 0; i < 100; ++i)
+    buffers.push_back(new PooledIOBuffer(32 * 1024));
+  buffers.clear();
+  // Only 256K of 32K blocks are kept.
+  EXPECT_EQ(8u, PooledIOBuffer::GetPoolSizeForTesting());
+}
+
+}  // namespace
+
+}  // namespace net
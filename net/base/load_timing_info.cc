@@ -8,7 +8,7 @@
 
 namespace net {
 
-LoadTimingInfo::ConnectTiming::ConnectTiming() {}
+LoadTimingInfo::ConnectTiming::ConnectTiming() : ssl_false_started(false) {}
 
 LoadTimingInfo::ConnectTiming::~ConnectTiming() {}
 
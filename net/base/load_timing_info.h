@@ -89,6 +89,12 @@ struct NET_EXPORT LoadTimingInfo {
     // the final destination server, not an SSL/SPDY proxy.
     base::TimeTicks ssl_start;
     base::TimeTicks ssl_end;
+
+    // True if the SSL handshake was False Started. In that case |ssl_end| is
+    // when the request could first be sent, about a round trip before the
+    // server's Finished message completes the handshake, which is the time
+    // saved over waiting for it.
+    bool ssl_false_started;
   };
 
   LoadTimingInfo();
@@ -381,6 +381,38 @@ static bool CheckForMagicNumbers(const char* content, size_t size,
   return false;
 }
 
+// Returns true if |content| is shorter than |magic_entry| and agrees with it
+// so far, so that more content could still produce a match.
+static bool MagicNumberCouldMatch(const char* content,
+                                  size_t size,
+                                  const MagicNumber& magic_entry) {
+  if (size >= magic_entry.magic_len)
+    return false;
+
+  if (magic_entry.is_string) {
+    // String magic numbers can't match past a null terminator.
+    if (memchr(content, '\0', size))
+      return false;
+    return base::strncasecmp(magic_entry.magic, content, size) == 0;
+  }
+  if (!magic_entry.mask)
+    return MagicCmp(magic_entry.magic, content, size);
+  return MagicMaskCmp(magic_entry.magic, content, size, magic_entry.mask);
+}
+
+// Returns true if more content than |size| bytes could match any of |magic|.
+// Sniffers use this to decide on a partial buffer as soon as the prefix they
+// have rules out every magic number, instead of waiting for the full length.
+static bool CouldMatchMagicNumbers(const char* content, size_t size,
+                                   const MagicNumber* magic,
+                                   size_t magic_len) {
+  for (size_t i = 0; i < magic_len; ++i) {
+    if (MagicNumberCouldMatch(content, size, magic[i]))
+      return true;
+  }
+  return false;
+}
+
 // Truncates |size| to |max_size| and returns true if |size| is at least
 // |max_size|.
 static bool TruncateSize(const size_t max_size, size_t* size) {
@@ -402,7 +434,7 @@ static bool SniffForHTML(const char* content,
                          std::string* result) {
   // For HTML, we are willing to consider up to 512 bytes. This may be overly
   // conservative as IE only considers 256.
-  *have_enough_content &= TruncateSize(512, &size);
+  const bool is_truncated = TruncateSize(512, &size);
 
   // We adopt a strategy similar to that used by Mozilla to sniff HTML tags,
   // but with some modifications to better match the HTML5 spec.
@@ -418,9 +450,18 @@ static bool SniffForHTML(const char* content,
                                      arraysize(kSniffableTags));
   }
   // |pos| now points to first non-whitespace character (or at end).
-  return CheckForMagicNumbers(pos, end - pos,
-                              kSniffableTags, arraysize(kSniffableTags),
-                              counter, result);
+  if (CheckForMagicNumbers(pos, end - pos,
+                           kSniffableTags, arraysize(kSniffableTags),
+                           counter, result))
+    return true;
+
+  // Once a non-whitespace character rules out every tag, more content can't
+  // make this HTML.
+  if (!is_truncated &&
+      CouldMatchMagicNumbers(pos, end - pos,
+                             kSniffableTags, arraysize(kSniffableTags)))
+    *have_enough_content = false;
+  return false;
 }
 
 // Returns true and sets result if the content matches any of kMagicNumbers.
@@ -429,7 +470,7 @@ static bool SniffForMagicNumbers(const char* content,
                                  size_t size,
                                  bool* have_enough_content,
                                  std::string* result) {
-  *have_enough_content &= TruncateSize(kBytesRequiredForMagic, &size);
+  const bool is_truncated = TruncateSize(kBytesRequiredForMagic, &size);
 
   // Check our big table of Magic Numbers
   static base::HistogramBase* counter(NULL);
@@ -437,9 +478,16 @@ static bool SniffForMagicNumbers(const char* content,
     counter = UMASnifferHistogramGet("mime_sniffer.kMagicNumbers2",
                                      arraysize(kMagicNumbers));
   }
-  return CheckForMagicNumbers(content, size,
-                              kMagicNumbers, arraysize(kMagicNumbers),
-                              counter, result);
+  if (CheckForMagicNumbers(content, size,
+                           kMagicNumbers, arraysize(kMagicNumbers),
+                           counter, result))
+    return true;
+
+  if (!is_truncated &&
+      CouldMatchMagicNumbers(content, size,
+                             kMagicNumbers, arraysize(kMagicNumbers)))
+    *have_enough_content = false;
+  return false;
 }
 
 // Returns true and sets result if the content matches any of
@@ -450,14 +498,20 @@ static bool SniffForOfficeDocs(const char* content,
                                const GURL& url,
                                bool* have_enough_content,
                                std::string* result) {
-  *have_enough_content &= TruncateSize(kBytesRequiredForOfficeMagic, &size);
+  const bool is_truncated =
+      TruncateSize(kBytesRequiredForOfficeMagic, &size);
 
   // Check our table of magic numbers for Office file types.
   std::string office_version;
   if (!CheckForMagicNumbers(content, size,
                             kOfficeMagicNumbers, arraysize(kOfficeMagicNumbers),
-                            NULL, &office_version))
+                            NULL, &office_version)) {
+    if (!is_truncated &&
+        CouldMatchMagicNumbers(content, size, kOfficeMagicNumbers,
+                               arraysize(kOfficeMagicNumbers)))
+      *have_enough_content = false;
     return false;
+  }
 
   OfficeDocType type = DOC_TYPE_NONE;
   for (size_t i = 0; i < arraysize(kOfficeExtensionTypes); ++i) {
@@ -785,12 +839,16 @@ static bool SniffCRX(const char* content,
     return false;
   }
 
-  *have_enough_content &= TruncateSize(kBytesRequiredForMagic, &size);
+  const bool is_truncated = TruncateSize(kBytesRequiredForMagic, &size);
   if (CheckForMagicNumbers(content, size,
                            kCRXMagicNumbers, arraysize(kCRXMagicNumbers),
                            NULL, result)) {
     counter->Add(2);
   } else {
+    if (!is_truncated &&
+        CouldMatchMagicNumbers(content, size, kCRXMagicNumbers,
+                               arraysize(kCRXMagicNumbers)))
+      *have_enough_content = false;
     return false;
   }
 
@@ -394,6 +394,43 @@ TEST(MimeSnifferTest, LooksBinary) {
   EXPECT_EQ("application/octet-stream", mime_type);
 }
 
+// Content that rules out every magic number and tag can be decided before the
+// sniffers' full lengths arrive, while a prefix of one has to wait.
+TEST(MimeSnifferTest, DecidesEarlyOnPartialContent) {
+  std::string mime_type;
+
+  // A binary-looking byte with no matching magic number is conclusive.
+  const char kBinary[] = "\x01\x02\x03 not a known format";
+  EXPECT_TRUE(SniffMimeType(kBinary, sizeof(kBinary) - 1, GURL(),
+                            std::string(), &mime_type));
+  EXPECT_EQ("application/octet-stream", mime_type);
+
+  // A partial HTML tag or magic number needs more content.
+  const char kPartialTag[] = "  <ht";
+  EXPECT_FALSE(SniffMimeType(kPartialTag, sizeof(kPartialTag) - 1, GURL(),
+                             std::string(), &mime_type));
+  const char kPartialGZip[] = "\x1F\x8B";
+  EXPECT_FALSE(SniffMimeType(kPartialGZip, sizeof(kPartialGZip) - 1, GURL(),
+                             std::string(), &mime_type));
+  const char kPartialCRX[] = "Cr24";
+  EXPECT_FALSE(SniffMimeType(kPartialCRX, sizeof(kPartialCRX) - 1,
+                             GURL("http://www.example.com/foo.crx"),
+                             "application/octet-stream", &mime_type));
+
+  // Content that can't start a CRX or Office magic number is conclusive for
+  // application/octet-stream, which is only sniffed for those.
+  const char kOther[] = "\x7f\x7f";
+  EXPECT_TRUE(SniffMimeType(kOther, sizeof(kOther) - 1,
+                            GURL("http://www.example.com/foo.crx"),
+                            "application/octet-stream", &mime_type));
+  EXPECT_EQ("application/octet-stream", mime_type);
+
+  // Text without a binary-looking byte may still turn out to be binary.
+  const char kText[] = "plain text";
+  EXPECT_FALSE(SniffMimeType(kText, sizeof(kText) - 1, GURL(), std::string(),
+                             &mime_type));
+}
+
 TEST(MimeSnifferTest, OfficeTest) {
   SnifferTest tests[] = {
     // Check for URLs incorrectly reported as Microsoft Office files.
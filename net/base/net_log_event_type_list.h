@@ -70,6 +70,10 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_IPV6_SUPPORTED)
 // This event is logged when a request is handled by a cache entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_CACHE_HIT)
 
+// This event is logged when a request is handled by a cache entry which has
+// expired, while the host is resolved again in the background.
+EVENT_TYPE(HOST_RESOLVER_IMPL_STALE_CACHE_HIT)
+
 // This event is logged when a request is handled by a HOSTS entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_HOSTS_HIT)
 
@@ -199,6 +203,10 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_PROC_TASK)
 //   }
 EVENT_TYPE(HOST_RESOLVER_IMPL_DNS_TASK)
 
+// This event is logged when a DnsTask completes with the IPv4 addresses,
+// without waiting any longer for the AAAA answer.
+EVENT_TYPE(HOST_RESOLVER_IMPL_DNS_TASK_PARTIAL_RESULT)
+
 // ------------------------------------------------------------------------
 // InitProxyResolver
 // ------------------------------------------------------------------------
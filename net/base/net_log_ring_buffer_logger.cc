@@ -0,0 +1,209 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/net_log_ring_buffer_logger.h"
+
+#include "base/bind.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/stl_util.h"
+#include "base/time/time.h"
+#include "base/values.h"
+
+namespace net {
+
+namespace {
+
+// How often the drain thread empties the buffers.
+const int kDrainIntervalMs = 250;
+
+}  // namespace
+
+// A single-producer, single-consumer ring of events. The thread that owns the
+// buffer adds events, and Drain() removes them. The indices only ever
+// increase, and wrap around as unsigned integers.
+class NetLogRingBufferLogger::ThreadBuffer {
+ public:
+  struct Event {
+    Event() : params(NULL) {}
+
+    NetLog::EventType type;
+    NetLog::Source source;
+    NetLog::EventPhase phase;
+    base::TimeTicks time;
+    // Owned, may be NULL.
+    base::Value* params;
+  };
+
+  explicit ThreadBuffer(size_t size)
+      : events_(size),
+        mask_(size - 1),
+        write_index_(0),
+        read_index_(0) {
+    DCHECK_EQ(0u, size & mask_) << "size must be a power of two";
+  }
+
+  ~ThreadBuffer() {
+    uint32 read_index = base::subtle::NoBarrier_Load(&read_index_);
+    uint32 write_index = base::subtle::NoBarrier_Load(&write_index_);
+    for (; read_index != write_index; ++read_index)
+      delete events_[read_index & mask_].params;
+  }
+
+  // Called by the owning thread. Takes ownership of |params|. Returns false,
+  // and deletes |params|, if the buffer is full.
+  bool Add(const NetLog::Entry& entry, base::Value* params) {
+    uint32 write_index = base::subtle::NoBarrier_Load(&write_index_);
+    uint32 read_index = base::subtle::Acquire_Load(&read_index_);
+    if (write_index - read_index > mask_) {
+      delete params;
+      return false;
+    }
+    Event& event = events_[write_index & mask_];
+    event.type = entry.type();
+    event.source = entry.source();
+    event.phase = entry.phase();
+    event.time = entry.time();
+    event.params = params;
+    base::subtle::Release_Store(&write_index_, write_index + 1);
+    return true;
+  }
+
+  // Called by the draining thread. Moves the buffered events to |events|,
+  // which takes ownership of their parameters.
+  void TakeEvents(std::vector<Event>* events) {
+    uint32 read_index = base::subtle::NoBarrier_Load(&read_index_);
+    uint32 write_index = base::subtle::Acquire_Load(&write_index_);
+    for (; read_index != write_index; ++read_index) {
+      Event& event = events_[read_index & mask_];
+      events->push_back(event);
+      event.params = NULL;
+    }
+    base::subtle::Release_Store(&read_index_, read_index);
+  }
+
+ private:
+  std::vector<Event> events_;
+  const uint32 mask_;
+
+  // Only written by the owning thread.
+  base::subtle::Atomic32 write_index_;
+  // Only written by the draining thread.
+  base::subtle::Atomic32 read_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadBuffer);
+};
+
+// static
+const size_t NetLogRingBufferLogger::kDefaultEventsPerThread;
+
+NetLogRingBufferLogger::NetLogRingBufferLogger(FILE* file,
+                                               const base::Value& constants,
+                                               size_t events_per_thread,
+                                               bool log_parameters)
+    : file_(file),
+      events_per_thread_(events_per_thread),
+      log_parameters_(log_parameters),
+      added_events_(false),
+      dropped_events_(0),
+      drain_thread_("NetLogDrainThread") {
+  DCHECK(file);
+  DCHECK_GT(events_per_thread, 0u);
+
+  std::string json;
+  base::JSONWriter::Write(&constants, &json);
+  fprintf(file_.get(), "{\"constants\": %s,\n", json.c_str());
+  fprintf(file_.get(), "\"events\": [\n");
+}
+
+NetLogRingBufferLogger::~NetLogRingBufferLogger() {
+  DCHECK(!net_log());
+  STLDeleteElements(&buffers_);
+  if (file_.get())
+    fprintf(file_.get(), "]}");
+}
+
+void NetLogRingBufferLogger::StartObserving(NetLog* net_log,
+                                            NetLog::LogLevel log_level) {
+  CHECK(drain_thread_.Start());
+  drain_thread_.message_loop()->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&NetLogRingBufferLogger::DrainAndReschedule,
+                 base::Unretained(this)),
+      base::TimeDelta::FromMilliseconds(kDrainIntervalMs));
+  net_log->AddThreadSafeObserver(this, log_level);
+}
+
+void NetLogRingBufferLogger::StopObserving() {
+  // Once the observer is removed, no thread is in OnAddEntry(), so the final
+  // Drain() sees every event.
+  net_log()->RemoveThreadSafeObserver(this);
+  drain_thread_.Stop();
+  Drain();
+  fflush(file_.get());
+}
+
+uint32 NetLogRingBufferLogger::dropped_events() const {
+  return base::subtle::NoBarrier_Load(&dropped_events_);
+}
+
+void NetLogRingBufferLogger::OnAddEntry(const NetLog::Entry& entry) {
+  base::Value* params = log_parameters_ ? entry.ParametersToValue() : NULL;
+  if (!GetThreadBuffer()->Add(entry, params))
+    base::subtle::NoBarrier_AtomicIncrement(&dropped_events_, 1);
+}
+
+NetLogRingBufferLogger::ThreadBuffer*
+NetLogRingBufferLogger::GetThreadBuffer() {
+  ThreadBuffer* buffer = thread_buffer_.Get();
+  if (!buffer) {
+    buffer = new ThreadBuffer(events_per_thread_);
+    thread_buffer_.Set(buffer);
+    base::AutoLock lock(buffers_lock_);
+    buffers_.push_back(buffer);
+  }
+  return buffer;
+}
+
+void NetLogRingBufferLogger::Drain() {
+  std::vector<ThreadBuffer::Event> events;
+  {
+    base::AutoLock lock(buffers_lock_);
+    for (size_t i = 0; i < buffers_.size(); ++i)
+      buffers_[i]->TakeEvents(&events);
+  }
+
+  for (size_t i = 0; i < events.size(); ++i) {
+    const ThreadBuffer::Event& event = events[i];
+    // Matches NetLog::Entry::ToValue().
+    base::DictionaryValue entry_dict;
+    entry_dict.SetString("time", NetLog::TickCountToString(event.time));
+    base::DictionaryValue* source_dict = new base::DictionaryValue();
+    source_dict->SetInteger("id", event.source.id);
+    source_dict->SetInteger("type", static_cast<int>(event.source.type));
+    entry_dict.Set("source", source_dict);
+    entry_dict.SetInteger("type", static_cast<int>(event.type));
+    entry_dict.SetInteger("phase", static_cast<int>(event.phase));
+    if (event.params)
+      entry_dict.Set("params", event.params);
+
+    std::string json;
+    base::JSONWriter::Write(&entry_dict, &json);
+    fprintf(file_.get(), "%s%s", (added_events_ ? ",\n" : ""), json.c_str());
+    added_events_ = true;
+  }
+}
+
+void NetLogRingBufferLogger::DrainAndReschedule() {
+  Drain();
+  base::MessageLoop::current()->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&NetLogRingBufferLogger::DrainAndReschedule,
+                 base::Unretained(this)),
+      base::TimeDelta::FromMilliseconds(kDrainIntervalMs));
+}
+
+}  // namespace net
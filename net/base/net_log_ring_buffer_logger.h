@@ -0,0 +1,106 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_NET_LOG_RING_BUFFER_LOGGER_H_
+#define NET_BASE_NET_LOG_RING_BUFFER_LOGGER_H_
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/memory/scoped_handle.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread.h"
+#include "base/threading/thread_local.h"
+#include "net/base/net_log.h"
+
+namespace base {
+class Value;
+}
+
+namespace net {
+
+// NetLogRingBufferLogger is a low-overhead alternative to NetLogLogger, meant
+// to be left attached to a NetLog. OnAddEntry() only records the event into a
+// fixed-size ring buffer of the calling thread, which needs neither a lock nor
+// an allocation beyond the parameters. A drain thread periodically empties
+// the buffers, and writes the events to the file in the same JSON format as
+// NetLogLogger.
+//
+// Parameters callbacks may refer to objects that are only valid while the
+// event is being added, so they are still run by OnAddEntry(); turning the
+// resulting Values into JSON and writing them out is what is left to the
+// drain thread. Passing |log_parameters| = false skips the callbacks too.
+//
+// Events are written in per-thread batches, ordered by time within a thread
+// only. When a thread adds events faster than they are drained, new events
+// are dropped and counted.
+class NET_EXPORT NetLogRingBufferLogger : public NetLog::ThreadSafeObserver {
+ public:
+  // The default number of events each thread's buffer can hold.
+  static const size_t kDefaultEventsPerThread = 4096;
+
+  // Takes ownership of |file| and will write network events to it once logging
+  // starts.  |file| must be non-NULL handle and be open for writing.
+  // |constants| is a legend for decoding constant values used in the log.
+  // |events_per_thread| must be a power of two.
+  NetLogRingBufferLogger(FILE* file,
+                         const base::Value& constants,
+                         size_t events_per_thread,
+                         bool log_parameters);
+  virtual ~NetLogRingBufferLogger();
+
+  // Starts the drain thread and observing |net_log|.  Must not already be
+  // watching a NetLog.
+  void StartObserving(NetLog* net_log, NetLog::LogLevel log_level);
+
+  // Stops observing net_log(), stops the drain thread and writes the events
+  // that are still buffered.  Must already be watching.
+  void StopObserving();
+
+  // Returns the number of events that were dropped because a buffer was full.
+  uint32 dropped_events() const;
+
+  // net::NetLog::ThreadSafeObserver implementation:
+  virtual void OnAddEntry(const NetLog::Entry& entry) OVERRIDE;
+
+ private:
+  class ThreadBuffer;
+
+  // Returns the buffer of the current thread, creating it on first use.
+  ThreadBuffer* GetThreadBuffer();
+
+  // Writes the buffered events of all threads to |file_|.
+  void Drain();
+
+  // Runs on the drain thread.
+  void DrainAndReschedule();
+
+  ScopedStdioHandle file_;
+
+  const size_t events_per_thread_;
+  const bool log_parameters_;
+
+  // True if an event has been written to |file_|.  Only used by Drain(),
+  // which runs on one thread at a time.
+  bool added_events_;
+
+  base::subtle::Atomic32 dropped_events_;
+
+  base::ThreadLocalPointer<ThreadBuffer> thread_buffer_;
+
+  // |buffers_lock_| protects |buffers_|, which owns the buffers of all
+  // threads that have added events.
+  base::Lock buffers_lock_;
+  std::vector<ThreadBuffer*> buffers_;
+
+  base::Thread drain_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetLogRingBufferLogger);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_NET_LOG_RING_BUFFER_LOGGER_H_
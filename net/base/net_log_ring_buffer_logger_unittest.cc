@@ -0,0 +1,153 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/net_log_ring_buffer_logger.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/message_loop/message_loop.h"
+#include "base/threading/thread.h"
+#include "base/values.h"
+#include "net/base/net_log_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumEvents = 20;
+
+void AddEvents(NetLog* net_log, NetLog::SourceType source_type) {
+  BoundNetLog bound_net_log = BoundNetLog::Make(net_log, source_type);
+  for (int i = 0; i < kNumEvents; ++i)
+    bound_net_log.AddEvent(NetLog::TYPE_CANCELLED,
+                           NetLog::IntegerCallback("index", i));
+}
+
+class NetLogRingBufferLoggerTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    log_path_ = temp_dir_.path().AppendASCII("NetLogFile");
+  }
+
+ protected:
+  // Reads the log, and returns its events.
+  void ReadEvents(scoped_ptr<base::Value>* root, base::ListValue** events) {
+    std::string input;
+    ASSERT_TRUE(base::ReadFileToString(log_path_, &input));
+
+    base::JSONReader reader;
+    root->reset(reader.ReadToValue(input));
+    ASSERT_TRUE(*root) << reader.GetErrorMessage();
+
+    base::DictionaryValue* dict;
+    ASSERT_TRUE((*root)->GetAsDictionary(&dict));
+    ASSERT_TRUE(dict->GetList("events", events));
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath log_path_;
+  NetLog net_log_;
+};
+
+TEST_F(NetLogRingBufferLoggerTest, GeneratesValidJSONForNoEvents) {
+  {
+    FILE* file = base::OpenFile(log_path_, "w");
+    ASSERT_TRUE(file);
+    scoped_ptr<base::Value> constants(NetLogLogger::GetConstants());
+    NetLogRingBufferLogger logger(
+        file, *constants, NetLogRingBufferLogger::kDefaultEventsPerThread,
+        true);
+    logger.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+    logger.StopObserving();
+  }
+
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = NULL;
+  ASSERT_NO_FATAL_FAILURE(ReadEvents(&root, &events));
+  EXPECT_EQ(0u, events->GetSize());
+}
+
+TEST_F(NetLogRingBufferLoggerTest, EventsFromSeveralThreads) {
+  {
+    FILE* file = base::OpenFile(log_path_, "w");
+    ASSERT_TRUE(file);
+    scoped_ptr<base::Value> constants(NetLogLogger::GetConstants());
+    NetLogRingBufferLogger logger(
+        file, *constants, NetLogRingBufferLogger::kDefaultEventsPerThread,
+        true);
+    logger.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+
+    base::Thread thread("NetLogRingBufferLoggerTest");
+    ASSERT_TRUE(thread.Start());
+    thread.message_loop()->PostTask(
+        FROM_HERE,
+        base::Bind(&AddEvents, &net_log_, NetLog::SOURCE_SPDY_SESSION));
+    AddEvents(&net_log_, NetLog::SOURCE_URL_REQUEST);
+    thread.Stop();
+
+    logger.StopObserving();
+    EXPECT_EQ(0u, logger.dropped_events());
+  }
+
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = NULL;
+  ASSERT_NO_FATAL_FAILURE(ReadEvents(&root, &events));
+  ASSERT_EQ(2u * kNumEvents, events->GetSize());
+
+  // Events of the same thread keep their order, and have their parameters.
+  int spdy_events = 0;
+  int url_request_events = 0;
+  for (size_t i = 0; i < events->GetSize(); ++i) {
+    base::DictionaryValue* event;
+    ASSERT_TRUE(events->GetDictionary(i, &event));
+    int source_type;
+    ASSERT_TRUE(event->GetInteger("source.type", &source_type));
+    int index;
+    ASSERT_TRUE(event->GetInteger("params.index", &index));
+    if (source_type == NetLog::SOURCE_SPDY_SESSION) {
+      EXPECT_EQ(spdy_events++, index);
+    } else {
+      EXPECT_EQ(NetLog::SOURCE_URL_REQUEST, source_type);
+      EXPECT_EQ(url_request_events++, index);
+    }
+  }
+}
+
+TEST_F(NetLogRingBufferLoggerTest, DropsEventsWhenFull) {
+  const size_t kEventsPerThread = 4;
+  uint32 dropped_events;
+  {
+    FILE* file = base::OpenFile(log_path_, "w");
+    ASSERT_TRUE(file);
+    scoped_ptr<base::Value> constants(NetLogLogger::GetConstants());
+    NetLogRingBufferLogger logger(file, *constants, kEventsPerThread, false);
+    logger.StartObserving(&net_log_, NetLog::LOG_ALL_BUT_BYTES);
+    AddEvents(&net_log_, NetLog::SOURCE_URL_REQUEST);
+    logger.StopObserving();
+    dropped_events = logger.dropped_events();
+  }
+
+  // The drain thread may have emptied the buffer while the events were being
+  // added, but at most |kEventsPerThread| can be pending at the end.
+  scoped_ptr<base::Value> root;
+  base::ListValue* events = NULL;
+  ASSERT_NO_FATAL_FAILURE(ReadEvents(&root, &events));
+  EXPECT_LE(kEventsPerThread, events->GetSize());
+  EXPECT_EQ(static_cast<size_t>(kNumEvents),
+            events->GetSize() + dropped_events);
+
+  // Parameters weren't requested.
+  base::DictionaryValue* event;
+  ASSERT_TRUE(events->GetDictionary(0, &event));
+  EXPECT_FALSE(event->HasKey("params"));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/base/upload_data_stream.h"
+#include "net/base/upload_file_element_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kFileSize = 8 * 1024 * 1024;
+
+// The size of the chunks the body is consumed in, as by HttpStreamParser.
+const int kChunkSize = 16 * 1024;
+
+// Stands in for the time it takes to write a chunk to the socket.
+const int kSocketWriteMicroseconds = 200;
+
+class UploadDataStreamPerfTest : public testing::Test {
+ protected:
+  UploadDataStreamPerfTest() : file_thread_("UploadDataStreamPerfTestFile") {}
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(file_thread_.Start());
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(base::CreateTemporaryFileInDir(temp_dir_.path(),
+                                               &temp_file_path_));
+    std::string data(kFileSize, 'a');
+    ASSERT_EQ(kFileSize, file_util::WriteFile(temp_file_path_, data.data(),
+                                              data.size()));
+  }
+
+  // Reads the whole file through an UploadDataStream, pausing after each
+  // chunk as if writing it to the socket.
+  void Upload(int read_ahead_size, const std::string& name) {
+    UploadFileElementReader* reader = new UploadFileElementReader(
+        file_thread_.message_loop_proxy().get(), temp_file_path_, 0,
+        kuint64max, base::Time());
+    reader->set_read_ahead_size(read_ahead_size);
+    ScopedVector<UploadElementReader> element_readers;
+    element_readers.push_back(reader);
+    UploadDataStream stream(element_readers.Pass(), 0);
+
+    TestCompletionCallback init_callback;
+    ASSERT_EQ(OK, init_callback.GetResult(
+        stream.Init(init_callback.callback())));
+
+    scoped_refptr<IOBuffer> buf(new IOBuffer(kChunkSize));
+    base::PerfTimeLogger timer(name.c_str());
+    int total = 0;
+    while (!stream.IsEOF()) {
+      TestCompletionCallback read_callback;
+      int result = read_callback.GetResult(
+          stream.Read(buf.get(), kChunkSize, read_callback.callback()));
+      ASSERT_GT(result, 0);
+      total += result;
+      base::PlatformThread::Sleep(
+          base::TimeDelta::FromMicroseconds(kSocketWriteMicroseconds));
+    }
+    timer.Done();
+    EXPECT_EQ(kFileSize, total);
+  }
+
+  base::MessageLoopForIO message_loop_;
+  base::Thread file_thread_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath temp_file_path_;
+};
+
+}  // namespace
+
+TEST_F(UploadDataStreamPerfTest, FileUploadThroughput) {
+  Upload(0, "UploadDataStream_File_NoReadAhead");
+  Upload(UploadFileElementReader::kDefaultReadAheadSize,
+         "UploadDataStream_File_ReadAhead");
+}
+
+}  // namespace net
@@ -22,6 +22,8 @@ uint64 overriding_content_length = 0;
 
 }  // namespace
 
+const int UploadFileElementReader::kDefaultReadAheadSize = 16 * 1024;
+
 UploadFileElementReader::UploadFileElementReader(
     base::TaskRunner* task_runner,
     const base::FilePath& path,
@@ -35,6 +37,12 @@ UploadFileElementReader::UploadFileElementReader(
       expected_modification_time_(expected_modification_time),
       content_length_(0),
       bytes_remaining_(0),
+      read_ahead_size_(0),
+      file_bytes_remaining_(0),
+      read_ahead_pending_(false),
+      read_ahead_offset_(0),
+      read_ahead_result_(0),
+      pending_read_buf_length_(0),
       weak_ptr_factory_(this) {
   DCHECK(task_runner_.get());
 }
@@ -42,6 +50,11 @@ UploadFileElementReader::UploadFileElementReader(
 UploadFileElementReader::~UploadFileElementReader() {
 }
 
+void UploadFileElementReader::set_read_ahead_size(int read_ahead_size) {
+  DCHECK_GE(read_ahead_size, 0);
+  read_ahead_size_ = read_ahead_size;
+}
+
 const UploadFileElementReader* UploadFileElementReader::AsFileReader() const {
   return this;
 }
@@ -82,6 +95,17 @@ int UploadFileElementReader::Read(IOBuffer* buf,
   if (num_bytes_to_read == 0)
     return 0;
 
+  // Serve the read from the read-ahead buffer, or wait for the read-ahead
+  // under way; FileStream allows only one read at a time anyway.
+  if (read_ahead_result_ != 0)
+    return ConsumeReadAhead(buf, num_bytes_to_read);
+  if (read_ahead_pending_) {
+    pending_read_buf_ = buf;
+    pending_read_buf_length_ = num_bytes_to_read;
+    pending_read_callback_ = callback;
+    return ERR_IO_PENDING;
+  }
+
   int result = file_stream_->Read(
       buf, num_bytes_to_read,
       base::Bind(base::IgnoreResult(&UploadFileElementReader::OnReadCompleted),
@@ -97,6 +121,14 @@ void UploadFileElementReader::Reset() {
   weak_ptr_factory_.InvalidateWeakPtrs();
   bytes_remaining_ = 0;
   content_length_ = 0;
+  file_bytes_remaining_ = 0;
+  read_ahead_pending_ = false;
+  read_ahead_offset_ = 0;
+  read_ahead_result_ = 0;
+  read_ahead_buf_ = NULL;
+  pending_read_buf_ = NULL;
+  pending_read_buf_length_ = 0;
+  pending_read_callback_.Reset();
   file_stream_.reset();
 }
 
@@ -182,6 +214,7 @@ void UploadFileElementReader::OnGetFileInfoCompleted(
 
   content_length_ = length;
   bytes_remaining_ = GetContentLength();
+  file_bytes_remaining_ = bytes_remaining_;
   callback.Run(OK);
 }
 
@@ -194,6 +227,8 @@ int UploadFileElementReader::OnReadCompleted(
   if (result > 0) {
     DCHECK_GE(bytes_remaining_, static_cast<uint64>(result));
     bytes_remaining_ -= result;
+    file_bytes_remaining_ -= result;
+    StartReadAhead();
   }
 
   if (!callback.is_null())
@@ -201,6 +236,62 @@ int UploadFileElementReader::OnReadCompleted(
   return result;
 }
 
+void UploadFileElementReader::StartReadAhead() {
+  if (read_ahead_size_ == 0 || read_ahead_pending_ ||
+      read_ahead_result_ != 0 || file_bytes_remaining_ == 0) {
+    return;
+  }
+
+  if (!read_ahead_buf_.get() || read_ahead_buf_->size() != read_ahead_size_)
+    read_ahead_buf_ = new IOBufferWithSize(read_ahead_size_);
+  uint64 num_bytes_to_read =
+      std::min(file_bytes_remaining_, static_cast<uint64>(read_ahead_size_));
+  read_ahead_pending_ = true;
+  int result = file_stream_->Read(
+      read_ahead_buf_.get(), num_bytes_to_read,
+      base::Bind(&UploadFileElementReader::OnReadAheadCompleted,
+                 weak_ptr_factory_.GetWeakPtr()));
+  if (result != ERR_IO_PENDING)
+    OnReadAheadCompleted(result);
+}
+
+void UploadFileElementReader::OnReadAheadCompleted(int result) {
+  DCHECK(read_ahead_pending_);
+  read_ahead_pending_ = false;
+
+  if (result == 0)  // Reached end-of-file earlier than expected.
+    result = ERR_UPLOAD_FILE_CHANGED;
+  if (result > 0) {
+    DCHECK_GE(file_bytes_remaining_, static_cast<uint64>(result));
+    file_bytes_remaining_ -= result;
+  }
+  read_ahead_offset_ = 0;
+  read_ahead_result_ = result;
+
+  if (pending_read_callback_.is_null())
+    return;
+  scoped_refptr<IOBuffer> buf;
+  buf.swap(pending_read_buf_);
+  CompletionCallback callback = pending_read_callback_;
+  pending_read_callback_.Reset();
+  callback.Run(ConsumeReadAhead(buf.get(), pending_read_buf_length_));
+}
+
+int UploadFileElementReader::ConsumeReadAhead(IOBuffer* buf, int buf_length) {
+  DCHECK_NE(0, read_ahead_result_);
+  if (read_ahead_result_ < 0)
+    return read_ahead_result_;
+
+  int num_bytes = std::min(read_ahead_result_, buf_length);
+  memcpy(buf->data(), read_ahead_buf_->data() + read_ahead_offset_, num_bytes);
+  read_ahead_offset_ += num_bytes;
+  read_ahead_result_ -= num_bytes;
+  DCHECK_GE(bytes_remaining_, static_cast<uint64>(num_bytes));
+  bytes_remaining_ -= num_bytes;
+  StartReadAhead();
+  return num_bytes;
+}
+
 UploadFileElementReader::ScopedOverridingContentLengthForTests::
 ScopedOverridingContentLengthForTests(uint64 value) {
   overriding_content_length = value;
@@ -22,10 +22,15 @@ class TaskRunner;
 namespace net {
 
 class FileStream;
+class IOBufferWithSize;
 
 // An UploadElementReader implementation for file.
 class NET_EXPORT UploadFileElementReader : public UploadElementReader {
  public:
+  // A read-ahead size that keeps one socket write's worth of data
+  // (HttpStreamParser sends the body in 16KB chunks) buffered ahead.
+  static const int kDefaultReadAheadSize;
+
   // |task_runner| is used to perform file operations. It must not be NULL.
   UploadFileElementReader(base::TaskRunner* task_runner,
                           const base::FilePath& path,
@@ -41,6 +46,14 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
     return expected_modification_time_;
   }
 
+  // When |read_ahead_size| is non-zero, each Read() that returns data starts
+  // reading up to |read_ahead_size| more bytes from the file, so that the next
+  // Read() can often complete synchronously, and the file read overlaps with
+  // whatever the caller does with the data (e.g. writing it to a socket).
+  // Read-ahead is disabled by default.
+  void set_read_ahead_size(int read_ahead_size);
+  int read_ahead_size() const { return read_ahead_size_; }
+
   // UploadElementReader overrides:
   virtual const UploadFileElementReader* AsFileReader() const OVERRIDE;
   virtual int Init(const CompletionCallback& callback) OVERRIDE;
@@ -72,6 +85,16 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
   // This method is used to implement Read().
   int OnReadCompleted(const CompletionCallback& callback, int result);
 
+  // These methods are used to implement read-ahead. StartReadAhead() issues a
+  // file read into |read_ahead_buf_| unless one is already running, buffered
+  // data is waiting to be consumed, or there is nothing left to read.
+  void StartReadAhead();
+  void OnReadAheadCompleted(int result);
+
+  // Copies up to |buf_length| bytes of buffered read-ahead data into |buf|,
+  // or returns the error the read-ahead ended with.
+  int ConsumeReadAhead(IOBuffer* buf, int buf_length);
+
   // Sets an value to override the result for GetContentLength().
   // Used for tests.
   struct NET_EXPORT_PRIVATE ScopedOverridingContentLengthForTests {
@@ -87,6 +110,24 @@ class NET_EXPORT UploadFileElementReader : public UploadElementReader {
   scoped_ptr<FileStream> file_stream_;
   uint64 content_length_;
   uint64 bytes_remaining_;
+
+  // Read-ahead state. |file_bytes_remaining_| counts the bytes not yet read
+  // from |file_stream_|, which is less than |bytes_remaining_| while data is
+  // buffered. |read_ahead_result_| is the number of buffered bytes still
+  // unconsumed, starting at |read_ahead_offset_|, or the error the last
+  // read-ahead failed with.
+  int read_ahead_size_;
+  uint64 file_bytes_remaining_;
+  scoped_refptr<IOBufferWithSize> read_ahead_buf_;
+  bool read_ahead_pending_;
+  int read_ahead_offset_;
+  int read_ahead_result_;
+
+  // A Read() waiting on the running read-ahead.
+  scoped_refptr<IOBuffer> pending_read_buf_;
+  int pending_read_buf_length_;
+  CompletionCallback pending_read_callback_;
+
   base::WeakPtrFactory<UploadFileElementReader> weak_ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(UploadFileElementReader);
@@ -177,6 +177,104 @@ TEST_F(UploadFileElementReaderTest, InitDuringAsyncOperation) {
   EXPECT_FALSE(init_callback1.have_result());
 }
 
+TEST_F(UploadFileElementReaderTest, ReadAhead) {
+  const int kChunkSize = 4;
+  UploadFileElementReader* file_reader =
+      new UploadFileElementReader(base::MessageLoopProxy::current().get(),
+                                  temp_file_path_,
+                                  0,
+                                  kuint64max,
+                                  base::Time());
+  file_reader->set_read_ahead_size(kChunkSize);
+  reader_.reset(file_reader);
+  TestCompletionCallback init_callback;
+  ASSERT_EQ(ERR_IO_PENDING, reader_->Init(init_callback.callback()));
+  ASSERT_EQ(OK, init_callback.WaitForResult());
+
+  std::vector<char> read_data;
+  std::vector<char> buf(kChunkSize * 2);
+  scoped_refptr<IOBuffer> wrapped_buffer = new WrappedIOBuffer(&buf[0]);
+
+  // The first read goes to the file directly.
+  TestCompletionCallback read_callback1;
+  ASSERT_EQ(ERR_IO_PENDING,
+            reader_->Read(
+                wrapped_buffer.get(), kChunkSize, read_callback1.callback()));
+  ASSERT_EQ(kChunkSize, read_callback1.WaitForResult());
+  read_data.insert(read_data.end(), buf.begin(), buf.begin() + kChunkSize);
+
+  // A read issued while the read-ahead is running waits for it.
+  TestCompletionCallback read_callback2;
+  ASSERT_EQ(ERR_IO_PENDING,
+            reader_->Read(
+                wrapped_buffer.get(), kChunkSize, read_callback2.callback()));
+  ASSERT_EQ(kChunkSize, read_callback2.WaitForResult());
+  read_data.insert(read_data.end(), buf.begin(), buf.begin() + kChunkSize);
+  EXPECT_EQ(bytes_.size() - 2 * kChunkSize, reader_->BytesRemaining());
+
+  // Once the read-ahead has finished, reads complete synchronously, and return
+  // no more than what was read ahead.
+  while (reader_->BytesRemaining() > 0) {
+    base::RunLoop().RunUntilIdle();
+    TestCompletionCallback read_callback;
+    int result = reader_->Read(
+        wrapped_buffer.get(), buf.size(), read_callback.callback());
+    ASSERT_GT(result, 0);
+    ASSERT_LE(result, kChunkSize);
+    read_data.insert(read_data.end(), buf.begin(), buf.begin() + result);
+  }
+  EXPECT_EQ(bytes_, read_data);
+
+  TestCompletionCallback read_callback3;
+  EXPECT_EQ(0,
+            reader_->Read(
+                wrapped_buffer.get(), buf.size(), read_callback3.callback()));
+}
+
+TEST_F(UploadFileElementReaderTest, InitDuringReadAhead) {
+  const int kChunkSize = 4;
+  UploadFileElementReader* file_reader =
+      new UploadFileElementReader(base::MessageLoopProxy::current().get(),
+                                  temp_file_path_,
+                                  0,
+                                  kuint64max,
+                                  base::Time());
+  file_reader->set_read_ahead_size(kChunkSize);
+  reader_.reset(file_reader);
+  TestCompletionCallback init_callback1;
+  ASSERT_EQ(ERR_IO_PENDING, reader_->Init(init_callback1.callback()));
+  ASSERT_EQ(OK, init_callback1.WaitForResult());
+
+  std::vector<char> buf(bytes_.size());
+  scoped_refptr<IOBuffer> wrapped_buffer = new WrappedIOBuffer(&buf[0]);
+  TestCompletionCallback read_callback1;
+  ASSERT_EQ(ERR_IO_PENDING,
+            reader_->Read(
+                wrapped_buffer.get(), kChunkSize, read_callback1.callback()));
+  ASSERT_EQ(kChunkSize, read_callback1.WaitForResult());
+
+  // Start a read that waits on the read-ahead, then call Init to cancel both.
+  TestCompletionCallback read_callback2;
+  ASSERT_EQ(ERR_IO_PENDING,
+            reader_->Read(
+                wrapped_buffer.get(), kChunkSize, read_callback2.callback()));
+  TestCompletionCallback init_callback2;
+  ASSERT_EQ(ERR_IO_PENDING, reader_->Init(init_callback2.callback()));
+  EXPECT_EQ(OK, init_callback2.WaitForResult());
+  EXPECT_EQ(bytes_.size(), reader_->BytesRemaining());
+
+  // Reading starts over from the beginning of the file.
+  TestCompletionCallback read_callback3;
+  ASSERT_EQ(ERR_IO_PENDING,
+            reader_->Read(
+                wrapped_buffer.get(), buf.size(), read_callback3.callback()));
+  EXPECT_EQ(static_cast<int>(buf.size()), read_callback3.WaitForResult());
+  EXPECT_EQ(bytes_, buf);
+
+  // Make sure the callback is not called for the cancelled read.
+  EXPECT_FALSE(read_callback2.have_result());
+}
+
 TEST_F(UploadFileElementReaderTest, Range) {
   const uint64 kOffset = 2;
   const uint64 kLength = bytes_.size() - kOffset * 3;
@@ -17,6 +17,8 @@
 #include "base/time/time.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
+#include "net/base/net_util.h"
+#include "net/cert/cert_status_flags.h"
 #include "net/cert/cert_trust_anchor_provider.h"
 #include "net/cert/cert_verify_proc.h"
 #include "net/cert/crl_set.h"
@@ -68,7 +70,13 @@ namespace net {
 //
 //
 // On a cache hit, MultiThreadedCertVerifier::Verify() returns synchronously
-// without posting a task to a worker thread.
+// without posting a task to a worker thread. The same happens when another
+// hostname was recently verified with the same certificate chain, in which
+// case only the name of the certificate is checked.
+//
+// At most max_concurrent_jobs_ CertVerifierWorkers run at once. Further
+// CertVerifierJobs are queued, and are started as running ones finish, unless
+// the chain cache can answer them by then.
 
 namespace {
 
@@ -78,6 +86,44 @@ const unsigned kMaxCacheEntries = 256;
 // The number of seconds for which we'll cache a cache entry.
 const unsigned kTTLSecs = 1800;  // 30 minutes.
 
+// The default value of max_concurrent_jobs_. Platform verification mostly
+// blocks on disk and network fetches, but running too many at once only
+// delays all of them.
+const size_t kDefaultMaxConcurrentJobs = 8;
+
+// The certificate status flags that depend on the hostname rather than on the
+// certificate chain.
+const CertStatus kHostnameCertStatus =
+    CERT_STATUS_COMMON_NAME_INVALID | CERT_STATUS_NON_UNIQUE_NAME;
+
+// Returns true if the result of a verification only depends on the
+// certificate chain, once the hostname-specific status is set aside.
+bool IsChainResultReusable(int error, const CertVerifyResult& verify_result) {
+  if (error != OK && error != ERR_CERT_COMMON_NAME_INVALID)
+    return false;
+  return !IsCertStatusError(verify_result.cert_status & ~kHostnameCertStatus);
+}
+
+// Replaces the hostname-specific parts of |verify_result|, which was produced
+// for another hostname, with those for |hostname|, and returns the
+// corresponding CertVerifier::Verify() return value. This mirrors the checks
+// CertVerifyProc does for the name.
+int RecheckHostname(X509Certificate* cert,
+                    const std::string& hostname,
+                    CertVerifyResult* verify_result) {
+  verify_result->cert_status &= ~kHostnameCertStatus;
+  verify_result->common_name_fallback_used = false;
+  if (!cert->VerifyNameMatch(hostname,
+                             &verify_result->common_name_fallback_used)) {
+    verify_result->cert_status |= CERT_STATUS_COMMON_NAME_INVALID;
+  }
+  if (verify_result->is_issued_by_known_root && IsHostnameNonUnique(hostname))
+    verify_result->cert_status |= CERT_STATUS_NON_UNIQUE_NAME;
+  if (!IsCertStatusError(verify_result->cert_status))
+    return OK;
+  return MapCertStatusToNetError(verify_result->cert_status);
+}
+
 }  // namespace
 
 MultiThreadedCertVerifier::CachedResult::CachedResult() : error(ERR_FAILED) {}
@@ -202,9 +248,14 @@ class CertVerifierWorker {
         error_(ERR_FAILED) {
   }
 
-  // Returns the certificate being verified. May only be called /before/
+  // Return the parameters of the verification. May only be called /before/
   // Start() is called.
   X509Certificate* certificate() const { return cert_.get(); }
+  const std::string& hostname() const { return hostname_; }
+  int flags() const { return flags_; }
+  const CertificateList& additional_trust_anchors() const {
+    return additional_trust_anchors_;
+  }
 
   bool Start() {
     DCHECK_EQ(base::MessageLoop::current(), origin_loop_);
@@ -316,13 +367,15 @@ class CertVerifierWorker {
 };
 
 // A CertVerifierJob is a one-to-one counterpart of a CertVerifierWorker. It
-// lives only on the CertVerifier's origin message loop.
+// lives only on the CertVerifier's origin message loop. The job owns its
+// worker until the worker is started.
 class CertVerifierJob {
  public:
   CertVerifierJob(CertVerifierWorker* worker,
                   const BoundNetLog& net_log)
       : start_time_(base::TimeTicks::Now()),
         worker_(worker),
+        started_(false),
         net_log_(net_log) {
     net_log_.BeginEvent(
         NetLog::TYPE_CERT_VERIFIER_JOB,
@@ -334,11 +387,25 @@ class CertVerifierJob {
     if (worker_) {
       net_log_.AddEvent(NetLog::TYPE_CANCELLED);
       net_log_.EndEvent(NetLog::TYPE_CERT_VERIFIER_JOB);
-      worker_->Cancel();
+      if (started_)
+        worker_->Cancel();
+      else
+        delete worker_;
       DeleteAllCanceled();
     }
   }
 
+  // Starts the worker. Returns false if it couldn't be started, in which case
+  // the job still owns it.
+  bool Start() {
+    DCHECK(!started_);
+    started_ = worker_->Start();
+    return started_;
+  }
+
+  // Returns the worker, which is only valid until HandleResult is called.
+  CertVerifierWorker* worker() const { return worker_; }
+
   void AddRequest(CertVerifierRequest* request) {
     request->net_log().AddEvent(
         NetLog::TYPE_CERT_VERIFIER_REQUEST_BOUND_TO_JOB,
@@ -349,6 +416,8 @@ class CertVerifierJob {
 
   void HandleResult(
       const MultiThreadedCertVerifier::CachedResult& verify_result) {
+    if (!started_)
+      delete worker_;
     worker_ = NULL;
     net_log_.EndEvent(NetLog::TYPE_CERT_VERIFIER_JOB);
     UMA_HISTOGRAM_CUSTOM_TIMES("Net.CertVerifier_Job_Latency",
@@ -385,14 +454,19 @@ class CertVerifierJob {
   const base::TimeTicks start_time_;
   std::vector<CertVerifierRequest*> requests_;
   CertVerifierWorker* worker_;
+  bool started_;
   const BoundNetLog net_log_;
 };
 
 MultiThreadedCertVerifier::MultiThreadedCertVerifier(
     CertVerifyProc* verify_proc)
     : cache_(kMaxCacheEntries),
+      chain_cache_(kMaxCacheEntries),
+      running_jobs_(0),
+      max_concurrent_jobs_(kDefaultMaxConcurrentJobs),
       requests_(0),
       cache_hits_(0),
+      chain_cache_hits_(0),
       inflight_joins_(0),
       verify_proc_(verify_proc),
       trust_anchor_provider_(NULL) {
@@ -400,6 +474,7 @@ MultiThreadedCertVerifier::MultiThreadedCertVerifier(
 }
 
 MultiThreadedCertVerifier::~MultiThreadedCertVerifier() {
+  // |queued_jobs_| are also in |inflight_|.
   STLDeleteValues(&inflight_);
   CertDatabase::GetInstance()->RemoveObserver(this);
 }
@@ -443,6 +518,14 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
     return cached_entry->error;
   }
 
+  int chain_error;
+  if (LookupChainCache(cert, hostname, flags, additional_trust_anchors,
+                       &chain_error, verify_result)) {
+    ++chain_cache_hits_;
+    *out_req = NULL;
+    return chain_error;
+  }
+
   // No cache hit. See if an identical request is currently in flight.
   CertVerifierJob* job;
   std::map<RequestParams, CertVerifierJob*>::const_iterator j;
@@ -465,13 +548,17 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
     job = new CertVerifierJob(
         worker,
         BoundNetLog::Make(net_log.net_log(), NetLog::SOURCE_CERT_VERIFIER_JOB));
-    if (!worker->Start()) {
-      delete job;
-      delete worker;
-      *out_req = NULL;
-      // TODO(wtc): log to the NetLog.
-      LOG(ERROR) << "CertVerifierWorker couldn't be started.";
-      return ERR_INSUFFICIENT_RESOURCES;  // Just a guess.
+    if (running_jobs_ < max_concurrent_jobs_) {
+      if (!job->Start()) {
+        delete job;  // Also deletes |worker|.
+        *out_req = NULL;
+        // TODO(wtc): log to the NetLog.
+        LOG(ERROR) << "CertVerifierWorker couldn't be started.";
+        return ERR_INSUFFICIENT_RESOURCES;  // Just a guess.
+      }
+      ++running_jobs_;
+    } else {
+      queued_jobs_.push_back(job);
     }
     inflight_.insert(std::make_pair(key, job));
   }
@@ -521,8 +608,58 @@ bool MultiThreadedCertVerifier::RequestParams::operator<(
       net::SHA1HashValueLessThan());
 }
 
+bool MultiThreadedCertVerifier::LookupChainCache(
+    X509Certificate* cert,
+    const std::string& hostname,
+    int flags,
+    const CertificateList& additional_trust_anchors,
+    int* error,
+    CertVerifyResult* verify_result) {
+  const RequestParams chain_key(cert->fingerprint(), cert->ca_fingerprint(),
+                                std::string(), flags,
+                                additional_trust_anchors);
+  const CertVerifierCache::value_type* cached_entry =
+      chain_cache_.Get(chain_key, CacheValidityPeriod(base::Time::Now()));
+  if (!cached_entry)
+    return false;
+  *verify_result = cached_entry->result;
+  *error = RecheckHostname(cert, hostname, verify_result);
+  return true;
+}
+
+void MultiThreadedCertVerifier::StartQueuedJobs(
+    CompletedJobList* completed_jobs) {
+  while (running_jobs_ < max_concurrent_jobs_ && !queued_jobs_.empty()) {
+    CertVerifierJob* job = queued_jobs_.front();
+    queued_jobs_.pop_front();
+
+    CertVerifierWorker* worker = job->worker();
+    CachedResult result;
+    if (!LookupChainCache(worker->certificate(), worker->hostname(),
+                          worker->flags(), worker->additional_trust_anchors(),
+                          &result.error, &result.result)) {
+      if (job->Start()) {
+        ++running_jobs_;
+        continue;
+      }
+      LOG(ERROR) << "CertVerifierWorker couldn't be started.";
+      result.error = ERR_INSUFFICIENT_RESOURCES;
+    } else {
+      ++chain_cache_hits_;
+    }
+
+    const RequestParams key(worker->certificate()->fingerprint(),
+                            worker->certificate()->ca_fingerprint(),
+                            worker->hostname(), worker->flags(),
+                            worker->additional_trust_anchors());
+    inflight_.erase(key);
+    completed_jobs->push_back(std::make_pair(job, result));
+  }
+}
+
 // HandleResult is called by CertVerifierWorker on the origin message loop.
-// It deletes CertVerifierJob.
+// It deletes CertVerifierJob, along with any queued job that the new chain
+// cache entry makes unnecessary.
 void MultiThreadedCertVerifier::HandleResult(
     X509Certificate* cert,
     const std::string& hostname,
@@ -539,9 +676,16 @@ void MultiThreadedCertVerifier::HandleResult(
   cached_result.error = error;
   cached_result.result = verify_result;
   base::Time now = base::Time::Now();
-  cache_.Put(
-      key, cached_result, CacheValidityPeriod(now),
-      CacheValidityPeriod(now, now + base::TimeDelta::FromSeconds(kTTLSecs)));
+  const CacheValidityPeriod validity_period(
+      now, now + base::TimeDelta::FromSeconds(kTTLSecs));
+  cache_.Put(key, cached_result, CacheValidityPeriod(now), validity_period);
+  if (IsChainResultReusable(error, verify_result)) {
+    const RequestParams chain_key(cert->fingerprint(), cert->ca_fingerprint(),
+                                  std::string(), flags,
+                                  additional_trust_anchors);
+    chain_cache_.Put(chain_key, cached_result, CacheValidityPeriod(now),
+                     validity_period);
+  }
 
   std::map<RequestParams, CertVerifierJob*>::iterator j;
   j = inflight_.find(key);
@@ -549,11 +693,19 @@ void MultiThreadedCertVerifier::HandleResult(
     NOTREACHED();
     return;
   }
-  CertVerifierJob* job = j->second;
+  CompletedJobList completed_jobs;
+  completed_jobs.push_back(std::make_pair(j->second, cached_result));
   inflight_.erase(j);
-
-  job->HandleResult(cached_result);
-  delete job;
+  DCHECK_LT(0u, running_jobs_);
+  --running_jobs_;
+  StartQueuedJobs(&completed_jobs);
+
+  // The callbacks may delete |this|, so it must not be used from here on.
+  for (CompletedJobList::iterator it = completed_jobs.begin();
+       it != completed_jobs.end(); ++it) {
+    it->first->HandleResult(it->second);
+    delete it->first;
+  }
 }
 
 void MultiThreadedCertVerifier::OnCACertChanged(
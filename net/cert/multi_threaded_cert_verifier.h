@@ -5,12 +5,15 @@
 #ifndef NET_CERT_MULTI_THREADED_CERT_VERIFIER_H_
 #define NET_CERT_MULTI_THREADED_CERT_VERIFIER_H_
 
+#include <deque>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
+#include "base/logging.h"
 #include "base/memory/ref_counted.h"
 #include "base/threading/non_thread_safe.h"
 #include "net/base/completion_callback.h"
@@ -65,6 +68,14 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
 
   virtual void CancelRequest(CertVerifier::RequestHandle req) OVERRIDE;
 
+  // Sets the maximum number of verifications that are run on worker threads
+  // at once. Verifications beyond the limit wait for a running one to finish,
+  // at which point they may be answered from the chain cache instead.
+  void set_max_concurrent_jobs(size_t max_concurrent_jobs) {
+    DCHECK_LT(0u, max_concurrent_jobs);
+    max_concurrent_jobs_ = max_concurrent_jobs;
+  }
+
  private:
   friend class CertVerifierWorker;  // Calls HandleResult.
   friend class CertVerifierRequest;
@@ -78,8 +89,12 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
                            RequestParamsComparators);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
                            CertTrustAnchorProvider);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, ChainCacheHit);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
+                           QueuedJobUsesChainCache);
 
-  // Input parameters of a certificate verification request.
+  // Input parameters of a certificate verification request. The keys of the
+  // chain cache have an empty |hostname|.
   struct NET_EXPORT_PRIVATE RequestParams {
     RequestParams(const SHA1HashValue& cert_fingerprint_arg,
                   const SHA1HashValue& ca_fingerprint_arg,
@@ -129,6 +144,25 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   typedef ExpiringCache<RequestParams, CachedResult, CacheValidityPeriod,
                         CacheExpirationFunctor> CertVerifierCache;
 
+  // Returns true if the chain of |cert| was verified recently and is in the
+  // chain cache. In that case the name of the certificate is checked against
+  // |hostname|, and the outcome is stored in |*error| and |*verify_result|.
+  bool LookupChainCache(X509Certificate* cert,
+                        const std::string& hostname,
+                        int flags,
+                        const CertificateList& additional_trust_anchors,
+                        int* error,
+                        CertVerifyResult* verify_result);
+
+  typedef std::vector<std::pair<CertVerifierJob*, CachedResult> >
+      CompletedJobList;
+
+  // Starts queued jobs until |max_concurrent_jobs_| are running. Queued jobs
+  // whose chain was verified in the meantime don't need a worker: they are
+  // removed from |inflight_| and appended to |completed_jobs| with their
+  // result, for the caller to complete once it no longer uses |this|.
+  void StartQueuedJobs(CompletedJobList* completed_jobs);
+
   void HandleResult(X509Certificate* cert,
                     const std::string& hostname,
                     int flags,
@@ -140,21 +174,38 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier
   virtual void OnCACertChanged(const X509Certificate* cert) OVERRIDE;
 
   // For unit testing.
-  void ClearCache() { cache_.Clear(); }
+  void ClearCache() {
+    cache_.Clear();
+    chain_cache_.Clear();
+  }
   size_t GetCacheSize() const { return cache_.size(); }
   uint64 cache_hits() const { return cache_hits_; }
+  uint64 chain_cache_hits() const { return chain_cache_hits_; }
   uint64 requests() const { return requests_; }
   uint64 inflight_joins() const { return inflight_joins_; }
 
   // cache_ maps from a request to a cached result.
   CertVerifierCache cache_;
 
+  // chain_cache_ maps from a certificate chain, without a hostname, to a
+  // result that only depends on the chain, so that a certificate shared by
+  // several hosts is only verified once. Results that include errors other
+  // than a name mismatch aren't kept.
+  CertVerifierCache chain_cache_;
+
   // inflight_ maps from a request to an active verification which is taking
-  // place.
+  // place, or waiting in |queued_jobs_| for a worker.
   std::map<RequestParams, CertVerifierJob*> inflight_;
 
+  // Jobs that wait for one of the |max_concurrent_jobs_| running ones to
+  // finish, oldest first.
+  std::deque<CertVerifierJob*> queued_jobs_;
+  size_t running_jobs_;
+  size_t max_concurrent_jobs_;
+
   uint64 requests_;
   uint64 cache_hits_;
+  uint64 chain_cache_hits_;
   uint64 inflight_joins_;
 
   scoped_refptr<CertVerifyProc> verify_proc_;
@@ -0,0 +1,151 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/cert/multi_threaded_cert_verifier.h"
+
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/threading/platform_thread.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_log.h"
+#include "net/base/test_completion_callback.h"
+#include "net/base/test_data_directory.h"
+#include "net/cert/cert_verify_proc.h"
+#include "net/cert/cert_verify_result.h"
+#include "net/cert/x509_certificate.h"
+#include "net/test/cert_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+// The number of hosts that share the certificate.
+const int kNumHostnames = 200;
+
+// The number of times each test is repeated, with a new verifier.
+const int kIterations = 5;
+
+// How long the simulated platform verification takes.
+const int kVerifyTimeMs = 5;
+
+// Stands in for a platform verifier, which typically spends most of its time
+// building and checking the path rather than matching the name.
+class SlowCertVerifyProc : public CertVerifyProc {
+ public:
+  SlowCertVerifyProc() {}
+
+ private:
+  virtual ~SlowCertVerifyProc() {}
+
+  // CertVerifyProc implementation
+  virtual bool SupportsAdditionalTrustAnchors() const OVERRIDE {
+    return false;
+  }
+
+  virtual int VerifyInternal(X509Certificate* cert,
+                             const std::string& hostname,
+                             int flags,
+                             CRLSet* crl_set,
+                             const CertificateList& additional_trust_anchors,
+                             CertVerifyResult* verify_result) OVERRIDE {
+    base::PlatformThread::Sleep(
+        base::TimeDelta::FromMilliseconds(kVerifyTimeMs));
+    if (!cert->VerifyNameMatch(hostname,
+                               &verify_result->common_name_fallback_used)) {
+      verify_result->cert_status |= CERT_STATUS_COMMON_NAME_INVALID;
+      return ERR_CERT_COMMON_NAME_INVALID;
+    }
+    return OK;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SlowCertVerifyProc);
+};
+
+class MultiThreadedCertVerifierPerfTest : public testing::Test {
+ public:
+  MultiThreadedCertVerifierPerfTest()
+      : message_loop_(new base::MessageLoopForIO()) {}
+
+  virtual void SetUp() OVERRIDE {
+    cert_ = ImportCertFromFile(GetTestCertsDirectory(), "ok_cert.pem");
+    ASSERT_TRUE(cert_.get());
+    for (int i = 0; i < kNumHostnames; ++i)
+      hostnames_.push_back(base::StringPrintf("host%d.example.com", i));
+  }
+
+ protected:
+  // Verifies |cert_| for all of |hostnames_| at once, like a page with many
+  // subresource hosts behind a shared certificate.
+  void VerifyConcurrently(MultiThreadedCertVerifier* verifier) {
+    ScopedVector<TestCompletionCallback> callbacks;
+    std::vector<CertVerifyResult> results(hostnames_.size());
+    std::vector<int> rvs;
+    for (size_t i = 0; i < hostnames_.size(); ++i) {
+      callbacks.push_back(new TestCompletionCallback());
+      CertVerifier::RequestHandle request_handle;
+      rvs.push_back(verifier->Verify(cert_.get(), hostnames_[i], 0, NULL,
+                                     &results[i], callbacks[i]->callback(),
+                                     &request_handle, BoundNetLog()));
+    }
+    for (size_t i = 0; i < hostnames_.size(); ++i)
+      EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, callbacks[i]->GetResult(rvs[i]));
+  }
+
+  // Verifies |cert_| for one hostname after the other.
+  void VerifySequentially(MultiThreadedCertVerifier* verifier) {
+    for (size_t i = 0; i < hostnames_.size(); ++i) {
+      CertVerifyResult result;
+      TestCompletionCallback callback;
+      CertVerifier::RequestHandle request_handle;
+      int rv = verifier->Verify(cert_.get(), hostnames_[i], 0, NULL, &result,
+                                callback.callback(), &request_handle,
+                                BoundNetLog());
+      EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, callback.GetResult(rv));
+    }
+  }
+
+  scoped_ptr<base::MessageLoop> message_loop_;
+  scoped_refptr<X509Certificate> cert_;
+  std::vector<std::string> hostnames_;
+};
+
+TEST_F(MultiThreadedCertVerifierPerfTest, SharedChainConcurrent) {
+  base::PerfTimeLogger timer("Cert_Verifier_Shared_Chain_Concurrent");
+  for (int i = 0; i < kIterations; ++i) {
+    MultiThreadedCertVerifier verifier(new SlowCertVerifyProc());
+    VerifyConcurrently(&verifier);
+  }
+  timer.Done();
+}
+
+TEST_F(MultiThreadedCertVerifierPerfTest, SharedChainSequential) {
+  base::PerfTimeLogger timer("Cert_Verifier_Shared_Chain_Sequential");
+  for (int i = 0; i < kIterations; ++i) {
+    MultiThreadedCertVerifier verifier(new SlowCertVerifyProc());
+    VerifySequentially(&verifier);
+  }
+  timer.Done();
+}
+
+TEST_F(MultiThreadedCertVerifierPerfTest, CacheHits) {
+  MultiThreadedCertVerifier verifier(new SlowCertVerifyProc());
+  VerifySequentially(&verifier);
+
+  base::PerfTimeLogger timer("Cert_Verifier_Cache_Hits");
+  for (int i = 0; i < kIterations * 100; ++i)
+    VerifySequentially(&verifier);
+  timer.Done();
+}
+
+}  // namespace
+
+}  // namespace net
@@ -482,4 +482,155 @@ TEST_F(MultiThreadedCertVerifierTest, CertTrustAnchorProvider) {
   ASSERT_EQ(1u, verifier_.cache_hits());
 }
 
+// Tests that a certificate chain which was verified for one hostname is only
+// checked against the name for other hostnames.
+TEST_F(MultiThreadedCertVerifierTest, ChainCacheHit) {
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(GetTestCertsDirectory(), "ok_cert.pem"));
+  ASSERT_TRUE(test_cert.get());
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  CertVerifier::RequestHandle request_handle;
+
+  error = verifier_.Verify(test_cert.get(),
+                           "www.example.com",
+                           0,
+                           NULL,
+                           &verify_result,
+                           callback.callback(),
+                           &request_handle,
+                           BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, error);
+
+  // A name that the certificate doesn't match either.
+  error = verifier_.Verify(test_cert.get(),
+                           "www2.example.com",
+                           0,
+                           NULL,
+                           &verify_result,
+                           callback.callback(),
+                           &request_handle,
+                           BoundNetLog());
+  EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, error);
+  EXPECT_FALSE(request_handle);
+  EXPECT_TRUE(verify_result.cert_status & CERT_STATUS_COMMON_NAME_INVALID);
+
+  // The name of the certificate.
+  error = verifier_.Verify(test_cert.get(),
+                           "127.0.0.1",
+                           0,
+                           NULL,
+                           &verify_result,
+                           callback.callback(),
+                           &request_handle,
+                           BoundNetLog());
+  EXPECT_EQ(OK, error);
+  EXPECT_FALSE(request_handle);
+  EXPECT_FALSE(verify_result.cert_status & CERT_STATUS_COMMON_NAME_INVALID);
+  EXPECT_EQ(test_cert.get(), verify_result.verified_cert.get());
+
+  ASSERT_EQ(3u, verifier_.requests());
+  ASSERT_EQ(0u, verifier_.cache_hits());
+  ASSERT_EQ(2u, verifier_.chain_cache_hits());
+  ASSERT_EQ(1u, verifier_.GetCacheSize());
+
+  // Different flags are a different chain verification.
+  error = verifier_.Verify(test_cert.get(),
+                           "127.0.0.1",
+                           CertVerifier::VERIFY_EV_CERT,
+                           NULL,
+                           &verify_result,
+                           callback.callback(),
+                           &request_handle,
+                           BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, error);
+  ASSERT_EQ(2u, verifier_.chain_cache_hits());
+}
+
+// Tests that verifications beyond the concurrency limit wait for the running
+// one, and are then answered from the chain cache.
+TEST_F(MultiThreadedCertVerifierTest, QueuedJobUsesChainCache) {
+  verifier_.set_max_concurrent_jobs(1);
+
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(GetTestCertsDirectory(), "ok_cert.pem"));
+  ASSERT_TRUE(test_cert.get());
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  CertVerifier::RequestHandle request_handle;
+  CertVerifyResult verify_result2;
+  TestCompletionCallback callback2;
+  CertVerifier::RequestHandle request_handle2;
+
+  error = verifier_.Verify(test_cert.get(),
+                           "www.example.com",
+                           0,
+                           NULL,
+                           &verify_result,
+                           callback.callback(),
+                           &request_handle,
+                           BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = verifier_.Verify(test_cert.get(),
+                           "127.0.0.1",
+                           0,
+                           NULL,
+                           &verify_result2,
+                           callback2.callback(),
+                           &request_handle2,
+                           BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  EXPECT_TRUE(request_handle2);
+
+  error = callback.WaitForResult();
+  EXPECT_EQ(ERR_CERT_COMMON_NAME_INVALID, error);
+  error = callback2.WaitForResult();
+  EXPECT_EQ(OK, error);
+  EXPECT_FALSE(verify_result2.cert_status & CERT_STATUS_COMMON_NAME_INVALID);
+  ASSERT_EQ(2u, verifier_.requests());
+  ASSERT_EQ(1u, verifier_.chain_cache_hits());
+  ASSERT_EQ(0u, verifier_.inflight_joins());
+}
+
+// Tests that queued verifications are not leaked when the verifier is
+// deleted.
+#if !defined(LEAK_SANITIZER)
+#define MAYBE_CancelQueuedRequestThenQuit CancelQueuedRequestThenQuit
+#else
+// See PR303886. LeakSanitizer flags a leak here.
+#define MAYBE_CancelQueuedRequestThenQuit DISABLED_CancelQueuedRequestThenQuit
+#endif
+TEST_F(MultiThreadedCertVerifierTest, MAYBE_CancelQueuedRequestThenQuit) {
+  verifier_.set_max_concurrent_jobs(1);
+
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(GetTestCertsDirectory(), "ok_cert.pem"));
+  ASSERT_TRUE(test_cert.get());
+
+  CertVerifyResult verify_result;
+  const char* const kHostnames[] = { "www.example.com", "www2.example.com" };
+  for (size_t i = 0; i < arraysize(kHostnames); ++i) {
+    CertVerifier::RequestHandle request_handle;
+    int error = verifier_.Verify(test_cert.get(),
+                                 kHostnames[i],
+                                 0,
+                                 NULL,
+                                 &verify_result,
+                                 base::Bind(&FailTest),
+                                 &request_handle,
+                                 BoundNetLog());
+    ASSERT_EQ(ERR_IO_PENDING, error);
+    verifier_.CancelRequest(request_handle);
+  }
+  // Destroy |verifier| by going out of scope.
+}
+
 }  // namespace net
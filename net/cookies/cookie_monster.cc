@@ -1152,9 +1152,9 @@ CookieList CookieMonster::GetAllCookiesForURLWithOptions(
     const CookieOptions& options) {
   base::AutoLock autolock(lock_);
 
+  // The cookies come back in CookieSorter order; see InternalInsertCookie().
   std::vector<CanonicalCookie*> cookie_ptrs;
   FindCookiesForHostAndDomain(url, options, false, &cookie_ptrs);
-  std::sort(cookie_ptrs.begin(), cookie_ptrs.end(), CookieSorter);
 
   CookieList cookies;
   for (std::vector<CanonicalCookie*>::const_iterator it = cookie_ptrs.begin();
@@ -1316,9 +1316,9 @@ std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
 
   TimeTicks start_time(TimeTicks::Now());
 
+  // The cookies come back in CookieSorter order; see InternalInsertCookie().
   std::vector<CanonicalCookie*> cookies;
   FindCookiesForHostAndDomain(url, options, true, &cookies);
-  std::sort(cookies.begin(), cookies.end(), CookieSorter);
 
   std::string cookie_line = BuildCookieLine(cookies);
 
@@ -1766,8 +1766,14 @@ CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
   if ((cc->IsPersistent() || persist_session_cookies_) && store_.get() &&
       sync_to_store)
     store_->AddCookie(*cc);
+  // Insert before the first cookie for |key| that sorts after |cc|, so that
+  // the cookies for each key stay in CookieSorter order.  Inserting with a
+  // hint places an equivalent key immediately before the hint.
+  CookieMapItPair its = cookies_.equal_range(key);
+  while (its.first != its.second && !CookieSorter(cc, its.first->second))
+    ++its.first;
   CookieMap::iterator inserted =
-      cookies_.insert(CookieMap::value_type(key, cc));
+      cookies_.insert(its.first, CookieMap::value_type(key, cc));
   if (delegate_.get()) {
     delegate_->OnCookieChanged(
         *cc, false, CookieMonsterDelegate::CHANGE_COOKIE_EXPLICIT);
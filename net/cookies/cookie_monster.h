@@ -95,6 +95,10 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // not legal to have domain cookies without an eTLD+1).  This rule
   // excludes cookies for, e.g, ".com", ".co.uk", or ".internalnetwork".
   // This behavior is the same as the behavior in Firefox v 3.6.10.
+  //
+  // The cookies under each key are kept in the order they are sent in a
+  // Cookie header: longest path first, then oldest first.  Since all the
+  // cookies for a URL share one key, lookups return them already sorted.
 
   // NOTE(deanm):
   // I benchmarked hash_multimap vs multimap.  We're going to be query-heavy
@@ -523,6 +527,7 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   // Takes ownership of *cc. Returns an iterator that points to the inserted
   // cookie in cookies_. Guarantee: all iterators to cookies_ remain valid.
+  // |cc| is inserted at its sorted position among the cookies for |key|.
   CookieMap::iterator InternalInsertCookie(const std::string& key,
                                            CanonicalCookie* cc,
                                            bool sync_to_store);
@@ -9,6 +9,7 @@
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/test/perf_time_logger.h"
+#include "base/threading/thread.h"
 #include "net/cookies/canonical_cookie.h"
 #include "net/cookies/cookie_monster.h"
 #include "net/cookies/cookie_monster_store_test.h"
@@ -21,6 +22,7 @@ namespace net {
 namespace {
 
 const int kNumCookies = 20000;
+const int kNumDomains = 10000;
 const char kCookieLine[] = "A  = \"b=;\\\"\"  ;secure;;;";
 const char kGoogleURL[] = "http://www.google.izzle";
 
@@ -93,6 +95,35 @@ class GetCookiesCallback : public BaseCallback {
   net::CookieOptions options_;
 };
 
+// Reads cookies synchronously on its own thread, the way callers outside the
+// IO thread do, to contend for the CookieMonster's lock.
+class ConcurrentReader {
+ public:
+  ConcurrentReader(CookieMonster* cm, const std::vector<GURL>& gurls)
+      : cm_(cm), gurls_(gurls), num_cookies_(0) {}
+
+  void ReadAll(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      for (std::vector<GURL>::const_iterator it = gurls_.begin();
+           it != gurls_.end(); ++it) {
+        cm_->GetAllCookiesForURLAsync(*it, base::Bind(
+            &ConcurrentReader::Run, base::Unretained(this)));
+      }
+    }
+  }
+
+  size_t num_cookies() const { return num_cookies_; }
+
+ private:
+  void Run(const CookieList& cookies) {
+    num_cookies_ += cookies.size();
+  }
+
+  CookieMonster* cm_;
+  const std::vector<GURL>& gurls_;
+  size_t num_cookies_;
+};
+
 }  // namespace
 
 TEST(ParsedCookieTest, TestParseCookies) {
@@ -182,6 +213,55 @@ TEST_F(CookieMonsterTest, TestAddCookieOnManyHosts) {
   timer3.Done();
 }
 
+// Queries a store holding a few cookies with different paths on each of
+// |kNumDomains| domains, first alone and then while another thread reads the
+// same cookies.
+TEST_F(CookieMonsterTest, TestQueryManyDomains) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  std::vector<GURL> gurls;
+  for (int i = 0; i < kNumDomains; ++i) {
+    gurls.push_back(
+        GURL(base::StringPrintf("https://www.a%05d.izzle/aa/bb/cc", i)));
+  }
+
+  SetCookieCallback setCookieCallback;
+  base::PerfTimeLogger timer("Cookie_monster_add_many_domains");
+  for (std::vector<GURL>::const_iterator it = gurls.begin();
+       it != gurls.end(); ++it) {
+    setCookieCallback.SetCookie(cm.get(), *it, "a=1; path=/");
+    setCookieCallback.SetCookie(cm.get(), *it, "b=1; path=/aa/bb");
+    setCookieCallback.SetCookie(cm.get(), *it, "c=1; path=/aa");
+  }
+  timer.Done();
+
+  GetCookiesCallback getCookiesCallback;
+  EXPECT_EQ("b=1; c=1; a=1", getCookiesCallback.GetCookies(cm.get(), gurls[0]));
+
+  base::PerfTimeLogger timer2("Cookie_monster_query_many_domains");
+  for (std::vector<GURL>::const_iterator it = gurls.begin();
+       it != gurls.end(); ++it) {
+    getCookiesCallback.GetCookies(cm.get(), *it);
+  }
+  timer2.Done();
+
+  base::Thread reader_thread("Cookie reader");
+  ASSERT_TRUE(reader_thread.Start());
+  ConcurrentReader reader(cm.get(), gurls);
+  reader_thread.message_loop_proxy()->PostTask(
+      FROM_HERE,
+      base::Bind(&ConcurrentReader::ReadAll, base::Unretained(&reader), 10));
+
+  base::PerfTimeLogger timer3("Cookie_monster_query_many_domains_concurrent");
+  for (std::vector<GURL>::const_iterator it = gurls.begin();
+       it != gurls.end(); ++it) {
+    getCookiesCallback.GetCookies(cm.get(), *it);
+  }
+  timer3.Done();
+
+  reader_thread.Stop();
+  EXPECT_EQ(30u * kNumDomains, reader.num_cookies());
+}
+
 TEST_F(CookieMonsterTest, TestDomainTree) {
   scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
   GetCookiesCallback getCookiesCallback;
@@ -2041,6 +2041,43 @@ TEST_F(CookieMonsterTest, CookieListOrdering) {
   }
 }
 
+// Cookies loaded from the backing store in no particular order must still
+// be returned longest path first, then oldest first.
+TEST_F(CookieMonsterTest, CookieOrderingAfterLoad) {
+  scoped_refptr<MockPersistentCookieStore> store(
+      new MockPersistentCookieStore);
+
+  Time now(Time::Now());
+  std::vector<CanonicalCookie*> initial_cookies;
+  AddCookieToList("www.google.com", "a=1; path=/", now, &initial_cookies);
+  AddCookieToList("www.google.com", "b=1; path=/aa/bb",
+                  now - TimeDelta::FromMinutes(1), &initial_cookies);
+  AddCookieToList("www.google.com", "c=1; path=/",
+                  now - TimeDelta::FromMinutes(2), &initial_cookies);
+  AddCookieToList("www.google.com", "d=1; path=/aa",
+                  now - TimeDelta::FromMinutes(3), &initial_cookies);
+  AddCookieToList("www.google.com", "e=1; path=/aa/bb",
+                  now - TimeDelta::FromMinutes(4), &initial_cookies);
+  store->SetLoadExpectation(true, initial_cookies);
+
+  scoped_refptr<CookieMonster> cm(new CookieMonster(store.get(), NULL));
+  EXPECT_EQ("e=1; b=1; d=1; c=1; a=1",
+            GetCookies(cm.get(), GURL("http://www.google.com/aa/bb/cc")));
+
+  // A cookie set later is placed among the loaded ones.
+  EXPECT_TRUE(SetCookie(cm.get(), GURL("http://www.google.com/"),
+                        "f=1; path=/aa"));
+  EXPECT_EQ("e=1; b=1; d=1; f=1; c=1; a=1",
+            GetCookies(cm.get(), GURL("http://www.google.com/aa/bb/cc")));
+  CookieList cookies(GetAllCookiesForURL(
+      cm.get(), GURL("http://www.google.com/aa/x.html")));
+  ASSERT_EQ(4u, cookies.size());
+  EXPECT_EQ("d", cookies[0].Name());
+  EXPECT_EQ("f", cookies[1].Name());
+  EXPECT_EQ("c", cookies[2].Name());
+  EXPECT_EQ("a", cookies[3].Name());
+}
+
 // This test and CookieMonstertest.TestGCTimes (in cookie_monster_perftest.cc)
 // are somewhat complementary twins.  This test is probing for whether
 // garbage collection always happens when it should (i.e. that we actually
@@ -195,6 +195,7 @@ int BackendImpl::SyncInit() {
   if (init_)
     return net::ERR_FAILED;
 
+  TimeTicks start = TimeTicks::Now();
   bool create_files = false;
   if (!InitBackingStore(&create_files)) {
     ReportError(ERR_STORAGE_ERROR);
@@ -293,6 +294,7 @@ int BackendImpl::SyncInit() {
                   &BackendImpl::OnStatsTimer);
   }
 
+  cache_stats_.index_load_time = TimeTicks::Now() - start;
   return disabled_ ? net::ERR_FAILED : net::OK;
 }
 
@@ -491,6 +493,8 @@ EntryImpl* BackendImpl::OpenEntryImpl(const std::string& key) {
     CACHE_UMA(HOURS, "AllOpenByTotalHours.Miss", 0, total_hours);
     CACHE_UMA(HOURS, "AllOpenByUseHours.Miss", 0, use_hours);
     stats_.OnEvent(Stats::OPEN_MISS);
+    cache_stats_.open_misses++;
+    cache_stats_.latency[CacheStats::OPEN].AddSample(TimeTicks::Now() - start);
     return NULL;
   }
 
@@ -504,6 +508,8 @@ EntryImpl* BackendImpl::OpenEntryImpl(const std::string& key) {
   CACHE_UMA(HOURS, "AllOpenByTotalHours.Hit", 0, total_hours);
   CACHE_UMA(HOURS, "AllOpenByUseHours.Hit", 0, use_hours);
   stats_.OnEvent(Stats::OPEN_HIT);
+  cache_stats_.open_hits++;
+  cache_stats_.latency[CacheStats::OPEN].AddSample(TimeTicks::Now() - start);
   SIMPLE_STATS_COUNTER("disk_cache.hit");
   return cache_entry;
 }
@@ -600,6 +606,7 @@ EntryImpl* BackendImpl::CreateEntryImpl(const std::string& key) {
 
   CACHE_UMA(AGE_MS, "CreateTime", 0, start);
   stats_.OnEvent(Stats::CREATE_HIT);
+  cache_stats_.latency[CacheStats::CREATE].AddSample(TimeTicks::Now() - start);
   SIMPLE_STATS_COUNTER("disk_cache.miss");
   Trace("create entry hit ");
   FlushIndex();
@@ -1234,6 +1241,14 @@ void BackendImpl::GetStats(StatsItems* stats) {
   stats_.GetItems(stats);
 }
 
+void BackendImpl::GetCacheStats(CacheStats* stats) {
+  if (disabled_)
+    return;
+
+  *stats = cache_stats_;
+  stats_.GetSizeDistribution(stats);
+}
+
 void BackendImpl::OnExternalCacheHit(const std::string& key) {
   background_queue_.OnExternalCacheHit(key);
 }
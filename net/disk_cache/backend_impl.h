@@ -11,6 +11,7 @@
 #include "base/files/file_path.h"
 #include "base/timer/timer.h"
 #include "net/disk_cache/block_files.h"
+#include "net/disk_cache/cache_stats.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/eviction.h"
 #include "net/disk_cache/in_flight_backend_io.h"
@@ -208,6 +209,9 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   void OnRead(int bytes);
   void OnWrite(int bytes);
 
+  // Structured statistics, see GetCacheStats().
+  CacheStats* cache_stats() { return &cache_stats_; }
+
   // Timer callback to calculate usage statistics.
   void OnStatsTimer();
 
@@ -275,6 +279,9 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
                             const CompletionCallback& callback) OVERRIDE;
   virtual void EndEnumeration(void** iter) OVERRIDE;
   virtual void GetStats(StatsItems* stats) OVERRIDE;
+  // The size distribution counts every stream as an entry, and its bytes are
+  // a lower bound.
+  virtual void GetCacheStats(CacheStats* stats) OVERRIDE;
   virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
 
  private:
@@ -387,6 +394,7 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   net::NetLog* net_log_;
 
   Stats stats_;  // Usage statistics.
+  CacheStats cache_stats_;
   scoped_ptr<base::RepeatingTimer<BackendImpl> > timer_;  // Usage timer.
   base::WaitableEvent done_;  // Signals the end of background work.
   scoped_refptr<TraceObject> trace_object_;  // Initializes internal tracing.
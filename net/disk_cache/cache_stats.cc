@@ -0,0 +1,160 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/cache_stats.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+
+namespace {
+
+const char* const kOperationNames[] = {
+  "Open",
+  "Create",
+  "Read",
+  "Write",
+};
+
+// Returns the index of the most significant bit of |value| plus one, or zero.
+int GetLog2Bucket(int64 value) {
+  int bucket = 0;
+  while (value > 0) {
+    bucket++;
+    value >>= 1;
+  }
+  return bucket;
+}
+
+void AddItem(const std::string& name,
+             const std::string& value,
+             std::vector<std::pair<std::string, std::string> >* items) {
+  items->push_back(std::make_pair(name, value));
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+LatencyHistogram::LatencyHistogram() : count_(0) {
+  memset(counts_, 0, sizeof(counts_));
+}
+
+void LatencyHistogram::AddSample(base::TimeDelta latency) {
+  int bucket = GetLog2Bucket(latency.InMicroseconds());
+  counts_[std::min(bucket, kNumBuckets - 1)]++;
+  count_++;
+}
+
+base::TimeDelta LatencyHistogram::GetPercentile(int percentile) const {
+  DCHECK(percentile >= 0 && percentile <= 100);
+  if (!count_)
+    return base::TimeDelta();
+
+  // The smallest number of samples that make up |percentile| percent.
+  const int64 target = std::max<int64>(1, (count_ * percentile + 99) / 100);
+  int64 seen = 0;
+  int bucket = 0;
+  for (; bucket < kNumBuckets - 1; ++bucket) {
+    seen += counts_[bucket];
+    if (seen >= target)
+      break;
+  }
+  return base::TimeDelta::FromMicroseconds(GG_INT64_C(1) << bucket);
+}
+
+CacheStats::CacheStats()
+    : open_hits(0),
+      open_misses(0),
+      evicted_entries(0),
+      evicted_bytes(0) {
+  COMPILE_ASSERT(arraysize(kOperationNames) == MAX_OPERATION,
+                 names_for_all_operations);
+  memset(read_hits, 0, sizeof(read_hits));
+  memset(read_misses, 0, sizeof(read_misses));
+  memset(entries_by_size, 0, sizeof(entries_by_size));
+  memset(bytes_by_size, 0, sizeof(bytes_by_size));
+}
+
+CacheStats::~CacheStats() {
+}
+
+// static
+int CacheStats::GetSizeBucket(int64 size) {
+  return std::min(GetLog2Bucket(size / 1024), kNumSizeBuckets - 1);
+}
+
+// static
+int64 CacheStats::GetSizeBucketMinSize(int bucket) {
+  DCHECK(bucket >= 0 && bucket < kNumSizeBuckets);
+  return bucket ? (GG_INT64_C(1024) << (bucket - 1)) : 0;
+}
+
+void CacheStats::RecordRead(int stream, int result) {
+  if (stream < 0 || stream >= kNumStreams || result < 0)
+    return;
+  if (result)
+    read_hits[stream]++;
+  else
+    read_misses[stream]++;
+}
+
+void CacheStats::AddEntries(int64 size, int64 count) {
+  const int bucket = GetSizeBucket(size);
+  entries_by_size[bucket] += count;
+  bytes_by_size[bucket] += size * count;
+}
+
+void CacheStats::GetItems(
+    std::vector<std::pair<std::string, std::string> >* items) const {
+  AddItem("Open hits", base::Int64ToString(open_hits), items);
+  AddItem("Open misses", base::Int64ToString(open_misses), items);
+  for (int i = 0; i < kNumStreams; ++i) {
+    AddItem(base::StringPrintf("Stream %d read hits", i),
+            base::Int64ToString(read_hits[i]), items);
+    AddItem(base::StringPrintf("Stream %d read misses", i),
+            base::Int64ToString(read_misses[i]), items);
+  }
+
+  for (int i = 0; i < MAX_OPERATION; ++i) {
+    const LatencyHistogram& histogram = latency[i];
+    AddItem(base::StringPrintf("%s count", kOperationNames[i]),
+            base::Int64ToString(histogram.count()), items);
+    AddItem(base::StringPrintf("%s latency p50/p90/p99 (us)",
+                               kOperationNames[i]),
+            base::Int64ToString(histogram.GetPercentile(50).InMicroseconds()) +
+                "/" +
+                base::Int64ToString(
+                    histogram.GetPercentile(90).InMicroseconds()) +
+                "/" +
+                base::Int64ToString(
+                    histogram.GetPercentile(99).InMicroseconds()),
+            items);
+  }
+
+  AddItem("Index load time (ms)",
+          base::Int64ToString(index_load_time.InMilliseconds()), items);
+
+  AddItem("Evicted entries", base::Int64ToString(evicted_entries), items);
+  AddItem("Evicted bytes", base::Int64ToString(evicted_bytes), items);
+  const int64 eviction_ms = eviction_time.InMilliseconds();
+  AddItem("Eviction throughput (KB/s)",
+          base::Int64ToString(
+              eviction_ms ? evicted_bytes * 1000 / 1024 / eviction_ms : 0),
+          items);
+
+  for (int i = 0; i < kNumSizeBuckets; ++i) {
+    if (!entries_by_size[i])
+      continue;
+    AddItem("Entries from " +
+                base::Int64ToString(GetSizeBucketMinSize(i) / 1024) + " KB",
+            base::Int64ToString(entries_by_size[i]) + " (" +
+                base::Int64ToString(bytes_by_size[i]) + " bytes)",
+            items);
+  }
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,97 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_CACHE_STATS_H_
+#define NET_DISK_CACHE_CACHE_STATS_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// Distribution of the latency of an operation.  Samples are kept in
+// exponential buckets, so recording one is cheap.
+class NET_EXPORT LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void AddSample(base::TimeDelta latency);
+
+  int64 count() const { return count_; }
+
+  // Returns an upper bound of the |percentile|th percentile of the samples,
+  // which is at most twice the actual value, or zero if there are no samples.
+  base::TimeDelta GetPercentile(int percentile) const;
+
+ private:
+  // Bucket 0 holds samples under a microsecond, bucket i holds samples in
+  // [2^(i-1), 2^i) microseconds and the last bucket everything longer.
+  static const int kNumBuckets = 32;
+
+  int64 counts_[kNumBuckets];
+  int64 count_;
+};
+
+// Structured statistics of a backend, see Backend::GetCacheStats().  Unless
+// noted, everything is counted since the backend was created.
+struct NET_EXPORT CacheStats {
+  enum Operation {
+    OPEN,
+    CREATE,
+    READ,
+    WRITE,
+    MAX_OPERATION
+  };
+
+  static const int kNumStreams = 3;
+
+  // Bucket 0 holds entries under 1 KB, bucket i holds entries in
+  // [2^(i-1), 2^i) KB and the last bucket everything larger.
+  static const int kNumSizeBuckets = 16;
+
+  CacheStats();
+  ~CacheStats();
+
+  static int GetSizeBucket(int64 size);
+
+  // Returns the smallest entry size held by |bucket|.
+  static int64 GetSizeBucketMinSize(int bucket);
+
+  // Records a read from |stream| that returned |result|.  A read that returns
+  // no data counts as a miss.
+  void RecordRead(int stream, int result);
+
+  // Adds |count| entries of |size| bytes to the size distribution.
+  void AddEntries(int64 size, int64 count);
+
+  // Appends a human readable version of the stats to |items|.
+  void GetItems(std::vector<std::pair<std::string, std::string> >* items) const;
+
+  int64 open_hits;
+  int64 open_misses;
+  int64 read_hits[kNumStreams];
+  int64 read_misses[kNumStreams];
+
+  LatencyHistogram latency[MAX_OPERATION];
+
+  // Time it took to load the index of the backend.
+  base::TimeDelta index_load_time;
+
+  int64 evicted_entries;
+  int64 evicted_bytes;
+  base::TimeDelta eviction_time;
+
+  // The entries currently stored, and the bytes they use, by entry size.
+  int64 entries_by_size[kNumSizeBuckets];
+  int64 bytes_by_size[kNumSizeBuckets];
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_CACHE_STATS_H_
@@ -0,0 +1,55 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/cache_stats.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+
+TEST(DiskCacheStatsTest, LatencyPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.GetPercentile(50).InMicroseconds());
+
+  for (int i = 0; i < 90; ++i)
+    histogram.AddSample(base::TimeDelta::FromMicroseconds(100));
+  for (int i = 0; i < 10; ++i)
+    histogram.AddSample(base::TimeDelta::FromMilliseconds(100));
+  EXPECT_EQ(100, histogram.count());
+
+  // The percentiles are rounded up to the next power of two.
+  EXPECT_EQ(128, histogram.GetPercentile(50).InMicroseconds());
+  EXPECT_EQ(128, histogram.GetPercentile(90).InMicroseconds());
+  EXPECT_EQ(131072, histogram.GetPercentile(99).InMicroseconds());
+}
+
+TEST(DiskCacheStatsTest, SizeBuckets) {
+  EXPECT_EQ(0, CacheStats::GetSizeBucket(0));
+  EXPECT_EQ(0, CacheStats::GetSizeBucket(1023));
+  EXPECT_EQ(1, CacheStats::GetSizeBucket(1024));
+  EXPECT_EQ(2, CacheStats::GetSizeBucket(2048));
+  EXPECT_EQ(CacheStats::kNumSizeBuckets - 1,
+            CacheStats::GetSizeBucket(GG_INT64_C(1) << 40));
+
+  for (int i = 0; i < CacheStats::kNumSizeBuckets; ++i) {
+    EXPECT_EQ(i, CacheStats::GetSizeBucket(
+                     CacheStats::GetSizeBucketMinSize(i)));
+  }
+
+  CacheStats stats;
+  stats.AddEntries(3000, 2);
+  EXPECT_EQ(2, stats.entries_by_size[2]);
+  EXPECT_EQ(6000, stats.bytes_by_size[2]);
+}
+
+TEST(DiskCacheStatsTest, ReadHitsAndMisses) {
+  CacheStats stats;
+  stats.RecordRead(1, 10);
+  stats.RecordRead(1, 0);
+  stats.RecordRead(1, -2);
+  EXPECT_EQ(1, stats.read_hits[1]);
+  EXPECT_EQ(1, stats.read_misses[1]);
+}
+
+}  // namespace disk_cache
@@ -31,6 +31,7 @@ namespace disk_cache {
 
 class Entry;
 class Backend;
+struct CacheStats;
 
 // Returns an instance of a Backend of the given |type|. |path| points to a
 // folder where the cached data will be stored (if appropriate). This cache
@@ -149,6 +150,10 @@ class NET_EXPORT Backend {
   virtual void GetStats(
       std::vector<std::pair<std::string, std::string> >* stats) = 0;
 
+  // Fills |stats| with structured statistics about the cache. Backends that
+  // don't keep them leave |stats| untouched.
+  virtual void GetCacheStats(CacheStats* stats) {}
+
   // Called whenever an external cache in the system reuses the resource
   // referred to by |key|.
   virtual void OnExternalCacheHit(const std::string& key) = 0;
@@ -189,6 +194,10 @@ class NET_EXPORT Entry {
   // after Close has been called; in other words, the caller may close this
   // entry without having to wait for all the callbacks, and still rely on the
   // cleanup performed from the callback code.
+  //
+  // The data is read straight into |buf|, so callers should pass the buffer
+  // the data is ultimately destined for instead of copying it out of an
+  // intermediate buffer.
   virtual int ReadData(int index, int offset, IOBuffer* buf, int buf_len,
                        const CompletionCallback& callback) = 0;
 
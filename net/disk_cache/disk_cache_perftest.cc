@@ -2,7 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
@@ -22,6 +25,9 @@
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/disk_cache_test_base.h"
 #include "net/disk_cache/disk_cache_test_util.h"
+#include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_index_delegate.h"
+#include "net/disk_cache/simple/simple_index_file.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -144,6 +150,90 @@ int BlockSize() {
   return (rand() & 0x3) + 1;
 }
 
+// An index file that loads |num_entries| synthetic entries, used over thirty
+// days, and never writes anything.
+class SyntheticSimpleIndexFile : public disk_cache::SimpleIndexFile {
+ public:
+  SyntheticSimpleIndexFile(int num_entries, int entry_size)
+      : disk_cache::SimpleIndexFile(NULL, NULL, net::DISK_CACHE,
+                                    base::FilePath(), NULL) {
+    const base::Time now = base::Time::Now();
+    for (int i = 0; i < num_entries; ++i) {
+      const base::Time last_used =
+          now - base::TimeDelta::FromSeconds(rand() % (30 * 24 * 3600));
+      disk_cache::SimpleIndex::InsertInEntrySet(
+          (static_cast<uint64>(rand()) << 32) ^ rand() ^ i,
+          disk_cache::EntryMetadata(last_used, entry_size),
+          &entries_);
+    }
+  }
+
+  const disk_cache::SimpleIndex::EntrySet& entries() const { return entries_; }
+
+  virtual void LoadIndexEntries(
+      base::Time cache_last_modified,
+      const base::Closure& callback,
+      disk_cache::SimpleIndexLoadResult* out_result) OVERRIDE {
+    out_result->entries = entries_;
+    out_result->did_load = true;
+    callback.Run();
+  }
+
+  virtual void WriteToDisk(const disk_cache::SimpleIndex::EntrySet& entry_set,
+                           uint64 cache_size,
+                           const base::TimeTicks& start,
+                           bool app_on_background) OVERRIDE {}
+
+  virtual void AppendToJournal(
+      const disk_cache::SimpleIndex::EntrySet& updated_entries,
+      const disk_cache::SimpleIndex::HashList& removed_hashes,
+      const base::TimeTicks& start,
+      bool app_on_background) OVERRIDE {}
+
+ private:
+  disk_cache::SimpleIndex::EntrySet entries_;
+};
+
+// Picks the entries to evict from |entries| the way the simple index did
+// before it kept time buckets: by sorting all of them by last use.  Returns
+// the number of entries picked.
+size_t SelectEntriesToEvictBySorting(
+    const disk_cache::SimpleIndex::EntrySet& entries,
+    uint64 size_to_evict) {
+  std::vector<std::pair<base::Time, int> > candidates;
+  candidates.reserve(entries.size());
+  for (disk_cache::SimpleIndex::EntrySet::const_iterator it = entries.begin();
+       it != entries.end(); ++it) {
+    candidates.push_back(std::make_pair(it->second.GetLastUsedTime(),
+                                        it->second.GetEntrySize()));
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  size_t picked = 0;
+  uint64 picked_size = 0;
+  while (picked < candidates.size() && picked_size < size_to_evict)
+    picked_size += candidates[picked++].second;
+  return picked;
+}
+
+// Records the entries the index asks to doom, so that only picking them is
+// timed.
+class RecordingSimpleIndexDelegate : public disk_cache::SimpleIndexDelegate {
+ public:
+  RecordingSimpleIndexDelegate() {}
+
+  const std::vector<uint64>& doomed_hashes() const { return doomed_hashes_; }
+
+  virtual void DoomEntries(std::vector<uint64>* entry_hashes,
+                           const net::CompletionCallback& callback) OVERRIDE {
+    doomed_hashes_.insert(doomed_hashes_.end(), entry_hashes->begin(),
+                          entry_hashes->end());
+  }
+
+ private:
+  std::vector<uint64> doomed_hashes_;
+};
+
 }  // namespace
 
 TEST_F(DiskCacheTest, Hash) {
@@ -248,3 +338,60 @@ TEST_F(DiskCacheTest, BlockFilesPerformance) {
   base::MessageLoop::current()->RunUntilIdle();
   delete[] address;
 }
+
+// Measures how long the simple cache index takes to pick the entries to evict
+// once a large index crosses its high watermark. Selection only visits the
+// oldest time buckets, so it should not grow with the size of the index. The
+// same selection done by sorting the whole index is timed first, as a
+// baseline.
+TEST_F(DiskCacheTest, SimpleIndexEvictionPerformance) {
+  const int kNumEntries = 1000000;
+  const int kEntrySize = 100;
+  const int kGrownEntrySize = kEntrySize * 1000;
+
+  int seed = static_cast<int>(Time::Now().ToInternalValue());
+  srand(seed);
+
+  RecordingSimpleIndexDelegate delegate;
+  SyntheticSimpleIndexFile* synthetic_index_file =
+      new SyntheticSimpleIndexFile(kNumEntries, kEntrySize);
+  scoped_ptr<disk_cache::SimpleIndexFile> index_file(synthetic_index_file);
+
+  // Matches the low watermark of the index in simple_index.cc.
+  const uint64 max_size =
+      static_cast<uint64>(synthetic_index_file->entries().size()) * kEntrySize;
+  const uint64 low_watermark = max_size - 2 * (max_size / 20);
+  const uint64 size_to_evict = max_size - kEntrySize + kGrownEntrySize -
+                               low_watermark;
+  base::PerfTimeLogger sort_timer("Pick entries to evict from 1M by sorting "
+                                  "them all");
+  const size_t sorted_entries = SelectEntriesToEvictBySorting(
+      synthetic_index_file->entries(), size_to_evict);
+  sort_timer.Done();
+  EXPECT_LT(0U, sorted_entries);
+
+  disk_cache::SimpleIndex index(NULL, &delegate, net::DISK_CACHE,
+                                index_file.Pass());
+
+  base::PerfTimeLogger load_timer("Load 1M simple index entries");
+  index.Initialize(base::Time());
+  load_timer.Done();
+  ASSERT_TRUE(index.initialized());
+  const int entry_count = index.GetEntryCount();
+  ASSERT_TRUE(index.SetMaxSize(entry_count * kEntrySize));
+
+  // Growing any entry pushes the index over its high watermark.
+  scoped_ptr<disk_cache::SimpleIndex::HashList> hashes = index.GetAllHashes();
+  ASSERT_FALSE(hashes->empty());
+  base::PerfTimeLogger eviction_timer("Pick entries to evict from 1M by "
+                                      "time buckets");
+  index.UpdateEntrySize(hashes->front(), kGrownEntrySize);
+  eviction_timer.Done();
+
+  const std::vector<uint64>& doomed_hashes = delegate.doomed_hashes();
+  EXPECT_LT(0U, doomed_hashes.size());
+  for (size_t i = 0; i < doomed_hashes.size(); ++i)
+    index.Remove(doomed_hashes[i]);
+  EXPECT_GT(entry_count, index.GetEntryCount());
+  base::MessageLoop::current()->RunUntilIdle();
+}
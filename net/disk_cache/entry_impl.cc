@@ -698,9 +698,13 @@ void EntryImpl::ReportIOTime(Operation op, const base::TimeTicks& start) {
   switch (op) {
     case kRead:
       CACHE_UMA(AGE_MS, "ReadTime", 0, start);
+      backend_->cache_stats()->latency[CacheStats::READ].AddSample(
+          TimeTicks::Now() - start);
       break;
     case kWrite:
       CACHE_UMA(AGE_MS, "WriteTime", 0, start);
+      backend_->cache_stats()->latency[CacheStats::WRITE].AddSample(
+          TimeTicks::Now() - start);
       break;
     case kSparseRead:
       CACHE_UMA(AGE_MS, "SparseReadTime", 0, start);
@@ -979,8 +983,11 @@ int EntryImpl::InternalReadData(int index, int offset,
     return net::ERR_INVALID_ARGUMENT;
 
   int entry_size = entry_.Data()->data_size[index];
-  if (offset >= entry_size || offset < 0 || !buf_len)
+  if (offset >= entry_size || offset < 0 || !buf_len) {
+    if (backend_.get())
+      backend_->cache_stats()->RecordRead(index, 0);
     return 0;
+  }
 
   if (buf_len < 0)
     return net::ERR_INVALID_ARGUMENT;
@@ -997,6 +1004,7 @@ int EntryImpl::InternalReadData(int index, int offset,
 
   backend_->OnEvent(Stats::READ_DATA);
   backend_->OnRead(buf_len);
+  backend_->cache_stats()->RecordRead(index, buf_len);
 
   Addr address(entry_.Data()->data_addr[index]);
   int eof = address.is_initialized() ? entry_size : 0;
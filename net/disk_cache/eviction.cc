@@ -157,6 +157,7 @@ void Eviction::TrimCache(bool empty) {
     CACHE_UMA(AGE_MS, "TotalClearTimeV1", 0, start);
   } else {
     CACHE_UMA(AGE_MS, "TotalTrimTimeV1", 0, start);
+    backend_->cache_stats()->eviction_time += TimeTicks::Now() - start;
   }
   CACHE_UMA(COUNTS, "TrimItemsV1", 0, deleted_entries);
 
@@ -291,6 +292,12 @@ bool Eviction::EvictEntry(CacheRankingsBlock* node, bool empty,
   }
 
   ReportTrimTimes(entry);
+  if (!empty) {
+    CacheStats* stats = backend_->cache_stats();
+    stats->evicted_entries++;
+    for (int i = 0; i < CacheStats::kNumStreams; i++)
+      stats->evicted_bytes += entry->GetDataSize(i);
+  }
   if (empty || !new_eviction_) {
     entry->DoomImpl();
   } else {
@@ -389,6 +396,7 @@ void Eviction::TrimCacheV2(bool empty) {
     CACHE_UMA(AGE_MS, "TotalClearTimeV2", 0, start);
   } else {
     CACHE_UMA(AGE_MS, "TotalTrimTimeV2", 0, start);
+    backend_->cache_stats()->eviction_time += TimeTicks::Now() - start;
   }
   CACHE_UMA(COUNTS, "TrimItemsV2", 0, deleted_entries);
 
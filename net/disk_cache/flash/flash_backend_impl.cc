@@ -0,0 +1,396 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/flash/flash_backend_impl.h"
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/task_runner_util.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/flash/flash_entry_impl.h"
+#include "net/disk_cache/flash/internal_entry.h"
+#include "net/disk_cache/flash/log_store.h"
+
+namespace disk_cache {
+
+FlashBackendCore::FlashBackendCore(const base::FilePath& path,
+                                   int32 storage_size)
+    : store_(new LogStore(path, storage_size)),
+      init_(false),
+      closing_(false),
+      num_open_entries_(0) {
+}
+
+FlashBackendCore::~FlashBackendCore() {
+  DCHECK(!init_ || closing_);
+}
+
+scoped_ptr<std::vector<std::string> > FlashBackendCore::Init() {
+  DCHECK(!init_);
+  scoped_ptr<std::vector<std::string> > null;
+  std::vector<int32> ids;
+  if (!store_->Init())
+    return null.Pass();
+  init_ = true;
+  if (!store_->GetEntryIds(&ids))
+    return null.Pass();
+
+  // Later versions of an entry, and tombstones, override the earlier ones.
+  for (size_t i = 0; i < ids.size(); ++i) {
+    scoped_refptr<InternalEntry> entry(new InternalEntry(ids[i], store()));
+    scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes = entry->Init();
+    if (!key_and_stream_sizes)
+      continue;
+    if (!key_and_stream_sizes->key.empty()) {
+      Insert(key_and_stream_sizes->key, ids[i], 0);
+    } else {
+      int key_size = entry->GetDataSize(0);
+      scoped_refptr<net::IOBuffer> key_buf(new net::IOBuffer(key_size));
+      if (entry->ReadData(0, 0, key_buf.get(), key_size,
+                          net::CompletionCallback()) == key_size) {
+        Remove(std::string(key_buf->data(), key_size));
+      }
+    }
+    entry->Close();
+  }
+
+  scoped_ptr<std::vector<std::string> > keys(new std::vector<std::string>);
+  for (Index::const_iterator it = index_.begin(); it != index_.end(); ++it)
+    keys->push_back(it->first);
+  return keys.Pass();
+}
+
+void FlashBackendCore::Close() {
+  closing_ = true;
+  if (init_ && !num_open_entries_)
+    store_->Close();
+}
+
+scoped_refptr<InternalEntry> FlashBackendCore::OpenEntry(
+    const std::string& key) {
+  if (!init_ || closing_)
+    return NULL;
+  Index::const_iterator it = index_.find(key);
+  if (it == index_.end())
+    return NULL;
+
+  scoped_refptr<InternalEntry> entry(new InternalEntry(it->second.id,
+                                                       store()));
+  scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes = entry->Init();
+  if (!key_and_stream_sizes)
+    return NULL;
+  if (key_and_stream_sizes->key != key) {
+    entry->Close();
+    return NULL;
+  }
+  ++num_open_entries_;
+  return entry;
+}
+
+void FlashBackendCore::CloseEntry(scoped_refptr<InternalEntry> entry) {
+  DCHECK_GT(num_open_entries_, 0);
+  entry->Close();
+  if (!--num_open_entries_ && closing_)
+    store_->Close();
+}
+
+scoped_ptr<FlashLostEntries> FlashBackendCore::SaveEntry(
+    scoped_refptr<InternalEntry> entry,
+    const std::string& key,
+    int64 generation) {
+  scoped_ptr<FlashLostEntries> lost_entries(new FlashLostEntries);
+  if (!init_ || closing_) {
+    entry->Doom();
+    entry->Close();
+    return lost_entries.Pass();
+  }
+
+  if (entry->Close()) {
+    UpdateEvictedEntries(lost_entries.get());
+    Insert(key, entry->id(), generation);
+  } else {
+    UpdateEvictedEntries(lost_entries.get());
+    lost_entries->push_back(std::make_pair(key, generation));
+  }
+  return lost_entries.Pass();
+}
+
+scoped_ptr<FlashLostEntries> FlashBackendCore::DoomEntries(
+    scoped_ptr<std::vector<std::string> > keys) {
+  scoped_ptr<FlashLostEntries> lost_entries(new FlashLostEntries);
+  if (!init_ || closing_)
+    return lost_entries.Pass();
+
+  for (size_t i = 0; i < keys->size(); ++i) {
+    const std::string& key = (*keys)[i];
+    if (index_.find(key) == index_.end())
+      continue;
+    Remove(key);
+
+    scoped_refptr<InternalEntry> tombstone(new InternalEntry("", store()));
+    scoped_refptr<net::IOBuffer> key_buf(new net::StringIOBuffer(key));
+    int key_size = static_cast<int>(key.size());
+    if (tombstone->WriteData(0, 0, key_buf.get(), key_size,
+                             net::CompletionCallback(), true) != key_size) {
+      tombstone->Doom();
+    }
+    if (!tombstone->Close())
+      LOG(WARNING) << "Could not write tombstone in flash cache.";
+    UpdateEvictedEntries(lost_entries.get());
+  }
+  return lost_entries.Pass();
+}
+
+void FlashBackendCore::Insert(const std::string& key,
+                              int32 id,
+                              int64 generation) {
+  Remove(key);
+  index_[key] = IndexEntry(id, generation);
+  keys_by_id_[id] = key;
+}
+
+void FlashBackendCore::Remove(const std::string& key) {
+  Index::iterator it = index_.find(key);
+  if (it == index_.end())
+    return;
+  keys_by_id_.erase(it->second.id);
+  index_.erase(it);
+}
+
+void FlashBackendCore::UpdateEvictedEntries(FlashLostEntries* lost_entries) {
+  std::vector<int32> evicted_ids;
+  store_->TakeEvictedEntryIds(&evicted_ids);
+  for (size_t i = 0; i < evicted_ids.size(); ++i) {
+    std::map<int32, std::string>::iterator it =
+        keys_by_id_.find(evicted_ids[i]);
+    if (it == keys_by_id_.end())
+      continue;
+    const std::string key = it->second;
+    lost_entries->push_back(std::make_pair(key, index_[key].generation));
+    Remove(key);
+  }
+}
+
+FlashBackendImpl::Enumeration::Enumeration() : position(0) {
+}
+
+FlashBackendImpl::Enumeration::~Enumeration() {
+}
+
+FlashBackendImpl::FlashBackendImpl(const base::FilePath& path,
+                                   int32 storage_size,
+                                   base::MessageLoopProxy* cache_thread)
+    : cache_thread_(cache_thread),
+      core_(new FlashBackendCore(path, storage_size)),
+      init_(false),
+      last_generation_(0) {
+}
+
+FlashBackendImpl::~FlashBackendImpl() {
+  cache_thread_->PostTask(FROM_HERE,
+                          base::Bind(&FlashBackendCore::Close, core_));
+}
+
+int FlashBackendImpl::Init(const CompletionCallback& callback) {
+  DCHECK(!init_);
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&FlashBackendCore::Init, core_),
+      base::Bind(&FlashBackendImpl::OnInitComplete, AsWeakPtr(), callback));
+  return net::ERR_IO_PENDING;
+}
+
+int64 FlashBackendImpl::BeginSaveEntry(const std::string& key,
+                                       int64 generation) {
+  KeyMap::iterator it = keys_.find(key);
+  if (it == keys_.end() || it->second.generation != generation)
+    return -1;
+  it->second.generation = ++last_generation_;
+  return it->second.generation;
+}
+
+void FlashBackendImpl::OnEntriesLost(
+    scoped_ptr<FlashLostEntries> lost_entries) {
+  for (size_t i = 0; i < lost_entries->size(); ++i) {
+    const std::pair<std::string, int64>& lost_entry = (*lost_entries)[i];
+    KeyMap::iterator it = keys_.find(lost_entry.first);
+    if (it != keys_.end() && it->second.generation == lost_entry.second)
+      keys_.erase(it);
+  }
+}
+
+net::CacheType FlashBackendImpl::GetCacheType() const {
+  return net::DISK_CACHE;
+}
+
+int32 FlashBackendImpl::GetEntryCount() const {
+  return keys_.size();
+}
+
+int FlashBackendImpl::OpenEntry(const std::string& key, Entry** entry,
+                                const CompletionCallback& callback) {
+  DCHECK(init_);
+  KeyMap::iterator it = keys_.find(key);
+  if (it == keys_.end())
+    return net::ERR_FAILED;
+  it->second.last_used = base::Time::Now();
+
+  scoped_refptr<FlashEntryImpl> flash_entry(
+      new FlashEntryImpl(key, it->second.generation, AsWeakPtr(), core_.get(),
+                         cache_thread_.get()));
+  return flash_entry->Open(entry, callback);
+}
+
+int FlashBackendImpl::CreateEntry(const std::string& key, Entry** entry,
+                                  const CompletionCallback& callback) {
+  DCHECK(init_);
+  if (key.empty() || keys_.find(key) != keys_.end())
+    return net::ERR_FAILED;
+
+  KeyInfo& key_info = keys_[key];
+  key_info.generation = ++last_generation_;
+  key_info.last_used = base::Time::Now();
+  FlashEntryImpl* flash_entry =
+      new FlashEntryImpl(key, key_info.generation, AsWeakPtr(), core_.get(),
+                         cache_thread_.get());
+  flash_entry->AddRef();
+  flash_entry->Init();
+  *entry = flash_entry;
+  return net::OK;
+}
+
+int FlashBackendImpl::DoomEntry(const std::string& key,
+                                const CompletionCallback& callback) {
+  DCHECK(init_);
+  if (keys_.find(key) == keys_.end())
+    return net::ERR_FAILED;
+  scoped_ptr<std::vector<std::string> > keys(new std::vector<std::string>);
+  keys->push_back(key);
+  DoomKeys(keys.Pass());
+  return net::OK;
+}
+
+int FlashBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
+  return DoomEntriesBetween(base::Time(), base::Time(), callback);
+}
+
+int FlashBackendImpl::DoomEntriesBetween(base::Time initial_time,
+                                         base::Time end_time,
+                                         const CompletionCallback& callback) {
+  DCHECK(init_);
+  if (end_time.is_null())
+    end_time = base::Time::Max();
+  scoped_ptr<std::vector<std::string> > keys(new std::vector<std::string>);
+  for (KeyMap::const_iterator it = keys_.begin(); it != keys_.end(); ++it) {
+    if (it->second.last_used >= initial_time &&
+        it->second.last_used < end_time) {
+      keys->push_back(it->first);
+    }
+  }
+  DoomKeys(keys.Pass());
+  return net::OK;
+}
+
+int FlashBackendImpl::DoomEntriesSince(base::Time initial_time,
+                                       const CompletionCallback& callback) {
+  return DoomEntriesBetween(initial_time, base::Time(), callback);
+}
+
+int FlashBackendImpl::OpenNextEntry(void** iter, Entry** next_entry,
+                                    const CompletionCallback& callback) {
+  DCHECK(init_);
+  Enumeration* enumeration = static_cast<Enumeration*>(*iter);
+  if (!enumeration) {
+    enumeration = new Enumeration;
+    for (KeyMap::const_iterator it = keys_.begin(); it != keys_.end(); ++it)
+      enumeration->keys.push_back(it->first);
+    *iter = enumeration;
+  }
+  return OpenNextEntryInternal(enumeration, next_entry, callback);
+}
+
+void FlashBackendImpl::EndEnumeration(void** iter) {
+  delete static_cast<Enumeration*>(*iter);
+  *iter = NULL;
+}
+
+void FlashBackendImpl::GetStats(
+    std::vector<std::pair<std::string, std::string> >* stats) {
+  std::pair<std::string, std::string> item;
+  item.first = "Cache type";
+  item.second = "Flash Cache";
+  stats->push_back(item);
+}
+
+void FlashBackendImpl::OnExternalCacheHit(const std::string& key) {
+  KeyMap::iterator it = keys_.find(key);
+  if (it != keys_.end())
+    it->second.last_used = base::Time::Now();
+}
+
+void FlashBackendImpl::OnInitComplete(
+    const CompletionCallback& callback,
+    scoped_ptr<std::vector<std::string> > keys) {
+  if (!keys) {
+    callback.Run(net::ERR_FAILED);
+    return;
+  }
+  // Times are not persisted; entries from earlier sessions are considered used
+  // at startup.
+  const base::Time now = base::Time::Now();
+  for (size_t i = 0; i < keys->size(); ++i)
+    keys_[(*keys)[i]].last_used = now;
+  init_ = true;
+  callback.Run(net::OK);
+}
+
+int FlashBackendImpl::OpenNextEntryInternal(
+    Enumeration* enumeration,
+    Entry** next_entry,
+    const CompletionCallback& callback) {
+  while (enumeration->position < enumeration->keys.size()) {
+    const std::string& key = enumeration->keys[enumeration->position++];
+    KeyMap::const_iterator it = keys_.find(key);
+    if (it == keys_.end())
+      continue;
+    scoped_refptr<FlashEntryImpl> flash_entry(
+        new FlashEntryImpl(key, it->second.generation, AsWeakPtr(),
+                           core_.get(), cache_thread_.get()));
+    return flash_entry->Open(
+        next_entry,
+        base::Bind(&FlashBackendImpl::OnOpenNextEntryComplete, AsWeakPtr(),
+                   enumeration, next_entry, callback));
+  }
+  return net::ERR_FAILED;
+}
+
+void FlashBackendImpl::OnOpenNextEntryComplete(
+    Enumeration* enumeration,
+    Entry** next_entry,
+    const CompletionCallback& callback,
+    int result) {
+  // Skip the entries that went away since the enumeration started.
+  if (result != net::OK)
+    result = OpenNextEntryInternal(enumeration, next_entry, callback);
+  if (result != net::ERR_IO_PENDING)
+    callback.Run(result);
+}
+
+void FlashBackendImpl::DoomKeys(scoped_ptr<std::vector<std::string> > keys) {
+  if (keys->empty())
+    return;
+  for (size_t i = 0; i < keys->size(); ++i)
+    keys_.erase((*keys)[i]);
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&FlashBackendCore::DoomEntries, core_, base::Passed(&keys)),
+      base::Bind(&FlashBackendImpl::OnEntriesLost, AsWeakPtr()));
+}
+
+}  // namespace disk_cache
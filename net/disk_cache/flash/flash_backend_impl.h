@@ -0,0 +1,208 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_FLASH_FLASH_BACKEND_IMPL_H_
+#define NET_DISK_CACHE_FLASH_FLASH_BACKEND_IMPL_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/containers/hash_tables.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "net/base/cache_type.h"
+#include "net/base/completion_callback.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace base {
+class MessageLoopProxy;
+}  // namespace base
+
+namespace disk_cache {
+
+class InternalEntry;
+class LogStore;
+
+// Keys of the entries the cache thread lost, along with the generation of the
+// version that was lost.
+typedef std::vector<std::pair<std::string, int64> > FlashLostEntries;
+
+// The part of the flash backend that lives on the cache thread: the log store
+// and the index mapping every key to the most recent version of its entry in
+// the log.  Apart from construction, every method must be called on the cache
+// thread.
+//
+// Since the log can't be updated in place, dooming an entry appends a
+// tombstone to the log: an entry with an empty key whose first stream holds
+// the key being doomed.  The index is rebuilt at startup by replaying the
+// entries of the log from the oldest to the most recent one.  Entries with an
+// empty key are therefore not supported.
+class NET_EXPORT_PRIVATE FlashBackendCore
+    : public base::RefCountedThreadSafe<FlashBackendCore> {
+ public:
+  FlashBackendCore(const base::FilePath& path, int32 storage_size);
+
+  LogStore* store() { return store_.get(); }
+
+  // Opens the store and rebuilds the index.  Returns the keys found, or NULL
+  // on failure.
+  scoped_ptr<std::vector<std::string> > Init();
+
+  // Closes the store as soon as the last open entry goes away.  All the
+  // later calls fail.
+  void Close();
+
+  // Returns the latest version of |key|, initialized, or NULL.
+  scoped_refptr<InternalEntry> OpenEntry(const std::string& key);
+
+  // Closes an entry returned by OpenEntry().
+  void CloseEntry(scoped_refptr<InternalEntry> entry);
+
+  // Appends |entry| to the log as version |generation| of |key|.  Returns the
+  // entries evicted to make room for it, which include |key| itself if it
+  // could not be saved.
+  scoped_ptr<FlashLostEntries> SaveEntry(scoped_refptr<InternalEntry> entry,
+                                         const std::string& key,
+                                         int64 generation);
+
+  // Writes a tombstone for each of |keys|.  Returns the evicted entries.
+  scoped_ptr<FlashLostEntries> DoomEntries(
+      scoped_ptr<std::vector<std::string> > keys);
+
+ private:
+  friend class base::RefCountedThreadSafe<FlashBackendCore>;
+
+  struct IndexEntry {
+    IndexEntry() : id(-1), generation(0) {}
+    IndexEntry(int32 id, int64 generation) : id(id), generation(generation) {}
+    int32 id;
+    int64 generation;
+  };
+  typedef base::hash_map<std::string, IndexEntry> Index;
+
+  ~FlashBackendCore();
+
+  // Makes |id| the latest version of |key|.
+  void Insert(const std::string& key, int32 id, int64 generation);
+  void Remove(const std::string& key);
+
+  // Drops every evicted entry from the index, adding it to |lost_entries|.
+  void UpdateEvictedEntries(FlashLostEntries* lost_entries);
+
+  scoped_ptr<LogStore> store_;
+  bool init_;
+  bool closing_;
+
+  Index index_;
+  std::map<int32, std::string> keys_by_id_;
+
+  // Number of entries returned by OpenEntry() that were not closed yet.
+  int num_open_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlashBackendCore);
+};
+
+// A disk_cache::Backend storing its entries in a flash friendly log: entries
+// are buffered in memory while they are written and appended to the log when
+// they are closed, so the storage is written sequentially, one segment after
+// the other.  When the log wraps around, the oldest segment is reclaimed as a
+// whole and the entries it held are evicted.
+//
+// The set of keys in the cache is kept on the IO thread, which lets new
+// entries be created synchronously.  Every key is tagged with a generation;
+// only the entry of the generation still current when it is closed gets
+// saved, so dooming a key cancels the pending writes of its entries.  Last
+// used and last modified times are only kept in memory.
+class NET_EXPORT_PRIVATE FlashBackendImpl
+    : public Backend,
+      public base::SupportsWeakPtr<FlashBackendImpl> {
+ public:
+  FlashBackendImpl(const base::FilePath& path,
+                   int32 storage_size,
+                   base::MessageLoopProxy* cache_thread);
+  virtual ~FlashBackendImpl();
+
+  int Init(const CompletionCallback& callback);
+
+  // Called by a closing entry that holds version |generation| of |key|.
+  // Returns the generation under which its data should be saved, or -1 if it
+  // was doomed or superseded.
+  int64 BeginSaveEntry(const std::string& key, int64 generation);
+
+  // Called when the cache thread lost some entries.
+  void OnEntriesLost(scoped_ptr<FlashLostEntries> lost_entries);
+
+  // Backend interface.
+  virtual net::CacheType GetCacheType() const OVERRIDE;
+  virtual int32 GetEntryCount() const OVERRIDE;
+  virtual int OpenEntry(const std::string& key, Entry** entry,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int CreateEntry(const std::string& key, Entry** entry,
+                          const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntry(const std::string& key,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomAllEntries(const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetween(base::Time initial_time,
+                                 base::Time end_time,
+                                 const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesSince(base::Time initial_time,
+                               const CompletionCallback& callback) OVERRIDE;
+  virtual int OpenNextEntry(void** iter, Entry** next_entry,
+                            const CompletionCallback& callback) OVERRIDE;
+  virtual void EndEnumeration(void** iter) OVERRIDE;
+  virtual void GetStats(
+      std::vector<std::pair<std::string, std::string> >* stats) OVERRIDE;
+  virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
+
+ private:
+  // Snapshot of the keys being enumerated by OpenNextEntry().
+  struct Enumeration {
+    Enumeration();
+    ~Enumeration();
+    std::vector<std::string> keys;
+    size_t position;
+  };
+
+  struct KeyInfo {
+    KeyInfo() : generation(0) {}
+    int64 generation;
+    base::Time last_used;
+  };
+  typedef base::hash_map<std::string, KeyInfo> KeyMap;
+
+  void OnInitComplete(const CompletionCallback& callback,
+                      scoped_ptr<std::vector<std::string> > keys);
+
+  // Opens the next entry of |enumeration| that is still in the cache.
+  int OpenNextEntryInternal(Enumeration* enumeration, Entry** next_entry,
+                            const CompletionCallback& callback);
+  void OnOpenNextEntryComplete(Enumeration* enumeration,
+                               Entry** next_entry,
+                               const CompletionCallback& callback,
+                               int result);
+
+  // Forgets about |keys| and writes their tombstones.
+  void DoomKeys(scoped_ptr<std::vector<std::string> > keys);
+
+  scoped_refptr<base::MessageLoopProxy> cache_thread_;
+  scoped_refptr<FlashBackendCore> core_;
+  bool init_;
+
+  KeyMap keys_;
+  int64 last_generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlashBackendImpl);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_FLASH_FLASH_BACKEND_IMPL_H_
@@ -0,0 +1,226 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/flash/flash_backend_impl.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/location.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/disk_cache/flash/flash_cache_test_base.h"
+#include "net/disk_cache/flash/format.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+
+namespace {
+
+class FlashBackendTest : public FlashCacheTest {
+ protected:
+  FlashBackendTest() : cache_thread_("CacheThread") {}
+
+  virtual void SetUp() OVERRIDE {
+    FlashCacheTest::SetUp();
+    ASSERT_TRUE(cache_thread_.StartWithOptions(
+        base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+    ReopenBackend();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    backend_.reset();
+    FlushCacheThread();
+    FlashCacheTest::TearDown();
+  }
+
+  // Waits for the tasks posted to the cache thread and their replies.
+  void FlushCacheThread() {
+    base::RunLoop run_loop;
+    cache_thread_.message_loop_proxy()->PostTaskAndReply(
+        FROM_HERE, base::Bind(&base::DoNothing), run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  void ReopenBackend() {
+    backend_.reset();
+    FlushCacheThread();
+    backend_.reset(new FlashBackendImpl(path_, kStorageSize,
+                                        cache_thread_.message_loop_proxy()));
+    net::TestCompletionCallback cb;
+    ASSERT_EQ(net::OK, cb.GetResult(backend_->Init(cb.callback())));
+  }
+
+  Entry* CreateEntry(const std::string& key) {
+    Entry* entry = NULL;
+    EXPECT_EQ(net::OK, backend_->CreateEntry(key, &entry,
+                                             net::CompletionCallback()));
+    return entry;
+  }
+
+  int OpenEntry(const std::string& key, Entry** entry) {
+    net::TestCompletionCallback cb;
+    return cb.GetResult(backend_->OpenEntry(key, entry, cb.callback()));
+  }
+
+  int WriteData(Entry* entry, int index, const std::string& data,
+                bool truncate) {
+    scoped_refptr<net::IOBuffer> buf(new net::StringIOBuffer(data));
+    net::TestCompletionCallback cb;
+    return cb.GetResult(entry->WriteData(index, 0, buf.get(), data.size(),
+                                         cb.callback(), truncate));
+  }
+
+  std::string ReadData(Entry* entry, int index) {
+    const int size = entry->GetDataSize(index);
+    scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(size + 1));
+    net::TestCompletionCallback cb;
+    int rv = cb.GetResult(entry->ReadData(index, 0, buf.get(), size,
+                                          cb.callback()));
+    EXPECT_EQ(size, rv);
+    return rv > 0 ? std::string(buf->data(), rv) : std::string();
+  }
+
+  base::MessageLoopForIO message_loop_;
+  base::Thread cache_thread_;
+  scoped_ptr<FlashBackendImpl> backend_;
+};
+
+}  // namespace
+
+TEST_F(FlashBackendTest, EntrySurvivesRestart) {
+  Entry* entry = CreateEntry("key");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(net::ERR_FAILED, backend_->CreateEntry("key", &entry,
+                                                   net::CompletionCallback()));
+  EXPECT_EQ(5, WriteData(entry, 0, "hello", true));
+  EXPECT_EQ(5, WriteData(entry, 1, "world", true));
+  entry->Close();
+  EXPECT_EQ(1, backend_->GetEntryCount());
+
+  ReopenBackend();
+  EXPECT_EQ(1, backend_->GetEntryCount());
+  ASSERT_EQ(net::OK, OpenEntry("key", &entry));
+  EXPECT_EQ("key", entry->GetKey());
+  EXPECT_EQ("hello", ReadData(entry, 0));
+  EXPECT_EQ("world", ReadData(entry, 1));
+  EXPECT_EQ(0, entry->GetDataSize(2));
+  entry->Close();
+}
+
+TEST_F(FlashBackendTest, WriteToExistingEntry) {
+  Entry* entry = CreateEntry("key");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(5, WriteData(entry, 0, "hello", true));
+  EXPECT_EQ(5, WriteData(entry, 1, "world", true));
+  entry->Close();
+  FlushCacheThread();
+
+  ASSERT_EQ(net::OK, OpenEntry("key", &entry));
+  EXPECT_EQ(3, WriteData(entry, 0, "bye", true));
+  EXPECT_EQ("bye", ReadData(entry, 0));
+  EXPECT_EQ("world", ReadData(entry, 1));
+  entry->Close();
+  FlushCacheThread();
+
+  ASSERT_EQ(net::OK, OpenEntry("key", &entry));
+  EXPECT_EQ("bye", ReadData(entry, 0));
+  entry->Close();
+
+  ReopenBackend();
+  ASSERT_EQ(net::OK, OpenEntry("key", &entry));
+  EXPECT_EQ("bye", ReadData(entry, 0));
+  EXPECT_EQ("world", ReadData(entry, 1));
+  entry->Close();
+}
+
+TEST_F(FlashBackendTest, DoomIsPersistent) {
+  Entry* entry = CreateEntry("doomed");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(4, WriteData(entry, 0, "data", true));
+  entry->Close();
+  entry = CreateEntry("kept");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(4, WriteData(entry, 0, "data", true));
+  entry->Close();
+
+  EXPECT_EQ(net::OK, backend_->DoomEntry("doomed", net::CompletionCallback()));
+  EXPECT_EQ(net::ERR_FAILED, OpenEntry("doomed", &entry));
+
+  ReopenBackend();
+  EXPECT_EQ(1, backend_->GetEntryCount());
+  EXPECT_EQ(net::ERR_FAILED, OpenEntry("doomed", &entry));
+  ASSERT_EQ(net::OK, OpenEntry("kept", &entry));
+  entry->Close();
+}
+
+TEST_F(FlashBackendTest, DoomedEntryIsNotSaved) {
+  Entry* entry = CreateEntry("key");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(4, WriteData(entry, 0, "data", true));
+  entry->Doom();
+  entry->Close();
+  EXPECT_EQ(0, backend_->GetEntryCount());
+
+  ReopenBackend();
+  EXPECT_EQ(0, backend_->GetEntryCount());
+}
+
+TEST_F(FlashBackendTest, RejectsEntriesLargerThanASegment) {
+  Entry* entry = CreateEntry("key");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(net::ERR_FAILED,
+            WriteData(entry, 0, std::string(kFlashSegmentFreeSpace, 'x'),
+                      true));
+  entry->Close();
+}
+
+TEST_F(FlashBackendTest, EvictsOldestEntries) {
+  const std::string data(kFlashSegmentFreeSpace / 2, 'x');
+  const int kNumEntries = 3 * kNumTestSegments;
+  for (int i = 0; i < kNumEntries; ++i) {
+    Entry* entry = CreateEntry(base::StringPrintf("key%d", i));
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(static_cast<int>(data.size()), WriteData(entry, 0, data, true));
+    entry->Close();
+  }
+  FlushCacheThread();
+  EXPECT_GT(kNumEntries, backend_->GetEntryCount());
+
+  Entry* entry = NULL;
+  EXPECT_EQ(net::ERR_FAILED, OpenEntry("key0", &entry));
+  ASSERT_EQ(net::OK,
+            OpenEntry(base::StringPrintf("key%d", kNumEntries - 1), &entry));
+  entry->Close();
+}
+
+TEST_F(FlashBackendTest, Enumeration) {
+  for (int i = 0; i < 3; ++i) {
+    Entry* entry = CreateEntry(base::StringPrintf("key%d", i));
+    ASSERT_TRUE(entry);
+    entry->Close();
+  }
+  FlushCacheThread();
+
+  void* iter = NULL;
+  int count = 0;
+  Entry* entry = NULL;
+  net::TestCompletionCallback cb;
+  while (cb.GetResult(backend_->OpenNextEntry(&iter, &entry,
+                                              cb.callback())) == net::OK) {
+    ++count;
+    entry->Close();
+  }
+  backend_->EndEnumeration(&iter);
+  EXPECT_EQ(3, count);
+}
+
+}  // namespace disk_cache
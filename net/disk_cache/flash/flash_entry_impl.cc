@@ -2,52 +2,71 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "net/disk_cache/flash/flash_entry_impl.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/location.h"
 #include "base/message_loop/message_loop_proxy.h"
 #include "base/task_runner_util.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
-#include "net/disk_cache/flash/flash_entry_impl.h"
+#include "net/disk_cache/flash/flash_backend_impl.h"
+#include "net/disk_cache/flash/format.h"
 #include "net/disk_cache/flash/internal_entry.h"
 
+namespace {
+
+// The first stream of the underlying store entry holds the key.
+const int kNumStreams = disk_cache::kFlashLogStoreEntryNumStreams - 1;
+
+}  // namespace
+
 namespace disk_cache {
 
 FlashEntryImpl::FlashEntryImpl(const std::string& key,
-                               LogStore* store,
+                               int64 generation,
+                               const base::WeakPtr<FlashBackendImpl>& backend,
+                               FlashBackendCore* core,
                                base::MessageLoopProxy* cache_thread)
     : init_(false),
       key_(key),
-      new_internal_entry_(new InternalEntry(key, store)),
+      generation_(generation),
+      doomed_(false),
+      copying_(false),
+      backend_(backend),
+      core_(core),
       cache_thread_(cache_thread) {
   memset(stream_sizes_, 0, sizeof(stream_sizes_));
 }
 
-FlashEntryImpl::FlashEntryImpl(int32 id,
-                               LogStore* store,
-                               base::MessageLoopProxy* cache_thread)
-    : init_(false),
-      old_internal_entry_(new InternalEntry(id, store)),
-      cache_thread_(cache_thread) {
+int FlashEntryImpl::Init() {
+  DCHECK(!init_);
+  new_internal_entry_ = new InternalEntry(key_, core_->store());
+  last_used_ = last_modified_ = base::Time::Now();
+  init_ = true;
+  return net::OK;
 }
 
-int FlashEntryImpl::Init(const CompletionCallback& callback) {
-  if (new_internal_entry_.get()) {
-    DCHECK(callback.is_null());
-    init_ = true;
-    return net::OK;
-  }
-  DCHECK(!callback.is_null() && old_internal_entry_.get());
-  callback_ = callback;
-  PostTaskAndReplyWithResult(cache_thread_.get(),
-                             FROM_HERE,
-                             Bind(&InternalEntry::Init, old_internal_entry_),
-                             Bind(&FlashEntryImpl::OnInitComplete, this));
+int FlashEntryImpl::Open(Entry** out_entry,
+                         const CompletionCallback& callback) {
+  DCHECK(!init_ && !callback.is_null());
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&FlashBackendCore::OpenEntry, core_, key_),
+      base::Bind(&FlashEntryImpl::OnOpenComplete, this, out_entry, callback));
   return net::ERR_IO_PENDING;
 }
 
 void FlashEntryImpl::Doom() {
   DCHECK(init_);
-  NOTREACHED();
+  if (doomed_)
+    return;
+  doomed_ = true;
+  if (backend_.get())
+    backend_->DoomEntry(key_, CompletionCallback());
 }
 
 void FlashEntryImpl::Close() {
@@ -62,89 +81,185 @@ std::string FlashEntryImpl::GetKey() const {
 
 base::Time FlashEntryImpl::GetLastUsed() const {
   DCHECK(init_);
-  NOTREACHED();
-  return base::Time::Now();
+  return last_used_;
 }
 
 base::Time FlashEntryImpl::GetLastModified() const {
   DCHECK(init_);
-  NOTREACHED();
-  return base::Time::Now();
+  return last_modified_;
 }
 
 int32 FlashEntryImpl::GetDataSize(int index) const {
   DCHECK(init_);
-  return new_internal_entry_->GetDataSize(index);
+  if (index < 0 || index >= kNumStreams)
+    return 0;
+  if (new_internal_entry_.get())
+    return new_internal_entry_->GetDataSize(index);
+  return stream_sizes_[index];
 }
 
 int FlashEntryImpl::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
                              const CompletionCallback& callback) {
   DCHECK(init_);
-  return new_internal_entry_->ReadData(index, offset, buf, buf_len, callback);
+  if (index < 0 || index >= kNumStreams || offset < 0 || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+  if (copying_)
+    return net::ERR_FAILED;
+  last_used_ = base::Time::Now();
+  if (new_internal_entry_.get()) {
+    return new_internal_entry_->ReadData(index, offset, buf, buf_len,
+                                         callback);
+  }
+
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&InternalEntry::ReadData, old_internal_entry_, index, offset,
+                 make_scoped_refptr(buf), buf_len, CompletionCallback()),
+      base::Bind(&FlashEntryImpl::OnIOComplete, this, callback));
+  return net::ERR_IO_PENDING;
 }
 
 int FlashEntryImpl::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
                               const CompletionCallback& callback,
                               bool truncate) {
   DCHECK(init_);
-  return new_internal_entry_->WriteData(index, offset, buf, buf_len, callback);
+  if (index < 0 || index >= kNumStreams || offset < 0 || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+  if (copying_)
+    return net::ERR_FAILED;
+
+  int new_size = offset + buf_len;
+  if (!truncate)
+    new_size = std::max(new_size, GetDataSize(index));
+  if (!CanResizeStream(index, new_size))
+    return net::ERR_FAILED;
+
+  last_used_ = last_modified_ = base::Time::Now();
+  if (new_internal_entry_.get()) {
+    return new_internal_entry_->WriteData(index, offset, buf, buf_len,
+                                          callback, truncate);
+  }
+
+  copying_ = true;
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&InternalEntry::Copy, old_internal_entry_, key_),
+      base::Bind(&FlashEntryImpl::OnCopyComplete, this,
+                 base::Bind(&FlashEntryImpl::WriteData, this, index, offset,
+                            make_scoped_refptr(buf), buf_len,
+                            CompletionCallback(), truncate),
+                 callback));
+  return net::ERR_IO_PENDING;
 }
 
 int FlashEntryImpl::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
                                    const CompletionCallback& callback) {
   DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 int FlashEntryImpl::WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
                                     const CompletionCallback& callback) {
   DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 int FlashEntryImpl::GetAvailableRange(int64 offset, int len, int64* start,
                                       const CompletionCallback& callback) {
   DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 bool FlashEntryImpl::CouldBeSparse() const {
   DCHECK(init_);
-  NOTREACHED();
   return false;
 }
 
 void FlashEntryImpl::CancelSparseIO() {
   DCHECK(init_);
-  NOTREACHED();
 }
 
 int FlashEntryImpl::ReadyForSparseIO(const CompletionCallback& callback) {
   DCHECK(init_);
-  NOTREACHED();
-  return net::ERR_FAILED;
-}
-
-void FlashEntryImpl::OnInitComplete(
-    scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes) {
-  DCHECK(!callback_.is_null());
-  if (!key_and_stream_sizes) {
-    callback_.Run(net::ERR_FAILED);
-  } else {
-    key_ = key_and_stream_sizes->key;
-    memcpy(stream_sizes_, key_and_stream_sizes->stream_sizes,
-           sizeof(stream_sizes_));
-    init_ = true;
-    callback_.Run(net::OK);
-  }
+  return net::ERR_NOT_IMPLEMENTED;
 }
 
 FlashEntryImpl::~FlashEntryImpl() {
+  if (old_internal_entry_.get()) {
+    cache_thread_->PostTask(FROM_HERE,
+                            base::Bind(&FlashBackendCore::CloseEntry, core_,
+                                       old_internal_entry_));
+  }
+  if (!new_internal_entry_.get())
+    return;
+
+  int64 generation = -1;
+  if (!doomed_ && backend_.get())
+    generation = backend_->BeginSaveEntry(key_, generation_);
+  if (generation < 0) {
+    // Nothing to save; a new entry does not touch the store until then.
+    new_internal_entry_->Doom();
+    new_internal_entry_->Close();
+    return;
+  }
+  PostTaskAndReplyWithResult(
+      cache_thread_.get(),
+      FROM_HERE,
+      base::Bind(&FlashBackendCore::SaveEntry, core_, new_internal_entry_,
+                 key_, generation),
+      base::Bind(&FlashBackendImpl::OnEntriesLost, backend_));
+}
+
+void FlashEntryImpl::OnOpenComplete(Entry** out_entry,
+                                    const CompletionCallback& callback,
+                                    scoped_refptr<InternalEntry> entry) {
+  if (!entry.get()) {
+    callback.Run(net::ERR_FAILED);
+    return;
+  }
+  old_internal_entry_ = entry;
+  // The sizes of an existing entry do not change once it is initialized.
+  for (int i = 0; i < kNumStreams; ++i)
+    stream_sizes_[i] = old_internal_entry_->GetDataSize(i);
+  last_used_ = last_modified_ = base::Time::Now();
+  init_ = true;
+  AddRef();
+  *out_entry = this;
+  callback.Run(net::OK);
+}
+
+void FlashEntryImpl::OnIOComplete(const CompletionCallback& callback,
+                                  int result) {
+  if (!callback.is_null())
+    callback.Run(result);
+}
+
+void FlashEntryImpl::OnCopyComplete(const base::Callback<int(void)>& write,
+                                    const CompletionCallback& callback,
+                                    scoped_refptr<InternalEntry> copy) {
+  DCHECK(copying_);
+  copying_ = false;
+  if (!copy.get()) {
+    OnIOComplete(callback, net::ERR_FAILED);
+    return;
+  }
+  new_internal_entry_ = copy;
   cache_thread_->PostTask(FROM_HERE,
-                          Bind(&InternalEntry::Close, new_internal_entry_));
+                          base::Bind(&FlashBackendCore::CloseEntry, core_,
+                                     old_internal_entry_));
+  old_internal_entry_ = NULL;
+  OnIOComplete(callback, write.Run());
+}
+
+bool FlashEntryImpl::CanResizeStream(int index, int size) const {
+  int64 entry_size = kFlashLogStoreEntryHeaderSize + key_.size() + size;
+  for (int i = 0; i < kNumStreams; ++i) {
+    if (i != index)
+      entry_size += GetDataSize(i);
+  }
+  return entry_size <= kFlashSegmentFreeSpace;
 }
 
 }  // namespace disk_cache
@@ -7,8 +7,11 @@
 
 #include <string>
 
+#include "base/callback.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "net/base/net_export.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/flash/internal_entry.h"
@@ -21,9 +24,10 @@ class MessageLoopProxy;
 
 namespace disk_cache {
 
+class FlashBackendCore;
+class FlashBackendImpl;
 class InternalEntry;
 class IOBuffer;
-class LogStore;
 
 // We use split objects to minimize the context switches between the main thread
 // and the cache thread in the most common case of creating a new entry.
@@ -34,20 +38,28 @@ class LogStore;
 //
 // When an entry is not new, every asynchronous call is posted to the cache
 // thread, just as before; synchronous calls like GetKey() and GetDataSize() are
-// served from the main thread.
+// served from the main thread.  Since stored entries can't be modified in
+// place, the first write to an existing entry copies it to a new entry, which
+// replaces the existing one once closed.  No other operation may be issued on
+// the entry until that first write completes.
 class NET_EXPORT_PRIVATE FlashEntryImpl
     : public Entry,
       public base::RefCountedThreadSafe<FlashEntryImpl> {
   friend class base::RefCountedThreadSafe<FlashEntryImpl>;
  public:
+  // |generation| is the version of the entry for |key| in |backend|.
   FlashEntryImpl(const std::string& key,
-                 LogStore* store,
-                 base::MessageLoopProxy* cache_thread);
-  FlashEntryImpl(int32 id,
-                 LogStore* store,
+                 int64 generation,
+                 const base::WeakPtr<FlashBackendImpl>& backend,
+                 FlashBackendCore* core,
                  base::MessageLoopProxy* cache_thread);
 
-  int Init(const CompletionCallback& callback);
+  // Initializes a new entry.
+  int Init();
+
+  // Opens the existing entry; on success a reference to |this| is stored in
+  // |out_entry| before |callback| runs.
+  int Open(Entry** out_entry, const CompletionCallback& callback);
 
   // disk_cache::Entry interface.
   virtual void Doom() OVERRIDE;
@@ -72,12 +84,33 @@ class NET_EXPORT_PRIVATE FlashEntryImpl
   virtual int ReadyForSparseIO(const CompletionCallback& callback) OVERRIDE;
 
  private:
-  void OnInitComplete(scoped_ptr<KeyAndStreamSizes> key_and_stream_sizes);
   virtual ~FlashEntryImpl();
 
+  void OnOpenComplete(Entry** out_entry,
+                      const CompletionCallback& callback,
+                      scoped_refptr<InternalEntry> entry);
+  void OnIOComplete(const CompletionCallback& callback, int result);
+
+  // Replaces |old_internal_entry_| with its |copy|, then runs |write|.
+  void OnCopyComplete(const base::Callback<int(void)>& write,
+                      const CompletionCallback& callback,
+                      scoped_refptr<InternalEntry> copy);
+
+  // Returns true if stream |index| can grow to |size| bytes while the entry
+  // still fits in a segment.
+  bool CanResizeStream(int index, int size) const;
+
   bool init_;
   std::string key_;
+  const int64 generation_;
   int stream_sizes_[kFlashLogStoreEntryNumStreams];
+  bool doomed_;
+  bool copying_;
+  base::Time last_used_;
+  base::Time last_modified_;
+
+  base::WeakPtr<FlashBackendImpl> backend_;
+  scoped_refptr<FlashBackendCore> core_;
 
   // Used if |this| is an newly created entry.
   scoped_refptr<InternalEntry> new_internal_entry_;
@@ -85,9 +118,6 @@ class NET_EXPORT_PRIVATE FlashEntryImpl
   // Used if |this| is an existing entry.
   scoped_refptr<InternalEntry> old_internal_entry_;
 
-  // Copy of the callback for asynchronous calls on |old_internal_entry_|.
-  CompletionCallback callback_;
-
   scoped_refptr<base::MessageLoopProxy> cache_thread_;
 
   DISALLOW_COPY_AND_ASSIGN(FlashEntryImpl);
@@ -17,9 +17,12 @@ const int32 kFlashSmallEntrySize = 4 * 1024;
 const size_t kFlashMaxEntryCount = kFlashSegmentSize / kFlashSmallEntrySize - 1;
 
 // Segment summary consists of a fixed region at the end of the segment
-// containing a counter specifying the number of saved offsets followed by the
-// offsets.
-const int32 kFlashSummarySize = (1 + kFlashMaxEntryCount) * sizeof(int32);
+// containing a magic number, the sequence number of the segment in the log, a
+// counter specifying the number of saved offsets followed by the offsets.
+const int32 kFlashSummaryMagicNumber = 0x5e65f00d;
+const int32 kFlashSummaryHeaderCount = 3;
+const int32 kFlashSummarySize =
+    (kFlashSummaryHeaderCount + kFlashMaxEntryCount) * sizeof(int32);
 const int32 kFlashSegmentFreeSpace = kFlashSegmentSize - kFlashSummarySize;
 
 // An entry consists of a fixed number of streams.
@@ -43,13 +43,19 @@ scoped_ptr<KeyAndStreamSizes> InternalEntry::Init() {
     return null.Pass();
 
   scoped_ptr<KeyAndStreamSizes> rv(new KeyAndStreamSizes);
-  if (!ReadKey(entry_.get(), &rv->key))
+  if (!ReadKey(entry_.get(), &rv->key)) {
+    entry_->Close();
     return null.Pass();
+  }
   for (int i = 0; i < kFlashLogStoreEntryNumStreams; ++i)
     rv->stream_sizes[i] = entry_->GetDataSize(i+1);
   return rv.Pass();
 }
 
+int32 InternalEntry::id() const {
+  return entry_->id();
+}
+
 int32 InternalEntry::GetDataSize(int index) const {
   return entry_->GetDataSize(++index);
 }
@@ -60,18 +66,41 @@ int InternalEntry::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
 }
 
 int InternalEntry::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
-                             const CompletionCallback& callback) {
-  return entry_->WriteData(++index, offset, buf, buf_len);
+                             const CompletionCallback& callback,
+                             bool truncate) {
+  return entry_->WriteData(++index, offset, buf, buf_len, truncate);
+}
+
+scoped_refptr<InternalEntry> InternalEntry::Copy(const std::string& key) {
+  scoped_refptr<InternalEntry> copy(new InternalEntry(key, store_));
+  for (int i = 0; i < kFlashLogStoreEntryNumStreams - 1; ++i) {
+    int size = GetDataSize(i);
+    if (!size)
+      continue;
+    scoped_refptr<IOBuffer> buf(new IOBuffer(size));
+    if (ReadData(i, 0, buf.get(), size, CompletionCallback()) != size ||
+        copy->WriteData(i, 0, buf.get(), size, CompletionCallback(), true) !=
+            size) {
+      copy->Doom();
+      copy->Close();
+      return NULL;
+    }
+  }
+  return copy;
+}
+
+void InternalEntry::Doom() {
+  entry_->Delete();
 }
 
-void InternalEntry::Close() {
-  entry_->Close();
+bool InternalEntry::Close() {
+  return entry_->Close();
 }
 
 bool InternalEntry::WriteKey(LogStoreEntry* entry, const std::string& key) {
   int key_size = static_cast<int>(key.size());
   scoped_refptr<IOBuffer> key_buf(new StringIOBuffer(key));
-  return entry->WriteData(0, 0, key_buf.get(), key_size) == key_size;
+  return entry->WriteData(0, 0, key_buf.get(), key_size, true) == key_size;
 }
 
 bool InternalEntry::ReadKey(LogStoreEntry* entry, std::string* key) {
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
@@ -40,12 +41,28 @@ class NET_EXPORT_PRIVATE InternalEntry
   InternalEntry(int32 id, LogStore* store);
 
   scoped_ptr<KeyAndStreamSizes> Init();
+
+  // The id of the entry in the store; valid for new entries only once they
+  // were closed successfully.
+  int32 id() const;
+
   int32 GetDataSize(int index) const;
   int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len,
                const net::CompletionCallback& callback);
   int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
-                const net::CompletionCallback& callback);
-  void Close();
+                const net::CompletionCallback& callback,
+                bool truncate);
+
+  // Returns a new entry for |key| holding a copy of the streams of this entry,
+  // or NULL on failure.  Since the store cannot overwrite data in place, this
+  // is how an existing entry is modified.
+  scoped_refptr<InternalEntry> Copy(const std::string& key);
+
+  // Makes a new entry go away without being saved on Close().
+  void Doom();
+
+  // Saves a new entry to the store, or closes an existing one.
+  bool Close();
 
  private:
   bool WriteKey(LogStoreEntry* entry, const std::string& key);
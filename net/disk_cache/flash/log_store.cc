@@ -2,11 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "net/disk_cache/flash/log_store.h"
+
+#include <algorithm>
+#include <utility>
+
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/stl_util.h"
 #include "net/disk_cache/flash/format.h"
-#include "net/disk_cache/flash/log_store.h"
 #include "net/disk_cache/flash/segment.h"
 #include "net/disk_cache/flash/storage.h"
 
@@ -19,6 +23,8 @@ LogStore::LogStore(const base::FilePath& path, int32 size)
       write_index_(0),
       current_entry_id_(-1),
       current_entry_num_bytes_left_to_write_(0),
+      next_sequence_number_(0),
+      writing_(false),
       init_(false),
       closed_(false) {
   DCHECK(size % kFlashSegmentSize == 0);
@@ -34,26 +40,67 @@ bool LogStore::Init() {
   if (!storage_.Init())
     return false;
 
-  // TODO(agayev): Once we start persisting segment metadata to disk, we will
-  // start from where we left off during the last shutdown.
-  scoped_ptr<Segment> segment(new Segment(write_index_, false, &storage_));
-  if (!segment->Init())
-    return false;
-
-  segment->AddUser();
-  open_segments_[write_index_] = segment.release();
+  // Find the most recently closed segment; writing resumes after it.  The
+  // segment to write is only opened when the first entry is created, so that
+  // the entries it holds remain readable until then.
+  int32 last_sequence_number = -1;
+  for (int32 i = 0; i < num_segments_; ++i) {
+    Segment segment(i, true, &storage_);
+    if (!segment.Init())
+      return false;
+    if (segment.sequence_number() > last_sequence_number) {
+      last_sequence_number = segment.sequence_number();
+      write_index_ = i;
+    }
+  }
+  next_sequence_number_ = last_sequence_number + 1;
   init_ = true;
   return true;
 }
 
 bool LogStore::Close() {
   DCHECK(init_ && !closed_);
-  open_segments_[write_index_]->ReleaseUser();
-  if (!open_segments_[write_index_]->Close())
-    return false;
+  if (writing_) {
+    open_segments_[write_index_]->ReleaseUser();
+    if (!open_segments_[write_index_]->Close())
+      return false;
+  }
   closed_ = true;
   return true;
-  // TODO(agayev): persist metadata to disk.
+}
+
+bool LogStore::GetEntryIds(std::vector<int32>* entry_ids) {
+  DCHECK(init_ && !closed_);
+  std::vector<std::pair<int32, int32> > segments;
+  for (int32 i = 0; i < num_segments_; ++i) {
+    if (writing_ && i == write_index_)
+      continue;
+    Segment segment(i, true, &storage_);
+    if (!segment.Init())
+      return false;
+    if (segment.sequence_number() >= 0)
+      segments.push_back(std::make_pair(segment.sequence_number(), i));
+  }
+  std::sort(segments.begin(), segments.end());
+
+  entry_ids->clear();
+  for (size_t i = 0; i < segments.size(); ++i) {
+    Segment segment(segments[i].second, true, &storage_);
+    if (!segment.Init())
+      return false;
+    std::vector<int32> offsets = segment.GetOffsets();
+    entry_ids->insert(entry_ids->end(), offsets.begin(), offsets.end());
+  }
+  if (writing_) {
+    std::vector<int32> offsets = open_segments_[write_index_]->GetOffsets();
+    entry_ids->insert(entry_ids->end(), offsets.begin(), offsets.end());
+  }
+  return true;
+}
+
+void LogStore::TakeEvictedEntryIds(std::vector<int32>* entry_ids) {
+  entry_ids->clear();
+  entry_ids->swap(evicted_entry_ids_);
 }
 
 bool LogStore::CreateEntry(int32 size, int32* id) {
@@ -61,7 +108,14 @@ bool LogStore::CreateEntry(int32 size, int32* id) {
   DCHECK(current_entry_id_ == -1 && size <= disk_cache::kFlashSegmentFreeSpace);
 
   // TODO(agayev): Avoid large entries from leaving the segments almost empty.
-  if (!open_segments_[write_index_]->CanHold(size)) {
+  if (!writing_) {
+    // Nothing was ever written to a fresh storage; otherwise move past the
+    // segment closed last.
+    if (next_sequence_number_ > 0)
+      write_index_ = GetNextSegmentIndex();
+    if (!OpenWriteSegment())
+      return false;
+  } else if (!open_segments_[write_index_]->CanHold(size)) {
     if (!open_segments_[write_index_]->Close())
       return false;
 
@@ -72,12 +126,8 @@ bool LogStore::CreateEntry(int32 size, int32* id) {
     }
 
     write_index_ = GetNextSegmentIndex();
-    scoped_ptr<Segment> segment(new Segment(write_index_, false, &storage_));
-    if (!segment->Init())
+    if (!OpenWriteSegment())
       return false;
-
-    segment->AddUser();
-    open_segments_[write_index_] = segment.release();
   }
 
   *id = open_segments_[write_index_]->write_offset();
@@ -108,7 +158,7 @@ bool LogStore::WriteData(const void* buffer, int32 size) {
 
 bool LogStore::OpenEntry(int32 id) {
   DCHECK(init_ && !closed_);
-  if (open_entries_.find(id) != open_entries_.end())
+  if (id == current_entry_id_)
     return false;
 
   // Segment is already open.
@@ -144,7 +194,7 @@ bool LogStore::ReadData(int32 id, void* buffer, int32 size,
 
 void LogStore::CloseEntry(int32 id) {
   DCHECK(init_ && !closed_);
-  std::set<int32>::iterator entry_iter = open_entries_.find(id);
+  std::multiset<int32>::iterator entry_iter = open_entries_.find(id);
   DCHECK(entry_iter != open_entries_.end());
 
   if (current_entry_id_ != -1) {
@@ -176,6 +226,28 @@ int32 LogStore::GetNextSegmentIndex() {
   return next_index;
 }
 
+bool LogStore::OpenWriteSegment() {
+  DCHECK(init_ && !closed_);
+  DCHECK(!open_segments_[write_index_]);
+
+  // The entries of the segment being reclaimed are gone once it is reopened.
+  Segment old_segment(write_index_, true, &storage_);
+  if (!old_segment.Init())
+    return false;
+  std::vector<int32> offsets = old_segment.GetOffsets();
+  evicted_entry_ids_.insert(evicted_entry_ids_.end(), offsets.begin(),
+                            offsets.end());
+
+  scoped_ptr<Segment> segment(new Segment(write_index_, false, &storage_));
+  if (!segment->Init())
+    return false;
+  segment->set_sequence_number(next_sequence_number_++);
+  segment->AddUser();
+  open_segments_[write_index_] = segment.release();
+  writing_ = true;
+  return true;
+}
+
 bool LogStore::InUse(int32 index) const {
   DCHECK(init_ && !closed_);
   DCHECK(index >= 0 && index < num_segments_);
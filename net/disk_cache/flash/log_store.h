@@ -22,15 +22,29 @@ class Segment;
 // i.e. it's not possible to overwrite data in place.  In order to update an
 // entry, a new version must be written.  Only one entry can be written to at
 // any given time, while concurrent reading of multiple entries is supported.
+//
+// Segments are written in a circular fashion.  When the log wraps around, the
+// oldest segment that is not in use is reclaimed as a whole, and the entries it
+// held are evicted.
 class NET_EXPORT_PRIVATE LogStore {
  public:
   LogStore(const base::FilePath& path, int32 size);
   ~LogStore();
 
   // Performs initialization.  Must be the first function called and further
-  // calls should be made only if it is successful.
+  // calls should be made only if it is successful.  Writing resumes after the
+  // most recently closed segment found on the storage.
   bool Init();
 
+  // Stores in |entry_ids| the ids of the entries found on the storage, from the
+  // oldest to the most recently written.  Entries of a segment that was not
+  // closed, e.g. because of a crash, are lost.
+  bool GetEntryIds(std::vector<int32>* entry_ids);
+
+  // Stores in |entry_ids| the ids of the entries evicted since the last call,
+  // because the segment holding them was reclaimed.
+  void TakeEvictedEntryIds(std::vector<int32>* entry_ids);
+
   // Closes the store.  Should be the last function called before destruction.
   bool Close();
 
@@ -46,7 +60,8 @@ class NET_EXPORT_PRIVATE LogStore {
   // Appends data to the end of the last created entry.
   bool WriteData(const void* buffer, int32 size);
 
-  // Opens an entry with id |entry_id|.
+  // Opens an entry with id |entry_id|.  An entry can be opened several times,
+  // each OpenEntry call should be matched with a CloseEntry call.
   bool OpenEntry(int32 entry_id);
 
   // Reads |size| bytes starting from |offset| into |buffer|, where |offset| is
@@ -62,10 +77,15 @@ class NET_EXPORT_PRIVATE LogStore {
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreSegmentSelectionIsFifo);
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreInUseSegmentIsSkipped);
   FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreReadFromCurrentAfterClose);
+  FRIEND_TEST_ALL_PREFIXES(FlashCacheTest, LogStoreResumesAfterReopen);
 
   int32 GetNextSegmentIndex();
   bool InUse(int32 segment_index) const;
 
+  // Opens segment |write_index_| for writing, evicting the entries it held.
+  // Must only be called while no segment is open for writing.
+  bool OpenWriteSegment();
+
   Storage storage_;
 
   int32 num_segments_;
@@ -78,8 +98,9 @@ class NET_EXPORT_PRIVATE LogStore {
   // |open_segments_| vector.
   int32 write_index_;
 
-  // Ids of entries currently open, either CreatEntry'ed or OpenEntry'ed.
-  std::set<int32> open_entries_;
+  // Ids of entries currently open, either CreatEntry'ed or OpenEntry'ed.  An
+  // entry appears once per OpenEntry call.
+  std::multiset<int32> open_entries_;
 
   // Id of the entry that is currently being written to, -1 if there is no entry
   // currently being written to.
@@ -90,6 +111,15 @@ class NET_EXPORT_PRIVATE LogStore {
   // -1.
   int32 current_entry_num_bytes_left_to_write_;
 
+  // Sequence number of the next segment opened for writing.
+  int32 next_sequence_number_;
+
+  // Ids of the entries that were in reclaimed segments.
+  std::vector<int32> evicted_entry_ids_;
+
+  // True once the segment at |write_index_| is open for writing.
+  bool writing_;
+
   bool init_;  // Init was called.
   bool closed_;  // Close was called.
 
@@ -2,12 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "net/disk_cache/flash/log_store_entry.h"
+
+#include <cstring>
+
 #include "base/logging.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/flash/format.h"
 #include "net/disk_cache/flash/log_store.h"
-#include "net/disk_cache/flash/log_store_entry.h"
 
 namespace disk_cache {
 
@@ -97,23 +100,22 @@ int LogStoreEntry::ReadData(int index, int offset, net::IOBuffer* buf,
 }
 
 int LogStoreEntry::WriteData(int index, int offset, net::IOBuffer* buf,
-                             int buf_len) {
-  DCHECK(init_ && !closed_);
+                             int buf_len, bool truncate) {
+  DCHECK(init_ && !closed_ && IsNew());
   if (InvalidStream(index))
     return net::ERR_INVALID_ARGUMENT;
 
   DCHECK(offset >= 0 && buf_len >= 0);
   Stream& stream = streams_[index];
+  DCHECK_EQ(stream.write_buffer.size(), static_cast<size_t>(stream.size));
   size_t new_size = static_cast<size_t>(offset + buf_len);
-  if (new_size) {
-    // TODO(agayev): Currently, only append and overwrite is supported.  Add
-    // support for arbitrary writes.
-    DCHECK(!offset || offset == stream.size);
-    if (stream.write_buffer.size() < new_size)
-      stream.write_buffer.resize(new_size);
-    memcpy(&streams_[index].write_buffer[offset], buf->data(), buf_len);
-  }
-  stream.size = new_size;
+  // Shrinking first makes sure that a gap left by a later write past the end
+  // reads back as zeros.
+  if (truncate || stream.write_buffer.size() < new_size)
+    stream.write_buffer.resize(new_size);
+  if (buf_len)
+    memcpy(&stream.write_buffer[offset], buf->data(), buf_len);
+  stream.size = stream.write_buffer.size();
   return buf_len;
 }
 
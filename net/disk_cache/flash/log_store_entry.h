@@ -34,7 +34,11 @@ class NET_EXPORT_PRIVATE LogStoreEntry {
   int32 GetDataSize(int index) const;
 
   int ReadData(int index, int offset, net::IOBuffer* buf, int buf_len);
-  int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len);
+
+  // Only new entries can be written to.  If |truncate| is true, the stream
+  // ends right after the written data.
+  int WriteData(int index, int offset, net::IOBuffer* buf, int buf_len,
+                bool truncate);
   void Delete();
 
  private:
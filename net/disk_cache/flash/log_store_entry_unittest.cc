@@ -49,7 +49,8 @@ TEST_F(FlashCacheTest, LogStoreEntryWriteRead) {
   for (int i = 0; i < disk_cache::kFlashLogStoreEntryNumStreams; ++i) {
     buffers[i] = new net::IOBuffer(sizes[i]);
     CacheTestFillBuffer(buffers[i]->data(), sizes[i], false);
-    EXPECT_EQ(sizes[i], entry->WriteData(i, 0, buffers[i].get(), sizes[i]));
+    EXPECT_EQ(sizes[i],
+              entry->WriteData(i, 0, buffers[i].get(), sizes[i], true));
   }
   EXPECT_TRUE(entry->Close());
 
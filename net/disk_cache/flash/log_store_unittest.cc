@@ -125,6 +125,78 @@ TEST_F(FlashCacheTest, LogStoreReadFromCurrentAfterClose) {
   EXPECT_TRUE(log_store.Close());
 }
 
+TEST_F(FlashCacheTest, LogStoreResumesAfterReopen) {
+  const int32 kSize = disk_cache::kFlashSegmentFreeSpace;
+  const std::vector<char> expected(kSize, 'c');
+
+  int32 id1;
+  int32 id2;
+  {
+    LogStore log_store(path_, kStorageSize);
+    EXPECT_TRUE(log_store.Init());
+    EXPECT_TRUE(log_store.CreateEntry(kSize, &id1));
+    EXPECT_TRUE(log_store.WriteData(&expected[0], kSize));
+    log_store.CloseEntry(id1);
+    EXPECT_TRUE(log_store.CreateEntry(kSize / 2, &id2));
+    EXPECT_TRUE(log_store.WriteData(&expected[0], kSize / 2));
+    log_store.CloseEntry(id2);
+    EXPECT_EQ(1, log_store.write_index_);
+    EXPECT_TRUE(log_store.Close());
+  }
+
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+  std::vector<int32> ids;
+  EXPECT_TRUE(log_store.GetEntryIds(&ids));
+  ASSERT_EQ(2U, ids.size());
+  EXPECT_EQ(id1, ids[0]);
+  EXPECT_EQ(id2, ids[1]);
+
+  // Both entries are still readable, and writing goes on after the segment
+  // written last.
+  EXPECT_TRUE(log_store.OpenEntry(id2));
+  std::vector<char> actual(kSize / 2, 0);
+  EXPECT_TRUE(log_store.ReadData(id2, &actual[0], kSize / 2, 0));
+  log_store.CloseEntry(id2);
+  EXPECT_EQ(std::vector<char>(kSize / 2, 'c'), actual);
+
+  int32 id3;
+  EXPECT_TRUE(log_store.CreateEntry(kSize / 2, &id3));
+  EXPECT_EQ(2, log_store.write_index_);
+  EXPECT_TRUE(log_store.WriteData(&expected[0], kSize / 2));
+  log_store.CloseEntry(id3);
+
+  std::vector<int32> evicted_ids;
+  log_store.TakeEvictedEntryIds(&evicted_ids);
+  EXPECT_TRUE(evicted_ids.empty());
+  EXPECT_TRUE(log_store.Close());
+}
+
+TEST_F(FlashCacheTest, LogStoreEvictsReclaimedSegments) {
+  LogStore log_store(path_, kStorageSize);
+  EXPECT_TRUE(log_store.Init());
+
+  const int32 kSize = disk_cache::kFlashSegmentFreeSpace;
+  const std::vector<char> expected(kSize, 'd');
+
+  // Fill every segment with one entry, then wrap around.
+  std::vector<int32> ids;
+  for (int32 i = 0; i <= kNumTestSegments; ++i) {
+    int32 id;
+    EXPECT_TRUE(log_store.CreateEntry(kSize, &id));
+    EXPECT_TRUE(log_store.WriteData(&expected[0], kSize));
+    log_store.CloseEntry(id);
+    ids.push_back(id);
+  }
+
+  std::vector<int32> evicted_ids;
+  log_store.TakeEvictedEntryIds(&evicted_ids);
+  ASSERT_EQ(1U, evicted_ids.size());
+  EXPECT_EQ(ids[0], evicted_ids[0]);
+  EXPECT_EQ(ids[0], ids[kNumTestSegments]);
+  EXPECT_TRUE(log_store.Close());
+}
+
 // TODO(agayev): Add a test that confirms that in-use segment is not selected as
 // the next write segment.
 
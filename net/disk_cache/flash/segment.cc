@@ -19,7 +19,8 @@ Segment::Segment(int32 index, bool read_only, Storage* storage)
       storage_(storage),
       offset_(index * kFlashSegmentSize),
       summary_offset_(offset_ + kFlashSegmentSize - kFlashSummarySize),
-      write_offset_(offset_) {
+      write_offset_(offset_),
+      sequence_number_(-1) {
   DCHECK(storage);
   DCHECK(storage->size() % kFlashSegmentSize == 0);
 }
@@ -56,21 +57,31 @@ bool Segment::Init() {
   if (offset_ < 0 || offset_ + kFlashSegmentSize > storage_->size())
     return false;
 
+  int32 summary[kFlashSummaryHeaderCount + kFlashMaxEntryCount];
   if (!read_only_) {
+    // Invalidate the summary left by an earlier use of this segment, so that
+    // the entries it describes are not recovered after a crash.
+    memset(summary, 0, kFlashSummarySize);
+    if (!storage_->Write(summary, kFlashSummarySize, summary_offset_))
+      return false;
     init_ = true;
     return true;
   }
 
-  int32 summary[kFlashMaxEntryCount + 1];
   if (!storage_->Read(summary, kFlashSummarySize, summary_offset_))
     return false;
 
-  size_t entry_count = summary[0];
-  DCHECK_LE(entry_count, kFlashMaxEntryCount);
+  init_ = true;
+  size_t entry_count = summary[2];
+  if (summary[0] != kFlashSummaryMagicNumber ||
+      entry_count > kFlashMaxEntryCount) {
+    return true;
+  }
 
-  std::vector<int32> tmp(summary + 1, summary + 1 + entry_count);
+  sequence_number_ = summary[1];
+  std::vector<int32> tmp(summary + kFlashSummaryHeaderCount,
+                         summary + kFlashSummaryHeaderCount + entry_count);
   offsets_.swap(tmp);
-  init_ = true;
   return true;
 }
 
@@ -102,10 +113,13 @@ bool Segment::Close() {
 
   DCHECK(offsets_.size() <= kFlashMaxEntryCount);
 
-  int32 summary[kFlashMaxEntryCount + 1];
+  int32 summary[kFlashSummaryHeaderCount + kFlashMaxEntryCount];
   memset(summary, 0, kFlashSummarySize);
-  summary[0] = offsets_.size();
-  std::copy(offsets_.begin(), offsets_.end(), summary + 1);
+  summary[0] = kFlashSummaryMagicNumber;
+  summary[1] = sequence_number_;
+  summary[2] = offsets_.size();
+  std::copy(offsets_.begin(), offsets_.end(),
+            summary + kFlashSummaryHeaderCount);
   if (!storage_->Write(summary, kFlashSummarySize, summary_offset_))
     return false;
 
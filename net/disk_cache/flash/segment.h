@@ -53,6 +53,12 @@ class Storage;
 // were stored in the Segment.  Before attempting to write an entry, the client
 // should call CanHold() to make sure that there is enough space in the segment.
 //
+// The metadata also holds the sequence number of the segment, which orders the
+// segments of a log from the oldest to the most recently written.  A segment
+// that was never closed, or whose data is being rewritten, has no valid
+// metadata: it reports no offsets and a sequence number of -1 once opened
+// read-only.
+//
 // ReadData can be called over the range that was previously written with
 // WriteData.  Reading from area that was not written will fail.
 
@@ -69,6 +75,11 @@ class NET_EXPORT_PRIVATE Segment {
   int32 index() const { return index_; }
   int32 write_offset() const { return write_offset_; }
 
+  int32 sequence_number() const { return sequence_number_; }
+  void set_sequence_number(int32 sequence_number) {
+    sequence_number_ = sequence_number;
+  }
+
   bool HaveOffset(int32 offset) const;
   std::vector<int32> GetOffsets() const { return offsets_; }
 
@@ -108,6 +119,7 @@ class NET_EXPORT_PRIVATE Segment {
   const int32 offset_;  // Offset of the segment on |storage_|.
   const int32 summary_offset_;  // Offset of the segment summary.
   int32 write_offset_;  // Current write offset.
+  int32 sequence_number_;  // Position of the segment in the log.
   std::vector<int32> offsets_;
 
   DISALLOW_COPY_AND_ASSIGN(Segment);
@@ -32,6 +32,7 @@
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_packed_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "net/disk_cache/simple/simple_version_upgrade.h"
@@ -79,6 +80,16 @@ void MaybeCreateSequencedWorkerPool() {
   }
 }
 
+// Returns the largest stream 0 and 1 file stored in a pack file rather than
+// in a file of its own, or 0 if entries are never packed.
+int GetMaxPackedEntrySize() {
+  const std::string packed_entries_field_trial =
+      base::FieldTrialList::FindFullName("SimpleCachePackedEntries");
+  if (packed_entries_field_trial.empty())
+    return 0;
+  return std::max(0, std::atoi(packed_entries_field_trial.c_str()));
+}
+
 bool g_fd_limit_histogram_has_been_populated = false;
 
 void MaybeHistogramFdLimit(net::CacheType cache_type) {
@@ -224,12 +235,20 @@ int SimpleBackendImpl::Init(const CompletionCallback& completion_callback) {
   worker_pool_ = g_sequenced_worker_pool->GetTaskRunnerWithShutdownBehavior(
       SequencedWorkerPool::CONTINUE_ON_SHUTDOWN);
 
+  const int max_packed_entry_size = GetMaxPackedEntrySize();
+  if (max_packed_entry_size > 0)
+    packed_store_ = new SimplePackedStore(path_, max_packed_entry_size);
+
   index_.reset(new SimpleIndex(MessageLoopProxy::current(), this, cache_type_,
                                make_scoped_ptr(new SimpleIndexFile(
                                    cache_thread_.get(), worker_pool_.get(),
-                                   cache_type_, path_))));
+                                   cache_type_, path_,
+                                   packed_store_.get()))));
   index_->ExecuteWhenReady(
       base::Bind(&RecordIndexLoad, cache_type_, base::TimeTicks::Now()));
+  index_->ExecuteWhenReady(
+      base::Bind(&SimpleBackendImpl::OnIndexLoaded, AsWeakPtr(),
+                 base::TimeTicks::Now()));
 
   PostTaskAndReplyWithResult(
       cache_thread_,
@@ -331,7 +350,7 @@ void SimpleBackendImpl::DoomEntries(std::vector<uint64>* entry_hashes,
   PostTaskAndReplyWithResult(
       worker_pool_, FROM_HERE,
       base::Bind(&SimpleSynchronousEntry::DoomEntrySet,
-                 mass_doom_entry_hashes_ptr, path_),
+                 mass_doom_entry_hashes_ptr, path_, packed_store_),
       base::Bind(&SimpleBackendImpl::DoomEntriesComplete,
                  AsWeakPtr(), base::Passed(&mass_doom_entry_hashes),
                  barrier_callback));
@@ -470,6 +489,11 @@ void SimpleBackendImpl::GetStats(
   stats->push_back(item);
 }
 
+void SimpleBackendImpl::GetCacheStats(CacheStats* stats) {
+  *stats = cache_stats_;
+  index_->GetCacheStats(stats);
+}
+
 void SimpleBackendImpl::OnExternalCacheHit(const std::string& key) {
   index_->UseIfExists(simple_util::GetEntryHashKey(key));
 }
@@ -692,6 +716,12 @@ void SimpleBackendImpl::CheckIterationReturnValue(
   callback.Run(error_code);
 }
 
+void SimpleBackendImpl::OnIndexLoaded(base::TimeTicks constructed_since,
+                                      int result) {
+  if (result == net::OK)
+    cache_stats_.index_load_time = base::TimeTicks::Now() - constructed_since;
+}
+
 void SimpleBackendImpl::DoomEntriesComplete(
     scoped_ptr<std::vector<uint64> > entry_hashes,
     const net::CompletionCallback& callback,
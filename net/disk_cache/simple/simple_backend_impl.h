@@ -19,6 +19,7 @@
 #include "base/task_runner.h"
 #include "base/time/time.h"
 #include "net/base/cache_type.h"
+#include "net/disk_cache/cache_stats.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/simple/simple_entry_impl.h"
 #include "net/disk_cache/simple/simple_index_delegate.h"
@@ -39,6 +40,7 @@ namespace disk_cache {
 
 class SimpleEntryImpl;
 class SimpleIndex;
+class SimplePackedStore;
 
 class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
     public SimpleIndexDelegate,
@@ -56,6 +58,11 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
 
   base::TaskRunner* worker_pool() { return worker_pool_.get(); }
 
+  CacheStats* cache_stats() { return &cache_stats_; }
+
+  // Returns NULL unless small entries are packed together.
+  SimplePackedStore* packed_store() { return packed_store_.get(); }
+
   int Init(const CompletionCallback& completion_callback);
 
   // Sets the maximum size for the total amount of data stored by this instance.
@@ -104,6 +111,7 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   virtual void EndEnumeration(void** iter) OVERRIDE;
   virtual void GetStats(
       std::vector<std::pair<std::string, std::string> >* stats) OVERRIDE;
+  virtual void GetCacheStats(CacheStats* stats) OVERRIDE;
   virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
 
  private:
@@ -188,6 +196,9 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
                                  const CompletionCallback& callback,
                                  int error_code);
 
+  // Records in |cache_stats_| the time it took to load the index.
+  void OnIndexLoaded(base::TimeTicks constructed_since, int result);
+
   // A callback thunk used by DoomEntries to clear the |entries_pending_doom_|
   // after a mass doom.
   void DoomEntriesComplete(scoped_ptr<std::vector<uint64> > entry_hashes,
@@ -199,6 +210,7 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   scoped_ptr<SimpleIndex> index_;
   const scoped_refptr<base::SingleThreadTaskRunner> cache_thread_;
   scoped_refptr<base::TaskRunner> worker_pool_;
+  scoped_refptr<SimplePackedStore> packed_store_;
 
   int orig_max_size_;
   const SimpleEntryImpl::OperationsMode entry_operations_mode_;
@@ -211,6 +223,8 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   // operations to be run at the completion of the Doom.
   base::hash_map<uint64, std::vector<base::Closure> > entries_pending_doom_;
 
+  CacheStats cache_stats_;
+
   net::NetLog* const net_log_;
 };
 
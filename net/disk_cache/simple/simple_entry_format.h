@@ -19,6 +19,7 @@ namespace disk_cache {
 const uint64 kSimpleInitialMagicNumber = GG_UINT64_C(0xfcfb6d1ba7725c30);
 const uint64 kSimpleFinalMagicNumber = GG_UINT64_C(0xf4fa6f45970d41d8);
 const uint64 kSimpleSparseRangeMagicNumber = GG_UINT64_C(0xeb97bf016553676b);
+const uint64 kSimplePackedRecordMagicNumber = GG_UINT64_C(0xc1a7e5b0d3e9a8f2);
 
 // A file containing stream 0 and stream 1 in the Simple cache consists of:
 //   - a SimpleFileHeader.
@@ -33,6 +34,11 @@ const uint64 kSimpleSparseRangeMagicNumber = GG_UINT64_C(0xeb97bf016553676b);
 //   - the key.
 //   - the data.
 //   - at the end, a SimpleFileEOF record.
+// A pack file holding small entries in the Simple cache consists of a
+// sequence of records, each made of:
+//   - a SimplePackedRecordHeader.
+//   - unless the record is a tombstone, the exact contents of the file
+//     containing stream 0 and stream 1 of the entry, as described above.
 static const int kSimpleEntryFileCount = 2;
 static const int kSimpleEntryStreamCount = 3;
 
@@ -68,6 +74,22 @@ struct SimpleFileSparseRangeHeader {
   uint32 data_crc32;
 };
 
+struct NET_EXPORT_PRIVATE SimplePackedRecordHeader {
+  enum Flags {
+    // The entry stored by an earlier record in the same pack file is gone.
+    FLAG_TOMBSTONE = (1U << 0),
+  };
+
+  SimplePackedRecordHeader();
+
+  uint64 packed_record_magic_number;
+  uint64 entry_hash;
+  uint32 flags;
+  uint32 data_size;
+  uint32 data_crc32;
+  uint32 padding;
+};
+
 }  // namespace disk_cache
 
 #endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_ENTRY_FORMAT_H_
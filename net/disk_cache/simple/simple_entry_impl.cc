@@ -19,11 +19,13 @@
 #include "base/time/time.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
+#include "net/disk_cache/cache_stats.h"
 #include "net/disk_cache/net_log_parameters.h"
 #include "net/disk_cache/simple/simple_backend_impl.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_net_log_parameters.h"
+#include "net/disk_cache/simple/simple_packed_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
@@ -169,6 +171,7 @@ SimpleEntryImpl::SimpleEntryImpl(net::CacheType cache_type,
     : backend_(backend->AsWeakPtr()),
       cache_type_(cache_type),
       worker_pool_(backend->worker_pool()),
+      packed_store_(backend->packed_store()),
       path_(path),
       entry_hash_(entry_hash),
       use_optimistic_operations_(operations_mode == OPTIMISTIC_OPERATIONS),
@@ -222,6 +225,7 @@ int SimpleEntryImpl::OpenEntry(Entry** out_entry,
 
   // If entry is not known to the index, initiate fast failover to the network.
   if (open_entry_index_enum == INDEX_MISS) {
+    GetCacheStats()->open_misses++;
     net_log_.AddEventWithNetErrorCode(
         net::NetLog::TYPE_SIMPLE_CACHE_ENTRY_OPEN_END,
         net::ERR_FAILED);
@@ -689,6 +693,7 @@ void SimpleEntryImpl::OpenEntryInternal(bool have_index,
                             path_,
                             entry_hash_,
                             have_index,
+                            packed_store_,
                             results.get());
   Closure reply = base::Bind(&SimpleEntryImpl::CreationOperationComplete,
                              this,
@@ -739,6 +744,7 @@ void SimpleEntryImpl::CreateEntryInternal(bool have_index,
                             key_,
                             entry_hash_,
                             have_index,
+                            packed_store_,
                             results.get());
   Closure reply = base::Bind(&SimpleEntryImpl::CreationOperationComplete,
                              this,
@@ -782,7 +788,8 @@ void SimpleEntryImpl::CloseInternal() {
                    SimpleEntryStat(last_used_, last_modified_, data_size_,
                                    sparse_data_size_),
                    base::Passed(&crc32s_to_write),
-                   stream_0_data_);
+                   stream_0_data_,
+                   doomed_);
     Closure reply = base::Bind(&SimpleEntryImpl::CloseOperationComplete, this);
     synchronous_entry_ = NULL;
     worker_pool_->PostTaskAndReply(FROM_HERE, task, reply);
@@ -833,6 +840,8 @@ void SimpleEntryImpl::ReadDataInternal(int stream_index,
   DCHECK_EQ(STATE_READY, state_);
   if (offset >= GetDataSize(stream_index) || offset < 0 || !buf_len) {
     RecordReadResult(cache_type_, READ_RESULT_FAST_EMPTY_RETURN);
+    if (CacheStats* stats = GetCacheStats())
+      stats->RecordRead(stream_index, 0);
     // If there is nothing to read, we bail out before setting state_ to
     // STATE_IO_PENDING.
     if (!callback.is_null())
@@ -845,6 +854,8 @@ void SimpleEntryImpl::ReadDataInternal(int stream_index,
   // Since stream 0 data is kept in memory, it is read immediately.
   if (stream_index == 0) {
     int ret_value = ReadStream0Data(buf, offset, buf_len);
+    if (CacheStats* stats = GetCacheStats())
+      stats->RecordRead(stream_index, ret_value);
     if (!callback.is_null()) {
       MessageLoopProxy::current()->PostTask(FROM_HERE,
                                             base::Bind(callback, ret_value));
@@ -853,6 +864,7 @@ void SimpleEntryImpl::ReadDataInternal(int stream_index,
   }
 
   state_ = STATE_IO_PENDING;
+  io_start_time_ = base::TimeTicks::Now();
   if (!doomed_ && backend_.get())
     backend_->index()->UseIfExists(entry_hash_);
 
@@ -936,6 +948,7 @@ void SimpleEntryImpl::WriteDataInternal(int stream_index,
     }
   }
   state_ = STATE_IO_PENDING;
+  io_start_time_ = base::TimeTicks::Now();
   if (!doomed_ && backend_.get())
     backend_->index()->UseIfExists(entry_hash_);
 
@@ -1077,7 +1090,8 @@ void SimpleEntryImpl::GetAvailableRangeInternal(
 void SimpleEntryImpl::DoomEntryInternal(const CompletionCallback& callback) {
   PostTaskAndReplyWithResult(
       worker_pool_, FROM_HERE,
-      base::Bind(&SimpleSynchronousEntry::DoomEntry, path_, entry_hash_),
+      base::Bind(&SimpleSynchronousEntry::DoomEntry, path_, entry_hash_,
+                 packed_store_),
       base::Bind(&SimpleEntryImpl::DoomOperationComplete, this, callback,
                  state_));
   state_ = STATE_IO_PENDING;
@@ -1096,6 +1110,18 @@ void SimpleEntryImpl::CreationOperationComplete(
   SIMPLE_CACHE_UMA(BOOLEAN,
                    "EntryCreationResult", cache_type_,
                    in_results->result == net::OK);
+  if (CacheStats* stats = GetCacheStats()) {
+    const bool is_open =
+        end_event_type == net::NetLog::TYPE_SIMPLE_CACHE_ENTRY_OPEN_END;
+    stats->latency[is_open ? CacheStats::OPEN : CacheStats::CREATE].AddSample(
+        base::TimeTicks::Now() - start_time);
+    if (is_open) {
+      if (in_results->result == net::OK)
+        stats->open_hits++;
+      else
+        stats->open_misses++;
+    }
+  }
   if (in_results->result != net::OK) {
     if (in_results->result != net::ERR_FILE_EXISTS)
       MarkAsDoomed();
@@ -1172,6 +1198,12 @@ void SimpleEntryImpl::ReadOperationComplete(
   DCHECK(read_crc32);
   DCHECK(result);
 
+  if (CacheStats* stats = GetCacheStats()) {
+    stats->latency[CacheStats::READ].AddSample(
+        base::TimeTicks::Now() - io_start_time_);
+    stats->RecordRead(stream_index, *result);
+  }
+
   if (*result > 0 &&
       crc_check_state_[stream_index] == CRC_CHECK_NEVER_READ_AT_ALL) {
     crc_check_state_[stream_index] = CRC_CHECK_NEVER_READ_TO_END;
@@ -1240,6 +1272,10 @@ void SimpleEntryImpl::WriteOperationComplete(
     const CompletionCallback& completion_callback,
     scoped_ptr<SimpleEntryStat> entry_stat,
     scoped_ptr<int> result) {
+  if (CacheStats* stats = GetCacheStats()) {
+    stats->latency[CacheStats::WRITE].AddSample(
+        base::TimeTicks::Now() - io_start_time_);
+  }
   if (*result >= 0)
     RecordWriteResult(cache_type_, WRITE_RESULT_SUCCESS);
   else
@@ -1447,6 +1483,10 @@ void SimpleEntryImpl::RecordWriteDependencyType(
                    type, WRITE_DEPENDENCY_TYPE_MAX);
 }
 
+CacheStats* SimpleEntryImpl::GetCacheStats() const {
+  return backend_.get() ? backend_->cache_stats() : NULL;
+}
+
 int SimpleEntryImpl::ReadStream0Data(net::IOBuffer* buf,
                                      int offset,
                                      int buf_len) {
@@ -31,7 +31,9 @@ class IOBuffer;
 
 namespace disk_cache {
 
+struct CacheStats;
 class SimpleBackendImpl;
+class SimplePackedStore;
 class SimpleSynchronousEntry;
 class SimpleEntryStat;
 struct SimpleEntryCreationResults;
@@ -280,6 +282,9 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
   void RecordReadIsParallelizable(const SimpleEntryOperation& operation) const;
   void RecordWriteDependencyType(const SimpleEntryOperation& operation) const;
 
+  // Returns the stats of the backend, or NULL if it is gone.
+  CacheStats* GetCacheStats() const;
+
   // Reads from the stream 0 data kept in memory.
   int ReadStream0Data(net::IOBuffer* buf, int offset, int buf_len);
 
@@ -304,6 +309,7 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
   const base::WeakPtr<SimpleBackendImpl> backend_;
   const net::CacheType cache_type_;
   const scoped_refptr<base::TaskRunner> worker_pool_;
+  const scoped_refptr<SimplePackedStore> packed_store_;
   const base::FilePath path_;
   const uint64 entry_hash_;
   const bool use_optimistic_operations_;
@@ -317,6 +323,9 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
   int32 data_size_[kSimpleEntryStreamCount];
   int32 sparse_data_size_;
 
+  // When the stream read or write in progress was started.
+  base::TimeTicks io_start_time_;
+
   // Number of times this object has been returned from Backend::OpenEntry() and
   // Backend::CreateEntry() without subsequent Entry::Close() calls. Used to
   // notify the backend when this entry not used by any callers.
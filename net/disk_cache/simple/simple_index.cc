@@ -23,10 +23,12 @@
 #include "base/threading/worker_pool.h"
 #include "base/time/time.h"
 #include "net/base/net_errors.h"
+#include "net/disk_cache/cache_stats.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index_delegate.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_packed_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 
@@ -48,28 +50,28 @@ const uint32 kEvictionMarginDivisor = 20;
 
 const uint32 kBytesInKb = 1024;
 
-// Utility class used for timestamp comparisons in entry metadata while sorting.
-class CompareHashesForTimestamp {
-  typedef disk_cache::SimpleIndex SimpleIndex;
-  typedef disk_cache::SimpleIndex::EntrySet EntrySet;
- public:
-  explicit CompareHashesForTimestamp(const EntrySet& set);
-
-  bool operator()(uint64 hash1, uint64 hash2);
- private:
-  const EntrySet& entry_set_;
+// The journal may grow up to this many records regardless of the index size,
+// and up to the number of entries divided by |kJournalCompactionDivisor| on
+// bigger indexes, before the next write compacts it into a full index file.
+const size_t kMinJournalRecordsBeforeCompaction = 1000;
+const size_t kJournalCompactionDivisor = 4;
+
+// The metadata of an entry in the time bucket being visited while selecting
+// entries to evict, gathered across the shards so they can be sorted together.
+struct EvictionCandidate {
+  EvictionCandidate(uint64 entry_hash, const disk_cache::EntryMetadata& meta)
+      : entry_hash(entry_hash),
+        last_used_time(meta.GetLastUsedTime()),
+        entry_size(meta.GetEntrySize()) {}
+
+  uint64 entry_hash;
+  base::Time last_used_time;
+  int entry_size;
 };
 
-CompareHashesForTimestamp::CompareHashesForTimestamp(const EntrySet& set)
-  : entry_set_(set) {
-}
-
-bool CompareHashesForTimestamp::operator()(uint64 hash1, uint64 hash2) {
-  EntrySet::const_iterator it1 = entry_set_.find(hash1);
-  DCHECK(it1 != entry_set_.end());
-  EntrySet::const_iterator it2 = entry_set_.find(hash2);
-  DCHECK(it2 != entry_set_.end());
-  return it1->second.GetLastUsedTime() < it2->second.GetLastUsedTime();
+bool CompareCandidatesForTimestamp(const EvictionCandidate& candidate1,
+                                   const EvictionCandidate& candidate2) {
+  return candidate1.last_used_time < candidate2.last_used_time;
 }
 
 }  // namespace
@@ -135,19 +137,26 @@ bool EntryMetadata::Deserialize(PickleIterator* it) {
   return true;
 }
 
+SimpleIndex::Shard::Shard() : size(0) {}
+
+SimpleIndex::Shard::~Shard() {}
+
 SimpleIndex::SimpleIndex(base::SingleThreadTaskRunner* io_thread,
                          SimpleIndexDelegate* delegate,
                          net::CacheType cache_type,
                          scoped_ptr<SimpleIndexFile> index_file)
     : delegate_(delegate),
       cache_type_(cache_type),
-      cache_size_(0),
       max_size_(0),
       high_watermark_(0),
       low_watermark_(0),
       eviction_in_progress_(false),
+      evicted_entries_(0),
+      evicted_bytes_(0),
       initialized_(false),
       index_file_(index_file.Pass()),
+      full_index_written_(false),
+      journal_record_count_(0),
       io_thread_(io_thread),
       // Creating the callback once so it is reused every time
       // write_to_disk_timer_.Start() is called.
@@ -238,12 +247,15 @@ scoped_ptr<SimpleIndex::HashList> SimpleIndex::GetEntriesBetween(
       end_time.is_null() ? base::Time::Max() : end_time;
   DCHECK(extended_end_time >= initial_time);
   scoped_ptr<HashList> ret_hashes(new HashList());
-  for (EntrySet::iterator it = entries_set_.begin(), end = entries_set_.end();
-       it != end; ++it) {
-    EntryMetadata& metadata = it->second;
-    base::Time entry_time = metadata.GetLastUsedTime();
-    if (initial_time <= entry_time && entry_time < extended_end_time)
-      ret_hashes->push_back(it->first);
+  for (size_t i = 0; i < kShardCount; ++i) {
+    Shard* shard = &shards_[i];
+    for (EntrySet::iterator it = shard->entries.begin(),
+         end = shard->entries.end(); it != end; ++it) {
+      EntryMetadata& metadata = it->second;
+      base::Time entry_time = metadata.GetLastUsedTime();
+      if (initial_time <= entry_time && entry_time < extended_end_time)
+        ret_hashes->push_back(it->first);
+    }
   }
   return ret_hashes.Pass();
 }
@@ -254,7 +266,26 @@ scoped_ptr<SimpleIndex::HashList> SimpleIndex::GetAllHashes() {
 
 int32 SimpleIndex::GetEntryCount() const {
   // TODO(pasko): return a meaningful initial estimate before initialized.
-  return entries_set_.size();
+  size_t entry_count = 0;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    const Shard* shard = &shards_[i];
+    entry_count += shard->entries.size();
+  }
+  return entry_count;
+}
+
+void SimpleIndex::GetCacheStats(CacheStats* stats) const {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  stats->evicted_entries += evicted_entries_;
+  stats->evicted_bytes += evicted_bytes_;
+  stats->eviction_time += eviction_time_;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    const Shard* shard = &shards_[i];
+    for (EntrySet::const_iterator it = shard->entries.begin(),
+         end = shard->entries.end(); it != end; ++it) {
+      stats->AddEntries(it->second.GetEntrySize(), 1);
+    }
+  }
 }
 
 void SimpleIndex::Insert(uint64 entry_hash) {
@@ -262,8 +293,13 @@ void SimpleIndex::Insert(uint64 entry_hash) {
   // Upon insert we don't know yet the size of the entry.
   // It will be updated later when the SimpleEntryImpl finishes opening or
   // creating the new entry, and then UpdateEntrySize will be called.
-  InsertInEntrySet(
-      entry_hash, EntryMetadata(base::Time::Now(), 0), &entries_set_);
+  Shard* shard = GetShard(entry_hash);
+  std::pair<EntrySet::iterator, bool> insert_result =
+      shard->entries.insert(EntrySet::value_type(
+          entry_hash, EntryMetadata(base::Time::Now(), 0)));
+  if (insert_result.second)
+    AddToTimeBucket(shard, entry_hash, insert_result.first->second);
+  shard->dirty_entries.insert(entry_hash);
   if (!initialized_)
     removed_entries_.erase(entry_hash);
   PostponeWritingToDisk();
@@ -271,10 +307,13 @@ void SimpleIndex::Insert(uint64 entry_hash) {
 
 void SimpleIndex::Remove(uint64 entry_hash) {
   DCHECK(io_thread_checker_.CalledOnValidThread());
-  EntrySet::iterator it = entries_set_.find(entry_hash);
-  if (it != entries_set_.end()) {
-    UpdateEntryIteratorSize(&it, 0);
-    entries_set_.erase(it);
+  Shard* shard = GetShard(entry_hash);
+  EntrySet::iterator it = shard->entries.find(entry_hash);
+  if (it != shard->entries.end()) {
+    UpdateEntryIteratorSize(shard, &it, 0);
+    RemoveFromTimeBucket(shard, entry_hash, it->second);
+    shard->entries.erase(it);
+    shard->dirty_entries.insert(entry_hash);
   }
 
   if (!initialized_)
@@ -285,58 +324,94 @@ void SimpleIndex::Remove(uint64 entry_hash) {
 bool SimpleIndex::Has(uint64 hash) const {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   // If not initialized, always return true, forcing it to go to the disk.
-  return !initialized_ || entries_set_.count(hash) > 0;
+  return !initialized_ || GetShard(hash)->entries.count(hash) > 0;
 }
 
 bool SimpleIndex::UseIfExists(uint64 entry_hash) {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   // Always update the last used time, even if it is during initialization.
   // It will be merged later.
-  EntrySet::iterator it = entries_set_.find(entry_hash);
-  if (it == entries_set_.end())
+  Shard* shard = GetShard(entry_hash);
+  EntrySet::iterator it = shard->entries.find(entry_hash);
+  if (it == shard->entries.end())
     // If not initialized, always return true, forcing it to go to the disk.
     return !initialized_;
+  RemoveFromTimeBucket(shard, entry_hash, it->second);
   it->second.SetLastUsedTime(base::Time::Now());
+  AddToTimeBucket(shard, entry_hash, it->second);
+  shard->dirty_entries.insert(entry_hash);
   PostponeWritingToDisk();
   return true;
 }
 
 void SimpleIndex::StartEvictionIfNeeded() {
   DCHECK(io_thread_checker_.CalledOnValidThread());
-  if (eviction_in_progress_ || cache_size_ <= high_watermark_)
+  const uint64 cache_size = GetCacheSize();
+  if (eviction_in_progress_ || cache_size <= high_watermark_)
     return;
-  // Take all live key hashes from the index and sort them by time.
   eviction_in_progress_ = true;
   eviction_start_time_ = base::TimeTicks::Now();
   SIMPLE_CACHE_UMA(MEMORY_KB,
                    "Eviction.CacheSizeOnStart2", cache_type_,
-                   cache_size_ / kBytesInKb);
+                   cache_size / kBytesInKb);
   SIMPLE_CACHE_UMA(MEMORY_KB,
                    "Eviction.MaxCacheSizeOnStart2", cache_type_,
                    max_size_ / kBytesInKb);
-  std::vector<uint64> entry_hashes;
-  entry_hashes.reserve(entries_set_.size());
-  for (EntrySet::const_iterator it = entries_set_.begin(),
-       end = entries_set_.end(); it != end; ++it) {
-    entry_hashes.push_back(it->first);
-  }
-  std::sort(entry_hashes.begin(), entry_hashes.end(),
-            CompareHashesForTimestamp(entries_set_));
 
-  // Remove as many entries from the index to get below |low_watermark_|.
-  std::vector<uint64>::iterator it = entry_hashes.begin();
+  // Visit the time buckets from the oldest one on, across all the shards. Only
+  // the buckets holding evicted entries are visited, and only their entries
+  // are sorted, so this is proportional to the number of entries evicted.
+  std::vector<uint64> entry_hashes;
   uint64 evicted_so_far_size = 0;
-  while (evicted_so_far_size < cache_size_ - low_watermark_) {
-    DCHECK(it != entry_hashes.end());
-    EntrySet::iterator found_meta = entries_set_.find(*it);
-    DCHECK(found_meta != entries_set_.end());
-    uint64 to_evict_size = found_meta->second.GetEntrySize();
-    evicted_so_far_size += to_evict_size;
-    ++it;
+  const uint64 size_to_evict = cache_size - low_watermark_;
+  uint32 next_bucket = 0;
+  while (evicted_so_far_size < size_to_evict) {
+    bool found_bucket = false;
+    uint32 bucket = 0;
+    for (size_t i = 0; i < kShardCount; ++i) {
+      Shard* shard = &shards_[i];
+      TimeBucketMap::const_iterator it =
+          shard->time_buckets.lower_bound(next_bucket);
+      if (it != shard->time_buckets.end() &&
+          (!found_bucket || it->first < bucket)) {
+        bucket = it->first;
+        found_bucket = true;
+      }
+    }
+    // The shards may have shrunk since |cache_size| was computed.
+    if (!found_bucket)
+      break;
+
+    std::vector<EvictionCandidate> candidates;
+    for (size_t i = 0; i < kShardCount; ++i) {
+      Shard* shard = &shards_[i];
+      TimeBucketMap::const_iterator bucket_it =
+          shard->time_buckets.find(bucket);
+      if (bucket_it == shard->time_buckets.end())
+        continue;
+      for (base::hash_set<uint64>::const_iterator it =
+               bucket_it->second.begin();
+           it != bucket_it->second.end(); ++it) {
+        EntrySet::const_iterator found_meta = shard->entries.find(*it);
+        DCHECK(found_meta != shard->entries.end());
+        candidates.push_back(EvictionCandidate(*it, found_meta->second));
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              CompareCandidatesForTimestamp);
+    for (std::vector<EvictionCandidate>::const_iterator it =
+             candidates.begin();
+         it != candidates.end() && evicted_so_far_size < size_to_evict;
+         ++it) {
+      entry_hashes.push_back(it->entry_hash);
+      evicted_so_far_size += it->entry_size;
+    }
+
+    if (bucket == std::numeric_limits<uint32>::max())
+      break;
+    next_bucket = bucket + 1;
   }
 
-  // Take out the rest of hashes from the eviction list.
-  entry_hashes.erase(it, entry_hashes.end());
   SIMPLE_CACHE_UMA(COUNTS,
                    "Eviction.EntryCount", cache_type_, entry_hashes.size());
   SIMPLE_CACHE_UMA(TIMES,
@@ -345,6 +420,8 @@ void SimpleIndex::StartEvictionIfNeeded() {
   SIMPLE_CACHE_UMA(MEMORY_KB,
                    "Eviction.SizeOfEvicted2", cache_type_,
                    evicted_so_far_size / kBytesInKb);
+  evicted_entries_ += entry_hashes.size();
+  evicted_bytes_ += evicted_so_far_size;
 
   delegate_->DoomEntries(&entry_hashes, base::Bind(&SimpleIndex::EvictionDone,
                                                    AsWeakPtr()));
@@ -352,11 +429,13 @@ void SimpleIndex::StartEvictionIfNeeded() {
 
 bool SimpleIndex::UpdateEntrySize(uint64 entry_hash, int entry_size) {
   DCHECK(io_thread_checker_.CalledOnValidThread());
-  EntrySet::iterator it = entries_set_.find(entry_hash);
-  if (it == entries_set_.end())
+  Shard* shard = GetShard(entry_hash);
+  EntrySet::iterator it = shard->entries.find(entry_hash);
+  if (it == shard->entries.end())
     return false;
 
-  UpdateEntryIteratorSize(&it, entry_size);
+  UpdateEntryIteratorSize(shard, &it, entry_size);
+  shard->dirty_entries.insert(entry_hash);
   PostponeWritingToDisk();
   StartEvictionIfNeeded();
   return true;
@@ -367,13 +446,14 @@ void SimpleIndex::EvictionDone(int result) {
 
   // Ignore the result of eviction. We did our best.
   eviction_in_progress_ = false;
+  eviction_time_ += base::TimeTicks::Now() - eviction_start_time_;
   SIMPLE_CACHE_UMA(BOOLEAN, "Eviction.Result", cache_type_, result == net::OK);
   SIMPLE_CACHE_UMA(TIMES,
                    "Eviction.TimeToDone", cache_type_,
                    base::TimeTicks::Now() - eviction_start_time_);
   SIMPLE_CACHE_UMA(MEMORY_KB,
                    "Eviction.SizeWhenDone2", cache_type_,
-                   cache_size_ / kBytesInKb);
+                   GetCacheSize() / kBytesInKb);
 }
 
 // static
@@ -385,7 +465,49 @@ void SimpleIndex::InsertInEntrySet(
   entry_set->insert(std::make_pair(entry_hash, entry_metadata));
 }
 
+// static
+uint32 SimpleIndex::GetTimeBucket(const EntryMetadata& entry_metadata) {
+  const base::Time last_used_time = entry_metadata.GetLastUsedTime();
+  if (last_used_time.is_null())
+    return 0;
+  return (last_used_time - base::Time::UnixEpoch()).InSeconds() /
+      kEvictionBucketSeconds;
+}
+
+// static
+void SimpleIndex::AddToTimeBucket(Shard* shard,
+                                  uint64 entry_hash,
+                                  const EntryMetadata& entry_metadata) {
+  shard->time_buckets[GetTimeBucket(entry_metadata)].insert(entry_hash);
+}
+
+// static
+void SimpleIndex::RemoveFromTimeBucket(Shard* shard,
+                                       uint64 entry_hash,
+                                       const EntryMetadata& entry_metadata) {
+  TimeBucketMap::iterator it =
+      shard->time_buckets.find(GetTimeBucket(entry_metadata));
+  DCHECK(it != shard->time_buckets.end());
+  it->second.erase(entry_hash);
+  if (it->second.empty())
+    shard->time_buckets.erase(it);
+}
+
+uint64 SimpleIndex::GetCacheSize() const {
+  uint64 cache_size = 0;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    const Shard* shard = &shards_[i];
+    cache_size += shard->size;
+  }
+  // Packed entries are charged their own size; their pack files take more.
+  SimplePackedStore* packed_store = index_file_->packed_store();
+  if (packed_store)
+    cache_size += packed_store->GetOverheadSize();
+  return cache_size;
+}
+
 void SimpleIndex::PostponeWritingToDisk() {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
   if (!initialized_)
     return;
   const int delay = app_on_background_ ? background_flush_delay_
@@ -395,13 +517,14 @@ void SimpleIndex::PostponeWritingToDisk() {
       FROM_HERE, base::TimeDelta::FromMilliseconds(delay), write_to_disk_cb_);
 }
 
-void SimpleIndex::UpdateEntryIteratorSize(EntrySet::iterator* it,
+// static
+void SimpleIndex::UpdateEntryIteratorSize(Shard* shard,
+                                          EntrySet::iterator* it,
                                           int entry_size) {
-  // Update the total cache size with the new entry size.
-  DCHECK(io_thread_checker_.CalledOnValidThread());
-  DCHECK_GE(cache_size_, implicit_cast<uint64>((*it)->second.GetEntrySize()));
-  cache_size_ -= (*it)->second.GetEntrySize();
-  cache_size_ += entry_size;
+  // Update the shard size with the new entry size.
+  DCHECK_GE(shard->size, implicit_cast<uint64>((*it)->second.GetEntrySize()));
+  shard->size -= (*it)->second.GetEntrySize();
+  shard->size += entry_size;
   (*it)->second.SetEntrySize(entry_size);
 }
 
@@ -418,24 +541,37 @@ void SimpleIndex::MergeInitializingSet(
   }
   removed_entries_.clear();
 
-  for (EntrySet::const_iterator it = entries_set_.begin();
-       it != entries_set_.end(); ++it) {
-    const uint64 entry_hash = it->first;
-    std::pair<EntrySet::iterator, bool> insert_result =
-        index_file_entries->insert(EntrySet::value_type(entry_hash,
-                                                        EntryMetadata()));
-    EntrySet::iterator& possibly_inserted_entry = insert_result.first;
-    possibly_inserted_entry->second = it->second;
-  }
-
-  uint64 merged_cache_size = 0;
-  for (EntrySet::iterator it = index_file_entries->begin();
+  EntrySet loaded_shards[kShardCount];
+  for (EntrySet::const_iterator it = index_file_entries->begin();
        it != index_file_entries->end(); ++it) {
-    merged_cache_size += it->second.GetEntrySize();
+    loaded_shards[GetShardIndex(it->first)].insert(*it);
   }
+  index_file_entries->clear();
+
+  for (size_t i = 0; i < kShardCount; ++i) {
+    Shard* shard = &shards_[i];
+    EntrySet* loaded_entries = &loaded_shards[i];
+    for (EntrySet::const_iterator it = shard->entries.begin();
+         it != shard->entries.end(); ++it) {
+      const uint64 entry_hash = it->first;
+      std::pair<EntrySet::iterator, bool> insert_result =
+          loaded_entries->insert(EntrySet::value_type(entry_hash,
+                                                      EntryMetadata()));
+      EntrySet::iterator& possibly_inserted_entry = insert_result.first;
+      possibly_inserted_entry->second = it->second;
+    }
+
+    shard->time_buckets.clear();
+    uint64 merged_shard_size = 0;
+    for (EntrySet::iterator it = loaded_entries->begin();
+         it != loaded_entries->end(); ++it) {
+      merged_shard_size += it->second.GetEntrySize();
+      AddToTimeBucket(shard, it->first, it->second);
+    }
 
-  entries_set_.swap(*index_file_entries);
-  cache_size_ = merged_cache_size;
+    shard->entries.swap(*loaded_entries);
+    shard->size = merged_shard_size;
+  }
   initialized_ = true;
 
   // The actual IO is asynchronous, so calling WriteToDisk() shouldn't slow the
@@ -474,9 +610,10 @@ void SimpleIndex::WriteToDisk() {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   if (!initialized_)
     return;
+  const size_t entry_count = GetEntryCount();
   SIMPLE_CACHE_UMA(CUSTOM_COUNTS,
                    "IndexNumEntriesOnWrite", cache_type_,
-                   entries_set_.size(), 0, 100000, 50);
+                   entry_count, 0, 100000, 50);
   const base::TimeTicks start = base::TimeTicks::Now();
   if (!last_write_to_disk_.is_null()) {
     if (app_on_background_) {
@@ -491,8 +628,60 @@ void SimpleIndex::WriteToDisk() {
   }
   last_write_to_disk_ = start;
 
-  index_file_->WriteToDisk(entries_set_, cache_size_,
-                           start, app_on_background_);
+  size_t dirty_count = 0;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    Shard* shard = &shards_[i];
+    dirty_count += shard->dirty_entries.size();
+  }
+  const size_t max_journal_records =
+      std::max(kMinJournalRecordsBeforeCompaction,
+               entry_count / kJournalCompactionDivisor);
+  const bool append_to_journal =
+      full_index_written_ &&
+      journal_record_count_ + dirty_count <= max_journal_records;
+
+  if (append_to_journal) {
+    // Only write out what changed since the last write.
+    EntrySet updated_entries;
+    HashList removed_hashes;
+    for (size_t i = 0; i < kShardCount; ++i) {
+      Shard* shard = &shards_[i];
+      for (base::hash_set<uint64>::const_iterator it =
+               shard->dirty_entries.begin();
+           it != shard->dirty_entries.end(); ++it) {
+        EntrySet::const_iterator found = shard->entries.find(*it);
+        if (found == shard->entries.end())
+          removed_hashes.push_back(*it);
+        else
+          updated_entries.insert(*found);
+      }
+      shard->dirty_entries.clear();
+    }
+    const size_t record_count = updated_entries.size() + removed_hashes.size();
+    if (record_count == 0)
+      return;
+    SIMPLE_CACHE_UMA(COUNTS,
+                     "IndexJournalRecordsOnWrite", cache_type_, record_count);
+    journal_record_count_ += record_count;
+    index_file_->AppendToJournal(updated_entries, removed_hashes,
+                                 start, app_on_background_);
+    return;
+  }
+
+  // Gather the shards into one set for serialization. This also compacts the
+  // journal, as the index file replaces it.
+  EntrySet entries;
+  uint64 cache_size = 0;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    Shard* shard = &shards_[i];
+    entries.insert(shard->entries.begin(), shard->entries.end());
+    cache_size += shard->size;
+    shard->dirty_entries.clear();
+  }
+  full_index_written_ = true;
+  journal_record_count_ = 0;
+
+  index_file_->WriteToDisk(entries, cache_size, start, app_on_background_);
 }
 
 }  // namespace disk_cache
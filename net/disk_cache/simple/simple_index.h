@@ -6,6 +6,7 @@
 #define NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_H_
 
 #include <list>
+#include <map>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -33,6 +34,7 @@ class PickleIterator;
 
 namespace disk_cache {
 
+struct CacheStats;
 class SimpleIndexDelegate;
 class SimpleIndexFile;
 struct SimpleIndexLoadResult;
@@ -71,12 +73,18 @@ class NET_EXPORT_PRIVATE EntryMetadata {
 };
 COMPILE_ASSERT(sizeof(EntryMetadata) == 8, metadata_size);
 
-// This class is not Thread-safe.
+// This class is not Thread-safe. The index is split into |kShardCount|
+// shards keyed by the top bits of the entry hash, each keeping its own size
+// and time buckets for eviction.
 class NET_EXPORT_PRIVATE SimpleIndex
     : public base::SupportsWeakPtr<SimpleIndex> {
  public:
   typedef std::vector<uint64> HashList;
 
+  // The number of shards is 2^|kShardCountBits|.
+  static const int kShardCountBits = 4;
+  static const size_t kShardCount = 1 << kShardCountBits;
+
   SimpleIndex(base::SingleThreadTaskRunner* io_thread,
               SimpleIndexDelegate* delegate,
               net::CacheType cache_type,
@@ -131,19 +139,76 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // Returns whether the index has been initialized yet.
   bool initialized() const { return initialized_; }
 
+  // Adds the eviction counts and the size distribution of the indexed entries
+  // to |stats|.
+  void GetCacheStats(CacheStats* stats) const;
+
+  // Returns the shard |entry_hash| belongs to, in [0, kShardCount).
+  static size_t GetShardIndex(uint64 entry_hash) {
+    return static_cast<size_t>(entry_hash >> (64 - kShardCountBits));
+  }
+
  private:
   friend class SimpleIndexTest;
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, IndexSizeCorrectOnMerge);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteQueued);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteExecuted);
   FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWritePostponed);
+  FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, ShardSizeAccounting);
+  FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, DiskWriteJournaled);
+  FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, JournalCompaction);
+  FRIEND_TEST_ALL_PREFIXES(SimpleIndexTest, TimeBuckets);
+
+  // Entries grouped by last used time, in buckets of
+  // |kEvictionBucketSeconds|. Lets eviction visit the oldest entries first
+  // without sorting the whole index.
+  typedef std::map<uint32, base::hash_set<uint64> > TimeBucketMap;
+
+  // A slice of the index. |size| is the sum of the sizes of |entries|.
+  // |dirty_entries| holds the hashes of the entries inserted, removed or
+  // modified since the index was last written to disk. |time_buckets| holds
+  // the hashes of |entries| by last used time.
+  struct Shard {
+    Shard();
+    ~Shard();
+
+    EntrySet entries;
+    uint64 size;
+    base::hash_set<uint64> dirty_entries;
+    TimeBucketMap time_buckets;
+  };
+
+  static const int kEvictionBucketSeconds = 60;
+
+  // Returns the time bucket of an entry.
+  static uint32 GetTimeBucket(const EntryMetadata& entry_metadata);
+
+  static void AddToTimeBucket(Shard* shard,
+                              uint64 entry_hash,
+                              const EntryMetadata& entry_metadata);
+  static void RemoveFromTimeBucket(Shard* shard,
+                                   uint64 entry_hash,
+                                   const EntryMetadata& entry_metadata);
+
+  Shard* GetShard(uint64 entry_hash) {
+    return &shards_[GetShardIndex(entry_hash)];
+  }
+  const Shard* GetShard(uint64 entry_hash) const {
+    return &shards_[GetShardIndex(entry_hash)];
+  }
+
+  // Returns the total storage size of all the shards, plus the overhead of
+  // the pack files.
+  uint64 GetCacheSize() const;
 
   void StartEvictionIfNeeded();
   void EvictionDone(int result);
 
   void PostponeWritingToDisk();
 
-  void UpdateEntryIteratorSize(EntrySet::iterator* it, int entry_size);
+  static void UpdateEntryIteratorSize(Shard* shard,
+                                      EntrySet::iterator* it,
+                                      int entry_size);
 
   // Must run on IO Thread.
   void MergeInitializingSet(scoped_ptr<SimpleIndexLoadResult> load_result);
@@ -157,19 +222,22 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // The owner of |this| must ensure the |delegate_| outlives |this|.
   SimpleIndexDelegate* delegate_;
 
-  EntrySet entries_set_;
+  Shard shards_[kShardCount];
 
   const net::CacheType cache_type_;
-  uint64 cache_size_;  // Total cache storage size in bytes.
   uint64 max_size_;
   uint64 high_watermark_;
   uint64 low_watermark_;
   bool eviction_in_progress_;
   base::TimeTicks eviction_start_time_;
+  int64 evicted_entries_;
+  int64 evicted_bytes_;
+  base::TimeDelta eviction_time_;
 
   // This stores all the entry_hash of entries that are removed during
   // initialization.
   base::hash_set<uint64> removed_entries_;
+
   bool initialized_;
 
   scoped_ptr<SimpleIndexFile> index_file_;
@@ -180,6 +248,15 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // thread, in all cases. |io_thread_checker_| documents and enforces this.
   base::ThreadChecker io_thread_checker_;
 
+  // Whether a full index file, and therefore a journal to append to, has been
+  // written during this session.
+  bool full_index_written_;
+
+  // Number of records appended to the journal since the last full write. Once
+  // it grows past a fraction of the index, the next write is a full one, which
+  // compacts the journal.
+  size_t journal_record_count_;
+
   // Timestamp of the last time we wrote the index to disk.
   // PostponeWritingToDisk() may give up postponing and allow the write if it
   // has been a while since last time we wrote.
@@ -18,6 +18,7 @@
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_packed_store.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
@@ -143,6 +144,8 @@ const char SimpleIndexFile::kIndexFileName[] = "the-real-index";
 const char SimpleIndexFile::kIndexDirectory[] = "index-dir";
 // static
 const char SimpleIndexFile::kTempIndexFileName[] = "temp-index";
+// static
+const char SimpleIndexFile::kJournalFileName[] = "the-real-index-journal";
 
 SimpleIndexFile::IndexMetadata::IndexMetadata()
     : magic_number_(kSimpleIndexMagicNumber),
@@ -216,6 +219,16 @@ void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
   bool result = base::ReplaceFile(temp_index_filename, index_filename, NULL);
   DCHECK(result);
 
+  // Start a new journal on top of the new index file. If this fails, or we
+  // crash before it completes, the old journal no longer matches the CRC of
+  // the index file and is ignored on load.
+  scoped_ptr<Pickle> journal_header =
+      SerializeJournalHeader(pickle->headerT<PickleHeader>()->crc);
+  const base::FilePath journal_filename =
+      index_filename.DirName().AppendASCII(kJournalFileName);
+  if (!WritePickleFile(journal_header.get(), journal_filename))
+    LOG(ERROR) << "Failed to reset the index journal";
+
   if (app_on_background) {
     SIMPLE_CACHE_UMA(TIMES,
                      "IndexWriteToDiskTime.Background", cache_type,
@@ -227,6 +240,44 @@ void SimpleIndexFile::SyncWriteToDisk(net::CacheType cache_type,
   }
 }
 
+// static
+void SimpleIndexFile::SyncAppendToJournal(
+    net::CacheType cache_type,
+    const base::FilePath& cache_directory,
+    const base::FilePath& journal_filename,
+    scoped_ptr<Pickle> pickle,
+    const base::TimeTicks& start_time,
+    bool app_on_background) {
+  base::Time cache_dir_mtime;
+  if (!simple_util::GetMTime(cache_directory, &cache_dir_mtime)) {
+    LOG(ERROR) << "Could obtain information about cache age";
+    return;
+  }
+  SerializeFinalData(cache_dir_mtime, pickle.get());
+
+  // AppendToFile() does not create the file, so a journal whose header is
+  // missing never gets batches appended to it.
+  int bytes_written = file_util::AppendToFile(
+      journal_filename, static_cast<const char*>(pickle->data()),
+      pickle->size());
+  if (bytes_written != implicit_cast<int>(pickle->size())) {
+    // A partially written batch is dropped on load, together with anything
+    // appended after it, so the index will just look stale next time.
+    LOG(ERROR) << "Failed to append to the index journal";
+    return;
+  }
+
+  if (app_on_background) {
+    SIMPLE_CACHE_UMA(TIMES,
+                     "IndexJournalWriteTime.Background", cache_type,
+                     (base::TimeTicks::Now() - start_time));
+  } else {
+    SIMPLE_CACHE_UMA(TIMES,
+                     "IndexJournalWriteTime.Foreground", cache_type,
+                     (base::TimeTicks::Now() - start_time));
+  }
+}
+
 bool SimpleIndexFile::IndexMetadata::CheckIndexMetadata() {
   return number_of_entries_ <= kMaxEntiresInIndex &&
       magic_number_ == kSimpleIndexMagicNumber &&
@@ -237,7 +288,8 @@ SimpleIndexFile::SimpleIndexFile(
     base::SingleThreadTaskRunner* cache_thread,
     base::TaskRunner* worker_pool,
     net::CacheType cache_type,
-    const base::FilePath& cache_directory)
+    const base::FilePath& cache_directory,
+    SimplePackedStore* packed_store)
     : cache_thread_(cache_thread),
       worker_pool_(worker_pool),
       cache_type_(cache_type),
@@ -245,7 +297,10 @@ SimpleIndexFile::SimpleIndexFile(
       index_file_(cache_directory_.AppendASCII(kIndexDirectory)
                       .AppendASCII(kIndexFileName)),
       temp_index_file_(cache_directory_.AppendASCII(kIndexDirectory)
-                           .AppendASCII(kTempIndexFileName)) {
+                           .AppendASCII(kTempIndexFileName)),
+      journal_file_(cache_directory_.AppendASCII(kIndexDirectory)
+                        .AppendASCII(kJournalFileName)),
+      packed_store_(packed_store) {
 }
 
 SimpleIndexFile::~SimpleIndexFile() {}
@@ -256,7 +311,8 @@ void SimpleIndexFile::LoadIndexEntries(base::Time cache_last_modified,
   base::Closure task = base::Bind(&SimpleIndexFile::SyncLoadIndexEntries,
                                   cache_type_,
                                   cache_last_modified, cache_directory_,
-                                  index_file_, out_result);
+                                  index_file_, journal_file_, packed_store_,
+                                  out_result);
   worker_pool_->PostTaskAndReply(FROM_HERE, task, callback);
 }
 
@@ -277,16 +333,36 @@ void SimpleIndexFile::WriteToDisk(const SimpleIndex::EntrySet& entry_set,
       app_on_background));
 }
 
+void SimpleIndexFile::AppendToJournal(
+    const SimpleIndex::EntrySet& updated_entries,
+    const SimpleIndex::HashList& removed_hashes,
+    const base::TimeTicks& start,
+    bool app_on_background) {
+  scoped_ptr<Pickle> pickle =
+      SerializeJournalBatch(updated_entries, removed_hashes);
+  cache_thread_->PostTask(FROM_HERE, base::Bind(
+      &SimpleIndexFile::SyncAppendToJournal,
+      cache_type_,
+      cache_directory_,
+      journal_file_,
+      base::Passed(&pickle),
+      base::TimeTicks::Now(),
+      app_on_background));
+}
+
 // static
 void SimpleIndexFile::SyncLoadIndexEntries(
     net::CacheType cache_type,
     base::Time cache_last_modified,
     const base::FilePath& cache_directory,
     const base::FilePath& index_file_path,
+    const base::FilePath& journal_file_path,
+    SimplePackedStore* packed_store,
     SimpleIndexLoadResult* out_result) {
   // Load the index and find its age.
   base::Time last_cache_seen_by_index;
-  SyncLoadFromDisk(index_file_path, &last_cache_seen_by_index, out_result);
+  SyncLoadFromDisk(index_file_path, journal_file_path,
+                   &last_cache_seen_by_index, out_result);
 
   // Consider the index loaded if it is fresh.
   const bool index_file_existed = base::PathExists(index_file_path);
@@ -311,7 +387,8 @@ void SimpleIndexFile::SyncLoadIndexEntries(
 
   // Reconstruct the index by scanning the disk for entries.
   const base::TimeTicks start = base::TimeTicks::Now();
-  SyncRestoreFromDisk(cache_directory, index_file_path, out_result);
+  SyncRestoreFromDisk(cache_directory, index_file_path, packed_store,
+                      out_result);
   SIMPLE_CACHE_UMA(MEDIUM_TIMES, "IndexRestoreTime", cache_type,
                    base::TimeTicks::Now() - start);
   SIMPLE_CACHE_UMA(COUNTS, "IndexEntriesRestored", cache_type,
@@ -328,6 +405,7 @@ void SimpleIndexFile::SyncLoadIndexEntries(
 
 // static
 void SimpleIndexFile::SyncLoadFromDisk(const base::FilePath& index_filename,
+                                       const base::FilePath& journal_filename,
                                        base::Time* out_last_cache_seen_by_index,
                                        SimpleIndexLoadResult* out_result) {
   out_result->Reset();
@@ -336,17 +414,36 @@ void SimpleIndexFile::SyncLoadFromDisk(const base::FilePath& index_filename,
   if (!index_file_map.Initialize(index_filename)) {
     LOG(WARNING) << "Could not map Simple Index file.";
     base::DeleteFile(index_filename, false);
+    base::DeleteFile(journal_filename, false);
     return;
   }
 
-  SimpleIndexFile::Deserialize(
-      reinterpret_cast<const char*>(index_file_map.data()),
-      index_file_map.length(),
-      out_last_cache_seen_by_index,
-      out_result);
+  const char* index_data = reinterpret_cast<const char*>(index_file_map.data());
+  SimpleIndexFile::Deserialize(index_data,
+                               index_file_map.length(),
+                               out_last_cache_seen_by_index,
+                               out_result);
 
-  if (!out_result->did_load)
+  if (!out_result->did_load) {
     base::DeleteFile(index_filename, false);
+    base::DeleteFile(journal_filename, false);
+    return;
+  }
+
+  base::MemoryMappedFile journal_file_map;
+  if (!journal_file_map.Initialize(journal_filename))
+    return;
+  const uint32 base_index_crc =
+      Pickle(index_data, index_file_map.length()).headerT<PickleHeader>()->crc;
+  if (!DeserializeJournal(
+          reinterpret_cast<const char*>(journal_file_map.data()),
+          journal_file_map.length(),
+          base_index_crc,
+          out_last_cache_seen_by_index,
+          &out_result->entries)) {
+    LOG(WARNING) << "Simple Index journal does not match the index file.";
+    base::DeleteFile(journal_filename, false);
+  }
 }
 
 // static
@@ -428,13 +525,128 @@ void SimpleIndexFile::Deserialize(const char* data, int data_len,
   out_result->did_load = true;
 }
 
+// static
+scoped_ptr<Pickle> SimpleIndexFile::SerializeJournalHeader(
+    uint32 base_index_crc) {
+  scoped_ptr<Pickle> pickle(new Pickle(sizeof(SimpleIndexFile::PickleHeader)));
+  pickle->WriteUInt64(kSimpleIndexJournalMagicNumber);
+  pickle->WriteUInt32(kSimpleVersion);
+  pickle->WriteUInt32(base_index_crc);
+  pickle->headerT<PickleHeader>()->crc = CalculatePickleCRC(*pickle);
+  return pickle.Pass();
+}
+
+// static
+scoped_ptr<Pickle> SimpleIndexFile::SerializeJournalBatch(
+    const SimpleIndex::EntrySet& updated_entries,
+    const SimpleIndex::HashList& removed_hashes) {
+  scoped_ptr<Pickle> pickle(new Pickle(sizeof(SimpleIndexFile::PickleHeader)));
+  pickle->WriteUInt32(updated_entries.size() + removed_hashes.size());
+  for (SimpleIndex::EntrySet::const_iterator it = updated_entries.begin();
+       it != updated_entries.end(); ++it) {
+    pickle->WriteInt(JOURNAL_RECORD_UPSERT);
+    pickle->WriteUInt64(it->first);
+    it->second.Serialize(pickle.get());
+  }
+  for (SimpleIndex::HashList::const_iterator it = removed_hashes.begin();
+       it != removed_hashes.end(); ++it) {
+    pickle->WriteInt(JOURNAL_RECORD_REMOVE);
+    pickle->WriteUInt64(*it);
+  }
+  return pickle.Pass();
+}
+
+// static
+int SimpleIndexFile::GetJournalPickleSize(const char* data, int data_len) {
+  if (data_len < implicit_cast<int>(sizeof(PickleHeader)))
+    return 0;
+  const uint64 pickle_size = sizeof(PickleHeader) +
+      reinterpret_cast<const PickleHeader*>(data)->payload_size;
+  if (pickle_size > implicit_cast<uint64>(data_len))
+    return 0;
+  return pickle_size;
+}
+
+// static
+bool SimpleIndexFile::DeserializeJournal(const char* data, int data_len,
+                                         uint32 base_index_crc,
+                                         base::Time* out_cache_last_modified,
+                                         SimpleIndex::EntrySet* entries) {
+  DCHECK(data);
+  DCHECK(entries);
+
+  // The journal is a sequence of pickles, and a Pickle built on a buffer
+  // assumes it spans all of it, so each pickle is framed explicitly.
+  Pickle header(data, GetJournalPickleSize(data, data_len));
+  if (!header.data() ||
+      header.headerT<PickleHeader>()->crc != CalculatePickleCRC(header)) {
+    return false;
+  }
+  PickleIterator header_it(header);
+  uint64 magic_number;
+  uint32 version;
+  uint32 crc;
+  if (!header_it.ReadUInt64(&magic_number) ||
+      !header_it.ReadUInt32(&version) ||
+      !header_it.ReadUInt32(&crc) ||
+      magic_number != kSimpleIndexJournalMagicNumber ||
+      version != kSimpleVersion ||
+      crc != base_index_crc) {
+    return false;
+  }
+
+  int offset = header.size();
+  while (offset < data_len) {
+    Pickle batch(data + offset,
+                 GetJournalPickleSize(data + offset, data_len - offset));
+    if (!batch.data() ||
+        batch.headerT<PickleHeader>()->crc != CalculatePickleCRC(batch)) {
+      LOG(WARNING) << "Torn batch at the end of the Simple Index journal.";
+      break;
+    }
+    offset += batch.size();
+
+    PickleIterator batch_it(batch);
+    uint32 record_count;
+    if (!batch_it.ReadUInt32(&record_count))
+      break;
+    for (uint32 i = 0; i < record_count; ++i) {
+      int record_type;
+      uint64 hash_key;
+      if (!batch_it.ReadInt(&record_type) || !batch_it.ReadUInt64(&hash_key))
+        return true;
+      if (record_type == JOURNAL_RECORD_REMOVE) {
+        entries->erase(hash_key);
+        continue;
+      }
+      EntryMetadata entry_metadata;
+      if (record_type != JOURNAL_RECORD_UPSERT ||
+          !entry_metadata.Deserialize(&batch_it)) {
+        return true;
+      }
+      (*entries)[hash_key] = entry_metadata;
+    }
+
+    int64 cache_last_modified;
+    if (!batch_it.ReadInt64(&cache_last_modified))
+      break;
+    DCHECK(out_cache_last_modified);
+    *out_cache_last_modified =
+        base::Time::FromInternalValue(cache_last_modified);
+  }
+  return true;
+}
+
 // static
 void SimpleIndexFile::SyncRestoreFromDisk(
     const base::FilePath& cache_directory,
     const base::FilePath& index_file_path,
+    SimplePackedStore* packed_store,
     SimpleIndexLoadResult* out_result) {
   VLOG(1) << "Simple Cache Index is being restored from disk.";
   base::DeleteFile(index_file_path, /* recursive = */ false);
+  base::DeleteFile(index_file_path.DirName().AppendASCII(kJournalFileName),
+                   /* recursive = */ false);
   out_result->Reset();
   SimpleIndex::EntrySet* entries = &out_result->entries;
 
@@ -444,6 +656,27 @@ void SimpleIndexFile::SyncRestoreFromDisk(
     LOG(ERROR) << "Could not reconstruct index from disk";
     return;
   }
+
+  // The entries in pack files have no files of their own.
+  if (packed_store) {
+    std::vector<SimplePackedStore::EntryInfo> packed_entries;
+    packed_store->GetEntries(&packed_entries);
+    for (size_t i = 0; i < packed_entries.size(); ++i) {
+      const SimplePackedStore::EntryInfo& packed_entry = packed_entries[i];
+      SimpleIndex::EntrySet::iterator it =
+          entries->find(packed_entry.entry_hash);
+      if (it == entries->end()) {
+        SimpleIndex::InsertInEntrySet(
+            packed_entry.entry_hash,
+            EntryMetadata(packed_entry.last_modified, packed_entry.size),
+            entries);
+      } else {
+        it->second.SetEntrySize(it->second.GetEntrySize() + packed_entry.size);
+      }
+    }
+  } else {
+    SimplePackedStore::DeleteAllPackFiles(cache_directory);
+  }
   out_result->did_load = true;
   // When we restore from disk we write the merged index file to disk right
   // away, this might save us from having to restore again next time.
@@ -13,6 +13,7 @@
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/port.h"
@@ -27,7 +28,10 @@ class TaskRunner;
 
 namespace disk_cache {
 
+class SimplePackedStore;
+
 const uint64 kSimpleIndexMagicNumber = GG_UINT64_C(0x656e74657220796f);
+const uint64 kSimpleIndexJournalMagicNumber = GG_UINT64_C(0x6a6f75726e616c30);
 
 struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
   SimpleIndexLoadResult();
@@ -46,6 +50,14 @@ struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
 // see SimpleIndexFile::Serialize() and SeeSimpleIndexFile::LoadFromDisk()
 // methods.
 //
+// Changes made between two full writes are appended to a journal file next to
+// the index file, as a sequence of pickles: a header carrying the CRC of the
+// index file the journal applies to, followed by batches of upsert and remove
+// records. The journal is replayed on top of the index file at load time, and
+// is discarded every time a full index file is written. See
+// SimpleIndexFile::SerializeJournalBatch() and
+// SimpleIndexFile::DeserializeJournal().
+//
 // The non-static methods must run on the IO thread. All the real
 // work is done in the static methods, which are run on the cache thread
 // or in worker threads. Synchronization between methods is the
@@ -74,26 +86,46 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
     uint64 cache_size_;  // Total cache storage size in bytes.
   };
 
+  // |packed_store| is NULL unless small entries are packed together.
   SimpleIndexFile(base::SingleThreadTaskRunner* cache_thread,
                   base::TaskRunner* worker_pool,
                   net::CacheType cache_type,
-                  const base::FilePath& cache_directory);
+                  const base::FilePath& cache_directory,
+                  SimplePackedStore* packed_store);
   virtual ~SimpleIndexFile();
 
+  SimplePackedStore* packed_store() const { return packed_store_.get(); }
+
   // Get index entries based on current disk context.
   virtual void LoadIndexEntries(base::Time cache_last_modified,
                                 const base::Closure& callback,
                                 SimpleIndexLoadResult* out_result);
 
-  // Write the specified set of entries to disk.
+  // Write the specified set of entries to disk, and start a new empty journal
+  // on top of it.
   virtual void WriteToDisk(const SimpleIndex::EntrySet& entry_set,
                            uint64 cache_size,
                            const base::TimeTicks& start,
                            bool app_on_background);
 
+  // Append the entries that changed since the last write to the journal.
+  // |updated_entries| holds the new metadata of inserted or modified entries,
+  // |removed_hashes| the hashes of the entries that are gone. Must only be
+  // called after WriteToDisk() has been called at least once.
+  virtual void AppendToJournal(const SimpleIndex::EntrySet& updated_entries,
+                               const SimpleIndex::HashList& removed_hashes,
+                               const base::TimeTicks& start,
+                               bool app_on_background);
+
  private:
   friend class WrappedSimpleIndexFile;
 
+  // Types of the records in a journal batch.
+  enum JournalRecordType {
+    JOURNAL_RECORD_UPSERT = 0,
+    JOURNAL_RECORD_REMOVE = 1,
+  };
+
   // Used for cache directory traversal.
   typedef base::Callback<void (const base::FilePath&)> EntryFileCallback;
 
@@ -106,10 +138,14 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                                    base::Time cache_last_modified,
                                    const base::FilePath& cache_directory,
                                    const base::FilePath& index_file_path,
+                                   const base::FilePath& journal_file_path,
+                                   SimplePackedStore* packed_store,
                                    SimpleIndexLoadResult* out_result);
 
-  // Load the index file from disk returning an EntrySet.
+  // Load the index file from disk returning an EntrySet, then replay the
+  // journal on top of it.
   static void SyncLoadFromDisk(const base::FilePath& index_filename,
+                               const base::FilePath& journal_filename,
                                base::Time* out_last_cache_seen_by_index,
                                SimpleIndexLoadResult* out_result);
 
@@ -133,6 +169,32 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                           base::Time* out_cache_last_modified,
                           SimpleIndexLoadResult* out_result);
 
+  // Returns a newly allocated Pickle with the journal header for an index file
+  // whose CRC is |base_index_crc|.
+  static scoped_ptr<Pickle> SerializeJournalHeader(uint32 base_index_crc);
+
+  // Returns a newly allocated Pickle holding one journal batch. As with
+  // Serialize(), SerializeFinalData() must be called on the result before it
+  // is written.
+  static scoped_ptr<Pickle> SerializeJournalBatch(
+      const SimpleIndex::EntrySet& updated_entries,
+      const SimpleIndex::HashList& removed_hashes);
+
+  // Returns the size of the pickle starting at |data|, or 0 if it does not fit
+  // in |data_len| bytes.
+  static int GetJournalPickleSize(const char* data, int data_len);
+
+  // Replays the journal in |data| of length |data_len| on top of |entries|.
+  // Returns false, without touching |entries|, if the journal does not apply
+  // to the index file with CRC |base_index_crc|. A torn batch at the end of
+  // the journal, as left by a crash while appending, is ignored.
+  // |out_cache_last_modified| is updated with the modification time recorded
+  // in the last batch replayed.
+  static bool DeserializeJournal(const char* data, int data_len,
+                                 uint32 base_index_crc,
+                                 base::Time* out_cache_last_modified,
+                                 SimpleIndex::EntrySet* entries);
+
   // Implemented either in simple_index_file_posix.cc or
   // simple_index_file_win.cc. base::FileEnumerator turned out to be very
   // expensive in terms of memory usage therefore it's used only on non-POSIX
@@ -142,7 +204,8 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
       const base::FilePath& cache_path,
       const EntryFileCallback& entry_file_callback);
 
-  // Writes the index file to disk atomically.
+  // Writes the index file to disk atomically, then replaces the journal next
+  // to it with an empty one matching the new index file.
   static void SyncWriteToDisk(net::CacheType cache_type,
                               const base::FilePath& cache_directory,
                               const base::FilePath& index_filename,
@@ -151,10 +214,20 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                               const base::TimeTicks& start_time,
                               bool app_on_background);
 
+  // Appends a journal batch to the journal file.
+  static void SyncAppendToJournal(net::CacheType cache_type,
+                                  const base::FilePath& cache_directory,
+                                  const base::FilePath& journal_filename,
+                                  scoped_ptr<Pickle> pickle,
+                                  const base::TimeTicks& start_time,
+                                  bool app_on_background);
+
   // Scan the index directory for entries, returning an EntrySet of all entries
-  // found.
+  // found. Entries in pack files are taken from |packed_store|; without one,
+  // the pack files are deleted.
   static void SyncRestoreFromDisk(const base::FilePath& cache_directory,
                                   const base::FilePath& index_file_path,
+                                  SimplePackedStore* packed_store,
                                   SimpleIndexLoadResult* out_result);
 
   // Determines if an index file is stale relative to the time of last
@@ -174,10 +247,13 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
   const base::FilePath cache_directory_;
   const base::FilePath index_file_;
   const base::FilePath temp_index_file_;
+  const base::FilePath journal_file_;
+  const scoped_refptr<SimplePackedStore> packed_store_;
 
   static const char kIndexDirectory[];
   static const char kIndexFileName[];
   static const char kTempIndexFileName[];
+  static const char kJournalFileName[];
 
   DISALLOW_COPY_AND_ASSIGN(SimpleIndexFile);
 };
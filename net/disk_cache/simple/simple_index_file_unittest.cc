@@ -22,6 +22,7 @@
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_packed_store.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "net/disk_cache/simple/simple_version_upgrade.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -70,15 +71,20 @@ TEST(IndexMetadataTest, Serialize) {
 class WrappedSimpleIndexFile : public SimpleIndexFile {
  public:
   using SimpleIndexFile::Deserialize;
+  using SimpleIndexFile::DeserializeJournal;
   using SimpleIndexFile::LegacyIsIndexFileStale;
   using SimpleIndexFile::Serialize;
   using SimpleIndexFile::SerializeFinalData;
+  using SimpleIndexFile::SerializeJournalBatch;
+  using SimpleIndexFile::SerializeJournalHeader;
+  using SimpleIndexFile::SyncRestoreFromDisk;
 
   explicit WrappedSimpleIndexFile(const base::FilePath& index_file_directory)
       : SimpleIndexFile(base::MessageLoopProxy::current().get(),
                         base::MessageLoopProxy::current().get(),
                         net::DISK_CACHE,
-                        index_file_directory) {}
+                        index_file_directory,
+                        NULL) {}
   virtual ~WrappedSimpleIndexFile() {
   }
 
@@ -156,6 +162,55 @@ TEST_F(SimpleIndexFileTest, Serialize) {
   }
 }
 
+TEST_F(SimpleIndexFileTest, ReplayJournal) {
+  const uint32 kBaseIndexCrc = 0x1234;
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time(), 11), &entries);
+  SimpleIndex::InsertInEntrySet(22, EntryMetadata(Time(), 22), &entries);
+
+  std::string journal;
+  scoped_ptr<Pickle> header =
+      WrappedSimpleIndexFile::SerializeJournalHeader(kBaseIndexCrc);
+  journal.append(static_cast<const char*>(header->data()), header->size());
+
+  SimpleIndex::EntrySet updated_entries;
+  SimpleIndex::InsertInEntrySet(22, EntryMetadata(Time(), 222),
+                                &updated_entries);
+  SimpleIndex::InsertInEntrySet(33, EntryMetadata(Time(), 33),
+                                &updated_entries);
+  SimpleIndex::HashList removed_hashes;
+  removed_hashes.push_back(11);
+  scoped_ptr<Pickle> batch = WrappedSimpleIndexFile::SerializeJournalBatch(
+      updated_entries, removed_hashes);
+  const base::Time now = base::Time::Now();
+  EXPECT_TRUE(WrappedSimpleIndexFile::SerializeFinalData(now, batch.get()));
+  journal.append(static_cast<const char*>(batch->data()), batch->size());
+
+  // The journal does not apply to an index file with another CRC.
+  base::Time when_journal_last_saw_cache;
+  SimpleIndex::EntrySet other_entries(entries);
+  EXPECT_FALSE(WrappedSimpleIndexFile::DeserializeJournal(
+      journal.data(), journal.size(), kBaseIndexCrc + 1,
+      &when_journal_last_saw_cache, &other_entries));
+  EXPECT_EQ(entries.size(), other_entries.size());
+
+  // A torn batch at the end is ignored.
+  std::string torn_journal(journal);
+  torn_journal.append(static_cast<const char*>(batch->data()),
+                      batch->size() / 2);
+  EXPECT_TRUE(WrappedSimpleIndexFile::DeserializeJournal(
+      torn_journal.data(), torn_journal.size(), kBaseIndexCrc,
+      &when_journal_last_saw_cache, &entries));
+  EXPECT_EQ(now, when_journal_last_saw_cache);
+
+  ASSERT_EQ(2U, entries.size());
+  EXPECT_EQ(0U, entries.count(11));
+  ASSERT_EQ(1U, entries.count(22));
+  EXPECT_EQ(222, entries.find(22)->second.GetEntrySize());
+  ASSERT_EQ(1U, entries.count(33));
+  EXPECT_EQ(33, entries.find(33)->second.GetEntrySize());
+}
+
 TEST_F(SimpleIndexFileTest, LegacyIsIndexFileStale) {
   base::ScopedTempDir cache_dir;
   ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
@@ -234,6 +289,62 @@ TEST_F(SimpleIndexFileTest, DISABLED_WriteThenLoadIndex) {
     EXPECT_EQ(1U, load_index_result.entries.count(kHashes[i]));
 }
 
+TEST_F(SimpleIndexFileTest, RestoreFromDiskFindsPackedEntries) {
+  base::ScopedTempDir cache_dir;
+  ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
+
+  // A packed entry, made of a minimal stream 0 and 1 file.
+  SimpleFileHeader header;
+  header.initial_magic_number = kSimpleInitialMagicNumber;
+  SimpleFileEOF eof;
+  eof.final_magic_number = kSimpleFinalMagicNumber;
+  std::string packed_contents(reinterpret_cast<const char*>(&header),
+                              sizeof(header));
+  packed_contents.append(reinterpret_cast<const char*>(&eof), sizeof(eof));
+  const base::FilePath packed_entry_file =
+      cache_dir.path().AppendASCII("packed_entry");
+  ASSERT_EQ(static_cast<int>(packed_contents.size()),
+            file_util::WriteFile(packed_entry_file, packed_contents.data(),
+                                 packed_contents.size()));
+  scoped_refptr<SimplePackedStore> packed_store(
+      new SimplePackedStore(cache_dir.path(), 4096));
+  ASSERT_TRUE(packed_store->PackEntryFile(11, packed_entry_file));
+
+  // An entry with a file of its own.
+  const std::string kEntryData = "entry data";
+  ASSERT_EQ(static_cast<int>(kEntryData.size()),
+            file_util::WriteFile(
+                cache_dir.path().AppendASCII(
+                    simple_util::GetFilenameFromEntryHashAndFileIndex(22, 0)),
+                kEntryData.data(), kEntryData.size()));
+
+  SimpleIndexLoadResult load_index_result;
+  WrappedSimpleIndexFile::SyncRestoreFromDisk(
+      cache_dir.path(), cache_dir.path().AppendASCII("index"),
+      packed_store.get(), &load_index_result);
+  EXPECT_TRUE(load_index_result.did_load);
+  EXPECT_EQ(2U, load_index_result.entries.size());
+  ASSERT_EQ(1U, load_index_result.entries.count(11));
+  EXPECT_EQ(static_cast<int>(packed_contents.size()),
+            load_index_result.entries.find(11)->second.GetEntrySize());
+  EXPECT_EQ(1U, load_index_result.entries.count(22));
+
+  // Without a packed store, the pack files are deleted along with their
+  // entries.
+  SimplePackedStore::Location location;
+  ASSERT_TRUE(packed_store->Lookup(11, &location));
+  const base::FilePath pack_file =
+      packed_store->GetPackFilePath(location.pack_index);
+  packed_store = NULL;
+  WrappedSimpleIndexFile::SyncRestoreFromDisk(
+      cache_dir.path(), cache_dir.path().AppendASCII("index"), NULL,
+      &load_index_result);
+  EXPECT_TRUE(load_index_result.did_load);
+  EXPECT_EQ(1U, load_index_result.entries.size());
+  EXPECT_EQ(1U, load_index_result.entries.count(22));
+  EXPECT_FALSE(base::PathExists(pack_file));
+}
+
 TEST_F(SimpleIndexFileTest, LoadCorruptIndex) {
   base::ScopedTempDir cache_dir;
   ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
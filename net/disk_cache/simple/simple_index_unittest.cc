@@ -30,6 +30,9 @@ const base::Time kTestLastUsedTime =
     base::Time::UnixEpoch() + base::TimeDelta::FromDays(20);
 const int kTestEntrySize = 789;
 
+// Matches kMinJournalRecordsBeforeCompaction in simple_index.cc.
+const size_t kMinJournalRecordsBeforeCompactionForTest = 1000;
+
 }  // namespace
 
 
@@ -52,10 +55,11 @@ class MockSimpleIndexFile : public SimpleIndexFile,
                             public base::SupportsWeakPtr<MockSimpleIndexFile> {
  public:
   MockSimpleIndexFile()
-      : SimpleIndexFile(NULL, NULL, net::DISK_CACHE, base::FilePath()),
+      : SimpleIndexFile(NULL, NULL, net::DISK_CACHE, base::FilePath(), NULL),
         load_result_(NULL),
         load_index_entries_calls_(0),
-        disk_writes_(0) {}
+        disk_writes_(0),
+        journal_writes_(0) {}
 
   virtual void LoadIndexEntries(
       base::Time cache_last_modified,
@@ -74,6 +78,15 @@ class MockSimpleIndexFile : public SimpleIndexFile,
     disk_write_entry_set_ = entry_set;
   }
 
+  virtual void AppendToJournal(const SimpleIndex::EntrySet& updated_entries,
+                               const SimpleIndex::HashList& removed_hashes,
+                               const base::TimeTicks& start,
+                               bool app_on_background) OVERRIDE {
+    journal_writes_++;
+    journal_updated_entries_ = updated_entries;
+    journal_removed_hashes_ = removed_hashes;
+  }
+
   void GetAndResetDiskWriteEntrySet(SimpleIndex::EntrySet* entry_set) {
     entry_set->swap(disk_write_entry_set_);
   }
@@ -82,13 +95,23 @@ class MockSimpleIndexFile : public SimpleIndexFile,
   SimpleIndexLoadResult* load_result() const { return load_result_; }
   int load_index_entries_calls() const { return load_index_entries_calls_; }
   int disk_writes() const { return disk_writes_; }
+  int journal_writes() const { return journal_writes_; }
+  const SimpleIndex::EntrySet& journal_updated_entries() const {
+    return journal_updated_entries_;
+  }
+  const SimpleIndex::HashList& journal_removed_hashes() const {
+    return journal_removed_hashes_;
+  }
 
  private:
   base::Closure load_callback_;
   SimpleIndexLoadResult* load_result_;
   int load_index_entries_calls_;
   int disk_writes_;
+  int journal_writes_;
   SimpleIndex::EntrySet disk_write_entry_set_;
+  SimpleIndex::EntrySet journal_updated_entries_;
+  SimpleIndex::HashList journal_removed_hashes_;
 };
 
 class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
@@ -131,13 +154,28 @@ class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
 
   // Redirect to allow single "friend" declaration in base class.
   bool GetEntryForTesting(uint64 key, EntryMetadata* metadata) {
-    SimpleIndex::EntrySet::iterator it = index_->entries_set_.find(key);
-    if (index_->entries_set_.end() == it)
+    SimpleIndex::Shard* shard = index_->GetShard(key);
+    SimpleIndex::EntrySet::iterator it = shard->entries.find(key);
+    if (shard->entries.end() == it)
       return false;
     *metadata = it->second;
     return true;
   }
 
+  // Returns how many entries are in the time bucket of |last_used_time|.
+  size_t CountEntriesInTimeBucket(base::Time last_used_time) {
+    const uint32 bucket =
+        SimpleIndex::GetTimeBucket(EntryMetadata(last_used_time, 0));
+    size_t count = 0;
+    for (size_t i = 0; i < SimpleIndex::kShardCount; ++i) {
+      SimpleIndex::TimeBucketMap::const_iterator it =
+          index_->shards_[i].time_buckets.find(bucket);
+      if (it != index_->shards_[i].time_buckets.end())
+        count += it->second.size();
+    }
+    return count;
+  }
+
   void InsertIntoIndexFileReturn(uint64 hash_key,
                                  base::Time last_used_time,
                                  int entry_size) {
@@ -206,13 +244,13 @@ TEST_F(SimpleIndexTest, IndexSizeCorrectOnMerge) {
   index()->UpdateEntrySize(hashes_.at<3>(), 3);
   index()->Insert(hashes_.at<4>());
   index()->UpdateEntrySize(hashes_.at<4>(), 4);
-  EXPECT_EQ(9U, index()->cache_size_);
+  EXPECT_EQ(9U, index()->GetCacheSize());
   {
     scoped_ptr<SimpleIndexLoadResult> result(new SimpleIndexLoadResult());
     result->did_load = true;
     index()->MergeInitializingSet(result.Pass());
   }
-  EXPECT_EQ(9U, index()->cache_size_);
+  EXPECT_EQ(9U, index()->GetCacheSize());
   {
     scoped_ptr<SimpleIndexLoadResult> result(new SimpleIndexLoadResult());
     result->did_load = true;
@@ -224,7 +262,44 @@ TEST_F(SimpleIndexTest, IndexSizeCorrectOnMerge) {
                                           EntryMetadata(base::Time::Now(), 4)));
     index()->MergeInitializingSet(result.Pass());
   }
-  EXPECT_EQ(2U + 3U + 4U + 11U, index()->cache_size_);
+  EXPECT_EQ(2U + 3U + 4U + 11U, index()->GetCacheSize());
+}
+
+// Entries are spread over the shards by the top bits of their hash.
+TEST_F(SimpleIndexTest, ShardIndexFromTopBits) {
+  EXPECT_EQ(0U, SimpleIndex::GetShardIndex(0));
+  EXPECT_EQ(0U, SimpleIndex::GetShardIndex(GG_UINT64_C(0x0fffffffffffffff)));
+  EXPECT_EQ(1U, SimpleIndex::GetShardIndex(GG_UINT64_C(0x1000000000000000)));
+  EXPECT_EQ(SimpleIndex::kShardCount - 1,
+            SimpleIndex::GetShardIndex(GG_UINT64_C(0xffffffffffffffff)));
+}
+
+// Each shard accounts only for the entries it holds.
+TEST_F(SimpleIndexTest, ShardSizeAccounting) {
+  const uint64 kHashInFirstShard = GG_UINT64_C(0x0000000000000001);
+  const uint64 kOtherHashInFirstShard = GG_UINT64_C(0x0000000000000002);
+  const uint64 kHashInLastShard = GG_UINT64_C(0xf000000000000001);
+  index()->SetMaxSize(1000);
+  ReturnIndexFile();
+
+  index()->Insert(kHashInFirstShard);
+  index()->UpdateEntrySize(kHashInFirstShard, 10);
+  index()->Insert(kOtherHashInFirstShard);
+  index()->UpdateEntrySize(kOtherHashInFirstShard, 20);
+  index()->Insert(kHashInLastShard);
+  index()->UpdateEntrySize(kHashInLastShard, 40);
+
+  EXPECT_EQ(30U, index()->shards_[0].size);
+  EXPECT_EQ(2U, index()->shards_[0].entries.size());
+  EXPECT_EQ(40U, index()->shards_[SimpleIndex::kShardCount - 1].size);
+  EXPECT_EQ(1U, index()->shards_[SimpleIndex::kShardCount - 1].entries.size());
+  EXPECT_EQ(70U, index()->GetCacheSize());
+  EXPECT_EQ(3, index()->GetEntryCount());
+
+  index()->Remove(kOtherHashInFirstShard);
+  EXPECT_EQ(10U, index()->shards_[0].size);
+  EXPECT_EQ(50U, index()->GetCacheSize());
+  EXPECT_EQ(2, index()->GetEntryCount());
 }
 
 // State of index changes as expected with an insert and a remove.
@@ -549,6 +624,51 @@ TEST_F(SimpleIndexTest, BasicEviction) {
   ASSERT_EQ(2u, last_doom_entry_hashes().size());
 }
 
+// Entries move between time buckets as they are used, and leave them when
+// removed.
+TEST_F(SimpleIndexTest, TimeBuckets) {
+  const base::Time now(base::Time::Now());
+  const base::Time two_days_ago = now - base::TimeDelta::FromDays(2);
+  InsertIntoIndexFileReturn(hashes_.at<1>(), two_days_ago, 10u);
+  InsertIntoIndexFileReturn(hashes_.at<2>(), two_days_ago, 10u);
+  ReturnIndexFile();
+  EXPECT_EQ(2U, CountEntriesInTimeBucket(two_days_ago));
+
+  index()->UseIfExists(hashes_.at<1>());
+  EXPECT_EQ(1U, CountEntriesInTimeBucket(two_days_ago));
+  EXPECT_EQ(1U, CountEntriesInTimeBucket(base::Time::Now()));
+
+  index()->Insert(hashes_.at<3>());
+  EXPECT_EQ(2U, CountEntriesInTimeBucket(base::Time::Now()));
+
+  index()->Remove(hashes_.at<2>());
+  EXPECT_EQ(0U, CountEntriesInTimeBucket(two_days_ago));
+  index()->Remove(hashes_.at<1>());
+  index()->Remove(hashes_.at<3>());
+  for (size_t i = 0; i < SimpleIndex::kShardCount; ++i)
+    EXPECT_TRUE(index()->shards_[i].time_buckets.empty());
+  index()->write_to_disk_timer_.Stop();
+}
+
+// Entries sharing a time bucket are still evicted oldest first.
+TEST_F(SimpleIndexTest, EvictionWithinTimeBucket) {
+  const base::Time now(base::Time::Now());
+  index()->SetMaxSize(1000);
+  InsertIntoIndexFileReturn(hashes_.at<1>(),
+                            now - base::TimeDelta::FromSeconds(2), 475u);
+  InsertIntoIndexFileReturn(hashes_.at<2>(),
+                            now - base::TimeDelta::FromSeconds(1), 475u);
+  ReturnIndexFile();
+
+  index()->Insert(hashes_.at<3>());
+  index()->UpdateEntrySize(hashes_.at<3>(), 100);
+  EXPECT_EQ(1, doom_entries_calls());
+  ASSERT_EQ(1u, last_doom_entry_hashes().size());
+  EXPECT_EQ(hashes_.at<1>(), last_doom_entry_hashes()[0]);
+  EXPECT_TRUE(index()->Has(hashes_.at<2>()));
+  EXPECT_TRUE(index()->Has(hashes_.at<3>()));
+}
+
 // Confirm all the operations queue a disk write at some point in the
 // future.
 TEST_F(SimpleIndexTest, DiskWriteQueued) {
@@ -626,4 +746,58 @@ TEST_F(SimpleIndexTest, DiskWritePostponed) {
   index()->write_to_disk_timer_.Stop();
 }
 
+// Once a full index has been written, later writes only append the changes to
+// the journal.
+TEST_F(SimpleIndexTest, DiskWriteJournaled) {
+  index()->SetMaxSize(1000);
+  ReturnIndexFile();
+
+  const uint64 kHash1 = hashes_.at<1>();
+  const uint64 kHash2 = hashes_.at<2>();
+  const uint64 kHash3 = hashes_.at<3>();
+  index()->Insert(kHash1);
+  index()->Insert(kHash2);
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(0, index_file_->journal_writes());
+
+  index()->UpdateEntrySize(kHash1, 20);
+  index()->Remove(kHash2);
+  index()->Insert(kHash3);
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  ASSERT_EQ(1, index_file_->journal_writes());
+
+  const SimpleIndex::EntrySet& updated = index_file_->journal_updated_entries();
+  ASSERT_EQ(2U, updated.size());
+  ASSERT_EQ(1U, updated.count(kHash1));
+  EXPECT_EQ(20, updated.find(kHash1)->second.GetEntrySize());
+  EXPECT_EQ(1U, updated.count(kHash3));
+  ASSERT_EQ(1U, index_file_->journal_removed_hashes().size());
+  EXPECT_EQ(kHash2, index_file_->journal_removed_hashes()[0]);
+
+  // Nothing changed, nothing to write.
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+  EXPECT_EQ(1, index_file_->journal_writes());
+  index()->write_to_disk_timer_.Stop();
+}
+
+// A journal that grew too big is compacted by writing a full index.
+TEST_F(SimpleIndexTest, JournalCompaction) {
+  index()->SetMaxSize(1000);
+  ReturnIndexFile();
+
+  index()->WriteToDisk();
+  EXPECT_EQ(1, index_file_->disk_writes());
+
+  index()->journal_record_count_ = kMinJournalRecordsBeforeCompactionForTest;
+  index()->Insert(hashes_.at<1>());
+  index()->WriteToDisk();
+  EXPECT_EQ(2, index_file_->disk_writes());
+  EXPECT_EQ(0, index_file_->journal_writes());
+  EXPECT_EQ(0U, index()->journal_record_count_);
+  index()->write_to_disk_timer_.Stop();
+}
+
 }  // namespace disk_cache
@@ -0,0 +1,647 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_packed_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/files/file_enumerator.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "net/disk_cache/simple/simple_entry_format.h"
+#include "third_party/zlib/zlib.h"
+
+namespace {
+
+const char kPackFilePrefix[] = "packed_";
+
+uint32 CalculateCrc32(const char* data, int size) {
+  return crc32(crc32(0, Z_NULL, 0),
+               reinterpret_cast<const Bytef*>(data), size);
+}
+
+// Returns true if |data| looks like the file holding stream 0 and stream 1 of
+// a Simple cache entry.
+bool IsValidEntryFile(const std::string& data) {
+  using disk_cache::SimpleFileEOF;
+  using disk_cache::SimpleFileHeader;
+  if (data.size() < sizeof(SimpleFileHeader) + sizeof(SimpleFileEOF))
+    return false;
+  SimpleFileHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.initial_magic_number != disk_cache::kSimpleInitialMagicNumber)
+    return false;
+  SimpleFileEOF eof;
+  std::memcpy(&eof, data.data() + data.size() - sizeof(eof), sizeof(eof));
+  return eof.final_magic_number == disk_cache::kSimpleFinalMagicNumber;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+struct SimplePackedStore::PendingAppend {
+  int pack_index;
+  // Offset of |header| in the pack file, |data| follows it.
+  int64 offset;
+  SimplePackedRecordHeader header;
+  // NULL for a tombstone.
+  const char* data;
+  bool written;
+};
+
+SimplePackedStore::Location::Location()
+    : pack_index(-1),
+      offset(0),
+      size(0) {
+}
+
+SimplePackedStore::PackFile::PackFile()
+    : live_entry_count(0),
+      live_data_size(0),
+      size(0),
+      pending_io_count(0) {
+}
+
+SimplePackedStore::SimplePackedStore(const base::FilePath& path,
+                                     int max_packed_entry_size)
+    : path_(path),
+      max_packed_entry_size_(max_packed_entry_size),
+      initialized_cv_(&lock_),
+      initializing_(false),
+      initialized_(false),
+      compacting_(false),
+      current_pack_index_(-1),
+      next_pack_index_(0) {
+}
+
+SimplePackedStore::~SimplePackedStore() {
+}
+
+bool SimplePackedStore::CanPack(int64 file_size) const {
+  return file_size <= max_packed_entry_size_;
+}
+
+bool SimplePackedStore::Lookup(uint64 entry_hash, Location* out_location) {
+  base::AutoLock auto_lock(lock_);
+  EnsureInitialized();
+  LocationMap::const_iterator it = locations_.find(entry_hash);
+  if (it == locations_.end())
+    return false;
+  *out_location = it->second;
+  return true;
+}
+
+base::FilePath SimplePackedStore::GetPackFilePath(int pack_index) const {
+  return path_.AppendASCII(
+      base::StringPrintf("%s%04d", kPackFilePrefix, pack_index));
+}
+
+bool SimplePackedStore::PackEntryFile(uint64 entry_hash,
+                                      const base::FilePath& entry_file) {
+  std::string data;
+  if (!base::ReadFileToString(entry_file, &data) ||
+      !CanPack(data.size()) || !IsValidEntryFile(data)) {
+    return false;
+  }
+
+  std::vector<PendingAppend> appends;
+  std::vector<int> pack_indices_to_delete;
+  int old_pack_index = -1;
+  {
+    base::AutoLock auto_lock(lock_);
+    EnsureInitialized();
+    LocationMap::iterator it = locations_.find(entry_hash);
+    if (it != locations_.end()) {
+      old_pack_index = it->second.pack_index;
+      ForgetEntry(it, &appends, &pack_indices_to_delete);
+    }
+    EnsureCurrentPackFile(&pack_indices_to_delete);
+    ReserveAppend(current_pack_index_, entry_hash, data.data(), data.size(),
+                  &appends);
+  }
+
+  WriteAppends(&appends);
+  const PendingAppend& record = appends.back();
+  {
+    base::AutoLock auto_lock(lock_);
+    if (record.written) {
+      Location location;
+      location.pack_index = record.pack_index;
+      location.offset = record.offset + sizeof(record.header);
+      location.size = data.size();
+      std::pair<LocationMap::iterator, bool> inserted =
+          locations_.insert(std::make_pair(entry_hash, location));
+      DCHECK(inserted.second);
+      PackFile& pack = pack_files_[location.pack_index];
+      ++pack.live_entry_count;
+      pack.live_data_size += location.size;
+    }
+    FinishAppends(appends, &pack_indices_to_delete);
+  }
+  DeletePackFiles(pack_indices_to_delete);
+  if (old_pack_index >= 0)
+    MaybeCompactPackFile(old_pack_index);
+
+  if (!record.written)
+    return false;
+  if (!base::DeleteFile(entry_file, false)) {
+    // Do not let the packed copy shadow the entry file later on.
+    RemoveEntry(entry_hash);
+    return false;
+  }
+  return true;
+}
+
+bool SimplePackedStore::UnpackEntryFile(uint64 entry_hash,
+                                        const base::FilePath& entry_file) {
+  Location location;
+  {
+    base::AutoLock auto_lock(lock_);
+    EnsureInitialized();
+    LocationMap::const_iterator it = locations_.find(entry_hash);
+    if (it == locations_.end())
+      return false;
+    location = it->second;
+    ++pack_files_[location.pack_index].pending_io_count;
+  }
+
+  std::vector<char> data(location.size);
+  base::File pack_file(GetPackFilePath(location.pack_index),
+                       base::File::FLAG_OPEN | base::File::FLAG_READ);
+  const bool read =
+      pack_file.IsValid() &&
+      pack_file.Read(location.offset, &data[0], location.size) ==
+          location.size;
+  pack_file.Close();
+  const bool unpacked =
+      read &&
+      file_util::WriteFile(entry_file, &data[0], location.size) ==
+          location.size;
+  if (read && !unpacked)
+    base::DeleteFile(entry_file, false);
+
+  std::vector<PendingAppend> appends;
+  std::vector<int> pack_indices_to_delete;
+  int forgotten_pack_index = -1;
+  {
+    base::AutoLock auto_lock(lock_);
+    --pack_files_[location.pack_index].pending_io_count;
+    MaybeDeletePackFile(location.pack_index, &pack_indices_to_delete);
+    // A compaction may have moved the record meanwhile.
+    LocationMap::iterator it = locations_.find(entry_hash);
+    if (unpacked && it != locations_.end()) {
+      forgotten_pack_index = it->second.pack_index;
+      ForgetEntry(it, &appends, &pack_indices_to_delete);
+    }
+  }
+
+  WriteAppends(&appends);
+  {
+    base::AutoLock auto_lock(lock_);
+    FinishAppends(appends, &pack_indices_to_delete);
+  }
+  DeletePackFiles(pack_indices_to_delete);
+  if (forgotten_pack_index >= 0)
+    MaybeCompactPackFile(forgotten_pack_index);
+  return unpacked;
+}
+
+bool SimplePackedStore::RemoveEntry(uint64 entry_hash) {
+  std::vector<PendingAppend> appends;
+  std::vector<int> pack_indices_to_delete;
+  int pack_index = -1;
+  {
+    base::AutoLock auto_lock(lock_);
+    EnsureInitialized();
+    LocationMap::iterator it = locations_.find(entry_hash);
+    if (it == locations_.end())
+      return false;
+    pack_index = it->second.pack_index;
+    ForgetEntry(it, &appends, &pack_indices_to_delete);
+  }
+
+  WriteAppends(&appends);
+  {
+    base::AutoLock auto_lock(lock_);
+    FinishAppends(appends, &pack_indices_to_delete);
+  }
+  DeletePackFiles(pack_indices_to_delete);
+  MaybeCompactPackFile(pack_index);
+  return true;
+}
+
+void SimplePackedStore::GetEntries(std::vector<EntryInfo>* out_entries) {
+  const size_t first_entry = out_entries->size();
+  std::vector<int> entry_pack_indices;
+  std::map<int, base::Time> pack_file_times;
+  {
+    base::AutoLock auto_lock(lock_);
+    EnsureInitialized();
+    for (PackFileMap::const_iterator it = pack_files_.begin();
+         it != pack_files_.end(); ++it) {
+      pack_file_times[it->first];
+    }
+    out_entries->reserve(first_entry + locations_.size());
+    entry_pack_indices.reserve(locations_.size());
+    for (LocationMap::const_iterator it = locations_.begin();
+         it != locations_.end(); ++it) {
+      EntryInfo entry_info;
+      entry_info.entry_hash = it->first;
+      entry_info.size = it->second.size;
+      out_entries->push_back(entry_info);
+      entry_pack_indices.push_back(it->second.pack_index);
+    }
+  }
+
+  for (std::map<int, base::Time>::iterator it = pack_file_times.begin();
+       it != pack_file_times.end(); ++it) {
+    base::File::Info file_info;
+    if (base::GetFileInfo(GetPackFilePath(it->first), &file_info))
+      it->second = file_info.last_modified;
+  }
+  for (size_t i = 0; i < entry_pack_indices.size(); ++i) {
+    (*out_entries)[first_entry + i].last_modified =
+        pack_file_times[entry_pack_indices[i]];
+  }
+}
+
+int64 SimplePackedStore::GetOverheadSize() {
+  base::AutoLock auto_lock(lock_);
+  int64 overhead_size = 0;
+  for (PackFileMap::const_iterator it = pack_files_.begin();
+       it != pack_files_.end(); ++it) {
+    overhead_size += it->second.size - it->second.live_data_size;
+  }
+  return overhead_size;
+}
+
+// static
+void SimplePackedStore::DeleteAllPackFiles(const base::FilePath& path) {
+  base::FileEnumerator enumerator(path, false /* recursive */,
+                                  base::FileEnumerator::FILES,
+                                  std::string(kPackFilePrefix) + "*");
+  for (base::FilePath file_path = enumerator.Next(); !file_path.empty();
+       file_path = enumerator.Next()) {
+    base::DeleteFile(file_path, false);
+  }
+}
+
+size_t SimplePackedStore::GetPackedEntryCountForTesting() {
+  base::AutoLock auto_lock(lock_);
+  EnsureInitialized();
+  return locations_.size();
+}
+
+void SimplePackedStore::EnsureInitialized() {
+  lock_.AssertAcquired();
+  while (initializing_)
+    initialized_cv_.Wait();
+  if (initialized_)
+    return;
+  initializing_ = true;
+
+  LocationMap locations;
+  PackFileMap pack_files;
+  std::vector<int> pack_indices;
+  {
+    // Everything but GetOverheadSize() waits for |initialized_|, so nothing
+    // else touches the pack files during the scan.
+    base::AutoUnlock auto_unlock(lock_);
+    base::FileEnumerator enumerator(path_, false /* recursive */,
+                                    base::FileEnumerator::FILES,
+                                    std::string(kPackFilePrefix) + "*");
+    for (base::FilePath file_path = enumerator.Next(); !file_path.empty();
+         file_path = enumerator.Next()) {
+      const std::string base_name = file_path.BaseName().MaybeAsASCII();
+      int pack_index;
+      if (base::StringToInt(base_name.substr(arraysize(kPackFilePrefix) - 1),
+                            &pack_index) && pack_index >= 0) {
+        pack_indices.push_back(pack_index);
+      }
+    }
+
+    // Records in later pack files are more recent.
+    std::sort(pack_indices.begin(), pack_indices.end());
+    for (size_t i = 0; i < pack_indices.size(); ++i)
+      ScanPackFile(pack_indices[i], &locations, &pack_files);
+
+    for (PackFileMap::iterator it = pack_files.begin();
+         it != pack_files.end();) {
+      if (it->second.live_entry_count == 0) {
+        base::DeleteFile(GetPackFilePath(it->first), false);
+        pack_files.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  locations_.swap(locations);
+  pack_files_.swap(pack_files);
+  if (!pack_indices.empty()) {
+    next_pack_index_ = pack_indices.back() + 1;
+    if (pack_files_.count(pack_indices.back()))
+      current_pack_index_ = pack_indices.back();
+  }
+  initializing_ = false;
+  initialized_ = true;
+  initialized_cv_.Broadcast();
+}
+
+void SimplePackedStore::ScanPackFile(int pack_index,
+                                     LocationMap* locations,
+                                     PackFileMap* pack_files) const {
+  base::File pack_file(GetPackFilePath(pack_index),
+                       base::File::FLAG_OPEN | base::File::FLAG_READ |
+                       base::File::FLAG_WRITE);
+  if (!pack_file.IsValid())
+    return;
+  PackFile* pack = &(*pack_files)[pack_index];
+
+  const int64 pack_file_size = pack_file.GetLength();
+  int64 offset = 0;
+  std::vector<char> data;
+  while (offset < pack_file_size) {
+    SimplePackedRecordHeader header;
+    if (pack_file.Read(offset, reinterpret_cast<char*>(&header),
+                       sizeof(header)) != sizeof(header) ||
+        header.packed_record_magic_number != kSimplePackedRecordMagicNumber) {
+      break;
+    }
+    const int64 data_offset = offset + sizeof(header);
+    if (header.flags & SimplePackedRecordHeader::FLAG_TOMBSTONE) {
+      LocationMap::iterator it = locations->find(header.entry_hash);
+      if (it != locations->end() && it->second.pack_index == pack_index) {
+        --pack->live_entry_count;
+        pack->live_data_size -= it->second.size;
+        locations->erase(it);
+      }
+      offset = data_offset;
+      continue;
+    }
+
+    if (header.data_size == 0 ||
+        static_cast<int64>(header.data_size) > pack_file_size - data_offset) {
+      break;
+    }
+    data.resize(header.data_size);
+    if (pack_file.Read(data_offset, &data[0], header.data_size) !=
+            static_cast<int>(header.data_size) ||
+        CalculateCrc32(&data[0], header.data_size) != header.data_crc32) {
+      break;
+    }
+
+    LocationMap::iterator it = locations->find(header.entry_hash);
+    if (it != locations->end()) {
+      PackFile* old_pack = &(*pack_files)[it->second.pack_index];
+      --old_pack->live_entry_count;
+      old_pack->live_data_size -= it->second.size;
+      locations->erase(it);
+    }
+    Location location;
+    location.pack_index = pack_index;
+    location.offset = data_offset;
+    location.size = header.data_size;
+    locations->insert(std::make_pair(header.entry_hash, location));
+    ++pack->live_entry_count;
+    pack->live_data_size += location.size;
+    offset = data_offset + header.data_size;
+  }
+
+  // Drop a torn record left by a crash while appending.
+  if (offset < pack_file_size)
+    pack_file.SetLength(offset);
+  pack->size = offset;
+}
+
+void SimplePackedStore::EnsureCurrentPackFile(
+    std::vector<int>* pack_indices_to_delete) {
+  lock_.AssertAcquired();
+  if (current_pack_index_ >= 0 &&
+      pack_files_[current_pack_index_].size < kMaxPackFileSize) {
+    return;
+  }
+
+  const int old_pack_index = current_pack_index_;
+  current_pack_index_ = next_pack_index_++;
+  pack_files_.insert(std::make_pair(current_pack_index_, PackFile()));
+  if (old_pack_index >= 0)
+    MaybeDeletePackFile(old_pack_index, pack_indices_to_delete);
+}
+
+void SimplePackedStore::ReserveAppend(int pack_index,
+                                      uint64 entry_hash,
+                                      const char* data,
+                                      int32 data_size,
+                                      std::vector<PendingAppend>* appends) {
+  lock_.AssertAcquired();
+  PendingAppend append;
+  append.pack_index = pack_index;
+  append.header.packed_record_magic_number = kSimplePackedRecordMagicNumber;
+  append.header.entry_hash = entry_hash;
+  if (data)
+    append.header.data_size = data_size;
+  else
+    append.header.flags = SimplePackedRecordHeader::FLAG_TOMBSTONE;
+  append.data = data;
+  append.written = false;
+
+  PackFile& pack = pack_files_[pack_index];
+  append.offset = pack.size;
+  pack.size += sizeof(append.header) + append.header.data_size;
+  ++pack.pending_io_count;
+  appends->push_back(append);
+}
+
+void SimplePackedStore::WriteAppends(
+    std::vector<PendingAppend>* appends) const {
+  for (size_t i = 0; i < appends->size(); ++i) {
+    PendingAppend& append = (*appends)[i];
+    const int data_size = append.header.data_size;
+    if (append.data)
+      append.header.data_crc32 = CalculateCrc32(append.data, data_size);
+
+    base::File pack_file(GetPackFilePath(append.pack_index),
+                         base::File::FLAG_OPEN_ALWAYS |
+                         base::File::FLAG_WRITE);
+    append.written =
+        pack_file.IsValid() &&
+        pack_file.Write(append.offset,
+                        reinterpret_cast<const char*>(&append.header),
+                        sizeof(append.header)) == sizeof(append.header) &&
+        (data_size == 0 ||
+         pack_file.Write(append.offset + sizeof(append.header), append.data,
+                         data_size) == data_size);
+    if (!append.written)
+      LOG(WARNING) << "Could not append to simple cache pack file.";
+  }
+}
+
+void SimplePackedStore::FinishAppends(
+    const std::vector<PendingAppend>& appends,
+    std::vector<int>* pack_indices_to_delete) {
+  lock_.AssertAcquired();
+  for (size_t i = 0; i < appends.size(); ++i) {
+    const int pack_index = appends[i].pack_index;
+    PackFileMap::iterator it = pack_files_.find(pack_index);
+    DCHECK(it != pack_files_.end());
+    --it->second.pending_io_count;
+    // The scan stops at a failed append, losing the records after it; do not
+    // add more of those.
+    if (!appends[i].written && pack_index == current_pack_index_)
+      current_pack_index_ = -1;
+    MaybeDeletePackFile(pack_index, pack_indices_to_delete);
+  }
+}
+
+void SimplePackedStore::ForgetEntry(LocationMap::iterator it,
+                                    std::vector<PendingAppend>* appends,
+                                    std::vector<int>* pack_indices_to_delete) {
+  lock_.AssertAcquired();
+  const uint64 entry_hash = it->first;
+  const int pack_index = it->second.pack_index;
+  PackFile& pack = pack_files_[pack_index];
+  --pack.live_entry_count;
+  pack.live_data_size -= it->second.size;
+  locations_.erase(it);
+
+  LocationMap::iterator moving_it = moving_locations_.find(entry_hash);
+  if (moving_it != moving_locations_.end()) {
+    // The copy a compaction is writing goes too. Its tombstone is reserved
+    // after it, so it cancels it.
+    ReserveAppend(moving_it->second.pack_index, entry_hash, NULL, 0, appends);
+    moving_locations_.erase(moving_it);
+  }
+
+  // Unless the whole pack file goes, cancel the record with a tombstone.
+  MaybeDeletePackFile(pack_index, pack_indices_to_delete);
+  if (pack_files_.count(pack_index))
+    ReserveAppend(pack_index, entry_hash, NULL, 0, appends);
+}
+
+void SimplePackedStore::MaybeDeletePackFile(
+    int pack_index,
+    std::vector<int>* pack_indices_to_delete) {
+  lock_.AssertAcquired();
+  PackFileMap::iterator it = pack_files_.find(pack_index);
+  if (it == pack_files_.end() || pack_index == current_pack_index_ ||
+      it->second.live_entry_count > 0 || it->second.pending_io_count > 0) {
+    return;
+  }
+  // Pack indices are never reused, so the file can be deleted after releasing
+  // |lock_|.
+  pack_files_.erase(it);
+  pack_indices_to_delete->push_back(pack_index);
+}
+
+void SimplePackedStore::DeletePackFiles(
+    const std::vector<int>& pack_indices) const {
+  for (size_t i = 0; i < pack_indices.size(); ++i)
+    base::DeleteFile(GetPackFilePath(pack_indices[i]), false);
+}
+
+void SimplePackedStore::MaybeCompactPackFile(int pack_index) {
+  typedef std::vector<std::pair<uint64, Location> > RecordList;
+  RecordList records;
+  {
+    base::AutoLock auto_lock(lock_);
+    PackFileMap::iterator it = pack_files_.find(pack_index);
+    if (compacting_ || it == pack_files_.end())
+      return;
+    const PackFile& pack = it->second;
+    const int64 live_size =
+        pack.live_data_size +
+        pack.live_entry_count *
+            static_cast<int64>(sizeof(SimplePackedRecordHeader));
+    const int64 dead_size = pack.size - live_size;
+    if (dead_size < kMinCompactionDeadSize || dead_size <= live_size)
+      return;
+
+    compacting_ = true;
+    ++it->second.pending_io_count;
+    if (pack_index == current_pack_index_)
+      current_pack_index_ = -1;
+    for (LocationMap::const_iterator location_it = locations_.begin();
+         location_it != locations_.end(); ++location_it) {
+      if (location_it->second.pack_index == pack_index)
+        records.push_back(*location_it);
+    }
+  }
+
+  // Records that could not be read stay where they are.
+  std::vector<std::string> record_data(records.size());
+  base::File pack_file(GetPackFilePath(pack_index),
+                       base::File::FLAG_OPEN | base::File::FLAG_READ);
+  for (size_t i = 0; i < records.size() && pack_file.IsValid(); ++i) {
+    const Location& location = records[i].second;
+    record_data[i].resize(location.size);
+    if (pack_file.Read(location.offset, &record_data[i][0], location.size) !=
+        location.size) {
+      record_data[i].clear();
+    }
+  }
+  pack_file.Close();
+
+  std::vector<PendingAppend> appends;
+  std::vector<int> pack_indices_to_delete;
+  {
+    base::AutoLock auto_lock(lock_);
+    for (size_t i = 0; i < records.size(); ++i) {
+      // Skip the entries removed or repacked since the records were listed.
+      LocationMap::const_iterator it = locations_.find(records[i].first);
+      if (record_data[i].empty() || it == locations_.end() ||
+          it->second.pack_index != pack_index ||
+          it->second.offset != records[i].second.offset) {
+        continue;
+      }
+      EnsureCurrentPackFile(&pack_indices_to_delete);
+      ReserveAppend(current_pack_index_, records[i].first,
+                    record_data[i].data(), record_data[i].size(), &appends);
+      Location new_location;
+      new_location.pack_index = current_pack_index_;
+      new_location.offset =
+          appends.back().offset + sizeof(SimplePackedRecordHeader);
+      new_location.size = record_data[i].size();
+      moving_locations_[records[i].first] = new_location;
+    }
+  }
+
+  WriteAppends(&appends);
+  {
+    base::AutoLock auto_lock(lock_);
+    for (size_t i = 0; i < appends.size(); ++i) {
+      const uint64 entry_hash = appends[i].header.entry_hash;
+      LocationMap::iterator moving_it = moving_locations_.find(entry_hash);
+      if (moving_it == moving_locations_.end())
+        continue;
+      const Location new_location = moving_it->second;
+      moving_locations_.erase(moving_it);
+      if (!appends[i].written)
+        continue;
+
+      LocationMap::iterator it = locations_.find(entry_hash);
+      DCHECK(it != locations_.end());
+      PackFile& old_pack = pack_files_[it->second.pack_index];
+      --old_pack.live_entry_count;
+      old_pack.live_data_size -= it->second.size;
+      it->second = new_location;
+      PackFile& new_pack = pack_files_[new_location.pack_index];
+      ++new_pack.live_entry_count;
+      new_pack.live_data_size += new_location.size;
+    }
+    FinishAppends(appends, &pack_indices_to_delete);
+    --pack_files_[pack_index].pending_io_count;
+    MaybeDeletePackFile(pack_index, &pack_indices_to_delete);
+    compacting_ = false;
+  }
+  DeletePackFiles(pack_indices_to_delete);
+}
+
+}  // namespace disk_cache
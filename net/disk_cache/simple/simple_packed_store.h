@@ -0,0 +1,221 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_PACKED_STORE_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_PACKED_STORE_H_
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/gtest_prod_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+struct SimplePackedRecordHeader;
+
+// Stores small Simple cache entries in shared, append-only pack files instead
+// of one file per entry. A packed entry is stored as the exact contents of its
+// stream 0 and 1 file, so a SimpleSynchronousEntry can read it in place given
+// the offset of the record. Packed entries never have a stream 2 file nor a
+// sparse file.
+//
+// Removing an entry appends a tombstone record to the pack file holding it.
+// Pack files are deleted once all the entries they hold are gone, and once
+// more than half of one is dead records and tombstones, its live records are
+// moved to the current pack file so that it can go. The table mapping entries
+// to records is rebuilt by scanning the pack files the first time the store is
+// used.
+//
+// This class is thread safe. |lock_| only guards the bookkeeping: offsets in
+// pack files are reserved while holding it, and the records are written after
+// releasing it. All methods but GetOverheadSize() block on IO and must only be
+// used on the worker pool.
+class NET_EXPORT_PRIVATE SimplePackedStore
+    : public base::RefCountedThreadSafe<SimplePackedStore> {
+ public:
+  // Where the stream 0 and 1 file of a packed entry is stored.
+  struct Location {
+    Location();
+
+    int pack_index;
+    int64 offset;
+    int32 size;
+  };
+
+  // What the index needs to know about a packed entry.
+  struct EntryInfo {
+    uint64 entry_hash;
+    int32 size;
+    // Packed entries have no times of their own; this is the last
+    // modification time of their pack file.
+    base::Time last_modified;
+  };
+
+  // Entries whose stream 0 and 1 file is at most |max_packed_entry_size| bytes
+  // long are packed in the directory |path|.
+  SimplePackedStore(const base::FilePath& path, int max_packed_entry_size);
+
+  // Returns true if an entry file of |file_size| bytes may be packed.
+  bool CanPack(int64 file_size) const;
+
+  // Returns true and sets |out_location| if |entry_hash| is packed.
+  bool Lookup(uint64 entry_hash, Location* out_location);
+
+  base::FilePath GetPackFilePath(int pack_index) const;
+
+  // Moves |entry_file|, the stream 0 and 1 file of |entry_hash|, into the
+  // current pack file, then deletes it. Returns false, leaving |entry_file| in
+  // place, if it is not a valid entry file or on IO error.
+  bool PackEntryFile(uint64 entry_hash, const base::FilePath& entry_file);
+
+  // Writes the packed entry |entry_hash| back to |entry_file|, then removes
+  // it from the pack.
+  bool UnpackEntryFile(uint64 entry_hash, const base::FilePath& entry_file);
+
+  // Removes |entry_hash| from the pack. Returns false if it was not packed.
+  bool RemoveEntry(uint64 entry_hash);
+
+  // Returns every packed entry, for rebuilding the index from disk.
+  void GetEntries(std::vector<EntryInfo>* out_entries);
+
+  // Returns the bytes taken by the pack files beyond the size of the entries
+  // they hold: record headers, tombstones and dead records. Does no IO, so
+  // that the index can charge them to the cache size from the IO thread.
+  int64 GetOverheadSize();
+
+  // Deletes the pack files in the directory |path|, for when entries aren't
+  // packed. Their entries are lost.
+  static void DeleteAllPackFiles(const base::FilePath& path);
+
+  size_t GetPackedEntryCountForTesting();
+
+ private:
+  friend class base::RefCountedThreadSafe<SimplePackedStore>;
+  FRIEND_TEST_ALL_PREFIXES(SimplePackedStoreTest, RotatesPackFiles);
+  FRIEND_TEST_ALL_PREFIXES(SimplePackedStoreTest, CompactsPackFiles);
+
+  // A record to append to a pack file, at an offset reserved with |lock_|
+  // held, and written after releasing it. Defined in the .cc file.
+  struct PendingAppend;
+
+  // What is known about a pack file.
+  struct PackFile {
+    PackFile();
+
+    // Number of live entries in the pack file, and the sum of their sizes.
+    int live_entry_count;
+    int64 live_data_size;
+
+    // Size of the pack file including the appends in flight, i.e. the offset
+    // the next record goes at.
+    int64 size;
+
+    // Reads and appends in flight. A pack file is only deleted once it has no
+    // live entries and no IO in flight.
+    int pending_io_count;
+  };
+
+  typedef base::hash_map<uint64, Location> LocationMap;
+  typedef std::map<int, PackFile> PackFileMap;
+
+  // Pack files are rotated once they grow past this size.
+  static const int64 kMaxPackFileSize = 4 * 1024 * 1024;
+
+  // A pack file is compacted once more than half of it is dead, and at least
+  // this many bytes are.
+  static const int64 kMinCompactionDeadSize = 64 * 1024;
+
+  ~SimplePackedStore();
+
+  // Scans the pack files to rebuild |locations_| on first use. Must be called
+  // with |lock_| held, which is released during the scan; other callers wait
+  // for the scan to finish.
+  void EnsureInitialized();
+
+  // Reads the records of pack file |pack_index|, in order, into |locations|
+  // and |pack_files|. Truncates the pack file after the last valid record.
+  void ScanPackFile(int pack_index,
+                    LocationMap* locations,
+                    PackFileMap* pack_files) const;
+
+  // Makes sure there is a current pack file with room left, rotating it if it
+  // is full. Must be called with |lock_| held.
+  void EnsureCurrentPackFile(std::vector<int>* pack_indices_to_delete);
+
+  // Reserves room in pack file |pack_index| for a record of |entry_hash| with
+  // |data_size| bytes of |data|, or for a tombstone if |data| is NULL. Must be
+  // called with |lock_| held.
+  void ReserveAppend(int pack_index,
+                     uint64 entry_hash,
+                     const char* data,
+                     int32 data_size,
+                     std::vector<PendingAppend>* appends);
+
+  // Writes |appends| to their pack files. Must be called without |lock_|.
+  void WriteAppends(std::vector<PendingAppend>* appends) const;
+
+  // Releases the pack files |appends| were written to. Must be called with
+  // |lock_| held.
+  void FinishAppends(const std::vector<PendingAppend>& appends,
+                     std::vector<int>* pack_indices_to_delete);
+
+  // Forgets about |entry_hash| and reserves a tombstone for it, or queues the
+  // pack file that held it for deletion if that was its last live entry. Must
+  // be called with |lock_| held.
+  void ForgetEntry(LocationMap::iterator it,
+                   std::vector<PendingAppend>* appends,
+                   std::vector<int>* pack_indices_to_delete);
+
+  // Queues pack file |pack_index| for deletion if nothing uses it anymore.
+  // Must be called with |lock_| held.
+  void MaybeDeletePackFile(int pack_index,
+                           std::vector<int>* pack_indices_to_delete);
+
+  // Deletes the pack files queued for deletion. Must be called without
+  // |lock_|.
+  void DeletePackFiles(const std::vector<int>& pack_indices) const;
+
+  // Moves the live records of pack file |pack_index| to the current pack file
+  // if enough of it is dead. Must be called without |lock_|.
+  void MaybeCompactPackFile(int pack_index);
+
+  const base::FilePath path_;
+  const int max_packed_entry_size_;
+
+  base::Lock lock_;
+
+  // Signaled once the pack files have been scanned.
+  base::ConditionVariable initialized_cv_;
+  bool initializing_;
+  bool initialized_;
+
+  LocationMap locations_;
+  PackFileMap pack_files_;
+
+  // The new locations of the entries whose records are being copied by a
+  // compaction. An entry removed meanwhile is dropped from here, so that the
+  // compaction does not bring it back.
+  LocationMap moving_locations_;
+  bool compacting_;
+
+  // The pack file new entries are appended to, |current_pack_index_| is -1
+  // until one is opened.
+  int current_pack_index_;
+  int next_pack_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimplePackedStore);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_PACKED_STORE_H_
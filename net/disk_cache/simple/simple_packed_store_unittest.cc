@@ -0,0 +1,210 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_packed_store.h"
+
+#include <string>
+
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "net/disk_cache/simple/simple_entry_format.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+
+namespace {
+
+// Returns the contents of a minimal stream 0 and 1 file with |payload| as its
+// key and data.
+std::string MakeEntryFileContents(const std::string& payload) {
+  SimpleFileHeader header;
+  header.initial_magic_number = kSimpleInitialMagicNumber;
+  header.key_length = payload.size();
+  SimpleFileEOF eof;
+  eof.final_magic_number = kSimpleFinalMagicNumber;
+  std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+  contents += payload;
+  contents.append(reinterpret_cast<const char*>(&eof), sizeof(eof));
+  return contents;
+}
+
+}  // namespace
+
+class SimplePackedStoreTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    store_ = new SimplePackedStore(temp_dir_.path(), 4096);
+  }
+
+  base::FilePath WriteEntryFile(const std::string& name,
+                                const std::string& contents) {
+    base::FilePath path = temp_dir_.path().AppendASCII(name);
+    EXPECT_EQ(static_cast<int>(contents.size()),
+              file_util::WriteFile(path, contents.data(), contents.size()));
+    return path;
+  }
+
+  // Simulates a restart of the backend.
+  void ReopenStore() {
+    store_ = new SimplePackedStore(temp_dir_.path(), 4096);
+  }
+
+  base::ScopedTempDir temp_dir_;
+  scoped_refptr<SimplePackedStore> store_;
+};
+
+TEST_F(SimplePackedStoreTest, PackAndUnpack) {
+  const std::string contents = MakeEntryFileContents("some key and data");
+  const base::FilePath entry_file = WriteEntryFile("entry_0", contents);
+
+  ASSERT_TRUE(store_->PackEntryFile(11, entry_file));
+  EXPECT_FALSE(base::PathExists(entry_file));
+
+  SimplePackedStore::Location location;
+  ASSERT_TRUE(store_->Lookup(11, &location));
+  EXPECT_EQ(static_cast<int>(contents.size()), location.size);
+  std::string pack_contents;
+  ASSERT_TRUE(base::ReadFileToString(
+      store_->GetPackFilePath(location.pack_index), &pack_contents));
+  EXPECT_EQ(contents, pack_contents.substr(location.offset, location.size));
+
+  ASSERT_TRUE(store_->UnpackEntryFile(11, entry_file));
+  EXPECT_FALSE(store_->Lookup(11, &location));
+  std::string unpacked_contents;
+  ASSERT_TRUE(base::ReadFileToString(entry_file, &unpacked_contents));
+  EXPECT_EQ(contents, unpacked_contents);
+}
+
+TEST_F(SimplePackedStoreTest, RejectsInvalidOrLargeFiles) {
+  const base::FilePath garbage_file = WriteEntryFile("garbage", "not an entry");
+  EXPECT_FALSE(store_->PackEntryFile(1, garbage_file));
+  EXPECT_TRUE(base::PathExists(garbage_file));
+
+  const base::FilePath large_file = WriteEntryFile(
+      "large", MakeEntryFileContents(std::string(8192, 'x')));
+  EXPECT_FALSE(store_->PackEntryFile(2, large_file));
+  EXPECT_TRUE(base::PathExists(large_file));
+  EXPECT_EQ(0U, store_->GetPackedEntryCountForTesting());
+}
+
+TEST_F(SimplePackedStoreTest, RebuildsLocationsFromPackFiles) {
+  ASSERT_TRUE(store_->PackEntryFile(
+      1, WriteEntryFile("a", MakeEntryFileContents("first"))));
+  ASSERT_TRUE(store_->PackEntryFile(
+      2, WriteEntryFile("b", MakeEntryFileContents("second"))));
+  ASSERT_TRUE(store_->PackEntryFile(
+      3, WriteEntryFile("c", MakeEntryFileContents("third"))));
+  store_->RemoveEntry(2);
+
+  SimplePackedStore::Location location_before;
+  ASSERT_TRUE(store_->Lookup(3, &location_before));
+
+  ReopenStore();
+  EXPECT_EQ(2U, store_->GetPackedEntryCountForTesting());
+  SimplePackedStore::Location location;
+  EXPECT_TRUE(store_->Lookup(1, &location));
+  EXPECT_FALSE(store_->Lookup(2, &location));
+  ASSERT_TRUE(store_->Lookup(3, &location));
+  EXPECT_EQ(location_before.pack_index, location.pack_index);
+  EXPECT_EQ(location_before.offset, location.offset);
+  EXPECT_EQ(location_before.size, location.size);
+}
+
+TEST_F(SimplePackedStoreTest, DropsTornRecord) {
+  ASSERT_TRUE(store_->PackEntryFile(
+      1, WriteEntryFile("a", MakeEntryFileContents("first"))));
+  SimplePackedStore::Location location;
+  ASSERT_TRUE(store_->Lookup(1, &location));
+  const base::FilePath pack_file = store_->GetPackFilePath(location.pack_index);
+  const char kGarbage[] = "torn record";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            file_util::AppendToFile(pack_file, kGarbage, sizeof(kGarbage)));
+
+  ReopenStore();
+  EXPECT_TRUE(store_->Lookup(1, &location));
+  int64 pack_file_size = 0;
+  ASSERT_TRUE(base::GetFileSize(pack_file, &pack_file_size));
+  EXPECT_EQ(location.offset + location.size, pack_file_size);
+}
+
+TEST_F(SimplePackedStoreTest, RotatesPackFiles) {
+  const std::string contents = MakeEntryFileContents(std::string(4000, 'x'));
+  const int kEntryCount =
+      SimplePackedStore::kMaxPackFileSize / contents.size() + 2;
+  for (int i = 0; i < kEntryCount; ++i) {
+    ASSERT_TRUE(store_->PackEntryFile(i, WriteEntryFile("entry", contents)));
+  }
+  SimplePackedStore::Location first_location;
+  SimplePackedStore::Location last_location;
+  ASSERT_TRUE(store_->Lookup(0, &first_location));
+  ASSERT_TRUE(store_->Lookup(kEntryCount - 1, &last_location));
+  EXPECT_NE(first_location.pack_index, last_location.pack_index);
+
+  // Removing every entry of a full pack file deletes it.
+  const base::FilePath first_pack_file =
+      store_->GetPackFilePath(first_location.pack_index);
+  for (int i = 0; i < kEntryCount; ++i) {
+    SimplePackedStore::Location location;
+    ASSERT_TRUE(store_->Lookup(i, &location));
+    if (location.pack_index == first_location.pack_index)
+      store_->RemoveEntry(i);
+  }
+  EXPECT_FALSE(base::PathExists(first_pack_file));
+}
+
+TEST_F(SimplePackedStoreTest, CompactsPackFiles) {
+  // Enough entries for the records of three quarters of them to be more than
+  // the dead size compaction waits for.
+  const int kEntrySize = 2000;
+  const int kEntryCount =
+      2 * SimplePackedStore::kMinCompactionDeadSize / kEntrySize;
+  for (int i = 0; i < kEntryCount; ++i) {
+    ASSERT_TRUE(store_->PackEntryFile(
+        i, WriteEntryFile("entry", MakeEntryFileContents(
+            std::string(kEntrySize, 'a' + i % 26)))));
+  }
+  SimplePackedStore::Location first_location;
+  ASSERT_TRUE(store_->Lookup(0, &first_location));
+  const base::FilePath first_pack_file =
+      store_->GetPackFilePath(first_location.pack_index);
+
+  for (int i = 0; i < kEntryCount; ++i) {
+    if (i % 4 != 0)
+      ASSERT_TRUE(store_->RemoveEntry(i));
+  }
+  EXPECT_FALSE(base::PathExists(first_pack_file));
+
+  for (int pass = 0; pass < 2; ++pass) {
+    int64 pack_files_size = 0;
+    int64 live_data_size = 0;
+    for (int i = 0; i < kEntryCount; ++i) {
+      SimplePackedStore::Location location;
+      if (i % 4 != 0) {
+        EXPECT_FALSE(store_->Lookup(i, &location));
+        continue;
+      }
+      ASSERT_TRUE(store_->Lookup(i, &location));
+      EXPECT_NE(first_location.pack_index, location.pack_index);
+      std::string pack_contents;
+      ASSERT_TRUE(base::ReadFileToString(
+          store_->GetPackFilePath(location.pack_index), &pack_contents));
+      EXPECT_EQ(MakeEntryFileContents(std::string(kEntrySize, 'a' + i % 26)),
+                pack_contents.substr(location.offset, location.size));
+      if (i == 0) {
+        pack_files_size = pack_contents.size();
+      } else {
+        // The surviving records all went to one pack file.
+        EXPECT_EQ(pack_files_size, static_cast<int64>(pack_contents.size()));
+      }
+      live_data_size += location.size;
+    }
+    // The pack file bytes not taken by live entries are charged as overhead.
+    EXPECT_EQ(pack_files_size - live_data_size, store_->GetOverheadSize());
+    ReopenStore();
+  }
+}
+
+}  // namespace disk_cache
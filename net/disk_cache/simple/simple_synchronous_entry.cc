@@ -6,7 +6,6 @@
 
 #include <algorithm>
 #include <cstring>
-#include <functional>
 #include <limits>
 
 #include "base/basictypes.h"
@@ -20,6 +19,7 @@
 #include "net/base/net_errors.h"
 #include "net/disk_cache/simple/simple_backend_version.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
+#include "net/disk_cache/simple/simple_packed_store.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
 
@@ -213,9 +213,10 @@ void SimpleSynchronousEntry::OpenEntry(
     const FilePath& path,
     const uint64 entry_hash,
     bool had_index,
+    SimplePackedStore* packed_store,
     SimpleEntryCreationResults *out_results) {
-  SimpleSynchronousEntry* sync_entry =
-      new SimpleSynchronousEntry(cache_type, path, "", entry_hash);
+  SimpleSynchronousEntry* sync_entry = new SimpleSynchronousEntry(
+      cache_type, path, "", entry_hash, packed_store);
   out_results->result =
       sync_entry->InitializeForOpen(had_index,
                                     &out_results->entry_stat,
@@ -238,10 +239,11 @@ void SimpleSynchronousEntry::CreateEntry(
     const std::string& key,
     const uint64 entry_hash,
     bool had_index,
+    SimplePackedStore* packed_store,
     SimpleEntryCreationResults *out_results) {
   DCHECK_EQ(entry_hash, GetEntryHashKey(key));
-  SimpleSynchronousEntry* sync_entry =
-      new SimpleSynchronousEntry(cache_type, path, key, entry_hash);
+  SimpleSynchronousEntry* sync_entry = new SimpleSynchronousEntry(
+      cache_type, path, key, entry_hash, packed_store);
   out_results->result = sync_entry->InitializeForCreate(
       had_index, &out_results->entry_stat);
   if (out_results->result != net::OK) {
@@ -257,18 +259,24 @@ void SimpleSynchronousEntry::CreateEntry(
 // static
 int SimpleSynchronousEntry::DoomEntry(
     const FilePath& path,
-    uint64 entry_hash) {
-  const bool deleted_well = DeleteFilesForEntryHash(path, entry_hash);
+    uint64 entry_hash,
+    SimplePackedStore* packed_store) {
+  const bool deleted_well =
+      DeleteFilesForEntryHash(path, entry_hash, packed_store);
   return deleted_well ? net::OK : net::ERR_FAILED;
 }
 
 // static
 int SimpleSynchronousEntry::DoomEntrySet(
     const std::vector<uint64>* key_hashes,
-    const FilePath& path) {
-  const size_t did_delete_count = std::count_if(
-      key_hashes->begin(), key_hashes->end(), std::bind1st(
-          std::ptr_fun(SimpleSynchronousEntry::DeleteFilesForEntryHash), path));
+    const FilePath& path,
+    SimplePackedStore* packed_store) {
+  size_t did_delete_count = 0;
+  for (std::vector<uint64>::const_iterator it = key_hashes->begin();
+       it != key_hashes->end(); ++it) {
+    if (DeleteFilesForEntryHash(path, *it, packed_store))
+      ++did_delete_count;
+  }
   return (did_delete_count == key_hashes->size()) ? net::OK : net::ERR_FAILED;
 }
 
@@ -286,9 +294,8 @@ void SimpleSynchronousEntry::ReadData(const EntryOperationData& in_entry_op,
   // be handled in the SimpleEntryImpl.
   DCHECK_LT(0, in_entry_op.buf_len);
   DCHECK(!empty_file_omitted_[file_index]);
-  File* file = const_cast<File*>(&files_[file_index]);
-  int bytes_read =
-      file->Read(file_offset, out_buf->data(), in_entry_op.buf_len);
+  int bytes_read = ReadFromFile(
+      file_index, file_offset, out_buf->data(), in_entry_op.buf_len);
   if (bytes_read > 0) {
     entry_stat->set_last_used(Time::Now());
     *out_crc32 = crc32(crc32(0L, Z_NULL, 0),
@@ -319,6 +326,15 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
       key_, in_entry_op.offset, in_entry_op.index);
   bool extending_by_write = offset + buf_len > out_entry_stat->data_size(index);
 
+  if (packed_ && file_index == 0) {
+    if (doomed || !UnpackEntryFile()) {
+      RecordWriteResult(cache_type_, WRITE_RESULT_WRITE_FAILURE);
+      Doom();
+      *out_result = net::ERR_CACHE_WRITE_FAILURE;
+      return;
+    }
+  }
+
   if (empty_file_omitted_[file_index]) {
     // Don't create a new file if the entry has been doomed, to avoid it being
     // mixed up with a newly-created entry with the same key.
@@ -621,11 +637,18 @@ void SimpleSynchronousEntry::CheckEOFRecord(int index,
 void SimpleSynchronousEntry::Close(
     const SimpleEntryStat& entry_stat,
     scoped_ptr<std::vector<CRCRecord> > crc32s_to_write,
-    net::GrowableIOBuffer* stream_0_data) {
+    net::GrowableIOBuffer* stream_0_data,
+    bool doomed) {
   DCHECK(stream_0_data);
+  // A packed entry is read in place from its pack file, and only needs its own
+  // file back if a stream changed.
+  if (packed_ && !crc32s_to_write->empty() && !UnpackEntryFile())
+    DVLOG(1) << "Could not unpack entry file.";
+
   // Write stream 0 data.
   int stream_0_offset = entry_stat.GetOffsetInFile(key_, 0, 0);
-  if (files_[0].Write(stream_0_offset, stream_0_data->data(),
+  if (!packed_ &&
+      files_[0].Write(stream_0_offset, stream_0_data->data(),
                       entry_stat.data_size(0)) !=
       entry_stat.data_size(0)) {
     RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
@@ -673,6 +696,8 @@ void SimpleSynchronousEntry::Close(
       continue;
 
     files_[i].Close();
+    if (i == 0 && packed_)
+      continue;
     const int64 file_size = entry_stat.GetFileSize(key_, i);
     SIMPLE_CACHE_UMA(CUSTOM_COUNTS,
                      "LastClusterSize", cache_type_,
@@ -683,11 +708,18 @@ void SimpleSynchronousEntry::Close(
                      cluster_loss * 100 / (cluster_loss + file_size));
   }
 
+  const bool had_sparse_file = sparse_file_open();
   if (sparse_file_open())
     sparse_file_.Close();
 
+  const int stream2_file_index = GetFileIndexFromStreamIndex(2);
+  if (packed_store_.get() && !packed_ && !doomed && !had_sparse_file &&
+      empty_file_omitted_[stream2_file_index] &&
+      packed_store_->CanPack(entry_stat.GetFileSize(key_, 0))) {
+    packed_store_->PackEntryFile(entry_hash_, GetFilenameFromFileIndex(0));
+  }
+
   if (files_created_) {
-    const int stream2_file_index = GetFileIndexFromStreamIndex(2);
     SIMPLE_CACHE_UMA(BOOLEAN, "EntryCreatedAndStream2Omitted", cache_type_,
                      empty_file_omitted_[stream2_file_index]);
   }
@@ -699,13 +731,18 @@ void SimpleSynchronousEntry::Close(
 SimpleSynchronousEntry::SimpleSynchronousEntry(net::CacheType cache_type,
                                                const FilePath& path,
                                                const std::string& key,
-                                               const uint64 entry_hash)
+                                               const uint64 entry_hash,
+                                               SimplePackedStore* packed_store)
     : cache_type_(cache_type),
       path_(path),
       entry_hash_(entry_hash),
       key_(key),
       have_open_files_(false),
-      initialized_(false) {
+      initialized_(false),
+      packed_store_(packed_store),
+      packed_(false),
+      packed_offset_(0),
+      packed_size_(0) {
   for (int i = 0; i < kSimpleEntryFileCount; ++i)
     empty_file_omitted_[i] = false;
 }
@@ -726,6 +763,21 @@ bool SimpleSynchronousEntry::MaybeOpenFile(
   files_[file_index].Initialize(filename, flags);
   *out_error = files_[file_index].error_details();
 
+  SimplePackedStore::Location location;
+  if (file_index == 0 && !files_[0].IsValid() &&
+      *out_error == File::FILE_ERROR_NOT_FOUND && packed_store_.get() &&
+      packed_store_->Lookup(entry_hash_, &location)) {
+    // A compaction may move the record and delete the pack file meanwhile.
+    files_[0].Initialize(packed_store_->GetPackFilePath(location.pack_index),
+                         File::FLAG_OPEN | File::FLAG_READ |
+                         File::FLAG_SHARE_DELETE);
+    *out_error = files_[0].error_details();
+    packed_ = files_[0].IsValid();
+    packed_offset_ = location.offset;
+    packed_size_ = location.size;
+    return packed_;
+  }
+
   if (CanOmitEmptyFile(file_index) && !files_[file_index].IsValid() &&
       *out_error == File::FILE_ERROR_NOT_FOUND) {
     empty_file_omitted_[file_index] = true;
@@ -825,7 +877,8 @@ bool SimpleSynchronousEntry::OpenFiles(
     // 0, stream 1 and one EOF record. The exact distribution of sizes between
     // stream 1 and stream 0 is only determined after reading the EOF record
     // for stream 0 in ReadAndValidateStream0.
-    out_entry_stat->set_data_size(i + 1, file_info.size);
+    out_entry_stat->set_data_size(
+        i + 1, (i == 0 && packed_) ? packed_size_ : file_info.size);
   }
   SIMPLE_CACHE_UMA(CUSTOM_COUNTS,
                    "SyncOpenEntryAge", cache_type_,
@@ -894,6 +947,34 @@ void SimpleSynchronousEntry::CloseFiles() {
     CloseFile(i);
 }
 
+int SimpleSynchronousEntry::ReadFromFile(int file_index,
+                                         int64 offset,
+                                         char* data,
+                                         int size) const {
+  if (file_index == 0 && packed_) {
+    // Never read past the record into the next one.
+    if (offset + size > packed_size_)
+      size = std::max<int64>(0, packed_size_ - offset);
+    offset += packed_offset_;
+  }
+  File* file = const_cast<File*>(&files_[file_index]);
+  return file->Read(offset, data, size);
+}
+
+bool SimpleSynchronousEntry::UnpackEntryFile() {
+  DCHECK(packed_);
+  files_[0].Close();
+  packed_ = false;
+  packed_offset_ = 0;
+  packed_size_ = 0;
+  if (!packed_store_->UnpackEntryFile(entry_hash_,
+                                      GetFilenameFromFileIndex(0))) {
+    return false;
+  }
+  File::Error error;
+  return MaybeOpenFile(0, &error);
+}
+
 int SimpleSynchronousEntry::InitializeForOpen(
     bool had_index,
     SimpleEntryStat* out_entry_stat,
@@ -910,7 +991,7 @@ int SimpleSynchronousEntry::InitializeForOpen(
 
     SimpleFileHeader header;
     int header_read_result =
-        files_[i].Read(0, reinterpret_cast<char*>(&header), sizeof(header));
+        ReadFromFile(i, 0, reinterpret_cast<char*>(&header), sizeof(header));
     if (header_read_result != sizeof(header)) {
       DLOG(WARNING) << "Cannot read header from entry.";
       RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_HEADER, had_index);
@@ -933,8 +1014,8 @@ int SimpleSynchronousEntry::InitializeForOpen(
     }
 
     scoped_ptr<char[]> key(new char[header.key_length]);
-    int key_read_result = files_[i].Read(sizeof(header), key.get(),
-                                         header.key_length);
+    int key_read_result = ReadFromFile(i, sizeof(header), key.get(),
+                                       header.key_length);
     if (key_read_result != implicit_cast<int>(header.key_length)) {
       DLOG(WARNING) << "Cannot read key from entry.";
       RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_KEY, had_index);
@@ -1026,6 +1107,11 @@ int SimpleSynchronousEntry::InitializeForCreate(
     bool had_index,
     SimpleEntryStat* out_entry_stat) {
   DCHECK(!initialized_);
+  SimplePackedStore::Location location;
+  if (packed_store_.get() && packed_store_->Lookup(entry_hash_, &location)) {
+    DLOG(WARNING) << "Entry is already packed.";
+    return net::ERR_FILE_EXISTS;
+  }
   if (!CreateFiles(had_index, out_entry_stat)) {
     DLOG(WARNING) << "Could not create platform files.";
     return net::ERR_FILE_EXISTS;
@@ -1075,9 +1161,8 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
   *stream_0_data = new net::GrowableIOBuffer();
   (*stream_0_data)->SetCapacity(stream_0_size);
   int file_offset = out_entry_stat->GetOffsetInFile(key_, 0, 0);
-  File* file = const_cast<File*>(&files_[0]);
   int bytes_read =
-      file->Read(file_offset, (*stream_0_data)->data(), stream_0_size);
+      ReadFromFile(0, file_offset, (*stream_0_data)->data(), stream_0_size);
   if (bytes_read != stream_0_size)
     return net::ERR_FAILED;
 
@@ -1106,9 +1191,9 @@ int SimpleSynchronousEntry::GetEOFRecordData(int index,
   SimpleFileEOF eof_record;
   int file_offset = entry_stat.GetEOFOffsetInFile(key_, index);
   int file_index = GetFileIndexFromStreamIndex(index);
-  File* file = const_cast<File*>(&files_[file_index]);
-  if (file->Read(file_offset, reinterpret_cast<char*>(&eof_record),
-                 sizeof(eof_record)) !=
+  if (ReadFromFile(file_index, file_offset,
+                   reinterpret_cast<char*>(&eof_record),
+                   sizeof(eof_record)) !=
       sizeof(eof_record)) {
     RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_READ_FAILURE);
     return net::ERR_CACHE_CHECKSUM_READ_FAILURE;
@@ -1129,7 +1214,7 @@ int SimpleSynchronousEntry::GetEOFRecordData(int index,
 }
 
 void SimpleSynchronousEntry::Doom() const {
-  DeleteFilesForEntryHash(path_, entry_hash_);
+  DeleteFilesForEntryHash(path_, entry_hash_, packed_store_.get());
 }
 
 // static
@@ -1145,11 +1230,17 @@ bool SimpleSynchronousEntry::DeleteFileForEntryHash(
 // static
 bool SimpleSynchronousEntry::DeleteFilesForEntryHash(
     const FilePath& path,
-    const uint64 entry_hash) {
+    const uint64 entry_hash,
+    SimplePackedStore* packed_store) {
+  // A packed entry has no file of its own.
+  const bool was_packed =
+      packed_store && packed_store->RemoveEntry(entry_hash);
   bool result = true;
   for (int i = 0; i < kSimpleEntryFileCount; ++i) {
-    if (!DeleteFileForEntryHash(path, entry_hash, i) && !CanOmitEmptyFile(i))
+    if (!DeleteFileForEntryHash(path, entry_hash, i) && !CanOmitEmptyFile(i) &&
+        !was_packed) {
       result = false;
+    }
   }
   FilePath to_delete = path.AppendASCII(
       GetSparseFilenameFromEntryHash(entry_hash));
@@ -27,6 +27,7 @@ class IOBuffer;
 
 namespace disk_cache {
 
+class SimplePackedStore;
 class SimpleSynchronousEntry;
 
 // This class handles the passing of data about the entry between
@@ -112,10 +113,12 @@ class SimpleSynchronousEntry {
     bool doomed;
   };
 
+  // |packed_store| may be NULL, in which case entries are never packed.
   static void OpenEntry(net::CacheType cache_type,
                         const base::FilePath& path,
                         uint64 entry_hash,
                         bool had_index,
+                        SimplePackedStore* packed_store,
                         SimpleEntryCreationResults* out_results);
 
   static void CreateEntry(net::CacheType cache_type,
@@ -123,19 +126,22 @@ class SimpleSynchronousEntry {
                           const std::string& key,
                           uint64 entry_hash,
                           bool had_index,
+                          SimplePackedStore* packed_store,
                           SimpleEntryCreationResults* out_results);
 
   // Deletes an entry from the file system without affecting the state of the
   // corresponding instance, if any (allowing operations to continue to be
   // executed through that instance). Returns a net error code.
   static int DoomEntry(const base::FilePath& path,
-                       uint64 entry_hash);
+                       uint64 entry_hash,
+                       SimplePackedStore* packed_store);
 
   // Like |DoomEntry()| above. Deletes all entries corresponding to the
   // |key_hashes|. Succeeds only when all entries are deleted. Returns a net
   // error code.
   static int DoomEntrySet(const std::vector<uint64>* key_hashes,
-                          const base::FilePath& path);
+                          const base::FilePath& path,
+                          SimplePackedStore* packed_store);
 
   // N.B. ReadData(), WriteData(), CheckEOFRecord() and Close() may block on IO.
   void ReadData(const EntryOperationData& in_entry_op,
@@ -166,10 +172,12 @@ class SimpleSynchronousEntry {
                          int* out_result);
 
   // Close all streams, and add write EOF records to streams indicated by the
-  // CRCRecord entries in |crc32s_to_write|.
+  // CRCRecord entries in |crc32s_to_write|. Small entries are then moved into
+  // the packed store, unless |doomed| is true.
   void Close(const SimpleEntryStat& entry_stat,
              scoped_ptr<std::vector<CRCRecord> > crc32s_to_write,
-             net::GrowableIOBuffer* stream_0_data);
+             net::GrowableIOBuffer* stream_0_data,
+             bool doomed);
 
   const base::FilePath& path() const { return path_; }
   std::string key() const { return key_; }
@@ -203,7 +211,8 @@ class SimpleSynchronousEntry {
       net::CacheType cache_type,
       const base::FilePath& path,
       const std::string& key,
-      uint64 entry_hash);
+      uint64 entry_hash,
+      SimplePackedStore* packed_store);
 
   // Like Entry, the SimpleSynchronousEntry self releases when Close() is
   // called.
@@ -227,6 +236,14 @@ class SimpleSynchronousEntry {
   void CloseFile(int index);
   void CloseFiles();
 
+  // Reads from one of the entry files, accounting for the position of the
+  // record in the pack file if the entry is packed.
+  int ReadFromFile(int file_index, int64 offset, char* data, int size) const;
+
+  // Moves a packed entry back to its own stream 0 and 1 file, and reopens it
+  // for writing.
+  bool UnpackEntryFile();
+
   // Returns a net error, i.e. net::OK on success. |had_index| is passed
   // from the main entry for metrics purposes, and is true if the index was
   // initialized when the open operation began.
@@ -298,7 +315,8 @@ class SimpleSynchronousEntry {
                                      uint64 entry_hash,
                                      int file_index);
   static bool DeleteFilesForEntryHash(const base::FilePath& path,
-                                      uint64 entry_hash);
+                                      uint64 entry_hash,
+                                      SimplePackedStore* packed_store);
 
   void RecordSyncCreateResult(CreateEntryResult result, bool had_index);
 
@@ -333,6 +351,14 @@ class SimpleSynchronousEntry {
   // True if the entry was created, or false if it was opened. Used to log
   // SimpleCache.*.EntryCreatedWithStream2Omitted only for created entries.
   bool files_created_;
+
+  scoped_refptr<SimplePackedStore> packed_store_;
+
+  // True if |files_[0]| is the read-only pack file holding the |packed_size_|
+  // bytes of this entry file at |packed_offset_|.
+  bool packed_;
+  int64 packed_offset_;
+  int32 packed_size_;
 };
 
 }  // namespace disk_cache
@@ -0,0 +1,661 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/staging_cache_backend.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/stringprintf.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+
+namespace {
+
+const int kNumStreams = 3;
+
+// Closed entries are flushed after this delay, so that the entries of a burst
+// of writes are flushed together.
+const int kFlushDelayMs = 200;
+
+}  // namespace
+
+namespace disk_cache {
+
+// An entry held in memory by a StagingCacheBackend.  The backend owns the
+// entries in memory; an entry removed from memory while it is open deletes
+// itself when closed.
+class StagedEntry : public Entry, public base::LinkNode<StagedEntry> {
+ public:
+  StagedEntry(StagingCacheBackend* backend, const std::string& key);
+
+  void Open();
+  bool IsOpen() const { return ref_count_ > 0; }
+
+  // Called when the entry is removed from memory.
+  void Detach();
+
+  // Returns the bytes used by the entry.
+  int32 GetStorageSize() const;
+
+  // Returns a copy of stream |index|, or NULL if it is empty.
+  scoped_refptr<net::IOBufferWithSize> CopyStreamData(int index) const;
+
+  // True if the entry was modified since it was last sent to the backend.
+  bool dirty() const { return dirty_; }
+  void set_dirty(bool dirty) { dirty_ = dirty; }
+
+  // True while the key is in the flush queue of the backend.
+  bool queued() const { return queued_; }
+  void set_queued(bool queued) { queued_ = queued; }
+
+  // True once the entry was written to the underlying backend.
+  bool flushed() const { return flushed_; }
+  void set_flushed(bool flushed) { flushed_ = flushed; }
+
+  // Entry interface.
+  virtual void Doom() OVERRIDE;
+  virtual void Close() OVERRIDE;
+  virtual std::string GetKey() const OVERRIDE;
+  virtual base::Time GetLastUsed() const OVERRIDE;
+  virtual base::Time GetLastModified() const OVERRIDE;
+  virtual int32 GetDataSize(int index) const OVERRIDE;
+  virtual int ReadData(int index, int offset, IOBuffer* buf, int buf_len,
+                       const CompletionCallback& callback) OVERRIDE;
+  virtual int WriteData(int index, int offset, IOBuffer* buf, int buf_len,
+                        const CompletionCallback& callback,
+                        bool truncate) OVERRIDE;
+  virtual int ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
+                             const CompletionCallback& callback) OVERRIDE;
+  virtual int WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
+                              const CompletionCallback& callback) OVERRIDE;
+  virtual int GetAvailableRange(int64 offset, int len, int64* start,
+                                const CompletionCallback& callback) OVERRIDE;
+  virtual bool CouldBeSparse() const OVERRIDE;
+  virtual void CancelSparseIO() OVERRIDE;
+  virtual int ReadyForSparseIO(const CompletionCallback& callback) OVERRIDE;
+
+ private:
+  friend class StagingCacheBackend;
+
+  virtual ~StagedEntry();
+
+  base::WeakPtr<StagingCacheBackend> backend_;
+  const std::string key_;
+  const int max_entry_size_;
+  std::vector<char> data_[kNumStreams];
+  int ref_count_;
+  bool doomed_;
+  bool dirty_;
+  bool queued_;
+  bool flushed_;
+  base::Time last_used_;
+  base::Time last_modified_;
+
+  DISALLOW_COPY_AND_ASSIGN(StagedEntry);
+};
+
+StagedEntry::StagedEntry(StagingCacheBackend* backend, const std::string& key)
+    : backend_(backend->AsWeakPtr()),
+      key_(key),
+      max_entry_size_(backend->MaxEntrySize()),
+      ref_count_(0),
+      doomed_(false),
+      dirty_(false),
+      queued_(false),
+      flushed_(false),
+      last_used_(base::Time::Now()),
+      last_modified_(last_used_) {
+}
+
+void StagedEntry::Open() {
+  DCHECK(!doomed_);
+  ref_count_++;
+  last_used_ = base::Time::Now();
+  if (backend_.get())
+    backend_->OnEntryUsed(this);
+}
+
+void StagedEntry::Detach() {
+  DCHECK(IsOpen());
+  doomed_ = true;
+}
+
+int32 StagedEntry::GetStorageSize() const {
+  int32 size = key_.size();
+  for (int i = 0; i < kNumStreams; ++i)
+    size += data_[i].size();
+  return size;
+}
+
+scoped_refptr<net::IOBufferWithSize> StagedEntry::CopyStreamData(
+    int index) const {
+  if (data_[index].empty())
+    return NULL;
+  scoped_refptr<net::IOBufferWithSize> buf(
+      new net::IOBufferWithSize(data_[index].size()));
+  memcpy(buf->data(), &data_[index][0], data_[index].size());
+  return buf;
+}
+
+void StagedEntry::Doom() {
+  if (!doomed_ && backend_.get())
+    backend_->DoomEntry(key_, CompletionCallback());
+}
+
+void StagedEntry::Close() {
+  DCHECK(IsOpen());
+  ref_count_--;
+  if (IsOpen())
+    return;
+  if (doomed_ || !backend_.get()) {
+    delete this;
+    return;
+  }
+  backend_->OnEntryClosed(this);
+}
+
+std::string StagedEntry::GetKey() const {
+  return key_;
+}
+
+base::Time StagedEntry::GetLastUsed() const {
+  return last_used_;
+}
+
+base::Time StagedEntry::GetLastModified() const {
+  return last_modified_;
+}
+
+int32 StagedEntry::GetDataSize(int index) const {
+  if (index < 0 || index >= kNumStreams)
+    return 0;
+  return data_[index].size();
+}
+
+int StagedEntry::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
+                          const CompletionCallback& callback) {
+  if (index < 0 || index >= kNumStreams)
+    return net::ERR_INVALID_ARGUMENT;
+
+  int entry_size = GetDataSize(index);
+  if (offset >= entry_size || offset < 0 || !buf_len)
+    return 0;
+
+  if (buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+
+  if (offset + buf_len > entry_size)
+    buf_len = entry_size - offset;
+
+  last_used_ = base::Time::Now();
+  if (!doomed_ && backend_.get())
+    backend_->OnEntryUsed(this);
+
+  memcpy(buf->data(), &(data_[index])[offset], buf_len);
+  return buf_len;
+}
+
+int StagedEntry::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
+                           const CompletionCallback& callback,
+                           bool truncate) {
+  if (index < 0 || index >= kNumStreams)
+    return net::ERR_INVALID_ARGUMENT;
+
+  if (offset < 0 || buf_len < 0)
+    return net::ERR_INVALID_ARGUMENT;
+
+  // offset of buf_len could be negative numbers.
+  if (offset > max_entry_size_ || buf_len > max_entry_size_ ||
+      offset + buf_len > max_entry_size_) {
+    return net::ERR_FAILED;
+  }
+
+  int32 old_size = GetDataSize(index);
+  if (old_size < offset + buf_len || truncate)
+    data_[index].resize(offset + buf_len);
+
+  last_used_ = last_modified_ = base::Time::Now();
+  dirty_ = true;
+  if (buf_len)
+    memcpy(&(data_[index])[offset], buf->data(), buf_len);
+
+  if (!doomed_ && backend_.get())
+    backend_->OnEntryModified(this, old_size, GetDataSize(index));
+  return buf_len;
+}
+
+int StagedEntry::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
+                                const CompletionCallback& callback) {
+  return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
+}
+
+int StagedEntry::WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
+                                 const CompletionCallback& callback) {
+  return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
+}
+
+int StagedEntry::GetAvailableRange(int64 offset, int len, int64* start,
+                                   const CompletionCallback& callback) {
+  return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
+}
+
+bool StagedEntry::CouldBeSparse() const {
+  return false;
+}
+
+void StagedEntry::CancelSparseIO() {
+}
+
+int StagedEntry::ReadyForSparseIO(const CompletionCallback& callback) {
+  return net::OK;
+}
+
+StagedEntry::~StagedEntry() {
+  DCHECK(!IsOpen());
+}
+
+struct StagingCacheBackend::PendingFlush {
+  explicit PendingFlush(const std::string& key)
+      : key(key), entry(NULL), next_stream(0), doomed(false) {}
+
+  const std::string key;
+
+  // The entry of the underlying backend, once created.
+  Entry* entry;
+
+  // The data to write to each stream of |entry|.
+  scoped_refptr<net::IOBufferWithSize> data[kNumStreams];
+  int next_stream;
+
+  // Set when the staged entry is doomed before the end of the flush.
+  bool doomed;
+};
+
+StagingCacheBackend::StagingCacheBackend(scoped_ptr<Backend> backend,
+                                         int max_bytes)
+    : backend_(backend.Pass()),
+      max_bytes_(max_bytes),
+      current_size_(0) {
+  DCHECK(backend_);
+}
+
+StagingCacheBackend::~StagingCacheBackend() {
+  // An entry only partially written would be read back as complete.
+  if (flush_ && flush_->entry) {
+    flush_->entry->Doom();
+    flush_->entry->Close();
+  }
+
+  while (lru_list_.head() != lru_list_.end()) {
+    StagedEntry* entry = lru_list_.head()->value();
+    entry->RemoveFromList();
+    if (entry->IsOpen())
+      entry->Detach();
+    else
+      delete entry;
+  }
+}
+
+int StagingCacheBackend::Flush(const CompletionCallback& callback) {
+  if (!flush_ && dirty_keys_.empty())
+    return net::OK;
+  flush_callbacks_.push_back(callback);
+  FlushNextEntry();
+  return net::ERR_IO_PENDING;
+}
+
+net::CacheType StagingCacheBackend::GetCacheType() const {
+  return backend_->GetCacheType();
+}
+
+int32 StagingCacheBackend::GetEntryCount() const {
+  // Entries that are not flushed yet are not counted by |backend_|.
+  int32 count = backend_->GetEntryCount();
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    if (!it->second->flushed())
+      count++;
+  }
+  return count;
+}
+
+int StagingCacheBackend::OpenEntry(const std::string& key, Entry** entry,
+                                   const CompletionCallback& callback) {
+  EntryMap::iterator it = entries_.find(key);
+  if (it == entries_.end())
+    return backend_->OpenEntry(key, entry, callback);
+
+  it->second->Open();
+  *entry = it->second;
+  return net::OK;
+}
+
+int StagingCacheBackend::CreateEntry(const std::string& key, Entry** entry,
+                                     const CompletionCallback& callback) {
+  if (entries_.find(key) != entries_.end())
+    return net::ERR_FAILED;
+
+  // The entry may only be in |backend_|, if it was evicted from memory or
+  // written before this object existed.
+  Entry** backend_entry = new Entry*(NULL);
+  CompletionCallback lookup_callback =
+      base::Bind(&StagingCacheBackend::OnCreateEntryLookupDone, AsWeakPtr(),
+                 key, entry, callback, base::Owned(backend_entry));
+  int rv = backend_->OpenEntry(key, backend_entry, lookup_callback);
+  if (rv == net::ERR_IO_PENDING)
+    return rv;
+  return CreateStagedEntry(key, rv, *backend_entry, entry);
+}
+
+int StagingCacheBackend::CreateStagedEntry(const std::string& key,
+                                           int open_result,
+                                           Entry* backend_entry,
+                                           Entry** entry) {
+  if (open_result == net::OK) {
+    backend_entry->Close();
+    return net::ERR_FAILED;
+  }
+  // Another CreateEntry() may have finished while |backend_| was looking.
+  if (entries_.find(key) != entries_.end())
+    return net::ERR_FAILED;
+
+  StagedEntry* staged_entry = new StagedEntry(this, key);
+  entries_[key] = staged_entry;
+  lru_list_.Append(staged_entry);
+  current_size_ += staged_entry->GetStorageSize();
+  staged_entry->Open();
+  *entry = staged_entry;
+  return net::OK;
+}
+
+// static
+void StagingCacheBackend::OnCreateEntryLookupDone(
+    base::WeakPtr<StagingCacheBackend> staging_backend,
+    const std::string& key,
+    Entry** entry,
+    const CompletionCallback& callback,
+    Entry** backend_entry,
+    int result) {
+  if (!staging_backend.get()) {
+    if (result == net::OK)
+      (*backend_entry)->Close();
+    return;
+  }
+  callback.Run(staging_backend->CreateStagedEntry(key, result, *backend_entry,
+                                                  entry));
+}
+
+int StagingCacheBackend::DoomEntry(const std::string& key,
+                                   const CompletionCallback& callback) {
+  EntryMap::iterator it = entries_.find(key);
+  if (it == entries_.end())
+    return backend_->DoomEntry(key, callback);
+
+  RemoveEntry(it->second);
+
+  // An older version of the entry may be in |backend_|.
+  backend_->DoomEntry(key, CompletionCallback());
+  return net::OK;
+}
+
+int StagingCacheBackend::DoomAllEntries(const CompletionCallback& callback) {
+  RemoveEntriesBetween(base::Time(), base::Time::Max());
+  return backend_->DoomAllEntries(callback);
+}
+
+int StagingCacheBackend::DoomEntriesBetween(
+    base::Time initial_time,
+    base::Time end_time,
+    const CompletionCallback& callback) {
+  RemoveEntriesBetween(initial_time, end_time);
+  return backend_->DoomEntriesBetween(initial_time, end_time, callback);
+}
+
+int StagingCacheBackend::DoomEntriesSince(base::Time initial_time,
+                                          const CompletionCallback& callback) {
+  RemoveEntriesBetween(initial_time, base::Time::Max());
+  return backend_->DoomEntriesSince(initial_time, callback);
+}
+
+int StagingCacheBackend::OpenNextEntry(void** iter, Entry** next_entry,
+                                       const CompletionCallback& callback) {
+  return backend_->OpenNextEntry(iter, next_entry, callback);
+}
+
+void StagingCacheBackend::EndEnumeration(void** iter) {
+  backend_->EndEnumeration(iter);
+}
+
+void StagingCacheBackend::GetStats(
+    std::vector<std::pair<std::string, std::string> >* stats) {
+  backend_->GetStats(stats);
+
+  std::pair<std::string, std::string> item;
+  item.first = "Staged entries";
+  item.second = base::StringPrintf("%d", static_cast<int>(entries_.size()));
+  stats->push_back(item);
+  item.first = "Staged bytes";
+  item.second = base::StringPrintf("%d", current_size_);
+  stats->push_back(item);
+  item.first = "Entries waiting for flush";
+  item.second = base::StringPrintf("%d", static_cast<int>(dirty_keys_.size()));
+  stats->push_back(item);
+}
+
+void StagingCacheBackend::OnExternalCacheHit(const std::string& key) {
+  EntryMap::iterator it = entries_.find(key);
+  if (it != entries_.end())
+    OnEntryUsed(it->second);
+  backend_->OnExternalCacheHit(key);
+}
+
+int StagingCacheBackend::MaxEntrySize() const {
+  return max_bytes_ / 8;
+}
+
+void StagingCacheBackend::OnEntryUsed(StagedEntry* entry) {
+  entry->RemoveFromList();
+  lru_list_.Append(entry);
+}
+
+void StagingCacheBackend::OnEntryModified(StagedEntry* entry,
+                                          int32 old_size,
+                                          int32 new_size) {
+  current_size_ += new_size - old_size;
+  OnEntryUsed(entry);
+  EvictIfNeeded();
+}
+
+void StagingCacheBackend::OnEntryClosed(StagedEntry* entry) {
+  if (entry->dirty() && !entry->queued()) {
+    entry->set_queued(true);
+    dirty_keys_.push_back(entry->GetKey());
+    if (!flush_ && !flush_timer_.IsRunning()) {
+      flush_timer_.Start(FROM_HERE,
+                         base::TimeDelta::FromMilliseconds(kFlushDelayMs),
+                         this, &StagingCacheBackend::FlushNextEntry);
+    }
+  }
+  EvictIfNeeded();
+}
+
+void StagingCacheBackend::RemoveEntry(StagedEntry* entry) {
+  entries_.erase(entry->GetKey());
+  entry->RemoveFromList();
+  current_size_ -= entry->GetStorageSize();
+  if (flush_ && flush_->key == entry->GetKey())
+    flush_->doomed = true;
+
+  if (entry->IsOpen())
+    entry->Detach();
+  else
+    delete entry;
+}
+
+void StagingCacheBackend::RemoveEntriesBetween(base::Time initial_time,
+                                               base::Time end_time) {
+  base::LinkNode<StagedEntry>* node = lru_list_.head();
+  while (node != lru_list_.end()) {
+    StagedEntry* entry = node->value();
+    node = node->next();
+    if (entry->GetLastUsed() >= initial_time &&
+        (end_time.is_null() || entry->GetLastUsed() < end_time)) {
+      RemoveEntry(entry);
+    }
+  }
+}
+
+void StagingCacheBackend::EvictIfNeeded() {
+  base::LinkNode<StagedEntry>* node = lru_list_.head();
+  while (current_size_ > max_bytes_ && node != lru_list_.end()) {
+    StagedEntry* entry = node->value();
+    node = node->next();
+    if (entry->IsOpen() || entry->dirty() ||
+        (flush_ && flush_->key == entry->GetKey())) {
+      continue;
+    }
+    RemoveEntry(entry);
+  }
+
+  // Don't wait for more writes to make room.
+  if (current_size_ > max_bytes_ && !dirty_keys_.empty())
+    FlushNextEntry();
+}
+
+void StagingCacheBackend::FlushNextEntry() {
+  if (flush_)
+    return;
+  flush_timer_.Stop();
+
+  while (!dirty_keys_.empty()) {
+    const std::string key = dirty_keys_.front();
+    dirty_keys_.pop_front();
+    EntryMap::iterator it = entries_.find(key);
+    if (it == entries_.end())
+      continue;
+    StagedEntry* entry = it->second;
+    entry->set_queued(false);
+    // An entry that was opened again is flushed once closed.
+    if (entry->IsOpen() || !entry->dirty())
+      continue;
+
+    flush_.reset(new PendingFlush(key));
+    for (int i = 0; i < kNumStreams; ++i)
+      flush_->data[i] = entry->CopyStreamData(i);
+    entry->set_dirty(false);
+    CreateFlushEntry(false);
+    return;
+  }
+
+  if (!flush_callbacks_.empty()) {
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&StagingCacheBackend::RunFlushCallbacks, AsWeakPtr()));
+  }
+}
+
+void StagingCacheBackend::CreateFlushEntry(bool retry) {
+  // |backend_| may write the entry after this object is gone.
+  Entry** entry = new Entry*(NULL);
+  CompletionCallback callback =
+      base::Bind(&StagingCacheBackend::OnFlushEntryCreated, AsWeakPtr(),
+                 retry, base::Owned(entry));
+  int rv = backend_->CreateEntry(flush_->key, entry, callback);
+  if (rv != net::ERR_IO_PENDING)
+    callback.Run(rv);
+}
+
+void StagingCacheBackend::OnFlushEntryDoomed(int result) {
+  CreateFlushEntry(true);
+}
+
+void StagingCacheBackend::OnFlushEntryCreated(bool retry,
+                                              Entry** entry,
+                                              int result) {
+  DCHECK(flush_);
+  if (result != net::OK) {
+    if (retry) {
+      FinishFlushEntry(false);
+      return;
+    }
+    // Replace the version of the entry |backend_| already has.
+    int rv = backend_->DoomEntry(
+        flush_->key,
+        base::Bind(&StagingCacheBackend::OnFlushEntryDoomed, AsWeakPtr()));
+    if (rv != net::ERR_IO_PENDING)
+      OnFlushEntryDoomed(rv);
+    return;
+  }
+
+  flush_->entry = *entry;
+  WriteFlushStreams();
+}
+
+void StagingCacheBackend::WriteFlushStreams() {
+  while (flush_->next_stream < kNumStreams) {
+    const int index = flush_->next_stream++;
+    net::IOBufferWithSize* data = flush_->data[index].get();
+    if (!data)
+      continue;
+    int rv = flush_->entry->WriteData(
+        index, 0, data, data->size(),
+        base::Bind(&StagingCacheBackend::OnFlushStreamWritten, AsWeakPtr(),
+                   data->size()),
+        true);
+    if (rv == net::ERR_IO_PENDING)
+      return;
+    if (rv != data->size()) {
+      FinishFlushEntry(false);
+      return;
+    }
+  }
+  FinishFlushEntry(true);
+}
+
+void StagingCacheBackend::OnFlushStreamWritten(int expected, int result) {
+  if (result != expected) {
+    FinishFlushEntry(false);
+    return;
+  }
+  WriteFlushStreams();
+}
+
+void StagingCacheBackend::FinishFlushEntry(bool success) {
+  scoped_ptr<PendingFlush> flush(flush_.Pass());
+  if (flush->entry) {
+    if (!success || flush->doomed)
+      flush->entry->Doom();
+    flush->entry->Close();
+  }
+
+  if (!success) {
+    DLOG(ERROR) << "Failed to flush a staged entry.";
+  } else if (!flush->doomed) {
+    EntryMap::iterator it = entries_.find(flush->key);
+    if (it != entries_.end())
+      it->second->set_flushed(true);
+  }
+
+  EvictIfNeeded();
+
+  // Let other tasks run between entries.
+  base::MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&StagingCacheBackend::FlushNextEntry, AsWeakPtr()));
+}
+
+void StagingCacheBackend::RunFlushCallbacks() {
+  if (flush_ || !dirty_keys_.empty())
+    return;
+  std::vector<CompletionCallback> callbacks;
+  callbacks.swap(flush_callbacks_);
+  for (size_t i = 0; i < callbacks.size(); ++i)
+    callbacks[i].Run(net::OK);
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,151 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_STAGING_CACHE_BACKEND_H_
+#define NET_DISK_CACHE_STAGING_CACHE_BACKEND_H_
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/containers/hash_tables.h"
+#include "base/containers/linked_list.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace disk_cache {
+
+class StagedEntry;
+
+// A Backend holding recently written entries in memory, in front of another,
+// usually disk based, backend.  Writes to the entries it creates complete
+// synchronously.  Once closed, the entries are flushed to the underlying
+// backend in batches, one after the other, so bursts of writes don't wait for
+// file creation and disk IO.  Entries stay in memory after they are flushed
+// and are opened without touching the underlying backend, until they are
+// evicted in LRU order to keep the memory used under |max_bytes|.
+//
+// Things to keep in mind:
+//  o CreateEntry() looks the key up in the underlying backend before creating
+//    the entry in memory, and fails if it is there.  A flushed entry replaces
+//    the entry of the underlying backend with the same key, if one was
+//    created since.
+//  o Entries opened from the underlying backend are returned as is.
+//  o Entries not flushed yet are lost when the backend is destroyed, and are
+//    not enumerated by OpenNextEntry().
+//  o The entries held in memory don't support sparse data.
+//  o Entries waiting to be flushed can't be evicted, so the memory used can
+//    go over |max_bytes| while the underlying backend catches up.
+class NET_EXPORT_PRIVATE StagingCacheBackend
+    : public Backend,
+      public base::SupportsWeakPtr<StagingCacheBackend> {
+ public:
+  StagingCacheBackend(scoped_ptr<Backend> backend, int max_bytes);
+  virtual ~StagingCacheBackend();
+
+  // Flushes all the entries waiting for it now.  |callback| is invoked once
+  // they are written to the underlying backend.  Returns net::OK if there is
+  // nothing to flush.
+  int Flush(const CompletionCallback& callback);
+
+  // Backend interface.
+  virtual net::CacheType GetCacheType() const OVERRIDE;
+  virtual int32 GetEntryCount() const OVERRIDE;
+  virtual int OpenEntry(const std::string& key, Entry** entry,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int CreateEntry(const std::string& key, Entry** entry,
+                          const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntry(const std::string& key,
+                        const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomAllEntries(const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesBetween(base::Time initial_time,
+                                 base::Time end_time,
+                                 const CompletionCallback& callback) OVERRIDE;
+  virtual int DoomEntriesSince(base::Time initial_time,
+                               const CompletionCallback& callback) OVERRIDE;
+  virtual int OpenNextEntry(void** iter, Entry** next_entry,
+                            const CompletionCallback& callback) OVERRIDE;
+  virtual void EndEnumeration(void** iter) OVERRIDE;
+  virtual void GetStats(
+      std::vector<std::pair<std::string, std::string> >* stats) OVERRIDE;
+  virtual void OnExternalCacheHit(const std::string& key) OVERRIDE;
+
+ private:
+  friend class StagedEntry;
+
+  // The entry being written to the underlying backend.
+  struct PendingFlush;
+
+  typedef base::hash_map<std::string, StagedEntry*> EntryMap;
+
+  // Creates the entry for |key| in memory, unless |backend_| has it, as told
+  // by |open_result| and |backend_entry|.
+  int CreateStagedEntry(const std::string& key,
+                        int open_result,
+                        Entry* backend_entry,
+                        Entry** entry);
+  static void OnCreateEntryLookupDone(
+      base::WeakPtr<StagingCacheBackend> staging_backend,
+      const std::string& key,
+      Entry** entry,
+      const CompletionCallback& callback,
+      Entry** backend_entry,
+      int result);
+
+  // Called by StagedEntry.
+  int MaxEntrySize() const;
+  void OnEntryUsed(StagedEntry* entry);
+  void OnEntryModified(StagedEntry* entry, int32 old_size, int32 new_size);
+  void OnEntryClosed(StagedEntry* entry);
+
+  // Removes |entry| from memory.  It is deleted once closed.
+  void RemoveEntry(StagedEntry* entry);
+
+  // Removes the entries last used between |initial_time| and |end_time|.
+  void RemoveEntriesBetween(base::Time initial_time, base::Time end_time);
+
+  // Evicts the least recently used entries that are closed and flushed until
+  // the memory used goes under the limit.
+  void EvictIfNeeded();
+
+  // Flushes the next entry waiting for it, if no flush is in progress.
+  void FlushNextEntry();
+  void CreateFlushEntry(bool retry);
+  void OnFlushEntryDoomed(int result);
+  void OnFlushEntryCreated(bool retry, Entry** entry, int result);
+  void WriteFlushStreams();
+  void OnFlushStreamWritten(int expected, int result);
+  void FinishFlushEntry(bool success);
+  void RunFlushCallbacks();
+
+  scoped_ptr<Backend> backend_;
+  const int max_bytes_;
+  int32 current_size_;
+
+  EntryMap entries_;
+
+  // Entries in memory, from the least to the most recently used.
+  base::LinkedList<StagedEntry> lru_list_;
+
+  // Keys of the entries to flush, in the order they were closed.
+  std::deque<std::string> dirty_keys_;
+  scoped_ptr<PendingFlush> flush_;
+  std::vector<CompletionCallback> flush_callbacks_;
+
+  // Gives time to the writes of a burst to be batched up.
+  base::OneShotTimer<StagingCacheBackend> flush_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(StagingCacheBackend);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_STAGING_CACHE_BACKEND_H_
@@ -0,0 +1,178 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/staging_cache_backend.h"
+
+#include <string>
+
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/disk_cache/mem_backend_impl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+
+namespace {
+
+const int kMaxBytes = 16 * 1024;
+
+class StagingCacheBackendTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    scoped_ptr<Backend> disk_backend =
+        MemBackendImpl::CreateBackend(1024 * 1024, NULL);
+    ASSERT_TRUE(disk_backend);
+    disk_backend_ = disk_backend.get();
+    backend_.reset(new StagingCacheBackend(disk_backend.Pass(), kMaxBytes));
+  }
+
+  void CreateEntry(const std::string& key, const std::string& data) {
+    Entry* entry = NULL;
+    net::TestCompletionCallback cb;
+    ASSERT_EQ(net::OK,
+              cb.GetResult(backend_->CreateEntry(key, &entry, cb.callback())));
+    scoped_refptr<net::IOBuffer> buf(new net::StringIOBuffer(data));
+    EXPECT_EQ(static_cast<int>(data.size()),
+              entry->WriteData(0, 0, buf.get(), data.size(),
+                               net::CompletionCallback(), true));
+    entry->Close();
+  }
+
+  void Flush() {
+    net::TestCompletionCallback cb;
+    EXPECT_EQ(net::OK, cb.GetResult(backend_->Flush(cb.callback())));
+  }
+
+  // Returns the data of stream 0 of |key| in |backend|, or an empty string.
+  std::string ReadEntry(Backend* backend, const std::string& key) {
+    Entry* entry = NULL;
+    net::TestCompletionCallback cb;
+    if (cb.GetResult(backend->OpenEntry(key, &entry, cb.callback())) !=
+        net::OK) {
+      return std::string();
+    }
+    const int size = entry->GetDataSize(0);
+    scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(size + 1));
+    int rv = cb.GetResult(entry->ReadData(0, 0, buf.get(), size,
+                                          cb.callback()));
+    entry->Close();
+    EXPECT_EQ(size, rv);
+    return rv > 0 ? std::string(buf->data(), rv) : std::string();
+  }
+
+  int GetStagedBytes() {
+    std::vector<std::pair<std::string, std::string> > stats;
+    backend_->GetStats(&stats);
+    for (size_t i = 0; i < stats.size(); ++i) {
+      int value = 0;
+      if (stats[i].first == "Staged bytes" &&
+          base::StringToInt(stats[i].second, &value)) {
+        return value;
+      }
+    }
+    ADD_FAILURE();
+    return -1;
+  }
+
+  base::MessageLoopForIO message_loop_;
+  Backend* disk_backend_;
+  scoped_ptr<StagingCacheBackend> backend_;
+};
+
+}  // namespace
+
+TEST_F(StagingCacheBackendTest, FlushesClosedEntries) {
+  CreateEntry("key", "some data");
+  EXPECT_EQ(1, backend_->GetEntryCount());
+  EXPECT_EQ(0, disk_backend_->GetEntryCount());
+
+  Flush();
+  EXPECT_EQ(1, disk_backend_->GetEntryCount());
+  EXPECT_EQ("some data", ReadEntry(disk_backend_, "key"));
+}
+
+TEST_F(StagingCacheBackendTest, ServesFlushedEntriesFromMemory) {
+  CreateEntry("key", "some data");
+  Flush();
+
+  // Only the underlying backend loses the entry.
+  net::TestCompletionCallback cb;
+  EXPECT_EQ(net::OK,
+            cb.GetResult(disk_backend_->DoomEntry("key", cb.callback())));
+  EXPECT_EQ("some data", ReadEntry(backend_.get(), "key"));
+}
+
+TEST_F(StagingCacheBackendTest, CreateFailsForEntriesInUnderlyingBackend) {
+  Entry* entry = NULL;
+  net::TestCompletionCallback cb;
+  ASSERT_EQ(net::OK,
+            cb.GetResult(disk_backend_->CreateEntry("key", &entry,
+                                                    cb.callback())));
+  entry->Close();
+
+  entry = NULL;
+  EXPECT_NE(net::OK,
+            cb.GetResult(backend_->CreateEntry("key", &entry, cb.callback())));
+  EXPECT_TRUE(entry == NULL);
+  EXPECT_EQ(0, GetStagedBytes());
+}
+
+TEST_F(StagingCacheBackendTest, ReplacesExistingEntries) {
+  CreateEntry("key", "new data");
+
+  // The underlying backend gets an entry of its own before the flush.
+  Entry* entry = NULL;
+  net::TestCompletionCallback cb;
+  ASSERT_EQ(net::OK,
+            cb.GetResult(disk_backend_->CreateEntry("key", &entry,
+                                                    cb.callback())));
+  entry->Close();
+
+  Flush();
+  EXPECT_EQ(1, disk_backend_->GetEntryCount());
+  EXPECT_EQ("new data", ReadEntry(disk_backend_, "key"));
+}
+
+TEST_F(StagingCacheBackendTest, EvictsFlushedEntries) {
+  const std::string data(kMaxBytes / 10, 'x');
+  const int kNumEntries = 30;
+  for (int i = 0; i < kNumEntries; ++i)
+    CreateEntry(base::StringPrintf("key%d", i), data);
+  Flush();
+  EXPECT_GE(kMaxBytes, GetStagedBytes());
+  EXPECT_EQ(kNumEntries, disk_backend_->GetEntryCount());
+
+  // Evicted entries are read from the underlying backend.
+  for (int i = 0; i < kNumEntries; ++i)
+    EXPECT_EQ(data, ReadEntry(backend_.get(), base::StringPrintf("key%d", i)));
+}
+
+TEST_F(StagingCacheBackendTest, DoomBeforeFlush) {
+  CreateEntry("doomed", "some data");
+  CreateEntry("kept", "some data");
+  EXPECT_EQ(net::OK, backend_->DoomEntry("doomed", net::CompletionCallback()));
+
+  Flush();
+  EXPECT_EQ(1, disk_backend_->GetEntryCount());
+  EXPECT_EQ("", ReadEntry(backend_.get(), "doomed"));
+  EXPECT_EQ("some data", ReadEntry(disk_backend_, "kept"));
+}
+
+TEST_F(StagingCacheBackendTest, DoomAllEntries) {
+  CreateEntry("flushed", "some data");
+  Flush();
+  CreateEntry("staged", "some data");
+
+  net::TestCompletionCallback cb;
+  EXPECT_EQ(net::OK, cb.GetResult(backend_->DoomAllEntries(cb.callback())));
+  Flush();
+  EXPECT_EQ(0, backend_->GetEntryCount());
+  EXPECT_EQ(0, GetStagedBytes());
+}
+
+}  // namespace disk_cache
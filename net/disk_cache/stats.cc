@@ -213,6 +213,13 @@ int Stats::GetLargeEntriesSize() {
   return total;
 }
 
+void Stats::GetSizeDistribution(CacheStats* stats) const {
+  for (int bucket = 0; bucket < kDataSizesLength; bucket++) {
+    if (data_sizes_[bucket] > 0)
+      stats->AddEntries(GetBucketRange(bucket), data_sizes_[bucket]);
+  }
+}
+
 int Stats::SerializeStats(void* data, int num_bytes, Addr* address) {
   OnDiskStats* stats = reinterpret_cast<OnDiskStats*>(data);
   if (num_bytes < static_cast<int>(sizeof(*stats)))
@@ -10,6 +10,7 @@
 
 #include "base/basictypes.h"
 #include "net/disk_cache/addr.h"
+#include "net/disk_cache/cache_stats.h"
 #include "net/disk_cache/stats_histogram.h"
 
 namespace base {
@@ -79,6 +80,9 @@ class Stats {
   // Returns the lower bound of the space used by entries bigger than 512 KB.
   int GetLargeEntriesSize();
 
+  // Adds the size distribution of the stored data to |stats|.
+  void GetSizeDistribution(CacheStats* stats) const;
+
   // Writes the stats into |data|, to be stored at the given cache address.
   // Returns the number of bytes copied.
   int SerializeStats(void* data, int num_bytes, Addr* address);
@@ -18,14 +18,20 @@ HostCache::Entry::Entry(int error, const AddressList& addrlist,
                         base::TimeDelta ttl)
     : error(error),
       addrlist(addrlist),
-      ttl(ttl) {
+      ttl(ttl),
+      hit_count(0),
+      source(SOURCE_UNKNOWN),
+      stale(false) {
   DCHECK(ttl >= base::TimeDelta());
 }
 
 HostCache::Entry::Entry(int error, const AddressList& addrlist)
     : error(error),
       addrlist(addrlist),
-      ttl(base::TimeDelta::FromSeconds(-1)) {
+      ttl(base::TimeDelta::FromSeconds(-1)),
+      hit_count(0),
+      source(SOURCE_UNKNOWN),
+      stale(false) {
 }
 
 HostCache::Entry::~Entry() {
@@ -46,7 +52,28 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   if (caching_is_disabled())
     return NULL;
 
-  return entries_.Get(key, now);
+  Entry* entry = entries_.GetMutable(key, now);
+  // The entry may be kept past its expiration, or restored, for LookupStale.
+  if (!entry || entry->expires <= now || entry->stale)
+    return NULL;
+  ++entry->hit_count;
+  return entry;
+}
+
+const HostCache::Entry* HostCache::LookupStale(const Key& key,
+                                               base::TimeTicks now,
+                                               bool* is_stale) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(is_stale);
+  if (caching_is_disabled())
+    return NULL;
+
+  Entry* entry = entries_.GetMutable(key, now);
+  if (!entry)
+    return NULL;
+  ++entry->hit_count;
+  *is_stale = entry->stale || entry->expires <= now;
+  return entry;
 }
 
 void HostCache::Set(const Key& key,
@@ -57,7 +84,28 @@ void HostCache::Set(const Key& key,
   if (caching_is_disabled())
     return;
 
-  entries_.Put(key, entry, now, now + ttl);
+  Entry stored_entry(entry);
+  stored_entry.expires = now + ttl;
+  stored_entry.hit_count = 0;
+  stored_entry.stale = false;
+  entries_.Put(key, stored_entry, now, stored_entry.expires + max_stale_);
+}
+
+void HostCache::Restore(const Key& key,
+                        const Entry& entry,
+                        base::TimeTicks now,
+                        base::TimeTicks expires) {
+  DCHECK(CalledOnValidThread());
+  if (caching_is_disabled())
+    return;
+  if (expires + max_stale_ <= now || entries_.Get(key, now))
+    return;
+
+  Entry stored_entry(entry);
+  stored_entry.expires = expires;
+  stored_entry.hit_count = 0;
+  stored_entry.stale = true;
+  entries_.Put(key, stored_entry, now, expires + max_stale_);
 }
 
 void HostCache::clear() {
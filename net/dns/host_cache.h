@@ -24,6 +24,15 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
  public:
   // Stores the latest address list that was looked up for a hostname.
   struct NET_EXPORT Entry {
+    // Where the resolve results came from. Persisted, so values must not be
+    // renumbered.
+    enum Source {
+      SOURCE_UNKNOWN = 0,
+      SOURCE_DNS = 1,
+      SOURCE_SYSTEM = 2,
+      SOURCE_HOSTS = 3,
+    };
+
     Entry(int error, const AddressList& addrlist, base::TimeDelta ttl);
     // Use when |ttl| is unknown.
     Entry(int error, const AddressList& addrlist);
@@ -36,6 +45,14 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
     AddressList addrlist;
     // TTL obtained from the nameserver. Negative if unknown.
     base::TimeDelta ttl;
+    // When the entry stops being fresh. Set by HostCache::Set.
+    base::TimeTicks expires;
+    // Number of lookups the entry served since it was set.
+    int hit_count;
+    Source source;
+    // True if the entry was restored from disk, rather than resolved by this
+    // process. LookupStale reports such entries as stale.
+    bool stale;
   };
 
   struct Key {
@@ -82,6 +99,12 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Like Lookup(), but also returns an entry which expired no more than
+  // max_stale() before |now|, in which case |*is_stale| is set to true.
+  const Entry* LookupStale(const Key& key,
+                           base::TimeTicks now,
+                           bool* is_stale);
+
   // Overwrites or creates an entry for |key|.
   // |entry| is the value to set, |now| is the current time
   // |ttl| is the "time to live".
@@ -90,6 +113,20 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
            base::TimeTicks now,
            base::TimeDelta ttl);
 
+  // Adds |entry|, which was persisted by an earlier process, to expire at
+  // |expires| and marked as stale, unless there already is an entry for
+  // |key|. Does nothing if the entry would already have been dropped at
+  // |now|.
+  void Restore(const Key& key,
+               const Entry& entry,
+               base::TimeTicks now,
+               base::TimeTicks expires);
+
+  // Sets how long entries are kept after they expire, so LookupStale() can
+  // return them. Only affects entries set afterwards. Defaults to zero.
+  void set_max_stale(base::TimeDelta max_stale) { max_stale_ = max_stale; }
+  base::TimeDelta max_stale() const { return max_stale_; }
+
   // Empties the cache
   void clear();
 
@@ -116,6 +153,8 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // a resolved result entry.
   EntryMap entries_;
 
+  base::TimeDelta max_stale_;
+
   DISALLOW_COPY_AND_ASSIGN(HostCache);
 };
 
@@ -0,0 +1,217 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/dns/host_cache_persister.h"
+
+#include <limits>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task_runner_util.h"
+#include "base/time/time.h"
+#include "net/base/address_list.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/dns/host_cache.h"
+
+namespace net {
+
+namespace {
+
+const int kHostCachePersisterVersion = 1;
+
+// How often the cache is written.
+const int kWriteIntervalMinutes = 5;
+
+std::string LoadFile(const base::FilePath& path) {
+  std::string result;
+  if (!base::ReadFileToString(path, &result))
+    return std::string();
+  return result;
+}
+
+bool WriteEntry(const HostCache::Key& key,
+                const HostCache::Entry& entry,
+                base::Time expires,
+                Pickle* pickle) {
+  const AddressList& addrlist = entry.addrlist;
+  if (!pickle->WriteString(key.hostname) ||
+      !pickle->WriteInt(key.address_family) ||
+      !pickle->WriteInt(key.host_resolver_flags) ||
+      !pickle->WriteInt64(entry.ttl.ToInternalValue()) ||
+      !pickle->WriteInt(entry.source) ||
+      !pickle->WriteInt64(expires.ToInternalValue()) ||
+      !pickle->WriteString(addrlist.canonical_name()) ||
+      addrlist.size() > std::numeric_limits<uint32>::max() ||
+      !pickle->WriteUInt32(addrlist.size())) {
+    return false;
+  }
+  for (size_t i = 0; i < addrlist.size(); ++i) {
+    const IPAddressNumber& address = addrlist[i].address();
+    if (!pickle->WriteString(std::string(address.begin(), address.end())) ||
+        !pickle->WriteUInt16(addrlist[i].port())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+HostCachePersister::HostCachePersister(
+    HostCache* cache,
+    const base::FilePath& path,
+    base::SequencedTaskRunner* file_task_runner)
+    : cache_(cache),
+      loaded_(false),
+      writer_(path, file_task_runner),
+      weak_factory_(this) {
+  DCHECK(cache_);
+  base::PostTaskAndReplyWithResult(
+      file_task_runner,
+      FROM_HERE,
+      base::Bind(&LoadFile, path),
+      base::Bind(&HostCachePersister::OnLoadComplete,
+                 weak_factory_.GetWeakPtr()));
+}
+
+HostCachePersister::~HostCachePersister() {
+  DCHECK(CalledOnValidThread());
+  // Don't replace the file with what was resolved before it was read.
+  if (!loaded_)
+    return;
+  std::string data;
+  if (SerializeData(&data))
+    writer_.WriteNow(data);
+}
+
+bool HostCachePersister::SerializeData(std::string* data) {
+  DCHECK(CalledOnValidThread());
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::Time wall_now = base::Time::Now();
+
+  Pickle pickle(sizeof(Pickle::Header));
+  if (!pickle.WriteInt(kHostCachePersisterVersion))
+    return false;
+  for (HostCache::EntryMap::Iterator it(cache_->entries()); it.HasNext();
+       it.Advance()) {
+    const HostCache::Entry& entry = it.value();
+    // Only successful results are worth keeping across restarts, and entries
+    // may be kept past their expiration.
+    if (entry.error != OK || it.expiration() <= now)
+      continue;
+    // Each entry is preceded by a true flag, and the last one is followed by
+    // a false one, so that the entries don't need to be counted up front.
+    if (!pickle.WriteBool(true) ||
+        !WriteEntry(it.key(), entry, wall_now + (entry.expires - now),
+                    &pickle)) {
+      return false;
+    }
+  }
+  if (!pickle.WriteBool(false))
+    return false;
+  data->assign(reinterpret_cast<const char*>(pickle.data()), pickle.size());
+  return true;
+}
+
+bool HostCachePersister::LoadEntries(const std::string& data) {
+  DCHECK(CalledOnValidThread());
+  if (data.empty())
+    return false;
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::Time wall_now = base::Time::Now();
+
+  Pickle pickle(data.data(), data.size());
+  PickleIterator iter(pickle);
+  int version = -1;
+  if (!pickle.ReadInt(&iter, &version) ||
+      version != kHostCachePersisterVersion) {
+    DVLOG(1) << "Missing or unsupported version";
+    return false;
+  }
+  while (true) {
+    bool has_entry = false;
+    if (!pickle.ReadBool(&iter, &has_entry))
+      return false;
+    if (!has_entry)
+      return true;
+
+    std::string hostname;
+    int address_family;
+    int host_resolver_flags;
+    int64 ttl;
+    int source;
+    int64 expires;
+    std::string canonical_name;
+    uint32 num_addresses;
+    if (!pickle.ReadString(&iter, &hostname) ||
+        !pickle.ReadInt(&iter, &address_family) ||
+        !pickle.ReadInt(&iter, &host_resolver_flags) ||
+        !pickle.ReadInt64(&iter, &ttl) ||
+        !pickle.ReadInt(&iter, &source) ||
+        !pickle.ReadInt64(&iter, &expires) ||
+        !pickle.ReadString(&iter, &canonical_name) ||
+        !pickle.ReadUInt32(&iter, &num_addresses)) {
+      DVLOG(1) << "Malformed entry";
+      return false;
+    }
+    if (address_family < ADDRESS_FAMILY_UNSPECIFIED ||
+        address_family > ADDRESS_FAMILY_LAST ||
+        source < HostCache::Entry::SOURCE_UNKNOWN ||
+        source > HostCache::Entry::SOURCE_HOSTS) {
+      DVLOG(1) << "Malformed entry";
+      return false;
+    }
+
+    AddressList addrlist;
+    addrlist.set_canonical_name(canonical_name);
+    for (uint32 i = 0; i < num_addresses; ++i) {
+      std::string address;
+      uint16 port;
+      if (!pickle.ReadString(&iter, &address) ||
+          !pickle.ReadUInt16(&iter, &port) ||
+          (address.size() != kIPv4AddressSize &&
+           address.size() != kIPv6AddressSize)) {
+        DVLOG(1) << "Malformed address";
+        return false;
+      }
+      addrlist.push_back(
+          IPEndPoint(IPAddressNumber(address.begin(), address.end()), port));
+    }
+
+    HostCache::Key key(hostname,
+                       static_cast<AddressFamily>(address_family),
+                       host_resolver_flags);
+    base::TimeDelta entry_ttl = base::TimeDelta::FromInternalValue(ttl);
+    HostCache::Entry entry = entry_ttl >= base::TimeDelta() ?
+        HostCache::Entry(OK, addrlist, entry_ttl) :
+        HostCache::Entry(OK, addrlist);
+    entry.source = static_cast<HostCache::Entry::Source>(source);
+    base::TimeTicks expires_ticks =
+        now + (base::Time::FromInternalValue(expires) - wall_now);
+    cache_->Restore(key, entry, now, expires_ticks);
+  }
+}
+
+void HostCachePersister::OnLoadComplete(const std::string& data) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(!loaded_);
+  LoadEntries(data);
+  loaded_ = true;
+  write_timer_.Start(FROM_HERE,
+                     base::TimeDelta::FromMinutes(kWriteIntervalMinutes),
+                     this,
+                     &HostCachePersister::OnWriteTimer);
+}
+
+void HostCachePersister::OnWriteTimer() {
+  writer_.ScheduleWrite(this);
+}
+
+}  // namespace net
@@ -0,0 +1,81 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DNS_HOST_CACHE_PERSISTER_H_
+#define NET_DNS_HOST_CACHE_PERSISTER_H_
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/non_thread_safe.h"
+#include "base/timer/timer.h"
+#include "net/base/net_export.h"
+
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
+namespace net {
+
+class HostCache;
+
+// Keeps a snapshot of the successful entries of a HostCache in a compact
+// file, so that a restarted process doesn't have to resolve every host again
+// before its first requests.
+//
+// The file is read on |file_task_runner| when the persister is created, and
+// its entries are restored into the cache with their original expiration,
+// marked as stale, so that HostResolverImpl refreshes them when used. The
+// cache is written back periodically, and when the persister is destroyed.
+// The persister must be created, used and destroyed on a single thread.
+class NET_EXPORT_PRIVATE HostCachePersister
+    : public base::ImportantFileWriter::DataSerializer,
+      public NON_EXPORTED_BASE(base::NonThreadSafe) {
+ public:
+  // |cache| must outlive the persister.
+  HostCachePersister(HostCache* cache,
+                     const base::FilePath& path,
+                     base::SequencedTaskRunner* file_task_runner);
+  virtual ~HostCachePersister();
+
+  // ImportantFileWriter::DataSerializer implementation.
+  //
+  // The entries are written as a Pickle of a version followed by each key,
+  // error-free result, TTL, source and expiration in wall clock time.
+  virtual bool SerializeData(std::string* data) OVERRIDE;
+
+  // Restores the entries of |data|, produced by SerializeData, into the
+  // cache. Entries the cache already has are left alone. Returns false if
+  // |data| is malformed or from another version, in which case entries
+  // before the malformed one may have been restored.
+  bool LoadEntries(const std::string& data);
+
+  // Returns true once the file has been read.
+  bool loaded() const { return loaded_; }
+
+ private:
+  void OnLoadComplete(const std::string& data);
+
+  // Schedules a write of the cache.
+  void OnWriteTimer();
+
+  HostCache* cache_;
+  bool loaded_;
+
+  // Helper for safely writing the data.
+  base::ImportantFileWriter writer_;
+
+  base::RepeatingTimer<HostCachePersister> write_timer_;
+
+  base::WeakPtrFactory<HostCachePersister> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(HostCachePersister);
+};
+
+}  // namespace net
+
+#endif  // NET_DNS_HOST_CACHE_PERSISTER_H_
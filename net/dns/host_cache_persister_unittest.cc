@@ -0,0 +1,174 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/dns/host_cache_persister.h"
+
+#include <string>
+
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
+#include "net/base/address_list.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_util.h"
+#include "net/dns/host_cache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const size_t kMaxCacheEntries = 10;
+
+HostCache::Key Key(const std::string& hostname) {
+  return HostCache::Key(hostname, ADDRESS_FAMILY_UNSPECIFIED, 0);
+}
+
+AddressList MakeAddressList(const std::string& ip_literal, int port) {
+  IPAddressNumber ip;
+  bool rv = ParseIPLiteralToNumber(ip_literal, &ip);
+  DCHECK(rv);
+  AddressList list = AddressList::CreateFromIPAddress(ip, port);
+  list.set_canonical_name("canonical." + ip_literal);
+  return list;
+}
+
+class HostCachePersisterTest : public testing::Test {
+ public:
+  HostCachePersisterTest() : cache_(kMaxCacheEntries) {}
+
+  virtual ~HostCachePersisterTest() {
+    base::MessageLoopForIO::current()->RunUntilIdle();
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("HostCache");
+  }
+
+ protected:
+  scoped_ptr<HostCachePersister> CreatePersister(HostCache* cache) {
+    scoped_ptr<HostCachePersister> persister(new HostCachePersister(
+        cache, path_,
+        base::MessageLoopForIO::current()->message_loop_proxy()));
+    base::MessageLoopForIO::current()->RunUntilIdle();
+    EXPECT_TRUE(persister->loaded());
+    return persister.Pass();
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+  HostCache cache_;
+};
+
+TEST_F(HostCachePersisterTest, SerializeAndLoadEntries) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeDelta kTTL = base::TimeDelta::FromMinutes(10);
+
+  HostCache::Entry entry(OK, MakeAddressList("192.168.1.1", 80), kTTL);
+  entry.source = HostCache::Entry::SOURCE_DNS;
+  cache_.Set(Key("foo.com"), entry, now, kTTL);
+  HostCache::Key ipv6_key("bar.com", ADDRESS_FAMILY_IPV6, 0);
+  cache_.Set(ipv6_key, HostCache::Entry(OK, MakeAddressList("::1", 443)), now,
+             kTTL);
+  // Negative entries aren't persisted.
+  cache_.Set(Key("error.com"), HostCache::Entry(ERR_NAME_NOT_RESOLVED,
+                                                AddressList()),
+             now, kTTL);
+
+  scoped_ptr<HostCachePersister> persister = CreatePersister(&cache_);
+  std::string data;
+  ASSERT_TRUE(persister->SerializeData(&data));
+
+  HostCache restored_cache(kMaxCacheEntries);
+  HostCachePersister restored_persister(
+      &restored_cache, temp_dir_.path().AppendASCII("Unused"),
+      base::MessageLoopForIO::current()->message_loop_proxy());
+  EXPECT_TRUE(restored_persister.LoadEntries(data));
+  EXPECT_EQ(2u, restored_cache.size());
+
+  // Restored entries are stale, and only returned by LookupStale.
+  EXPECT_FALSE(restored_cache.Lookup(Key("foo.com"), now));
+  bool is_stale = false;
+  const HostCache::Entry* restored =
+      restored_cache.LookupStale(Key("foo.com"), now, &is_stale);
+  ASSERT_TRUE(restored);
+  EXPECT_TRUE(is_stale);
+  EXPECT_EQ(OK, restored->error);
+  EXPECT_EQ(HostCache::Entry::SOURCE_DNS, restored->source);
+  EXPECT_EQ(kTTL, restored->ttl);
+  ASSERT_EQ(1u, restored->addrlist.size());
+  EXPECT_EQ("192.168.1.1:80", restored->addrlist[0].ToString());
+  EXPECT_EQ("canonical.192.168.1.1", restored->addrlist.canonical_name());
+  // The expiration survives the trip through wall clock time, give or take a
+  // few seconds.
+  base::TimeDelta drift = restored->expires - (now + kTTL);
+  EXPECT_GT(base::TimeDelta::FromSeconds(5), drift);
+  EXPECT_LT(base::TimeDelta::FromSeconds(-5), drift);
+
+  restored = restored_cache.LookupStale(ipv6_key, now, &is_stale);
+  ASSERT_TRUE(restored);
+  EXPECT_FALSE(restored->has_ttl());
+  EXPECT_EQ("[::1]:443", restored->addrlist[0].ToString());
+
+  // Setting an entry again makes it fresh.
+  restored_cache.Set(Key("foo.com"), *restored, now, kTTL);
+  EXPECT_TRUE(restored_cache.Lookup(Key("foo.com"), now));
+}
+
+TEST_F(HostCachePersisterTest, RestoreKeepsExistingEntries) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeDelta kTTL = base::TimeDelta::FromMinutes(10);
+  cache_.Set(Key("foo.com"),
+             HostCache::Entry(OK, MakeAddressList("192.168.1.1", 80)), now,
+             kTTL);
+  scoped_ptr<HostCachePersister> persister = CreatePersister(&cache_);
+  std::string data;
+  ASSERT_TRUE(persister->SerializeData(&data));
+
+  HostCache other_cache(kMaxCacheEntries);
+  other_cache.Set(Key("foo.com"),
+                  HostCache::Entry(OK, MakeAddressList("192.168.1.2", 80)),
+                  now, kTTL);
+  HostCachePersister other_persister(
+      &other_cache, temp_dir_.path().AppendASCII("Unused"),
+      base::MessageLoopForIO::current()->message_loop_proxy());
+  EXPECT_TRUE(other_persister.LoadEntries(data));
+  const HostCache::Entry* entry = other_cache.Lookup(Key("foo.com"), now);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("192.168.1.2:80", entry->addrlist[0].ToString());
+}
+
+TEST_F(HostCachePersisterTest, RejectsMalformedData) {
+  scoped_ptr<HostCachePersister> persister = CreatePersister(&cache_);
+  EXPECT_FALSE(persister->LoadEntries(std::string()));
+  EXPECT_FALSE(persister->LoadEntries("garbage"));
+
+  cache_.Set(Key("foo.com"),
+             HostCache::Entry(OK, MakeAddressList("192.168.1.1", 80)),
+             base::TimeTicks::Now(), base::TimeDelta::FromMinutes(10));
+  std::string data;
+  ASSERT_TRUE(persister->SerializeData(&data));
+  cache_.clear();
+  EXPECT_FALSE(persister->LoadEntries(data.substr(0, data.size() - 8)));
+}
+
+TEST_F(HostCachePersisterTest, WritesOnDestruction) {
+  cache_.Set(Key("foo.com"),
+             HostCache::Entry(OK, MakeAddressList("192.168.1.1", 80)),
+             base::TimeTicks::Now(), base::TimeDelta::FromMinutes(10));
+  CreatePersister(&cache_).reset();
+  base::MessageLoopForIO::current()->RunUntilIdle();
+  EXPECT_TRUE(base::PathExists(path_));
+
+  // A new persister restores the snapshot into an empty cache.
+  HostCache restored_cache(kMaxCacheEntries);
+  scoped_ptr<HostCachePersister> persister = CreatePersister(&restored_cache);
+  EXPECT_EQ(1u, restored_cache.size());
+}
+
+}  // namespace
+
+}  // namespace net
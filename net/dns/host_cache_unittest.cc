@@ -87,6 +87,85 @@ TEST(HostCacheTest, Basic) {
 
 // Try caching entries for a failed resolve attempt -- since we set the TTL of
 // such entries to 0 it won't store, but it will kick out the previous result.
+TEST(HostCacheTest, LookupStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+  const base::TimeDelta kMaxStale = base::TimeDelta::FromSeconds(30);
+
+  HostCache cache(kMaxCacheEntries);
+  cache.set_max_stale(kMaxStale);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  HostCache::Key key1 = Key("foobar.com");
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+  cache.Set(key1, entry, now, kTTL);
+
+  bool is_stale = true;
+  const HostCache::Entry* cached = cache.LookupStale(key1, now, &is_stale);
+  ASSERT_TRUE(cached);
+  EXPECT_FALSE(is_stale);
+  EXPECT_EQ(now + kTTL, cached->expires);
+  EXPECT_TRUE(cache.Lookup(key1, now));
+  EXPECT_EQ(2, cache.Lookup(key1, now)->hit_count);
+
+  // Advance to t=10, when the entry expires, but is kept as stale.
+  now += kTTL;
+  EXPECT_FALSE(cache.Lookup(key1, now));
+  is_stale = false;
+  EXPECT_TRUE(cache.LookupStale(key1, now, &is_stale));
+  EXPECT_TRUE(is_stale);
+  EXPECT_EQ(1U, cache.size());
+
+  // Setting the entry again makes it fresh, and resets its hit count.
+  cache.Set(key1, entry, now, kTTL);
+  cached = cache.Lookup(key1, now);
+  ASSERT_TRUE(cached);
+  EXPECT_EQ(1, cached->hit_count);
+
+  // Advance to t=50, after the stale entry is gone too.
+  now += kTTL + kMaxStale;
+  is_stale = false;
+  EXPECT_FALSE(cache.LookupStale(key1, now, &is_stale));
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(HostCacheTest, Restore) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+
+  HostCache::Key key1 = Key("foobar.com");
+  HostCache::Key key2 = Key("foobar2.com");
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+
+  // A restored entry keeps its expiration, but is stale.
+  cache.Restore(key1, entry, now, now + kTTL);
+  EXPECT_FALSE(cache.Lookup(key1, now));
+  bool is_stale = false;
+  const HostCache::Entry* restored = cache.LookupStale(key1, now, &is_stale);
+  ASSERT_TRUE(restored);
+  EXPECT_TRUE(is_stale);
+  EXPECT_EQ(now + kTTL, restored->expires);
+
+  // Restoring doesn't replace an entry.
+  cache.Set(key2, entry, now, kTTL);
+  cache.Restore(key2, entry, now, now + kTTL);
+  EXPECT_TRUE(cache.Lookup(key2, now));
+
+  // An entry which has already expired isn't restored, unless stale entries
+  // are kept long enough.
+  cache.clear();
+  cache.Restore(key1, entry, now, now - kTTL);
+  EXPECT_EQ(0U, cache.size());
+  cache.set_max_stale(2 * kTTL);
+  cache.Restore(key1, entry, now, now - kTTL);
+  EXPECT_EQ(1U, cache.size());
+}
+
 TEST(HostCacheTest, NoCacheZeroTTL) {
   const base::TimeDelta kSuccessEntryTTL = base::TimeDelta::FromSeconds(10);
   const base::TimeDelta kFailureEntryTTL = base::TimeDelta::FromSeconds(0);
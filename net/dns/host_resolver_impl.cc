@@ -29,6 +29,7 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/worker_pool.h"
 #include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "base/values.h"
 #include "net/base/address_family.h"
 #include "net/base/address_list.h"
@@ -44,6 +45,7 @@
 #include "net/dns/dns_protocol.h"
 #include "net/dns/dns_response.h"
 #include "net/dns/dns_transaction.h"
+#include "net/dns/host_cache_persister.h"
 #include "net/dns/host_resolver_proc.h"
 #include "net/socket/client_socket_factory.h"
 #include "net/udp/datagram_client_socket.h"
@@ -69,6 +71,10 @@ const unsigned kNegativeCacheEntryTTLSeconds = 0;
 // Minimum TTL for successful resolutions with DnsTask.
 const unsigned kMinimumTTLSeconds = kCacheEntryTTLSeconds;
 
+// How long before a popular cache entry expires a lookup of it may start a
+// refresh.
+const unsigned kCacheRefreshLeadSeconds = 5;
+
 // We use a separate histogram name for each platform to facilitate the
 // display of error codes by their symbolic name (since each platform has
 // different mappings).
@@ -980,17 +986,27 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
     // only needs to run one transaction.
     virtual void OnFirstDnsTransactionComplete() = 0;
 
+    // Called instead of OnDnsTaskComplete with the IPv4 addresses, when the
+    // AAAA transaction hasn't completed within the partial result delay of
+    // the A transaction. The DnsTask must be destroyed by the delegate.
+    virtual void OnDnsTaskPartialResult(base::TimeTicks start_time,
+                                        const AddressList& addr_list,
+                                        base::TimeDelta ttl) = 0;
+
    protected:
     Delegate() {}
     virtual ~Delegate() {}
   };
 
+  // A zero |partial_result_delay| disables partial results.
   DnsTask(DnsClient* client,
           const Key& key,
+          base::TimeDelta partial_result_delay,
           Delegate* delegate,
           const BoundNetLog& job_net_log)
       : client_(client),
         key_(key),
+        partial_result_delay_(partial_result_delay),
         delegate_(delegate),
         net_log_(job_net_log),
         num_completed_transactions_(0),
@@ -1102,10 +1118,22 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
     if (needs_two_transactions() && num_completed_transactions_ == 1) {
       // No need to repeat the suffix search.
       key_.hostname = transaction->GetHostname();
+      // Don't hold up connections to the IPv4 addresses for long while waiting
+      // for the AAAA answer. IPv6 addresses aren't served on their own since
+      // they need to be sorted, and the A answer usually comes first anyway,
+      // as its transaction is started first.
+      if (partial_result_delay_ > base::TimeDelta() &&
+          transaction->GetType() == dns_protocol::kTypeA &&
+          !addr_list_.empty()) {
+        partial_result_timer_.Start(FROM_HERE, partial_result_delay_, this,
+                                    &DnsTask::OnPartialResultTimeout);
+      }
       delegate_->OnFirstDnsTransactionComplete();
       return;
     }
 
+    partial_result_timer_.Stop();
+
     if (addr_list_.empty()) {
       // TODO(szym): Don't fallback to ProcTask in this case.
       OnFailure(ERR_NAME_NOT_RESOLVED, DnsResponse::DNS_PARSE_OK);
@@ -1151,6 +1179,14 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
     OnSuccess(addr_list);
   }
 
+  void OnPartialResultTimeout() {
+    DCHECK_EQ(1u, num_completed_transactions_);
+    net_log_.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK_PARTIAL_RESULT);
+    net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                      addr_list_.CreateNetLogCallback());
+    delegate_->OnDnsTaskPartialResult(task_start_time_, addr_list_, ttl_);
+  }
+
   void OnFailure(int net_error, DnsResponse::Result result) {
     DCHECK_NE(OK, net_error);
     net_log_.EndEvent(
@@ -1169,6 +1205,10 @@ class HostResolverImpl::DnsTask : public base::SupportsWeakPtr<DnsTask> {
   DnsClient* client_;
   Key key_;
 
+  // How long the IPv4 addresses wait for the AAAA answer.
+  const base::TimeDelta partial_result_delay_;
+  base::OneShotTimer<DnsTask> partial_result_timer_;
+
   // The listener to the results of this DnsTask.
   Delegate* delegate_;
   const BoundNetLog net_log_;
@@ -1204,6 +1244,8 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
         key_(key),
         priority_tracker_(priority),
         had_non_speculative_request_(false),
+        is_refresh_(false),
+        is_partial_(false),
         had_dns_config_(false),
         num_occupied_job_slots_(0),
         dns_task_error_(OK),
@@ -1299,8 +1341,16 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     UpdatePriority();
   }
 
-  // Marks |req| as cancelled. If it was the last active Request, also finishes
-  // this Job, marking it as cancelled, and deletes it.
+  // Makes this Job update the cache even if it has no requests, as long as
+  // it succeeds. Request-less refresh jobs are otherwise only cancelled by
+  // aborts and evictions.
+  void MarkAsRefresh() {
+    is_refresh_ = true;
+  }
+
+  // Marks |req| as cancelled. If it was the last active Request of a Job which
+  // isn't a refresh, also finishes this Job, marking it as cancelled, and
+  // deletes it.
   void CancelRequest(Request* req) {
     DCHECK_EQ(key_.hostname, req->info().hostname());
     DCHECK(!req->was_canceled());
@@ -1316,7 +1366,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                                  req->request_net_log().source(),
                                  priority()));
 
-    if (num_active_requests() > 0) {
+    if (num_active_requests() > 0 || is_refresh_) {
       UpdatePriority();
     } else {
       // If we were called from a Request's callback within CompleteRequests,
@@ -1358,15 +1408,20 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    // A refresh has no request to take the port from, and updates the cache
+    // with the result of DNS.
+    if (num_active_requests() == 0) {
+      DCHECK(is_refresh_);
+      return false;
+    }
     AddressList addr_list;
     if (resolver_->ServeFromHosts(key(),
                                   requests_.front()->info(),
                                   &addr_list)) {
+      HostCache::Entry entry(OK, MakeAddressListForRequest(addr_list));
+      entry.source = HostCache::Entry::SOURCE_HOSTS;
       // This will destroy the Job.
-      CompleteRequests(
-          HostCache::Entry(OK, MakeAddressListForRequest(addr_list)),
-          base::TimeDelta());
+      CompleteRequests(entry, base::TimeDelta());
       return true;
     }
     return false;
@@ -1535,15 +1590,19 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       ttl = base::TimeDelta::FromSeconds(kCacheEntryTTLSeconds);
 
     // Don't store the |ttl| in cache since it's not obtained from the server.
-    CompleteRequests(
-        HostCache::Entry(net_error, MakeAddressListForRequest(addr_list)),
-        ttl);
+    HostCache::Entry entry(net_error, MakeAddressListForRequest(addr_list));
+    entry.source = HostCache::Entry::SOURCE_SYSTEM;
+    CompleteRequests(entry, ttl);
   }
 
   void StartDnsTask() {
     DCHECK(resolver_->HaveDnsConfig());
-    dns_task_.reset(new DnsTask(resolver_->dns_client_.get(), key_, this,
-                                net_log_));
+    // A refresh has no requests waiting for its result, and would otherwise
+    // cache a partial one.
+    base::TimeDelta partial_result_delay = is_refresh_ ?
+        base::TimeDelta() : resolver_->partial_result_delay_;
+    dns_task_.reset(new DnsTask(resolver_->dns_client_.get(), key_,
+                                partial_result_delay, this, net_log_));
 
     dns_task_->StartFirstTransaction();
     // Schedule a second transaction, if needed.
@@ -1619,9 +1678,10 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     base::TimeDelta bounded_ttl =
         std::max(ttl, base::TimeDelta::FromSeconds(kMinimumTTLSeconds));
 
-    CompleteRequests(
-        HostCache::Entry(net_error, MakeAddressListForRequest(addr_list), ttl),
-        bounded_ttl);
+    HostCache::Entry entry(net_error, MakeAddressListForRequest(addr_list),
+                           ttl);
+    entry.source = HostCache::Entry::SOURCE_DNS;
+    CompleteRequests(entry, bounded_ttl);
   }
 
   virtual void OnFirstDnsTransactionComplete() OVERRIDE {
@@ -1637,6 +1697,23 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       dns_task_->StartSecondTransaction();
   }
 
+  virtual void OnDnsTaskPartialResult(base::TimeTicks start_time,
+                                      const AddressList& addr_list,
+                                      base::TimeDelta ttl) OVERRIDE {
+    DCHECK(is_dns_running());
+    DCHECK(!is_refresh_);
+    DNS_HISTOGRAM("AsyncDNS.ResolvePartialSuccess",
+                  base::TimeTicks::Now() - start_time);
+    UmaAsyncDnsResolveStatus(RESOLVE_STATUS_DNS_SUCCESS);
+
+    resolver_->OnDnsTaskResolve(OK);
+
+    is_partial_ = true;
+    HostCache::Entry entry(OK, MakeAddressListForRequest(addr_list), ttl);
+    entry.source = HostCache::Entry::SOURCE_DNS;
+    CompleteRequests(entry, ttl);
+  }
+
   // Performs Job's last rites. Completes all Requests. Deletes this.
   void CompleteRequests(const HostCache::Entry& entry,
                         base::TimeDelta ttl) {
@@ -1665,7 +1742,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       handle_.Reset();
     }
 
-    if (num_active_requests() == 0) {
+    if (num_active_requests() == 0 && !is_refresh_) {
       net_log_.AddEvent(NetLog::TYPE_CANCELLED);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
@@ -1675,7 +1752,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                       entry.error);
 
-    DCHECK(!requests_.empty());
+    DCHECK(!requests_.empty() || is_refresh_);
 
     if (entry.error == OK) {
       // Record this histogram here, when we know the system has a valid DNS
@@ -1686,8 +1763,14 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
     bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
                         (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
-    if (did_complete)
+    // A failed refresh leaves the stale entry in place, rather than replacing
+    // it with a negative entry.
+    if (did_complete && !is_partial_ && (!is_refresh_ || entry.error == OK))
       resolver_->CacheResult(key_, entry, ttl);
+    // A partial result isn't cached. Instead, a refresh caches the full one,
+    // and takes the requests for |key_| that arrive in the meantime.
+    if (is_partial_)
+      resolver_->StartRefreshJob(key_);
 
     // Complete all of the requests that were attached to the job.
     for (RequestsList::const_iterator it = requests_.begin();
@@ -1747,6 +1830,12 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   bool had_non_speculative_request_;
 
+  // True if the Job was started to refresh a cache entry.
+  bool is_refresh_;
+
+  // True if the Job completed with the IPv4 addresses only.
+  bool is_partial_;
+
   // Distinguishes measurements taken while DnsClient was fully configured.
   bool had_dns_config_;
 
@@ -1806,7 +1895,8 @@ HostResolverImpl::HostResolverImpl(
       use_local_ipv6_(false),
       resolved_known_ipv6_hostname_(false),
       additional_resolver_flags_(0),
-      fallback_to_proctask_(true) {
+      fallback_to_proctask_(true),
+      refresh_min_hits_(0) {
 
   DCHECK_GE(dispatcher_.num_priorities(), static_cast<size_t>(NUM_PRIORITIES));
 
@@ -1857,6 +1947,33 @@ void HostResolverImpl::SetMaxQueuedJobs(size_t value) {
   max_queued_jobs_ = value;
 }
 
+void HostResolverImpl::SetStaleCacheParams(base::TimeDelta max_stale,
+                                           int refresh_min_hits) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(max_stale >= base::TimeDelta());
+  DCHECK_GE(refresh_min_hits, 0);
+  if (cache_.get())
+    cache_->set_max_stale(max_stale);
+  refresh_min_hits_ = refresh_min_hits;
+}
+
+void HostResolverImpl::SetPartialResultDelay(base::TimeDelta delay) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(delay >= base::TimeDelta());
+  partial_result_delay_ = delay;
+}
+
+void HostResolverImpl::EnableCachePersistence(
+    const base::FilePath& path,
+    base::SequencedTaskRunner* file_task_runner) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(!cache_persister_);
+  if (cache_.get()) {
+    cache_persister_.reset(
+        new HostCachePersister(cache_.get(), path, file_task_runner));
+  }
+}
+
 int HostResolverImpl::Resolve(const RequestInfo& info,
                               RequestPriority priority,
                               AddressList* addresses,
@@ -1939,8 +2056,11 @@ int HostResolverImpl::ResolveHelper(const Key& key,
   int net_error = ERR_UNEXPECTED;
   if (ResolveAsIP(key, info, &net_error, addresses))
     return net_error;
-  if (ServeFromCache(key, info, &net_error, addresses)) {
-    request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
+  bool is_stale = false;
+  if (ServeFromCache(key, info, &net_error, addresses, &is_stale)) {
+    request_net_log.AddEvent(
+        is_stale ? NetLog::TYPE_HOST_RESOLVER_IMPL_STALE_CACHE_HIT
+                 : NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
     return net_error;
   }
   // TODO(szym): Do not do this if nsswitch.conf instructs not to.
@@ -2050,16 +2170,22 @@ bool HostResolverImpl::ResolveAsIP(const Key& key,
 bool HostResolverImpl::ServeFromCache(const Key& key,
                                       const RequestInfo& info,
                                       int* net_error,
-                                      AddressList* addresses) {
+                                      AddressList* addresses,
+                                      bool* is_stale) {
   DCHECK(addresses);
   DCHECK(net_error);
+  DCHECK(is_stale);
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
+  base::TimeTicks now = base::TimeTicks::Now();
+  const HostCache::Entry* cache_entry = cache_->LookupStale(key, now,
+                                                            is_stale);
   if (!cache_entry)
     return false;
+  // Only successful results are worth serving while refreshing them.
+  if (*is_stale && cache_entry->error != OK)
+    return false;
 
   *net_error = cache_entry->error;
   if (*net_error == OK) {
@@ -2067,9 +2193,42 @@ bool HostResolverImpl::ServeFromCache(const Key& key,
       RecordTTL(cache_entry->ttl);
     *addresses = EnsurePortOnAddressList(cache_entry->addrlist, info.port());
   }
+
+  bool needs_refresh = *is_stale;
+  if (!needs_refresh && refresh_min_hits_ > 0 && *net_error == OK &&
+      cache_entry->hit_count >= refresh_min_hits_) {
+    needs_refresh = cache_entry->expires - now <=
+        base::TimeDelta::FromSeconds(kCacheRefreshLeadSeconds);
+  }
+  // |cache_entry| may be invalidated by the refresh.
+  if (needs_refresh)
+    StartRefreshJob(key);
   return true;
 }
 
+void HostResolverImpl::StartRefreshJob(const Key& key) {
+  JobMap::iterator jobit = jobs_.find(key);
+  if (jobit != jobs_.end())
+    return;
+
+  BoundNetLog refresh_net_log = BoundNetLog::Make(net_log_,
+      NetLog::SOURCE_HOST_RESOLVER_IMPL_REQUEST);
+  Job* job =
+      new Job(weak_ptr_factory_.GetWeakPtr(), key, IDLE, refresh_net_log);
+  job->MarkAsRefresh();
+  job->Schedule(false);
+
+  // Check for queue overflow.
+  if (dispatcher_.num_queued_jobs() > max_queued_jobs_) {
+    Job* evicted = static_cast<Job*>(dispatcher_.EvictOldestLowest());
+    DCHECK(evicted);
+    evicted->OnEvicted();  // Deletes |evicted|.
+    if (evicted == job)
+      return;
+  }
+  jobs_.insert(jobit, std::make_pair(key, job));
+}
+
 bool HostResolverImpl::ServeFromHosts(const Key& key,
                                       const RequestInfo& info,
                                       AddressList* addresses) {
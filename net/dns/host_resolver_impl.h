@@ -22,10 +22,16 @@
 #include "net/dns/host_resolver.h"
 #include "net/dns/host_resolver_proc.h"
 
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
 namespace net {
 
 class BoundNetLog;
 class DnsClient;
+class HostCachePersister;
 class NetLog;
 
 // For each hostname that is requested, HostResolver creates a
@@ -123,6 +129,28 @@ class NET_EXPORT HostResolverImpl
   // Only allowed when the queue is empty.
   void SetMaxQueuedJobs(size_t value);
 
+  // Serves successful cache entries for up to |max_stale| after they expire,
+  // while a refresh job resolves the host again in the background. Entries
+  // looked up at least |refresh_min_hits| times are also refreshed when
+  // looked up shortly before they expire. A zero |max_stale| or
+  // |refresh_min_hits| disables the respective behavior, which is the
+  // default.
+  void SetStaleCacheParams(base::TimeDelta max_stale, int refresh_min_hits);
+
+  // When the A answer of an ADDRESS_FAMILY_UNSPECIFIED DNS resolution comes
+  // |delay| before the AAAA answer, completes the requests with the IPv4
+  // addresses, so that they can start connecting. The full result is then
+  // resolved again and cached in the background. Zero, the default, waits
+  // for both answers.
+  void SetPartialResultDelay(base::TimeDelta delay);
+
+  // Restores the cache from the snapshot at |path|, if there is one, and keeps
+  // the snapshot up to date, using |file_task_runner| for all file I/O.
+  // Restored entries are stale, so they are refreshed when they are first
+  // used. Does nothing if there is no cache.
+  void EnableCachePersistence(const base::FilePath& path,
+                              base::SequencedTaskRunner* file_task_runner);
+
   // Set the DnsClient to be used for resolution. In case of failure, the
   // HostResolverProc from ProcTaskParams will be queried. If the DnsClient is
   // not pre-configured with a valid DnsConfig, a new config is fetched from
@@ -179,11 +207,17 @@ class NET_EXPORT HostResolverImpl
 
   // If |key| is not found in cache returns false, otherwise returns
   // true, sets |net_error| to the cached error code and fills |addresses|
-  // if it is a positive entry.
+  // if it is a positive entry. Sets |is_stale| if the entry has expired,
+  // and starts a refresh job for stale and soon to expire popular entries.
   bool ServeFromCache(const Key& key,
                       const RequestInfo& info,
                       int* net_error,
-                      AddressList* addresses);
+                      AddressList* addresses,
+                      bool* is_stale);
+
+  // Starts a Job with no requests which resolves |key| and updates the cache
+  // with the result, unless a Job for |key| already exists.
+  void StartRefreshJob(const Key& key);
 
   // If we have a DnsClient with a valid DnsConfig, and |key| is found in the
   // HOSTS file, returns true and fills |addresses|. Otherwise returns false.
@@ -244,6 +278,10 @@ class NET_EXPORT HostResolverImpl
   // Cache of host resolution results.
   scoped_ptr<HostCache> cache_;
 
+  // Keeps a snapshot of |cache_| on disk, if enabled. Destroyed before
+  // |cache_|, so it can write the final snapshot.
+  scoped_ptr<HostCachePersister> cache_persister_;
+
   // Map from HostCache::Key to a Job.
   JobMap jobs_;
 
@@ -293,6 +331,14 @@ class NET_EXPORT HostResolverImpl
   // Allow fallback to ProcTask if DnsTask fails.
   bool fallback_to_proctask_;
 
+  // Number of lookups after which a cache entry is refreshed before it
+  // expires. Zero if such refreshes are disabled.
+  int refresh_min_hits_;
+
+  // How long IPv4 addresses wait for the AAAA answer. Zero if they wait for
+  // it.
+  base::TimeDelta partial_result_delay_;
+
   DISALLOW_COPY_AND_ASSIGN(HostResolverImpl);
 };
 
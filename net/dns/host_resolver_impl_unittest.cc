@@ -1252,6 +1252,110 @@ TEST_F(HostResolverImplTest, ResolveFromCache) {
   EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
 }
 
+namespace {
+
+// Makes the only entry of |cache| look as though it was set |age| ago with a
+// |ttl|.
+void AgeOnlyCacheEntry(HostCache* cache,
+                       base::TimeDelta age,
+                       base::TimeDelta ttl) {
+  ASSERT_EQ(1u, cache->size());
+  HostCache::EntryMap::Iterator it(cache->entries());
+  HostCache::Key key = it.key();
+  HostCache::Entry entry = it.value();
+  cache->Set(key, entry, base::TimeTicks::Now() - age, ttl);
+}
+
+}  // namespace
+
+TEST_F(HostResolverImplTest, ServeStaleWhileRefreshing) {
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+  resolver_->SetStaleCacheParams(base::TimeDelta::FromMinutes(1), 0);
+  proc_->SignalMultiple(1u);
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info, DEFAULT_PRIORITY)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+
+  // Expire the entry 10 seconds ago.
+  AgeOnlyCacheEntry(resolver_->GetHostCache(),
+                    base::TimeDelta::FromSeconds(70),
+                    base::TimeDelta::FromSeconds(60));
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.43");
+
+  // The stale entry is served right away, and the host is resolved again.
+  EXPECT_EQ(OK, CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_TRUE(requests_[1]->HasOneAddress("192.168.1.42", 80));
+  EXPECT_EQ(1u, num_running_dispatcher_jobs());
+  EXPECT_TRUE(proc_->WaitFor(1u));
+
+  // A request which bypasses the cache joins the refresh.
+  HostResolver::RequestInfo uncached_info(info);
+  uncached_info.set_allow_cached_response(false);
+  EXPECT_EQ(ERR_IO_PENDING,
+            CreateRequest(uncached_info, DEFAULT_PRIORITY)->Resolve());
+  proc_->SignalMultiple(1u);
+  EXPECT_EQ(OK, requests_[2]->WaitForResult());
+  EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.43", 80));
+  EXPECT_EQ(2u, proc_->GetCaptureList().size());
+
+  // The refreshed entry is fresh.
+  EXPECT_EQ(OK, CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_TRUE(requests_[3]->HasOneAddress("192.168.1.43", 80));
+  EXPECT_EQ(0u, num_running_dispatcher_jobs());
+}
+
+TEST_F(HostResolverImplTest, StaleEntriesNotServedByDefault) {
+  proc_->SignalMultiple(1u);
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info, DEFAULT_PRIORITY)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+
+  AgeOnlyCacheEntry(resolver_->GetHostCache(),
+                    base::TimeDelta::FromSeconds(70),
+                    base::TimeDelta::FromSeconds(60));
+  EXPECT_EQ(ERR_DNS_CACHE_MISS,
+            CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_EQ(0u, num_running_dispatcher_jobs());
+}
+
+TEST_F(HostResolverImplTest, RefreshPopularEntryBeforeExpiry) {
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+  resolver_->SetStaleCacheParams(base::TimeDelta(), 2);
+  proc_->SignalMultiple(1u);
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest(info, DEFAULT_PRIORITY)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+
+  // Make the entry expire in 3 seconds.
+  AgeOnlyCacheEntry(resolver_->GetHostCache(),
+                    base::TimeDelta::FromSeconds(57),
+                    base::TimeDelta::FromSeconds(60));
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.43");
+
+  // The first hit doesn't make the entry popular enough to be refreshed.
+  EXPECT_EQ(OK, CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_EQ(0u, num_running_dispatcher_jobs());
+
+  // The second one does.
+  EXPECT_EQ(OK, CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
+  EXPECT_EQ(1u, num_running_dispatcher_jobs());
+
+  HostResolver::RequestInfo uncached_info(info);
+  uncached_info.set_allow_cached_response(false);
+  EXPECT_EQ(ERR_IO_PENDING,
+            CreateRequest(uncached_info, DEFAULT_PRIORITY)->Resolve());
+  proc_->SignalMultiple(1u);
+  EXPECT_EQ(OK, requests_[3]->WaitForResult());
+
+  EXPECT_EQ(OK, CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_TRUE(requests_[4]->HasOneAddress("192.168.1.43", 80));
+  EXPECT_EQ(0u, num_running_dispatcher_jobs());
+}
+
 // Test the retry attempts simulating host resolver proc that takes too long.
 TEST_F(HostResolverImplTest, MultipleAttempts) {
   // Total number of attempts would be 3 and we want the 3rd attempt to resolve
@@ -1878,6 +1982,49 @@ TEST_F(HostResolverImplDnsTest, AAAACompletesFirst) {
   EXPECT_EQ(ERR_DNS_TIMED_OUT, requests_[2]->result());
 }
 
+// Test that a slow AAAA answer doesn't hold up the IPv4 addresses for longer
+// than the partial result delay, and that the full result is cached later.
+TEST_F(HostResolverImplDnsTest, PartialResultAfterDelay) {
+  set_fallback_to_proctask(false);
+  resolver_->SetDefaultAddressFamily(ADDRESS_FAMILY_UNSPECIFIED);
+  resolver_->SetPartialResultDelay(base::TimeDelta::FromMilliseconds(1));
+  ChangeDnsConfig(CreateValidDnsConfig());
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_TRUE(requests_[0]->HasOneAddress("127.0.0.1", 80));
+
+  // The partial result isn't cached, while its refresh waits for AAAA.
+  EXPECT_EQ(ERR_DNS_CACHE_MISS,
+            CreateRequest("6slow_ok", 80)->ResolveFromCache());
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 80)->Resolve());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE(requests_[2]->completed());
+
+  dns_client_->CompleteDelayedTransactions();
+  EXPECT_EQ(OK, requests_[2]->WaitForResult());
+  EXPECT_EQ(2u, requests_[2]->NumberOfAddresses());
+  EXPECT_EQ(OK, CreateRequest("6slow_ok", 80)->ResolveFromCache());
+  EXPECT_EQ(2u, requests_[3]->NumberOfAddresses());
+}
+
+// Test that both answers are waited for when they come in time.
+TEST_F(HostResolverImplDnsTest, NoPartialResultWhenBothAnswersArrive) {
+  set_fallback_to_proctask(false);
+  resolver_->SetDefaultAddressFamily(ADDRESS_FAMILY_UNSPECIFIED);
+  resolver_->SetPartialResultDelay(base::TimeDelta::FromHours(1));
+  ChangeDnsConfig(CreateValidDnsConfig());
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("6slow_ok", 80)->Resolve());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE(requests_[0]->completed());
+
+  dns_client_->CompleteDelayedTransactions();
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_EQ(2u, requests_[0]->NumberOfAddresses());
+  EXPECT_EQ(OK, CreateRequest("6slow_ok", 80)->ResolveFromCache());
+}
+
 // Test the case where only a single transaction slot is available.
 TEST_F(HostResolverImplDnsTest, SerialResolver) {
   CreateSerialResolver();
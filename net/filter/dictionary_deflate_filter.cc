@@ -0,0 +1,166 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/filter/dictionary_deflate_filter.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "third_party/zlib/zlib.h"
+
+namespace net {
+
+namespace {
+
+// Dictionary server hash plus null, as in SDCH.
+const size_t kServerIdLength = 9;
+
+}  // namespace
+
+DictionaryDeflateFilter::DictionaryDeflateFilter(
+    const FilterContext& filter_context)
+    : decoding_status_(DECODING_UNINITIALIZED) {
+  bool success = filter_context.GetURL(&url_);
+  DCHECK(success);
+}
+
+DictionaryDeflateFilter::~DictionaryDeflateFilter() {
+  if (zlib_stream_.get())
+    inflateEnd(zlib_stream_.get());
+}
+
+bool DictionaryDeflateFilter::InitDecoding(Filter::FilterType filter_type) {
+  if (decoding_status_ != DECODING_UNINITIALIZED)
+    return false;
+  if (filter_type != FILTER_TYPE_DICTIONARY_DEFLATE)
+    return false;
+
+  // Initialize zlib only after we have a dictionary in hand.
+  decoding_status_ = WAITING_FOR_DICTIONARY_SELECTION;
+  return true;
+}
+
+Filter::FilterStatus DictionaryDeflateFilter::ReadFilteredData(
+    char* dest_buffer,
+    int* dest_len) {
+  if (!dest_buffer || !dest_len || *dest_len <= 0)
+    return FILTER_ERROR;
+
+  if (decoding_status_ == WAITING_FOR_DICTIONARY_SELECTION) {
+    FilterStatus status = InitializeDictionary();
+    if (status != FILTER_OK) {
+      *dest_len = 0;
+      return status;
+    }
+  }
+
+  if (decoding_status_ == DECODING_DONE) {
+    // Ignore anything after the end of the zlib stream.
+    next_stream_data_ = NULL;
+    stream_data_len_ = 0;
+    *dest_len = 0;
+    return FILTER_DONE;
+  }
+
+  if (decoding_status_ != DECODING_IN_PROGRESS)
+    return FILTER_ERROR;
+
+  return DoInflate(dest_buffer, dest_len);
+}
+
+Filter::FilterStatus DictionaryDeflateFilter::InitializeDictionary() {
+  size_t bytes_needed = kServerIdLength - dictionary_hash_.size();
+  DCHECK_GT(bytes_needed, 0u);
+  if (!next_stream_data_)
+    return FILTER_NEED_MORE_DATA;
+  if (static_cast<size_t>(stream_data_len_) < bytes_needed) {
+    dictionary_hash_.append(next_stream_data_, stream_data_len_);
+    next_stream_data_ = NULL;
+    stream_data_len_ = 0;
+    return FILTER_NEED_MORE_DATA;
+  }
+  dictionary_hash_.append(next_stream_data_, bytes_needed);
+  stream_data_len_ -= bytes_needed;
+  if (stream_data_len_ > 0)
+    next_stream_data_ += bytes_needed;
+  else
+    next_stream_data_ = NULL;
+
+  SdchManager::Dictionary* dictionary = NULL;
+  if (dictionary_hash_[kServerIdLength - 1] == '\0' && SdchManager::Global()) {
+    SdchManager::Global()->GetVcdiffDictionary(
+        std::string(dictionary_hash_, 0, kServerIdLength - 1), url_,
+        &dictionary);
+  }
+  if (!dictionary) {
+    decoding_status_ = DECODING_ERROR;
+    return FILTER_ERROR;
+  }
+  dictionary_ = dictionary;
+
+  zlib_stream_.reset(new z_stream);
+  memset(zlib_stream_.get(), 0, sizeof(z_stream));
+  if (inflateInit(zlib_stream_.get()) != Z_OK) {
+    zlib_stream_.reset();
+    decoding_status_ = DECODING_ERROR;
+    return FILTER_ERROR;
+  }
+
+  decoding_status_ = DECODING_IN_PROGRESS;
+  return next_stream_data_ ? FILTER_OK : FILTER_NEED_MORE_DATA;
+}
+
+Filter::FilterStatus DictionaryDeflateFilter::DoInflate(char* dest_buffer,
+                                                        int* dest_len) {
+  if (!next_stream_data_ || stream_data_len_ <= 0) {
+    *dest_len = 0;
+    return FILTER_NEED_MORE_DATA;
+  }
+
+  z_stream* stream = zlib_stream_.get();
+  stream->next_in = bit_cast<Bytef*>(next_stream_data_);
+  stream->avail_in = stream_data_len_;
+  stream->next_out = bit_cast<Bytef*>(dest_buffer);
+  stream->avail_out = *dest_len;
+
+  int inflate_code = inflate(stream, Z_NO_FLUSH);
+  if (inflate_code == Z_NEED_DICT) {
+    // zlib checks the dictionary's Adler-32 against the one in the stream
+    // header, so a mismatched dictionary fails here rather than producing
+    // garbage.
+    const std::string& text = dictionary_->text();
+    if (inflateSetDictionary(stream, bit_cast<const Bytef*>(text.data()),
+                             static_cast<uInt>(text.size())) != Z_OK) {
+      decoding_status_ = DECODING_ERROR;
+      return FILTER_ERROR;
+    }
+    inflate_code = inflate(stream, Z_NO_FLUSH);
+  }
+  *dest_len -= stream->avail_out;
+
+  stream_data_len_ = stream->avail_in;
+  next_stream_data_ =
+      stream_data_len_ ? bit_cast<char*>(stream->next_in) : NULL;
+
+  switch (inflate_code) {
+    case Z_STREAM_END:
+      decoding_status_ = DECODING_DONE;
+      next_stream_data_ = NULL;
+      stream_data_len_ = 0;
+      return FILTER_DONE;
+    case Z_OK:
+      return next_stream_data_ ? FILTER_OK : FILTER_NEED_MORE_DATA;
+    case Z_BUF_ERROR:
+      // The header alone may have been consumed before the dictionary was
+      // set, leaving nothing for the second inflate() call.
+      if (!next_stream_data_)
+        return FILTER_NEED_MORE_DATA;
+      // Fall through.
+    default:
+      decoding_status_ = DECODING_ERROR;
+      return FILTER_ERROR;
+  }
+}
+
+}  // namespace net
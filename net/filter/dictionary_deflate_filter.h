@@ -0,0 +1,91 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// DictionaryDeflateFilter decodes the "x-dictionary-deflate" content encoding,
+// a zlib stream compressed against a pre-shared dictionary. Dictionaries are
+// the ones SdchManager stores and advertises for SDCH, so a server that has
+// handed out an SDCH dictionary can use either encoding with it.
+//
+// The encoded body starts like an SDCH body, with the 8 character server hash
+// of the dictionary followed by a null, and continues with a zlib stream
+// (RFC 1950) whose preset dictionary is the dictionary text. Short responses
+// compress much better than with gzip because they can refer back into the
+// dictionary, and decoding is as fast as gzip since it is the same inflate.
+//
+// DictionaryDeflateFilter is a subclass of Filter. See the latter's header file
+// filter.h for sample usage.
+
+#ifndef NET_FILTER_DICTIONARY_DEFLATE_FILTER_H_
+#define NET_FILTER_DICTIONARY_DEFLATE_FILTER_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+#include "net/base/sdch_manager.h"
+#include "net/filter/filter.h"
+#include "url/gurl.h"
+
+typedef struct z_stream_s z_stream;
+
+namespace net {
+
+class NET_EXPORT_PRIVATE DictionaryDeflateFilter : public Filter {
+ public:
+  virtual ~DictionaryDeflateFilter();
+
+  // Initializes filter decoding mode and internal control blocks.
+  bool InitDecoding(Filter::FilterType filter_type);
+
+  // Decodes the pre-filter data and writes the output into |dest_buffer|.
+  // The function returns FilterStatus. See filter.h for its description.
+  //
+  // Upon entry, *dest_len is the total size (in number of chars) of the
+  // destination buffer. Upon exit, *dest_len is the actual number of chars
+  // written into the destination buffer.
+  virtual FilterStatus ReadFilteredData(char* dest_buffer,
+                                        int* dest_len) OVERRIDE;
+
+ private:
+  enum DecodingStatus {
+    DECODING_UNINITIALIZED,
+    WAITING_FOR_DICTIONARY_SELECTION,
+    DECODING_IN_PROGRESS,
+    DECODING_DONE,
+    DECODING_ERROR
+  };
+
+  // Only to be instantiated by Filter::Factory.
+  explicit DictionaryDeflateFilter(const FilterContext& filter_context);
+  friend class Filter;
+
+  // Reads the server hash at the start of the stream and looks up the
+  // dictionary it names. Returns FILTER_NEED_MORE_DATA until the whole hash
+  // has arrived, FILTER_ERROR if the dictionary isn't available for url_.
+  FilterStatus InitializeDictionary();
+
+  // Inflates the pre-filter data into |dest_buffer|, supplying the dictionary
+  // when zlib asks for it.
+  FilterStatus DoInflate(char* dest_buffer, int* dest_len);
+
+  DecodingStatus decoding_status_;
+
+  // The server hash and trailing null, accumulated until complete.
+  std::string dictionary_hash_;
+
+  // Holds a reference so the dictionary text stays alive while decoding.
+  scoped_refptr<SdchManager::Dictionary> dictionary_;
+
+  // The URL of the response, used to check that the dictionary may be used.
+  GURL url_;
+
+  scoped_ptr<z_stream> zlib_stream_;
+
+  DISALLOW_COPY_AND_ASSIGN(DictionaryDeflateFilter);
+};
+
+}  // namespace net
+
+#endif  // NET_FILTER_DICTIONARY_DEFLATE_FILTER_H_
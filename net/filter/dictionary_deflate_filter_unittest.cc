@@ -0,0 +1,178 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/filter/dictionary_deflate_filter.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "net/base/io_buffer.h"
+#include "net/base/sdch_manager.h"
+#include "net/filter/mock_filter_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/zlib/zlib.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+const char kSampleDomain[] = "dictionarytest.com";
+
+const char kDictionaryText[] =
+    "<html><head><title>Example</title></head><body><div class=\"content\">"
+    "Repeated boilerplate that both ends already have.</div></body></html>";
+
+const char kTestData[] =
+    "<html><head><title>Hello</title></head><body><div class=\"content\">"
+    "Repeated boilerplate that both ends already have, and a little more."
+    "</div></body></html>";
+
+std::string NewDictionary(const std::string& domain) {
+  return "Domain: " + domain + "\n\n" + kDictionaryText;
+}
+
+// Compresses |data| against |dictionary_text|, and prefixes the server hash of
+// |dictionary|, as a server would.
+std::string Encode(const std::string& dictionary,
+                   const std::string& dictionary_text,
+                   const std::string& data) {
+  std::string client_hash;
+  std::string server_hash;
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  EXPECT_EQ(Z_OK, deflateInit(&stream, Z_BEST_COMPRESSION));
+  EXPECT_EQ(Z_OK, deflateSetDictionary(
+      &stream, reinterpret_cast<const Bytef*>(dictionary_text.data()),
+      dictionary_text.size()));
+
+  std::vector<char> output(deflateBound(&stream, data.size()));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = output.size();
+  EXPECT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  output.resize(output.size() - stream.avail_out);
+  deflateEnd(&stream);
+
+  std::string encoded(server_hash);
+  encoded.append("\0", 1);
+  encoded.append(output.begin(), output.end());
+  return encoded;
+}
+
+// Feeds |source| to |filter| in blocks of at most |input_block_length| and
+// reads the output in blocks of |output_block_length|. Returns false if the
+// filter reported an error.
+bool FilterTestData(const std::string& source,
+                    size_t input_block_length,
+                    size_t output_block_length,
+                    Filter* filter,
+                    std::string* output) {
+  scoped_ptr<char[]> output_buffer(new char[output_block_length]);
+  size_t input_amount = std::min(
+      input_block_length, static_cast<size_t>(filter->stream_buffer_size()));
+  size_t source_index = 0;
+  Filter::FilterStatus status = Filter::FILTER_NEED_MORE_DATA;
+  while (true) {
+    size_t copy_amount = 0;
+    if (status == Filter::FILTER_NEED_MORE_DATA) {
+      copy_amount = std::min(input_amount, source.size() - source_index);
+      if (copy_amount > 0) {
+        memcpy(filter->stream_buffer()->data(), source.data() + source_index,
+               copy_amount);
+        filter->FlushStreamBuffer(copy_amount);
+        source_index += copy_amount;
+      }
+    }
+    int buffer_length = output_block_length;
+    status = filter->ReadData(output_buffer.get(), &buffer_length);
+    output->append(output_buffer.get(), buffer_length);
+    if (status == Filter::FILTER_ERROR)
+      return false;
+    if (status == Filter::FILTER_DONE)
+      return true;
+    if (copy_amount == 0 && buffer_length == 0)
+      return true;
+  }
+}
+
+}  // namespace
+
+class DictionaryDeflateFilterTest : public testing::Test {
+ protected:
+  DictionaryDeflateFilterTest()
+      : sdch_manager_(new SdchManager),
+        url_(std::string("http://") + kSampleDomain) {
+    filter_types_.push_back(Filter::FILTER_TYPE_DICTIONARY_DEFLATE);
+    filter_context_.SetURL(url_);
+  }
+
+  scoped_ptr<SdchManager> sdch_manager_;
+  const GURL url_;
+  std::vector<Filter::FilterType> filter_types_;
+  MockFilterContext filter_context_;
+};
+
+TEST_F(DictionaryDeflateFilterTest, Decode) {
+  std::string dictionary(NewDictionary(kSampleDomain));
+  ASSERT_TRUE(sdch_manager_->AddSdchDictionary(dictionary, url_));
+  std::string encoded(Encode(dictionary, kDictionaryText, kTestData));
+
+  scoped_ptr<Filter> filter(Filter::Factory(filter_types_, filter_context_));
+  ASSERT_TRUE(filter.get());
+  std::string output;
+  EXPECT_TRUE(FilterTestData(encoded, 100, 100, filter.get(), &output));
+  EXPECT_EQ(kTestData, output);
+
+  // Decode with really small buffers (size 1) to check for edge effects.
+  filter.reset(Filter::Factory(filter_types_, filter_context_));
+  output.clear();
+  EXPECT_TRUE(FilterTestData(encoded, 1, 1, filter.get(), &output));
+  EXPECT_EQ(kTestData, output);
+}
+
+TEST_F(DictionaryDeflateFilterTest, UnknownDictionary) {
+  std::string dictionary(NewDictionary(kSampleDomain));
+  std::string encoded(Encode(dictionary, kDictionaryText, kTestData));
+
+  scoped_ptr<Filter> filter(Filter::Factory(filter_types_, filter_context_));
+  ASSERT_TRUE(filter.get());
+  std::string output;
+  EXPECT_FALSE(FilterTestData(encoded, 100, 100, filter.get(), &output));
+  EXPECT_TRUE(output.empty());
+}
+
+TEST_F(DictionaryDeflateFilterTest, DictionaryForOtherDomain) {
+  std::string dictionary(NewDictionary(kSampleDomain));
+  ASSERT_TRUE(sdch_manager_->AddSdchDictionary(dictionary, url_));
+  std::string encoded(Encode(dictionary, kDictionaryText, kTestData));
+
+  MockFilterContext filter_context;
+  filter_context.SetURL(GURL("http://www.example.com"));
+  scoped_ptr<Filter> filter(Filter::Factory(filter_types_, filter_context));
+  ASSERT_TRUE(filter.get());
+  std::string output;
+  EXPECT_FALSE(FilterTestData(encoded, 100, 100, filter.get(), &output));
+}
+
+// A stream compressed against different text fails zlib's dictionary check.
+TEST_F(DictionaryDeflateFilterTest, WrongDictionaryText) {
+  std::string dictionary(NewDictionary(kSampleDomain));
+  ASSERT_TRUE(sdch_manager_->AddSdchDictionary(dictionary, url_));
+  std::string encoded(Encode(dictionary, "some other text", kTestData));
+
+  scoped_ptr<Filter> filter(Filter::Factory(filter_types_, filter_context_));
+  ASSERT_TRUE(filter.get());
+  std::string output;
+  EXPECT_FALSE(FilterTestData(encoded, 100, 100, filter.get(), &output));
+  EXPECT_TRUE(output.empty());
+}
+
+}  // namespace net
@@ -8,6 +8,7 @@
 #include "base/strings/string_util.h"
 #include "net/base/io_buffer.h"
 #include "net/base/mime_util.h"
+#include "net/filter/dictionary_deflate_filter.h"
 #include "net/filter/gzip_filter.h"
 #include "net/filter/sdch_filter.h"
 
@@ -18,6 +19,7 @@ const char kDeflate[]      = "deflate";
 const char kGZip[]         = "gzip";
 const char kXGZip[]        = "x-gzip";
 const char kSdch[]         = "sdch";
+const char kDictionaryDeflate[] = "x-dictionary-deflate";
 // compress and x-compress are currently not supported.  If we decide to support
 // them, we'll need the same mime type compatibility hack we have for gzip.  For
 // more information, see Firefox's nsHttpChannel::ProcessNormal.
@@ -142,6 +144,8 @@ Filter::FilterType Filter::ConvertEncodingToType(
     type_id = FILTER_TYPE_GZIP;
   } else if (LowerCaseEqualsASCII(filter_type, kSdch)) {
     type_id = FILTER_TYPE_SDCH;
+  } else if (LowerCaseEqualsASCII(filter_type, kDictionaryDeflate)) {
+    type_id = FILTER_TYPE_DICTIONARY_DEFLATE;
   } else {
     // Note we also consider "identity" and "uncompressed" UNSUPPORTED as
     // filter should be disabled in such cases.
@@ -221,6 +225,12 @@ void Filter::FixupEncodingTypes(
   // very strange things to the request, or the response, so we have to handle
   // them gracefully.
 
+  // The dictionary may also have been used by the other encoding that
+  // supports it, which doesn't need any of the SDCH fixups.
+  if (!encoding_types->empty() &&
+      (FILTER_TYPE_DICTIONARY_DEFLATE == encoding_types->front()))
+    return;
+
   // If content encoding included SDCH, then everything is "relatively" fine.
   if (!encoding_types->empty() &&
       (FILTER_TYPE_SDCH == encoding_types->front())) {
@@ -355,6 +365,17 @@ Filter* Filter::InitSdchFilter(FilterType type_id,
   return sdch_filter->InitDecoding(type_id) ? sdch_filter.release() : NULL;
 }
 
+// static
+Filter* Filter::InitDictionaryDeflateFilter(
+    FilterType type_id,
+    const FilterContext& filter_context,
+    int buffer_size) {
+  scoped_ptr<DictionaryDeflateFilter> filter(
+      new DictionaryDeflateFilter(filter_context));
+  filter->InitBuffer(buffer_size);
+  return filter->InitDecoding(type_id) ? filter.release() : NULL;
+}
+
 // static
 Filter* Filter::PrependNewFilter(FilterType type_id,
                                  const FilterContext& filter_context,
@@ -374,6 +395,12 @@ Filter* Filter::PrependNewFilter(FilterType type_id,
             InitSdchFilter(type_id, filter_context, buffer_size));
       }
       break;
+    case FILTER_TYPE_DICTIONARY_DEFLATE:
+      if (SdchManager::Global() && SdchManager::sdch_enabled()) {
+        first_filter.reset(InitDictionaryDeflateFilter(
+            type_id, filter_context, buffer_size));
+      }
+      break;
     default:
       break;
   }
@@ -125,6 +125,7 @@ class NET_EXPORT_PRIVATE Filter {
     FILTER_TYPE_GZIP_HELPING_SDCH,  // Gzip possible, but pass through allowed.
     FILTER_TYPE_SDCH,
     FILTER_TYPE_SDCH_POSSIBLE,  // Sdch possible, but pass through allowed.
+    FILTER_TYPE_DICTIONARY_DEFLATE,
     FILTER_TYPE_UNSUPPORTED,
   };
 
@@ -252,6 +253,10 @@ class NET_EXPORT_PRIVATE Filter {
   static Filter* InitSdchFilter(FilterType type_id,
                                 const FilterContext& filter_context,
                                 int buffer_size);
+  static Filter* InitDictionaryDeflateFilter(
+      FilterType type_id,
+      const FilterContext& filter_context,
+      int buffer_size);
 
   // Helper function to empty our output into the next filter's input.
   void PushDataIntoNextFilter();
@@ -0,0 +1,153 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/path_service.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "net/base/io_buffer.h"
+#include "net/base/sdch_manager.h"
+#include "net/filter/filter.h"
+#include "net/filter/mock_filter_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/zlib/zlib.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+// How many times each body is decoded.
+const int kIterations = 2000;
+
+const char kSampleDomain[] = "filterperftest.com";
+
+// Deflates |data| in zlib format, using |dictionary_text| as the preset
+// dictionary if it isn't empty.
+std::string Deflate(const std::string& data,
+                    const std::string& dictionary_text) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  EXPECT_EQ(Z_OK, deflateInit(&stream, Z_BEST_COMPRESSION));
+  if (!dictionary_text.empty()) {
+    EXPECT_EQ(Z_OK, deflateSetDictionary(
+        &stream, reinterpret_cast<const Bytef*>(dictionary_text.data()),
+        dictionary_text.size()));
+  }
+  std::vector<char> output(deflateBound(&stream, data.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = output.size();
+  EXPECT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  output.resize(output.size() - stream.avail_out);
+  deflateEnd(&stream);
+  return std::string(output.begin(), output.end());
+}
+
+// Decodes |encoded| with a new filter chain of |filter_types|, |iterations|
+// times, and checks the result is |expected|.
+void DecodeRepeatedly(const std::vector<Filter::FilterType>& filter_types,
+                      const FilterContext& filter_context,
+                      const std::string& encoded,
+                      const std::string& expected,
+                      int iterations) {
+  scoped_refptr<IOBuffer> output(new IOBuffer(32 * 1024));
+  for (int i = 0; i < iterations; ++i) {
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context));
+    ASSERT_TRUE(filter.get());
+    size_t decoded = 0;
+    size_t offset = 0;
+    Filter::FilterStatus status = Filter::FILTER_NEED_MORE_DATA;
+    while (status != Filter::FILTER_DONE) {
+      if (status == Filter::FILTER_NEED_MORE_DATA) {
+        ASSERT_LT(offset, encoded.size());
+        size_t amount = std::min(encoded.size() - offset,
+                                 static_cast<size_t>(
+                                     filter->stream_buffer_size()));
+        memcpy(filter->stream_buffer()->data(), encoded.data() + offset,
+               amount);
+        filter->FlushStreamBuffer(amount);
+        offset += amount;
+      }
+      int output_len = output->size();
+      status = filter->ReadData(output->data(), &output_len);
+      ASSERT_NE(Filter::FILTER_ERROR, status);
+      decoded += output_len;
+    }
+    ASSERT_EQ(expected.size(), decoded);
+  }
+}
+
+}  // namespace
+
+class FilterPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    base::FilePath file_path;
+    PathService::Get(base::DIR_SOURCE_ROOT, &file_path);
+    file_path = file_path.AppendASCII("net")
+                         .AppendASCII("data")
+                         .AppendASCII("filter_unittests")
+                         .AppendASCII("google.txt");
+    ASSERT_TRUE(base::ReadFileToString(file_path, &source_));
+  }
+
+  std::string source_;
+};
+
+// Compares decoding a page with deflate (GZipFilter) against decoding it with
+// x-dictionary-deflate, where a dictionary built from an earlier version of
+// the page is available.
+TEST_F(FilterPerfTest, DecodeThroughput) {
+  // Stands in for a dictionary of the site's common markup: the first half of
+  // the page with a small edit.
+  std::string dictionary_text = source_.substr(0, source_.size() / 2);
+  dictionary_text[dictionary_text.size() / 2] ^= 1;
+  std::string dictionary =
+      std::string("Domain: ") + kSampleDomain + "\n\n" + dictionary_text;
+  SdchManager sdch_manager;
+  GURL url(std::string("http://") + kSampleDomain);
+  ASSERT_TRUE(sdch_manager.AddSdchDictionary(dictionary, url));
+
+  std::string client_hash;
+  std::string server_hash;
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+
+  std::string deflate_encoded = Deflate(source_, std::string());
+  std::string dictionary_encoded = server_hash;
+  dictionary_encoded.append("\0", 1);
+  dictionary_encoded.append(Deflate(source_, dictionary_text));
+
+  LOG(ERROR) << base::StringPrintf(
+      "%u byte body: deflate %u bytes, x-dictionary-deflate %u bytes",
+      static_cast<unsigned>(source_.size()),
+      static_cast<unsigned>(deflate_encoded.size()),
+      static_cast<unsigned>(dictionary_encoded.size()));
+
+  MockFilterContext filter_context;
+  filter_context.SetURL(url);
+
+  std::vector<Filter::FilterType> deflate_types;
+  deflate_types.push_back(Filter::FILTER_TYPE_DEFLATE);
+  base::PerfTimeLogger deflate_timer("Filter_Decode_Deflate");
+  DecodeRepeatedly(deflate_types, filter_context, deflate_encoded, source_,
+                   kIterations);
+  deflate_timer.Done();
+
+  std::vector<Filter::FilterType> dictionary_types;
+  dictionary_types.push_back(Filter::FILTER_TYPE_DICTIONARY_DEFLATE);
+  base::PerfTimeLogger dictionary_timer("Filter_Decode_DictionaryDeflate");
+  DecodeRepeatedly(dictionary_types, filter_context, dictionary_encoded,
+                   source_, kIterations);
+  dictionary_timer.Done();
+}
+
+}  // namespace net
@@ -29,6 +29,8 @@ TEST(FilterTest, ContentTypeId) {
             Filter::ConvertEncodingToType("sdch"));
   EXPECT_EQ(Filter::FILTER_TYPE_SDCH,
             Filter::ConvertEncodingToType("sDcH"));
+  EXPECT_EQ(Filter::FILTER_TYPE_DICTIONARY_DEFLATE,
+            Filter::ConvertEncodingToType("x-dictionary-deflate"));
   EXPECT_EQ(Filter::FILTER_TYPE_UNSUPPORTED,
             Filter::ConvertEncodingToType("weird"));
   EXPECT_EQ(Filter::FILTER_TYPE_UNSUPPORTED,
@@ -117,6 +119,14 @@ TEST(FilterTest, SdchEncoding) {
   ASSERT_EQ(2U, encoding_types.size());
   EXPECT_EQ(Filter::FILTER_TYPE_SDCH, encoding_types[0]);
   EXPECT_EQ(Filter::FILTER_TYPE_GZIP_HELPING_SDCH, encoding_types[1]);
+
+  // The dictionary can also be used with x-dictionary-deflate, which is left
+  // alone.
+  encoding_types.clear();
+  encoding_types.push_back(Filter::FILTER_TYPE_DICTIONARY_DEFLATE);
+  Filter::FixupEncodingTypes(filter_context, &encoding_types);
+  ASSERT_EQ(1U, encoding_types.size());
+  EXPECT_EQ(Filter::FILTER_TYPE_DICTIONARY_DEFLATE, encoding_types[0]);
 }
 
 TEST(FilterTest, MissingSdchEncoding) {
@@ -95,7 +95,9 @@ HttpCache::ActiveEntry::ActiveEntry(disk_cache::Entry* entry)
     : disk_entry(entry),
       writer(NULL),
       will_process_pending_queue(false),
-      doomed(false) {
+      doomed(false),
+      writer_streaming(false),
+      writer_failed(false) {
 }
 
 HttpCache::ActiveEntry::~ActiveEntry() {
@@ -290,6 +292,7 @@ HttpCache::HttpCache(const net::HttpNetworkSession::Params& params,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
+      enable_tailing_readers_(false),
       quic_server_info_factory_(new QuicServerInfoFactoryAdaptor(this)),
       network_layer_(new HttpNetworkLayer(new HttpNetworkSession(params))) {
 }
@@ -301,6 +304,7 @@ HttpCache::HttpCache(HttpNetworkSession* session,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
+      enable_tailing_readers_(false),
       quic_server_info_factory_(new QuicServerInfoFactoryAdaptor(this)),
       network_layer_(new HttpNetworkLayer(session)) {
 }
@@ -312,6 +316,7 @@ HttpCache::HttpCache(HttpTransactionFactory* network_layer,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
+      enable_tailing_readers_(false),
       network_layer_(network_layer) {
 }
 
@@ -809,6 +814,13 @@ int HttpCache::AddTransactionToEntry(ActiveEntry* entry, Transaction* trans) {
   //
   // NOTE: If the transaction can only write, then the entry should not be in
   // use (since any existing entry should have already been doomed).
+  //
+  // Readers may also tail a writer that is streaming a complete response.
+
+  if (entry->writer && entry->writer_streaming && trans->CanTailWriter()) {
+    entry->readers.push_back(trans);
+    return OK;
+  }
 
   if (entry->writer || entry->will_process_pending_queue) {
     entry->pending_queue.push_back(trans);
@@ -844,8 +856,10 @@ void HttpCache::DoneWithEntry(ActiveEntry* entry, Transaction* trans,
   if (entry->will_process_pending_queue && entry->readers.empty())
     return;
 
-  if (entry->writer) {
-    DCHECK(trans == entry->writer);
+  if (entry->writer == trans) {
+    // Readers tailing the writer can't get the rest of the response anymore,
+    // even if the entry is kept as truncated.
+    entry->writer_failed = true;
 
     // Assume there was a failure.
     bool success = false;
@@ -865,9 +879,30 @@ void HttpCache::DoneWithEntry(ActiveEntry* entry, Transaction* trans,
 }
 
 void HttpCache::DoneWritingToEntry(ActiveEntry* entry, bool success) {
-  DCHECK(entry->readers.empty());
-
   entry->writer = NULL;
+  entry->writer_streaming = false;
+  if (!success)
+    entry->writer_failed = true;
+
+  if (!entry->readers.empty()) {
+    // All the readers are tailing the writer.
+    NotifyWaitingReaders(entry);
+    if (success) {
+      ProcessPendingQueue(entry);
+      return;
+    }
+
+    // Let the readers finish with a doomed entry, and restart everybody else.
+    TransactionList pending_queue;
+    pending_queue.swap(entry->pending_queue);
+    if (!entry->doomed)
+      DoomActiveEntry(entry->disk_entry->GetKey());
+    while (!pending_queue.empty()) {
+      pending_queue.front()->io_callback().Run(ERR_CACHE_RACE);
+      pending_queue.pop_front();
+    }
+    return;
+  }
 
   if (success) {
     ProcessPendingQueue(entry);
@@ -892,13 +927,16 @@ void HttpCache::DoneWritingToEntry(ActiveEntry* entry, bool success) {
 }
 
 void HttpCache::DoneReadingFromEntry(ActiveEntry* entry, Transaction* trans) {
-  DCHECK(!entry->writer);
-
   TransactionList::iterator it =
       std::find(entry->readers.begin(), entry->readers.end(), trans);
   DCHECK(it != entry->readers.end());
 
   entry->readers.erase(it);
+  entry->waiting_readers.remove(trans);
+
+  // The pending queue is processed once the writer is done.
+  if (entry->writer)
+    return;
 
   ProcessPendingQueue(entry);
 }
@@ -916,6 +954,46 @@ void HttpCache::ConvertWriterToReader(ActiveEntry* entry) {
   ProcessPendingQueue(entry);
 }
 
+void HttpCache::AllowTailingReaders(ActiveEntry* entry) {
+  DCHECK(entry->writer);
+  if (!enable_tailing_readers_)
+    return;
+  entry->writer_streaming = true;
+  entry->writer_failed = false;
+
+  TransactionList::iterator it = entry->pending_queue.begin();
+  while (it != entry->pending_queue.end()) {
+    Transaction* trans = *it;
+    if (!trans->CanTailWriter()) {
+      ++it;
+      continue;
+    }
+    entry->pending_queue.erase(it++);
+    entry->readers.push_back(trans);
+    // Don't run the reader from within the writer's IO loop.
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(trans->io_callback(), OK));
+  }
+}
+
+void HttpCache::WaitForWriter(ActiveEntry* entry, Transaction* trans) {
+  DCHECK(entry->writer);
+  DCHECK(std::find(entry->readers.begin(), entry->readers.end(), trans) !=
+         entry->readers.end());
+  entry->waiting_readers.push_back(trans);
+}
+
+void HttpCache::NotifyWaitingReaders(ActiveEntry* entry) {
+  TransactionList waiting_readers;
+  waiting_readers.swap(entry->waiting_readers);
+  // The IO callback of a transaction does nothing once it is destroyed.
+  for (TransactionList::iterator it = waiting_readers.begin();
+       it != waiting_readers.end(); ++it) {
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind((*it)->io_callback(), OK));
+  }
+}
+
 LoadState HttpCache::GetLoadStateForPendingTransaction(
       const Transaction* trans) {
   ActiveEntriesMap::const_iterator i = active_entries_.find(trans->key());
@@ -174,6 +174,13 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   void set_mode(Mode value) { mode_ = value; }
   Mode mode() { return mode_; }
 
+  // When enabled, transactions that only need to read an entry don't wait for
+  // its writer to finish: they start reading as soon as the writer appends the
+  // body of a complete response, and follow it as more data is written.
+  void set_enable_tailing_readers(bool value) {
+    enable_tailing_readers_ = value;
+  }
+
   // Close currently active sockets so that fresh page loads will not use any
   // recycled connections.  For sockets currently in use, they may not close
   // immediately, but they will not be reusable. This is for debugging.
@@ -238,6 +245,17 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
     TransactionList    pending_queue;
     bool               will_process_pending_queue;
     bool               doomed;
+
+    // True while |writer| appends the body of a complete response, so that
+    // readers can tail it.
+    bool               writer_streaming;
+
+    // True if the writer tailed by |readers| went away before writing the
+    // whole response.
+    bool               writer_failed;
+
+    // Readers that caught up with |writer| and wait for more data.
+    TransactionList    waiting_readers;
   };
 
   typedef base::hash_map<std::string, ActiveEntry*> ActiveEntriesMap;
@@ -340,6 +358,19 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // transactions can start reading from this entry.
   void ConvertWriterToReader(ActiveEntry* entry);
 
+  // Called by the writer of |entry| when it starts appending the body of a
+  // complete response. The pending transactions that only need to read the
+  // entry are let in to tail the writer.
+  void AllowTailingReaders(ActiveEntry* entry);
+
+  // Called by a reader of |entry| that read all the data written so far. The
+  // IO callback of |trans| is invoked once the writer appends more data or
+  // goes away.
+  void WaitForWriter(ActiveEntry* entry, Transaction* trans);
+
+  // Notifies the readers waiting on the writer of |entry|.
+  void NotifyWaitingReaders(ActiveEntry* entry);
+
   // Returns the LoadState of the provided pending transaction.
   LoadState GetLoadStateForPendingTransaction(const Transaction* trans);
 
@@ -390,6 +421,8 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
 
   Mode mode_;
 
+  bool enable_tailing_readers_;
+
   const scoped_ptr<QuicServerInfoFactoryAdaptor> quic_server_info_factory_;
 
   scoped_ptr<HttpTransactionFactory> network_layer_;
@@ -1400,6 +1400,12 @@ int HttpCache::Transaction::DoTruncateCachedMetadataComplete(int result) {
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HTTP_CACHE_WRITE_INFO,
                                         result);
     }
+    // The response info is stored and the body is about to be appended, so
+    // other readers don't have to wait for the whole body.
+    if (mode_ == WRITE && !partial_.get() && !truncated_ &&
+        response_.headers->response_code() == 200) {
+      cache_->AllowTailingReaders(entry_);
+    }
   }
 
   next_state_ = STATE_PARTIAL_HEADERS_RECEIVED;
@@ -1572,6 +1578,8 @@ int HttpCache::Transaction::DoCacheReadData() {
                                io_callback_);
   }
 
+  // |read_buf_| is the consumer's buffer: the backend copies the data only
+  // once, straight from its storage.
   return entry_->disk_entry->ReadData(kResponseContentIndex, read_offset_,
                                       read_buf_.get(), io_buf_len_,
                                       io_callback_);
@@ -1595,6 +1603,15 @@ int HttpCache::Transaction::DoCacheReadDataComplete(int result) {
 
   if (result > 0) {
     read_offset_ += result;
+  } else if (result == 0 && IsTailingWriter()) {
+    // Wait for more data.
+    next_state_ = STATE_CACHE_READ_DATA;
+    cache_->WaitForWriter(entry_, this);
+    return ERR_IO_PENDING;
+  } else if (result == 0 && entry_->writer_failed &&
+             response_.headers->GetContentLength() != read_offset_) {
+    // The writer we were tailing went away before the end of the response.
+    return OnCacheReadError(ERR_CACHE_READ_FAILURE, false);
   } else if (result == 0) {  // End of file.
     RecordHistograms();
     cache_->DoneReadingFromEntry(entry_, this);
@@ -1634,11 +1651,15 @@ int HttpCache::Transaction::DoCacheWriteDataComplete(int result) {
     // We want to ignore errors writing to disk and just keep reading from
     // the network.
     result = write_len_;
-  } else if (!done_reading_ && entry_) {
-    int current_size = entry_->disk_entry->GetDataSize(kResponseContentIndex);
-    int64 body_size = response_.headers->GetContentLength();
-    if (body_size >= 0 && body_size <= current_size)
-      done_reading_ = true;
+  } else if (entry_) {
+    cache_->NotifyWaitingReaders(entry_);
+    if (!done_reading_) {
+      int current_size =
+          entry_->disk_entry->GetDataSize(kResponseContentIndex);
+      int64 body_size = response_.headers->GetContentLength();
+      if (body_size >= 0 && body_size <= current_size)
+        done_reading_ = true;
+    }
   }
 
   if (partial_.get()) {
@@ -1839,6 +1860,13 @@ int HttpCache::Transaction::BeginCacheValidation() {
     UpdateTransactionPattern(PATTERN_ENTRY_USED);
     RecordOfflineStatus(effective_load_flags_, OFFLINE_STATUS_FRESH_CACHE);
     return SetupEntryForRead();
+  } else if (IsTailingWriter()) {
+    // The entry can't be validated while it is being written, so just go to
+    // the network without touching it.
+    cache_->DoneReadingFromEntry(entry_, this);
+    entry_ = NULL;
+    mode_ = NONE;
+    next_state_ = STATE_SEND_REQUEST;
   } else {
     // Make the network request conditional, to see if we may reuse our cached
     // response.  If we cannot do so, then we just resort to a normal fetch.
@@ -2219,7 +2247,8 @@ int HttpCache::Transaction::SetupEntryForRead() {
       partial_.reset();
     }
   }
-  cache_->ConvertWriterToReader(entry_);
+  if (!IsTailingWriter())
+    cache_->ConvertWriterToReader(entry_);
   mode_ = READ;
 
   if (entry_->disk_entry->GetDataSize(kMetadataIndex))
@@ -2519,6 +2548,10 @@ void HttpCache::Transaction::RecordHistograms() {
   }
 }
 
+bool HttpCache::Transaction::IsTailingWriter() const {
+  return entry_ && entry_->writer && entry_->writer != this;
+}
+
 void HttpCache::Transaction::OnIOComplete(int result) {
   DoLoop(result);
 }
@@ -93,6 +93,12 @@ class HttpCache::Transaction : public HttpTransaction {
 
   HttpCache::ActiveEntry* entry() { return entry_; }
 
+  // Returns true if this transaction may read an entry while its writer is
+  // still appending the response body.
+  bool CanTailWriter() const {
+    return (mode_ == READ || mode_ == READ_WRITE) && !partial_.get();
+  }
+
   // Returns the LoadState of the writer transaction of a given ActiveEntry. In
   // other words, returns the LoadState of this transaction without asking the
   // http cache, because this transaction should be the one currently writing
@@ -379,6 +385,10 @@ class HttpCache::Transaction : public HttpTransaction {
   void UpdateTransactionPattern(TransactionPattern new_transaction_pattern);
   void RecordHistograms();
 
+  // Returns true if this transaction reads |entry_| while another transaction
+  // is writing it.
+  bool IsTailingWriter() const;
+
   // Called to signal completion of asynchronous IO.
   void OnIOComplete(int result);
 
@@ -1390,6 +1390,104 @@ TEST(HttpCache, SimpleGET_RacingReaders) {
   }
 }
 
+// Tests that a reader doesn't wait for the writer to finish, and gets the data
+// as soon as it is written to the cache.
+TEST(HttpCache, SimpleGET_ReaderTailsWriter) {
+  MockHttpCache cache;
+  cache.http_cache()->set_enable_tailing_readers(true);
+
+  MockHttpRequest request(kSimpleGET_Transaction);
+
+  Context writer;
+  ASSERT_EQ(net::OK, cache.CreateTransaction(&writer.trans));
+  writer.result = writer.trans->Start(
+      &request, writer.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, writer.callback.GetResult(writer.result));
+
+  // The writer hasn't read the body yet.
+  Context reader;
+  ASSERT_EQ(net::OK, cache.CreateTransaction(&reader.trans));
+  reader.result = reader.trans->Start(
+      &request, reader.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, reader.callback.GetResult(reader.result));
+
+  const std::string expected(kSimpleGET_Transaction.data);
+  const int kChunkSize = 8;
+  scoped_refptr<net::IOBuffer> write_buf(new net::IOBuffer(kChunkSize));
+  scoped_refptr<net::IOBuffer> read_buf(new net::IOBuffer(kChunkSize));
+  std::string written;
+  std::string read;
+  while (written.size() < expected.size()) {
+    // The reader caught up with the writer, so it waits for more data.
+    int read_rv = reader.trans->Read(read_buf.get(), kChunkSize,
+                                     reader.callback.callback());
+    ASSERT_EQ(net::ERR_IO_PENDING, read_rv);
+
+    int rv = writer.callback.GetResult(
+        writer.trans->Read(write_buf.get(), kChunkSize,
+                           writer.callback.callback()));
+    ASSERT_GT(rv, 0);
+    written.append(write_buf->data(), rv);
+
+    rv = reader.callback.WaitForResult();
+    ASSERT_GT(rv, 0);
+    read.append(read_buf->data(), rv);
+    EXPECT_EQ(written, read);
+  }
+
+  int read_rv = reader.trans->Read(read_buf.get(), kChunkSize,
+                                   reader.callback.callback());
+  EXPECT_EQ(0, writer.callback.GetResult(
+      writer.trans->Read(write_buf.get(), kChunkSize,
+                         writer.callback.callback())));
+  EXPECT_EQ(0, reader.callback.GetResult(read_rv));
+  EXPECT_EQ(expected, read);
+
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+}
+
+// Tests that a reader tailing a writer fails if the writer goes away before
+// writing the whole response.
+TEST(HttpCache, SimpleGET_ReaderTailsCancelledWriter) {
+  MockHttpCache cache;
+  cache.http_cache()->set_enable_tailing_readers(true);
+
+  MockHttpRequest request(kSimpleGET_Transaction);
+
+  Context writer;
+  ASSERT_EQ(net::OK, cache.CreateTransaction(&writer.trans));
+  writer.result = writer.trans->Start(
+      &request, writer.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, writer.callback.GetResult(writer.result));
+
+  Context reader;
+  ASSERT_EQ(net::OK, cache.CreateTransaction(&reader.trans));
+  reader.result = reader.trans->Start(
+      &request, reader.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, reader.callback.GetResult(reader.result));
+
+  const int kChunkSize = 8;
+  scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(kChunkSize));
+  EXPECT_EQ(kChunkSize, writer.callback.GetResult(
+      writer.trans->Read(buf.get(), kChunkSize, writer.callback.callback())));
+  EXPECT_EQ(kChunkSize, reader.callback.GetResult(
+      reader.trans->Read(buf.get(), kChunkSize, reader.callback.callback())));
+
+  int rv = reader.trans->Read(buf.get(), kChunkSize,
+                              reader.callback.callback());
+  ASSERT_EQ(net::ERR_IO_PENDING, rv);
+  writer.trans.reset();
+  EXPECT_EQ(net::ERR_CACHE_READ_FAILURE, reader.callback.WaitForResult());
+  reader.trans.reset();
+
+  // The truncated entry is not used.
+  RunTransactionTest(cache.http_cache(), kSimpleGET_Transaction);
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(2, cache.disk_cache()->create_count());
+}
+
 // Tests that we can doom an entry with pending transactions and delete one of
 // the pending transactions before the first one completes.
 // See http://code.google.com/p/chromium/issues/detail?id=25588
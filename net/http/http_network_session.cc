@@ -190,6 +190,13 @@ SSLClientSocketPool* HttpNetworkSession::GetSocketPoolForSSLWithProxy(
       proxy_server);
 }
 
+int HttpNetworkSession::RecordSocketRequest(SocketPoolType pool_type,
+                                            const HostPortPair& endpoint,
+                                            const std::string& group_name) {
+  return GetSocketPoolManager(pool_type)->RecordSocketRequest(endpoint,
+                                                              group_name);
+}
+
 base::Value* HttpNetworkSession::SocketPoolInfoToValue() const {
   // TODO(yutak): Should merge values from normal pools and WebSocket pools.
   return normal_socket_pool_manager_->SocketPoolInfoToValue();
@@ -129,6 +129,11 @@ class NET_EXPORT HttpNetworkSession
       SocketPoolType pool_type,
       const HostPortPair& proxy_server);
 
+  // See ClientSocketPoolManager::RecordSocketRequest().
+  int RecordSocketRequest(SocketPoolType pool_type,
+                          const HostPortPair& endpoint,
+                          const std::string& group_name);
+
   CertVerifier* cert_verifier() { return cert_verifier_; }
   ProxyService* proxy_service() { return proxy_service_; }
   SSLConfigService* ssl_config_service() { return ssl_config_service_.get(); }
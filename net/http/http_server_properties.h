@@ -80,6 +80,7 @@ class NET_EXPORT HttpServerProperties {
     base::TimeDelta rtt;
     uint64 bandwidth_estimate;
   };
+  typedef std::map<HostPortPair, NetworkStats> ServerNetworkStatsMap;
 
   HttpServerProperties() {}
   virtual ~HttpServerProperties() {}
@@ -84,6 +84,18 @@ void HttpServerPropertiesImpl::InitializeSpdySettingsServers(
   spdy_settings_map_.swap(*spdy_settings_map);
 }
 
+void HttpServerPropertiesImpl::InitializeServerNetworkStats(
+    ServerNetworkStatsMap* server_network_stats_map) {
+  // First swap, and then add back the stats measured during this session,
+  // which override the persisted ones.
+  server_network_stats_map_.swap(*server_network_stats_map);
+  for (ServerNetworkStatsMap::const_iterator it =
+       server_network_stats_map->begin();
+       it != server_network_stats_map->end(); ++it) {
+    server_network_stats_map_[it->first] = it->second;
+  }
+}
+
 void HttpServerPropertiesImpl::InitializePipelineCapabilities(
     const PipelineCapabilityMap* pipeline_capability_map) {
   PipelineCapabilityMap::const_iterator it;
@@ -99,6 +111,11 @@ void HttpServerPropertiesImpl::SetNumPipelinedHostsToRemember(int max_size) {
   pipeline_capability_map_.reset(new CachedPipelineCapabilityMap(max_size));
 }
 
+const HttpServerProperties::ServerNetworkStatsMap&
+HttpServerPropertiesImpl::server_network_stats_map() const {
+  return server_network_stats_map_;
+}
+
 void HttpServerPropertiesImpl::GetSpdyServerList(
     base::ListValue* spdy_server_list) const {
   DCHECK(CalledOnValidThread());
@@ -149,6 +166,7 @@ void HttpServerPropertiesImpl::Clear() {
   spdy_servers_table_.clear();
   alternate_protocol_map_.clear();
   spdy_settings_map_.clear();
+  server_network_stats_map_.clear();
   pipeline_capability_map_->Clear();
 }
 
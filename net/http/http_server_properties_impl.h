@@ -44,6 +44,12 @@ class NET_EXPORT HttpServerPropertiesImpl
 
   void InitializeSpdySettingsServers(SpdySettingsMap* spdy_settings_map);
 
+  // Initializes |server_network_stats_map_| with the stats from
+  // |server_network_stats_map|. Stats measured since startup are kept, as they
+  // are fresher than the persisted ones.
+  void InitializeServerNetworkStats(
+      ServerNetworkStatsMap* server_network_stats_map);
+
   // Initializes |pipeline_capability_map_| with the servers (host/port) from
   // |pipeline_capability_map| that either support HTTP pipelining or not.
   void InitializePipelineCapabilities(
@@ -69,6 +75,9 @@ class NET_EXPORT HttpServerPropertiesImpl
   // can only be called if |pipeline_capability_map_| is empty.
   void SetNumPipelinedHostsToRemember(int max_size);
 
+  // Returns the measured network stats of all servers.
+  const ServerNetworkStatsMap& server_network_stats_map() const;
+
   // -----------------------------
   // HttpServerProperties methods:
   // -----------------------------
@@ -150,7 +159,6 @@ class NET_EXPORT HttpServerPropertiesImpl
   // |spdy_servers_table_| has flattened representation of servers (host/port
   // pair) that either support or not support SPDY protocol.
   typedef base::hash_map<std::string, bool> SpdyServerHostPortTable;
-  typedef std::map<HostPortPair, NetworkStats> ServerNetworkStatsMap;
   typedef std::map<HostPortPair, HostPortPair> CanonicalHostMap;
   typedef std::vector<std::string> CanonicalSufficList;
 
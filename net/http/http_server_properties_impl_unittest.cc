@@ -433,6 +433,40 @@ TEST_F(SpdySettingsServerPropertiesTest, Clear) {
   EXPECT_EQ(0U, impl_.GetSpdySettings(spdy_server_docs).size());
 }
 
+typedef HttpServerPropertiesImplTest ServerNetworkStatsServerPropertiesTest;
+
+TEST_F(ServerNetworkStatsServerPropertiesTest, Initialize) {
+  HostPortPair google_server("www.google.com", 443);
+  HostPortPair docs_server("docs.google.com", 443);
+
+  // Stats measured in this session override the persisted ones.
+  HttpServerProperties::NetworkStats stats1;
+  stats1.rtt = base::TimeDelta::FromMilliseconds(10);
+  stats1.bandwidth_estimate = 100;
+  impl_.SetServerNetworkStats(google_server, stats1);
+
+  HttpServerProperties::NetworkStats stats2;
+  stats2.rtt = base::TimeDelta::FromMilliseconds(20);
+  stats2.bandwidth_estimate = 200;
+  HttpServerProperties::ServerNetworkStatsMap server_network_stats_map;
+  server_network_stats_map[google_server] = stats2;
+  server_network_stats_map[docs_server] = stats2;
+  impl_.InitializeServerNetworkStats(&server_network_stats_map);
+
+  EXPECT_EQ(2U, impl_.server_network_stats_map().size());
+  const HttpServerProperties::NetworkStats* stats_ret =
+      impl_.GetServerNetworkStats(google_server);
+  ASSERT_TRUE(stats_ret != NULL);
+  EXPECT_EQ(10, stats_ret->rtt.InMilliseconds());
+  stats_ret = impl_.GetServerNetworkStats(docs_server);
+  ASSERT_TRUE(stats_ret != NULL);
+  EXPECT_EQ(20, stats_ret->rtt.InMilliseconds());
+  EXPECT_EQ(200U, stats_ret->bandwidth_estimate);
+
+  impl_.Clear();
+  EXPECT_TRUE(impl_.GetServerNetworkStats(google_server) == NULL);
+}
+
 }  // namespace
 
 }  // namespace net
@@ -0,0 +1,460 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_sender.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "base/logging.h"
+#include "base/rand_util.h"
+#include "net/quic/quic_clock.h"
+
+using std::max;
+using std::min;
+
+namespace net {
+
+namespace {
+const QuicByteCount kMaxSegmentSize = kMaxPacketSize;
+// Congestion windows, in packets.
+const QuicByteCount kInitialCongestionWindow = 10;
+const QuicByteCount kMinimumCongestionWindow = 4;
+// The gain used in STARTUP to double the sending rate every round trip,
+// 2/ln(2), and its inverse used to drain the resulting queue.
+const float kHighGain = 2.885f;
+const float kDrainGain = 1.f / kHighGain;
+// The PROBE_BW pacing gain cycle.  Each phase lasts about one min RTT.
+const float kPacingGain[] = { 1.25f, 0.75f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f };
+const int kGainCycleLength = arraysize(kPacingGain);
+// The congestion window gain outside of STARTUP and DRAIN, which leaves room
+// for delayed and aggregated acks.
+const float kCongestionWindowGain = 2.f;
+// The number of round trips the max bandwidth filter covers.
+const uint64 kBandwidthWindowSize = kGainCycleLength + 2;
+// STARTUP exits when the bandwidth has grown by less than 25% for three
+// round trips.
+const float kStartupGrowthTarget = 1.25f;
+const int kRoundTripsWithoutGrowthBeforeExitingStartup = 3;
+// The min RTT expires after 10 seconds, and PROBE_RTT lasts at least 200ms.
+const int kMinRttExpirySeconds = 10;
+const int kProbeRttTimeMs = 200;
+// Constants used for RTT calculation.
+const int kInitialRttMs = 100;  // At a typical RTT 100 ms.
+const float kAlpha = 0.125f;
+const float kOneMinusAlpha = (1 - kAlpha);
+const float kBeta = 0.25f;
+const float kOneMinusBeta = (1 - kBeta);
+}  // namespace
+
+BbrSender::SentPacketState::SentPacketState(
+    QuicTime sent_time,
+    QuicByteCount bytes,
+    QuicByteCount total_bytes_delivered,
+    QuicTime last_delivered_time,
+    QuicTime last_delivered_sent_time)
+    : sent_time(sent_time),
+      bytes(bytes),
+      total_bytes_delivered(total_bytes_delivered),
+      last_delivered_time(last_delivered_time),
+      last_delivered_sent_time(last_delivered_sent_time) {
+}
+
+BbrSender::BbrSender(const QuicClock* clock)
+    : clock_(clock),
+      mode_(STARTUP),
+      bytes_in_flight_(0),
+      total_bytes_delivered_(0),
+      last_delivered_time_(QuicTime::Zero()),
+      last_delivered_sent_time_(QuicTime::Zero()),
+      round_trip_count_(0),
+      next_round_trip_delivered_(0),
+      max_bandwidth_(kBandwidthWindowSize, QuicBandwidth::Zero(), 0),
+      min_rtt_(QuicTime::Delta::Zero()),
+      min_rtt_timestamp_(QuicTime::Zero()),
+      min_rtt_expired_(false),
+      smoothed_rtt_(QuicTime::Delta::Zero()),
+      mean_deviation_(QuicTime::Delta::Zero()),
+      pacing_gain_(kHighGain),
+      congestion_window_gain_(kHighGain),
+      pacing_rate_(QuicBandwidth::Zero()),
+      congestion_window_(kInitialCongestionWindow * kMaxSegmentSize),
+      initial_congestion_window_(kInitialCongestionWindow * kMaxSegmentSize),
+      next_send_time_(QuicTime::Zero()),
+      cycle_current_offset_(0),
+      last_cycle_start_(QuicTime::Zero()),
+      has_losses_(false),
+      is_at_full_bandwidth_(false),
+      bandwidth_at_last_round_(QuicBandwidth::Zero()),
+      rounds_without_bandwidth_gain_(0),
+      exit_probe_rtt_at_(QuicTime::Zero()),
+      probe_rtt_round_passed_(false) {
+  CalculatePacingRate();
+}
+
+BbrSender::~BbrSender() {
+}
+
+void BbrSender::SetFromConfig(const QuicConfig& config, bool is_server) {
+  if (is_server) {
+    // Set the initial window size.
+    initial_congestion_window_ =
+        config.server_initial_congestion_window() * kMaxSegmentSize;
+    congestion_window_ = initial_congestion_window_;
+    CalculatePacingRate();
+  }
+}
+
+void BbrSender::OnIncomingQuicCongestionFeedbackFrame(
+    const QuicCongestionFeedbackFrame& /*feedback*/,
+    QuicTime /*feedback_receive_time*/) {
+  // The model is built from acks alone.
+}
+
+void BbrSender::OnPacketAcked(QuicPacketSequenceNumber acked_sequence_number,
+                              QuicByteCount acked_bytes) {
+  SentPacketMap::iterator it = sent_packets_.find(acked_sequence_number);
+  if (it == sent_packets_.end()) {
+    // The packet was sent before an RTO, and is no longer in flight.
+    return;
+  }
+  const QuicTime now = clock_->ApproximateNow();
+  const QuicByteCount prior_in_flight = bytes_in_flight_;
+  DCHECK_GE(bytes_in_flight_, acked_bytes);
+  bytes_in_flight_ -= min(bytes_in_flight_, acked_bytes);
+  total_bytes_delivered_ += acked_bytes;
+
+  bool is_round_start = UpdateBandwidthAndRoundTrip(it->second, now);
+  sent_packets_.erase(it);
+
+  if (mode_ == PROBE_BW) {
+    UpdateGainCyclePhase(now, prior_in_flight);
+  }
+  has_losses_ = false;
+  if (is_round_start && !is_at_full_bandwidth_) {
+    CheckIfFullBandwidthReached();
+  }
+  MaybeExitStartupOrDrain(now);
+  MaybeEnterOrExitProbeRtt(now, is_round_start);
+
+  CalculatePacingRate();
+  CalculateCongestionWindow(acked_bytes);
+}
+
+void BbrSender::OnPacketLost(QuicPacketSequenceNumber sequence_number,
+                             QuicTime /*ack_receive_time*/) {
+  // Losses are not used as a congestion signal, but they end a PROBE_BW
+  // phase which is probing for more bandwidth.  The bytes are removed from
+  // flight by the following OnPacketAbandoned.
+  DVLOG(1) << "Incoming loss of packet " << sequence_number;
+  has_losses_ = true;
+}
+
+bool BbrSender::OnPacketSent(QuicTime sent_time,
+                             QuicPacketSequenceNumber sequence_number,
+                             QuicByteCount bytes,
+                             TransmissionType /*transmission_type*/,
+                             HasRetransmittableData is_retransmittable) {
+  // Only track data packets.
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    return false;
+  }
+
+  if (bytes_in_flight_ == 0) {
+    // Nothing is in flight, so the delivery rate of this packet is measured
+    // from when it is sent rather than the last ack, which may be long ago.
+    last_delivered_time_ = sent_time;
+    last_delivered_sent_time_ = sent_time;
+  }
+  sent_packets_.insert(std::make_pair(
+      sequence_number,
+      SentPacketState(sent_time, bytes, total_bytes_delivered_,
+                      last_delivered_time_, last_delivered_sent_time_)));
+  bytes_in_flight_ += bytes;
+
+  next_send_time_ = QuicTime::Max(next_send_time_, sent_time).Add(
+      pacing_rate_.TransferTime(bytes));
+  return true;
+}
+
+void BbrSender::OnRetransmissionTimeout(bool packets_retransmitted) {
+  sent_packets_.clear();
+  bytes_in_flight_ = 0;
+  if (packets_retransmitted) {
+    congestion_window_ = kMinimumCongestionWindow * kMaxSegmentSize;
+  }
+}
+
+void BbrSender::OnPacketAbandoned(QuicPacketSequenceNumber sequence_number,
+                                  QuicByteCount abandoned_bytes) {
+  if (sent_packets_.erase(sequence_number) == 0) {
+    return;
+  }
+  DCHECK_GE(bytes_in_flight_, abandoned_bytes);
+  bytes_in_flight_ -= min(bytes_in_flight_, abandoned_bytes);
+}
+
+QuicTime::Delta BbrSender::TimeUntilSend(
+    QuicTime now,
+    TransmissionType transmission_type,
+    HasRetransmittableData has_retransmittable_data,
+    IsHandshake handshake) {
+  if (transmission_type == TLP_RETRANSMISSION ||
+      has_retransmittable_data == NO_RETRANSMITTABLE_DATA ||
+      handshake == IS_HANDSHAKE) {
+    // Acks, handshake packets and tail loss probes are sent immediately, as
+    // they are by TcpCubicSender.
+    return QuicTime::Delta::Zero();
+  }
+  if (bytes_in_flight_ >= GetCongestionWindow()) {
+    return QuicTime::Delta::Infinite();
+  }
+  if (next_send_time_ > now) {
+    return next_send_time_.Subtract(now);
+  }
+  return QuicTime::Delta::Zero();
+}
+
+QuicBandwidth BbrSender::BandwidthEstimate() const {
+  return max_bandwidth_.GetBest();
+}
+
+void BbrSender::UpdateRtt(QuicTime::Delta rtt) {
+  if (rtt.IsInfinite() || rtt.IsZero()) {
+    DVLOG(1) << "Ignoring rtt, because it's "
+             << (rtt.IsZero() ? "Zero" : "Infinite");
+    return;
+  }
+  const QuicTime now = clock_->ApproximateNow();
+  bool expired = !min_rtt_.IsZero() &&
+      now > min_rtt_timestamp_.Add(
+          QuicTime::Delta::FromSeconds(kMinRttExpirySeconds));
+  if (min_rtt_.IsZero() || rtt <= min_rtt_ || expired) {
+    min_rtt_ = rtt;
+    min_rtt_timestamp_ = now;
+  }
+  if (expired) {
+    min_rtt_expired_ = true;
+  }
+
+  // First time call.
+  if (smoothed_rtt_.IsZero()) {
+    smoothed_rtt_ = rtt;
+    mean_deviation_ = QuicTime::Delta::FromMicroseconds(
+        rtt.ToMicroseconds() / 2);
+  } else {
+    mean_deviation_ = QuicTime::Delta::FromMicroseconds(
+        kOneMinusBeta * mean_deviation_.ToMicroseconds() +
+        kBeta *
+            std::abs(smoothed_rtt_.ToMicroseconds() - rtt.ToMicroseconds()));
+    smoothed_rtt_ = QuicTime::Delta::FromMicroseconds(
+        kOneMinusAlpha * smoothed_rtt_.ToMicroseconds() +
+        kAlpha * rtt.ToMicroseconds());
+  }
+}
+
+QuicTime::Delta BbrSender::SmoothedRtt() const {
+  if (smoothed_rtt_.IsZero()) {
+    return QuicTime::Delta::FromMilliseconds(kInitialRttMs);
+  }
+  return smoothed_rtt_;
+}
+
+QuicTime::Delta BbrSender::RetransmissionDelay() const {
+  return QuicTime::Delta::FromMicroseconds(
+      smoothed_rtt_.ToMicroseconds() + 4 * mean_deviation_.ToMicroseconds());
+}
+
+QuicByteCount BbrSender::GetCongestionWindow() const {
+  if (mode_ == PROBE_RTT) {
+    return kMinimumCongestionWindow * kMaxSegmentSize;
+  }
+  return congestion_window_;
+}
+
+QuicTime::Delta BbrSender::GetMinRtt() const {
+  if (min_rtt_.IsZero()) {
+    return QuicTime::Delta::FromMilliseconds(kInitialRttMs);
+  }
+  return min_rtt_;
+}
+
+QuicByteCount BbrSender::GetTargetCongestionWindow(float gain) const {
+  if (max_bandwidth_.GetBest().IsZero()) {
+    return gain * initial_congestion_window_;
+  }
+  QuicByteCount bdp = max_bandwidth_.GetBest().ToBytesPerPeriod(GetMinRtt());
+  return max<QuicByteCount>(gain * bdp,
+                            kMinimumCongestionWindow * kMaxSegmentSize);
+}
+
+bool BbrSender::UpdateBandwidthAndRoundTrip(const SentPacketState& packet,
+                                            QuicTime now) {
+  // The delivery rate is measured over the longer of the send and ack
+  // intervals, so that neither a burst of sends nor compressed acks inflate
+  // it above the bottleneck rate.
+  QuicTime::Delta send_interval =
+      packet.sent_time.Subtract(packet.last_delivered_sent_time);
+  QuicTime::Delta ack_interval = now.Subtract(packet.last_delivered_time);
+  QuicTime::Delta interval = QuicTime::Delta::Max(send_interval, ack_interval);
+  QuicByteCount delivered =
+      total_bytes_delivered_ - packet.total_bytes_delivered;
+
+  last_delivered_time_ = now;
+  last_delivered_sent_time_ = packet.sent_time;
+
+  bool is_round_start = false;
+  if (packet.total_bytes_delivered >= next_round_trip_delivered_) {
+    ++round_trip_count_;
+    next_round_trip_delivered_ = total_bytes_delivered_;
+    is_round_start = true;
+  }
+
+  // Intervals shorter than the min RTT can't be trusted, since all the acks
+  // of a round trip may have arrived in a burst.
+  if (!interval.IsZero() && !min_rtt_.IsZero() && interval >= min_rtt_) {
+    max_bandwidth_.Update(
+        QuicBandwidth::FromBytesAndTimeDelta(delivered, interval),
+        round_trip_count_);
+  }
+  return is_round_start;
+}
+
+void BbrSender::EnterStartupMode() {
+  mode_ = STARTUP;
+  pacing_gain_ = kHighGain;
+  congestion_window_gain_ = kHighGain;
+}
+
+void BbrSender::EnterProbeBandwidthMode(QuicTime now) {
+  mode_ = PROBE_BW;
+  congestion_window_gain_ = kCongestionWindowGain;
+  // Start in a random phase, other than the one draining the queue, so that
+  // competing flows don't probe in lockstep.
+  cycle_current_offset_ = base::RandInt(0, kGainCycleLength - 2);
+  if (cycle_current_offset_ >= 1) {
+    ++cycle_current_offset_;
+  }
+  last_cycle_start_ = now;
+  pacing_gain_ = kPacingGain[cycle_current_offset_];
+}
+
+void BbrSender::UpdateGainCyclePhase(QuicTime now,
+                                     QuicByteCount prior_in_flight) {
+  bool should_advance_gain_cycling =
+      now.Subtract(last_cycle_start_) > GetMinRtt();
+
+  // A phase probing for more bandwidth lasts until it has actually put the
+  // extra data in flight, unless losses indicate the bottleneck is full.
+  if (pacing_gain_ > 1.f && !has_losses_ &&
+      prior_in_flight < GetTargetCongestionWindow(pacing_gain_)) {
+    should_advance_gain_cycling = false;
+  }
+  // A phase draining the queue ends early once the queue is drained.
+  if (pacing_gain_ < 1.f &&
+      bytes_in_flight_ <= GetTargetCongestionWindow(1.f)) {
+    should_advance_gain_cycling = true;
+  }
+
+  if (should_advance_gain_cycling) {
+    cycle_current_offset_ = (cycle_current_offset_ + 1) % kGainCycleLength;
+    last_cycle_start_ = now;
+    pacing_gain_ = kPacingGain[cycle_current_offset_];
+  }
+}
+
+void BbrSender::CheckIfFullBandwidthReached() {
+  QuicBandwidth target = bandwidth_at_last_round_.Scale(kStartupGrowthTarget);
+  if (max_bandwidth_.GetBest() >= target) {
+    bandwidth_at_last_round_ = max_bandwidth_.GetBest();
+    rounds_without_bandwidth_gain_ = 0;
+    return;
+  }
+  ++rounds_without_bandwidth_gain_;
+  if (rounds_without_bandwidth_gain_ >=
+      kRoundTripsWithoutGrowthBeforeExitingStartup) {
+    is_at_full_bandwidth_ = true;
+  }
+}
+
+void BbrSender::MaybeExitStartupOrDrain(QuicTime now) {
+  if (mode_ == STARTUP && is_at_full_bandwidth_) {
+    DVLOG(1) << "Exiting STARTUP with bandwidth "
+             << max_bandwidth_.GetBest().ToKBitsPerSecond() << " kbps";
+    mode_ = DRAIN;
+    pacing_gain_ = kDrainGain;
+    congestion_window_gain_ = kHighGain;
+  }
+  if (mode_ == DRAIN && bytes_in_flight_ <= GetTargetCongestionWindow(1.f)) {
+    EnterProbeBandwidthMode(now);
+  }
+}
+
+void BbrSender::MaybeEnterOrExitProbeRtt(QuicTime now, bool is_round_start) {
+  if (min_rtt_expired_ && mode_ != PROBE_RTT) {
+    DVLOG(1) << "Min RTT expired, entering PROBE_RTT";
+    mode_ = PROBE_RTT;
+    pacing_gain_ = 1.f;
+    exit_probe_rtt_at_ = QuicTime::Zero();
+  }
+  min_rtt_expired_ = false;
+
+  if (mode_ != PROBE_RTT) {
+    return;
+  }
+  if (!exit_probe_rtt_at_.IsInitialized()) {
+    // Wait for the bytes in flight to drop to the minimum window before
+    // starting the PROBE_RTT timer, so the queue has drained.
+    if (bytes_in_flight_ <= kMinimumCongestionWindow * kMaxSegmentSize) {
+      exit_probe_rtt_at_ =
+          now.Add(QuicTime::Delta::FromMilliseconds(kProbeRttTimeMs));
+      probe_rtt_round_passed_ = false;
+    }
+    return;
+  }
+  if (is_round_start) {
+    probe_rtt_round_passed_ = true;
+  }
+  if (now >= exit_probe_rtt_at_ && probe_rtt_round_passed_) {
+    min_rtt_timestamp_ = now;
+    if (!is_at_full_bandwidth_) {
+      EnterStartupMode();
+    } else {
+      EnterProbeBandwidthMode(now);
+    }
+  }
+}
+
+void BbrSender::CalculatePacingRate() {
+  if (max_bandwidth_.GetBest().IsZero()) {
+    // Until there is a bandwidth sample, pace the initial window over the
+    // initial RTT, at the STARTUP gain.
+    pacing_rate_ = QuicBandwidth::FromBytesAndTimeDelta(
+        initial_congestion_window_, GetMinRtt()).Scale(pacing_gain_);
+    return;
+  }
+  QuicBandwidth target_rate = max_bandwidth_.GetBest().Scale(pacing_gain_);
+  if (mode_ == STARTUP && target_rate < pacing_rate_) {
+    // Don't slow down while still looking for the bottleneck bandwidth.
+    return;
+  }
+  pacing_rate_ = target_rate;
+}
+
+void BbrSender::CalculateCongestionWindow(QuicByteCount bytes_acked) {
+  QuicByteCount target_window =
+      GetTargetCongestionWindow(congestion_window_gain_);
+  if (is_at_full_bandwidth_) {
+    // Grow towards the target as packets are acked, and shrink to it at once.
+    congestion_window_ = min(target_window, congestion_window_ + bytes_acked);
+  } else if (congestion_window_ < target_window ||
+             total_bytes_delivered_ < initial_congestion_window_) {
+    // Whilst looking for the bottleneck bandwidth, never shrink the window.
+    congestion_window_ += bytes_acked;
+  }
+  congestion_window_ = max(congestion_window_,
+                           kMinimumCongestionWindow * kMaxSegmentSize);
+}
+
+}  // namespace net
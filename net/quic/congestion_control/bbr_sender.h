@@ -0,0 +1,191 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// BBR (Bottleneck Bandwidth and RTT) send side congestion algorithm.  Rather
+// than reacting to loss, it builds an explicit model of the path from the
+// delivery rate and round trip time of acked packets, paces at the estimated
+// bottleneck bandwidth and keeps roughly one bandwidth-delay product in
+// flight.
+
+#ifndef NET_QUIC_CONGESTION_CONTROL_BBR_SENDER_H_
+#define NET_QUIC_CONGESTION_CONTROL_BBR_SENDER_H_
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "net/base/net_export.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/congestion_control/windowed_filter.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+class QuicClock;
+
+class NET_EXPORT_PRIVATE BbrSender : public SendAlgorithmInterface {
+ public:
+  enum Mode {
+    // Exponential growth of the pacing rate until the bandwidth stops
+    // increasing.
+    STARTUP,
+    // Drains the queue built during startup.
+    DRAIN,
+    // Cycles the pacing gain around 1 to probe for more bandwidth.
+    PROBE_BW,
+    // Briefly reduces the congestion window to measure a new min RTT.
+    PROBE_RTT,
+  };
+
+  explicit BbrSender(const QuicClock* clock);
+  virtual ~BbrSender();
+
+  // Start implementation of SendAlgorithmInterface.
+  virtual void SetFromConfig(const QuicConfig& config, bool is_server) OVERRIDE;
+  virtual void OnIncomingQuicCongestionFeedbackFrame(
+      const QuicCongestionFeedbackFrame& feedback,
+      QuicTime feedback_receive_time) OVERRIDE;
+  virtual void OnPacketAcked(QuicPacketSequenceNumber acked_sequence_number,
+                             QuicByteCount acked_bytes) OVERRIDE;
+  virtual void OnPacketLost(QuicPacketSequenceNumber sequence_number,
+                            QuicTime ack_receive_time) OVERRIDE;
+  virtual bool OnPacketSent(QuicTime sent_time,
+                            QuicPacketSequenceNumber sequence_number,
+                            QuicByteCount bytes,
+                            TransmissionType transmission_type,
+                            HasRetransmittableData is_retransmittable) OVERRIDE;
+  virtual void OnRetransmissionTimeout(bool packets_retransmitted) OVERRIDE;
+  virtual void OnPacketAbandoned(QuicPacketSequenceNumber sequence_number,
+                                 QuicByteCount abandoned_bytes) OVERRIDE;
+  virtual QuicTime::Delta TimeUntilSend(
+      QuicTime now,
+      TransmissionType transmission_type,
+      HasRetransmittableData has_retransmittable_data,
+      IsHandshake handshake) OVERRIDE;
+  virtual QuicBandwidth BandwidthEstimate() const OVERRIDE;
+  virtual void UpdateRtt(QuicTime::Delta rtt_sample) OVERRIDE;
+  virtual QuicTime::Delta SmoothedRtt() const OVERRIDE;
+  virtual QuicTime::Delta RetransmissionDelay() const OVERRIDE;
+  virtual QuicByteCount GetCongestionWindow() const OVERRIDE;
+  // End implementation of SendAlgorithmInterface.
+
+  Mode mode() const { return mode_; }
+
+  // Returns the min RTT seen within the last min RTT expiry period, or zero
+  // if no RTT has been measured yet.
+  QuicTime::Delta min_rtt() const { return min_rtt_; }
+
+  QuicBandwidth pacing_rate() const { return pacing_rate_; }
+
+ private:
+  typedef WindowedFilter<QuicBandwidth, MaxFilter<QuicBandwidth> >
+      MaxBandwidthFilter;
+
+  // The state of the connection when a packet was sent, from which the
+  // delivery rate is computed when it is acked.
+  struct SentPacketState {
+    SentPacketState(QuicTime sent_time,
+                    QuicByteCount bytes,
+                    QuicByteCount total_bytes_delivered,
+                    QuicTime last_delivered_time,
+                    QuicTime last_delivered_sent_time);
+
+    QuicTime sent_time;
+    QuicByteCount bytes;
+    // The total bytes delivered when the packet was sent.
+    QuicByteCount total_bytes_delivered;
+    // The time the most recently delivered packet was acked, and the time it
+    // was sent, when this packet was sent.
+    QuicTime last_delivered_time;
+    QuicTime last_delivered_sent_time;
+  };
+  typedef std::map<QuicPacketSequenceNumber, SentPacketState> SentPacketMap;
+
+  // Returns the min RTT, or the initial RTT if none has been measured.
+  QuicTime::Delta GetMinRtt() const;
+
+  // Returns |gain| times the estimated bandwidth-delay product.
+  QuicByteCount GetTargetCongestionWindow(float gain) const;
+
+  // Records the delivery rate of the acked packet in the bandwidth filter,
+  // and returns true if it starts a new round trip.
+  bool UpdateBandwidthAndRoundTrip(const SentPacketState& packet, QuicTime now);
+
+  void EnterStartupMode();
+  void EnterProbeBandwidthMode(QuicTime now);
+  void UpdateGainCyclePhase(QuicTime now, QuicByteCount prior_in_flight);
+  void CheckIfFullBandwidthReached();
+  void MaybeExitStartupOrDrain(QuicTime now);
+  void MaybeEnterOrExitProbeRtt(QuicTime now, bool is_round_start);
+  void CalculatePacingRate();
+  void CalculateCongestionWindow(QuicByteCount bytes_acked);
+
+  const QuicClock* clock_;
+
+  Mode mode_;
+
+  SentPacketMap sent_packets_;
+
+  // Bytes in flight, aka bytes on the wire.
+  QuicByteCount bytes_in_flight_;
+
+  // The total number of bytes acked, and the time and sent time of the most
+  // recently acked packet.
+  QuicByteCount total_bytes_delivered_;
+  QuicTime last_delivered_time_;
+  QuicTime last_delivered_sent_time_;
+
+  // A round trip ends when a packet sent after the previous round ended is
+  // acked, which is known by total_bytes_delivered_ at its send time.
+  uint64 round_trip_count_;
+  QuicByteCount next_round_trip_delivered_;
+
+  // The max delivery rate over the last few round trips.
+  MaxBandwidthFilter max_bandwidth_;
+
+  // The min RTT, and when it was last measured.
+  QuicTime::Delta min_rtt_;
+  QuicTime min_rtt_timestamp_;
+  // Set when min_rtt_ expires, which triggers PROBE_RTT.
+  bool min_rtt_expired_;
+
+  // Smoothed RTT and mean deviation, used for the retransmission delay.
+  QuicTime::Delta smoothed_rtt_;
+  QuicTime::Delta mean_deviation_;
+
+  float pacing_gain_;
+  float congestion_window_gain_;
+  QuicBandwidth pacing_rate_;
+  QuicByteCount congestion_window_;
+  QuicByteCount initial_congestion_window_;
+
+  // The earliest time the pacing rate allows the next packet to be sent.
+  QuicTime next_send_time_;
+
+  // The current phase of the PROBE_BW gain cycle, and when it started.
+  int cycle_current_offset_;
+  QuicTime last_cycle_start_;
+
+  // Set on loss, and cleared once the gain cycle has taken it into account.
+  bool has_losses_;
+
+  // Used to detect the end of STARTUP, when the bandwidth has not grown
+  // significantly for a few round trips.
+  bool is_at_full_bandwidth_;
+  QuicBandwidth bandwidth_at_last_round_;
+  int rounds_without_bandwidth_gain_;
+
+  // The time PROBE_RTT may exit, once the bytes in flight have dropped to
+  // the minimum window, and whether a round trip has passed since.
+  QuicTime exit_probe_rtt_at_;
+  bool probe_rtt_round_passed_;
+
+  DISALLOW_COPY_AND_ASSIGN(BbrSender);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CONGESTION_CONTROL_BBR_SENDER_H_
@@ -0,0 +1,211 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_sender.h"
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/quic/congestion_control/tcp_cubic_sender.h"
+#include "net/quic/test_tools/mock_clock.h"
+#include "net/quic/test_tools/send_algorithm_simulator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+const QuicByteCount kDefaultWindow = 10 * kMaxPacketSize;
+
+class BbrSenderTest : public ::testing::Test {
+ protected:
+  BbrSenderTest()
+      : sender_(new BbrSender(&clock_)),
+        sequence_number_(1) {
+    // Start the clock at a non-zero time, as a real clock would.
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+  }
+
+  // Sends packets as long as TimeUntilSend returns zero, and returns how many
+  // were sent.
+  int SendAvailable() {
+    int packets_sent = 0;
+    while (sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                  HAS_RETRANSMITTABLE_DATA,
+                                  NOT_HANDSHAKE).IsZero()) {
+      sender_->OnPacketSent(clock_.Now(), sequence_number_++, kMaxPacketSize,
+                            NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA);
+      ++packets_sent;
+    }
+    return packets_sent;
+  }
+
+  MockClock clock_;
+  scoped_ptr<BbrSender> sender_;
+  QuicPacketSequenceNumber sequence_number_;
+};
+
+TEST_F(BbrSenderTest, InitialState) {
+  EXPECT_EQ(BbrSender::STARTUP, sender_->mode());
+  EXPECT_EQ(kDefaultWindow, sender_->GetCongestionWindow());
+  EXPECT_TRUE(sender_->BandwidthEstimate().IsZero());
+  EXPECT_FALSE(sender_->pacing_rate().IsZero());
+  EXPECT_EQ(100, sender_->SmoothedRtt().ToMilliseconds());
+}
+
+TEST_F(BbrSenderTest, PacesInitialWindow) {
+  // The first packet goes out immediately, and the next is paced.
+  EXPECT_EQ(1, SendAvailable());
+  QuicTime::Delta delay = sender_->TimeUntilSend(
+      clock_.Now(), NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA,
+      NOT_HANDSHAKE);
+  EXPECT_FALSE(delay.IsZero());
+  EXPECT_FALSE(delay.IsInfinite());
+  EXPECT_EQ(sender_->pacing_rate().TransferTime(kMaxPacketSize), delay);
+
+  // Acks, handshake packets and tail loss probes are never delayed.
+  EXPECT_TRUE(sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                     NO_RETRANSMITTABLE_DATA,
+                                     NOT_HANDSHAKE).IsZero());
+  EXPECT_TRUE(sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                     HAS_RETRANSMITTABLE_DATA,
+                                     IS_HANDSHAKE).IsZero());
+  EXPECT_TRUE(sender_->TimeUntilSend(clock_.Now(), TLP_RETRANSMISSION,
+                                     HAS_RETRANSMITTABLE_DATA,
+                                     NOT_HANDSHAKE).IsZero());
+}
+
+TEST_F(BbrSenderTest, CongestionWindowLimitsBytesInFlight) {
+  int packets_sent = 0;
+  while (sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                HAS_RETRANSMITTABLE_DATA,
+                                NOT_HANDSHAKE).IsZero() ||
+         !sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                 HAS_RETRANSMITTABLE_DATA,
+                                 NOT_HANDSHAKE).IsInfinite()) {
+    clock_.AdvanceTime(sender_->TimeUntilSend(
+        clock_.Now(), NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA,
+        NOT_HANDSHAKE));
+    packets_sent += SendAvailable();
+  }
+  EXPECT_EQ(10, packets_sent);
+
+  // Abandoning a packet opens the window again.
+  sender_->OnPacketAbandoned(1, kMaxPacketSize);
+  EXPECT_FALSE(sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                      HAS_RETRANSMITTABLE_DATA,
+                                      NOT_HANDSHAKE).IsInfinite());
+}
+
+TEST_F(BbrSenderTest, RetransmissionTimeoutClearsBytesInFlight) {
+  for (int i = 0; i < 10; ++i) {
+    sender_->OnPacketSent(clock_.Now(), sequence_number_++, kMaxPacketSize,
+                          NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA);
+  }
+  EXPECT_TRUE(sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                     HAS_RETRANSMITTABLE_DATA,
+                                     NOT_HANDSHAKE).IsInfinite());
+  sender_->OnRetransmissionTimeout(true);
+  EXPECT_EQ(4 * kMaxPacketSize, sender_->GetCongestionWindow());
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  EXPECT_TRUE(sender_->TimeUntilSend(clock_.Now(), NOT_RETRANSMISSION,
+                                     HAS_RETRANSMITTABLE_DATA,
+                                     NOT_HANDSHAKE).IsZero());
+  // Acks of packets sent before the timeout are ignored.
+  sender_->OnPacketAcked(1, kMaxPacketSize);
+  EXPECT_TRUE(sender_->BandwidthEstimate().IsZero());
+}
+
+TEST_F(BbrSenderTest, UpdateRtt) {
+  sender_->UpdateRtt(QuicTime::Delta::FromMilliseconds(60));
+  EXPECT_EQ(60, sender_->min_rtt().ToMilliseconds());
+  EXPECT_EQ(60, sender_->SmoothedRtt().ToMilliseconds());
+  EXPECT_EQ(180, sender_->RetransmissionDelay().ToMilliseconds());
+
+  sender_->UpdateRtt(QuicTime::Delta::FromMilliseconds(80));
+  EXPECT_EQ(60, sender_->min_rtt().ToMilliseconds());
+  sender_->UpdateRtt(QuicTime::Delta::FromMilliseconds(50));
+  EXPECT_EQ(50, sender_->min_rtt().ToMilliseconds());
+
+  // Once the min RTT is older than 10 seconds, it is replaced by the next
+  // sample, however large.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(11));
+  sender_->UpdateRtt(QuicTime::Delta::FromMilliseconds(70));
+  EXPECT_EQ(70, sender_->min_rtt().ToMilliseconds());
+}
+
+TEST_F(BbrSenderTest, SimulatedTransferFindsBottleneckBandwidth) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+  SendAlgorithmSimulator simulator(sender_.get(), &clock_, kBandwidth, kRtt);
+
+  // 10 MB is about 80 round trips at the bottleneck bandwidth.
+  QuicTime start = clock_.Now();
+  simulator.TransferBytes(10 * 1000 * 1000);
+  QuicTime::Delta elapsed = clock_.Now().Subtract(start);
+
+  EXPECT_EQ(BbrSender::PROBE_BW, sender_->mode());
+  EXPECT_LE(kBandwidth.Scale(0.9f), sender_->BandwidthEstimate());
+  EXPECT_GE(kBandwidth.Scale(1.1f), sender_->BandwidthEstimate());
+  EXPECT_GE(kRtt.Add(QuicTime::Delta::FromMilliseconds(5)),
+            sender_->min_rtt());
+  EXPECT_LE(kBandwidth.Scale(0.8f),
+            QuicBandwidth::FromBytesAndTimeDelta(simulator.bytes_acked(),
+                                                 elapsed));
+}
+
+TEST_F(BbrSenderTest, SimulatedTransferKeepsQueueShort) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+  SendAlgorithmSimulator simulator(sender_.get(), &clock_, kBandwidth, kRtt);
+  // Use a deep buffer, which a loss based sender would fill.
+  simulator.set_buffer_size(4 * kBandwidth.ToBytesPerPeriod(kRtt));
+
+  simulator.TransferBytes(10 * 1000 * 1000);
+
+  // STARTUP overshoots, queueing up to about two bandwidth-delay products,
+  // but the queue never fills the buffer, and nothing is lost.
+  EXPECT_EQ(0u, simulator.packets_lost());
+  EXPECT_GE(kRtt.Multiply(4), simulator.max_rtt());
+}
+
+TEST_F(BbrSenderTest, SimulatedTransferWithRandomLoss) {
+  const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+  const QuicByteCount kTransferSize = 10 * 1000 * 1000;
+  const float kLossRate = 0.01f;
+
+  SendAlgorithmSimulator bbr_simulator(sender_.get(), &clock_, kBandwidth,
+                                       kRtt);
+  bbr_simulator.set_loss_rate(kLossRate);
+  QuicTime start = clock_.Now();
+  bbr_simulator.TransferBytes(kTransferSize);
+  QuicBandwidth bbr_throughput = QuicBandwidth::FromBytesAndTimeDelta(
+      bbr_simulator.bytes_acked(), clock_.Now().Subtract(start));
+  EXPECT_LT(0u, bbr_simulator.packets_lost());
+
+  // Random loss doesn't bring down the bandwidth estimate, so BBR keeps most
+  // of the link busy.
+  EXPECT_LE(kBandwidth.Scale(0.7f), bbr_throughput);
+
+  // Cubic halves its window on every loss, and does much worse.
+  MockClock cubic_clock;
+  cubic_clock.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+  TcpCubicSender cubic_sender(&cubic_clock, false, kMaxTcpCongestionWindow);
+  QuicCongestionFeedbackFrame feedback;
+  feedback.type = kTCP;
+  feedback.tcp.receive_window = 10 * kBandwidth.ToBytesPerPeriod(kRtt);
+  cubic_sender.OnIncomingQuicCongestionFeedbackFrame(feedback,
+                                                     cubic_clock.Now());
+  SendAlgorithmSimulator cubic_simulator(&cubic_sender, &cubic_clock,
+                                         kBandwidth, kRtt);
+  cubic_simulator.set_loss_rate(kLossRate);
+  start = cubic_clock.Now();
+  cubic_simulator.TransferBytes(kTransferSize);
+  QuicBandwidth cubic_throughput = QuicBandwidth::FromBytesAndTimeDelta(
+      cubic_simulator.bytes_acked(), cubic_clock.Now().Subtract(start));
+
+  EXPECT_LT(cubic_throughput.Scale(2), bbr_throughput);
+}
+
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,46 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// The pure virtual class for send side loss detection algorithm.
+
+#ifndef NET_QUIC_CONGESTION_CONTROL_LOSS_DETECTION_INTERFACE_H_
+#define NET_QUIC_CONGESTION_CONTROL_LOSS_DETECTION_INTERFACE_H_
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+class QuicUnackedPacketMap;
+
+class NET_EXPORT_PRIVATE LossDetectionInterface {
+ public:
+  // Creates the loss detector for |loss_type|.
+  static LossDetectionInterface* Create(LossDetectionType loss_type);
+
+  virtual ~LossDetectionInterface() {}
+
+  virtual LossDetectionType GetLossDetectionType() const = 0;
+
+  // Called when a new ack arrives or the loss alarm fires.  Only the pending
+  // packets up to |largest_observed| are examined, and those which are lost
+  // are returned.  |srtt| is the smoothed RTT, and |latest_rtt| the RTT of
+  // the most recent ack, which is infinite until one has been measured.
+  virtual SequenceNumberSet DetectLostPackets(
+      const QuicUnackedPacketMap& unacked_packets,
+      const QuicTime& time,
+      QuicPacketSequenceNumber largest_observed,
+      QuicTime::Delta srtt,
+      QuicTime::Delta latest_rtt) = 0;
+
+  // Get the time the LossDetectionAlgorithm wants to re-evaluate losses.
+  // Returns QuicTime::Zero if no alarm needs to be set.
+  virtual QuicTime GetLossTimeout() const = 0;
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CONGESTION_CONTROL_LOSS_DETECTION_INTERFACE_H_
@@ -0,0 +1,93 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/windowed_filter.h"
+
+#include "net/quic/quic_bandwidth.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+class WindowedFilterTest : public ::testing::Test {
+ protected:
+  // Set the window to 10 rounds, with samples measured in round trips.
+  WindowedFilterTest()
+      : min_filter_(10, 0, 0),
+        max_filter_(10, QuicBandwidth::Zero(), 0) {
+  }
+
+  // Sets up the min filter with samples of 10, 20, 30 and 40, increasing by
+  // 10 every 2 rounds, ending at round 8.
+  void InitializeMinFilter() {
+    uint64 round = 0;
+    for (int i = 1; i <= 4; ++i) {
+      round += 2;
+      min_filter_.Update(10 * i, round);
+    }
+    // The first sample is the best, and the second best is the first sample
+    // taken after a quarter of the window.
+    EXPECT_EQ(10, min_filter_.GetBest());
+    EXPECT_EQ(30, min_filter_.GetSecondBest());
+    EXPECT_EQ(30, min_filter_.GetThirdBest());
+  }
+
+  WindowedFilter<int, MinFilter<int> > min_filter_;
+  WindowedFilter<QuicBandwidth, MaxFilter<QuicBandwidth> > max_filter_;
+};
+
+TEST_F(WindowedFilterTest, FirstSampleIsBest) {
+  min_filter_.Update(50, 1);
+  EXPECT_EQ(50, min_filter_.GetBest());
+  EXPECT_EQ(50, min_filter_.GetSecondBest());
+  EXPECT_EQ(50, min_filter_.GetThirdBest());
+}
+
+TEST_F(WindowedFilterTest, NewBestResetsAllEstimates) {
+  InitializeMinFilter();
+  min_filter_.Update(5, 7);
+  EXPECT_EQ(5, min_filter_.GetBest());
+  EXPECT_EQ(5, min_filter_.GetSecondBest());
+  EXPECT_EQ(5, min_filter_.GetThirdBest());
+}
+
+TEST_F(WindowedFilterTest, BestExpires) {
+  InitializeMinFilter();
+  // The best, from round 2, expires once the window of 10 rounds passes,
+  // and the second best takes its place.
+  min_filter_.Update(50, 13);
+  EXPECT_EQ(30, min_filter_.GetBest());
+  min_filter_.Update(60, 17);
+  EXPECT_EQ(50, min_filter_.GetBest());
+}
+
+TEST_F(WindowedFilterTest, AllEstimatesExpire) {
+  InitializeMinFilter();
+  // A sample after every estimate is outside the window replaces them all.
+  min_filter_.Update(100, 30);
+  EXPECT_EQ(100, min_filter_.GetBest());
+  EXPECT_EQ(100, min_filter_.GetSecondBest());
+  EXPECT_EQ(100, min_filter_.GetThirdBest());
+}
+
+TEST_F(WindowedFilterTest, MaxBandwidth) {
+  QuicBandwidth low = QuicBandwidth::FromKBitsPerSecond(500);
+  QuicBandwidth high = QuicBandwidth::FromKBitsPerSecond(1000);
+  max_filter_.Update(low, 1);
+  EXPECT_EQ(low, max_filter_.GetBest());
+  max_filter_.Update(high, 2);
+  EXPECT_EQ(high, max_filter_.GetBest());
+
+  // Lower samples don't replace the max while it is within the window.
+  for (uint64 round = 3; round <= 12; ++round) {
+    max_filter_.Update(low, round);
+    EXPECT_EQ(high, max_filter_.GetBest());
+  }
+  // Once the max is older than the window, the lower samples take over.
+  max_filter_.Update(low, 13);
+  EXPECT_EQ(low, max_filter_.GetBest());
+}
+
+}  // namespace test
+}  // namespace net
@@ -4,6 +4,9 @@
 
 #include "net/quic/crypto/quic_encrypter.h"
 
+#include <string.h>
+
+#include "base/memory/scoped_ptr.h"
 #include "net/quic/crypto/aes_128_gcm_12_encrypter.h"
 #include "net/quic/crypto/null_encrypter.h"
 
@@ -22,4 +25,18 @@ QuicEncrypter* QuicEncrypter::Create(QuicTag algorithm) {
   }
 }
 
+bool QuicEncrypter::EncryptPacketInto(QuicPacketSequenceNumber sequence_number,
+                                      base::StringPiece associated_data,
+                                      base::StringPiece plaintext,
+                                      char* output) {
+  scoped_ptr<QuicData> ciphertext(
+      EncryptPacket(sequence_number, associated_data, plaintext));
+  if (ciphertext.get() == NULL) {
+    return false;
+  }
+  DCHECK_EQ(GetCiphertextSize(plaintext.size()), ciphertext->length());
+  memcpy(output, ciphertext->data(), ciphertext->length());
+  return true;
+}
+
 }  // namespace net
@@ -0,0 +1,270 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/quic_server_info_store.h"
+
+#include <limits>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string_piece.h"
+#include "base/task_runner_util.h"
+#include "net/base/completion_callback.h"
+#include "net/base/net_errors.h"
+#include "net/quic/crypto/cert_compressor.h"
+#include "net/quic/crypto/common_cert_set.h"
+
+using base::StringPiece;
+using std::string;
+using std::vector;
+
+namespace net {
+
+namespace {
+
+const int kQuicServerInfoStoreVersion = 1;
+
+string LoadFile(const base::FilePath& path) {
+  string result;
+  if (!base::ReadFileToString(path, &result)) {
+    return string();
+  }
+  return result;
+}
+
+}  // namespace
+
+// A QuicServerInfo which reads from and persists to a QuicServerInfoStore.
+// It may outlive the store, in which case it is never ready and Persist does
+// nothing.
+class QuicServerInfoStore::StoreBackedQuicServerInfo : public QuicServerInfo {
+ public:
+  StoreBackedQuicServerInfo(const string& hostname,
+                            const base::WeakPtr<QuicServerInfoStore>& store)
+      : QuicServerInfo(hostname),
+        hostname_(hostname),
+        store_(store),
+        ready_(false),
+        weak_factory_(this) {
+  }
+
+  virtual ~StoreBackedQuicServerInfo() {}
+
+  // QuicServerInfo implementation.
+  virtual void Start() OVERRIDE {
+    if (store_.get()) {
+      store_->RunWhenLoaded(
+          base::Bind(&StoreBackedQuicServerInfo::OnStoreLoaded,
+                     weak_factory_.GetWeakPtr()));
+    }
+  }
+
+  virtual int WaitForDataReady(const CompletionCallback& callback) OVERRIDE {
+    if (ready_) {
+      return OK;
+    }
+    if (!callback.is_null()) {
+      user_callback_ = callback;
+    }
+    return ERR_IO_PENDING;
+  }
+
+  virtual bool IsDataReady() OVERRIDE {
+    return ready_;
+  }
+
+  virtual void Persist() OVERRIDE {
+    DCHECK(ready_);
+    if (store_.get()) {
+      store_->Update(hostname_, state());
+    }
+  }
+
+ private:
+  void OnStoreLoaded() {
+    DCHECK(!ready_);
+    if (!store_->Lookup(hostname_, mutable_state())) {
+      mutable_state()->Clear();
+    }
+    ready_ = true;
+    if (!user_callback_.is_null()) {
+      CompletionCallback callback = user_callback_;
+      user_callback_.Reset();
+      callback.Run(OK);
+    }
+  }
+
+  const string hostname_;
+  base::WeakPtr<QuicServerInfoStore> store_;
+  bool ready_;
+  CompletionCallback user_callback_;
+  base::WeakPtrFactory<StoreBackedQuicServerInfo> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreBackedQuicServerInfo);
+};
+
+QuicServerInfoStore::Entry::Entry() {}
+
+QuicServerInfoStore::Entry::~Entry() {}
+
+QuicServerInfoStore::QuicServerInfoStore(
+    const base::FilePath& path,
+    base::SequencedTaskRunner* file_task_runner)
+    : loaded_(false),
+      writer_(path, file_task_runner),
+      weak_factory_(this) {
+  base::PostTaskAndReplyWithResult(
+      file_task_runner,
+      FROM_HERE,
+      base::Bind(&LoadFile, path),
+      base::Bind(&QuicServerInfoStore::OnLoadComplete,
+                 weak_factory_.GetWeakPtr()));
+}
+
+QuicServerInfoStore::~QuicServerInfoStore() {
+  DCHECK(CalledOnValidThread());
+  if (writer_.HasPendingWrite()) {
+    writer_.DoScheduledWrite();
+  }
+}
+
+QuicServerInfo* QuicServerInfoStore::GetForHost(const string& hostname) {
+  DCHECK(CalledOnValidThread());
+  return new StoreBackedQuicServerInfo(hostname, weak_factory_.GetWeakPtr());
+}
+
+bool QuicServerInfoStore::SerializeData(string* data) {
+  DCHECK(CalledOnValidThread());
+  Pickle p(sizeof(Pickle::Header));
+  if (!p.WriteInt(kQuicServerInfoStoreVersion) ||
+      entries_.size() > std::numeric_limits<uint32>::max() ||
+      !p.WriteUInt32(entries_.size())) {
+    return false;
+  }
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    const Entry& entry = it->second;
+    if (!p.WriteString(it->first) ||
+        !p.WriteString(entry.server_config) ||
+        !p.WriteString(entry.source_address_token) ||
+        !p.WriteString(entry.server_config_sig) ||
+        !p.WriteString(entry.compressed_certs)) {
+      return false;
+    }
+  }
+  data->assign(reinterpret_cast<const char*>(p.data()), p.size());
+  return true;
+}
+
+bool QuicServerInfoStore::LoadEntries(const string& data) {
+  entries_.clear();
+  if (data.empty()) {
+    return false;
+  }
+
+  Pickle p(data.data(), data.size());
+  PickleIterator iter(p);
+  int version = -1;
+  if (!p.ReadInt(&iter, &version) || version != kQuicServerInfoStoreVersion) {
+    DVLOG(1) << "Missing or unsupported version";
+    return false;
+  }
+  uint32 num_entries;
+  if (!p.ReadUInt32(&iter, &num_entries)) {
+    DVLOG(1) << "Malformed num_entries";
+    return false;
+  }
+  for (uint32 i = 0; i < num_entries; ++i) {
+    string hostname;
+    Entry entry;
+    if (!p.ReadString(&iter, &hostname) ||
+        !p.ReadString(&iter, &entry.server_config) ||
+        !p.ReadString(&iter, &entry.source_address_token) ||
+        !p.ReadString(&iter, &entry.server_config_sig) ||
+        !p.ReadString(&iter, &entry.compressed_certs)) {
+      DVLOG(1) << "Malformed entry";
+      entries_.clear();
+      return false;
+    }
+    entries_[hostname] = entry;
+  }
+  return true;
+}
+
+bool QuicServerInfoStore::Lookup(const string& hostname,
+                                 QuicServerInfo::State* state) const {
+  DCHECK(CalledOnValidThread());
+  EntryMap::const_iterator it = entries_.find(hostname);
+  if (it == entries_.end()) {
+    return false;
+  }
+  const Entry& entry = it->second;
+  state->Clear();
+  if (!entry.compressed_certs.empty() &&
+      !CertCompressor::DecompressChain(entry.compressed_certs,
+                                       vector<string>(),
+                                       CommonCertSets::GetInstanceQUIC(),
+                                       &state->certs)) {
+    DVLOG(1) << "Failed to decompress certs for " << hostname;
+    state->Clear();
+    return false;
+  }
+  state->server_config = entry.server_config;
+  state->source_address_token = entry.source_address_token;
+  state->server_config_sig = entry.server_config_sig;
+  return true;
+}
+
+void QuicServerInfoStore::Update(const string& hostname,
+                                 const QuicServerInfo::State& state) {
+  DCHECK(CalledOnValidThread());
+  Entry& entry = entries_[hostname];
+  entry.server_config = state.server_config;
+  entry.source_address_token = state.source_address_token;
+  entry.server_config_sig = state.server_config_sig;
+  entry.compressed_certs.clear();
+  if (!state.certs.empty()) {
+    // Compress against the common certificate sets only, since there are no
+    // cached certificates to refer to when the chain is read back.
+    const CommonCertSets* common_sets = CommonCertSets::GetInstanceQUIC();
+    entry.compressed_certs = CertCompressor::CompressChain(
+        state.certs, common_sets->GetCommonHashes(), StringPiece(),
+        common_sets);
+  }
+  writer_.ScheduleWrite(this);
+}
+
+void QuicServerInfoStore::RunWhenLoaded(const base::Closure& callback) {
+  DCHECK(CalledOnValidThread());
+  if (loaded_) {
+    callback.Run();
+    return;
+  }
+  load_callbacks_.push_back(callback);
+}
+
+void QuicServerInfoStore::OnLoadComplete(const string& data) {
+  DCHECK(CalledOnValidThread());
+  // Servers persisted before the load completed are newer than the file.
+  EntryMap updated_entries;
+  updated_entries.swap(entries_);
+  LoadEntries(data);
+  for (EntryMap::const_iterator it = updated_entries.begin();
+       it != updated_entries.end(); ++it) {
+    entries_[it->first] = it->second;
+  }
+  loaded_ = true;
+
+  vector<base::Closure> callbacks;
+  callbacks.swap(load_callbacks_);
+  for (size_t i = 0; i < callbacks.size(); ++i) {
+    callbacks[i].Run();
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,104 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CRYPTO_QUIC_SERVER_INFO_STORE_H_
+#define NET_QUIC_CRYPTO_QUIC_SERVER_INFO_STORE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/compiler_specific.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/non_thread_safe.h"
+#include "net/base/net_export.h"
+#include "net/quic/crypto/quic_server_info.h"
+
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
+namespace net {
+
+// QuicServerInfoStore keeps the crypto config of every QUIC server in a
+// single compact file, so that it can be loaded as soon as the network stack
+// starts and shared by every QuicStreamFactory, rather than being looked up
+// entry by entry in the HTTP cache of one profile.  Certificate chains are
+// stored compressed with CertCompressor.
+//
+// The file is read on |file_task_runner| when the store is created, and
+// rewritten there a short while after any server's state is persisted.
+// QuicServerInfo objects handed out before the load completes wait for it.
+// The store must be created, used and destroyed on a single thread.
+class NET_EXPORT_PRIVATE QuicServerInfoStore
+    : public QuicServerInfoFactory,
+      public base::ImportantFileWriter::DataSerializer,
+      public NON_EXPORTED_BASE(base::NonThreadSafe) {
+ public:
+  QuicServerInfoStore(const base::FilePath& path,
+                      base::SequencedTaskRunner* file_task_runner);
+  virtual ~QuicServerInfoStore();
+
+  // QuicServerInfoFactory implementation.
+  virtual QuicServerInfo* GetForHost(const std::string& hostname) OVERRIDE;
+
+  // ImportantFileWriter::DataSerializer implementation.
+  virtual bool SerializeData(std::string* data) OVERRIDE;
+
+  // Replaces the stored entries with those parsed from |data|, which was
+  // produced by SerializeData.  Returns false, and leaves the store empty, if
+  // |data| is malformed or from another version.
+  bool LoadEntries(const std::string& data);
+
+  // Returns true once the file has been read.
+  bool loaded() const { return loaded_; }
+
+  size_t num_entries() const { return entries_.size(); }
+
+ private:
+  class StoreBackedQuicServerInfo;
+
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    std::string server_config;
+    std::string source_address_token;
+    std::string server_config_sig;
+    // The certificate chain, compressed by CertCompressor.
+    std::string compressed_certs;
+  };
+
+  typedef std::map<std::string, Entry> EntryMap;
+
+  // Fills |state| with the stored config for |hostname|.  Returns false if
+  // there is none, or it can't be decompressed.
+  bool Lookup(const std::string& hostname, QuicServerInfo::State* state) const;
+
+  // Stores |state| as the config for |hostname| and schedules a write.
+  void Update(const std::string& hostname, const QuicServerInfo::State& state);
+
+  // Runs |callback| once the file has been read, or immediately if it has.
+  void RunWhenLoaded(const base::Closure& callback);
+
+  void OnLoadComplete(const std::string& data);
+
+  EntryMap entries_;
+  bool loaded_;
+  std::vector<base::Closure> load_callbacks_;
+
+  // Helper for safely writing the data.
+  base::ImportantFileWriter writer_;
+
+  base::WeakPtrFactory<QuicServerInfoStore> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicServerInfoStore);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CRYPTO_QUIC_SERVER_INFO_STORE_H_
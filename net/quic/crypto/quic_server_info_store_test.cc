@@ -0,0 +1,134 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/crypto/quic_server_info_store.h"
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+const char kHostname[] = "www.google.com";
+
+class QuicServerInfoStoreTest : public ::testing::Test {
+ protected:
+  virtual ~QuicServerInfoStoreTest() {
+    store_.reset();
+    base::MessageLoop::current()->RunUntilIdle();
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("QUIC Server Info");
+    CreateStore();
+  }
+
+  void CreateStore() {
+    store_.reset(new QuicServerInfoStore(
+        path_, base::MessageLoop::current()->message_loop_proxy().get()));
+  }
+
+  // Returns a started QuicServerInfo for |kHostname| whose data is ready.
+  QuicServerInfo* GetReadyServerInfo() {
+    QuicServerInfo* server_info = store_->GetForHost(kHostname);
+    server_info->Start();
+    TestCompletionCallback callback;
+    int rv = server_info->WaitForDataReady(callback.callback());
+    EXPECT_EQ(OK, callback.GetResult(rv));
+    EXPECT_TRUE(server_info->IsDataReady());
+    return server_info;
+  }
+
+  void SetState(QuicServerInfo* server_info) {
+    QuicServerInfo::State* state = server_info->mutable_state();
+    state->server_config = "server config";
+    state->source_address_token = "source address token";
+    state->server_config_sig = "server config signature";
+    state->certs.push_back("leaf cert");
+    state->certs.push_back("intermediate cert");
+  }
+
+  void ExpectState(const QuicServerInfo& server_info) {
+    const QuicServerInfo::State& state = server_info.state();
+    EXPECT_EQ("server config", state.server_config);
+    EXPECT_EQ("source address token", state.source_address_token);
+    EXPECT_EQ("server config signature", state.server_config_sig);
+    ASSERT_EQ(2u, state.certs.size());
+    EXPECT_EQ("leaf cert", state.certs[0]);
+    EXPECT_EQ("intermediate cert", state.certs[1]);
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+  scoped_ptr<QuicServerInfoStore> store_;
+};
+
+TEST_F(QuicServerInfoStoreTest, WaitsForLoad) {
+  scoped_ptr<QuicServerInfo> server_info(store_->GetForHost(kHostname));
+  server_info->Start();
+  EXPECT_FALSE(store_->loaded());
+  EXPECT_FALSE(server_info->IsDataReady());
+
+  TestCompletionCallback callback;
+  EXPECT_EQ(ERR_IO_PENDING,
+            server_info->WaitForDataReady(callback.callback()));
+  EXPECT_EQ(OK, callback.WaitForResult());
+  EXPECT_TRUE(store_->loaded());
+  EXPECT_TRUE(server_info->IsDataReady());
+  EXPECT_TRUE(server_info->state().server_config.empty());
+  EXPECT_TRUE(server_info->state().certs.empty());
+}
+
+TEST_F(QuicServerInfoStoreTest, SerializeData) {
+  scoped_ptr<QuicServerInfo> server_info(GetReadyServerInfo());
+  SetState(server_info.get());
+  server_info->Persist();
+  EXPECT_EQ(1u, store_->num_entries());
+
+  string data;
+  EXPECT_TRUE(store_->SerializeData(&data));
+  // The whole store is shared, so a lookup from any factory sees the state.
+  scoped_ptr<QuicServerInfo> other_server_info(GetReadyServerInfo());
+  ExpectState(*other_server_info);
+
+  EXPECT_TRUE(store_->LoadEntries(data));
+  EXPECT_EQ(1u, store_->num_entries());
+  EXPECT_FALSE(store_->LoadEntries(data.substr(0, data.size() - 1)));
+  EXPECT_EQ(0u, store_->num_entries());
+  EXPECT_FALSE(store_->LoadEntries(string()));
+}
+
+TEST_F(QuicServerInfoStoreTest, PersistsAcrossRestarts) {
+  scoped_ptr<QuicServerInfo> server_info(GetReadyServerInfo());
+  SetState(server_info.get());
+  server_info->Persist();
+
+  // Destroying the store writes out the pending change.
+  store_.reset();
+  base::MessageLoop::current()->RunUntilIdle();
+  CreateStore();
+  EXPECT_EQ(1u, store_->num_entries());
+  server_info.reset(GetReadyServerInfo());
+  ExpectState(*server_info);
+}
+
+TEST_F(QuicServerInfoStoreTest, ServerInfoOutlivesStore) {
+  scoped_ptr<QuicServerInfo> server_info(GetReadyServerInfo());
+  store_.reset();
+  SetState(server_info.get());
+  server_info->Persist();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -95,7 +95,7 @@ QuicClientSession::QuicClientSession(
       stream_factory_(stream_factory),
       socket_(socket.Pass()),
       writer_(writer.Pass()),
-      read_buffer_(new IOBufferWithSize(kMaxPacketSize)),
+      read_buffer_(new PooledIOBuffer(kMaxPacketSize)),
       read_pending_(false),
       num_total_streams_(0),
       net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_QUIC_SESSION)),
@@ -533,7 +533,7 @@ void QuicClientSession::OnReadComplete(int result) {
   }
 
   scoped_refptr<IOBufferWithSize> buffer(read_buffer_);
-  read_buffer_ = new IOBufferWithSize(kMaxPacketSize);
+  read_buffer_ = new PooledIOBuffer(kMaxPacketSize);
   QuicEncryptedPacket packet(buffer->data(), result);
   IPEndPoint local_address;
   IPEndPoint peer_address;
@@ -56,11 +56,36 @@ const size_t kMaxFecGroups = 2;
 // expectation of the CHLO/SHLO arriving.
 const size_t kMaxUndecryptablePackets = 10;
 
+// The number of unused packet buffers kept for reuse.  Only packets queued
+// while the connection is write blocked hold on to a buffer for long.
+const size_t kMaxFreePacketBuffers = 8;
+
 bool Near(QuicPacketSequenceNumber a, QuicPacketSequenceNumber b) {
   QuicPacketSequenceNumber delta = (a > b) ? a - b : b - a;
   return delta <= kMaxPacketGap;
 }
 
+// Holds a buffer from a QuicPacketBufferPool for the duration of a scope.
+class ScopedPacketBuffer {
+ public:
+  explicit ScopedPacketBuffer(QuicPacketBufferPool* pool)
+      : pool_(pool),
+        buffer_(pool->Acquire()) {
+  }
+
+  ~ScopedPacketBuffer() {
+    pool_->Release(buffer_);
+  }
+
+  char* get() const { return buffer_; }
+
+ private:
+  QuicPacketBufferPool* pool_;
+  char* buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedPacketBuffer);
+};
+
 // An alarm that is scheduled to send an ack if a timeout occurs.
 class AckAlarm : public QuicAlarm::Delegate {
  public:
@@ -189,6 +214,7 @@ QuicConnection::QuicConnection(QuicGuid guid,
       resume_writes_alarm_(helper->CreateAlarm(new SendAlarm(this))),
       timeout_alarm_(helper->CreateAlarm(new TimeoutAlarm(this))),
       debug_visitor_(NULL),
+      packet_buffer_pool_(kMaxPacketSize, kMaxFreePacketBuffers),
       packet_creator_(guid_, &framer_, random_generator_, is_server),
       packet_generator_(this, NULL, &packet_creator_),
       idle_network_timeout_(
@@ -209,6 +235,7 @@ QuicConnection::QuicConnection(QuicGuid guid,
   }
   DVLOG(1) << ENDPOINT << "Created connection with guid: " << guid;
   timeout_alarm_->Set(clock_->ApproximateNow().Add(idle_network_timeout_));
+  packet_creator_.set_buffer_pool(&packet_buffer_pool_);
   framer_.set_visitor(this);
   framer_.set_received_entropy_calculator(&received_packet_manager_);
 }
@@ -218,7 +245,7 @@ QuicConnection::~QuicConnection() {
   STLDeleteValues(&group_map_);
   for (QueuedPacketList::iterator it = queued_packets_.begin();
        it != queued_packets_.end(); ++it) {
-    delete it->packet;
+    DeletePacket(it->packet);
   }
 }
 
@@ -1039,7 +1066,7 @@ void QuicConnection::WriteQueuedPackets() {
   while (!writer_->IsWriteBlocked() &&
          packet_iterator != queued_packets_.end()) {
     if (WritePacket(*packet_iterator)) {
-      delete packet_iterator->packet;
+      DeletePacket(packet_iterator->packet);
       packet_iterator = queued_packets_.erase(packet_iterator);
     } else {
       // Continue, because some queued packets may still be writable.
@@ -1167,36 +1194,52 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
   DCHECK_LE(sequence_number_of_last_sent_packet_, sequence_number);
   sequence_number_of_last_sent_packet_ = sequence_number;
 
-  QuicEncryptedPacket* encrypted = framer_.EncryptPacket(
-      packet.encryption_level, sequence_number, *packet.packet);
-  if (encrypted == NULL) {
+  // Packets are encrypted into a pooled buffer, unless they are too large
+  // for it, which only happens in tests allowing oversized packets.
+  ScopedPacketBuffer buffer(&packet_buffer_pool_);
+  scoped_ptr<QuicEncryptedPacket> oversized_encrypted;
+  size_t encrypted_length = 0;
+  if (packet.packet->length() <=
+      framer_.GetMaxPlaintextSize(packet_buffer_pool_.buffer_size())) {
+    encrypted_length = framer_.EncryptPacketInto(
+        packet.encryption_level, sequence_number, *packet.packet,
+        buffer.get(), packet_buffer_pool_.buffer_size());
+  } else {
+    oversized_encrypted.reset(framer_.EncryptPacket(
+        packet.encryption_level, sequence_number, *packet.packet));
+    if (oversized_encrypted.get() != NULL) {
+      encrypted_length = oversized_encrypted->length();
+    }
+  }
+  if (encrypted_length == 0) {
     LOG(DFATAL) << ENDPOINT << "Failed to encrypt packet number "
                 << sequence_number;
     // CloseConnection does not send close packet, so no infinite loop here.
     CloseConnection(QUIC_ENCRYPTION_FAILURE, false);
     return false;
   }
+  const QuicEncryptedPacket encrypted(
+      oversized_encrypted.get() != NULL ? oversized_encrypted->data() :
+          buffer.get(),
+      encrypted_length);
 
-  // Connection close packets are eventually owned by TimeWaitListManager.
-  // Others are deleted at the end of this call.
-  scoped_ptr<QuicEncryptedPacket> encrypted_deleter;
+  // Connection close packets are eventually owned by TimeWaitListManager, so
+  // they are copied out of the buffer.
   if (packet.type == CONNECTION_CLOSE) {
     DCHECK(connection_close_packet_.get() == NULL);
-    connection_close_packet_.reset(encrypted);
+    connection_close_packet_.reset(encrypted.Clone());
     // This assures we won't try to write *forced* packets when blocked.
     // Return true to stop processing.
     if (writer_->IsWriteBlocked()) {
       visitor_->OnWriteBlocked();
       return true;
     }
-  } else {
-    encrypted_deleter.reset(encrypted);
   }
 
-  LOG_IF(DFATAL, encrypted->length() > options()->max_packet_length)
+  LOG_IF(DFATAL, encrypted.length() > options()->max_packet_length)
       << "Writing an encrypted packet larger than max_packet_length:"
       << options()->max_packet_length << " encrypted length: "
-      << encrypted->length();
+      << encrypted.length();
   DVLOG(1) << ENDPOINT << "Sending packet number " << sequence_number
            << " : " << (packet.packet->is_fec_packet() ? "FEC " :
                (packet.retransmittable == HAS_RETRANSMITTABLE_DATA
@@ -1204,21 +1247,21 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
            << ", encryption level: "
            << QuicUtils::EncryptionLevelToString(packet.encryption_level)
            << ", length:" << packet.packet->length() << ", encrypted length:"
-           << encrypted->length();
+           << encrypted.length();
   DVLOG(2) << ENDPOINT << "packet(" << sequence_number << "): " << std::endl
            << QuicUtils::StringToHexASCIIDump(packet.packet->AsStringPiece());
 
-  DCHECK(encrypted->length() <= kMaxPacketSize ||
+  DCHECK(encrypted.length() <= kMaxPacketSize ||
          FLAGS_quic_allow_oversized_packets_for_test)
       << "Packet " << sequence_number << " will not be read; too large: "
-      << packet.packet->length() << " " << encrypted->length() << " "
+      << packet.packet->length() << " " << encrypted.length() << " "
       << " close: " << (packet.type == CONNECTION_CLOSE ? "yes" : "no");
 
   DCHECK(pending_write_.get() == NULL);
   pending_write_.reset(new QueuedPacket(packet));
 
-  WriteResult result = writer_->WritePacket(encrypted->data(),
-                                            encrypted->length(),
+  WriteResult result = writer_->WritePacket(encrypted.data(),
+                                            encrypted.length(),
                                             self_address().address(),
                                             peer_address());
   if (result.error_code == ERR_IO_PENDING) {
@@ -1227,7 +1270,7 @@ bool QuicConnection::WritePacket(QueuedPacket packet) {
   if (debug_visitor_) {
     // Pass the write result to the visitor.
     debug_visitor_->OnPacketSent(
-        sequence_number, packet.encryption_level, *encrypted, result);
+        sequence_number, packet.encryption_level, encrypted, result);
   }
   if (result.status == WRITE_STATUS_BLOCKED) {
     visitor_->OnWriteBlocked();
@@ -1373,7 +1416,7 @@ bool QuicConnection::SendOrQueuePacket(EncryptionLevel level,
   // unless it's ConnectionClose, in which case it is written immediately.
   if ((queued_packet.type == CONNECTION_CLOSE || queued_packets_.empty()) &&
       WritePacket(queued_packet)) {
-    delete packet.packet;
+    DeletePacket(packet.packet);
     return true;
   }
   queued_packet.type = QUEUED;
@@ -1381,6 +1424,13 @@ bool QuicConnection::SendOrQueuePacket(EncryptionLevel level,
   return false;
 }
 
+void QuicConnection::DeletePacket(QuicPacket* packet) {
+  if (!packet->owns_buffer()) {
+    packet_buffer_pool_.Release(packet->mutable_data());
+  }
+  delete packet;
+}
+
 void QuicConnection::UpdateSentPacketInfo(SentPacketInfo* sent_info) {
   sent_info->least_unacked = GetLeastUnacked();
   sent_info->entropy_hash = sent_entropy_manager_.EntropyHash(
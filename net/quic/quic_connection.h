@@ -33,6 +33,7 @@
 #include "net/quic/quic_alarm.h"
 #include "net/quic/quic_blocked_writer_interface.h"
 #include "net/quic/quic_connection_stats.h"
+#include "net/quic/quic_packet_buffer_pool.h"
 #include "net/quic/quic_packet_creator.h"
 #include "net/quic/quic_packet_generator.h"
 #include "net/quic/quic_packet_writer.h"
@@ -503,6 +504,10 @@ class NET_EXPORT_PRIVATE QuicConnection
   // will not be consulted.
   bool WritePacket(QueuedPacket packet);
 
+  // Deletes |packet|, returning its buffer to |packet_buffer_pool_| if it was
+  // serialized into one.
+  void DeletePacket(QuicPacket* packet);
+
   // Make sure an ack we got from our peer is sane.
   bool ValidateAckFrame(const QuicAckFrame& incoming_ack);
 
@@ -656,6 +661,9 @@ class NET_EXPORT_PRIVATE QuicConnection
 
   QuicConnectionVisitorInterface* visitor_;
   QuicConnectionDebugVisitorInterface* debug_visitor_;
+  // The buffers packets are serialized and encrypted into.  Must outlive
+  // |packet_creator_| and the packets it created.
+  QuicPacketBufferPool packet_buffer_pool_;
   QuicPacketCreator packet_creator_;
   QuicPacketGenerator packet_generator_;
 
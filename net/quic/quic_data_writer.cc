@@ -19,11 +19,21 @@ namespace net {
 QuicDataWriter::QuicDataWriter(size_t size)
     : buffer_(new char[size]),
       capacity_(size),
-      length_(0) {
+      length_(0),
+      owns_buffer_(true) {
+}
+
+QuicDataWriter::QuicDataWriter(size_t size, char* buffer)
+    : buffer_(buffer),
+      capacity_(size),
+      length_(0),
+      owns_buffer_(false) {
 }
 
 QuicDataWriter::~QuicDataWriter() {
-  delete[] buffer_;
+  if (owns_buffer_) {
+    delete[] buffer_;
+  }
 }
 
 char* QuicDataWriter::take() {
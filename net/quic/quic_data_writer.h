@@ -26,13 +26,17 @@ namespace net {
 class NET_EXPORT_PRIVATE QuicDataWriter {
  public:
   explicit QuicDataWriter(size_t length);
+  // Creates a QuicDataWriter which writes to |buffer|, which holds |length|
+  // bytes and remains owned by the caller.
+  QuicDataWriter(size_t length, char* buffer);
 
   ~QuicDataWriter();
 
   // Returns the size of the QuicDataWriter's data.
   size_t length() const { return length_; }
 
-  // Takes the buffer from the QuicDataWriter.
+  // Takes the buffer from the QuicDataWriter.  The caller owns the buffer
+  // unless it was supplied to the constructor.
   char* take();
 
   // Methods for adding to the payload.  These values are appended to the end
@@ -74,6 +78,7 @@ class NET_EXPORT_PRIVATE QuicDataWriter {
   char* buffer_;
   size_t capacity_;  // Allocation size of payload (or -1 if buffer is const).
   size_t length_;    // Current length of the buffer.
+  bool owns_buffer_;
 };
 
 }  // namespace net
@@ -37,6 +37,21 @@ TEST(QuicDataWriterDeathTest, WriteUInt8ToOffset) {
                 "offset: 4 >= capacity: 4");
 }
 
+TEST(QuicDataWriterTest, WriteToSuppliedBuffer) {
+  char buffer[6];
+  {
+    QuicDataWriter writer(arraysize(buffer), buffer);
+    EXPECT_TRUE(writer.WriteUInt32(0x04030201));
+    EXPECT_TRUE(writer.WriteUInt16(0x0605));
+    EXPECT_FALSE(writer.WriteUInt8(7));
+    EXPECT_EQ(buffer, writer.take());
+  }
+  // The writer did not free the buffer, which still holds its data.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(i + 1, buffer[i]);
+  }
+}
+
 TEST(QuicDataWriterTest, SanityCheckUFloat16Consts) {
   // Check the arithmetic on the constants - otherwise the values below make
   // no sense.
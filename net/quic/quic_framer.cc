@@ -339,9 +339,27 @@ SerializedPacket QuicFramer::BuildDataPacket(
     const QuicFrames& frames,
     size_t packet_size) {
   QuicDataWriter writer(packet_size);
+  return SerializeDataPacket(header, frames, packet_size, true, &writer);
+}
+
+SerializedPacket QuicFramer::BuildDataPacketInBuffer(
+    const QuicPacketHeader& header,
+    const QuicFrames& frames,
+    size_t packet_size,
+    char* buffer) {
+  QuicDataWriter writer(packet_size, buffer);
+  return SerializeDataPacket(header, frames, packet_size, false, &writer);
+}
+
+SerializedPacket QuicFramer::SerializeDataPacket(
+    const QuicPacketHeader& header,
+    const QuicFrames& frames,
+    size_t packet_size,
+    bool owns_buffer,
+    QuicDataWriter* writer) {
   const SerializedPacket kNoPacket(
       0, PACKET_1BYTE_SEQUENCE_NUMBER, NULL, 0, NULL);
-  if (!AppendPacketHeader(header, &writer)) {
+  if (!AppendPacketHeader(header, writer)) {
     LOG(DFATAL) << "AppendPacketHeader failed";
     return kNoPacket;
   }
@@ -350,58 +368,58 @@ SerializedPacket QuicFramer::BuildDataPacket(
     const QuicFrame& frame = frames[i];
 
     const bool last_frame_in_packet = i == (frames.size() - 1);
-    if (!AppendTypeByte(frame, last_frame_in_packet, &writer)) {
+    if (!AppendTypeByte(frame, last_frame_in_packet, writer)) {
       LOG(DFATAL) << "AppendTypeByte failed";
       return kNoPacket;
     }
 
     switch (frame.type) {
       case PADDING_FRAME:
-        writer.WritePadding();
+        writer->WritePadding();
         break;
       case STREAM_FRAME:
         if (!AppendStreamFrame(
-            *frame.stream_frame, last_frame_in_packet, &writer)) {
+            *frame.stream_frame, last_frame_in_packet, writer)) {
           LOG(DFATAL) << "AppendStreamFrame failed";
           return kNoPacket;
         }
         break;
       case ACK_FRAME:
         if (!AppendAckFrameAndTypeByte(
-                header, *frame.ack_frame, &writer)) {
+                header, *frame.ack_frame, writer)) {
           LOG(DFATAL) << "AppendAckFrameAndTypeByte failed";
           return kNoPacket;
         }
         break;
       case CONGESTION_FEEDBACK_FRAME:
         if (!AppendQuicCongestionFeedbackFrame(
-                *frame.congestion_feedback_frame, &writer)) {
+                *frame.congestion_feedback_frame, writer)) {
           LOG(DFATAL) << "AppendQuicCongestionFeedbackFrame failed";
           return kNoPacket;
         }
         break;
       case RST_STREAM_FRAME:
-        if (!AppendRstStreamFrame(*frame.rst_stream_frame, &writer)) {
+        if (!AppendRstStreamFrame(*frame.rst_stream_frame, writer)) {
           LOG(DFATAL) << "AppendRstStreamFrame failed";
           return kNoPacket;
         }
         break;
       case CONNECTION_CLOSE_FRAME:
         if (!AppendConnectionCloseFrame(
-                *frame.connection_close_frame, &writer)) {
+                *frame.connection_close_frame, writer)) {
           LOG(DFATAL) << "AppendConnectionCloseFrame failed";
           return kNoPacket;
         }
         break;
       case GOAWAY_FRAME:
-        if (!AppendGoAwayFrame(*frame.goaway_frame, &writer)) {
+        if (!AppendGoAwayFrame(*frame.goaway_frame, writer)) {
           LOG(DFATAL) << "AppendGoAwayFrame failed";
           return kNoPacket;
         }
         break;
       case WINDOW_UPDATE_FRAME:
         if (quic_version_ > QUIC_VERSION_13) {
-          if (!AppendWindowUpdateFrame(*frame.window_update_frame, &writer)) {
+          if (!AppendWindowUpdateFrame(*frame.window_update_frame, writer)) {
             LOG(DFATAL) << "AppendWindowUpdateFrame failed";
             return kNoPacket;
           }
@@ -413,7 +431,7 @@ SerializedPacket QuicFramer::BuildDataPacket(
         break;
       case BLOCKED_FRAME:
         if (quic_version_ > QUIC_VERSION_13) {
-          if (!AppendBlockedFrame(*frame.blocked_frame, &writer)) {
+          if (!AppendBlockedFrame(*frame.blocked_frame, writer)) {
             LOG(DFATAL) << "AppendBlockedFrame failed";
             return kNoPacket;
           }
@@ -431,12 +449,12 @@ SerializedPacket QuicFramer::BuildDataPacket(
   }
 
   // Save the length before writing, because take clears it.
-  const size_t len = writer.length();
+  const size_t len = writer->length();
   // Less than or equal because truncated acks end up with max_plaintex_size
   // length, even though they're typically slightly shorter.
   DCHECK_LE(len, packet_size);
   QuicPacket* packet = QuicPacket::NewDataPacket(
-      writer.take(), len, true, header.public_header.guid_length,
+      writer->take(), len, owns_buffer, header.public_header.guid_length,
       header.public_header.version_flag,
       header.public_header.sequence_number_length);
 
@@ -1709,19 +1727,43 @@ QuicEncryptedPacket* QuicFramer::EncryptPacket(
     const QuicPacket& packet) {
   DCHECK(encrypter_[level].get() != NULL);
 
-  scoped_ptr<QuicData> out(encrypter_[level]->EncryptPacket(
-      packet_sequence_number, packet.AssociatedData(), packet.Plaintext()));
-  if (out.get() == NULL) {
-    RaiseError(QUIC_ENCRYPTION_FAILURE);
+  const size_t buffer_length = packet.BeforePlaintext().length() +
+      encrypter_[level]->GetCiphertextSize(packet.Plaintext().length());
+  scoped_ptr<char[]> buffer(new char[buffer_length]);
+  const size_t len = EncryptPacketInto(level, packet_sequence_number, packet,
+                                       buffer.get(), buffer_length);
+  if (len == 0) {
     return NULL;
   }
+  return new QuicEncryptedPacket(buffer.release(), len, true);
+}
+
+size_t QuicFramer::EncryptPacketInto(
+    EncryptionLevel level,
+    QuicPacketSequenceNumber packet_sequence_number,
+    const QuicPacket& packet,
+    char* buffer,
+    size_t buffer_length) {
+  DCHECK(encrypter_[level].get() != NULL);
+
   StringPiece header_data = packet.BeforePlaintext();
-  size_t len =  header_data.length() + out->length();
-  char* buffer = new char[len];
-  // TODO(rch): eliminate this buffer copy by passing in a buffer to Encrypt().
+  StringPiece plaintext = packet.Plaintext();
+  const size_t len = header_data.length() +
+      encrypter_[level]->GetCiphertextSize(plaintext.length());
+  if (len > buffer_length) {
+    LOG(DFATAL) << "Encrypted packet of length " << len
+                << " does not fit in " << buffer_length << " bytes";
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
   memcpy(buffer, header_data.data(), header_data.length());
-  memcpy(buffer + header_data.length(), out->data(), out->length());
-  return new QuicEncryptedPacket(buffer, len, true);
+  if (!encrypter_[level]->EncryptPacketInto(
+          packet_sequence_number, packet.AssociatedData(), plaintext,
+          buffer + header_data.length())) {
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+  return len;
 }
 
 size_t QuicFramer::GetMaxPlaintextSize(size_t ciphertext_size) {
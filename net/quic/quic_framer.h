@@ -301,6 +301,14 @@ class NET_EXPORT_PRIVATE QuicFramer {
                                    const QuicFrames& frames,
                                    size_t packet_size);
 
+  // Like BuildDataPacket(), but serializes the packet into |buffer|, which
+  // must be at least |packet_size| bytes long.  The returned packet does not
+  // own |buffer|, which must outlive it.
+  SerializedPacket BuildDataPacketInBuffer(const QuicPacketHeader& header,
+                                           const QuicFrames& frames,
+                                           size_t packet_size,
+                                           char* buffer);
+
   // Returns a SerializedPacket whose |packet| member is owned by the caller,
   // and is populated with the fields in |header| and |fec|, or is NULL if the
   // packet could not be created.
@@ -347,6 +355,15 @@ class NET_EXPORT_PRIVATE QuicFramer {
                                      QuicPacketSequenceNumber sequence_number,
                                      const QuicPacket& packet);
 
+  // Writes the encrypted |packet| to |buffer|, which is |buffer_length| bytes
+  // long, and returns the length of the encrypted packet, or 0 if the packet
+  // could not be encrypted or does not fit.
+  size_t EncryptPacketInto(EncryptionLevel level,
+                           QuicPacketSequenceNumber sequence_number,
+                           const QuicPacket& packet,
+                           char* buffer,
+                           size_t buffer_length);
+
   // Returns the maximum length of plaintext that can be encrypted
   // to ciphertext no larger than |ciphertext_size|.
   size_t GetMaxPlaintextSize(size_t ciphertext_size);
@@ -414,6 +431,15 @@ class NET_EXPORT_PRIVATE QuicFramer {
   bool DecryptPayload(const QuicPacketHeader& header,
                       const QuicEncryptedPacket& packet);
 
+  // Serializes |header| and |frames| with |writer|, which holds
+  // |packet_size| bytes.  The returned packet owns the writer's buffer if
+  // |owns_buffer| is true.
+  SerializedPacket SerializeDataPacket(const QuicPacketHeader& header,
+                                       const QuicFrames& frames,
+                                       size_t packet_size,
+                                       bool owns_buffer,
+                                       QuicDataWriter* writer);
+
   // Returns the full packet sequence number from the truncated
   // wire format version and the last seen packet sequence number.
   QuicPacketSequenceNumber CalculatePacketSequenceNumberFromWire(
@@ -0,0 +1,113 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/test/perf_log.h"
+#include "base/test/perf_time_logger.h"
+#include "net/quic/quic_framer.h"
+#include "net/quic/quic_packet_buffer_pool.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_utils.h"
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+const int kIterations = 100000;
+
+class QuicFramerPerfTest : public ::testing::Test {
+ protected:
+  QuicFramerPerfTest()
+      : framer_(QuicSupportedVersions(), QuicTime::Zero(), false),
+        data_(1000, 'x') {
+    header_.public_header.guid = GG_UINT64_C(0xFEDCBA9876543210);
+    header_.public_header.reset_flag = false;
+    header_.public_header.version_flag = false;
+    header_.fec_flag = false;
+    header_.entropy_flag = false;
+    header_.fec_group = 0;
+    header_.packet_sequence_number = 1;
+
+    // Nearly fill a default sized packet with a single stream frame, as a
+    // bulk transfer would.
+    stream_frame_.stream_id = 5;
+    stream_frame_.fin = false;
+    stream_frame_.offset = 0;
+    stream_frame_.data = MakeIOVector(data_);
+    frames_.push_back(QuicFrame(&stream_frame_));
+    packet_size_ = framer_.GetMaxPlaintextSize(kDefaultMaxPacketSize);
+  }
+
+  void NextPacket() {
+    ++header_.packet_sequence_number;
+    stream_frame_.offset += stream_frame_.data.TotalBufferSize();
+  }
+
+  QuicFramer framer_;
+  QuicPacketHeader header_;
+  QuicStreamFrame stream_frame_;
+  QuicFrames frames_;
+  string data_;
+  size_t packet_size_;
+};
+
+// Serializes and encrypts packets the way QuicConnection did before it
+// pooled its buffers, with two allocations per packet.
+TEST_F(QuicFramerPerfTest, SerializeAndEncrypt) {
+  size_t bytes = 0;
+  {
+    base::PerfTimeLogger timer("quic_framer_serialize_and_encrypt");
+    for (int i = 0; i < kIterations; ++i) {
+      scoped_ptr<QuicPacket> packet(
+          framer_.BuildDataPacket(header_, frames_, packet_size_).packet);
+      ASSERT_TRUE(packet != NULL);
+      scoped_ptr<QuicEncryptedPacket> encrypted(framer_.EncryptPacket(
+          ENCRYPTION_NONE, header_.packet_sequence_number, *packet));
+      ASSERT_TRUE(encrypted != NULL);
+      bytes += encrypted->length();
+      NextPacket();
+    }
+  }
+  base::LogPerfResult("quic_framer_serialize_and_encrypt_bytes", bytes,
+                      "bytes");
+}
+
+// Serializes and encrypts packets into pooled buffers, as QuicConnection
+// does.
+TEST_F(QuicFramerPerfTest, SerializeAndEncryptIntoPooledBuffers) {
+  QuicPacketBufferPool pool(kMaxPacketSize, 2);
+  size_t bytes = 0;
+  {
+    base::PerfTimeLogger timer("quic_framer_serialize_and_encrypt_pooled");
+    for (int i = 0; i < kIterations; ++i) {
+      char* buffer = pool.Acquire();
+      scoped_ptr<QuicPacket> packet(framer_.BuildDataPacketInBuffer(
+          header_, frames_, packet_size_, buffer).packet);
+      ASSERT_TRUE(packet != NULL);
+      char* encrypted = pool.Acquire();
+      size_t encrypted_length = framer_.EncryptPacketInto(
+          ENCRYPTION_NONE, header_.packet_sequence_number, *packet,
+          encrypted, pool.buffer_size());
+      ASSERT_NE(0u, encrypted_length);
+      bytes += encrypted_length;
+      pool.Release(encrypted);
+      packet.reset();
+      pool.Release(buffer);
+      NextPacket();
+    }
+  }
+  base::LogPerfResult("quic_framer_serialize_and_encrypt_pooled_bytes", bytes,
+                      "bytes");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -4570,6 +4570,54 @@ TEST_P(QuicFramerTest, EncryptPacketWithVersionFlag) {
   EXPECT_TRUE(CheckEncryption(sequence_number, raw.get()));
 }
 
+TEST_P(QuicFramerTest, BuildDataPacketInBufferAndEncryptPacketInto) {
+  QuicPacketHeader header;
+  header.public_header.guid = GG_UINT64_C(0xFEDCBA9876543210);
+  header.public_header.reset_flag = false;
+  header.public_header.version_flag = false;
+  header.fec_flag = false;
+  header.entropy_flag = true;
+  header.packet_sequence_number = GG_UINT64_C(0x77123456789ABC);
+  header.fec_group = 0;
+
+  QuicStreamFrame stream_frame;
+  stream_frame.stream_id = 0x01020304;
+  stream_frame.fin = true;
+  stream_frame.offset = GG_UINT64_C(0xBA98FEDC32107654);
+  stream_frame.data = MakeIOVector("hello world!");
+
+  QuicFrames frames;
+  frames.push_back(QuicFrame(&stream_frame));
+
+  scoped_ptr<QuicPacket> expected(
+      framer_.BuildUnsizedDataPacket(header, frames).packet);
+  ASSERT_TRUE(expected != NULL);
+
+  // The packet is serialized into the supplied buffer, which it doesn't own.
+  char buffer[kMaxPacketSize];
+  scoped_ptr<QuicPacket> raw(framer_.BuildDataPacketInBuffer(
+      header, frames, expected->length(), buffer).packet);
+  ASSERT_TRUE(raw != NULL);
+  EXPECT_EQ(buffer, raw->data());
+  EXPECT_FALSE(raw->owns_buffer());
+  test::CompareCharArraysWithHexError("constructed packet",
+                                      raw->data(), raw->length(),
+                                      expected->data(), expected->length());
+
+  char encrypted[kMaxPacketSize];
+  size_t encrypted_length = framer_.EncryptPacketInto(
+      ENCRYPTION_NONE, header.packet_sequence_number, *raw, encrypted,
+      arraysize(encrypted));
+  EXPECT_EQ(raw->length(), encrypted_length);
+  EXPECT_TRUE(CheckEncryption(header.packet_sequence_number, raw.get()));
+
+  // The encrypted packet must fit in the output buffer.
+  EXPECT_DFATAL(EXPECT_EQ(0u, framer_.EncryptPacketInto(
+                    ENCRYPTION_NONE, header.packet_sequence_number, *raw,
+                    encrypted, raw->length() - 1)),
+                "does not fit in");
+}
+
 TEST_P(QuicFramerTest, Truncation) {
   QuicPacketHeader header;
   header.public_header.guid = GG_UINT64_C(0xFEDCBA9876543210);
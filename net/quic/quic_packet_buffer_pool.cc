@@ -0,0 +1,41 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_packet_buffer_pool.h"
+
+#include "base/logging.h"
+
+namespace net {
+
+QuicPacketBufferPool::QuicPacketBufferPool(size_t buffer_size,
+                                           size_t max_free_buffers)
+    : buffer_size_(buffer_size),
+      max_free_buffers_(max_free_buffers) {
+}
+
+QuicPacketBufferPool::~QuicPacketBufferPool() {
+  for (size_t i = 0; i < free_buffers_.size(); ++i) {
+    delete[] free_buffers_[i];
+  }
+}
+
+char* QuicPacketBufferPool::Acquire() {
+  if (free_buffers_.empty()) {
+    return new char[buffer_size_];
+  }
+  char* buffer = free_buffers_.back();
+  free_buffers_.pop_back();
+  return buffer;
+}
+
+void QuicPacketBufferPool::Release(char* buffer) {
+  DCHECK(buffer);
+  if (free_buffers_.size() >= max_free_buffers_) {
+    delete[] buffer;
+    return;
+  }
+  free_buffers_.push_back(buffer);
+}
+
+}  // namespace net
@@ -0,0 +1,48 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Recycles the buffers packets are serialized and encrypted into, so that
+// sending a packet doesn't allocate once a connection is under way.
+
+#ifndef NET_QUIC_QUIC_PACKET_BUFFER_POOL_H_
+#define NET_QUIC_QUIC_PACKET_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class NET_EXPORT_PRIVATE QuicPacketBufferPool {
+ public:
+  // The buffers are |buffer_size| bytes long.  At most |max_free_buffers|
+  // released buffers are kept for reuse; the others are freed.
+  QuicPacketBufferPool(size_t buffer_size, size_t max_free_buffers);
+  ~QuicPacketBufferPool();
+
+  // Returns a buffer of buffer_size() bytes, owned by the caller until it is
+  // passed to Release().
+  char* Acquire();
+
+  // Takes back a buffer returned by Acquire().
+  void Release(char* buffer);
+
+  size_t buffer_size() const { return buffer_size_; }
+
+  size_t free_buffer_count() const { return free_buffers_.size(); }
+
+ private:
+  const size_t buffer_size_;
+  const size_t max_free_buffers_;
+  std::vector<char*> free_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketBufferPool);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_QUIC_PACKET_BUFFER_POOL_H_
@@ -0,0 +1,44 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_packet_buffer_pool.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+TEST(QuicPacketBufferPoolTest, ReusesReleasedBuffers) {
+  QuicPacketBufferPool pool(100, 2);
+  EXPECT_EQ(100u, pool.buffer_size());
+
+  char* buffer1 = pool.Acquire();
+  char* buffer2 = pool.Acquire();
+  EXPECT_NE(buffer1, buffer2);
+  EXPECT_EQ(0u, pool.free_buffer_count());
+
+  pool.Release(buffer1);
+  EXPECT_EQ(1u, pool.free_buffer_count());
+  EXPECT_EQ(buffer1, pool.Acquire());
+  EXPECT_EQ(0u, pool.free_buffer_count());
+
+  pool.Release(buffer1);
+  pool.Release(buffer2);
+}
+
+TEST(QuicPacketBufferPoolTest, FreesBuffersBeyondLimit) {
+  QuicPacketBufferPool pool(100, 1);
+  char* buffer1 = pool.Acquire();
+  char* buffer2 = pool.Acquire();
+  pool.Release(buffer1);
+  pool.Release(buffer2);
+  EXPECT_EQ(1u, pool.free_buffer_count());
+  EXPECT_EQ(buffer1, pool.Acquire());
+  pool.Release(buffer1);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
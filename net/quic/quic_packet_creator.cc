@@ -9,6 +9,7 @@
 #include "net/quic/crypto/quic_random.h"
 #include "net/quic/quic_ack_notifier.h"
 #include "net/quic/quic_fec_group.h"
+#include "net/quic/quic_packet_buffer_pool.h"
 #include "net/quic/quic_utils.h"
 
 using base::StringPiece;
@@ -61,6 +62,7 @@ QuicPacketCreator::QuicPacketCreator(QuicGuid guid,
                                      bool is_server)
     : guid_(guid),
       framer_(framer),
+      buffer_pool_(NULL),
       random_bool_source_(new QuicRandomBoolSource(random_generator)),
       sequence_number_(0),
       fec_group_number_(0),
@@ -332,8 +334,18 @@ SerializedPacket QuicPacketCreator::SerializePacket() {
       queued_frames_.size() != 1 ||
       (queued_frames_.back().type == ACK_FRAME ||
        queued_frames_.back().type == CONNECTION_CLOSE_FRAME);
-  SerializedPacket serialized =
-      framer_->BuildDataPacket(header, queued_frames_, packet_size_);
+  SerializedPacket serialized(0, PACKET_1BYTE_SEQUENCE_NUMBER, NULL, 0, NULL);
+  if (buffer_pool_ != NULL && packet_size_ <= buffer_pool_->buffer_size()) {
+    char* buffer = buffer_pool_->Acquire();
+    serialized = framer_->BuildDataPacketInBuffer(header, queued_frames_,
+                                                  packet_size_, buffer);
+    if (!serialized.packet) {
+      buffer_pool_->Release(buffer);
+    }
+  } else {
+    serialized = framer_->BuildDataPacket(header, queued_frames_,
+                                          packet_size_);
+  }
   if (!serialized.packet) {
     LOG(DFATAL) << "Failed to serialize " << queued_frames_.size()
                 << " frames.";
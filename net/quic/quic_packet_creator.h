@@ -24,6 +24,7 @@ class QuicPacketCreatorPeer;
 }
 
 class QuicAckNotifier;
+class QuicPacketBufferPool;
 class QuicRandom;
 class QuicRandomBoolSource;
 
@@ -175,6 +176,13 @@ class NET_EXPORT_PRIVATE QuicPacketCreator : public QuicFecBuilderInterface {
     return &options_;
   }
 
+  // Makes data packets be serialized into buffers taken from |pool|, when
+  // they fit.  Such packets don't own their buffer, which must be returned
+  // to |pool| once the packet is deleted.  |pool| must outlive the creator.
+  void set_buffer_pool(QuicPacketBufferPool* pool) {
+    buffer_pool_ = pool;
+  }
+
  private:
   friend class test::QuicPacketCreatorPeer;
 
@@ -200,6 +208,7 @@ class NET_EXPORT_PRIVATE QuicPacketCreator : public QuicFecBuilderInterface {
   Options options_;
   QuicGuid guid_;
   QuicFramer* framer_;
+  QuicPacketBufferPool* buffer_pool_;  // Not owned, may be NULL.
   scoped_ptr<QuicRandomBoolSource> random_bool_source_;
   QuicPacketSequenceNumber sequence_number_;
   QuicFecGroupNumber fec_group_number_;
@@ -666,6 +666,11 @@ enum CongestionFeedbackType {
   kFixRate,  // Provided for testing.
 };
 
+enum LossDetectionType {
+  kNack,  // Used to mimic TCP's loss detection.
+  kTime,  // Time based loss detection.
+};
+
 struct NET_EXPORT_PRIVATE CongestionFeedbackMessageTCP {
   CongestionFeedbackMessageTCP();
 
@@ -847,6 +852,7 @@ class NET_EXPORT_PRIVATE QuicData {
 
   const char* data() const { return buffer_; }
   size_t length() const { return length_; }
+  bool owns_buffer() const { return owns_buffer_; }
 
  private:
   const char* buffer_;
@@ -6,6 +6,8 @@
 
 #include "base/logging.h"
 #include "base/stl_util.h"
+#include "net/quic/congestion_control/bbr_sender.h"
+#include "net/quic/congestion_control/loss_detection_interface.h"
 #include "net/quic/congestion_control/pacing_sender.h"
 #include "net/quic/crypto/crypto_protocol.h"
 #include "net/quic/quic_ack_notifier_manager.h"
@@ -31,6 +33,15 @@ bool FLAGS_track_retransmission_history = false;
 // request pacing for the server to enable it.
 bool FLAGS_enable_quic_pacing = false;
 
+// If true, QUIC connections will offer the BBR congestion control algorithm,
+// which paces at a model of the bottleneck bandwidth instead of reacting to
+// loss.  The peer must also support it for it to be used.
+bool FLAGS_enable_quic_bbr = false;
+
+// If true, QUIC connections declare a packet lost once 1.25 RTTs have passed
+// since a later packet was acked, instead of after 3 nacks.
+bool FLAGS_use_time_loss_detection = false;
+
 namespace net {
 namespace {
 static const int kDefaultRetransmissionTimeMs = 500;
@@ -41,9 +52,6 @@ static const int kMinRetransmissionTimeMs = 200;
 static const int kMaxRetransmissionTimeMs = 60000;
 static const size_t kMaxRetransmissions = 10;
 
-// TCP retransmits after 3 nacks.
-static const size_t kNumberOfNacksBeforeRetransmission = 3;
-
 // Only exponentially back off the handshake timer 5 times due to a timeout.
 static const size_t kMaxHandshakeRetransmissionBackoffs = 5;
 static const size_t kMinHandshakeTimeoutMs = 10;
@@ -75,7 +83,10 @@ QuicSentPacketManager::QuicSentPacketManager(bool is_server,
       clock_(clock),
       stats_(stats),
       send_algorithm_(SendAlgorithmInterface::Create(clock, type)),
+      loss_algorithm_(LossDetectionInterface::Create(
+          FLAGS_use_time_loss_detection ? kTime : kNack)),
       rtt_sample_(QuicTime::Delta::Infinite()),
+      largest_observed_(0),
       pending_crypto_packet_count_(0),
       consecutive_rto_count_(0),
       consecutive_tlp_count_(0),
@@ -100,6 +111,9 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
   if (config.congestion_control() == kPACE) {
     MaybeEnablePacing();
   }
+  if (config.congestion_control() == kTBBR) {
+    MaybeEnableBbr();
+  }
   send_algorithm_->SetFromConfig(config, is_server_);
 }
 
@@ -344,12 +358,7 @@ QuicSentPacketManager::MarkPacketHandled(
     ++all_transmissions_it;
   }
 
-  QuicUnackedPacketMap::const_iterator next_unacked = unacked_packets_.begin();
-  while (next_unacked != unacked_packets_.end() &&
-         next_unacked->first < sequence_number) {
-    ++next_unacked;
-  }
-  return next_unacked;
+  return unacked_packets_.lower_bound(sequence_number);
 }
 
 bool QuicSentPacketManager::IsUnacked(
@@ -400,15 +409,19 @@ bool QuicSentPacketManager::OnPacketSent(
 
 void QuicSentPacketManager::OnRetransmissionTimeout() {
   DCHECK(unacked_packets_.HasPendingPackets());
-  // Handshake retransmission, TLP, and RTO are implemented with a single alarm.
-  // The handshake alarm is set when the handshake has not completed, and the
-  // TLP and RTO alarms are set after that.
+  // Handshake retransmission, timer based loss detection, TLP, and RTO are
+  // implemented with a single alarm. The handshake alarm is set when the
+  // handshake has not completed, the loss alarm is set when the loss detection
+  // algorithm says to, and the TLP and RTO alarms are set after that.
   // The TLP alarm is always set to run for under an RTO.
   switch (GetRetransmissionMode()) {
     case HANDSHAKE_MODE:
       ++stats_->crypto_retransmit_count;
       RetransmitCryptoPackets();
       return;
+    case LOSS_MODE:
+      InvokeLossDetection(clock_->Now());
+      return;
     case TLP_MODE:
       // If no tail loss probe can be sent, because there are no retransmittable
       // packets, execute a conventional RTO to abandon old packets.
@@ -498,6 +511,9 @@ QuicSentPacketManager::RetransmissionTimeoutMode
   if (pending_crypto_packet_count_ > 0) {
     return HANDSHAKE_MODE;
   }
+  if (loss_algorithm_->GetLossTimeout() != QuicTime::Zero()) {
+    return LOSS_MODE;
+  }
   if (consecutive_tlp_count_ < max_tail_loss_probes_) {
     if (unacked_packets_.HasUnackedRetransmittableFrames()) {
       return TLP_MODE;
@@ -528,18 +544,21 @@ void QuicSentPacketManager::OnIncomingQuicCongestionFeedbackFrame(
 void QuicSentPacketManager::MaybeRetransmitOnAckFrame(
     const ReceivedPacketInfo& received_info,
     const QuicTime& ack_receive_time) {
-  // Go through all pending packets up to the largest observed and see if any
-  // need to be retransmitted or lost.
-  for (QuicUnackedPacketMap::const_iterator it = unacked_packets_.begin();
-       it != unacked_packets_.end() &&
-           it->first <= received_info.largest_observed; ++it) {
-    if (!it->second.pending) {
+  // Only the packets the peer reports missing can still be pending below the
+  // largest observed, since acks were handled previously, so walk the missing
+  // packets instead of every unacked packet.
+  largest_observed_ = max(largest_observed_, received_info.largest_observed);
+  SequenceNumberSet::const_iterator it =
+      received_info.missing_packets.lower_bound(
+          unacked_packets_.GetLeastUnackedSentPacket());
+  for (; it != received_info.missing_packets.end() &&
+           *it <= received_info.largest_observed; ++it) {
+    QuicPacketSequenceNumber sequence_number = *it;
+    if (!unacked_packets_.IsUnacked(sequence_number) ||
+        !unacked_packets_.IsPending(sequence_number)) {
       continue;
     }
-    QuicPacketSequenceNumber sequence_number = it->first;
     DVLOG(1) << "still missing packet " << sequence_number;
-    // Acks must be handled previously, so ensure it's missing and not acked.
-    DCHECK(IsAwaitingPacket(received_info, sequence_number));
 
     // Consider it multiple nacks when there is a gap between the missing packet
     // and the largest observed, since the purpose of a nack threshold is to
@@ -550,10 +569,16 @@ void QuicSentPacketManager::MaybeRetransmitOnAckFrame(
     unacked_packets_.NackPacket(sequence_number, min_nacks);
   }
 
+  InvokeLossDetection(ack_receive_time);
+}
+
+void QuicSentPacketManager::InvokeLossDetection(QuicTime time) {
   SequenceNumberSet lost_packets =
-      DetectLostPackets(unacked_packets_,
-                       ack_receive_time,
-                       received_info.largest_observed);
+      loss_algorithm_->DetectLostPackets(unacked_packets_,
+                                         time,
+                                         largest_observed_,
+                                         send_algorithm_->SmoothedRtt(),
+                                         rtt_sample_);
   for (SequenceNumberSet::const_iterator it = lost_packets.begin();
        it != lost_packets.end(); ++it) {
     QuicPacketSequenceNumber sequence_number = *it;
@@ -561,7 +586,7 @@ void QuicSentPacketManager::MaybeRetransmitOnAckFrame(
     // should be recorded as a loss to the send algorithm, but not retransmitted
     // until it's known whether the FEC packet arrived.
     ++stats_->packets_lost;
-    send_algorithm_->OnPacketLost(sequence_number, ack_receive_time);
+    send_algorithm_->OnPacketLost(sequence_number, time);
     OnPacketAbandoned(sequence_number);
 
     if (unacked_packets_.HasRetransmittableFrames(sequence_number)) {
@@ -576,40 +601,6 @@ void QuicSentPacketManager::MaybeRetransmitOnAckFrame(
   }
 }
 
-// static
-SequenceNumberSet QuicSentPacketManager::DetectLostPackets(
-    const QuicUnackedPacketMap& unacked_packets,
-    const QuicTime& time,
-    QuicPacketSequenceNumber largest_observed) {
-  SequenceNumberSet lost_packets;
-
-  for (QuicUnackedPacketMap::const_iterator it = unacked_packets.begin();
-       it != unacked_packets.end() && it->first <= largest_observed; ++it) {
-    if (!it->second.pending) {
-      continue;
-    }
-    size_t num_nacks_needed = kNumberOfNacksBeforeRetransmission;
-    // Check for early retransmit(RFC5827) when the last packet gets acked and
-    // the there are fewer than 4 pending packets.
-    // TODO(ianswett): Set a retransmission timer instead of losing the packet
-    // and retransmitting immediately.  Also consider only invoking OnPacketLost
-    // and OnPacketAbandoned when they're actually retransmitted in case they
-    // arrive while queued for retransmission.
-    if (it->second.retransmittable_frames &&
-        unacked_packets.largest_sent_packet() == largest_observed) {
-      num_nacks_needed = largest_observed - it->first;
-    }
-
-    if (it->second.nack_count < num_nacks_needed) {
-      continue;
-    }
-
-    lost_packets.insert(it->first);
-  }
-
-  return lost_packets;
-}
-
 void QuicSentPacketManager::MaybeUpdateRTT(
     const ReceivedPacketInfo& received_info,
     const QuicTime& ack_receive_time) {
@@ -672,6 +663,8 @@ const QuicTime QuicSentPacketManager::GetRetransmissionTime() const {
   switch (GetRetransmissionMode()) {
     case HANDSHAKE_MODE:
       return clock_->ApproximateNow().Add(GetCryptoRetransmissionDelay());
+    case LOSS_MODE:
+      return loss_algorithm_->GetLossTimeout();
     case TLP_MODE: {
       // TODO(ianswett): When CWND is available, it would be preferable to
       // set the timer based on the earliest retransmittable packet.
@@ -770,4 +763,18 @@ void QuicSentPacketManager::MaybeEnablePacing() {
                        QuicTime::Delta::FromMicroseconds(1)));
 }
 
+void QuicSentPacketManager::MaybeEnableBbr() {
+  if (!FLAGS_enable_quic_bbr) {
+    return;
+  }
+
+  // BbrSender paces itself, so it replaces any PacingSender.  This happens
+  // before any data is sent, so nothing in flight is lost track of.
+  using_pacing_ = false;
+  send_algorithm_.reset(new BbrSender(clock_));
+  if (!rtt_sample_.IsInfinite()) {
+    send_algorithm_->UpdateRtt(rtt_sample_);
+  }
+}
+
 }  // namespace net
@@ -16,6 +16,7 @@
 #include "base/containers/hash_tables.h"
 #include "base/memory/scoped_ptr.h"
 #include "net/base/linked_hash_map.h"
+#include "net/quic/congestion_control/loss_detection_interface.h"
 #include "net/quic/congestion_control/send_algorithm_interface.h"
 #include "net/quic/quic_ack_notifier_manager.h"
 #include "net/quic/quic_protocol.h"
@@ -23,6 +24,8 @@
 
 NET_EXPORT_PRIVATE extern bool FLAGS_track_retransmission_history;
 NET_EXPORT_PRIVATE extern bool FLAGS_enable_quic_pacing;
+NET_EXPORT_PRIVATE extern bool FLAGS_enable_quic_bbr;
+NET_EXPORT_PRIVATE extern bool FLAGS_use_time_loss_detection;
 
 namespace net {
 
@@ -163,6 +166,10 @@ class NET_EXPORT_PRIVATE QuicSentPacketManager {
   // FLAGS_enable_quic_pacing is set.
   void MaybeEnablePacing();
 
+  // Replaces the send algorithm with a BbrSender if FLAGS_enable_quic_bbr is
+  // set.
+  void MaybeEnableBbr();
+
   bool using_pacing() const { return using_pacing_; }
 
  private:
@@ -178,6 +185,7 @@ class NET_EXPORT_PRIVATE QuicSentPacketManager {
     RTO_MODE,
     TLP_MODE,
     HANDSHAKE_MODE,
+    LOSS_MODE,
   };
 
   typedef linked_hash_map<QuicPacketSequenceNumber,
@@ -220,6 +228,10 @@ class NET_EXPORT_PRIVATE QuicSentPacketManager {
   void MaybeRetransmitOnAckFrame(const ReceivedPacketInfo& received_info,
                                  const QuicTime& ack_receive_time);
 
+  // Invokes the loss detection algorithm and loses and retransmits packets if
+  // necessary.
+  void InvokeLossDetection(QuicTime time);
+
   // Marks |sequence_number| as being fully handled, either due to receipt
   // by the peer, or having been discarded as indecipherable.  Returns an
   // iterator to the next remaining unacked packet.
@@ -233,11 +245,6 @@ class NET_EXPORT_PRIVATE QuicSentPacketManager {
   void MarkForRetransmission(QuicPacketSequenceNumber sequence_number,
                              TransmissionType transmission_type);
 
-  static SequenceNumberSet DetectLostPackets(
-      const QuicUnackedPacketMap& unacked_packets,
-      const QuicTime& time,
-      QuicPacketSequenceNumber largest_observed);
-
   // Newly serialized retransmittable and fec packets are added to this map,
   // which contains owning pointers to any contained frames.  If a packet is
   // retransmitted, this map will contain entries for both the old and the new
@@ -262,7 +269,10 @@ class NET_EXPORT_PRIVATE QuicSentPacketManager {
   const QuicClock* clock_;
   QuicConnectionStats* stats_;
   scoped_ptr<SendAlgorithmInterface> send_algorithm_;
+  scoped_ptr<LossDetectionInterface> loss_algorithm_;
   QuicTime::Delta rtt_sample_;  // RTT estimate from the most recent ACK.
+  // The largest sequence number the peer has reported receiving.
+  QuicPacketSequenceNumber largest_observed_;
   // Number of outstanding crypto handshake packets.
   size_t pending_crypto_packet_count_;
   // Number of times the RTO timer has fired in a row without receiving an ack.
@@ -10,6 +10,7 @@
 #include "base/logging.h"
 #include "net/quic/reliable_quic_stream.h"
 
+using std::max;
 using std::min;
 using std::numeric_limits;
 
@@ -20,8 +21,7 @@ QuicStreamSequencer::QuicStreamSequencer(ReliableQuicStream* quic_stream)
       num_bytes_consumed_(0),
       max_frame_memory_(numeric_limits<size_t>::max()),
       close_offset_(numeric_limits<QuicStreamOffset>::max()),
-      blocked_(false),
-      num_bytes_buffered_(0) {
+      blocked_(false) {
 }
 
 QuicStreamSequencer::QuicStreamSequencer(size_t max_frame_memory,
@@ -30,8 +30,7 @@ QuicStreamSequencer::QuicStreamSequencer(size_t max_frame_memory,
       num_bytes_consumed_(0),
       max_frame_memory_(max_frame_memory),
       close_offset_(numeric_limits<QuicStreamOffset>::max()),
-      blocked_(false),
-      num_bytes_buffered_(0) {
+      blocked_(false) {
   if (max_frame_memory < kMaxPacketSize) {
     LOG(DFATAL) << "Setting max frame memory to " << max_frame_memory
                 << ".  Some frames will be impossible to handle.";
@@ -101,6 +100,14 @@ bool QuicStreamSequencer::OnStreamFrame(const QuicStreamFrame& frame) {
   IOVector data;
   data.AppendIovec(frame.data.iovec(), frame.data.Size());
 
+  // Drop any part of the frame which has already been consumed.
+  if (byte_offset < num_bytes_consumed_) {
+    size_t bytes_consumed = num_bytes_consumed_ - byte_offset;
+    data.Consume(bytes_consumed);
+    data_len -= bytes_consumed;
+    byte_offset = num_bytes_consumed_;
+  }
+
   // If the frame has arrived in-order then we can process it immediately, only
   // buffering if the stream is unable to process it.
   if (!blocked_ && byte_offset == num_bytes_consumed_) {
@@ -111,7 +118,7 @@ bool QuicStreamSequencer::OnStreamFrame(const QuicStreamFrame& frame) {
           static_cast<char*>(data.iovec()[i].iov_base),
           data.iovec()[i].iov_len);
     }
-    num_bytes_consumed_ += bytes_consumed;
+    RecordBytesConsumed(bytes_consumed);
     if (MaybeCloseStream()) {
       return true;
     }
@@ -133,10 +140,8 @@ bool QuicStreamSequencer::OnStreamFrame(const QuicStreamFrame& frame) {
   for (size_t i = 0; i < data.Size(); ++i) {
     DVLOG(1) << "Buffering stream data at offset " << byte_offset;
     const iovec& iov = data.iovec()[i];
-    frames_.insert(make_pair(
-        byte_offset, string(static_cast<char*>(iov.iov_base), iov.iov_len)));
+    buffer_.Write(byte_offset, static_cast<char*>(iov.iov_base), iov.iov_len);
     byte_offset += iov.iov_len;
-    num_bytes_buffered_ += iov.iov_len;
   }
   return true;
 }
@@ -164,8 +169,7 @@ bool QuicStreamSequencer::MaybeCloseStream() {
     // Technically it's an error if num_bytes_consumed isn't exactly
     // equal, but error handling seems silly at this point.
     stream_->OnFinRead();
-    frames_.clear();
-    num_bytes_buffered_ = 0;
+    buffer_.Clear();
     return true;
   }
   return false;
@@ -173,102 +177,32 @@ bool QuicStreamSequencer::MaybeCloseStream() {
 
 int QuicStreamSequencer::GetReadableRegions(iovec* iov, size_t iov_len) {
   DCHECK(!blocked_);
-  FrameMap::iterator it = frames_.begin();
-  size_t index = 0;
-  QuicStreamOffset offset = num_bytes_consumed_;
-  while (it != frames_.end() && index < iov_len) {
-    if (it->first != offset) return index;
-
-    iov[index].iov_base = static_cast<void*>(
-        const_cast<char*>(it->second.data()));
-    iov[index].iov_len = it->second.size();
-    offset += it->second.size();
-
-    ++index;
-    ++it;
-  }
-  return index;
+  return buffer_.GetReadableRegions(iov, iov_len);
 }
 
 int QuicStreamSequencer::Readv(const struct iovec* iov, size_t iov_len) {
   DCHECK(!blocked_);
-  FrameMap::iterator it = frames_.begin();
-  size_t iov_index = 0;
-  size_t iov_offset = 0;
-  size_t frame_offset = 0;
-  size_t initial_bytes_consumed = num_bytes_consumed_;
-
-  while (iov_index < iov_len &&
-         it != frames_.end() &&
-         it->first == num_bytes_consumed_) {
-    int bytes_to_read = min(iov[iov_index].iov_len - iov_offset,
-                            it->second.size() - frame_offset);
-
-    char* iov_ptr = static_cast<char*>(iov[iov_index].iov_base) + iov_offset;
-    memcpy(iov_ptr,
-           it->second.data() + frame_offset, bytes_to_read);
-    frame_offset += bytes_to_read;
-    iov_offset += bytes_to_read;
-
-    if (iov[iov_index].iov_len == iov_offset) {
-      // We've filled this buffer.
-      iov_offset = 0;
-      ++iov_index;
-    }
-    if (it->second.size() == frame_offset) {
-      // We've copied this whole frame
-      RecordBytesConsumed(it->second.size());
-      frames_.erase(it);
-      it = frames_.begin();
-      frame_offset = 0;
-    }
-  }
-  // We've finished copying.  If we have a partial frame, update it.
-  if (frame_offset != 0) {
-    frames_.insert(make_pair(it->first + frame_offset,
-                             it->second.substr(frame_offset)));
-    frames_.erase(frames_.begin());
-    RecordBytesConsumed(frame_offset);
-  }
-  return num_bytes_consumed_ - initial_bytes_consumed;
+  size_t bytes_read = buffer_.Readv(iov, iov_len);
+  num_bytes_consumed_ += bytes_read;
+  return bytes_read;
 }
 
 void QuicStreamSequencer::MarkConsumed(size_t num_bytes_consumed) {
   DCHECK(!blocked_);
-  size_t end_offset = num_bytes_consumed_ + num_bytes_consumed;
-  while (!frames_.empty() && end_offset != num_bytes_consumed_) {
-    FrameMap::iterator it = frames_.begin();
-    if (it->first != num_bytes_consumed_) {
-      LOG(DFATAL) << "Invalid argument to MarkConsumed. "
-                  << " num_bytes_consumed_: " << num_bytes_consumed_
-                  << " end_offset: " << end_offset
-                  << " offset: " << it->first
-                  << " length: " << it->second.length();
-      stream_->Reset(QUIC_ERROR_PROCESSING_STREAM);
-      return;
-    }
-
-    if (it->first + it->second.length() <= end_offset) {
-      num_bytes_consumed_ += it->second.length();
-      num_bytes_buffered_ -= it->second.length();
-      // This chunk is entirely consumed.
-      frames_.erase(it);
-      continue;
-    }
-
-    // Partially consume this frame.
-    size_t delta = end_offset - it->first;
-    RecordBytesConsumed(delta);
-    frames_.insert(make_pair(end_offset, it->second.substr(delta)));
-    frames_.erase(it);
-    break;
+  size_t readable_bytes = buffer_.ReadableBytes();
+  if (num_bytes_consumed > readable_bytes) {
+    LOG(DFATAL) << "Invalid argument to MarkConsumed. "
+                << " num_bytes_consumed_: " << num_bytes_consumed_
+                << " end_offset: " << num_bytes_consumed_ + num_bytes_consumed
+                << " readable bytes: " << readable_bytes;
+    stream_->Reset(QUIC_ERROR_PROCESSING_STREAM);
+    return;
   }
+  RecordBytesConsumed(num_bytes_consumed);
 }
 
 bool QuicStreamSequencer::HasBytesToRead() const {
-  FrameMap::const_iterator it = frames_.begin();
-
-  return it != frames_.end() && it->first == num_bytes_consumed_;
+  return buffer_.ReadableBytes() > 0;
 }
 
 bool QuicStreamSequencer::IsClosed() const {
@@ -276,12 +210,19 @@ bool QuicStreamSequencer::IsClosed() const {
 }
 
 bool QuicStreamSequencer::IsDuplicate(const QuicStreamFrame& frame) const {
-  // A frame is duplicate if the frame offset is smaller than our bytes consumed
-  // or we have stored the frame in our map.
-  // TODO(pwestin): Is it possible that a new frame contain more data even if
-  // the offset is the same?
-  return frame.offset < num_bytes_consumed_ ||
-      frames_.find(frame.offset) != frames_.end();
+  // A frame is duplicate if all of its data has been consumed or buffered
+  // already.  An empty frame only carries a fin, and is a duplicate if it
+  // precedes the consumed data.
+  size_t data_len = frame.data.TotalBufferSize();
+  if (data_len == 0) {
+    return frame.offset < num_bytes_consumed_;
+  }
+  QuicStreamOffset end_offset = frame.offset + data_len;
+  if (end_offset <= num_bytes_consumed_) {
+    return true;
+  }
+  QuicStreamOffset start_offset = max(frame.offset, num_bytes_consumed_);
+  return buffer_.IsReceived(start_offset, end_offset - start_offset);
 }
 
 void QuicStreamSequencer::SetBlockedUntilFlush() {
@@ -290,26 +231,19 @@ void QuicStreamSequencer::SetBlockedUntilFlush() {
 
 void QuicStreamSequencer::FlushBufferedFrames() {
   blocked_ = false;
-  FrameMap::iterator it = frames_.find(num_bytes_consumed_);
-  while (it != frames_.end()) {
-    DVLOG(1) << "Flushing buffered packet at offset " << it->first;
-    string* data = &it->second;
-    size_t bytes_consumed = stream_->ProcessRawData(data->c_str(),
-                                                    data->size());
+  iovec iov;
+  while (buffer_.GetReadableRegions(&iov, 1) == 1) {
+    DVLOG(1) << "Flushing buffered data at offset " << num_bytes_consumed_;
+    size_t bytes_consumed = stream_->ProcessRawData(
+        static_cast<char*>(iov.iov_base), iov.iov_len);
     RecordBytesConsumed(bytes_consumed);
     if (MaybeCloseStream()) {
       return;
     }
-    if (bytes_consumed > data->size()) {
+    if (bytes_consumed > iov.iov_len) {
       stream_->Reset(QUIC_ERROR_PROCESSING_STREAM);  // Programming error
       return;
-    } else if (bytes_consumed == data->size()) {
-      frames_.erase(it);
-      it = frames_.find(num_bytes_consumed_);
-    } else {
-      string new_data = it->second.substr(bytes_consumed);
-      frames_.erase(it);
-      frames_.insert(make_pair(num_bytes_consumed_, new_data));
+    } else if (bytes_consumed < iov.iov_len) {
       return;
     }
   }
@@ -318,7 +252,7 @@ void QuicStreamSequencer::FlushBufferedFrames() {
 
 void QuicStreamSequencer::RecordBytesConsumed(size_t bytes_consumed) {
   num_bytes_consumed_ += bytes_consumed;
-  num_bytes_buffered_ -= bytes_consumed;
+  buffer_.AdvanceReadOffset(num_bytes_consumed_);
 }
 
 }  // namespace net
@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "net/base/iovec.h"
 #include "net/quic/quic_protocol.h"
+#include "net/quic/quic_stream_sequencer_buffer.h"
 
 using std::map;
 using std::string;
@@ -50,7 +51,9 @@ class NET_EXPORT_PRIVATE QuicStreamSequencer {
   // can handle more data.  The following three functions make that possible.
 
   // Fills in up to iov_len iovecs with the next readable regions.  Returns the
-  // number of iovs used.  Non-destructive of the underlying data.
+  // number of iovs used.  Non-destructive of the underlying data.  Each
+  // region is as large as the contiguous data in a block of the buffer, so
+  // it may span several frames.
   int GetReadableRegions(iovec* iov, size_t iov_len);
 
   // Copies the data into the iov_len buffers provided.  Returns the number of
@@ -67,18 +70,19 @@ class NET_EXPORT_PRIVATE QuicStreamSequencer {
   // Returns true if the sequencer has delivered the fin.
   bool IsClosed() const;
 
-  // Returns true if the sequencer has received this frame before.
+  // Returns true if the sequencer has received all of the data of this frame
+  // before.
   bool IsDuplicate(const QuicStreamFrame& frame) const;
 
-  // Calls |ProcessRawData| on |stream_| for each buffered frame that may
-  // be processed.
+  // Calls |ProcessRawData| on |stream_| for the buffered data that may be
+  // processed.
   void FlushBufferedFrames();
 
   // Blocks processing of frames until |FlushBufferedFrames| is called.
   void SetBlockedUntilFlush();
 
   size_t num_bytes_buffered() const {
-    return num_bytes_buffered_;
+    return buffer_.bytes_buffered();
   }
 
  private:
@@ -92,7 +96,7 @@ class NET_EXPORT_PRIVATE QuicStreamSequencer {
   bool MaybeCloseStream();
 
   // Called whenever bytes are consumed by the stream. Updates
-  // num_bytes_consumed_ and num_bytes_buffered_.
+  // num_bytes_consumed_ and frees the buffered data it consumed.
   void RecordBytesConsumed(size_t bytes_consumed);
 
   // The stream which owns this sequencer.
@@ -101,11 +105,9 @@ class NET_EXPORT_PRIVATE QuicStreamSequencer {
   // The last data consumed by the stream.
   QuicStreamOffset num_bytes_consumed_;
 
-  // TODO(alyssar) use something better than strings.
-  typedef map<QuicStreamOffset, string> FrameMap;
-
-  // Stores buffered frames (maps from sequence number -> frame data as string).
-  FrameMap frames_;
+  // Stores the data received but not consumed yet, and which ranges of it
+  // have arrived.
+  QuicStreamSequencerBuffer buffer_;
 
   // The maximum memory the sequencer can buffer.
   size_t max_frame_memory_;
@@ -117,9 +119,6 @@ class NET_EXPORT_PRIVATE QuicStreamSequencer {
   // If true, the sequencer is blocked from passing data to the stream and will
   // buffer all new incoming data until FlushBufferedFrames is called.
   bool blocked_;
-
-  // Tracks how many bytes the sequencer has buffered.
-  size_t num_bytes_buffered_;
 };
 
 }  // namespace net
@@ -0,0 +1,154 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_stream_sequencer_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/stl_util.h"
+
+using std::max;
+using std::min;
+
+namespace net {
+
+const size_t QuicStreamSequencerBuffer::kBlockSize = 8 * 1024;
+
+struct QuicStreamSequencerBuffer::Block {
+  char data[kBlockSize];
+};
+
+QuicStreamSequencerBuffer::QuicStreamSequencerBuffer()
+    : read_offset_(0),
+      bytes_buffered_(0) {
+}
+
+QuicStreamSequencerBuffer::~QuicStreamSequencerBuffer() {
+  STLDeleteValues(&blocks_);
+}
+
+void QuicStreamSequencerBuffer::Write(QuicStreamOffset offset,
+                                      const char* data,
+                                      size_t length) {
+  if (offset < read_offset_) {
+    size_t skip = min<QuicStreamOffset>(length, read_offset_ - offset);
+    offset += skip;
+    data += skip;
+    length -= skip;
+  }
+  if (length == 0) {
+    return;
+  }
+  bytes_buffered_ += received_.Add(offset, offset + length);
+
+  while (length > 0) {
+    QuicStreamOffset index = offset / kBlockSize;
+    size_t block_offset = offset % kBlockSize;
+    size_t bytes_to_copy = min(length, kBlockSize - block_offset);
+    BlockMap::iterator it = blocks_.lower_bound(index);
+    if (it == blocks_.end() || it->first != index) {
+      it = blocks_.insert(it, std::make_pair(index, new Block));
+    }
+    memcpy(it->second->data + block_offset, data, bytes_to_copy);
+    offset += bytes_to_copy;
+    data += bytes_to_copy;
+    length -= bytes_to_copy;
+  }
+}
+
+bool QuicStreamSequencerBuffer::IsReceived(QuicStreamOffset offset,
+                                           size_t length) const {
+  DCHECK_LT(0u, length);
+  return received_.Contains(offset, offset + length);
+}
+
+int QuicStreamSequencerBuffer::GetReadableRegions(iovec* iov,
+                                                  size_t iov_len) const {
+  QuicStreamOffset offset = read_offset_;
+  QuicStreamOffset end_offset = offset + ReadableBytes();
+  BlockMap::const_iterator it = blocks_.find(offset / kBlockSize);
+  size_t index = 0;
+  while (offset < end_offset && index < iov_len) {
+    DCHECK(it != blocks_.end());
+    DCHECK_EQ(offset / kBlockSize, it->first);
+    size_t block_offset = offset % kBlockSize;
+    size_t length = min<QuicStreamOffset>(kBlockSize - block_offset,
+                                          end_offset - offset);
+    iov[index].iov_base = it->second->data + block_offset;
+    iov[index].iov_len = length;
+    offset += length;
+    ++index;
+    ++it;
+  }
+  return index;
+}
+
+size_t QuicStreamSequencerBuffer::Readv(const struct iovec* iov,
+                                        size_t iov_len) {
+  iovec regions[8];
+  size_t bytes_read = 0;
+  size_t iov_index = 0;
+  size_t iov_offset = 0;
+  while (iov_index < iov_len) {
+    int num_regions = GetReadableRegions(regions, arraysize(regions));
+    if (num_regions == 0) {
+      break;
+    }
+    size_t bytes_copied = 0;
+    for (int i = 0; i < num_regions && iov_index < iov_len; ++i) {
+      size_t region_offset = 0;
+      while (region_offset < regions[i].iov_len && iov_index < iov_len) {
+        size_t bytes_to_copy = min(regions[i].iov_len - region_offset,
+                                   iov[iov_index].iov_len - iov_offset);
+        memcpy(static_cast<char*>(iov[iov_index].iov_base) + iov_offset,
+               static_cast<char*>(regions[i].iov_base) + region_offset,
+               bytes_to_copy);
+        region_offset += bytes_to_copy;
+        iov_offset += bytes_to_copy;
+        bytes_copied += bytes_to_copy;
+        if (iov_offset == iov[iov_index].iov_len) {
+          // We've filled this buffer.
+          iov_offset = 0;
+          ++iov_index;
+        }
+      }
+    }
+    AdvanceReadOffset(read_offset_ + bytes_copied);
+    bytes_read += bytes_copied;
+  }
+  return bytes_read;
+}
+
+size_t QuicStreamSequencerBuffer::ReadableBytes() const {
+  IntervalSet<QuicStreamOffset>::const_iterator it = received_.begin();
+  if (it == received_.end() || it->first != read_offset_) {
+    return 0;
+  }
+  return it->second - it->first;
+}
+
+void QuicStreamSequencerBuffer::AdvanceReadOffset(QuicStreamOffset offset) {
+  if (offset <= read_offset_) {
+    return;
+  }
+  bytes_buffered_ -= received_.Difference(read_offset_, offset);
+  read_offset_ = offset;
+  // Free the blocks which end at or before the new read offset.
+  while (!blocks_.empty() &&
+         (blocks_.begin()->first + 1) * kBlockSize <= read_offset_) {
+    delete blocks_.begin()->second;
+    blocks_.erase(blocks_.begin());
+  }
+}
+
+void QuicStreamSequencerBuffer::Clear() {
+  STLDeleteValues(&blocks_);
+  received_.clear();
+  bytes_buffered_ = 0;
+}
+
+}  // namespace net
@@ -0,0 +1,89 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_QUIC_STREAM_SEQUENCER_BUFFER_H_
+#define NET_QUIC_QUIC_STREAM_SEQUENCER_BUFFER_H_
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "net/base/interval_set.h"
+#include "net/base/iovec.h"
+#include "net/base/net_export.h"
+#include "net/quic/quic_protocol.h"
+
+namespace net {
+
+// Receive buffer for the data of a stream which arrives out of order.  Data
+// is copied into fixed size blocks, which are allocated as they are first
+// written and freed once the reader has moved past them, and the received
+// byte ranges are tracked in an interval set.  Writing and looking up data
+// takes logarithmic time in the number of blocks and gaps, and readers get
+// the contiguous data at the read offset as a few large regions.
+class NET_EXPORT_PRIVATE QuicStreamSequencerBuffer {
+ public:
+  // The size of the blocks data is copied into.
+  static const size_t kBlockSize;
+
+  QuicStreamSequencerBuffer();
+  ~QuicStreamSequencerBuffer();
+
+  // Copies |length| bytes of |data| to the buffer at stream offset |offset|.
+  // Any part of it which precedes the read offset is ignored, and any part
+  // which has already been received is overwritten.
+  void Write(QuicStreamOffset offset, const char* data, size_t length);
+
+  // Returns true if all of [offset, offset + length) has been written to the
+  // buffer and not read yet.
+  bool IsReceived(QuicStreamOffset offset, size_t length) const;
+
+  // Fills in up to |iov_len| iovecs with the contiguous data at the read
+  // offset, one per block.  Returns the number of iovecs used.
+  int GetReadableRegions(iovec* iov, size_t iov_len) const;
+
+  // Copies the contiguous data at the read offset into the |iov_len| buffers
+  // provided, and moves the read offset past it.  Returns the number of bytes
+  // read.
+  size_t Readv(const struct iovec* iov, size_t iov_len);
+
+  // Returns the number of contiguous bytes at the read offset.
+  size_t ReadableBytes() const;
+
+  // Moves the read offset forward to |offset|, freeing the data before it.
+  void AdvanceReadOffset(QuicStreamOffset offset);
+
+  // Frees all buffered data.
+  void Clear();
+
+  QuicStreamOffset read_offset() const { return read_offset_; }
+
+  // Returns the number of bytes received past the read offset.
+  size_t bytes_buffered() const { return bytes_buffered_; }
+
+  // Returns the number of blocks currently allocated.
+  size_t num_blocks() const { return blocks_.size(); }
+
+ private:
+  struct Block;
+
+  // Maps the index of each allocated block, which is its stream offset
+  // divided by kBlockSize, to the block.
+  typedef std::map<QuicStreamOffset, Block*> BlockMap;
+
+  // The byte ranges which have been written and not read yet.
+  IntervalSet<QuicStreamOffset> received_;
+
+  BlockMap blocks_;
+
+  // The offset of the first byte which has not been read.
+  QuicStreamOffset read_offset_;
+
+  size_t bytes_buffered_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicStreamSequencerBuffer);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_QUIC_STREAM_SEQUENCER_BUFFER_H_
@@ -24,6 +24,7 @@ using std::vector;
 using testing::_;
 using testing::AnyNumber;
 using testing::InSequence;
+using testing::Invoke;
 using testing::Return;
 using testing::StrEq;
 
@@ -62,7 +63,7 @@ class QuicStreamSequencerPeer : public QuicStreamSequencer {
     max_frame_memory_ = limit;
   }
   uint64 num_bytes_consumed() const { return num_bytes_consumed_; }
-  const FrameMap* frames() const { return &frames_; }
+  const QuicStreamSequencerBuffer* buffer() const { return &buffer_; }
   QuicStreamOffset close_offset() const { return close_offset_; }
 };
 
@@ -72,8 +73,14 @@ class MockStream : public ReliableQuicStream {
       : ReliableQuicStream(id, session) {
   }
 
+  // The buffered data handed to the stream isn't NUL terminated, so it is
+  // matched as a string.
+  virtual uint32 ProcessRawData(const char* data, uint32 data_len) OVERRIDE {
+    return ProcessData(string(data, data_len));
+  }
+
   MOCK_METHOD0(OnFinRead, void());
-  MOCK_METHOD2(ProcessRawData, uint32(const char* data, uint32 data_len));
+  MOCK_METHOD1(ProcessData, uint32(const string& data));
   MOCK_METHOD2(CloseConnectionWithDetails, void(QuicErrorCode error,
                                                 const string& details));
   MOCK_METHOD1(Reset, void(QuicRstStreamErrorCode error));
@@ -142,16 +149,16 @@ class QuicStreamSequencerTest : public ::testing::Test {
 };
 
 TEST_F(QuicStreamSequencerTest, RejectOldFrame) {
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3))
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc")))
       .WillOnce(Return(3));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(3u, sequencer_->num_bytes_consumed());
   // Ignore this - it matches a past sequence number and we should not see it
   // again.
   EXPECT_TRUE(sequencer_->OnFrame(0, "def"));
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
 }
 
 TEST_F(QuicStreamSequencerTest, RejectOverlyLargeFrame) {
@@ -170,22 +177,22 @@ TEST_F(QuicStreamSequencerTest, DropFramePastBuffering) {
 }
 
 TEST_F(QuicStreamSequencerTest, RejectBufferedFrame) {
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc")));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
   // Ignore this - it matches a buffered frame.
   // Right now there's no checking that the payload is consistent.
   EXPECT_TRUE(sequencer_->OnFrame(0, "def"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
 }
 
 TEST_F(QuicStreamSequencerTest, FullFrameConsumed) {
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(3u, sequencer_->num_bytes_consumed());
 }
 
@@ -193,15 +200,15 @@ TEST_F(QuicStreamSequencerTest, BlockedThenFullFrameConsumed) {
   sequencer_->SetBlockedUntilFlush();
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
 
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
   sequencer_->FlushBufferedFrames();
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(3u, sequencer_->num_bytes_consumed());
 
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("def"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("def"))).WillOnce(Return(3));
   EXPECT_CALL(stream_, OnFinRead());
   EXPECT_TRUE(sequencer_->OnFinFrame(3, "def"));
 }
@@ -210,13 +217,13 @@ TEST_F(QuicStreamSequencerTest, BlockedThenFullFrameAndFinConsumed) {
   sequencer_->SetBlockedUntilFlush();
 
   EXPECT_TRUE(sequencer_->OnFinFrame(0, "abc"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
 
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
   EXPECT_CALL(stream_, OnFinRead());
   sequencer_->FlushBufferedFrames();
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(3u, sequencer_->num_bytes_consumed());
 }
 
@@ -224,65 +231,64 @@ TEST_F(QuicStreamSequencerTest, EmptyFrame) {
   EXPECT_CALL(stream_,
               CloseConnectionWithDetails(QUIC_INVALID_STREAM_FRAME, _));
   EXPECT_FALSE(sequencer_->OnFrame(0, ""));
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
 }
 
 TEST_F(QuicStreamSequencerTest, EmptyFinFrame) {
   EXPECT_CALL(stream_, OnFinRead());
   EXPECT_TRUE(sequencer_->OnFinFrame(0, ""));
-  EXPECT_EQ(0u, sequencer_->frames()->size());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
 }
 
 TEST_F(QuicStreamSequencerTest, PartialFrameConsumed) {
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(2));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(2));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(1u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(2u, sequencer_->num_bytes_consumed());
-  EXPECT_EQ("c", sequencer_->frames()->find(2)->second);
+  const char* expected[] = {"c"};
+  ASSERT_TRUE(VerifyReadableRegions(expected, arraysize(expected)));
 }
 
 TEST_F(QuicStreamSequencerTest, NextxFrameNotConsumed) {
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(0));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
-  EXPECT_EQ("abc", sequencer_->frames()->find(0)->second);
+  const char* expected[] = {"abc"};
+  ASSERT_TRUE(VerifyReadableRegions(expected, arraysize(expected)));
 }
 
 TEST_F(QuicStreamSequencerTest, FutureFrameNotProcessed) {
   EXPECT_TRUE(sequencer_->OnFrame(3, "abc"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
-  EXPECT_EQ("abc", sequencer_->frames()->find(3)->second);
+  EXPECT_FALSE(sequencer_->HasBytesToRead());
+  EXPECT_TRUE(sequencer_->buffer()->IsReceived(3, 3));
 }
 
 TEST_F(QuicStreamSequencerTest, OutOfOrderFrameProcessed) {
   // Buffer the first
   EXPECT_TRUE(sequencer_->OnFrame(6, "ghi"));
-  EXPECT_EQ(1u, sequencer_->frames()->size());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
   EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
   // Buffer the second
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
-  EXPECT_EQ(2u, sequencer_->frames()->size());
   EXPECT_EQ(0u, sequencer_->num_bytes_consumed());
   EXPECT_EQ(6u, sequencer_->num_bytes_buffered());
 
+  // The buffered frames are contiguous, so they are processed together.
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("def"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("ghi"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("defghi"))).WillOnce(Return(6));
 
   // Ack right away
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
   EXPECT_EQ(9u, sequencer_->num_bytes_consumed());
   EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
-
-  EXPECT_EQ(0u, sequencer_->frames()->size());
 }
 
 TEST_F(QuicStreamSequencerTest, OutOfOrderFramesProcessedWithBuffering) {
@@ -297,7 +303,7 @@ TEST_F(QuicStreamSequencerTest, OutOfOrderFramesProcessedWithBuffering) {
   EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
 
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
 
   // Ack right away
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
@@ -309,13 +315,11 @@ TEST_F(QuicStreamSequencerTest, OutOfOrderFramesProcessedWithBuffering) {
   EXPECT_EQ(3u, sequencer_->num_bytes_consumed());
   EXPECT_EQ(6u, sequencer_->num_bytes_buffered());
 
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("def"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("ghi"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("jkl"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("def"))).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("ghijkl"))).WillOnce(Return(6));
 
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
   EXPECT_EQ(12u, sequencer_->num_bytes_consumed());
-  EXPECT_EQ(0u, sequencer_->frames()->size());
   EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
 }
 
@@ -339,9 +343,9 @@ TEST_F(QuicStreamSequencerTest, OutOfOrderFramesBlockingWithReadv) {
   // Push pqr - process
 
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("def"), 3)).WillOnce(Return(0));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("pqr"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("def"))).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("pqr"))).WillOnce(Return(3));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
@@ -375,9 +379,9 @@ TEST_F(QuicStreamSequencerTest, OutOfOrderFramesBlockignWithGetReadableRegion) {
   sequencer_->SetMemoryLimit(9);
 
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("def"), 3)).WillOnce(Return(0));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("pqr"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("def"))).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("pqr"))).WillOnce(Return(3));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
@@ -389,7 +393,7 @@ TEST_F(QuicStreamSequencerTest, OutOfOrderFramesBlockignWithGetReadableRegion) {
   EXPECT_EQ(9u, sequencer_->num_bytes_buffered());
 
   // Read 3 bytes.
-  const char* expected[] = {"def", "ghi", "jkl"};
+  const char* expected[] = {"defghijkl"};
   ASSERT_TRUE(VerifyReadableRegions(expected, arraysize(expected)));
   char buffer[9];
   iovec read_iov = { &buffer[0], 3 };
@@ -401,7 +405,7 @@ TEST_F(QuicStreamSequencerTest, OutOfOrderFramesBlockignWithGetReadableRegion) {
   EXPECT_EQ(9u, sequencer_->num_bytes_buffered());
 
   // Read the remaining 9 bytes.
-  const char* expected2[] = {"ghi", "jkl", "mno"};
+  const char* expected2[] = {"ghijklmno"};
   ASSERT_TRUE(VerifyReadableRegions(expected2, arraysize(expected2)));
   read_iov.iov_len = 9;
   ASSERT_EQ(9, sequencer_->Readv(&read_iov, 1));
@@ -415,7 +419,7 @@ TEST_F(QuicStreamSequencerTest, MarkConsumed) {
   sequencer_->SetMemoryLimit(9);
 
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(0));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
@@ -425,20 +429,20 @@ TEST_F(QuicStreamSequencerTest, MarkConsumed) {
   EXPECT_EQ(9u, sequencer_->num_bytes_buffered());
 
   // Peek into the data.
-  const char* expected[] = {"abc", "def", "ghi"};
+  const char* expected[] = {"abcdefghi"};
   ASSERT_TRUE(VerifyReadableRegions(expected, arraysize(expected)));
 
   // Consume 1 byte.
   sequencer_->MarkConsumed(1);
   // Verify data.
-  const char* expected2[] = {"bc", "def", "ghi"};
+  const char* expected2[] = {"bcdefghi"};
   ASSERT_TRUE(VerifyReadableRegions(expected2, arraysize(expected2)));
   EXPECT_EQ(8u, sequencer_->num_bytes_buffered());
 
   // Consume 2 bytes.
   sequencer_->MarkConsumed(2);
   // Verify data.
-  const char* expected3[] = {"def", "ghi"};
+  const char* expected3[] = {"defghi"};
   ASSERT_TRUE(VerifyReadableRegions(expected3, arraysize(expected3)));
   EXPECT_EQ(6u, sequencer_->num_bytes_buffered());
 
@@ -451,9 +455,7 @@ TEST_F(QuicStreamSequencerTest, MarkConsumed) {
 }
 
 TEST_F(QuicStreamSequencerTest, MarkConsumedError) {
-  // TODO(rch): enable when chromium supports EXPECT_DFATAL.
-  /*
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(0));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
   EXPECT_TRUE(sequencer_->OnFrame(9, "jklmnopqrstuvwxyz"));
@@ -467,21 +469,66 @@ TEST_F(QuicStreamSequencerTest, MarkConsumedError) {
   // and expect the stream to be closed.
   EXPECT_CALL(stream_, Reset(QUIC_ERROR_PROCESSING_STREAM));
   EXPECT_DFATAL(sequencer_->MarkConsumed(4),
-                "Invalid argument to MarkConsumed.  num_bytes_consumed_: 3 "
-                "end_offset: 4 offset: 9 length: 17");
-  */
+                "Invalid argument to MarkConsumed.  num_bytes_consumed_: 0 "
+                "end_offset: 4 readable bytes: 3");
+}
+
+TEST_F(QuicStreamSequencerTest, OverlappingFramesProcessed) {
+  InSequence s;
+  EXPECT_CALL(stream_, ProcessData(StrEq("abcd"))).WillOnce(Return(4));
+  EXPECT_CALL(stream_, ProcessData(StrEq("ef"))).WillOnce(Return(2));
+  EXPECT_CALL(stream_, ProcessData(StrEq("gh"))).WillOnce(Return(2));
+
+  EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
+  EXPECT_EQ(3u, sequencer_->num_bytes_buffered());
+
+  // Only the part of the buffered frame which follows this one is left to
+  // process.
+  EXPECT_TRUE(sequencer_->OnFrame(0, "abcd"));
+  EXPECT_EQ(6u, sequencer_->num_bytes_consumed());
+  EXPECT_EQ(0u, sequencer_->num_bytes_buffered());
+
+  // The data of this frame which was already consumed is dropped.
+  EXPECT_FALSE(sequencer_->IsDuplicate(
+      QuicStreamFrame(1, false, 5, MakeIOVector("fgh"))));
+  EXPECT_TRUE(sequencer_->OnFrame(5, "fgh"));
+  EXPECT_EQ(8u, sequencer_->num_bytes_consumed());
+
+  EXPECT_TRUE(sequencer_->IsDuplicate(
+      QuicStreamFrame(1, false, 4, MakeIOVector("efgh"))));
+}
+
+TEST_F(QuicStreamSequencerTest, BufferFreesConsumedBlocks) {
+  const size_t kBlockSize = QuicStreamSequencerBuffer::kBlockSize;
+  string data(2 * kBlockSize, 'a');
+  EXPECT_CALL(stream_, ProcessData(_)).WillOnce(Return(0));
+
+  EXPECT_TRUE(sequencer_->OnFrame(0, data.c_str()));
+  EXPECT_EQ(data.size(), sequencer_->num_bytes_buffered());
+  EXPECT_EQ(2u, sequencer_->buffer()->num_blocks());
+
+  // Regions don't span blocks.
+  iovec iov[3];
+  ASSERT_EQ(2, sequencer_->GetReadableRegions(iov, arraysize(iov)));
+  EXPECT_EQ(kBlockSize, iov[0].iov_len);
+  EXPECT_EQ(kBlockSize, iov[1].iov_len);
+
+  // Blocks are freed as soon as they are consumed.
+  sequencer_->MarkConsumed(kBlockSize + 1);
+  EXPECT_EQ(1u, sequencer_->buffer()->num_blocks());
+  EXPECT_EQ(kBlockSize - 1, sequencer_->num_bytes_buffered());
 }
 
 TEST_F(QuicStreamSequencerTest, MarkConsumedWithMissingPacket) {
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(0));
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
   // Missing packet: 6, ghi
   EXPECT_TRUE(sequencer_->OnFrame(9, "jkl"));
 
-  const char* expected[] = {"abc", "def"};
+  const char* expected[] = {"abcdef"};
   ASSERT_TRUE(VerifyReadableRegions(expected, arraysize(expected)));
 
   sequencer_->MarkConsumed(6);
@@ -490,7 +537,7 @@ TEST_F(QuicStreamSequencerTest, MarkConsumedWithMissingPacket) {
 TEST_F(QuicStreamSequencerTest, BasicHalfCloseOrdered) {
   InSequence s;
 
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
   EXPECT_CALL(stream_, OnFinRead());
   EXPECT_TRUE(sequencer_->OnFinFrame(0, "abc"));
 
@@ -501,8 +548,8 @@ TEST_F(QuicStreamSequencerTest, BasicHalfCloseUnorderedWithFlush) {
   sequencer_->OnFinFrame(6, "");
   EXPECT_EQ(6u, sequencer_->close_offset());
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("def"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("def"))).WillOnce(Return(3));
   EXPECT_CALL(stream_, OnFinRead());
 
   EXPECT_TRUE(sequencer_->OnFrame(3, "def"));
@@ -513,7 +560,7 @@ TEST_F(QuicStreamSequencerTest, BasicHalfUnordered) {
   sequencer_->OnFinFrame(3, "");
   EXPECT_EQ(3u, sequencer_->close_offset());
   InSequence s;
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(3));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(3));
   EXPECT_CALL(stream_, OnFinRead());
 
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
@@ -527,7 +574,7 @@ TEST_F(QuicStreamSequencerTest, TerminateWithReadv) {
 
   EXPECT_FALSE(sequencer_->IsClosed());
 
-  EXPECT_CALL(stream_, ProcessRawData(StrEq("abc"), 3)).WillOnce(Return(0));
+  EXPECT_CALL(stream_, ProcessData(StrEq("abc"))).WillOnce(Return(0));
   EXPECT_TRUE(sequencer_->OnFrame(0, "abc"));
 
   iovec iov = { &buffer[0], 3 };
@@ -585,6 +632,11 @@ class QuicSequencerRandomTest : public QuicStreamSequencerTest {
     return to_process;
   }
 
+  uint32 ProcessAll(const string& data) {
+    output_.append(data);
+    return data.size();
+  }
+
   string output_;
   FrameList list_;
 };
@@ -592,12 +644,8 @@ class QuicSequencerRandomTest : public QuicStreamSequencerTest {
 // All frames are processed as soon as we have sequential data.
 // Infinite buffering, so all frames are acked right away.
 TEST_F(QuicSequencerRandomTest, RandomFramesNoDroppingNoBackup) {
-  InSequence s;
-  for (size_t i = 0; i < list_.size(); ++i) {
-    string* data = &list_[i].second;
-    EXPECT_CALL(stream_, ProcessRawData(StrEq(*data), data->size()))
-        .WillOnce(Return(data->size()));
-  }
+  EXPECT_CALL(stream_, ProcessData(_))
+      .WillRepeatedly(Invoke(this, &QuicSequencerRandomTest::ProcessAll));
 
   while (!list_.empty()) {
     int index = OneToN(list_.size()) - 1;
@@ -608,6 +656,7 @@ TEST_F(QuicSequencerRandomTest, RandomFramesNoDroppingNoBackup) {
 
     list_.erase(list_.begin() + index);
   }
+  EXPECT_EQ(kPayload, output_);
 }
 
 // All frames are processed as soon as we have sequential data.
@@ -615,12 +664,8 @@ TEST_F(QuicSequencerRandomTest, RandomFramesNoDroppingNoBackup) {
 TEST_F(QuicSequencerRandomTest, RandomFramesDroppingNoBackup) {
   sequencer_->SetMemoryLimit(26);
 
-  InSequence s;
-  for (size_t i = 0; i < list_.size(); ++i) {
-    string* data = &list_[i].second;
-    EXPECT_CALL(stream_, ProcessRawData(StrEq(*data), data->size()))
-        .WillOnce(Return(data->size()));
-  }
+  EXPECT_CALL(stream_, ProcessData(_))
+      .WillRepeatedly(Invoke(this, &QuicSequencerRandomTest::ProcessAll));
 
   while (!list_.empty()) {
     int index = OneToN(list_.size()) - 1;
@@ -633,6 +678,7 @@ TEST_F(QuicSequencerRandomTest, RandomFramesDroppingNoBackup) {
       list_.erase(list_.begin() + index);
     }
   }
+  EXPECT_EQ(kPayload, output_);
 }
 
 }  // namespace
@@ -5,16 +5,24 @@
 #include "net/quic/quic_unacked_packet_map.h"
 
 #include "base/logging.h"
-#include "base/stl_util.h"
 #include "net/quic/quic_connection_stats.h"
-#include "net/quic/quic_utils_chromium.h"
 
+using std::make_pair;
 using std::max;
 
 namespace net {
 
 #define ENDPOINT (is_server_ ? "Server: " : " Client: ")
 
+namespace {
+
+// Removed packets leave a hole, a default TransmissionInfo, behind.
+bool IsHole(const QuicUnackedPacketMap::TransmissionInfo& transmission_info) {
+  return transmission_info.all_transmissions == NULL;
+}
+
+}  // namespace
+
 QuicUnackedPacketMap::TransmissionInfo::TransmissionInfo()
     : retransmittable_frames(NULL),
       sequence_number_length(PACKET_1BYTE_SEQUENCE_NUMBER),
@@ -53,15 +61,37 @@ QuicUnackedPacketMap::TransmissionInfo::TransmissionInfo(
   all_transmissions->insert(sequence_number);
 }
 
+QuicUnackedPacketMap::const_iterator::const_iterator(
+    const UnackedPacketMap* packets,
+    size_t index)
+    : packets_(packets),
+      index_(index) {
+  // The first and last entries are never holes, but lower_bound may land on
+  // one in between.
+  while (index_ < packets_->size() && IsHole((*packets_)[index_].second)) {
+    ++index_;
+  }
+}
+
+QuicUnackedPacketMap::const_iterator&
+QuicUnackedPacketMap::const_iterator::operator++() {
+  ++index_;
+  while (index_ < packets_->size() && IsHole((*packets_)[index_].second)) {
+    ++index_;
+  }
+  return *this;
+}
+
 QuicUnackedPacketMap::QuicUnackedPacketMap(bool is_server)
     : largest_sent_packet_(0),
+      num_unacked_packets_(0),
+      num_pending_packets_(0),
       bytes_in_flight_(0),
       is_server_(is_server) {
 }
 
 QuicUnackedPacketMap::~QuicUnackedPacketMap() {
-  for (UnackedPacketMap::iterator it = unacked_packets_.begin();
-       it != unacked_packets_.end(); ++it) {
+  for (const_iterator it = begin(); it != end(); ++it) {
     delete it->second.retransmittable_frames;
     // Only delete all_transmissions once, for the newest packet.
     if (it->first == *it->second.all_transmissions->rbegin()) {
@@ -74,31 +104,40 @@ QuicUnackedPacketMap::~QuicUnackedPacketMap() {
 // sent in order and the connection tracks RetransmittableFrames for longer.
 void QuicUnackedPacketMap::AddPacket(
     const SerializedPacket& serialized_packet) {
+  QuicPacketSequenceNumber sequence_number = serialized_packet.sequence_number;
   if (!unacked_packets_.empty()) {
-    bool is_old_packet = unacked_packets_.rbegin()->first >=
-        serialized_packet.sequence_number;
+    bool is_old_packet = unacked_packets_.back().first >= sequence_number;
     LOG_IF(DFATAL, is_old_packet) << "Old packet serialized: "
-                                  << serialized_packet.sequence_number
+                                  << sequence_number
                                   << " vs: "
-                                  << unacked_packets_.rbegin()->first;
+                                  << unacked_packets_.back().first;
+    if (is_old_packet) {
+      return;
+    }
+    // Fill in holes for any sequence numbers which were skipped.
+    for (QuicPacketSequenceNumber hole = unacked_packets_.back().first + 1;
+         hole < sequence_number; ++hole) {
+      unacked_packets_.push_back(make_pair(hole, TransmissionInfo()));
+    }
   }
 
-  unacked_packets_[serialized_packet.sequence_number] =
+  unacked_packets_.push_back(make_pair(
+      sequence_number,
       TransmissionInfo(serialized_packet.retransmittable_frames,
-                       serialized_packet.sequence_number,
-                       serialized_packet.sequence_number_length);
+                       sequence_number,
+                       serialized_packet.sequence_number_length)));
+  ++num_unacked_packets_;
 }
 
 void QuicUnackedPacketMap::OnRetransmittedPacket(
     QuicPacketSequenceNumber old_sequence_number,
     QuicPacketSequenceNumber new_sequence_number) {
-  DCHECK(ContainsKey(unacked_packets_, old_sequence_number));
+  DCHECK(IsUnacked(old_sequence_number));
   DCHECK(unacked_packets_.empty() ||
-         unacked_packets_.rbegin()->first < new_sequence_number);
+         unacked_packets_.back().first < new_sequence_number);
 
   // TODO(ianswett): Discard and lose the packet lazily instead of immediately.
-  TransmissionInfo* transmission_info =
-      FindOrNull(unacked_packets_, old_sequence_number);
+  TransmissionInfo* transmission_info = Find(old_sequence_number);
   RetransmittableFrames* frames = transmission_info->retransmittable_frames;
   LOG_IF(DFATAL, frames == NULL) << "Attempt to retransmit packet with no "
                                  << "retransmittable frames: "
@@ -107,25 +146,38 @@ void QuicUnackedPacketMap::OnRetransmittedPacket(
   // We keep the old packet in the unacked packet list until it, or one of
   // the retransmissions of it are acked.
   transmission_info->retransmittable_frames = NULL;
-  unacked_packets_[new_sequence_number] =
+  for (QuicPacketSequenceNumber hole = unacked_packets_.back().first + 1;
+       hole < new_sequence_number; ++hole) {
+    unacked_packets_.push_back(make_pair(hole, TransmissionInfo()));
+  }
+  // Copy what's needed before push_back, which invalidates
+  // |transmission_info|.
+  QuicSequenceNumberLength sequence_number_length =
+      transmission_info->sequence_number_length;
+  SequenceNumberSet* all_transmissions = transmission_info->all_transmissions;
+  unacked_packets_.push_back(make_pair(
+      new_sequence_number,
       TransmissionInfo(frames,
                        new_sequence_number,
-                       transmission_info->sequence_number_length,
-                       transmission_info->all_transmissions);
+                       sequence_number_length,
+                       all_transmissions)));
+  ++num_unacked_packets_;
 }
 
 void QuicUnackedPacketMap::ClearPreviousRetransmissions(size_t num_to_clear) {
-  UnackedPacketMap::iterator it = unacked_packets_.begin();
-  while (it != unacked_packets_.end() && num_to_clear > 0) {
-    QuicPacketSequenceNumber sequence_number = it->first;
+  while (!unacked_packets_.empty() && num_to_clear > 0) {
+    // The front is never a hole.
+    QuicPacketSequenceNumber sequence_number = unacked_packets_.front().first;
+    const TransmissionInfo& transmission_info =
+        unacked_packets_.front().second;
     // If this is a pending packet, or has retransmittable data, then there is
     // no point in clearing out any further packets, because they would not
     // affect the high water mark.
-    if (it->second.pending || it->second.retransmittable_frames != NULL) {
+    if (transmission_info.pending ||
+        transmission_info.retransmittable_frames != NULL) {
       break;
     }
 
-    ++it;
     RemovePacket(sequence_number);
     --num_to_clear;
   }
@@ -133,8 +185,7 @@ void QuicUnackedPacketMap::ClearPreviousRetransmissions(size_t num_to_clear) {
 
 bool QuicUnackedPacketMap::HasRetransmittableFrames(
     QuicPacketSequenceNumber sequence_number) const {
-  const TransmissionInfo* transmission_info =
-      FindOrNull(unacked_packets_, sequence_number);
+  const TransmissionInfo* transmission_info = Find(sequence_number);
   if (transmission_info == NULL) {
     return false;
   }
@@ -144,45 +195,50 @@ bool QuicUnackedPacketMap::HasRetransmittableFrames(
 
 void QuicUnackedPacketMap::NackPacket(QuicPacketSequenceNumber sequence_number,
                                       size_t min_nacks) {
-  UnackedPacketMap::iterator it = unacked_packets_.find(sequence_number);
-  if (it == unacked_packets_.end()) {
+  TransmissionInfo* transmission_info = Find(sequence_number);
+  if (transmission_info == NULL) {
     LOG(DFATAL) << "NackPacket called for packet that is not unacked: "
                 << sequence_number;
     return;
   }
 
-  it->second.nack_count = max(min_nacks, it->second.nack_count + 1);
+  transmission_info->nack_count =
+      max(min_nacks, transmission_info->nack_count + 1);
 }
 
 void QuicUnackedPacketMap::RemovePacket(
     QuicPacketSequenceNumber sequence_number) {
   DVLOG(1) << __FUNCTION__ << " " << sequence_number;
-  UnackedPacketMap::iterator it = unacked_packets_.find(sequence_number);
-  if (it == unacked_packets_.end()) {
+  TransmissionInfo* transmission_info = Find(sequence_number);
+  if (transmission_info == NULL) {
     LOG(DFATAL) << "packet is not unacked: " << sequence_number;
     return;
   }
-  const TransmissionInfo& transmission_info = it->second;
-  transmission_info.all_transmissions->erase(sequence_number);
-  if (transmission_info.all_transmissions->empty()) {
-    delete transmission_info.all_transmissions;
+  if (transmission_info->pending) {
+    // Keep the bytes in flight right if a pending packet is removed.
+    SetNotPending(sequence_number);
   }
-  if (transmission_info.retransmittable_frames != NULL) {
-    delete transmission_info.retransmittable_frames;
+  transmission_info->all_transmissions->erase(sequence_number);
+  if (transmission_info->all_transmissions->empty()) {
+    delete transmission_info->all_transmissions;
   }
-  unacked_packets_.erase(it);
+  if (transmission_info->retransmittable_frames != NULL) {
+    delete transmission_info->retransmittable_frames;
+  }
+  *transmission_info = TransmissionInfo();
+  --num_unacked_packets_;
+  TrimHoles();
 }
 
 void QuicUnackedPacketMap::NeuterPacket(
     QuicPacketSequenceNumber sequence_number) {
-  DVLOG(1) << __FUNCTION__ << " " << sequence_number << " pending? "
-           << unacked_packets_[sequence_number].pending;
-  UnackedPacketMap::iterator it = unacked_packets_.find(sequence_number);
-  if (it == unacked_packets_.end()) {
+  TransmissionInfo* transmission_info = Find(sequence_number);
+  if (transmission_info == NULL) {
     LOG(DFATAL) << "packet is not unacked: " << sequence_number;
     return;
   }
-  TransmissionInfo* transmission_info = &it->second;
+  DVLOG(1) << __FUNCTION__ << " " << sequence_number << " pending? "
+           << transmission_info->pending;
   if (transmission_info->all_transmissions->size() > 1) {
     transmission_info->all_transmissions->erase(sequence_number);
     transmission_info->all_transmissions = new SequenceNumberSet();
@@ -196,44 +252,45 @@ void QuicUnackedPacketMap::NeuterPacket(
 
 bool QuicUnackedPacketMap::IsUnacked(
     QuicPacketSequenceNumber sequence_number) const {
-  return ContainsKey(unacked_packets_, sequence_number);
+  return Find(sequence_number) != NULL;
 }
 
 bool QuicUnackedPacketMap::IsPending(
     QuicPacketSequenceNumber sequence_number) const {
-  const TransmissionInfo* transmission_info =
-      FindOrNull(unacked_packets_, sequence_number);
+  const TransmissionInfo* transmission_info = Find(sequence_number);
   return transmission_info != NULL && transmission_info->pending;
 }
 
 void QuicUnackedPacketMap::SetNotPending(
     QuicPacketSequenceNumber sequence_number) {
-  if (unacked_packets_[sequence_number].pending) {
-    LOG_IF(DFATAL,
-           bytes_in_flight_ < unacked_packets_[sequence_number].bytes_sent);
-    bytes_in_flight_ -= unacked_packets_[sequence_number].bytes_sent;
-    unacked_packets_[sequence_number].pending = false;
+  TransmissionInfo* transmission_info = Find(sequence_number);
+  if (transmission_info == NULL) {
+    LOG(DFATAL) << "SetNotPending called for packet that is not unacked: "
+                << sequence_number;
+    return;
+  }
+  if (transmission_info->pending) {
+    LOG_IF(DFATAL, bytes_in_flight_ < transmission_info->bytes_sent);
+    bytes_in_flight_ -= transmission_info->bytes_sent;
+    transmission_info->pending = false;
+    --num_pending_packets_;
   }
 }
 
 bool QuicUnackedPacketMap::HasUnackedPackets() const {
-  return !unacked_packets_.empty();
+  return num_unacked_packets_ > 0;
 }
 
 bool QuicUnackedPacketMap::HasPendingPackets() const {
-  for (UnackedPacketMap::const_reverse_iterator it =
-           unacked_packets_.rbegin(); it != unacked_packets_.rend(); ++it) {
-    if (it->second.pending) {
-      return true;
-    }
-  }
-  return false;
+  return num_pending_packets_ > 0;
 }
 
 const QuicUnackedPacketMap::TransmissionInfo&
     QuicUnackedPacketMap::GetTransmissionInfo(
         QuicPacketSequenceNumber sequence_number) const {
-  return unacked_packets_.find(sequence_number)->second;
+  const TransmissionInfo* transmission_info = Find(sequence_number);
+  DCHECK(transmission_info != NULL);
+  return *transmission_info;
 }
 
 QuicTime QuicUnackedPacketMap::GetLastPacketSentTime() const {
@@ -251,11 +308,11 @@ QuicTime QuicUnackedPacketMap::GetLastPacketSentTime() const {
 }
 
 QuicTime QuicUnackedPacketMap::GetFirstPendingPacketSentTime() const {
-  UnackedPacketMap::const_iterator it = unacked_packets_.begin();
-  while (it != unacked_packets_.end() && !it->second.pending) {
+  const_iterator it = begin();
+  while (it != end() && !it->second.pending) {
     ++it;
   }
-  if (it == unacked_packets_.end()) {
+  if (it == end()) {
     LOG(DFATAL) << "No pending packets";
     return QuicTime::Zero();
   }
@@ -263,21 +320,11 @@ QuicTime QuicUnackedPacketMap::GetFirstPendingPacketSentTime() const {
 }
 
 size_t QuicUnackedPacketMap::GetNumUnackedPackets() const {
-  return unacked_packets_.size();
+  return num_unacked_packets_;
 }
 
 bool QuicUnackedPacketMap::HasMultiplePendingPackets() const {
-  size_t num_pending = 0;
-  for (UnackedPacketMap::const_reverse_iterator it = unacked_packets_.rbegin();
-       it != unacked_packets_.rend(); ++it) {
-    if (it->second.pending) {
-      ++num_pending;
-    }
-    if (num_pending > 1) {
-      return true;
-    }
-  }
-  return false;
+  return num_pending_packets_ > 1;
 }
 
 bool QuicUnackedPacketMap::HasUnackedRetransmittableFrames() const {
@@ -292,8 +339,7 @@ bool QuicUnackedPacketMap::HasUnackedRetransmittableFrames() const {
 
 size_t QuicUnackedPacketMap::GetNumRetransmittablePackets() const {
   size_t num_unacked_packets = 0;
-  for (UnackedPacketMap::const_iterator it = unacked_packets_.begin();
-       it != unacked_packets_.end(); ++it) {
+  for (const_iterator it = begin(); it != end(); ++it) {
     if (it->second.retransmittable_frames != NULL) {
       ++num_unacked_packets;
     }
@@ -308,13 +354,12 @@ QuicUnackedPacketMap::GetLeastUnackedSentPacket() const {
     return 0;
   }
 
-  return unacked_packets_.begin()->first;
+  return unacked_packets_.front().first;
 }
 
 SequenceNumberSet QuicUnackedPacketMap::GetUnackedPackets() const {
   SequenceNumberSet unacked_packets;
-  for (UnackedPacketMap::const_iterator it = unacked_packets_.begin();
-       it != unacked_packets_.end(); ++it) {
+  for (const_iterator it = begin(); it != end(); ++it) {
     unacked_packets.insert(it->first);
   }
   return unacked_packets;
@@ -324,19 +369,60 @@ void QuicUnackedPacketMap::SetPending(QuicPacketSequenceNumber sequence_number,
                                       QuicTime sent_time,
                                       QuicByteCount bytes_sent) {
   DCHECK_LT(0u, sequence_number);
-  UnackedPacketMap::iterator it = unacked_packets_.find(sequence_number);
-  if (it == unacked_packets_.end()) {
+  TransmissionInfo* transmission_info = Find(sequence_number);
+  if (transmission_info == NULL) {
     LOG(DFATAL) << "OnPacketSent called for packet that is not unacked: "
                 << sequence_number;
     return;
   }
-  DCHECK(!it->second.pending);
+  DCHECK(!transmission_info->pending);
 
   largest_sent_packet_ = max(sequence_number, largest_sent_packet_);
   bytes_in_flight_ += bytes_sent;
-  it->second.sent_time = sent_time;
-  it->second.bytes_sent = bytes_sent;
-  it->second.pending = true;
+  transmission_info->sent_time = sent_time;
+  transmission_info->bytes_sent = bytes_sent;
+  transmission_info->pending = true;
+  ++num_pending_packets_;
+}
+
+QuicUnackedPacketMap::const_iterator QuicUnackedPacketMap::lower_bound(
+    QuicPacketSequenceNumber sequence_number) const {
+  if (unacked_packets_.empty() ||
+      sequence_number <= unacked_packets_.front().first) {
+    return begin();
+  }
+  if (sequence_number > unacked_packets_.back().first) {
+    return end();
+  }
+  return const_iterator(&unacked_packets_,
+                        sequence_number - unacked_packets_.front().first);
+}
+
+QuicUnackedPacketMap::TransmissionInfo* QuicUnackedPacketMap::Find(
+    QuicPacketSequenceNumber sequence_number) {
+  return const_cast<TransmissionInfo*>(
+      static_cast<const QuicUnackedPacketMap*>(this)->Find(sequence_number));
+}
+
+const QuicUnackedPacketMap::TransmissionInfo* QuicUnackedPacketMap::Find(
+    QuicPacketSequenceNumber sequence_number) const {
+  if (unacked_packets_.empty() ||
+      sequence_number < unacked_packets_.front().first ||
+      sequence_number > unacked_packets_.back().first) {
+    return NULL;
+  }
+  const TransmissionInfo& transmission_info =
+      unacked_packets_[sequence_number - unacked_packets_.front().first].second;
+  return IsHole(transmission_info) ? NULL : &transmission_info;
+}
+
+void QuicUnackedPacketMap::TrimHoles() {
+  while (!unacked_packets_.empty() && IsHole(unacked_packets_.front().second)) {
+    unacked_packets_.pop_front();
+  }
+  while (!unacked_packets_.empty() && IsHole(unacked_packets_.back().second)) {
+    unacked_packets_.pop_back();
+  }
 }
 
 }  // namespace net
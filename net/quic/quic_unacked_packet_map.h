@@ -5,7 +5,9 @@
 #ifndef NET_QUIC_QUIC_UNACKED_PACKET_MAP_H_
 #define NET_QUIC_QUIC_UNACKED_PACKET_MAP_H_
 
-#include "net/base/linked_hash_map.h"
+#include <deque>
+#include <utility>
+
 #include "net/quic/quic_protocol.h"
 
 namespace net {
@@ -13,6 +15,12 @@ namespace net {
 // Class which tracks unacked packets, including those packets which are
 // currently pending, and the relationship between packets which
 // contain the same data (via retransmissions)
+//
+// Since sequence numbers are sent in order, the packets are kept in a deque
+// indexed by their offset from the least unacked sequence number, so finding
+// a packet takes constant time, and acks and loss detection walk contiguous
+// entries rather than map nodes.  Packets removed from the middle leave holes,
+// which are skipped by iteration and popped once they reach either end.
 class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
  public:
   struct NET_EXPORT_PRIVATE TransmissionInfo {
@@ -40,7 +48,7 @@ class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
     QuicByteCount bytes_sent;
     size_t nack_count;
     // Stores the sequence numbers of all transmissions of this packet.
-    // Can never be null.
+    // Can never be null, except for the holes left by removed packets.
     SequenceNumberSet* all_transmissions;
     // Pending packets have not been abandoned or lost.
     bool pending;
@@ -116,13 +124,43 @@ class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
   // in the ack frame for new acks.
   void ClearPreviousRetransmissions(size_t num_to_clear);
 
-  typedef linked_hash_map<QuicPacketSequenceNumber,
-                          TransmissionInfo> UnackedPacketMap;
+  typedef std::deque<std::pair<QuicPacketSequenceNumber, TransmissionInfo> >
+      UnackedPacketMap;
+
+  // Iterates over the unacked packets in sequence number order, skipping the
+  // holes left by removed packets.  Like a map iterator, it points to a pair
+  // of the sequence number and its TransmissionInfo.  Removing packets
+  // invalidates all iterators.
+  class NET_EXPORT_PRIVATE const_iterator {
+   public:
+    typedef UnackedPacketMap::value_type value_type;
+
+    const_iterator(const UnackedPacketMap* packets, size_t index);
+
+    const value_type& operator*() const { return (*packets_)[index_]; }
+    const value_type* operator->() const { return &(*packets_)[index_]; }
+    const_iterator& operator++();
+
+    bool operator==(const const_iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    const UnackedPacketMap* packets_;
+    size_t index_;
+  };
 
-  typedef UnackedPacketMap::const_iterator const_iterator;
+  const_iterator begin() const { return const_iterator(&unacked_packets_, 0); }
+  const_iterator end() const {
+    return const_iterator(&unacked_packets_, unacked_packets_.size());
+  }
 
-  const_iterator begin() const { return unacked_packets_.begin(); }
-  const_iterator end() const { return unacked_packets_.end(); }
+  // Returns an iterator to the first unacked packet whose sequence number is
+  // at least |sequence_number|.
+  const_iterator lower_bound(QuicPacketSequenceNumber sequence_number) const;
 
   // Returns true if there are unacked packets that are pending.
   bool HasPendingPackets() const;
@@ -154,6 +192,13 @@ class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
   void NeuterPacket(QuicPacketSequenceNumber sequence_number);
 
  private:
+  // Returns the entry for |sequence_number|, or NULL if it is not unacked.
+  TransmissionInfo* Find(QuicPacketSequenceNumber sequence_number);
+  const TransmissionInfo* Find(QuicPacketSequenceNumber sequence_number) const;
+
+  // Pops the holes off both ends of unacked_packets_.
+  void TrimHoles();
+
   QuicPacketSequenceNumber largest_sent_packet_;
 
   // Newly serialized retransmittable and fec packets are added to this map,
@@ -166,6 +211,11 @@ class NET_EXPORT_PRIVATE QuicUnackedPacketMap {
   // set to NULL.
   UnackedPacketMap unacked_packets_;
 
+  // The number of entries in unacked_packets_ which are not holes, and the
+  // number of those which are pending.
+  size_t num_unacked_packets_;
+  size_t num_pending_packets_;
+
   size_t bytes_in_flight_;
 
   bool is_server_;
@@ -0,0 +1,135 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/quic_unacked_packet_map.h"
+
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicUnackedPacketMapTest : public ::testing::Test {
+ protected:
+  QuicUnackedPacketMapTest()
+      : unacked_packets_(false),
+        now_(QuicTime::Zero().Add(QuicTime::Delta::FromMilliseconds(1000))) {
+  }
+
+  SerializedPacket CreateRetransmittablePacket(
+      QuicPacketSequenceNumber sequence_number) {
+    return SerializedPacket(sequence_number, PACKET_1BYTE_SEQUENCE_NUMBER,
+                            NULL, 0, new RetransmittableFrames());
+  }
+
+  void SendPacket(QuicPacketSequenceNumber sequence_number) {
+    unacked_packets_.AddPacket(CreateRetransmittablePacket(sequence_number));
+    unacked_packets_.SetPending(sequence_number, now_, 1000);
+  }
+
+  void VerifyUnackedPackets(QuicPacketSequenceNumber* packets,
+                            size_t num_packets) {
+    SequenceNumberSet unacked = unacked_packets_.GetUnackedPackets();
+    ASSERT_EQ(num_packets, unacked.size());
+    ASSERT_EQ(num_packets, unacked_packets_.GetNumUnackedPackets());
+    size_t i = 0;
+    for (QuicUnackedPacketMap::const_iterator it = unacked_packets_.begin();
+         it != unacked_packets_.end(); ++it, ++i) {
+      ASSERT_LT(i, num_packets);
+      EXPECT_EQ(packets[i], it->first);
+      EXPECT_TRUE(unacked_packets_.IsUnacked(packets[i]));
+    }
+    EXPECT_EQ(num_packets, i);
+  }
+
+  QuicUnackedPacketMap unacked_packets_;
+  QuicTime now_;
+};
+
+TEST_F(QuicUnackedPacketMapTest, RemoveLeavesHoles) {
+  for (QuicPacketSequenceNumber i = 1; i <= 5; ++i) {
+    SendPacket(i);
+  }
+  unacked_packets_.SetNotPending(2);
+  unacked_packets_.RemovePacket(2);
+  unacked_packets_.SetNotPending(4);
+  unacked_packets_.RemovePacket(4);
+
+  QuicPacketSequenceNumber unacked[] = { 1, 3, 5 };
+  VerifyUnackedPackets(unacked, arraysize(unacked));
+  EXPECT_FALSE(unacked_packets_.IsUnacked(2));
+  EXPECT_FALSE(unacked_packets_.IsUnacked(4));
+  EXPECT_FALSE(unacked_packets_.IsUnacked(6));
+  EXPECT_EQ(3000u, unacked_packets_.bytes_in_flight());
+  EXPECT_TRUE(unacked_packets_.HasMultiplePendingPackets());
+  EXPECT_EQ(1u, unacked_packets_.GetLeastUnackedSentPacket());
+}
+
+TEST_F(QuicUnackedPacketMapTest, RemoveFromFrontTrimsHoles) {
+  for (QuicPacketSequenceNumber i = 1; i <= 4; ++i) {
+    SendPacket(i);
+  }
+  unacked_packets_.RemovePacket(2);
+  unacked_packets_.RemovePacket(1);
+  EXPECT_EQ(3u, unacked_packets_.GetLeastUnackedSentPacket());
+
+  unacked_packets_.RemovePacket(4);
+  QuicPacketSequenceNumber unacked[] = { 3 };
+  VerifyUnackedPackets(unacked, arraysize(unacked));
+  EXPECT_TRUE(unacked_packets_.HasPendingPackets());
+  EXPECT_FALSE(unacked_packets_.HasMultiplePendingPackets());
+
+  unacked_packets_.RemovePacket(3);
+  EXPECT_FALSE(unacked_packets_.HasUnackedPackets());
+  EXPECT_FALSE(unacked_packets_.HasPendingPackets());
+  EXPECT_EQ(0u, unacked_packets_.GetLeastUnackedSentPacket());
+}
+
+TEST_F(QuicUnackedPacketMapTest, SkippedSequenceNumbers) {
+  SendPacket(1);
+  SendPacket(4);
+  SendPacket(7);
+
+  QuicPacketSequenceNumber unacked[] = { 1, 4, 7 };
+  VerifyUnackedPackets(unacked, arraysize(unacked));
+  EXPECT_FALSE(unacked_packets_.IsUnacked(3));
+  EXPECT_EQ(7u, unacked_packets_.largest_sent_packet());
+}
+
+TEST_F(QuicUnackedPacketMapTest, LowerBound) {
+  for (QuicPacketSequenceNumber i = 2; i <= 6; ++i) {
+    SendPacket(i);
+  }
+  unacked_packets_.RemovePacket(4);
+  unacked_packets_.RemovePacket(5);
+
+  EXPECT_EQ(2u, unacked_packets_.lower_bound(1)->first);
+  EXPECT_EQ(3u, unacked_packets_.lower_bound(3)->first);
+  EXPECT_EQ(6u, unacked_packets_.lower_bound(4)->first);
+  EXPECT_EQ(6u, unacked_packets_.lower_bound(6)->first);
+  EXPECT_TRUE(unacked_packets_.end() == unacked_packets_.lower_bound(7));
+}
+
+TEST_F(QuicUnackedPacketMapTest, RetransmittedPacket) {
+  SendPacket(1);
+  unacked_packets_.SetNotPending(1);
+  unacked_packets_.OnRetransmittedPacket(1, 3);
+  unacked_packets_.SetPending(3, now_, 1000);
+
+  QuicPacketSequenceNumber unacked[] = { 1, 3 };
+  VerifyUnackedPackets(unacked, arraysize(unacked));
+  EXPECT_FALSE(unacked_packets_.HasRetransmittableFrames(1));
+  EXPECT_TRUE(unacked_packets_.HasRetransmittableFrames(3));
+  EXPECT_EQ(2u, unacked_packets_.GetTransmissionInfo(3).
+                all_transmissions->size());
+
+  unacked_packets_.RemovePacket(1);
+  QuicPacketSequenceNumber unacked2[] = { 3 };
+  VerifyUnackedPackets(unacked2, arraysize(unacked2));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,175 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/test_tools/send_algorithm_simulator.h"
+
+#include "base/logging.h"
+
+namespace net {
+namespace test {
+
+namespace {
+const QuicByteCount kPacketSize = kMaxPacketSize;
+const uint32 kRandomSeed = 1;
+}  // namespace
+
+SendAlgorithmSimulator::SentPacket::SentPacket(
+    QuicPacketSequenceNumber sequence_number,
+    QuicTime send_time,
+    QuicTime ack_time,
+    bool lost)
+    : sequence_number(sequence_number),
+      send_time(send_time),
+      ack_time(ack_time),
+      lost(lost) {
+}
+
+SendAlgorithmSimulator::SendAlgorithmSimulator(
+    SendAlgorithmInterface* send_algorithm,
+    MockClock* clock,
+    QuicBandwidth bandwidth,
+    QuicTime::Delta rtt)
+    : send_algorithm_(send_algorithm),
+      clock_(clock),
+      bandwidth_(bandwidth),
+      rtt_(rtt),
+      loss_rate_(0),
+      buffer_size_(bandwidth.ToBytesPerPeriod(rtt)),
+      random_state_(kRandomSeed),
+      link_busy_until_(clock->Now()),
+      next_sequence_number_(1),
+      bytes_acked_(0),
+      bytes_pending_(0),
+      packets_sent_(0),
+      packets_lost_(0),
+      max_rtt_(QuicTime::Delta::Zero()) {
+}
+
+SendAlgorithmSimulator::~SendAlgorithmSimulator() {
+}
+
+void SendAlgorithmSimulator::TransferBytes(QuicByteCount num_bytes) {
+  const QuicByteCount target = bytes_acked_ + num_bytes;
+  while (bytes_acked_ < target) {
+    const QuicTime now = clock_->Now();
+    QuicTime::Delta send_delay = QuicTime::Delta::Infinite();
+    if (bytes_acked_ + bytes_pending_ < target) {
+      send_delay = send_algorithm_->TimeUntilSend(
+          now, NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA, NOT_HANDSHAKE);
+    }
+    if (send_delay.IsZero()) {
+      SendPacket();
+      continue;
+    }
+
+    std::list<SentPacket>::const_iterator next_ack = pending_packets_.begin();
+    while (next_ack != pending_packets_.end() && next_ack->lost) {
+      ++next_ack;
+    }
+    if (next_ack == pending_packets_.end() ||
+        (!send_delay.IsInfinite() &&
+         now.Add(send_delay) < next_ack->ack_time)) {
+      if (!send_delay.IsInfinite()) {
+        clock_->AdvanceTime(send_delay);
+      } else if (!pending_packets_.empty()) {
+        HandleTailLoss();
+      } else {
+        LOG(DFATAL) << "Send algorithm is blocked with nothing in flight.";
+        return;
+      }
+      continue;
+    }
+    if (next_ack->ack_time > now) {
+      clock_->AdvanceTime(next_ack->ack_time.Subtract(now));
+    }
+    HandleAck();
+  }
+}
+
+void SendAlgorithmSimulator::SendPacket() {
+  const QuicTime now = clock_->Now();
+  QuicByteCount queued_bytes = 0;
+  if (link_busy_until_ > now) {
+    queued_bytes = bandwidth_.ToBytesPerPeriod(link_busy_until_.Subtract(now));
+  }
+
+  bool lost = true;
+  QuicTime ack_time = QuicTime::Zero();
+  if (queued_bytes + kPacketSize <= buffer_size_) {
+    // The packet fits in the queue, so it goes over the bottleneck link, but
+    // may still be dropped at random later on the path.
+    link_busy_until_ = QuicTime::Max(link_busy_until_, now).Add(
+        bandwidth_.TransferTime(kPacketSize));
+    ack_time = link_busy_until_.Add(rtt_);
+    lost = ShouldDropRandomly();
+  }
+
+  QuicPacketSequenceNumber sequence_number = next_sequence_number_++;
+  send_algorithm_->OnPacketSent(now, sequence_number, kPacketSize,
+                                NOT_RETRANSMISSION, HAS_RETRANSMITTABLE_DATA);
+  pending_packets_.push_back(
+      SentPacket(sequence_number, now, ack_time, lost));
+  bytes_pending_ += kPacketSize;
+  ++packets_sent_;
+}
+
+void SendAlgorithmSimulator::HandleAck() {
+  const QuicTime now = clock_->Now();
+  // Every packet is acked, so any lost packet sent before the acked one is
+  // detected as lost, as though by three nacks.
+  while (pending_packets_.front().lost) {
+    const SentPacket& packet = pending_packets_.front();
+    send_algorithm_->OnPacketLost(packet.sequence_number, now);
+    send_algorithm_->OnPacketAbandoned(packet.sequence_number, kPacketSize);
+    bytes_pending_ -= kPacketSize;
+    ++packets_lost_;
+    pending_packets_.pop_front();
+  }
+
+  const SentPacket& packet = pending_packets_.front();
+  DCHECK(now == packet.ack_time);
+  QuicTime::Delta rtt = now.Subtract(packet.send_time);
+  if (rtt > max_rtt_) {
+    max_rtt_ = rtt;
+  }
+  // The sent packet manager updates the RTT before handling the ack.
+  send_algorithm_->UpdateRtt(rtt);
+  send_algorithm_->OnPacketAcked(packet.sequence_number, kPacketSize);
+  bytes_acked_ += kPacketSize;
+  bytes_pending_ -= kPacketSize;
+  pending_packets_.pop_front();
+}
+
+void SendAlgorithmSimulator::HandleTailLoss() {
+  // Wait for the retransmission timer, then report the losses.
+  QuicTime::Delta delay = send_algorithm_->RetransmissionDelay();
+  if (delay.IsZero()) {
+    delay = rtt_.Multiply(2);
+  }
+  clock_->AdvanceTime(delay);
+  const QuicTime now = clock_->Now();
+  while (!pending_packets_.empty()) {
+    const SentPacket& packet = pending_packets_.front();
+    DCHECK(packet.lost);
+    send_algorithm_->OnPacketLost(packet.sequence_number, now);
+    send_algorithm_->OnPacketAbandoned(packet.sequence_number, kPacketSize);
+    bytes_pending_ -= kPacketSize;
+    ++packets_lost_;
+    pending_packets_.pop_front();
+  }
+}
+
+bool SendAlgorithmSimulator::ShouldDropRandomly() {
+  if (loss_rate_ <= 0) {
+    return false;
+  }
+  // A linear congruential generator, so that every run drops the same
+  // packets.
+  random_state_ = random_state_ * 1103515245 + 12345;
+  float value = ((random_state_ >> 16) & 0x7fff) / 32768.f;
+  return value < loss_rate_;
+}
+
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,110 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A test only class to run a SendAlgorithmInterface over a simulated network
+// path: a single bottleneck link with a fixed bandwidth and a tail drop
+// queue, a fixed propagation delay, and optional random loss.
+
+#ifndef NET_QUIC_TEST_TOOLS_SEND_ALGORITHM_SIMULATOR_H_
+#define NET_QUIC_TEST_TOOLS_SEND_ALGORITHM_SIMULATOR_H_
+
+#include <list>
+
+#include "base/basictypes.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+#include "net/quic/test_tools/mock_clock.h"
+
+namespace net {
+namespace test {
+
+class SendAlgorithmSimulator {
+ public:
+  // |send_algorithm| and |clock| are not owned, and |clock| must be the clock
+  // |send_algorithm| uses.  |rtt| is the round trip time of an empty path.
+  SendAlgorithmSimulator(SendAlgorithmInterface* send_algorithm,
+                         MockClock* clock,
+                         QuicBandwidth bandwidth,
+                         QuicTime::Delta rtt);
+  ~SendAlgorithmSimulator();
+
+  // Sets the fraction of packets dropped at random, independently of the
+  // queue length.  The drops are the same on every run.
+  void set_loss_rate(float loss_rate) { loss_rate_ = loss_rate; }
+
+  // Sets the number of bytes the bottleneck queue holds before dropping
+  // packets.  Defaults to one bandwidth-delay product.
+  void set_buffer_size(QuicByteCount buffer_size) {
+    buffer_size_ = buffer_size;
+  }
+
+  // Sends |num_bytes| of data, retransmitting whatever is lost, and advances
+  // the clock until all of it has been acked.
+  void TransferBytes(QuicByteCount num_bytes);
+
+  QuicByteCount bytes_acked() const { return bytes_acked_; }
+  size_t packets_sent() const { return packets_sent_; }
+  size_t packets_lost() const { return packets_lost_; }
+
+  // Returns the largest RTT seen by the send algorithm.
+  QuicTime::Delta max_rtt() const { return max_rtt_; }
+
+ private:
+  struct SentPacket {
+    SentPacket(QuicPacketSequenceNumber sequence_number,
+               QuicTime send_time,
+               QuicTime ack_time,
+               bool lost);
+
+    QuicPacketSequenceNumber sequence_number;
+    QuicTime send_time;
+    // When the ack of the packet arrives, if it is not lost.
+    QuicTime ack_time;
+    bool lost;
+  };
+
+  // Sends one packet into the bottleneck queue.
+  void SendPacket();
+
+  // Delivers the ack of the first packet in flight, and reports any packets
+  // lost before it.
+  void HandleAck();
+
+  // Reports the packets which were lost at the tail, when there is no later
+  // packet whose ack would reveal the losses.
+  void HandleTailLoss();
+
+  // Returns true with probability |loss_rate_|.
+  bool ShouldDropRandomly();
+
+  SendAlgorithmInterface* send_algorithm_;
+  MockClock* clock_;
+  const QuicBandwidth bandwidth_;
+  const QuicTime::Delta rtt_;
+  float loss_rate_;
+  QuicByteCount buffer_size_;
+  uint32 random_state_;
+
+  // The packets which have been sent and not yet acked or declared lost,
+  // in the order they were sent.
+  std::list<SentPacket> pending_packets_;
+  // When the bottleneck link finishes sending the packets queued on it.
+  QuicTime link_busy_until_;
+
+  QuicPacketSequenceNumber next_sequence_number_;
+  QuicByteCount bytes_acked_;
+  QuicByteCount bytes_pending_;
+  size_t packets_sent_;
+  size_t packets_lost_;
+  QuicTime::Delta max_rtt_;
+
+  DISALLOW_COPY_AND_ASSIGN(SendAlgorithmSimulator);
+};
+
+}  // namespace test
+}  // namespace net
+
+#endif  // NET_QUIC_TEST_TOOLS_SEND_ALGORITHM_SIMULATOR_H_
@@ -542,6 +542,24 @@ void ClientSocketPoolBaseHelper::CloseIdleSockets() {
   DCHECK_EQ(0, idle_socket_count_);
 }
 
+void ClientSocketPoolBaseHelper::CloseIdleSocketsInGroup(
+    const std::string& group_name) {
+  GroupMap::iterator it = group_map_.find(group_name);
+  if (it == group_map_.end())
+    return;
+
+  Group* group = it->second;
+  std::list<IdleSocket>* idle_sockets = group->mutable_idle_sockets();
+  while (!idle_sockets->empty()) {
+    delete idle_sockets->front().socket;
+    idle_sockets->pop_front();
+    DecrementIdleCount();
+  }
+
+  if (group->IsEmpty())
+    RemoveGroup(it);
+}
+
 int ClientSocketPoolBaseHelper::IdleSocketCountInGroup(
     const std::string& group_name) const {
   GroupMap::const_iterator i = group_map_.find(group_name);
@@ -256,6 +256,9 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // See ClientSocketPool::CloseIdleSockets for documentation on this function.
   void CloseIdleSockets();
 
+  // Closes the idle sockets of |group_name|, if it exists.
+  void CloseIdleSocketsInGroup(const std::string& group_name);
+
   // See ClientSocketPool::IdleSocketCount() for documentation on this function.
   int idle_socket_count() const {
     return idle_socket_count_;
@@ -775,6 +778,10 @@ class ClientSocketPoolBase {
 
   void CloseIdleSockets() { return helper_.CloseIdleSockets(); }
 
+  void CloseIdleSocketsInGroup(const std::string& group_name) {
+    return helper_.CloseIdleSocketsInGroup(group_name);
+  }
+
   int idle_socket_count() const { return helper_.idle_socket_count(); }
 
   int IdleSocketCountInGroup(const std::string& group_name) const {
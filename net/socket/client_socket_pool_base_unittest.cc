@@ -589,6 +589,10 @@ class TestClientSocketPool : public ClientSocketPool {
 
   void CleanupTimedOutIdleSockets() { base_.CleanupIdleSockets(false); }
 
+  void CloseIdleSocketsInGroup(const std::string& group_name) {
+    base_.CloseIdleSocketsInGroup(group_name);
+  }
+
   void EnableConnectBackupJobs() { base_.EnableConnectBackupJobs(); }
 
   bool CloseOneIdleConnectionInHigherLayeredPool() {
@@ -3191,6 +3195,25 @@ TEST_F(ClientSocketPoolBaseTest, RequestSockets) {
   EXPECT_EQ(2, pool_->IdleSocketCountInGroup("a"));
 }
 
+TEST_F(ClientSocketPoolBaseTest, CloseIdleSocketsInGroup) {
+  CreatePool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
+  connect_job_factory_->set_job_type(TestConnectJob::kMockJob);
+
+  pool_->RequestSockets("a", &params_, 2, BoundNetLog());
+  pool_->RequestSockets("b", &params_, 1, BoundNetLog());
+  EXPECT_EQ(2, pool_->IdleSocketCountInGroup("a"));
+  EXPECT_EQ(3, pool_->IdleSocketCount());
+
+  pool_->CloseIdleSocketsInGroup("a");
+  EXPECT_FALSE(pool_->HasGroup("a"));
+  EXPECT_EQ(1, pool_->IdleSocketCountInGroup("b"));
+  EXPECT_EQ(1, pool_->IdleSocketCount());
+
+  // Unknown groups are ignored.
+  pool_->CloseIdleSocketsInGroup("c");
+  EXPECT_EQ(1, pool_->IdleSocketCount());
+}
+
 TEST_F(ClientSocketPoolBaseTest, RequestSocketsWhenAlreadyHaveAConnectJob) {
   CreatePool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
   connect_job_factory_->set_job_type(TestConnectJob::kMockPendingJob);
@@ -64,6 +64,11 @@ COMPILE_ASSERT(arraysize(g_max_sockets_per_proxy_server) ==
                    HttpNetworkSession::NUM_SOCKET_POOL_TYPES,
                max_sockets_per_proxy_server_length_mismatch);
 
+// The sockets warmed up for learned demand are unused until a request picks
+// them up, and so are closed by the pools after a few seconds anyway. This
+// bounds how many can be held at once.
+int g_max_warm_idle_sockets = 32;
+
 // The meat of the implementation for the InitSocketHandleForHttpRequest,
 // InitSocketHandleForRawConnect and PreconnectSocketsForHttpRequest methods.
 int InitSocketPoolHelper(const GURL& request_url,
@@ -245,6 +250,15 @@ int InitSocketPoolHelper(const GURL& request_url,
       return OK;
     }
 
+    if (proxy_info.is_direct()) {
+      int num_warm_sockets = session->RecordSocketRequest(
+          socket_pool_type, origin_host_port, connection_group);
+      if (num_warm_sockets) {
+        RequestSocketsForPool(ssl_pool, connection_group, ssl_params,
+                              num_warm_sockets, net_log);
+      }
+    }
+
     return socket_handle->Init(connection_group, ssl_params,
                                request_priority, callback, ssl_pool,
                                net_log);
@@ -290,6 +304,13 @@ int InitSocketPoolHelper(const GURL& request_url,
     return OK;
   }
 
+  int num_warm_sockets = session->RecordSocketRequest(
+      socket_pool_type, origin_host_port, connection_group);
+  if (num_warm_sockets) {
+    RequestSocketsForPool(pool, connection_group, tcp_params, num_warm_sockets,
+                          net_log);
+  }
+
   return socket_handle->Init(connection_group, tcp_params,
                              request_priority, callback,
                              pool, net_log);
@@ -362,6 +383,17 @@ void ClientSocketPoolManager::set_max_sockets_per_proxy_server(
   g_max_sockets_per_proxy_server[pool_type] = socket_count;
 }
 
+// static
+int ClientSocketPoolManager::max_warm_idle_sockets() {
+  return g_max_warm_idle_sockets;
+}
+
+// static
+void ClientSocketPoolManager::set_max_warm_idle_sockets(int socket_count) {
+  DCHECK_LE(0, socket_count);
+  g_max_warm_idle_sockets = socket_count;
+}
+
 int InitSocketHandleForHttpRequest(
     const GURL& request_url,
     const HttpRequestHeaders& request_extra_headers,
@@ -67,6 +67,12 @@ class NET_EXPORT_PRIVATE ClientSocketPoolManager {
       HttpNetworkSession::SocketPoolType pool_type,
       int socket_count);
 
+  // The number of idle sockets, summed over the direct transport and SSL
+  // pools, beyond which no more sockets are warmed up for learned demand.
+  // 0 disables warming.
+  static int max_warm_idle_sockets();
+  static void set_max_warm_idle_sockets(int socket_count);
+
   virtual void FlushSocketPoolsWithError(int error) = 0;
   virtual void CloseIdleSockets() = 0;
   virtual TransportClientSocketPool* GetTransportSocketPool() = 0;
@@ -80,6 +86,13 @@ class NET_EXPORT_PRIVATE ClientSocketPoolManager {
   // Creates a Value summary of the state of the socket pools. The caller is
   // responsible for deleting the returned value.
   virtual base::Value* SocketPoolInfoToValue() const = 0;
+
+  // Records that a socket to |endpoint| is about to be requested from the
+  // group |group_name| of the direct transport or SSL pool. Returns the
+  // number of sockets the group should be warmed up to, or 0 to leave it
+  // alone.
+  virtual int RecordSocketRequest(const HostPortPair& endpoint,
+                                  const std::string& group_name) = 0;
 };
 
 // A helper method that uses the passed in proxy information to initialize a
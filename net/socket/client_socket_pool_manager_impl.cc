@@ -4,6 +4,9 @@
 
 #include "net/socket/client_socket_pool_manager_impl.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/values.h"
 #include "net/http/http_network_session.h"
@@ -17,6 +20,16 @@ namespace net {
 
 namespace {
 
+// The number of hosts whose demand is remembered.
+const size_t kMaxDemandHosts = 256;
+
+// Requests to a host that start within this long of each other are counted
+// as concurrent, roughly the time a page takes to discover its subresources.
+const int kDemandBurstWindowMs = 1000;
+
+// How long it takes for a host's learned demand to halve.
+const int kDemandHalfLifeMinutes = 30;
+
 // Appends information about all |socket_pools| to the end of |list|.
 template <class MapType>
 void AddSocketPoolsToList(base::ListValue* list,
@@ -85,7 +98,13 @@ ClientSocketPoolManagerImpl::ClientSocketPoolManagerImpl(
       transport_for_https_proxy_pool_histograms_("TCPforHTTPSProxy"),
       ssl_for_https_proxy_pool_histograms_("SSLforHTTPSProxy"),
       http_proxy_pool_histograms_("HTTPProxy"),
-      ssl_socket_pool_for_proxies_histograms_("SSLForProxies") {
+      ssl_socket_pool_for_proxies_histograms_("SSLForProxies"),
+      demand_model_(kMaxDemandHosts,
+                    base::TimeDelta::FromMilliseconds(kDemandBurstWindowMs),
+                    base::TimeDelta::FromMinutes(kDemandHalfLifeMinutes)),
+      memory_pressure_listener_(
+          base::Bind(&ClientSocketPoolManagerImpl::OnMemoryPressure,
+                     base::Unretained(this))) {
   CertDatabase::GetInstance()->AddObserver(this);
 }
 
@@ -375,6 +394,54 @@ base::Value* ClientSocketPoolManagerImpl::SocketPoolInfoToValue() const {
   return list;
 }
 
+int ClientSocketPoolManagerImpl::RecordSocketRequest(
+    const HostPortPair& endpoint,
+    const std::string& group_name) {
+  DCHECK(CalledOnValidThread());
+  // WebSocket connections are long-lived, and don't come in bursts.
+  if (pool_type_ != HttpNetworkSession::NORMAL_SOCKET_POOL ||
+      max_warm_idle_sockets() == 0) {
+    return 0;
+  }
+
+  int demand = demand_model_.RecordRequest(endpoint, group_name,
+                                           base::TimeTicks::Now());
+  if (demand <= 1)
+    return 0;
+
+  // The request itself takes one of the sockets, the others are warmed up
+  // only as far as the idle budget allows.
+  int idle_sockets = transport_socket_pool_->IdleSocketCount() +
+                     ssl_socket_pool_->IdleSocketCount();
+  int num_warm_sockets =
+      std::min(demand - 1, max_warm_idle_sockets() - idle_sockets);
+  if (num_warm_sockets <= 0)
+    return 0;
+  return std::min(num_warm_sockets + 1, max_sockets_per_group(pool_type_));
+}
+
+void ClientSocketPoolManagerImpl::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  DCHECK(CalledOnValidThread());
+  if (memory_pressure_level ==
+      base::MemoryPressureListener::MEMORY_PRESSURE_CRITICAL) {
+    demand_model_.Clear();
+    transport_socket_pool_->CloseIdleSockets();
+    ssl_socket_pool_->CloseIdleSockets();
+    return;
+  }
+
+  // Whichever pool warmed a group, closing its idle sockets in both pools is
+  // harmless.
+  std::vector<std::string> group_names;
+  demand_model_.EvictLeastRecentlyUsed((demand_model_.size() + 1) / 2,
+                                       &group_names);
+  for (size_t i = 0; i < group_names.size(); ++i) {
+    ssl_socket_pool_->CloseIdleSocketsInGroup(group_names[i]);
+    transport_socket_pool_->CloseIdleSocketsInGroup(group_names[i]);
+  }
+}
+
 void ClientSocketPoolManagerImpl::OnCertAdded(const X509Certificate* cert) {
   FlushSocketPoolsWithError(ERR_NETWORK_CHANGED);
 }
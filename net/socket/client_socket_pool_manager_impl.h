@@ -8,6 +8,7 @@
 #include <map>
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/stl_util.h"
@@ -17,6 +18,7 @@
 #include "net/http/http_network_session.h"
 #include "net/socket/client_socket_pool_histograms.h"
 #include "net/socket/client_socket_pool_manager.h"
+#include "net/socket/connection_demand_model.h"
 
 namespace net {
 
@@ -90,6 +92,9 @@ class ClientSocketPoolManagerImpl : public base::NonThreadSafe,
   // responsible for deleting the returned value.
   virtual base::Value* SocketPoolInfoToValue() const OVERRIDE;
 
+  virtual int RecordSocketRequest(const HostPortPair& endpoint,
+                                  const std::string& group_name) OVERRIDE;
+
   // CertDatabase::Observer methods:
   virtual void OnCertAdded(const X509Certificate* cert) OVERRIDE;
   virtual void OnCACertChanged(const X509Certificate* cert) OVERRIDE;
@@ -104,6 +109,11 @@ class ClientSocketPoolManagerImpl : public base::NonThreadSafe,
   typedef internal::OwnedPoolMap<HostPortPair, SSLClientSocketPool*>
       SSLSocketPoolMap;
 
+  // Closes the warm idle sockets of the least recently requested hosts, or
+  // of all hosts if |memory_pressure_level| is critical.
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
   NetLog* const net_log_;
   ClientSocketFactory* const socket_factory_;
   HostResolver* const host_resolver_;
@@ -145,6 +155,11 @@ class ClientSocketPoolManagerImpl : public base::NonThreadSafe,
   ClientSocketPoolHistograms ssl_socket_pool_for_proxies_histograms_;
   SSLSocketPoolMap ssl_socket_pools_for_proxies_;
 
+  // Learns how many sockets each host needs at once, to warm up the direct
+  // transport and SSL pools ahead of the requests.
+  ConnectionDemandModel demand_model_;
+  base::MemoryPressureListener memory_pressure_listener_;
+
   DISALLOW_COPY_AND_ASSIGN(ClientSocketPoolManagerImpl);
 };
 
@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/connection_demand_model.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace net {
+
+ConnectionDemandModel::HostDemand::HostDemand()
+    : demand(0),
+      burst_size(0) {
+}
+
+ConnectionDemandModel::ConnectionDemandModel(size_t max_hosts,
+                                             base::TimeDelta burst_window,
+                                             base::TimeDelta half_life)
+    : burst_window_(burst_window),
+      half_life_(half_life),
+      hosts_(max_hosts) {
+  DCHECK_GT(half_life.InMicroseconds(), 0);
+}
+
+ConnectionDemandModel::~ConnectionDemandModel() {}
+
+int ConnectionDemandModel::RecordRequest(const HostPortPair& host,
+                                         const std::string& group_name,
+                                         base::TimeTicks now) {
+  HostDemandMap::iterator it = hosts_.Get(host);
+  if (it == hosts_.end()) {
+    HostDemand host_demand;
+    host_demand.demand = 1;
+    host_demand.last_update = now;
+    host_demand.burst_start = now;
+    host_demand.burst_size = 1;
+    host_demand.group_name = group_name;
+    hosts_.Put(host, host_demand);
+    return 1;
+  }
+
+  HostDemand* host_demand = &it->second;
+  double demand = DecayedDemand(*host_demand, now);
+  host_demand->last_update = now;
+  host_demand->group_name = group_name;
+
+  if (now - host_demand->burst_start < burst_window_) {
+    ++host_demand->burst_size;
+    host_demand->demand = std::max(demand,
+                                   static_cast<double>(host_demand->burst_size));
+    return 0;
+  }
+
+  host_demand->demand = std::max(demand, 1.0);
+  host_demand->burst_start = now;
+  host_demand->burst_size = 1;
+  return std::max(1, static_cast<int>(demand + 0.5));
+}
+
+double ConnectionDemandModel::GetDemand(const HostPortPair& host,
+                                        base::TimeTicks now) const {
+  HostDemandMap::const_iterator it = hosts_.Peek(host);
+  if (it == hosts_.end())
+    return 0;
+  return DecayedDemand(it->second, now);
+}
+
+void ConnectionDemandModel::EvictLeastRecentlyUsed(
+    size_t count,
+    std::vector<std::string>* group_names) {
+  for (; count > 0 && !hosts_.empty(); --count) {
+    HostDemandMap::reverse_iterator it = hosts_.rbegin();
+    group_names->push_back(it->second.group_name);
+    hosts_.Erase(it);
+  }
+}
+
+void ConnectionDemandModel::Clear() {
+  hosts_.Clear();
+}
+
+double ConnectionDemandModel::DecayedDemand(const HostDemand& host_demand,
+                                            base::TimeTicks now) const {
+  double half_lives = (now - host_demand.last_update).InSecondsF() /
+                      half_life_.InSecondsF();
+  if (half_lives <= 0)
+    return host_demand.demand;
+  return host_demand.demand * pow(0.5, half_lives);
+}
+
+}  // namespace net
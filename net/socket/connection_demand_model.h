@@ -0,0 +1,88 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SOCKET_CONNECTION_DEMAND_MODEL_H_
+#define NET_SOCKET_CONNECTION_DEMAND_MODEL_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/containers/mru_cache.h"
+#include "base/time/time.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// ConnectionDemandModel learns how many connections each host needs at once.
+// Requests to a host that arrive within |burst_window| of the first request
+// of a burst are counted as concurrent, and a host's demand is the largest
+// burst it has seen, halving every |half_life| so that hosts which stop being
+// busy are forgotten. At most |max_hosts| hosts are remembered; the least
+// recently requested ones are dropped first.
+//
+// The model also remembers the connection group of the last request to each
+// host, so that the sockets it caused to be warmed up can be found again.
+class NET_EXPORT_PRIVATE ConnectionDemandModel {
+ public:
+  ConnectionDemandModel(size_t max_hosts,
+                        base::TimeDelta burst_window,
+                        base::TimeDelta half_life);
+  ~ConnectionDemandModel();
+
+  // Records a request at |now| for a connection to |host|, in the connection
+  // group |group_name|. If the request starts a new burst, returns the number
+  // of connections the burst is expected to need, which is at least 1.
+  // Returns 0 for the other requests of a burst.
+  int RecordRequest(const HostPortPair& host,
+                    const std::string& group_name,
+                    base::TimeTicks now);
+
+  // Returns the demand learned for |host| as of |now|, or 0 if |host| isn't
+  // known. Doesn't count as a use of |host|.
+  double GetDemand(const HostPortPair& host, base::TimeTicks now) const;
+
+  // Forgets the |count| least recently requested hosts, and appends their
+  // connection groups to |group_names|.
+  void EvictLeastRecentlyUsed(size_t count,
+                              std::vector<std::string>* group_names);
+
+  // Forgets all hosts.
+  void Clear();
+
+  size_t size() const { return hosts_.size(); }
+
+ private:
+  struct HostDemand {
+    HostDemand();
+
+    // The demand as of |last_update|.
+    double demand;
+    base::TimeTicks last_update;
+
+    // The current burst.
+    base::TimeTicks burst_start;
+    int burst_size;
+
+    std::string group_name;
+  };
+
+  typedef base::MRUCache<HostPortPair, HostDemand> HostDemandMap;
+
+  // Returns the demand of |host_demand| as of |now|.
+  double DecayedDemand(const HostDemand& host_demand,
+                       base::TimeTicks now) const;
+
+  const base::TimeDelta burst_window_;
+  const base::TimeDelta half_life_;
+
+  HostDemandMap hosts_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConnectionDemandModel);
+};
+
+}  // namespace net
+
+#endif  // NET_SOCKET_CONNECTION_DEMAND_MODEL_H_
@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/connection_demand_model.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const size_t kMaxHosts = 3;
+
+class ConnectionDemandModelTest : public testing::Test {
+ public:
+  ConnectionDemandModelTest()
+      : model_(kMaxHosts,
+               base::TimeDelta::FromSeconds(1),
+               base::TimeDelta::FromMinutes(10)),
+        host_("www.example.com", 443),
+        now_(base::TimeTicks::Now()) {}
+
+ protected:
+  // Records a burst of |size| requests to |host| at |now_|.
+  int RecordBurst(const HostPortPair& host, int size) {
+    int demand = model_.RecordRequest(host, "ssl/" + host.ToString(), now_);
+    for (int i = 1; i < size; ++i)
+      EXPECT_EQ(0, model_.RecordRequest(host, "ssl/" + host.ToString(), now_));
+    return demand;
+  }
+
+  ConnectionDemandModel model_;
+  const HostPortPair host_;
+  base::TimeTicks now_;
+};
+
+TEST_F(ConnectionDemandModelTest, LearnsLargestBurst) {
+  EXPECT_EQ(0, model_.GetDemand(host_, now_));
+  EXPECT_EQ(1, RecordBurst(host_, 4));
+  EXPECT_EQ(4, model_.GetDemand(host_, now_));
+
+  now_ += base::TimeDelta::FromSeconds(2);
+  EXPECT_EQ(4, RecordBurst(host_, 2));
+
+  // The smaller burst didn't lower the demand.
+  now_ += base::TimeDelta::FromSeconds(2);
+  EXPECT_EQ(4, RecordBurst(host_, 6));
+  now_ += base::TimeDelta::FromSeconds(2);
+  EXPECT_EQ(6, RecordBurst(host_, 1));
+}
+
+TEST_F(ConnectionDemandModelTest, DemandDecays) {
+  RecordBurst(host_, 6);
+
+  now_ += base::TimeDelta::FromMinutes(10);
+  EXPECT_DOUBLE_EQ(3, model_.GetDemand(host_, now_));
+  EXPECT_EQ(3, RecordBurst(host_, 1));
+
+  // Demand never drops below the request that is being made.
+  now_ += base::TimeDelta::FromMinutes(60);
+  EXPECT_EQ(1, RecordBurst(host_, 1));
+}
+
+TEST_F(ConnectionDemandModelTest, EvictsLeastRecentlyUsed) {
+  HostPortPair host1("host1", 80);
+  HostPortPair host2("host2", 80);
+  HostPortPair host3("host3", 80);
+  HostPortPair host4("host4", 80);
+  RecordBurst(host1, 1);
+  RecordBurst(host2, 1);
+  RecordBurst(host3, 1);
+  RecordBurst(host1, 1);
+  EXPECT_EQ(3u, model_.size());
+
+  // |host2| is the least recently used, so it makes room for |host4|.
+  RecordBurst(host4, 1);
+  EXPECT_EQ(3u, model_.size());
+  EXPECT_EQ(0, model_.GetDemand(host2, now_));
+
+  std::vector<std::string> group_names;
+  model_.EvictLeastRecentlyUsed(2, &group_names);
+  ASSERT_EQ(2u, group_names.size());
+  EXPECT_EQ("ssl/host3:80", group_names[0]);
+  EXPECT_EQ("ssl/host1:80", group_names[1]);
+  EXPECT_EQ(1u, model_.size());
+  EXPECT_EQ(1, model_.GetDemand(host4, now_));
+
+  // Evicting more hosts than are known stops at the last one.
+  group_names.clear();
+  model_.EvictLeastRecentlyUsed(5, &group_names);
+  EXPECT_EQ(1u, group_names.size());
+  EXPECT_EQ(0u, model_.size());
+}
+
+}  // namespace
+
+}  // namespace net
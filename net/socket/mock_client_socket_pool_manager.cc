@@ -91,4 +91,10 @@ base::Value* MockClientSocketPoolManager::SocketPoolInfoToValue() const {
   return NULL;
 }
 
+int MockClientSocketPoolManager::RecordSocketRequest(
+    const HostPortPair& endpoint,
+    const std::string& group_name) {
+  return 0;
+}
+
 }  // namespace net
@@ -38,6 +38,8 @@ class MockClientSocketPoolManager : public ClientSocketPoolManager {
   virtual SSLClientSocketPool* GetSocketPoolForSSLWithProxy(
       const HostPortPair& proxy_server) OVERRIDE;
   virtual base::Value* SocketPoolInfoToValue() const OVERRIDE;
+  virtual int RecordSocketRequest(const HostPortPair& endpoint,
+                                  const std::string& group_name) OVERRIDE;
 
  private:
   typedef internal::OwnedPoolMap<HostPortPair, TransportClientSocketPool*>
@@ -0,0 +1,46 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/socket.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+
+namespace net {
+
+WriteBuffer::WriteBuffer(IOBuffer* buf, int buf_len)
+    : buf(buf),
+      buf_len(buf_len) {
+}
+
+WriteBuffer::~WriteBuffer() {}
+
+scoped_refptr<IOBufferWithSize> MergeWriteBuffers(
+    const WriteBufferList& buffers) {
+  int total_len = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    DCHECK_GT(buffers[i].buf_len, 0);
+    total_len += buffers[i].buf_len;
+  }
+  scoped_refptr<IOBufferWithSize> merged(new IOBufferWithSize(total_len));
+  int offset = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    memcpy(merged->data() + offset, buffers[i].buf->data(),
+           buffers[i].buf_len);
+    offset += buffers[i].buf_len;
+  }
+  return merged;
+}
+
+int Socket::Writev(const WriteBufferList& buffers,
+                   const CompletionCallback& callback) {
+  DCHECK(!buffers.empty());
+  if (buffers.size() == 1)
+    return Write(buffers[0].buf.get(), buffers[0].buf_len, callback);
+  scoped_refptr<IOBufferWithSize> merged = MergeWriteBuffers(buffers);
+  return Write(merged.get(), merged->size(), callback);
+}
+
+}  // namespace net
@@ -5,12 +5,31 @@
 #ifndef NET_SOCKET_SOCKET_H_
 #define NET_SOCKET_SOCKET_H_
 
+#include <vector>
+
+#include "base/memory/ref_counted.h"
 #include "net/base/completion_callback.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_export.h"
 
 namespace net {
 
-class IOBuffer;
+// One of the buffers of a vectored write, and the number of bytes to write
+// from it.
+struct NET_EXPORT WriteBuffer {
+  WriteBuffer(IOBuffer* buf, int buf_len);
+  ~WriteBuffer();
+
+  scoped_refptr<IOBuffer> buf;
+  int buf_len;
+};
+
+typedef std::vector<WriteBuffer> WriteBufferList;
+
+// Returns a single buffer with the data of |buffers|, for sockets that can't
+// write several at once.
+NET_EXPORT_PRIVATE scoped_refptr<IOBufferWithSize> MergeWriteBuffers(
+    const WriteBufferList& buffers);
 
 // Represents a read/write socket.
 class NET_EXPORT Socket {
@@ -46,6 +65,15 @@ class NET_EXPORT Socket {
   virtual int Write(IOBuffer* buf, int buf_len,
                     const CompletionCallback& callback) = 0;
 
+  // Writes the data of |buffers|, in order, as if they were a single buffer.
+  // Everything said about Write() applies: the data may be written partially,
+  // and the socket acquires references to the buffers of a pending write.
+  // |buffers| must not be empty, and each buffer must have data.
+  // Sockets that can hand several buffers to the OS at once override this;
+  // the default implementation copies them into one buffer for Write().
+  virtual int Writev(const WriteBufferList& buffers,
+                     const CompletionCallback& callback);
+
   // Set the receive buffer size (in bytes) for the socket.
   // Note: changing this value can affect the TCP window size on some platforms.
   // Returns true on success, or false on failure.
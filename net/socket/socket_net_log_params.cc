@@ -4,6 +4,8 @@
 
 #include "net/socket/socket_net_log_params.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/values.h"
 #include "net/base/host_port_pair.h"
@@ -69,4 +71,15 @@ NetLog::ParametersCallback CreateNetLogSourceAddressCallback(
   return base::Bind(&NetLogSourceAddressCallback, net_address, address_len);
 }
 
+void LogWriteBuffersSent(const BoundNetLog& net_log,
+                         const WriteBufferList& buffers,
+                         int bytes_sent) {
+  for (size_t i = 0; i < buffers.size() && bytes_sent > 0; ++i) {
+    int len = std::min(bytes_sent, buffers[i].buf_len);
+    net_log.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_SENT, len,
+                                 buffers[i].buf->data());
+    bytes_sent -= len;
+  }
+}
+
 }  // namespace net
@@ -7,6 +7,7 @@
 
 #include "net/base/net_log.h"
 #include "net/base/sys_addrinfo.h"
+#include "net/socket/socket.h"
 
 namespace net {
 
@@ -33,6 +34,12 @@ NetLog::ParametersCallback CreateNetLogSourceAddressCallback(
     const struct sockaddr* net_address,
     socklen_t address_len);
 
+// Adds a TYPE_SOCKET_BYTES_SENT event to |net_log| for each of |buffers|
+// that the first |bytes_sent| bytes of a vectored write came from.
+void LogWriteBuffersSent(const BoundNetLog& net_log,
+                         const WriteBufferList& buffers,
+                         int bytes_sent);
+
 }  // namespace net
 
 #endif  // NET_SOCKET_SOCKET_NET_LOG_PARAMS_H_
@@ -270,7 +270,8 @@ SSLSocketDataProvider::SSLSocketDataProvider(IoMode mode, int result)
       protocol_negotiated(kProtoUnknown),
       client_cert_sent(false),
       cert_request_info(NULL),
-      channel_id_sent(false) {
+      channel_id_sent(false),
+      false_started(false) {
 }
 
 SSLSocketDataProvider::~SSLSocketDataProvider() {
@@ -1419,6 +1420,10 @@ void MockSSLClientSocket::set_channel_id_sent(bool channel_id_sent) {
   data_->channel_id_sent = channel_id_sent;
 }
 
+bool MockSSLClientSocket::WasFalseStarted() const {
+  return data_->false_started;
+}
+
 ServerBoundCertService* MockSSLClientSocket::GetServerBoundCertService() const {
   return data_->server_bound_cert_service;
 }
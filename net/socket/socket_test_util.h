@@ -333,6 +333,7 @@ struct SSLSocketDataProvider {
   SSLCertRequestInfo* cert_request_info;
   scoped_refptr<X509Certificate> cert;
   bool channel_id_sent;
+  bool false_started;
   ServerBoundCertService* server_bound_cert_service;
 };
 
@@ -959,6 +960,7 @@ class MockSSLClientSocket : public MockClientSocket, public AsyncSocket {
 
   virtual bool WasChannelIDSent() const OVERRIDE;
   virtual void set_channel_id_sent(bool channel_id_sent) OVERRIDE;
+  virtual bool WasFalseStarted() const OVERRIDE;
   virtual ServerBoundCertService* GetServerBoundCertService() const OVERRIDE;
 
  private:
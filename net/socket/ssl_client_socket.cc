@@ -17,6 +17,7 @@ SSLClientSocket::SSLClientSocket()
       was_spdy_negotiated_(false),
       protocol_negotiated_(kProtoUnknown),
       channel_id_sent_(false),
+      false_started_(false),
       signed_cert_timestamps_received_(false),
       stapled_ocsp_response_received_(false) {
 }
@@ -146,6 +147,14 @@ void SSLClientSocket::set_channel_id_sent(bool channel_id_sent) {
   channel_id_sent_ = channel_id_sent;
 }
 
+bool SSLClientSocket::WasFalseStarted() const {
+  return false_started_;
+}
+
+void SSLClientSocket::set_false_started(bool false_started) {
+  false_started_ = false_started;
+}
+
 void SSLClientSocket::set_signed_cert_timestamps_received(
     bool signed_cert_timestamps_received) {
   signed_cert_timestamps_received_ = signed_cert_timestamps_received;
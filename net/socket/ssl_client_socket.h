@@ -132,9 +132,17 @@ class NET_EXPORT SSLClientSocket : public SSLSocket {
   // Public for ssl_client_socket_openssl_unittest.cc.
   virtual bool WasChannelIDSent() const;
 
+  // Returns true if the handshake was False Started, i.e. the connection was
+  // reported as established, and accepts application data, before the
+  // server's Finished message was received. This saves a round trip before
+  // the first request can be sent.
+  virtual bool WasFalseStarted() const;
+
  protected:
   virtual void set_channel_id_sent(bool channel_id_sent);
 
+  virtual void set_false_started(bool false_started);
+
   virtual void set_signed_cert_timestamps_received(
       bool signed_cert_timestamps_received);
 
@@ -171,6 +179,8 @@ class NET_EXPORT SSLClientSocket : public SSLSocket {
   NextProto protocol_negotiated_;
   // True if a channel ID was sent.
   bool channel_id_sent_;
+  // True if the handshake was False Started.
+  bool false_started_;
   // True if SCTs were received via a TLS extension.
   bool signed_cert_timestamps_received_;
   // True if a stapled OCSP response was received.
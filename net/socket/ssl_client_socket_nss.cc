@@ -416,6 +416,7 @@ struct HandshakeState {
     sct_list_from_tls_extension.clear();
     stapled_ocsp_response.clear();
     resumed_handshake = false;
+    false_started = false;
     ssl_connection_status = 0;
   }
 
@@ -452,6 +453,10 @@ struct HandshakeState {
   // True if the current handshake was the result of TLS session resumption.
   bool resumed_handshake;
 
+  // True if the current handshake was False Started, so that it completes
+  // after the first application data is sent.
+  bool false_started;
+
   // The negotiated security parameters (TLS version, cipher, extensions) of
   // the SSL connection.
   int ssl_connection_status;
@@ -1825,6 +1830,7 @@ int SSLClientSocketNSS::Core::DoHandshake() {
   } else if (rv == SECSuccess) {
     if (!handshake_callback_called_) {
       false_started_ = true;
+      nss_handshake_state_.false_started = true;
       HandshakeSucceeded();
     }
   } else {
@@ -2090,7 +2096,7 @@ int SSLClientSocketNSS::Core::BufferRecv() {
     // buffer too full to read into, so no I/O possible at moment
     rv = ERR_IO_PENDING;
   } else {
-    scoped_refptr<IOBuffer> read_buffer(new IOBuffer(nb));
+    scoped_refptr<IOBuffer> read_buffer(new PooledIOBuffer(nb));
     if (OnNetworkTaskRunner()) {
       rv = DoBufferRecv(read_buffer.get(), nb);
     } else {
@@ -2132,7 +2138,7 @@ int SSLClientSocketNSS::Core::BufferSend() {
 
   int rv = 0;
   if (len) {
-    scoped_refptr<IOBuffer> send_buffer(new IOBuffer(len));
+    scoped_refptr<IOBuffer> send_buffer(new PooledIOBuffer(len));
     memcpy(send_buffer->data(), buf1, len1);
     memcpy(send_buffer->data() + len1, buf2, len2);
 
@@ -3348,6 +3354,7 @@ int SSLClientSocketNSS::DoHandshakeComplete(int result) {
     // Done!
   }
   set_channel_id_sent(core_->state().channel_id_sent);
+  set_false_started(core_->state().false_started);
   set_signed_cert_timestamps_received(
       !core_->state().sct_list_from_tls_extension.empty());
   set_stapled_ocsp_response_received(
@@ -14,8 +14,10 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/debug/alias.h"
+#include "base/hash.h"
 #include "base/memory/singleton.h"
 #include "base/metrics/histogram.h"
+#include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
 #include "crypto/ec_private_key.h"
 #include "crypto/openssl_util.h"
@@ -232,12 +234,26 @@ struct SslSetClearMask {
   long clear_mask;
 };
 
+// Returns a hash of the settings of |ssl_config| that a session must have
+// been negotiated with to be resumed, e.g. not by a version fallback.
+std::string GetSSLConfigCacheKey(const SSLConfig& ssl_config) {
+  std::string settings = base::StringPrintf("%x-%x-%d",
+                                            ssl_config.version_min,
+                                            ssl_config.version_max,
+                                            ssl_config.channel_id_enabled);
+  for (size_t i = 0; i < ssl_config.disabled_cipher_suites.size(); ++i)
+    base::StringAppendF(&settings, "-%x", ssl_config.disabled_cipher_suites[i]);
+  return base::StringPrintf("%08x", base::Hash(settings));
+}
+
 // Compute a unique key string for the SSL session cache. |socket| is an
 // input socket object. Return a string.
 std::string GetSocketSessionCacheKey(const SSLClientSocketOpenSSL& socket) {
   std::string result = socket.host_and_port().ToString();
   result.append("/");
   result.append(socket.ssl_session_cache_shard());
+  result.append("/");
+  result.append(GetSSLConfigCacheKey(socket.ssl_config()));
   return result;
 }
 
@@ -336,6 +352,27 @@ void SSLClientSocket::ClearSessionCache() {
   OpenSSLClientKeyStore::GetInstance()->Flush();
 }
 
+// static
+void SSLClientSocketOpenSSL::ExportSessionCache(
+    size_t max_sessions,
+    SSLSessionCacheOpenSSL::SerializedSessionList* sessions) {
+  SSLContext::GetInstance()->session_cache()->ExportSessions(max_sessions,
+                                                             sessions);
+}
+
+// static
+void SSLClientSocketOpenSSL::ImportSessionCache(
+    const SSLSessionCacheOpenSSL::SerializedSessionList& sessions) {
+  SSLSessionCacheOpenSSL* session_cache =
+      SSLContext::GetInstance()->session_cache();
+  for (size_t i = 0; i < sessions.size(); ++i) {
+    if (!session_cache->ImportSession(sessions[i].cache_key,
+                                      sessions[i].data)) {
+      DVLOG(1) << "Dropping session for " << sessions[i].cache_key;
+    }
+  }
+}
+
 SSLClientSocketOpenSSL::SSLClientSocketOpenSSL(
     scoped_ptr<ClientSocketHandle> transport_socket,
     const HostPortPair& host_and_port,
@@ -714,6 +751,15 @@ bool SSLClientSocketOpenSSL::Init() {
   mode.ConfigureFlag(SSL_MODE_SMALL_BUFFERS, true);
 #endif
 
+#if defined(SSL_MODE_HANDSHAKE_CUTTHROUGH)
+  // Handshake cut-through is OpenSSL's False Start: the handshake completes
+  // once the client's Finished message is sent, when the negotiated cipher
+  // suite and NPN allow it, so that the first request goes out in the same
+  // flight instead of waiting for the server's Finished message.
+  mode.ConfigureFlag(SSL_MODE_HANDSHAKE_CUTTHROUGH,
+                     ssl_config_.false_start_enabled);
+#endif
+
   SSL_set_mode(ssl_, mode.set_mask);
   SSL_clear_mode(ssl_, mode.clear_mask);
 
@@ -822,6 +868,9 @@ int SSLClientSocketOpenSSL::DoHandshake() {
       DVLOG(2) << "Result of session reuse for " << host_and_port_.ToString()
                << " is: " << (SSL_session_reused(ssl_) ? "Success" : "Fail");
     }
+#if defined(SSL_MODE_HANDSHAKE_CUTTHROUGH)
+    set_false_started(SSL_cutthrough_complete(ssl_) != 0);
+#endif
     // SSL handshake is completed.  Let's verify the certificate.
     const bool got_cert = !!UpdateServerCert();
     DCHECK(got_cert);
@@ -1157,7 +1206,8 @@ int SSLClientSocketOpenSSL::BufferSend(void) {
     size_t max_read = BIO_ctrl_pending(transport_bio_);
     if (!max_read)
       return 0;  // Nothing pending in the OpenSSL write BIO.
-    send_buffer_ = new DrainableIOBuffer(new IOBuffer(max_read), max_read);
+    send_buffer_ = new DrainableIOBuffer(new PooledIOBuffer(max_read),
+                                         max_read);
     int read_bytes = BIO_read(transport_bio_, send_buffer_->data(), max_read);
     DCHECK_GT(read_bytes, 0);
     CHECK_EQ(static_cast<int>(max_read), read_bytes);
@@ -1202,7 +1252,7 @@ int SSLClientSocketOpenSSL::BufferRecv(void) {
   if (!max_write)
     return ERR_IO_PENDING;
 
-  recv_buffer_ = new IOBuffer(max_write);
+  recv_buffer_ = new PooledIOBuffer(max_write);
   int rv = transport_->socket()->Read(
       recv_buffer_.get(),
       max_write,
@@ -15,6 +15,7 @@
 #include "net/cert/cert_verify_result.h"
 #include "net/socket/client_socket_handle.h"
 #include "net/socket/ssl_client_socket.h"
+#include "net/socket/ssl_session_cache_openssl.h"
 #include "net/ssl/server_bound_cert_service.h"
 #include "net/ssl/ssl_config_service.h"
 
@@ -52,6 +53,20 @@ class SSLClientSocketOpenSSL : public SSLClientSocket {
   const std::string& ssl_session_cache_shard() const {
     return ssl_session_cache_shard_;
   }
+  const SSLConfig& ssl_config() const { return ssl_config_; }
+
+  // Serializes the sessions of the most used hosts of the session cache that
+  // all SSLClientSocketOpenSSLs share. See
+  // SSLSessionCacheOpenSSL::ExportSessions().
+  static void ExportSessionCache(
+      size_t max_sessions,
+      SSLSessionCacheOpenSSL::SerializedSessionList* sessions);
+
+  // Adds |sessions|, exported by ExportSessionCache() in a previous process,
+  // to the shared session cache, so that the first connections to their hosts
+  // do an abbreviated handshake.
+  static void ImportSessionCache(
+      const SSLSessionCacheOpenSSL::SerializedSessionList& sessions);
 
   // SSLClientSocket implementation.
   virtual void GetSSLCertRequestInfo(
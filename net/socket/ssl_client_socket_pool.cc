@@ -361,6 +361,7 @@ int SSLConnectJob::DoSSLConnectComplete(int result) {
   if (result == OK ||
       ssl_socket_->IgnoreCertError(result, params_->load_flags())) {
     DCHECK(!connect_timing_.ssl_start.is_null());
+    connect_timing_.ssl_false_started = ssl_socket_->WasFalseStarted();
     base::TimeDelta connect_duration =
         connect_timing_.ssl_end - connect_timing_.ssl_start;
     if (using_spdy) {
@@ -611,6 +612,11 @@ void SSLClientSocketPool::CloseIdleSockets() {
   base_.CloseIdleSockets();
 }
 
+void SSLClientSocketPool::CloseIdleSocketsInGroup(
+    const std::string& group_name) {
+  base_.CloseIdleSocketsInGroup(group_name);
+}
+
 int SSLClientSocketPool::IdleSocketCount() const {
   return base_.idle_socket_count();
 }
@@ -243,6 +243,9 @@ class NET_EXPORT_PRIVATE SSLClientSocketPool
 
   virtual ClientSocketPoolHistograms* histograms() const OVERRIDE;
 
+  // Closes the idle sockets of |group_name|, if there are any.
+  void CloseIdleSocketsInGroup(const std::string& group_name);
+
   // LowerLayeredPool implementation.
   virtual bool IsStalled() const OVERRIDE;
 
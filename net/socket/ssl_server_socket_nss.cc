@@ -551,7 +551,7 @@ int SSLServerSocketNSS::BufferSend(void) {
 
   int rv = 0;
   if (len) {
-    scoped_refptr<IOBuffer> send_buffer(new IOBuffer(len));
+    scoped_refptr<IOBuffer> send_buffer(new PooledIOBuffer(len));
     memcpy(send_buffer->data(), buf1, len1);
     memcpy(send_buffer->data() + len1, buf2, len2);
     rv = transport_socket_->Write(
@@ -585,7 +585,7 @@ int SSLServerSocketNSS::BufferRecv(void) {
     // buffer too full to read into, so no I/O possible at moment
     rv = ERR_IO_PENDING;
   } else {
-    recv_buffer_ = new IOBuffer(nb);
+    recv_buffer_ = new PooledIOBuffer(nb);
     rv = transport_socket_->Read(
         recv_buffer_.get(),
         nb,
@@ -4,8 +4,10 @@
 
 #include "net/socket/ssl_session_cache_openssl.h"
 
+#include <algorithm>
 #include <list>
 #include <map>
+#include <utility>
 
 #include <openssl/rand.h>
 #include <openssl/ssl.h>
@@ -127,6 +129,10 @@ namespace net {
 //   of |key_index_|. If is used to efficiently remove sessions from the cache,
 //   as well as check for the existence of a session ID value in the cache.
 //
+//   |use_counts_| is a hash table mapping the keys of |key_index_| to the
+//   number of times their sessions were resumed. It is used to find the most
+//   used sessions when exporting them.
+//
 //   SSL_SESSION objects are reference-counted, and owned by the cache. This
 //   means that their reference count is incremented when they are added, and
 //   decremented when they are removed.
@@ -232,6 +238,7 @@ class SSLSessionCacheOpenSSLImpl {
     ordering_.push_front(session);
     ordering_.erase(it->second);
     it->second = ordering_.begin();
+    ++use_counts_[cache_key];
 
     return SSL_set_session(ssl, session) == 1;
   }
@@ -251,6 +258,7 @@ class SSLSessionCacheOpenSSLImpl {
     base::AutoLock lock(lock_);
     id_index_.clear();
     key_index_.clear();
+    use_counts_.clear();
     while (!ordering_.empty()) {
       SSL_SESSION* session = ordering_.front();
       ordering_.pop_front();
@@ -258,6 +266,84 @@ class SSLSessionCacheOpenSSLImpl {
     }
   }
 
+  void ExportSessions(size_t max_sessions,
+                      SSLSessionCacheOpenSSL::SerializedSessionList* sessions) {
+    base::AutoLock locked(lock_);
+    DCHECK(sessions);
+    sessions->clear();
+
+    // Order the keys by use count, keeping the MRU order between equally used
+    // ones.
+    std::vector<std::pair<size_t, KeyIndex::const_iterator> > keys;
+    for (MRUSessionList::const_iterator it = ordering_.begin();
+         it != ordering_.end(); ++it) {
+      SessionIdIndex::const_iterator id_it = id_index_.find(SessionId(*it));
+      DCHECK(id_it != id_index_.end());
+      KeyIndex::const_iterator key_it = id_it->second;
+      UseCountMap::const_iterator count_it = use_counts_.find(key_it->first);
+      size_t use_count = count_it == use_counts_.end() ? 0 : count_it->second;
+      keys.push_back(std::make_pair(use_count, key_it));
+    }
+    std::stable_sort(keys.begin(), keys.end(), CompareUseCounts);
+
+    long now = static_cast<long>(::time(NULL));
+    for (size_t n = 0; n < keys.size() && sessions->size() < max_sessions;
+         ++n) {
+      SSL_SESSION* session = *keys[n].second->second;
+      if (!SSL_SESSION_get_ex_data(session, GetSSLSessionExIndex()) ||
+          session->time + session->timeout <= now) {
+        continue;
+      }
+      int length = i2d_SSL_SESSION(session, NULL);
+      if (length <= 0)
+        continue;
+      SSLSessionCacheOpenSSL::SerializedSession serialized;
+      serialized.cache_key = keys[n].second->first;
+      serialized.data.resize(length);
+      unsigned char* data =
+          reinterpret_cast<unsigned char*>(&serialized.data[0]);
+      if (i2d_SSL_SESSION(session, &data) != length)
+        continue;
+      sessions->push_back(serialized);
+    }
+  }
+
+  bool ImportSession(const std::string& cache_key, const std::string& data) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(
+        data.data());
+    SSL_SESSION* session = d2i_SSL_SESSION(NULL, &p, data.size());
+    if (!session)
+      return false;
+    if (session->session_id_length == 0 ||
+        session->time + session->timeout <=
+            static_cast<long>(::time(NULL))) {
+      SSL_SESSION_free(session);
+      return false;
+    }
+
+    base::AutoLock locked(lock_);
+    if (key_index_.find(cache_key) != key_index_.end() ||
+        id_index_.find(SessionId(session)) != id_index_.end()) {
+      // Keep the session of the current process, which is at least as fresh.
+      SSL_SESSION_free(session);
+      return true;
+    }
+    SSL_SESSION_set_ex_data(
+        session, GetSSLSessionExIndex(), reinterpret_cast<void*>(1));
+    // Imported sessions are older than the others, so they go to the back of
+    // the MRU list.
+    ordering_.push_back(session);
+    KeyIndex::iterator it =
+        key_index_.insert(std::make_pair(cache_key, --ordering_.end())).first;
+    id_index_[SessionId(session)] = it;
+
+    if (key_index_.size() > config_.max_entries)
+      ShrinkCacheLocked();
+
+    DCHECK_EQ(key_index_.size(), id_index_.size());
+    return true;
+  }
+
  private:
   // Type for list of SSL_SESSION handles, ordered in MRU order.
   typedef std::list<SSL_SESSION*> MRUSessionList;
@@ -265,6 +351,15 @@ class SSLSessionCacheOpenSSLImpl {
   typedef base::hash_map<std::string, MRUSessionList::iterator> KeyIndex;
   // Type for a dictionary from SessionId values to key index nodes.
   typedef base::hash_map<SessionId, KeyIndex::iterator> SessionIdIndex;
+  // Type for a dictionary from unique cache keys to the number of times their
+  // sessions were resumed.
+  typedef base::hash_map<std::string, size_t> UseCountMap;
+
+  static bool CompareUseCounts(
+      const std::pair<size_t, KeyIndex::const_iterator>& a,
+      const std::pair<size_t, KeyIndex::const_iterator>& b) {
+    return a.first > b.first;
+  }
 
   // Return the key associated with a given session, or the empty string if
   // none exist. This shall only be used for debugging.
@@ -299,6 +394,7 @@ class SSLSessionCacheOpenSSLImpl {
 
     id_index_.erase(session_id);
     ordering_.erase(key_it->second);
+    use_counts_.erase(key_it->first);
     key_index_.erase(key_it);
 
     SSL_SESSION_free(session);
@@ -474,6 +570,7 @@ class SSLSessionCacheOpenSSLImpl {
   MRUSessionList ordering_;
   KeyIndex key_index_;
   SessionIdIndex id_index_;
+  UseCountMap use_counts_;
 
   size_t expiration_check_;
 };
@@ -505,4 +602,14 @@ void SSLSessionCacheOpenSSL::MarkSSLSessionAsGood(SSL* ssl) {
 
 void SSLSessionCacheOpenSSL::Flush() { impl_->Flush(); }
 
+void SSLSessionCacheOpenSSL::ExportSessions(size_t max_sessions,
+                                            SerializedSessionList* sessions) {
+  impl_->ExportSessions(max_sessions, sessions);
+}
+
+bool SSLSessionCacheOpenSSL::ImportSession(const std::string& cache_key,
+                                           const std::string& data) {
+  return impl_->ImportSession(cache_key, data);
+}
+
 }  // namespace net
@@ -6,6 +6,7 @@
 #define NET_SOCKET_SSL_SESSION_CACHE_OPENSSL_H
 
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "net/base/net_export.h"
@@ -44,6 +45,10 @@ class SSLSessionCacheOpenSSLImpl;
 //  - Clients can call Flush() to remove all sessions from the cache, this is
 //    useful when the system's certificate store has changed.
 //
+//  - Clients can call ExportSessions() to serialize the sessions of the most
+//    used keys, and ImportSession() to add them to a cache again, e.g. to warm
+//    up the cache of a new process.
+//
 // This class is thread-safe. There shouldn't be any issue with multiple
 // SSL connections being performed in parallel in multiple threads.
 class NET_EXPORT SSLSessionCacheOpenSSL {
@@ -66,6 +71,13 @@ class NET_EXPORT SSLSessionCacheOpenSSL {
     int timeout_seconds;
   };
 
+  // A session serialized by ExportSessions(), along with its cache key.
+  struct SerializedSession {
+    std::string cache_key;
+    std::string data;
+  };
+  typedef std::vector<SerializedSession> SerializedSessionList;
+
   SSLSessionCacheOpenSSL() : impl_(NULL) {}
 
   // Construct a new cache instance.
@@ -125,6 +137,18 @@ class NET_EXPORT SSLSessionCacheOpenSSL {
   // the system's certificate store has changed.
   void Flush();
 
+  // Serializes the good, unexpired sessions of up to |max_sessions| cache keys
+  // into |sessions|, starting with the keys whose sessions were resumed the
+  // most. The serialized data holds session secrets, and must be stored
+  // accordingly.
+  void ExportSessions(size_t max_sessions, SerializedSessionList* sessions);
+
+  // Adds the session serialized in |data| by ExportSessions() for
+  // |cache_key|, unless the cache already has a session for it. The session
+  // was validated before it was exported, so it's marked as good. Returns
+  // false if |data| can't be parsed, or holds an expired session.
+  bool ImportSession(const std::string& cache_key, const std::string& data);
+
   // TODO(digit): Move to client code.
   static const int kDefaultTimeoutSeconds = 60 * 60;
   static const size_t kMaxEntries = 1024;
@@ -375,4 +375,71 @@ TEST_F(SSLSessionCacheOpenSSLTest, CheckExpiration) {
   EXPECT_EQ(1U, cache_.size());
 }
 
+// Check that the sessions of the most used keys are exported first, and that
+// exported sessions can be resumed after they are imported in another cache.
+TEST_F(SSLSessionCacheOpenSSLTest, ExportAndImportSessions) {
+  const char* const kKeys[] = { "rare", "popular", "never-resumed" };
+  for (size_t n = 0; n < arraysize(kKeys); ++n) {
+    ScopedSSL ssl(NewSSL(kKeys[n]));
+    // Sessions without a cipher can't be serialized. The cipher isn't
+    // negotiated since the unit test doesn't connect.
+    ssl.get()->session->cipher_id = 0x0300002F;  // TLS_RSA_WITH_AES_128_CBC_SHA
+    AddToCache(ssl.get());
+    cache_.MarkSSLSessionAsGood(ssl.get());
+  }
+  ScopedSSL not_good_ssl(NewSSL("not-good"));
+  not_good_ssl.get()->session->cipher_id = 0x0300002F;
+  AddToCache(not_good_ssl.get());
+  not_good_ssl.reset(NULL);
+
+  for (int n = 0; n < 3; ++n) {
+    ScopedSSL ssl(NewSSL("popular"));
+    EXPECT_TRUE(cache_.SetSSLSessionWithKey(ssl.get(), "popular"));
+  }
+  ScopedSSL rare_ssl(NewSSL("rare"));
+  EXPECT_TRUE(cache_.SetSSLSessionWithKey(rare_ssl.get(), "rare"));
+  rare_ssl.reset(NULL);
+
+  SSLSessionCacheOpenSSL::SerializedSessionList sessions;
+  cache_.ExportSessions(2, &sessions);
+  ASSERT_EQ(2U, sessions.size());
+  EXPECT_EQ("popular", sessions[0].cache_key);
+  EXPECT_EQ("rare", sessions[1].cache_key);
+
+  // Sessions that aren't good aren't exported.
+  cache_.ExportSessions(10, &sessions);
+  ASSERT_EQ(3U, sessions.size());
+  EXPECT_EQ("never-resumed", sessions[2].cache_key);
+
+  cache_.Flush();
+  EXPECT_FALSE(cache_.ImportSession("garbage", "not a session"));
+  for (size_t n = 0; n < sessions.size(); ++n)
+    EXPECT_TRUE(cache_.ImportSession(sessions[n].cache_key, sessions[n].data));
+  EXPECT_EQ(3U, cache_.size());
+
+  // Imported sessions are good, and resumed.
+  ScopedSSL ssl(NewSSL("popular"));
+  EXPECT_TRUE(cache_.SetSSLSessionWithKey(ssl.get(), "popular"));
+}
+
+// Check that importing a session doesn't replace the current one.
+TEST_F(SSLSessionCacheOpenSSLTest, ImportKeepsCurrentSession) {
+  const std::string key("hello");
+  ScopedSSL ssl(NewSSL(key));
+  ssl.get()->session->cipher_id = 0x0300002F;
+  AddToCache(ssl.get());
+  cache_.MarkSSLSessionAsGood(ssl.get());
+
+  SSLSessionCacheOpenSSL::SerializedSessionList sessions;
+  cache_.ExportSessions(1, &sessions);
+  ASSERT_EQ(1U, sessions.size());
+
+  ScopedSSL ssl2(NewSSL(key));
+  AddToCache(ssl2.get());
+  SSL_SESSION* session2 = ssl2.get()->session;
+  EXPECT_TRUE(cache_.ImportSession(key, sessions[0].data));
+  EXPECT_EQ(1U, cache_.size());
+  EXPECT_EQ(2, session2->references);
+}
+
 }  // namespace net
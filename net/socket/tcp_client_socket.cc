@@ -269,6 +269,19 @@ int TCPClientSocket::Write(IOBuffer* buf,
   return result;
 }
 
+int TCPClientSocket::Writev(const WriteBufferList& buffers,
+                            const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+
+  CompletionCallback write_callback = base::Bind(
+      &TCPClientSocket::DidCompleteReadWrite, base::Unretained(this), callback);
+  int result = socket_->Writev(buffers, write_callback);
+  if (result > 0)
+    use_history_.set_was_used_to_convey_data();
+
+  return result;
+}
+
 bool TCPClientSocket::SetReceiveBufferSize(int32 size) {
   return socket_->SetReceiveBufferSize(size);
 }
@@ -6,10 +6,15 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <vector>
 
 #include "base/callback_helpers.h"
 #include "base/logging.h"
@@ -425,6 +430,51 @@ int TCPSocketLibevent::Write(IOBuffer* buf,
   return ERR_IO_PENDING;
 }
 
+int TCPSocketLibevent::Writev(const WriteBufferList& buffers,
+                              const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(!waiting_connect_);
+  DCHECK(write_callback_.is_null());
+  // Synchronous operation not supported
+  DCHECK(!callback.is_null());
+  DCHECK(!buffers.empty());
+
+  // TCP Fast Open sends the first write with sendto(), which takes a single
+  // buffer.
+  if (buffers.size() == 1)
+    return Write(buffers[0].buf.get(), buffers[0].buf_len, callback);
+  if (use_tcp_fastopen_ && !tcp_fastopen_connected_) {
+    scoped_refptr<IOBufferWithSize> merged = MergeWriteBuffers(buffers);
+    return Write(merged.get(), merged->size(), callback);
+  }
+
+  int nwrite = InternalWritev(buffers);
+  if (nwrite >= 0) {
+    base::StatsCounter write_bytes("tcp.write_bytes");
+    write_bytes.Add(nwrite);
+    LogWriteBuffersSent(net_log_, buffers, nwrite);
+    return nwrite;
+  }
+  if (errno != EAGAIN && errno != EWOULDBLOCK) {
+    int net_error = MapSystemError(errno);
+    net_log_.AddEvent(NetLog::TYPE_SOCKET_WRITE_ERROR,
+                      CreateNetLogSocketErrorCallback(net_error, errno));
+    return net_error;
+  }
+
+  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+          socket_, true, base::MessageLoopForIO::WATCH_WRITE,
+          &write_socket_watcher_, &write_watcher_)) {
+    DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
+    return MapSystemError(errno);
+  }
+
+  write_buffers_ = buffers;
+  write_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
 int TCPSocketLibevent::GetLocalAddress(IPEndPoint* address) const {
   DCHECK(CalledOnValidThread());
   DCHECK(address);
@@ -560,6 +610,7 @@ void TCPSocketLibevent::Close() {
   if (!write_callback_.is_null()) {
     write_buf_ = NULL;
     write_buf_len_ = 0;
+    write_buffers_.clear();
     write_callback_.Reset();
   }
 
@@ -753,16 +804,24 @@ void TCPSocketLibevent::DidCompleteWrite() {
     return;
 
   int bytes_transferred;
-  bytes_transferred = HANDLE_EINTR(write(socket_, write_buf_->data(),
-                                         write_buf_len_));
+  if (!write_buffers_.empty()) {
+    bytes_transferred = InternalWritev(write_buffers_);
+  } else {
+    bytes_transferred = HANDLE_EINTR(write(socket_, write_buf_->data(),
+                                           write_buf_len_));
+  }
 
   int result;
   if (bytes_transferred >= 0) {
     result = bytes_transferred;
     base::StatsCounter write_bytes("tcp.write_bytes");
     write_bytes.Add(bytes_transferred);
-    net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_SENT, result,
-                                  write_buf_->data());
+    if (!write_buffers_.empty()) {
+      LogWriteBuffersSent(net_log_, write_buffers_, result);
+    } else {
+      net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_SENT, result,
+                                    write_buf_->data());
+    }
   } else {
     result = MapSystemError(errno);
     if (result != ERR_IO_PENDING) {
@@ -774,6 +833,7 @@ void TCPSocketLibevent::DidCompleteWrite() {
   if (result != ERR_IO_PENDING) {
     write_buf_ = NULL;
     write_buf_len_ = 0;
+    write_buffers_.clear();
     write_socket_watcher_.StopWatchingFileDescriptor();
     base::ResetAndReturn(&write_callback_).Run(result);
   }
@@ -868,6 +928,18 @@ int TCPSocketLibevent::InternalWrite(IOBuffer* buf, int buf_len) {
   return nwrite;
 }
 
+int TCPSocketLibevent::InternalWritev(const WriteBufferList& buffers) {
+  // Buffers beyond IOV_MAX are left for the next write, like any other
+  // partially written data.
+  std::vector<struct iovec> iov(std::min<size_t>(buffers.size(), IOV_MAX));
+  for (size_t i = 0; i < iov.size(); ++i) {
+    DCHECK_GT(buffers[i].buf_len, 0);
+    iov[i].iov_base = buffers[i].buf->data();
+    iov[i].iov_len = buffers[i].buf_len;
+  }
+  return HANDLE_EINTR(writev(socket_, &iov[0], iov.size()));
+}
+
 void TCPSocketLibevent::RecordFastOpenStatus() {
   if (use_tcp_fastopen_ &&
       (fast_open_status_ == FAST_OPEN_FAST_CONNECT_RETURN ||
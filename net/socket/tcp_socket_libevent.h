@@ -16,6 +16,7 @@
 #include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
+#include "net/socket/socket.h"
 #include "net/socket/socket_descriptor.h"
 
 namespace net {
@@ -48,6 +49,9 @@ class NET_EXPORT TCPSocketLibevent : public base::NonThreadSafe {
   // Full duplex mode (reading and writing at the same time) is supported.
   int Read(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
   int Write(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
+  // Writes |buffers| with a single writev() call.
+  int Writev(const WriteBufferList& buffers,
+             const CompletionCallback& callback);
 
   int GetLocalAddress(IPEndPoint* address) const;
   int GetPeerAddress(IPEndPoint* address) const;
@@ -172,6 +176,7 @@ class NET_EXPORT TCPSocketLibevent : public base::NonThreadSafe {
 
   // Internal function to write to a socket. Returns an OS error.
   int InternalWrite(IOBuffer* buf, int buf_len);
+  int InternalWritev(const WriteBufferList& buffers);
 
   // Called when the socket is known to be in a connected state.
   void RecordFastOpenStatus();
@@ -201,6 +206,9 @@ class NET_EXPORT TCPSocketLibevent : public base::NonThreadSafe {
   scoped_refptr<IOBuffer> write_buf_;
   int write_buf_len_;
 
+  // The buffers used for vectored writes, instead of |write_buf_|.
+  WriteBufferList write_buffers_;
+
   // External callback; called when read is complete.
   CompletionCallback read_callback_;
 
@@ -259,5 +259,60 @@ TEST_F(TCPSocketTest, ReadWrite) {
   ASSERT_EQ(message, received_message);
 }
 
+TEST_F(TCPSocketTest, Writev) {
+  ASSERT_NO_FATAL_FAILURE(SetUpListenIPv4());
+
+  TestCompletionCallback connect_callback;
+  TCPSocket connecting_socket(NULL, NetLog::Source());
+  int result = connecting_socket.Open(ADDRESS_FAMILY_IPV4);
+  ASSERT_EQ(OK, result);
+  connecting_socket.Connect(local_address_, connect_callback.callback());
+
+  TestCompletionCallback accept_callback;
+  scoped_ptr<TCPSocket> accepted_socket;
+  IPEndPoint accepted_address;
+  result = socket_.Accept(&accepted_socket, &accepted_address,
+                          accept_callback.callback());
+  ASSERT_EQ(OK, accept_callback.GetResult(result));
+  ASSERT_TRUE(accepted_socket.get());
+  EXPECT_EQ(OK, connect_callback.WaitForResult());
+
+  const char* const kParts[] = { "test ", "vectored ", "message" };
+  WriteBufferList buffers;
+  std::string message;
+  for (size_t i = 0; i < arraysize(kParts); ++i) {
+    buffers.push_back(WriteBuffer(new StringIOBuffer(kParts[i]),
+                                  strlen(kParts[i])));
+    message += kParts[i];
+  }
+  EXPECT_EQ(message, std::string(MergeWriteBuffers(buffers)->data(),
+                                 message.size()));
+
+  // A small write to a fresh loopback connection is written at once.
+  TestCompletionCallback write_callback;
+  int write_result =
+      accepted_socket->Writev(buffers, write_callback.callback());
+  ASSERT_EQ(static_cast<int>(message.size()),
+            write_callback.GetResult(write_result));
+
+  std::vector<char> buffer(message.size());
+  size_t bytes_read = 0;
+  while (bytes_read < message.size()) {
+    scoped_refptr<IOBufferWithSize> read_buffer(
+        new IOBufferWithSize(message.size() - bytes_read));
+    TestCompletionCallback read_callback;
+    int read_result = connecting_socket.Read(
+        read_buffer.get(), read_buffer->size(), read_callback.callback());
+    read_result = read_callback.GetResult(read_result);
+    ASSERT_TRUE(read_result > 0);
+    ASSERT_TRUE(bytes_read + read_result <= message.size());
+    memmove(&buffer[bytes_read], read_buffer->data(), read_result);
+    bytes_read += read_result;
+  }
+
+  std::string received_message(buffer.begin(), buffer.end());
+  ASSERT_EQ(message, received_message);
+}
+
 }  // namespace
 }  // namespace net
@@ -6,6 +6,8 @@
 
 #include <mstcpip.h>
 
+#include <vector>
+
 #include "base/callback_helpers.h"
 #include "base/logging.h"
 #include "base/metrics/stats_counters.h"
@@ -145,7 +147,7 @@ class TCPSocketWin::Core : public base::RefCounted<Core> {
 
   // The buffers used in Read() and Write().
   scoped_refptr<IOBuffer> read_iobuffer_;
-  scoped_refptr<IOBuffer> write_iobuffer_;
+  WriteBufferList write_buffers_;
   int read_buffer_length_;
   int write_buffer_length_;
 
@@ -474,24 +476,34 @@ int TCPSocketWin::Read(IOBuffer* buf,
 int TCPSocketWin::Write(IOBuffer* buf,
                         int buf_len,
                         const CompletionCallback& callback) {
+  return Writev(WriteBufferList(1, WriteBuffer(buf, buf_len)), callback);
+}
+
+int TCPSocketWin::Writev(const WriteBufferList& buffers,
+                         const CompletionCallback& callback) {
   DCHECK(CalledOnValidThread());
   DCHECK_NE(socket_, INVALID_SOCKET);
   DCHECK(!waiting_write_);
   DCHECK(write_callback_.is_null());
-  DCHECK_GT(buf_len, 0);
-  DCHECK(!core_->write_iobuffer_);
+  DCHECK(!buffers.empty());
+  DCHECK(core_->write_buffers_.empty());
 
   base::StatsCounter writes("tcp.writes");
   writes.Increment();
 
-  WSABUF write_buffer;
-  write_buffer.len = buf_len;
-  write_buffer.buf = buf->data();
+  std::vector<WSABUF> write_buffers(buffers.size());
+  int buf_len = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    DCHECK_GT(buffers[i].buf_len, 0);
+    write_buffers[i].len = buffers[i].buf_len;
+    write_buffers[i].buf = buffers[i].buf->data();
+    buf_len += buffers[i].buf_len;
+  }
 
   // TODO(wtc): Remove the assertion after enough testing.
   AssertEventNotSignaled(core_->write_overlapped_.hEvent);
   DWORD num;
-  int rv = WSASend(socket_, &write_buffer, 1, &num, 0,
+  int rv = WSASend(socket_, &write_buffers[0], write_buffers.size(), &num, 0,
                    &core_->write_overlapped_, NULL);
   if (rv == 0) {
     if (ResetEventIfSignaled(core_->write_overlapped_.hEvent)) {
@@ -505,8 +517,7 @@ int TCPSocketWin::Write(IOBuffer* buf,
       }
       base::StatsCounter write_bytes("tcp.write_bytes");
       write_bytes.Add(rv);
-      net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_SENT, rv,
-                                    buf->data());
+      LogWriteBuffersSent(net_log_, buffers, rv);
       return rv;
     }
   } else {
@@ -520,7 +531,7 @@ int TCPSocketWin::Write(IOBuffer* buf,
   }
   waiting_write_ = true;
   write_callback_ = callback;
-  core_->write_iobuffer_ = buf;
+  core_->write_buffers_ = buffers;
   core_->write_buffer_length_ = buf_len;
   core_->WatchForWrite();
   return ERR_IO_PENDING;
@@ -939,12 +950,11 @@ void TCPSocketWin::DidCompleteWrite() {
     } else {
       base::StatsCounter write_bytes("tcp.write_bytes");
       write_bytes.Add(num_bytes);
-      net_log_.AddByteTransferEvent(NetLog::TYPE_SOCKET_BYTES_SENT, num_bytes,
-                                    core_->write_iobuffer_->data());
+      LogWriteBuffersSent(net_log_, core_->write_buffers_, num_bytes);
     }
   }
 
-  core_->write_iobuffer_ = NULL;
+  core_->write_buffers_.clear();
 
   DCHECK_NE(rv, ERR_IO_PENDING);
   base::ResetAndReturn(&write_callback_).Run(rv);
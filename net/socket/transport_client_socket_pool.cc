@@ -33,6 +33,9 @@ namespace net {
 // don't synchronize.
 const int TransportConnectJob::kIPv6FallbackTimerInMs = 300;
 
+const int IPv6FallbackDelayEstimator::kMinFallbackDelayMs = 25;
+const int IPv6FallbackDelayEstimator::kMinRaceResults = 4;
+
 namespace {
 
 // Returns true iff all addresses in |list| are in the IPv6 family.
@@ -46,6 +49,9 @@ bool AddressListOnlyContainsIPv6(const AddressList& list) {
   return true;
 }
 
+// Weight of the latest race in IPv6FallbackDelayEstimator's moving average.
+const double kRaceResultWeight = 0.2;
+
 }  // namespace
 
 // This lock protects |g_last_connect_time|.
@@ -70,6 +76,42 @@ TransportSocketParams::TransportSocketParams(
 
 TransportSocketParams::~TransportSocketParams() {}
 
+IPv6FallbackDelayEstimator::IPv6FallbackDelayEstimator()
+    : num_race_results_(0),
+      ipv6_success_rate_(1.0) {
+  NetworkChangeNotifier::AddIPAddressObserver(this);
+}
+
+IPv6FallbackDelayEstimator::~IPv6FallbackDelayEstimator() {
+  NetworkChangeNotifier::RemoveIPAddressObserver(this);
+}
+
+void IPv6FallbackDelayEstimator::RecordRaceResult(bool ipv6_won) {
+  double result = ipv6_won ? 1.0 : 0.0;
+  if (num_race_results_ == 0) {
+    ipv6_success_rate_ = result;
+  } else {
+    ipv6_success_rate_ +=
+        kRaceResultWeight * (result - ipv6_success_rate_);
+  }
+  ++num_race_results_;
+}
+
+base::TimeDelta IPv6FallbackDelayEstimator::GetFallbackDelay() const {
+  if (num_race_results_ < kMinRaceResults) {
+    return base::TimeDelta::FromMilliseconds(
+        TransportConnectJob::kIPv6FallbackTimerInMs);
+  }
+  double delay_ms = kMinFallbackDelayMs + ipv6_success_rate_ *
+      (TransportConnectJob::kIPv6FallbackTimerInMs - kMinFallbackDelayMs);
+  return base::TimeDelta::FromMilliseconds(static_cast<int64>(delay_ms));
+}
+
+void IPv6FallbackDelayEstimator::OnIPAddressChanged() {
+  num_race_results_ = 0;
+  ipv6_success_rate_ = 1.0;
+}
+
 // TransportConnectJobs will time out after this many seconds.  Note this is
 // the total time, including both host resolution and TCP connect() times.
 //
@@ -88,6 +130,7 @@ TransportConnectJob::TransportConnectJob(
     base::TimeDelta timeout_duration,
     ClientSocketFactory* client_socket_factory,
     HostResolver* host_resolver,
+    IPv6FallbackDelayEstimator* fallback_delay_estimator,
     Delegate* delegate,
     NetLog* net_log)
     : ConnectJob(group_name, timeout_duration, priority, delegate,
@@ -95,6 +138,7 @@ TransportConnectJob::TransportConnectJob(
       params_(params),
       client_socket_factory_(client_socket_factory),
       resolver_(host_resolver),
+      fallback_delay_estimator_(fallback_delay_estimator),
       next_state_(STATE_NONE),
       interval_between_connects_(CONNECT_INTERVAL_GT_20MS) {
 }
@@ -225,7 +269,7 @@ int TransportConnectJob::DoTransportConnect() {
       addresses_.front().GetFamily() == ADDRESS_FAMILY_IPV6 &&
       !AddressListOnlyContainsIPv6(addresses_)) {
     fallback_timer_.Start(FROM_HERE,
-        base::TimeDelta::FromMilliseconds(kIPv6FallbackTimerInMs),
+        fallback_delay_estimator_->GetFallbackDelay(),
         this, &TransportConnectJob::DoIPv6FallbackTransportConnect);
   }
   return rv;
@@ -301,6 +345,13 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
                                    base::TimeDelta::FromMilliseconds(1),
                                    base::TimeDelta::FromMinutes(10),
                                    100);
+        // The socket moves on to the IPv4 addresses if all the IPv6 ones
+        // fail.
+        IPEndPoint peer;
+        if (transport_socket_->GetPeerAddress(&peer) == OK) {
+          fallback_delay_estimator_->RecordRaceResult(
+              peer.GetFamily() == ADDRESS_FAMILY_IPV6);
+        }
       }
     }
     SetSocket(transport_socket_.Pass());
@@ -374,6 +425,7 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
         base::TimeDelta::FromMilliseconds(1),
         base::TimeDelta::FromMinutes(10),
         100);
+    fallback_delay_estimator_->RecordRaceResult(false);
     SetSocket(fallback_transport_socket_.Pass());
     next_state_ = STATE_NONE;
     transport_socket_.reset();
@@ -402,6 +454,7 @@ scoped_ptr<ConnectJob>
                               ConnectionTimeout(),
                               client_socket_factory_,
                               host_resolver_,
+                              fallback_delay_estimator_.get(),
                               delegate,
                               net_log_));
 }
@@ -491,6 +544,11 @@ void TransportClientSocketPool::CloseIdleSockets() {
   base_.CloseIdleSockets();
 }
 
+void TransportClientSocketPool::CloseIdleSocketsInGroup(
+    const std::string& group_name) {
+  base_.CloseIdleSocketsInGroup(group_name);
+}
+
 int TransportClientSocketPool::IdleSocketCount() const {
   return base_.idle_socket_count();
 }
@@ -13,6 +13,7 @@
 #include "base/time/time.h"
 #include "base/timer/timer.h"
 #include "net/base/host_port_pair.h"
+#include "net/base/network_change_notifier.h"
 #include "net/dns/host_resolver.h"
 #include "net/dns/single_request_host_resolver.h"
 #include "net/socket/client_socket_pool.h"
@@ -55,22 +56,63 @@ class NET_EXPORT_PRIVATE TransportSocketParams
   DISALLOW_COPY_AND_ASSIGN(TransportSocketParams);
 };
 
+// Learns how much of a head start TransportConnectJob gives IPv6 connect()s
+// over IPv4 ones, from how often IPv6 won the race on the current network.
+// Networks where IPv6 works get the full kIPv6FallbackTimerInMs, while on
+// those where it keeps losing, IPv4 connect()s start almost right away. What
+// was learned is forgotten on IP address changes, which usually mean a new
+// network.
+class NET_EXPORT_PRIVATE IPv6FallbackDelayEstimator
+    : public NetworkChangeNotifier::IPAddressObserver {
+ public:
+  IPv6FallbackDelayEstimator();
+  virtual ~IPv6FallbackDelayEstimator();
+
+  // Records whether a connect() to a list of both IPv6 and IPv4 addresses
+  // ended up connected over IPv6.
+  void RecordRaceResult(bool ipv6_won);
+
+  // Returns how long to wait for an IPv6 connect() before starting an IPv4
+  // one.
+  base::TimeDelta GetFallbackDelay() const;
+
+  // NetworkChangeNotifier::IPAddressObserver implementation.
+  virtual void OnIPAddressChanged() OVERRIDE;
+
+  // The shortest head start IPv6 gets.
+  static const int kMinFallbackDelayMs;
+
+  // The number of races recorded before the delay is based on them.
+  static const int kMinRaceResults;
+
+ private:
+  int num_race_results_;
+
+  // Moving average of the IPv6 wins, between 0 and 1.
+  double ipv6_success_rate_;
+
+  DISALLOW_COPY_AND_ASSIGN(IPv6FallbackDelayEstimator);
+};
+
 // TransportConnectJob handles the host resolution necessary for socket creation
 // and the transport (likely TCP) connect. TransportConnectJob also has fallback
 // logic for IPv6 connect() timeouts (which may happen due to networks / routers
 // with broken IPv6 support). Those timeouts take 20s, so rather than make the
-// user wait 20s for the timeout to fire, we use a fallback timer
-// (kIPv6FallbackTimerInMs) and start a connect() to a IPv4 address if the timer
-// fires. Then we race the IPv4 connect() against the IPv6 connect() (which has
-// a headstart) and return the one that completes first to the socket pool.
+// user wait 20s for the timeout to fire, we use a fallback timer, at most
+// kIPv6FallbackTimerInMs as learned by |fallback_delay_estimator|, and start a
+// connect() to a IPv4 address if the timer fires. Then we race the IPv4
+// connect() against the IPv6 connect() (which has a headstart) and return the
+// one that completes first to the socket pool.
 class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
  public:
+  // |fallback_delay_estimator| must outlive the job.
   TransportConnectJob(const std::string& group_name,
                       RequestPriority priority,
                       const scoped_refptr<TransportSocketParams>& params,
                       base::TimeDelta timeout_duration,
                       ClientSocketFactory* client_socket_factory,
                       HostResolver* host_resolver,
+                      IPv6FallbackDelayEstimator* fallback_delay_estimator,
                       Delegate* delegate,
                       NetLog* net_log);
   virtual ~TransportConnectJob();
@@ -121,6 +163,7 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   scoped_refptr<TransportSocketParams> params_;
   ClientSocketFactory* const client_socket_factory_;
   SingleRequestHostResolver resolver_;
+  IPv6FallbackDelayEstimator* const fallback_delay_estimator_;
   AddressList addresses_;
   State next_state_;
 
@@ -182,6 +225,9 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
   virtual base::TimeDelta ConnectionTimeout() const OVERRIDE;
   virtual ClientSocketPoolHistograms* histograms() const OVERRIDE;
 
+  // Closes the idle sockets of |group_name|, if there are any.
+  void CloseIdleSocketsInGroup(const std::string& group_name);
+
   // HigherLayeredPool implementation.
   virtual bool IsStalled() const OVERRIDE;
   virtual void AddHigherLayeredPool(HigherLayeredPool* higher_pool) OVERRIDE;
@@ -198,6 +244,7 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
                          NetLog* net_log)
         : client_socket_factory_(client_socket_factory),
           host_resolver_(host_resolver),
+          fallback_delay_estimator_(new IPv6FallbackDelayEstimator()),
           net_log_(net_log) {}
 
     virtual ~TransportConnectJobFactory() {}
@@ -214,6 +261,8 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
    private:
     ClientSocketFactory* const client_socket_factory_;
     HostResolver* const host_resolver_;
+    // Shared by the jobs of the pool.
+    scoped_ptr<IPv6FallbackDelayEstimator> fallback_delay_estimator_;
     NetLog* net_log_;
 
     DISALLOW_COPY_AND_ASSIGN(TransportConnectJobFactory);
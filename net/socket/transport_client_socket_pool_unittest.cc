@@ -1370,6 +1370,78 @@ TEST_F(TransportClientSocketPoolTest, IPv4HasNoFallback) {
   EXPECT_EQ(1, client_socket_factory_.allocation_count());
 }
 
+TEST(IPv6FallbackDelayEstimatorTest, LearnsFromRaceResults) {
+  const base::TimeDelta kMaxDelay = base::TimeDelta::FromMilliseconds(
+      TransportConnectJob::kIPv6FallbackTimerInMs);
+  const base::TimeDelta kMinDelay = base::TimeDelta::FromMilliseconds(
+      IPv6FallbackDelayEstimator::kMinFallbackDelayMs);
+  IPv6FallbackDelayEstimator estimator;
+  EXPECT_EQ(kMaxDelay, estimator.GetFallbackDelay());
+
+  // A few races aren't enough to go by.
+  for (int i = 1; i < IPv6FallbackDelayEstimator::kMinRaceResults; ++i)
+    estimator.RecordRaceResult(false);
+  EXPECT_EQ(kMaxDelay, estimator.GetFallbackDelay());
+
+  // IPv6 never winning means IPv4 connects almost right away.
+  estimator.RecordRaceResult(false);
+  EXPECT_EQ(kMinDelay, estimator.GetFallbackDelay());
+
+  // IPv6 starting to win makes for a longer head start.
+  estimator.RecordRaceResult(true);
+  base::TimeDelta delay = estimator.GetFallbackDelay();
+  EXPECT_LT(kMinDelay, delay);
+  EXPECT_GT(kMaxDelay, delay);
+  estimator.RecordRaceResult(true);
+  EXPECT_LT(delay, estimator.GetFallbackDelay());
+
+  // A new network starts from scratch.
+  estimator.OnIPAddressChanged();
+  EXPECT_EQ(kMaxDelay, estimator.GetFallbackDelay());
+}
+
+TEST_F(TransportClientSocketPoolTest, IPv6FallbackUsesLearnedDelay) {
+  // Create a pool without backup jobs.
+  ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(false);
+  TransportClientSocketPool pool(kMaxSockets,
+                                 kMaxSocketsPerGroup,
+                                 histograms_.get(),
+                                 host_resolver_.get(),
+                                 &client_socket_factory_,
+                                 NULL);
+
+  // IPv6 keeps stalling, IPv4 connects right away.
+  MockClientSocketFactory::ClientSocketType case_types[] = {
+    MockClientSocketFactory::MOCK_STALLED_CLIENT_SOCKET,
+    MockClientSocketFactory::MOCK_CLIENT_SOCKET,
+  };
+  host_resolver_->rules()->AddIPLiteralRule(
+      "*", "2:abcd::3:4:ff,2.2.2.2", std::string());
+
+  base::TimeDelta last_delay;
+  for (int i = 0; i < IPv6FallbackDelayEstimator::kMinRaceResults + 1; ++i) {
+    client_socket_factory_.set_client_socket_types(case_types, 2);
+
+    TestCompletionCallback callback;
+    ClientSocketHandle handle;
+    base::TimeTicks start = base::TimeTicks::Now();
+    int rv = handle.Init("a", params_, LOW, callback.callback(), &pool,
+                         BoundNetLog());
+    EXPECT_EQ(ERR_IO_PENDING, rv);
+    EXPECT_EQ(OK, callback.WaitForResult());
+    last_delay = base::TimeTicks::Now() - start;
+    handle.socket()->Disconnect();
+  }
+
+  // After IPv4 won every race, the fallback no longer waits for the full
+  // fallback timer.
+  EXPECT_GT(base::TimeDelta::FromMilliseconds(
+                TransportConnectJob::kIPv6FallbackTimerInMs),
+            last_delay);
+  EXPECT_EQ(2 * (IPv6FallbackDelayEstimator::kMinRaceResults + 1),
+            client_socket_factory_.allocation_count());
+}
+
 }  // namespace
 
 }  // namespace net
@@ -28,6 +28,37 @@ SpdyMajorVersion NextProtoToSpdyMajorVersion(NextProto next_proto) {
   return SPDY2;
 }
 
+void BufferedSpdyFramerVisitorInterface::OnSynStreamView(
+    SpdyStreamId stream_id,
+    SpdyStreamId associated_stream_id,
+    SpdyPriority priority,
+    bool fin,
+    bool unidirectional,
+    const SpdyHeaderBlockView& headers) {
+  SpdyHeaderBlock block;
+  headers.CopyTo(&block);
+  OnSynStream(stream_id, associated_stream_id, priority, fin, unidirectional,
+              block);
+}
+
+void BufferedSpdyFramerVisitorInterface::OnSynReplyView(
+    SpdyStreamId stream_id,
+    bool fin,
+    const SpdyHeaderBlockView& headers) {
+  SpdyHeaderBlock block;
+  headers.CopyTo(&block);
+  OnSynReply(stream_id, fin, block);
+}
+
+void BufferedSpdyFramerVisitorInterface::OnHeadersView(
+    SpdyStreamId stream_id,
+    bool fin,
+    const SpdyHeaderBlockView& headers) {
+  SpdyHeaderBlock block;
+  headers.CopyTo(&block);
+  OnHeaders(stream_id, fin, block);
+}
+
 BufferedSpdyFramer::BufferedSpdyFramer(SpdyMajorVersion version,
                                        bool enable_compression)
     : spdy_framer_(version),
@@ -37,7 +68,6 @@ BufferedSpdyFramer::BufferedSpdyFramer(SpdyMajorVersion version,
       header_stream_id_(SpdyFramer::kInvalidStream),
       frames_received_(0) {
   spdy_framer_.set_enable_compression(enable_compression);
-  memset(header_buffer_, 0, sizeof(header_buffer_));
 }
 
 BufferedSpdyFramer::~BufferedSpdyFramer() {
@@ -110,9 +140,8 @@ bool BufferedSpdyFramer::OnControlFrameHeaderData(SpdyStreamId stream_id,
     // Indicates end-of-header-block.
     CHECK(header_buffer_valid_);
 
-    SpdyHeaderBlock headers;
     size_t parsed_len = spdy_framer_.ParseHeaderBlockInBuffer(
-        header_buffer_, header_buffer_used_, &headers);
+        header_buffer_, header_buffer_used_, &header_block_view_);
     // TODO(rch): this really should be checking parsed_len != len,
     // but a bunch of tests fail.  Need to figure out why.
     if (parsed_len == 0) {
@@ -123,22 +152,22 @@ bool BufferedSpdyFramer::OnControlFrameHeaderData(SpdyStreamId stream_id,
     DCHECK(control_frame_fields_.get());
     switch (control_frame_fields_->type) {
       case SYN_STREAM:
-        visitor_->OnSynStream(control_frame_fields_->stream_id,
-                              control_frame_fields_->associated_stream_id,
-                              control_frame_fields_->priority,
-                              control_frame_fields_->fin,
-                              control_frame_fields_->unidirectional,
-                              headers);
+        visitor_->OnSynStreamView(control_frame_fields_->stream_id,
+                                  control_frame_fields_->associated_stream_id,
+                                  control_frame_fields_->priority,
+                                  control_frame_fields_->fin,
+                                  control_frame_fields_->unidirectional,
+                                  header_block_view_);
         break;
       case SYN_REPLY:
-        visitor_->OnSynReply(control_frame_fields_->stream_id,
-                             control_frame_fields_->fin,
-                             headers);
+        visitor_->OnSynReplyView(control_frame_fields_->stream_id,
+                                 control_frame_fields_->fin,
+                                 header_block_view_);
         break;
       case HEADERS:
-        visitor_->OnHeaders(control_frame_fields_->stream_id,
-                            control_frame_fields_->fin,
-                            headers);
+        visitor_->OnHeadersView(control_frame_fields_->stream_id,
+                                control_frame_fields_->fin,
+                                header_block_view_);
         break;
       default:
         DCHECK(false) << "Unexpect control frame type: "
@@ -146,6 +175,7 @@ bool BufferedSpdyFramer::OnControlFrameHeaderData(SpdyStreamId stream_id,
         break;
     }
     control_frame_fields_.reset(NULL);
+    header_block_view_.Clear();
     return true;
   }
 
@@ -344,7 +374,8 @@ SpdyPriority BufferedSpdyFramer::GetHighestPriority() const {
 }
 
 void BufferedSpdyFramer::InitHeaderStreaming(SpdyStreamId stream_id) {
-  memset(header_buffer_, 0, kHeaderBufferSize);
+  // Only the first |header_buffer_used_| bytes are ever read, so the
+  // buffer doesn't need clearing.
   header_buffer_used_ = 0;
   header_buffer_valid_ = true;
   header_stream_id_ = stream_id;
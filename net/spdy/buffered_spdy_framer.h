@@ -52,6 +52,24 @@ class NET_EXPORT_PRIVATE BufferedSpdyFramerVisitorInterface {
                          bool fin,
                          const SpdyHeaderBlock& headers) = 0;
 
+  // The following are called instead of the above with a view of the
+  // headers into the framer's header buffer, which is only valid for
+  // the duration of the call. The default implementations copy the
+  // headers and call the above; visitors which only inspect the
+  // headers may override them to avoid building a SpdyHeaderBlock.
+  virtual void OnSynStreamView(SpdyStreamId stream_id,
+                               SpdyStreamId associated_stream_id,
+                               SpdyPriority priority,
+                               bool fin,
+                               bool unidirectional,
+                               const SpdyHeaderBlockView& headers);
+  virtual void OnSynReplyView(SpdyStreamId stream_id,
+                              bool fin,
+                              const SpdyHeaderBlockView& headers);
+  virtual void OnHeadersView(SpdyStreamId stream_id,
+                             bool fin,
+                             const SpdyHeaderBlockView& headers);
+
   // Called when a data frame header is received.
   virtual void OnDataFrameHeader(SpdyStreamId stream_id,
                                  size_t length,
@@ -233,6 +251,9 @@ class NET_EXPORT_PRIVATE BufferedSpdyFramer
   char header_buffer_[kHeaderBufferSize];
   size_t header_buffer_used_;
   bool header_buffer_valid_;
+  // Points into |header_buffer_| once a header block is complete. It is
+  // reused across frames so that parsing doesn't allocate.
+  SpdyHeaderBlockView header_block_view_;
   SpdyStreamId header_stream_id_;
   int frames_received_;
 
@@ -0,0 +1,298 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_constants.h"
+
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "net/spdy/hpack_huffman_table.h"
+
+namespace net {
+
+namespace {
+
+// The table returned by ObtainHpackHuffmanTable().
+class SharedHpackHuffmanTable : public HpackHuffmanTable {
+ public:
+  SharedHpackHuffmanTable() {
+    std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+    CHECK(Initialize(&code[0], code.size()));
+  }
+};
+
+base::LazyInstance<SharedHpackHuffmanTable>::Leaky g_shared_huffman_table =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+std::vector<HpackHuffmanSymbol> HpackHuffmanCode() {
+  const HpackHuffmanSymbol kHpackHuffmanCode[] = {
+    { 0x1ff8ul, 13, 0 },
+    { 0x7fffd8ul, 23, 1 },
+    { 0xfffffe2ul, 28, 2 },
+    { 0xfffffe3ul, 28, 3 },
+    { 0xfffffe4ul, 28, 4 },
+    { 0xfffffe5ul, 28, 5 },
+    { 0xfffffe6ul, 28, 6 },
+    { 0xfffffe7ul, 28, 7 },
+    { 0xfffffe8ul, 28, 8 },
+    { 0xffffeaul, 24, 9 },
+    { 0x3ffffffcul, 30, 10 },
+    { 0xfffffe9ul, 28, 11 },
+    { 0xfffffeaul, 28, 12 },
+    { 0x3ffffffdul, 30, 13 },
+    { 0xfffffebul, 28, 14 },
+    { 0xfffffecul, 28, 15 },
+    { 0xfffffedul, 28, 16 },
+    { 0xfffffeeul, 28, 17 },
+    { 0xfffffeful, 28, 18 },
+    { 0xffffff0ul, 28, 19 },
+    { 0xffffff1ul, 28, 20 },
+    { 0xffffff2ul, 28, 21 },
+    { 0x3ffffffeul, 30, 22 },
+    { 0xffffff3ul, 28, 23 },
+    { 0xffffff4ul, 28, 24 },
+    { 0xffffff5ul, 28, 25 },
+    { 0xffffff6ul, 28, 26 },
+    { 0xffffff7ul, 28, 27 },
+    { 0xffffff8ul, 28, 28 },
+    { 0xffffff9ul, 28, 29 },
+    { 0xffffffaul, 28, 30 },
+    { 0xffffffbul, 28, 31 },
+    { 0x14ul, 6, 32 },
+    { 0x3f8ul, 10, 33 },
+    { 0x3f9ul, 10, 34 },
+    { 0xffaul, 12, 35 },
+    { 0x1ff9ul, 13, 36 },
+    { 0x15ul, 6, 37 },
+    { 0xf8ul, 8, 38 },
+    { 0x7faul, 11, 39 },
+    { 0x3faul, 10, 40 },
+    { 0x3fbul, 10, 41 },
+    { 0xf9ul, 8, 42 },
+    { 0x7fbul, 11, 43 },
+    { 0xfaul, 8, 44 },
+    { 0x16ul, 6, 45 },
+    { 0x17ul, 6, 46 },
+    { 0x18ul, 6, 47 },
+    { 0x0ul, 5, 48 },
+    { 0x1ul, 5, 49 },
+    { 0x2ul, 5, 50 },
+    { 0x19ul, 6, 51 },
+    { 0x1aul, 6, 52 },
+    { 0x1bul, 6, 53 },
+    { 0x1cul, 6, 54 },
+    { 0x1dul, 6, 55 },
+    { 0x1eul, 6, 56 },
+    { 0x1ful, 6, 57 },
+    { 0x5cul, 7, 58 },
+    { 0xfbul, 8, 59 },
+    { 0x7ffcul, 15, 60 },
+    { 0x20ul, 6, 61 },
+    { 0xffbul, 12, 62 },
+    { 0x3fcul, 10, 63 },
+    { 0x1ffaul, 13, 64 },
+    { 0x21ul, 6, 65 },
+    { 0x5dul, 7, 66 },
+    { 0x5eul, 7, 67 },
+    { 0x5ful, 7, 68 },
+    { 0x60ul, 7, 69 },
+    { 0x61ul, 7, 70 },
+    { 0x62ul, 7, 71 },
+    { 0x63ul, 7, 72 },
+    { 0x64ul, 7, 73 },
+    { 0x65ul, 7, 74 },
+    { 0x66ul, 7, 75 },
+    { 0x67ul, 7, 76 },
+    { 0x68ul, 7, 77 },
+    { 0x69ul, 7, 78 },
+    { 0x6aul, 7, 79 },
+    { 0x6bul, 7, 80 },
+    { 0x6cul, 7, 81 },
+    { 0x6dul, 7, 82 },
+    { 0x6eul, 7, 83 },
+    { 0x6ful, 7, 84 },
+    { 0x70ul, 7, 85 },
+    { 0x71ul, 7, 86 },
+    { 0x72ul, 7, 87 },
+    { 0xfcul, 8, 88 },
+    { 0x73ul, 7, 89 },
+    { 0xfdul, 8, 90 },
+    { 0x1ffbul, 13, 91 },
+    { 0x7fff0ul, 19, 92 },
+    { 0x1ffcul, 13, 93 },
+    { 0x3ffcul, 14, 94 },
+    { 0x22ul, 6, 95 },
+    { 0x7ffdul, 15, 96 },
+    { 0x3ul, 5, 97 },
+    { 0x23ul, 6, 98 },
+    { 0x4ul, 5, 99 },
+    { 0x24ul, 6, 100 },
+    { 0x5ul, 5, 101 },
+    { 0x25ul, 6, 102 },
+    { 0x26ul, 6, 103 },
+    { 0x27ul, 6, 104 },
+    { 0x6ul, 5, 105 },
+    { 0x74ul, 7, 106 },
+    { 0x75ul, 7, 107 },
+    { 0x28ul, 6, 108 },
+    { 0x29ul, 6, 109 },
+    { 0x2aul, 6, 110 },
+    { 0x7ul, 5, 111 },
+    { 0x2bul, 6, 112 },
+    { 0x76ul, 7, 113 },
+    { 0x2cul, 6, 114 },
+    { 0x8ul, 5, 115 },
+    { 0x9ul, 5, 116 },
+    { 0x2dul, 6, 117 },
+    { 0x77ul, 7, 118 },
+    { 0x78ul, 7, 119 },
+    { 0x79ul, 7, 120 },
+    { 0x7aul, 7, 121 },
+    { 0x7bul, 7, 122 },
+    { 0x7ffeul, 15, 123 },
+    { 0x7fcul, 11, 124 },
+    { 0x3ffdul, 14, 125 },
+    { 0x1ffdul, 13, 126 },
+    { 0xffffffcul, 28, 127 },
+    { 0xfffe6ul, 20, 128 },
+    { 0x3fffd2ul, 22, 129 },
+    { 0xfffe7ul, 20, 130 },
+    { 0xfffe8ul, 20, 131 },
+    { 0x3fffd3ul, 22, 132 },
+    { 0x3fffd4ul, 22, 133 },
+    { 0x3fffd5ul, 22, 134 },
+    { 0x7fffd9ul, 23, 135 },
+    { 0x3fffd6ul, 22, 136 },
+    { 0x7fffdaul, 23, 137 },
+    { 0x7fffdbul, 23, 138 },
+    { 0x7fffdcul, 23, 139 },
+    { 0x7fffddul, 23, 140 },
+    { 0x7fffdeul, 23, 141 },
+    { 0xffffebul, 24, 142 },
+    { 0x7fffdful, 23, 143 },
+    { 0xffffecul, 24, 144 },
+    { 0xffffedul, 24, 145 },
+    { 0x3fffd7ul, 22, 146 },
+    { 0x7fffe0ul, 23, 147 },
+    { 0xffffeeul, 24, 148 },
+    { 0x7fffe1ul, 23, 149 },
+    { 0x7fffe2ul, 23, 150 },
+    { 0x7fffe3ul, 23, 151 },
+    { 0x7fffe4ul, 23, 152 },
+    { 0x1fffdcul, 21, 153 },
+    { 0x3fffd8ul, 22, 154 },
+    { 0x7fffe5ul, 23, 155 },
+    { 0x3fffd9ul, 22, 156 },
+    { 0x7fffe6ul, 23, 157 },
+    { 0x7fffe7ul, 23, 158 },
+    { 0xffffeful, 24, 159 },
+    { 0x3fffdaul, 22, 160 },
+    { 0x1fffddul, 21, 161 },
+    { 0xfffe9ul, 20, 162 },
+    { 0x3fffdbul, 22, 163 },
+    { 0x3fffdcul, 22, 164 },
+    { 0x7fffe8ul, 23, 165 },
+    { 0x7fffe9ul, 23, 166 },
+    { 0x1fffdeul, 21, 167 },
+    { 0x7fffeaul, 23, 168 },
+    { 0x3fffddul, 22, 169 },
+    { 0x3fffdeul, 22, 170 },
+    { 0xfffff0ul, 24, 171 },
+    { 0x1fffdful, 21, 172 },
+    { 0x3fffdful, 22, 173 },
+    { 0x7fffebul, 23, 174 },
+    { 0x7fffecul, 23, 175 },
+    { 0x1fffe0ul, 21, 176 },
+    { 0x1fffe1ul, 21, 177 },
+    { 0x3fffe0ul, 22, 178 },
+    { 0x1fffe2ul, 21, 179 },
+    { 0x7fffedul, 23, 180 },
+    { 0x3fffe1ul, 22, 181 },
+    { 0x7fffeeul, 23, 182 },
+    { 0x7fffeful, 23, 183 },
+    { 0xfffeaul, 20, 184 },
+    { 0x3fffe2ul, 22, 185 },
+    { 0x3fffe3ul, 22, 186 },
+    { 0x3fffe4ul, 22, 187 },
+    { 0x7ffff0ul, 23, 188 },
+    { 0x3fffe5ul, 22, 189 },
+    { 0x3fffe6ul, 22, 190 },
+    { 0x7ffff1ul, 23, 191 },
+    { 0x3ffffe0ul, 26, 192 },
+    { 0x3ffffe1ul, 26, 193 },
+    { 0xfffebul, 20, 194 },
+    { 0x7fff1ul, 19, 195 },
+    { 0x3fffe7ul, 22, 196 },
+    { 0x7ffff2ul, 23, 197 },
+    { 0x3fffe8ul, 22, 198 },
+    { 0x1ffffecul, 25, 199 },
+    { 0x3ffffe2ul, 26, 200 },
+    { 0x3ffffe3ul, 26, 201 },
+    { 0x3ffffe4ul, 26, 202 },
+    { 0x7ffffdeul, 27, 203 },
+    { 0x7ffffdful, 27, 204 },
+    { 0x3ffffe5ul, 26, 205 },
+    { 0xfffff1ul, 24, 206 },
+    { 0x1ffffedul, 25, 207 },
+    { 0x7fff2ul, 19, 208 },
+    { 0x1fffe3ul, 21, 209 },
+    { 0x3ffffe6ul, 26, 210 },
+    { 0x7ffffe0ul, 27, 211 },
+    { 0x7ffffe1ul, 27, 212 },
+    { 0x3ffffe7ul, 26, 213 },
+    { 0x7ffffe2ul, 27, 214 },
+    { 0xfffff2ul, 24, 215 },
+    { 0x1fffe4ul, 21, 216 },
+    { 0x1fffe5ul, 21, 217 },
+    { 0x3ffffe8ul, 26, 218 },
+    { 0x3ffffe9ul, 26, 219 },
+    { 0xffffffdul, 28, 220 },
+    { 0x7ffffe3ul, 27, 221 },
+    { 0x7ffffe4ul, 27, 222 },
+    { 0x7ffffe5ul, 27, 223 },
+    { 0xfffecul, 20, 224 },
+    { 0xfffff3ul, 24, 225 },
+    { 0xfffedul, 20, 226 },
+    { 0x1fffe6ul, 21, 227 },
+    { 0x3fffe9ul, 22, 228 },
+    { 0x1fffe7ul, 21, 229 },
+    { 0x1fffe8ul, 21, 230 },
+    { 0x7ffff3ul, 23, 231 },
+    { 0x3fffeaul, 22, 232 },
+    { 0x3fffebul, 22, 233 },
+    { 0x1ffffeeul, 25, 234 },
+    { 0x1ffffeful, 25, 235 },
+    { 0xfffff4ul, 24, 236 },
+    { 0xfffff5ul, 24, 237 },
+    { 0x3ffffeaul, 26, 238 },
+    { 0x7ffff4ul, 23, 239 },
+    { 0x3ffffebul, 26, 240 },
+    { 0x7ffffe6ul, 27, 241 },
+    { 0x3ffffecul, 26, 242 },
+    { 0x3ffffedul, 26, 243 },
+    { 0x7ffffe7ul, 27, 244 },
+    { 0x7ffffe8ul, 27, 245 },
+    { 0x7ffffe9ul, 27, 246 },
+    { 0x7ffffeaul, 27, 247 },
+    { 0x7ffffebul, 27, 248 },
+    { 0xffffffeul, 28, 249 },
+    { 0x7ffffecul, 27, 250 },
+    { 0x7ffffedul, 27, 251 },
+    { 0x7ffffeeul, 27, 252 },
+    { 0x7ffffeful, 27, 253 },
+    { 0x7fffff0ul, 27, 254 },
+    { 0x3ffffeeul, 26, 255 },
+    { 0x3ffffffful, 30, 256 },
+  };
+  return std::vector<HpackHuffmanSymbol>(
+      kHpackHuffmanCode,
+      kHpackHuffmanCode + arraysize(kHpackHuffmanCode));
+}
+
+const HpackHuffmanTable& ObtainHpackHuffmanTable() {
+  return g_shared_huffman_table.Get();
+}
+
+}  // namespace net
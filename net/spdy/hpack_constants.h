@@ -5,7 +5,10 @@
 #ifndef NET_SPDY_HPACK_CONSTANTS_H_
 #define NET_SPDY_HPACK_CONSTANTS_H_
 
+#include <vector>
+
 #include "base/basictypes.h"
+#include "net/base/net_export.h"
 
 // All section references below are to
 // http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
@@ -20,10 +23,25 @@ struct HpackPrefix {
   size_t bit_size;
 };
 
+// A HpackHuffmanSymbol is a pairing of a symbol (represented as an
+// integer from 0 to 256, 256 being EOS) and its Huffman code, stored
+// in the lower |length| bits of |code|.
+struct HpackHuffmanSymbol {
+  uint32 code;
+  uint8 length;
+  uint16 id;
+};
+
+class HpackHuffmanTable;
+
 // The marker for a string literal that is stored unmodified (i.e.,
 // without Huffman encoding) (from 4.1.2).
 const HpackPrefix kStringLiteralIdentityEncoded = { 0x0, 1 };
 
+// The marker for a string literal that is stored with Huffman
+// encoding (from 4.1.2).
+const HpackPrefix kStringLiteralHuffmanEncoded = { 0x1, 1 };
+
 // The opcode for an indexed header field (from 4.2).
 const HpackPrefix kIndexedOpcode = { 0x1, 1 };
 
@@ -35,6 +53,16 @@ const HpackPrefix kLiteralNoIndexOpcode = { 0x01, 2 };
 // (from 4.3.2).
 const HpackPrefix kLiteralIncrementalIndexOpcode = { 0x00, 2 };
 
+// Returns the Huffman code of the 256 octets and EOS, in order of
+// their ids. Draft 05 has separate codes for requests and responses;
+// this is the single code of the later drafts, used in both
+// directions.
+NET_EXPORT_PRIVATE std::vector<HpackHuffmanSymbol> HpackHuffmanCode();
+
+// Returns a table initialized with HpackHuffmanCode(). The table is
+// shared and lives for the lifetime of the process.
+NET_EXPORT_PRIVATE const HpackHuffmanTable& ObtainHpackHuffmanTable();
+
 }  // namespace net
 
 #endif  // NET_SPDY_HPACK_CONSTANTS_H_
@@ -6,6 +6,7 @@
 
 #include "base/basictypes.h"
 #include "net/spdy/hpack_constants.h"
+#include "net/spdy/hpack_huffman_table.h"
 #include "net/spdy/hpack_output_stream.h"
 
 namespace net {
@@ -13,7 +14,8 @@ namespace net {
 using base::StringPiece;
 
 HpackDecoder::HpackDecoder(uint32 max_string_literal_size)
-    : max_string_literal_size_(max_string_literal_size) {}
+    : max_string_literal_size_(max_string_literal_size),
+      huffman_table_(ObtainHpackHuffmanTable()) {}
 
 HpackDecoder::~HpackDecoder() {}
 
@@ -126,7 +128,7 @@ bool HpackDecoder::DecodeNextName(
     return false;
 
   if (index_or_zero == 0)
-    return input_stream->DecodeNextStringLiteral(next_name);
+    return DecodeNextStringLiteral(input_stream, &name_buffer_, next_name);
 
   uint32 index = index_or_zero;
   if (index > context_.GetEntryCount())
@@ -138,7 +140,23 @@ bool HpackDecoder::DecodeNextName(
 
 bool HpackDecoder::DecodeNextValue(
     HpackInputStream* input_stream, StringPiece* next_name) {
-  return input_stream->DecodeNextStringLiteral(next_name);
+  return DecodeNextStringLiteral(input_stream, &value_buffer_, next_name);
+}
+
+bool HpackDecoder::DecodeNextStringLiteral(HpackInputStream* input_stream,
+                                           std::string* buffer,
+                                           StringPiece* output) {
+  if (input_stream->MatchPrefixAndConsume(kStringLiteralIdentityEncoded))
+    return input_stream->DecodeNextIdentityString(output);
+
+  if (input_stream->MatchPrefixAndConsume(kStringLiteralHuffmanEncoded)) {
+    if (!input_stream->DecodeNextHuffmanString(huffman_table_, buffer))
+      return false;
+    *output = StringPiece(*buffer);
+    return true;
+  }
+
+  return false;
 }
 
 }  // namespace net
@@ -17,6 +17,8 @@
 
 namespace net {
 
+class HpackHuffmanTable;
+
 // An HpackDecoder decodes header sets as outlined in
 // http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
 // .
@@ -44,6 +46,13 @@ class NET_EXPORT_PRIVATE HpackDecoder {
   const uint32 max_string_literal_size_;
   HpackEncodingContext context_;
 
+  const HpackHuffmanTable& huffman_table_;
+
+  // Hold the decoded Huffman-encoded name and value of the header
+  // being processed.
+  std::string name_buffer_;
+  std::string value_buffer_;
+
   // Tries to process the next header representation and maybe emit
   // headers into |header_list| according to it. Returns true if
   // successful, or false if an error was encountered.
@@ -56,6 +65,12 @@ class NET_EXPORT_PRIVATE HpackDecoder {
   bool DecodeNextValue(HpackInputStream* input_stream,
                        base::StringPiece* next_name);
 
+  // Decodes an identity or Huffman-encoded string literal. A decoded
+  // Huffman-encoded string is held by |buffer|.
+  bool DecodeNextStringLiteral(HpackInputStream* input_stream,
+                               std::string* buffer,
+                               base::StringPiece* output);
+
   DISALLOW_COPY_AND_ASSIGN(HpackDecoder);
 };
 
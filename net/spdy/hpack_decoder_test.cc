@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "base/strings/string_piece.h"
 #include "net/spdy/hpack_encoder.h"
+#include "net/spdy/hpack_huffman_table.h"
 #include "net/spdy/hpack_input_stream.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -166,6 +167,35 @@ TEST(HpackDecoderTest, LiteralHeaderInvalidIndices) {
   EXPECT_FALSE(decoder.DecodeHeaderSet(StringPiece("\x00", 1), &header_list));
 }
 
+// Decoding a literal header with a Huffman-encoded name and value
+// should work.
+TEST(HpackDecoderTest, LiteralHeaderHuffmanEncoded) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string name;
+  table.EncodeString("x-custom", &name);
+  string value;
+  table.EncodeString("www.example.com", &value);
+  string input = "\x40" + string(1, 0x80 | name.size()) + name +
+      string(1, 0x80 | value.size()) + value;
+
+  HpackDecoder decoder(kuint32max);
+  std::map<string, string> header_set = DecodeUniqueHeaderSet(&decoder, input);
+
+  std::map<string, string> expected_header_set;
+  expected_header_set["x-custom"] = "www.example.com";
+  EXPECT_EQ(expected_header_set, header_set);
+}
+
+// Decoding a literal header with an invalid Huffman-encoded value
+// should fail.
+TEST(HpackDecoderTest, LiteralHeaderInvalidHuffmanEncoding) {
+  HpackDecoder decoder(kuint32max);
+  HpackHeaderPairVector header_list;
+  // The value is an encoded EOS.
+  EXPECT_FALSE(decoder.DecodeHeaderSet(
+      StringPiece("\x44\x84\xff\xff\xff\xff", 6), &header_list));
+}
+
 // Round-tripping the header set from E.2.1 should work.
 TEST(HpackDecoderTest, BasicE21) {
   HpackEncoder encoder(kuint32max);
@@ -4,33 +4,90 @@
 
 #include "net/spdy/hpack_encoder.h"
 
+#include <vector>
+
+#include "base/logging.h"
+#include "net/spdy/hpack_constants.h"
+#include "net/spdy/hpack_entry.h"
+#include "net/spdy/hpack_huffman_table.h"
 #include "net/spdy/hpack_output_stream.h"
 
 namespace net {
 
+using base::StringPiece;
 using std::string;
 
 HpackEncoder::HpackEncoder(uint32 max_string_literal_size)
-    : max_string_literal_size_(max_string_literal_size) {}
+    : max_string_literal_size_(max_string_literal_size),
+      huffman_table_(ObtainHpackHuffmanTable()) {}
 
 HpackEncoder::~HpackEncoder() {}
 
 bool HpackEncoder::EncodeHeaderSet(const std::map<string, string>& header_set,
                                    string* output) {
-  // TOOD(akalin): Do more sophisticated encoding.
   HpackOutputStream output_stream(max_string_literal_size_);
+  output_stream.set_huffman_table(&huffman_table_);
+
+  // Start from an empty reference set, so that the decoder emits only
+  // the headers encoded below.
+  for (uint32 i = 1; i <= context_.GetMutableEntryCount(); ++i) {
+    if (context_.IsReferencedAt(i)) {
+      output_stream.AppendIndexedHeader(0);
+      uint32 new_index = 0;
+      std::vector<uint32> removed_referenced_indices;
+      context_.ProcessIndexedHeader(0, &new_index,
+                                    &removed_referenced_indices);
+      break;
+    }
+  }
+
   for (std::map<string, string>::const_iterator it = header_set.begin();
        it != header_set.end(); ++it) {
-    // TODO(akalin): Clarify in the spec that encoding with the name
-    // as a literal is OK even if the name already exists in the
-    // header table.
-    if (!output_stream.AppendLiteralHeaderNoIndexingWithName(
-            it->first, it->second)) {
+    if (!EncodeHeader(it->first, it->second, &output_stream))
       return false;
-    }
   }
   output_stream.TakeString(output);
   return true;
 }
 
+bool HpackEncoder::EncodeHeader(StringPiece name,
+                                StringPiece value,
+                                HpackOutputStream* output_stream) {
+  uint32 new_index = 0;
+  std::vector<uint32> removed_referenced_indices;
+
+  // An indexed entry is put in the reference set, and so emitted by
+  // the decoder. The names in a header set are unique, so it can't be
+  // referenced already.
+  uint32 index = context_.GetIndexOfNameAndValue(name, value);
+  if (index > 0) {
+    DCHECK(!context_.IsReferencedAt(index));
+    output_stream->AppendIndexedHeader(index);
+    context_.ProcessIndexedHeader(index, &new_index,
+                                  &removed_referenced_indices);
+    return true;
+  }
+
+  // Indexing an entry taking more than half of the header table would
+  // evict most of the table.
+  uint32 name_index = context_.GetIndexOfName(name);
+  const size_t entry_size =
+      name.size() + value.size() + HpackEntry::kSizeOverhead;
+  if (entry_size <= context_.GetMaxSize() / 2) {
+    if (!output_stream->AppendLiteralHeaderIncrementalIndexing(
+            name_index, name, value)) {
+      return false;
+    }
+    context_.ProcessLiteralHeaderWithIncrementalIndexing(
+        name, value, &new_index, &removed_referenced_indices);
+    return true;
+  }
+
+  if (name_index > 0) {
+    return output_stream->AppendLiteralHeaderNoIndexingWithIndexedName(
+        name_index, value);
+  }
+  return output_stream->AppendLiteralHeaderNoIndexingWithName(name, value);
+}
+
 }  // namespace net
@@ -10,11 +10,15 @@
 
 #include "base/basictypes.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
 #include "net/spdy/hpack_encoding_context.h"
 
 namespace net {
 
+class HpackHuffmanTable;
+class HpackOutputStream;
+
 // An HpackEncoder encodes header sets as outlined in
 // http://tools.ietf.org/html/draft-ietf-httpbis-header-compression-05
 // .
@@ -24,13 +28,25 @@ class NET_EXPORT_PRIVATE HpackEncoder {
   ~HpackEncoder();
 
   // Encodes the given header set into the given string. Returns
-  // whether or not the encoding was successful.
+  // whether or not the encoding was successful; if not, no other
+  // member function may be called.
+  //
+  // Headers found in the header or static table are encoded as
+  // indices, others are added to the header table unless they are
+  // too large. Header sets must be decoded in the order they were
+  // encoded.
   bool EncodeHeaderSet(const std::map<std::string, std::string>& header_set,
                        std::string* output);
 
  private:
+  // Encodes the header with the given name and value.
+  bool EncodeHeader(base::StringPiece name,
+                    base::StringPiece value,
+                    HpackOutputStream* output_stream);
+
   const uint32 max_string_literal_size_;
   HpackEncodingContext context_;
+  const HpackHuffmanTable& huffman_table_;
 
   DISALLOW_COPY_AND_ASSIGN(HpackEncoder);
 };
@@ -7,6 +7,7 @@
 #include <map>
 #include <string>
 
+#include "net/spdy/hpack_decoder.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -15,10 +16,21 @@ namespace {
 
 using std::string;
 
-// Test that EncoderHeaderSet() simply encodes everything as literals
-// without indexing.
+// Decodes |encoded_header_set| with |decoder| into a map.
+std::map<string, string> DecodeHeaderSet(HpackDecoder* decoder,
+                                         const string& encoded_header_set) {
+  HpackHeaderPairVector header_list;
+  EXPECT_TRUE(decoder->DecodeHeaderSet(encoded_header_set, &header_list));
+  std::map<string, string> header_set(header_list.begin(), header_list.end());
+  EXPECT_EQ(header_list.size(), header_set.size());
+  return header_set;
+}
+
+// Test that headers not in any table are added to the header table,
+// and then encoded as indices.
 TEST(HpackEncoderTest, Basic) {
   HpackEncoder encoder(kuint32max);
+  HpackDecoder decoder(kuint32max);
 
   std::map<string, string> header_set1;
   header_set1["name1"] = "value1";
@@ -26,8 +38,15 @@ TEST(HpackEncoderTest, Basic) {
 
   string encoded_header_set1;
   EXPECT_TRUE(encoder.EncodeHeaderSet(header_set1, &encoded_header_set1));
-  EXPECT_EQ("\x40\x05name1\x06value1"
-            "\x40\x05name2\x06value2", encoded_header_set1);
+  EXPECT_EQ(header_set1, DecodeHeaderSet(&decoder, encoded_header_set1));
+
+  // The reference set is emptied first, and both headers are now in
+  // the header table.
+  string encoded_header_set1_again;
+  EXPECT_TRUE(
+      encoder.EncodeHeaderSet(header_set1, &encoded_header_set1_again));
+  EXPECT_EQ("\x80\x82\x81", encoded_header_set1_again);
+  EXPECT_EQ(header_set1, DecodeHeaderSet(&decoder, encoded_header_set1_again));
 
   std::map<string, string> header_set2;
   header_set2["name2"] = "different-value";
@@ -35,8 +54,63 @@ TEST(HpackEncoderTest, Basic) {
 
   string encoded_header_set2;
   EXPECT_TRUE(encoder.EncodeHeaderSet(header_set2, &encoded_header_set2));
-  EXPECT_EQ("\x40\x05name2\x0f" "different-value"
-            "\x40\x05name3\x06value3", encoded_header_set2);
+  EXPECT_EQ(header_set2, DecodeHeaderSet(&decoder, encoded_header_set2));
+}
+
+// Test that a header in the static table is encoded as its index.
+TEST(HpackEncoderTest, StaticTableHeader) {
+  HpackEncoder encoder(kuint32max);
+
+  std::map<string, string> header_set;
+  header_set[":method"] = "GET";
+
+  string encoded_header_set;
+  EXPECT_TRUE(encoder.EncodeHeaderSet(header_set, &encoded_header_set));
+  EXPECT_EQ("\x82", encoded_header_set);
+}
+
+// Test that a header taking more than half of the header table is
+// not indexed, and that its name is encoded as an index if possible.
+TEST(HpackEncoderTest, LargeHeaderNotIndexed) {
+  HpackEncoder encoder(kuint32max);
+  HpackDecoder decoder(kuint32max);
+
+  std::map<string, string> header_set;
+  header_set["cookie"] = string(4096, 'x');
+  header_set["x-large"] = string(4096, 'y');
+
+  string encoded_header_set;
+  EXPECT_TRUE(encoder.EncodeHeaderSet(header_set, &encoded_header_set));
+  // "cookie" is at index 31 of the static table.
+  EXPECT_EQ('\x5f', encoded_header_set[0]);
+  EXPECT_EQ(header_set, DecodeHeaderSet(&decoder, encoded_header_set));
+
+  // Nothing was added to the reference set.
+  std::map<string, string> empty_header_set;
+  string encoded_empty_header_set;
+  EXPECT_TRUE(encoder.EncodeHeaderSet(empty_header_set,
+                                      &encoded_empty_header_set));
+  EXPECT_EQ("", encoded_empty_header_set);
+  EXPECT_TRUE(DecodeHeaderSet(&decoder, encoded_empty_header_set).empty());
+}
+
+// Test that a sequence of header sets survives a round trip through
+// the encoder and the decoder, while the header table churns.
+TEST(HpackEncoderTest, RoundTripSequence) {
+  HpackEncoder encoder(kuint32max);
+  HpackDecoder decoder(kuint32max);
+
+  for (int i = 0; i < 100; ++i) {
+    std::map<string, string> header_set;
+    header_set[":method"] = (i % 3) ? "GET" : "POST";
+    header_set[":path"] = "/resource/" + string(i % 7, 'p');
+    header_set["user-agent"] = "Mozilla/5.0 (X11; Linux x86_64)";
+    header_set[string(1, 'a' + i % 26) + "-header"] = string(i * 7, 'v');
+
+    string encoded_header_set;
+    EXPECT_TRUE(encoder.EncodeHeaderSet(header_set, &encoded_header_set));
+    EXPECT_EQ(header_set, DecodeHeaderSet(&decoder, encoded_header_set));
+  }
 }
 
 // Test that trying to encode a header set with a too-long header
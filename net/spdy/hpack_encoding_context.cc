@@ -6,6 +6,10 @@
 
 #include <cstddef>
 
+#include <string>
+
+#include "base/containers/hash_tables.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "net/spdy/hpack_entry.h"
@@ -98,6 +102,48 @@ const StaticEntry kStaticTable[] = {
 
 const size_t kStaticEntryCount = arraysize(kStaticTable);
 
+// Maps the names, and the names and values, of the static table to
+// their lowest index in it (starting at 1).
+class StaticTableIndex {
+ public:
+  StaticTableIndex() {
+    for (size_t i = kStaticEntryCount; i > 0; --i) {
+      const StaticEntry& entry = kStaticTable[i - 1];
+      StringPiece name(entry.name, entry.name_len);
+      StringPiece value(entry.value, entry.value_len);
+      name_index_[name.as_string()] = i;
+      name_and_value_index_[
+          HpackHeaderTable::GetNameAndValueKey(name, value)] = i;
+    }
+  }
+
+  uint32 GetIndexOfNameAndValue(StringPiece name, StringPiece value) const {
+    return LookUpIndex(name_and_value_index_,
+                       HpackHeaderTable::GetNameAndValueKey(name, value));
+  }
+
+  uint32 GetIndexOfName(StringPiece name) const {
+    return LookUpIndex(name_index_, name.as_string());
+  }
+
+ private:
+  typedef base::hash_map<std::string, uint32> IndexMap;
+
+  static uint32 LookUpIndex(const IndexMap& index_map,
+                            const std::string& key) {
+    IndexMap::const_iterator it = index_map.find(key);
+    return (it == index_map.end()) ? 0 : it->second;
+  }
+
+  IndexMap name_index_;
+  IndexMap name_and_value_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(StaticTableIndex);
+};
+
+base::LazyInstance<StaticTableIndex>::Leaky g_static_table_index =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 const uint32 HpackEncodingContext::kUntouched = HpackEntry::kUntouched;
@@ -114,6 +160,10 @@ uint32 HpackEncodingContext::GetEntryCount() const {
   return GetMutableEntryCount() + kStaticEntryCount;
 }
 
+uint32 HpackEncodingContext::GetMaxSize() const {
+  return header_table_.max_size();
+}
+
 StringPiece HpackEncodingContext::GetNameAt(uint32 index) const {
   CHECK_GE(index, 1u);
   CHECK_LE(index, GetEntryCount());
@@ -144,6 +194,23 @@ bool HpackEncodingContext::IsReferencedAt(uint32 index) const {
   return header_table_.GetEntry(index).IsReferenced();
 }
 
+uint32 HpackEncodingContext::GetIndexOfNameAndValue(StringPiece name,
+                                                    StringPiece value) const {
+  uint32 index = header_table_.GetIndexOfNameAndValue(name, value);
+  if (index > 0)
+    return index;
+  index = g_static_table_index.Get().GetIndexOfNameAndValue(name, value);
+  return (index > 0) ? header_table_.GetEntryCount() + index : 0;
+}
+
+uint32 HpackEncodingContext::GetIndexOfName(StringPiece name) const {
+  uint32 index = header_table_.GetIndexOfName(name);
+  if (index > 0)
+    return index;
+  index = g_static_table_index.Get().GetIndexOfName(name);
+  return (index > 0) ? header_table_.GetEntryCount() + index : 0;
+}
+
 uint32 HpackEncodingContext::GetTouchCountAt(uint32 index) const {
   CHECK_GE(index, 1u);
   CHECK_LE(index, GetEntryCount());
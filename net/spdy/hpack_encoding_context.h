@@ -42,6 +42,8 @@ class NET_EXPORT_PRIVATE HpackEncodingContext {
 
   uint32 GetEntryCount() const;
 
+  uint32 GetMaxSize() const;
+
   // For all read accessors below, index must be >= 1 and <=
   // GetEntryCount().  For all mutating accessors below, index must be
   // >= 1 and <= GetMutableEntryCount().
@@ -55,6 +57,13 @@ class NET_EXPORT_PRIVATE HpackEncodingContext {
 
   bool IsReferencedAt(uint32 index) const;
 
+  // Return the lowest index of an entry with the given name and
+  // value, or the given name, or 0 if there is none. These are hash
+  // lookups into both the header table and the static table.
+  uint32 GetIndexOfNameAndValue(base::StringPiece name,
+                                base::StringPiece value) const;
+  uint32 GetIndexOfName(base::StringPiece name) const;
+
   uint32 GetTouchCountAt(uint32 index) const;
 
   void SetReferencedAt(uint32 index, bool referenced);
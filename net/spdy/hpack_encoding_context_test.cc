@@ -157,6 +157,30 @@ TEST(HpackEncodingContextTest, LiteralHeaderIncrementalIndexingDoesNotFit) {
   EXPECT_EQ(0u, encoding_context.GetMutableEntryCount());
 }
 
+// Look up headers in the static table and in the header table. The
+// header table comes first, and shifts the indices of the static
+// table.
+TEST(HpackEncodingContextTest, IndexLookups) {
+  HpackEncodingContext encoding_context;
+
+  EXPECT_EQ(2u, encoding_context.GetIndexOfNameAndValue(":method", "GET"));
+  EXPECT_EQ(2u, encoding_context.GetIndexOfName(":method"));
+  EXPECT_EQ(0u, encoding_context.GetIndexOfNameAndValue(":method", "PUT"));
+  EXPECT_EQ(0u, encoding_context.GetIndexOfName("x-custom"));
+
+  uint32 new_index = 0;
+  std::vector<uint32> removed_referenced_indices;
+  EXPECT_TRUE(encoding_context.ProcessLiteralHeaderWithIncrementalIndexing(
+      ":method", "PUT", &new_index, &removed_referenced_indices));
+  EXPECT_EQ(1u, new_index);
+
+  EXPECT_EQ(1u, encoding_context.GetIndexOfNameAndValue(":method", "PUT"));
+  EXPECT_EQ(1u, encoding_context.GetIndexOfName(":method"));
+  EXPECT_EQ(3u, encoding_context.GetIndexOfNameAndValue(":method", "GET"));
+  EXPECT_EQ(":method", encoding_context.GetNameAt(3));
+  EXPECT_EQ("GET", encoding_context.GetValueAt(3));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -9,7 +9,10 @@
 
 namespace net {
 
-HpackHeaderTable::HpackHeaderTable() : size_(0), max_size_(4096) {}
+HpackHeaderTable::HpackHeaderTable()
+    : size_(0),
+      max_size_(4096),
+      insertion_count_(0) {}
 
 HpackHeaderTable::~HpackHeaderTable() {}
 
@@ -31,13 +34,61 @@ HpackEntry* HpackHeaderTable::GetMutableEntry(uint32 index) {
   return &entries_[index-1];
 }
 
+uint32 HpackHeaderTable::GetIndexOfNameAndValue(
+    base::StringPiece name,
+    base::StringPiece value) const {
+  return LookUpIndex(name_and_value_index_, GetNameAndValueKey(name, value));
+}
+
+uint32 HpackHeaderTable::GetIndexOfName(base::StringPiece name) const {
+  return LookUpIndex(name_index_, name.as_string());
+}
+
+// static
+std::string HpackHeaderTable::GetNameAndValueKey(base::StringPiece name,
+                                                 base::StringPiece value) {
+  // Header names can't contain '\0', so the key is unambiguous.
+  std::string key;
+  key.reserve(name.size() + 1 + value.size());
+  name.AppendToString(&key);
+  key.push_back('\0');
+  value.AppendToString(&key);
+  return key;
+}
+
+uint32 HpackHeaderTable::LookUpIndex(const IndexMap& index_map,
+                                     const std::string& key) const {
+  IndexMap::const_iterator it = index_map.find(key);
+  if (it == index_map.end())
+    return 0;
+  uint64 index = insertion_count_ - it->second;
+  DCHECK_GE(index, 1u);
+  DCHECK_LE(index, GetEntryCount());
+  return static_cast<uint32>(index);
+}
+
+void HpackHeaderTable::EvictLastEntry() {
+  CHECK(!entries_.empty());
+  const HpackEntry& entry = entries_.back();
+  // The last entry has the oldest insertion id, so it is indexed only if no
+  // more recent entry has its name, or name and value.
+  const uint64 id = insertion_count_ - entries_.size();
+  IndexMap::iterator it = name_index_.find(entry.name().as_string());
+  if (it != name_index_.end() && it->second == id)
+    name_index_.erase(it);
+  it = name_and_value_index_.find(
+      GetNameAndValueKey(entry.name(), entry.value()));
+  if (it != name_and_value_index_.end() && it->second == id)
+    name_and_value_index_.erase(it);
+
+  size_ -= entry.Size();
+  entries_.pop_back();
+}
+
 void HpackHeaderTable::SetMaxSize(uint32 max_size) {
   max_size_ = max_size;
-  while (size_ > max_size_) {
-    CHECK(!entries_.empty());
-    size_ -= entries_.back().Size();
-    entries_.pop_back();
-  }
+  while (size_ > max_size_)
+    EvictLastEntry();
 }
 
 void HpackHeaderTable::TryAddEntry(
@@ -60,8 +111,7 @@ void HpackHeaderTable::TryAddEntry(
     if (entries_.back().IsReferenced()) {
       removed_referenced_indices->push_back(entries_.size());
     }
-    size_ -= entries_.back().Size();
-    entries_.pop_back();
+    EvictLastEntry();
   }
 
   if (entry.Size() <= size_t_max_size) {
@@ -71,6 +121,10 @@ void HpackHeaderTable::TryAddEntry(
     size_ += entry.Size();
     *index = 1;
     entries_.push_front(entry);
+    name_index_[entry.name().as_string()] = insertion_count_;
+    name_and_value_index_[GetNameAndValueKey(entry.name(), entry.value())] =
+        insertion_count_;
+    ++insertion_count_;
   }
 }
 
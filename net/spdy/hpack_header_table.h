@@ -7,10 +7,13 @@
 
 #include <cstddef>
 #include <deque>
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
 #include "net/spdy/hpack_entry.h"
 
@@ -42,6 +45,18 @@ class NET_EXPORT_PRIVATE HpackHeaderTable {
   // The given index must be >= 1 and <= GetEntryCount().
   HpackEntry* GetMutableEntry(uint32 index);
 
+  // Return the index of the most recently added entry with the given
+  // name and value, or the given name, or 0 if there is none. These
+  // are hash lookups.
+  uint32 GetIndexOfNameAndValue(base::StringPiece name,
+                                base::StringPiece value) const;
+  uint32 GetIndexOfName(base::StringPiece name) const;
+
+  // Returns the key under which an entry with the given name and
+  // value is indexed.
+  static std::string GetNameAndValueKey(base::StringPiece name,
+                                        base::StringPiece value);
+
   // Sets the maximum size of the header table, evicting entries if
   // necessary as described in 3.3.2.
   void SetMaxSize(uint32 max_size);
@@ -58,10 +73,25 @@ class NET_EXPORT_PRIVATE HpackHeaderTable {
                    std::vector<uint32>* removed_referenced_indices);
 
  private:
+  // Maps names, or names and values, to the insertion id of the most
+  // recently added entry having them. The entry with the insertion id
+  // |id| has the index |insertion_count_ - id|.
+  typedef base::hash_map<std::string, uint64> IndexMap;
+
+  // Returns the index of the entry |index_map| maps |key| to, or 0.
+  uint32 LookUpIndex(const IndexMap& index_map, const std::string& key) const;
+
+  // Evicts the last entry, removing it from the index maps.
+  void EvictLastEntry();
+
   std::deque<HpackEntry> entries_;
   uint32 size_;
   uint32 max_size_;
 
+  uint64 insertion_count_;
+  IndexMap name_index_;
+  IndexMap name_and_value_index_;
+
   DISALLOW_COPY_AND_ASSIGN(HpackHeaderTable);
 };
 
@@ -214,6 +214,55 @@ TEST(HpackHeaderTableTest, TryAddTooLargeEntry) {
   EXPECT_EQ(0u, header_table.GetEntryCount());
 }
 
+// Add entries with the same name and check that the lookups find the
+// most recently added one, and track the indices as entries are added
+// and evicted.
+TEST(HpackHeaderTableTest, IndexLookups) {
+  HpackHeaderTable header_table;
+
+  EXPECT_EQ(0u, header_table.GetIndexOfName("name"));
+  EXPECT_EQ(0u, header_table.GetIndexOfNameAndValue("name", "value1"));
+
+  uint32 index = 0;
+  std::vector<uint32> removed_referenced_indices;
+  header_table.TryAddEntry(HpackEntry("name", "value1"), &index,
+                           &removed_referenced_indices);
+  header_table.TryAddEntry(HpackEntry("name", "value2"), &index,
+                           &removed_referenced_indices);
+  header_table.TryAddEntry(HpackEntry("other", "value1"), &index,
+                           &removed_referenced_indices);
+
+  EXPECT_EQ(2u, header_table.GetIndexOfName("name"));
+  EXPECT_EQ(3u, header_table.GetIndexOfNameAndValue("name", "value1"));
+  EXPECT_EQ(2u, header_table.GetIndexOfNameAndValue("name", "value2"));
+  EXPECT_EQ(1u, header_table.GetIndexOfNameAndValue("other", "value1"));
+  EXPECT_EQ(0u, header_table.GetIndexOfNameAndValue("other", "value2"));
+
+  // Only the oldest entry is evicted, which no longer shadows anything.
+  header_table.SetMaxSize(header_table.size() - 1);
+  EXPECT_EQ(2u, header_table.GetEntryCount());
+  EXPECT_EQ(2u, header_table.GetIndexOfName("name"));
+  EXPECT_EQ(0u, header_table.GetIndexOfNameAndValue("name", "value1"));
+  EXPECT_EQ(2u, header_table.GetIndexOfNameAndValue("name", "value2"));
+
+  header_table.SetMaxSize(0);
+  EXPECT_EQ(0u, header_table.GetIndexOfName("name"));
+  EXPECT_EQ(0u, header_table.GetIndexOfName("other"));
+}
+
+// Test that values containing '\0' don't collide with other names.
+TEST(HpackHeaderTableTest, IndexLookupsWithNulValues) {
+  HpackHeaderTable header_table;
+
+  uint32 index = 0;
+  std::vector<uint32> removed_referenced_indices;
+  header_table.TryAddEntry(HpackEntry("a", string("b\0c", 3)), &index,
+                           &removed_referenced_indices);
+  EXPECT_EQ(1u, header_table.GetIndexOfNameAndValue("a", string("b\0c", 3)));
+  EXPECT_EQ(0u, header_table.GetIndexOfNameAndValue("a", "b"));
+  EXPECT_EQ(0u, header_table.GetIndexOfName(string("a\0b", 3)));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -0,0 +1,229 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_huffman_table.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace net {
+
+using base::StringPiece;
+using std::string;
+
+namespace {
+
+// The id of EOS, which is the last symbol.
+const uint16 kEosId = 256;
+
+// The number of bits looked up by the root decode table, and at most
+// by the tables it points to. The codes of the octets common in
+// headers fit in the root table.
+const uint8 kRootIndexedLength = 9;
+const uint8 kBranchIndexedLength = 6;
+
+// The longest code supported, so that a decode lookup can be done on
+// 32 bits of input.
+const uint8 kMaxCodeLength = 32;
+
+// Returns the code of |symbol| in the most significant bits.
+uint32 LeftAlignedCode(const HpackHuffmanSymbol& symbol) {
+  return symbol.code << (kMaxCodeLength - symbol.length);
+}
+
+uint8 MaxLength(const std::vector<HpackHuffmanSymbol>& symbols) {
+  uint8 max_length = 0;
+  for (size_t i = 0; i < symbols.size(); ++i)
+    max_length = std::max(max_length, symbols[i].length);
+  return max_length;
+}
+
+}  // namespace
+
+HpackHuffmanTable::HpackHuffmanTable() {}
+
+HpackHuffmanTable::~HpackHuffmanTable() {}
+
+bool HpackHuffmanTable::Initialize(const HpackHuffmanSymbol* symbols,
+                                   size_t symbol_count) {
+  CHECK(!IsInitialized());
+  if (symbol_count != kEosId + 1u)
+    return false;
+
+  std::vector<HpackHuffmanSymbol> code(symbols, symbols + symbol_count);
+  for (size_t i = 0; i < code.size(); ++i) {
+    if (code[i].id != i || code[i].length == 0 ||
+        code[i].length > kMaxCodeLength ||
+        (code[i].length < kMaxCodeLength &&
+         (code[i].code >> code[i].length) != 0)) {
+      return false;
+    }
+  }
+
+  size_t root_index = 0;
+  if (!BuildDecodeTable(code, 0,
+                        std::min(kRootIndexedLength, MaxLength(code)),
+                        &root_index)) {
+    decode_tables_.clear();
+    decode_entries_.clear();
+    return false;
+  }
+  DCHECK_EQ(0u, root_index);
+  code_by_id_.swap(code);
+  return true;
+}
+
+bool HpackHuffmanTable::IsInitialized() const {
+  return !code_by_id_.empty();
+}
+
+bool HpackHuffmanTable::BuildDecodeTable(
+    const std::vector<HpackHuffmanSymbol>& symbols,
+    uint8 prefix_length,
+    uint8 indexed_length,
+    size_t* table_index) {
+  DCHECK_GT(indexed_length, 0u);
+  DCHECK_LE(prefix_length + indexed_length, kMaxCodeLength);
+  *table_index = decode_tables_.size();
+  const DecodeTable table = {
+    prefix_length, indexed_length, decode_entries_.size()
+  };
+  decode_tables_.push_back(table);
+
+  const size_t entry_count = static_cast<size_t>(1) << indexed_length;
+  const DecodeEntry empty_entry = { 0, 0, 0 };
+  decode_entries_.resize(decode_entries_.size() + entry_count, empty_entry);
+
+  // The codes longer than this table, by the entry they go through.
+  std::vector<std::vector<HpackHuffmanSymbol> > branches(entry_count);
+  const uint8 total_length = prefix_length + indexed_length;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    const HpackHuffmanSymbol& symbol = symbols[i];
+    const uint32 slot = (LeftAlignedCode(symbol) << prefix_length) >>
+        (kMaxCodeLength - indexed_length);
+    if (symbol.length > total_length) {
+      branches[slot].push_back(symbol);
+      continue;
+    }
+    // The symbol fills all the entries whose bits start with its code.
+    const size_t slot_count =
+        static_cast<size_t>(1) << (total_length - symbol.length);
+    for (size_t j = 0; j < slot_count; ++j) {
+      DecodeEntry* entry = &decode_entries_[table.entries_offset + slot + j];
+      if (entry->length != 0)
+        return false;
+      entry->length = symbol.length;
+      entry->symbol_id = symbol.id;
+    }
+  }
+
+  for (size_t slot = 0; slot < entry_count; ++slot) {
+    if (branches[slot].empty())
+      continue;
+    // A shorter code would be a prefix of the branch's codes.
+    if (decode_entries_[table.entries_offset + slot].length != 0)
+      return false;
+    const uint8 next_indexed_length = std::min<uint8>(
+        kBranchIndexedLength, MaxLength(branches[slot]) - total_length);
+    size_t next_table_index = 0;
+    if (!BuildDecodeTable(branches[slot], total_length, next_indexed_length,
+                          &next_table_index) ||
+        next_table_index > kuint16max) {
+      return false;
+    }
+    decode_entries_[table.entries_offset + slot].next_table_index =
+        static_cast<uint16>(next_table_index);
+  }
+  return true;
+}
+
+size_t HpackHuffmanTable::EncodedSize(StringPiece in) const {
+  DCHECK(IsInitialized());
+  size_t bit_count = 0;
+  for (size_t i = 0; i < in.size(); ++i)
+    bit_count += code_by_id_[static_cast<uint8>(in[i])].length;
+  return (bit_count + 7) / 8;
+}
+
+void HpackHuffmanTable::EncodeString(StringPiece in, string* out) const {
+  DCHECK(IsInitialized());
+  out->reserve(out->size() + EncodedSize(in));
+  // Holds the lower |bit_count| bits, less than 8 between symbols.
+  uint64 bits = 0;
+  size_t bit_count = 0;
+  for (size_t i = 0; i < in.size(); ++i) {
+    const HpackHuffmanSymbol& symbol = code_by_id_[static_cast<uint8>(in[i])];
+    bits = (bits << symbol.length) | symbol.code;
+    bit_count += symbol.length;
+    while (bit_count >= 8) {
+      bit_count -= 8;
+      out->push_back(static_cast<char>(bits >> bit_count));
+    }
+    bits &= (static_cast<uint64>(1) << bit_count) - 1;
+  }
+  if (bit_count > 0) {
+    const HpackHuffmanSymbol& eos = code_by_id_[kEosId];
+    const size_t padding_length = 8 - bit_count;
+    bits = (bits << padding_length) |
+        (eos.code >> (eos.length - padding_length));
+    out->push_back(static_cast<char>(bits));
+  }
+}
+
+bool HpackHuffmanTable::DecodeString(StringPiece in,
+                                     size_t out_capacity,
+                                     string* out) const {
+  DCHECK(IsInitialized());
+  const size_t initial_out_size = out->size();
+  // Holds |bit_count| bits of input in the most significant bits.
+  uint64 bits = 0;
+  size_t bit_count = 0;
+  size_t in_offset = 0;
+  while (true) {
+    while (bit_count <= 56 && in_offset < in.size()) {
+      bits |= static_cast<uint64>(static_cast<uint8>(in[in_offset++])) <<
+          (56 - bit_count);
+      bit_count += 8;
+    }
+    if (bit_count == 0)
+      return true;
+
+    const uint32 peeked = static_cast<uint32>(bits >> 32);
+    size_t table_index = 0;
+    const DecodeEntry* entry = NULL;
+    while (true) {
+      const DecodeTable& table = decode_tables_[table_index];
+      const uint32 slot = (peeked << table.prefix_length) >>
+          (kMaxCodeLength - table.indexed_length);
+      entry = &decode_entries_[table.entries_offset + slot];
+      if (entry->next_table_index == 0)
+        break;
+      table_index = entry->next_table_index;
+    }
+    if (entry->length == 0)
+      return false;
+
+    if (entry->length > bit_count) {
+      // The input is exhausted. What is left must be padding: less
+      // than an octet of the most significant bits of EOS.
+      DCHECK_EQ(in_offset, in.size());
+      const uint64 padding_mask =
+          ~static_cast<uint64>(0) << (64 - bit_count);
+      const uint64 eos_bits =
+          static_cast<uint64>(LeftAlignedCode(code_by_id_[kEosId])) << 32;
+      return bit_count < 8 &&
+          (bits & padding_mask) == (eos_bits & padding_mask);
+    }
+    if (entry->symbol_id == kEosId)
+      return false;
+    if (out->size() - initial_out_size >= out_capacity)
+      return false;
+    out->push_back(static_cast<char>(entry->symbol_id));
+    bits <<= entry->length;
+    bit_count -= entry->length;
+  }
+}
+
+}  // namespace net
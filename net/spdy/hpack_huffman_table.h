@@ -0,0 +1,92 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SPDY_HPACK_HUFFMAN_TABLE_H_
+#define NET_SPDY_HPACK_HUFFMAN_TABLE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+#include "net/spdy/hpack_constants.h"
+
+namespace net {
+
+// A HpackHuffmanTable encodes and decodes string literals with a
+// canonical Huffman code (4.1.2). Decoding is table-driven: each
+// lookup consumes several bits of input at once, and codes longer
+// than the root table are resolved through chained sub-tables.
+class NET_EXPORT_PRIVATE HpackHuffmanTable {
+ public:
+  HpackHuffmanTable();
+  ~HpackHuffmanTable();
+
+  // Prepares the table for the given code, which must define the
+  // symbols 0 to 255 and EOS (256), in order of their ids, and be
+  // prefix-free. Returns whether or not the code was valid; if not,
+  // no other member function may be called.
+  bool Initialize(const HpackHuffmanSymbol* symbols, size_t symbol_count);
+
+  // Returns whether Initialize() has been successfully called.
+  bool IsInitialized() const;
+
+  // Returns the size in octets of the encoding of |in|.
+  size_t EncodedSize(base::StringPiece in) const;
+
+  // Appends the encoding of |in| to |out|. The last octet is padded
+  // with the most significant bits of EOS.
+  void EncodeString(base::StringPiece in, std::string* out) const;
+
+  // Decodes |in| and appends the result to |out|. Returns false if
+  // |in| is not a valid encoding, which includes padding longer than
+  // 7 bits or not made of the bits of EOS, or if more than
+  // |out_capacity| octets would be appended.
+  bool DecodeString(base::StringPiece in,
+                    size_t out_capacity,
+                    std::string* out) const;
+
+ private:
+  // Entries of the decode tables. An entry either points to the table
+  // resolving the following bits, or holds the symbol whose code
+  // starts with the bits looked up and how long that code is.
+  struct DecodeEntry {
+    uint16 next_table_index;
+    uint8 length;
+    uint16 symbol_id;
+  };
+
+  // A decode table looks up |indexed_length| bits following the
+  // first |prefix_length| bits of a code. The root table has index 0
+  // and a |prefix_length| of 0.
+  struct DecodeTable {
+    uint8 prefix_length;
+    uint8 indexed_length;
+    size_t entries_offset;
+  };
+
+  // Adds the decode table resolving |symbols|, whose codes share
+  // their first |prefix_length| bits, and the tables it points to.
+  // Fills in |table_index| with the index of the added table. Returns
+  // false if the codes are not prefix-free.
+  bool BuildDecodeTable(const std::vector<HpackHuffmanSymbol>& symbols,
+                        uint8 prefix_length,
+                        uint8 indexed_length,
+                        size_t* table_index);
+
+  // Indexed by symbol id.
+  std::vector<HpackHuffmanSymbol> code_by_id_;
+
+  std::vector<DecodeTable> decode_tables_;
+  std::vector<DecodeEntry> decode_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(HpackHuffmanTable);
+};
+
+}  // namespace net
+
+#endif  // NET_SPDY_HPACK_HUFFMAN_TABLE_H_
@@ -0,0 +1,130 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_huffman_table.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "net/spdy/hpack_constants.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+using std::string;
+
+// Test that the shared table is initialized with a valid code.
+TEST(HpackHuffmanTableTest, SharedTableIsInitialized) {
+  EXPECT_TRUE(ObtainHpackHuffmanTable().IsInitialized());
+}
+
+// Test that a code which is not prefix-free is rejected.
+TEST(HpackHuffmanTableTest, InitializeRejectsPrefixes) {
+  std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+  // The code of 'a' becomes a prefix of the code of '0'.
+  code['a'].code = code['0'].code >> 1;
+  code['a'].length = code['0'].length - 1;
+
+  HpackHuffmanTable table;
+  EXPECT_FALSE(table.Initialize(&code[0], code.size()));
+}
+
+// Test that a code missing symbols is rejected.
+TEST(HpackHuffmanTableTest, InitializeRejectsMissingSymbols) {
+  std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+  HpackHuffmanTable table;
+  EXPECT_FALSE(table.Initialize(&code[0], code.size() - 1));
+}
+
+// Test an encoding from the examples of the spec.
+TEST(HpackHuffmanTableTest, EncodeExample) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string encoded;
+  table.EncodeString("www.example.com", &encoded);
+  EXPECT_EQ("\xf1\xe3\xc2\xe5\xf2\x3a\x6b\xa0\xab\x90\xf4\xff", encoded);
+  EXPECT_EQ(encoded.size(), table.EncodedSize("www.example.com"));
+
+  string decoded;
+  EXPECT_TRUE(table.DecodeString(encoded, kuint32max, &decoded));
+  EXPECT_EQ("www.example.com", decoded);
+}
+
+// Test that all octets survive an encoding and decoding round trip,
+// including the ones with the longest codes.
+TEST(HpackHuffmanTableTest, RoundTripAllOctets) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string input;
+  for (int i = 0; i < 256; ++i)
+    input.push_back(static_cast<char>(i));
+  for (int i = 255; i >= 0; --i)
+    input.push_back(static_cast<char>(i));
+
+  string encoded;
+  table.EncodeString(input, &encoded);
+  EXPECT_EQ(table.EncodedSize(input), encoded.size());
+
+  string decoded;
+  EXPECT_TRUE(table.DecodeString(encoded, input.size(), &decoded));
+  EXPECT_EQ(input, decoded);
+}
+
+// Test that decoding appends to the output.
+TEST(HpackHuffmanTableTest, DecodeAppends) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string encoded;
+  table.EncodeString("bar", &encoded);
+
+  string decoded("foo");
+  EXPECT_TRUE(table.DecodeString(encoded, 3, &decoded));
+  EXPECT_EQ("foobar", decoded);
+}
+
+// Test that decoding more octets than the capacity fails.
+TEST(HpackHuffmanTableTest, DecodeCapacity) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string encoded;
+  table.EncodeString("www.example.com", &encoded);
+
+  string decoded;
+  EXPECT_FALSE(table.DecodeString(encoded, 14, &decoded));
+}
+
+// Test that invalid padding is rejected.
+TEST(HpackHuffmanTableTest, DecodeInvalidPadding) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  string decoded;
+
+  // '0' is 00000, padded with zeros instead of ones.
+  EXPECT_FALSE(table.DecodeString(string("\x00", 1), kuint32max, &decoded));
+
+  // A full octet of padding.
+  string encoded;
+  table.EncodeString("0", &encoded);
+  encoded.push_back('\xff');
+  EXPECT_FALSE(table.DecodeString(encoded, kuint32max, &decoded));
+
+  // An encoded EOS.
+  EXPECT_FALSE(table.DecodeString("\xff\xff\xff\xff", kuint32max, &decoded));
+}
+
+// Test that typical header values get shorter.
+TEST(HpackHuffmanTableTest, EncodingIsShorter) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  const char* kValues[] = {
+    "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+    "gzip,deflate,sdch",
+    "en-US,en;q=0.8",
+    "max-age=0",
+  };
+  for (size_t i = 0; i < arraysize(kValues); ++i)
+    EXPECT_LT(table.EncodedSize(kValues[i]), strlen(kValues[i]));
+}
+
+}  // namespace
+
+}  // namespace net
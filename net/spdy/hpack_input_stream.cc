@@ -6,6 +6,7 @@
 
 #include "base/basictypes.h"
 #include "base/logging.h"
+#include "net/spdy/hpack_huffman_table.h"
 
 namespace net {
 
@@ -90,28 +91,36 @@ bool HpackInputStream::DecodeNextUint32(uint32* I) {
   return !has_more;
 }
 
-// TODO(akalin): Figure out how to handle the storage for
-// Huffman-encoded sequences.
-bool HpackInputStream::DecodeNextStringLiteral(StringPiece* str) {
-  if (MatchPrefixAndConsume(kStringLiteralIdentityEncoded)) {
-    uint32 size = 0;
-    if (!DecodeNextUint32(&size))
-      return false;
+bool HpackInputStream::DecodeNextIdentityString(StringPiece* str) {
+  uint32 size = 0;
+  if (!DecodeNextUint32(&size))
+    return false;
 
-    if (size > max_string_literal_size_)
-      return false;
+  if (size > max_string_literal_size_)
+    return false;
 
-    if (size > buffer_.size())
-      return false;
+  if (size > buffer_.size())
+    return false;
 
-    *str = StringPiece(buffer_.data(), size);
-    buffer_.remove_prefix(size);
-    return true;
-  }
+  *str = StringPiece(buffer_.data(), size);
+  buffer_.remove_prefix(size);
+  return true;
+}
 
-  // TODO(akalin): Handle Huffman-encoded sequences.
+bool HpackInputStream::DecodeNextHuffmanString(const HpackHuffmanTable& table,
+                                               std::string* str) {
+  uint32 encoded_size = 0;
+  if (!DecodeNextUint32(&encoded_size))
+    return false;
 
-  return false;
+  if (encoded_size > buffer_.size())
+    return false;
+
+  // The size limit applies to the decoded string.
+  str->clear();
+  StringPiece encoded(buffer_.data(), encoded_size);
+  buffer_.remove_prefix(encoded_size);
+  return table.DecodeString(encoded, max_string_literal_size_, str);
 }
 
 }  // namespace net
@@ -20,6 +20,8 @@
 
 namespace net {
 
+class HpackHuffmanTable;
+
 // TODO(akalin): When we use a callback/delegate instead of a vector,
 // use StringPiece instead of string.
 typedef std::pair<std::string, std::string> HpackHeaderPair;
@@ -46,7 +48,17 @@ class NET_EXPORT_PRIVATE HpackInputStream {
   // decoding was successful, or false if an error was encountered.
 
   bool DecodeNextUint32(uint32* I);
-  bool DecodeNextStringLiteral(base::StringPiece* str);
+
+  // The string decoding functions below must be called once the
+  // string literal prefix has been matched.
+
+  // |str| points into the input buffer.
+  bool DecodeNextIdentityString(base::StringPiece* str);
+
+  // Decodes a Huffman-encoded string into |str|, whose previous
+  // contents are discarded.
+  bool DecodeNextHuffmanString(const HpackHuffmanTable& table,
+                               std::string* str);
 
   // Accessors for testing.
 
@@ -58,8 +70,13 @@ class NET_EXPORT_PRIVATE HpackInputStream {
     return DecodeNextUint32(I);
   }
 
-  bool DecodeNextStringLiteralForTest(base::StringPiece *str) {
-    return DecodeNextStringLiteral(str);
+  bool DecodeNextIdentityStringForTest(base::StringPiece* str) {
+    return DecodeNextIdentityString(str);
+  }
+
+  bool DecodeNextHuffmanStringForTest(const HpackHuffmanTable& table,
+                                      std::string* str) {
+    return DecodeNextHuffmanString(table, str);
   }
 
  private:
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "base/strings/string_piece.h"
+#include "net/spdy/hpack_huffman_table.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -454,35 +455,72 @@ TEST(HpackInputStreamTest, SevenByteIntegersOneToSevenBitPrefixes) {
 }
 
 // Decoding a valid encoded string literal should work.
-TEST(HpackInputStreamTest, DecodeNextStringLiteral) {
+TEST(HpackInputStreamTest, DecodeNextIdentityString) {
   HpackInputStream input_stream(kuint32max, "\x0estring literal");
 
   EXPECT_TRUE(input_stream.HasMoreData());
+  EXPECT_TRUE(input_stream.MatchPrefixAndConsume(
+      kStringLiteralIdentityEncoded));
   StringPiece string_piece;
-  EXPECT_TRUE(input_stream.DecodeNextStringLiteralForTest(&string_piece));
+  EXPECT_TRUE(input_stream.DecodeNextIdentityStringForTest(&string_piece));
   EXPECT_EQ("string literal", string_piece);
   EXPECT_FALSE(input_stream.HasMoreData());
 }
 
 // Decoding an encoded string literal with size larger than
 // |max_string_literal_size_| should fail.
-TEST(HpackInputStreamTest, DecodeNextStringLiteralSizeLimit) {
+TEST(HpackInputStreamTest, DecodeNextIdentityStringSizeLimit) {
   HpackInputStream input_stream(13, "\x0estring literal");
 
   EXPECT_TRUE(input_stream.HasMoreData());
+  EXPECT_TRUE(input_stream.MatchPrefixAndConsume(
+      kStringLiteralIdentityEncoded));
   StringPiece string_piece;
-  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece));
+  EXPECT_FALSE(input_stream.DecodeNextIdentityStringForTest(&string_piece));
 }
 
 // Decoding an encoded string literal with size larger than the
 // remainder of the buffer should fail.
-TEST(HpackInputStreamTest, DecodeNextStringLiteralInvalidSize) {
+TEST(HpackInputStreamTest, DecodeNextIdentityStringInvalidSize) {
   // Set the length to be one more than it should be.
   HpackInputStream input_stream(kuint32max, "\x0fstring literal");
 
   EXPECT_TRUE(input_stream.HasMoreData());
+  EXPECT_TRUE(input_stream.MatchPrefixAndConsume(
+      kStringLiteralIdentityEncoded));
   StringPiece string_piece;
-  EXPECT_FALSE(input_stream.DecodeNextStringLiteralForTest(&string_piece));
+  EXPECT_FALSE(input_stream.DecodeNextIdentityStringForTest(&string_piece));
+}
+
+// Decoding a valid Huffman-encoded string literal should work.
+TEST(HpackInputStreamTest, DecodeNextHuffmanString) {
+  string encoded;
+  ObtainHpackHuffmanTable().EncodeString("string literal", &encoded);
+  ASSERT_LT(encoded.size(), 0x7fu);
+  string input = string(1, 0x80 | encoded.size()) + encoded;
+  HpackInputStream input_stream(kuint32max, input);
+
+  EXPECT_TRUE(input_stream.MatchPrefixAndConsume(
+      kStringLiteralHuffmanEncoded));
+  string decoded("previous contents");
+  EXPECT_TRUE(input_stream.DecodeNextHuffmanStringForTest(
+      ObtainHpackHuffmanTable(), &decoded));
+  EXPECT_EQ("string literal", decoded);
+  EXPECT_FALSE(input_stream.HasMoreData());
+}
+
+// The size limit applies to the decoded Huffman-encoded string.
+TEST(HpackInputStreamTest, DecodeNextHuffmanStringSizeLimit) {
+  string encoded;
+  ObtainHpackHuffmanTable().EncodeString("string literal", &encoded);
+  string input = string(1, 0x80 | encoded.size()) + encoded;
+  HpackInputStream input_stream(13, input);
+
+  EXPECT_TRUE(input_stream.MatchPrefixAndConsume(
+      kStringLiteralHuffmanEncoded));
+  string decoded;
+  EXPECT_FALSE(input_stream.DecodeNextHuffmanStringForTest(
+      ObtainHpackHuffmanTable(), &decoded));
 }
 
 }  // namespace
@@ -5,6 +5,7 @@
 #include "net/spdy/hpack_output_stream.h"
 
 #include "base/logging.h"
+#include "net/spdy/hpack_huffman_table.h"
 
 using base::StringPiece;
 
@@ -14,6 +15,7 @@ using std::string;
 
 HpackOutputStream::HpackOutputStream(uint32 max_string_literal_size)
     : max_string_literal_size_(max_string_literal_size),
+      huffman_table_(NULL),
       bit_offset_(0) {}
 
 HpackOutputStream::~HpackOutputStream() {}
@@ -34,6 +36,23 @@ bool HpackOutputStream::AppendLiteralHeaderNoIndexingWithName(
   return true;
 }
 
+bool HpackOutputStream::AppendLiteralHeaderNoIndexingWithIndexedName(
+    uint32 name_index, StringPiece value) {
+  DCHECK_GT(name_index, 0u);
+  AppendPrefix(kLiteralNoIndexOpcode);
+  AppendUint32(name_index);
+  return AppendStringLiteral(value);
+}
+
+bool HpackOutputStream::AppendLiteralHeaderIncrementalIndexing(
+    uint32 name_index, StringPiece name, StringPiece value) {
+  AppendPrefix(kLiteralIncrementalIndexOpcode);
+  AppendUint32(name_index);
+  if (name_index == 0 && !AppendStringLiteral(name))
+    return false;
+  return AppendStringLiteral(value);
+}
+
 void HpackOutputStream::TakeString(string* output) {
   // This must hold, since all public functions cause the buffer to
   // end on a byte boundary.
@@ -88,10 +107,18 @@ void HpackOutputStream::AppendUint32(uint32 I) {
 
 bool HpackOutputStream::AppendStringLiteral(base::StringPiece str) {
   DCHECK_EQ(bit_offset_, 0u);
-  // TODO(akalin): Implement Huffman encoding.
-  AppendPrefix(kStringLiteralIdentityEncoded);
   if (str.size() > max_string_literal_size_)
     return false;
+  if (huffman_table_) {
+    size_t encoded_size = huffman_table_->EncodedSize(str);
+    if (encoded_size < str.size()) {
+      AppendPrefix(kStringLiteralHuffmanEncoded);
+      AppendUint32(static_cast<uint32>(encoded_size));
+      huffman_table_->EncodeString(str, &buffer_);
+      return true;
+    }
+  }
+  AppendPrefix(kStringLiteralIdentityEncoded);
   AppendUint32(static_cast<uint32>(str.size()));
   buffer_.append(str.data(), str.size());
   return true;
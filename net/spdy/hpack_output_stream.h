@@ -21,6 +21,8 @@
 
 namespace net {
 
+class HpackHuffmanTable;
+
 // An HpackOutputStream handles all the low-level details of encoding
 // header fields.
 class NET_EXPORT_PRIVATE HpackOutputStream {
@@ -30,6 +32,12 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   explicit HpackOutputStream(uint32 max_string_literal_size);
   ~HpackOutputStream();
 
+  // If set, string literals are Huffman-encoded with |table| whenever
+  // that makes them shorter. |table| must outlive this object.
+  void set_huffman_table(const HpackHuffmanTable* table) {
+    huffman_table_ = table;
+  }
+
   // Corresponds to 4.2.
   void AppendIndexedHeader(uint32 index_or_zero);
 
@@ -39,6 +47,17 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   bool AppendLiteralHeaderNoIndexingWithName(base::StringPiece name,
                                              base::StringPiece value);
 
+  // Corresponds to 4.3.1 (first form), the name being the one at
+  // |name_index|. Same return value as above.
+  bool AppendLiteralHeaderNoIndexingWithIndexedName(uint32 name_index,
+                                                    base::StringPiece value);
+
+  // Corresponds to 4.3.2, the name being the one at |name_index|, or
+  // |name| if |name_index| is 0. Same return value as above.
+  bool AppendLiteralHeaderIncrementalIndexing(uint32 name_index,
+                                              base::StringPiece name,
+                                              base::StringPiece value);
+
   // Moves the internal buffer to the given string and clears all
   // internal state.
   void TakeString(std::string* output);
@@ -85,6 +104,7 @@ class NET_EXPORT_PRIVATE HpackOutputStream {
   bool AppendStringLiteral(base::StringPiece str);
 
   const uint32 max_string_literal_size_;
+  const HpackHuffmanTable* huffman_table_;
 
   // The internal bit buffer.
   std::string buffer_;
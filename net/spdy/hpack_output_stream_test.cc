@@ -7,6 +7,7 @@
 #include <cstddef>
 
 #include "base/basictypes.h"
+#include "net/spdy/hpack_huffman_table.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -258,6 +259,36 @@ TEST(HpackOutputStreamTest, AppendStringLiteralNoHuffmanEncoding) {
   EXPECT_EQ(string("\x7f\x00", 2) + literal, str);
 }
 
+// Test that a string literal is Huffman-encoded when a table is set
+// and that makes it shorter.
+TEST(HpackOutputStreamTest, AppendStringLiteralHuffmanEncoding) {
+  const HpackHuffmanTable& table = ObtainHpackHuffmanTable();
+  HpackOutputStream output_stream(kuint32max);
+  output_stream.set_huffman_table(&table);
+
+  EXPECT_TRUE(output_stream.AppendStringLiteralForTest("www.example.com"));
+  string encoded;
+  table.EncodeString("www.example.com", &encoded);
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ(string(1, 0x80 | encoded.size()) + encoded, str);
+}
+
+// Test that a string literal is left unmodified when Huffman
+// encoding doesn't make it shorter.
+TEST(HpackOutputStreamTest, AppendStringLiteralHuffmanEncodingLonger) {
+  HpackOutputStream output_stream(kuint32max);
+  output_stream.set_huffman_table(&ObtainHpackHuffmanTable());
+
+  string literal("\x01\x02\x03");
+  EXPECT_TRUE(output_stream.AppendStringLiteralForTest(literal));
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ("\x03" + literal, str);
+}
+
 // Test that trying to encode a too-long string literal will fail.
 TEST(HpackOutputStreamTest, AppendStringLiteralTooLong) {
   HpackOutputStream output_stream(kuint32max - 1);
@@ -288,6 +319,32 @@ TEST(HpackOutputStreamTest, AppendLiteralHeaderNoIndexingWithName) {
   EXPECT_EQ("\x40\x04name\x05value", str);
 }
 
+// Test that encoding a literal header without indexing with an
+// indexed name encodes the index and the value.
+TEST(HpackOutputStreamTest, AppendLiteralHeaderNoIndexingWithIndexedName) {
+  HpackOutputStream output_stream(kuint32max);
+  EXPECT_TRUE(
+      output_stream.AppendLiteralHeaderNoIndexingWithIndexedName(4, "value"));
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ("\x44\x05value", str);
+}
+
+// Test that encoding a literal header with incremental indexing
+// encodes the name as an index if given one, or as a string literal.
+TEST(HpackOutputStreamTest, AppendLiteralHeaderIncrementalIndexing) {
+  HpackOutputStream output_stream(kuint32max);
+  EXPECT_TRUE(
+      output_stream.AppendLiteralHeaderIncrementalIndexing(4, "", "value"));
+  EXPECT_TRUE(
+      output_stream.AppendLiteralHeaderIncrementalIndexing(0, "name", "value"));
+
+  string str;
+  output_stream.TakeString(&str);
+  EXPECT_EQ(string("\x04\x05value\x00\x04name\x05value", 19), str);
+}
+
 // Test that trying to encode a header with a too-long header name or
 // value will fail.
 TEST(HpackOutputStreamTest, AppendLiteralHeaderNoIndexingWithNameTooLong) {
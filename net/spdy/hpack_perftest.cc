@@ -0,0 +1,143 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/perf_log.h"
+#include "base/test/perf_time_logger.h"
+#include "net/spdy/hpack_decoder.h"
+#include "net/spdy/hpack_encoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+using std::string;
+
+const int kIterations = 1000;
+
+typedef std::map<string, string> HeaderSet;
+
+// Returns a sequence of request header sets, as a browser would send
+// while loading a page and its subresources.
+std::vector<HeaderSet> MakeRequestHeaderSets() {
+  std::vector<HeaderSet> header_sets;
+  for (int i = 0; i < 20; ++i) {
+    HeaderSet header_set;
+    header_set[":method"] = "GET";
+    header_set[":scheme"] = "https";
+    header_set[":authority"] = "www.example.com";
+    header_set[":path"] = (i == 0) ? "/" :
+        "/static/resource" + base::IntToString(i) + ".js";
+    header_set["accept"] = (i == 0) ?
+        "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8" :
+        "*/*";
+    header_set["accept-encoding"] = "gzip,deflate,sdch";
+    header_set["accept-language"] = "en-US,en;q=0.8";
+    header_set["user-agent"] =
+        "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/33.0.1750.117 Safari/537.36";
+    header_set["cookie"] =
+        "PREF=ID=8f5d7d1a2b3c4e5f:U=0123456789abcdef:FF=0:TM=1392691145:"
+        "LM=1392691145:S=abcdefghijklmnop; NID=67=abcdefghijklmnopqrstuvwxyz";
+    if (i > 0)
+      header_set["referer"] = "https://www.example.com/";
+    header_sets.push_back(header_set);
+  }
+  return header_sets;
+}
+
+// Returns a sequence of response header sets matching the requests
+// above.
+std::vector<HeaderSet> MakeResponseHeaderSets() {
+  std::vector<HeaderSet> header_sets;
+  for (int i = 0; i < 20; ++i) {
+    HeaderSet header_set;
+    header_set[":status"] = "200";
+    header_set["cache-control"] = (i == 0) ? "private, max-age=0" :
+        "public, max-age=31536000";
+    header_set["content-encoding"] = "gzip";
+    header_set["content-length"] = base::IntToString(1000 + 37 * i);
+    header_set["content-type"] = (i == 0) ? "text/html; charset=UTF-8" :
+        "text/javascript";
+    header_set["date"] = "Tue, 18 Feb 2014 02:39:05 GMT";
+    header_set["expires"] = (i == 0) ? "-1" : "Wed, 18 Feb 2015 02:39:05 GMT";
+    header_set["server"] = "gws";
+    if (i == 0)
+      header_set["set-cookie"] = "NID=67=abcdefghijklmnopqrstuvwxyz; path=/";
+    header_sets.push_back(header_set);
+  }
+  return header_sets;
+}
+
+// Encodes |header_sets| in order with a single encoder, as on a
+// single connection, and fills in |encoded_header_sets|.
+void EncodeHeaderSets(const std::vector<HeaderSet>& header_sets,
+                      std::vector<string>* encoded_header_sets) {
+  HpackEncoder encoder(kuint32max);
+  encoded_header_sets->clear();
+  for (size_t i = 0; i < header_sets.size(); ++i) {
+    string encoded_header_set;
+    EXPECT_TRUE(encoder.EncodeHeaderSet(header_sets[i], &encoded_header_set));
+    encoded_header_sets->push_back(encoded_header_set);
+  }
+}
+
+// Decodes |encoded_header_sets| in order with a single decoder.
+void DecodeHeaderSets(const std::vector<string>& encoded_header_sets) {
+  HpackDecoder decoder(kuint32max);
+  for (size_t i = 0; i < encoded_header_sets.size(); ++i) {
+    HpackHeaderPairVector header_list;
+    EXPECT_TRUE(decoder.DecodeHeaderSet(encoded_header_sets[i], &header_list));
+  }
+}
+
+void RunPerfTest(const char* name, const std::vector<HeaderSet>& header_sets) {
+  size_t uncompressed_size = 0;
+  for (size_t i = 0; i < header_sets.size(); ++i) {
+    for (HeaderSet::const_iterator it = header_sets[i].begin();
+         it != header_sets[i].end(); ++it) {
+      uncompressed_size += it->first.size() + it->second.size();
+    }
+  }
+
+  std::vector<string> encoded_header_sets;
+  {
+    base::PerfTimeLogger timer((string(name) + "_encode").c_str());
+    for (int i = 0; i < kIterations; ++i)
+      EncodeHeaderSets(header_sets, &encoded_header_sets);
+  }
+
+  size_t compressed_size = 0;
+  for (size_t i = 0; i < encoded_header_sets.size(); ++i)
+    compressed_size += encoded_header_sets[i].size();
+  base::LogPerfResult((string(name) + "_uncompressed_size").c_str(),
+                      uncompressed_size, "bytes");
+  base::LogPerfResult((string(name) + "_compressed_size").c_str(),
+                      compressed_size, "bytes");
+  EXPECT_LT(compressed_size, uncompressed_size);
+
+  {
+    base::PerfTimeLogger timer((string(name) + "_decode").c_str());
+    for (int i = 0; i < kIterations; ++i)
+      DecodeHeaderSets(encoded_header_sets);
+  }
+}
+
+TEST(HpackPerfTest, RequestHeaderSets) {
+  RunPerfTest("hpack_request", MakeRequestHeaderSets());
+}
+
+TEST(HpackPerfTest, ResponseHeaderSets) {
+  RunPerfTest("hpack_response", MakeResponseHeaderSets());
+}
+
+}  // namespace
+
+}  // namespace net
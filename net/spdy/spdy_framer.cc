@@ -1686,6 +1686,28 @@ size_t SpdyFramer::ProcessDataFramePayload(const char* data, size_t len) {
 size_t SpdyFramer::ParseHeaderBlockInBuffer(const char* header_data,
                                           size_t header_length,
                                           SpdyHeaderBlock* block) const {
+  SpdyHeaderBlockView view;
+  size_t bytes_consumed =
+      ParseHeaderBlockInBuffer(header_data, header_length, &view);
+  if (bytes_consumed == 0)
+    return 0;
+
+  // Ensure no duplicates with what |block| already holds.
+  for (SpdyHeaderBlockView::const_iterator it = view.begin();
+       it != view.end(); ++it) {
+    if (block->find(it->first.as_string()) != block->end()) {
+      DVLOG(1) << "Duplicate header '" << it->first << "'.";
+      return 0;
+    }
+  }
+  view.CopyTo(block);
+  return bytes_consumed;
+}
+
+size_t SpdyFramer::ParseHeaderBlockInBuffer(const char* header_data,
+                                            size_t header_length,
+                                            SpdyHeaderBlockView* view) const {
+  view->Clear();
   SpdyFrameReader reader(header_data, header_length);
 
   // Read number of headers.
@@ -1706,35 +1728,32 @@ size_t SpdyFramer::ParseHeaderBlockInBuffer(const char* header_data,
 
   // Read each header.
   for (uint32 index = 0; index < num_headers; ++index) {
-    base::StringPiece temp;
+    base::StringPiece name;
+    base::StringPiece value;
 
     // Read header name.
-    if ((spdy_version_ < 3) ? !reader.ReadStringPiece16(&temp)
-                            : !reader.ReadStringPiece32(&temp)) {
+    if ((spdy_version_ < 3) ? !reader.ReadStringPiece16(&name)
+                            : !reader.ReadStringPiece32(&name)) {
       DVLOG(1) << "Unable to read header name (" << index + 1 << " of "
                << num_headers << ").";
       return 0;
     }
-    std::string name = temp.as_string();
 
     // Read header value.
-    if ((spdy_version_ < 3) ? !reader.ReadStringPiece16(&temp)
-                            : !reader.ReadStringPiece32(&temp)) {
+    if ((spdy_version_ < 3) ? !reader.ReadStringPiece16(&value)
+                            : !reader.ReadStringPiece32(&value)) {
       DVLOG(1) << "Unable to read header value (" << index + 1 << " of "
                << num_headers << ").";
       return 0;
     }
-    std::string value = temp.as_string();
 
-    // Ensure no duplicates.
-    if (block->find(name) != block->end()) {
-      DVLOG(1) << "Duplicate header '" << name << "' (" << index + 1 << " of "
-               << num_headers << ").";
-      return 0;
-    }
+    view->Append(name, value);
+  }
 
-    // Store header.
-    (*block)[name] = value;
+  // Ensure no duplicates.
+  if (!view->Finalize()) {
+    DVLOG(1) << "Duplicate header in block of " << num_headers << ".";
+    return 0;
   }
   return reader.GetBytesConsumed();
 }
@@ -352,6 +352,12 @@ class NET_EXPORT_PRIVATE SpdyFramer {
                                 size_t header_length,
                                 SpdyHeaderBlock* block) const;
 
+  // Like the above, but fills in |view| with pieces of |header_data|
+  // instead of copying the names and values. |view| is cleared first.
+  size_t ParseHeaderBlockInBuffer(const char* header_data,
+                                  size_t header_length,
+                                  SpdyHeaderBlockView* view) const;
+
   // Serialize a data frame.
   SpdySerializedFrame* SerializeData(const SpdyDataIR& data) const;
   // Serializes just the data frame header, excluding actual data payload.
@@ -592,6 +592,42 @@ TEST_P(SpdyFramerTest, HeaderBlockInBuffer) {
   EXPECT_EQ(headers["gamma"], new_headers["gamma"]);
 }
 
+// Test that a header block parsed into a view points into the buffer.
+TEST_P(SpdyFramerTest, HeaderBlockViewInBuffer) {
+  SpdyFramer framer(spdy_version_);
+  framer.set_enable_compression(false);
+
+  SpdySynStreamIR syn_stream(1);
+  syn_stream.set_priority(1);
+  syn_stream.SetHeader("alpha", "beta");
+  syn_stream.SetHeader("gamma", "charlie");
+  scoped_ptr<SpdyFrame> frame(framer.SerializeSynStream(syn_stream));
+  EXPECT_TRUE(frame.get() != NULL);
+  base::StringPiece serialized_headers =
+      GetSerializedHeaders(frame.get(), framer);
+  SpdyHeaderBlockView view;
+  EXPECT_EQ(serialized_headers.size(),
+            framer.ParseHeaderBlockInBuffer(serialized_headers.data(),
+                                            serialized_headers.size(),
+                                            &view));
+
+  EXPECT_EQ(2u, view.size());
+  SpdyHeaderBlockView::const_iterator it = view.find("gamma");
+  ASSERT_TRUE(it != view.end());
+  EXPECT_EQ("charlie", it->second);
+  EXPECT_GE(it->second.data(), serialized_headers.data());
+  EXPECT_LE(it->second.data() + it->second.size(),
+            serialized_headers.data() + serialized_headers.size());
+
+  // Parsing into a header block that already holds one of the names
+  // fails.
+  SpdyHeaderBlock headers;
+  headers["alpha"] = "delta";
+  EXPECT_FALSE(framer.ParseHeaderBlockInBuffer(serialized_headers.data(),
+                                               serialized_headers.size(),
+                                               &headers));
+}
+
 // Test that if there's not a full frame, we fail to parse it.
 TEST_P(SpdyFramerTest, UndersizedHeaderBlockInBuffer) {
   SpdyFramer framer(spdy_version_);
@@ -742,6 +778,10 @@ TEST_P(SpdyFramerTest, DuplicateHeader) {
   EXPECT_FALSE(framer.ParseHeaderBlockInBuffer(serialized_headers.data(),
                                                serialized_headers.size(),
                                                &new_headers));
+  SpdyHeaderBlockView view;
+  EXPECT_FALSE(framer.ParseHeaderBlockInBuffer(serialized_headers.data(),
+                                               serialized_headers.size(),
+                                               &view));
 }
 
 TEST_P(SpdyFramerTest, MultiValueHeader) {
@@ -4,11 +4,78 @@
 
 #include "net/spdy/spdy_header_block.h"
 
+#include <algorithm>
+
+#include "base/logging.h"
 #include "base/values.h"
 #include "net/spdy/spdy_http_utils.h"
 
 namespace net {
 
+namespace {
+
+bool HeaderNameLess(const SpdyHeaderBlockView::Header& header1,
+                    const SpdyHeaderBlockView::Header& header2) {
+  return header1.first < header2.first;
+}
+
+}  // namespace
+
+SpdyHeaderBlockView::SpdyHeaderBlockView() : finalized_(true) {}
+
+SpdyHeaderBlockView::SpdyHeaderBlockView(const SpdyHeaderBlock& block)
+    : finalized_(true) {
+  headers_.reserve(block.size());
+  for (SpdyHeaderBlock::const_iterator it = block.begin();
+       it != block.end(); ++it) {
+    headers_.push_back(Header(it->first, it->second));
+  }
+}
+
+SpdyHeaderBlockView::~SpdyHeaderBlockView() {}
+
+void SpdyHeaderBlockView::Append(const base::StringPiece& name,
+                                 const base::StringPiece& value) {
+  headers_.push_back(Header(name, value));
+  finalized_ = false;
+}
+
+bool SpdyHeaderBlockView::Finalize() {
+  std::sort(headers_.begin(), headers_.end(), HeaderNameLess);
+  finalized_ = true;
+  for (size_t i = 1; i < headers_.size(); ++i) {
+    if (headers_[i - 1].first == headers_[i].first)
+      return false;
+  }
+  return true;
+}
+
+void SpdyHeaderBlockView::Clear() {
+  headers_.clear();
+  finalized_ = true;
+}
+
+void SpdyHeaderBlockView::CopyTo(SpdyHeaderBlock* block) const {
+  DCHECK(finalized_);
+  // The headers are sorted, so each insertion is at the end.
+  for (const_iterator it = begin(); it != end(); ++it) {
+    block->insert(block->end(),
+                  SpdyHeaderBlock::value_type(it->first.as_string(),
+                                              it->second.as_string()));
+  }
+}
+
+SpdyHeaderBlockView::const_iterator SpdyHeaderBlockView::find(
+    const base::StringPiece& name) const {
+  DCHECK(finalized_);
+  const_iterator it = std::lower_bound(begin(), end(),
+                                       Header(name, base::StringPiece()),
+                                       HeaderNameLess);
+  if (it != end() && it->first == name)
+    return it;
+  return end();
+}
+
 base::Value* SpdyHeaderBlockNetLogCallback(
     const SpdyHeaderBlock* headers,
     NetLog::LogLevel /* log_level */) {
@@ -7,7 +7,11 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
 
@@ -17,6 +21,55 @@ namespace net {
 // SYN_STREAM or SYN_REPLY frame.
 typedef std::map<std::string, std::string> SpdyHeaderBlock;
 
+// A read-only set of headers whose names and values point into a buffer
+// owned by someone else, typically the buffer a header block was parsed
+// from. Building one doesn't allocate per header, and reusing one after
+// Clear() doesn't allocate at all, so it suits code which only inspects
+// the headers of a frame. A view is valid only as long as the buffer it
+// points into; use CopyTo() to retain the headers.
+//
+// Like a SpdyHeaderBlock, a finalized view is sorted by name and
+// exposes pairs through |first| and |second|.
+class NET_EXPORT_PRIVATE SpdyHeaderBlockView {
+ public:
+  typedef std::pair<base::StringPiece, base::StringPiece> Header;
+  typedef std::vector<Header>::const_iterator const_iterator;
+
+  SpdyHeaderBlockView();
+  // Creates a finalized view of the strings of |block|, which must
+  // outlive the view and not be modified while it is used.
+  explicit SpdyHeaderBlockView(const SpdyHeaderBlock& block);
+  ~SpdyHeaderBlockView();
+
+  // Adds a header. The view must then be finalized before it is
+  // used.
+  void Append(const base::StringPiece& name, const base::StringPiece& value);
+
+  // Sorts the headers by name. Returns false if a name appears more
+  // than once.
+  bool Finalize();
+
+  // Removes all the headers, keeping the allocated storage.
+  void Clear();
+
+  // Copies the headers into |block|.
+  void CopyTo(SpdyHeaderBlock* block) const;
+
+  // Returns the header named |name|, or end().
+  const_iterator find(const base::StringPiece& name) const;
+
+  const_iterator begin() const { return headers_.begin(); }
+  const_iterator end() const { return headers_.end(); }
+  size_t size() const { return headers_.size(); }
+  bool empty() const { return headers_.empty(); }
+
+ private:
+  std::vector<Header> headers_;
+  bool finalized_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpdyHeaderBlockView);
+};
+
 // Converts a SpdyHeaderBlock into NetLog event parameters.  Caller takes
 // ownership of returned value.
 NET_EXPORT base::Value* SpdyHeaderBlockNetLogCallback(
@@ -26,6 +26,59 @@ TEST(SpdyHeaderBlockTest, ToNetLogParamAndBackAgain) {
   EXPECT_EQ(headers, headers2);
 }
 
+TEST(SpdyHeaderBlockTest, ViewOfBuffer) {
+  const char kBuffer[] = "gammacharliealphabeta";
+  base::StringPiece buffer(kBuffer);
+
+  SpdyHeaderBlockView view;
+  view.Append(buffer.substr(0, 5), buffer.substr(5, 7));
+  view.Append(buffer.substr(12, 5), buffer.substr(17, 4));
+  ASSERT_TRUE(view.Finalize());
+  EXPECT_EQ(2u, view.size());
+
+  // The headers are sorted and point into the buffer.
+  EXPECT_EQ("alpha", view.begin()->first);
+  EXPECT_EQ(kBuffer + 12, view.begin()->first.data());
+  SpdyHeaderBlockView::const_iterator it = view.find("gamma");
+  ASSERT_TRUE(it != view.end());
+  EXPECT_EQ("charlie", it->second);
+  EXPECT_TRUE(view.find("delta") == view.end());
+
+  SpdyHeaderBlock headers;
+  view.CopyTo(&headers);
+  SpdyHeaderBlock expected_headers;
+  expected_headers["alpha"] = "beta";
+  expected_headers["gamma"] = "charlie";
+  EXPECT_EQ(expected_headers, headers);
+
+  view.Clear();
+  EXPECT_TRUE(view.empty());
+}
+
+TEST(SpdyHeaderBlockTest, ViewRejectsDuplicates) {
+  SpdyHeaderBlockView view;
+  view.Append("name", "value1");
+  view.Append("other", "value");
+  view.Append("name", "value2");
+  EXPECT_FALSE(view.Finalize());
+}
+
+TEST(SpdyHeaderBlockTest, ViewOfHeaderBlock) {
+  SpdyHeaderBlock headers;
+  headers["A"] = "a";
+  headers["B"] = "b";
+
+  SpdyHeaderBlockView view(headers);
+  EXPECT_EQ(2u, view.size());
+  SpdyHeaderBlockView::const_iterator it = view.find("B");
+  ASSERT_TRUE(it != view.end());
+  EXPECT_EQ(headers["B"].data(), it->second.data());
+
+  SpdyHeaderBlock headers2;
+  view.CopyTo(&headers2);
+  EXPECT_EQ(headers, headers2);
+}
+
 }  // namespace
 
 }  // namespace net
@@ -444,7 +444,7 @@ SpdySession::SpdySession(
       spdy_session_key_(spdy_session_key),
       pool_(NULL),
       http_server_properties_(http_server_properties),
-      read_buffer_(new IOBuffer(kReadBufferSize)),
+      read_buffer_(new PooledIOBuffer(kReadBufferSize)),
       stream_hi_water_mark_(kFirstStreamId),
       in_flight_write_frame_type_(DATA),
       in_flight_write_frame_size_(0),
@@ -572,6 +572,9 @@ Error SpdySession::InitializeWithSocket(
                              enable_compression_));
   buffered_spdy_framer_->set_visitor(this);
   buffered_spdy_framer_->set_debug_visitor(this);
+  // SPDY/4 streams share the connection by weight rather than by
+  // strict priority, so that low priorities are not starved.
+  write_queue_.set_weighted_scheduling(protocol_ >= kProtoSPDY4a2);
   UMA_HISTOGRAM_ENUMERATION("Net.SpdyVersion", protocol_, kProtoMaximumVersion);
 #if defined(SPDY_PROXY_AUTH_ORIGIN)
   UMA_HISTOGRAM_BOOLEAN("Net.SpdySessions_DataReductionProxy",
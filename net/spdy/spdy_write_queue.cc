@@ -13,6 +13,19 @@
 
 namespace net {
 
+namespace {
+
+// The weight of each priority for weighted scheduling, indexed by
+// RequestPriority. Each priority gets four times the share of the one
+// below it.
+const int kPriorityWeights[NUM_PRIORITIES] = { 1, 4, 16, 64, 256 };
+
+int PriorityToNodeId(RequestPriority priority) {
+  return static_cast<int>(priority) + 1;
+}
+
+}  // namespace
+
 SpdyWriteQueue::PendingWrite::PendingWrite() : frame_producer(NULL) {}
 
 SpdyWriteQueue::PendingWrite::PendingWrite(
@@ -26,15 +39,26 @@ SpdyWriteQueue::PendingWrite::PendingWrite(
 
 SpdyWriteQueue::PendingWrite::~PendingWrite() {}
 
-SpdyWriteQueue::SpdyWriteQueue() {}
+SpdyWriteQueue::SpdyWriteQueue() : weighted_scheduling_(false) {
+  for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; ++i) {
+    CHECK(priority_forest_.AddRootNode(
+        PriorityToNodeId(static_cast<RequestPriority>(i)),
+        kPriorityWeights[i]));
+  }
+}
 
 SpdyWriteQueue::~SpdyWriteQueue() {
   Clear();
 }
 
+void SpdyWriteQueue::set_weighted_scheduling(bool weighted_scheduling) {
+  DCHECK(IsEmpty());
+  weighted_scheduling_ = weighted_scheduling;
+}
+
 bool SpdyWriteQueue::IsEmpty() const {
   for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; i++) {
-    if (!queue_[i].empty())
+    if (!queue_[i].empty() || !control_queue_[i].empty())
       return false;
   }
   return true;
@@ -48,26 +72,32 @@ void SpdyWriteQueue::Enqueue(RequestPriority priority,
   CHECK_LE(priority, MAXIMUM_PRIORITY);
   if (stream.get())
     DCHECK_EQ(stream->priority(), priority);
-  queue_[priority].push_back(
-      PendingWrite(frame_type, frame_producer.release(), stream));
+  PendingWrite pending_write(frame_type, frame_producer.release(), stream);
+  if (weighted_scheduling_ && frame_type != DATA) {
+    control_queue_[priority].push_back(pending_write);
+    return;
+  }
+  queue_[priority].push_back(pending_write);
+  UpdateReadyToWrite(priority);
 }
 
 bool SpdyWriteQueue::Dequeue(SpdyFrameType* frame_type,
                              scoped_ptr<SpdyBufferProducer>* frame_producer,
                              base::WeakPtr<SpdyStream>* stream) {
-  for (int i = MAXIMUM_PRIORITY; i >= MINIMUM_PRIORITY; --i) {
-    if (!queue_[i].empty()) {
-      PendingWrite pending_write = queue_[i].front();
-      queue_[i].pop_front();
-      *frame_type = pending_write.frame_type;
-      frame_producer->reset(pending_write.frame_producer);
-      *stream = pending_write.stream;
-      if (pending_write.has_stream)
-        DCHECK(stream->get());
-      return true;
-    }
-  }
-  return false;
+  RequestPriority priority = MINIMUM_PRIORITY;
+  std::deque<PendingWrite>* queue = NextQueueToWrite(&priority);
+  if (!queue)
+    return false;
+
+  PendingWrite pending_write = queue->front();
+  queue->pop_front();
+  UpdateReadyToWrite(priority);
+  *frame_type = pending_write.frame_type;
+  frame_producer->reset(pending_write.frame_producer);
+  *stream = pending_write.stream;
+  if (pending_write.has_stream)
+    DCHECK(stream->get());
+  return true;
 }
 
 void SpdyWriteQueue::RemovePendingWritesForStream(
@@ -87,34 +117,24 @@ void SpdyWriteQueue::RemovePendingWritesForStream(
            it != queue_[i].end(); ++it) {
         DCHECK_NE(it->stream.get(), stream.get());
       }
+      for (std::deque<PendingWrite>::const_iterator it =
+               control_queue_[i].begin();
+           it != control_queue_[i].end(); ++it) {
+        DCHECK_NE(it->stream.get(), stream.get());
+      }
     }
   }
 
   // Do the actual deletion and removal, preserving FIFO-ness.
-  std::deque<PendingWrite>* queue = &queue_[priority];
-  std::deque<PendingWrite>::iterator out_it = queue->begin();
-  for (std::deque<PendingWrite>::const_iterator it = queue->begin();
-       it != queue->end(); ++it) {
-    if (it->stream.get() == stream.get()) {
-      delete it->frame_producer;
-    } else {
-      *out_it = *it;
-      ++out_it;
-    }
-  }
-  queue->erase(out_it, queue->end());
-}
-
-void SpdyWriteQueue::RemovePendingWritesForStreamsAfter(
-    SpdyStreamId last_good_stream_id) {
-  for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; ++i) {
-    // Do the actual deletion and removal, preserving FIFO-ness.
-    std::deque<PendingWrite>* queue = &queue_[i];
+  std::deque<PendingWrite>* queues[] = {
+    &queue_[priority], &control_queue_[priority]
+  };
+  for (size_t i = 0; i < arraysize(queues); ++i) {
+    std::deque<PendingWrite>* queue = queues[i];
     std::deque<PendingWrite>::iterator out_it = queue->begin();
     for (std::deque<PendingWrite>::const_iterator it = queue->begin();
          it != queue->end(); ++it) {
-      if (it->stream.get() && (it->stream->stream_id() > last_good_stream_id ||
-                               it->stream->stream_id() == 0)) {
+      if (it->stream.get() == stream.get()) {
         delete it->frame_producer;
       } else {
         *out_it = *it;
@@ -123,6 +143,32 @@ void SpdyWriteQueue::RemovePendingWritesForStreamsAfter(
     }
     queue->erase(out_it, queue->end());
   }
+  UpdateReadyToWrite(priority);
+}
+
+void SpdyWriteQueue::RemovePendingWritesForStreamsAfter(
+    SpdyStreamId last_good_stream_id) {
+  for (int i = MINIMUM_PRIORITY; i <= MAXIMUM_PRIORITY; ++i) {
+    std::deque<PendingWrite>* queues[] = { &queue_[i], &control_queue_[i] };
+    for (size_t j = 0; j < arraysize(queues); ++j) {
+      // Do the actual deletion and removal, preserving FIFO-ness.
+      std::deque<PendingWrite>* queue = queues[j];
+      std::deque<PendingWrite>::iterator out_it = queue->begin();
+      for (std::deque<PendingWrite>::const_iterator it = queue->begin();
+           it != queue->end(); ++it) {
+        if (it->stream.get() &&
+            (it->stream->stream_id() > last_good_stream_id ||
+             it->stream->stream_id() == 0)) {
+          delete it->frame_producer;
+        } else {
+          *out_it = *it;
+          ++out_it;
+        }
+      }
+      queue->erase(out_it, queue->end());
+    }
+    UpdateReadyToWrite(static_cast<RequestPriority>(i));
+  }
 }
 
 void SpdyWriteQueue::Clear() {
@@ -132,7 +178,50 @@ void SpdyWriteQueue::Clear() {
       delete it->frame_producer;
     }
     queue_[i].clear();
+    for (std::deque<PendingWrite>::iterator it = control_queue_[i].begin();
+         it != control_queue_[i].end(); ++it) {
+      delete it->frame_producer;
+    }
+    control_queue_[i].clear();
+    UpdateReadyToWrite(static_cast<RequestPriority>(i));
+  }
+}
+
+void SpdyWriteQueue::UpdateReadyToWrite(RequestPriority priority) {
+  const int node_id = PriorityToNodeId(priority);
+  if (queue_[priority].empty())
+    priority_forest_.MarkNoLongerReadyToWrite(node_id);
+  else
+    priority_forest_.MarkReadyToWrite(node_id);
+}
+
+std::deque<SpdyWriteQueue::PendingWrite>* SpdyWriteQueue::NextQueueToWrite(
+    RequestPriority* priority) {
+  for (int i = MAXIMUM_PRIORITY; i >= MINIMUM_PRIORITY; --i) {
+    if (!control_queue_[i].empty()) {
+      *priority = static_cast<RequestPriority>(i);
+      return &control_queue_[i];
+    }
+  }
+
+  if (weighted_scheduling_) {
+    // Picks among the non-empty queues at random, in proportion to
+    // their weights.
+    const int node_id = priority_forest_.NextNodeToWrite();
+    if (node_id == 0)
+      return NULL;
+    *priority = static_cast<RequestPriority>(node_id - 1);
+    DCHECK(!queue_[*priority].empty());
+    return &queue_[*priority];
+  }
+
+  for (int i = MAXIMUM_PRIORITY; i >= MINIMUM_PRIORITY; --i) {
+    if (!queue_[i].empty()) {
+      *priority = static_cast<RequestPriority>(i);
+      return &queue_[i];
+    }
   }
+  return NULL;
 }
 
 }  // namespace net
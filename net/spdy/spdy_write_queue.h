@@ -12,6 +12,7 @@
 #include "base/memory/weak_ptr.h"
 #include "net/base/net_export.h"
 #include "net/base/request_priority.h"
+#include "net/spdy/spdy_priority_forest.h"
 #include "net/spdy/spdy_protocol.h"
 
 namespace net {
@@ -22,11 +23,22 @@ class SpdyStream;
 
 // A queue of SpdyBufferProducers to produce frames to write. Ordered
 // by priority, and then FIFO.
+//
+// With weighted scheduling, control frames go first, still ordered by
+// priority and then FIFO, so that they are never stuck behind bulk
+// data. The priorities then share the writes of DATA frames in
+// proportion to their weights, rather than lower priorities waiting
+// for all the higher ones to drain. DATA frames of a given priority
+// stay FIFO, so the frames of a stream keep their order.
 class NET_EXPORT_PRIVATE SpdyWriteQueue {
  public:
   SpdyWriteQueue();
   ~SpdyWriteQueue();
 
+  // Switches between strict priority order and weighted scheduling.
+  // May only be called when the queue is empty.
+  void set_weighted_scheduling(bool weighted_scheduling);
+
   // Returns whether there is anything in the write queue,
   // i.e. whether the next call to Dequeue will return true.
   bool IsEmpty() const;
@@ -78,9 +90,29 @@ class NET_EXPORT_PRIVATE SpdyWriteQueue {
     ~PendingWrite();
   };
 
-  // The actual write queue, binned by priority.
+  // Marks the node of |priority| in |priority_forest_| as ready to
+  // write if the queue of DATA frames of |priority| is non-empty, and
+  // as not ready otherwise.
+  void UpdateReadyToWrite(RequestPriority priority);
+
+  // Returns the queue to dequeue from next and fills in its priority,
+  // or returns NULL if all the queues are empty.
+  std::deque<PendingWrite>* NextQueueToWrite(RequestPriority* priority);
+
+  bool weighted_scheduling_;
+
+  // The actual write queue, binned by priority. With weighted
+  // scheduling, these only hold DATA frames.
   std::deque<PendingWrite> queue_[NUM_PRIORITIES];
 
+  // With weighted scheduling, the other frames, binned by priority.
+  std::deque<PendingWrite> control_queue_[NUM_PRIORITIES];
+
+  // Holds a root node per priority, weighted by priority and marked
+  // ready to write while that priority's queue of DATA frames is
+  // non-empty. Node ids are priorities plus one, since 0 means no node.
+  SpdyPriorityForest<int, int> priority_forest_;
+
   DISALLOW_COPY_AND_ASSIGN(SpdyWriteQueue);
 };
 
@@ -247,6 +247,87 @@ TEST_F(SpdyWriteQueueTest, Clear) {
   EXPECT_FALSE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
 }
 
+// With weighted scheduling, control frames should be dequeued before
+// DATA frames, in priority order.
+TEST_F(SpdyWriteQueueTest, WeightedSchedulingControlFramesFirst) {
+  SpdyWriteQueue write_queue;
+  write_queue.set_weighted_scheduling(true);
+
+  scoped_ptr<SpdyStream> stream_lowest(MakeTestStream(LOWEST));
+  scoped_ptr<SpdyStream> stream_highest(MakeTestStream(HIGHEST));
+
+  write_queue.Enqueue(HIGHEST, DATA, StringToProducer("DATA"),
+                      stream_highest->GetWeakPtr());
+  write_queue.Enqueue(LOWEST, SYN_STREAM, StringToProducer("SYN_STREAM"),
+                      stream_lowest->GetWeakPtr());
+  write_queue.Enqueue(HIGHEST, PING, StringToProducer("PING"),
+                      base::WeakPtr<SpdyStream>());
+
+  SpdyFrameType frame_type = DATA;
+  scoped_ptr<SpdyBufferProducer> frame_producer;
+  base::WeakPtr<SpdyStream> stream;
+  ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+  EXPECT_EQ(PING, frame_type);
+  EXPECT_EQ("PING", ProducerToString(frame_producer.Pass()));
+
+  ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+  EXPECT_EQ(SYN_STREAM, frame_type);
+  EXPECT_EQ(stream_lowest, stream.get());
+
+  ASSERT_TRUE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+  EXPECT_EQ(DATA, frame_type);
+  EXPECT_EQ(stream_highest, stream.get());
+
+  EXPECT_FALSE(write_queue.Dequeue(&frame_type, &frame_producer, &stream));
+}
+
+// With weighted scheduling, a lower priority should get a share of the
+// DATA frames while a higher priority has frames pending, and the DATA
+// frames of each priority should stay FIFO.
+TEST_F(SpdyWriteQueueTest, WeightedSchedulingSharesData) {
+  SpdyWriteQueue write_queue;
+  write_queue.set_weighted_scheduling(true);
+
+  scoped_ptr<SpdyStream> stream_lowest(MakeTestStream(LOWEST));
+  scoped_ptr<SpdyStream> stream_highest(MakeTestStream(HIGHEST));
+
+  // LOWEST has a weight of 4 against 256 for HIGHEST, so it is all but
+  // certain to be picked before HIGHEST runs out.
+  const int kHighestCount = 2000;
+  const int kLowestCount = 10;
+  for (int i = 0; i < kHighestCount; ++i) {
+    write_queue.Enqueue(HIGHEST, DATA, IntToProducer(i),
+                        stream_highest->GetWeakPtr());
+  }
+  for (int i = 0; i < kLowestCount; ++i) {
+    write_queue.Enqueue(LOWEST, DATA, IntToProducer(i),
+                        stream_lowest->GetWeakPtr());
+  }
+
+  int next_highest = 0;
+  int next_lowest = 0;
+  bool lowest_before_highest_drained = false;
+  SpdyFrameType frame_type = DATA;
+  scoped_ptr<SpdyBufferProducer> frame_producer;
+  base::WeakPtr<SpdyStream> stream;
+  while (write_queue.Dequeue(&frame_type, &frame_producer, &stream)) {
+    EXPECT_EQ(DATA, frame_type);
+    if (stream.get() == stream_highest.get()) {
+      EXPECT_EQ(next_highest, ProducerToInt(frame_producer.Pass()));
+      ++next_highest;
+    } else {
+      EXPECT_EQ(stream_lowest, stream.get());
+      EXPECT_EQ(next_lowest, ProducerToInt(frame_producer.Pass()));
+      ++next_lowest;
+      if (next_highest < kHighestCount)
+        lowest_before_highest_drained = true;
+    }
+  }
+  EXPECT_EQ(kHighestCount, next_highest);
+  EXPECT_EQ(kLowestCount, next_lowest);
+  EXPECT_TRUE(lowest_before_highest_drained);
+}
+
 }  // namespace
 
 }  // namespace net
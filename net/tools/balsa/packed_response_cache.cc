@@ -0,0 +1,271 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/balsa/packed_response_cache.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "net/tools/balsa/balsa_frame.h"
+#include "net/tools/balsa/balsa_headers.h"
+#include "net/tools/balsa/noop_balsa_visitor.h"
+
+using base::StringPiece;
+
+namespace net {
+
+using internal::PackedResponseCacheHeader;
+using internal::PackedResponseCacheIndexEntry;
+
+namespace {
+
+const char kMagic[8] = { 'P', 'K', 'D', 'R', 'E', 'S', 'P', '\0' };
+const uint32 kVersion = 1;
+
+// The largest write to the file at once, as base::File takes an int.
+const size_t kMaxWriteSize = 1 << 30;
+
+// Collects the serialized headers for BalsaHeaders::WriteToBuffer.
+class StringBuffer {
+ public:
+  explicit StringBuffer(std::string* output) : output_(output) {}
+
+  void Write(const char* data, size_t size) { output_->append(data, size); }
+
+ private:
+  std::string* output_;
+};
+
+bool KeyLess(const std::pair<std::string, PackedResponseCacheIndexEntry>& a,
+             const std::pair<std::string, PackedResponseCacheIndexEntry>& b) {
+  return a.first < b.first;
+}
+
+}  // namespace
+
+PackedResponseCache::PackedResponseCache()
+    : num_entries_(0),
+      index_(NULL) {
+}
+
+PackedResponseCache::~PackedResponseCache() {
+}
+
+bool PackedResponseCache::Open(const base::FilePath& path) {
+  DCHECK(!file_.IsValid());
+  if (!file_.Initialize(path)) {
+    LOG(ERROR) << "Unable to map " << path.value();
+    return false;
+  }
+
+  PackedResponseCacheHeader header;
+  if (file_.length() < sizeof(header)) {
+    LOG(ERROR) << path.value() << " is too short for a packed cache.";
+    return false;
+  }
+  memcpy(&header, file_.data(), sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion) {
+    LOG(ERROR) << path.value() << " is not a packed cache of version "
+               << kVersion;
+    return false;
+  }
+  const uint64 index_size = static_cast<uint64>(header.num_entries) *
+      sizeof(PackedResponseCacheIndexEntry);
+  if (header.index_offset % sizeof(uint64) != 0 ||
+      header.index_offset > file_.length() ||
+      index_size > file_.length() - header.index_offset) {
+    LOG(ERROR) << "The index of " << path.value() << " is out of bounds.";
+    return false;
+  }
+  index_ = reinterpret_cast<const PackedResponseCacheIndexEntry*>(
+      file_.data() + header.index_offset);
+  num_entries_ = header.num_entries;
+
+  // Check every entry up front, so that lookups don't have to.
+  for (size_t i = 0; i < num_entries_; ++i) {
+    const PackedResponseCacheIndexEntry* entry = index_entry(i);
+    if (Piece(entry->key_offset, entry->key_length).data() == NULL ||
+        Piece(entry->headers_offset, entry->headers_length).data() == NULL ||
+        Piece(entry->body_offset, entry->body_length).data() == NULL) {
+      LOG(ERROR) << "Entry " << i << " of " << path.value()
+                 << " is out of bounds.";
+      num_entries_ = 0;
+      return false;
+    }
+    if (i > 0 && GetEntry(i - 1).key.compare(GetEntry(i).key) >= 0) {
+      LOG(ERROR) << "The index of " << path.value() << " is not sorted.";
+      num_entries_ = 0;
+      return false;
+    }
+  }
+  return true;
+}
+
+PackedResponseCache::Entry PackedResponseCache::GetEntry(size_t index) const {
+  const PackedResponseCacheIndexEntry* index_entry = this->index_entry(index);
+  Entry entry;
+  entry.key = Piece(index_entry->key_offset, index_entry->key_length);
+  entry.headers =
+      Piece(index_entry->headers_offset, index_entry->headers_length);
+  entry.body = Piece(index_entry->body_offset, index_entry->body_length);
+  return entry;
+}
+
+bool PackedResponseCache::Find(const StringPiece& key, Entry* entry) const {
+  size_t low = 0;
+  size_t high = num_entries_;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    const PackedResponseCacheIndexEntry* index_entry =
+        this->index_entry(middle);
+    const int comparison =
+        Piece(index_entry->key_offset, index_entry->key_length).compare(key);
+    if (comparison == 0) {
+      *entry = GetEntry(middle);
+      return true;
+    }
+    if (comparison < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+// static
+bool PackedResponseCache::ParseHeaders(const StringPiece& header_block,
+                                       BalsaHeaders* headers) {
+  NoOpBalsaVisitor visitor;
+  BalsaFrame framer;
+  framer.set_is_request(false);
+  framer.set_balsa_headers(headers);
+  framer.set_balsa_visitor(&visitor);
+  framer.ProcessInput(header_block.data(), header_block.size());
+  // The framer may go on to expect a body, but the headers are complete.
+  return !framer.Error() &&
+      framer.ParseState() != BalsaFrameEnums::READING_HEADER_AND_FIRSTLINE;
+}
+
+const PackedResponseCacheIndexEntry* PackedResponseCache::index_entry(
+    size_t index) const {
+  DCHECK_LT(index, num_entries_);
+  return index_ + index;
+}
+
+StringPiece PackedResponseCache::Piece(uint64 offset, uint64 length) const {
+  if (offset > file_.length() || length > file_.length() - offset) {
+    return StringPiece();
+  }
+  return StringPiece(reinterpret_cast<const char*>(file_.data()) + offset,
+                     static_cast<size_t>(length));
+}
+
+PackedResponseCacheWriter::PackedResponseCacheWriter() : offset_(0) {
+}
+
+PackedResponseCacheWriter::~PackedResponseCacheWriter() {
+}
+
+bool PackedResponseCacheWriter::Open(const base::FilePath& path) {
+  file_.Initialize(path,
+                   base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!file_.IsValid()) {
+    LOG(ERROR) << "Unable to create " << path.value();
+    return false;
+  }
+  // The header is written by Finish(), once the index offset is known.
+  offset_ = sizeof(PackedResponseCacheHeader);
+  return true;
+}
+
+bool PackedResponseCacheWriter::Add(const StringPiece& key,
+                                    const BalsaHeaders& headers,
+                                    const StringPiece& body) {
+  DCHECK(file_.IsValid());
+  std::string header_block;
+  StringBuffer buffer(&header_block);
+  headers.WriteHeaderAndEndingToBuffer(&buffer);
+
+  PackedResponseCacheIndexEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.key_offset = offset_;
+  entry.key_length = key.size();
+  if (!Write(key)) {
+    return false;
+  }
+  entry.headers_offset = offset_;
+  entry.headers_length = header_block.size();
+  if (!Write(header_block)) {
+    return false;
+  }
+  entry.body_offset = offset_;
+  entry.body_length = body.size();
+  if (!Write(body)) {
+    return false;
+  }
+  entries_.push_back(std::make_pair(key.as_string(), entry));
+  return true;
+}
+
+bool PackedResponseCacheWriter::Finish() {
+  DCHECK(file_.IsValid());
+  // Keep the last entry added for each key.
+  std::stable_sort(entries_.begin(), entries_.end(), KeyLess);
+  std::vector<PackedResponseCacheIndexEntry> index;
+  index.reserve(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (i + 1 < entries_.size() && entries_[i].first == entries_[i + 1].first) {
+      continue;
+    }
+    index.push_back(entries_[i].second);
+  }
+  entries_.clear();
+
+  // Align the index, so that it can be read in place from the mapping.
+  const uint64 padding = (sizeof(uint64) - offset_ % sizeof(uint64)) %
+      sizeof(uint64);
+  if (!Write(StringPiece("\0\0\0\0\0\0\0", padding))) {
+    return false;
+  }
+
+  PackedResponseCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_entries = index.size();
+  header.index_offset = offset_;
+  if (!index.empty() &&
+      !Write(StringPiece(reinterpret_cast<const char*>(&index[0]),
+                         index.size() * sizeof(index[0])))) {
+    return false;
+  }
+  if (file_.Write(0, reinterpret_cast<const char*>(&header),
+                  sizeof(header)) != static_cast<int>(sizeof(header))) {
+    LOG(ERROR) << "Unable to write the packed cache header.";
+    return false;
+  }
+  file_.Close();
+  return true;
+}
+
+bool PackedResponseCacheWriter::Write(const StringPiece& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    const int size = static_cast<int>(
+        std::min(data.size() - written, kMaxWriteSize));
+    if (file_.Write(offset_, data.data() + written, size) != size) {
+      LOG(ERROR) << "Unable to write to the packed cache.";
+      return false;
+    }
+    written += size;
+    offset_ += size;
+  }
+  return true;
+}
+
+}  // namespace net
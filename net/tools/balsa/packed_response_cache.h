@@ -0,0 +1,130 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A read-only file of HTTP responses which the toy servers map into memory
+// rather than reading a directory of captured responses into strings.
+// Startup only has to map the file and check its index, and response bodies
+// are served straight from the mapped pages, which the kernel can share and
+// page out.
+//
+// The file consists of a header, an index of entries sorted by key, and the
+// data of the entries: for each its key, its response header block (the
+// first line and the header lines, ending with an empty line), and its body.
+// Integers are stored in the byte order of the machine writing the file.
+
+#ifndef NET_TOOLS_BALSA_PACKED_RESPONSE_CACHE_H_
+#define NET_TOOLS_BALSA_PACKED_RESPONSE_CACHE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/strings/string_piece.h"
+
+namespace net {
+
+class BalsaHeaders;
+
+namespace internal {
+
+struct PackedResponseCacheHeader {
+  char magic[8];
+  uint32 version;
+  uint32 num_entries;
+  uint64 index_offset;
+};
+
+struct PackedResponseCacheIndexEntry {
+  uint64 key_offset;
+  uint64 headers_offset;
+  uint64 body_offset;
+  uint64 body_length;
+  uint32 key_length;
+  uint32 headers_length;
+};
+
+}  // namespace internal
+
+class PackedResponseCache {
+ public:
+  struct Entry {
+    base::StringPiece key;
+    base::StringPiece headers;
+    base::StringPiece body;
+  };
+
+  PackedResponseCache();
+  ~PackedResponseCache();
+
+  // Maps the file at |path|, and checks that it is a well formed cache.
+  // Returns false if it isn't, or on an error.
+  bool Open(const base::FilePath& path);
+
+  size_t num_entries() const { return num_entries_; }
+
+  // Returns the entry with index |index|, in order of key.  The pieces of
+  // the entry point into the mapping, and are valid as long as the cache.
+  Entry GetEntry(size_t index) const;
+
+  // Finds the entry for |key| in O(log(n)), and returns false if there is
+  // none.
+  bool Find(const base::StringPiece& key, Entry* entry) const;
+
+  // Parses the header block of an entry into |headers|.  Returns false if
+  // it is malformed.
+  static bool ParseHeaders(const base::StringPiece& header_block,
+                           BalsaHeaders* headers);
+
+ private:
+  const internal::PackedResponseCacheIndexEntry* index_entry(
+      size_t index) const;
+  base::StringPiece Piece(uint64 offset, uint64 length) const;
+
+  base::MemoryMappedFile file_;
+  size_t num_entries_;
+  const internal::PackedResponseCacheIndexEntry* index_;
+
+  DISALLOW_COPY_AND_ASSIGN(PackedResponseCache);
+};
+
+// Writes a file for PackedResponseCache.  The data of the entries is written
+// as they are added, and only the index is held in memory, so a cache can be
+// much larger than memory.
+class PackedResponseCacheWriter {
+ public:
+  PackedResponseCacheWriter();
+  ~PackedResponseCacheWriter();
+
+  // Creates the file at |path|, replacing any file there.
+  bool Open(const base::FilePath& path);
+
+  // Adds the response for |key|.  If several responses are added for a key,
+  // the last one is kept.
+  bool Add(const base::StringPiece& key,
+           const BalsaHeaders& headers,
+           const base::StringPiece& body);
+
+  // Writes the index and closes the file.
+  bool Finish();
+
+ private:
+  typedef std::pair<std::string, internal::PackedResponseCacheIndexEntry>
+      KeyAndEntry;
+
+  bool Write(const base::StringPiece& data);
+
+  base::File file_;
+  uint64 offset_;
+  std::vector<KeyAndEntry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(PackedResponseCacheWriter);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_BALSA_PACKED_RESPONSE_CACHE_H_
@@ -0,0 +1,121 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/balsa/packed_response_cache.h"
+
+#include <string>
+
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_piece.h"
+#include "net/tools/balsa/balsa_headers.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::StringPiece;
+
+namespace net {
+
+namespace {
+
+class PackedResponseCacheTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("cache.pack");
+  }
+
+  void AddResponse(PackedResponseCacheWriter* writer,
+                   StringPiece key,
+                   StringPiece code,
+                   StringPiece body) {
+    BalsaHeaders headers;
+    headers.SetResponseFirstlineFromStringPieces("HTTP/1.1", code, "OK");
+    headers.AppendHeader("content-type", "text/html");
+    ASSERT_TRUE(writer->Add(key, headers, body));
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+};
+
+TEST_F(PackedResponseCacheTest, WriteAndRead) {
+  PackedResponseCacheWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  AddResponse(&writer, "www.example.com/b", "200", "body b");
+  AddResponse(&writer, "www.example.com/a", "200", "body a");
+  AddResponse(&writer, "www.example.com/c", "404", std::string());
+  ASSERT_TRUE(writer.Finish());
+
+  PackedResponseCache cache;
+  ASSERT_TRUE(cache.Open(path_));
+  ASSERT_EQ(3u, cache.num_entries());
+  // The entries are in order of key.
+  EXPECT_EQ("www.example.com/a", cache.GetEntry(0).key);
+  EXPECT_EQ("www.example.com/b", cache.GetEntry(1).key);
+  EXPECT_EQ("www.example.com/c", cache.GetEntry(2).key);
+
+  PackedResponseCache::Entry entry;
+  ASSERT_TRUE(cache.Find("www.example.com/b", &entry));
+  EXPECT_EQ("body b", entry.body);
+  BalsaHeaders headers;
+  ASSERT_TRUE(PackedResponseCache::ParseHeaders(entry.headers, &headers));
+  EXPECT_EQ("200", headers.response_code());
+  EXPECT_EQ("text/html", headers.GetHeader("content-type"));
+
+  ASSERT_TRUE(cache.Find("www.example.com/c", &entry));
+  EXPECT_TRUE(entry.body.empty());
+  EXPECT_FALSE(cache.Find("www.example.com/d", &entry));
+  EXPECT_FALSE(cache.Find("", &entry));
+}
+
+TEST_F(PackedResponseCacheTest, LastResponseForKeyIsKept) {
+  PackedResponseCacheWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  AddResponse(&writer, "www.example.com/a", "200", "first");
+  AddResponse(&writer, "www.example.com/a", "200", "second");
+  ASSERT_TRUE(writer.Finish());
+
+  PackedResponseCache cache;
+  ASSERT_TRUE(cache.Open(path_));
+  ASSERT_EQ(1u, cache.num_entries());
+  EXPECT_EQ("second", cache.GetEntry(0).body);
+}
+
+TEST_F(PackedResponseCacheTest, EmptyCache) {
+  PackedResponseCacheWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  ASSERT_TRUE(writer.Finish());
+
+  PackedResponseCache cache;
+  ASSERT_TRUE(cache.Open(path_));
+  EXPECT_EQ(0u, cache.num_entries());
+  PackedResponseCache::Entry entry;
+  EXPECT_FALSE(cache.Find("www.example.com/a", &entry));
+}
+
+TEST_F(PackedResponseCacheTest, RejectsMalformedFiles) {
+  std::string garbage("not a packed cache at all");
+  ASSERT_EQ(static_cast<int>(garbage.size()),
+            file_util::WriteFile(path_, garbage.data(), garbage.size()));
+  PackedResponseCache garbage_cache;
+  EXPECT_FALSE(garbage_cache.Open(path_));
+
+  PackedResponseCacheWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  AddResponse(&writer, "www.example.com/a", "200", "body a");
+  ASSERT_TRUE(writer.Finish());
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(path_, &contents));
+
+  // Cut off the end of the index.
+  contents.resize(contents.size() - 1);
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            file_util::WriteFile(path_, contents.data(), contents.size()));
+  PackedResponseCache truncated_cache;
+  EXPECT_FALSE(truncated_cache.Open(path_));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -52,6 +52,12 @@ const char kDumpHeaders[] = "dump-headers";
 // Dumps all entries to stdout.
 const char kDumpContents[] = "dump-contents";
 
+// Dumps the stats of the backend to stdout.
+const char kDumpCacheStats[] = "dump-cache-stats";
+
+// Use the simple backend for --dump-cache-stats.
+const char kSimple[] = "simple";
+
 // Convert the cache to files.
 const char kDumpToFiles[] = "dump-to-files";
 
@@ -69,6 +75,8 @@ int Help() {
   printf("dump_cache --input=path1 [--output=path2]\n");
   printf("--dump-headers: display file headers\n");
   printf("--dump-contents: display all entries\n");
+  printf("--dump-cache-stats: display the stats of the backend, "
+         "add --simple for a simple cache\n");
   printf("--upgrade: copy contents to the output path\n");
   printf("--dump-to-files: write the contents of the cache to files\n");
   return INVALID_ARGUMENT;
@@ -117,6 +125,14 @@ int main(int argc, const char* argv[]) {
   if (input_path.empty())
     return Help();
 
+  // Simple caches don't have a version header, so check this first.
+  if (command_line.HasSwitch(kDumpCacheStats)) {
+    return DumpCacheStats(input_path,
+                          command_line.HasSwitch(kSimple) ?
+                              net::CACHE_BACKEND_SIMPLE :
+                              net::CACHE_BACKEND_BLOCKFILE);
+  }
+
   bool dump_to_files = command_line.HasSwitch(kDumpToFiles);
   bool upgrade = command_line.HasSwitch(kUpgrade);
 
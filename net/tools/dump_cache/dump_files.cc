@@ -12,13 +12,21 @@
 
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/files/file_enumerator.h"
 #include "base/format_macros.h"
 #include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/threading/thread.h"
 #include "net/base/file_stream.h"
+#include "net/base/net_errors.h"
 #include "net/disk_cache/block_files.h"
+#include "net/disk_cache/cache_stats.h"
+#include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/disk_format.h"
 #include "net/disk_cache/mapped_file.h"
 #include "net/disk_cache/stats.h"
@@ -304,6 +312,19 @@ void DumpRankings(const disk_cache::RankingsNode& rankings) {
   printf("----------\n\n");
 }
 
+void OnOperationComplete(base::RunLoop* run_loop, int* result, int rv) {
+  *result = rv;
+  run_loop->Quit();
+}
+
+// Runs the message loop until the operation that returned |rv| completes.
+int WaitForResult(base::RunLoop* run_loop, int* result, int rv) {
+  if (rv != net::ERR_IO_PENDING)
+    return rv;
+  run_loop->Run();
+  return *result;
+}
+
 }  // namespace.
 
 // -----------------------------------------------------------------------
@@ -372,3 +393,47 @@ int DumpContents(const base::FilePath& input_path) {
 
   return 0;
 }
+
+// Dumps the stats of the backend opened on the cache.
+int DumpCacheStats(const base::FilePath& input_path,
+                   net::BackendType backend_type) {
+  base::MessageLoopForIO loop;
+  base::Thread cache_thread("CacheThread");
+  if (!cache_thread.StartWithOptions(
+          base::Thread::Options(base::MessageLoop::TYPE_IO, 0))) {
+    return -1;
+  }
+
+  scoped_ptr<disk_cache::Backend> cache;
+  int result = net::ERR_IO_PENDING;
+  base::RunLoop create_loop;
+  int rv = disk_cache::CreateCacheBackend(
+      net::DISK_CACHE, backend_type, input_path, 0, false,
+      cache_thread.message_loop_proxy().get(), NULL, &cache,
+      base::Bind(&OnOperationComplete, &create_loop, &result));
+  if (WaitForResult(&create_loop, &result, rv) != net::OK) {
+    printf("Unable to open the cache\n");
+    return -1;
+  }
+
+  // The enumeration waits for the index to load, so the stats cover all the
+  // entries.
+  void* iter = NULL;
+  disk_cache::Entry* entry = NULL;
+  base::RunLoop enumerate_loop;
+  rv = cache->OpenNextEntry(
+      &iter, &entry,
+      base::Bind(&OnOperationComplete, &enumerate_loop, &result));
+  if (WaitForResult(&enumerate_loop, &result, rv) == net::OK)
+    entry->Close();
+  cache->EndEnumeration(&iter);
+
+  disk_cache::CacheStats stats;
+  cache->GetCacheStats(&stats);
+  std::vector<std::pair<std::string, std::string> > items;
+  stats.GetItems(&items);
+  for (size_t i = 0; i < items.size(); i++)
+    printf("%s: %s\n", items[i].first.c_str(), items[i].second.c_str());
+
+  return 0;
+}
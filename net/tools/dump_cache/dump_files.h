@@ -10,6 +10,7 @@
 // files).
 
 #include "base/files/file_path.h"
+#include "net/base/cache_type.h"
 
 // Returns the major version of the specified cache.
 int GetMajorVersion(const base::FilePath& input_path);
@@ -20,4 +21,8 @@ int DumpContents(const base::FilePath& input_path);
 // Dumps the headers of all files.
 int DumpHeaders(const base::FilePath& input_path);
 
+// Opens the cache with a |backend_type| backend and dumps its stats.
+int DumpCacheStats(const base::FilePath& input_path,
+                   net::BackendType backend_type);
+
 #endif  // NET_TOOLS_DUMP_CACHE_DUMP_FILES_H_
@@ -0,0 +1,317 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/epoll_server/epoll_alarm_wheel.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace net {
+
+namespace {
+
+struct NodeTimeLess {
+  bool operator()(const EpollAlarmWheel::Node* a,
+                  const EpollAlarmWheel::Node* b) const {
+    return a->time_in_us < b->time_in_us;
+  }
+};
+
+}  // namespace
+
+const int64 EpollAlarmWheel::kTickInUsec;
+const int EpollAlarmWheel::kNumLevels;
+const int EpollAlarmWheel::kBitsPerLevel;
+const int64 EpollAlarmWheel::kSlotsPerLevel;
+const int64 EpollAlarmWheel::kSlotMask;
+const int EpollAlarmWheel::kExpired;
+const int EpollAlarmWheel::kNotInWheel;
+
+EpollAlarmWheel::Node::Node()
+    : time_in_us(0),
+      cb(NULL),
+      level(kNotInWheel),
+      prev(this),
+      next(this) {
+}
+
+EpollAlarmWheel::EpollAlarmWheel()
+    : size_(0),
+      current_tick_(0),
+      remove_any_cursor_(0),
+      free_nodes_(NULL) {
+  for (int level = 0; level < kNumLevels; ++level) {
+    level_sizes_[level] = 0;
+  }
+}
+
+EpollAlarmWheel::~EpollAlarmWheel() {
+  for (int level = 0; level < kNumLevels; ++level) {
+    for (int64 slot = 0; slot < kSlotsPerLevel; ++slot) {
+      Node* head = &slots_[level][slot];
+      while (!IsEmptyList(head)) {
+        Node* node = head->next;
+        Unlink(node);
+        delete node;
+      }
+    }
+  }
+  while (!IsEmptyList(&expired_)) {
+    Node* node = expired_.next;
+    Unlink(node);
+    delete node;
+  }
+  while (free_nodes_ != NULL) {
+    Node* node = free_nodes_;
+    free_nodes_ = node->next;
+    delete node;
+  }
+}
+
+EpollAlarmWheel::Node* EpollAlarmWheel::Add(int64 time_in_us,
+                                            EpollAlarmCallbackInterface* cb,
+                                            int64 now_in_us) {
+  bool wheel_empty = true;
+  for (int level = 0; level < kNumLevels; ++level) {
+    wheel_empty = wheel_empty && level_sizes_[level] == 0;
+  }
+  if (wheel_empty) {
+    // With no alarms in the slots, the wheel can be moved straight to the
+    // current time, rather than turned through every tick it was idle for.
+    current_tick_ = TickFor(now_in_us);
+  }
+
+  Node* node = NewNode();
+  node->time_in_us = time_in_us;
+  node->cb = cb;
+  Insert(node);
+  ++size_;
+  return node;
+}
+
+void EpollAlarmWheel::Remove(Node* node) {
+  DCHECK_NE(kNotInWheel, node->level);
+  if (node->level != kExpired) {
+    --level_sizes_[node->level];
+  }
+  Unlink(node);
+  --size_;
+  FreeNode(node);
+}
+
+void EpollAlarmWheel::Expire(int64 now_in_us) {
+  const int64 now_tick = TickFor(now_in_us);
+  while (true) {
+    CollectDue(now_in_us);
+    if (current_tick_ >= now_tick) {
+      break;
+    }
+    // Skip over the ticks for which there can't be any alarms: if the lowest
+    // |level| levels are empty, nothing can be due until the next slot of
+    // the level above them is cascaded.
+    int level = 0;
+    while (level < kNumLevels && level_sizes_[level] == 0) {
+      ++level;
+    }
+    if (level == kNumLevels) {
+      current_tick_ = now_tick;
+      break;
+    }
+    const int shift = kBitsPerLevel * level;
+    current_tick_ = std::min(now_tick,
+                             ((current_tick_ >> shift) + 1) << shift);
+    if ((current_tick_ & kSlotMask) == 0) {
+      Cascade(1);
+    }
+  }
+
+  if (due_.empty()) {
+    return;
+  }
+  // Alarms due at the same time fire in the order they were added.
+  std::stable_sort(due_.begin(), due_.end(), NodeTimeLess());
+  for (std::vector<Node*>::iterator it = due_.begin(); it != due_.end();
+       ++it) {
+    (*it)->level = kExpired;
+    LinkBefore(&expired_, *it);
+  }
+  due_.clear();
+}
+
+EpollAlarmCallbackInterface* EpollAlarmWheel::PopExpired() {
+  if (IsEmptyList(&expired_)) {
+    return NULL;
+  }
+  Node* node = expired_.next;
+  EpollAlarmCallbackInterface* cb = node->cb;
+  Unlink(node);
+  --size_;
+  FreeNode(node);
+  return cb;
+}
+
+int64 EpollAlarmWheel::NextAlarmTimeLowerBound() const {
+  DCHECK(!empty());
+  int64 next_time = kint64max;
+  if (!IsEmptyList(&expired_)) {
+    next_time = expired_.next->time_in_us;
+  }
+
+  // Each slot of the first level holds the alarms of a single tick, so the
+  // first slot in use holds the earliest alarm of the level.
+  if (level_sizes_[0] > 0) {
+    for (int64 i = 0; i < kSlotsPerLevel; ++i) {
+      const Node* head = &slots_[0][(current_tick_ + i) & kSlotMask];
+      if (IsEmptyList(head)) {
+        continue;
+      }
+      for (const Node* node = head->next; node != head; node = node->next) {
+        next_time = std::min(next_time, node->time_in_us);
+      }
+      break;
+    }
+  }
+
+  // The alarms in the higher levels are not sorted by more than their slot,
+  // so use the time at which the first slot in use is cascaded.  Waking up
+  // then is early, but harmless.
+  for (int level = 1; level < kNumLevels; ++level) {
+    if (level_sizes_[level] == 0) {
+      continue;
+    }
+    const int shift = kBitsPerLevel * level;
+    for (int64 i = 1; i <= kSlotsPerLevel; ++i) {
+      const int64 slot_tick = (current_tick_ >> shift) + i;
+      if (!IsEmptyList(&slots_[level][slot_tick & kSlotMask])) {
+        next_time = std::min(next_time, (slot_tick << shift) * kTickInUsec);
+        break;
+      }
+    }
+  }
+  return next_time;
+}
+
+EpollAlarmCallbackInterface* EpollAlarmWheel::RemoveAny() {
+  if (empty()) {
+    return NULL;
+  }
+  if (!IsEmptyList(&expired_)) {
+    return PopExpired();
+  }
+  const int64 num_slots = kNumLevels * kSlotsPerLevel;
+  for (int64 i = 0; i < num_slots; ++i) {
+    const int64 index = (remove_any_cursor_ + i) % num_slots;
+    Node* head = &slots_[index / kSlotsPerLevel][index % kSlotsPerLevel];
+    if (!IsEmptyList(head)) {
+      remove_any_cursor_ = index;
+      EpollAlarmCallbackInterface* cb = head->next->cb;
+      Remove(head->next);
+      return cb;
+    }
+  }
+  LOG(DFATAL) << "Alarm wheel of size " << size_ << " has no alarms.";
+  return NULL;
+}
+
+void EpollAlarmWheel::GetAlarms(std::vector<const Node*>* alarms) const {
+  for (const Node* node = expired_.next; node != &expired_;
+       node = node->next) {
+    alarms->push_back(node);
+  }
+  for (int level = 0; level < kNumLevels; ++level) {
+    for (int64 slot = 0; slot < kSlotsPerLevel; ++slot) {
+      const Node* head = &slots_[level][slot];
+      for (const Node* node = head->next; node != head; node = node->next) {
+        alarms->push_back(node);
+      }
+    }
+  }
+}
+
+void EpollAlarmWheel::Insert(Node* node) {
+  // Alarms which are already due go in the slot of the current tick.
+  int64 tick = std::max(TickFor(node->time_in_us), current_tick_);
+  int64 delta = tick - current_tick_;
+  int level = 0;
+  while (level < kNumLevels - 1 &&
+         delta >= (kSlotsPerLevel << (kBitsPerLevel * level))) {
+    ++level;
+  }
+  if (level == kNumLevels - 1) {
+    // Alarms beyond the range of the wheel wait in its last slot, and are
+    // put back into the top level whenever it is cascaded.
+    const int64 max_delta =
+        (kSlotsPerLevel << (kBitsPerLevel * (kNumLevels - 1))) - 1;
+    tick = current_tick_ + std::min(delta, max_delta);
+  }
+  node->level = level;
+  LinkBefore(
+      &slots_[level][(tick >> (kBitsPerLevel * level)) & kSlotMask], node);
+  ++level_sizes_[level];
+}
+
+void EpollAlarmWheel::Cascade(int level) {
+  const int64 index =
+      (current_tick_ >> (kBitsPerLevel * level)) & kSlotMask;
+  Node* head = &slots_[level][index];
+  while (!IsEmptyList(head)) {
+    Node* node = head->next;
+    Unlink(node);
+    --level_sizes_[level];
+    Insert(node);
+  }
+  if (index == 0 && level + 1 < kNumLevels) {
+    Cascade(level + 1);
+  }
+}
+
+void EpollAlarmWheel::CollectDue(int64 now_in_us) {
+  Node* head = &slots_[0][current_tick_ & kSlotMask];
+  Node* node = head->next;
+  while (node != head) {
+    Node* next = node->next;
+    if (node->time_in_us <= now_in_us) {
+      Unlink(node);
+      --level_sizes_[0];
+      due_.push_back(node);
+    }
+    node = next;
+  }
+}
+
+EpollAlarmWheel::Node* EpollAlarmWheel::NewNode() {
+  if (free_nodes_ == NULL) {
+    return new Node();
+  }
+  Node* node = free_nodes_;
+  free_nodes_ = node->next;
+  return node;
+}
+
+void EpollAlarmWheel::FreeNode(Node* node) {
+  node->cb = NULL;
+  node->level = kNotInWheel;
+  node->prev = NULL;
+  node->next = free_nodes_;
+  free_nodes_ = node;
+}
+
+// static
+void EpollAlarmWheel::LinkBefore(Node* head, Node* node) {
+  node->prev = head->prev;
+  node->next = head;
+  head->prev->next = node;
+  head->prev = node;
+}
+
+// static
+void EpollAlarmWheel::Unlink(Node* node) {
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+  node->prev = node;
+  node->next = node;
+}
+
+}  // namespace net
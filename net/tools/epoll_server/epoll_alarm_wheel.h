@@ -0,0 +1,135 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_EPOLL_SERVER_EPOLL_ALARM_WHEEL_H_
+#define NET_TOOLS_EPOLL_SERVER_EPOLL_ALARM_WHEEL_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+
+namespace net {
+
+class EpollAlarmCallbackInterface;
+
+// A hierarchical timer wheel holding the alarms of an EpollServer, in the
+// style of the Linux kernel's timer lists.  Registering and unregistering an
+// alarm take constant time, however many alarms are registered, which an
+// ordered map can't offer once there are hundreds of thousands of
+// connections, each with a few alarms which are mostly cancelled before they
+// fire.
+//
+// Time is divided into ticks of kTickInUsec.  The first level has a slot for
+// each of the next 256 ticks, and each following level has 256 slots, each
+// covering all the slots of the level below.  Whenever the first level wraps
+// around, the alarms of the next slot of the second level are spread out
+// into it, and so on up the levels.  Alarms are only ever compared by their
+// exact time within the slot of the current tick, so they fire exactly when
+// they are due, and in order of time.
+class EpollAlarmWheel {
+ public:
+  static const int64 kTickInUsec = 1000;
+
+  // An alarm in the wheel.  Each node is linked into the list of the slot
+  // holding it, so that it can be removed without a lookup.
+  struct Node {
+    Node();
+
+    int64 time_in_us;
+    EpollAlarmCallbackInterface* cb;
+    // The level of the slot, kExpired if the node is waiting to be popped by
+    // PopExpired, or kNotInWheel.
+    int level;
+    Node* prev;
+    Node* next;
+  };
+
+  EpollAlarmWheel();
+  ~EpollAlarmWheel();
+
+  // Adds an alarm for |cb| at |time_in_us|.  The returned node stays valid
+  // until the alarm is removed or popped.  |now_in_us| is used to position
+  // the wheel when it is empty.
+  Node* Add(int64 time_in_us, EpollAlarmCallbackInterface* cb,
+            int64 now_in_us);
+
+  // Removes the alarm of |node|, which must be in the wheel.
+  void Remove(Node* node);
+
+  // Turns the wheel to |now_in_us|, and queues every alarm due by then, in
+  // order of time, to be returned by PopExpired.
+  void Expire(int64 now_in_us);
+
+  // Removes the first alarm queued by Expire, and returns its callback, or
+  // returns NULL if there are none left.
+  EpollAlarmCallbackInterface* PopExpired();
+
+  // Returns a time no later than that of the earliest alarm, which is exact
+  // unless the earliest alarm is further away than the slots of the first
+  // level.  The wheel must not be empty.
+  int64 NextAlarmTimeLowerBound() const;
+
+  // Removes any one alarm and returns its callback, or returns NULL if the
+  // wheel is empty.  Removing every alarm this way takes linear time.
+  EpollAlarmCallbackInterface* RemoveAny();
+
+  // Appends every alarm in the wheel to |alarms|, in no particular order.
+  void GetAlarms(std::vector<const Node*>* alarms) const;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+ private:
+  static const int kNumLevels = 4;
+  static const int kBitsPerLevel = 8;
+  static const int64 kSlotsPerLevel = 1 << kBitsPerLevel;
+  static const int64 kSlotMask = kSlotsPerLevel - 1;
+  static const int kExpired = -1;
+  static const int kNotInWheel = -2;
+
+  static int64 TickFor(int64 time_in_us) { return time_in_us / kTickInUsec; }
+
+  // Links |node| into the slot for its time.
+  void Insert(Node* node);
+
+  // Spreads out the alarms of the current slot of |level| into the lower
+  // levels, and cascades the next level if that slot is the first.
+  void Cascade(int level);
+
+  // Queues the alarms of the current slot of the first level which are due
+  // by |now_in_us| in |due_|.
+  void CollectDue(int64 now_in_us);
+
+  Node* NewNode();
+  void FreeNode(Node* node);
+
+  static void LinkBefore(Node* head, Node* node);
+  static void Unlink(Node* node);
+  static bool IsEmptyList(const Node* head) { return head->next == head; }
+
+  // The list heads of the slots.
+  Node slots_[kNumLevels][kSlotsPerLevel];
+  size_t level_sizes_[kNumLevels];
+  // The alarms which have been expired, but not yet popped.
+  Node expired_;
+  size_t size_;
+
+  // All alarms due before this tick have been expired.
+  int64 current_tick_;
+
+  // Where RemoveAny continues looking for an alarm.
+  int64 remove_any_cursor_;
+
+  // Nodes no longer in use, linked through |next|.
+  Node* free_nodes_;
+
+  // Scratch space for Expire.
+  std::vector<Node*> due_;
+
+  DISALLOW_COPY_AND_ASSIGN(EpollAlarmWheel);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_EPOLL_SERVER_EPOLL_ALARM_WHEEL_H_
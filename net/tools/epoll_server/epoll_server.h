@@ -36,6 +36,7 @@
 #include "base/compiler_specific.h"
 #include "base/containers/hash_tables.h"
 #include "base/memory/scoped_ptr.h"
+#include "net/tools/epoll_server/epoll_alarm_wheel.h"
 #include <sys/epoll.h>
 
 namespace net {
@@ -122,8 +123,7 @@ class EpollServer {
   typedef EpollAlarmCallbackInterface AlarmCB;
   typedef EpollCallbackInterface CB;
 
-  typedef std::multimap<int64, AlarmCB*> TimeToAlarmCBMap;
-  typedef TimeToAlarmCBMap::iterator AlarmRegToken;
+  typedef EpollAlarmWheel::Node* AlarmRegToken;
 
   // Summary:
   //   Constructor:
@@ -196,6 +196,23 @@ class EpollServer {
 
   ////////////////////////////////////////
 
+  // Summary:
+  //   A shortcut for RegisterFD which registers 'fd' for edge triggered
+  //   notification of 'event_mask', and puts it on the ready list, so that
+  //   the callback gets the initial event which edge trigger registration
+  //   doesn't send.  The callback should read or write until it would block,
+  //   and then call SetFDNotReady(); see SetFDReady() for details.  This
+  //   saves the epoll_ctl() calls which changing the event mask of a level
+  //   triggered fd takes.
+  // Args:
+  //   fd - a valid, non-blocking file-descriptor
+  //   cb - an instance of a subclass of EpollCallbackInterface
+  //   event_mask - a combination of (EPOLLOUT, EPOLLIN.. etc), without
+  //                EPOLLET.
+  virtual void RegisterFDEdgeTriggered(int fd, CB* cb, int event_mask);
+
+  ////////////////////////////////////////
+
   // Summary:
   //   Removes the FD and the associated callback from the pollserver.
   //   If the callback is registered with other FDs, they will continue
@@ -394,7 +411,7 @@ class EpollServer {
   //   be warned that a token may have become already invalid when OnAlarm()
   //   is called, was unregistered, or OnShutdown was called on that alarm.
   // Args:
-  //    iterator_token - iterator to the alarm callback to unregister.
+  //    iterator_token - token of the alarm callback to unregister.
   virtual void UnregisterAlarm(
       const EpollServer::AlarmRegToken& iterator_token);
 
@@ -677,7 +694,10 @@ class EpollServer {
   typedef base::hash_set<AlarmCB*, AlarmCBHash> AlarmCBMap;
   AlarmCBMap all_alarms_;
 
-  TimeToAlarmCBMap alarm_map_;
+  // The registered alarms.  Registering and unregistering take constant
+  // time, which matters with an alarm or two for each of a great many
+  // connections.
+  EpollAlarmWheel alarm_wheel_;
 
   // The amount of time in microseconds that we'll wait before returning
   // from the WaitForEventsAndExecuteCallbacks() function.
@@ -693,15 +713,6 @@ class EpollServer {
   // ApproximateNowInUs() function. See that function for more details.
   int64 recorded_now_in_us_;
 
-  // This is used to implement CallAndReregisterAlarmEvents. This stores
-  // all alarms that were reregistered because OnAlarm() returned a
-  // value > 0 and the time at which they should be executed is less that
-  // the current time.  By storing such alarms in this map we ensure
-  // that while calling CallAndReregisterAlarmEvents we do not call
-  // OnAlarm on any alarm in this set. This ensures that we do not
-  // go in an infinite loop.
-  AlarmCBMap alarms_reregistered_and_should_be_skipped_;
-
   LIST_HEAD(ReadyList, CBAndEventMask) ready_list_;
   LIST_HEAD(TmpList, CBAndEventMask) tmp_list_;
   int ready_list_size_;
@@ -945,7 +956,7 @@ class EpollServer {
  private:
   // Helper functions used in the destructor.
   void CleanupFDToCBMap();
-  void CleanupTimeToAlarmCBMap();
+  void CleanupAlarms();
 
   // The callback registered to the fds below.  As the purpose of their
   // registration is to wake the epoll server it just clears the pipe and
@@ -984,7 +995,7 @@ class EpollAlarmCallbackInterface {
   // Summary:
   //   Called when the an alarm is registered. Invalidates an AlarmRegToken.
   // Args:
-  //   token: the iterator to the the alarm registered in the alarm map.
+  //   token: the node of the alarm registered in the alarm wheel.
   //   WARNING: this token becomes invalid when the alarm fires, is
   //   unregistered, or OnShutdown is called on that alarm.
   //   eps: the epoll server the alarm is registered with.
@@ -0,0 +1,120 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/epoll_server/epoll_server_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
+#include "net/tools/epoll_server/epoll_server.h"
+
+namespace net {
+
+namespace {
+
+// How long an idle loop waits before checking whether it should exit.  Stop()
+// wakes the loops up, so this is only a backstop.
+const int64 kTimeoutInUs = 50 * 1000;
+
+}  // namespace
+
+// Runs one epoll server until it is told to quit.
+class EpollServerPool::Loop : public base::SimpleThread {
+ public:
+  Loop(size_t index, bool pin_to_core)
+      : base::SimpleThread("EpollServerPool" + base::Uint64ToString(index)),
+        index_(index),
+        pin_to_core_(pin_to_core),
+        quit_(true, false) {
+    epoll_server_.set_timeout_in_us(kTimeoutInUs);
+  }
+
+  virtual ~Loop() {}
+
+  EpollServer* epoll_server() { return &epoll_server_; }
+
+  // Makes the thread exit after the current iteration.  May be called on any
+  // thread.
+  void Quit() {
+    quit_.Signal();
+    epoll_server_.Wake();
+  }
+
+  // base::SimpleThread:
+  virtual void Run() OVERRIDE {
+    if (pin_to_core_) {
+      PinToCore();
+    }
+    while (!quit_.IsSignaled()) {
+      epoll_server_.WaitForEventsAndExecuteCallbacks();
+    }
+  }
+
+ private:
+  void PinToCore() {
+    const int core = index_ % base::SysInfo::NumberOfProcessors();
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core, &cpu_set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (rc != 0) {
+      // Running unpinned is slower, but still correct.
+      LOG(WARNING) << "Unable to pin epoll server " << index_ << " to core "
+                   << core << ": " << strerror(rc);
+    }
+  }
+
+  const size_t index_;
+  const bool pin_to_core_;
+  EpollServer epoll_server_;
+  base::WaitableEvent quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(Loop);
+};
+
+EpollServerPool::EpollServerPool(size_t num_servers, bool pin_to_cores)
+    : started_(false) {
+  DCHECK_GT(num_servers, 0u);
+  for (size_t i = 0; i < num_servers; ++i) {
+    loops_.push_back(new Loop(i, pin_to_cores));
+  }
+}
+
+EpollServerPool::~EpollServerPool() {
+  Stop();
+}
+
+EpollServer* EpollServerPool::server(size_t index) {
+  DCHECK_LT(index, loops_.size());
+  return loops_[index]->epoll_server();
+}
+
+void EpollServerPool::Start() {
+  DCHECK(!started_);
+  started_ = true;
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    loops_[i]->Start();
+  }
+}
+
+void EpollServerPool::Stop() {
+  if (!started_) {
+    return;
+  }
+  started_ = false;
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    loops_[i]->Quit();
+  }
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    loops_[i]->Join();
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,57 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Runs several independent EpollServers, each on a thread of its own, and
+// optionally with each thread pinned to a core.  A server which handles a
+// share of the connections on each loop, rather than handing work from one
+// loop to others, keeps each connection's state in the cache of one core.
+
+#ifndef NET_TOOLS_EPOLL_SERVER_EPOLL_SERVER_POOL_H_
+#define NET_TOOLS_EPOLL_SERVER_EPOLL_SERVER_POOL_H_
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+
+namespace net {
+
+class EpollServer;
+
+class EpollServerPool {
+ public:
+  // Creates |num_servers| epoll servers.  If |pin_to_cores| is true, the
+  // thread of the server with index i only runs on core i modulo the number
+  // of cores.
+  EpollServerPool(size_t num_servers, bool pin_to_cores);
+
+  // Stops the threads, if they are running.
+  ~EpollServerPool();
+
+  // Returns the epoll server with index |index|.  Before Start(), callbacks
+  // and alarms can be registered with it from any thread; after, only from
+  // its own thread, as with any epoll server other than Wake().
+  EpollServer* server(size_t index);
+
+  size_t size() const { return loops_.size(); }
+
+  // Starts running the epoll servers, each on its own thread.  A pool can
+  // only be started once.
+  void Start();
+
+  // Makes each thread return from its current iteration of its epoll
+  // server, and waits for them to exit.  The epoll servers are still alive
+  // and hold their registrations, and are shut down with the pool.
+  void Stop();
+
+ private:
+  class Loop;
+
+  ScopedVector<Loop> loops_;
+  bool started_;
+
+  DISALLOW_COPY_AND_ASSIGN(EpollServerPool);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_EPOLL_SERVER_EPOLL_SERVER_POOL_H_
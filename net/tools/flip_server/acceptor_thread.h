@@ -46,7 +46,15 @@ class SMAcceptorThread : public base::SimpleThread,
                          public EpollCallbackInterface,
                          public SMConnectionPoolInterface {
  public:
-  SMAcceptorThread(FlipAcceptor* acceptor, MemoryCache* memory_cache);
+  // Accepts connections on |listen_fd|, which is either the acceptor's
+  // listen_fd_, or a socket of the thread's own from
+  // FlipAcceptor::CreateWorkerListenFD(), which the thread then owns.  If
+  // |max_connections| is not zero, no more than that many connections are
+  // allocated, and connections accepted beyond that are closed.
+  SMAcceptorThread(FlipAcceptor* acceptor,
+                   MemoryCache* memory_cache,
+                   int listen_fd,
+                   size_t max_connections);
   virtual ~SMAcceptorThread();
 
   // EpollCallbackInteface interface
@@ -83,6 +91,11 @@ class SMAcceptorThread : public base::SimpleThread,
   SSLState* ssl_state_;
   bool use_ssl_;
   int idle_socket_timeout_s_;
+  // The oldest last read time of the active connections, as of the last
+  // time they were checked for idleness.
+  time_t oldest_time_;
+  int listen_fd_;
+  const size_t max_connections_;
 
   std::vector<SMConnection*> unused_server_connections_;
   std::vector<SMConnection*> tmp_unused_server_connections_;
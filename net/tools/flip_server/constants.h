@@ -13,6 +13,9 @@ const int kSpdyOverhead = 8;
 const int kInitialDataSendersThreshold = (2 * kMSS) - kSpdyOverhead;
 const int kSSLSegmentSize = (1 * kMSS) - kSSLOverhead;
 const int kSpdySegmentSize = kSSLSegmentSize - kSpdyOverhead;
+// The size of the buffer each SMConnection reads into, which is most of the
+// memory a connection takes.
+const int kSMConnectionReadBufferSize = kSpdySegmentSize * 40;
 
 #define ACCEPTOR_CLIENT_IDENT \
   acceptor_->listen_ip_ << ":" << acceptor_->listen_port_ << " "
@@ -37,6 +37,7 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
       accept_backlog_size_(accept_backlog_size),
       disable_nagle_(disable_nagle),
       accepts_per_wake_(accepts_per_wake),
+      reuseport_(reuseport),
       memory_cache_(memory_cache),
       ssl_session_expiry_(300),  // TODO(mbelshe):  Hook these up!
       ssl_disable_compression_(false),
@@ -93,6 +94,28 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
 
 FlipAcceptor::~FlipAcceptor() {}
 
+int FlipAcceptor::CreateWorkerListenFD() const {
+  DCHECK(reuseport_);
+  int fd = -1;
+  // The interface was raised when |listen_fd_| was bound, so don't wait.
+  int ret = CreateListeningSocket(listen_ip_,
+                                  listen_port_,
+                                  true,
+                                  accept_backlog_size_,
+                                  true,
+                                  true,
+                                  false,
+                                  disable_nagle_,
+                                  &fd);
+  if (ret != 0) {
+    LOG(ERROR) << "Unable to create worker listening socket for: ret = "
+               << ret << ": " << listen_ip_ << ":" << listen_port_;
+    return -1;
+  }
+  FlipSetNonBlocking(fd);
+  return fd;
+}
+
 FlipConfig::FlipConfig()
     : server_think_time_in_s_(0),
       log_destination_(logging::LOG_TO_SYSTEM_DEBUG_LOG),
@@ -41,6 +41,12 @@ class FlipAcceptor {
                void* memory_cache);
   ~FlipAcceptor();
 
+  // Creates another non-blocking socket listening on the same address, for
+  // a worker thread which accepts connections on its own socket.  The
+  // acceptor must have been created with |reuseport|, so that the kernel
+  // spreads incoming connections among the sockets.  Returns -1 on failure.
+  int CreateWorkerListenFD() const;
+
   enum FlipHandlerType flip_handler_type_;
   std::string listen_ip_;
   std::string listen_port_;
@@ -55,6 +61,7 @@ class FlipAcceptor {
   bool disable_nagle_;
   int accepts_per_wake_;
   int listen_fd_;
+  bool reuseport_;
   void* memory_cache_;
   int ssl_session_expiry_;
   bool ssl_disable_compression_;
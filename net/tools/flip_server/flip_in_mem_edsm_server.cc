@@ -8,17 +8,21 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "base/command_line.h"
+#include "base/files/file_path.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
 #include "base/synchronization/lock.h"
 #include "base/timer/timer.h"
 #include "net/tools/balsa/split.h"
 #include "net/tools/flip_server/acceptor_thread.h"
 #include "net/tools/flip_server/constants.h"
 #include "net/tools/flip_server/flip_config.h"
+#include "net/tools/flip_server/mem_cache.h"
 #include "net/tools/flip_server/output_ordering.h"
 #include "net/tools/flip_server/sm_connection.h"
 #include "net/tools/flip_server/sm_interface.h"
@@ -43,6 +47,17 @@ int32 FLAGS_accept_backlog_size = 1024;
 //  SO_REUSEPORT);
 bool FLAGS_reuseport = false;
 
+// The number of threads accepting and serving the connections of each
+//  acceptor.  With more than one, each thread has a listening socket of its
+//  own, bound with SO_REUSEPORT, its own pool of connections and its own
+//  view of the memory cache, so that nothing is shared between the threads.
+int32 FLAGS_workers_per_acceptor = 1;
+
+// With more than one worker per acceptor, the number of megabytes of
+//  connections each worker may allocate.  Connections accepted beyond that
+//  are closed.  If set to 0, there is no limit.
+int32 FLAGS_worker_memory_budget_mb = 0;
+
 // Flag to force spdy, even if NPN is not negotiated.
 bool FLAGS_force_spdy = false;
 
@@ -151,6 +166,17 @@ static int OpenPidFile(const char* pidfile) {
   return fd;
 }
 
+// Fills |cache| from the pack given by --cache-pack, or else from the files
+// in the current directory.
+void LoadMemoryCache(const CommandLine& cl, net::MemoryCache* cache) {
+  if (cl.HasSwitch("cache-pack")) {
+    if (!cache->AddFilesFromPack(cl.GetSwitchValuePath("cache-pack")))
+      LOG(FATAL) << "Unable to load the cache pack.";
+    return;
+  }
+  cache->AddFiles();
+}
+
 int main(int argc, char** argv) {
   unsigned int i = 0;
   bool wait_for_iface = false;
@@ -198,6 +224,19 @@ int main(int argc, char** argv) {
         "\t--ssl-session-expiry=<seconds> (default is 300)\n"
         "\t--ssl-disable-compression\n"
         "\t--idle-timeout=<seconds> (default is 300)\n"
+        "\t--workers=<n> (default is 1)\n"
+        "\t  * Each of the n worker threads of a listen ip:port accepts on"
+        " a socket\n"
+        "\t    of its own, bound with SO_REUSEPORT.\n"
+        "\t--worker-memory-mb=<megabytes> (default is 0, no limit)\n"
+        "\t  * The memory each worker may use for connections.\n"
+        "\t--cache-pack=<filepath>\n"
+        "\t  * Serve the files of a pack written by --write-cache-pack,"
+        " mapped\n"
+        "\t    read-only, instead of the files in the current directory.\n"
+        "\t--write-cache-pack=<filepath>\n"
+        "\t  * Write the files in the current directory to a pack, and"
+        " exit.\n"
         "\t--pidfile=<filepath> (default /var/run/flip-server.pid)\n"
         "\t--help\n");
     exit(0);
@@ -260,6 +299,20 @@ int main(int argc, char** argv) {
         atoi(cl.GetSwitchValueASCII("idle-timeout").c_str());
   }
 
+  if (cl.HasSwitch("workers")) {
+    FLAGS_workers_per_acceptor =
+        std::max(1, atoi(cl.GetSwitchValueASCII("workers").c_str()));
+  }
+  if (FLAGS_workers_per_acceptor > 1) {
+    // The workers' sockets can only share the address with SO_REUSEPORT.
+    FLAGS_reuseport = true;
+  }
+
+  if (cl.HasSwitch("worker-memory-mb")) {
+    FLAGS_worker_memory_budget_mb =
+        atoi(cl.GetSwitchValueASCII("worker-memory-mb").c_str());
+  }
+
   if (cl.HasSwitch("force_spdy"))
     net::SMConnection::set_force_spdy(true);
 
@@ -269,6 +322,16 @@ int main(int argc, char** argv) {
   settings.lock_log = logging::DONT_LOCK_LOG_FILE;
   logging::InitLogging(settings);
 
+  if (cl.HasSwitch("write-cache-pack")) {
+    net::MemoryCache cache;
+    cache.AddFiles();
+    if (!cache.WritePack(cl.GetSwitchValuePath("write-cache-pack"))) {
+      LOG(ERROR) << "Unable to write the cache pack.";
+      exit(1);
+    }
+    exit(0);
+  }
+
   LOG(INFO) << "Flip SPDY proxy started with configuration:";
   LOG(INFO) << "Logging destination     : " << g_proxy_config.log_destination_;
   LOG(INFO) << "Log file                : " << g_proxy_config.log_filename_;
@@ -286,6 +349,8 @@ int main(int argc, char** argv) {
                                                                 : "false");
   LOG(INFO) << "Force SPDY              : " << (FLAGS_force_spdy ? "true"
                                                                  : "false");
+  LOG(INFO) << "Workers per acceptor    : " << FLAGS_workers_per_acceptor;
+  LOG(INFO) << "Worker memory budget MB : " << FLAGS_worker_memory_budget_mb;
   LOG(INFO) << "SSL session expiry      : "
             << g_proxy_config.ssl_session_expiry_;
   LOG(INFO) << "SSL disable compression : "
@@ -328,7 +393,7 @@ int main(int argc, char** argv) {
   // Spdy Server Acceptor
   net::MemoryCache spdy_memory_cache;
   if (cl.HasSwitch("spdy-server")) {
-    spdy_memory_cache.AddFiles();
+    LoadMemoryCache(cl, &spdy_memory_cache);
     std::string value = cl.GetSwitchValueASCII("spdy-server");
     std::vector<std::string> valueArgs = split(value, ',');
     while (valueArgs.size() < 4)
@@ -354,7 +419,7 @@ int main(int argc, char** argv) {
   // Spdy Server Acceptor
   net::MemoryCache http_memory_cache;
   if (cl.HasSwitch("http-server")) {
-    http_memory_cache.AddFiles();
+    LoadMemoryCache(cl, &http_memory_cache);
     std::string value = cl.GetSwitchValueASCII("http-server");
     std::vector<std::string> valueArgs = split(value, ',');
     while (valueArgs.size() < 4)
@@ -378,22 +443,49 @@ int main(int argc, char** argv) {
   }
 
   std::vector<net::SMAcceptorThread*> sm_worker_threads_;
+  // The views of the memory caches the extra workers serve from.
+  ScopedVector<net::MemoryCache> worker_memory_caches;
+
+  size_t max_connections_per_worker = 0;
+  if (FLAGS_workers_per_acceptor > 1 && FLAGS_worker_memory_budget_mb > 0) {
+    size_t connection_size =
+        sizeof(net::SMConnection) + kSMConnectionReadBufferSize;
+    max_connections_per_worker = std::max<size_t>(
+        1, (FLAGS_worker_memory_budget_mb * 1024 * 1024) / connection_size);
+  }
 
   for (i = 0; i < g_proxy_config.acceptors_.size(); i++) {
     net::FlipAcceptor* acceptor = g_proxy_config.acceptors_[i];
 
-    sm_worker_threads_.push_back(new net::SMAcceptorThread(
-        acceptor, (net::MemoryCache*)acceptor->memory_cache_));
-    // Note that spdy_memory_cache is not threadsafe, it is merely
-    // thread compatible. Thus, if ever we are to spawn multiple threads,
-    // we either must make the MemoryCache threadsafe, or use
-    // a separate MemoryCache for each thread.
-    //
-    // The latter is what is currently being done as we spawn
-    // a separate thread for each http and spdy server acceptor.
-
-    sm_worker_threads_.back()->InitWorker();
-    sm_worker_threads_.back()->Start();
+    for (int worker = 0; worker < FLAGS_workers_per_acceptor; ++worker) {
+      // Note that spdy_memory_cache is not threadsafe, it is merely
+      // thread compatible. Thus, if ever we are to spawn multiple threads,
+      // we either must make the MemoryCache threadsafe, or use
+      // a separate MemoryCache for each thread.
+      //
+      // The latter is what is currently being done as we spawn
+      // a separate thread for each http and spdy server acceptor, and the
+      // extra workers of an acceptor each get a view of their own.
+      net::MemoryCache* memory_cache =
+          static_cast<net::MemoryCache*>(acceptor->memory_cache_);
+      int listen_fd = acceptor->listen_fd_;
+      if (worker > 0) {
+        listen_fd = acceptor->CreateWorkerListenFD();
+        if (listen_fd < 0) {
+          break;
+        }
+        if (memory_cache) {
+          net::MemoryCache* view = new net::MemoryCache;
+          view->CloneFrom(*memory_cache);
+          worker_memory_caches.push_back(view);
+          memory_cache = view;
+        }
+      }
+      sm_worker_threads_.push_back(new net::SMAcceptorThread(
+          acceptor, memory_cache, listen_fd, max_connections_per_worker));
+      sm_worker_threads_.back()->InitWorker();
+      sm_worker_threads_.back()->Start();
+    }
   }
 
   while (!wantExit) {
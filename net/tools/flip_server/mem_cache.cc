@@ -16,9 +16,11 @@
 #include <map>
 #include <string>
 
+#include "base/files/file_path.h"
 #include "base/strings/string_util.h"
 #include "net/tools/balsa/balsa_frame.h"
 #include "net/tools/balsa/balsa_headers.h"
+#include "net/tools/balsa/packed_response_cache.h"
 #include "net/tools/dump_cache/url_to_filename_encoder.h"
 #include "net/tools/dump_cache/url_utilities.h"
 
@@ -53,7 +55,8 @@ void StoreBodyAndHeadersVisitor::HandleBodyError(BalsaFrame* framer) {
 FileData::FileData(const BalsaHeaders* headers,
                    const std::string& filename,
                    const std::string& body)
-    : filename_(filename), body_(body) {
+    : filename_(filename), body_storage_(body) {
+  body_ = body_storage_;
   if (headers) {
     headers_.reset(new BalsaHeaders);
     headers_->CopyFrom(*headers);
@@ -64,7 +67,7 @@ FileData::FileData() {}
 
 FileData::~FileData() {}
 
-MemoryCache::MemoryCache() : cwd_(FLAGS_cache_base_dir) {}
+MemoryCache::MemoryCache() : cwd_(FLAGS_cache_base_dir), owns_files_(true) {}
 
 MemoryCache::~MemoryCache() { ClearFiles(); }
 
@@ -73,6 +76,7 @@ void MemoryCache::CloneFrom(const MemoryCache& mc) {
   ClearFiles();
   files_ = mc.files_;
   cwd_ = mc.cwd_;
+  owns_files_ = false;
 }
 
 void MemoryCache::AddFiles() {
@@ -118,6 +122,51 @@ void MemoryCache::AddFiles() {
   }
 }
 
+bool MemoryCache::AddFilesFromPack(const base::FilePath& path) {
+  DCHECK(owns_files_) << "Can't add files to a view of another cache.";
+  if (pack_.get()) {
+    LOG(DFATAL) << "A pack has already been loaded.";
+    return false;
+  }
+  scoped_ptr<PackedResponseCache> pack(new PackedResponseCache);
+  if (!pack->Open(path)) {
+    LOG(ERROR) << "Unable to load pack: " << path.value();
+    return false;
+  }
+  for (size_t i = 0; i < pack->num_entries(); ++i) {
+    PackedResponseCache::Entry entry = pack->GetEntry(i);
+    FileData* file_data = new FileData;
+    file_data->headers_.reset(new BalsaHeaders);
+    if (!PackedResponseCache::ParseHeaders(entry.headers,
+                                           file_data->headers_.get())) {
+      LOG(ERROR) << "Malformed headers in pack for: " << entry.key;
+      delete file_data;
+      continue;
+    }
+    file_data->filename_ = entry.key.as_string();
+    file_data->body_ = entry.body;
+    InsertFile(file_data);
+  }
+  LOG(INFO) << "Added " << pack->num_entries() << " files from pack: "
+            << path.value();
+  pack_.reset(pack.release());
+  return true;
+}
+
+bool MemoryCache::WritePack(const base::FilePath& path) const {
+  PackedResponseCacheWriter writer;
+  if (!writer.Open(path))
+    return false;
+  for (Files::const_iterator it = files_.begin(); it != files_.end(); ++it) {
+    const FileData* file_data = it->second;
+    if (!file_data->headers())
+      continue;
+    if (!writer.Add(it->first, *file_data->headers(), file_data->body()))
+      return false;
+  }
+  return writer.Finish();
+}
+
 void MemoryCache::ReadToString(const char* filename, std::string* output) {
   output->clear();
   int fd = open(filename, 0, "r");
@@ -233,6 +282,7 @@ void MemoryCache::InsertFile(const BalsaHeaders* headers,
 }
 
 void MemoryCache::InsertFile(FileData* file_data) {
+  DCHECK(owns_files_) << "Can't add files to a view of another cache.";
   Files::iterator it = files_.find(file_data->filename());
   if (it != files_.end()) {
     delete it->second;
@@ -243,10 +293,14 @@ void MemoryCache::InsertFile(FileData* file_data) {
 }
 
 void MemoryCache::ClearFiles() {
-  for (Files::const_iterator i = files_.begin(); i != files_.end(); ++i) {
-    delete i->second;
+  if (owns_files_) {
+    for (Files::const_iterator i = files_.begin(); i != files_.end(); ++i) {
+      delete i->second;
+    }
+    pack_.reset();
   }
   files_.clear();
+  owns_files_ = true;
 }
 
 }  // namespace net
@@ -10,12 +10,19 @@
 
 #include "base/compiler_specific.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
 #include "net/tools/balsa/balsa_headers.h"
 #include "net/tools/balsa/balsa_visitor_interface.h"
 #include "net/tools/flip_server/constants.h"
 
+namespace base {
+class FilePath;
+}  // namespace base
+
 namespace net {
 
+class PackedResponseCache;
+
 class StoreBodyAndHeadersVisitor : public BalsaVisitorInterface {
  public:
   void HandleError() { error_ = true; }
@@ -72,12 +79,16 @@ class FileData {
   const BalsaHeaders* headers() const { return headers_.get(); }
 
   const std::string& filename() { return filename_; }
-  const std::string& body() { return body_; }
+  base::StringPiece body() const { return body_; }
 
  private:
+  friend class MemoryCache;
+
   scoped_ptr<BalsaHeaders> headers_;
   std::string filename_;
-  std::string body_;
+  // Points into |body_storage_|, or into the pack the file was loaded from.
+  base::StringPiece body_;
+  std::string body_storage_;
 
   DISALLOW_COPY_AND_ASSIGN(FileData);
 };
@@ -117,10 +128,22 @@ class MemoryCache {
   MemoryCache();
   virtual ~MemoryCache();
 
+  // Makes this cache a view of the files of |mc|, which must outlive it and
+  // not change while it is in use.  A view has a map of its own, so that
+  // threads serving the same files don't share one, but the file data is
+  // shared, and new files can't be added to the view.
   void CloneFrom(const MemoryCache& mc);
 
   void AddFiles();
 
+  // Maps a pack written by WritePack() and adds its files, which are served
+  // from the mapped pages.  Only one pack can be added.  Returns false if
+  // the pack can't be loaded.
+  bool AddFilesFromPack(const base::FilePath& path);
+
+  // Writes the files of the cache to a pack.  Returns false on an error.
+  bool WritePack(const base::FilePath& path) const;
+
   // virtual for unittests
   virtual void ReadToString(const char* filename, std::string* output);
 
@@ -141,6 +164,10 @@ class MemoryCache {
 
   Files files_;
   std::string cwd_;
+  // False for a view made by CloneFrom.
+  bool owns_files_;
+  // The pack that bodies of files added by AddFilesFromPack point into.
+  scoped_ptr<PackedResponseCache> pack_;
 };
 
 class NotifierInterface {
@@ -4,6 +4,8 @@
 
 #include "net/tools/flip_server/mem_cache.h"
 
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
 #include "net/tools/balsa/balsa_headers.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -96,6 +98,54 @@ TEST_F(FlipMemoryCacheTest, GetFileDataForHtmlFile) {
   ASSERT_EQ(hello_html, mem_cache_->GetFileData("hello.http"));
 }
 
+TEST_F(FlipMemoryCacheTest, CloneFromSharesFileData) {
+  mem_cache_->data_map_["./hello"] =
+      "HTTP/1.0 200 OK\r\n"
+      "key1: value1\r\n\r\n"
+      "body: body\r\n";
+  mem_cache_->ReadAndStoreFileContents("./hello");
+  FileData* hello = mem_cache_->GetFileData("hello");
+  ASSERT_FALSE(NULL == hello);
+
+  {
+    MemoryCache view;
+    view.CloneFrom(*mem_cache_);
+    ASSERT_EQ(hello, view.GetFileData("hello"));
+    ASSERT_EQ(NULL, view.GetFileData("foo"));
+  }
+
+  // Destroying the view leaves the file data of the cache alone.
+  ASSERT_EQ(hello, mem_cache_->GetFileData("hello"));
+  ASSERT_EQ("body: body\r\n", hello->body());
+}
+
+TEST_F(FlipMemoryCacheTest, WriteAndAddFilesFromPack) {
+  mem_cache_->data_map_["./hello"] =
+      "HTTP/1.1 200 OK\r\n"
+      "key1: value1\r\n\r\n"
+      "body: body\r\n";
+  mem_cache_->ReadAndStoreFileContents("./hello");
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath pack_path = temp_dir.path().AppendASCII("pack");
+  ASSERT_TRUE(mem_cache_->WritePack(pack_path));
+
+  MemoryCache packed_cache;
+  ASSERT_TRUE(packed_cache.AddFilesFromPack(pack_path));
+  FileData* hello = packed_cache.GetFileData("hello");
+  ASSERT_FALSE(NULL == hello);
+  ASSERT_EQ("body: body\r\n", hello->body());
+  ASSERT_EQ("value1", hello->headers()->GetHeader("key1"));
+  ASSERT_EQ("200", hello->headers()->response_code());
+  ASSERT_EQ(NULL, packed_cache.GetFileData("foo"));
+
+  // A pack that doesn't exist isn't loaded.
+  MemoryCache missing_cache;
+  ASSERT_FALSE(
+      missing_cache.AddFilesFromPack(temp_dir.path().AppendASCII("missing")));
+}
+
 }  // namespace
 
 }  // namespace net
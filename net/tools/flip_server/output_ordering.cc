@@ -12,7 +12,7 @@
 namespace net {
 
 OutputOrdering::PriorityMapPointer::PriorityMapPointer()
-    : ring(NULL), alarm_enabled(false) {}
+    : ring(NULL), alarm_enabled(false), alarm_token(NULL) {}
 
 OutputOrdering::PriorityMapPointer::~PriorityMapPointer() {}
 
@@ -47,7 +47,7 @@ SMConnection::SMConnection(EpollServer* epoll_server,
       ssl_state_(ssl_state),
       memory_cache_(memory_cache),
       acceptor_(acceptor),
-      read_buffer_(kSpdySegmentSize * 40),
+      read_buffer_(kSMConnectionReadBufferSize),
       sm_spdy_interface_(NULL),
       sm_http_interface_(NULL),
       sm_streamer_interface_(NULL),
@@ -123,19 +123,19 @@ SMInterface* SpdySM::FindOrMakeNewSMConnectionInterface(
 
 int SpdySM::SpdyHandleNewStream(SpdyStreamId stream_id,
                                 SpdyPriority priority,
-                                const SpdyHeaderBlock& headers,
+                                const SpdyHeaderBlockView& headers,
                                 std::string& http_data,
                                 bool* is_https_scheme) {
   *is_https_scheme = false;
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: OnSyn(" << stream_id << ")";
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: # headers: " << headers.size();
 
-  SpdyHeaderBlock::const_iterator method = headers.end();
-  SpdyHeaderBlock::const_iterator host = headers.end();
-  SpdyHeaderBlock::const_iterator path = headers.end();
-  SpdyHeaderBlock::const_iterator scheme = headers.end();
-  SpdyHeaderBlock::const_iterator version = headers.end();
-  SpdyHeaderBlock::const_iterator url = headers.end();
+  SpdyHeaderBlockView::const_iterator method = headers.end();
+  SpdyHeaderBlockView::const_iterator host = headers.end();
+  SpdyHeaderBlockView::const_iterator path = headers.end();
+  SpdyHeaderBlockView::const_iterator scheme = headers.end();
+  SpdyHeaderBlockView::const_iterator version = headers.end();
+  SpdyHeaderBlockView::const_iterator url = headers.end();
 
   std::string path_string, host_string, version_string;
 
@@ -154,9 +154,10 @@ int SpdySM::SpdyHandleNewStream(SpdyStreamId stream_id,
     // path contains a query string with a http:// in one of its values,
     // UrlUtilities::GetUrlPath will fail and always return a / breaking
     // the request. GetUrlPath assumes the absolute URL is being passed in.
-    path_string = UrlUtilities::GetUrlPath(url->second);
-    host_string = UrlUtilities::GetUrlHost(url->second);
-    version_string = version->second;
+    std::string url_string = url->second.as_string();
+    path_string = UrlUtilities::GetUrlPath(url_string);
+    host_string = UrlUtilities::GetUrlHost(url_string);
+    version_string = version->second.as_string();
   } else {
     method = headers.find(":method");
     host = headers.find(":host");
@@ -168,8 +169,8 @@ int SpdySM::SpdyHandleNewStream(SpdyStreamId stream_id,
               << "missing. Not creating stream";
       return 0;
     }
-    host_string = host->second;
-    path_string = path->second;
+    host_string = host->second.as_string();
+    path_string = path->second.as_string();
     version_string = "HTTP/1.1";
   }
 
@@ -177,22 +178,23 @@ int SpdySM::SpdyHandleNewStream(SpdyStreamId stream_id,
     *is_https_scheme = true;
   }
 
+  std::string method_string = method->second.as_string();
   if (acceptor_->flip_handler_type_ == FLIP_HANDLER_SPDY_SERVER) {
-    VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Request: " << method->second
+    VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Request: " << method_string
             << " " << path_string;
     std::string filename = EncodeURL(path_string,
                                      host_string,
-                                     method->second);
+                                     method_string);
     NewStream(stream_id, priority, filename);
   } else {
     http_data +=
-        method->second + " " + path_string + " " + version_string + "\r\n";
-    VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Request: " << method->second << " "
+        method_string + " " + path_string + " " + version_string + "\r\n";
+    VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Request: " << method_string << " "
             << path_string << " " << version_string;
     http_data += "Host: " + (*is_https_scheme ?
                              acceptor_->https_server_ip_ :
                              acceptor_->http_server_ip_) + "\r\n";
-    for (SpdyHeaderBlock::const_iterator i = headers.begin();
+    for (SpdyHeaderBlockView::const_iterator i = headers.begin();
          i != headers.end(); ++i) {
       if ((i->first.size() > 0 && i->first[0] == ':') ||
           i->first == "host" ||
@@ -204,9 +206,11 @@ int SpdySM::SpdyHandleNewStream(SpdyStreamId stream_id,
           i == url) {
         // Ignore the entry.
       } else {
-        http_data += i->first + ": " + i->second + "\r\n";
-        VLOG(2) << ACCEPTOR_CLIENT_IDENT << i->first.c_str() << ":"
-                << i->second.c_str();
+        i->first.AppendToString(&http_data);
+        http_data += ": ";
+        i->second.AppendToString(&http_data);
+        http_data += "\r\n";
+        VLOG(2) << ACCEPTOR_CLIENT_IDENT << i->first << ":" << i->second;
       }
     }
     if (forward_ip_header_.length()) {
@@ -246,6 +250,16 @@ void SpdySM::OnSynStream(SpdyStreamId stream_id,
                          bool fin,
                          bool unidirectional,
                          const SpdyHeaderBlock& headers) {
+  OnSynStreamView(stream_id, associated_stream_id, priority, fin,
+                  unidirectional, SpdyHeaderBlockView(headers));
+}
+
+void SpdySM::OnSynStreamView(SpdyStreamId stream_id,
+                             SpdyStreamId associated_stream_id,
+                             SpdyPriority priority,
+                             bool fin,
+                             bool unidirectional,
+                             const SpdyHeaderBlockView& headers) {
   std::string http_data;
   bool is_https_scheme;
   int ret = SpdyHandleNewStream(
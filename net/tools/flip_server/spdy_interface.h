@@ -57,7 +57,7 @@ class SpdySM : public BufferedSpdyFramerVisitorInterface, public SMInterface {
       const std::string& server_port);
   int SpdyHandleNewStream(SpdyStreamId stream_id,
                           SpdyPriority priority,
-                          const SpdyHeaderBlock& headers,
+                          const SpdyHeaderBlockView& headers,
                           std::string& http_data,
                           bool* is_https_scheme);
 
@@ -73,6 +73,14 @@ class SpdySM : public BufferedSpdyFramerVisitorInterface, public SMInterface {
                            bool unidirectional,
                            const SpdyHeaderBlock& headers) OVERRIDE;
 
+  // Handles SYN_STREAM headers without copying them out of the framer.
+  virtual void OnSynStreamView(SpdyStreamId stream_id,
+                               SpdyStreamId associated_stream_id,
+                               SpdyPriority priority,
+                               bool fin,
+                               bool unidirectional,
+                               const SpdyHeaderBlockView& headers) OVERRIDE;
+
   // Called after all the header data for SYN_REPLY control frame is received.
   virtual void OnSynReply(SpdyStreamId stream_id,
                           bool fin,
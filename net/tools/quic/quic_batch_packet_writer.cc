@@ -0,0 +1,114 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_batch_packet_writer.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "base/logging.h"
+
+namespace net {
+namespace tools {
+
+const size_t QuicBatchPacketWriter::kMaxBatchSize;
+
+QuicBatchPacketWriter::QuicBatchPacketWriter(int fd)
+    : fd_(fd),
+      write_blocked_(false),
+      packets_(new BufferedPacket[kMaxBatchSize]),
+      packet_count_(0) {}
+
+QuicBatchPacketWriter::~QuicBatchPacketWriter() {}
+
+WriteResult QuicBatchPacketWriter::WritePacket(
+    const char* buffer, size_t buf_len,
+    const net::IPAddressNumber& self_address,
+    const net::IPEndPoint& peer_address) {
+  const bool too_large = buf_len > kMaxPacketSize;
+  if (packet_count_ == kMaxBatchSize || too_large)
+    Flush();
+  if (too_large && packet_count_ == 0 && !write_blocked_) {
+    // Packets too large to buffer are sent right away, once the
+    // buffered ones are sent.
+    WriteResult result = QuicSocketUtils::WritePacket(
+        fd_, buffer, buf_len, self_address, peer_address);
+    if (result.status == WRITE_STATUS_BLOCKED)
+      write_blocked_ = true;
+    return result;
+  }
+  if (packet_count_ == kMaxBatchSize || too_large) {
+    DCHECK(write_blocked_);
+    return WriteResult(WRITE_STATUS_BLOCKED, EAGAIN);
+  }
+
+  BufferedPacket* packet = &packets_[packet_count_];
+  memcpy(packet->data, buffer, buf_len);
+  packet->length = buf_len;
+  packet->peer_address_length = sizeof(packet->peer_address);
+  CHECK(peer_address.ToSockAddr(
+      reinterpret_cast<struct sockaddr*>(&packet->peer_address),
+      &packet->peer_address_length));
+  msghdr hdr;
+  QuicSocketUtils::SetIpInfoInMsghdr(self_address, packet->cbuf, &hdr);
+  packet->cbuf_length = hdr.msg_controllen;
+  ++packet_count_;
+  return WriteResult(WRITE_STATUS_OK, buf_len);
+}
+
+bool QuicBatchPacketWriter::IsWriteBlockedDataBuffered() const {
+  return false;
+}
+
+bool QuicBatchPacketWriter::IsWriteBlocked() const {
+  return write_blocked_;
+}
+
+void QuicBatchPacketWriter::SetWritable() {
+  write_blocked_ = false;
+  Flush();
+}
+
+void QuicBatchPacketWriter::Flush() {
+  while (packet_count_ > 0 && !write_blocked_) {
+    iovec iovs[kMaxBatchSize];
+    mmsghdr messages[kMaxBatchSize];
+    memset(messages, 0, sizeof(messages));
+    for (size_t i = 0; i < packet_count_; ++i) {
+      BufferedPacket* packet = &packets_[i];
+      iovs[i].iov_base = packet->data;
+      iovs[i].iov_len = packet->length;
+      msghdr* hdr = &messages[i].msg_hdr;
+      hdr->msg_name = &packet->peer_address;
+      hdr->msg_namelen = packet->peer_address_length;
+      hdr->msg_iov = &iovs[i];
+      hdr->msg_iovlen = 1;
+      hdr->msg_control = packet->cbuf_length > 0 ? packet->cbuf : NULL;
+      hdr->msg_controllen = packet->cbuf_length;
+    }
+
+    int rc = sendmmsg(fd_, messages, packet_count_, 0);
+    if (rc > 0) {
+      RemoveFirstPackets(rc);
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      write_blocked_ = true;
+    } else {
+      // The first packet could not be sent. It has already been
+      // reported as written, so it is dropped, as if lost on the wire.
+      LOG(ERROR) << "Error writing packet: " << strerror(errno);
+      RemoveFirstPackets(1);
+    }
+  }
+}
+
+void QuicBatchPacketWriter::RemoveFirstPackets(size_t count) {
+  DCHECK_LE(count, packet_count_);
+  packet_count_ -= count;
+  memmove(&packets_[0], &packets_[count],
+          packet_count_ * sizeof(BufferedPacket));
+}
+
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,82 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+#define NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+
+#include <sys/socket.h>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/quic_packet_writer.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+namespace net {
+
+struct WriteResult;
+
+namespace tools {
+
+// Packet writer which buffers the packets written to it and sends them
+// with as few sendmmsg calls as possible when flushed, rather than with
+// one sendmsg call per packet. The owner must call Flush() once it is
+// done writing for a while, e.g. after each round of epoll callbacks.
+class QuicBatchPacketWriter : public QuicPacketWriter {
+ public:
+  // The number of packets buffered before they are flushed anyway.
+  static const size_t kMaxBatchSize = 16;
+
+  explicit QuicBatchPacketWriter(int fd);
+  virtual ~QuicBatchPacketWriter();
+
+  // QuicPacketWriter.
+  // Buffers the packet and reports it as written. If the buffer is
+  // full and can't be flushed because the socket is write blocked, the
+  // packet is not buffered and WRITE_STATUS_BLOCKED is returned.
+  virtual WriteResult WritePacket(
+      const char* buffer, size_t buf_len,
+      const net::IPAddressNumber& self_address,
+      const net::IPEndPoint& peer_address) OVERRIDE;
+  virtual bool IsWriteBlockedDataBuffered() const OVERRIDE;
+  virtual bool IsWriteBlocked() const OVERRIDE;
+  // Also flushes the buffered packets.
+  virtual void SetWritable() OVERRIDE;
+
+  // Sends the buffered packets. If the socket becomes write blocked,
+  // the remaining packets stay buffered until the next flush and
+  // IsWriteBlocked() returns true until SetWritable() is called.
+  void Flush();
+
+  size_t buffered_packet_count() const { return packet_count_; }
+
+ private:
+  // A buffered packet, along with what its mmsghdr points to.
+  struct BufferedPacket {
+    char data[kMaxPacketSize];
+    size_t length;
+    sockaddr_storage peer_address;
+    socklen_t peer_address_length;
+    char cbuf[kSpaceForIpInfo];
+    size_t cbuf_length;
+  };
+
+  // Removes the first |count| buffered packets.
+  void RemoveFirstPackets(size_t count);
+
+  int fd_;
+  bool write_blocked_;
+
+  // Holds kMaxBatchSize packets, the first |packet_count_| of which
+  // are buffered.
+  scoped_ptr<BufferedPacket[]> packets_;
+  size_t packet_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicBatchPacketWriter);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
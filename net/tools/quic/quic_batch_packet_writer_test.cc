@@ -0,0 +1,134 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_batch_packet_writer.h"
+
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/base/ip_endpoint.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using std::string;
+
+namespace net {
+namespace tools {
+namespace test {
+namespace {
+
+// Returns a non-blocking UDP socket bound to an ephemeral loopback port,
+// and fills in |address| with its address.
+int CreateBoundSocket(IPEndPoint* address) {
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  if (fd < 0)
+    return fd;
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sockaddr_storage storage;
+  socklen_t storage_length = sizeof(storage);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&storage),
+                  &storage_length) != 0 ||
+      !address->FromSockAddr(reinterpret_cast<sockaddr*>(&storage),
+                             storage_length)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+class QuicBatchPacketWriterTest : public ::testing::Test {
+ protected:
+  QuicBatchPacketWriterTest() {
+    write_fd_ = CreateBoundSocket(&write_address_);
+    read_fd_ = CreateBoundSocket(&read_address_);
+  }
+
+  virtual ~QuicBatchPacketWriterTest() {
+    close(write_fd_);
+    close(read_fd_);
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_LE(0, write_fd_);
+    ASSERT_LE(0, read_fd_);
+  }
+
+  // Returns the next packet received, or an empty string if none is.
+  string ReadPacket() {
+    char buffer[kMaxPacketSize];
+    ssize_t rc = recv(read_fd_, buffer, sizeof(buffer), 0);
+    return rc > 0 ? string(buffer, rc) : string();
+  }
+
+  int write_fd_;
+  int read_fd_;
+  IPEndPoint write_address_;
+  IPEndPoint read_address_;
+};
+
+TEST_F(QuicBatchPacketWriterTest, BuffersUntilFlush) {
+  QuicBatchPacketWriter writer(write_fd_);
+  for (int i = 0; i < 3; ++i) {
+    string packet = "packet " + base::IntToString(i);
+    WriteResult result = writer.WritePacket(
+        packet.data(), packet.size(), write_address_.address(),
+        read_address_);
+    EXPECT_EQ(WRITE_STATUS_OK, result.status);
+    EXPECT_EQ(static_cast<int>(packet.size()), result.bytes_written);
+  }
+  EXPECT_EQ(3u, writer.buffered_packet_count());
+  EXPECT_FALSE(writer.IsWriteBlocked());
+  EXPECT_EQ("", ReadPacket());
+
+  writer.Flush();
+  EXPECT_EQ(0u, writer.buffered_packet_count());
+  EXPECT_EQ("packet 0", ReadPacket());
+  EXPECT_EQ("packet 1", ReadPacket());
+  EXPECT_EQ("packet 2", ReadPacket());
+  EXPECT_EQ("", ReadPacket());
+}
+
+TEST_F(QuicBatchPacketWriterTest, FlushesFullBatch) {
+  QuicBatchPacketWriter writer(write_fd_);
+  const size_t kPacketCount = QuicBatchPacketWriter::kMaxBatchSize + 1;
+  for (size_t i = 0; i < kPacketCount; ++i) {
+    string packet = "packet " + base::Uint64ToString(i);
+    EXPECT_EQ(WRITE_STATUS_OK, writer.WritePacket(
+        packet.data(), packet.size(), IPAddressNumber(),
+        read_address_).status);
+  }
+  // The full batch was sent to make room for the last packet.
+  EXPECT_EQ(1u, writer.buffered_packet_count());
+  for (size_t i = 0; i < kPacketCount - 1; ++i)
+    EXPECT_EQ("packet " + base::Uint64ToString(i), ReadPacket());
+  EXPECT_EQ("", ReadPacket());
+
+  writer.Flush();
+  EXPECT_EQ("packet " + base::Uint64ToString(kPacketCount - 1),
+            ReadPacket());
+}
+
+TEST_F(QuicBatchPacketWriterTest, SetWritableFlushes) {
+  QuicBatchPacketWriter writer(write_fd_);
+  string packet = "packet";
+  writer.WritePacket(packet.data(), packet.size(), IPAddressNumber(),
+                     read_address_);
+  writer.SetWritable();
+  EXPECT_EQ(0u, writer.buffered_packet_count());
+  EXPECT_EQ("packet", ReadPacket());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace tools
+}  // namespace net
@@ -11,6 +11,7 @@
 #include "base/stl_util.h"
 #include "net/quic/quic_blocked_writer_interface.h"
 #include "net/quic/quic_utils.h"
+#include "net/tools/quic/quic_batch_packet_writer.h"
 #include "net/tools/quic/quic_default_packet_writer.h"
 #include "net/tools/quic/quic_epoll_connection_helper.h"
 #include "net/tools/quic/quic_packet_writer_wrapper.h"
@@ -140,6 +141,7 @@ QuicDispatcher::QuicDispatcher(const QuicConfig& config,
       delete_sessions_alarm_(new DeleteSessionsAlarm(this)),
       epoll_server_(epoll_server),
       helper_(new QuicEpollConnectionHelper(epoll_server_)),
+      batch_writer_(NULL),
       supported_versions_(supported_versions),
       current_packet_(NULL),
       framer_(supported_versions, /*unused*/ QuicTime::Zero(), true),
@@ -312,7 +314,12 @@ void QuicDispatcher::OnWriteBlocked(QuicBlockedWriterInterface* writer) {
 }
 
 QuicPacketWriter* QuicDispatcher::CreateWriter(int fd) {
+#if MMSG_MORE
+  batch_writer_ = new QuicBatchPacketWriter(fd);
+  return batch_writer_;
+#else
   return new QuicDefaultPacketWriter(fd);
+#endif
 }
 
 QuicPacketWriterWrapper* QuicDispatcher::CreateWriterWrapper(
@@ -342,6 +349,12 @@ QuicConnection* QuicDispatcher::CreateQuicConnection(
 
 void QuicDispatcher::set_writer(QuicPacketWriter* writer) {
   writer_->set_writer(writer);
+  batch_writer_ = NULL;
+}
+
+void QuicDispatcher::FlushWrites() {
+  if (batch_writer_)
+    batch_writer_->Flush();
 }
 
 bool QuicDispatcher::HandlePacketForTimeWait(
@@ -43,6 +43,7 @@ class QuicSession;
 
 namespace tools {
 
+class QuicBatchPacketWriter;
 class QuicPacketWriterWrapper;
 
 namespace test {
@@ -81,6 +82,9 @@ class QuicDispatcher : public QuicServerSessionVisitor {
   // Returns true if there's anything in the blocked writer list.
   virtual bool HasPendingWrites() const;
 
+  // Sends the packets the writer has buffered, if it buffers any.
+  void FlushWrites();
+
   // Sends ConnectionClose frames to all connected clients.
   void Shutdown();
 
@@ -193,6 +197,10 @@ class QuicDispatcher : public QuicServerSessionVisitor {
   // connections.
   scoped_ptr<QuicPacketWriterWrapper> writer_;
 
+  // The writer created by CreateWriter() if it batches writes, owned by
+  // |writer_|, or NULL once it has been replaced.
+  QuicBatchPacketWriter* batch_writer_;
+
   // This vector contains QUIC versions which we currently support.
   // This should be ordered such that the highest supported version is the first
   // element, with subsequent elements in descending order (versions can be
@@ -9,6 +9,7 @@
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "net/tools/balsa/balsa_headers.h"
+#include "net/tools/balsa/packed_response_cache.h"
 
 using base::FilePath;
 using base::StringPiece;
@@ -23,6 +24,10 @@ namespace tools {
 
 std::string FLAGS_quic_in_memory_cache_dir = "";
 
+// Specifies a file written by QuicInMemoryCache::WritePackedCache to map
+// instead of reading the cache directory.
+std::string FLAGS_quic_in_memory_cache_pack = "";
+
 namespace {
 
 // BalsaVisitor implementation (glue) which caches response bodies.
@@ -114,12 +119,53 @@ QuicInMemoryCache::QuicInMemoryCache() {
   Initialize();
 }
 
+bool QuicInMemoryCache::WritePackedCache(const FilePath& path) const {
+  PackedResponseCacheWriter writer;
+  if (!writer.Open(path)) {
+    return false;
+  }
+  for (ResponseMap::const_iterator it = responses_.begin();
+       it != responses_.end(); ++it) {
+    if (!writer.Add(it->first, it->second->headers(), it->second->body())) {
+      return false;
+    }
+  }
+  return writer.Finish();
+}
+
 void QuicInMemoryCache::ResetForTests() {
   STLDeleteValues(&responses_);
+  pack_.reset();
   Initialize();
 }
 
+void QuicInMemoryCache::InitializeFromPack() {
+  VLOG(1) << "Attempting to initialize QuicInMemoryCache from pack: "
+          << FLAGS_quic_in_memory_cache_pack;
+  pack_.reset(new PackedResponseCache());
+  if (!pack_->Open(FilePath(FLAGS_quic_in_memory_cache_pack))) {
+    LOG(DFATAL) << "Unable to load " << FLAGS_quic_in_memory_cache_pack;
+    pack_.reset();
+    return;
+  }
+  for (size_t i = 0; i < pack_->num_entries(); ++i) {
+    PackedResponseCache::Entry entry = pack_->GetEntry(i);
+    scoped_ptr<Response> response(new Response());
+    if (!PackedResponseCache::ParseHeaders(entry.headers,
+                                           &response->headers_)) {
+      LOG(DFATAL) << "Malformed headers for: " << entry.key;
+      continue;
+    }
+    response->set_unowned_body(entry.body);
+    responses_[entry.key.as_string()] = response.release();
+  }
+}
+
 void QuicInMemoryCache::Initialize() {
+  if (!FLAGS_quic_in_memory_cache_pack.empty()) {
+    InitializeFromPack();
+    return;
+  }
   // If there's no defined cache dir, we have no initialization to do.
   if (FLAGS_quic_in_memory_cache_dir.empty()) {
     VLOG(1) << "No cache directory found. Skipping initialization.";
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "base/containers/hash_tables.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
 #include "base/strings/string_piece.h"
 #include "net/tools/balsa/balsa_frame.h"
@@ -16,7 +17,14 @@
 
 template <typename T> struct DefaultSingletonTraits;
 
+namespace base {
+class FilePath;
+}  // namespace base
+
 namespace net {
+
+class PackedResponseCache;
+
 namespace tools {
 
 namespace test {
@@ -24,12 +32,15 @@ class QuicInMemoryCachePeer;
 }  // namespace
 
 extern std::string FLAGS_quic_in_memory_cache_dir;
+extern std::string FLAGS_quic_in_memory_cache_pack;
 
 class QuicServer;
 
 // In-memory cache for HTTP responses.
 // Reads from disk cache generated by:
 // `wget -p --save_headers <url>`
+// or maps a PackedResponseCache written by WritePackedCache(), and serves
+// the bodies from the mapping.
 class QuicInMemoryCache {
  public:
   // Container for response header/body pairs.
@@ -39,7 +50,7 @@ class QuicInMemoryCache {
     ~Response() {}
 
     const BalsaHeaders& headers() const { return headers_; }
-    const base::StringPiece body() const { return base::StringPiece(body_); }
+    const base::StringPiece body() const { return body_; }
 
    private:
     friend class QuicInMemoryCache;
@@ -48,11 +59,18 @@ class QuicInMemoryCache {
       headers_.CopyFrom(headers);
     }
     void set_body(base::StringPiece body) {
-      body.CopyToString(&body_);
+      body.CopyToString(&body_storage_);
+      body_ = body_storage_;
+    }
+    // Sets the body without copying it.  |body| must outlive the response.
+    void set_unowned_body(base::StringPiece body) {
+      body_storage_.clear();
+      body_ = body;
     }
 
     BalsaHeaders headers_;
-    std::string body_;
+    base::StringPiece body_;
+    std::string body_storage_;
 
     DISALLOW_COPY_AND_ASSIGN(Response);
   };
@@ -79,6 +97,10 @@ class QuicInMemoryCache {
                    const BalsaHeaders& response_headers,
                    base::StringPiece response_body);
 
+  // Writes all the responses to a file which can be loaded with
+  // --quic_in_memory_cache_pack.  Returns false on an error.
+  bool WritePackedCache(const base::FilePath& path) const;
+
  private:
   typedef base::hash_map<std::string, Response*> ResponseMap;
   friend struct DefaultSingletonTraits<QuicInMemoryCache>;
@@ -91,11 +113,18 @@ class QuicInMemoryCache {
 
   void Initialize();
 
+  // Loads the responses from FLAGS_quic_in_memory_cache_pack.
+  void InitializeFromPack();
+
   std::string GetKey(const BalsaHeaders& response_headers) const;
 
   // Cached responses.
   ResponseMap responses_;
 
+  // The packed cache the response bodies point into, if it was loaded from
+  // one.
+  scoped_ptr<PackedResponseCache> pack_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicInMemoryCache);
 };
 
@@ -0,0 +1,313 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_multi_threaded_server.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
+#include "net/base/net_util.h"
+#include "net/quic/crypto/crypto_handshake.h"
+#include "net/quic/crypto/quic_random.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/quic_epoll_clock.h"
+#include "net/tools/quic/quic_in_memory_cache.h"
+#include "net/tools/quic/quic_packet_reader.h"
+#include "net/tools/quic/quic_server.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+using std::string;
+
+namespace net {
+namespace tools {
+
+namespace {
+
+const int kEpollFlags = EPOLLIN | EPOLLOUT | EPOLLET;
+const char kSourceAddressTokenSecret[] = "secret";
+
+}  // namespace
+
+// Runs the epoll server, socket and dispatcher of one shard.
+class QuicMultiThreadedServer::Worker : public base::SimpleThread,
+                                        public EpollCallbackInterface {
+ public:
+  Worker(QuicMultiThreadedServer* server, size_t shard)
+      : base::SimpleThread("QuicServerWorker" + base::Uint64ToString(shard)),
+        server_(server),
+        shard_(shard),
+        fd_(-1),
+        port_(0),
+        packets_dropped_(0),
+        overflow_supported_(false),
+        quit_(true, false) {
+    epoll_server_.set_timeout_in_us(50 * 1000);
+#if MMSG_MORE
+    packet_reader_.reset(new QuicPacketReader());
+#endif
+  }
+
+  virtual ~Worker() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  // Creates the socket of the shard, bound with SO_REUSEPORT, and its
+  // dispatcher.  Must be called before the thread is started.
+  bool Listen(const IPEndPoint& address) {
+    fd_ = QuicSocketUtils::CreateUdpSocket(address, true,
+                                           &overflow_supported_);
+    if (fd_ < 0) {
+      return false;
+    }
+    port_ = address.port();
+    if (port_ == 0) {
+      SockaddrStorage storage;
+      IPEndPoint server_address;
+      if (getsockname(fd_, storage.addr, &storage.addr_len) != 0 ||
+          !server_address.FromSockAddr(storage.addr, storage.addr_len)) {
+        LOG(ERROR) << "Unable to get self address.  Error: "
+                   << strerror(errno);
+        return false;
+      }
+      port_ = server_address.port();
+    }
+
+    epoll_server_.RegisterFD(fd_, this, kEpollFlags);
+    dispatcher_.reset(new QuicShardedDispatcher(
+        server_->config_, server_->crypto_config_,
+        server_->supported_versions_, &epoll_server_, shard_,
+        &server_->owner_map_, server_));
+    dispatcher_->Initialize(fd_);
+    return true;
+  }
+
+  // Queues a packet handed over by another shard, and wakes the thread up
+  // to process it.  May be called on any thread.
+  void AddForwardedPacket(const IPEndPoint& server_address,
+                          const IPEndPoint& client_address,
+                          const QuicEncryptedPacket& packet) {
+    {
+      base::AutoLock lock(forwarded_packets_lock_);
+      forwarded_packets_.push_back(ForwardedPacket());
+      ForwardedPacket* forwarded = &forwarded_packets_.back();
+      forwarded->server_address = server_address;
+      forwarded->client_address = client_address;
+      packet.AsStringPiece().CopyToString(&forwarded->data);
+    }
+    epoll_server_.Wake();
+  }
+
+  // Makes the thread shut its dispatcher down and exit.
+  void Quit() {
+    quit_.Signal();
+    epoll_server_.Wake();
+  }
+
+  int port() const { return port_; }
+
+  // base::SimpleThread:
+  virtual void Run() OVERRIDE {
+    while (!quit_.IsSignaled()) {
+      epoll_server_.WaitForEventsAndExecuteCallbacks();
+      ProcessForwardedPackets();
+      // Send what the callbacks, alarms and forwarded packets wrote, in as
+      // few syscalls as possible.
+      dispatcher_->FlushWrites();
+    }
+    dispatcher_->Shutdown();
+    dispatcher_->FlushWrites();
+    epoll_server_.UnregisterFD(fd_);
+    close(fd_);
+    fd_ = -1;
+  }
+
+  // EpollCallbackInterface:
+  virtual void OnRegistration(EpollServer* eps,
+                              int fd,
+                              int event_mask) OVERRIDE {}
+  virtual void OnModification(int fd, int event_mask) OVERRIDE {}
+  virtual void OnEvent(int fd, EpollEvent* event) OVERRIDE {
+    DCHECK_EQ(fd, fd_);
+    event->out_ready_mask = 0;
+
+    if (event->in_events & EPOLLIN) {
+      bool read = true;
+      while (read) {
+        uint32* packets_dropped =
+            overflow_supported_ ? &packets_dropped_ : NULL;
+        if (packet_reader_.get()) {
+          read = packet_reader_->ReadAndDispatchPackets(
+              fd_, port_, dispatcher_.get(), packets_dropped);
+        } else {
+          read = QuicServer::ReadAndDispatchSinglePacket(
+              fd_, port_, dispatcher_.get(), packets_dropped);
+        }
+      }
+    }
+    if (event->in_events & EPOLLOUT) {
+      dispatcher_->OnCanWrite();
+      if (dispatcher_->HasPendingWrites()) {
+        event->out_ready_mask |= EPOLLOUT;
+      }
+    }
+  }
+  virtual void OnUnregistration(int fd, bool replaced) OVERRIDE {}
+  virtual void OnShutdown(EpollServer* eps, int fd) OVERRIDE {}
+
+ private:
+  struct ForwardedPacket {
+    IPEndPoint server_address;
+    IPEndPoint client_address;
+    string data;
+  };
+
+  void ProcessForwardedPackets() {
+    std::vector<ForwardedPacket> packets;
+    {
+      base::AutoLock lock(forwarded_packets_lock_);
+      packets.swap(forwarded_packets_);
+    }
+    for (size_t i = 0; i < packets.size(); ++i) {
+      QuicEncryptedPacket packet(packets[i].data.data(),
+                                 packets[i].data.size(), false);
+      dispatcher_->ProcessPacket(packets[i].server_address,
+                                 packets[i].client_address, packet);
+    }
+  }
+
+  QuicMultiThreadedServer* server_;
+  const size_t shard_;
+
+  // Must outlive |epoll_server_|'s shutdown.
+  scoped_ptr<QuicShardedDispatcher> dispatcher_;
+  EpollServer epoll_server_;
+
+  // Listening connection.  Also used for outbound client communication.
+  int fd_;
+  int port_;
+
+  uint32 packets_dropped_;
+  bool overflow_supported_;
+
+  // Reads packets with recvmmsg, if it is available.
+  scoped_ptr<QuicPacketReader> packet_reader_;
+
+  // The packets handed over by the other shards, not yet processed.
+  base::Lock forwarded_packets_lock_;
+  std::vector<ForwardedPacket> forwarded_packets_;
+
+  base::WaitableEvent quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+QuicMultiThreadedServer::QuicMultiThreadedServer(size_t num_threads)
+    : num_threads_(num_threads),
+      port_(0),
+      crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance()),
+      supported_versions_(QuicSupportedVersions()) {
+  // Use hardcoded crypto parameters for now.
+  config_.SetDefaults();
+  config_.set_initial_round_trip_time_us(kMaxInitialRoundTripTimeUs, 0);
+  config_.set_server_initial_congestion_window(kMaxInitialWindow,
+                                               kDefaultInitialWindow);
+  Initialize();
+}
+
+QuicMultiThreadedServer::QuicMultiThreadedServer(
+    const QuicConfig& config,
+    const QuicVersionVector& supported_versions,
+    size_t num_threads)
+    : num_threads_(num_threads),
+      port_(0),
+      config_(config),
+      crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance()),
+      supported_versions_(supported_versions) {
+  Initialize();
+}
+
+QuicMultiThreadedServer::~QuicMultiThreadedServer() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    DCHECK(!workers_[i]->HasBeenStarted() || workers_[i]->HasBeenJoined())
+        << "Shutdown() must be called before deleting a started server.";
+  }
+}
+
+void QuicMultiThreadedServer::Initialize() {
+  DCHECK_GT(num_threads_, 0u);
+  // Initialize the in memory cache now, before the threads share it.
+  QuicInMemoryCache::GetInstance();
+
+  EpollServer epoll_server;
+  QuicEpollClock clock(&epoll_server);
+
+  scoped_ptr<CryptoHandshakeMessage> scfg(
+      crypto_config_.AddDefaultConfig(
+          QuicRandom::GetInstance(), &clock,
+          QuicCryptoServerConfig::ConfigOptions()));
+}
+
+bool QuicMultiThreadedServer::Listen(const IPEndPoint& address) {
+  DCHECK(workers_.empty());
+  // The first socket picks the port if none is specified, and the others
+  // share it.
+  IPEndPoint shard_address = address;
+  for (size_t i = 0; i < num_threads_; ++i) {
+    scoped_ptr<Worker> worker(new Worker(this, i));
+    if (!worker->Listen(shard_address)) {
+      workers_.clear();
+      return false;
+    }
+    if (i == 0) {
+      port_ = worker->port();
+      shard_address = IPEndPoint(address.address(), port_);
+    }
+    workers_.push_back(worker.release());
+  }
+  DVLOG(1) << "Listening on " << shard_address.ToString() << " with "
+           << num_threads_ << " threads";
+  return true;
+}
+
+void QuicMultiThreadedServer::Start() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Start();
+  }
+}
+
+void QuicMultiThreadedServer::Shutdown() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Quit();
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i]->HasBeenStarted()) {
+      workers_[i]->Join();
+    }
+  }
+}
+
+void QuicMultiThreadedServer::ForwardPacket(size_t shard,
+                                            const IPEndPoint& server_address,
+                                            const IPEndPoint& client_address,
+                                            const QuicEncryptedPacket& packet) {
+  DCHECK_LT(shard, workers_.size());
+  workers_[shard]->AddForwardedPacket(server_address, client_address, packet);
+}
+
+}  // namespace tools
+}  // namespace net
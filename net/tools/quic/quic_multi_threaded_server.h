@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A toy server like QuicServer, which handles QUIC traffic on several
+// threads.  Each thread has its own socket, bound to the same address with
+// SO_REUSEPORT, its own epoll server and its own dispatcher, and so its own
+// time wait list.  The kernel spreads incoming packets among the sockets by
+// client address, and packets for a connection which reach a thread other
+// than the one owning the connection are handed over to the owner.
+
+#ifndef NET_TOOLS_QUIC_QUIC_MULTI_THREADED_SERVER_H_
+#define NET_TOOLS_QUIC_QUIC_MULTI_THREADED_SERVER_H_
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/crypto/quic_crypto_server_config.h"
+#include "net/quic/quic_config.h"
+#include "net/quic/quic_protocol.h"
+#include "net/tools/quic/quic_sharded_dispatcher.h"
+
+namespace net {
+namespace tools {
+
+class QuicMultiThreadedServer : public QuicShardedDispatcher::PacketForwarder {
+ public:
+  explicit QuicMultiThreadedServer(size_t num_threads);
+  QuicMultiThreadedServer(const QuicConfig& config,
+                          const QuicVersionVector& supported_versions,
+                          size_t num_threads);
+
+  virtual ~QuicMultiThreadedServer();
+
+  // Creates the sockets for all the threads, listening on the specified
+  // address.  Must be called before Start().
+  bool Listen(const IPEndPoint& address);
+
+  // Starts handling events on the threads.
+  void Start();
+
+  // Gives all active sessions a chance to notify clients that they're closing,
+  // and stops the threads.
+  void Shutdown();
+
+  // QuicShardedDispatcher::PacketForwarder implementation.  May be called on
+  // any of the threads.
+  virtual void ForwardPacket(size_t shard,
+                             const IPEndPoint& server_address,
+                             const IPEndPoint& client_address,
+                             const QuicEncryptedPacket& packet) OVERRIDE;
+
+  void SetStrikeRegisterNoStartupPeriod() {
+    crypto_config_.set_strike_register_no_startup_period();
+  }
+
+  size_t num_threads() const { return num_threads_; }
+
+  int port() const { return port_; }
+
+ private:
+  class Worker;
+
+  // Initialize the state shared by the threads.
+  void Initialize();
+
+  const size_t num_threads_;
+
+  // The port the server is listening on.
+  int port_;
+
+  // config_ contains non-crypto parameters that are negotiated in the crypto
+  // handshake.
+  QuicConfig config_;
+  // crypto_config_ contains crypto parameters for the handshake.  It is
+  // shared by the threads, so that clients can resume their handshakes on
+  // any of them.
+  QuicCryptoServerConfig crypto_config_;
+
+  // This vector contains QUIC versions which we currently support.
+  // This should be ordered such that the highest supported version is the first
+  // element, with subsequent elements in descending order (versions can be
+  // skipped as necessary).
+  QuicVersionVector supported_versions_;
+
+  // Which thread owns each connection.
+  QuicGuidOwnerMap owner_map_;
+
+  // One per thread, indexed by shard.
+  ScopedVector<Worker> workers_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicMultiThreadedServer);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_MULTI_THREADED_SERVER_H_
@@ -0,0 +1,82 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_packet_reader.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "base/logging.h"
+#include "net/base/ip_endpoint.h"
+#include "net/tools/quic/quic_dispatcher.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+namespace net {
+namespace tools {
+
+const size_t QuicPacketReader::kNumPacketsPerReadMmsgCall;
+
+QuicPacketReader::QuicPacketReader() {
+  SetupMessages();
+}
+
+QuicPacketReader::~QuicPacketReader() {}
+
+void QuicPacketReader::SetupMessages() {
+  for (size_t i = 0; i < kNumPacketsPerReadMmsgCall; ++i) {
+    packets_[i].iov.iov_base = packets_[i].buf;
+    packets_[i].iov.iov_len = sizeof(packets_[i].buf);
+    memset(&packets_[i].raw_address, 0, sizeof(packets_[i].raw_address));
+    memset(packets_[i].cbuf, 0, sizeof(packets_[i].cbuf));
+
+    msghdr* hdr = &mmsg_hdrs_[i].msg_hdr;
+    hdr->msg_name = &packets_[i].raw_address;
+    hdr->msg_namelen = sizeof(sockaddr_storage);
+    hdr->msg_iov = &packets_[i].iov;
+    hdr->msg_iovlen = 1;
+    hdr->msg_control = packets_[i].cbuf;
+    hdr->msg_controllen = sizeof(packets_[i].cbuf);
+    hdr->msg_flags = 0;
+    mmsg_hdrs_[i].msg_len = 0;
+  }
+}
+
+bool QuicPacketReader::ReadAndDispatchPackets(int fd,
+                                              int port,
+                                              QuicDispatcher* dispatcher,
+                                              uint32* packets_dropped) {
+  // The kernel overwrites the lengths of the names and control data, so
+  // they have to be reset before each call.
+  SetupMessages();
+
+  int packets_read = recvmmsg(fd, mmsg_hdrs_, kNumPacketsPerReadMmsgCall,
+                              0, NULL);
+  if (packets_read <= 0) {
+    if (packets_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+      LOG(ERROR) << "Error reading " << strerror(errno);
+    return false;  // We failed to read.
+  }
+
+  for (int i = 0; i < packets_read; ++i) {
+    msghdr* hdr = &mmsg_hdrs_[i].msg_hdr;
+    if (mmsg_hdrs_[i].msg_len == 0 || hdr->msg_namelen == 0)
+      continue;
+
+    if (packets_dropped != NULL)
+      QuicSocketUtils::GetOverflowFromMsghdr(hdr, packets_dropped);
+
+    IPEndPoint client_address;
+    QuicSocketUtils::GetPeerAddressFromMsghdr(hdr, &client_address);
+    IPAddressNumber server_ip = QuicSocketUtils::GetAddressFromMsghdr(hdr);
+
+    QuicEncryptedPacket packet(packets_[i].buf, mmsg_hdrs_[i].msg_len, false);
+    IPEndPoint server_address(server_ip, port);
+    dispatcher->ProcessPacket(server_address, client_address, packet);
+  }
+  return true;
+}
+
+}  // namespace tools
+}  // namespace net
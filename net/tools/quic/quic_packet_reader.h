@@ -0,0 +1,64 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
+#define NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "base/basictypes.h"
+#include "net/quic/quic_protocol.h"
+
+namespace net {
+namespace tools {
+
+class QuicDispatcher;
+
+// Reads packets with recvmmsg, several per call, and hands them to a
+// QuicDispatcher. Holds the buffers the packets are read into, so that
+// reading doesn't allocate.
+class QuicPacketReader {
+ public:
+  // The number of packets read per recvmmsg call.
+  static const size_t kNumPacketsPerReadMmsgCall = 16;
+
+  QuicPacketReader();
+  ~QuicPacketReader();
+
+  // Reads a batch of packets from the given fd, and then passes them off
+  // to the QuicDispatcher.  Returns true if any packets were read, false
+  // otherwise.
+  // If packets_dropped is non-null, the socket is configured to track
+  // dropped packets, and some packets are read, it will be set to the number of
+  // dropped packets.
+  bool ReadAndDispatchPackets(int fd, int port, QuicDispatcher* dispatcher,
+                              uint32* packets_dropped);
+
+ private:
+  // The storage of a packet and of what its mmsghdr points to.
+  struct PacketData {
+    iovec iov;
+    sockaddr_storage raw_address;
+    // Extra space so that we can send an error if the client goes over
+    // the limit.
+    char buf[2 * kMaxPacketSize];
+    // The ancillary data holds the overflow count and the address the
+    // packet was sent to.
+    char cbuf[CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(in6_pktinfo))];
+  };
+
+  // Prepares the mmsghdrs for the next recvmmsg call.
+  void SetupMessages();
+
+  PacketData packets_[kNumPacketsPerReadMmsgCall];
+  mmsghdr mmsg_hdrs_[kNumPacketsPerReadMmsgCall];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketReader);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
@@ -19,14 +19,9 @@
 #include "net/quic/quic_data_reader.h"
 #include "net/quic/quic_protocol.h"
 #include "net/tools/quic/quic_in_memory_cache.h"
+#include "net/tools/quic/quic_packet_reader.h"
 #include "net/tools/quic/quic_socket_utils.h"
 
-#define MMSG_MORE 0
-
-#ifndef SO_RXQ_OVFL
-#define SO_RXQ_OVFL 40
-#endif
-
 const int kEpollFlags = EPOLLIN | EPOLLOUT | EPOLLET;
 static const char kSourceAddressTokenSecret[] = "secret";
 
@@ -65,6 +60,7 @@ QuicServer::QuicServer(const QuicConfig& config,
 void QuicServer::Initialize() {
 #if MMSG_MORE
   use_recvmmsg_ = true;
+  packet_reader_.reset(new QuicPacketReader());
 #endif
   epoll_server_.set_timeout_in_us(50 * 1000);
   // Initialize the in memory cache now.
@@ -83,53 +79,9 @@ QuicServer::~QuicServer() {
 
 bool QuicServer::Listen(const IPEndPoint& address) {
   port_ = address.port();
-  int address_family = address.GetSockAddrFamily();
-  fd_ = socket(address_family, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  fd_ = QuicSocketUtils::CreateUdpSocket(address, false,
+                                         &overflow_supported_);
   if (fd_ < 0) {
-    LOG(ERROR) << "CreateSocket() failed: " << strerror(errno);
-    return false;
-  }
-
-  int rc = QuicSocketUtils::SetGetAddressInfo(fd_, address_family);
-
-  if (rc < 0) {
-    LOG(ERROR) << "IP detection not supported" << strerror(errno);
-    return false;
-  }
-
-  int get_overflow = 1;
-  rc = setsockopt(
-      fd_, SOL_SOCKET, SO_RXQ_OVFL, &get_overflow, sizeof(get_overflow));
-
-  if (rc < 0) {
-    DLOG(WARNING) << "Socket overflow detection not supported";
-  } else {
-    overflow_supported_ = true;
-  }
-
-  // Enable the socket option that allows the local address to be
-  // returned if the socket is bound to more than on address.
-  int get_local_ip = 1;
-  rc = setsockopt(fd_, IPPROTO_IP, IP_PKTINFO,
-                  &get_local_ip, sizeof(get_local_ip));
-  if (rc == 0 && address_family == AF_INET6) {
-    rc = setsockopt(fd_, IPPROTO_IPV6, IPV6_RECVPKTINFO,
-                    &get_local_ip, sizeof(get_local_ip));
-  }
-  if (rc != 0) {
-    LOG(ERROR) << "Failed to set required socket options";
-    return false;
-  }
-
-  sockaddr_storage raw_addr;
-  socklen_t raw_addr_len = sizeof(raw_addr);
-  CHECK(address.ToSockAddr(reinterpret_cast<sockaddr*>(&raw_addr),
-                           &raw_addr_len));
-  rc = bind(fd_,
-            reinterpret_cast<const sockaddr*>(&raw_addr),
-            sizeof(raw_addr));
-  if (rc < 0) {
-    LOG(ERROR) << "Bind failed: " << strerror(errno);
     return false;
   }
 
@@ -156,12 +108,16 @@ bool QuicServer::Listen(const IPEndPoint& address) {
 
 void QuicServer::WaitForEvents() {
   epoll_server_.WaitForEventsAndExecuteCallbacks();
+  // Send what the callbacks and alarms wrote, in as few syscalls as
+  // possible.
+  dispatcher_->FlushWrites();
 }
 
 void QuicServer::Shutdown() {
   // Before we shut down the epoll server, give all active sessions a chance to
   // notify clients that they're closing.
   dispatcher_->Shutdown();
+  dispatcher_->FlushWrites();
 
   close(fd_);
   fd_ = -1;
@@ -175,9 +131,15 @@ void QuicServer::OnEvent(int fd, EpollEvent* event) {
     DVLOG(1) << "EPOLLIN";
     bool read = true;
     while (read) {
+      uint32* packets_dropped =
+          overflow_supported_ ? &packets_dropped_ : NULL;
+      if (use_recvmmsg_) {
+        read = packet_reader_->ReadAndDispatchPackets(
+            fd_, port_, dispatcher_.get(), packets_dropped);
+      } else {
         read = ReadAndDispatchSinglePacket(
-            fd_, port_, dispatcher_.get(),
-            overflow_supported_ ? &packets_dropped_ : NULL);
+            fd_, port_, dispatcher_.get(), packets_dropped);
+      }
     }
   }
   if (event->in_events & EPOLLOUT) {
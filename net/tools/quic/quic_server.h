@@ -26,6 +26,7 @@ class QuicServerPeer;
 }  // namespace test
 
 class QuicDispatcher;
+class QuicPacketReader;
 
 class QuicServer : public EpollCallbackInterface {
  public:
@@ -103,6 +104,9 @@ class QuicServer : public EpollCallbackInterface {
   // If true, use recvmmsg for reading.
   bool use_recvmmsg_;
 
+  // Reads packets with recvmmsg if |use_recvmmsg_| is true.
+  scoped_ptr<QuicPacketReader> packet_reader_;
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   QuicConfig config_;
@@ -10,16 +10,24 @@
 #include "base/at_exit.h"
 #include "base/basictypes.h"
 #include "base/command_line.h"
+#include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
 #include "net/base/ip_endpoint.h"
 #include "net/tools/quic/quic_in_memory_cache.h"
+#include "net/tools/quic/quic_multi_threaded_server.h"
 #include "net/tools/quic/quic_server.h"
 
 // The port the quic server will listen on.
 
 int32 FLAGS_port = 6121;
 
+// The number of threads handling QUIC traffic, each with its own socket.
+
+int32 FLAGS_num_threads = 1;
+
 int main(int argc, char *argv[]) {
   CommandLine::Init(argc, argv);
   CommandLine* line = CommandLine::ForCurrentProcess();
@@ -35,8 +43,15 @@ int main(int argc, char *argv[]) {
         "Options:\n"
         "-h, --help                  show this help message and exit\n"
         "--port=<port>               specify the port to listen on\n"
+        "--num_threads=<n>           handle traffic on n threads, sharing\n"
+        "                            the port with SO_REUSEPORT\n"
         "--quic_in_memory_cache_dir  directory containing response data\n"
-        "                            to load\n";
+        "                            to load\n"
+        "--quic_in_memory_cache_pack=<file>\n"
+        "                            map responses from a pack file instead\n"
+        "--write_quic_in_memory_cache_pack=<file>\n"
+        "                            write the loaded responses to a pack\n"
+        "                            file and exit\n";
     std::cout << help_str;
     exit(0);
   }
@@ -46,6 +61,11 @@ int main(int argc, char *argv[]) {
         line->GetSwitchValueASCII("quic_in_memory_cache_dir");
   }
 
+  if (line->HasSwitch("quic_in_memory_cache_pack")) {
+    net::tools::FLAGS_quic_in_memory_cache_pack =
+        line->GetSwitchValueASCII("quic_in_memory_cache_pack");
+  }
+
   if (line->HasSwitch("port")) {
     int port;
     if (base::StringToInt(line->GetSwitchValueASCII("port"), &port)) {
@@ -53,11 +73,41 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (line->HasSwitch("num_threads")) {
+    int num_threads;
+    if (base::StringToInt(line->GetSwitchValueASCII("num_threads"),
+                          &num_threads) && num_threads > 0) {
+      FLAGS_num_threads = num_threads;
+    }
+  }
+
   base::AtExitManager exit_manager;
 
+  if (line->HasSwitch("write_quic_in_memory_cache_pack")) {
+    base::FilePath pack_path =
+        line->GetSwitchValuePath("write_quic_in_memory_cache_pack");
+    if (!net::tools::QuicInMemoryCache::GetInstance()->WritePackedCache(
+            pack_path)) {
+      LOG(ERROR) << "Unable to write " << pack_path.value();
+      return 1;
+    }
+    return 0;
+  }
+
   net::IPAddressNumber ip;
   CHECK(net::ParseIPLiteralToNumber("::", &ip));
 
+  if (FLAGS_num_threads > 1) {
+    net::tools::QuicMultiThreadedServer server(FLAGS_num_threads);
+    if (!server.Listen(net::IPEndPoint(ip, FLAGS_port))) {
+      return 1;
+    }
+    server.Start();
+    while (1) {
+      base::PlatformThread::Sleep(base::TimeDelta::FromSeconds(1));
+    }
+  }
+
   net::tools::QuicServer server;
 
   if (!server.Listen(net::IPEndPoint(ip, FLAGS_port))) {
@@ -0,0 +1,92 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_sharded_dispatcher.h"
+
+#include "base/logging.h"
+#include "net/tools/quic/quic_time_wait_list_manager.h"
+
+using std::make_pair;
+
+namespace net {
+namespace tools {
+
+const size_t QuicGuidOwnerMap::kNoOwner = static_cast<size_t>(-1);
+
+QuicGuidOwnerMap::QuicGuidOwnerMap() {}
+
+QuicGuidOwnerMap::~QuicGuidOwnerMap() {}
+
+size_t QuicGuidOwnerMap::GetOwner(QuicGuid guid) const {
+  base::AutoLock lock(lock_);
+  OwnerMap::const_iterator it = owners_.find(guid);
+  return it == owners_.end() ? kNoOwner : it->second;
+}
+
+size_t QuicGuidOwnerMap::ClaimOwner(QuicGuid guid, size_t shard) {
+  DCHECK_NE(kNoOwner, shard);
+  base::AutoLock lock(lock_);
+  return owners_.insert(make_pair(guid, shard)).first->second;
+}
+
+void QuicGuidOwnerMap::ReleaseOwner(QuicGuid guid, size_t shard) {
+  base::AutoLock lock(lock_);
+  OwnerMap::iterator it = owners_.find(guid);
+  if (it != owners_.end() && it->second == shard) {
+    owners_.erase(it);
+  }
+}
+
+QuicShardedDispatcher::QuicShardedDispatcher(
+    const QuicConfig& config,
+    const QuicCryptoServerConfig& crypto_config,
+    const QuicVersionVector& supported_versions,
+    EpollServer* epoll_server,
+    size_t shard,
+    QuicGuidOwnerMap* owner_map,
+    PacketForwarder* forwarder)
+    : QuicDispatcher(config, crypto_config, supported_versions, epoll_server),
+      shard_(shard),
+      owner_map_(owner_map),
+      forwarder_(forwarder) {
+}
+
+QuicShardedDispatcher::~QuicShardedDispatcher() {}
+
+void QuicShardedDispatcher::OnConnectionClosed(QuicGuid guid,
+                                               QuicErrorCode error) {
+  QuicDispatcher::OnConnectionClosed(guid, error);
+  owner_map_->ReleaseOwner(guid, shard_);
+}
+
+bool QuicShardedDispatcher::OnUnauthenticatedPublicHeader(
+    const QuicPacketPublicHeader& header) {
+  QuicGuid guid = header.guid;
+  if (session_map().find(guid) != session_map().end() ||
+      time_wait_list_manager()->IsGuidInTimeWait(guid)) {
+    return QuicDispatcher::OnUnauthenticatedPublicHeader(header);
+  }
+
+  // Only the packets which may create a session claim the connection, so
+  // that stray packets don't take ownership away from the shard its clients
+  // will be sending to.
+  const bool claim = header.version_flag && !header.reset_flag;
+  size_t owner = claim ? owner_map_->ClaimOwner(guid, shard_) :
+      owner_map_->GetOwner(guid);
+  if (owner != QuicGuidOwnerMap::kNoOwner && owner != shard_) {
+    DVLOG(1) << "Forwarding packet for " << guid << " to shard " << owner;
+    forwarder_->ForwardPacket(owner, current_server_address(),
+                              current_client_address(), current_packet());
+    return false;
+  }
+
+  bool result = QuicDispatcher::OnUnauthenticatedPublicHeader(header);
+  if (claim && session_map().find(guid) == session_map().end()) {
+    owner_map_->ReleaseOwner(guid, shard_);
+  }
+  return result;
+}
+
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,103 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A dispatcher for one of several threads sharing a server port, which hands
+// the packets of connections owned by other threads over to them.
+
+#ifndef NET_TOOLS_QUIC_QUIC_SHARDED_DISPATCHER_H_
+#define NET_TOOLS_QUIC_QUIC_SHARDED_DISPATCHER_H_
+
+#include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
+#include "base/synchronization/lock.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/quic_protocol.h"
+#include "net/tools/quic/quic_dispatcher.h"
+
+namespace net {
+namespace tools {
+
+// Records which shard owns each connection.  A connection is owned by the
+// shard which created its session, for as long as the session is open.
+// Thread safe.
+class QuicGuidOwnerMap {
+ public:
+  // Returned when no shard owns a connection.
+  static const size_t kNoOwner;
+
+  QuicGuidOwnerMap();
+  ~QuicGuidOwnerMap();
+
+  // Returns the shard owning |guid|, or kNoOwner.
+  size_t GetOwner(QuicGuid guid) const;
+
+  // Makes |shard| the owner of |guid| unless another shard already owns it,
+  // and returns the owner.
+  size_t ClaimOwner(QuicGuid guid, size_t shard);
+
+  // Removes the ownership of |guid| by |shard|, if it owns it.
+  void ReleaseOwner(QuicGuid guid, size_t shard);
+
+ private:
+  typedef base::hash_map<QuicGuid, size_t> OwnerMap;
+
+  mutable base::Lock lock_;
+  OwnerMap owners_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicGuidOwnerMap);
+};
+
+class QuicShardedDispatcher : public QuicDispatcher {
+ public:
+  // Hands packets over to the thread of another shard.
+  class PacketForwarder {
+   public:
+    virtual ~PacketForwarder() {}
+
+    // Called when a packet for a connection owned by |shard| arrived on
+    // another shard's socket, e.g. because the client's address changed.
+    // |packet| is only valid for the duration of the call.
+    virtual void ForwardPacket(size_t shard,
+                               const IPEndPoint& server_address,
+                               const IPEndPoint& client_address,
+                               const QuicEncryptedPacket& packet) = 0;
+  };
+
+  // |owner_map| and |forwarder| are shared between the shards and must
+  // outlive the dispatcher.
+  QuicShardedDispatcher(const QuicConfig& config,
+                        const QuicCryptoServerConfig& crypto_config,
+                        const QuicVersionVector& supported_versions,
+                        EpollServer* epoll_server,
+                        size_t shard,
+                        QuicGuidOwnerMap* owner_map,
+                        PacketForwarder* forwarder);
+
+  virtual ~QuicShardedDispatcher();
+
+  // QuicServerSessionVisitor interface implementation:
+  // Also gives up the ownership of the connection.
+  virtual void OnConnectionClosed(QuicGuid guid, QuicErrorCode error) OVERRIDE;
+
+  size_t shard() const { return shard_; }
+
+ protected:
+  // QuicDispatcher:
+  // Forwards the packet if its connection is owned by another shard, and
+  // claims the connection before a session is created for it.
+  virtual bool OnUnauthenticatedPublicHeader(
+      const QuicPacketPublicHeader& header) OVERRIDE;
+
+ private:
+  const size_t shard_;
+  QuicGuidOwnerMap* owner_map_;
+  PacketForwarder* forwarder_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicShardedDispatcher);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_SHARDED_DISPATCHER_H_
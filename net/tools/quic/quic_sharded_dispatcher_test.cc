@@ -0,0 +1,179 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_sharded_dispatcher.h"
+
+#include <string>
+
+#include "net/quic/crypto/quic_crypto_server_config.h"
+#include "net/quic/crypto/quic_random.h"
+#include "net/quic/quic_utils.h"
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/test_tools/quic_test_utils.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using net::test::MockSession;
+using std::string;
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+using testing::WithoutArgs;
+
+namespace net {
+namespace tools {
+namespace test {
+namespace {
+
+const size_t kShard = 0;
+const size_t kOtherShard = 1;
+
+class MockPacketForwarder : public QuicShardedDispatcher::PacketForwarder {
+ public:
+  MOCK_METHOD4(ForwardPacket, void(size_t shard,
+                                   const IPEndPoint& server_address,
+                                   const IPEndPoint& client_address,
+                                   const QuicEncryptedPacket& packet));
+};
+
+class TestShardedDispatcher : public QuicShardedDispatcher {
+ public:
+  TestShardedDispatcher(const QuicConfig& config,
+                        const QuicCryptoServerConfig& crypto_config,
+                        EpollServer* eps,
+                        QuicGuidOwnerMap* owner_map,
+                        PacketForwarder* forwarder)
+      : QuicShardedDispatcher(config, crypto_config, QuicSupportedVersions(),
+                              eps, kShard, owner_map, forwarder) {
+  }
+
+  MOCK_METHOD3(CreateQuicSession, QuicSession*(
+      QuicGuid guid,
+      const IPEndPoint& server_address,
+      const IPEndPoint& client_address));
+};
+
+// A connection which unregisters the session from the dispatcher when
+// sending connection close.
+class MockServerConnection : public MockConnection {
+ public:
+  MockServerConnection(QuicGuid guid, QuicDispatcher* dispatcher)
+      : MockConnection(guid, true),
+        dispatcher_(dispatcher) {}
+
+  void UnregisterOnConnectionClosed() {
+    dispatcher_->OnConnectionClosed(guid(), QUIC_NO_ERROR);
+  }
+
+ private:
+  QuicDispatcher* dispatcher_;
+};
+
+class QuicShardedDispatcherTest : public ::testing::Test {
+ public:
+  QuicShardedDispatcherTest()
+      : crypto_config_(QuicCryptoServerConfig::TESTING,
+                       QuicRandom::GetInstance()),
+        dispatcher_(config_, crypto_config_, &eps_, &owner_map_, &forwarder_),
+        client_address_(net::test::Loopback4(), 1) {
+    dispatcher_.Initialize(1);
+  }
+
+  QuicSession* CreateSession(QuicGuid guid) {
+    MockServerConnection* connection =
+        new MockServerConnection(guid, &dispatcher_);
+    MockSession* session = new MockSession(connection);
+    ON_CALL(*connection, SendConnectionClose(_)).WillByDefault(
+        WithoutArgs(Invoke(
+            connection, &MockServerConnection::UnregisterOnConnectionClosed)));
+    EXPECT_CALL(*connection, ProcessUdpPacket(_, client_address_, _));
+    return session;
+  }
+
+  void ProcessPacket(QuicGuid guid, bool version_flag) {
+    QuicPacketHeader header;
+    header.public_header.guid = guid;
+    header.public_header.guid_length = PACKET_8BYTE_GUID;
+    header.public_header.version_flag = version_flag;
+    header.public_header.reset_flag = false;
+    header.public_header.sequence_number_length = PACKET_6BYTE_SEQUENCE_NUMBER;
+    header.packet_sequence_number = 1;
+    header.entropy_flag = false;
+    header.entropy_hash = 0;
+    header.fec_flag = false;
+    header.is_in_fec_group = NOT_IN_FEC_GROUP;
+    header.fec_group = 0;
+    QuicStreamFrame stream_frame(1, false, 0, MakeIOVector("foo"));
+    QuicFrames frames;
+    frames.push_back(QuicFrame(&stream_frame));
+    QuicFramer framer(QuicSupportedVersions(), QuicTime::Zero(), false);
+    scoped_ptr<QuicPacket> packet(
+        framer.BuildUnsizedDataPacket(header, frames).packet);
+    ASSERT_TRUE(packet != NULL);
+    scoped_ptr<QuicEncryptedPacket> encrypted(
+        framer.EncryptPacket(ENCRYPTION_NONE, 1, *packet));
+    ASSERT_TRUE(encrypted != NULL);
+    dispatcher_.ProcessPacket(IPEndPoint(), client_address_, *encrypted);
+  }
+
+ protected:
+  EpollServer eps_;
+  QuicConfig config_;
+  QuicCryptoServerConfig crypto_config_;
+  QuicGuidOwnerMap owner_map_;
+  MockPacketForwarder forwarder_;
+  TestShardedDispatcher dispatcher_;
+  IPEndPoint client_address_;
+};
+
+TEST(QuicGuidOwnerMapTest, ClaimAndRelease) {
+  QuicGuidOwnerMap owner_map;
+  EXPECT_EQ(QuicGuidOwnerMap::kNoOwner, owner_map.GetOwner(1));
+
+  EXPECT_EQ(kShard, owner_map.ClaimOwner(1, kShard));
+  EXPECT_EQ(kShard, owner_map.ClaimOwner(1, kOtherShard));
+  EXPECT_EQ(kShard, owner_map.GetOwner(1));
+
+  // Only the owner gives up the ownership.
+  owner_map.ReleaseOwner(1, kOtherShard);
+  EXPECT_EQ(kShard, owner_map.GetOwner(1));
+  owner_map.ReleaseOwner(1, kShard);
+  EXPECT_EQ(QuicGuidOwnerMap::kNoOwner, owner_map.GetOwner(1));
+}
+
+TEST_F(QuicShardedDispatcherTest, NewSessionClaimsConnection) {
+  EXPECT_CALL(forwarder_, ForwardPacket(_, _, _, _)).Times(0);
+  EXPECT_CALL(dispatcher_, CreateQuicSession(1, _, client_address_))
+      .WillOnce(Return(CreateSession(1)));
+  ProcessPacket(1, true);
+  EXPECT_EQ(kShard, owner_map_.GetOwner(1));
+
+  // Closing the session gives up the ownership.
+  dispatcher_.Shutdown();
+  EXPECT_EQ(QuicGuidOwnerMap::kNoOwner, owner_map_.GetOwner(1));
+}
+
+TEST_F(QuicShardedDispatcherTest, ForwardsPacketsOfOtherShards) {
+  owner_map_.ClaimOwner(1, kOtherShard);
+
+  EXPECT_CALL(dispatcher_, CreateQuicSession(_, _, _)).Times(0);
+  EXPECT_CALL(forwarder_, ForwardPacket(kOtherShard, _, client_address_, _))
+      .Times(2);
+  ProcessPacket(1, true);
+  ProcessPacket(1, false);
+  EXPECT_EQ(kOtherShard, owner_map_.GetOwner(1));
+}
+
+TEST_F(QuicShardedDispatcherTest, StrayPacketDoesNotClaimConnection) {
+  EXPECT_CALL(dispatcher_, CreateQuicSession(_, _, _)).Times(0);
+  EXPECT_CALL(forwarder_, ForwardPacket(_, _, _, _)).Times(0);
+  ProcessPacket(1, false);
+  EXPECT_EQ(QuicGuidOwnerMap::kNoOwner, owner_map_.GetOwner(1));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace tools
+}  // namespace net
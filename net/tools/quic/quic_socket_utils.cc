@@ -9,6 +9,7 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <unistd.h>
 #include <string>
 
 #include "base/basictypes.h"
@@ -19,6 +20,10 @@
 #define SO_RXQ_OVFL 40
 #endif
 
+#ifndef SO_REUSEPORT
+#define SO_REUSEPORT 15
+#endif
+
 namespace net {
 namespace tools {
 
@@ -79,6 +84,127 @@ int QuicSocketUtils::SetGetAddressInfo(int fd, int address_family) {
   }
 }
 
+// static
+int QuicSocketUtils::CreateUdpSocket(const IPEndPoint& address,
+                                     bool reuse_port,
+                                     bool* overflow_supported) {
+  int address_family = address.GetSockAddrFamily();
+  int fd = socket(address_family, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  if (fd < 0) {
+    LOG(ERROR) << "CreateSocket() failed: " << strerror(errno);
+    return -1;
+  }
+
+  int rc = SetGetAddressInfo(fd, address_family);
+
+  if (rc < 0) {
+    LOG(ERROR) << "IP detection not supported" << strerror(errno);
+    close(fd);
+    return -1;
+  }
+
+  int get_overflow = 1;
+  rc = setsockopt(
+      fd, SOL_SOCKET, SO_RXQ_OVFL, &get_overflow, sizeof(get_overflow));
+
+  if (rc < 0) {
+    DLOG(WARNING) << "Socket overflow detection not supported";
+    *overflow_supported = false;
+  } else {
+    *overflow_supported = true;
+  }
+
+  // Enable the socket option that allows the local address to be
+  // returned if the socket is bound to more than on address.
+  int get_local_ip = 1;
+  rc = setsockopt(fd, IPPROTO_IP, IP_PKTINFO,
+                  &get_local_ip, sizeof(get_local_ip));
+  if (rc == 0 && address_family == AF_INET6) {
+    rc = setsockopt(fd, IPPROTO_IPV6, IPV6_RECVPKTINFO,
+                    &get_local_ip, sizeof(get_local_ip));
+  }
+  if (rc != 0) {
+    LOG(ERROR) << "Failed to set required socket options";
+    close(fd);
+    return -1;
+  }
+
+  if (reuse_port) {
+    int reuse = 1;
+    rc = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+    if (rc != 0) {
+      LOG(ERROR) << "SO_REUSEPORT not supported: " << strerror(errno);
+      close(fd);
+      return -1;
+    }
+  }
+
+  sockaddr_storage raw_addr;
+  socklen_t raw_addr_len = sizeof(raw_addr);
+  CHECK(address.ToSockAddr(reinterpret_cast<sockaddr*>(&raw_addr),
+                           &raw_addr_len));
+  rc = bind(fd,
+            reinterpret_cast<const sockaddr*>(&raw_addr),
+            sizeof(raw_addr));
+  if (rc < 0) {
+    LOG(ERROR) << "Bind failed: " << strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// static
+void QuicSocketUtils::GetPeerAddressFromMsghdr(struct msghdr* hdr,
+                                               IPEndPoint* peer_address) {
+  const sockaddr_storage* raw_address =
+      reinterpret_cast<const sockaddr_storage*>(hdr->msg_name);
+  if (raw_address->ss_family == AF_INET) {
+    CHECK(peer_address->FromSockAddr(
+        reinterpret_cast<const sockaddr*>(raw_address),
+        sizeof(struct sockaddr_in)));
+  } else if (raw_address->ss_family == AF_INET6) {
+    CHECK(peer_address->FromSockAddr(
+        reinterpret_cast<const sockaddr*>(raw_address),
+        sizeof(struct sockaddr_in6)));
+  }
+}
+
+// static
+void QuicSocketUtils::SetIpInfoInMsghdr(const IPAddressNumber& self_address,
+                                        char* cbuf,
+                                        struct msghdr* hdr) {
+  if (self_address.empty()) {
+    hdr->msg_control = 0;
+    hdr->msg_controllen = 0;
+  } else if (GetAddressFamily(self_address) == ADDRESS_FAMILY_IPV4) {
+    hdr->msg_control = cbuf;
+    hdr->msg_controllen = kSpaceForIpInfo;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+
+    cmsg->cmsg_len = CMSG_LEN(sizeof(in_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_PKTINFO;
+    in_pktinfo* pktinfo = reinterpret_cast<in_pktinfo*>(CMSG_DATA(cmsg));
+    memset(pktinfo, 0, sizeof(in_pktinfo));
+    pktinfo->ipi_ifindex = 0;
+    memcpy(&pktinfo->ipi_spec_dst, &self_address[0], self_address.size());
+    hdr->msg_controllen = cmsg->cmsg_len;
+  } else {
+    hdr->msg_control = cbuf;
+    hdr->msg_controllen = kSpaceForIpInfo;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+
+    cmsg->cmsg_len = CMSG_LEN(sizeof(in6_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type = IPV6_PKTINFO;
+    in6_pktinfo* pktinfo = reinterpret_cast<in6_pktinfo*>(CMSG_DATA(cmsg));
+    memset(pktinfo, 0, sizeof(in6_pktinfo));
+    memcpy(&pktinfo->ipi6_addr, &self_address[0], self_address.size());
+    hdr->msg_controllen = cmsg->cmsg_len;
+  }
+}
+
 // static
 int QuicSocketUtils::ReadPacket(int fd, char* buffer, size_t buf_len,
                                 uint32* dropped_packets,
@@ -123,15 +249,7 @@ int QuicSocketUtils::ReadPacket(int fd, char* buffer, size_t buf_len,
     *self_address = QuicSocketUtils::GetAddressFromMsghdr(&hdr);
   }
 
-  if (raw_address.ss_family == AF_INET) {
-    CHECK(peer_address->FromSockAddr(
-        reinterpret_cast<const sockaddr*>(&raw_address),
-        sizeof(struct sockaddr_in)));
-  } else if (raw_address.ss_family == AF_INET6) {
-    CHECK(peer_address->FromSockAddr(
-        reinterpret_cast<const sockaddr*>(&raw_address),
-        sizeof(struct sockaddr_in6)));
-  }
+  GetPeerAddressFromMsghdr(&hdr, peer_address);
 
   return bytes_read;
 }
@@ -156,41 +274,8 @@ WriteResult QuicSocketUtils::WritePacket(int fd,
   hdr.msg_iovlen = 1;
   hdr.msg_flags = 0;
 
-  const int kSpaceForIpv4 = CMSG_SPACE(sizeof(in_pktinfo));
-  const int kSpaceForIpv6 = CMSG_SPACE(sizeof(in6_pktinfo));
-  // kSpaceForIp should be big enough to hold both IPv4 and IPv6 packet info.
-  const int kSpaceForIp =
-      (kSpaceForIpv4 < kSpaceForIpv6) ? kSpaceForIpv6 : kSpaceForIpv4;
-  char cbuf[kSpaceForIp];
-  if (self_address.empty()) {
-    hdr.msg_control = 0;
-    hdr.msg_controllen = 0;
-  } else if (GetAddressFamily(self_address) == ADDRESS_FAMILY_IPV4) {
-    hdr.msg_control = cbuf;
-    hdr.msg_controllen = kSpaceForIp;
-    cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
-
-    cmsg->cmsg_len = CMSG_LEN(sizeof(in_pktinfo));
-    cmsg->cmsg_level = IPPROTO_IP;
-    cmsg->cmsg_type = IP_PKTINFO;
-    in_pktinfo* pktinfo = reinterpret_cast<in_pktinfo*>(CMSG_DATA(cmsg));
-    memset(pktinfo, 0, sizeof(in_pktinfo));
-    pktinfo->ipi_ifindex = 0;
-    memcpy(&pktinfo->ipi_spec_dst, &self_address[0], self_address.size());
-    hdr.msg_controllen = cmsg->cmsg_len;
-  } else {
-    hdr.msg_control = cbuf;
-    hdr.msg_controllen = kSpaceForIp;
-    cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
-
-    cmsg->cmsg_len = CMSG_LEN(sizeof(in6_pktinfo));
-    cmsg->cmsg_level = IPPROTO_IPV6;
-    cmsg->cmsg_type = IPV6_PKTINFO;
-    in6_pktinfo* pktinfo = reinterpret_cast<in6_pktinfo*>(CMSG_DATA(cmsg));
-    memset(pktinfo, 0, sizeof(in6_pktinfo));
-    memcpy(&pktinfo->ipi6_addr, &self_address[0], self_address.size());
-    hdr.msg_controllen = cmsg->cmsg_len;
-  }
+  char cbuf[kSpaceForIpInfo];
+  SetIpInfoInMsghdr(self_address, cbuf, &hdr);
 
   int rc = sendmsg(fd, &hdr, 0);
   if (rc >= 0) {
@@ -7,6 +7,8 @@
 #ifndef NET_TOOLS_QUIC_QUIC_SOCKET_UTILS_H_
 #define NET_TOOLS_QUIC_QUIC_SOCKET_UTILS_H_
 
+#include <features.h>
+#include <netinet/in.h>
 #include <stddef.h>
 #include <sys/socket.h>
 #include <string>
@@ -14,9 +16,22 @@
 #include "net/base/ip_endpoint.h"
 #include "net/quic/quic_protocol.h"
 
+// Whether recvmmsg() and sendmmsg() are available, which they are from
+// glibc 2.14 on.
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 14))
+#define MMSG_MORE 1
+#else
+#define MMSG_MORE 0
+#endif
+
 namespace net {
 namespace tools {
 
+// The size of the ancillary data needed to hold either IP_PKTINFO or
+// IPV6_PKTINFO, the latter being the larger.
+const size_t kSpaceForIpInfo = CMSG_SPACE(sizeof(in6_pktinfo));
+
 class QuicSocketUtils {
  public:
   // If the msghdr contains IP_PKTINFO or IPV6_PKTINFO, this will return the
@@ -29,10 +44,33 @@ class QuicSocketUtils {
   static bool GetOverflowFromMsghdr(struct msghdr *hdr,
                                     uint32 *dropped_packets);
 
+  // Sets peer_address to the address recvmsg or recvmmsg stored in
+  // the msg_name of the msghdr.
+  static void GetPeerAddressFromMsghdr(struct msghdr* hdr,
+                                       IPEndPoint* peer_address);
+
+  // Sets the msg_control of the msghdr to an IP_PKTINFO or IPV6_PKTINFO
+  // entry for self_address, built in cbuf, which must hold
+  // kSpaceForIpInfo bytes.  If self_address is empty, clears msg_control
+  // instead.
+  static void SetIpInfoInMsghdr(const IPAddressNumber& self_address,
+                                char* cbuf,
+                                struct msghdr* hdr);
+
   // Sets either IP_PKTINFO or IPV6_PKTINFO on the socket, based on
   // address_family.  Returns the return code from setsockopt.
   static int SetGetAddressInfo(int fd, int address_family);
 
+  // Creates a non-blocking UDP socket bound to address, which reports the
+  // address packets were sent to and, if the kernel supports it, the number
+  // of packets dropped.  If reuse_port is true, the socket is bound with
+  // SO_REUSEPORT, so that several sockets can share address and the kernel
+  // spreads incoming packets among them.  Returns the socket, or -1 on
+  // failure.  overflow_supported is set to whether SO_RXQ_OVFL was set.
+  static int CreateUdpSocket(const IPEndPoint& address,
+                             bool reuse_port,
+                             bool* overflow_supported);
+
   // Reads buf_len from the socket.  If reading is successful, returns bytes
   // read and sets peer_address to the peer address.  Otherwise returns -1.
   //
@@ -548,14 +548,17 @@ void URLFetcherCore::StartURLRequest() {
         request_->set_upload(make_scoped_ptr(
             UploadDataStream::CreateWithReader(reader.Pass(), 0)));
       } else if (!upload_file_path_.empty()) {
-        scoped_ptr<UploadElementReader> reader(
+        scoped_ptr<UploadFileElementReader> reader(
             new UploadFileElementReader(upload_file_task_runner_.get(),
                                         upload_file_path_,
                                         upload_range_offset_,
                                         upload_range_length_,
                                         base::Time()));
+        reader->set_read_ahead_size(
+            UploadFileElementReader::kDefaultReadAheadSize);
         request_->set_upload(make_scoped_ptr(
-            UploadDataStream::CreateWithReader(reader.Pass(), 0)));
+            UploadDataStream::CreateWithReader(
+                reader.PassAs<UploadElementReader>(), 0)));
       }
 
       current_upload_bytes_ = -1;
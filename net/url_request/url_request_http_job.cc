@@ -500,9 +500,12 @@ void URLRequestHttpJob::AddExtraHeaders() {
       request_info_.extra_headers.SetHeader(
           HttpRequestHeaders::kAcceptEncoding, "gzip,deflate");
     } else {
-      // Include SDCH in acceptable list.
+      // Include SDCH in acceptable list, and x-dictionary-deflate when there
+      // is a dictionary for it to use.
       request_info_.extra_headers.SetHeader(
-          HttpRequestHeaders::kAcceptEncoding, "gzip,deflate,sdch");
+          HttpRequestHeaders::kAcceptEncoding,
+          avail_dictionaries.empty() ? "gzip,deflate,sdch"
+                                     : "gzip,deflate,sdch,x-dictionary-deflate");
       if (!avail_dictionaries.empty()) {
         request_info_.extra_headers.SetHeader(
             kAvailDictionaryHeader,
@@ -0,0 +1,126 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how many URLRequests per second the HTTP stack can complete end to
+// end, from URLRequest down to the socket, when the network itself costs
+// nothing.  Sockets are mocked, so the numbers reflect the overhead of the
+// request, job, cache, transaction, stream and socket pool layers.
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "base/time/time.h"
+#include "net/base/load_flags.h"
+#include "net/base/load_timing_info.h"
+#include "net/socket/socket_test_util.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+const int kNumRequests = 1000;
+const int kBodySize = 4096;
+
+class URLRequestPerfTest : public testing::Test {
+ protected:
+  URLRequestPerfTest() : context_(true) {
+    context_.set_client_socket_factory(&socket_factory_);
+    context_.Init();
+  }
+
+  // Returns an HTTP/1.1 response with a |kBodySize| byte body.
+  static std::string MakeResponse(bool keep_alive) {
+    return base::StringPrintf(
+        "HTTP/1.1 200 OK\r\n"
+        "Connection: %s\r\n"
+        "Content-Length: %d\r\n"
+        "\r\n",
+        keep_alive ? "keep-alive" : "close", kBodySize) +
+        std::string(kBodySize, 'x');
+  }
+
+  // Serves every request on its own connection.
+  void AddOneSocketPerRequest(const std::string& response) {
+    reads_.assign(1, MockRead(ASYNC, response.data(), response.size()));
+    for (int i = 0; i < kNumRequests; ++i) {
+      StaticSocketDataProvider* data =
+          new StaticSocketDataProvider(&reads_[0], reads_.size(), NULL, 0);
+      socket_data_.push_back(data);
+      socket_factory_.AddSocketDataProvider(data);
+    }
+  }
+
+  // Serves all requests on a single kept-alive connection.
+  void AddSharedSocket(const std::string& response) {
+    reads_.assign(kNumRequests,
+                  MockRead(ASYNC, response.data(), response.size()));
+    StaticSocketDataProvider* data =
+        new StaticSocketDataProvider(&reads_[0], reads_.size(), NULL, 0);
+    socket_data_.push_back(data);
+    socket_factory_.AddSocketDataProvider(data);
+  }
+
+  // Runs |kNumRequests| requests one after the other and reports the total
+  // time and the mean time to first byte under |name|.
+  void RunRequests(const std::string& name) {
+    GURL url("http://www.example.org/");
+    base::TimeDelta total_ttfb;
+    base::PerfTimeLogger timer(name.c_str());
+    for (int i = 0; i < kNumRequests; ++i) {
+      TestDelegate delegate;
+      URLRequest request(url, DEFAULT_PRIORITY, &delegate, &context_);
+      request.SetLoadFlags(LOAD_DISABLE_CACHE);
+      request.Start();
+      base::RunLoop().Run();
+      ASSERT_TRUE(request.status().is_success());
+      ASSERT_EQ(kBodySize, delegate.bytes_received());
+
+      LoadTimingInfo load_timing_info;
+      request.GetLoadTimingInfo(&load_timing_info);
+      total_ttfb += load_timing_info.receive_headers_end -
+                    load_timing_info.request_start;
+    }
+    timer.Done();
+
+    double mean_ttfb_us =
+        static_cast<double>(total_ttfb.InMicroseconds()) / kNumRequests;
+    perf_test::PrintResult("time_to_first_byte", "", name, mean_ttfb_us, "us",
+                           true);
+  }
+
+  base::MessageLoopForIO message_loop_;
+  MockClientSocketFactory socket_factory_;
+  std::vector<MockRead> reads_;
+  ScopedVector<StaticSocketDataProvider> socket_data_;
+  // Declared last so that the idle sockets it owns go away before their data.
+  TestURLRequestContext context_;
+};
+
+}  // namespace
+
+TEST_F(URLRequestPerfTest, HttpNewConnections) {
+  std::string response = MakeResponse(false);
+  AddOneSocketPerRequest(response);
+  RunRequests(base::StringPrintf("URLRequest_Http_NewConnection%d",
+                                 kNumRequests));
+}
+
+TEST_F(URLRequestPerfTest, HttpKeepAlive) {
+  std::string response = MakeResponse(true);
+  AddSharedSocket(response);
+  RunRequests(base::StringPrintf("URLRequest_Http_KeepAlive%d",
+                                 kNumRequests));
+}
+
+}  // namespace net
@@ -4,6 +4,8 @@
 
 #include "remoting/codec/video_encoder_vpx.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/sys_info.h"
@@ -29,6 +31,31 @@ namespace {
 // map for the encoder.
 const int kMacroBlockSize = 16;
 
+// Frames with more pixels than this, like those of 4K desktops, are encoded
+// with more than two threads.
+const int kLargeFramePixels = 1920 * 1200;
+
+// Maximum number of threads used to encode large frames.
+const int kMaxEncoderThreads = 4;
+
+// Returns the number of threads to encode frames of |size| with.
+int GetEncoderThreadCount(const webrtc::DesktopSize& size) {
+  // Using 2 threads gives a great boost in performance for most systems with
+  // adequate processing power. NB: Going to multiple threads on low end
+  // windows systems can really hurt performance.
+  // http://crbug.com/99179
+  int processors = base::SysInfo::NumberOfProcessors();
+  if (processors <= 2)
+    return 1;
+  if (size.width() * size.height() <= kLargeFramePixels)
+    return 2;
+
+  // Large frames keep two threads busy at low frame rates.  Spread their
+  // macroblock rows over half of the cores, leaving the rest for capturing
+  // and sending.
+  return std::max(2, std::min(processors / 2, kMaxEncoderThreads));
+}
+
 ScopedVpxCodec CreateVP8Codec(const webrtc::DesktopSize& size) {
   ScopedVpxCodec codec(new vpx_codec_ctx_t);
 
@@ -51,11 +78,7 @@ ScopedVpxCodec CreateVP8Codec(const webrtc::DesktopSize& size) {
   // encoding.
   config.g_profile = 2;
 
-  // Using 2 threads gives a great boost in performance for most systems with
-  // adequate processing power. NB: Going to multiple threads on low end
-  // windows systems can really hurt performance.
-  // http://crbug.com/99179
-  config.g_threads = (base::SysInfo::NumberOfProcessors() > 2) ? 2 : 1;
+  config.g_threads = GetEncoderThreadCount(size);
   config.rc_min_quantizer = 20;
   config.rc_max_quantizer = 30;
   config.g_timebase.num = 1;
@@ -74,6 +97,14 @@ ScopedVpxCodec CreateVP8Codec(const webrtc::DesktopSize& size) {
   if (vpx_codec_control(codec.get(), VP8E_SET_NOISE_SENSITIVITY, 0))
     return ScopedVpxCodec();
 
+  // Split the tokens of large frames into partitions, so that they are packed,
+  // and later decoded, in parallel.
+  if (config.g_threads > 2 &&
+      vpx_codec_control(codec.get(), VP8E_SET_TOKEN_PARTITIONS,
+                        VP8_FOUR_TOKENPARTITION)) {
+    return ScopedVpxCodec();
+  }
+
   return codec.Pass();
 }
 
@@ -47,6 +47,22 @@ TEST(VideoEncoderVpxTest, TestSizeChangeNoLeak) {
   EXPECT_TRUE(packet);
 }
 
+// Test that frames large enough to be encoded with more threads, and token
+// partitions, are encoded.
+TEST(VideoEncoderVpxTest, TestLargeFrame) {
+  scoped_ptr<VideoEncoderVpx> encoder(VideoEncoderVpx::CreateForVP8());
+
+  scoped_ptr<webrtc::DesktopFrame> frame(
+      new webrtc::BasicDesktopFrame(webrtc::DesktopSize(3840, 2160)));
+  frame->mutable_updated_region()->SetRect(
+      webrtc::DesktopRect::MakeXYWH(1000, 1000, 200, 100));
+  scoped_ptr<VideoPacket> packet = encoder->Encode(*frame);
+  ASSERT_TRUE(packet);
+  EXPECT_EQ(3840, packet->format().screen_width());
+  EXPECT_EQ(2160, packet->format().screen_height());
+  EXPECT_EQ(1, packet->dirty_rects_size());
+}
+
 // Test that the DPI information is correctly propagated from the
 // media::ScreenCaptureData to the VideoPacket.
 TEST(VideoEncoderVpxTest, TestDpiPropagation) {
@@ -84,4 +84,22 @@ TEST(CaptureSchedulerTest, RollingAverageDifferentTimes) {
   }
 }
 
+// Verifies that frames are captured no faster than they are sent.
+TEST(CaptureSchedulerTest, SendTimeLimitsCaptureRate) {
+  const int kSendTimes[] = { 100, 300, 20, 20, 20 };
+  const int kTestResults[] = { 100, 200, 140, 113, 50 };
+
+  CaptureScheduler scheduler;
+  scheduler.SetNumOfProcessorsForTest(2);
+  scheduler.set_minimum_interval(
+      base::TimeDelta::FromMilliseconds(kMinumumFrameIntervalMs));
+  scheduler.RecordCaptureTime(base::TimeDelta::FromMilliseconds(10));
+  scheduler.RecordEncodeTime(base::TimeDelta::FromMilliseconds(10));
+  for (size_t i = 0; i < arraysize(kSendTimes); ++i) {
+    scheduler.RecordSendTime(base::TimeDelta::FromMilliseconds(kSendTimes[i]));
+    EXPECT_EQ(kTestResults[i], scheduler.NextCaptureDelay().InMilliseconds())
+        << i;
+  }
+}
+
 }  // namespace remoting
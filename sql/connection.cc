@@ -6,12 +6,19 @@
 
 #include <string.h>
 
+#include <algorithm>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
 #include "base/files/file_path.h"
 #include "base/file_util.h"
+#include "base/format_macros.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
 #include "base/metrics/sparse_histogram.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
@@ -145,6 +152,60 @@ int GetSqlite3File(sqlite3* db, sqlite3_file** file) {
 
 namespace sql {
 
+// Checkpoints the write-ahead log of a database file through a sqlite handle
+// of its own, on the connection's checkpoint task runner.
+class Connection::WalCheckpointer
+    : public base::RefCountedThreadSafe<Connection::WalCheckpointer> {
+ public:
+  explicit WalCheckpointer(const std::string& file_name)
+      : file_name_(file_name),
+        pending_(0) {
+  }
+
+  // Posts a checkpoint to |task_runner| unless one is already pending.
+  void Schedule(base::SequencedTaskRunner* task_runner) {
+    if (base::subtle::Acquire_CompareAndSwap(&pending_, 0, 1) != 0)
+      return;
+    task_runner->PostTask(FROM_HERE,
+                          base::Bind(&WalCheckpointer::Checkpoint, this));
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<WalCheckpointer>;
+
+  ~WalCheckpointer() {}
+
+  void Checkpoint() {
+    // Clear |pending_| first, so that a commit which grows the log while the
+    // checkpoint runs schedules another one.
+    base::subtle::Release_Store(&pending_, 0);
+
+    // A passive checkpoint copies what it can without waiting on readers or
+    // the writer.  Opening without SQLITE_OPEN_CREATE keeps a database which
+    // was deleted in the meantime from being recreated.  The handle only
+    // notices that the database uses the log once it has read from it.
+    sqlite3* db = NULL;
+    int rc = sqlite3_open_v2(file_name_.c_str(), &db, SQLITE_OPEN_READWRITE,
+                             NULL);
+    if (rc == SQLITE_OK) {
+      rc = sqlite3_exec(db, "SELECT COUNT(*) FROM sqlite_master",
+                        NULL, NULL, NULL);
+    }
+    if (rc == SQLITE_OK) {
+      rc = sqlite3_wal_checkpoint_v2(db, NULL, SQLITE_CHECKPOINT_PASSIVE,
+                                     NULL, NULL);
+    }
+    sqlite3_close(db);
+    if (rc != SQLITE_OK)
+      UMA_HISTOGRAM_SPARSE_SLOWLY("Sqlite.WalCheckpointFailure", rc);
+  }
+
+  const std::string file_name_;
+  base::subtle::Atomic32 pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(WalCheckpointer);
+};
+
 // static
 Connection::ErrorIgnorerCallback* Connection::current_ignorer_cb_ = NULL;
 
@@ -173,12 +234,30 @@ bool StatementID::operator<(const StatementID& other) const {
   return strcmp(str_, other.str_) < 0;
 }
 
+std::string StatementID::ToString() const {
+  if (number_ == -1)
+    return str_;
+  return base::StringPrintf("%s:%d", str_, number_);
+}
+
+StatementStats::StatementStats()
+    : cache_hit_count(0),
+      prepare_count(0),
+      eviction_count(0),
+      step_count(0),
+      row_count(0) {
+}
+
+StatementStats::~StatementStats() {
+}
+
 Connection::StatementRef::StatementRef(Connection* connection,
                                        sqlite3_stmt* stmt,
                                        bool was_valid)
     : connection_(connection),
       stmt_(stmt),
-      was_valid_(was_valid) {
+      was_valid_(was_valid),
+      stats_(NULL) {
   if (connection)
     connection_->StatementRefCreated(this);
 }
@@ -203,6 +282,7 @@ void Connection::StatementRef::Close(bool forced) {
     stmt_ = NULL;
   }
   connection_ = NULL;  // The connection may be getting deleted.
+  stats_ = NULL;  // Owned by the connection.
 
   // Forced close is expected to happen from a statement error
   // handler.  In that case maintain the sense of |was_valid_| which
@@ -216,6 +296,13 @@ Connection::Connection()
       cache_size_(0),
       exclusive_locking_(false),
       restrict_to_user_(false),
+      wal_mode_(false),
+      wal_checkpoint_pages_(kDefaultWalCheckpointPages),
+      mmap_size_(0),
+      mmap_enabled_(false),
+      wal_enabled_(false),
+      statement_cache_limit_(0),
+      track_statement_stats_(false),
       transaction_nesting_(0),
       needs_rollback_(false),
       in_memory_(false),
@@ -226,6 +313,11 @@ Connection::~Connection() {
   Close();
 }
 
+void Connection::set_checkpoint_task_runner(
+    const scoped_refptr<base::SequencedTaskRunner>& task_runner) {
+  checkpoint_task_runner_ = task_runner;
+}
+
 bool Connection::Open(const base::FilePath& path) {
   if (!histogram_tag_.empty()) {
     int64 size_64 = 0;
@@ -267,6 +359,7 @@ void Connection::CloseInternal(bool forced) {
 
   // Release cached statements.
   statement_cache_.clear();
+  statement_lru_.clear();
 
   // With cached statements released, in-use statements will remain.
   // Closing the database while statements are in use is an API
@@ -296,6 +389,9 @@ void Connection::CloseInternal(bool forced) {
     }
   }
   db_ = NULL;
+  mmap_enabled_ = false;
+  wal_enabled_ = false;
+  wal_checkpointer_ = NULL;
 }
 
 void Connection::Close() {
@@ -325,26 +421,60 @@ void Connection::Preload() {
   if (preload_size < 1)
     return;
 
+  ReadAhead(preload_size);
+}
+
+int64 Connection::ReadAhead(int64 size) {
   sqlite3_file* file = NULL;
   int rc = GetSqlite3File(db_, &file);
   if (rc != SQLITE_OK)
-    return;
+    return 0;
 
   sqlite3_int64 file_size = 0;
   rc = file->pMethods->xFileSize(file, &file_size);
   if (rc != SQLITE_OK)
-    return;
-
-  // Don't preload more than the file contains.
-  if (preload_size > file_size)
-    preload_size = file_size;
+    return 0;
 
-  scoped_ptr<char[]> buf(new char[page_size]);
-  for (sqlite3_int64 pos = 0; pos < file_size; pos += page_size) {
-    rc = file->pMethods->xRead(file, buf.get(), page_size, pos);
+  // Don't read more than the file contains.
+  if (size > file_size)
+    size = file_size;
+
+  // Read in chunks of many pages, since the cost of a read is dominated by
+  // the call rather than the copy.
+  const int kChunkSize = 256 * 1024;
+  scoped_ptr<char[]> buf(new char[kChunkSize]);
+  int64 pos = 0;
+  while (pos < size) {
+    int chunk = static_cast<int>(std::min<int64>(kChunkSize, size - pos));
+    rc = file->pMethods->xRead(file, buf.get(), chunk, pos);
     if (rc != SQLITE_OK)
-      return;
+      break;
+    pos += chunk;
   }
+  return pos;
+}
+
+void Connection::EnableMmap() {
+  // PRAGMA mmap_size was added in SQLite 3.7.17.
+  if (sqlite3_libversion_number() < 3007017)
+    return;
+
+  // sqlite_master must be read before the file size is known, and a failure
+  // here is left for the caller's first statement to report.
+  if (ExecuteAndReturnErrorCode("SELECT COUNT(*) FROM sqlite_master") !=
+      SQLITE_OK) {
+    return;
+  }
+
+  // A read error in the mapped region would crash, so stop the mapping
+  // short of the first block which can't be read.
+  const int64 mmap_size = ReadAhead(mmap_size_);
+  if (mmap_size <= 0)
+    return;
+
+  const std::string sql =
+      base::StringPrintf("PRAGMA mmap_size = %" PRId64, mmap_size);
+  mmap_enabled_ = ExecuteAndReturnErrorCode(sql.c_str()) == SQLITE_OK;
 }
 
 void Connection::TrimMemory(bool aggressively) {
@@ -391,6 +521,18 @@ bool Connection::Raze() {
     return false;
   }
 
+  // Backing up into a database which uses the write-ahead log fails unless
+  // the page sizes match, so raze through the rollback journal.
+  if (!wal_enabled_)
+    return RazeInternal();
+
+  ignore_result(SetWalEnabled(false));
+  bool razed = RazeInternal();
+  ignore_result(SetWalEnabled(true));
+  return razed;
+}
+
+bool Connection::RazeInternal() {
   sql::Connection null_db;
   if (!null_db.OpenInMemory()) {
     DLOG(FATAL) << "Unable to open in-memory database.";
@@ -552,13 +694,16 @@ bool Connection::Delete(const base::FilePath& path) {
 
   base::FilePath journal_path(path.value() + FILE_PATH_LITERAL("-journal"));
   base::FilePath wal_path(path.value() + FILE_PATH_LITERAL("-wal"));
+  base::FilePath shm_path(path.value() + FILE_PATH_LITERAL("-shm"));
 
   base::DeleteFile(journal_path, false);
   base::DeleteFile(wal_path, false);
+  base::DeleteFile(shm_path, false);
   base::DeleteFile(path, false);
 
   return !base::PathExists(journal_path) &&
       !base::PathExists(wal_path) &&
+      !base::PathExists(shm_path) &&
       !base::PathExists(path);
 }
 
@@ -702,17 +847,110 @@ scoped_refptr<Connection::StatementRef> Connection::GetCachedStatement(
     // one invalidating cached statements, and we'll remove it from the cache
     // if we do that. Make sure we reset it before giving out the cached one in
     // case it still has some stuff bound.
-    DCHECK(i->second->is_valid());
-    sqlite3_reset(i->second->stmt());
-    return i->second;
+    scoped_refptr<StatementRef>& statement = i->second.ref;
+    DCHECK(statement->is_valid());
+    sqlite3_reset(statement->stmt());
+    statement_lru_.splice(statement_lru_.end(), statement_lru_,
+                          i->second.lru_position);
+    if (track_statement_stats_) {
+      if (!statement->stats())
+        statement->set_stats(GetStatementStatsEntry(id, sql));
+      statement->stats()->cache_hit_count++;
+    }
+    return statement;
   }
 
+  base::TimeTicks start;
+  if (track_statement_stats_)
+    start = base::TimeTicks::Now();
   scoped_refptr<StatementRef> statement = GetUniqueStatement(sql);
-  if (statement->is_valid())
-    statement_cache_[id] = statement;  // Only cache valid statements.
+  if (!statement->is_valid())
+    return statement;  // Only cache valid statements.
+
+  if (track_statement_stats_) {
+    StatementStats* stats = GetStatementStatsEntry(id, sql);
+    stats->prepare_count++;
+    stats->prepare_time += base::TimeTicks::Now() - start;
+    statement->set_stats(stats);
+  }
+
+  CachedStatement& entry = statement_cache_[id];
+  entry.ref = statement;
+  entry.lru_position = statement_lru_.insert(statement_lru_.end(), id);
+  EnforceStatementCacheLimit();
   return statement;
 }
 
+void Connection::set_statement_cache_limit(size_t limit) {
+  statement_cache_limit_ = limit;
+  EnforceStatementCacheLimit();
+}
+
+void Connection::EnforceStatementCacheLimit() {
+  if (!statement_cache_limit_)
+    return;
+
+  while (statement_cache_.size() > statement_cache_limit_) {
+    CachedStatementMap::iterator i =
+        statement_cache_.find(statement_lru_.front());
+    DCHECK(i != statement_cache_.end());
+    if (i->second.ref->stats())
+      i->second.ref->stats()->eviction_count++;
+    statement_cache_.erase(i);
+    statement_lru_.pop_front();
+  }
+}
+
+StatementStats* Connection::GetStatementStatsEntry(const StatementID& id,
+                                                   const char* sql) {
+  StatementStats& stats = statement_stats_[id];
+  if (stats.id.empty()) {
+    stats.id = id.ToString();
+    stats.sql = sql;
+  }
+  return &stats;
+}
+
+void Connection::GetStatementStats(std::vector<StatementStats>* stats) const {
+  stats->clear();
+  for (StatementStatsMap::const_iterator i = statement_stats_.begin();
+       i != statement_stats_.end(); ++i) {
+    stats->push_back(i->second);
+  }
+}
+
+void Connection::ResetStatementStats() {
+  for (StatementStatsMap::iterator i = statement_stats_.begin();
+       i != statement_stats_.end(); ++i) {
+    StatementStats fresh;
+    fresh.id.swap(i->second.id);
+    fresh.sql.swap(i->second.sql);
+    i->second = fresh;
+  }
+}
+
+void Connection::RecordStatementStep(StatementRef* ref,
+                                     int rc,
+                                     base::TimeDelta elapsed) {
+  StatementStats* stats = ref->stats();
+  if (stats && track_statement_stats_) {
+    stats->step_count++;
+    if (rc == SQLITE_ROW)
+      stats->row_count++;
+    stats->step_time += elapsed;
+    if (elapsed > stats->max_step_time)
+      stats->max_step_time = elapsed;
+  }
+
+  if (slow_statement_threshold_ > base::TimeDelta() &&
+      elapsed >= slow_statement_threshold_ && ref->stmt()) {
+    TRACE_EVENT_INSTANT2("sql", "Connection::SlowStatement",
+                         TRACE_EVENT_SCOPE_THREAD,
+                         "sql", TRACE_STR_COPY(sqlite3_sql(ref->stmt())),
+                         "ms", elapsed.InMillisecondsF());
+  }
+}
+
 scoped_refptr<Connection::StatementRef> Connection::GetUniqueStatement(
     const char* sql) {
   AssertIOAllowed();
@@ -722,7 +960,19 @@ scoped_refptr<Connection::StatementRef> Connection::GetUniqueStatement(
     return new StatementRef(NULL, NULL, poisoned_);
 
   sqlite3_stmt* stmt = NULL;
+  base::TimeTicks start;
+  if (slow_statement_threshold_ > base::TimeDelta())
+    start = base::TimeTicks::Now();
   int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL);
+  if (slow_statement_threshold_ > base::TimeDelta()) {
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    if (elapsed >= slow_statement_threshold_) {
+      TRACE_EVENT_INSTANT2("sql", "Connection::SlowPrepare",
+                           TRACE_EVENT_SCOPE_THREAD,
+                           "sql", TRACE_STR_COPY(sql),
+                           "ms", elapsed.InMillisecondsF());
+    }
+  }
   if (rc != SQLITE_OK) {
     // This is evidence of a syntax error in the incoming SQL.
     DLOG(FATAL) << "SQL compile error " << GetErrorMessage();
@@ -750,6 +1000,40 @@ scoped_refptr<Connection::StatementRef> Connection::GetUntrackedStatement(
   return new StatementRef(NULL, stmt, true);
 }
 
+bool Connection::SetWalEnabled(bool enable) {
+  // Not tracked, so that failures here do not reach the error callback,
+  // which may be what called Raze().
+  Statement journal_mode(GetUntrackedStatement(
+      enable ? "PRAGMA journal_mode = WAL" : "PRAGMA journal_mode = PERSIST"));
+  if (journal_mode.Step())
+    wal_enabled_ = journal_mode.ColumnString(0) == "wal";
+  if (wal_enabled_) {
+    // Replaces SQLite's own autocheckpoint.
+    sqlite3_wal_hook(db_, &Connection::OnWalCommit, this);
+  }
+  return wal_enabled_ == enable;
+}
+
+// static
+int Connection::OnWalCommit(void* connection,
+                            sqlite3* db,
+                            const char* db_name,
+                            int pages) {
+  Connection* self = static_cast<Connection*>(connection);
+  if (pages < self->wal_checkpoint_pages_)
+    return SQLITE_OK;
+
+  // Attached databases are checkpointed inline.
+  if (self->wal_checkpointer_.get() && !strcmp(db_name, "main")) {
+    self->wal_checkpointer_->Schedule(self->checkpoint_task_runner_.get());
+    return SQLITE_OK;
+  }
+
+  // What SQLite's autocheckpoint would have done.
+  sqlite3_wal_checkpoint(db, db_name);
+  return SQLITE_OK;
+}
+
 std::string Connection::GetSchema() const {
   // The ORDER BY should not be necessary, but relying on organic
   // order for something like this is questionable.
@@ -917,8 +1201,10 @@ bool Connection::OpenInternal(const std::string& file_name,
       // be fatal unless the file doesn't exist.
       base::FilePath journal_path(file_name + FILE_PATH_LITERAL("-journal"));
       base::FilePath wal_path(file_name + FILE_PATH_LITERAL("-wal"));
+      base::FilePath shm_path(file_name + FILE_PATH_LITERAL("-shm"));
       base::SetPosixFilePermissions(journal_path, mode);
       base::SetPosixFilePermissions(wal_path, mode);
+      base::SetPosixFilePermissions(shm_path, mode);
     }
   }
 #endif  // defined(OS_POSIX)
@@ -977,6 +1263,8 @@ bool Connection::OpenInternal(const std::string& file_name,
   // TODO(shess): Figure out if PERSIST and journal_size_limit really
   // matter.  In theory, it keeps pages pre-allocated, so if
   // transactions usually fit, it should be faster.
+  // WAL - append to the -wal file to commit, see set_wal_mode().  Enabled
+  // below, since the page size can't change once the log is in use.
   ignore_result(Execute("PRAGMA journal_mode = PERSIST"));
   ignore_result(Execute("PRAGMA journal_size_limit = 16384"));
 
@@ -1000,6 +1288,21 @@ bool Connection::OpenInternal(const std::string& file_name,
     ignore_result(ExecuteWithTimeout(sql.c_str(), kBusyTimeout));
   }
 
+  if (mmap_size_ > 0 && !in_memory_ && !file_name.empty())
+    EnableMmap();
+
+  // In-memory and temporary databases have no file for the log.
+  if (wal_mode_ && !in_memory_ && !file_name.empty() && SetWalEnabled(true)) {
+    // The log is synced before each checkpoint rather than on every commit.
+    // A crash can lose the most recent commits, but can't corrupt the
+    // database.
+    ignore_result(Execute("PRAGMA synchronous = NORMAL"));
+
+    // Other handles are kept out by exclusive locking.
+    if (checkpoint_task_runner_.get() && !exclusive_locking_)
+      wal_checkpointer_ = new WalCheckpointer(file_name);
+  }
+
   if (!ExecuteWithTimeout("PRAGMA secure_delete=ON", kBusyTimeout)) {
     bool was_poisoned = poisoned_;
     Close();
@@ -1052,6 +1355,13 @@ int Connection::OnSqliteError(int err, sql::Statement *stmt, const char* sql) {
   UMA_HISTOGRAM_SPARSE_SLOWLY("Sqlite.Error", err);
   AddTaggedHistogram("Sqlite.Error", err);
 
+  // The file may be failing, and a failed read through the memory mapping
+  // would crash, so go back to reading.
+  if (mmap_enabled_ && (err & 0xff) == SQLITE_IOERR) {
+    sqlite3_exec(db_, "PRAGMA mmap_size = 0", NULL, NULL, NULL);
+    mmap_enabled_ = false;
+  }
+
   // Always log the error.
   if (!sql && stmt)
     sql = stmt->GetSQLStatement();
@@ -5,6 +5,7 @@
 #ifndef SQL_CONNECTION_H_
 #define SQL_CONNECTION_H_
 
+#include <list>
 #include <map>
 #include <set>
 #include <string>
@@ -24,6 +25,7 @@ struct sqlite3_stmt;
 
 namespace base {
 class FilePath;
+class SequencedTaskRunner;
 }
 
 namespace sql {
@@ -70,6 +72,9 @@ class StatementID {
   // We need this to insert into our map.
   bool operator<(const StatementID& other) const;
 
+  // Returns "file:line", or the unique name for custom statements.
+  std::string ToString() const;
+
  private:
   int number_;
   const char* str_;
@@ -77,6 +82,38 @@ class StatementID {
 
 #define SQL_FROM_HERE sql::StatementID(__FILE__, __LINE__)
 
+// Usage and timing of one cached statement, collected while
+// Connection::set_track_statement_stats() is enabled.  See
+// Connection::GetStatementStats().
+struct SQL_EXPORT StatementStats {
+  StatementStats();
+  ~StatementStats();
+
+  // The StatementID, as given by StatementID::ToString().
+  std::string id;
+
+  // The SQL the statement was compiled from.
+  std::string sql;
+
+  // Number of GetCachedStatement() calls served from the cache, and number
+  // which had to compile the statement.
+  int cache_hit_count;
+  int prepare_count;
+
+  // Number of times the statement was dropped to honor the cache limit.
+  int eviction_count;
+
+  // Number of sqlite3_step() calls, and how many of them returned a row.
+  int64 step_count;
+  int64 row_count;
+
+  // Total time spent compiling and stepping the statement, and the longest
+  // single step.
+  base::TimeDelta prepare_time;
+  base::TimeDelta step_time;
+  base::TimeDelta max_step_time;
+};
+
 class Connection;
 
 class SQL_EXPORT Connection {
@@ -105,6 +142,17 @@ class SQL_EXPORT Connection {
   // called before Open() to have an effect.
   void set_cache_size(int cache_size) { cache_size_ = cache_size; }
 
+  // Sets the most bytes of the database file SQLite may read through a
+  // memory mapping instead of read() calls.  Only the prefix of the file
+  // which can be read without error at open is mapped, since an I/O error on
+  // a mapped page crashes instead of returning an error, and mapping is
+  // turned off if an I/O error is seen later.  Zero, the default, disables
+  // mapping.  This must be called before Open() to have an effect.
+  //
+  // Requires SQLite 3.7.17 or later, so it has no effect with the bundled
+  // SQLite; Preload() is the way to warm the cache there.
+  void set_mmap_size(int64 mmap_size) { mmap_size_ = mmap_size; }
+
   // Call to put the database in exclusive locking mode. There is no "back to
   // normal" flag because of some additional requirements sqlite puts on this
   // transaition (requires another access to the DB) and because we don't
@@ -123,6 +171,27 @@ class SQL_EXPORT Connection {
   // other platforms.
   void set_restrict_to_user() { restrict_to_user_ = true; }
 
+  // Call to use the write-ahead log instead of the rollback journal.  A
+  // commit then appends to the -wal file without syncing, and the database
+  // itself is only written and synced when the log is checkpointed back
+  // into it.  Readers do not block the writer.  Has no effect on in-memory
+  // and temporary databases.  This must be called before Open() to have an
+  // effect.
+  void set_wal_mode() { wal_mode_ = true; }
+
+  // Sets how many pages a commit may leave in the write-ahead log before a
+  // passive checkpoint is started.  Defaults to kDefaultWalCheckpointPages,
+  // which matches SQLite's own autocheckpoint.
+  static const int kDefaultWalCheckpointPages = 1000;
+  void set_wal_checkpoint_pages(int pages) { wal_checkpoint_pages_ = pages; }
+
+  // Runs write-ahead log checkpoints on |task_runner| through a handle of
+  // its own, so that they do not delay commits on this connection.  Without
+  // a task runner, or with exclusive locking (which keeps other handles
+  // out), checkpoints run on the committing thread.
+  void set_checkpoint_task_runner(
+      const scoped_refptr<base::SequencedTaskRunner>& task_runner);
+
   // Set an error-handling callback.  On errors, the error number (and
   // statement, if available) will be passed to the callback.
   //
@@ -181,6 +250,10 @@ class SQL_EXPORT Connection {
   // Returns true if the database has been successfully opened.
   bool is_open() const { return !!db_; }
 
+  // Returns true if the open database uses the write-ahead log.  This can be
+  // false after set_wal_mode() if the database does not support it.
+  bool is_wal_enabled() const { return wal_enabled_; }
+
   // Closes the database. This is automatically performed on destruction for
   // you, but this allows you to close the database early. You must not call
   // any other functions after closing it. It is permissable to call Close on
@@ -352,6 +425,32 @@ class SQL_EXPORT Connection {
   // valid SQL, returns true.
   bool IsSQLValid(const char* sql);
 
+  // Bounds the number of statements kept by GetCachedStatement().  Once the
+  // cache holds |limit| statements, caching another one finalizes the least
+  // recently used.  Statements in use by a Statement object stay valid until
+  // it releases them.  Zero, the default, means no bound.
+  void set_statement_cache_limit(size_t limit);
+  size_t statement_cache_size() const { return statement_cache_.size(); }
+
+  // Enables collecting StatementStats for statements obtained through
+  // GetCachedStatement().  Unique statements are not tracked.
+  void set_track_statement_stats(bool track) {
+    track_statement_stats_ = track;
+  }
+
+  // Emits a "sql" trace event for every prepare or step which takes at least
+  // |threshold|, cached or not.  A zero threshold, the default, disables it.
+  void set_slow_statement_threshold(base::TimeDelta threshold) {
+    slow_statement_threshold_ = threshold;
+  }
+
+  // Replaces the contents of |stats| with the stats of every statement seen
+  // since tracking was enabled, ordered by StatementID.
+  void GetStatementStats(std::vector<StatementStats>* stats) const;
+
+  // Zeroes the counters returned by GetStatementStats().
+  void ResetStatementStats();
+
   // Returns a non-cached statement for the given SQL. Use this for SQL that
   // is only executed once or only rarely (there is overhead associated with
   // keeping a statement cached).
@@ -426,6 +525,10 @@ class SQL_EXPORT Connection {
   };
   bool OpenInternal(const std::string& file_name, Retry retry_flag);
 
+  // Raze() without the state checks, and with the database in rollback
+  // journal mode.
+  bool RazeInternal();
+
   // Internal close function used by Close() and RazeAndClose().
   // |forced| indicates that orderly-shutdown checks should not apply.
   void CloseInternal(bool forced);
@@ -438,6 +541,15 @@ class SQL_EXPORT Connection {
       base::ThreadRestrictions::AssertIOAllowed();
   }
 
+  // Reads the first |size| bytes of the main database file, in large chunks.
+  // Returns how many bytes were read before the end of the file or the first
+  // error.  Used to prime the filesystem cache and to validate the part of
+  // the file which is memory mapped.
+  int64 ReadAhead(int64 size);
+
+  // Applies |mmap_size_| to the open database, see set_mmap_size().
+  void EnableMmap();
+
   // Internal helper for DoesTableExist and DoesIndexExist.
   bool DoesTableOrIndexExist(const char* name, const char* type) const;
 
@@ -497,6 +609,11 @@ class SQL_EXPORT Connection {
     // if database wasn't open in memory.
     void AssertIOAllowed() { if (connection_) connection_->AssertIOAllowed(); }
 
+    // Where steps of a tracked cached statement are accounted, or NULL.
+    // Owned by the connection.
+    StatementStats* stats() const { return stats_; }
+    void set_stats(StatementStats* stats) { stats_ = stats; }
+
    private:
     friend class base::RefCounted<StatementRef>;
 
@@ -505,6 +622,7 @@ class SQL_EXPORT Connection {
     Connection* connection_;
     sqlite3_stmt* stmt_;
     bool was_valid_;
+    StatementStats* stats_;
 
     DISALLOW_COPY_AND_ASSIGN(StatementRef);
   };
@@ -519,6 +637,27 @@ class SQL_EXPORT Connection {
   void StatementRefCreated(StatementRef* ref);
   void StatementRefDeleted(StatementRef* ref);
 
+  // True if Statement should time its steps and report them to
+  // RecordStatementStep().
+  bool ShouldTimeStatements() const {
+    return track_statement_stats_ ||
+        slow_statement_threshold_ > base::TimeDelta();
+  }
+
+  // Called by Statement after a step of |ref| which returned |rc| and took
+  // |elapsed|.
+  void RecordStatementStep(StatementRef* ref,
+                           int rc,
+                           base::TimeDelta elapsed);
+
+  // Returns the stats entry for |id|, creating it for |sql| if needed.
+  StatementStats* GetStatementStatsEntry(const StatementID& id,
+                                         const char* sql);
+
+  // Finalizes least recently used cached statements until the cache is
+  // within |statement_cache_limit_|.
+  void EnforceStatementCacheLimit();
+
   // Called when a sqlite function returns an error, which is passed
   // as |err|.  The return value is the error code to be reflected
   // back to client code.  |stmt| is non-NULL if the error relates to
@@ -543,6 +682,20 @@ class SQL_EXPORT Connection {
   // case for const functions).
   scoped_refptr<StatementRef> GetUntrackedStatement(const char* sql) const;
 
+  // Switches the journal of the open database to the write-ahead log if
+  // |enable|, or back to the persistent rollback journal otherwise.  Leaving
+  // the log checkpoints it into the database.  Returns true if the database
+  // ends up in the requested mode.
+  bool SetWalEnabled(bool enable);
+
+  // sqlite3_wal_hook() callback, called after each commit with the number of
+  // |pages| in the write-ahead log of database |db_name|.  |connection| is
+  // the Connection.  Starts a checkpoint once the log is large enough.
+  static int OnWalCommit(void* connection,
+                         sqlite3* db,
+                         const char* db_name,
+                         int pages);
+
   bool IntegrityCheckHelper(
       const char* pragma_sql,
       std::vector<std::string>* messages) WARN_UNUSED_RESULT;
@@ -557,12 +710,46 @@ class SQL_EXPORT Connection {
   int cache_size_;
   bool exclusive_locking_;
   bool restrict_to_user_;
+  bool wal_mode_;
+  int wal_checkpoint_pages_;
+  int64 mmap_size_;
+
+  // Whether SQLite was allowed to memory map the open database.
+  bool mmap_enabled_;
+
+  // Whether the open database is using the write-ahead log.
+  bool wal_enabled_;
+
+  // Runs checkpoints off the connection's thread, see
+  // set_checkpoint_task_runner().  |wal_checkpointer_| is created on open
+  // when both WAL and |checkpoint_task_runner_| are in use.
+  class WalCheckpointer;
+  scoped_refptr<base::SequencedTaskRunner> checkpoint_task_runner_;
+  scoped_refptr<WalCheckpointer> wal_checkpointer_;
 
   // All cached statements. Keeping a reference to these statements means that
-  // they'll remain active.
-  typedef std::map<StatementID, scoped_refptr<StatementRef> >
-      CachedStatementMap;
+  // they'll remain active.  |statement_lru_| holds their IDs from least to
+  // most recently used, and each entry points at its position there.
+  typedef std::list<StatementID> StatementIDList;
+  struct CachedStatement {
+    scoped_refptr<StatementRef> ref;
+    StatementIDList::iterator lru_position;
+  };
+  typedef std::map<StatementID, CachedStatement> CachedStatementMap;
   CachedStatementMap statement_cache_;
+  StatementIDList statement_lru_;
+
+  // Maximum size of |statement_cache_|, or zero for no bound.
+  size_t statement_cache_limit_;
+
+  // Stats of cached statements, see set_track_statement_stats().  Entries
+  // are never erased, since StatementRefs point at them.
+  typedef std::map<StatementID, StatementStats> StatementStatsMap;
+  StatementStatsMap statement_stats_;
+  bool track_statement_stats_;
+
+  // See set_slow_statement_threshold().
+  base::TimeDelta slow_statement_threshold_;
 
   // A list of all StatementRefs we've given out. Each ref must register with
   // us when it's created or destroyed. This allows us to potentially close
@@ -6,6 +6,7 @@
 #include "base/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
+#include "base/threading/thread.h"
 #include "sql/connection.h"
 #include "sql/meta_table.h"
 #include "sql/statement.h"
@@ -25,6 +26,18 @@ int SqliteMasterCount(sql::Connection* db) {
   return s.Step() ? s.ColumnInt(0) : -1;
 }
 
+// Helper to return the journal mode of |db|, or "" in case of error.
+std::string JournalMode(sql::Connection* db) {
+  sql::Statement s(db->GetUniqueStatement("PRAGMA journal_mode"));
+  return s.Step() ? s.ColumnString(0) : std::string();
+}
+
+// Helper to return the size of the file at |path|, or -1 in case of error.
+int64 FileSize(const base::FilePath& path) {
+  int64 size = 0;
+  return base::GetFileSize(path, &size) ? size : -1;
+}
+
 // Track the number of valid references which share the same pointer.
 // This is used to allow testing an implicitly use-after-free case by
 // explicitly having the ref count live longer than the object.
@@ -167,6 +180,106 @@ TEST_F(SQLConnectionTest, CachedStatement) {
   EXPECT_FALSE(db().HasCachedStatement(SQL_FROM_HERE));
 }
 
+TEST_F(SQLConnectionTest, CachedStatementLimit) {
+  sql::StatementID id1("foo", 1);
+  sql::StatementID id2("foo", 2);
+  sql::StatementID id3("foo", 3);
+
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  db().set_statement_cache_limit(2);
+
+  {
+    sql::Statement s(db().GetCachedStatement(id1, "SELECT a FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+  }
+  {
+    sql::Statement s(db().GetCachedStatement(id2, "SELECT b FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+  }
+
+  // Touch |id1| so that |id2| is the least recently used.
+  {
+    sql::Statement s(db().GetCachedStatement(id1, "SELECT a FROM foo"));
+    ASSERT_TRUE(s.is_valid());
+  }
+
+  // A statement evicted while in use stays valid.
+  sql::Statement s(db().GetCachedStatement(id3, "SELECT a, b FROM foo"));
+  ASSERT_TRUE(s.is_valid());
+  EXPECT_EQ(2u, db().statement_cache_size());
+  EXPECT_TRUE(db().HasCachedStatement(id1));
+  EXPECT_FALSE(db().HasCachedStatement(id2));
+  EXPECT_TRUE(db().HasCachedStatement(id3));
+
+  db().set_statement_cache_limit(1);
+  EXPECT_EQ(1u, db().statement_cache_size());
+  EXPECT_FALSE(db().HasCachedStatement(id1));
+  EXPECT_TRUE(s.is_valid());
+  EXPECT_FALSE(s.Step());
+  EXPECT_TRUE(s.Succeeded());
+}
+
+TEST_F(SQLConnectionTest, StatementStats) {
+  sql::StatementID id1("foo", 1);
+  sql::StatementID id2("bar");
+
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (1)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (2)"));
+  db().set_track_statement_stats(true);
+  db().set_slow_statement_threshold(base::TimeDelta::FromMicroseconds(1));
+
+  for (int i = 0; i < 3; ++i) {
+    sql::Statement s(db().GetCachedStatement(id1, "SELECT a FROM foo"));
+    while (s.Step()) {
+    }
+    EXPECT_TRUE(s.Succeeded());
+  }
+  {
+    sql::Statement s(db().GetCachedStatement(id2, "DELETE FROM foo"));
+    EXPECT_TRUE(s.Run());
+  }
+
+  // Unique statements are not tracked.
+  {
+    sql::Statement s(db().GetUniqueStatement("SELECT a FROM foo"));
+    EXPECT_FALSE(s.Step());
+  }
+
+  std::vector<sql::StatementStats> stats;
+  db().GetStatementStats(&stats);
+  ASSERT_EQ(2u, stats.size());
+
+  EXPECT_EQ("bar", stats[0].id);
+  EXPECT_EQ("DELETE FROM foo", stats[0].sql);
+  EXPECT_EQ(0, stats[0].cache_hit_count);
+  EXPECT_EQ(1, stats[0].prepare_count);
+  EXPECT_EQ(1, stats[0].step_count);
+  EXPECT_EQ(0, stats[0].row_count);
+
+  EXPECT_EQ("foo:1", stats[1].id);
+  EXPECT_EQ("SELECT a FROM foo", stats[1].sql);
+  EXPECT_EQ(2, stats[1].cache_hit_count);
+  EXPECT_EQ(1, stats[1].prepare_count);
+  EXPECT_EQ(0, stats[1].eviction_count);
+  EXPECT_EQ(9, stats[1].step_count);
+  EXPECT_EQ(6, stats[1].row_count);
+  EXPECT_GE(stats[1].step_time, stats[1].max_step_time);
+
+  db().ResetStatementStats();
+  db().GetStatementStats(&stats);
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_EQ("foo:1", stats[1].id);
+  EXPECT_EQ(0, stats[1].cache_hit_count);
+  EXPECT_EQ(0, stats[1].step_count);
+  EXPECT_EQ(base::TimeDelta(), stats[1].step_time);
+
+  db().set_statement_cache_limit(1);
+  db().GetStatementStats(&stats);
+  EXPECT_EQ(0, stats[0].eviction_count);
+  EXPECT_EQ(1, stats[1].eviction_count);
+}
+
 TEST_F(SQLConnectionTest, IsSQLValidTest) {
   ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
   ASSERT_TRUE(db().IsSQLValid("SELECT a FROM foo"));
@@ -363,6 +476,39 @@ TEST_F(SQLConnectionTest, RazePageSize) {
   ASSERT_EQ(kPageSize, s.ColumnInt(0));
 }
 
+// Raze() must also work when the database uses the write-ahead log,
+// which otherwise requires the page size to match.
+TEST_F(SQLConnectionTest, RazeWal) {
+  db().Close();
+  db().set_wal_mode();
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_TRUE(db().is_wal_enabled());
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (id INTEGER PRIMARY KEY, value)"));
+
+  int default_page_size = 0;
+  {
+    sql::Statement s(db().GetUniqueStatement("PRAGMA page_size"));
+    ASSERT_TRUE(s.Step());
+    default_page_size = s.ColumnInt(0);
+  }
+  ASSERT_GT(default_page_size, 0);
+  const int kPageSize = 2 * default_page_size;
+
+  db().Close();
+  db().set_page_size(kPageSize);
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_TRUE(db().is_wal_enabled());
+
+  ASSERT_TRUE(db().Raze());
+  EXPECT_EQ(0, SqliteMasterCount(&db()));
+  EXPECT_TRUE(db().is_wal_enabled());
+  EXPECT_EQ("wal", JournalMode(&db()));
+
+  sql::Statement s(db().GetUniqueStatement("PRAGMA page_size"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(kPageSize, s.ColumnInt(0));
+}
+
 // Test that Raze() results are seen in other connections.
 TEST_F(SQLConnectionTest, RazeMultiple) {
   const char* kCreateSql = "CREATE TABLE foo (id INTEGER PRIMARY KEY, value)";
@@ -866,4 +1012,115 @@ TEST_F(SQLConnectionTest, Basic_FullIntegrityCheck) {
   // file that would pass the quick check and fail the full check.
 }
 
+// Memory mapping must be transparent, including when the mapping is larger
+// than the file.  Preload() must also cope with a file larger than what it
+// reads.
+TEST_F(SQLConnectionTest, MmapAndPreload) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  const std::string blob(64 * 1024, 'x');
+  for (int i = 0; i < 8; ++i) {
+    sql::Statement s(db().GetUniqueStatement("INSERT INTO foo VALUES (?)"));
+    s.BindBlob(0, blob.data(), blob.size());
+    ASSERT_TRUE(s.Run());
+  }
+  db().Close();
+
+  db().set_mmap_size(1024 * 1024 * 1024);
+  db().set_cache_size(16);
+  ASSERT_TRUE(db().Open(db_path()));
+  db().Preload();
+
+  sql::Statement s(db().GetUniqueStatement("SELECT a FROM foo"));
+  int rows = 0;
+  while (s.Step()) {
+    std::string value;
+    ASSERT_TRUE(s.ColumnBlobAsString(0, &value));
+    EXPECT_EQ(blob, value);
+    ++rows;
+  }
+  EXPECT_TRUE(s.Succeeded());
+  EXPECT_EQ(8, rows);
+}
+
+TEST_F(SQLConnectionTest, WalMode) {
+  // The rollback journal is the default.
+  EXPECT_FALSE(db().is_wal_enabled());
+  EXPECT_EQ("persist", JournalMode(&db()));
+
+  db().Close();
+  db().set_wal_mode();
+  ASSERT_TRUE(db().Open(db_path()));
+  EXPECT_TRUE(db().is_wal_enabled());
+  EXPECT_EQ("wal", JournalMode(&db()));
+
+  // Commits go to the log.
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  base::FilePath wal_path(db_path().value() + FILE_PATH_LITERAL("-wal"));
+  EXPECT_LT(0, FileSize(wal_path));
+
+  // Closing the last handle checkpoints and deletes the log.
+  db().Close();
+  EXPECT_FALSE(base::PathExists(wal_path));
+
+  // SQLite remembers WAL mode in the database, but without set_wal_mode()
+  // the database returns to the rollback journal.
+  sql::Connection other_db;
+  ASSERT_TRUE(other_db.Open(db_path()));
+  EXPECT_FALSE(other_db.is_wal_enabled());
+  EXPECT_EQ("persist", JournalMode(&other_db));
+  EXPECT_TRUE(other_db.DoesTableExist("foo"));
+
+  // Not supported for in-memory databases.
+  sql::Connection memory_db;
+  memory_db.set_wal_mode();
+  ASSERT_TRUE(memory_db.OpenInMemory());
+  EXPECT_FALSE(memory_db.is_wal_enabled());
+}
+
+TEST_F(SQLConnectionTest, WalCheckpoint) {
+  db().Close();
+  ASSERT_TRUE(sql::Connection::Delete(db_path()));
+  db().set_wal_mode();
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_TRUE(db().is_wal_enabled());
+
+  // Only the header page is written before the first checkpoint.
+  const int64 initial_size = FileSize(db_path());
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (1)"));
+  EXPECT_EQ(initial_size, FileSize(db_path()));
+
+  // Once the log passes the threshold, the next commit checkpoints it.
+  db().set_wal_checkpoint_pages(1);
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (2)"));
+  EXPECT_LT(initial_size, FileSize(db_path()));
+}
+
+TEST_F(SQLConnectionTest, WalCheckpointTaskRunner) {
+  base::Thread checkpoint_thread("Checkpoint");
+  ASSERT_TRUE(checkpoint_thread.Start());
+
+  db().Close();
+  ASSERT_TRUE(sql::Connection::Delete(db_path()));
+  db().set_wal_mode();
+  db().set_wal_checkpoint_pages(1);
+  db().set_checkpoint_task_runner(checkpoint_thread.message_loop_proxy());
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_TRUE(db().is_wal_enabled());
+
+  const int64 initial_size = FileSize(db_path());
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (1)"));
+
+  // Stopping the thread runs the checkpoints it was sent.
+  checkpoint_thread.Stop();
+  EXPECT_LT(initial_size, FileSize(db_path()));
+
+  // The log is still usable from this connection.
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (a) VALUES (2)"));
+  sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM foo"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(2, s.ColumnInt(0));
+}
+
 }  // namespace
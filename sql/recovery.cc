@@ -166,6 +166,13 @@ bool Recovery::Init(const base::FilePath& db_path) {
   // more complicated.
   db_->RollbackAllTransactions();
 
+  // Checkpoint and leave the write-ahead log.  Otherwise the attached
+  // database has to read through the log, which exclusive locking keeps
+  // private to this handle, and the final backup requires the recovered
+  // database to have the same page size.
+  if (db_->is_wal_enabled())
+    ignore_result(db_->SetWalEnabled(false));
+
   // Disable exclusive locking mode so that the attached database can
   // access things.  The locking_mode change is not active until the
   // next database access, so immediately force an access.  Enabling
@@ -197,6 +197,46 @@ TEST_F(SQLRecoveryTest, VirtualTable) {
             ExecuteWithResults(&db(), kXSql, "|", "\n"));
 }
 
+// Recovery must see commits still in the write-ahead log, even though
+// exclusive locking keeps the log private to the original handle.
+TEST_F(SQLRecoveryTest, VirtualTableWal) {
+  db().Close();
+  db().set_wal_mode();
+  db().set_exclusive_locking();
+  ASSERT_TRUE(db().Open(db_path()));
+  ASSERT_TRUE(db().is_wal_enabled());
+
+  const char kCreateSql[] = "CREATE TABLE x (t TEXT)";
+  ASSERT_TRUE(db().Execute(kCreateSql));
+  ASSERT_TRUE(db().Execute("INSERT INTO x VALUES ('This is a test')"));
+  ASSERT_TRUE(db().Execute("INSERT INTO x VALUES ('That was a test')"));
+
+  {
+    scoped_ptr<sql::Recovery> recovery = sql::Recovery::Begin(&db(), db_path());
+    ASSERT_TRUE(recovery.get());
+
+    const char kRecoveryCreateSql[] =
+        "CREATE VIRTUAL TABLE temp.recover_x using recover("
+        "  corrupt.x,"
+        "  t TEXT STRICT"
+        ")";
+    ASSERT_TRUE(recovery->db()->Execute(kRecoveryCreateSql));
+    ASSERT_TRUE(recovery->db()->Execute(kCreateSql));
+    ASSERT_TRUE(recovery->db()->Execute(
+        "INSERT INTO x SELECT t FROM recover_x"));
+
+    ASSERT_TRUE(sql::Recovery::Recovered(recovery.Pass()));
+  }
+
+  ASSERT_TRUE(Reopen());
+  EXPECT_TRUE(db().is_wal_enabled());
+  ASSERT_EQ("CREATE TABLE x (t TEXT)", GetSchema(&db()));
+
+  const char* kXSql = "SELECT * FROM x ORDER BY 1";
+  ASSERT_EQ("That was a test\nThis is a test",
+            ExecuteWithResults(&db(), kXSql, "|", "\n"));
+}
+
 void RecoveryCallback(sql::Connection* db, const base::FilePath& db_path,
                       int* record_error, int error, sql::Statement* stmt) {
   *record_error = error;
@@ -7,6 +7,7 @@
 #include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
 #include "third_party/sqlite/sqlite3.h"
 
 namespace sql {
@@ -58,7 +59,7 @@ bool Statement::Run() {
     return false;
 
   stepped_ = true;
-  return CheckError(sqlite3_step(ref_->stmt())) == SQLITE_DONE;
+  return CheckError(StepInternal()) == SQLITE_DONE;
 }
 
 bool Statement::Step() {
@@ -67,7 +68,19 @@ bool Statement::Step() {
     return false;
 
   stepped_ = true;
-  return CheckError(sqlite3_step(ref_->stmt())) == SQLITE_ROW;
+  return CheckError(StepInternal()) == SQLITE_ROW;
+}
+
+int Statement::StepInternal() {
+  Connection* connection = ref_->connection();
+  if (!connection || !connection->ShouldTimeStatements())
+    return sqlite3_step(ref_->stmt());
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  int rc = sqlite3_step(ref_->stmt());
+  connection->RecordStatementStep(ref_.get(), rc,
+                                  base::TimeTicks::Now() - start);
+  return rc;
 }
 
 void Statement::Reset(bool clear_bound_vars) {
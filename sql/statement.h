@@ -173,6 +173,10 @@ class SQL_EXPORT Statement {
   // ensuring that contracts are honored in error edge cases.
   bool CheckValid() const;
 
+  // Runs sqlite3_step(), timing it if the connection collects statement
+  // stats or traces slow statements.
+  int StepInternal();
+
   // The actual sqlite statement. This may be unique to us, or it may be cached
   // by the connection, which is why it's refcounted. This pointer is
   // guaranteed non-NULL.
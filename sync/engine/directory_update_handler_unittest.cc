@@ -7,6 +7,7 @@
 #include "base/compiler_specific.h"
 #include "base/message_loop/message_loop.h"
 #include "base/stl_util.h"
+#include "base/strings/stringprintf.h"
 #include "sync/engine/syncer_proto_util.h"
 #include "sync/internal_api/public/base/model_type.h"
 #include "sync/internal_api/public/test/test_entry_factory.h"
@@ -681,6 +682,73 @@ TEST_F(DirectoryUpdateHandlerApplyUpdateTest, ItemsBothKnownAndUnknown) {
   }
 }
 
+// Apply a chain of nested folders that was received children first.
+TEST_F(DirectoryUpdateHandlerApplyUpdateTest, NestedFoldersInReverseOrder) {
+  const int kDepth = 10;
+  std::string root_server_id = syncable::GetNullId().GetServerId();
+  std::vector<int64> handles;
+  for (int i = kDepth - 1; i >= 0; --i) {
+    handles.push_back(entry_factory()->CreateUnappliedNewItemWithParent(
+        base::StringPrintf("folder%d", i), DefaultBookmarkSpecifics(),
+        i == 0 ? root_server_id : base::StringPrintf("folder%d", i - 1)));
+  }
+
+  sessions::StatusController status;
+  ApplyBookmarkUpdates(&status);
+  EXPECT_EQ(0, status.num_hierarchy_conflicts());
+  EXPECT_EQ(kDepth, status.num_updates_applied());
+
+  {
+    syncable::ReadTransaction trans(FROM_HERE, directory());
+    for (size_t i = 0; i < handles.size(); ++i) {
+      syncable::Entry entry(&trans, syncable::GET_BY_HANDLE, handles[i]);
+      ASSERT_TRUE(entry.good());
+      EXPECT_FALSE(entry.GetIsUnappliedUpdate());
+    }
+  }
+}
+
+// Delete a chain of nested folders whose outermost folder was received first.
+TEST_F(DirectoryUpdateHandlerApplyUpdateTest, DeleteNestedFolders) {
+  const int kDepth = 10;
+  std::string root_server_id = syncable::GetNullId().GetServerId();
+  std::vector<int64> handles;
+  for (int i = 0; i < kDepth; ++i) {
+    handles.push_back(entry_factory()->CreateUnappliedNewItemWithParent(
+        base::StringPrintf("folder%d", i), DefaultBookmarkSpecifics(),
+        i == 0 ? root_server_id : base::StringPrintf("folder%d", i - 1)));
+  }
+  sessions::StatusController status;
+  ApplyBookmarkUpdates(&status);
+  EXPECT_EQ(kDepth, status.num_updates_applied());
+
+  {
+    syncable::WriteTransaction trans(FROM_HERE, UNITTEST, directory());
+    for (size_t i = 0; i < handles.size(); ++i) {
+      syncable::MutableEntry entry(&trans, syncable::GET_BY_HANDLE, handles[i]);
+      ASSERT_TRUE(entry.good());
+      entry.PutServerVersion(entry_factory()->GetNextRevision());
+      entry.PutIsUnappliedUpdate(true);
+      entry.PutServerIsDel(true);
+    }
+  }
+
+  sessions::StatusController delete_status;
+  ApplyBookmarkUpdates(&delete_status);
+  EXPECT_EQ(0, delete_status.num_hierarchy_conflicts());
+  EXPECT_EQ(kDepth, delete_status.num_updates_applied());
+
+  {
+    syncable::ReadTransaction trans(FROM_HERE, directory());
+    for (size_t i = 0; i < handles.size(); ++i) {
+      syncable::Entry entry(&trans, syncable::GET_BY_HANDLE, handles[i]);
+      ASSERT_TRUE(entry.good());
+      EXPECT_FALSE(entry.GetIsUnappliedUpdate());
+      EXPECT_TRUE(entry.GetIsDel());
+    }
+  }
+}
+
 // Attempt application of password upates where the passphrase is known.
 TEST_F(DirectoryUpdateHandlerApplyUpdateTest, DecryptablePassword) {
   // Decryptable password updates should be applied.
@@ -14,6 +14,7 @@
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/message_loop/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "sync/engine/backoff_delay_provider.h"
 #include "sync/engine/syncer.h"
 #include "sync/notifier/object_id_invalidation_map.h"
@@ -33,6 +34,11 @@ using sync_pb::GetUpdatesCallerInfo;
 
 namespace {
 
+// Local nudges for a type that keeps changing before its commit ran, like a
+// bookmark import, double the type's delay up to this bound, so that the
+// changes are committed in a few large batches instead of many small ones.
+const int kMaxBurstNudgeDelayMilliseconds = 2000;
+
 bool ShouldRequestEarlyExit(const SyncProtocolError& error) {
   switch (error.error_type) {
     case SYNC_SUCCESS:
@@ -167,6 +173,7 @@ SyncSchedulerImpl::SyncSchedulerImpl(const std::string& name,
       delay_provider_(delay_provider),
       syncer_(syncer),
       session_context_(context),
+      local_nudges_since_last_cycle_(0),
       no_scheduling_allowed_(false),
       do_poll_after_credentials_updated_(false),
       next_sync_session_job_priority_(NORMAL_PRIORITY),
@@ -366,9 +373,11 @@ void SyncSchedulerImpl::ScheduleLocalNudge(
   SDVLOG_LOC(nudge_location, 2)
       << "Scheduling sync because of local change to "
       << ModelTypeSetToString(types);
+  TimeDelta delay = GetLocalNudgeDelay(desired_delay, types);
   UpdateNudgeTimeRecords(types);
   nudge_tracker_.RecordLocalChange(types);
-  ScheduleNudgeImpl(desired_delay, nudge_location);
+  ++local_nudges_since_last_cycle_;
+  ScheduleNudgeImpl(delay, nudge_location);
 }
 
 void SyncSchedulerImpl::ScheduleLocalRefreshRequest(
@@ -460,6 +469,10 @@ void SyncSchedulerImpl::DoNudgeSyncSessionJob(JobPriority priority) {
 
   DVLOG(2) << "Will run normal mode sync cycle with types "
            << ModelTypeSetToString(session_context_->enabled_types());
+  UMA_HISTOGRAM_COUNTS_100("Sync.LocalNudgesPerCycle",
+                           local_nudges_since_last_cycle_);
+  local_nudges_since_last_cycle_ = 0;
+
   scoped_ptr<SyncSession> session(SyncSession::Build(session_context_, this));
   bool premature_exit = !syncer_->NormalSyncShare(
       GetEnabledAndUnthrottledTypes(),
@@ -591,6 +604,29 @@ void SyncSchedulerImpl::DoRetrySyncSessionJob() {
   }
 }
 
+TimeDelta SyncSchedulerImpl::GetLocalNudgeDelay(const TimeDelta& desired_delay,
+                                                ModelTypeSet types) {
+  DCHECK(CalledOnValidThread());
+  TimeTicks now = TimeTicks::Now();
+  TimeDelta max_delay = std::max(
+      desired_delay,
+      TimeDelta::FromMilliseconds(kMaxBurstNudgeDelayMilliseconds));
+  TimeDelta delay = desired_delay;
+  for (ModelTypeSet::Iterator iter = types.First(); iter.Good(); iter.Inc()) {
+    TimeDelta& type_delay = local_nudge_delays_by_model_type_[iter.Get()];
+    ModelTypeTimeMap::const_iterator previous =
+        last_local_nudges_by_model_type_.find(iter.Get());
+    if (previous != last_local_nudges_by_model_type_.end() &&
+        now - previous->second < std::max(type_delay, desired_delay)) {
+      type_delay = std::min(std::max(type_delay * 2, desired_delay), max_delay);
+    } else {
+      type_delay = desired_delay;
+    }
+    delay = std::max(delay, type_delay);
+  }
+  return delay;
+}
+
 void SyncSchedulerImpl::UpdateNudgeTimeRecords(ModelTypeSet types) {
   DCHECK(CalledOnValidThread());
   base::TimeTicks now = TimeTicks::Now();
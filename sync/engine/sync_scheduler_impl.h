@@ -232,6 +232,12 @@ class SYNC_EXPORT_PRIVATE SyncSchedulerImpl
   // up and does not need to perform an initial sync.
   void SendInitialSnapshot();
 
+  // Returns the delay for a local nudge of |types|, stretched for datatypes
+  // that are changing in bursts.  Must be called before the nudge is recorded
+  // by UpdateNudgeTimeRecords().
+  base::TimeDelta GetLocalNudgeDelay(const base::TimeDelta& desired_delay,
+                                     ModelTypeSet types);
+
   // This is used for histogramming and analysis of ScheduleNudge* APIs.
   // SyncScheduler is the ultimate choke-point for all such invocations (with
   // and without InvalidationState variants, all NudgeSources, etc) and as such
@@ -293,6 +299,14 @@ class SYNC_EXPORT_PRIVATE SyncSchedulerImpl
   typedef std::map<ModelType, base::TimeTicks> ModelTypeTimeMap;
   ModelTypeTimeMap last_local_nudges_by_model_type_;
 
+  // The delay of the last local nudge of each datatype, which grows while the
+  // datatype keeps nudging faster than it is committed.
+  typedef std::map<ModelType, base::TimeDelta> ModelTypeDelayMap;
+  ModelTypeDelayMap local_nudge_delays_by_model_type_;
+
+  // Number of local nudges coalesced into the next sync cycle.
+  int local_nudges_since_last_cycle_;
+
   // Used as an "anti-reentrancy defensive assertion".
   // While true, it is illegal for any new scheduling activity to take place.
   // Ensures that higher layers don't break this law in response to events that
@@ -519,6 +519,40 @@ TEST_F(SyncSchedulerTest, NudgeCoalescingWithDifferentTimings) {
   EXPECT_LE(times[0], max_time);
 }
 
+// Test that a datatype that keeps changing before it is committed has its
+// nudges delayed, so that its changes are committed in larger batches.
+TEST_F(SyncSchedulerTest, NudgeBurstCoalescing) {
+  StartSyncScheduler(SyncScheduler::NORMAL_MODE);
+  const ModelTypeSet types(BOOKMARKS);
+  const TimeDelta delay = TimeDelta::FromMilliseconds(20);
+
+  SyncShareTimes times;
+  EXPECT_CALL(*syncer(), NormalSyncShare(_,_,_))
+      .WillOnce(DoAll(Invoke(sessions::test_util::SimulateNormalSuccess),
+                      RecordSyncShare(&times)));
+  TimeTicks optimal_time = TimeTicks::Now() + delay;
+  for (int i = 0; i < 3; ++i)
+    scheduler()->ScheduleLocalNudge(delay, types, FROM_HERE);
+  RunLoop();
+
+  // The first nudge still runs on time.
+  ASSERT_EQ(1U, times.size());
+  EXPECT_GE(times[0], optimal_time);
+  Mock::VerifyAndClearExpectations(syncer());
+
+  // The burst goes on, so the next nudge waits longer than requested.
+  SyncShareTimes times2;
+  EXPECT_CALL(*syncer(), NormalSyncShare(_,_,_))
+      .WillOnce(DoAll(Invoke(sessions::test_util::SimulateNormalSuccess),
+                      RecordSyncShare(&times2)));
+  TimeTicks min_time = TimeTicks::Now() + delay * 4;
+  scheduler()->ScheduleLocalNudge(delay, types, FROM_HERE);
+  RunLoop();
+
+  ASSERT_EQ(1U, times2.size());
+  EXPECT_GE(times2[0], min_time);
+}
+
 // Test nudge scheduling.
 TEST_F(SyncSchedulerTest, NudgeWithStates) {
   StartSyncScheduler(SyncScheduler::NORMAL_MODE);
@@ -4,6 +4,9 @@
 
 #include "sync/engine/update_applicator.h"
 
+#include <algorithm>
+#include <map>
+#include <utility>
 #include <vector>
 
 #include "base/logging.h"
@@ -19,6 +22,73 @@ namespace syncer {
 
 using syncable::ID;
 
+namespace {
+
+// Orders |handles| so that each update comes after the updates it depends on:
+// new and moved items after the update that creates their new parent folder,
+// and deleted folders after the deletions of their contents.  Deletions go
+// last, so that items moved out of a deleted folder leave it first.
+void SortByHierarchy(syncable::BaseTransaction* trans,
+                     std::vector<int64>* handles) {
+  const size_t kNone = static_cast<size_t>(-1);
+  const size_t count = handles->size();
+
+  // A deletion depends on the local children of the folder it deletes, any
+  // other update on its new parent.
+  std::vector<bool> is_deletion(count);
+  std::vector<syncable::Id> parent_ids(count);
+  std::map<syncable::Id, size_t> index_by_id;
+  for (size_t i = 0; i < count; ++i) {
+    syncable::Entry entry(trans, syncable::GET_BY_HANDLE, (*handles)[i]);
+    is_deletion[i] = entry.GetServerIsDel();
+    parent_ids[i] =
+        is_deletion[i] ? entry.GetParentId() : entry.GetServerParentId();
+    index_by_id[entry.GetId()] = i;
+  }
+
+  // The depth of an update is the number of its ancestors that are updated
+  // the same way.  Loops, which the applications will reject anyway, just
+  // get some depth.
+  std::vector<size_t> depths(count, kNone);
+  std::vector<size_t> chain;
+  for (size_t i = 0; i < count; ++i) {
+    size_t current = i;
+    while (current != kNone && depths[current] == kNone) {
+      depths[current] = 0;
+      chain.push_back(current);
+      std::map<syncable::Id, size_t>::const_iterator parent =
+          index_by_id.find(parent_ids[current]);
+      if (parent != index_by_id.end() &&
+          is_deletion[parent->second] == is_deletion[current]) {
+        current = parent->second;
+      } else {
+        current = kNone;
+      }
+    }
+    size_t depth = current == kNone ? 0 : depths[current] + 1;
+    for (std::vector<size_t>::reverse_iterator it = chain.rbegin();
+         it != chain.rend(); ++it) {
+      depths[*it] = depth++;
+    }
+    chain.clear();
+  }
+
+  // Parents before children, then deepest deletions first.  Ties keep the
+  // original order.
+  std::vector<std::pair<size_t, size_t> > order(count);
+  for (size_t i = 0; i < count; ++i) {
+    order[i].first = is_deletion[i] ? 2 * count - depths[i] : depths[i];
+    order[i].second = i;
+  }
+  std::sort(order.begin(), order.end());
+  std::vector<int64> sorted(count);
+  for (size_t i = 0; i < count; ++i)
+    sorted[i] = (*handles)[order[i].second];
+  handles->swap(sorted);
+}
+
+}  // namespace
+
 UpdateApplicator::UpdateApplicator(Cryptographer* cryptographer)
     : cryptographer_(cryptographer),
       updates_applied_(0),
@@ -32,9 +102,11 @@ UpdateApplicator::~UpdateApplicator() {
 // Attempt to apply all updates, using multiple passes if necessary.
 //
 // Some updates must be applied in order.  For example, children must be created
-// after their parent folder is created.  This function runs an O(n^2) algorithm
-// that will keep trying until there is nothing left to apply, or it stops
-// making progress, which would indicate that the hierarchy is invalid.
+// after their parent folder is created.  The updates are sorted so that valid
+// hierarchies apply in a single pass, which matters for large initial
+// downloads.  Updates that still fail are retried until there is nothing left
+// to apply, or no progress is made, which would indicate that the hierarchy is
+// invalid.
 //
 // The update applicator also has to deal with simple conflicts, which occur
 // when an item is modified on both the server and the local model.  We remember
@@ -47,6 +119,7 @@ void UpdateApplicator::AttemptApplications(
     syncable::WriteTransaction* trans,
     const std::vector<int64>& handles) {
   std::vector<int64> to_apply = handles;
+  SortByHierarchy(trans, &to_apply);
 
   DVLOG(1) << "UpdateApplicator running over " << to_apply.size() << " items.";
   while (!to_apply.empty()) {
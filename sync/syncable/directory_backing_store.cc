@@ -37,10 +37,20 @@ static const string::size_type kUpdateStatementBufferSize = 2048;
 // Increment this version whenever updating DB tables.
 const int32 kCurrentDBVersion = 86;
 
+// Number of metahandles bound to each DELETE statement when purging entries.
+static const size_t kDeleteBatchSize = 100;
+
+// SaveChanges() grows the page cache to |kBulkSaveCacheSize| pages while it
+// writes at least |kBulkSaveThreshold| entries.
+static const size_t kBulkSaveThreshold = 100;
+static const int kBulkSaveCacheSize = 2000;
+
 // Iterate over the fields of |entry| and bind each to |statement| for
 // updating.  Returns the number of args bound.
 void BindFields(const EntryKernel& entry,
                 sql::Statement* statement) {
+  // Reused by the proto fields, BindBlob() copies the data.
+  std::string temp;
   int index = 0;
   int i = 0;
   for (i = BEGIN_FIELDS; i < INT64_FIELDS_END; ++i) {
@@ -61,12 +71,10 @@ void BindFields(const EntryKernel& entry,
     statement->BindString(index++, entry.ref(static_cast<StringField>(i)));
   }
   for ( ; i < PROTO_FIELDS_END; ++i) {
-    std::string temp;
     entry.ref(static_cast<ProtoField>(i)).SerializeToString(&temp);
     statement->BindBlob(index++, temp.data(), temp.length());
   }
   for ( ; i < UNIQUE_POSITION_FIELDS_END; ++i) {
-    std::string temp;
     entry.ref(static_cast<UniquePositionField>(i)).SerializeToString(&temp);
     statement->BindBlob(index++, temp.data(), temp.length());
   }
@@ -98,8 +106,24 @@ scoped_ptr<EntryKernel> UnpackEntry(sql::Statement* statement) {
                 statement->ColumnString(i));
   }
   for ( ; i < PROTO_FIELDS_END; ++i) {
-    kernel->mutable_ref(static_cast<ProtoField>(i)).ParseFromArray(
-        statement->ColumnBlob(i), statement->ColumnByteLength(i));
+    const void* blob = statement->ColumnBlob(i);
+    int length = statement->ColumnByteLength(i);
+    // Most entries have the same local and server specifics, so keep one
+    // copy in memory for columns that hold the same bytes.
+    int same = PROTO_FIELDS_BEGIN;
+    while (same < i &&
+           (statement->ColumnByteLength(same) != length ||
+            memcmp(statement->ColumnBlob(same), blob, length) != 0)) {
+      ++same;
+    }
+    if (same < i) {
+      kernel->put(static_cast<ProtoField>(i),
+                  kernel->ref(static_cast<ProtoField>(same)));
+      continue;
+    }
+    sync_pb::EntitySpecifics specifics;
+    specifics.ParseFromArray(blob, length);
+    kernel->take(static_cast<ProtoField>(i), &specifics);
   }
   for ( ; i < UNIQUE_POSITION_FIELDS_END; ++i) {
     std::string temp;
@@ -119,6 +143,42 @@ scoped_ptr<EntryKernel> UnpackEntry(sql::Statement* statement) {
 
 namespace {
 
+// Raises the page cache size of |db| to at least |cache_size| pages for the
+// lifetime of the object.  When a transaction dirties more pages than the
+// cache holds, SQLite spills them to the database before the commit and has
+// to sync the journal for every spill.
+class ScopedCacheSize {
+ public:
+  ScopedCacheSize(sql::Connection* db, int cache_size)
+      : db_(db),
+        original_cache_size_(0) {
+    sql::Statement get_cache_size(db_->GetUniqueStatement("PRAGMA cache_size"));
+    if (!get_cache_size.Step())
+      return;
+    int original_cache_size = get_cache_size.ColumnInt(0);
+    if (original_cache_size >= cache_size)
+      return;
+    if (db_->Execute(
+            base::StringPrintf("PRAGMA cache_size=%d", cache_size).c_str())) {
+      original_cache_size_ = original_cache_size;
+    }
+  }
+
+  // Shrinking the cache again frees the pages above the original size.
+  ~ScopedCacheSize() {
+    if (original_cache_size_) {
+      ignore_result(db_->Execute(base::StringPrintf(
+          "PRAGMA cache_size=%d", original_cache_size_).c_str()));
+    }
+  }
+
+ private:
+  sql::Connection* db_;
+  int original_cache_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedCacheSize);
+};
+
 string ComposeCreateTableColumnSpecs() {
   const ColumnSpec* begin = g_metas_columns;
   const ColumnSpec* end = g_metas_columns + arraysize(g_metas_columns);
@@ -175,23 +235,38 @@ bool DirectoryBackingStore::DeleteEntries(EntryTable from,
   if (handles.empty())
     return true;
 
+  // Deletes up to kDeleteBatchSize entries per statement.
+  std::string handle_list("?");
+  for (size_t i = 1; i < kDeleteBatchSize; ++i)
+    handle_list.append(",?");
+
   sql::Statement statement;
   // Call GetCachedStatement() separately to get different statements for
   // different tables.
   switch (from) {
     case METAS_TABLE:
       statement.Assign(db_->GetCachedStatement(
-          SQL_FROM_HERE, "DELETE FROM metas WHERE metahandle = ?"));
+          SQL_FROM_HERE,
+          ("DELETE FROM metas WHERE metahandle IN (" + handle_list + ")")
+              .c_str()));
       break;
     case DELETE_JOURNAL_TABLE:
       statement.Assign(db_->GetCachedStatement(
-          SQL_FROM_HERE, "DELETE FROM deleted_metas WHERE metahandle = ?"));
+          SQL_FROM_HERE,
+          ("DELETE FROM deleted_metas WHERE metahandle IN (" + handle_list +
+           ")").c_str()));
       break;
   }
 
-  for (MetahandleSet::const_iterator i = handles.begin(); i != handles.end();
-       ++i) {
-    statement.BindInt64(0, *i);
+  MetahandleSet::const_iterator i = handles.begin();
+  while (i != handles.end()) {
+    // The last batch repeats its final handle to fill the statement.
+    int64 handle = 0;
+    for (size_t bound = 0; bound < kDeleteBatchSize; ++bound) {
+      if (i != handles.end())
+        handle = *i++;
+      statement.BindInt64(bound, handle);
+    }
     if (!statement.Run())
       return false;
     statement.Reset(true);
@@ -213,6 +288,15 @@ bool DirectoryBackingStore::SaveChanges(
     return true;
   }
 
+  // Declared before |transaction| so that the cache only shrinks again after
+  // the commit.
+  scoped_ptr<ScopedCacheSize> bulk_cache_size;
+  if (snapshot.dirty_metas.size() + snapshot.metahandles_to_purge.size() +
+          snapshot.delete_journals.size() +
+          snapshot.delete_journals_to_purge.size() >= kBulkSaveThreshold) {
+    bulk_cache_size.reset(new ScopedCacheSize(db_.get(), kBulkSaveCacheSize));
+  }
+
   sql::Transaction transaction(db_.get());
   if (!transaction.Begin())
     return false;
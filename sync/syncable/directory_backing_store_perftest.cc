@@ -0,0 +1,122 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long DirectoryBackingStore takes to save and purge the
+// entries of a large initial sync.
+
+#include "sync/syncable/directory_backing_store.h"
+
+#include <string>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/stl_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "sync/internal_api/public/base/unique_position.h"
+#include "sync/protocol/bookmark_specifics.pb.h"
+#include "sync/protocol/sync.pb.h"
+#include "sync/syncable/directory.h"
+#include "sync/syncable/entry_kernel.h"
+#include "sync/syncable/on_disk_directory_backing_store.h"
+#include "sync/syncable/syncable_id.h"
+#include "sync/util/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace syncer {
+namespace syncable {
+
+namespace {
+
+const int kNumEntries = 50000;
+
+// Returns a synced bookmark with metahandle |handle|, the way it looks after
+// an initial sync applied it.
+EntryKernel* CreateBookmark(int64 handle, const std::string& suffix) {
+  EntryKernel* kernel = new EntryKernel;
+  kernel->put(META_HANDLE, handle);
+  kernel->put(BASE_VERSION, 1);
+  kernel->put(SERVER_VERSION, 1);
+  kernel->put(MTIME, ProtoTimeToTime(handle));
+  kernel->put(SERVER_MTIME, ProtoTimeToTime(handle));
+  kernel->put(ID, Id::CreateFromServerId(base::StringPrintf("s%lld", handle)));
+  kernel->put(PARENT_ID, Id::CreateFromServerId("bookmark_bar"));
+  kernel->put(SERVER_PARENT_ID, Id::CreateFromServerId("bookmark_bar"));
+  kernel->put(NON_UNIQUE_NAME, base::StringPrintf("Bookmark %lld", handle));
+  kernel->put(SERVER_NON_UNIQUE_NAME,
+              base::StringPrintf("Bookmark %lld", handle));
+
+  sync_pb::EntitySpecifics specifics;
+  sync_pb::BookmarkSpecifics* bookmark = specifics.mutable_bookmark();
+  bookmark->set_url(
+      base::StringPrintf("http://www.example%lld.com/path/page.html", handle));
+  bookmark->set_title(base::StringPrintf("Bookmark %lld", handle));
+  bookmark->set_favicon(std::string(400, 'f'));
+  kernel->put(SPECIFICS, specifics);
+  kernel->put(SERVER_SPECIFICS, specifics);
+
+  UniquePosition position = UniquePosition::FromInt64(handle, suffix);
+  kernel->put(UNIQUE_POSITION, position);
+  kernel->put(SERVER_UNIQUE_POSITION, position);
+  kernel->put(UNIQUE_BOOKMARK_TAG, suffix);
+  kernel->mark_dirty(NULL);
+  return kernel;
+}
+
+}  // namespace
+
+class DirectoryBackingStorePerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    store_.reset(new OnDiskDirectoryBackingStore(
+        "Perf", temp_dir_.path().AppendASCII("SyncData.sqlite3")));
+    Directory::MetahandlesMap handles_map;
+    JournalIndex delete_journals;
+    Directory::KernelLoadInfo info;
+    ASSERT_EQ(OPENED, store_->Load(&handles_map, &delete_journals, &info));
+    STLDeleteValues(&handles_map);
+    STLDeleteElements(&delete_journals);
+  }
+
+  // Fills |snapshot| with |kNumEntries| dirty bookmarks.
+  void CreateDirtyEntries(Directory::SaveChangesSnapshot* snapshot) {
+    std::string suffix(UniquePosition::kSuffixLength, 's');
+    for (int64 i = 1; i <= kNumEntries; ++i) {
+      snapshot->dirty_metas.insert(snapshot->dirty_metas.end(),
+                                   CreateBookmark(i, suffix));
+    }
+  }
+
+  base::ScopedTempDir temp_dir_;
+  scoped_ptr<DirectoryBackingStore> store_;
+};
+
+TEST_F(DirectoryBackingStorePerfTest, SaveAndPurgeEntries) {
+  Directory::SaveChangesSnapshot insert;
+  CreateDirtyEntries(&insert);
+  base::PerfTimeLogger insert_timer(
+      base::StringPrintf("DirectoryBackingStore_Insert%d", kNumEntries)
+          .c_str());
+  ASSERT_TRUE(store_->SaveChanges(insert));
+  insert_timer.Done();
+
+  // Saving the same entries again replaces every row.
+  base::PerfTimeLogger replace_timer(
+      base::StringPrintf("DirectoryBackingStore_Replace%d", kNumEntries)
+          .c_str());
+  ASSERT_TRUE(store_->SaveChanges(insert));
+  replace_timer.Done();
+
+  Directory::SaveChangesSnapshot purge;
+  for (int64 i = 1; i <= kNumEntries; ++i)
+    purge.metahandles_to_purge.insert(purge.metahandles_to_purge.end(), i);
+  base::PerfTimeLogger purge_timer(
+      base::StringPrintf("DirectoryBackingStore_Purge%d", kNumEntries).c_str());
+  ASSERT_TRUE(store_->SaveChanges(purge));
+  purge_timer.Done();
+}
+
+}  // namespace syncable
+}  // namespace syncer
@@ -3488,6 +3488,104 @@ TEST_F(DirectoryBackingStoreTest, DeleteEntries) {
   EXPECT_EQ(0U, handles_map.size());
 }
 
+// Purges enough entries to need several batched DELETE statements, the last
+// one only partially filled.
+TEST_F(DirectoryBackingStoreTest, SaveAndPurgeManyEntries) {
+  sql::Connection connection;
+  ASSERT_TRUE(connection.OpenInMemory());
+  scoped_ptr<TestDirectoryBackingStore> dbs(
+      new TestDirectoryBackingStore(GetUsername(), &connection));
+  Directory::MetahandlesMap handles_map;
+  JournalIndex delete_journals;
+  Directory::KernelLoadInfo kernel_load_info;
+  STLValueDeleter<Directory::MetahandlesMap> index_deleter(&handles_map);
+  ASSERT_EQ(OPENED,
+            dbs->Load(&handles_map, &delete_journals, &kernel_load_info));
+  size_t initial_size = handles_map.size();
+
+  const int64 kNumEntries = 500;
+  const int64 kFirstHandle = 1000;
+  Directory::SaveChangesSnapshot save;
+  for (int64 handle = kFirstHandle; handle < kFirstHandle + kNumEntries;
+       ++handle) {
+    EntryKernel* kernel = new EntryKernel;
+    kernel->put(META_HANDLE, handle);
+    kernel->put(ID, Id::CreateFromServerId(base::Int64ToString(handle)));
+    kernel->put(PARENT_ID, Id());
+    kernel->put(NON_UNIQUE_NAME, base::Int64ToString(handle));
+    kernel->mark_dirty(NULL);
+    save.dirty_metas.insert(kernel);
+  }
+  ASSERT_TRUE(dbs->SaveChanges(save));
+
+  // Purge every other entry, which doesn't fill the last batch.
+  Directory::SaveChangesSnapshot purge;
+  for (int64 handle = kFirstHandle; handle < kFirstHandle + kNumEntries;
+       handle += 2) {
+    purge.metahandles_to_purge.insert(handle);
+  }
+  ASSERT_TRUE(dbs->SaveChanges(purge));
+
+  STLDeleteValues(&handles_map);
+  STLDeleteElements(&delete_journals);
+  ASSERT_EQ(OPENED,
+            dbs->Load(&handles_map, &delete_journals, &kernel_load_info));
+  EXPECT_EQ(initial_size + kNumEntries / 2, handles_map.size());
+  for (int64 handle = kFirstHandle; handle < kFirstHandle + kNumEntries;
+       ++handle) {
+    EXPECT_EQ(handle % 2 == 1, handles_map.count(handle) == 1) << handle;
+  }
+}
+
+// Entries whose local and server specifics are equal load with one copy of
+// them, which is unshared again when either one changes.
+TEST_F(DirectoryBackingStoreTest, LoadSharesEqualSpecifics) {
+  sql::Connection connection;
+  ASSERT_TRUE(connection.OpenInMemory());
+  scoped_ptr<TestDirectoryBackingStore> dbs(
+      new TestDirectoryBackingStore(GetUsername(), &connection));
+  Directory::MetahandlesMap handles_map;
+  JournalIndex delete_journals;
+  Directory::KernelLoadInfo kernel_load_info;
+  STLValueDeleter<Directory::MetahandlesMap> index_deleter(&handles_map);
+  ASSERT_EQ(OPENED,
+            dbs->Load(&handles_map, &delete_journals, &kernel_load_info));
+
+  const int64 kHandle = 1000;
+  sync_pb::EntitySpecifics specifics;
+  specifics.mutable_bookmark()->set_url("http://www.google.com/");
+  Directory::SaveChangesSnapshot save;
+  EntryKernel* kernel = new EntryKernel;
+  kernel->put(META_HANDLE, kHandle);
+  kernel->put(ID, Id::CreateFromServerId("s1000"));
+  kernel->put(PARENT_ID, Id());
+  kernel->put(SPECIFICS, specifics);
+  kernel->put(SERVER_SPECIFICS, kernel->ref(SPECIFICS));
+  EXPECT_EQ(&kernel->ref(SPECIFICS), &kernel->ref(SERVER_SPECIFICS));
+  kernel->mark_dirty(NULL);
+  save.dirty_metas.insert(kernel);
+  ASSERT_TRUE(dbs->SaveChanges(save));
+
+  STLDeleteValues(&handles_map);
+  STLDeleteElements(&delete_journals);
+  ASSERT_EQ(OPENED,
+            dbs->Load(&handles_map, &delete_journals, &kernel_load_info));
+  ASSERT_EQ(1U, handles_map.count(kHandle));
+  EntryKernel* loaded = handles_map[kHandle];
+  EXPECT_EQ(&loaded->ref(SPECIFICS), &loaded->ref(SERVER_SPECIFICS));
+  EXPECT_EQ(specifics.SerializeAsString(),
+            loaded->ref(SERVER_SPECIFICS).SerializeAsString());
+  EXPECT_FALSE(loaded->ref(BASE_SERVER_SPECIFICS).has_bookmark());
+
+  sync_pb::EntitySpecifics changed;
+  changed.mutable_bookmark()->set_url("http://www.example.com/");
+  loaded->put(SPECIFICS, changed);
+  EXPECT_EQ(changed.SerializeAsString(),
+            loaded->ref(SPECIFICS).SerializeAsString());
+  EXPECT_EQ(specifics.SerializeAsString(),
+            loaded->ref(SERVER_SPECIFICS).SerializeAsString());
+}
+
 TEST_F(DirectoryBackingStoreTest, GenerateCacheGUID) {
   const std::string& guid1 = TestDirectoryBackingStore::GenerateCacheGUID();
   const std::string& guid2 = TestDirectoryBackingStore::GenerateCacheGUID();
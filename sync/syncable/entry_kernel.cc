@@ -21,6 +21,34 @@ EntryKernel::EntryKernel() : dirty_(false) {
 
 EntryKernel::~EntryKernel() {}
 
+void EntryKernel::put(ProtoField field, const sync_pb::EntitySpecifics& value) {
+  scoped_refptr<SharedSpecifics>& specifics =
+      specifics_fields[field - PROTO_FIELDS_BEGIN];
+  // Applying an update copies the server specifics into the local ones, and
+  // committing copies them back, so the fields often refer to each other.
+  for (int i = 0; i < PROTO_FIELDS_COUNT; ++i) {
+    if (specifics_fields[i].get() && &specifics_fields[i]->data == &value) {
+      specifics = specifics_fields[i];
+      return;
+    }
+  }
+  if (value.ByteSize() == 0)
+    specifics = NULL;
+  else
+    specifics = new SharedSpecifics(value);
+}
+
+void EntryKernel::take(ProtoField field, sync_pb::EntitySpecifics* value) {
+  scoped_refptr<SharedSpecifics>& specifics =
+      specifics_fields[field - PROTO_FIELDS_BEGIN];
+  if (value->ByteSize() == 0) {
+    specifics = NULL;
+    return;
+  }
+  specifics = new SharedSpecifics;
+  specifics->data.Swap(value);
+}
+
 ModelType EntryKernel::GetModelType() const {
   ModelType specifics_type = GetModelTypeFromSpecifics(ref(SPECIFICS));
   if (specifics_type != UNSPECIFIED)
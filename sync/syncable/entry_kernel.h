@@ -7,6 +7,7 @@
 
 #include <set>
 
+#include "base/memory/ref_counted.h"
 #include "base/time/time.h"
 #include "base/values.h"
 #include "sync/base/sync_export.h"
@@ -177,8 +178,14 @@ enum {
 
 struct SYNC_EXPORT_PRIVATE EntryKernel {
  private:
+  // Specifics are immutable once stored, so they are shared between the
+  // fields of an entry, which usually hold the same specifics, and between
+  // copies of it, like the originals kept by write transactions and the
+  // snapshots taken for saving.  Empty specifics aren't allocated at all.
+  typedef base::RefCountedData<sync_pb::EntitySpecifics> SharedSpecifics;
+
   std::string string_fields[STRING_FIELDS_COUNT];
-  sync_pb::EntitySpecifics specifics_fields[PROTO_FIELDS_COUNT];
+  scoped_refptr<SharedSpecifics> specifics_fields[PROTO_FIELDS_COUNT];
   int64 int64_fields[INT64_FIELDS_COUNT];
   base::Time time_fields[TIME_FIELDS_COUNT];
   Id id_fields[ID_FIELDS_COUNT];
@@ -247,9 +254,11 @@ struct SYNC_EXPORT_PRIVATE EntryKernel {
   inline void put(StringField field, const std::string& value) {
     string_fields[field - STRING_FIELDS_BEGIN] = value;
   }
-  inline void put(ProtoField field, const sync_pb::EntitySpecifics& value) {
-    specifics_fields[field - PROTO_FIELDS_BEGIN].CopyFrom(value);
-  }
+  // Shares the storage of |value| if it is another specifics field of this
+  // entry, and copies it otherwise.
+  void put(ProtoField field, const sync_pb::EntitySpecifics& value);
+  // Moves |value| into |field| without copying it, leaving |value| empty.
+  void take(ProtoField field, sync_pb::EntitySpecifics* value);
   inline void put(UniquePositionField field, const UniquePosition& value) {
     unique_position_fields[field - UNIQUE_POSITION_FIELDS_BEGIN] = value;
   }
@@ -286,7 +295,10 @@ struct SYNC_EXPORT_PRIVATE EntryKernel {
     return string_fields[field - STRING_FIELDS_BEGIN];
   }
   inline const sync_pb::EntitySpecifics& ref(ProtoField field) const {
-    return specifics_fields[field - PROTO_FIELDS_BEGIN];
+    const SharedSpecifics* specifics =
+        specifics_fields[field - PROTO_FIELDS_BEGIN].get();
+    return specifics ? specifics->data :
+        sync_pb::EntitySpecifics::default_instance();
   }
   inline const UniquePosition& ref(UniquePositionField field) const {
     return unique_position_fields[field - UNIQUE_POSITION_FIELDS_BEGIN];
@@ -295,13 +307,11 @@ struct SYNC_EXPORT_PRIVATE EntryKernel {
     return bit_temps[field - BIT_TEMPS_BEGIN];
   }
 
-  // Non-const, mutable ref getters for object types only.
+  // Non-const, mutable ref getters for object types only.  Specifics can
+  // only be replaced, through put() and take().
   inline std::string& mutable_ref(StringField field) {
     return string_fields[field - STRING_FIELDS_BEGIN];
   }
-  inline sync_pb::EntitySpecifics& mutable_ref(ProtoField field) {
-    return specifics_fields[field - PROTO_FIELDS_BEGIN];
-  }
   inline Id& mutable_ref(IdField field) {
     return id_fields[field - ID_FIELDS_BEGIN];
   }
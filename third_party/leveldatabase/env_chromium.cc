@@ -80,11 +80,17 @@ class Retrier {
   RetrierProvider* provider_;
 };
 
+// Every origin's IndexedDB database shares this Env, so give them more than
+// one thread to compact on; a large compaction in one origin would otherwise
+// stall writes in all of them.
+const int kIDBMaxBackgroundThreads = 3;
+
 class IDBEnvStdio : public ChromiumEnvStdio {
  public:
   IDBEnvStdio() : ChromiumEnvStdio() {
     name_ = "LevelDBEnv.IDB";
     make_backup_ = true;
+    max_bg_threads_ = kIDBMaxBackgroundThreads;
   }
 };
 
@@ -94,6 +100,7 @@ class IDBEnvWin : public ChromiumEnvWin {
   IDBEnvWin() : ChromiumEnvWin() {
     name_ = "LevelDBEnv.IDB";
     make_backup_ = true;
+    max_bg_threads_ = kIDBMaxBackgroundThreads;
   }
 };
 #endif
@@ -352,8 +359,10 @@ bool ChromiumEnv::HasTableExtension(const base::FilePath& path)
 ChromiumEnv::ChromiumEnv()
     : name_("LevelDBEnv"),
       make_backup_(false),
+      max_bg_threads_(1),
       bgsignal_(&mu_),
-      started_bgthread_(false),
+      bg_threads_(0),
+      idle_bg_threads_(0),
       kMaxRetryTimeMillis(1000) {
 }
 
@@ -731,6 +740,15 @@ base::HistogramBase* ChromiumEnv::GetLockFileAncestorHistogram() const {
       base::Histogram::kUmaTargetedHistogramFlag);
 }
 
+base::HistogramBase* ChromiumEnv::GetBackgroundQueueTimeHistogram() const {
+  std::string uma_name(name_);
+  uma_name.append(".BackgroundQueueTime");
+  return base::Histogram::FactoryTimeGet(
+      uma_name, base::TimeDelta::FromMilliseconds(1),
+      base::TimeDelta::FromMinutes(1), 50,
+      base::Histogram::kUmaTargetedHistogramFlag);
+}
+
 base::HistogramBase* ChromiumEnv::GetRetryTimeHistogram(MethodID method) const {
   std::string uma_name(name_);
   // TODO(dgrogan): This is probably not the best way to concatenate strings.
@@ -777,22 +795,21 @@ class Thread : public ::base::PlatformThread::Delegate {
 void ChromiumEnv::Schedule(void (*function)(void*), void* arg) {
   mu_.Acquire();
 
-  // Start background thread if necessary
-  if (!started_bgthread_) {
-    started_bgthread_ = true;
-    StartThread(&ChromiumEnv::BGThreadWrapper, this);
-  }
-
-  // If the queue is currently empty, the background thread may currently be
-  // waiting.
-  if (queue_.empty()) {
+  // Wake an idle background thread, or start another one if all of them are
+  // busy and the pool may still grow.
+  if (idle_bg_threads_ > 0) {
     bgsignal_.Signal();
+  } else if (bg_threads_ < max_bg_threads_) {
+    ++bg_threads_;
+    StartThread(&ChromiumEnv::BGThreadWrapper, this);
   }
 
   // Add to priority queue
   queue_.push_back(BGItem());
   queue_.back().function = function;
   queue_.back().arg = arg;
+  queue_.back().enqueue_time = base::TimeTicks::Now();
+  TRACE_COUNTER_ID1("leveldb", "ChromiumEnv::BGQueue", this, queue_.size());
 
   mu_.Release();
 }
@@ -804,14 +821,22 @@ void ChromiumEnv::BGThread() {
     // Wait until there is an item that is ready to run
     mu_.Acquire();
     while (queue_.empty()) {
+      ++idle_bg_threads_;
       bgsignal_.Wait();
+      --idle_bg_threads_;
     }
 
     void (*function)(void*) = queue_.front().function;
     void* arg = queue_.front().arg;
+    base::TimeTicks enqueue_time = queue_.front().enqueue_time;
     queue_.pop_front();
+    TRACE_COUNTER_ID1("leveldb", "ChromiumEnv::BGQueue", this, queue_.size());
 
     mu_.Release();
+    // Time spent queued behind other work is time a compaction could have
+    // been freeing up room for writers.
+    GetBackgroundQueueTimeHistogram()->AddTime(
+        base::TimeTicks::Now() - enqueue_time);
     TRACE_EVENT0("leveldb", "ChromiumEnv::BGThread-Task");
     (*function)(arg);
   }
@@ -11,6 +11,7 @@
 
 #include "base/files/file.h"
 #include "base/metrics/histogram.h"
+#include "base/time/time.h"
 #include "leveldb/env.h"
 #include "port/port_chromium.h"
 #include "util/mutexlock.h"
@@ -145,6 +146,10 @@ class ChromiumEnv : public leveldb::Env,
 
   std::string name_;
   bool make_backup_;
+  // Upper bound on the number of threads running Schedule()d work. LevelDB
+  // never runs two compactions of the same database at once, so more than
+  // one thread only helps an Env shared by several databases.
+  int max_bg_threads_;
 
  private:
   // File locks may not be exclusive within a process (e.g. on POSIX). Track
@@ -181,6 +186,7 @@ class ChromiumEnv : public leveldb::Env,
   void RecordLockFileAncestors(int num_missing_ancestors) const;
   base::HistogramBase* GetMethodIOErrorHistogram() const;
   base::HistogramBase* GetLockFileAncestorHistogram() const;
+  base::HistogramBase* GetBackgroundQueueTimeHistogram() const;
 
   // RetrierProvider implementation.
   virtual int MaxRetryTimeMillis() const { return kMaxRetryTimeMillis; }
@@ -192,12 +198,14 @@ class ChromiumEnv : public leveldb::Env,
 
   ::base::Lock mu_;
   ::base::ConditionVariable bgsignal_;
-  bool started_bgthread_;
+  int bg_threads_;
+  int idle_bg_threads_;
 
   // Entry per Schedule() call
   struct BGItem {
     void* arg;
     void (*function)(void*);
+    base::TimeTicks enqueue_time;
   };
   typedef std::deque<BGItem> BGQueue;
   BGQueue queue_;
@@ -7,6 +7,7 @@
 #include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/test/test_suite.h"
 #include "env_chromium_stdio.h"
 #if defined(OS_WIN)
@@ -255,4 +256,37 @@ TEST(ChromiumEnv, GetChildrenPriorResults) {
   EXPECT_EQ(1, result.size());
 }
 
+struct BlockingTaskState {
+  BlockingTaskState()
+      : second_task_ran(false, false),
+        first_task_done(false, false),
+        first_task_saw_second(false) {}
+  base::WaitableEvent second_task_ran;
+  base::WaitableEvent first_task_done;
+  bool first_task_saw_second;
+};
+
+void WaitForSecondTask(void* arg) {
+  BlockingTaskState* state = static_cast<BlockingTaskState*>(arg);
+  state->first_task_saw_second = state->second_task_ran.TimedWait(
+      base::TimeDelta::FromSeconds(10));
+  state->first_task_done.Signal();
+}
+
+void SignalSecondTask(void* arg) {
+  static_cast<BlockingTaskState*>(arg)->second_task_ran.Signal();
+}
+
+TEST(ChromiumEnv, IDBEnvRunsBackgroundWorkConcurrently) {
+  // The IndexedDB Env is shared by many databases, so a long compaction in
+  // one of them must not hold up work scheduled by another.
+  // Leaked: the background threads may still be touching it on return.
+  BlockingTaskState* state = new BlockingTaskState;
+  Env* env = IDBEnv();
+  env->Schedule(&WaitForSecondTask, state);
+  env->Schedule(&SignalSecondTask, state);
+  state->first_task_done.Wait();
+  EXPECT_TRUE(state->first_task_saw_second);
+}
+
 int main(int argc, char** argv) { return base::TestSuite(argc, argv).Run(); }
@@ -437,8 +437,10 @@ void Compositor::Layout() {
   // We're sending damage that will be addressed during this composite
   // cycle, so we don't need to schedule another composite to address it.
   disable_schedule_composite_ = true;
-  if (root_layer_)
+  if (root_layer_) {
     root_layer_->SendDamagedRects();
+    root_layer_->UpdateSubtreeCaching();
+  }
   disable_schedule_composite_ = false;
 }
 
@@ -50,6 +50,8 @@ Layer::Layer()
       parent_(NULL),
       visible_(true),
       force_render_surface_(false),
+      cache_subtree_(false),
+      caching_subtree_(false),
       fills_bounds_opaquely_(true),
       background_blur_radius_(0),
       layer_saturation_(0.0f),
@@ -73,6 +75,8 @@ Layer::Layer(LayerType type)
       parent_(NULL),
       visible_(true),
       force_render_surface_(false),
+      cache_subtree_(false),
+      caching_subtree_(false),
       fills_bounds_opaquely_(true),
       background_blur_radius_(0),
       layer_saturation_(0.0f),
@@ -463,7 +467,7 @@ void Layer::SwitchToLayer(scoped_refptr<cc::Layer> new_layer) {
   cc_layer_->SetLayerClient(this);
   cc_layer_->SetAnchorPoint(gfx::PointF());
   cc_layer_->SetContentsOpaque(fills_bounds_opaquely_);
-  cc_layer_->SetForceRenderSurface(force_render_surface_);
+  cc_layer_->SetForceRenderSurface(force_render_surface_ || caching_subtree_);
   cc_layer_->SetIsDrawable(type_ != LAYER_NOT_DRAWN);
   cc_layer_->SetHideLayerAndSubtree(!visible_);
 }
@@ -586,6 +590,22 @@ void Layer::SendDamagedRects() {
     children_[i]->SendDamagedRects();
 }
 
+bool Layer::UpdateSubtreeCaching() {
+  bool descendant_animating = false;
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (children_[i]->UpdateSubtreeCaching())
+      descendant_animating = true;
+  }
+
+  bool caching = cache_subtree_ && !descendant_animating;
+  if (caching != caching_subtree_) {
+    caching_subtree_ = caching;
+    cc_layer_->SetForceRenderSurface(force_render_surface_ ||
+                                     caching_subtree_);
+  }
+  return descendant_animating || (animator_.get() && animator_->is_animating());
+}
+
 void Layer::SuppressPaint() {
   if (!delegate_)
     return;
@@ -654,7 +674,16 @@ void Layer::SetForceRenderSurface(bool force) {
     return;
 
   force_render_surface_ = force;
-  cc_layer_->SetForceRenderSurface(force_render_surface_);
+  cc_layer_->SetForceRenderSurface(force_render_surface_ || caching_subtree_);
+}
+
+void Layer::SetCacheSubtree(bool cache_subtree) {
+  if (cache_subtree_ == cache_subtree)
+    return;
+
+  cache_subtree_ = cache_subtree;
+  // The surface is set up, or dropped, at the next commit.
+  ScheduleDraw();
 }
 
 class LayerDebugInfo : public base::debug::ConvertableToTraceFormat {
@@ -287,6 +287,12 @@ class COMPOSITOR_EXPORT Layer
   // |cc_layer_|.
   void SendDamagedRects();
 
+  // Decides, for each layer of this subtree that has the cache subtree hint,
+  // whether its cc layer currently gets a cached render surface. Returns true
+  // if any layer in the subtree is animating. Called by the Compositor before
+  // every commit.
+  bool UpdateSubtreeCaching();
+
   const SkRegion& damaged_region() const { return damaged_region_; }
 
   // Suppresses painting the content by disconnecting |delegate_|.
@@ -330,6 +336,14 @@ class COMPOSITOR_EXPORT Layer
   void SetForceRenderSurface(bool force);
   bool force_render_surface() const { return force_render_surface_; }
 
+  // Hints that this layer's subtree rarely changes. The subtree is then drawn
+  // into a render surface whose contents the compositor keeps across frames,
+  // redrawing only damaged parts, and is composited as a single quad. The
+  // surface isn't used while a descendant is animating, because it would be
+  // redrawn every frame; animations of this layer itself don't matter.
+  void SetCacheSubtree(bool cache_subtree);
+  bool cache_subtree() const { return cache_subtree_; }
+
   // LayerClient
   virtual scoped_refptr<base::debug::ConvertableToTraceFormat>
       TakeDebugInfo() OVERRIDE;
@@ -416,6 +430,11 @@ class COMPOSITOR_EXPORT Layer
 
   bool force_render_surface_;
 
+  // See SetCacheSubtree(). |caching_subtree_| is whether the cc layer currently
+  // has a render surface for it.
+  bool cache_subtree_;
+  bool caching_subtree_;
+
   bool fills_bounds_opaquely_;
 
   // Union of damaged rects, in pixel coordinates, to be used when
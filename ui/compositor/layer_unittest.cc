@@ -1520,4 +1520,43 @@ TEST_F(LayerWithRealCompositorTest, SwitchCCLayerAnimations) {
   EXPECT_FLOAT_EQ(l1->opacity(), 0.5f);
 }
 
+// Tests that a subtree with the cache hint gets a render surface only while
+// none of its descendants are animating.
+TEST_F(LayerWithRealCompositorTest, CacheSubtree) {
+  scoped_ptr<Layer> root(CreateLayer(LAYER_TEXTURED));
+  scoped_ptr<Layer> parent(CreateLayer(LAYER_TEXTURED));
+  scoped_ptr<Layer> child(CreateLayer(LAYER_TEXTURED));
+  root->Add(parent.get());
+  parent->Add(child.get());
+
+  parent->SetCacheSubtree(true);
+  EXPECT_FALSE(parent->cc_layer()->force_render_surface());
+  EXPECT_FALSE(root->UpdateSubtreeCaching());
+  EXPECT_TRUE(parent->cc_layer()->force_render_surface());
+
+  // Animating the layer itself doesn't invalidate the cached contents.
+  parent->SetAnimator(LayerAnimator::CreateImplicitAnimator());
+  parent->SetOpacity(0.5f);
+  EXPECT_TRUE(root->UpdateSubtreeCaching());
+  EXPECT_TRUE(parent->cc_layer()->force_render_surface());
+  parent->GetAnimator()->StopAnimating();
+
+  // Animating a descendant does, until the animation is over.
+  child->SetAnimator(LayerAnimator::CreateImplicitAnimator());
+  child->SetOpacity(0.5f);
+  EXPECT_TRUE(root->UpdateSubtreeCaching());
+  EXPECT_FALSE(parent->cc_layer()->force_render_surface());
+  child->GetAnimator()->StopAnimating();
+  EXPECT_FALSE(root->UpdateSubtreeCaching());
+  EXPECT_TRUE(parent->cc_layer()->force_render_surface());
+
+  // A forced render surface stays when the hint is removed.
+  parent->SetForceRenderSurface(true);
+  parent->SetCacheSubtree(false);
+  root->UpdateSubtreeCaching();
+  EXPECT_TRUE(parent->cc_layer()->force_render_surface());
+  parent->SetForceRenderSurface(false);
+  EXPECT_FALSE(parent->cc_layer()->force_render_surface());
+}
+
 }  // namespace ui
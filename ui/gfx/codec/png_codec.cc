@@ -593,6 +593,12 @@ bool DoLibpngWrite(png_struct* png_ptr, png_info* info_ptr,
 
   png_set_compression_level(png_ptr, compression_level);
 
+  // By default libpng tries every filter on every row and keeps the one that
+  // looks most compressible, which costs more than zlib itself at its fastest
+  // level. The Sub filter alone does nearly as well on screen content.
+  if (compression_level == Z_BEST_SPEED)
+    png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+
   // Set our callback for libpng to give us the data.
   png_set_write_fn(png_ptr, state, EncoderWriteCallback, FakeFlushCallback);
   png_set_error_fn(png_ptr, NULL, LogLibPNGEncodeError, LogLibPNGEncodeWarning);
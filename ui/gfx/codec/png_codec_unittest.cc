@@ -1186,5 +1186,20 @@ TEST(PNGCodec, EncodeDecodeWithVaryingCompressionLevels) {
   EXPECT_TRUE(BitmapsAreEqual(decoded, original_bitmap));
 }
 
+TEST(PNGCodec, FastEncodeLargeBitmap) {
+  const int w = 1024, h = 768;
+
+  SkBitmap original_bitmap;
+  MakeTestBGRASkBitmap(w, h, &original_bitmap);
+
+  std::vector<unsigned char> encoded;
+  ASSERT_TRUE(
+      PNGCodec::FastEncodeBGRASkBitmap(original_bitmap, false, &encoded));
+
+  SkBitmap decoded;
+  ASSERT_TRUE(PNGCodec::Decode(&encoded[0], encoded.size(), &decoded));
+  EXPECT_TRUE(BitmapsAreEqual(decoded, original_bitmap));
+}
+
 
 }  // namespace gfx
@@ -4,8 +4,14 @@
 
 #include "ui/gfx/image/image_skia_operations.h"
 
+#include <list>
+
+#include "base/bind.h"
 #include "base/command_line.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/message_loop/message_loop.h"
 #include "skia/ext/image_operations.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/image/canvas_image_source.h"
@@ -373,6 +379,79 @@ class ResizeSource : public ImageSkiaSource {
   DISALLOW_COPY_AND_ASSIGN(ResizeSource);
 };
 
+// The number of resized images ResizedImageCache keeps alive.
+const size_t kMaxCachedResizedImages = 64;
+
+// Remembers the images CreateResizedImage() recently returned, so that views
+// asking for the same resize of the same image share one ImageSkia and its
+// reps are generated once per scale. Resizing an image that is itself a
+// cached resize resizes the original instead, so the pixels are resampled
+// once however long the chain. The cache is dropped on memory pressure.
+class ResizedImageCache {
+ public:
+  ResizedImageCache()
+      : memory_pressure_listener_(
+            base::Bind(&ResizedImageCache::OnMemoryPressure,
+                       base::Unretained(this))) {
+  }
+
+  ImageSkia GetResizedImage(const ImageSkia& source,
+                            skia::ImageOperations::ResizeMethod method,
+                            const Size& target_dip_size) {
+    ImageSkia original = source;
+    for (Entries::const_iterator it = entries_.begin(); it != entries_.end();
+         ++it) {
+      if (it->resized.BackedBySameObjectAs(source)) {
+        original = it->source;
+        break;
+      }
+    }
+
+    for (Entries::iterator it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->source.BackedBySameObjectAs(original) &&
+          it->method == method &&
+          it->target_dip_size == target_dip_size) {
+        entries_.splice(entries_.begin(), entries_, it);
+        return it->resized;
+      }
+    }
+
+    Entry entry;
+    entry.source = original;
+    entry.method = method;
+    entry.target_dip_size = target_dip_size;
+    entry.resized = ImageSkia(
+        new ResizeSource(original, method, target_dip_size), target_dip_size);
+    entries_.push_front(entry);
+    if (entries_.size() > kMaxCachedResizedImages)
+      entries_.pop_back();
+    return entry.resized;
+  }
+
+ private:
+  struct Entry {
+    ImageSkia source;
+    skia::ImageOperations::ResizeMethod method;
+    Size target_dip_size;
+    ImageSkia resized;
+  };
+  // Most recently used first.
+  typedef std::list<Entry> Entries;
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level) {
+    entries_.clear();
+  }
+
+  Entries entries_;
+  base::MemoryPressureListener memory_pressure_listener_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResizedImageCache);
+};
+
+base::LazyInstance<ResizedImageCache>::Leaky g_resized_image_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
 // DropShadowSource generates image reps with drop shadow for image reps in
 // |source| that represent requested scale factors.
 class DropShadowSource : public ImageSkiaSource {
@@ -524,6 +603,12 @@ ImageSkia ImageSkiaOperations::CreateResizedImage(
   if (source.isNull())
     return ImageSkia();
 
+  // ImageSkia is bound to the thread using it, so only the UI thread, where
+  // views ask for the same resizes over and over, shares resized images.
+  if (base::MessageLoopForUI::IsCurrent()) {
+    return g_resized_image_cache.Get().GetResizedImage(
+        source, method, target_dip_size);
+  }
   return ImageSkia(new ResizeSource(source, method, target_dip_size),
                    target_dip_size);
 }
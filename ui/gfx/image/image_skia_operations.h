@@ -79,7 +79,9 @@ class GFX_EXPORT ImageSkiaOperations {
   static ImageSkia ExtractSubset(const gfx::ImageSkia& image,
                                  const gfx::Rect& subset_bounds);
 
-  // Creates an image by resizing |source| to given |target_dip_size|.
+  // Creates an image by resizing |source| to given |target_dip_size|. On the
+  // UI thread, recent calls with the same arguments return the same image, and
+  // resizing a resized image resamples the original |source|.
   static ImageSkia CreateResizedImage(const ImageSkia& source,
                                       skia::ImageOperations::ResizeMethod methd,
                                       const Size& target_dip_size);
@@ -5,9 +5,11 @@
 #include "ui/gfx/image/image_skia.h"
 
 #include "base/logging.h"
+#include "base/message_loop/message_loop.h"
 #include "base/threading/simple_thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/image/image_skia_operations.h"
 #include "ui/gfx/image/image_skia_rep.h"
 #include "ui/gfx/image/image_skia_source.h"
 #include "ui/gfx/size.h"
@@ -372,6 +374,29 @@ TEST(ImageSkiaTest, SourceOnThreadTest) {
 }
 #endif  // ENABLE_NON_THREAD_SAFE
 
+// Tests that the UI thread shares resized images, and resizes a resized image
+// from its original.
+TEST(ImageSkiaTest, SharedResizedImages) {
+  base::MessageLoopForUI message_loop;
+  ImageSkia image(new DynamicSource(Size(100, 100)), Size(100, 100));
+
+  ImageSkia resized = ImageSkiaOperations::CreateResizedImage(
+      image, skia::ImageOperations::RESIZE_BEST, Size(50, 50));
+  EXPECT_TRUE(resized.BackedBySameObjectAs(
+      ImageSkiaOperations::CreateResizedImage(
+          image, skia::ImageOperations::RESIZE_BEST, Size(50, 50))));
+  EXPECT_FALSE(resized.BackedBySameObjectAs(
+      ImageSkiaOperations::CreateResizedImage(
+          image, skia::ImageOperations::RESIZE_BEST, Size(40, 40))));
+
+  ImageSkia resized_twice = ImageSkiaOperations::CreateResizedImage(
+      resized, skia::ImageOperations::RESIZE_BEST, Size(20, 20));
+  EXPECT_TRUE(resized_twice.BackedBySameObjectAs(
+      ImageSkiaOperations::CreateResizedImage(
+          image, skia::ImageOperations::RESIZE_BEST, Size(20, 20))));
+  EXPECT_EQ(40, resized_twice.GetRepresentation(2.0f).pixel_width());
+}
+
 // Just in case we ever get lumped together with other compilation units.
 #undef ENABLE_NON_THREAD_SAFE
 
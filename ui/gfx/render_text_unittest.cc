@@ -1886,6 +1886,42 @@ TEST_F(RenderTextTest, Win_BreakRunsByUnicodeBlocks) {
   EXPECT_EQ(Range(2, 3), render_text->runs_[1]->range);
   EXPECT_EQ(Range(3, 5), render_text->runs_[2]->range);
 }
+
+// Ensure runs reusing the shaping of equal runs get the same glyphs and
+// widths as the first run shaped.
+TEST_F(RenderTextTest, Win_CachedShaping) {
+  scoped_ptr<RenderTextWin> render_text(
+      static_cast<RenderTextWin*>(RenderText::CreateInstance()));
+  render_text->SetText(WideToUTF16(L"abc \x25B6 def"));
+  render_text->EnsureLayout();
+  ASSERT_EQ(3U, render_text->runs_.size());
+
+  scoped_ptr<RenderTextWin> other_text(
+      static_cast<RenderTextWin*>(RenderText::CreateInstance()));
+  other_text->SetText(WideToUTF16(L"abc \x25B6 xyz"));
+  other_text->EnsureLayout();
+  ASSERT_EQ(3U, other_text->runs_.size());
+
+  for (size_t i = 0; i < 2; ++i) {
+    SCOPED_TRACE(base::StringPrintf("runs_[%" PRIuS "]", i));
+    const internal::TextRun* run = render_text->runs_[i];
+    const internal::TextRun* other_run = other_text->runs_[i];
+    EXPECT_EQ(run->range, other_run->range);
+    EXPECT_EQ(run->font.GetFontName(), other_run->font.GetFontName());
+    EXPECT_EQ(run->width, other_run->width);
+    ASSERT_EQ(run->glyph_count, other_run->glyph_count);
+    for (int j = 0; j < run->glyph_count; ++j) {
+      EXPECT_EQ(run->glyphs[j], other_run->glyphs[j]);
+      EXPECT_EQ(run->advance_widths[j], other_run->advance_widths[j]);
+    }
+    for (size_t j = 0; j < run->range.length(); ++j)
+      EXPECT_EQ(run->logical_clusters[j], other_run->logical_clusters[j]);
+  }
+  EXPECT_EQ(render_text->GetStringSize().width() -
+                render_text->runs_[2]->width,
+            other_text->GetStringSize().width() -
+                other_text->runs_[2]->width);
+}
 #endif  // defined(OS_WIN)
 
 }  // namespace gfx
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "base/containers/mru_cache.h"
 #include "base/i18n/break_iterator.h"
 #include "base/i18n/char_iterator.h"
 #include "base/i18n/rtl.h"
@@ -37,6 +38,114 @@ const size_t kMaxRuns = 10000;
 // The maximum number of glyphs per run; ScriptShape fails on larger values.
 const size_t kMaxGlyphs = 65535;
 
+// The number of shaped runs kept in the process-wide cache, and the maximum
+// length of the runs that are cached, to bound its memory use.
+const size_t kMaxCachedRuns = 1000;
+const size_t kMaxCachedRunLength = 256;
+
+// Identifies the shaping of a run: its text, font and script analysis.
+struct ShapedRunKey {
+  base::string16 text;
+  std::string font_name;
+  int font_size;
+  int font_style;
+  SCRIPT_ANALYSIS script_analysis;
+
+  bool operator<(const ShapedRunKey& other) const {
+    if (text != other.text)
+      return text < other.text;
+    if (font_name != other.font_name)
+      return font_name < other.font_name;
+    if (font_size != other.font_size)
+      return font_size < other.font_size;
+    if (font_style != other.font_style)
+      return font_style < other.font_style;
+    return memcmp(&script_analysis, &other.script_analysis,
+                  sizeof(script_analysis)) < 0;
+  }
+};
+
+// The glyphs and placement that shaping a run produced.
+struct ShapedRun {
+  Font font;
+  SCRIPT_ANALYSIS script_analysis;
+  int glyph_count;
+  scoped_ptr<WORD[]> glyphs;
+  scoped_ptr<WORD[]> logical_clusters;
+  scoped_ptr<SCRIPT_VISATTR[]> visible_attributes;
+  scoped_ptr<int[]> advance_widths;
+  scoped_ptr<GOFFSET[]> offsets;
+  ABC abc_widths;
+};
+
+// Runs shaped by any RenderTextWin, most recently used first.  Text that is
+// laid out over and over, like the strings drawn by Canvas on every paint, and
+// the runs an edit didn't change are not shaped again.
+typedef base::OwningMRUCache<ShapedRunKey, ShapedRun*> ShapedRunCache;
+
+ShapedRunCache* GetShapedRunCache() {
+  CR_DEFINE_STATIC_LOCAL(ShapedRunCache, cache, (kMaxCachedRuns));
+  return &cache;
+}
+
+template <typename T>
+void CopyArray(const scoped_ptr<T[]>& from,
+               size_t count,
+               scoped_ptr<T[]>* to) {
+  to->reset(new T[count]);
+  std::copy(from.get(), from.get() + count, to->get());
+}
+
+// Fills |key| with the identity of |run| of |layout_text|, before shaping.
+void GetShapedRunKey(const base::string16& layout_text,
+                     const internal::TextRun& run,
+                     ShapedRunKey* key) {
+  key->text = layout_text.substr(run.range.start(), run.range.length());
+  key->font_name = run.font.GetFontName();
+  key->font_size = run.font.GetFontSize();
+  key->font_style = run.font_style;
+  key->script_analysis = run.script_analysis;
+}
+
+// Copies the shaping cached under |key| into |run|, if any.
+bool GetCachedShaping(const ShapedRunKey& key, internal::TextRun* run) {
+  ShapedRunCache* cache = GetShapedRunCache();
+  ShapedRunCache::iterator it = cache->Get(key);
+  if (it == cache->end())
+    return false;
+
+  const ShapedRun& shaped = *it->second;
+  run->font = shaped.font;
+  run->script_analysis = shaped.script_analysis;
+  run->glyph_count = shaped.glyph_count;
+  CopyArray(shaped.glyphs, shaped.glyph_count, &run->glyphs);
+  CopyArray(shaped.logical_clusters, run->range.length(),
+            &run->logical_clusters);
+  CopyArray(shaped.visible_attributes, shaped.glyph_count,
+            &run->visible_attributes);
+  CopyArray(shaped.advance_widths, shaped.glyph_count, &run->advance_widths);
+  CopyArray(shaped.offsets, shaped.glyph_count, &run->offsets);
+  run->abc_widths = shaped.abc_widths;
+  return true;
+}
+
+// Caches the shaping of |run| under |key|.
+void CacheShaping(const ShapedRunKey& key, const internal::TextRun& run) {
+  ShapedRun* shaped = new ShapedRun;
+  shaped->font = run.font;
+  shaped->script_analysis = run.script_analysis;
+  shaped->glyph_count = run.glyph_count;
+  CopyArray(run.glyphs, run.glyph_count, &shaped->glyphs);
+  CopyArray(run.logical_clusters, run.range.length(),
+            &shaped->logical_clusters);
+  CopyArray(run.visible_attributes, run.glyph_count,
+            &shaped->visible_attributes);
+  CopyArray(run.advance_widths, run.glyph_count, &shaped->advance_widths);
+  CopyArray(run.offsets, run.glyph_count, &shaped->offsets);
+  shaped->abc_widths = run.abc_widths;
+  GetShapedRunCache()->Put(key, shaped);
+}
+
 // Callback to |EnumEnhMetaFile()| to intercept font creation.
 int CALLBACK MetaFileEnumProc(HDC hdc,
                               HANDLETABLE* table,
@@ -999,26 +1108,34 @@ void RenderTextWin::LayoutVisualText() {
   int descent = font_list().GetHeight() - font_list().GetBaseline();
   for (size_t i = 0; i < runs_.size(); ++i) {
     internal::TextRun* run = runs_[i];
-    LayoutTextRun(run);
+    ShapedRunKey key;
+    const bool cacheable = run->range.length() <= kMaxCachedRunLength;
+    if (cacheable)
+      GetShapedRunKey(GetLayoutText(), *run, &key);
+    if (!cacheable || !GetCachedShaping(key, run)) {
+      LayoutTextRun(run);
+      if (run->glyph_count > 0) {
+        run->advance_widths.reset(new int[run->glyph_count]);
+        run->offsets.reset(new GOFFSET[run->glyph_count]);
+        hr = ScriptPlace(cached_hdc_,
+                         &run->script_cache,
+                         run->glyphs.get(),
+                         run->glyph_count,
+                         run->visible_attributes.get(),
+                         &(run->script_analysis),
+                         run->advance_widths.get(),
+                         run->offsets.get(),
+                         &(run->abc_widths));
+        DCHECK(SUCCEEDED(hr));
+      }
+
+      if (cacheable && run->glyph_count > 0)
+        CacheShaping(key, *run);
+    }
 
     ascent = std::max(ascent, run->font.GetBaseline());
     descent = std::max(descent,
                        run->font.GetHeight() - run->font.GetBaseline());
-
-    if (run->glyph_count > 0) {
-      run->advance_widths.reset(new int[run->glyph_count]);
-      run->offsets.reset(new GOFFSET[run->glyph_count]);
-      hr = ScriptPlace(cached_hdc_,
-                       &run->script_cache,
-                       run->glyphs.get(),
-                       run->glyph_count,
-                       run->visible_attributes.get(),
-                       &(run->script_analysis),
-                       run->advance_widths.get(),
-                       run->offsets.get(),
-                       &(run->abc_widths));
-      DCHECK(SUCCEEDED(hr));
-    }
   }
 
   // Build the array of bidirectional embedding levels.
@@ -0,0 +1,90 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "url/gurl_view.h"
+
+#include "base/logging.h"
+#include "url/gurl.h"
+#include "url/url_util.h"
+
+GURLView::GURLView(const GURL& url)
+    : spec_(url.possibly_invalid_spec().data()),
+      spec_len_(static_cast<int>(url.possibly_invalid_spec().length())),
+      is_valid_(url.is_valid()),
+      parsed_(url.parsed_for_possibly_invalid_spec()) {
+}
+
+GURLView::GURLView(const base::StringPiece& url_string,
+                   url_canon::CanonOutput* buffer) {
+  DCHECK_EQ(0, buffer->length());
+  is_valid_ = url_util::Canonicalize(
+      url_string.data(), static_cast<int>(url_string.length()), true, NULL,
+      buffer, &parsed_);
+  InitFromBuffer(buffer);
+}
+
+GURLView::GURLView(const GURL& url,
+                   const url_canon::Replacements<char>& replacements,
+                   url_canon::CanonOutput* buffer) {
+  DCHECK_EQ(0, buffer->length());
+  // Not allowed for invalid URLs.
+  if (url.is_valid()) {
+    const std::string& spec = url.possibly_invalid_spec();
+    is_valid_ = url_util::ReplaceComponents(
+        spec.data(), static_cast<int>(spec.length()),
+        url.parsed_for_possibly_invalid_spec(), replacements, NULL, buffer,
+        &parsed_);
+  } else {
+    is_valid_ = false;
+  }
+  InitFromBuffer(buffer);
+}
+
+base::StringPiece GURLView::spec() const {
+  if (is_valid_ || spec_len_ == 0)
+    return possibly_invalid_spec();
+
+  DCHECK(false) << "Trying to get the spec of an invalid URL!";
+  return base::StringPiece();
+}
+
+bool GURLView::SchemeIs(const char* lower_ascii_scheme) const {
+  if (parsed_.scheme.len <= 0)
+    return lower_ascii_scheme == NULL;
+  return url_util::LowerCaseEqualsASCII(spec_ + parsed_.scheme.begin,
+                                        spec_ + parsed_.scheme.end(),
+                                        lower_ascii_scheme);
+}
+
+bool GURLView::SchemeIsHTTPOrHTTPS() const {
+  return SchemeIs("http") || SchemeIs("https");
+}
+
+bool GURLView::SchemeIsWSOrWSS() const {
+  return SchemeIs("ws") || SchemeIs("wss");
+}
+
+int GURLView::IntPort() const {
+  if (parsed_.port.is_nonempty())
+    return url_parse::ParsePort(spec_, parsed_.port);
+  return url_parse::PORT_UNSPECIFIED;
+}
+
+int GURLView::EffectiveIntPort() const {
+  int int_port = IntPort();
+  if (int_port == url_parse::PORT_UNSPECIFIED &&
+      url_util::IsStandard(spec_, parsed_.scheme))
+    return url_canon::DefaultPortForScheme(spec_ + parsed_.scheme.begin,
+                                           parsed_.scheme.len);
+  return int_port;
+}
+
+GURL GURLView::ToGURL() const {
+  return GURL(spec_, spec_len_, parsed_, is_valid_);
+}
+
+void GURLView::InitFromBuffer(url_canon::CanonOutput* buffer) {
+  spec_ = buffer->data();
+  spec_len_ = buffer->length();
+}
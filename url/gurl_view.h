@@ -0,0 +1,114 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef URL_GURL_VIEW_H_
+#define URL_GURL_VIEW_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+#include "url/url_canon.h"
+#include "url/url_export.h"
+#include "url/url_parse.h"
+
+class GURL;
+
+// GURLView is a parsed, canonical URL that doesn't own its spec. It either
+// refers to the spec of an existing GURL, or canonicalizes into a buffer
+// supplied by the caller, typically a url_canon::RawCanonOutput on the stack.
+// This avoids the heap allocation of a GURL for URLs that are only inspected,
+// for example to compute a slightly different spec and compare it or copy it
+// somewhere else.
+//
+// The view is only valid as long as the GURL or the buffer it refers to, and
+// the buffer must not be written to while the view is in use:
+//
+//   url_canon::RawCanonOutput<1024> buffer;
+//   url_canon::Replacements<char> replacements;
+//   replacements.ClearRef();
+//   GURLView view(url, replacements, &buffer);
+//   if (view.is_valid())
+//     Use(view.spec());
+//
+// Filesystem URLs are canonicalized like any other, but the view doesn't
+// provide access to their inner URL.
+class URL_EXPORT GURLView {
+ public:
+  // Refers to the spec of |url|, which must outlive the view.
+  explicit GURLView(const GURL& url);
+
+  // Canonicalizes |url_string|, which must be UTF-8, into |buffer|, in the
+  // same way as the GURL constructor.
+  GURLView(const base::StringPiece& url_string, url_canon::CanonOutput* buffer);
+
+  // Canonicalizes |url| with |replacements| applied into |buffer|, in the same
+  // way as GURL::ReplaceComponents. The view is invalid if |url| is.
+  GURLView(const GURL& url,
+           const url_canon::Replacements<char>& replacements,
+           url_canon::CanonOutput* buffer);
+
+  // See the GURL accessors of the same names.
+  bool is_valid() const { return is_valid_; }
+  bool is_empty() const { return spec_len_ == 0; }
+
+  // Returns the spec, or an empty string if the view isn't valid.
+  base::StringPiece spec() const;
+  base::StringPiece possibly_invalid_spec() const {
+    return base::StringPiece(spec_, spec_len_);
+  }
+  const url_parse::Parsed& parsed_for_possibly_invalid_spec() const {
+    return parsed_;
+  }
+
+  bool SchemeIs(const char* lower_ascii_scheme) const;
+  bool SchemeIsHTTPOrHTTPS() const;
+  bool SchemeIsWSOrWSS() const;
+
+  base::StringPiece scheme_piece() const {
+    return ComponentPiece(parsed_.scheme);
+  }
+  base::StringPiece host_piece() const {
+    return ComponentPiece(parsed_.host);
+  }
+  base::StringPiece path_piece() const {
+    return ComponentPiece(parsed_.path);
+  }
+  base::StringPiece query_piece() const {
+    return ComponentPiece(parsed_.query);
+  }
+  base::StringPiece ref_piece() const {
+    return ComponentPiece(parsed_.ref);
+  }
+
+  bool has_host() const { return parsed_.host.len > 0; }
+  bool has_port() const { return parsed_.port.len >= 0; }
+  bool has_query() const { return parsed_.query.len >= 0; }
+  bool has_ref() const { return parsed_.ref.len >= 0; }
+
+  int IntPort() const;
+  int EffectiveIntPort() const;
+
+  // Copies the view into a GURL.
+  GURL ToGURL() const;
+
+ private:
+  // Finishes canonicalizing into |buffer|.
+  void InitFromBuffer(url_canon::CanonOutput* buffer);
+
+  base::StringPiece ComponentPiece(const url_parse::Component& comp) const {
+    if (comp.len <= 0)
+      return base::StringPiece();
+    return base::StringPiece(spec_ + comp.begin, comp.len);
+  }
+
+  const char* spec_;
+  int spec_len_;
+  bool is_valid_;
+  url_parse::Parsed parsed_;
+
+  DISALLOW_COPY_AND_ASSIGN(GURLView);
+};
+
+#endif  // URL_GURL_VIEW_H_
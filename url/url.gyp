@@ -22,6 +22,8 @@
       'sources': [
         'gurl.cc',
         'gurl.h',
+        'gurl_view.cc',
+        'gurl_view.h',
         'third_party/mozilla/url_parse.cc',
         'third_party/mozilla/url_parse.h',
         'url_canon.h',
@@ -73,6 +75,7 @@
       ],
       'sources': [
         'gurl_unittest.cc',
+        'gurl_view_unittest.cc',
         'url_canon_unittest.cc',
         'url_parse_unittest.cc',
         'url_test_utils.h',
@@ -96,5 +99,18 @@
       # TODO(jschuh): crbug.com/167187 fix size_t to int truncations.
       'msvs_disabled_warnings': [4267, ],
     },
+    {
+      'target_name': 'url_perftests',
+      'type': 'executable',
+      'dependencies': [
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gtest.gyp:gtest',
+        'url_lib',
+      ],
+      'sources': [
+        'url_canon_perftest.cc',
+      ],
+    },
   ],
 }
@@ -118,6 +118,11 @@ bool DoSimpleHost(const INCHAR* host,
 
   bool success = true;
   for (int i = 0; i < host_len; ++i) {
+    // Bulk-copy the characters that are already canonical.
+    i += AppendCanonicalChars(host, i, host_len, CANONICAL_HOST_CHARS, output);
+    if (i == host_len)
+      break;
+
     unsigned int source = host[i];
     if (source == '%') {
       // Unescape first, if possible.
@@ -8,8 +8,21 @@
 #include <cstdio>
 #include <string>
 
+#include "build/build_config.h"
 #include "url/url_canon_internal.h"
 
+// SSE2 is part of the x86-64 baseline, 32-bit builds only get it when the
+// compiler is allowed to assume it.
+#if defined(ARCH_CPU_X86_64) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define URL_CANON_USE_SSE2
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <emmintrin.h>
+#endif
+#endif
+
 namespace url_canon {
 
 namespace {
@@ -58,6 +71,80 @@ void DoAppendInvalidNarrowString(const CHAR* spec, int begin, int end,
   }
 }
 
+inline bool IsCanonicalChar(unsigned char c, CanonicalCharSet char_set) {
+  bool is_digit = c >= '0' && c <= '9';
+  bool is_lower = c >= 'a' && c <= 'z';
+  switch (char_set) {
+    case CANONICAL_PATH_CHARS:
+      return is_digit || is_lower || (c >= 'A' && c <= 'Z') ||
+             c == '-' || c == '_' || c == '/';
+    case CANONICAL_HOST_CHARS:
+      return is_digit || is_lower || c == '-' || c == '.';
+    case CANONICAL_QUERY_CHARS:
+      return IsQueryChar(c);
+  }
+  NOTREACHED();
+  return false;
+}
+
+#if defined(URL_CANON_USE_SSE2)
+
+// Returns a mask with 0xff for each byte of |chars| that is in ['lo', 'hi'].
+// The comparisons are signed, which is fine for bounds below 0x80 since the
+// bytes with the high bit set compare as negative and so are never in range.
+inline __m128i InRange(__m128i chars, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(lo - 1)),
+                       _mm_cmplt_epi8(chars, _mm_set1_epi8(hi + 1)));
+}
+
+inline __m128i Equals(__m128i chars, char c) {
+  return _mm_cmpeq_epi8(chars, _mm_set1_epi8(c));
+}
+
+// Returns a bit for each of the 16 bytes at |spec|, set if the byte is in
+// |char_set|. Must give the same answers as IsCanonicalChar().
+inline int CanonicalCharMask(const char* spec, CanonicalCharSet char_set) {
+  __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(spec));
+  __m128i digits = InRange(chars, '0', '9');
+  __m128i result;
+  switch (char_set) {
+    case CANONICAL_PATH_CHARS: {
+      // Setting 0x20 lowercases the letters, and maps no other character to
+      // a letter.
+      __m128i letters =
+          InRange(_mm_or_si128(chars, _mm_set1_epi8(0x20)), 'a', 'z');
+      __m128i punctuation = _mm_or_si128(
+          _mm_or_si128(Equals(chars, '-'), Equals(chars, '_')),
+          Equals(chars, '/'));
+      result = _mm_or_si128(_mm_or_si128(letters, digits), punctuation);
+      break;
+    }
+    case CANONICAL_HOST_CHARS: {
+      __m128i punctuation =
+          _mm_or_si128(Equals(chars, '-'), Equals(chars, '.'));
+      result = _mm_or_si128(_mm_or_si128(InRange(chars, 'a', 'z'), digits),
+                            punctuation);
+      break;
+    }
+    case CANONICAL_QUERY_CHARS: {
+      // Printable characters except for those kSharedCharTypeTable escapes.
+      __m128i escaped = _mm_or_si128(
+          _mm_or_si128(Equals(chars, '"'), Equals(chars, '#')),
+          _mm_or_si128(
+              Equals(chars, '\''),
+              _mm_or_si128(Equals(chars, '<'), Equals(chars, '>'))));
+      result = _mm_andnot_si128(escaped, InRange(chars, '!', '~'));
+      break;
+    }
+    default:
+      NOTREACHED();
+      return 0;
+  }
+  return _mm_movemask_epi8(result);
+}
+
+#endif  // URL_CANON_USE_SSE2
+
 // Overrides one component, see the url_canon::Replacements structure for
 // what the various combionations of source pointer and component mean.
 void DoOverrideComponent(const char* override_source,
@@ -257,6 +344,27 @@ void AppendInvalidNarrowString(const base::char16* spec, int begin, int end,
       spec, begin, end, output);
 }
 
+int CountCanonicalChars(const char* spec, int begin, int end,
+                        CanonicalCharSet char_set) {
+  int i = begin;
+#if defined(URL_CANON_USE_SSE2)
+  for (; i + 16 <= end; i += 16) {
+    int mask = CanonicalCharMask(&spec[i], char_set);
+    if (mask != 0xffff) {
+      // The first clear bit is the first character that isn't canonical.
+      int count = 0;
+      while (mask & (1 << count))
+        count++;
+      return i + count - begin;
+    }
+  }
+#endif
+  while (i < end && IsCanonicalChar(static_cast<unsigned char>(spec[i]),
+                                    char_set))
+    i++;
+  return i - begin;
+}
+
 bool ConvertUTF16ToUTF8(const base::char16* input, int input_len,
                         CanonOutput* output) {
   bool success = true;
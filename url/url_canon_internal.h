@@ -72,6 +72,45 @@ inline bool IsComponentChar(unsigned char c) {
   return IsCharOfType(c, CHAR_COMPONENT);
 }
 
+// The characters the path, host and query canonicalizers copy to the output
+// unchanged, narrowed down to sets that can be tested 16 at a time. The
+// canonicalizers handle all other characters themselves.
+enum CanonicalCharSet {
+  // ASCII letters, digits, '-', '_' and '/'.
+  CANONICAL_PATH_CHARS,
+
+  // Lowercase ASCII letters, digits, '-' and '.'.
+  CANONICAL_HOST_CHARS,
+
+  // The characters with CHAR_QUERY: printable ASCII except for the quotes,
+  // '#', '<' and '>'.
+  CANONICAL_QUERY_CHARS,
+};
+
+// Returns the number of characters at the start of |spec|[begin, end) that
+// are in |char_set|, and so can be bulk-appended to the output. Most URLs are
+// already canonical, so this lets the canonicalizers skip their per-character
+// handling for long runs. Uses SSE2 where it is available.
+URL_EXPORT int CountCanonicalChars(const char* spec, int begin, int end,
+                                   CanonicalCharSet char_set);
+
+// Appends the characters CountCanonicalChars() finds to |output|, and returns
+// how many there were. The fast path only applies to 8-bit input and output;
+// other combinations append nothing.
+inline int AppendCanonicalChars(const char* spec, int begin, int end,
+                                CanonicalCharSet char_set,
+                                CanonOutput* output) {
+  int count = CountCanonicalChars(spec, begin, end, char_set);
+  output->Append(&spec[begin], count);
+  return count;
+}
+template<typename CHAR, typename OUTCHAR>
+inline int AppendCanonicalChars(const CHAR* spec, int begin, int end,
+                                CanonicalCharSet char_set,
+                                CanonOutputT<OUTCHAR>* output) {
+  return 0;
+}
+
 // Appends the given string to the output, escaping characters that do not
 // match the given |type| in SharedCharTypes.
 void AppendStringOfType(const char* source, int length,
@@ -184,6 +184,12 @@ bool DoPartialPath(const CHAR* spec,
 
   bool success = true;
   for (int i = path.begin; i < end; i++) {
+    // Bulk-copy the characters that need no handling up to the next one that
+    // might.
+    i += AppendCanonicalChars(spec, i, end, CANONICAL_PATH_CHARS, output);
+    if (i == end)
+      break;
+
     UCHAR uch = static_cast<UCHAR>(spec[i]);
     if (sizeof(CHAR) > sizeof(char) && uch >= 0x80) {
       // We only need to test wide input for having non-ASCII characters. For
@@ -0,0 +1,104 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// GURL construction canonicalizes every URL, and happens throughout the
+// network stack and the browser, so it should be fast on the URLs that are
+// actually seen. Those are overwhelmingly ASCII and already canonical.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_time_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "url/url_canon.h"
+#include "url/url_canon_stdstring.h"
+#include "url/url_parse.h"
+
+namespace {
+
+// A mix of the kinds of URLs a page load involves.
+const char* const kCanonicalURLs[] = {
+  "http://www.example.com/",
+  "https://www.google.com/search?q=chromium+url+canonicalization&ie=UTF-8",
+  "https://ssl.gstatic.com/gb/images/v1_76783e20.png",
+  "http://static.example-cdn.net/assets/js/application-3f2a9b1c8d.min.js",
+  "https://fonts.googleapis.com/css?family=Open+Sans:400,700&subset=latin",
+  "http://ads.example.org/pixel?id=123456789&ts=1391234567&ref=http%3A%2F%2F"
+      "www.example.com%2Farticle",
+  "https://en.wikipedia.org/wiki/Uniform_resource_locator",
+  "https://api.example.com/v2/users/12345/timeline?count=50&since_id=987654",
+  "http://www.example.com:8080/cgi-bin/query?name=value&other=thing",
+  "https://www.example.com/path/to/a/deeply/nested/resource/index.html#top",
+};
+
+// URLs that do need some work.
+const char* const kNonCanonicalURLs[] = {
+  "HTTP://WWW.EXAMPLE.COM/Path/../Other/./File.HTML",
+  "http://www.example.com/a%41b/%7Euser/with space?q=<tag>",
+  "http://www.example.com\\windows\\style\\path",
+  "http://caf\xc3\xa9.example.com/men\xc3\xba?\xc3\xa9=1",
+};
+
+const int kIterations = 100000;
+
+void CanonicalizeAll(const char* test_name,
+                     const char* const* urls,
+                     size_t num_urls) {
+  std::vector<url_parse::Parsed> parsed(num_urls);
+  std::vector<int> lengths(num_urls);
+  for (size_t i = 0; i < num_urls; i++) {
+    lengths[i] = static_cast<int>(strlen(urls[i]));
+    url_parse::ParseStandardURL(urls[i], lengths[i], &parsed[i]);
+  }
+
+  std::string out_str;
+  base::PerfTimeLogger timer(test_name);
+  for (int iteration = 0; iteration < kIterations; iteration++) {
+    for (size_t i = 0; i < num_urls; i++) {
+      out_str.clear();
+      url_canon::StdStringCanonOutput output(&out_str);
+      url_parse::Parsed out_parsed;
+      url_canon::CanonicalizeStandardURL(urls[i], lengths[i], parsed[i], NULL,
+                                         &output, &out_parsed);
+      output.Complete();
+    }
+  }
+  timer.Done();
+}
+
+TEST(URLCanonPerfTest, CanonicalURLs) {
+  CanonicalizeAll("URL_Canon_Canonical", kCanonicalURLs,
+                  arraysize(kCanonicalURLs));
+}
+
+TEST(URLCanonPerfTest, NonCanonicalURLs) {
+  CanonicalizeAll("URL_Canon_NonCanonical", kNonCanonicalURLs,
+                  arraysize(kNonCanonicalURLs));
+}
+
+TEST(URLCanonPerfTest, LongPath) {
+  std::string url = "http://www.example.com";
+  for (int i = 0; i < 32; i++)
+    url += base::StringPrintf("/path-segment-%d", i);
+  const char* urls[] = { url.c_str() };
+  CanonicalizeAll("URL_Canon_LongPath", urls, arraysize(urls));
+}
+
+TEST(URLCanonPerfTest, GURL) {
+  base::PerfTimeLogger timer("URL_Canon_GURL");
+  for (int iteration = 0; iteration < kIterations; iteration++) {
+    for (size_t i = 0; i < arraysize(kCanonicalURLs); i++) {
+      GURL url(kCanonicalURLs[i]);
+      EXPECT_TRUE(url.is_valid());
+    }
+  }
+  timer.Done();
+}
+
+}  // namespace
@@ -59,6 +59,11 @@ template<typename CHAR>
 void AppendRaw8BitQueryString(const CHAR* source, int length,
                               CanonOutput* output) {
   for (int i = 0; i < length; i++) {
+    // Bulk-copy the characters that don't need escaping.
+    i += AppendCanonicalChars(source, i, length, CANONICAL_QUERY_CHARS, output);
+    if (i == length)
+      break;
+
     if (!IsQueryChar(static_cast<unsigned char>(source[i])))
       AppendEscapedChar(static_cast<unsigned char>(source[i]), output);
     else  // Doesn't need escaping.
@@ -1284,6 +1284,81 @@ TEST(URLCanonTest, Query) {
   EXPECT_EQ("?a%20%00z%01", out_str);
 }
 
+TEST(URLCanonTest, CountCanonicalChars) {
+  // Puts each character at each offset of an otherwise canonical string, so
+  // that it lands in every position of a 16 character block as well as in
+  // the tail.
+  const int kLength = 40;
+  for (int c = 0; c < 0x100; c++) {
+    bool is_digit = c >= '0' && c <= '9';
+    bool is_lower = c >= 'a' && c <= 'z';
+    bool is_upper = c >= 'A' && c <= 'Z';
+    bool in_set[] = {
+      is_digit || is_lower || is_upper || c == '-' || c == '_' || c == '/',
+      is_digit || is_lower || c == '-' || c == '.',
+      url_canon::IsQueryChar(static_cast<unsigned char>(c)),
+    };
+    url_canon::CanonicalCharSet char_sets[] = {
+      url_canon::CANONICAL_PATH_CHARS,
+      url_canon::CANONICAL_HOST_CHARS,
+      url_canon::CANONICAL_QUERY_CHARS,
+    };
+    for (size_t set = 0; set < ARRAYSIZE(char_sets); set++) {
+      for (int offset = 0; offset < kLength; offset++) {
+        std::string input(kLength, 'a');
+        input[offset] = static_cast<char>(c);
+        int expected = in_set[set] ? kLength : offset;
+        EXPECT_EQ(expected,
+                  url_canon::CountCanonicalChars(input.data(), 0, kLength,
+                                                 char_sets[set]))
+            << "character " << c << " at " << offset;
+        // Also start in the middle.
+        if (offset > 3) {
+          EXPECT_EQ(expected - 3,
+                    url_canon::CountCanonicalChars(input.data(), 3, kLength,
+                                                   char_sets[set]));
+        }
+      }
+    }
+  }
+}
+
+TEST(URLCanonTest, LongComponents) {
+  // Components that are longer than a block of the fast path, with the
+  // characters that need handling on either side of the block boundaries.
+  struct URLCase {
+    const char* input;
+    const char* expected;
+  } cases[] = {
+    {"http://www.Example-Of-A-Long-HOST.example.com/",
+     "http://www.example-of-a-long-host.example.com/"},
+    {"http://www.example-of-a-long-host%41.example.com/",
+     "http://www.example-of-a-long-hosta.example.com/"},
+    {"http://host/a-long-path-segment/../another-long-segment/./file_name.html",
+     "http://host/another-long-segment/file_name.html"},
+    {"http://host/0123456789abcdef/%41%42%43/0123456789abcde\\x/\x01 y",
+     "http://host/0123456789abcdef/ABC/0123456789abcde/x/%01%20y"},
+    {"http://host/?a-long-query-string=with+some&values<that>need\"escaping\"",
+     "http://host/?a-long-query-string=with+some&values%3Cthat%3Eneed"
+     "%22escaping%22"},
+  };
+
+  for (size_t i = 0; i < ARRAYSIZE(cases); i++) {
+    int url_len = static_cast<int>(strlen(cases[i].input));
+    url_parse::Parsed parsed;
+    url_parse::ParseStandardURL(cases[i].input, url_len, &parsed);
+
+    url_parse::Parsed out_parsed;
+    std::string out_str;
+    url_canon::StdStringCanonOutput output(&out_str);
+    EXPECT_TRUE(url_canon::CanonicalizeStandardURL(
+        cases[i].input, url_len, parsed, NULL, &output, &out_parsed));
+    output.Complete();
+
+    EXPECT_EQ(cases[i].expected, out_str);
+  }
+}
+
 TEST(URLCanonTest, Ref) {
   // Refs are trivial, it just checks the encoding.
   DualComponentCase ref_cases[] = {
@@ -53,6 +53,13 @@ void AppCacheHistograms::CountCheckResponseResult(
        result, NUM_CHECK_RESPONSE_RESULT_TYPES);
 }
 
+void AppCacheHistograms::AddUpdateJobStats(const base::TimeDelta& duration,
+                                           int64 bytes_fetched) {
+  UMA_HISTOGRAM_LONG_TIMES("appcache.UpdateJobDuration", duration);
+  UMA_HISTOGRAM_MEMORY_KB("appcache.UpdateJobBytesFetched",
+                          static_cast<int>(bytes_fetched / 1024));
+}
+
 void AppCacheHistograms::AddTaskQueueTimeSample(
     const base::TimeDelta& duration) {
   UMA_HISTOGRAM_TIMES("appcache.TaskQueueTime", duration);
@@ -31,6 +31,8 @@ class AppCacheHistograms {
     NUM_CHECK_RESPONSE_RESULT_TYPES
   };
   static void CountCheckResponseResult(CheckResponseResultType result);
+  static void AddUpdateJobStats(const base::TimeDelta& duration,
+                                int64 bytes_fetched);
 
   static void AddTaskQueueTimeSample(const base::TimeDelta& duration);
   static void AddTaskRunTimeSample(const base::TimeDelta& duration);
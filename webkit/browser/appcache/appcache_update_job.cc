@@ -10,12 +10,14 @@
 #include "base/message_loop/message_loop.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
+#include "net/base/host_port_pair.h"
 #include "net/base/io_buffer.h"
 #include "net/base/load_flags.h"
 #include "net/base/net_errors.h"
 #include "net/base/request_priority.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
+#include "net/http/http_server_properties.h"
 #include "net/url_request/url_request_context.h"
 #include "webkit/browser/appcache/appcache_group.h"
 #include "webkit/browser/appcache/appcache_histograms.h"
@@ -23,7 +25,9 @@
 namespace appcache {
 
 static const int kBufferSize = 32768;
-static const size_t kMaxConcurrentUrlFetches = 2;
+// Matches the per-host connection limit of the socket pools.
+static const size_t kMaxConcurrentUrlFetches = 6;
+static const size_t kMaxConcurrentSpdyUrlFetches = 16;
 static const int kMax503Retries = 3;
 
 static std::string FormatUrlErrorMessage(
@@ -328,8 +332,10 @@ AppCacheUpdateJob::AppCacheUpdateJob(AppCacheService* service,
       internal_state_(FETCH_MANIFEST),
       master_entries_completed_(0),
       url_fetches_completed_(0),
+      max_concurrent_url_fetches_(kMaxConcurrentUrlFetches),
       manifest_fetcher_(NULL),
       stored_state_(UNSTORED),
+      bytes_fetched_(0),
       storage_(service->storage()) {
     service_->AddObserver(this);
 }
@@ -394,6 +400,7 @@ void AppCacheUpdateJob::StartUpdate(AppCacheHost* host,
   }
 
   // Begin update process for the group.
+  start_time_ = base::TimeTicks::Now();
   group_->SetUpdateStatus(AppCacheGroup::CHECKING);
   if (group_->HasCache()) {
     update_type_ = UPGRADE_ATTEMPT;
@@ -544,6 +551,7 @@ void AppCacheUpdateJob::ContinueHandleManifestFetchCompleted(bool changed) {
 
   // Proceed with update process. Section 6.9.4 steps 8-20.
   internal_state_ = DOWNLOADING;
+  max_concurrent_url_fetches_ = GetMaxConcurrentUrlFetches();
   inprogress_cache_ = new AppCache(storage_, storage_->NewCacheId());
   BuildUrlFileList(manifest);
   inprogress_cache_->InitializeWithManifest(&manifest);
@@ -584,6 +592,7 @@ void AppCacheUpdateJob::HandleUrlFetchCompleted(URLFetcher* fetcher) {
     DCHECK(fetcher->response_writer());
     entry.set_response_id(fetcher->response_writer()->response_id());
     entry.set_response_size(fetcher->response_writer()->amount_written());
+    bytes_fetched_ += entry.response_size();
     if (!inprogress_cache_->AddOrModifyEntry(url, entry))
       duplicate_response_ids_.push_back(entry.response_id());
 
@@ -664,6 +673,7 @@ void AppCacheUpdateJob::HandleMasterEntryFetchCompleted(
     AppCacheEntry master_entry(AppCacheEntry::MASTER,
                                fetcher->response_writer()->response_id(),
                                fetcher->response_writer()->amount_written());
+    bytes_fetched_ += master_entry.response_size();
     if (cache->AddOrModifyEntry(url, master_entry))
       added_master_entries_.push_back(url);
     else
@@ -998,7 +1008,7 @@ void AppCacheUpdateJob::FetchUrls() {
   // Fetch each URL in the list according to section 6.9.4 step 17.1-17.3.
   // Fetch up to the concurrent limit. Other fetches will be triggered as each
   // each fetch completes.
-  while (pending_url_fetches_.size() < kMaxConcurrentUrlFetches &&
+  while (pending_url_fetches_.size() < max_concurrent_url_fetches_ &&
          !urls_to_fetch_.empty()) {
     UrlToFetch url_to_fetch = urls_to_fetch_.front();
     urls_to_fetch_.pop_front();
@@ -1050,6 +1060,17 @@ void AppCacheUpdateJob::CancelAllUrlFetches() {
   urls_to_fetch_.clear();
 }
 
+size_t AppCacheUpdateJob::GetMaxConcurrentUrlFetches() const {
+  base::WeakPtr<net::HttpServerProperties> http_server_properties =
+      service_->request_context()->http_server_properties();
+  if (http_server_properties.get() &&
+      http_server_properties->SupportsSpdy(
+          net::HostPortPair::FromURL(manifest_url_))) {
+    return kMaxConcurrentSpdyUrlFetches;
+  }
+  return kMaxConcurrentUrlFetches;
+}
+
 bool AppCacheUpdateJob::ShouldSkipUrlFetch(const AppCacheEntry& entry) {
   // 6.6.4 Step 17
   // If the resource URL being processed was flagged as neither an
@@ -1315,6 +1336,8 @@ void AppCacheUpdateJob::MaybeCompleteUpdate() {
       internal_state_ = COMPLETED;
       AppCacheHistograms::CountUpdateJobResult(
           UPDATE_OK, manifest_url_.GetOrigin());
+      AppCacheHistograms::AddUpdateJobStats(
+          base::TimeTicks::Now() - start_time_, bytes_fetched_);
       break;
     case CACHE_FAILURE:
       NOTREACHED();  // See HandleCacheFailure
@@ -13,6 +13,7 @@
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
+#include "base/time/time.h"
 #include "net/base/completion_callback.h"
 #include "net/http/http_response_headers.h"
 #include "net/url_request/url_request.h"
@@ -208,6 +209,9 @@ class WEBKIT_STORAGE_BROWSER_EXPORT AppCacheUpdateJob
   void AddUrlToFileList(const GURL& url, int type);
   void FetchUrls();
   void CancelAllUrlFetches();
+  // Returns how many URL fetches may run at once. SPDY multiplexes them over
+  // a single connection, so more can run when the manifest's server speaks it.
+  size_t GetMaxConcurrentUrlFetches() const;
   bool ShouldSkipUrlFetch(const AppCacheEntry& entry);
 
   // If entry already exists in the cache currently being updated, merge
@@ -280,6 +284,7 @@ class WEBKIT_STORAGE_BROWSER_EXPORT AppCacheUpdateJob
   // URLs of files to fetch along with their flags.
   AppCache::EntryMap url_file_list_;
   size_t url_fetches_completed_;
+  size_t max_concurrent_url_fetches_;
 
   // Helper container to track which urls have not been fetched yet. URLs are
   // removed when the fetch is initiated. Flag indicates whether an attempt
@@ -320,6 +325,10 @@ class WEBKIT_STORAGE_BROWSER_EXPORT AppCacheUpdateJob
   // Whether we've stored the resulting group/cache yet.
   StoredState stored_state_;
 
+  // Used for uma stats on successful updates.
+  base::TimeTicks start_time_;
+  int64 bytes_fetched_;
+
   AppCacheStorage* storage_;
 
   FRIEND_TEST_ALL_PREFIXES(AppCacheGroupTest, QueueUpdate);
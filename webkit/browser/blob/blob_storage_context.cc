@@ -4,6 +4,8 @@
 
 #include "webkit/browser/blob/blob_storage_context.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/location.h"
 #include "base/logging.h"
@@ -140,8 +142,9 @@ void BlobStorageContext::AppendBlobDataItem(
   //    modification time.
   // 3) The FileSystem File item is denoted by the FileSystem URL, the range
   //    and the expected modification time.
-  // 4) The Blob items are expanded.
-  // TODO(michaeln): Would be nice to avoid copying Data items when expanding.
+  // 4) The Blob items are expanded. Data items of finished blobs are shared
+  //    rather than copied; the source blob then stays registered until every
+  //    blob sharing its bytes goes away, so its memory stays accounted for.
 
   DCHECK(item.length() > 0);
   switch (item.type()) {
@@ -186,6 +189,7 @@ void BlobStorageContext::AppendBlobDataItem(
     memory_usage_ -= target_blob_data->GetMemoryUsage();
     found->second.flags |= EXCEEDED_MEMORY;
     found->second.data = new BlobData(uuid);
+    ReleaseSharedBlobs(target_blob_data);
     return;
   }
 }
@@ -220,8 +224,10 @@ void BlobStorageContext::DecrementBlobRefCount(const std::string& uuid) {
     return;
   DCHECK_EQ(found->second.data->uuid(), uuid);
   if (--(found->second.refcount) == 0) {
-    memory_usage_ -= found->second.data->GetMemoryUsage();
+    scoped_refptr<BlobData> data = found->second.data;
+    memory_usage_ -= data->GetMemoryUsage();
     blob_map_.erase(found);
+    ReleaseSharedBlobs(data.get());
   }
 }
 
@@ -231,6 +237,10 @@ bool BlobStorageContext::ExpandStorageItems(
   DCHECK(target_blob_data && src_blob_data &&
          length != static_cast<uint64>(-1));
 
+  // The items of a blob that is still being built may be reallocated, so only
+  // the bytes of finished blobs can be shared.
+  bool share_bytes = !IsBeingBuilt(src_blob_data->uuid());
+
   std::vector<BlobData::Item>::const_iterator iter =
       src_blob_data->items().begin();
   if (offset) {
@@ -246,10 +256,13 @@ bool BlobStorageContext::ExpandStorageItems(
     uint64 current_length = iter->length() - offset;
     uint64 new_length = current_length > length ? length : current_length;
     if (iter->type() == BlobData::Item::TYPE_BYTES) {
-      if (!AppendBytesItem(
-              target_blob_data,
-              iter->bytes() + static_cast<size_t>(iter->offset() + offset),
-              static_cast<int64>(new_length))) {
+      const char* bytes =
+          iter->bytes() + static_cast<size_t>(iter->offset() + offset);
+      if (share_bytes) {
+        AppendSharedBytesItem(target_blob_data, src_blob_data, bytes,
+                              static_cast<int64>(new_length));
+      } else if (!AppendBytesItem(target_blob_data, bytes,
+                                  static_cast<int64>(new_length))) {
         return false;  // exceeded memory
       }
     } else if (iter->type() == BlobData::Item::TYPE_FILE) {
@@ -285,6 +298,29 @@ bool BlobStorageContext::AppendBytesItem(
   return true;
 }
 
+void BlobStorageContext::AppendSharedBytesItem(
+    BlobData* target_blob_data, BlobData* owner_blob_data,
+    const char* bytes, int64 length) {
+  DCHECK_GT(length, 0);
+  // Keep the owner registered, and its memory accounted for, while its bytes
+  // are shared.
+  const std::vector<scoped_refptr<BlobData> >& shared_blobs =
+      target_blob_data->shared_blobs();
+  if (std::find(shared_blobs.begin(), shared_blobs.end(), owner_blob_data) ==
+      shared_blobs.end()) {
+    IncrementBlobRefCount(owner_blob_data->uuid());
+  }
+  target_blob_data->AppendSharedData(bytes, static_cast<size_t>(length),
+                                     owner_blob_data);
+}
+
+void BlobStorageContext::ReleaseSharedBlobs(BlobData* blob_data) {
+  const std::vector<scoped_refptr<BlobData> >& shared_blobs =
+      blob_data->shared_blobs();
+  for (size_t i = 0; i < shared_blobs.size(); ++i)
+    DecrementBlobRefCount(shared_blobs[i]->uuid());
+}
+
 void BlobStorageContext::AppendFileItem(
     BlobData* target_blob_data,
     const base::FilePath& file_path, uint64 offset, uint64 length,
@@ -85,6 +85,11 @@ class WEBKIT_STORAGE_BROWSER_EXPORT BlobStorageContext
                           uint64 length);
   bool AppendBytesItem(BlobData* target_blob_data,
                        const char* data, int64 length);
+  void AppendSharedBytesItem(BlobData* target_blob_data,
+                             BlobData* owner_blob_data,
+                             const char* data, int64 length);
+  // Drops the references |blob_data| holds on the blobs it shares bytes with.
+  void ReleaseSharedBlobs(BlobData* blob_data);
   void AppendFileItem(BlobData* target_blob_data,
                       const base::FilePath& file_path,
                       uint64 offset, uint64 length,
@@ -131,6 +131,50 @@ TEST(BlobStorageContextTest, CompoundBlobs) {
   EXPECT_TRUE(*(blob_data_handle->data()) == *canonicalized_blob_data2.get());
 }
 
+TEST(BlobStorageContextTest, SlicesShareBytes) {
+  const std::string kId1("id1");
+  const std::string kId2("id2");
+
+  base::MessageLoop fake_io_message_loop;
+
+  scoped_refptr<BlobData> blob_data1(new BlobData(kId1));
+  blob_data1->AppendData("Data1");
+  blob_data1->AppendData("Data2");
+
+  scoped_refptr<BlobData> blob_data2(new BlobData(kId2));
+  blob_data2->AppendBlob(kId1, 3, 4);
+
+  BlobStorageContext context;
+  scoped_ptr<BlobDataHandle> blob_data_handle1 =
+      context.AddFinishedBlob(blob_data1.get());
+  ASSERT_TRUE(blob_data_handle1.get());
+  scoped_ptr<BlobDataHandle> blob_data_handle2 =
+      context.AddFinishedBlob(blob_data2.get());
+  ASSERT_TRUE(blob_data_handle2.get());
+
+  // The slice points into the bytes of the first blob instead of copying.
+  const std::vector<BlobData::Item>& items1 =
+      blob_data_handle1->data()->items();
+  const std::vector<BlobData::Item>& items2 =
+      blob_data_handle2->data()->items();
+  ASSERT_EQ(2U, items2.size());
+  EXPECT_EQ(items1[0].bytes() + 3, items2[0].bytes());
+  EXPECT_EQ(2U, items2[0].length());
+  EXPECT_EQ(items1[1].bytes(), items2[1].bytes());
+  EXPECT_EQ(2U, items2[1].length());
+  EXPECT_EQ(0, blob_data_handle2->data()->GetMemoryUsage());
+
+  // The shared bytes outlive the handle of the first blob.
+  blob_data_handle1.reset();
+  EXPECT_EQ(0, memcmp("a1", blob_data_handle2->data()->items()[0].bytes(), 2));
+  EXPECT_EQ(0, memcmp("Da", blob_data_handle2->data()->items()[1].bytes(), 2));
+
+  // Both blobs go away with the last reference to the slice.
+  blob_data_handle2.reset();
+  EXPECT_FALSE(context.GetBlobDataFromUUID(kId2));
+  EXPECT_FALSE(context.GetBlobDataFromUUID(kId1));
+}
+
 TEST(BlobStorageContextTest, PublicBlobUrls) {
   BlobStorageContext context;
   BlobStorageHost host(&context);
@@ -73,6 +73,7 @@ const char kChildLookupPrefix[] = "CHILD_OF:";
 const char kChildLookupSeparator[] = ":";
 const char kLastFileIdKey[] = "LAST_FILE_ID";
 const char kLastIntegerKey[] = "LAST_INTEGER";
+const size_t kMaxCachedChildIds = 1000;
 const int64 kMinimumReportIntervalHours = 1;
 const char kInitStatusHistogramLabel[] = "FileSystem.DirectoryDatabaseInit";
 const char kDatabaseRepairHistogramLabel[] =
@@ -413,7 +414,8 @@ SandboxDirectoryDatabase::SandboxDirectoryDatabase(
     const base::FilePath& filesystem_data_directory,
     leveldb::Env* env_override)
     : filesystem_data_directory_(filesystem_data_directory),
-      env_override_(env_override) {
+      env_override_(env_override),
+      child_id_cache_(kMaxCachedChildIds) {
 }
 
 SandboxDirectoryDatabase::~SandboxDirectoryDatabase() {
@@ -427,6 +429,11 @@ bool SandboxDirectoryDatabase::GetChildWithName(
     return false;
   DCHECK(child_id);
   std::string child_key = GetChildLookupKey(parent_id, name);
+  ChildIdCache::iterator found = child_id_cache_.Get(child_key);
+  if (found != child_id_cache_.end()) {
+    *child_id = found->second;
+    return true;
+  }
   std::string child_id_string;
   leveldb::Status status =
       db_->Get(leveldb::ReadOptions(), child_key, &child_id_string);
@@ -437,6 +444,7 @@ bool SandboxDirectoryDatabase::GetChildWithName(
       LOG(ERROR) << "Hit database corruption!";
       return false;
     }
+    child_id_cache_.Put(child_key, *child_id);
     return true;
   }
   HandleError(FROM_HERE, status);
@@ -732,6 +740,7 @@ bool SandboxDirectoryDatabase::Init(RecoveryOption recovery_option) {
   ReportInitStatus(status);
   if (status.ok()) {
     db_.reset(db);
+    child_id_cache_.Clear();
     return true;
   }
   HandleError(FROM_HERE, status);
@@ -800,6 +809,8 @@ bool SandboxDirectoryDatabase::IsDirectory(FileId file_id) {
 bool SandboxDirectoryDatabase::IsFileSystemConsistent() {
   if (!Init(FAIL_ON_CORRUPTION))
     return false;
+  // Check what is actually on disk rather than what was cached.
+  child_id_cache_.Clear();
   DatabaseCheckHelper helper(this, db_.get(), filesystem_data_directory_);
   return helper.IsFileSystemConsistent();
 }
@@ -894,6 +905,8 @@ bool SandboxDirectoryDatabase::AddFileInfoHelper(
   } else {
     std::string child_key = GetChildLookupKey(info.parent_id, info.name);
     batch->Put(child_key, id_string);
+    // The batch may yet fail to be written, so don't cache the new id here.
+    EraseCachedChildId(child_key);
   }
   Pickle pickle;
   if (!PickleFromFileInfo(info, &pickle))
@@ -922,17 +935,27 @@ bool SandboxDirectoryDatabase::RemoveFileInfoHelper(
       return false;
     }
   }
-  batch->Delete(GetChildLookupKey(info.parent_id, info.name));
+  std::string child_key = GetChildLookupKey(info.parent_id, info.name);
+  batch->Delete(child_key);
   batch->Delete(GetFileLookupKey(file_id));
+  EraseCachedChildId(child_key);
   return true;
 }
 
+void SandboxDirectoryDatabase::EraseCachedChildId(
+    const std::string& child_key) {
+  ChildIdCache::iterator found = child_id_cache_.Peek(child_key);
+  if (found != child_id_cache_.end())
+    child_id_cache_.Erase(found);
+}
+
 void SandboxDirectoryDatabase::HandleError(
     const tracked_objects::Location& from_here,
     const leveldb::Status& status) {
   LOG(ERROR) << "SandboxDirectoryDatabase failed at: "
              << from_here.ToString() << " with error: " << status.ToString();
   db_.reset();
+  child_id_cache_.Clear();
 }
 
 }  // namespace fileapi
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/memory/scoped_ptr.h"
@@ -105,6 +106,8 @@ class WEBKIT_STORAGE_BROWSER_EXPORT_PRIVATE SandboxDirectoryDatabase {
     FAIL_ON_CORRUPTION,
   };
 
+  typedef base::MRUCache<std::string, FileId> ChildIdCache;
+
   friend class ObfuscatedFileUtil;
   friend class SandboxDirectoryDatabaseTest;
 
@@ -116,12 +119,16 @@ class WEBKIT_STORAGE_BROWSER_EXPORT_PRIVATE SandboxDirectoryDatabase {
   bool AddFileInfoHelper(
       const FileInfo& info, FileId file_id, leveldb::WriteBatch* batch);
   bool RemoveFileInfoHelper(FileId file_id, leveldb::WriteBatch* batch);
+  void EraseCachedChildId(const std::string& child_key);
   void HandleError(const tracked_objects::Location& from_here,
                    const leveldb::Status& status);
 
   const base::FilePath filesystem_data_directory_;
   leveldb::Env* env_override_;
   scoped_ptr<leveldb::DB> db_;
+  // Maps child lookup keys to file ids, so that resolving a path doesn't hit
+  // the database once per component.  Only holds entries known to exist.
+  ChildIdCache child_id_cache_;
   base::Time last_reported_time_;
   DISALLOW_COPY_AND_ASSIGN(SandboxDirectoryDatabase);
 };
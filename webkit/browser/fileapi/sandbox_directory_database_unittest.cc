@@ -119,6 +119,7 @@ class SandboxDirectoryDatabaseTest : public testing::Test {
         "CHILD_OF:" + base::Int64ToString(parent_id) + ":" +
         FilePathToString(base::FilePath(name)),
         base::Int64ToString(child_id)).ok());
+    db()->child_id_cache_.Clear();
   }
 
   // Deletes link from parent of |file_id| to |file_id|.
@@ -129,6 +130,7 @@ class SandboxDirectoryDatabaseTest : public testing::Test {
         leveldb::WriteOptions(),
         "CHILD_OF:" + base::Int64ToString(file_info.parent_id) + ":" +
         FilePathToString(base::FilePath(file_info.name))).ok());
+    db()->child_id_cache_.Clear();
   }
 
  protected:
@@ -313,6 +315,40 @@ TEST_F(SandboxDirectoryDatabaseTest, TestGetFileWithPath) {
   EXPECT_EQ(file_id2, check_file_id);
 }
 
+TEST_F(SandboxDirectoryDatabaseTest, TestGetFileWithPathAfterChange) {
+  FileInfo info;
+  FileId dir_id;
+  FileId file_id;
+  info.parent_id = 0;
+  info.name = FILE_PATH_LITERAL("dir");
+  EXPECT_EQ(base::File::FILE_OK, db()->AddFileInfo(info, &dir_id));
+  info.parent_id = dir_id;
+  info.name = FILE_PATH_LITERAL("foo");
+  EXPECT_EQ(base::File::FILE_OK, db()->AddFileInfo(info, &file_id));
+
+  // Look the file up once so that its path is remembered.
+  FileId check_file_id;
+  base::FilePath old_path =
+      base::FilePath(FILE_PATH_LITERAL("dir")).Append(FILE_PATH_LITERAL("foo"));
+  EXPECT_TRUE(db()->GetFileWithPath(old_path, &check_file_id));
+  EXPECT_EQ(file_id, check_file_id);
+
+  // Renaming the file must be visible to subsequent lookups.
+  info.name = FILE_PATH_LITERAL("bar");
+  EXPECT_TRUE(db()->UpdateFileInfo(file_id, info));
+  EXPECT_FALSE(db()->GetFileWithPath(old_path, &check_file_id));
+  base::FilePath new_path =
+      base::FilePath(FILE_PATH_LITERAL("dir")).Append(FILE_PATH_LITERAL("bar"));
+  EXPECT_TRUE(db()->GetFileWithPath(new_path, &check_file_id));
+  EXPECT_EQ(file_id, check_file_id);
+
+  // So must removing it.
+  EXPECT_TRUE(db()->RemoveFileInfo(file_id));
+  EXPECT_FALSE(db()->GetFileWithPath(new_path, &check_file_id));
+  EXPECT_FALSE(db()->GetChildWithName(
+      dir_id, FILE_PATH_LITERAL("bar"), &check_file_id));
+}
+
 TEST_F(SandboxDirectoryDatabaseTest, TestListChildren) {
   // No children in the root.
   std::vector<FileId> children;
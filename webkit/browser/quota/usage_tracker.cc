@@ -420,13 +420,15 @@ void ClientUsageTracker::SetUsageCacheEnabled(const GURL& origin,
       non_cached_limited_origins_by_host_[host].insert(origin);
   } else {
     // Erase |origin| from |non_cached_origins_| and invalidate the usage cache
-    // for the host.
+    // for the host. Only the host needs to be gathered again: the global usage
+    // stays valid, as re-adding |origin| to the cache adds its usage to it.
     if (EraseOriginFromOriginSet(&non_cached_limited_origins_by_host_,
                                  host, origin) ||
         EraseOriginFromOriginSet(&non_cached_unlimited_origins_by_host_,
                                  host, origin)) {
       cached_hosts_.erase(host);
-      global_usage_retrieved_ = false;
+      if (global_usage_retrieved_)
+        GetHostUsage(host, base::Bind(&NoopHostUsageCallback));
     }
   }
 }
@@ -36,7 +36,7 @@ void DidGetUsage(bool* done,
 
 class MockQuotaClient : public QuotaClient {
  public:
-  MockQuotaClient() {}
+  MockQuotaClient() : get_origins_for_type_count_(0) {}
   virtual ~MockQuotaClient() {}
 
   virtual ID id() const OVERRIDE {
@@ -57,6 +57,7 @@ class MockQuotaClient : public QuotaClient {
   virtual void GetOriginsForType(StorageType type,
                                  const GetOriginsCallback& callback) OVERRIDE {
     EXPECT_EQ(kStorageTypeTemporary, type);
+    ++get_origins_for_type_count_;
     std::set<GURL> origins;
     for (UsageMap::const_iterator itr = usage_map_.begin();
          itr != usage_map_.end(); ++itr) {
@@ -108,10 +109,15 @@ class MockQuotaClient : public QuotaClient {
     return usage_map_[origin] += delta;
   }
 
+  int get_origins_for_type_count() const {
+    return get_origins_for_type_count_;
+  }
+
  private:
   typedef std::map<GURL, int64> UsageMap;
 
   UsageMap usage_map_;
+  int get_origins_for_type_count_;
 
   DISALLOW_COPY_AND_ASSIGN(MockQuotaClient);
 };
@@ -188,6 +194,10 @@ class UsageTrackerTest : public testing::Test {
         quota_client_.id(), origin, enabled);
   }
 
+  int GetOriginsForTypeCount() const {
+    return quota_client_.get_origins_for_type_count();
+  }
+
  private:
   QuotaClientList GetUsageTrackerList() {
     QuotaClientList client_list;
@@ -287,6 +297,39 @@ TEST_F(UsageTrackerTest, CacheDisabledClientTest) {
   EXPECT_EQ(500, host_usage);
 }
 
+TEST_F(UsageTrackerTest, ReenableCacheKeepsGlobalUsage) {
+  int64 usage = 0;
+  int64 unlimited_usage = 0;
+  int64 host_usage = 0;
+
+  const GURL origin("http://example.com");
+  const GURL other_origin("http://other.com");
+  const std::string host(net::GetHostOrSpecFromURL(origin));
+
+  UpdateUsageWithoutNotification(origin, 100);
+  UpdateUsageWithoutNotification(other_origin, 10);
+  GetGlobalUsage(&usage, &unlimited_usage);
+  EXPECT_EQ(110, usage);
+  EXPECT_EQ(1, GetOriginsForTypeCount());
+
+  SetUsageCacheEnabled(origin, false);
+  UpdateUsageWithoutNotification(origin, 100);
+  SetUsageCacheEnabled(origin, true);
+  base::RunLoop().RunUntilIdle();
+
+  // Only the host of |origin| is gathered again, not every origin.
+  GetGlobalUsage(&usage, &unlimited_usage);
+  GetHostUsage(host, &host_usage);
+  EXPECT_EQ(210, usage);
+  EXPECT_EQ(200, host_usage);
+  EXPECT_EQ(1, GetOriginsForTypeCount());
+
+  UpdateUsage(origin, 50);
+  GetGlobalUsage(&usage, &unlimited_usage);
+  EXPECT_EQ(260, usage);
+  EXPECT_EQ(1, GetOriginsForTypeCount());
+}
+
 TEST_F(UsageTrackerTest, LimitedGlobalUsageTest) {
   const GURL kNormal("http://normal");
   const GURL kUnlimited("http://unlimited");
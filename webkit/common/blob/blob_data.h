@@ -34,6 +34,10 @@ class WEBKIT_STORAGE_COMMON_EXPORT BlobData
 
   void AppendData(const char* data, size_t length);
 
+  // Appends |length| bytes at |data| without copying them. The bytes must be
+  // owned by |owner|, which is kept alive as long as this blob is.
+  void AppendSharedData(const char* data, size_t length, BlobData* owner);
+
   void AppendFile(const base::FilePath& file_path, uint64 offset, uint64 length,
                   const base::Time& expected_modification_time);
   void AppendBlob(const std::string& uuid, uint64 offset, uint64 length);
@@ -46,6 +50,9 @@ class WEBKIT_STORAGE_COMMON_EXPORT BlobData
 
   const std::string& uuid() const { return uuid_; }
   const std::vector<Item>& items() const { return items_; }
+  const std::vector<scoped_refptr<BlobData> >& shared_blobs() const {
+    return shared_blobs_;
+  }
   const std::string& content_type() const { return content_type_; }
   void set_content_type(const std::string& content_type) {
     content_type_ = content_type;
@@ -58,6 +65,8 @@ class WEBKIT_STORAGE_COMMON_EXPORT BlobData
     content_disposition_ = content_disposition;
   }
 
+  // Returns the size of the bytes owned by this blob, which excludes the
+  // bytes shared with other blobs.
   int64 GetMemoryUsage() const;
 
  private:
@@ -69,6 +78,8 @@ class WEBKIT_STORAGE_COMMON_EXPORT BlobData
   std::string content_disposition_;
   std::vector<Item> items_;
   std::vector<scoped_refptr<ShareableFileReference> > shareable_files_;
+  std::vector<scoped_refptr<BlobData> > shared_blobs_;
+  int64 shared_data_length_;
 
   DISALLOW_COPY_AND_ASSIGN(BlobData);
 };